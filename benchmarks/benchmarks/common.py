@@ -106,6 +106,42 @@ def run_monitored(code):
     return duration, peak_memusage
 
 
+def traced_memory(func, *args, **kwargs):
+    """
+    Memory allocated by a call to func, as traced by tracemalloc.
+
+    This covers Python objects and the data of NumPy arrays, which NumPy
+    reports to tracemalloc, but not the scratch space that compiled code
+    allocates with malloc or new; the process peak of ``peakmem_``
+    benchmarks includes those.
+
+    Returns
+    -------
+    peak : int
+        Peak of the memory allocated during the call, in bytes
+    blocks : int
+        Number of the blocks allocated during the call and still held
+        after it, as by its result
+
+    """
+    import tracemalloc
+
+    was_tracing = tracemalloc.is_tracing()
+    if not was_tracing:
+        tracemalloc.start()
+    try:
+        # also resets the peak
+        tracemalloc.clear_traces()
+        result = func(*args, **kwargs)
+        peak = tracemalloc.get_traced_memory()[1]
+        blocks = len(tracemalloc.take_snapshot().traces)
+        del result
+    finally:
+        if not was_tracing:
+            tracemalloc.stop()
+    return peak, blocks
+
+
 def get_mem_info():
     """Get information about available memory"""
     if not sys.platform.startswith('linux'):
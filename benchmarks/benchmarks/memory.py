@@ -0,0 +1,159 @@
+"""
+Memory use of the sparse, spatial, interpolate, fft and ndimage kernels
+
+Each suite tracks, for one call of a kernel,
+
+- ``peakmem_kernel``: the peak resident memory of the process, which
+  includes the scratch space of the compiled code and the inputs made in
+  setup;
+- ``track_traced_peak``: the peak of the memory allocated during the call,
+  as traced by tracemalloc (Python objects and NumPy arrays);
+- ``track_traced_blocks``: the number of traced blocks that the call
+  allocates and its result holds on to.
+
+The traced numbers are exact and do not depend on the allocator, so small
+regressions show up in them before they do in the process peak.
+"""
+from __future__ import division, absolute_import, print_function
+
+import numpy as np
+
+try:
+    from scipy import fft, ndimage, sparse
+    from scipy.interpolate import Rbf
+    from scipy.spatial import cKDTree
+    from scipy.spatial.distance import pdist
+except ImportError:
+    pass
+
+from .common import Benchmark, traced_memory, with_attributes
+
+
+class MemoryBenchmark(Benchmark):
+    """
+    Base of the suites: subclasses define setup and kernel(), which
+    returns the result of the call.
+    """
+
+    def peakmem_kernel(self, *args):
+        self.kernel()
+
+    @with_attributes(unit="bytes")
+    def track_traced_peak(self, *args):
+        return traced_memory(self.kernel)[0]
+
+    @with_attributes(unit="blocks")
+    def track_traced_blocks(self, *args):
+        return traced_memory(self.kernel)[1]
+
+
+class SparseMatmat(MemoryBenchmark):
+    params = [[10**4, 10**5], [4, 16]]
+    param_names = ['n', 'nnz_per_row']
+
+    def setup(self, n, nnz_per_row):
+        self.A = sparse.random(n, n, density=nnz_per_row / n, format='csr',
+                               random_state=1234)
+
+    def kernel(self):
+        return self.A * self.A
+
+
+class SparseConversion(MemoryBenchmark):
+    params = [[10**5, 10**6], ['csc', 'coo', 'bsr']]
+    param_names = ['n', 'format']
+
+    def setup(self, n, format):
+        self.A = sparse.random(n, n, density=8 / n, format='csr',
+                               random_state=1234)
+        self.format = format
+
+    def kernel(self):
+        return self.A.asformat(self.format)
+
+
+class KDTreeQueryBallPoint(MemoryBenchmark):
+    params = [[10**4, 10**5], [0.01, 0.05]]
+    param_names = ['n', 'r']
+
+    def setup(self, n, r):
+        rng = np.random.RandomState(1234)
+        self.T = cKDTree(rng.uniform(size=(n, 3)))
+        self.x = rng.uniform(size=(n, 3))
+        self.r = r
+
+    def kernel(self):
+        return self.T.query_ball_point(self.x, self.r)
+
+
+class KDTreeBuild(MemoryBenchmark):
+    params = [[10**5, 10**6]]
+    param_names = ['n']
+
+    def setup(self, n):
+        self.data = np.random.RandomState(1234).uniform(size=(n, 3))
+
+    def kernel(self):
+        return cKDTree(self.data)
+
+
+class Pdist(MemoryBenchmark):
+    params = [[1000, 4000], ['euclidean', 'hamming']]
+    param_names = ['n', 'metric']
+
+    def setup(self, n, metric):
+        rng = np.random.RandomState(1234)
+        self.X = rng.uniform(size=(n, 8))
+        if metric == 'hamming':
+            self.X = self.X > 0.5
+        self.metric = metric
+
+    def kernel(self):
+        return pdist(self.X, self.metric)
+
+
+class RbfInit(MemoryBenchmark):
+    params = [[500, 2000], ['multiquadric', 'thin_plate']]
+    param_names = ['n', 'function']
+
+    def setup(self, n, function):
+        rng = np.random.RandomState(1234)
+        self.x, self.y, self.d = rng.uniform(size=(3, n))
+        self.function = function
+
+    def kernel(self):
+        return Rbf(self.x, self.y, self.d, function=self.function)
+
+
+class FFTN(MemoryBenchmark):
+    params = [[(1024, 1024), (128, 128, 128)], ['c2c', 'r2c']]
+    param_names = ['shape', 'type']
+
+    def setup(self, shape, type):
+        rng = np.random.RandomState(1234)
+        self.x = rng.standard_normal(shape)
+        if type == 'c2c':
+            self.x = self.x + 1j*rng.standard_normal(shape)
+        self.type = type
+
+    def kernel(self):
+        if self.type == 'c2c':
+            return fft.fftn(self.x)
+        return fft.rfftn(self.x)
+
+
+class NdimageFilter(MemoryBenchmark):
+    params = [[(2048, 2048), (128, 128, 128)],
+              ['gaussian', 'median', 'uniform']]
+    param_names = ['shape', 'filter']
+
+    def setup(self, shape, filter):
+        self.x = np.random.RandomState(1234).standard_normal(shape)
+        self.filter = filter
+
+    def kernel(self):
+        if self.filter == 'gaussian':
+            return ndimage.gaussian_filter(self.x, 2.0)
+        elif self.filter == 'median':
+            return ndimage.median_filter(self.x, 3)
+        return ndimage.uniform_filter(self.x, 5)
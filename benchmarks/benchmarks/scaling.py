@@ -0,0 +1,151 @@
+"""
+Scaling of the threaded kernels with the number of threads
+
+Each suite times one kernel for a number of threads and a problem size,
+and tracks
+
+- ``track_efficiency``: the parallel efficiency t(1) / (threads * t(threads)),
+  1 for perfect scaling;
+- ``track_bandwidth``: the bytes of the operands read and written per second,
+  in GB/s, to compare with the memory bandwidth of the machine.
+
+Thread counts above the number of CPUs are skipped.
+"""
+from __future__ import division, absolute_import, print_function
+
+import os
+import time
+
+import numpy as np
+
+try:
+    from scipy import fft, ndimage, sparse
+    from scipy.spatial import cKDTree
+    from scipy.spatial.distance import cdist
+except ImportError:
+    pass
+
+from .common import Benchmark, with_attributes
+
+
+def _cpu_count():
+    if hasattr(os, 'sched_getaffinity'):
+        return len(os.sched_getaffinity(0))
+    return os.cpu_count() or 1
+
+
+def _best_time(func, min_time=0.2, max_repeat=50):
+    """Shortest time of a call to func, over calls lasting min_time"""
+    best = np.inf
+    start = time.perf_counter()
+    for _ in range(max_repeat):
+        t0 = time.perf_counter()
+        func()
+        t1 = time.perf_counter()
+        best = min(best, t1 - t0)
+        if t1 - start > min_time:
+            break
+    return best
+
+
+class ScalingBenchmark(Benchmark):
+    """
+    Base of the suites: the first parameter is the number of threads.
+    Subclasses define setup_kernel, which sets ``self.nbytes``, and
+    kernel(threads).
+    """
+    threads = [1, 2, 4, 8]
+
+    def setup(self, threads, *args):
+        if threads > _cpu_count():
+            raise NotImplementedError("more threads than CPUs")
+        self.setup_kernel(*args)
+
+    def time_kernel(self, threads, *args):
+        self.kernel(threads)
+
+    @with_attributes(unit="relative")
+    def track_efficiency(self, threads, *args):
+        t1 = _best_time(lambda: self.kernel(1))
+        tp = t1 if threads == 1 else _best_time(lambda: self.kernel(threads))
+        return t1 / (threads * tp)
+
+    @with_attributes(unit="GB/s")
+    def track_bandwidth(self, threads, *args):
+        return self.nbytes / _best_time(lambda: self.kernel(threads)) / 1e9
+
+
+class KDTreeQuery(ScalingBenchmark):
+    params = [ScalingBenchmark.threads, [10**4, 10**5, 10**6]]
+    param_names = ['threads', 'n']
+
+    def setup_kernel(self, n):
+        rng = np.random.RandomState(1234)
+        self.T = cKDTree(rng.uniform(size=(n, 3)))
+        self.queries = rng.uniform(size=(n, 3))
+        # points and queries, distances and indices
+        self.nbytes = 2 * self.queries.nbytes + n * 16
+
+    def kernel(self, threads):
+        self.T.query(self.queries, n_jobs=threads)
+
+
+class FFT2(ScalingBenchmark):
+    params = [ScalingBenchmark.threads, [256, 1024, 2048]]
+    param_names = ['threads', 'n']
+
+    def setup_kernel(self, n):
+        rng = np.random.RandomState(1234)
+        self.x = rng.standard_normal((n, n)) + 1j*rng.standard_normal((n, n))
+        self.nbytes = 2 * self.x.nbytes
+
+    def kernel(self, threads):
+        fft.fft2(self.x, workers=threads)
+
+
+class SparseMatvec(ScalingBenchmark):
+    params = [ScalingBenchmark.threads, [10**4, 10**5, 10**6]]
+    param_names = ['threads', 'n']
+
+    def setup_kernel(self, n):
+        self.A = sparse.random(n, n, density=16 / n, format='csr',
+                               random_state=1234)
+        self.x = np.ones(n)
+        self.nbytes = (self.A.data.nbytes + self.A.indices.nbytes +
+                       self.A.indptr.nbytes + 2 * self.x.nbytes)
+
+    def kernel(self, threads):
+        with sparse.set_workers(threads):
+            self.A.dot(self.x)
+
+
+class Cdist(ScalingBenchmark):
+    params = [ScalingBenchmark.threads, [500, 2000, 4000]]
+    param_names = ['threads', 'n']
+
+    def setup_kernel(self, n):
+        rng = np.random.RandomState(1234)
+        self.XA = rng.uniform(size=(n, 8))
+        self.XB = rng.uniform(size=(n, 8))
+        self.nbytes = self.XA.nbytes + self.XB.nbytes + n * n * 8
+
+    def kernel(self, threads):
+        cdist(self.XA, self.XB, 'euclidean', workers=threads)
+
+
+class NdimageFilter(ScalingBenchmark):
+    params = [ScalingBenchmark.threads, [512, 2048, 4096],
+              ['uniform', 'gaussian']]
+    param_names = ['threads', 'n', 'filter']
+
+    def setup_kernel(self, n, filter):
+        rng = np.random.RandomState(1234)
+        self.x = rng.standard_normal((n, n))
+        self.filter = filter
+        self.nbytes = 2 * self.x.nbytes
+
+    def kernel(self, threads):
+        if self.filter == 'uniform':
+            ndimage.uniform_filter(self.x, 5, workers=threads)
+        else:
+            ndimage.gaussian_filter(self.x, 2.0, workers=threads)
@@ -0,0 +1,340 @@
+/*
+ * Minimal harness for the native kernel benchmarks
+ *
+ * Each benchmark program times kernels called straight from C++, and
+ * prints one JSON object per line for every case:
+ *
+ *     {"name": "csr_matvec", "params": "matrix=poisson2d,n=300",
+ *      "ns": 512.3, "ns_min": 508.1, "repeat": 7, "number": 200,
+ *      "per": {"nnz": 0.11}, "gflops": 17.5,
+ *      "counters": {"cycles": 1712.0, "instructions": 3021.0}}
+ *
+ * "ns" is the median time of one call over the repeats, "per" the time
+ * per unit of work (nonzero, point, ...) and "counters" the hardware
+ * counters per call, where the platform has them (Linux perf events).
+ * run_native.py collects the lines of all programs.
+ *
+ * Options: --repeat N, --min-time SECONDS (per repeat), --filter SUBSTRING
+ * (of the name), --threads N (for the threaded cases).
+ */
+#ifndef SCIPY_NATIVE_BENCH_H
+#define SCIPY_NATIVE_BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define BENCH_HAVE_PERF 1
+#endif
+
+namespace bench {
+
+struct options {
+    int repeat;
+    double min_time;
+    std::string filter;
+    int threads;
+
+    options() : repeat(7), min_time(0.05), threads(4) {}
+};
+
+inline options parse_options(int argc, char **argv)
+{
+    options opts;
+
+    for (int k = 1; k < argc; ++k) {
+        const bool has_value = k + 1 < argc;
+        if (!strcmp(argv[k], "--repeat") && has_value) {
+            opts.repeat = std::max(1, atoi(argv[++k]));
+        }
+        else if (!strcmp(argv[k], "--min-time") && has_value) {
+            opts.min_time = atof(argv[++k]);
+        }
+        else if (!strcmp(argv[k], "--filter") && has_value) {
+            opts.filter = argv[++k];
+        }
+        else if (!strcmp(argv[k], "--threads") && has_value) {
+            opts.threads = std::max(1, atoi(argv[++k]));
+        }
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[k]);
+            exit(2);
+        }
+    }
+    return opts;
+}
+
+
+/*
+ * Hardware counters of the calling thread and of the threads it starts
+ * while counting; workers of persistent pools started earlier are missed
+ */
+class counters {
+public:
+    static const int n_events = 4;
+
+    counters() : n_open_(0)
+    {
+#ifdef BENCH_HAVE_PERF
+        static const unsigned long long configs[n_events] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+        };
+        for (int k = 0; k < n_events; ++k) {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[k];
+            attr.disabled = 1;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fds_[k] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+            if (fds_[k] == -1) {
+                /* not permitted, or no PMU as in most virtual machines */
+                close_all();
+                return;
+            }
+            ++n_open_;
+        }
+#endif
+    }
+
+    ~counters() { close_all(); }
+
+    bool available() const { return n_open_ == n_events; }
+
+    static const char *name(int k)
+    {
+        static const char *names[n_events] = {
+            "cycles", "instructions", "cache_misses", "branch_misses"
+        };
+        return names[k];
+    }
+
+    void start()
+    {
+#ifdef BENCH_HAVE_PERF
+        for (int k = 0; k < n_open_; ++k) {
+            ioctl(fds_[k], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fds_[k], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    void stop(double values[n_events])
+    {
+        for (int k = 0; k < n_events; ++k) {
+            values[k] = 0;
+        }
+#ifdef BENCH_HAVE_PERF
+        for (int k = 0; k < n_open_; ++k) {
+            unsigned long long v = 0;
+            ioctl(fds_[k], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fds_[k], &v, sizeof(v)) == (ssize_t)sizeof(v)) {
+                values[k] = (double)v;
+            }
+        }
+#endif
+    }
+
+private:
+    void close_all()
+    {
+#ifdef BENCH_HAVE_PERF
+        for (int k = 0; k < n_open_; ++k) {
+            close(fds_[k]);
+        }
+#endif
+        n_open_ = 0;
+    }
+
+    int fds_[n_events];
+    int n_open_;
+};
+
+
+/* The work done by one call, to normalize the time by */
+struct work {
+    const char *unit;   /* "nnz", "point", ... or NULL */
+    double count;
+    double flops;       /* floating point operations, or 0 */
+
+    work(const char *unit_, double count_, double flops_ = 0)
+        : unit(unit_), count(count_), flops(flops_) {}
+};
+
+
+class runner {
+public:
+    explicit runner(const options &opts) : opts_(opts) {}
+
+    const options &opts() const { return opts_; }
+
+    bool selected(const std::string &name) const
+    {
+        return opts_.filter.empty() ||
+               name.find(opts_.filter) != std::string::npos;
+    }
+
+    /*
+     * Times func(), after a first call to warm up, and prints the result.
+     * setup() is called untimed before each repeat, as for kernels which
+     * modify their input.
+     */
+    template <class Func, class Setup>
+    void run(const std::string &name, const std::string &params,
+             const work &w, Func func, Setup setup)
+    {
+        typedef std::chrono::steady_clock clock;
+
+        if (!selected(name)) {
+            return;
+        }
+
+        setup();
+        clock::time_point t0 = clock::now();
+        func();
+        double once = seconds(clock::now() - t0);
+
+        /* calls per repeat, for each repeat to last at least min_time */
+        long number = 1;
+        if (once < opts_.min_time) {
+            number = (long)std::min(1e9, opts_.min_time / std::max(once, 1e-9));
+            number = std::max(1L, number);
+        }
+
+        std::vector<double> times;
+        double sums[counters::n_events] = {0};
+        for (int r = 0; r < opts_.repeat; ++r) {
+            double values[counters::n_events];
+            setup();
+            counters_.start();
+            t0 = clock::now();
+            for (long k = 0; k < number; ++k) {
+                func();
+            }
+            double t = seconds(clock::now() - t0);
+            counters_.stop(values);
+            times.push_back(t / number * 1e9);
+            for (int k = 0; k < counters::n_events; ++k) {
+                sums[k] += values[k] / number;
+            }
+        }
+
+        std::sort(times.begin(), times.end());
+        const double median = times.size() % 2
+            ? times[times.size() / 2]
+            : 0.5 * (times[times.size() / 2 - 1] + times[times.size() / 2]);
+
+        printf("{\"name\": \"%s\", \"params\": \"%s\", \"ns\": %.6g, "
+               "\"ns_min\": %.6g, \"repeat\": %d, \"number\": %ld",
+               name.c_str(), params.c_str(), median, times[0],
+               opts_.repeat, number);
+        if (w.unit != NULL && w.count > 0) {
+            printf(", \"per\": {\"%s\": %.6g}", w.unit, median / w.count);
+        }
+        if (w.flops > 0) {
+            printf(", \"gflops\": %.6g", w.flops / median);
+        }
+        if (counters_.available()) {
+            printf(", \"counters\": {");
+            for (int k = 0; k < counters::n_events; ++k) {
+                printf("%s\"%s\": %.6g", k ? ", " : "", counters::name(k),
+                       sums[k] / opts_.repeat);
+            }
+            printf("}");
+        }
+        printf("}\n");
+        fflush(stdout);
+    }
+
+    template <class Func>
+    void run(const std::string &name, const std::string &params,
+             const work &w, Func func)
+    {
+        run(name, params, w, func, [] {});
+    }
+
+private:
+    template <class Duration>
+    static double seconds(Duration d)
+    {
+        return std::chrono::duration<double>(d).count();
+    }
+
+    options opts_;
+    counters counters_;
+};
+
+
+/* "key=value,key=value" parameter strings */
+inline std::string param(const char *key, double value)
+{
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%s=%g", key, value);
+    return buf;
+}
+
+inline std::string param(const char *key, const char *value)
+{
+    return std::string(key) + "=" + value;
+}
+
+inline std::string params(const std::vector<std::string> &items)
+{
+    std::string s;
+    for (size_t k = 0; k < items.size(); ++k) {
+        s += (k ? "," : "") + items[k];
+    }
+    return s;
+}
+
+
+/* Keeps the compiler from optimizing away the result of a kernel */
+template <class T>
+inline void do_not_optimize(const T &value)
+{
+#if defined(__GNUC__)
+    __asm__ __volatile__("" : : "g"(&value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+}
+
+
+/* Reproducible uniform [0, 1) numbers, the same on every platform */
+class random {
+public:
+    explicit random(unsigned long long seed) : state_(seed * 2 + 1) {}
+
+    unsigned long long next()
+    {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 7;
+        state_ ^= state_ << 17;
+        return state_;
+    }
+
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    long below(long n) { return (long)(next() % (unsigned long long)n); }
+
+private:
+    unsigned long long state_;
+};
+
+} // namespace bench
+
+#endif
@@ -0,0 +1,225 @@
+/*
+ * Native benchmarks of the cKDTree kernels
+ *
+ * The counterparts of the Build, Query and CNeighbors suites of
+ * benchmarks/spatial.py, calling build.cxx, query.cxx and
+ * count_neighbors.cxx directly. The tree is set up here the way
+ * ckdtree.pyx does it.
+ */
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "ckdtree_decl.h"
+
+#include "bench.h"
+
+typedef ckdtree_intp_t intp;
+
+/* A cKDTree over n points of m dimensions, with the arrays it points to */
+class tree {
+public:
+    tree(const std::vector<double> &data, intp m, intp leafsize,
+         int n_jobs = 1)
+        : data_(data), maxes_(m), mins_(m)
+    {
+        const intp n = (intp)data.size() / m;
+
+        memset(&self_, 0, sizeof(self_));
+        self_.raw_data = &data_[0];
+        self_.n = n;
+        self_.m = m;
+        self_.leafsize = leafsize;
+
+        for (intp j = 0; j < m; ++j) {
+            maxes_[j] = -std::numeric_limits<double>::infinity();
+            mins_[j] = std::numeric_limits<double>::infinity();
+        }
+        for (intp i = 0; i < n; ++i) {
+            for (intp j = 0; j < m; ++j) {
+                maxes_[j] = std::max(maxes_[j], data_[i * m + j]);
+                mins_[j] = std::min(mins_[j], data_[i * m + j]);
+            }
+        }
+        self_.raw_maxes = &maxes_[0];
+        self_.raw_mins = &mins_[0];
+        build(n_jobs);
+    }
+
+    ~tree()
+    {
+        delete self_.tree_buffer;
+        delete self_.hot_buffer;
+    }
+
+    /* (Re)builds the tree, as cKDTree.__init__ */
+    void build(int n_jobs)
+    {
+        const intp n = self_.n;
+        std::vector<double> tmpmaxes(maxes_), tmpmins(mins_);
+
+        indices_.resize(n);
+        for (intp i = 0; i < n; ++i) {
+            indices_[i] = i;
+        }
+        self_.raw_indices = &indices_[0];
+
+        delete self_.tree_buffer;
+        self_.tree_buffer = new std::vector<ckdtreenode>();
+        build_ckdtree(&self_, 0, n, &tmpmaxes[0], &tmpmins[0], 1, 1, n_jobs);
+
+        /* as _post_init */
+        self_.ctree = &self_.tree_buffer->front();
+        self_.size = (intp)self_.tree_buffer->size();
+        for (intp k = 0; k < self_.size; ++k) {
+            ckdtreenode &node = self_.ctree[k];
+            if (node.split_dim == -1) {
+                node.less = NULL;
+                node.greater = NULL;
+            }
+            else {
+                node.less = self_.ctree + node._less;
+                node.greater = self_.ctree + node._greater;
+            }
+        }
+        if (self_.hot_buffer == NULL) {
+            self_.hot_buffer = new std::vector<ckdtreehotnode>();
+        }
+        build_hot_nodes(&self_);
+    }
+
+    const ckdtree *get() const { return &self_; }
+
+private:
+    tree(const tree &);
+    tree &operator=(const tree &);
+
+    ckdtree self_;
+    std::vector<double> data_, maxes_, mins_;
+    std::vector<intp> indices_;
+};
+
+/* n points of m uniform [0, 1) coordinates */
+static std::vector<double> uniform_points(intp n, intp m,
+                                          unsigned long long seed)
+{
+    bench::random rng(seed);
+    std::vector<double> v((size_t)n * m);
+    for (size_t k = 0; k < v.size(); ++k) {
+        v[k] = rng.uniform();
+    }
+    return v;
+}
+
+static std::string mn(intp m, intp n)
+{
+    return bench::params({bench::param("m", (double)m),
+                          bench::param("n", (double)n)});
+}
+
+
+static void bench_build(bench::runner &b, intp m, intp n)
+{
+    if (!b.selected("ckdtree_build")) {
+        return;
+    }
+    tree t(uniform_points(n, m, 1234), m, 16);
+
+    b.run("ckdtree_build", mn(m, n), bench::work("point", n), [&] {
+        t.build(1);
+    });
+
+    const int workers = b.opts().threads;
+    b.run("ckdtree_build",
+          bench::params({mn(m, n), bench::param("threads", workers)}),
+          bench::work("point", n), [&] {
+        t.build(workers);
+    });
+}
+
+static void bench_query(bench::runner &b, intp m, intp n, intp r, intp k,
+                        double p)
+{
+    if (!b.selected("ckdtree_query")) {
+        return;
+    }
+    tree t(uniform_points(n, m, 1234), m, 16);
+    const std::vector<double> x = uniform_points(r, m, 5678);
+    std::vector<double> dd((size_t)r * k);
+    std::vector<intp> ii((size_t)r * k), kk(k);
+    for (intp j = 0; j < k; ++j) {
+        kk[j] = j + 1;
+    }
+    const std::string params = bench::params({
+        mn(m, n), bench::param("r", (double)r), bench::param("k", (double)k),
+        bench::param("p", p)});
+
+    intp n_capped = 0;
+    auto query = [&](int workers) {
+        return [&, workers] {
+            query_knn(t.get(), &dd[0], &ii[0], &x[0], r, &kk[0], k, k, 0.0,
+                      p, std::numeric_limits<double>::infinity(), 0,
+                      &n_capped, 0, workers);
+            bench::do_not_optimize(dd[0]);
+        };
+    };
+
+    const int workers = b.opts().threads;
+    b.run("ckdtree_query", params, bench::work("point", r), query(1));
+    b.run("ckdtree_query",
+          bench::params({params, bench::param("threads", workers)}),
+          bench::work("point", r), query(workers));
+}
+
+static void bench_count_neighbors(bench::runner &b, intp m, intp n1,
+                                  intp n2, intp nr)
+{
+    if (!b.selected("ckdtree_count_neighbors")) {
+        return;
+    }
+    tree t1(uniform_points(n1, m, 1234), m, 8);
+    tree t2(uniform_points(n2, m, 5678), m, 8);
+    std::vector<double> r(nr);
+    std::vector<intp> results(nr);
+    for (intp k = 0; k < nr; ++k) {
+        r[k] = std::sqrt((double)m) * (k + 1) / nr;
+    }
+    const std::string params = bench::params({
+        bench::param("m", (double)m), bench::param("n1", (double)n1),
+        bench::param("n2", (double)n2), bench::param("nr", (double)nr)});
+
+    b.run("ckdtree_count_neighbors", params, bench::work("point", n2), [&] {
+        count_neighbors_unweighted(t1.get(), t2.get(), nr, &r[0],
+                                   &results[0], 2.0, 1, 1);
+        bench::do_not_optimize(results[0]);
+    }, [&] {
+        std::fill(results.begin(), results.end(), 0);
+    });
+}
+
+
+int main(int argc, char **argv)
+{
+    bench::runner b(bench::parse_options(argc, argv));
+    const intp dims[] = {3, 8, 16};
+    const double inf = std::numeric_limits<double>::infinity();
+
+    for (intp m : dims) {
+        bench_build(b, m, 10000);
+    }
+    bench_build(b, 3, 1000000);
+
+    for (intp m : dims) {
+        bench_query(b, m, 10000, 1000, 1, 2.0);
+    }
+    bench_query(b, 3, 100000, 100000, 1, 2.0);
+    bench_query(b, 3, 100000, 100000, 1, 1.0);
+    bench_query(b, 3, 100000, 100000, 1, inf);
+    bench_query(b, 3, 100000, 100000, 8, 2.0);
+
+    for (intp m : {(intp)2, (intp)8, (intp)16}) {
+        bench_count_neighbors(b, m, 1000, 1000, 100);
+    }
+
+    return 0;
+}
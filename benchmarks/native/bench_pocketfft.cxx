@@ -0,0 +1,137 @@
+/*
+ * Native benchmarks of the pocketfft kernels
+ *
+ * The counterparts of the Fft, RFft and FftN suites of
+ * benchmarks/fft_basic.py, calling pocketfft_hdronly.h directly. The
+ * operation counts are the usual nominal ones, 5 n log2(n) for a complex
+ * and half of that for a real transform of size n.
+ */
+#include <cmath>
+#include <complex>
+
+#include "pocketfft_hdronly.h"
+
+#include "bench.h"
+
+using pocketfft::shape_t;
+using pocketfft::stride_t;
+
+static double nominal_flops(const shape_t &shape)
+{
+    double n = 1;
+    for (size_t k = 0; k < shape.size(); ++k) {
+        n *= shape[k];
+    }
+    return 5 * n * std::log2(n);
+}
+
+static std::string shape_param(const shape_t &shape)
+{
+    std::string s = "shape=";
+    for (size_t k = 0; k < shape.size(); ++k) {
+        s += (k ? "x" : "") + std::to_string(shape[k]);
+    }
+    return s;
+}
+
+static stride_t strides(const shape_t &shape, size_t itemsize)
+{
+    stride_t s(shape.size());
+    ptrdiff_t stride = itemsize;
+    for (size_t k = shape.size(); k-- > 0; ) {
+        s[k] = stride;
+        stride *= shape[k];
+    }
+    return s;
+}
+
+static void bench_c2c(bench::runner &b, const shape_t &shape, size_t nthreads)
+{
+    typedef std::complex<double> cmplx;
+    size_t n = 1;
+    shape_t axes;
+    for (size_t k = 0; k < shape.size(); ++k) {
+        n *= shape[k];
+        axes.push_back(k);
+    }
+    bench::random rng(1234);
+    std::vector<cmplx> in(n), out(n);
+    for (size_t k = 0; k < n; ++k) {
+        in[k] = cmplx(rng.uniform(), rng.uniform());
+    }
+    const stride_t s = strides(shape, sizeof(cmplx));
+    std::string params = shape_param(shape);
+    if (nthreads > 1) {
+        params = bench::params({params, bench::param("threads",
+                                                     (double)nthreads)});
+    }
+
+    b.run("c2c", params, bench::work("point", n, nominal_flops(shape)), [&] {
+        pocketfft::c2c(shape, s, s, axes, pocketfft::FORWARD, &in[0],
+                       &out[0], 1.0, nthreads);
+        bench::do_not_optimize(out[0]);
+    });
+}
+
+static void bench_r2c(bench::runner &b, const shape_t &shape, size_t nthreads)
+{
+    typedef std::complex<double> cmplx;
+    size_t n = 1;
+    shape_t axes, shape_out(shape);
+    for (size_t k = 0; k < shape.size(); ++k) {
+        n *= shape[k];
+        axes.push_back(k);
+    }
+    shape_out.back() = shape.back() / 2 + 1;
+    size_t n_out = n / shape.back() * shape_out.back();
+    bench::random rng(1234);
+    std::vector<double> in(n);
+    std::vector<cmplx> out(n_out);
+    for (size_t k = 0; k < n; ++k) {
+        in[k] = rng.uniform();
+    }
+    std::string params = shape_param(shape);
+    if (nthreads > 1) {
+        params = bench::params({params, bench::param("threads",
+                                                     (double)nthreads)});
+    }
+
+    b.run("r2c", params, bench::work("point", n, nominal_flops(shape) / 2),
+          [&] {
+        pocketfft::r2c(shape, strides(shape, sizeof(double)),
+                       strides(shape_out, sizeof(cmplx)), axes,
+                       pocketfft::FORWARD, &in[0], &out[0], 1.0, nthreads);
+        bench::do_not_optimize(out[0]);
+    });
+}
+
+
+int main(int argc, char **argv)
+{
+    bench::runner b(bench::parse_options(argc, argv));
+    const size_t nthreads = b.opts().threads;
+
+    /* powers of 2, of small primes, and a large prime (Bluestein) */
+    const size_t sizes[] = {64, 1024, 65536, 1000, 3 * 5 * 7 * 11 * 13,
+                            10007};
+
+    for (size_t n : sizes) {
+        bench_c2c(b, shape_t(1, n), 1);
+    }
+    for (size_t n : sizes) {
+        bench_r2c(b, shape_t(1, n), 1);
+    }
+
+    const shape_t square = {512, 512};
+    const shape_t cube = {64, 64, 64};
+    bench_c2c(b, square, 1);
+    bench_c2c(b, cube, 1);
+    bench_r2c(b, square, 1);
+    if (nthreads > 1) {
+        bench_c2c(b, square, nthreads);
+        bench_c2c(b, cube, nthreads);
+        bench_r2c(b, square, nthreads);
+    }
+
+    return 0;
+}
@@ -0,0 +1,240 @@
+/*
+ * Native benchmarks of the sparsetools kernels
+ *
+ * The counterparts of the Matvec, Matvecs, Matmul and Conversion suites
+ * of benchmarks/sparse.py, calling csr.h and bsr.h directly on int32
+ * indices and float64 values.
+ */
+#include <Python.h>
+#include "numpy/arrayobject.h"
+
+#include "complex_ops.h"
+#include "csr.h"
+#include "bsr.h"
+
+#include "bench.h"
+
+typedef npy_int32 I;
+
+struct csr {
+    I n_row, n_col;
+    std::vector<I> p, j;
+    std::vector<double> x;
+
+    I nnz() const { return p[n_row]; }
+};
+
+/* The 5-point Poisson matrix on an n by n grid, as poisson2d(n) */
+static csr poisson2d(I n)
+{
+    csr A;
+    A.n_row = A.n_col = n * n;
+    A.p.push_back(0);
+    for (I r = 0; r < n; ++r) {
+        for (I c = 0; c < n; ++c) {
+            const I i = r * n + c;
+            const I cols[5] = {i - n, i - 1, i, i + 1, i + n};
+            const bool ok[5] = {r > 0, c > 0, true, c < n - 1, r < n - 1};
+            for (int k = 0; k < 5; ++k) {
+                if (ok[k]) {
+                    A.j.push_back(cols[k]);
+                    A.x.push_back(cols[k] == i ? 4.0 : -1.0);
+                }
+            }
+            A.p.push_back((I)A.j.size());
+        }
+    }
+    return A;
+}
+
+/* An n by n matrix with nnz_per_row entries at random columns per row */
+static csr random_matrix(I n, I nnz_per_row, unsigned long long seed)
+{
+    bench::random rng(seed);
+    csr A;
+    A.n_row = A.n_col = n;
+    A.p.push_back(0);
+    for (I i = 0; i < n; ++i) {
+        const size_t start = A.j.size();
+        for (I k = 0; k < nnz_per_row; ++k) {
+            A.j.push_back((I)rng.below(n));
+            A.x.push_back(rng.uniform());
+        }
+        std::sort(A.j.begin() + start, A.j.end());
+        A.p.push_back((I)A.j.size());
+    }
+    return A;
+}
+
+/* The pattern of A with R by C blocks of ones, as kron(A, ones((R, C))) */
+static csr block_values(const csr &A, I R, I C)
+{
+    csr B = A;
+    B.x.assign((size_t)A.nnz() * R * C, 1.0);
+    return B;
+}
+
+static std::vector<double> random_vector(size_t n, unsigned long long seed)
+{
+    bench::random rng(seed);
+    std::vector<double> v(n);
+    for (size_t k = 0; k < n; ++k) {
+        v[k] = rng.uniform();
+    }
+    return v;
+}
+
+struct named_matrix {
+    std::string params;
+    csr A;
+};
+
+
+static void bench_matvec(bench::runner &b, const named_matrix &m)
+{
+    const csr &A = m.A;
+    std::vector<double> x = random_vector(A.n_col, 1), y(A.n_row);
+    const bench::work w("nnz", A.nnz(), 2.0 * A.nnz());
+
+    b.run("csr_matvec", m.params, w, [&] {
+        csr_matvec(A.n_row, A.n_col, &A.p[0], &A.j[0], &A.x[0], &x[0],
+                   &y[0]);
+        bench::do_not_optimize(y[0]);
+    });
+
+    const I workers = b.opts().threads;
+    b.run("csr_matvec_threaded",
+          bench::params({m.params, bench::param("threads", workers)}), w,
+          [&] {
+        csr_matvec_threaded(A.n_row, A.n_col, &A.p[0], &A.j[0], &A.x[0],
+                            &x[0], &y[0], workers);
+        bench::do_not_optimize(y[0]);
+    });
+}
+
+static void bench_matvecs(bench::runner &b, const named_matrix &m,
+                          I n_vecs)
+{
+    const csr &A = m.A;
+    std::vector<double> x = random_vector((size_t)A.n_col * n_vecs, 1);
+    std::vector<double> y((size_t)A.n_row * n_vecs);
+    const bench::work w("nnz", (double)A.nnz() * n_vecs,
+                        2.0 * A.nnz() * n_vecs);
+    const std::string params =
+        bench::params({m.params, bench::param("n_vecs", n_vecs)});
+
+    b.run("csr_matvecs", params, w, [&] {
+        csr_matvecs(A.n_row, A.n_col, n_vecs, &A.p[0], &A.j[0], &A.x[0],
+                    &x[0], &y[0]);
+        bench::do_not_optimize(y[0]);
+    });
+}
+
+static void bench_bsr_matvec(bench::runner &b, I n, I R)
+{
+    const csr A = block_values(poisson2d(n), R, R);
+    std::vector<double> x = random_vector((size_t)A.n_col * R, 1);
+    std::vector<double> y((size_t)A.n_row * R);
+    const double nnz = (double)A.nnz() * R * R;
+    const bench::work w("nnz", nnz, 2.0 * nnz);
+    const std::string params = bench::params({
+        bench::param("matrix", "poisson2d"), bench::param("n", n),
+        bench::param("blocksize", R)});
+
+    b.run("bsr_matvec", params, w, [&] {
+        bsr_matvec(A.n_row, A.n_col, R, R, &A.p[0], &A.j[0], &A.x[0], &x[0],
+                   &y[0]);
+        bench::do_not_optimize(y[0]);
+    });
+}
+
+static void bench_matmat(bench::runner &b, const named_matrix &m)
+{
+    const csr &A = m.A;
+    std::vector<npy_intp> flops(A.n_row + 1);
+    csr_matmat_flops(A.n_row, &A.p[0], &A.j[0], &A.p[0], &flops[0]);
+    const double madds = (double)flops[A.n_row];
+    const bench::work w("madd", madds, 2.0 * madds);
+
+    std::vector<I> Cp(A.n_row + 1), Cj;
+    std::vector<double> Cx;
+    csr_matmat_pass1(A.n_row, A.n_col, &A.p[0], &A.j[0], &A.p[0], &A.j[0],
+                     &Cp[0]);
+    Cj.resize(Cp[A.n_row] > 0 ? Cp[A.n_row] : 1);
+    Cx.resize(Cj.size());
+
+    b.run("csr_matmat", m.params, w, [&] {
+        csr_matmat_pass1(A.n_row, A.n_col, &A.p[0], &A.j[0], &A.p[0],
+                         &A.j[0], &Cp[0]);
+        csr_matmat_pass2(A.n_row, A.n_col, &A.p[0], &A.j[0], &A.x[0],
+                         &A.p[0], &A.j[0], &A.x[0], &Cp[0], &Cj[0], &Cx[0]);
+        bench::do_not_optimize(Cx[0]);
+    });
+
+    const I workers = b.opts().threads;
+    b.run("csr_matmat_threaded",
+          bench::params({m.params, bench::param("threads", workers)}), w,
+          [&] {
+        csr_matmat_pass1_threaded(A.n_row, A.n_col, &A.p[0], &A.j[0],
+                                  &A.p[0], &A.j[0], &Cp[0], workers);
+        csr_matmat_pass2_threaded(A.n_row, A.n_col, &A.p[0], &A.j[0],
+                                  &A.x[0], &A.p[0], &A.j[0], &A.x[0],
+                                  &Cp[0], &Cj[0], &Cx[0], workers);
+        bench::do_not_optimize(Cx[0]);
+    });
+}
+
+static void bench_tocsc(bench::runner &b, const named_matrix &m)
+{
+    const csr &A = m.A;
+    std::vector<I> Bp(A.n_col + 1), Bi(A.nnz());
+    std::vector<double> Bx(A.nnz());
+    const bench::work w("nnz", A.nnz());
+
+    b.run("csr_tocsc", m.params, w, [&] {
+        csr_tocsc(A.n_row, A.n_col, &A.p[0], &A.j[0], &A.x[0], &Bp[0],
+                  &Bi[0], &Bx[0]);
+        bench::do_not_optimize(Bx[0]);
+    });
+
+    const I workers = b.opts().threads;
+    b.run("csr_tocsc_threaded",
+          bench::params({m.params, bench::param("threads", workers)}), w,
+          [&] {
+        csr_tocsc_threaded(A.n_row, A.n_col, &A.p[0], &A.j[0], &A.x[0],
+                           &Bp[0], &Bi[0], &Bx[0], workers);
+        bench::do_not_optimize(Bx[0]);
+    });
+}
+
+
+int main(int argc, char **argv)
+{
+    bench::runner b(bench::parse_options(argc, argv));
+
+    const named_matrix poisson_small = {
+        bench::params({bench::param("matrix", "poisson2d"),
+                       bench::param("n", 100)}),
+        poisson2d(100)};
+    const named_matrix poisson = {
+        bench::params({bench::param("matrix", "poisson2d"),
+                       bench::param("n", 300)}),
+        poisson2d(300)};
+    const named_matrix random_sparse = {
+        bench::params({bench::param("matrix", "random"),
+                       bench::param("n", 200000),
+                       bench::param("nnz_per_row", 16)}),
+        random_matrix(200000, 16, 1234)};
+
+    bench_matvec(b, poisson);
+    bench_matvec(b, random_sparse);
+    bench_matvecs(b, poisson, 10);
+    bench_bsr_matvec(b, 150, 2);
+    bench_bsr_matvec(b, 100, 3);
+    bench_bsr_matvec(b, 75, 4);
+    bench_matmat(b, poisson);
+    bench_tocsc(b, poisson_small);
+    bench_tocsc(b, random_sparse);
+
+    return 0;
+}
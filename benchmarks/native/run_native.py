@@ -0,0 +1,239 @@
+#!/usr/bin/env python
+"""
+run_native.py [run|compare] [options]
+
+Builds and runs the native benchmarks of the sparsetools, cKDTree and
+pocketfft kernels, which call the C++ code directly without the Python
+layer, or compares two sets of results.
+
+Run all benchmarks and save the results::
+
+    python run_native.py run -o before.json
+
+Only the matrix-vector products, with 8 threads for the threaded cases::
+
+    python run_native.py run --filter matvec --threads 8
+
+Compare two result files, flagging changes by a factor above 1.05::
+
+    python run_native.py compare before.json after.json --factor 1.05
+
+The benchmarks are built with the C++ compiler in $CXX (default: that of
+the Python build, else ``c++``) and the flags in $CXXFLAGS (default:
+``-O2``), against the sources of the checked out tree and the NumPy
+headers of the running Python.
+
+"""
+from __future__ import division, absolute_import, print_function
+
+import os
+import sys
+import json
+import shlex
+import argparse
+import platform
+import subprocess
+import sysconfig
+
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), '..', '..'))
+HERE = os.path.abspath(os.path.dirname(__file__))
+
+SPARSETOOLS = os.path.join(ROOT, 'scipy', 'sparse', 'sparsetools')
+CKDTREE = os.path.join(ROOT, 'scipy', 'spatial', 'ckdtree', 'src')
+POCKETFFT = os.path.join(ROOT, 'scipy', 'fft', '_pocketfft')
+
+# The kernel sources are those of the extensions in the setup.py files
+CKDTREE_SOURCES = ['query.cxx', 'build.cxx', 'query_pairs.cxx',
+                   'count_neighbors.cxx', 'query_ball_point.cxx',
+                   'query_ball_tree.cxx', 'sparse_distances.cxx',
+                   'thread_pool.cxx']
+
+PROGRAMS = {
+    'sparsetools': dict(
+        sources=['bench_sparsetools.cxx'],
+        include_dirs=[SPARSETOOLS],
+        python=True),
+    'ckdtree': dict(
+        sources=(['bench_ckdtree.cxx'] +
+                 [os.path.join(CKDTREE, x) for x in CKDTREE_SOURCES]),
+        include_dirs=[CKDTREE, os.path.join(ROOT, 'scipy', '_lib')],
+        python=False),
+    'pocketfft': dict(
+        sources=['bench_pocketfft.cxx'],
+        include_dirs=[POCKETFFT],
+        define_macros=['POCKETFFT_PTHREADS'],
+        python=False),
+}
+
+
+def get_compiler():
+    cxx = os.environ.get('CXX') or sysconfig.get_config_var('CXX') or 'c++'
+    flags = shlex.split(os.environ.get('CXXFLAGS', '-O2'))
+    return shlex.split(cxx), flags
+
+
+def build(name, build_dir):
+    import numpy as np
+
+    program = PROGRAMS[name]
+    cxx, flags = get_compiler()
+    include_dirs = [HERE, np.get_include()] + program['include_dirs']
+    if program['python']:
+        include_dirs.append(sysconfig.get_paths()['include'])
+
+    exe = os.path.join(build_dir, 'bench_' + name)
+    cmd = (cxx + flags + ['-std=c++11', '-pthread'] +
+           ['-I' + d for d in include_dirs] +
+           ['-D' + m for m in program.get('define_macros', [])] +
+           [os.path.join(HERE, s) for s in program['sources']] +
+           ['-o', exe, '-lm'])
+
+    if not os.path.isdir(build_dir):
+        os.makedirs(build_dir)
+    print("Building %s" % exe, file=sys.stderr)
+    subprocess.check_call(cmd)
+    return exe
+
+
+def git_commit():
+    try:
+        out = subprocess.check_output(['git', 'rev-parse', 'HEAD'], cwd=ROOT)
+        return out.decode('ascii').strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def compiler_version(cxx):
+    try:
+        out = subprocess.check_output(cxx + ['--version'],
+                                      stderr=subprocess.STDOUT)
+        return out.decode('utf-8', 'replace').splitlines()[0]
+    except (OSError, subprocess.CalledProcessError, IndexError):
+        return None
+
+
+def key(result):
+    return '%s(%s)' % (result['name'], result['params'])
+
+
+def format_result(r):
+    s = '%-24s %-50s %12.4g ns' % (r['name'], r['params'], r['ns'])
+    for unit, ns in sorted(r.get('per', {}).items()):
+        s += '  %9.4g ns/%s' % (ns, unit)
+    if 'gflops' in r:
+        s += '  %7.3g GFLOP/s' % r['gflops']
+    if 'counters' in r and r['counters'].get('cycles'):
+        c = r['counters']
+        s += '  IPC %.2f' % (c['instructions'] / c['cycles'])
+    return s
+
+
+def run(args):
+    cxx, flags = get_compiler()
+    names = args.programs or sorted(PROGRAMS)
+    options = ['--repeat', str(args.repeat),
+               '--min-time', str(args.min_time),
+               '--threads', str(args.threads)]
+    if args.filter:
+        options += ['--filter', args.filter]
+
+    results = []
+    for name in names:
+        exe = build(name, args.build_dir)
+        proc = subprocess.Popen([exe] + options, stdout=subprocess.PIPE)
+        for line in proc.stdout:
+            r = json.loads(line.decode('utf-8'))
+            r['program'] = name
+            results.append(r)
+            print(format_result(r))
+            sys.stdout.flush()
+        if proc.wait() != 0:
+            print("%s failed with status %d" % (exe, proc.returncode),
+                  file=sys.stderr)
+            return 1
+
+    if args.output:
+        data = dict(commit=git_commit(),
+                    machine=platform.node(),
+                    platform=platform.platform(),
+                    cpu_count=os.cpu_count() if hasattr(os, 'cpu_count') else None,
+                    compiler=compiler_version(cxx),
+                    flags=flags,
+                    options=dict(repeat=args.repeat, min_time=args.min_time,
+                                 threads=args.threads),
+                    results=results)
+        with open(args.output, 'w') as f:
+            json.dump(data, f, indent=1, sort_keys=True)
+    return 0
+
+
+def compare(args):
+    with open(args.old) as f:
+        old = dict((key(r), r) for r in json.load(f)['results'])
+    with open(args.new) as f:
+        new = json.load(f)['results']
+
+    # as asv compare: + for slower, - for faster, by more than factor
+    status = 0
+    print('%-2s %12s %12s %8s  %s' % ('', 'before', 'after', 'ratio',
+                                      'benchmark'))
+    for r in new:
+        k = key(r)
+        if k not in old:
+            continue
+        ratio = r['ns'] / old[k]['ns']
+        mark = ''
+        if ratio > args.factor:
+            mark = '+'
+            status = 1
+        elif ratio < 1 / args.factor:
+            mark = '-'
+        print('%-2s %9.4g ns %9.4g ns %8.2f  %s' % (mark, old[k]['ns'],
+                                                    r['ns'], ratio, k))
+    return status if args.strict else 0
+
+
+def main():
+    p = argparse.ArgumentParser(usage=__doc__.strip())
+    sub = p.add_subparsers(dest='command')
+
+    p_run = sub.add_parser('run', help="build and run the benchmarks")
+    p_run.add_argument('programs', nargs='*',
+                       help="benchmark programs to run, of %s (default: all)"
+                       % ", ".join(sorted(PROGRAMS)))
+    p_run.add_argument('--filter', default=None,
+                       help="only run the kernels whose name contains this")
+    p_run.add_argument('--repeat', type=int, default=7,
+                       help="timings per case, the median is reported")
+    p_run.add_argument('--min-time', type=float, default=0.05,
+                       help="minimum duration of a timing, in seconds")
+    p_run.add_argument('--threads', type=int, default=4,
+                       help="threads of the threaded cases")
+    p_run.add_argument('--build-dir',
+                       default=os.path.join(ROOT, 'build', 'native-bench'))
+    p_run.add_argument('-o', '--output', default=None,
+                       help="JSON file to write the results to")
+
+    p_cmp = sub.add_parser('compare', help="compare two result files")
+    p_cmp.add_argument('old')
+    p_cmp.add_argument('new')
+    p_cmp.add_argument('--factor', type=float, default=1.1,
+                       help="ratio of times to report as a change")
+    p_cmp.add_argument('--strict', action='store_true',
+                       help="exit with status 1 if anything got slower")
+
+    args = p.parse_args()
+    if args.command == 'run':
+        for name in args.programs:
+            if name not in PROGRAMS:
+                p.error("unknown benchmark program %r" % name)
+        sys.exit(run(args))
+    elif args.command == 'compare':
+        sys.exit(compare(args))
+    p.print_help()
+    sys.exit(2)
+
+
+if __name__ == '__main__':
+    main()
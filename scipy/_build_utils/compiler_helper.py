@@ -0,0 +1,94 @@
+"""
+Helpers for detection of compiler features
+"""
+import tempfile
+import os
+import sys
+
+
+def try_compile(compiler, code=None, flags=[], ext='.cpp'):
+    """Returns True if the compiler is able to compile the given code"""
+    from distutils.errors import CompileError
+
+    code = code or 'int main (int argc, char **argv) { return 0; }'
+
+    with tempfile.TemporaryDirectory() as temp_dir:
+        fname = os.path.join(temp_dir, 'main'+ext)
+        with open(fname, 'w') as f:
+            f.write(code)
+
+        try:
+            compiler.compile([fname], extra_postargs=flags)
+        except CompileError:
+            return False
+    return True
+
+
+def has_flag(compiler, flag):
+    return try_compile(compiler, flags=[flag])
+
+
+def get_cxx_std_flag(compiler):
+    """Detects compiler flag for c++14, c++11, or None if not detected"""
+    # GNU C compiler documentation uses single dash:
+    #    https://gcc.gnu.org/onlinedocs/gcc/Standards.html
+    # but silently understands two dashes, like --std=c++11 too.
+    # Other GCC compatible compilers, like Intel C Compiler on Linux do not.
+    gnu_flags = ['-std=c++14', '-std=c++11']
+    flags_by_cc = {
+        'msvc': ['/std:c++14', None],
+        'intelw': ['/Qstd=c++14', '/Qstd=c++11']
+    }
+    flags = flags_by_cc.get(compiler.compiler_type, gnu_flags)
+
+    for flag in flags:
+        if flag is None:
+            return None
+
+        if has_flag(compiler, flag):
+            return flag
+
+    from numpy.distutils import log
+    log.warn('Could not detect c++ standard flag')
+    return None
+
+
+def try_add_flag(args, compiler, flag):
+    """Appends flag to the list of arguments if supported by the compiler"""
+    if try_compile(compiler, flags=args+[flag]):
+        args.append(flag)
+
+
+def set_cxx_flags_hook(build_ext, ext):
+    """Sets basic compiler flags for compiling C++11 code"""
+    cc = build_ext._cxx_compiler
+    args = ext.extra_compile_args
+
+    std_flag = get_cxx_std_flag(cc)
+    if std_flag is not None:
+        args.append(std_flag)
+
+    if cc.compiler_type == 'msvc':
+        args.append('/EHsc')
+    elif sys.platform == 'darwin':
+        args.append('-mmacosx-version-min=10.7')
+        try_add_flag(args, cc, '-stdlib=libc++')
+
+
+def set_cxx_threads_flags_hook(build_ext, ext):
+    """Sets compiler and linker flags for C++11 code using std::thread"""
+    set_cxx_flags_hook(build_ext, ext)
+
+    cc = build_ext._cxx_compiler
+    if cc.compiler_type != 'msvc' and has_flag(cc, '-pthread'):
+        ext.extra_compile_args.append('-pthread')
+        ext.extra_link_args.append('-pthread')
+
+
+def set_c_threads_flags_hook(build_ext, ext):
+    """Sets compiler and linker flags for C code using pthreads"""
+    cc = build_ext.compiler
+    if (cc.compiler_type != 'msvc' and
+            try_compile(cc, flags=['-pthread'], ext='.c')):
+        ext.extra_compile_args.append('-pthread')
+        ext.extra_link_args.append('-pthread')
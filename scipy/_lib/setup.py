@@ -19,7 +19,8 @@ def configuration(parent_package='',top_path=None):
 
     config.add_extension("_test_ccallback",
                          sources=["src/_test_ccallback.c"],
-                         depends=depends,
+                         depends=depends + [os.path.join(include_dir,
+                                                         'ccallback_pool.h')],
                          include_dirs=[include_dir])
 
     config.add_extension("_fpumode",
@@ -32,12 +32,16 @@
  * and only safe if there is no memory allocation between setjmp/longjmp (or you
  * need to add additional cleanup yourself).
  *
+ * The *call_batch* function shows how to evaluate a batch callback on several
+ * threads with the pool of ccallback_pool.h.
+ *
  */
 
 #include <setjmp.h>
 #include <Python.h>
 
 #include "ccallback.h"
+#include "ccallback_pool.h"
 
 
 #define ERROR_VALUE 2
@@ -270,6 +274,65 @@ static PyObject *test_call_nonlocal(PyObject *obj, PyObject *args)
 }
 
 
+static ccallback_signature_t batch_signatures[] = {
+    {CCALLBACK_BATCH_SIGNATURE, 0},
+    {NULL}
+};
+
+static PyObject *test_call_batch(PyObject *obj, PyObject *args)
+{
+    PyObject *callback_obj;
+    Py_ssize_t n, k;
+    double start, *x, result = 0;
+    int nthreads, ret;
+    ccallback_t callback;
+
+    if (!PyArg_ParseTuple(args, "Ondi", &callback_obj, &n, &start, &nthreads)) {
+        return NULL;
+    }
+    if (n < 0) {
+        PyErr_SetString(PyExc_ValueError, "n must be nonnegative");
+        return NULL;
+    }
+
+    ret = ccallback_prepare(&callback, batch_signatures, callback_obj, CCALLBACK_DEFAULTS);
+    if (ret != 0) {
+        return NULL;
+    }
+    if (callback.py_function != NULL) {
+        ccallback_release(&callback);
+        PyErr_SetString(PyExc_ValueError, "batch callbacks must be low-level");
+        return NULL;
+    }
+
+    x = (double *)malloc(2 * (n > 0 ? n : 1) * sizeof(double));
+    if (x == NULL) {
+        ccallback_release(&callback);
+        return PyErr_NoMemory();
+    }
+    for (k = 0; k < n; ++k) {
+        x[k] = start + k;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    ret = ccallback_batch_map(&callback, nthreads, x, x + n, n, 1024);
+    Py_END_ALLOW_THREADS
+
+    ccallback_release(&callback);
+
+    for (k = 0; k < n; ++k) {
+        result += x[n + k];
+    }
+    free(x);
+
+    if (ret != 0) {
+        PyErr_SetString(PyExc_ValueError, "ERROR_VALUE encountered!");
+        return NULL;
+    }
+    return PyFloat_FromDouble(result);
+}
+
+
 /*
  * Functions for testing the PyCapsule interface
  */
@@ -344,6 +407,33 @@ static PyObject *test_get_plus1bc_capsule(PyObject *obj, PyObject *args)
 }
 
 
+static char *test_plus1_batch_signature = CCALLBACK_BATCH_SIGNATURE;
+
+
+static int test_plus1_batch_callback(double *x, double *y, intptr_t n, void *user_data)
+{
+    intptr_t k;
+
+    for (k = 0; k < n; ++k) {
+        if (x[k] == ERROR_VALUE) {
+            return -1;
+        }
+        y[k] = x[k] + (user_data == NULL ? 1 : *(double *)user_data);
+    }
+    return 0;
+}
+
+
+static PyObject *test_get_plus1_batch_capsule(PyObject *obj, PyObject *args)
+{
+    if (!PyArg_ParseTuple(args, "")) {
+        return NULL;
+    }
+
+    return PyCapsule_New((void *)test_plus1_batch_callback, test_plus1_batch_signature, NULL);
+}
+
+
 static void data_capsule_destructor(PyObject *capsule)
 {
     void *data;
@@ -378,9 +468,11 @@ static PyMethodDef test_ccallback_methods[] = {
     {"test_call_simple", (PyCFunction)test_call_simple, METH_VARARGS, ""},
     {"test_call_nodata", (PyCFunction)test_call_nodata, METH_VARARGS, ""},
     {"test_call_nonlocal", (PyCFunction)test_call_nonlocal, METH_VARARGS, ""},
+    {"test_call_batch", (PyCFunction)test_call_batch, METH_VARARGS, ""},
     {"test_get_plus1_capsule", (PyCFunction)test_get_plus1_capsule, METH_VARARGS, ""},
     {"test_get_plus1b_capsule", (PyCFunction)test_get_plus1b_capsule, METH_VARARGS, ""},
     {"test_get_plus1bc_capsule", (PyCFunction)test_get_plus1bc_capsule, METH_VARARGS, ""},
+    {"test_get_plus1_batch_capsule", (PyCFunction)test_get_plus1_batch_capsule, METH_VARARGS, ""},
     {"test_get_data_capsule", (PyCFunction)test_get_data_capsule, METH_VARARGS, ""},
     {"test_get_data_capsule", (PyCFunction)test_get_data_capsule, METH_VARARGS, ""},
     {NULL, NULL, 0, NULL}
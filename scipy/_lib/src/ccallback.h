@@ -64,10 +64,15 @@ struct ccallback {
 
 /*
  * Thread-local storage
+ *
+ * CCALLBACK_NATIVE_TLS is defined if ccallback_obtain can be called without
+ * holding the GIL.
  */
 
 #if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && (__GNUC_MINOR__ >= 4)))
 
+#define CCALLBACK_NATIVE_TLS
+
 static __thread ccallback_t *_active_ccallback = NULL;
 
 static void *ccallback__get_thread_local(void)
@@ -91,6 +96,8 @@ static ccallback_t *ccallback_obtain(void)
 
 #elif defined(_MSC_VER)
 
+#define CCALLBACK_NATIVE_TLS
+
 static __declspec(thread) ccallback_t *_active_ccallback = NULL;
 
 static void *ccallback__get_thread_local(void)
@@ -0,0 +1,346 @@
+/*
+ * ccallback_pool
+ *
+ * Batch callbacks and a persistent worker pool for ccallback.h.
+ *
+ * A batch callback evaluates the user function on a whole array at a time,
+ *
+ *     int func(double *x, double *y, intptr_t n, void *user_data)
+ *
+ * filling y[k] = f(x[k]) for 0 <= k < n and returning 0, or nonzero on
+ * error. Consumers accept it by listing CCALLBACK_BATCH_SIGNATURE among
+ * the signatures passed to ccallback_prepare.
+ *
+ * ccallback_pool_run runs a function on several threads of a pool which is
+ * kept between calls, with the thread-local callback of ccallback_obtain
+ * set on each of them, so that thunks written for CCALLBACK_OBTAIN work
+ * unchanged on the workers. As with the threads of ndimage and optimize,
+ * the function must be written such that any one call can do all of the
+ * work, by claiming chunks from a shared counter: the pool gives no
+ * guarantee on how many workers join a run.
+ *
+ * The pool is static, so each extension module including this header has
+ * its own. Python callbacks, and platforms without native thread-local
+ * storage, run on the calling thread only, as does a run started while
+ * the pool is busy with another.
+ *
+ * For an example see `scipy/_lib/src/_test_ccallback.c`.
+ */
+
+
+#ifndef CCALLBACK_POOL_H_
+#define CCALLBACK_POOL_H_
+
+
+#include "ccallback.h"
+
+#include <stdint.h>
+
+
+#define CCALLBACK_BATCH_SIGNATURE "int (double *, double *, intptr_t, void *)"
+
+/* Upper bound on the number of threads of a run */
+#define CCALLBACK_POOL_MAX_THREADS 256
+
+
+typedef int ccallback_batch_func(double *x, double *y, intptr_t n,
+                                 void *user_data);
+typedef void ccallback_pool_func(void *arg);
+
+
+/*
+ * Portable locks, condition variables and detached threads
+ */
+
+#ifdef _WIN32
+
+#include <windows.h>
+#include <process.h>
+
+typedef SRWLOCK ccallback__mutex;
+typedef CONDITION_VARIABLE ccallback__cond;
+
+#define CCALLBACK__MUTEX_INIT SRWLOCK_INIT
+#define CCALLBACK__COND_INIT CONDITION_VARIABLE_INIT
+
+#define ccallback__mutex_init(m) InitializeSRWLock(m)
+#define ccallback__mutex_destroy(m) ((void)(m))
+#define ccallback__mutex_lock(m) AcquireSRWLockExclusive(m)
+#define ccallback__mutex_unlock(m) ReleaseSRWLockExclusive(m)
+#define ccallback__cond_wait(c, m) \
+    SleepConditionVariableSRW(c, m, INFINITE, 0)
+#define ccallback__cond_broadcast(c) WakeAllConditionVariable(c)
+
+#define CCALLBACK__THREAD_RETURN unsigned __stdcall
+
+#else
+
+#include <pthread.h>
+
+typedef pthread_mutex_t ccallback__mutex;
+typedef pthread_cond_t ccallback__cond;
+
+#define CCALLBACK__MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
+#define CCALLBACK__COND_INIT PTHREAD_COND_INITIALIZER
+
+#define ccallback__mutex_init(m) pthread_mutex_init(m, NULL)
+#define ccallback__mutex_destroy(m) pthread_mutex_destroy(m)
+#define ccallback__mutex_lock(m) pthread_mutex_lock(m)
+#define ccallback__mutex_unlock(m) pthread_mutex_unlock(m)
+#define ccallback__cond_wait(c, m) pthread_cond_wait(c, m)
+#define ccallback__cond_broadcast(c) pthread_cond_broadcast(c)
+
+#define CCALLBACK__THREAD_RETURN void *
+
+#endif
+
+
+/*
+ * The pool
+ *
+ * Workers sleep until the generation changes, then join the run if it
+ * still has claims left. The caller takes back the unused claims once its
+ * own call is done, and waits for the workers which joined.
+ */
+
+typedef struct {
+    ccallback__mutex lock;
+    ccallback__cond work;
+    ccallback__cond done;
+    int nworkers;
+    int busy;
+    unsigned long generation;
+    int nclaims;
+    int nrunning;
+    ccallback_pool_func *func;
+    void *arg;
+    ccallback_t *callback;
+} ccallback__pool_t;
+
+static ccallback__pool_t ccallback__pool = {
+    CCALLBACK__MUTEX_INIT, CCALLBACK__COND_INIT, CCALLBACK__COND_INIT,
+    0, 0, 0, 0, 0, NULL, NULL, NULL
+};
+
+
+static CCALLBACK__THREAD_RETURN ccallback__pool_worker(void *arg)
+{
+    ccallback__pool_t *pool = &ccallback__pool;
+    /* the generation at start, so that the run starting us is joined */
+    unsigned long seen = (unsigned long)(uintptr_t)arg;
+
+    ccallback__mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->generation == seen) {
+            ccallback__cond_wait(&pool->work, &pool->lock);
+        }
+        seen = pool->generation;
+        if (pool->nclaims > 0) {
+            ccallback_pool_func *func = pool->func;
+            void *func_arg = pool->arg;
+            ccallback_t *callback = pool->callback;
+
+            --pool->nclaims;
+            ++pool->nrunning;
+            ccallback__mutex_unlock(&pool->lock);
+
+            ccallback__set_thread_local((void *)callback);
+            func(func_arg);
+            ccallback__set_thread_local(NULL);
+
+            ccallback__mutex_lock(&pool->lock);
+            if (--pool->nrunning == 0) {
+                ccallback__cond_broadcast(&pool->done);
+            }
+        }
+    }
+    return 0;
+}
+
+
+#ifndef _WIN32
+/* Worker threads are not inherited by a forked child */
+static void ccallback__pool_atfork_child(void)
+{
+    ccallback__pool_t *pool = &ccallback__pool;
+
+    ccallback__mutex_init(&pool->lock);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->nworkers = 0;
+    pool->busy = 0;
+    pool->nclaims = 0;
+    pool->nrunning = 0;
+}
+#endif
+
+
+/* Starts a detached worker; returns 0 on failure */
+static int ccallback__pool_start_worker(unsigned long generation)
+{
+    void *arg = (void *)(uintptr_t)generation;
+#ifdef _WIN32
+    HANDLE handle = (HANDLE)_beginthreadex(NULL, 0, ccallback__pool_worker,
+                                           arg, 0, NULL);
+    if (handle == 0) {
+        return 0;
+    }
+    CloseHandle(handle);
+    return 1;
+#else
+    pthread_t handle;
+
+    if (ccallback__pool.nworkers == 0 &&
+            pthread_atfork(NULL, NULL, ccallback__pool_atfork_child) != 0) {
+        return 0;
+    }
+    if (pthread_create(&handle, NULL, ccallback__pool_worker, arg) != 0) {
+        return 0;
+    }
+    pthread_detach(handle);
+    return 1;
+#endif
+}
+
+
+/*
+ * Runs func(arg) on up to nthreads threads, one of them the calling thread,
+ * with callback as the thread-local callback of the workers, and returns
+ * the number of threads which ran it when all of them have finished.
+ * Python callbacks are run on the calling thread only.
+ */
+static int ccallback_pool_run(ccallback_t *callback, int nthreads,
+                              ccallback_pool_func *func, void *arg)
+{
+    ccallback__pool_t *pool = &ccallback__pool;
+    int owner = 0, nclaims = 0, nused = 1;
+
+#ifndef CCALLBACK_NATIVE_TLS
+    nthreads = 1;
+#endif
+    if (callback != NULL && callback->py_function != NULL) {
+        nthreads = 1;
+    }
+    if (nthreads > CCALLBACK_POOL_MAX_THREADS) {
+        nthreads = CCALLBACK_POOL_MAX_THREADS;
+    }
+
+    if (nthreads > 1) {
+        ccallback__mutex_lock(&pool->lock);
+        if (!pool->busy) {
+            pool->busy = 1;
+            owner = 1;
+            while (pool->nworkers < nthreads - 1 &&
+                   ccallback__pool_start_worker(pool->generation)) {
+                ++pool->nworkers;
+            }
+            nclaims = nthreads - 1 < pool->nworkers ? nthreads - 1
+                                                    : pool->nworkers;
+            pool->func = func;
+            pool->arg = arg;
+            pool->callback = callback;
+            pool->nclaims = nclaims;
+            ++pool->generation;
+            ccallback__cond_broadcast(&pool->work);
+        }
+        ccallback__mutex_unlock(&pool->lock);
+    }
+
+    func(arg);
+
+    if (owner) {
+        ccallback__mutex_lock(&pool->lock);
+        nused += nclaims - pool->nclaims;
+        pool->nclaims = 0;
+        while (pool->nrunning > 0) {
+            ccallback__cond_wait(&pool->done, &pool->lock);
+        }
+        pool->busy = 0;
+        ccallback__mutex_unlock(&pool->lock);
+    }
+    return nused;
+}
+
+
+/*
+ * Batch evaluation
+ */
+
+typedef struct {
+    ccallback_t *callback;
+    double *x;
+    double *y;
+    intptr_t n;
+    intptr_t chunk;
+    intptr_t next;
+    int error;
+    ccallback__mutex lock;
+} ccallback__batch_t;
+
+
+static void ccallback__batch_worker(void *arg)
+{
+    ccallback__batch_t *batch = (ccallback__batch_t *)arg;
+    ccallback_t *callback = batch->callback;
+
+    for (;;) {
+        intptr_t start, count;
+        int ret;
+
+        ccallback__mutex_lock(&batch->lock);
+        if (batch->error != 0 || batch->next >= batch->n) {
+            ccallback__mutex_unlock(&batch->lock);
+            return;
+        }
+        start = batch->next;
+        count = batch->n - start < batch->chunk ? batch->n - start
+                                                : batch->chunk;
+        batch->next += count;
+        ccallback__mutex_unlock(&batch->lock);
+
+        ret = ((ccallback_batch_func *)callback->c_function)(
+            batch->x + start, batch->y + start, count, callback->user_data);
+        if (ret != 0) {
+            ccallback__mutex_lock(&batch->lock);
+            if (batch->error == 0) {
+                batch->error = ret;
+            }
+            ccallback__mutex_unlock(&batch->lock);
+            return;
+        }
+    }
+}
+
+
+/*
+ * Evaluates the C batch callback on x[0:n] into y[0:n], in chunks of up to
+ * chunk points run on up to nthreads threads. Returns 0, or the first
+ * nonzero value returned by the callback, upon which the remaining chunks
+ * are abandoned. Can be called without the GIL.
+ */
+static int ccallback_batch_map(ccallback_t *callback, int nthreads,
+                               double *x, double *y, intptr_t n,
+                               intptr_t chunk)
+{
+    ccallback__batch_t batch;
+
+    batch.callback = callback;
+    batch.x = x;
+    batch.y = y;
+    batch.n = n;
+    batch.chunk = chunk > 0 ? chunk : 1;
+    batch.next = 0;
+    batch.error = 0;
+    ccallback__mutex_init(&batch.lock);
+
+    if (n <= batch.chunk) {
+        nthreads = 1;
+    }
+    ccallback_pool_run(callback, nthreads, ccallback__batch_worker, &batch);
+
+    ccallback__mutex_destroy(&batch.lock);
+    return batch.error;
+}
+
+
+#endif /* CCALLBACK_POOL_H_ */
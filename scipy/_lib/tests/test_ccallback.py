@@ -197,3 +197,41 @@ def test_threadsafety():
 
     for caller in CALLERS.keys():
         check(caller)
+
+
+def test_call_batch():
+    caller = _test_ccallback.test_call_batch
+    func = LowLevelCallable(_test_ccallback.test_get_plus1_batch_capsule())
+    n = 100000
+    expected = n*(n - 1)/2 + 4*n
+
+    for nthreads in [1, 2, 4, 16]:
+        assert_equal(caller(func, n, 3.0, nthreads), expected)
+
+    data = _test_ccallback.test_get_data_capsule()
+    assert_equal(caller(LowLevelCallable(func.function, data), n, 3.0, 4),
+                 expected + n)
+
+    assert_raises(ValueError, caller, func, n, 0.0, 4)
+    assert_raises(ValueError, caller, callback_python, n, 3.0, 4)
+    assert_raises(ValueError, caller,
+                  LowLevelCallable(_test_ccallback.test_get_plus1_capsule()),
+                  n, 3.0, 4)
+
+
+def test_call_batch_threadsafety():
+    caller = _test_ccallback.test_call_batch
+    func = LowLevelCallable(_test_ccallback.test_get_plus1_batch_capsule())
+    n = 50000
+    results = []
+
+    def run():
+        results.append(caller(func, n, 3.0, 4))
+
+    threads = [threading.Thread(target=run) for j in range(8)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+
+    assert_equal(results, [n*(n - 1)/2 + 4*n]*len(threads))
@@ -11,8 +11,22 @@ cdef extern from "numpy/npy_math.h":
     cdef enum:
         NPY_INFINITYF
 
+cdef extern from "zeros_threads.h":
+    ctypedef struct zeros_mutex:
+        pass
+    void zeros_mutex_init(zeros_mutex *m) nogil
+    void zeros_mutex_destroy(zeros_mutex *m) nogil
+    void zeros_mutex_lock(zeros_mutex *m) nogil
+    void zeros_mutex_unlock(zeros_mutex *m) nogil
+    void zeros_run_threads(int nthreads, void (*func)(void *) nogil,
+                           void *arg) nogil
+
 ctypedef unsigned char uchar
 
+# The distance matrix is updated by several threads only from this number
+# of clusters, below which starting the threads would take longer.
+DEF PARALLEL_UPDATE_MIN = 20000
+
 
 # _hierarchy_distance_update.pxi includes the definition of linkage_distance_update
 # and the distance update functions for the supported linkage methods.
@@ -22,7 +36,7 @@ cdef linkage_distance_update *linkage_methods = [
 include "_structures.pxi"
 
 cdef inline np.npy_int64 condensed_index(np.npy_int64 n, np.npy_int64 i,
-                                         np.npy_int64 j):
+                                         np.npy_int64 j) nogil:
     """
     Calculate the condensed index of element (i, j) in an n x n condensed
     matrix.
@@ -47,6 +61,86 @@ cdef inline void set_visited(uchar *bitset, int i):
     bitset[i >> 3] |= 1 << (i & 7)
 
 
+cdef struct work_queue:
+    # Blocks of work shared between threads
+    np.npy_int64 next, nblocks
+    zeros_mutex lock
+
+
+cdef np.npy_int64 claim_block(work_queue *q) nogil:
+    """
+    Return the index of the next unprocessed block, or -1.
+    """
+    cdef np.npy_int64 k
+    zeros_mutex_lock(&q.lock)
+    k = q.next
+    q.next += 1
+    zeros_mutex_unlock(&q.lock)
+    return k if k < q.nblocks else -1
+
+
+cdef void run_blocks(work_queue *q, np.npy_int64 nblocks,
+                     void (*func)(void *) nogil, void *arg,
+                     int nthreads) nogil:
+    """
+    Run func(arg) on up to nthreads threads, which claim the nblocks blocks
+    of q.
+    """
+    q.next = 0
+    q.nblocks = nblocks
+    if nthreads > nblocks:
+        nthreads = <int>nblocks
+    zeros_mutex_init(&q.lock)
+    zeros_run_threads(max(nthreads, 1), func, arg)
+    zeros_mutex_destroy(&q.lock)
+
+
+cdef struct update_work:
+    # Distance update after merging clusters x and y, for linkage methods
+    # working on the condensed distance matrix D
+    work_queue q
+    double *D
+    int *size
+    int n, x, y, nx, ny, block
+    double d_xy
+    linkage_distance_update new_dist
+
+
+cdef void update_distances_blocks(void *arg) nogil:
+    cdef update_work *w = <update_work *>arg
+    cdef np.npy_int64 k
+    cdef int i, ni, stop
+
+    k = claim_block(&w.q)
+    while k >= 0:
+        stop = min(w.n, (k + 1) * w.block)
+        for i in range(k * w.block, stop):
+            ni = w.size[i]
+            if ni == 0 or i == w.y:
+                continue
+
+            w.D[condensed_index(w.n, i, w.y)] = w.new_dist(
+                w.D[condensed_index(w.n, i, w.x)],
+                w.D[condensed_index(w.n, i, w.y)],
+                w.d_xy, w.nx, w.ny, ni)
+        k = claim_block(&w.q)
+
+
+cdef void update_distances(update_work *w, int n_clusters,
+                           int nthreads) nogil:
+    """
+    Replace the distances to the cluster y by the distances to the union of
+    the clusters x and y, using several threads if there are many clusters.
+    """
+    if nthreads == 1 or n_clusters < PARALLEL_UPDATE_MIN:
+        nthreads = 1
+        w.block = w.n
+    else:
+        w.block = (w.n + 4 * nthreads - 1) // (4 * nthreads)
+    run_blocks(&w.q, (w.n + w.block - 1) // w.block,
+               update_distances_blocks, w, nthreads)
+
+
 cpdef void calculate_cluster_sizes(double[:, :] Z, double[:] cs, int n):
     """
     Calculate the size of each cluster. The result is the fourth column of
@@ -300,7 +394,58 @@ cpdef void cluster_monocrit(double[:, :] Z, double[:] MC, int[:] T,
     PyMem_Free(visited)
 
 
-def cophenetic_distances(double[:, :] Z, double[:] d, int n):
+cdef struct cophenet_work:
+    # Filling of the cophenetic distances, by rows of the merges: row t of
+    # merge k is the leaf rows[k] + t - offset[k] of the larger child, for
+    # offset[k] <= t < offset[k + 1], and its distances to the cols_n[k]
+    # leaves of the smaller child, from cols[k], are Z[k, 2].
+    work_queue q
+    double *d
+    int *members
+    int *rows
+    int *cols
+    int *cols_n
+    double *dist
+    np.npy_int64 *offset
+    np.npy_int64 block
+    int n
+
+
+cdef void cophenetic_blocks(void *arg) nogil:
+    cdef cophenet_work *w = <cophenet_work *>arg
+    cdef np.npy_int64 b, t, stop, lo, hi, mid
+    cdef int i, j, k, row
+    cdef double dist
+
+    b = claim_block(&w.q)
+    while b >= 0:
+        t = b * w.block
+        stop = min(t + w.block, w.offset[w.n - 1])
+
+        # the merge of row t
+        lo = 0
+        hi = w.n - 1
+        while hi - lo > 1:
+            mid = (lo + hi) // 2
+            if w.offset[mid] <= t:
+                lo = mid
+            else:
+                hi = mid
+        k = <int>lo
+
+        while t < stop:
+            while w.offset[k + 1] <= t:
+                k += 1
+            row = w.members[w.rows[k] + t - w.offset[k]]
+            dist = w.dist[k]
+            for j in range(w.cols[k], w.cols[k] + w.cols_n[k]):
+                w.d[condensed_index(w.n, row, w.members[j])] = dist
+            t += 1
+        b = claim_block(&w.q)
+
+
+def cophenetic_distances(double[:, :] Z, double[::1] d, int n,
+                         int nthreads=1):
     """
     Calculate the cophenetic distances between each observation
 
@@ -312,13 +457,26 @@ def cophenetic_distances(double[:, :] Z, double[:] d, int n):
         The condensed matrix to store the cophenetic distances.
     n : int
         The number of observations.
+    nthreads : int
+        The number of threads filling `d`.
     """
-    cdef int i, j, k, root, i_lc, i_rc, n_lc, n_rc, right_start
-    cdef double dist
+    cdef int i, j, k, root, i_lc, i_rc, n_lc, n_rc
     cdef int[:] curr_node = np.ndarray(n, dtype=np.intc)
     cdef int[:] members = np.ndarray(n, dtype=np.intc)
     cdef int[:] left_start = np.ndarray(n, dtype=np.intc)
 
+    # The leaves of each merge are contiguous in members; the rows and
+    # columns of its distances are those of its larger and smaller child.
+    cdef int[::1] rows = np.zeros(max(n - 1, 1), dtype=np.intc)
+    cdef int[::1] cols = np.zeros(max(n - 1, 1), dtype=np.intc)
+    cdef int[::1] cols_n = np.zeros(max(n - 1, 1), dtype=np.intc)
+    cdef double[::1] dist = np.zeros(max(n - 1, 1))
+    cdef np.npy_int64[::1] offset = np.zeros(n, dtype=np.int64)
+    cdef cophenet_work w
+
+    if n < 2:
+        return
+
     cdef int visited_size = (((n * 2) - 1) >> 3) + 1
     cdef uchar *visited = <uchar *>PyMem_Malloc(visited_size)
     if not visited:
@@ -360,16 +518,38 @@ def cophenetic_distances(double[:, :] Z, double[:] d, int n):
             members[left_start[k] + n_lc] = i_rc
 
         # back to the root of current subtree
-        dist = Z[root, 2]
-        right_start = left_start[k] + n_lc
-        for i in range(left_start[k], right_start):
-            for j in range(right_start, right_start + n_rc):
-                d[condensed_index(n, members[i], members[j])] = dist
+        dist[root] = Z[root, 2]
+        if n_lc >= n_rc:
+            rows[root] = left_start[k]
+            cols[root] = left_start[k] + n_lc
+            cols_n[root] = n_rc
+        else:
+            rows[root] = left_start[k] + n_lc
+            cols[root] = left_start[k]
+            cols_n[root] = n_lc
+        offset[root + 1] = max(n_lc, n_rc)
 
         k -= 1  # back to parent node
 
     PyMem_Free(visited)
 
+    for i in range(n - 1):
+        offset[i + 1] += offset[i]
+
+    w.d = &d[0]
+    w.members = &members[0]
+    w.rows = &rows[0]
+    w.cols = &cols[0]
+    w.cols_n = &cols_n[0]
+    w.dist = &dist[0]
+    w.offset = &offset[0]
+    w.n = n
+    # blocks of about 2^16 distances
+    w.block = max(1, (<np.npy_int64>1 << 16) // max(n // 2, 1))
+    with nogil:
+        run_blocks(&w.q, (offset[n - 1] + w.block - 1) // w.block,
+                   cophenetic_blocks, &w, nthreads)
+
 
 cpdef void get_max_Rfield_for_each_cluster(double[:, :] Z, double[:, :] R,
                                            double[:] max_rfs, int n, int rf):
@@ -775,7 +955,7 @@ cdef Pair find_min_dist(int n, double[:] D, int[:] size, int x):
     return Pair(y, current_min)
 
 
-def fast_linkage(double[:] dists, int n, int method):
+def fast_linkage(double[:] dists, int n, int method, int nthreads=1):
     """Perform hierarchy clustering.
 
     It implements "Generic Clustering Algorithm" from [1]. The worst case
@@ -791,6 +971,8 @@ def fast_linkage(double[:] dists, int n, int method):
     method : int
         The linkage method. 0: single 1: complete 2: average 3: centroid
         4: median 5: ward 6: weighted
+    nthreads : int
+        The number of threads updating the distance matrix.
 
     Returns
     -------
@@ -815,11 +997,15 @@ def fast_linkage(double[:] dists, int n, int method):
     cdef int[:] neighbor = np.empty(n - 1, dtype=np.intc)
     cdef double[:] min_dist = np.empty(n - 1)
 
-    cdef linkage_distance_update new_dist = linkage_methods[method]
+    cdef update_work update
+    update.D = &D[0]
+    update.size = &size[0]
+    update.n = n
+    update.new_dist = linkage_methods[method]
 
     cdef int i, k
     cdef int x, y, z
-    cdef int nx, ny, nz
+    cdef int nx, ny
     cdef int id_x, id_y
     cdef double dist
     cdef Pair pair
@@ -869,14 +1055,13 @@ def fast_linkage(double[:] dists, int n, int method):
         cluster_id[y] = n + k  # Update ID of y.
 
         # Update the distance matrix.
-        for z in range(n):
-            nz = size[z]
-            if nz == 0 or z == y:
-                continue
-
-            D[condensed_index(n, z, y)] = new_dist(
-                D[condensed_index(n, z, x)], D[condensed_index(n, z, y)],
-                dist, nx, ny, nz)
+        update.x = x
+        update.y = y
+        update.nx = nx
+        update.ny = ny
+        update.d_xy = dist
+        with nogil:
+            update_distances(&update, n - k - 1, nthreads)
 
         # Reassign neighbor candidates from x to y.
         # This reassignment is just a (logical) guess.
@@ -907,7 +1092,7 @@ def fast_linkage(double[:] dists, int n, int method):
     return Z.base
 
 
-def nn_chain(double[:] dists, int n, int method):
+def nn_chain(double[:] dists, int n, int method, int nthreads=1):
     """Perform hierarchy clustering using nearest-neighbor chain algorithm.
 
     Parameters
@@ -919,6 +1104,8 @@ def nn_chain(double[:] dists, int n, int method):
     method : int
         The linkage method. 0: single 1: complete 2: average 3: centroid
         4: median 5: ward 6: weighted
+    nthreads : int
+        The number of threads updating the distance matrix.
 
     Returns
     -------
@@ -931,13 +1118,17 @@ def nn_chain(double[:] dists, int n, int method):
     cdef double[:] D = dists.copy()  # Distances between clusters.
     cdef int[:] size = np.ones(n, dtype=np.intc)  # Sizes of clusters.
 
-    cdef linkage_distance_update new_dist = linkage_methods[method]
+    cdef update_work update
+    update.D = &D[0]
+    update.size = &size[0]
+    update.n = n
+    update.new_dist = linkage_methods[method]
 
     # Variables to store neighbors chain.
     cdef int[:] cluster_chain = np.ndarray(n, dtype=np.intc)
     cdef int chain_length = 0
 
-    cdef int i, j, k, x, y, nx, ny, ni
+    cdef int i, j, k, x, y, nx, ny
     cdef double dist, current_min
 
     for k in range(n - 1):
@@ -995,15 +1186,13 @@ def nn_chain(double[:] dists, int n, int method):
         size[y] = nx + ny  # Cluster y will be replaced with the new cluster
 
         # Update the distance matrix.
-        for i in range(n):
-            ni = size[i]
-            if ni == 0 or i == y:
-                continue
-
-            D[condensed_index(n, i, y)] = new_dist(
-                D[condensed_index(n, i, x)],
-                D[condensed_index(n, i, y)],
-                current_min, nx, ny, ni)
+        update.x = x
+        update.y = y
+        update.nx = nx
+        update.ny = ny
+        update.d_xy = current_min
+        with nogil:
+            update_distances(&update, n - k - 1, nthreads)
 
     # Sort Z by cluster distances.
     order = np.argsort(Z_arr[:, 2], kind='mergesort')
@@ -1073,6 +1262,329 @@ def mst_single_linkage(double[:] dists, int n):
     return Z_arr
 
 
+cdef inline double vector_dist(double[:, :] C, int[:] size, int x, int y,
+                               int method):
+    """Distance between the clusters x and y of centers C, for
+    `fast_linkage_vector` and `nn_chain_vector`."""
+    cdef int k
+    cdef double diff, dist = 0
+
+    for k in range(C.shape[1]):
+        diff = C[x, k] - C[y, k]
+        dist += diff * diff
+
+    if method == 5:  # ward
+        dist *= 2.0 * size[x] * size[y] / (size[x] + size[y])
+    return sqrt(dist)
+
+
+cdef inline void merge_centers(double[:, :] C, int x, int y, int nx, int ny,
+                               int method):
+    """Replace the center of y with the center of the union of x and y."""
+    cdef int k
+
+    for k in range(C.shape[1]):
+        if method == 4:  # median
+            C[y, k] = (C[x, k] + C[y, k]) / 2
+        else:
+            C[y, k] = (nx * C[x, k] + ny * C[y, k]) / (nx + ny)
+
+
+cdef Pair find_min_dist_vector(int n, double[:, :] C, int[:] size, int x,
+                               int method):
+    cdef double current_min = NPY_INFINITYF
+    cdef int y = -1
+    cdef int i
+    cdef double dist
+
+    for i in range(x + 1, n):
+        if size[i] == 0:
+            continue
+
+        dist = vector_dist(C, size, x, i, method)
+        if dist < current_min:
+            current_min = dist
+            y = i
+
+    return Pair(y, current_min)
+
+
+def fast_linkage_vector(double[:, :] X, int method):
+    """Perform hierarchy clustering of observations.
+
+    It is `fast_linkage` with the distances between clusters computed from
+    their centers when needed, instead of being stored, so that the memory
+    is O(N). The worst case time complexity is O(N^3 M), for M features.
+
+    Parameters
+    ----------
+    X : ndarray, shape (n, m)
+        The observations.
+    method : int
+        The linkage method. 3: centroid 4: median 5: ward
+
+    Returns
+    -------
+    Z : ndarray, shape (n - 1, 4)
+        Computed linkage matrix.
+    """
+    cdef int n = X.shape[0]
+    cdef double[:, :] Z = np.empty((n - 1, 4))
+
+    cdef double[:, :] C = np.array(X)  # Centers of clusters.
+    cdef int[:] size = np.ones(n, dtype=np.intc)  # Sizes of clusters.
+    # ID of a cluster to put into linkage matrix.
+    cdef int[:] cluster_id = np.arange(n, dtype=np.intc)
+
+    # Nearest neighbor candidate and lower bound of the distance to the
+    # true nearest neighbor for each cluster among clusters with higher
+    # indices (thus size is n - 1).
+    cdef int[:] neighbor = np.empty(n - 1, dtype=np.intc)
+    cdef double[:] min_dist = np.empty(n - 1)
+
+    cdef int i, k
+    cdef int x, y, z
+    cdef int nx, ny
+    cdef int id_x, id_y
+    cdef double dist
+    cdef Pair pair
+
+    for x in range(n - 1):
+        pair = find_min_dist_vector(n, C, size, x, method)
+        neighbor[x] = pair.key
+        min_dist[x] = pair.value
+    cdef Heap min_dist_heap = Heap(min_dist)
+
+    for k in range(n - 1):
+        # As in fast_linkage, the two closest clusters are found in no more
+        # than n - k distance updates.
+        for i in range(n - k):
+            pair = min_dist_heap.get_min()
+            x, dist = pair.key, pair.value
+            y = neighbor[x]
+
+            if dist == vector_dist(C, size, x, y, method):
+                break
+
+            pair = find_min_dist_vector(n, C, size, x, method)
+            y, dist = pair.key, pair.value
+            neighbor[x] = y
+            min_dist[x] = dist
+            min_dist_heap.change_value(x, dist)
+        min_dist_heap.remove_min()
+
+        id_x = cluster_id[x]
+        id_y = cluster_id[y]
+        nx = size[x]
+        ny = size[y]
+
+        if id_x > id_y:
+            id_x, id_y = id_y, id_x
+
+        Z[k, 0] = id_x
+        Z[k, 1] = id_y
+        Z[k, 2] = dist
+        Z[k, 3] = nx + ny
+
+        merge_centers(C, x, y, nx, ny, method)
+        size[x] = 0  # Cluster x will be dropped.
+        size[y] = nx + ny  # Cluster y will be replaced with the new cluster.
+        cluster_id[y] = n + k  # Update ID of y.
+
+        # Reassign neighbor candidates from x to y.
+        # This reassignment is just a (logical) guess.
+        for z in range(x):
+            if size[z] > 0 and neighbor[z] == x:
+                neighbor[z] = y
+
+        # Update lower bounds of distance.
+        for z in range(y):
+            if size[z] == 0:
+                continue
+
+            dist = vector_dist(C, size, z, y, method)
+            if dist < min_dist[z]:
+                neighbor[z] = y
+                min_dist[z] = dist
+                min_dist_heap.change_value(z, dist)
+
+        # Find nearest neighbor for y.
+        if y < n - 1:
+            pair = find_min_dist_vector(n, C, size, y, method)
+            z, dist = pair.key, pair.value
+            if z != -1:
+                neighbor[y] = z
+                min_dist[y] = dist
+                min_dist_heap.change_value(y, dist)
+
+    return Z.base
+
+
+def nn_chain_vector(double[:, :] X, int method):
+    """Perform hierarchy clustering of observations using nearest-neighbor
+    chain algorithm.
+
+    It is `nn_chain` with the distances between clusters computed from
+    their centers when needed, instead of being stored, so that the memory
+    is O(N). Only valid for the ward method among those of
+    `fast_linkage_vector`, the others not being reducible.
+
+    Parameters
+    ----------
+    X : ndarray, shape (n, m)
+        The observations.
+    method : int
+        The linkage method. 5: ward
+
+    Returns
+    -------
+    Z : ndarray, shape (n - 1, 4)
+        Computed linkage matrix.
+    """
+    cdef int n = X.shape[0]
+    Z_arr = np.empty((n - 1, 4))
+    cdef double[:, :] Z = Z_arr
+
+    cdef double[:, :] C = np.array(X)  # Centers of clusters.
+    cdef int[:] size = np.ones(n, dtype=np.intc)  # Sizes of clusters.
+
+    # Variables to store neighbors chain.
+    cdef int[:] cluster_chain = np.ndarray(n, dtype=np.intc)
+    cdef int chain_length = 0
+
+    cdef int i, k, x, y, nx, ny
+    cdef double dist, current_min
+
+    for k in range(n - 1):
+        if chain_length == 0:
+            chain_length = 1
+            for i in range(n):
+                if size[i] > 0:
+                    cluster_chain[0] = i
+                    break
+
+        # Go through chain of neighbors until two mutual neighbors are found.
+        while True:
+            x = cluster_chain[chain_length - 1]
+
+            # We want to prefer the previous element in the chain as the
+            # minimum, to avoid potentially going in cycles.
+            if chain_length > 1:
+                y = cluster_chain[chain_length - 2]
+                current_min = vector_dist(C, size, x, y, method)
+            else:
+                current_min = NPY_INFINITYF
+
+            for i in range(n):
+                if size[i] == 0 or x == i:
+                    continue
+
+                dist = vector_dist(C, size, x, i, method)
+                if dist < current_min:
+                    current_min = dist
+                    y = i
+
+            if chain_length > 1 and y == cluster_chain[chain_length - 2]:
+                break
+
+            cluster_chain[chain_length] = y
+            chain_length += 1
+
+        # Merge clusters x and y and pop them from stack.
+        chain_length -= 2
+
+        # This is a convention used in fastcluster.
+        if x > y:
+            x, y = y, x
+
+        # get the original numbers of points in clusters x and y
+        nx = size[x]
+        ny = size[y]
+
+        # Record the new node.
+        Z[k, 0] = x
+        Z[k, 1] = y
+        Z[k, 2] = current_min
+        Z[k, 3] = nx + ny
+        merge_centers(C, x, y, nx, ny, method)
+        size[x] = 0  # Cluster x will be dropped.
+        size[y] = nx + ny  # Cluster y will be replaced with the new cluster
+
+    # Sort Z by cluster distances.
+    order = np.argsort(Z_arr[:, 2], kind='mergesort')
+    Z_arr = Z_arr[order]
+
+    # Find correct cluster labels inplace.
+    label(Z_arr, n)
+
+    return Z_arr
+
+
+def mst_single_linkage_vector(double[:, :] X):
+    """Perform hierarchy clustering of observations using MST algorithm for
+    single linkage.
+
+    It is `mst_single_linkage` with the Euclidean distances between the
+    observations computed when needed, so that the memory is O(N).
+
+    Parameters
+    ----------
+    X : ndarray, shape (n, m)
+        The observations.
+
+    Returns
+    -------
+    Z : ndarray, shape (n - 1, 4)
+        Computed linkage matrix.
+    """
+    cdef int n = X.shape[0]
+    Z_arr = np.empty((n - 1, 4))
+    cdef double[:, :] Z = Z_arr
+
+    # Which nodes were already merged.
+    cdef int[:] merged = np.zeros(n, dtype=np.intc)
+
+    cdef double[:] D = np.empty(n)
+    D[:] = NPY_INFINITYF
+
+    cdef int i, j, k, x, y
+    cdef double dist, diff, current_min
+
+    x = 0
+    for k in range(n - 1):
+        current_min = NPY_INFINITYF
+        merged[x] = 1
+        for i in range(n):
+            if merged[i] == 1:
+                continue
+
+            dist = 0
+            for j in range(X.shape[1]):
+                diff = X[x, j] - X[i, j]
+                dist += diff * diff
+            dist = sqrt(dist)
+            if D[i] > dist:
+                D[i] = dist
+
+            if D[i] < current_min:
+                y = i
+                current_min = D[i]
+
+        Z[k, 0] = x
+        Z[k, 1] = y
+        Z[k, 2] = current_min
+        x = y
+
+    # Sort Z by cluster distances.
+    order = np.argsort(Z_arr[:, 2], kind='mergesort')
+    Z_arr = Z_arr[order]
+
+    # Find correct cluster labels and compute cluster sizes inplace.
+    label(Z_arr, n)
+
+    return Z_arr
+
+
 cdef class LinkageUnionFind:
     """Structure for fast cluster labeling in unsorted dendrogram."""
     cdef int[:] parent
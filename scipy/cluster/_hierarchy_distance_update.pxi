@@ -21,41 +21,44 @@ Returns
 -------
 d_xyi : double
     Distance from the new cluster xy to cluster i
+
+The functions do not need the GIL, so that the distance matrix can be
+updated by several threads.
 """
 ctypedef double (*linkage_distance_update)(double d_xi, double d_yi,
                                            double d_xy, int size_x,
-                                           int size_y, int size_i)
+                                           int size_y, int size_i) nogil
 
 
 cdef double _single(double d_xi, double d_yi, double d_xy,
-                    int size_x, int size_y, int size_i):
+                    int size_x, int size_y, int size_i) nogil:
     return min(d_xi, d_yi)
 
 
 cdef double _complete(double d_xi, double d_yi, double d_xy,
-                      int size_x, int size_y, int size_i):
+                      int size_x, int size_y, int size_i) nogil:
     return max(d_xi, d_yi)
 
 
 cdef double _average(double d_xi, double d_yi, double d_xy,
-                     int size_x, int size_y, int size_i):
+                     int size_x, int size_y, int size_i) nogil:
     return (size_x * d_xi + size_y * d_yi) / (size_x + size_y)
 
 
 cdef double _centroid(double d_xi, double d_yi, double d_xy,
-                      int size_x, int size_y, int size_i):
+                      int size_x, int size_y, int size_i) nogil:
     return sqrt((((size_x * d_xi * d_xi) + (size_y * d_yi * d_yi)) -
                  (size_x * size_y * d_xy * d_xy) / (size_x + size_y)) /
                 (size_x + size_y))
 
 
 cdef double _median(double d_xi, double d_yi, double d_xy,
-                    int size_x, int size_y, int size_i):
+                    int size_x, int size_y, int size_i) nogil:
     return sqrt(0.5 * (d_xi * d_xi + d_yi * d_yi) - 0.25 * d_xy * d_xy)
 
 
 cdef double _ward(double d_xi, double d_yi, double d_xy,
-                  int size_x, int size_y, int size_i):
+                  int size_x, int size_y, int size_i) nogil:
     cdef double t = 1.0 / (size_x + size_y + size_i)
     return sqrt((size_i + size_x) * t * d_xi * d_xi +
                 (size_i + size_y) * t * d_yi * d_yi -
@@ -63,5 +66,5 @@ cdef double _ward(double d_xi, double d_yi, double d_xy,
 
 
 cdef double _weighted(double d_xi, double d_yi, double d_xy,
-                      int size_x, int size_y, int size_i):
+                      int size_x, int size_y, int size_i) nogil:
     return 0.5 * (d_xi + d_yi)
@@ -9,12 +9,15 @@ Translated to Cython by David Warde-Farley, October 2009.
 
 from __future__ import absolute_import
 
+from multiprocessing import cpu_count
+
 cimport cython
 import numpy as np
 cimport numpy as np
 from .cluster_blas cimport f_dgemm, f_sgemm
 
-from libc.math cimport sqrt
+from libc.math cimport sqrt, INFINITY
+from libc.stdlib cimport malloc, calloc, free
 
 ctypedef np.float64_t float64_t
 ctypedef np.float32_t float32_t
@@ -30,11 +33,85 @@ ctypedef fused vq_type:
 # switch back to the naive algorithm to avoid high overhead.
 DEF NFEATURES_CUTOFF=5
 
+# Observations are processed in blocks whose inner products with the code
+# book have about this many entries.
+DEF BLOCK_ENTRIES=65536
+
 # Initialize the NumPy C API
 np.import_array()
 
 
-cdef inline vq_type vec_sqr(int n, vq_type *p):
+cdef extern from "zeros_threads.h":
+    ctypedef struct zeros_mutex:
+        pass
+    void zeros_mutex_init(zeros_mutex *m) nogil
+    void zeros_mutex_destroy(zeros_mutex *m) nogil
+    void zeros_mutex_lock(zeros_mutex *m) nogil
+    void zeros_mutex_unlock(zeros_mutex *m) nogil
+    void zeros_run_threads(int nthreads, void (*func)(void *) nogil,
+                           void *arg) nogil
+
+
+cdef struct vq_work:
+    # The shared state of the threads of _vq, _update_cluster_means and
+    # _hamerly_assign. The arrays are of the dtype given by is_float.
+    bint is_float
+    void *obs
+    void *code_book
+    # squared norms of the codes (_vq) or half the distance from each code
+    # to the closest other one (_hamerly_assign)
+    void *code_aux
+    int32_t *labels
+    # distances to the closest code (_vq), upper and lower bounds on them
+    # (_hamerly_assign), or the partial sums of the codes (update)
+    void *dist
+    void *lower
+    int *counts
+    np.npy_intp nobs, ncodes, nfeat, block, nblocks
+    # next block to claim, and whether a thread ran out of memory
+    np.npy_intp next
+    bint nomem
+    zeros_mutex lock
+
+
+cdef int _nthreads(workers) except -1:
+    return cpu_count() if workers == -1 else max(int(workers), 1)
+
+
+cdef np.npy_intp _claim(vq_work *w) nogil:
+    # Returns the index of the next unprocessed block, or -1
+    cdef np.npy_intp k
+    zeros_mutex_lock(&w.lock)
+    k = w.next
+    w.next += 1
+    if w.nomem or k >= w.nblocks:
+        k = -1
+    zeros_mutex_unlock(&w.lock)
+    return k
+
+
+cdef void _set_nomem(vq_work *w) nogil:
+    zeros_mutex_lock(&w.lock)
+    w.nomem = 1
+    zeros_mutex_unlock(&w.lock)
+
+
+cdef int _run(vq_work *w, void (*func)(void *) nogil,
+              int nthreads) except -1:
+    if nthreads > w.nblocks:
+        nthreads = max(<int>w.nblocks, 1)
+    w.next = 0
+    w.nomem = 0
+    zeros_mutex_init(&w.lock)
+    with nogil:
+        zeros_run_threads(nthreads, func, <void *>w)
+    zeros_mutex_destroy(&w.lock)
+    if w.nomem:
+        raise MemoryError()
+    return 0
+
+
+cdef inline vq_type vec_sqr(int n, vq_type *p) nogil:
     cdef vq_type result = 0.0
     cdef int i
     for i in range(n):
@@ -43,7 +120,7 @@ cdef inline vq_type vec_sqr(int n, vq_type *p):
 
 
 cdef inline void cal_M(int nobs, int ncodes, int nfeat, vq_type *obs,
-                       vq_type *code_book, vq_type *M):
+                       vq_type *code_book, vq_type *M) nogil:
     """
     Calculate M = obs * code_book.T
     """
@@ -59,9 +136,74 @@ cdef inline void cal_M(int nobs, int ncodes, int nfeat, vq_type *obs,
                 &alpha, code_book, &nfeat, obs, &nfeat, &beta, M, &ncodes)
 
 
+cdef void _vq_blocks(vq_type *obs, vq_type *code_book, vq_type *codes_sqr,
+                     vq_type *low_dist, vq_work *w) nogil:
+    """
+    Processes blocks of observations for _vq, with the inner products
+    of a block with the codes in a buffer of the thread.
+    """
+    cdef np.npy_intp i, j, k, start, n
+    cdef np.npy_intp ncodes = w.ncodes, nfeat = w.nfeat
+    cdef vq_type *M = NULL
+    cdef vq_type *p_obs
+    cdef vq_type *p_M
+    cdef vq_type dist_sqr, obs_sqr
+
+    if nfeat >= NFEATURES_CUTOFF:
+        M = <vq_type *>malloc(w.block * ncodes * sizeof(vq_type))
+        if M == NULL:
+            _set_nomem(w)
+            return
+
+    k = _claim(w)
+    while k >= 0:
+        start = k * w.block
+        n = min(w.block, w.nobs - start)
+        p_obs = obs + start * nfeat
+
+        if M == NULL:
+            _vq_small_nf(p_obs, code_book, ncodes, nfeat, n,
+                         w.labels + start, low_dist + start)
+        else:
+            # M[i][j] is -2 times the inner product of the i-th obs of the
+            # block and the j-th code
+            cal_M(n, ncodes, nfeat, p_obs, code_book, M)
+
+            for i in range(n):
+                # the inner product of the observation with itself
+                obs_sqr = vec_sqr(nfeat, p_obs)
+                p_M = M + i * ncodes
+                for j in range(ncodes):
+                    dist_sqr = p_M[j] + obs_sqr + codes_sqr[j]
+                    if dist_sqr < low_dist[start + i]:
+                        w.labels[start + i] = j
+                        low_dist[start + i] = dist_sqr
+
+                # dist_sqr may be negative due to float point errors
+                if low_dist[start + i] > 0:
+                    low_dist[start + i] = sqrt(low_dist[start + i])
+                else:
+                    low_dist[start + i] = 0
+                p_obs += nfeat
+
+        k = _claim(w)
+
+    free(M)
+
+
+cdef void _vq_thread(void *arg) nogil:
+    cdef vq_work *w = <vq_work *>arg
+    if w.is_float:
+        _vq_blocks(<float32_t *>w.obs, <float32_t *>w.code_book,
+                   <float32_t *>w.code_aux, <float32_t *>w.dist, w)
+    else:
+        _vq_blocks(<float64_t *>w.obs, <float64_t *>w.code_book,
+                   <float64_t *>w.code_aux, <float64_t *>w.dist, w)
+
+
 cdef int _vq(vq_type *obs, vq_type *code_book,
              int ncodes, int nfeat, int nobs,
-             int32_t *codes, vq_type *low_dist) except -1:
+             int32_t *codes, vq_type *low_dist, int nthreads=1) except -1:
     """
     The underlying function (template) of _vq.vq.
 
@@ -82,33 +224,18 @@ cdef int _vq(vq_type *obs, vq_type *code_book,
     low_dist : vq_type*
         low_dist[i] is the Euclidean distance from obs[i] to the corresponding
         centroid.
+    nthreads : int
+        The number of threads processing blocks of observations.
     """
-    # Naive algorithm is preferred when nfeat is small
-    if nfeat < NFEATURES_CUTOFF:
-        _vq_small_nf(obs, code_book, ncodes, nfeat, nobs, codes, low_dist)
-        return 0
-
-    cdef np.npy_intp i, j
-    cdef vq_type *p_obs
+    cdef np.npy_intp i
     cdef vq_type *p_codes
-    cdef vq_type dist_sqr
-    cdef np.ndarray[vq_type, ndim=1] obs_sqr, codes_sqr
-    cdef np.ndarray[vq_type, ndim=2] M
+    cdef np.ndarray[vq_type, ndim=1] codes_sqr
+    cdef vq_work w
 
     if vq_type is float32_t:
-        obs_sqr = np.ndarray(nobs, np.float32)
         codes_sqr = np.ndarray(ncodes, np.float32)
-        M = np.ndarray((nobs, ncodes), np.float32)
     else:
-        obs_sqr = np.ndarray(nobs, np.float64)
         codes_sqr = np.ndarray(ncodes, np.float64)
-        M = np.ndarray((nobs, ncodes), np.float64)
-
-    p_obs = obs
-    for i in range(nobs):
-        # obs_sqr[i] is the inner product of the i-th observation with itself
-        obs_sqr[i] = vec_sqr(nfeat, p_obs)
-        p_obs += nfeat
 
     p_codes = code_book
     for i in range(ncodes):
@@ -116,30 +243,25 @@ cdef int _vq(vq_type *obs, vq_type *code_book,
         codes_sqr[i] = vec_sqr(nfeat, p_codes)
         p_codes += nfeat
 
-    # M[i][j] is the inner product of the i-th obs and j-th code
-    # M = obs * codes.T
-    cal_M(nobs, ncodes, nfeat, obs, code_book, <vq_type *>M.data)
-
-    for i in range(nobs):
-        for j in range(ncodes):
-            dist_sqr = (M[i, j] +
-                    obs_sqr[i] + codes_sqr[j])
-            if dist_sqr < low_dist[i]:
-                codes[i] = j
-                low_dist[i] = dist_sqr
-
-        # dist_sqr may be negative due to float point errors
-        if low_dist[i] > 0:
-            low_dist[i] = sqrt(low_dist[i])
-        else:
-            low_dist[i] = 0
+    w.is_float = vq_type is float32_t
+    w.obs = obs
+    w.code_book = code_book
+    w.code_aux = codes_sqr.data
+    w.labels = codes
+    w.dist = low_dist
+    w.nobs = nobs
+    w.ncodes = ncodes
+    w.nfeat = nfeat
+    w.block = max(1, min(nobs, BLOCK_ENTRIES // max(ncodes, 1)))
+    w.nblocks = (nobs + w.block - 1) // w.block
+    _run(&w, _vq_thread, nthreads)
 
     return 0
 
 
 cdef void _vq_small_nf(vq_type *obs, vq_type *code_book,
-                       int ncodes, int nfeat, int nobs,
-                       int32_t *codes, vq_type *low_dist):
+                       np.npy_intp ncodes, np.npy_intp nfeat, np.npy_intp nobs,
+                       int32_t *codes, vq_type *low_dist) nogil:
     """
     Vector quantization using naive algorithm.
     This is preferred when nfeat is small.
@@ -179,7 +301,7 @@ cdef void _vq_small_nf(vq_type *obs, vq_type *code_book,
         obs_offset += nfeat
 
 
-def vq(np.ndarray obs, np.ndarray codes):
+def vq(np.ndarray obs, np.ndarray codes, workers=1):
     """
     Vector quantization ndarray wrapper. Only support float32 and float64.
 
@@ -189,6 +311,8 @@ def vq(np.ndarray obs, np.ndarray codes):
         The observation matrix. Each row is an observation.
     codes : ndarray
         The code book matrix.
+    workers : int
+        The number of threads; -1 uses all CPUs.
 
     Notes
     -----
@@ -197,6 +321,7 @@ def vq(np.ndarray obs, np.ndarray codes):
     arrays are supported.
     """
     cdef int nobs, ncodes, nfeat
+    cdef int nthreads = _nthreads(workers)
     cdef np.ndarray outcodes, outdists
 
     # Ensure the arrays are contiguous
@@ -234,18 +359,58 @@ def vq(np.ndarray obs, np.ndarray codes):
     if obs.dtype.type is np.float32:
         _vq(<float32_t *>obs.data, <float32_t *>codes.data,
             ncodes, nfeat, nobs, <int32_t *>outcodes.data,
-            <float32_t *>outdists.data)
+            <float32_t *>outdists.data, nthreads)
     elif obs.dtype.type is np.float64:
         _vq(<float64_t *>obs.data, <float64_t *>codes.data,
             ncodes, nfeat, nobs, <int32_t *>outcodes.data,
-            <float64_t *>outdists.data)
+            <float64_t *>outdists.data, nthreads)
 
     return outcodes, outdists
 
 
+cdef void _sum_parts(vq_type *obs, vq_type *sums, vq_work *w) nogil:
+    """
+    Sums the observations of parts of the observation matrix by cluster,
+    into the sums and counts of each part.
+    """
+    cdef np.npy_intp i, j, k, label, start, stop
+    cdef np.npy_intp nc = w.ncodes, nfeat = w.nfeat
+    cdef vq_type *obs_p
+    cdef vq_type *cb_p
+    cdef int *count
+
+    k = _claim(w)
+    while k >= 0:
+        start = k * w.block
+        stop = min(start + w.block, w.nobs)
+        obs_p = obs + start * nfeat
+        count = w.counts + k * nc
+        for i in range(start, stop):
+            label = w.labels[i]
+            cb_p = sums + (k * nc + label) * nfeat
+
+            for j in range(nfeat):
+                cb_p[j] += obs_p[j]
+
+            # Count the obs in each cluster
+            count[label] += 1
+            obs_p += nfeat
+
+        k = _claim(w)
+
+
+cdef void _sum_parts_thread(void *arg) nogil:
+    cdef vq_work *w = <vq_work *>arg
+    if w.is_float:
+        _sum_parts(<float32_t *>w.obs, <float32_t *>w.dist, w)
+    else:
+        _sum_parts(<float64_t *>w.obs, <float64_t *>w.dist, w)
+
+
 @cython.cdivision(True)
 cdef np.ndarray _update_cluster_means(vq_type *obs, int32_t *labels,
-                                      vq_type *cb, int nobs, int nc, int nfeat):
+                                      vq_type *cb, int nobs, int nc, int nfeat,
+                                      int nthreads=1):
     """
     The underlying function (template) of _vq.update_cluster_means.
 
@@ -263,30 +428,54 @@ cdef np.ndarray _update_cluster_means(vq_type *obs, int32_t *labels,
         The number of centroids (codes).
     nfeat : int
         The number of features of each observation.
+    nthreads : int
+        The number of threads. The observations are split into this many
+        parts, summed separately and then added in order, so the result
+        only depends on the number of threads.
 
     Returns
     -------
     has_members : ndarray
         A boolean array indicating which clusters have members.
     """
-    cdef np.npy_intp i, j, cluster_size, label
-    cdef vq_type *obs_p
+    cdef np.npy_intp i, j, k, cluster_size
+    cdef np.npy_intp nparts = max(1, min(nthreads, nobs))
     cdef vq_type *cb_p
+    cdef vq_type *sums_p
+    cdef np.ndarray sums
+    cdef np.ndarray[int, ndim=2] part_count
     cdef np.ndarray[int, ndim=1] obs_count
+    cdef vq_work w
 
-    # Calculate the sums the numbers of obs in each cluster
-    obs_count = np.zeros(nc, np.intc)
-    obs_p = obs
-    for i in range(nobs):
-        label = labels[i]
-        cb_p = cb + nfeat * label
-
-        for j in range(nfeat):
-            cb_p[j] += obs_p[j]
+    # Calculate the sums the numbers of obs in each cluster, by part
+    if vq_type is float32_t:
+        sums = np.zeros((nparts, nc, nfeat), np.float32)
+    else:
+        sums = np.zeros((nparts, nc, nfeat), np.float64)
+    part_count = np.zeros((nparts, nc), np.intc)
+
+    w.is_float = vq_type is float32_t
+    w.obs = obs
+    w.labels = labels
+    w.dist = sums.data
+    w.counts = <int *>part_count.data
+    w.nobs = nobs
+    w.ncodes = nc
+    w.nfeat = nfeat
+    w.block = (nobs + nparts - 1) // nparts if nobs > 0 else 1
+    w.nblocks = (nobs + w.block - 1) // w.block
+    _run(&w, _sum_parts_thread, nthreads)
 
-        # Count the obs in each cluster
-        obs_count[label] += 1
-        obs_p += nfeat
+    obs_count = np.zeros(nc, np.intc)
+    sums_p = <vq_type *>sums.data
+    for k in range(nparts):
+        cb_p = cb
+        for i in range(nc):
+            for j in range(nfeat):
+                cb_p[j] += sums_p[j]
+            obs_count[i] += part_count[k, i]
+            cb_p += nfeat
+            sums_p += nfeat
 
     cb_p = cb
     for i in range(nc):
@@ -303,7 +492,8 @@ cdef np.ndarray _update_cluster_means(vq_type *obs, int32_t *labels,
     return obs_count > 0
 
 
-def update_cluster_means(np.ndarray obs, np.ndarray labels, int nc):
+def update_cluster_means(np.ndarray obs, np.ndarray labels, int nc,
+                         workers=1):
     """
     The update-step of K-means. Calculate the mean of observations in each
     cluster.
@@ -317,6 +507,9 @@ def update_cluster_means(np.ndarray obs, np.ndarray labels, int nc):
         The label of each observation. Must be an 1d array.
     nc : int
         The number of centroids.
+    workers : int
+        The number of threads; -1 uses all CPUs. The result depends on it
+        only through rounding.
 
     Returns
     -------
@@ -333,6 +526,7 @@ def update_cluster_means(np.ndarray obs, np.ndarray labels, int nc):
     """
     cdef np.ndarray has_members, cb
     cdef int nfeat
+    cdef int nthreads = _nthreads(workers)
 
     # Ensure the arrays are contiguous
     obs = np.ascontiguousarray(obs)
@@ -358,11 +552,259 @@ def update_cluster_means(np.ndarray obs, np.ndarray labels, int nc):
         has_members = _update_cluster_means(<float32_t *>obs.data,
                                             <int32_t *>labels.data,
                                             <float32_t *>cb.data,
-                                            obs.shape[0], nc, nfeat)
+                                            obs.shape[0], nc, nfeat, nthreads)
     elif obs.dtype.type is np.float64:
         has_members = _update_cluster_means(<float64_t *>obs.data,
                                             <int32_t *>labels.data,
                                             <float64_t *>cb.data,
-                                            obs.shape[0], nc, nfeat)
+                                            obs.shape[0], nc, nfeat, nthreads)
 
     return cb, has_members
+
+
+cdef inline vq_type _dist(np.npy_intp n, vq_type *x, vq_type *y) nogil:
+    cdef np.npy_intp i
+    cdef vq_type d, s = 0
+    for i in range(n):
+        d = x[i] - y[i]
+        s += d * d
+    return sqrt(s)
+
+
+cdef void _hamerly_blocks(vq_type *obs, vq_type *code_book, vq_type *half,
+                          vq_type *upper, vq_type *lower, vq_work *w) nogil:
+    """
+    Processes blocks of observations for _hamerly_assign.
+    """
+    cdef np.npy_intp i, j, k, start, stop, best
+    cdef np.npy_intp ncodes = w.ncodes, nfeat = w.nfeat
+    cdef vq_type *p_obs
+    cdef vq_type bound, d, d1, d2
+
+    k = _claim(w)
+    while k >= 0:
+        start = k * w.block
+        stop = min(start + w.block, w.nobs)
+        for i in range(start, stop):
+            best = w.labels[i]
+            bound = max(half[best], lower[i])
+            if upper[i] <= bound:
+                continue
+
+            # tighten the upper bound before scanning all the codes
+            p_obs = obs + i * nfeat
+            upper[i] = _dist(nfeat, p_obs, code_book + best * nfeat)
+            if upper[i] <= bound:
+                continue
+
+            d1 = INFINITY
+            d2 = INFINITY
+            for j in range(ncodes):
+                d = _dist(nfeat, p_obs, code_book + j * nfeat)
+                if d < d1:
+                    d2 = d1
+                    d1 = d
+                    best = j
+                elif d < d2:
+                    d2 = d
+            w.labels[i] = best
+            upper[i] = d1
+            lower[i] = d2
+
+        k = _claim(w)
+
+
+cdef void _hamerly_thread(void *arg) nogil:
+    cdef vq_work *w = <vq_work *>arg
+    if w.is_float:
+        _hamerly_blocks(<float32_t *>w.obs, <float32_t *>w.code_book,
+                        <float32_t *>w.code_aux, <float32_t *>w.dist,
+                        <float32_t *>w.lower, w)
+    else:
+        _hamerly_blocks(<float64_t *>w.obs, <float64_t *>w.code_book,
+                        <float64_t *>w.code_aux, <float64_t *>w.dist,
+                        <float64_t *>w.lower, w)
+
+
+cdef int _hamerly_assign(vq_type *obs, vq_type *code_book, int32_t *labels,
+                         vq_type *upper, vq_type *lower, int ncodes,
+                         int nfeat, int nobs, int nthreads) except -1:
+    """
+    The underlying function (template) of _vq.hamerly_assign.
+    """
+    cdef np.npy_intp i, j
+    cdef vq_type d
+    cdef np.ndarray[vq_type, ndim=1] half
+    cdef vq_work w
+
+    # half[i] is half the distance from the i-th code to the closest other
+    # one; an observation closer than that to its code keeps it
+    if vq_type is float32_t:
+        half = np.empty(ncodes, np.float32)
+    else:
+        half = np.empty(ncodes, np.float64)
+    half.fill(np.inf)
+    for i in range(ncodes):
+        for j in range(i + 1, ncodes):
+            d = _dist(nfeat, code_book + i * nfeat, code_book + j * nfeat) / 2
+            if d < half[i]:
+                half[i] = d
+            if d < half[j]:
+                half[j] = d
+
+    w.is_float = vq_type is float32_t
+    w.obs = obs
+    w.code_book = code_book
+    w.code_aux = half.data
+    w.labels = labels
+    w.dist = upper
+    w.lower = lower
+    w.nobs = nobs
+    w.ncodes = ncodes
+    w.nfeat = nfeat
+    w.block = max(1, min(nobs, BLOCK_ENTRIES // max(ncodes, 1)))
+    w.nblocks = (nobs + w.block - 1) // w.block
+    _run(&w, _hamerly_thread, nthreads)
+
+    return 0
+
+
+def hamerly_assign(np.ndarray obs, np.ndarray code_book, np.ndarray labels,
+                   np.ndarray upper, np.ndarray lower, workers=1):
+    """
+    The assignment step of K-means with Hamerly's bounds, in place.
+
+    Parameters
+    ----------
+    obs : ndarray
+        The observation matrix, contiguous. Each row is an observation. Its
+        dtype must be float32 or float64.
+    code_book : ndarray
+        The code book matrix, contiguous and of the same dtype as `obs`.
+    labels : ndarray
+        The current label of each observation, contiguous int32.
+    upper, lower : ndarray
+        Contiguous arrays of the dtype of `obs`. An upper bound on the
+        distance of each observation to the code of its label, and a lower
+        bound on its distance to any other code.
+    workers : int
+        The number of threads; -1 uses all CPUs.
+
+    Notes
+    -----
+    The labels and bounds are updated to the nearest codes. Initially, all
+    labels may be 0 with `upper` infinite and `lower` zero. When the codes
+    move by ``delta``, the bounds remain valid after ``upper +=
+    delta[labels]`` and ``lower -= delta.max()``. Only the observations
+    whose bounds do not prove that their label is unchanged are compared
+    with all the codes.
+    """
+    cdef int nobs, ncodes, nfeat
+    cdef int nthreads = _nthreads(workers)
+
+    if obs.dtype not in (np.float32, np.float64):
+        raise TypeError('type other than float or double not supported')
+    for a in (code_book, upper, lower):
+        if a.dtype != obs.dtype:
+            raise TypeError('arrays should have the same dtype as obs')
+    if labels.dtype.type is not np.int32:
+        raise TypeError('labels should be int32')
+    for a in (obs, code_book, labels, upper, lower):
+        if not a.flags.c_contiguous:
+            raise ValueError('arrays should be contiguous')
+
+    nobs = obs.shape[0]
+    ncodes = code_book.shape[0]
+    nfeat = 1 if obs.ndim == 1 else obs.shape[1]
+    if obs.ndim != code_book.ndim or (obs.ndim == 2 and
+                                      code_book.shape[1] != nfeat):
+        raise ValueError('obs and code should have same number of '
+                         'features (columns)')
+    if labels.size != nobs or upper.size != nobs or lower.size != nobs:
+        raise ValueError('labels and bounds should have one entry per '
+                         'observation')
+
+    if obs.dtype.type is np.float32:
+        _hamerly_assign(<float32_t *>obs.data, <float32_t *>code_book.data,
+                        <int32_t *>labels.data, <float32_t *>upper.data,
+                        <float32_t *>lower.data, ncodes, nfeat, nobs,
+                        nthreads)
+    else:
+        _hamerly_assign(<float64_t *>obs.data, <float64_t *>code_book.data,
+                        <int32_t *>labels.data, <float64_t *>upper.data,
+                        <float64_t *>lower.data, ncodes, nfeat, nobs,
+                        nthreads)
+
+
+@cython.cdivision(True)
+cdef void _minibatch_update(vq_type *obs, int32_t *labels, float64_t *cb,
+                            np.int64_t *counts, np.npy_intp nobs,
+                            np.npy_intp nfeat) nogil:
+    """
+    The underlying function (template) of _vq.minibatch_update.
+    """
+    cdef np.npy_intp i, j, label
+    cdef float64_t eta
+    cdef float64_t *cb_p
+
+    for i in range(nobs):
+        label = labels[i]
+        cb_p = cb + label * nfeat
+        counts[label] += 1
+        # each centroid is the running mean of the observations assigned
+        # to it so far
+        eta = 1.0 / counts[label]
+        for j in range(nfeat):
+            cb_p[j] += eta * (obs[j] - cb_p[j])
+        obs += nfeat
+
+
+def minibatch_update(np.ndarray obs, np.ndarray labels, np.ndarray cb,
+                     np.ndarray counts):
+    """
+    The update-step of mini-batch K-means, in place. Moves the code of each
+    observation towards it, by the inverse of the number of observations
+    assigned to the code so far.
+
+    Parameters
+    ----------
+    obs : ndarray
+        The observation matrix, contiguous. Each row is an observation. Its
+        dtype must be float32 or float64.
+    labels : ndarray
+        The label of each observation, contiguous int32.
+    cb : ndarray
+        The code book, contiguous float64.
+    counts : ndarray
+        The number of observations assigned to each code so far, contiguous
+        int64.
+    """
+    cdef np.npy_intp nobs, nfeat
+
+    if obs.dtype not in (np.float32, np.float64):
+        raise TypeError('type other than float or double not supported')
+    if cb.dtype.type is not np.float64 or counts.dtype.type is not np.int64:
+        raise TypeError('cb should be float64 and counts int64')
+    if labels.dtype.type is not np.int32:
+        raise TypeError('labels should be int32')
+    for a in (obs, labels, cb, counts):
+        if not a.flags.c_contiguous:
+            raise ValueError('arrays should be contiguous')
+
+    nobs = obs.shape[0]
+    nfeat = 1 if obs.ndim == 1 else obs.shape[1]
+    if labels.size != nobs or cb.size != counts.size * nfeat:
+        raise ValueError('inconsistent sizes of obs, labels, cb and counts')
+    if nobs > 0 and (labels.min() < 0 or labels.max() >= counts.size):
+        raise ValueError('labels out of range')
+
+    if obs.dtype.type is np.float32:
+        with nogil:
+            _minibatch_update(<float32_t *>obs.data, <int32_t *>labels.data,
+                              <float64_t *>cb.data,
+                              <np.int64_t *>counts.data, nobs, nfeat)
+    else:
+        with nogil:
+            _minibatch_update(<float64_t *>obs.data, <int32_t *>labels.data,
+                              <float64_t *>cb.data,
+                              <np.int64_t *>counts.data, nobs, nfeat)
@@ -21,6 +21,7 @@ These are routines for agglomerative clustering.
    :toctree: generated/
 
    linkage
+   linkage_vector
    single
    complete
    average
@@ -125,6 +126,7 @@ from __future__ import division, print_function, absolute_import
 import warnings
 import bisect
 from collections import deque
+from multiprocessing import cpu_count
 
 import numpy as np
 from . import _hierarchy, _optimal_leaf_ordering
@@ -141,8 +143,8 @@ __all__ = ['ClusterNode', 'average', 'centroid', 'complete', 'cophenet',
            'correspond', 'cut_tree', 'dendrogram', 'fcluster', 'fclusterdata',
            'from_mlab_linkage', 'inconsistent', 'is_isomorphic',
            'is_monotonic', 'is_valid_im', 'is_valid_linkage', 'leaders',
-           'leaves_list', 'linkage', 'maxRstat', 'maxdists', 'maxinconsts',
-           'median', 'num_obs_linkage', 'optimal_leaf_ordering',
+           'leaves_list', 'linkage', 'linkage_vector', 'maxRstat', 'maxdists',
+           'maxinconsts', 'median', 'num_obs_linkage', 'optimal_leaf_ordering',
            'set_link_color_palette', 'single', 'to_mlab_linkage', 'to_tree',
            'ward', 'weighted', 'distance']
 
@@ -830,7 +832,8 @@ def ward(y):
     return linkage(y, method='ward', metric='euclidean')
 
 
-def linkage(y, method='single', metric='euclidean', optimal_ordering=False):
+def linkage(y, method='single', metric='euclidean', optimal_ordering=False,
+            workers=1):
     """
     Perform hierarchical/agglomerative clustering.
 
@@ -986,6 +989,12 @@ def linkage(y, method='single', metric='euclidean', optimal_ordering=False):
         also the `optimal_leaf_ordering` function.
 
         .. versionadded:: 1.0.0
+    workers : int, optional
+        Number of threads updating the distances between clusters, for
+        methods other than 'single'; -1 uses all CPUs. Threads are only used
+        while there are many clusters. Default: 1
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -1063,13 +1072,14 @@ def linkage(y, method='single', metric='euclidean', optimal_ordering=False):
 
     n = int(distance.num_obs_y(y))
     method_code = _LINKAGE_METHODS[method]
+    nthreads = _nthreads(workers)
 
     if method == 'single':
         result = _hierarchy.mst_single_linkage(y, n)
     elif method in ['complete', 'average', 'weighted', 'ward']:
-        result = _hierarchy.nn_chain(y, n, method_code)
+        result = _hierarchy.nn_chain(y, n, method_code, nthreads)
     else:
-        result = _hierarchy.fast_linkage(y, n, method_code)
+        result = _hierarchy.fast_linkage(y, n, method_code, nthreads)
 
     if optimal_ordering:
         return optimal_leaf_ordering(result, y)
@@ -1077,6 +1087,80 @@ def linkage(y, method='single', metric='euclidean', optimal_ordering=False):
         return result
 
 
+def linkage_vector(X, method='single'):
+    """
+    Perform hierarchical/agglomerative clustering of observation vectors.
+
+    The result is that of ``linkage(X, method)`` for the Euclidean metric,
+    but the pairwise distances are not stored: the distances between
+    observations, or between the centers of clusters, are computed when
+    needed. The memory use is then :math:`O(n)` instead of :math:`O(n^2)`
+    for :math:`n` observations, which allows clustering large data sets.
+
+    Parameters
+    ----------
+    X : ndarray
+        A :math:`n` by :math:`m` array of :math:`n` observation vectors in
+        :math:`m` dimensions.
+    method : str, optional
+        The linkage algorithm to use: 'single', 'centroid', 'median' or
+        'ward', as for `linkage`.
+
+    Returns
+    -------
+    Z : ndarray
+        The hierarchical clustering encoded as a linkage matrix.
+
+    See Also
+    --------
+    linkage : clustering from observations or pairwise distances.
+
+    Notes
+    -----
+    For method 'single' the minimum spanning tree is built with Prim's
+    algorithm, and for 'ward' the nearest-neighbors chain algorithm is used,
+    in :math:`O(n^2 m)` time. Methods 'centroid' and 'median' do not
+    allow the nearest-neighbors chain; they use the generic algorithm of
+    [1]_, whose worst case time complexity is :math:`O(n^3 m)`.
+
+    The distances are rounded differently than in `linkage`, so that
+    clusters at equal distances may be merged in a different order.
+
+    .. versionadded:: 1.4.0
+
+    References
+    ----------
+    .. [1] Daniel Mullner, "Modern hierarchical, agglomerative clustering
+           algorithms", :arXiv:`1109.2378v1`.
+
+    Examples
+    --------
+    >>> from scipy.cluster.hierarchy import linkage, linkage_vector
+    >>> np.random.seed(1234)
+    >>> X = np.random.rand(100, 3)
+    >>> np.allclose(linkage_vector(X, 'ward'), linkage(X, 'ward'))
+    True
+
+    """
+    if method not in ('single', 'centroid', 'median', 'ward'):
+        raise ValueError("Invalid method: {0}".format(method))
+
+    X = _convert_to_double(np.asarray(X, order='c'))
+    if X.ndim != 2:
+        raise ValueError("`X` must be 2 dimensional.")
+    if X.shape[0] < 2:
+        raise ValueError("At least two observations are required.")
+    if not np.all(np.isfinite(X)):
+        raise ValueError("`X` must contain only finite values.")
+
+    if method == 'single':
+        return _hierarchy.mst_single_linkage_vector(X)
+    elif method == 'ward':
+        return _hierarchy.nn_chain_vector(X, _LINKAGE_METHODS[method])
+    else:
+        return _hierarchy.fast_linkage_vector(X, _LINKAGE_METHODS[method])
+
+
 class ClusterNode(object):
     """
     A tree node class for representing a cluster.
@@ -1559,6 +1643,10 @@ def _convert_to_bool(X):
     return X
 
 
+def _nthreads(workers):
+    return cpu_count() if workers == -1 else max(int(workers), 1)
+
+
 def _convert_to_double(X):
     if X.dtype != np.double:
         X = X.astype(np.double)
@@ -1567,7 +1655,7 @@ def _convert_to_double(X):
     return X
 
 
-def cophenet(Z, Y=None):
+def cophenet(Z, Y=None, workers=1):
     """
     Calculate the cophenetic distances between each observation in
     the hierarchical clustering defined by the linkage ``Z``.
@@ -1590,6 +1678,11 @@ def cophenet(Z, Y=None):
         of a set of :math:`n` observations in :math:`m`
         dimensions. `Y` is the condensed distance matrix from which
         `Z` was generated.
+    workers : int, optional
+        Number of threads filling the cophenetic distance matrix; -1 uses
+        all CPUs. Default: 1
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -1682,7 +1775,7 @@ def cophenet(Z, Y=None):
     # The dimensions are used instead.
     Z = _convert_to_double(Z)
 
-    _hierarchy.cophenetic_distances(Z, zz, int(n))
+    _hierarchy.cophenetic_distances(Z, zz, int(n), _nthreads(workers))
     if Y is None:
         return zz
 
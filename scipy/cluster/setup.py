@@ -1,6 +1,7 @@
 from __future__ import division, print_function, absolute_import
 
 import sys
+from os.path import join
 
 if sys.version_info[0] >= 3:
     DEFINE_MACROS = [("SCIPY_PY3K", None)]
@@ -17,14 +18,17 @@ def configuration(parent_package='', top_path=None):
 
     config.add_data_dir('tests')
 
+    zeros_dir = join('..', 'optimize', 'Zeros')
     config.add_extension('_vq',
         sources=[('_vq.c')],
-        include_dirs=[get_numpy_include_dirs()],
+        include_dirs=[get_numpy_include_dirs(), zeros_dir],
+        depends=[join(zeros_dir, 'zeros_threads.h')],
         extra_info=blas_opt)
 
     config.add_extension('_hierarchy',
         sources=[('_hierarchy.c')],
-        include_dirs=[get_numpy_include_dirs()])
+        include_dirs=[get_numpy_include_dirs(), zeros_dir],
+        depends=[join(zeros_dir, 'zeros_threads.h')])
 
     config.add_extension('_optimal_leaf_ordering',
         sources=[('_optimal_leaf_ordering.c')],
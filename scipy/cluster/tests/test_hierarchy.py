@@ -42,14 +42,14 @@ from scipy._lib.six import xrange, u
 
 import scipy.cluster.hierarchy
 from scipy.cluster.hierarchy import (
-    ClusterWarning, linkage, from_mlab_linkage, to_mlab_linkage,
-    num_obs_linkage, inconsistent, cophenet, fclusterdata, fcluster,
-    is_isomorphic, single, leaders, complete, weighted, centroid,
+    ClusterWarning, linkage, linkage_vector, from_mlab_linkage,
+    to_mlab_linkage, num_obs_linkage, inconsistent, cophenet, fclusterdata,
+    fcluster, is_isomorphic, single, leaders, complete, weighted, centroid,
     correspond, is_monotonic, maxdists, maxinconsts, maxRstat,
     is_valid_linkage, is_valid_im, to_tree, leaves_list, dendrogram,
     set_link_color_palette, cut_tree, optimal_leaf_ordering,
     _order_cluster_tree, _hierarchy, _LINKAGE_METHODS)
-from scipy.spatial.distance import pdist
+from scipy.spatial.distance import pdist, squareform
 from scipy.cluster._hierarchy import Heap
 
 from . import hierarchy_test_data
@@ -106,6 +106,20 @@ class TestLinkage(object):
         Z = linkage(y, method)
         assert_allclose(Z, expectedZ, atol=1e-06)
 
+        Z = linkage_vector(hierarchy_test_data.X, method)
+        assert_allclose(Z, expectedZ, atol=1e-06)
+
+    @pytest.mark.parametrize('method', ['single', 'centroid', 'median', 'ward'])
+    def test_linkage_vector(self, method):
+        rng = np.random.RandomState(0)
+        X = rng.rand(200, 3)
+        assert_allclose(linkage_vector(X, method), linkage(X, method),
+                        rtol=1e-10)
+
+        assert_raises(ValueError, linkage_vector, X, 'complete')
+        assert_raises(ValueError, linkage_vector, X[:1], method)
+        assert_raises(ValueError, linkage_vector, X[0], method)
+
     def test_compare_with_trivial(self):
         rng = np.random.RandomState(0)
         n = 20
@@ -182,6 +196,25 @@ class TestCopheneticDistance(object):
         assert_allclose(c, expectedc, atol=1e-10)
         assert_allclose(M, expectedM, atol=1e-10)
 
+    @pytest.mark.parametrize('method', ['single', 'average', 'centroid'])
+    def test_cophenet_workers(self, method):
+        rng = np.random.RandomState(0)
+        X = rng.rand(500, 2)
+        Z = linkage(X, method)
+        assert_equal(linkage(X, method, workers=4), Z)
+
+        # all the pairs of leaves joined at each merge
+        M = np.zeros((500, 500))
+        leaves = [[i] for i in range(500)]
+        for a, b, dist, _ in Z:
+            a, b = leaves[int(a)], leaves[int(b)]
+            M[np.ix_(a, b)] = M[np.ix_(b, a)] = dist
+            leaves.append(a + b)
+        expected = squareform(M, checks=False)
+
+        assert_equal(cophenet(Z), expected)
+        assert_equal(cophenet(Z, workers=4), expected)
+
 
 class TestMLabLinkageConversion(object):
     def test_mlab_linkage_conversion_empty(self):
@@ -11,8 +11,8 @@ from scipy._lib._numpy_compat import suppress_warnings
 import pytest
 from pytest import raises as assert_raises
 
-from scipy.cluster.vq import (kmeans, kmeans2, py_vq, vq, whiten,
-                              ClusterError, _krandinit)
+from scipy.cluster.vq import (kmeans, kmeans2, kmeans_minibatch, py_vq, vq,
+                              whiten, ClusterError, _krandinit)
 from scipy.cluster import _vq
 from scipy.sparse.sputils import matrix
 
@@ -171,6 +171,22 @@ class TestVq(object):
         assert_allclose(dis0, dis1, 1e-5)
         assert_array_equal(codes0, codes1)
 
+    @pytest.mark.parametrize('dtype', [np.float32, np.float64])
+    @pytest.mark.parametrize('nfeat', [2, 20])
+    def test_vq_workers(self, dtype, nfeat):
+        # several blocks of observations, shared between the threads
+        np.random.seed(1234)
+        X = np.random.rand(5000, nfeat).astype(dtype)
+        code_book = np.random.rand(40, nfeat).astype(dtype)
+
+        codes0, dis0 = _vq.vq(X, code_book)
+        codes1, dis1 = vq(X, code_book, workers=4)
+        assert_array_equal(codes0, codes1)
+        assert_array_equal(dis0, dis1)
+        codes2, dis2 = py_vq(X, code_book)
+        assert_array_equal(codes0, codes2)
+        assert_allclose(dis0, dis2, rtol=1e-4)
+
 
 class TestKMean(object):
     def test_large_features(self):
@@ -289,3 +305,72 @@ class TestKMean(object):
         res = kmeans(x, 1, thresh=1e16)
         assert_allclose(res[0], np.array([4.]))
         assert_allclose(res[1], 2.3999999999999999)
+
+    def test_kmeans2_workers(self):
+        np.random.seed(1234)
+        data = np.concatenate([np.random.randn(300, 3) + c
+                               for c in 4 * np.eye(3)])
+        init = data[[0, 300, 600]]
+
+        # the plain algorithm
+        code_book = init
+        for i in range(10):
+            label = vq(data, code_book)[0]
+            code_book = _vq.update_cluster_means(data, label, 3)[0]
+
+        for workers in [1, 4]:
+            res = kmeans2(data, init, iter=10, minit='matrix',
+                          workers=workers)
+            assert_allclose(res[0], code_book, rtol=1e-12)
+            assert_array_equal(res[1], label)
+
+    def test_update_cluster_means_workers(self):
+        np.random.seed(1234)
+        obs = np.random.rand(1000, 4)
+        labels = np.random.randint(0, 10, 1000).astype(np.int32)
+        cb0, has0 = _vq.update_cluster_means(obs, labels, 12)
+        cb1, has1 = _vq.update_cluster_means(obs, labels, 12, workers=4)
+        assert_allclose(cb0, cb1, rtol=1e-13)
+        assert_array_equal(has0, has1)
+        assert_array_equal(has0, np.arange(12) < 10)
+
+    def test_kmeans_minibatch(self):
+        np.random.seed(1234)
+        centers = np.array([[0., 0.], [10., 0.], [0., 10.]])
+        data = np.concatenate([np.random.randn(2000, 2) + c for c in centers])
+        np.random.shuffle(data)
+
+        res = kmeans_minibatch(data, centers + 1, batch_size=500, iter=2)
+        assert_allclose(res[0], centers, atol=0.1)
+        assert_array_equal(res[1], [4000, 4000, 4000])
+
+        def chunks():
+            for i in range(0, data.shape[0], 700):
+                yield data[i:i + 700]
+
+        res = kmeans_minibatch(chunks(), centers + 1, batch_size=256)
+        assert_allclose(res[0], centers, atol=0.1)
+        assert_array_equal(res[1], [2000, 2000, 2000])
+
+        # the running means of the observations of each centroid
+        label = vq(data, res[0])[0]
+        assert_allclose(res[0], _vq.update_cluster_means(data, label, 3)[0],
+                        atol=0.05)
+
+        res = kmeans_minibatch(data, 3, batch_size=100, minit='++')
+        assert_equal(res[0].shape, (3, 2))
+        assert_equal(res[1].sum(), data.shape[0])
+
+    def test_kmeans_minibatch_errors(self):
+        data = np.random.rand(100, 2)
+        assert_raises(ValueError, kmeans_minibatch, data, 0)
+        assert_raises(ValueError, kmeans_minibatch, data, 20, batch_size=10)
+        assert_raises(ValueError, kmeans_minibatch, data, 2, batch_size=0)
+        assert_raises(ValueError, kmeans_minibatch, data, np.ones((2, 3)))
+        assert_raises(ValueError, kmeans_minibatch, iter([]), 2)
+        assert_raises(ValueError, kmeans_minibatch,
+                      iter([data, np.random.rand(10, 3)]), 2)
+        with pytest.warns(UserWarning):
+            kmeans_minibatch(data, [[0., 0.], [100., 100.]])
+        assert_raises(ClusterError, kmeans_minibatch, data,
+                      [[0., 0.], [100., 100.]], missing='raise')
@@ -14,6 +14,7 @@ centroids in a code book.
    kmeans -- Performs k-means on a set of observation vectors forming k clusters
    kmeans2 -- A different implementation of k-means with more methods
            -- for initializing centroids
+   kmeans_minibatch -- Mini-batch k-means for large or streamed observations
 
 Background information
 ----------------------
@@ -77,7 +78,7 @@ from . import _vq
 
 __docformat__ = 'restructuredtext'
 
-__all__ = ['whiten', 'vq', 'kmeans', 'kmeans2']
+__all__ = ['whiten', 'vq', 'kmeans', 'kmeans2', 'kmeans_minibatch']
 
 
 class ClusterError(Exception):
@@ -140,7 +141,7 @@ def whiten(obs, check_finite=True):
     return obs / std_dev
 
 
-def vq(obs, code_book, check_finite=True):
+def vq(obs, code_book, check_finite=True, workers=1):
     """
     Assign codes from a code book to observations.
 
@@ -176,6 +177,11 @@ def vq(obs, code_book, check_finite=True):
         Disabling may give a performance gain, but may result in problems
         (crashes, non-termination) if the inputs do contain infinities or NaNs.
         Default: True
+    workers : int, optional
+        Number of threads assigning blocks of observations, for float32 and
+        float64 input; -1 uses all CPUs. Default: 1
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -206,7 +212,7 @@ def vq(obs, code_book, check_finite=True):
     c_code_book = code_book.astype(ct, copy=False)
 
     if np.issubdtype(ct, np.float64) or np.issubdtype(ct, np.float32):
-        return _vq.vq(c_obs, c_code_book)
+        return _vq.vq(c_obs, c_code_book, workers)
     return py_vq(obs, code_book, check_finite=False)
 
 
@@ -590,7 +596,7 @@ _valid_miss_meth = {'warn': _missing_warn, 'raise': _missing_raise}
 
 
 def kmeans2(data, k, iter=10, thresh=1e-5, minit='random',
-            missing='warn', check_finite=True):
+            missing='warn', check_finite=True, workers=1):
     """
     Classify a set of observations into k clusters using the k-means algorithm.
 
@@ -641,6 +647,12 @@ def kmeans2(data, k, iter=10, thresh=1e-5, minit='random',
         Disabling may give a performance gain, but may result in problems
         (crashes, non-termination) if the inputs do contain infinities or NaNs.
         Default: True
+    workers : int, optional
+        Number of threads for the assignment and update steps, for float32
+        and float64 data; -1 uses all CPUs. The centroids depend on it only
+        through rounding. Default: 1
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -651,11 +663,21 @@ def kmeans2(data, k, iter=10, thresh=1e-5, minit='random',
         label[i] is the code or index of the centroid the
         i'th observation is closest to.
 
+    Notes
+    -----
+    For float32 and float64 data, the assignment step keeps for each
+    observation an upper bound on the distance to its centroid and a lower
+    bound on the distance to the others, as in [2]_, and only compares the
+    observations whose bounds may have crossed with all the centroids. The
+    labels are those of the plain algorithm.
+
     References
     ----------
     .. [1] D. Arthur and S. Vassilvitskii, "k-means++: the advantages of
        careful seeding", Proceedings of the Eighteenth Annual ACM-SIAM Symposium
        on Discrete Algorithms, 2007.
+    .. [2] G. Hamerly, "Making k-means even faster", Proceedings of the 2010
+       SIAM International Conference on Data Mining, 2010.
     """
     if int(iter) < 1:
         raise ValueError("Invalid iter (%s), "
@@ -700,15 +722,205 @@ def kmeans2(data, k, iter=10, thresh=1e-5, minit='random',
         else:
             code_book = init_meth(data, k)
 
+    bounded = data.dtype in (np.float32, np.float64)
+    if bounded:
+        # the bounds of the assignment step, which compares every
+        # observation with all the centroids the first time
+        data = np.ascontiguousarray(data)
+        code_book = np.ascontiguousarray(code_book, dtype=data.dtype)
+        label = np.zeros(data.shape[0], dtype=np.int32)
+        upper = np.full(data.shape[0], np.inf, dtype=data.dtype)
+        lower = np.zeros(data.shape[0], dtype=data.dtype)
+
     for i in xrange(iter):
         # Compute the nearest neighbor for each obs using the current code book
-        label = vq(data, code_book)[0]
+        if bounded:
+            _vq.hamerly_assign(data, code_book, label, upper, lower, workers)
+        else:
+            label = vq(data, code_book, workers=workers)[0]
         # Update the code book by computing centroids
-        new_code_book, has_members = _vq.update_cluster_means(data, label, nc)
+        new_code_book, has_members = _vq.update_cluster_means(data, label, nc,
+                                                              workers)
         if not has_members.all():
             miss_meth()
             # Set the empty clusters to their previous positions
             new_code_book[~has_members] = code_book[~has_members]
+        if bounded:
+            shift = new_code_book - code_book
+            shift = np.sqrt((shift * shift).reshape(nc, -1).sum(axis=1))
+            upper += shift[label]
+            lower -= shift.max()
         code_book = new_code_book
 
     return code_book, label
+
+
+def _minibatches(data, batch_size, iter):
+    """Yields the batches of `kmeans_minibatch`, as arrays."""
+    if hasattr(data, 'shape'):
+        # an array or memmap: contiguous slices, in a new random order for
+        # each pass
+        nobs = data.shape[0]
+        starts = np.arange(0, nobs, batch_size)
+        for i in xrange(iter):
+            for start in np.random.permutation(starts):
+                yield data[start:start + batch_size]
+    else:
+        for chunk in data:
+            chunk = np.asarray(chunk)
+            for start in xrange(0, max(chunk.shape[0], 1), batch_size):
+                yield chunk[start:start + batch_size]
+
+
+def kmeans_minibatch(data, k, batch_size=1024, iter=1, minit='points',
+                     missing='warn', check_finite=True, workers=1):
+    """
+    Mini-batch k-means for large or streamed sets of observations.
+
+    The observations are processed in batches of `batch_size`: each batch
+    is assigned to the nearest centroids, and each centroid is then moved
+    towards its observations so that it is the running mean of all the
+    observations assigned to it so far [1]_. Only one batch is held in
+    memory at a time, so the data may be a memory-mapped array or a stream
+    of chunks larger than the memory.
+
+    Parameters
+    ----------
+    data : ndarray or iterable of ndarray
+        A 'M' by 'N' array of 'M' observations in 'N' dimensions or a length
+        'M' array of 'M' one-dimensional observations, such as a
+        `numpy.memmap`, or an iterable of such arrays with the same number
+        of dimensions, which is consumed once.
+    k : int or ndarray
+        The number of clusters to form, or the initial centroids as for
+        `kmeans2`.
+    batch_size : int, optional
+        Number of observations per batch. The initial centroids are chosen
+        from the first batch, which must then have at least `k`
+        observations. Default: 1024
+    iter : int, optional
+        Number of passes over `data` if it is an array, in which case the
+        batches are taken in a random order. Ignored for iterables.
+        Default: 1
+    minit : str, optional
+        Method for initialization from the first batch, as for `kmeans2`:
+        'random', 'points' or '++'. Default: 'points'
+    missing : str, optional
+        What to do if some centroid was assigned no observation, as for
+        `kmeans2`: 'warn' or 'raise'. Default: 'warn'
+    check_finite : bool, optional
+        Whether to check that the batches contain only finite numbers.
+        Default: True
+    workers : int, optional
+        Number of threads for the assignment steps; -1 uses all CPUs.
+        Default: 1
+
+    Returns
+    -------
+    centroid : ndarray
+        A 'k' by 'N' array of centroids, of dtype float64.
+    count : ndarray
+        count[i] is the number of observations assigned to the i'th
+        centroid, over all the passes.
+
+    See Also
+    --------
+    kmeans2 : k-means on observations held in memory.
+    vq : assign the observations to the centroids found.
+
+    Notes
+    -----
+    The centroids are the running means of their observations, whose
+    labels are those of the nearest centroid at the time their batch was
+    processed. The labels of the observations for the final centroids can
+    be computed batch by batch with `vq`.
+
+    .. versionadded:: 1.4.0
+
+    References
+    ----------
+    .. [1] D. Sculley, "Web-scale k-means clustering", Proceedings of the
+       19th International Conference on World Wide Web, 2010.
+
+    Examples
+    --------
+    >>> from scipy.cluster.vq import kmeans_minibatch
+    >>> np.random.seed(1234)
+    >>> def chunks():
+    ...     for i in range(100):
+    ...         yield np.random.randn(1000, 2) + [[0, 0], [10, 10]][i % 2]
+    >>> centroid, count = kmeans_minibatch(chunks(), [[1., 1.], [9., 9.]])
+    >>> np.abs(centroid - [[0, 0], [10, 10]]).max() < 0.05
+    True
+    >>> count.sum()
+    100000
+
+    """
+    if int(batch_size) < 1:
+        raise ValueError("Invalid batch_size (%s), "
+                         "must be a positive integer." % batch_size)
+    if int(iter) < 1:
+        raise ValueError("Invalid iter (%s), "
+                         "must be a positive integer." % iter)
+    try:
+        miss_meth = _valid_miss_meth[missing]
+    except KeyError:
+        raise ValueError("Unknown missing method %r" % (missing,))
+
+    code_book = None
+    counts = None
+    for batch in _minibatches(data, int(batch_size), int(iter)):
+        batch = _asarray_validated(batch, check_finite=check_finite)
+        batch = np.ascontiguousarray(batch, dtype=np.float64)
+        if batch.ndim not in (1, 2):
+            raise ValueError("Input of rank > 2 is not supported.")
+
+        if code_book is None:
+            code_book = _kmeans_minibatch_init(batch, k, minit)
+            counts = np.zeros(code_book.shape[0], dtype=np.int64)
+        if (batch.ndim != code_book.ndim or
+                batch.shape[1:] != code_book.shape[1:]):
+            raise ValueError("All the batches should have the dimensions "
+                             "of the centroids.")
+        if batch.shape[0] == 0:
+            continue
+
+        label = _vq.vq(batch, code_book, workers)[0]
+        _vq.minibatch_update(batch, label, code_book, counts)
+
+    if code_book is None:
+        raise ValueError("Empty input is not supported.")
+    if not counts.all():
+        miss_meth()
+
+    return code_book, counts
+
+
+def _kmeans_minibatch_init(batch, k, minit):
+    """Initial centroids of `kmeans_minibatch`, as a float64 array."""
+    if not np.isscalar(k):
+        code_book = np.array(k, dtype=np.float64)
+        if batch.ndim != code_book.ndim:
+            raise ValueError("k array doesn't match data rank")
+        if batch.ndim > 1 and code_book.shape[1] != batch.shape[1]:
+            raise ValueError("k array doesn't match data dimension")
+        if code_book.shape[0] < 1:
+            raise ValueError("Cannot ask kmeans_minibatch for 0 clusters")
+        return np.ascontiguousarray(code_book)
+
+    nc = int(k)
+    if nc < 1:
+        raise ValueError("Cannot ask kmeans_minibatch for %d clusters"
+                         " (k was %s)" % (nc, k))
+    elif nc != k:
+        warnings.warn("k was not an integer, was converted.")
+    if batch.shape[0] < nc:
+        raise ValueError("The first batch has fewer than k observations.")
+
+    try:
+        init_meth = _valid_init_meth[minit]
+    except KeyError:
+        raise ValueError("Unknown init method %r" % (minit,))
+    code_book = init_meth(batch, nc)
+    return np.ascontiguousarray(code_book, dtype=np.float64).reshape(
+        (nc,) + batch.shape[1:])
@@ -1,6 +1,6 @@
 from . import _pocketfft
 
-def fft(x, n=None, axis=-1, norm=None, overwrite_x=False):
+def fft(x, n=None, axis=-1, norm=None, overwrite_x=False, workers=None):
     """
     Compute the one-dimensional discrete Fourier Transform.
 
@@ -27,6 +27,10 @@ def fft(x, n=None, axis=-1, norm=None, overwrite_x=False):
     overwrite_x : bool, optional
         If True, the contents of `x` can be destroyed; the default is False.
         See the notes below for more details.
+    workers : int, optional
+        Maximum number of workers to use for parallel computation. If negative,
+        the value wraps around from ``os.cpu_count()``.
+        See below for more details.
 
     Returns
     -------
@@ -88,6 +92,13 @@ def fft(x, n=None, axis=-1, norm=None, overwrite_x=False):
     rely on the contents of ``x`` after the transform as this may change in
     future without warning.
 
+    The ``workers`` argument specifies the maximum number of parallel jobs to
+    split the FFT computation into. The transform is split over the lines of
+    ``x`` along the transformed axis, so a single 1-D transform runs on one
+    thread regardless. Jobs run on a pool of threads that is started on first
+    use and kept for later calls. ``workers=-1`` uses all threads returned by
+    ``os.cpu_count()``.
+
     References
     ----------
     .. [1] Cooley, James W., and John W. Tukey, 1965, "An algorithm for the
@@ -120,10 +131,10 @@ def fft(x, n=None, axis=-1, norm=None, overwrite_x=False):
 
     """
 
-    return _pocketfft.fft(x, n, axis, norm, overwrite_x)
+    return _pocketfft.fft(x, n, axis, norm, overwrite_x, workers)
 
 
-def ifft(x, n=None, axis=-1, norm=None, overwrite_x=False):
+def ifft(x, n=None, axis=-1, norm=None, overwrite_x=False, workers=None):
     """
     Compute the one-dimensional inverse discrete Fourier Transform.
 
@@ -161,6 +172,10 @@ def ifft(x, n=None, axis=-1, norm=None, overwrite_x=False):
     overwrite_x : bool, optional
         If True, the contents of `x` can be destroyed; the default is False.
         See :func:`fft` for more details.
+    workers : int, optional
+        Maximum number of workers to use for parallel computation. If negative,
+        the value wraps around from ``os.cpu_count()``.
+        See :func:`~scipy.fft.fft` for more details.
 
     Returns
     -------
@@ -213,10 +228,10 @@ def ifft(x, n=None, axis=-1, norm=None, overwrite_x=False):
     >>> plt.show()
 
     """
-    return _pocketfft.ifft(x, n, axis, norm, overwrite_x)
+    return _pocketfft.ifft(x, n, axis, norm, overwrite_x, workers)
 
 
-def rfft(x, n=None, axis=-1, norm=None, overwrite_x=False):
+def rfft(x, n=None, axis=-1, norm=None, overwrite_x=False, workers=None):
     """
     Compute the one-dimensional discrete Fourier Transform for real input.
 
@@ -241,6 +256,10 @@ def rfft(x, n=None, axis=-1, norm=None, overwrite_x=False):
     overwrite_x : bool, optional
         If True, the contents of `x` can be destroyed; the default is False.
         See :func:`fft` for more details.
+    workers : int, optional
+        Maximum number of workers to use for parallel computation. If negative,
+        the value wraps around from ``os.cpu_count()``.
+        See :func:`~scipy.fft.fft` for more details.
 
     Returns
     -------
@@ -295,10 +314,10 @@ def rfft(x, n=None, axis=-1, norm=None, overwrite_x=False):
     exploited to compute only the non-negative frequency terms.
 
     """
-    return _pocketfft.rfft(x, n, axis, norm, overwrite_x)
+    return _pocketfft.rfft(x, n, axis, norm, overwrite_x, workers)
 
 
-def irfft(x, n=None, axis=-1, norm=None, overwrite_x=False):
+def irfft(x, n=None, axis=-1, norm=None, overwrite_x=False, workers=None):
     """
     Compute the inverse of the n-point DFT for real input.
 
@@ -332,6 +351,10 @@ def irfft(x, n=None, axis=-1, norm=None, overwrite_x=False):
     overwrite_x : bool, optional
         If True, the contents of `x` can be destroyed; the default is False.
         See :func:`fft` for more details.
+    workers : int, optional
+        Maximum number of workers to use for parallel computation. If negative,
+        the value wraps around from ``os.cpu_count()``.
+        See :func:`~scipy.fft.fft` for more details.
 
     Returns
     -------
@@ -385,10 +408,10 @@ def irfft(x, n=None, axis=-1, norm=None, overwrite_x=False):
     specified, and the output array is purely real.
 
     """
-    return _pocketfft.irfft(x, n, axis, norm, overwrite_x)
+    return _pocketfft.irfft(x, n, axis, norm, overwrite_x, workers)
 
 
-def fftn(x, s=None, axes=None, norm=None, overwrite_x=False):
+def fftn(x, s=None, axes=None, norm=None, overwrite_x=False, workers=None):
     """
     Compute the N-dimensional discrete Fourier Transform.
 
@@ -418,6 +441,10 @@ def fftn(x, s=None, axes=None, norm=None, overwrite_x=False):
     overwrite_x : bool, optional
         If True, the contents of `x` can be destroyed; the default is False.
         See :func:`fft` for more details.
+    workers : int, optional
+        Maximum number of workers to use for parallel computation. If negative,
+        the value wraps around from ``os.cpu_count()``.
+        See :func:`~scipy.fft.fft` for more details.
 
     Returns
     -------
@@ -480,10 +507,10 @@ def fftn(x, s=None, axes=None, norm=None, overwrite_x=False):
 
     """
 
-    return _pocketfft.fftn(x, s, axes, norm, overwrite_x)
+    return _pocketfft.fftn(x, s, axes, norm, overwrite_x, workers)
 
 
-def ifftn(x, s=None, axes=None, norm=None, overwrite_x=False):
+def ifftn(x, s=None, axes=None, norm=None, overwrite_x=False, workers=None):
     """
     Compute the N-dimensional inverse discrete Fourier Transform.
 
@@ -521,6 +548,10 @@ def ifftn(x, s=None, axes=None, norm=None, overwrite_x=False):
     overwrite_x : bool, optional
         If True, the contents of `x` can be destroyed; the default is False.
         See :func:`fft` for more details.
+    workers : int, optional
+        Maximum number of workers to use for parallel computation. If negative,
+        the value wraps around from ``os.cpu_count()``.
+        See :func:`~scipy.fft.fft` for more details.
 
     Returns
     -------
@@ -573,10 +604,10 @@ def ifftn(x, s=None, axes=None, norm=None, overwrite_x=False):
     >>> plt.show()
 
     """
-    return _pocketfft.ifftn(x, s, axes, norm, overwrite_x)
+    return _pocketfft.ifftn(x, s, axes, norm, overwrite_x, workers)
 
 
-def fft2(x, s=None, axes=(-2, -1), norm=None, overwrite_x=False):
+def fft2(x, s=None, axes=(-2, -1), norm=None, overwrite_x=False, workers=None):
     """
     Compute the 2-dimensional discrete Fourier Transform
 
@@ -607,6 +638,10 @@ def fft2(x, s=None, axes=(-2, -1), norm=None, overwrite_x=False):
     overwrite_x : bool, optional
         If True, the contents of `x` can be destroyed; the default is False.
         See :func:`fft` for more details.
+    workers : int, optional
+        Maximum number of workers to use for parallel computation. If negative,
+        the value wraps around from ``os.cpu_count()``.
+        See :func:`~scipy.fft.fft` for more details.
 
     Returns
     -------
@@ -663,10 +698,11 @@ def fft2(x, s=None, axes=(-2, -1), norm=None, overwrite_x=False):
 
     """
 
-    return _pocketfft.fft2(x, s, axes, norm, overwrite_x)
+    return _pocketfft.fft2(x, s, axes, norm, overwrite_x, workers)
 
 
-def ifft2(x, s=None, axes=(-2, -1), norm=None, overwrite_x=False):
+def ifft2(x, s=None, axes=(-2, -1), norm=None, overwrite_x=False,
+          workers=None):
     """
     Compute the 2-dimensional inverse discrete Fourier Transform.
 
@@ -704,6 +740,10 @@ def ifft2(x, s=None, axes=(-2, -1), norm=None, overwrite_x=False):
     overwrite_x : bool, optional
         If True, the contents of `x` can be destroyed; the default is False.
         See :func:`fft` for more details.
+    workers : int, optional
+        Maximum number of workers to use for parallel computation. If negative,
+        the value wraps around from ``os.cpu_count()``.
+        See :func:`~scipy.fft.fft` for more details.
 
     Returns
     -------
@@ -750,10 +790,10 @@ def ifft2(x, s=None, axes=(-2, -1), norm=None, overwrite_x=False):
 
     """
 
-    return _pocketfft.ifft2(x, s, axes, norm, overwrite_x)
+    return _pocketfft.ifft2(x, s, axes, norm, overwrite_x, workers)
 
 
-def rfftn(x, s=None, axes=None, norm=None, overwrite_x=False):
+def rfftn(x, s=None, axes=None, norm=None, overwrite_x=False, workers=None):
     """
     Compute the N-dimensional discrete Fourier Transform for real input.
 
@@ -784,6 +824,10 @@ def rfftn(x, s=None, axes=None, norm=None, overwrite_x=False):
     overwrite_x : bool, optional
         If True, the contents of `x` can be destroyed; the default is False.
         See :func:`fft` for more details.
+    workers : int, optional
+        Maximum number of workers to use for parallel computation. If negative,
+        the value wraps around from ``os.cpu_count()``.
+        See :func:`~scipy.fft.fft` for more details.
 
     Returns
     -------
@@ -838,10 +882,11 @@ def rfftn(x, s=None, axes=None, norm=None, overwrite_x=False):
             [0.+0.j,  0.+0.j]]])
 
     """
-    return _pocketfft.rfftn(x, s, axes, norm, overwrite_x)
+    return _pocketfft.rfftn(x, s, axes, norm, overwrite_x, workers)
 
 
-def rfft2(x, s=None, axes=(-2, -1), norm=None, overwrite_x=False):
+def rfft2(x, s=None, axes=(-2, -1), norm=None, overwrite_x=False,
+          workers=None):
     """
     Compute the 2-dimensional FFT of a real array.
 
@@ -858,6 +903,10 @@ def rfft2(x, s=None, axes=(-2, -1), norm=None, overwrite_x=False):
     overwrite_x : bool, optional
         If True, the contents of `x` can be destroyed; the default is False.
         See :func:`fft` for more details.
+    workers : int, optional
+        Maximum number of workers to use for parallel computation. If negative,
+        the value wraps around from ``os.cpu_count()``.
+        See :func:`~scipy.fft.fft` for more details.
 
     Returns
     -------
@@ -876,10 +925,10 @@ def rfft2(x, s=None, axes=(-2, -1), norm=None, overwrite_x=False):
 
     """
 
-    return _pocketfft.rfft2(x, s, axes, norm, overwrite_x)
+    return _pocketfft.rfft2(x, s, axes, norm, overwrite_x, workers)
 
 
-def irfftn(x, s=None, axes=None, norm=None, overwrite_x=False):
+def irfftn(x, s=None, axes=None, norm=None, overwrite_x=False, workers=None):
     """
     Compute the inverse of the N-dimensional FFT of real input.
 
@@ -918,6 +967,10 @@ def irfftn(x, s=None, axes=None, norm=None, overwrite_x=False):
     overwrite_x : bool, optional
         If True, the contents of `x` can be destroyed; the default is False.
         See :func:`fft` for more details.
+    workers : int, optional
+        Maximum number of workers to use for parallel computation. If negative,
+        the value wraps around from ``os.cpu_count()``.
+        See :func:`~scipy.fft.fft` for more details.
 
     Returns
     -------
@@ -973,10 +1026,11 @@ def irfftn(x, s=None, axes=None, norm=None, overwrite_x=False):
             [1.,  1.]]])
 
     """
-    return _pocketfft.irfftn(x, s, axes, norm, overwrite_x)
+    return _pocketfft.irfftn(x, s, axes, norm, overwrite_x, workers)
 
 
-def irfft2(x, s=None, axes=(-2, -1), norm=None, overwrite_x=False):
+def irfft2(x, s=None, axes=(-2, -1), norm=None, overwrite_x=False,
+           workers=None):
     """
     Compute the 2-dimensional inverse FFT of a real array.
 
@@ -994,6 +1048,10 @@ def irfft2(x, s=None, axes=(-2, -1), norm=None, overwrite_x=False):
     overwrite_x : bool, optional
         If True, the contents of `x` can be destroyed; the default is False.
         See :func:`fft` for more details.
+    workers : int, optional
+        Maximum number of workers to use for parallel computation. If negative,
+        the value wraps around from ``os.cpu_count()``.
+        See :func:`~scipy.fft.fft` for more details.
 
     Returns
     -------
@@ -1011,4 +1069,4 @@ def irfft2(x, s=None, axes=(-2, -1), norm=None, overwrite_x=False):
 
     """
 
-    return _pocketfft.irfft2(x, s, axes, norm, overwrite_x)
+    return _pocketfft.irfft2(x, s, axes, norm, overwrite_x, workers)
@@ -1,6 +1,7 @@
 """ FFT backend using pypocketfft """
 
 from .basic import *
+from .realtransforms import *
 
 from scipy._lib._testutils import PytestTester
 test = PytestTester(__name__)
@@ -0,0 +1,34 @@
+"""
+Selection of the pypocketfft build for the running CPU.
+
+Besides the baseline ``pypocketfft``, the extension is built for wider vector
+instruction sets as ``pypocketfft_<isa>``. The widest one that the CPU
+supports, and that was actually compiled for its instruction set, is
+imported as `pypocketfft`.
+"""
+from __future__ import division, print_function, absolute_import
+
+import importlib
+from scipy.fft._pocketfft import pypocketfft as _baseline
+
+# from widest to narrowest
+_ISAS = ('avx512f', 'avx2')
+
+
+def _select():
+    features = _baseline.cpu_features()
+    for isa in _ISAS:
+        if isa not in features:
+            continue
+        try:
+            mod = importlib.import_module('scipy.fft._pocketfft.pypocketfft_'
+                                          + isa)
+        except ImportError:
+            continue
+        # without compiler support the module is a baseline build
+        if mod.isa == isa:
+            return mod
+    return _baseline
+
+
+pypocketfft = _select()
@@ -5,12 +5,32 @@ from __future__ import division, print_function, absolute_import
 
 import numpy as np
 import functools
-from scipy.fft._pocketfft import pypocketfft as pfft
+import os
+from scipy.fft._pocketfft._isa import pypocketfft as pfft
 from scipy.fftpack.helper import _init_nd_shape_and_axes
 
 
-# TODO: Build with OpenMp and add configuration support
-_default_workers = 1
+_cpu_count = os.cpu_count() or 1
+
+def _workers(workers):
+    """
+    Handle the ``workers`` argument: the number of threads to use, with
+    negative values counting back from ``os.cpu_count()``.
+    """
+    if workers is None:
+        return 1
+
+    workers = int(workers)
+    if workers < 0:
+        if workers >= -_cpu_count:
+            workers += 1 + _cpu_count
+        else:
+            raise ValueError("workers value out of range; got {}, must not be"
+                             " less than {}".format(workers, -_cpu_count))
+    elif workers == 0:
+        raise ValueError("workers must not be zero")
+
+    return workers
 
 def _asfarray(x):
     """
@@ -88,7 +108,8 @@ def _normalization(norm, forward):
         "Invalid norm value {}, should be None or \"ortho\".".format(norm))
 
 
-def c2c(forward, x, n=None, axis=-1, norm=None, overwrite_x=False):
+def c2c(forward, x, n=None, axis=-1, norm=None, overwrite_x=False,
+        workers=None):
     """ Return discrete Fourier transform of real or complex sequence. """
     tmp = _asfarray(x)
     overwrite_x = overwrite_x or _datacopied(tmp, x)
@@ -103,7 +124,7 @@ def c2c(forward, x, n=None, axis=-1, norm=None, overwrite_x=False):
 
     out = (tmp if overwrite_x and tmp.dtype.kind == 'c' else None)
 
-    return pfft.c2c(tmp, (axis,), forward, norm, out, _default_workers)
+    return pfft.c2c(tmp, (axis,), forward, norm, out, _workers(workers))
 
 
 fft = functools.partial(c2c, True)
@@ -112,7 +133,8 @@ ifft = functools.partial(c2c, False)
 ifft.__name__ = 'ifft'
 
 
-def rfft(x, n=None, axis=-1, norm=None, overwrite_x=False):
+def rfft(x, n=None, axis=-1, norm=None, overwrite_x=False,
+         workers=None):
     """
     Discrete Fourier transform of a real sequence.
     """
@@ -129,10 +151,11 @@ def rfft(x, n=None, axis=-1, norm=None, overwrite_x=False):
                          .format(tmp.shape[axis]))
 
     # Note: overwrite_x is not utilised
-    return pfft.r2c(tmp, (axis,), True, norm, None, _default_workers)
+    return pfft.r2c(tmp, (axis,), True, norm, None, _workers(workers))
 
 
-def irfft(x, n=None, axis=-1, norm=None, overwrite_x=False):
+def irfft(x, n=None, axis=-1, norm=None, overwrite_x=False,
+          workers=None):
     """
     Return inverse discrete Fourier transform of real sequence x.
     """
@@ -153,38 +176,43 @@ def irfft(x, n=None, axis=-1, norm=None, overwrite_x=False):
         tmp, _ = _fix_shape_1d(tmp, (n//2) + 1, axis)
 
     # Note: overwrite_x is not utilised
-    return pfft.c2r(tmp, (axis,), n, False, norm, None, _default_workers)
+    return pfft.c2r(tmp, (axis,), n, False, norm, None, _workers(workers))
 
 
-def fft2(x, shape=None, axes=(-2,-1), norm=None, overwrite_x=False):
+def fft2(x, shape=None, axes=(-2,-1), norm=None, overwrite_x=False,
+         workers=None):
     """
     2-D discrete Fourier transform.
     """
-    return fftn(x, shape, axes, norm, overwrite_x)
+    return fftn(x, shape, axes, norm, overwrite_x, workers)
 
 
-def ifft2(x, shape=None, axes=(-2,-1), norm=None, overwrite_x=False):
+def ifft2(x, shape=None, axes=(-2,-1), norm=None, overwrite_x=False,
+          workers=None):
     """
     2-D discrete inverse Fourier transform of real or complex sequence.
     """
-    return ifftn(x, shape, axes, norm, overwrite_x)
+    return ifftn(x, shape, axes, norm, overwrite_x, workers)
 
 
-def rfft2(x, shape=None, axes=(-2,-1), norm=None, overwrite_x=False):
+def rfft2(x, shape=None, axes=(-2,-1), norm=None, overwrite_x=False,
+          workers=None):
     """
     2-D discrete Fourier transform of a real sequence
     """
-    return rfftn(x, shape, axes, norm, overwrite_x)
+    return rfftn(x, shape, axes, norm, overwrite_x, workers)
 
 
-def irfft2(x, shape=None, axes=(-2,-1), norm=None, overwrite_x=False):
+def irfft2(x, shape=None, axes=(-2,-1), norm=None, overwrite_x=False,
+           workers=None):
     """
     2-D discrete inverse Fourier transform of a real sequence
     """
-    return irfftn(x, shape, axes, norm, overwrite_x)
+    return irfftn(x, shape, axes, norm, overwrite_x, workers)
 
 
-def c2cn(forward, x, shape=None, axes=None, norm=None, overwrite_x=False):
+def c2cn(forward, x, shape=None, axes=None, norm=None, overwrite_x=False,
+         workers=None):
     """
     Return multidimensional discrete Fourier transform.
     """
@@ -202,7 +230,7 @@ def c2cn(forward, x, shape=None, axes=None, norm=None, overwrite_x=False):
     norm = _normalization(norm, forward)
     out = (tmp if overwrite_x and tmp.dtype.kind == 'c' else None)
 
-    return pfft.c2c(tmp, axes, forward, norm, out, _default_workers)
+    return pfft.c2c(tmp, axes, forward, norm, out, _workers(workers))
 
 
 fftn = functools.partial(c2cn, True)
@@ -210,7 +238,8 @@ fftn.__name__ = 'fftn'
 ifftn = functools.partial(c2cn, False)
 ifftn.__name__ = 'ifftn'
 
-def rfftn(x, shape=None, axes=None, norm=None, overwrite_x=False):
+def rfftn(x, shape=None, axes=None, norm=None, overwrite_x=False,
+          workers=None):
     """Return multi-dimensional discrete Fourier transform of real input"""
     tmp = _asfarray(x)
 
@@ -225,9 +254,10 @@ def rfftn(x, shape=None, axes=None, norm=None, overwrite_x=False):
         raise ValueError("at least 1 axis must be transformed")
 
     # Note: overwrite_x is not utilised
-    return pfft.r2c(tmp, axes, True, norm, None, _default_workers)
+    return pfft.r2c(tmp, axes, True, norm, None, _workers(workers))
 
-def irfftn(x, shape=None, axes=None, norm=None, overwrite_x=False):
+def irfftn(x, shape=None, axes=None, norm=None, overwrite_x=False,
+           workers=None):
     """Multi-dimensional inverse discrete fourier transform with real output"""
     tmp = _asfarray(x)
 
@@ -253,4 +283,4 @@ def irfftn(x, shape=None, axes=None, norm=None, overwrite_x=False):
     tmp, _ = _fix_shape(tmp, shape, axes)
 
     # Note: overwrite_x is not utilised
-    return pfft.c2r(tmp, axes, lastsize, False, norm, None, _default_workers)
+    return pfft.c2r(tmp, axes, lastsize, False, norm, None, _workers(workers))
@@ -45,6 +45,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define POCKETFFT_CACHE_SIZE 16
 #endif
 
+// memory that the shared store of twiddle and Bluestein tables may occupy
+#ifndef POCKETFFT_TABLE_CACHE_BYTES
+#define POCKETFFT_TABLE_CACHE_BYTES (64*1024*1024)
+#endif
+
 #include <cmath>
 #include <cstring>
 #include <cstdlib>
@@ -56,8 +61,21 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <array>
 #include <mutex>
 #endif
-#ifdef POCKETFFT_OPENMP
-#include <omp.h>
+#if POCKETFFT_TABLE_CACHE_BYTES!=0
+#include <map>
+#include <mutex>
+#endif
+#ifndef POCKETFFT_NO_MULTITHREADING
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <queue>
+#include <atomic>
+#include <functional>
+#include <exception>
+#ifdef POCKETFFT_PTHREADS
+#include <pthread.h>
+#endif
 #endif
 
 
@@ -387,7 +405,7 @@ template<typename T> class sincos_2pibyn
       }
 
   public:
-    POCKETFFT_NOINLINE sincos_2pibyn(size_t n, bool half)
+    POCKETFFT_NOINLINE sincos_2pibyn(size_t n, bool half=false)
       : data(2*n)
       {
       sincos_2pibyn_half(n, data.data());
@@ -398,8 +416,304 @@ template<typename T> class sincos_2pibyn
     const T *rdata() const { return data; }
     const cmplx<T> *cdata() const
       { return reinterpret_cast<const cmplx<T> *>(data.data()); }
+    size_t memsize() const { return data.size()*sizeof(T); }
+  };
+
+//
+// shared table store
+//
+
+#if POCKETFFT_TABLE_CACHE_BYTES!=0
+// Tables that are expensive to compute and identical for all plans of a
+// given length: full twiddle tables, Bluestein chirps and their inner
+// plans. They are indexed by type and length and reference counted. The
+// store keeps the most recently used ones alive up to
+// POCKETFFT_TABLE_CACHE_BYTES bytes, as reported by their memsize();
+// tables still used by a plan are not freed by eviction.
+class table_store
+  {
+  private:
+    struct entry
+      {
+      shared_ptr<void> tab;
+      size_t bytes, last_access;
+      };
+    using key_t = pair<const void *, size_t>;
+
+    map<key_t, entry> entries;
+    size_t total=0, access_counter=0;
+    mutex mut;
+
+    // an address that identifies the table type Tab
+    template<typename Tab> static const void *tag()
+      { static const char id=0; return &id; }
+
+    static table_store &instance()
+      { static table_store store; return store; }
+
+    shared_ptr<void> find(const key_t &key)
+      {
+      auto it = entries.find(key);
+      if (it==entries.end()) return nullptr;
+      it->second.last_access = ++access_counter;
+      return it->second.tab;
+      }
+
+    void insert(const key_t &key, const shared_ptr<void> &tab, size_t bytes)
+      {
+      entries[key] = entry{tab, bytes, ++access_counter};
+      total += bytes;
+      // evict the least recently used tables, but never the new one
+      while ((total>POCKETFFT_TABLE_CACHE_BYTES) && (entries.size()>1))
+        {
+        auto lru = entries.end();
+        for (auto it=entries.begin(); it!=entries.end(); ++it)
+          if ((it->first!=key) && ((lru==entries.end())
+            || (it->second.last_access<lru->second.last_access)))
+            lru = it;
+        total -= lru->second.bytes;
+        entries.erase(lru);
+        }
+      }
+
+  public:
+    template<typename Tab> static shared_ptr<Tab> get(size_t n)
+      {
+      auto &store = instance();
+      key_t key(tag<Tab>(), n);
+      {
+      lock_guard<mutex> lock(store.mut);
+      auto p = store.find(key);
+      if (p) return static_pointer_cast<Tab>(p);
+      }
+      // computed without holding the lock, since tables may need others
+      auto tab = make_shared<Tab>(n);
+      lock_guard<mutex> lock(store.mut);
+      auto p = store.find(key);
+      if (p) return static_pointer_cast<Tab>(p);
+      store.insert(key, tab, tab->memsize());
+      return tab;
+      }
+  };
+#endif
+
+template<typename Tab> shared_ptr<Tab> get_table(size_t n)
+  {
+#if POCKETFFT_TABLE_CACHE_BYTES==0
+  return make_shared<Tab>(n);
+#else
+  return table_store::get<Tab>(n);
+#endif
+  }
+
+namespace threading {
+
+#ifdef POCKETFFT_NO_MULTITHREADING
+
+constexpr inline size_t thread_id() { return 0; }
+constexpr inline size_t num_threads() { return 1; }
+constexpr inline size_t max_threads() { return 1; }
+
+template <typename Func>
+void thread_map(size_t /* nthreads */, Func f)
+  { f(); }
+
+#else
+
+// index of the calling thread within the current thread_map, and the
+// number of threads taking part in it
+inline size_t &thread_id()
+  {
+  static thread_local size_t thread_id_=0;
+  return thread_id_;
+  }
+inline size_t &num_threads()
+  {
+  static thread_local size_t num_threads_=1;
+  return num_threads_;
+  }
+
+inline size_t max_threads()
+  {
+  static const size_t max_threads_=
+    max<size_t>(1, thread::hardware_concurrency());
+  return max_threads_;
+  }
+
+class latch
+  {
+  private:
+    size_t num_left_;
+    mutex mut_;
+    condition_variable completed_;
+
+  public:
+    explicit latch(size_t n): num_left_(n) {}
+
+    void count_down()
+      {
+      lock_guard<mutex> lock(mut_);
+      if (--num_left_==0)
+        completed_.notify_all();
+      }
+
+    void wait()
+      {
+      unique_lock<mutex> lock(mut_);
+      completed_.wait(lock, [this]{ return num_left_==0; });
+      }
   };
 
+// A persistent set of max_threads() workers taking jobs from a shared
+// queue. It is created on first use and reused by all later transforms.
+class thread_pool
+  {
+  private:
+    queue<function<void()>> work_;
+    vector<thread> threads_;
+    mutex mut_;
+    condition_variable available_;
+    bool shutdown_;
+
+    void worker_main()
+      {
+      for (;;)
+        {
+        function<void()> work;
+          {
+          unique_lock<mutex> lock(mut_);
+          available_.wait(lock, [this]{ return shutdown_ || !work_.empty(); });
+          if (work_.empty()) return; // shut down, with no work left
+          work = move(work_.front());
+          work_.pop();
+          }
+        work();
+        }
+      }
+
+    void create_threads()
+      {
+      size_t nthreads=max_threads();
+      lock_guard<mutex> lock(mut_);
+      shutdown_=false;
+      for (size_t i=0; i<nthreads; ++i)
+        {
+        try
+          { threads_.emplace_back([this]{ worker_main(); }); }
+        catch (...)
+          {
+          if (threads_.empty()) throw;
+          break; // run with the workers we could start
+          }
+        }
+      }
+
+  public:
+    thread_pool(): shutdown_(false)
+      { create_threads(); }
+
+    ~thread_pool()
+      { shutdown(); }
+
+    void submit(function<void()> work)
+      {
+        {
+        lock_guard<mutex> lock(mut_);
+        if (shutdown_)
+          throw runtime_error("work item submitted after shutdown");
+        work_.push(move(work));
+        }
+      available_.notify_one();
+      }
+
+    void shutdown()
+      {
+        {
+        lock_guard<mutex> lock(mut_);
+        shutdown_=true;
+        }
+      available_.notify_all();
+      for (auto &t : threads_)
+        if (t.joinable()) t.join();
+      threads_.clear();
+      }
+
+    void restart()
+      { create_threads(); }
+  };
+
+inline thread_pool &get_pool()
+  {
+  static thread_pool pool;
+#ifdef POCKETFFT_PTHREADS
+  // threads do not survive fork(); stop them before and start new ones in
+  // both processes afterwards
+  static once_flag f;
+  call_once(f,
+    []{
+    pthread_atfork(
+      +[]{ get_pool().shutdown(); },  // prepare
+      +[]{ get_pool().restart(); },   // parent
+      +[]{ get_pool().restart(); });  // child
+    });
+#endif
+  return pool;
+  }
+
+// Call f() on nthreads threads, with thread_id() from 0 to nthreads-1 and
+// num_threads() equal to nthreads, and return when all calls have
+// finished. The calling thread takes share 0. An exception thrown by any
+// of the calls is rethrown here.
+template <typename Func>
+void thread_map(size_t nthreads, Func f)
+  {
+  if (nthreads==0)
+    nthreads=max_threads();
+
+  if (nthreads==1)
+    { f(); return; }
+
+  auto &pool=get_pool();
+  latch counter(nthreads-1);
+  exception_ptr ex;
+  mutex ex_mut;
+  for (size_t i=1; i<nthreads; ++i)
+    {
+    pool.submit(
+      [&f, &counter, &ex, &ex_mut, i, nthreads] {
+      thread_id()=i;
+      num_threads()=nthreads;
+      try { f(); }
+      catch (...)
+        {
+        lock_guard<mutex> lock(ex_mut);
+        ex=current_exception();
+        }
+      counter.count_down();
+      });
+    }
+
+  auto old_id=thread_id(), old_num=num_threads();
+  thread_id()=0;
+  num_threads()=nthreads;
+  try { f(); }
+  catch (...)
+    {
+    lock_guard<mutex> lock(ex_mut);
+    ex=current_exception();
+    }
+  thread_id()=old_id;
+  num_threads()=old_num;
+
+  counter.wait();
+  if (ex)
+    rethrow_exception(ex);
+  }
+
+#endif
+
+}
+
 struct util // hack to avoid duplicate symbols
   {
   static POCKETFFT_NOINLINE size_t largest_prime_factor (size_t n)
@@ -487,20 +801,18 @@ struct util // hack to avoid duplicate symbols
     if (axis>=shape.size()) throw runtime_error("bad axis number");
     }
 
-#ifdef POCKETFFT_OPENMP
-    static size_t nthreads() { return size_t(omp_get_num_threads()); }
-    static size_t thread_num() { return size_t(omp_get_thread_num()); }
+    static size_t nthreads() { return threading::num_threads(); }
+    static size_t thread_num() { return threading::thread_id(); }
     static size_t thread_count (size_t nthreads, const shape_t &shape,
       size_t axis)
       {
       if (nthreads==1) return 1;
-      if (prod(shape) < 20*shape[axis]) return 1;
-      return (nthreads==0) ? size_t(omp_get_max_threads()) : nthreads;
+      size_t size = prod(shape);
+      if (size < 20*shape[axis]) return 1;
+      size_t lines = size/shape[axis];
+      size_t max_threads = (nthreads==0) ? threading::max_threads() : nthreads;
+      return (lines<max_threads) ? lines : max_threads;
       }
-#else
-    static constexpr size_t nthreads() { return 1; }
-    static constexpr size_t thread_num() { return 0; }
-#endif
   };
 
 //
@@ -1218,8 +1530,8 @@ template<bool fwd, typename T> void pass_all(T c[], T0 fct)
 
     void comp_twiddle()
       {
-      sincos_2pibyn<T0> twid(length, false);
-      auto twiddle = twid.cdata();
+      auto twid = get_table<sincos_2pibyn<T0>>(length);
+      auto twiddle = twid->cdata();
       size_t l1=1;
       size_t memofs=0;
       for (size_t k=0; k<fact.size(); ++k)
@@ -1251,6 +1563,8 @@ template<bool fwd, typename T> void pass_all(T c[], T0 fct)
       mem.resize(twsize());
       comp_twiddle();
       }
+
+    size_t memsize() const { return mem.size()*sizeof(cmplx<T0>); }
   };
 
 //
@@ -1954,13 +2268,15 @@ template<typename T> void radbg(size_t ido, size_t ip, size_t l1,
       }
 
   public:
-    template<typename T> void forward(T c[], T0 fct)
+    // work, if given, must hold length elements and replaces the
+    // internally allocated buffer
+    template<typename T> void forward(T c[], T0 fct, T *work=nullptr)
       {
       if (length==1) { c[0]*=fct; return; }
       size_t n=length;
       size_t l1=n, nf=fact.size();
-      arr<T> ch(n);
-      T *p1=c, *p2=ch.data();
+      arr<T> ch(work ? 0 : n);
+      T *p1=c, *p2=work ? work : ch.data();
 
       for(size_t k1=0; k1<nf;++k1)
         {
@@ -1983,13 +2299,13 @@ template<typename T> void radbg(size_t ido, size_t ip, size_t l1,
       copy_and_norm(c,p1,n,fct);
       }
 
-    template<typename T> void backward(T c[], T0 fct)
+    template<typename T> void backward(T c[], T0 fct, T *work=nullptr)
       {
       if (length==1) { c[0]*=fct; return; }
       size_t n=length;
       size_t l1=1, nf=fact.size();
-      arr<T> ch(n);
-      T *p1=c, *p2=ch.data();
+      arr<T> ch(work ? 0 : n);
+      T *p1=c, *p2=work ? work : ch.data();
 
       for(size_t k=0; k<nf; k++)
         {
@@ -2048,7 +2364,8 @@ template<typename T> void radbg(size_t ido, size_t ip, size_t l1,
 
     void comp_twiddle()
       {
-      sincos_2pibyn<T0> twid(length, true);
+      auto twid_ = get_table<sincos_2pibyn<T0>>(length);
+      const auto &twid(*twid_);
       size_t l1=1;
       T0 *ptr=mem.data();
       for (size_t k=0; k<fact.size(); ++k)
@@ -2101,7 +2418,7 @@ template<typename T0> class fftblue
   {
   private:
     size_t n, n2;
-    cfftp<T0> plan;
+    shared_ptr<cfftp<T0>> plan;
     arr<cmplx<T0>> mem;
     cmplx<T0> *bk, *bkf;
 
@@ -2116,14 +2433,14 @@ template<typename T0> class fftblue
       for (size_t m=n; m<n2; ++m)
         akf[m]=zero;
 
-      plan.forward (akf.data(),1.);
+      plan->forward (akf.data(),1.);
 
       /* do the convolution */
       for (size_t m=0; m<n2; ++m)
         akf[m] = akf[m].template special_mul<!fwd>(bkf[m]);
 
       /* inverse FFT */
-      plan.backward (akf.data(),1.);
+      plan->backward (akf.data(),1.);
 
       /* multiply by b_k */
       for (size_t m=0; m<n; ++m)
@@ -2132,12 +2449,13 @@ template<typename T0> class fftblue
 
   public:
     POCKETFFT_NOINLINE fftblue(size_t length)
-      : n(length), n2(util::good_size(n*2-1)), plan(n2), mem(n+n2),
-        bk(mem.data()), bkf(mem.data()+n)
+      : n(length), n2(util::good_size(n*2-1)),
+        plan(get_table<cfftp<T0>>(n2)), mem(n+n2), bk(mem.data()),
+        bkf(mem.data()+n)
       {
       /* initialize b_k */
-      sincos_2pibyn<T0> tmp_(2*n, false);
-      auto tmp = tmp_.cdata();
+      auto tmp_ = get_table<sincos_2pibyn<T0>>(2*n);
+      auto tmp = tmp_->cdata();
       bk[0].Set(1, 0);
 
       size_t coeff=0;
@@ -2155,9 +2473,11 @@ template<typename T0> class fftblue
         bkf[m] = bkf[n2-m] = bk[m]*xn2;
       for (size_t m=n;m<=(n2-n);++m)
         bkf[m].Set(0.,0.);
-      plan.forward(bkf,1.);
+      plan->forward(bkf,1.);
       }
 
+    size_t memsize() const { return mem.size()*sizeof(cmplx<T0>); }
+
     template<typename T> void backward(cmplx<T> c[], T0 fct)
       { fft<false>(c,fct); }
 
@@ -2198,7 +2518,7 @@ template<typename T0> class pocketfft_c
   {
   private:
     unique_ptr<cfftp<T0>> packplan;
-    unique_ptr<fftblue<T0>> blueplan;
+    shared_ptr<fftblue<T0>> blueplan;
     size_t len;
 
   public:
@@ -2216,7 +2536,7 @@ template<typename T0> class pocketfft_c
       double comp2 = 2*util::cost_guess(util::good_size(2*length-1));
       comp2*=1.5; /* fudge factor that appears to give good overall performance */
       if (comp2<comp1) // use Bluestein
-        blueplan=unique_ptr<fftblue<T0>>(new fftblue<T0>(length));
+        blueplan=get_table<fftblue<T0>>(length);
       else
         packplan=unique_ptr<cfftp<T0>>(new cfftp<T0>(length));
       }
@@ -2238,7 +2558,7 @@ template<typename T0> class pocketfft_r
   {
   private:
     unique_ptr<rfftp<T0>> packplan;
-    unique_ptr<fftblue<T0>> blueplan;
+    shared_ptr<fftblue<T0>> blueplan;
     size_t len;
 
   public:
@@ -2256,26 +2576,276 @@ template<typename T0> class pocketfft_r
       double comp2 = 2*util::cost_guess(util::good_size(2*length-1));
       comp2*=1.5; /* fudge factor that appears to give good overall performance */
       if (comp2<comp1) // use Bluestein
-        blueplan=unique_ptr<fftblue<T0>>(new fftblue<T0>(length));
+        blueplan=get_table<fftblue<T0>>(length);
       else
         packplan=unique_ptr<rfftp<T0>>(new rfftp<T0>(length));
       }
 
-    template<typename T> POCKETFFT_NOINLINE void backward(T c[], T0 fct)
+    // work, if given, is a buffer of length() elements used instead of an
+    // allocation; Bluestein plans ignore it
+    template<typename T> POCKETFFT_NOINLINE void backward(T c[], T0 fct,
+      T *work=nullptr)
       {
-      packplan ? packplan->backward(c,fct)
+      packplan ? packplan->backward(c,fct,work)
                : blueplan->backward_r(c,fct);
       }
 
-    template<typename T> POCKETFFT_NOINLINE void forward(T c[], T0 fct)
+    template<typename T> POCKETFFT_NOINLINE void forward(T c[], T0 fct,
+      T *work=nullptr)
       {
-      packplan ? packplan->forward(c,fct)
+      packplan ? packplan->forward(c,fct,work)
                : blueplan->forward_r(c,fct);
       }
 
+    bool uses_bluestein() const { return bool(blueplan); }
+
     size_t length() const { return len; }
   };
 
+//
+// DCT/DST of types I-IV, computed with real-valued FFTs
+//
+// All transforms are unnormalized in the FFTPACK sense (e.g. DCT-II is
+// 2*sum(x[n]*cos(pi*k*(2n+1)/(2N)))); for ortho=true the first (and for
+// DCT-I also the last) entry receives the extra factor that makes the
+// result match scipy.fftpack's norm='ortho', the overall scale is applied
+// through fct.
+//
+
+template<typename T> inline void MPINPLACE(T &a, T &b)
+  { T t = a; a -= b; b += t; }
+
+template<typename T0> class T_dct1
+  {
+  private:
+    pocketfft_r<T0> fftplan;
+
+  public:
+    POCKETFFT_NOINLINE T_dct1(size_t length)
+      : fftplan(2*(length-1)) {}
+
+    template<typename T> POCKETFFT_NOINLINE void exec(T c[], T0 fct, bool ortho,
+      int /*type*/, bool /*cosine*/)
+      {
+      constexpr T0 sqrt2=T0(1.414213562373095048801688724209698L);
+      size_t N=fftplan.length(), n=N/2+1;
+      if (ortho)
+        { c[0]*=sqrt2; c[n-1]*=sqrt2; }
+      arr<T> tmp(N);
+      tmp[0] = c[0];
+      for (size_t i=1; i<n; ++i)
+        tmp[i] = tmp[N-i] = c[i];
+      fftplan.forward(tmp.data(), fct);
+      c[0] = tmp[0];
+      for (size_t i=1; i<n; ++i)
+        c[i] = tmp[2*i-1];
+      if (ortho)
+        { c[0]*=sqrt2*T0(0.5); c[n-1]*=sqrt2*T0(0.5); }
+      }
+
+    size_t length() const { return fftplan.length()/2+1; }
+  };
+
+template<typename T0> class T_dst1
+  {
+  private:
+    pocketfft_r<T0> fftplan;
+
+  public:
+    POCKETFFT_NOINLINE T_dst1(size_t length)
+      : fftplan(2*(length+1)) {}
+
+    template<typename T> POCKETFFT_NOINLINE void exec(T c[], T0 fct,
+      bool /*ortho*/, int /*type*/, bool /*cosine*/)
+      {
+      size_t N=fftplan.length(), n=N/2-1;
+      arr<T> tmp(N);
+      tmp[0] = tmp[n+1] = c[0]*0;
+      for (size_t i=0; i<n; ++i)
+        { tmp[i+1]=c[i]; tmp[N-1-i]=-c[i]; }
+      fftplan.forward(tmp.data(), fct);
+      for (size_t i=0; i<n; ++i)
+        c[i] = -tmp[2*i+2];
+      }
+
+    size_t length() const { return fftplan.length()/2-1; }
+  };
+
+// types II and III of both DCT and DST; the DST is obtained from the DCT by
+// reversing the input (type II) or output (type III) and flipping the sign
+// of every other entry
+template<typename T0> class T_dcst23
+  {
+  private:
+    pocketfft_r<T0> fftplan;
+    arr<T0> twiddle;
+
+  public:
+    POCKETFFT_NOINLINE T_dcst23(size_t length)
+      : fftplan(length), twiddle(length)
+      {
+      sincos_2pibyn<T0> tw(4*length, true);
+      for (size_t i=0; i<length; ++i)
+        twiddle[i] = tw.cdata()[i+1].r;
+      }
+
+    template<typename T> POCKETFFT_NOINLINE void exec(T c[], T0 fct, bool ortho,
+      int type, bool cosine)
+      {
+      constexpr T0 sqrt2=T0(1.414213562373095048801688724209698L);
+      size_t N=length();
+      size_t NS2 = (N+1)/2;
+      if (type==2)
+        {
+        if (!cosine)
+          for (size_t k=1; k<N; k+=2)
+            c[k] = -c[k];
+        c[0] *= 2;
+        if ((N&1)==0) c[N-1]*=2;
+        for (size_t k=1; k<N-1; k+=2)
+          MPINPLACE(c[k+1], c[k]);
+        fftplan.backward(c, fct);
+        for (size_t k=1, kc=N-1; k<NS2; ++k, --kc)
+          {
+          T t1 = twiddle[k-1]*c[kc]+twiddle[kc-1]*c[k];
+          T t2 = twiddle[k-1]*c[k]-twiddle[kc-1]*c[kc];
+          c[k] = T0(0.5)*(t1+t2); c[kc]=T0(0.5)*(t1-t2);
+          }
+        if ((N&1)==0)
+          c[NS2] *= twiddle[NS2-1];
+        if (!cosine)
+          for (size_t k=0, kc=N-1; k<kc; ++k, --kc)
+            swap(c[k], c[kc]);
+        if (ortho) c[0]*=sqrt2*T0(0.5);
+        }
+      else
+        {
+        if (ortho) c[0]*=sqrt2;
+        if (!cosine)
+          for (size_t k=0, kc=N-1; k<kc; ++k, --kc)
+            swap(c[k], c[kc]);
+        for (size_t k=1, kc=N-1; k<NS2; ++k, --kc)
+          {
+          T t1=c[k]+c[kc], t2=c[k]-c[kc];
+          c[k] = twiddle[k-1]*t2+twiddle[kc-1]*t1;
+          c[kc]= twiddle[k-1]*t1-twiddle[kc-1]*t2;
+          }
+        if ((N&1)==0)
+          c[NS2] *= 2*twiddle[NS2-1];
+        fftplan.forward(c, fct);
+        for (size_t k=1; k<N-1; k+=2)
+          MPINPLACE(c[k], c[k+1]);
+        if (!cosine)
+          for (size_t k=1; k<N; k+=2)
+            c[k] = -c[k];
+        }
+      }
+
+    size_t length() const { return fftplan.length(); }
+  };
+
+// type IV of both DCT and DST; even lengths use a half-length complex FFT,
+// odd lengths a real FFT of the same length
+template<typename T0> class T_dcst4
+  {
+  private:
+    size_t N;
+    unique_ptr<pocketfft_c<T0>> fft;
+    unique_ptr<pocketfft_r<T0>> rfft;
+    arr<cmplx<T0>> C2;
+
+  public:
+    POCKETFFT_NOINLINE T_dcst4(size_t length)
+      : N(length),
+        fft((N&1) ? nullptr : new pocketfft_c<T0>(N/2)),
+        rfft((N&1)? new pocketfft_r<T0>(N) : nullptr),
+        C2((N&1) ? 0 : N/2)
+      {
+      if ((N&1)==0)
+        {
+        sincos_2pibyn<T0> tw(16*N, true);
+        for (size_t i=0; i<N/2; ++i)
+          C2[i] = conj(tw.cdata()[8*i+1]);
+        }
+      }
+
+    template<typename T> POCKETFFT_NOINLINE void exec(T c[], T0 fct,
+      bool /*ortho*/, int /*type*/, bool cosine)
+      {
+      size_t n2 = N/2;
+      if (!cosine)
+        for (size_t k=0, kc=N-1; k<n2; ++k, --kc)
+          swap(c[k], c[kc]);
+      if (N&1)
+        {
+        // The following code is derived from the FFTW3 function apply_re11()
+        // and is released under the 3-clause BSD license with friendly
+        // permission of Matteo Frigo and Steven G. Johnson.
+
+        arr<T> y(N);
+        {
+        size_t i=0, m=n2;
+        for (; m<N; ++i, m+=4)
+          y[i] = c[m];
+        for (; m<2*N; ++i, m+=4)
+          y[i] = -c[2*N-m-1];
+        for (; m<3*N; ++i, m+=4)
+          y[i] = -c[m-2*N];
+        for (; m<4*N; ++i, m+=4)
+          y[i] = c[4*N-m-1];
+        for (; i<N; ++i, m+=4)
+          y[i] = c[m-4*N];
+        }
+        rfft->forward(y.data(), fct);
+        {
+        auto SGN = [](size_t i)
+           {
+           constexpr T0 sqrt2=T0(1.414213562373095048801688724209698L);
+           return (i&2) ? -sqrt2 : sqrt2;
+           };
+        c[n2] = y[0]*SGN(n2+1);
+        size_t i=0, i1=1, k=1;
+        for (; k<n2; ++i, ++i1, k+=2)
+          {
+          c[i    ] = y[2*k-1]*SGN(i1)     + y[2*k  ]*SGN(i);
+          c[N -i1] = y[2*k-1]*SGN(N -i)   - y[2*k  ]*SGN(N -i1);
+          c[n2-i1] = y[2*k+1]*SGN(n2-i)   - y[2*k+2]*SGN(n2-i1);
+          c[n2+i1] = y[2*k+1]*SGN(n2+i+2) + y[2*k+2]*SGN(n2+i1);
+          }
+        if (k == n2)
+          {
+          c[i   ] = y[2*k-1]*SGN(i+1) + y[2*k]*SGN(i);
+          c[N-i1] = y[2*k-1]*SGN(i+2) + y[2*k]*SGN(i1);
+          }
+        }
+
+        // FFTW-derived code ends here
+        }
+      else
+        {
+        // even length algorithm from
+        // https://www.appletonaudio.com/blog/2013/derivation-of-fast-dct-4-algorithm-based-on-dft/
+        arr<cmplx<T>> y(n2);
+        for(size_t i=0; i<n2; ++i)
+          {
+          y[i].Set(c[2*i],c[N-1-2*i]);
+          y[i] = y[i]*C2[i];
+          }
+        fft->forward(y.data(), fct);
+        for(size_t i=0, ic=n2-1; i<n2; ++i, --ic)
+          {
+          c[2*i  ] =  2*(y[i ].r*C2[i ].r-y[i ].i*C2[i ].i);
+          c[2*i+1] = -2*(y[ic].i*C2[ic].r+y[ic].r*C2[ic].i);
+          }
+        }
+      if (!cosine)
+        for (size_t k=1; k<N; k+=2)
+          c[k] = -c[k];
+      }
+
+    size_t length() const { return N; }
+  };
+
 //
 // multi-D infrastructure
 //
@@ -2556,13 +3126,16 @@ template<> struct VTYPE<long double>
   };
 #endif
 
-template<typename T> arr<char> alloc_tmp(const shape_t &shape,
+template<typename T> size_t tmp_size(const shape_t &shape,
   size_t axsize, size_t elemsize)
   {
   auto othersize = util::prod(shape)/axsize;
   auto tmpsize = axsize*((othersize>=VLEN<T>::val) ? VLEN<T>::val : 1);
-  return arr<char>(tmpsize*elemsize);
+  return tmpsize*elemsize;
   }
+template<typename T> arr<char> alloc_tmp(const shape_t &shape,
+  size_t axsize, size_t elemsize)
+  { return arr<char>(tmp_size<T>(shape, axsize, elemsize)); }
 template<typename T> arr<char> alloc_tmp(const shape_t &shape,
   const shape_t &axes, size_t elemsize)
   {
@@ -2578,65 +3151,494 @@ template<typename T> arr<char> alloc_tmp(const shape_t &shape,
   return arr<char>(tmpsize*elemsize);
   }
 
-#ifdef POCKETFFT_OPENMP
-#define POCKETFFT_NTHREADS nthreads
+// Blocked passes: for an axis with a long stride, lines are gathered up to
+// max_block_lines at a time instead of VLEN, so that every element row of
+// the block is one long run of adjacent lines, read and written back with
+// whole cache lines and few page changes.
+constexpr size_t max_block_lines = 64;
+constexpr size_t block_stride_bytes = 4096;
+constexpr size_t block_cache_bytes = 256*1024;
+
+// The number of lines per block for a pass along axis, or 0 if the lines
+// should be gathered VLEN at a time. The block of len*lines elements stays
+// in the L2 cache.
+template<typename T> size_t block_lines(const arr_info &in,
+  const arr_info &out, size_t axis, size_t in_elemsize, size_t out_elemsize)
+  {
+#ifdef POCKETFFT_NO_VECTORS
+  (void)in; (void)out; (void)axis; (void)in_elemsize; (void)out_elemsize;
+  return 0;
 #else
-#define POCKETFFT_NTHREADS
+  constexpr auto vlen = VLEN<T>::val;
+  // multi_iter visits adjacent lines along the last other axis of length >1
+  size_t d = in.ndim();
+  for (size_t i=in.ndim(); i-->0; )
+    if ((i!=axis) && (in.shape(i)>1))
+      { d=i; break; }
+  if ((vlen==1) || (d==in.ndim()) || (in.shape(d)<=vlen)) return 0;
+  if ((size_t(abs(in.stride(d)))!=in_elemsize)
+    || (size_t(abs(out.stride(d)))!=out_elemsize))
+    return 0;
+  if ((size_t(abs(in.stride(axis)))<block_stride_bytes)
+    && (size_t(abs(out.stride(axis)))<block_stride_bytes))
+    return 0;
+  size_t len = in.shape(axis);
+  size_t nblk = block_cache_bytes/(len*max(in_elemsize, out_elemsize));
+  nblk = min(nblk, max_block_lines);
+  nblk -= nblk%vlen;
+  return (nblk>vlen) ? nblk : 0;
 #endif
+  }
 
-template<typename T> POCKETFFT_NOINLINE void general_c(
-  const cndarr<cmplx<T>> &in, ndarr<cmplx<T>> &out,
-  const shape_t &axes, bool forward, T fct, size_t POCKETFFT_NTHREADS)
+// Per-thread temporary storage that outlives a single transform, for
+// callers that execute the same plan many times. reserve() must be called
+// with the number of threads before they start using get().
+class thread_scratch
   {
-  shared_ptr<pocketfft_c<T>> plan;
+  private:
+    vector<arr<char>> buf;
 
-  for (size_t iax=0; iax<axes.size(); ++iax)
-    {
-    constexpr auto vlen = VLEN<T>::val;
-    size_t len=in.shape(axes[iax]);
-    if ((!plan) || (len!=plan->length()))
-      plan = get_plan<pocketfft_c<T>>(len);
+  public:
+    void reserve(size_t nthreads)
+      { if (buf.size()<nthreads) buf.resize(nthreads); }
 
-#ifdef POCKETFFT_OPENMP
-#pragma omp parallel num_threads(util::thread_count(nthreads, in.shape(), axes[iax]))
-#endif
-{
-    auto storage = alloc_tmp<T>(in.shape(), len, sizeof(cmplx<T>));
-    const auto &tin(iax==0? in : out);
-    multi_iter<vlen> it(tin, out, axes[iax]);
-#ifndef POCKETFFT_NO_VECTORS
-    if (vlen>1)
-      while (it.remaining()>=vlen)
-        {
-        using vtype = typename VTYPE<T>::type;
-        it.advance(vlen);
-        auto tdatav = reinterpret_cast<cmplx<vtype> *>(storage.data());
-        for (size_t i=0; i<len; ++i)
-          for (size_t j=0; j<vlen; ++j)
-            {
-            tdatav[i].r[j] = tin[it.iofs(j,i)].r;
-            tdatav[i].i[j] = tin[it.iofs(j,i)].i;
-            }
-        forward ? plan->forward (tdatav, fct) : plan->backward(tdatav, fct);
-        for (size_t i=0; i<len; ++i)
-          for (size_t j=0; j<vlen; ++j)
-            out[it.oofs(j,i)].Set(tdatav[i].r[j],tdatav[i].i[j]);
-        }
-#endif
-    while (it.remaining()>0)
+    char *get(size_t share, size_t bytes)
       {
-      it.advance(1);
-      auto tdata = reinterpret_cast<cmplx<T> *>(storage.data());
-      if ((&tin[0]==&out[0]) && (it.stride_out()==sizeof(cmplx<T>))) // fully in-place
-        forward ? plan->forward (&out[it.oofs(0)], fct)
-                : plan->backward(&out[it.oofs(0)], fct);
-      else if (it.stride_out()==sizeof(cmplx<T>)) // compute FFT in output location
-        {
-        for (size_t i=0; i<len; ++i)
-          out[it.oofs(i)] = tin[it.iofs(i)];
-        forward ? plan->forward (&out[it.oofs(0)], fct)
-                : plan->backward(&out[it.oofs(0)], fct);
-        }
+      if (share>=buf.size()) throw runtime_error("scratch not reserved");
+      if (buf[share].size()<bytes) buf[share].resize(bytes);
+      return buf[share].data();
+      }
+  };
+
+// temporary storage of one thread, taken from scratch if given, else
+// allocated for the duration of the call
+class tmp_storage
+  {
+  private:
+    arr<char> own;
+    char *ptr;
+
+  public:
+    tmp_storage(thread_scratch *scratch, size_t bytes)
+      : own(scratch ? 0 : bytes),
+        ptr(scratch ? scratch->get(threading::thread_id(), bytes) : own.data())
+      {}
+    char *data() { return ptr; }
+  };
+
+//
+// four-step transforms of a single long line
+//
+
+// A single line of at least this many complex points is transformed with
+// the four-step algorithm when more than one thread is requested.
+#ifndef POCKETFFT_FOURSTEP_MIN
+#define POCKETFFT_FOURSTEP_MIN (size_t(1)<<18)
+#endif
+
+// exp(-2 pi i m/n) for 0<=m<n, as the product of the entries of two tables
+// of about sqrt(n) roots each
+template<typename T> class sincos_2pibyn_split
+  {
+  private:
+    using Thigh = typename conditional<(sizeof(T)>sizeof(double)), T, double>::type;
+    size_t l;
+    arr<cmplx<Thigh>> lo, hi;
+
+    static cmplx<Thigh> root(size_t m, size_t n)
+      {
+      constexpr Thigh pi = Thigh(3.141592653589793238462643383279502884197L);
+      // keep the angle in [0, pi] for accuracy
+      bool flip = 2*m>n;
+      Thigh ang = 2*pi*Thigh(flip ? n-m : m)/Thigh(n);
+      return cmplx<Thigh>(cos(ang), flip ? sin(ang) : -sin(ang));
+      }
+
+  public:
+    POCKETFFT_NOINLINE sincos_2pibyn_split(size_t n)
+      : l(size_t(sqrt(double(n)))+1), lo(l), hi((n+l-1)/l)
+      {
+      for (size_t i=0; i<lo.size(); ++i)
+        lo[i] = root(i, n);
+      for (size_t i=0; i<hi.size(); ++i)
+        hi[i] = root(i*l, n);
+      }
+
+    cmplx<T> operator[](size_t m) const
+      {
+      const auto &a(hi[m/l]), &b(lo[m%l]);
+      return cmplx<T>(T(a.r*b.r-a.i*b.i), T(a.r*b.i+a.i*b.r));
+      }
+
+    size_t memsize() const
+      { return (lo.size()+hi.size())*sizeof(cmplx<Thigh>); }
+  };
+
+// The factor n1 of len=n1*n2 for a four-step transform of a single line
+// of len complex points on nthreads threads, or 0 to use the plain
+// transform. n1 is the largest divisor of len not above sqrt(len).
+inline size_t fourstep_factor(size_t len, size_t lines, size_t nthreads)
+  {
+  if (nthreads==0) nthreads = threading::max_threads();
+  if ((lines!=1) || (nthreads==1) || (len<POCKETFFT_FOURSTEP_MIN))
+    return 0;
+  size_t n1 = size_t(sqrt(double(len)));
+  while (n1*n1>len) --n1;
+  for (; n1>=64; --n1)
+    if (len%n1==0) return n1;
+  return 0;
+  }
+
+// the share of the calling thread in n items, for thread_map
+inline void thread_share(size_t n, size_t &lo, size_t &hi)
+  {
+  size_t nthreads = threading::num_threads(), id = threading::thread_id();
+  lo = n*id/nthreads;
+  hi = n*(id+1)/nthreads;
+  }
+
+// Four-step (Bailey) transform of the line along axis of in, of length
+// len=n1*n2, seen as the n1 x n2 matrix in[j1*n2+j2], into out[k1+n1*k2]:
+//  - n2 transforms of length n1 down the columns,
+//  - multiplication by the twiddle factors exp(-+2 pi i j2*k1/len),
+//  - n1 transforms of length n2 along the rows,
+//  - a transpose.
+// Each pass works on blocks of columns or rows, so that the strided
+// accesses touch whole cache lines, and splits the blocks between the
+// threads. in and out may be the same array.
+template<typename T> POCKETFFT_NOINLINE void fourstep_c(
+  const cndarr<cmplx<T>> &in, ndarr<cmplx<T>> &out, size_t axis,
+  size_t n1, bool forward, T fct, size_t nthreads)
+  {
+  constexpr size_t blk = 16;
+  size_t len = in.shape(axis), n2 = len/n1;
+  ptrdiff_t s_in = in.stride(axis), s_out = out.stride(axis);
+  auto plan1 = get_plan<pocketfft_c<T>>(n1);
+  auto plan2 = get_plan<pocketfft_c<T>>(n2);
+  auto twiddle_ = get_table<sincos_2pibyn_split<T>>(len);
+  const auto &twiddle(*twiddle_);
+  arr<cmplx<T>> tmp(len);
+
+  // transform the columns, with the twiddle factors, into tmp
+  threading::thread_map(nthreads, [&] {
+    arr<cmplx<T>> buf(blk*n1);
+    size_t lo, hi;
+    thread_share((n2+blk-1)/blk, lo, hi);
+    for (size_t b=lo; b<hi; ++b)
+      {
+      size_t c0 = b*blk, nc = min(blk, n2-c0);
+      for (size_t j1=0; j1<n1; ++j1)
+        for (size_t c=0; c<nc; ++c)
+          buf[c*n1+j1] = in[ptrdiff_t(j1*n2+c0+c)*s_in];
+      for (size_t c=0; c<nc; ++c)
+        {
+        auto col = buf.data()+c*n1;
+        size_t j2 = c0+c;
+        if (forward)
+          {
+          plan1->forward(col, T(1));
+          for (size_t k1=1; k1<n1; ++k1)
+            col[k1] = col[k1]*twiddle[j2*k1];
+          }
+        else
+          {
+          plan1->backward(col, T(1));
+          for (size_t k1=1; k1<n1; ++k1)
+            col[k1] = col[k1].template special_mul<true>(twiddle[j2*k1]);
+          }
+        }
+      for (size_t k1=0; k1<n1; ++k1)
+        for (size_t c=0; c<nc; ++c)
+          tmp[k1*n2+c0+c] = buf[c*n1+k1];
+      }
+    });
+
+  // transform the rows of tmp, and write them transposed to out
+  threading::thread_map(nthreads, [&] {
+    size_t lo, hi;
+    thread_share((n1+blk-1)/blk, lo, hi);
+    for (size_t b=lo; b<hi; ++b)
+      {
+      size_t r0 = b*blk, nr = min(blk, n1-r0);
+      for (size_t r=0; r<nr; ++r)
+        {
+        auto row = tmp.data()+(r0+r)*n2;
+        forward ? plan2->forward(row, fct) : plan2->backward(row, fct);
+        }
+      for (size_t k2=0; k2<n2; ++k2)
+        for (size_t r=0; r<nr; ++r)
+          out[ptrdiff_t(r0+r+n1*k2)*s_out] = tmp[(r0+r)*n2+k2];
+      }
+    });
+  }
+
+// Real transform of a single line of even length len=2*m along axis, as
+// the four-step complex transform of z[j] = x[2j] + i*x[2j+1], with
+// n1 a factor of m
+template<typename T> POCKETFFT_NOINLINE void fourstep_r2c(
+  const cndarr<T> &in, ndarr<cmplx<T>> &out, size_t axis, size_t n1,
+  bool forward, T fct, size_t nthreads)
+  {
+  size_t len = in.shape(axis), m = len/2;
+  ptrdiff_t s_in = in.stride(axis), s_out = out.stride(axis);
+  arr<cmplx<T>> z(m);
+  threading::thread_map(nthreads, [&] {
+    size_t lo, hi;
+    thread_share(m, lo, hi);
+    for (size_t j=lo; j<hi; ++j)
+      z[j].Set(in[ptrdiff_t(2*j)*s_in], in[ptrdiff_t(2*j+1)*s_in]);
+    });
+
+  shape_t shp{m};
+  stride_t str{ptrdiff_t(sizeof(cmplx<T>))};
+  ndarr<cmplx<T>> az(z.data(), shp, str);
+  fourstep_c<T>(az, az, 0, n1, true, T(1), nthreads);
+
+  // with E and O the transforms of the even and odd points,
+  // X[k] = E[k] + exp(-2 pi i k/len)*O[k], for k=0..m
+  auto twiddle_ = get_table<sincos_2pibyn_split<T>>(len);
+  const auto &twiddle(*twiddle_);
+  T half = T(0.5)*fct;
+  threading::thread_map(nthreads, [&] {
+    size_t lo, hi;
+    thread_share(m+1, lo, hi);
+    for (size_t k=lo; k<hi; ++k)
+      {
+      auto a = z[(k==m) ? 0 : k], b = conj(z[(k==0) ? 0 : m-k]);
+      auto e = a+b, d = a-b;
+      auto o = cmplx<T>(d.i, -d.r)*twiddle[k];
+      auto x = (e+o)*half;
+      out[ptrdiff_t(k)*s_out] = forward ? x : conj(x);
+      }
+    });
+  }
+
+// Inverse of fourstep_r2c: the real line of even length len=2*m along axis
+// of out from its m+1 complex coefficients in in
+template<typename T> POCKETFFT_NOINLINE void fourstep_c2r(
+  const cndarr<cmplx<T>> &in, ndarr<T> &out, size_t axis, size_t n1,
+  bool forward, T fct, size_t nthreads)
+  {
+  size_t len = out.shape(axis), m = len/2;
+  ptrdiff_t s_in = in.stride(axis), s_out = out.stride(axis);
+  auto twiddle_ = get_table<sincos_2pibyn_split<T>>(len);
+  const auto &twiddle(*twiddle_);
+  arr<cmplx<T>> z(m);
+
+  // Z[k] = E[k] + i*O[k], with E and O twice the transforms of the even
+  // and odd points; the imaginary parts of X[0] and X[m] are ignored
+  threading::thread_map(nthreads, [&] {
+    size_t lo, hi;
+    thread_share(m, lo, hi);
+    for (size_t k=lo; k<hi; ++k)
+      {
+      auto a = in[ptrdiff_t(k)*s_in], b = in[ptrdiff_t(m-k)*s_in];
+      if (forward) a = conj(a); else b = conj(b);
+      if (k==0) { a.i = T(0); b.i = T(0); }
+      auto e = a+b, d = a-b;
+      auto o = d.template special_mul<true>(twiddle[k]);
+      z[k] = cmplx<T>(e.r-o.i, e.i+o.r);
+      }
+    });
+
+  shape_t shp{m};
+  stride_t str{ptrdiff_t(sizeof(cmplx<T>))};
+  ndarr<cmplx<T>> az(z.data(), shp, str);
+  fourstep_c<T>(az, az, 0, n1, false, fct, nthreads);
+
+  threading::thread_map(nthreads, [&] {
+    size_t lo, hi;
+    thread_share(m, lo, hi);
+    for (size_t j=lo; j<hi; ++j)
+      {
+      out[ptrdiff_t(2*j)*s_out] = z[j].r;
+      out[ptrdiff_t(2*j+1)*s_out] = z[j].i;
+      }
+    });
+  }
+
+// If plan_ is given, it is used for all axes (which must have its length)
+// and the four-step path is skipped; scratch, if given, provides the
+// temporary storage.
+#ifndef POCKETFFT_NO_VECTORS
+// One thread's share of a blocked c2c pass along axis (see block_lines);
+// buf holds len*nblk complex values
+template<typename T> void blocked_c(const cndarr<cmplx<T>> &in,
+  ndarr<cmplx<T>> &out, size_t axis, pocketfft_c<T> &plan, bool forward,
+  T fct, size_t nblk, char *buf)
+  {
+  using vtype = typename VTYPE<T>::type;
+  constexpr auto vlen = VLEN<T>::val;
+  size_t len = in.shape(axis);
+  multi_iter<max_block_lines> it(in, out, axis);
+  auto tdatav = reinterpret_cast<cmplx<vtype> *>(buf);
+  while (it.remaining()>=vlen)
+    {
+    size_t n = min(nblk, it.remaining()-it.remaining()%vlen), ng = n/vlen;
+    it.advance(n);
+    for (size_t i=0; i<len; ++i)
+      for (size_t g=0; g<ng; ++g)
+        for (size_t j=0; j<vlen; ++j)
+          {
+          tdatav[g*len+i].r[j] = in[it.iofs(g*vlen+j,i)].r;
+          tdatav[g*len+i].i[j] = in[it.iofs(g*vlen+j,i)].i;
+          }
+    for (size_t g=0; g<ng; ++g)
+      forward ? plan.forward (tdatav+g*len, fct)
+              : plan.backward(tdatav+g*len, fct);
+    for (size_t i=0; i<len; ++i)
+      for (size_t g=0; g<ng; ++g)
+        for (size_t j=0; j<vlen; ++j)
+          out[it.oofs(g*vlen+j,i)].Set(tdatav[g*len+i].r[j],
+                                       tdatav[g*len+i].i[j]);
+    }
+  auto tdata = reinterpret_cast<cmplx<T> *>(buf);
+  while (it.remaining()>0)
+    {
+    it.advance(1);
+    for (size_t i=0; i<len; ++i)
+      tdata[i] = in[it.iofs(i)];
+    forward ? plan.forward (tdata, fct) : plan.backward(tdata, fct);
+    for (size_t i=0; i<len; ++i)
+      out[it.oofs(i)] = tdata[i];
+    }
+  }
+
+// One thread's share of a blocked r2c pass along axis (see block_lines);
+// buf holds len*nblk real values
+template<typename T> void blocked_r2c(const cndarr<T> &in,
+  ndarr<cmplx<T>> &out, size_t axis, pocketfft_r<T> &plan, bool forward,
+  T fct, size_t nblk, char *buf)
+  {
+  using vtype = typename VTYPE<T>::type;
+  constexpr auto vlen = VLEN<T>::val;
+  size_t len = in.shape(axis);
+  multi_iter<max_block_lines> it(in, out, axis);
+  auto tdatav = reinterpret_cast<vtype *>(buf);
+  T sign = forward ? T(1) : T(-1);
+  while (it.remaining()>=vlen)
+    {
+    size_t n = min(nblk, it.remaining()-it.remaining()%vlen), ng = n/vlen;
+    it.advance(n);
+    for (size_t i=0; i<len; ++i)
+      for (size_t g=0; g<ng; ++g)
+        for (size_t j=0; j<vlen; ++j)
+          tdatav[g*len+i][j] = in[it.iofs(g*vlen+j,i)];
+    for (size_t g=0; g<ng; ++g)
+      plan.forward(tdatav+g*len, fct);
+    for (size_t g=0; g<ng; ++g)
+      for (size_t j=0; j<vlen; ++j)
+        out[it.oofs(g*vlen+j,0)].Set(tdatav[g*len][j]);
+    size_t i=1, ii=1;
+    for (; i<len-1; i+=2, ++ii)
+      for (size_t g=0; g<ng; ++g)
+        for (size_t j=0; j<vlen; ++j)
+          out[it.oofs(g*vlen+j,ii)].Set(tdatav[g*len+i][j],
+                                        sign*tdatav[g*len+i+1][j]);
+    if (i<len)
+      for (size_t g=0; g<ng; ++g)
+        for (size_t j=0; j<vlen; ++j)
+          out[it.oofs(g*vlen+j,ii)].Set(tdatav[g*len+i][j]);
+    }
+  auto tdata = reinterpret_cast<T *>(buf);
+  while (it.remaining()>0)
+    {
+    it.advance(1);
+    for (size_t i=0; i<len; ++i)
+      tdata[i] = in[it.iofs(i)];
+    plan.forward(tdata, fct);
+    out[it.oofs(0)].Set(tdata[0]);
+    size_t i=1, ii=1;
+    for (; i<len-1; i+=2, ++ii)
+      out[it.oofs(ii)].Set(tdata[i], sign*tdata[i+1]);
+    if (i<len)
+      out[it.oofs(ii)].Set(tdata[i]);
+    }
+  }
+#endif
+
+template<typename T> POCKETFFT_NOINLINE void general_c(
+  const cndarr<cmplx<T>> &in, ndarr<cmplx<T>> &out,
+  const shape_t &axes, bool forward, T fct, size_t nthreads,
+  pocketfft_c<T> *plan_=nullptr, thread_scratch *scratch=nullptr)
+  {
+  shared_ptr<pocketfft_c<T>> cached;
+
+  for (size_t iax=0; iax<axes.size(); ++iax)
+    {
+    constexpr auto vlen = VLEN<T>::val;
+    size_t len=in.shape(axes[iax]);
+    if (plan_)
+      {
+      if (len!=plan_->length())
+        throw runtime_error("axis length does not match the plan");
+      }
+    else
+      {
+      size_t n1=fourstep_factor(len, in.size()/len, nthreads);
+      if (n1!=0)
+        {
+        fourstep_c(iax==0 ? in : out, out, axes[iax], n1, forward, fct,
+          nthreads);
+        fct = T(1);
+        continue;
+        }
+      if ((!cached) || (len!=cached->length()))
+        cached = get_plan<pocketfft_c<T>>(len);
+      }
+    auto plan = plan_ ? plan_ : cached.get();
+
+    auto nth = util::thread_count(nthreads, in.shape(), axes[iax]);
+    if (scratch) scratch->reserve(nth);
+    size_t nblk = block_lines<T>(iax==0 ? in : out, out, axes[iax],
+      sizeof(cmplx<T>), sizeof(cmplx<T>));
+threading::thread_map(nth,
+  [&] {
+    tmp_storage storage(scratch, nblk ? len*nblk*sizeof(cmplx<T>) :
+      tmp_size<T>(in.shape(), len, sizeof(cmplx<T>)));
+    const auto &tin(iax==0? in : out);
+#ifndef POCKETFFT_NO_VECTORS
+    if (nblk>0)
+      {
+      blocked_c(tin, out, axes[iax], *plan, forward, fct, nblk,
+        storage.data());
+      return;
+      }
+#endif
+    multi_iter<vlen> it(tin, out, axes[iax]);
+#ifndef POCKETFFT_NO_VECTORS
+    if (vlen>1)
+      while (it.remaining()>=vlen)
+        {
+        using vtype = typename VTYPE<T>::type;
+        it.advance(vlen);
+        auto tdatav = reinterpret_cast<cmplx<vtype> *>(storage.data());
+        for (size_t i=0; i<len; ++i)
+          for (size_t j=0; j<vlen; ++j)
+            {
+            tdatav[i].r[j] = tin[it.iofs(j,i)].r;
+            tdatav[i].i[j] = tin[it.iofs(j,i)].i;
+            }
+        forward ? plan->forward (tdatav, fct) : plan->backward(tdatav, fct);
+        for (size_t i=0; i<len; ++i)
+          for (size_t j=0; j<vlen; ++j)
+            out[it.oofs(j,i)].Set(tdatav[i].r[j],tdatav[i].i[j]);
+        }
+#endif
+    while (it.remaining()>0)
+      {
+      it.advance(1);
+      auto tdata = reinterpret_cast<cmplx<T> *>(storage.data());
+      if ((&tin[0]==&out[0]) && (it.stride_out()==sizeof(cmplx<T>))) // fully in-place
+        forward ? plan->forward (&out[it.oofs(0)], fct)
+                : plan->backward(&out[it.oofs(0)], fct);
+      else if (it.stride_out()==sizeof(cmplx<T>)) // compute FFT in output location
+        {
+        for (size_t i=0; i<len; ++i)
+          out[it.oofs(i)] = tin[it.iofs(i)];
+        forward ? plan->forward (&out[it.oofs(0)], fct)
+                : plan->backward(&out[it.oofs(0)], fct);
+        }
       else
         {
         for (size_t i=0; i<len; ++i)
@@ -2646,14 +3648,14 @@ template<typename T> POCKETFFT_NOINLINE void general_c(
           out[it.oofs(i)] = tdata[i];
         }
       }
-} // end of parallel region
+}); // end of parallel region
     fct = T(1); // factor has been applied, use 1 for remaining axes
     }
   }
 
 template<typename T> POCKETFFT_NOINLINE void general_hartley(
   const cndarr<T> &in, ndarr<T> &out, const shape_t &axes, T fct,
-  size_t POCKETFFT_NTHREADS)
+  size_t nthreads)
   {
   shared_ptr<pocketfft_r<T>> plan;
 
@@ -2664,10 +3666,8 @@ template<typename T> POCKETFFT_NOINLINE void general_hartley(
     if ((!plan) || (len!=plan->length()))
       plan = get_plan<pocketfft_r<T>>(len);
 
-#ifdef POCKETFFT_OPENMP
-#pragma omp parallel num_threads(util::thread_count(nthreads, in.shape(), axes[iax]))
-#endif
-{
+threading::thread_map(util::thread_count(nthreads, in.shape(), axes[iax]),
+  [&] {
     auto storage = alloc_tmp<T>(in.shape(), len, sizeof(T));
     const auto &tin(iax==0 ? in : out);
     multi_iter<vlen> it(tin, out, axes[iax]);
@@ -2714,23 +3714,50 @@ template<typename T> POCKETFFT_NOINLINE void general_hartley(
       if (i<len)
         out[it.oofs(i1)] = tdata[i];
       }
-} // end of parallel region
+}); // end of parallel region
     fct = T(1); // factor has been applied, use 1 for remaining axes
     }
   }
 
+// plan_ and scratch as for general_c
 template<typename T> POCKETFFT_NOINLINE void general_r2c(
   const cndarr<T> &in, ndarr<cmplx<T>> &out, size_t axis, bool forward, T fct,
-  size_t POCKETFFT_NTHREADS)
+  size_t nthreads, pocketfft_r<T> *plan_=nullptr,
+  thread_scratch *scratch=nullptr)
   {
-  auto plan = get_plan<pocketfft_r<T>>(in.shape(axis));
-  constexpr auto vlen = VLEN<T>::val;
   size_t len=in.shape(axis);
-#ifdef POCKETFFT_OPENMP
-#pragma omp parallel num_threads(util::thread_count(nthreads, in.shape(), axis))
+  shared_ptr<pocketfft_r<T>> cached;
+  if (plan_)
+    {
+    if (len!=plan_->length())
+      throw runtime_error("axis length does not match the plan");
+    }
+  else
+    {
+    size_t n1=(len%2==0) ? fourstep_factor(len/2, in.size()/len, nthreads) : 0;
+    if (n1!=0)
+      {
+      fourstep_r2c(in, out, axis, n1, forward, fct, nthreads);
+      return;
+      }
+    cached = get_plan<pocketfft_r<T>>(len);
+    }
+  auto plan = plan_ ? plan_ : cached.get();
+  constexpr auto vlen = VLEN<T>::val;
+  auto nth = util::thread_count(nthreads, in.shape(), axis);
+  if (scratch) scratch->reserve(nth);
+  size_t nblk = block_lines<T>(in, out, axis, sizeof(T), sizeof(cmplx<T>));
+threading::thread_map(nth,
+  [&] {
+  tmp_storage storage(scratch, nblk ? len*nblk*sizeof(T) :
+    tmp_size<T>(in.shape(), len, sizeof(T)));
+#ifndef POCKETFFT_NO_VECTORS
+  if (nblk>0)
+    {
+    blocked_r2c(in, out, axis, *plan, forward, fct, nblk, storage.data());
+    return;
+    }
 #endif
-{
-  auto storage = alloc_tmp<T>(in.shape(), len, sizeof(T));
   multi_iter<vlen> it(in, out, axis);
 #ifndef POCKETFFT_NO_VECTORS
   if (vlen>1)
@@ -2777,20 +3804,38 @@ template<typename T> POCKETFFT_NOINLINE void general_r2c(
     if (i<len)
       out[it.oofs(ii)].Set(tdata[i]);
     }
-} // end of parallel region
+}); // end of parallel region
   }
+// plan_ and scratch as for general_c
 template<typename T> POCKETFFT_NOINLINE void general_c2r(
   const cndarr<cmplx<T>> &in, ndarr<T> &out, size_t axis, bool forward, T fct,
-  size_t POCKETFFT_NTHREADS)
+  size_t nthreads, pocketfft_r<T> *plan_=nullptr,
+  thread_scratch *scratch=nullptr)
   {
-  auto plan = get_plan<pocketfft_r<T>>(out.shape(axis));
-  constexpr auto vlen = VLEN<T>::val;
   size_t len=out.shape(axis);
-#ifdef POCKETFFT_OPENMP
-#pragma omp parallel num_threads(util::thread_count(nthreads, in.shape(), axis))
-#endif
-{
-  auto storage = alloc_tmp<T>(out.shape(), len, sizeof(T));
+  shared_ptr<pocketfft_r<T>> cached;
+  if (plan_)
+    {
+    if (len!=plan_->length())
+      throw runtime_error("axis length does not match the plan");
+    }
+  else
+    {
+    size_t n1=(len%2==0) ? fourstep_factor(len/2, out.size()/len, nthreads) : 0;
+    if (n1!=0)
+      {
+      fourstep_c2r(in, out, axis, n1, forward, fct, nthreads);
+      return;
+      }
+    cached = get_plan<pocketfft_r<T>>(len);
+    }
+  auto plan = plan_ ? plan_ : cached.get();
+  constexpr auto vlen = VLEN<T>::val;
+  auto nth = util::thread_count(nthreads, in.shape(), axis);
+  if (scratch) scratch->reserve(nth);
+threading::thread_map(nth,
+  [&] {
+  tmp_storage storage(scratch, tmp_size<T>(out.shape(), len, sizeof(T)));
   multi_iter<vlen> it(in, out, axis);
 #ifndef POCKETFFT_NO_VECTORS
   if (vlen>1)
@@ -2853,12 +3898,12 @@ template<typename T> POCKETFFT_NOINLINE void general_c2r(
     for (size_t i=0; i<len; ++i)
       out[it.oofs(i)] = tdata[i];
     }
-} // end of parallel region
+}); // end of parallel region
   }
 
 template<typename T> POCKETFFT_NOINLINE void general_r(
   const cndarr<T> &in, ndarr<T> &out, const shape_t &axes, bool r2c,
-  bool forward, T fct, size_t POCKETFFT_NTHREADS)
+  bool forward, T fct, size_t nthreads)
   {
   shared_ptr<pocketfft_r<T>> plan;
 
@@ -2869,10 +3914,8 @@ template<typename T> POCKETFFT_NOINLINE void general_r(
     if ((!plan) || (len!=plan->length()))
       plan = get_plan<pocketfft_r<T>>(len);
 
-#ifdef POCKETFFT_OPENMP
-#pragma omp parallel num_threads(util::thread_count(nthreads, in.shape(), axes[iax]))
-#endif
-{
+threading::thread_map(util::thread_count(nthreads, in.shape(), axes[iax]),
+  [&] {
     auto storage = alloc_tmp<T>(in.shape(), len, sizeof(T));
     const auto &tin(iax==0 ? in : out);
     multi_iter<vlen> it(tin, out, axes[iax]);
@@ -2944,12 +3987,381 @@ template<typename T> POCKETFFT_NOINLINE void general_r(
           out[it.oofs(i)] = tdata[i];
         }
       }
-} // end of parallel region
+}); // end of parallel region
+    fct = T(1); // factor has been applied, use 1 for remaining axes
+    }
+  }
+
+template<typename Trafo, typename T> POCKETFFT_NOINLINE void general_dcst(
+  const cndarr<T> &in, ndarr<T> &out, const shape_t &axes, T fct, bool ortho,
+  int type, bool cosine, size_t nthreads)
+  {
+  shared_ptr<Trafo> plan;
+
+  for (size_t iax=0; iax<axes.size(); ++iax)
+    {
+    constexpr auto vlen = VLEN<T>::val;
+    size_t len=in.shape(axes[iax]);
+    if ((!plan) || (len!=plan->length()))
+      plan = get_plan<Trafo>(len);
+
+threading::thread_map(util::thread_count(nthreads, in.shape(), axes[iax]),
+  [&] {
+    auto storage = alloc_tmp<T>(in.shape(), len, sizeof(T));
+    const auto &tin(iax==0 ? in : out);
+    multi_iter<vlen> it(tin, out, axes[iax]);
+#ifndef POCKETFFT_NO_VECTORS
+    if (vlen>1)
+      while (it.remaining()>=vlen)
+        {
+        using vtype = typename VTYPE<T>::type;
+        it.advance(vlen);
+        auto tdatav = reinterpret_cast<vtype *>(storage.data());
+        for (size_t i=0; i<len; ++i)
+          for (size_t j=0; j<vlen; ++j)
+            tdatav[i][j] = tin[it.iofs(j,i)];
+        plan->exec(tdatav, fct, ortho, type, cosine);
+        for (size_t i=0; i<len; ++i)
+          for (size_t j=0; j<vlen; ++j)
+            out[it.oofs(j,i)] = tdatav[i][j];
+        }
+#endif
+    while (it.remaining()>0)
+      {
+      it.advance(1);
+      auto tdata = reinterpret_cast<T *>(storage.data());
+      if ((&tin[0]==&out[0]) && (it.stride_out()==sizeof(T))) // fully in-place
+        plan->exec(&out[it.oofs(0)], fct, ortho, type, cosine);
+      else if (it.stride_out()==sizeof(T)) // compute in output location
+        {
+        for (size_t i=0; i<len; ++i)
+          out[it.oofs(i)] = tin[it.iofs(i)];
+        plan->exec(&out[it.oofs(0)], fct, ortho, type, cosine);
+        }
+      else
+        {
+        for (size_t i=0; i<len; ++i)
+          tdata[i] = tin[it.iofs(i)];
+        plan->exec(tdata, fct, ortho, type, cosine);
+        for (size_t i=0; i<len; ++i)
+          out[it.oofs(i)] = tdata[i];
+        }
+      }
+}); // end of parallel region
     fct = T(1); // factor has been applied, use 1 for remaining axes
     }
   }
 
-#undef POCKETFFT_NTHREADS
+//
+// FFT-based linear convolution of real arrays
+//
+
+// a *= b for two spectra of length len in FFTPACK halfcomplex order
+template<typename T> inline void halfcomplex_mul(T * POCKETFFT_RESTRICT a,
+  const T * POCKETFFT_RESTRICT b, size_t len)
+  {
+  a[0] *= b[0];
+  size_t i=1;
+  for (; i+1<len; i+=2)
+    {
+    T ar=a[i], ai=a[i+1];
+    a[i  ] = ar*b[i  ]-ai*b[i+1];
+    a[i+1] = ar*b[i+1]+ai*b[i  ];
+    }
+  if (i<len) a[i] *= b[i];
+  }
+
+// Convolution along a single axis, one line at a time: both lines are
+// zero-padded to nfft, transformed, multiplied and transformed back in one
+// scratch buffer, and out receives the window [start; start+out.shape(axis))
+// of the result. a and b must have the shape of out along all other axes.
+template<typename T> POCKETFFT_NOINLINE void general_convolve_1d(
+  const cndarr<T> &a, const cndarr<T> &b, ndarr<T> &out, size_t axis,
+  size_t nfft, size_t start, T fct, size_t nthreads)
+  {
+  auto plan = get_plan<pocketfft_r<T>>(nfft);
+  size_t na=a.shape(axis), nb=b.shape(axis), nout=out.shape(axis);
+  constexpr auto vlen = VLEN<T>::val;
+threading::thread_map(util::thread_count(nthreads, out.shape(), axis),
+  [&] {
+  auto storage = alloc_tmp<T>(out.shape(), 2*nfft, sizeof(T));
+  multi_iter<vlen> ita(a, out, axis), itb(b, out, axis);
+#ifndef POCKETFFT_NO_VECTORS
+  if (vlen>1)
+    while (ita.remaining()>=vlen)
+      {
+      using vtype = typename VTYPE<T>::type;
+      ita.advance(vlen); itb.advance(vlen);
+      auto bufa = reinterpret_cast<vtype *>(storage.data()), bufb=bufa+nfft;
+      for (size_t i=0; i<nfft; ++i)
+        for (size_t j=0; j<vlen; ++j)
+          {
+          bufa[i][j] = (i<na) ? a[ita.iofs(j,i)] : T(0);
+          bufb[i][j] = (i<nb) ? b[itb.iofs(j,i)] : T(0);
+          }
+      plan->forward(bufa, fct);
+      plan->forward(bufb, T(1));
+      halfcomplex_mul(bufa, bufb, nfft);
+      plan->backward(bufa, T(1));
+      for (size_t i=0; i<nout; ++i)
+        for (size_t j=0; j<vlen; ++j)
+          out[ita.oofs(j,i)] = bufa[start+i][j];
+      }
+#endif
+  while (ita.remaining()>0)
+    {
+    ita.advance(1); itb.advance(1);
+    auto bufa = reinterpret_cast<T *>(storage.data()), bufb=bufa+nfft;
+    for (size_t i=0; i<nfft; ++i)
+      {
+      bufa[i] = (i<na) ? a[ita.iofs(i)] : T(0);
+      bufb[i] = (i<nb) ? b[itb.iofs(i)] : T(0);
+      }
+    plan->forward(bufa, fct);
+    plan->forward(bufb, T(1));
+    halfcomplex_mul(bufa, bufb, nfft);
+    plan->backward(bufa, T(1));
+    for (size_t i=0; i<nout; ++i)
+      out[ita.oofs(i)] = bufa[start+i];
+    }
+}); // end of parallel region
+  }
+
+// r2c transform of length nfft along axis, with the lines of in (which may be
+// shorter) zero-padded; out has nfft/2+1 entries along axis
+template<typename T> POCKETFFT_NOINLINE void general_r2c_padded(
+  const cndarr<T> &in, ndarr<cmplx<T>> &out, size_t axis, size_t nfft,
+  size_t nthreads)
+  {
+  auto plan = get_plan<pocketfft_r<T>>(nfft);
+  size_t len=in.shape(axis);
+threading::thread_map(util::thread_count(nthreads, in.shape(), axis),
+  [&] {
+  arr<T> tdata(nfft);
+  multi_iter<1> it(in, out, axis);
+  while (it.remaining()>0)
+    {
+    it.advance(1);
+    for (size_t i=0; i<nfft; ++i)
+      tdata[i] = (i<len) ? in[it.iofs(i)] : T(0);
+    plan->forward(tdata.data(), T(1));
+    out[it.oofs(0)].Set(tdata[0]);
+    size_t i=1, ii=1;
+    for (; i<nfft-1; i+=2, ++ii)
+      out[it.oofs(ii)].Set(tdata[i], tdata[i+1]);
+    if (i<nfft)
+      out[it.oofs(ii)].Set(tdata[i]);
+    }
+}); // end of parallel region
+  }
+
+// c2r transform of length nfft along axis, of which out receives the window
+// [start; start+out.shape(axis))
+template<typename T> POCKETFFT_NOINLINE void general_c2r_cropped(
+  const cndarr<cmplx<T>> &in, ndarr<T> &out, size_t axis, size_t nfft,
+  size_t start, T fct, size_t nthreads)
+  {
+  auto plan = get_plan<pocketfft_r<T>>(nfft);
+  size_t nout=out.shape(axis);
+threading::thread_map(util::thread_count(nthreads, out.shape(), axis),
+  [&] {
+  arr<T> tdata(nfft);
+  multi_iter<1> it(in, out, axis);
+  while (it.remaining()>0)
+    {
+    it.advance(1);
+    tdata[0]=in[it.iofs(0)].r;
+    size_t i=1, ii=1;
+    for (; i<nfft-1; i+=2, ++ii)
+      {
+      tdata[i  ] = in[it.iofs(ii)].r;
+      tdata[i+1] = in[it.iofs(ii)].i;
+      }
+    if (i<nfft)
+      tdata[i] = in[it.iofs(ii)].r;
+    plan->backward(tdata.data(), fct);
+    for (size_t j=0; j<nout; ++j)
+      out[it.oofs(j)] = tdata[start+j];
+    }
+}); // end of parallel region
+  }
+
+// What segment_spectra stores for every segment X of a line
+enum spectra_mode { SPECTRA, POWER, POWER_SUM };
+
+// Windowed spectra of the overlapping segments of real lines. Segment s of
+// line l consists of the nperseg samples starting at in[ofs[l]+s*step*s_in]
+// (offsets and stride in elements). It has its mean (detrend 1) or its
+// least-squares line (detrend 2) removed, is multiplied by win and
+// zero-padded to nfft, and goes through an r2c transform into
+// nfreq=nfft/2+1 bins X, computed in precision T. Depending on mode,
+//  - SPECTRA stores fct*X at spec[(l*nseg+s)*nfreq+k],
+//  - POWER stores fct*|X|^2, doubled for the bins that stand for a pair of
+//    frequencies, at pow[(l*nseg+s)*nfreq+k],
+//  - POWER_SUM adds up POWER over the segments into pow[l*nfreq+k].
+// All steps happen in one buffer of nfft values per thread.
+template<typename Tin, typename T> POCKETFFT_NOINLINE void segment_spectra(
+  const Tin *in, const vector<ptrdiff_t> &ofs, ptrdiff_t s_in, size_t nseg,
+  size_t step, const T *win, size_t nperseg, size_t nfft, int detrend,
+  spectra_mode mode, T fct, cmplx<T> *spec, T *pow, size_t nthreads)
+  {
+  size_t nlines=ofs.size(), nfreq=nfft/2+1, nunits=nlines*nseg;
+  if (mode==POWER_SUM)
+    for (size_t i=0; i<nlines*nfreq; ++i) pow[i]=T(0);
+  if (nunits==0) return;
+  auto plan = get_plan<pocketfft_r<T>>(nfft);
+  // sums of (i - (nperseg-1)/2)^2 for the slope of a least-squares line
+  T mid = T(nperseg-1)/2, sxx=0;
+  for (size_t i=0; i<nperseg; ++i)
+    sxx += (T(i)-mid)*(T(i)-mid);
+  size_t nth = util::thread_count(nthreads, {nunits, nperseg}, 1);
+  // POWER_SUM: every thread sums its range of segments into the lines it
+  // touches, and the partial sums are added up afterwards
+  vector<arr<T>> part(mode==POWER_SUM ? nth : 0);
+  vector<size_t> part_l0(part.size());
+
+threading::thread_map(nth, [&] {
+  arr<T> buf(nfft);
+  size_t lo, hi;
+  thread_share(nunits, lo, hi);
+  if (lo>=hi) return;
+  T *acc = nullptr;
+  size_t l0 = lo/nseg;
+  if (mode==POWER_SUM)
+    {
+    auto &p(part[threading::thread_id()]);
+    p.resize(((hi-1)/nseg-l0+1)*nfreq);
+    for (size_t i=0; i<p.size(); ++i) p[i]=T(0);
+    part_l0[threading::thread_id()] = l0;
+    acc = p.data();
+    }
+  for (size_t u=lo; u<hi; ++u)
+    {
+    size_t l=u/nseg, s=u%nseg;
+    const Tin *seg = in + ofs[l] + ptrdiff_t(s*step)*s_in;
+    T a=0, b=0;  // the trend a + b*(i-mid)
+    if (detrend!=0)
+      {
+      for (size_t i=0; i<nperseg; ++i)
+        {
+        T v = T(seg[ptrdiff_t(i)*s_in]);
+        a += v;
+        if (detrend==2) b += (T(i)-mid)*v;
+        }
+      a /= T(nperseg);
+      if ((detrend==2) && (sxx>0)) b /= sxx;
+      }
+    for (size_t i=0; i<nperseg; ++i)
+      buf[i] = (T(seg[ptrdiff_t(i)*s_in])-a-b*(T(i)-mid))*win[i];
+    for (size_t i=nperseg; i<nfft; ++i)
+      buf[i] = T(0);
+    plan->forward(buf.data(), T(1));
+    if (mode==SPECTRA)
+      {
+      auto o = spec + u*nfreq;
+      o[0].Set(buf[0]*fct);
+      size_t i=1, k=1;
+      for (; i<nfft-1; i+=2, ++k)
+        o[k].Set(buf[i]*fct, buf[i+1]*fct);
+      if (i<nfft)
+        o[k].Set(buf[i]*fct);
+      continue;
+      }
+    auto o = (mode==POWER) ? pow + u*nfreq : acc + (l-l0)*nfreq;
+    if (mode==POWER)
+      for (size_t k=0; k<nfreq; ++k) o[k]=T(0);
+    T f2 = 2*fct;
+    o[0] += buf[0]*buf[0]*fct;
+    size_t i=1, k=1;
+    for (; i<nfft-1; i+=2, ++k)
+      o[k] += (buf[i]*buf[i]+buf[i+1]*buf[i+1])*f2;
+    if (i<nfft)
+      o[k] += buf[i]*buf[i]*fct;  // the unpaired Nyquist bin
+    }
+}); // end of parallel region
+
+  for (size_t t=0; t<part.size(); ++t)
+    for (size_t i=0; i<part[t].size(); ++i)
+      pow[part_l0[t]*nfreq+i] += part[t][i];
+  }
+
+// Streaming FIR filter by overlap-save. The spectrum of the kernel is
+// computed once; every call to filter() continues the causal convolution
+// y[n] = sum_k kernel[k]*x[n-k] of all samples passed so far, so a signal
+// can be fed in blocks of any size. After construction no memory is
+// allocated. An object must not be used from several threads at once.
+template<typename T0> class overlap_save
+  {
+  private:
+    size_t klen, nfft, blk;
+    shared_ptr<pocketfft_r<T0>> plan;
+    arr<T0> kspec, hist, buf, work;
+
+    // smallest cheap FFT length >= n that is not computed with Bluestein's
+    // algorithm, which would allocate for every transform
+    static size_t good_length(size_t n)
+      {
+      size_t res = util::good_size(n);
+      while (get_plan<pocketfft_r<T0>>(res)->uses_bluestein())
+        res = util::good_size(res+1);
+      return res;
+      }
+
+  public:
+    // block is the number of samples per FFT; if 0, the FFT length is
+    // chosen as about four times the kernel length
+    POCKETFFT_NOINLINE overlap_save(const T0 *kernel, size_t klen_,
+      size_t block=0)
+      : klen(klen_),
+        nfft(good_length((block==0) ? max<size_t>(4*klen_, 64)
+                                    : block+klen_-1)),
+        blk(nfft-klen_+1), plan(get_plan<pocketfft_r<T0>>(nfft)),
+        kspec(nfft), hist((klen_==0) ? 0 : klen_-1), buf(nfft), work(nfft)
+      {
+      if (klen==0) throw invalid_argument("empty filter kernel");
+      for (size_t i=0; i<klen; ++i)
+        kspec[i] = kernel[i];
+      for (size_t i=klen; i<nfft; ++i)
+        kspec[i] = T0(0);
+      plan->forward(kspec.data(), T0(1)/T0(nfft), work.data());
+      reset();
+      }
+
+    // forgets all samples passed so far
+    void reset()
+      {
+      for (size_t i=0; i<hist.size(); ++i)
+        hist[i] = T0(0);
+      }
+
+    // filters n samples; out receives n samples and may be equal to in
+    POCKETFFT_NOINLINE void filter(const T0 *in, T0 *out, size_t n)
+      {
+      size_t nh=klen-1;
+      while (n>0)
+        {
+        size_t m=min(n, blk);
+        for (size_t i=0; i<nh; ++i)
+          buf[i] = hist[i];
+        for (size_t i=0; i<m; ++i)
+          buf[nh+i] = in[i];
+        for (size_t i=nh+m; i<nfft; ++i)
+          buf[i] = T0(0);
+        for (size_t i=0; i<nh; ++i)
+          hist[i] = buf[m+i];
+        plan->forward(buf.data(), T0(1), work.data());
+        halfcomplex_mul(buf.data(), kspec.data(), nfft);
+        plan->backward(buf.data(), T0(1), work.data());
+        for (size_t i=0; i<m; ++i)
+          out[i] = buf[nh+i];
+        in+=m; out+=m; n-=m;
+        }
+      }
+
+    size_t kernel_length() const { return klen; }
+    size_t fft_length() const { return nfft; }
+    size_t block_length() const { return blk; }
+  };
 
 template<typename T> void c2c(const shape_t &shape, const stride_t &stride_in,
   const stride_t &stride_out, const shape_t &axes, bool forward,
@@ -2963,6 +4375,10 @@ template<typename T> void c2c(const shape_t &shape, const stride_t &stride_in,
   general_c(ain, aout, axes, forward, fct, nthreads);
   }
 
+// r2c and c2r can work in place, with data_in and data_out pointing to the
+// same memory, if the (last) transformed axis has unit real stride and room
+// for its complex values, i.e. 2*(n/2+1) real values along it (the padded
+// layout of FFTW's in-place real transforms), and all other strides agree.
 template<typename T> void r2c(const shape_t &shape_in,
   const stride_t &stride_in, const stride_t &stride_out, size_t axis,
   bool forward, const T *data_in, complex<T> *data_out, T fct,
@@ -3027,8 +4443,18 @@ template<typename T> void c2r(const shape_t &shape_out,
   for (int i=int(shape_in.size())-2; i>=0; --i)
     stride_inter[size_t(i)] =
       stride_inter[size_t(i+1)]*ptrdiff_t(shape_in[size_t(i+1)]);
-  arr<complex<T>> tmp(nval);
   auto newaxes = shape_t({axes.begin(), --axes.end()});
+  if (static_cast<const void *>(data_in)==data_out)
+    {
+    // in place: the other axes are transformed in the input array itself
+    auto data_c = reinterpret_cast<complex<T> *>(data_out);
+    c2c(shape_in, stride_in, stride_in, newaxes, forward, data_c, data_c,
+      T(1), nthreads);
+    c2r(shape_out, stride_in, stride_out, axes.back(), forward, data_c,
+      data_out, fct, nthreads);
+    return;
+    }
+  arr<complex<T>> tmp(nval);
   c2c(shape_in, stride_in, stride_inter, newaxes, forward, data_in, tmp.data(),
     T(1), nthreads);
   c2r(shape_out, stride_inter, stride_out, axes.back(), forward,
@@ -3058,6 +4484,138 @@ template<typename T> void r2r_separable_hartley(const shape_t &shape,
   general_hartley(ain, aout, axes, fct, nthreads);
   }
 
+// Linear convolution of the real arrays a and b along axes, computed with
+// FFTs of the lengths nfft (at least a.shape+b.shape-1 along each axis).
+// Along every transformed axis, out receives the window [start;
+// start+shape_out) of the full convolution. Along the other axes, a and b
+// have the length of out or, for broadcasting, a zero stride.
+template<typename T> void convolve(const shape_t &shape_a,
+  const stride_t &stride_a, const T *data_a, const shape_t &shape_b,
+  const stride_t &stride_b, const T *data_b, const shape_t &shape_out,
+  const stride_t &stride_out, T *data_out, const shape_t &axes,
+  const shape_t &nfft, const shape_t &start, size_t nthreads=1)
+  {
+  if (util::prod(shape_out)==0) return;
+  util::sanity_check(shape_out, stride_a, stride_out, false, axes);
+  util::sanity_check(shape_out, stride_b, stride_out, false, axes);
+  if ((shape_a.size()!=shape_out.size()) || (shape_b.size()!=shape_out.size())
+    || (nfft.size()!=axes.size()) || (start.size()!=axes.size()))
+    throw runtime_error("dimension mismatch");
+  shape_t spec(shape_out);
+  vector<bool> transformed(shape_out.size(), false);
+  for (size_t i=0; i<axes.size(); ++i)
+    {
+    auto ax=axes[i];
+    if ((shape_a[ax]==0) || (shape_b[ax]==0)
+      || (shape_a[ax]+shape_b[ax]-1>nfft[i])
+      || (start[i]+shape_out[ax]>nfft[i]))
+      throw invalid_argument("bad FFT length or output window");
+    spec[ax] = nfft[i];
+    transformed[ax] = true;
+    }
+  for (size_t d=0; d<shape_out.size(); ++d)
+    if ((!transformed[d]) && ((shape_a[d]!=shape_out[d])
+      || (shape_b[d]!=shape_out[d])))
+      throw invalid_argument("shape mismatch along a non-transformed axis");
+
+  cndarr<T> aa(data_a, shape_a, stride_a), ab(data_b, shape_b, stride_b);
+  ndarr<T> aout(data_out, shape_out, stride_out);
+  T fct(1);
+  for (auto n: nfft)
+    fct /= T(n);
+
+  if (axes.size()==1)
+    return general_convolve_1d(aa, ab, aout, axes[0], nfft[0], start[0], fct,
+      nthreads);
+
+  // spectra of a and b in a single buffer, with the last transformed axis
+  // halved
+  auto last=axes.back();
+  spec[last] = nfft.back()/2+1;
+  size_t nspec=util::prod(spec);
+  stride_t sspec(spec.size());
+  sspec.back() = sizeof(cmplx<T>);
+  for (int i=int(spec.size())-2; i>=0; --i)
+    sspec[size_t(i)] = sspec[size_t(i+1)]*ptrdiff_t(spec[size_t(i+1)]);
+  arr<cmplx<T>> buf(2*nspec);
+  for (size_t i=0; i<2*nspec; ++i)
+    buf[i].Set(T(0));
+  auto otheraxes = shape_t{axes.begin(), --axes.end()};
+
+  for (size_t k=0; k<2; ++k)
+    {
+    const auto &in(k==0 ? aa : ab);
+    auto sub(in.shape());
+    sub[last] = spec[last];
+    ndarr<cmplx<T>> dst(buf.data()+k*nspec, sub, sspec);
+    general_r2c_padded(in, dst, last, nfft.back(), nthreads);
+    ndarr<cmplx<T>> full(buf.data()+k*nspec, spec, sspec);
+    general_c(full, full, otheraxes, true, T(1), nthreads);
+    }
+
+  auto pa=buf.data(), pb=buf.data()+nspec;
+threading::thread_map(util::thread_count(nthreads, spec, last),
+  [&] {
+  size_t lo, hi;
+  thread_share(nspec, lo, hi);
+  for (size_t i=lo; i<hi; ++i)
+    pa[i] = pa[i]*pb[i];
+}); // end of parallel region
+
+  ndarr<cmplx<T>> full(pa, spec, sspec);
+  general_c(full, full, otheraxes, false, T(1), nthreads);
+  // the window of the output along the other transformed axes
+  auto win(shape_out);
+  win[last] = spec[last];
+  ptrdiff_t ofs=0;
+  for (size_t i=0; i+1<axes.size(); ++i)
+    ofs += ptrdiff_t(start[i])*sspec[axes[i]];
+  cndarr<cmplx<T>> awin(reinterpret_cast<const char *>(pa)+ofs, win, sspec);
+  general_c2r_cropped(awin, aout, last, nfft.back(), start.back(), fct,
+    nthreads);
+  }
+
+template<typename T> void dct(const shape_t &shape,
+  const stride_t &stride_in, const stride_t &stride_out, const shape_t &axes,
+  int type, const T *data_in, T *data_out, T fct, bool ortho,
+  size_t nthreads=1)
+  {
+  if ((type<1) || (type>4)) throw invalid_argument("invalid DCT type");
+  if (util::prod(shape)==0) return;
+  util::sanity_check(shape, stride_in, stride_out, data_in==data_out, axes);
+  cndarr<T> ain(data_in, shape, stride_in);
+  ndarr<T> aout(data_out, shape, stride_out);
+  if (type==1)
+    general_dcst<T_dct1<T>>(ain, aout, axes, fct, ortho, type, true, nthreads);
+  else if (type==4)
+    general_dcst<T_dcst4<T>>(ain, aout, axes, fct, ortho, type, true,
+      nthreads);
+  else
+    general_dcst<T_dcst23<T>>(ain, aout, axes, fct, ortho, type, true,
+      nthreads);
+  }
+
+template<typename T> void dst(const shape_t &shape,
+  const stride_t &stride_in, const stride_t &stride_out, const shape_t &axes,
+  int type, const T *data_in, T *data_out, T fct, bool ortho,
+  size_t nthreads=1)
+  {
+  if ((type<1) || (type>4)) throw invalid_argument("invalid DST type");
+  if (util::prod(shape)==0) return;
+  util::sanity_check(shape, stride_in, stride_out, data_in==data_out, axes);
+  cndarr<T> ain(data_in, shape, stride_in);
+  ndarr<T> aout(data_out, shape, stride_out);
+  if (type==1)
+    general_dcst<T_dst1<T>>(ain, aout, axes, fct, ortho, type, false,
+      nthreads);
+  else if (type==4)
+    general_dcst<T_dcst4<T>>(ain, aout, axes, fct, ortho, type, false,
+      nthreads);
+  else
+    general_dcst<T_dcst23<T>>(ain, aout, axes, fct, ortho, type, false,
+      nthreads);
+  }
+
 } // namespace detail
 
 using detail::FORWARD;
@@ -3069,6 +4627,12 @@ using detail::c2r;
 using detail::r2c;
 using detail::r2r_fftpack;
 using detail::r2r_separable_hartley;
+using detail::dct;
+using detail::dst;
+using detail::convolve;
+using detail::overlap_save;
+using detail::segment_spectra;
+using detail::spectra_mode;
 
 } // namespace pocketfft
 
@@ -102,10 +102,39 @@ template<typename T> T norm_fct(int inorm, const shape_t &shape,
   return norm_fct<T>(inorm, N);
   }
 
+// Normalization factor for a DCT/DST whose ortho scale is 1/sqrt(2*(N+delta))
+// along each transformed axis
+template<typename T> T norm_fct_dcst(int inorm, const shape_t &shape,
+  const shape_t &axes, int delta)
+  {
+  if (inorm==0) return T(1);
+  if (inorm!=1)
+    throw invalid_argument("invalid value for inorm (must be 0 or 1)");
+  ldbl_t N(1);
+  for (auto a: axes)
+    N *= 2*(ldbl_t(shape[a])+delta);
+  return T(1/sqrt(N));
+  }
+
+// Whether arr is stored in Fortran order, but not also in C order
+bool fortran_ordered(const py::array &arr)
+  {
+  return (arr.ndim()>1) && (arr.flags() & py::array::f_style)
+    && !(arr.flags() & py::array::c_style);
+  }
+
+// A new output array is allocated in Fortran order if the input `like` is
+// Fortran-ordered, so that Fortran data is read and written along the same
+// memory layout and needs no reordering copy afterwards.
 template<typename T> py::array_t<T> prepare_output(py::object &out_,
-  shape_t &dims)
+  shape_t &dims, const py::array &like)
   {
-  if (out_.is(None)) return py::array_t<T>(dims);
+  if (out_.is(None))
+    {
+    if (fortran_ordered(like))
+      return py::array_t<T>(py::array_t<T, py::array::f_style>(dims));
+    return py::array_t<T>(dims);
+    }
   auto tmp = out_.cast<py::array_t<T>>();
   if (!tmp.is(out_)) // a new object was created during casting
     throw runtime_error("unexpected data type for output array");
@@ -118,7 +147,7 @@ template<typename T> py::array c2c_internal(const py::array &in,
   {
   auto axes = makeaxes(in, axes_);
   auto dims(copy_shape(in));
-  auto res = prepare_output<complex<T>>(out_, dims);
+  auto res = prepare_output<complex<T>>(out_, dims, in);
   auto s_in=copy_strides(in);
   auto s_out=copy_strides(res);
   auto d_in=reinterpret_cast<const complex<T> *>(in.data());
@@ -137,7 +166,7 @@ template<typename T> py::array c2c_sym_internal(const py::array &in,
   {
   auto axes = makeaxes(in, axes_);
   auto dims(copy_shape(in));
-  auto res = prepare_output<complex<T>>(out_, dims);
+  auto res = prepare_output<complex<T>>(out_, dims, in);
   auto s_in=copy_strides(in);
   auto s_out=copy_strides(res);
   auto d_in=reinterpret_cast<const T *>(in.data());
@@ -178,7 +207,7 @@ template<typename T> py::array r2c_internal(const py::array &in,
   auto axes = makeaxes(in, axes_);
   auto dims_in(copy_shape(in)), dims_out(dims_in);
   dims_out[axes.back()] = (dims_out[axes.back()]>>1)+1;
-  py::array res = prepare_output<complex<T>>(out_, dims_out);
+  py::array res = prepare_output<complex<T>>(out_, dims_out, in);
   auto s_in=copy_strides(in);
   auto s_out=copy_strides(res);
   auto d_in=reinterpret_cast<const T *>(in.data());
@@ -205,7 +234,7 @@ template<typename T> py::array r2r_fftpack_internal(const py::array &in,
   {
   auto axes = makeaxes(in, axes_);
   auto dims(copy_shape(in));
-  py::array res = prepare_output<T>(out_, dims);
+  py::array res = prepare_output<T>(out_, dims, in);
   auto s_in=copy_strides(in);
   auto s_out=copy_strides(res);
   auto d_in=reinterpret_cast<const T *>(in.data());
@@ -238,7 +267,7 @@ template<typename T> py::array c2r_internal(const py::array &in,
   if ((lastsize/2) + 1 != dims_in[axis])
     throw runtime_error("bad lastsize");
   dims_out[axis] = lastsize;
-  py::array res = prepare_output<T>(out_, dims_out);
+  py::array res = prepare_output<T>(out_, dims_out, in);
   auto s_in=copy_strides(in);
   auto s_out=copy_strides(res);
   auto d_in=reinterpret_cast<const complex<T> *>(in.data());
@@ -259,11 +288,85 @@ py::array c2r(const py::array &in, const py::object &axes_, size_t lastsize,
     inorm, out_, nthreads))
   }
 
+// In-place r2c: along the last transformed axis, a holds 2*(n/2+1) real
+// values, the first n of which are the input. The result is a complex view
+// of the memory of a.
+template<typename T> py::array r2c_inplace_internal(py::array &a, size_t n,
+  const py::object &axes_, bool forward, int inorm, size_t nthreads)
+  {
+  auto axes = makeaxes(a, axes_);
+  size_t axis = axes.back();
+  auto dims_in(copy_shape(a)), dims_out(dims_in);
+  auto s_in=copy_strides(a), s_out(s_in);
+  if ((n==0) || (dims_in[axis]!=2*(n/2+1)))
+    throw invalid_argument("axis length must be 2*(n//2+1)");
+  if (s_in[axis]!=ptrdiff_t(sizeof(T)))
+    throw invalid_argument("the last transformed axis must be contiguous");
+  if (!a.writeable())
+    throw invalid_argument("array is not writeable");
+  dims_in[axis] = n;
+  dims_out[axis] = n/2+1;
+  s_out[axis] = ptrdiff_t(sizeof(complex<T>));
+  auto data=reinterpret_cast<T *>(a.mutable_data());
+  if (pocketfft::detail::util::prod(dims_in)!=0)
+    {
+    py::gil_scoped_release release;
+    T fct = norm_fct<T>(inorm, dims_in, axes);
+    pocketfft::r2c(dims_in, s_in, s_out, axes, forward, data,
+      reinterpret_cast<complex<T> *>(data), fct, nthreads);
+    }
+  return py::array(py::dtype::of<complex<T>>(), dims_out, s_out, data, a);
+  }
+
+py::array r2c_inplace(py::array &a, size_t n, const py::object &axes_,
+  bool forward, int inorm, size_t nthreads)
+  {
+  DISPATCH(a, f64, f32, flong, r2c_inplace_internal, (a, n, axes_, forward,
+    inorm, nthreads))
+  }
+
+// In-place c2r, the inverse of r2c_inplace. The result is a real view of
+// the memory of a of length lastsize along the last transformed axis.
+template<typename T> py::array c2r_inplace_internal(py::array &a,
+  const py::object &axes_, size_t lastsize, bool forward, int inorm,
+  size_t nthreads)
+  {
+  auto axes = makeaxes(a, axes_);
+  size_t axis = axes.back();
+  auto dims_in(copy_shape(a)), dims_out(dims_in);
+  auto s_in=copy_strides(a), s_out(s_in);
+  if (lastsize==0) lastsize=2*dims_in[axis]-1;
+  if ((lastsize/2) + 1 != dims_in[axis])
+    throw invalid_argument("bad lastsize");
+  if (s_in[axis]!=ptrdiff_t(sizeof(complex<T>)))
+    throw invalid_argument("the last transformed axis must be contiguous");
+  if (!a.writeable())
+    throw invalid_argument("array is not writeable");
+  dims_out[axis] = lastsize;
+  s_out[axis] = ptrdiff_t(sizeof(T));
+  auto data=reinterpret_cast<complex<T> *>(a.mutable_data());
+  if (pocketfft::detail::util::prod(dims_out)!=0)
+    {
+    py::gil_scoped_release release;
+    T fct = norm_fct<T>(inorm, dims_out, axes);
+    pocketfft::c2r(dims_out, s_in, s_out, axes, forward, data,
+      reinterpret_cast<T *>(data), fct, nthreads);
+    }
+  return py::array(py::dtype::of<T>(), dims_out, s_out, data, a);
+  }
+
+py::array c2r_inplace(py::array &a, const py::object &axes_, size_t lastsize,
+  bool forward, int inorm, size_t nthreads)
+  {
+  DISPATCH(a, c128, c64, clong, c2r_inplace_internal, (a, axes_, lastsize,
+    forward, inorm, nthreads))
+  }
+
 template<typename T> py::array separable_hartley_internal(const py::array &in,
   const py::object &axes_, int inorm, py::object &out_, size_t nthreads)
   {
   auto dims(copy_shape(in));
-  py::array res = prepare_output<T>(out_, dims);
+  py::array res = prepare_output<T>(out_, dims, in);
   auto axes = makeaxes(in, axes_);
   auto s_in=copy_strides(in);
   auto s_out=copy_strides(res);
@@ -290,7 +393,7 @@ template<typename T>py::array complex2hartley(const py::array &in,
   {
   using namespace pocketfft::detail;
   auto dims_out(copy_shape(in));
-  py::array out = prepare_output<T>(out_, dims_out);
+  py::array out = prepare_output<T>(out_, dims_out, in);
   cndarr<cmplx<T>> atmp(tmp.data(), copy_shape(tmp), copy_strides(tmp));
   ndarr<T> aout(out.mutable_data(), copy_shape(out), copy_strides(out));
   auto axes = makeaxes(in, axes_);
@@ -317,7 +420,435 @@ py::array genuine_hartley(const py::array &in, const py::object &axes_,
   DISPATCH(in, f64, f32, flong, complex2hartley, (in, tmp, axes_, out_))
   }
 
-const char *pypocketfft_DS = R"""(Fast Fourier and Hartley transforms.
+template<typename T> py::array dcst_internal(const py::array &in,
+  const py::object &axes_, int type, bool cosine, int inorm, py::object &out_,
+  size_t nthreads)
+  {
+  auto axes = makeaxes(in, axes_);
+  auto dims(copy_shape(in));
+  py::array res = prepare_output<T>(out_, dims, in);
+  auto s_in=copy_strides(in);
+  auto s_out=copy_strides(res);
+  auto d_in=reinterpret_cast<const T *>(in.data());
+  auto d_out=reinterpret_cast<T *>(res.mutable_data());
+  {
+  py::gil_scoped_release release;
+  int delta = (type!=1) ? 0 : (cosine ? -1 : 1);
+  T fct = norm_fct_dcst<T>(inorm, dims, axes, delta);
+  cosine ?
+    pocketfft::dct(dims, s_in, s_out, axes, type, d_in, d_out, fct, inorm==1,
+      nthreads) :
+    pocketfft::dst(dims, s_in, s_out, axes, type, d_in, d_out, fct, inorm==1,
+      nthreads);
+  }
+  return res;
+  }
+
+py::array dct(const py::array &in, int type, const py::object &axes_,
+  int inorm, py::object &out_, size_t nthreads)
+  {
+  DISPATCH(in, f64, f32, flong, dcst_internal, (in, axes_, type, true, inorm,
+    out_, nthreads))
+  }
+
+py::array dst(const py::array &in, int type, const py::object &axes_,
+  int inorm, py::object &out_, size_t nthreads)
+  {
+  DISPATCH(in, f64, f32, flong, dcst_internal, (in, axes_, type, false, inorm,
+    out_, nthreads))
+  }
+
+// Linear convolution (or correlation) of two real arrays along `axes`.
+// Along the other axes the arrays are broadcast against each other.
+template<typename T> py::array convolve_internal(const py::array &a,
+  const py::array &b, const py::object &axes_, const string &mode,
+  bool correlate, size_t nthreads)
+  {
+  if (!b.dtype().is(a.dtype()))
+    throw invalid_argument("arrays must have the same data type");
+  if (a.ndim()!=b.ndim())
+    throw invalid_argument("arrays must have the same number of dimensions");
+  if ((mode!="full") && (mode!="same") && (mode!="valid"))
+    throw invalid_argument("mode must be 'full', 'same' or 'valid'");
+  auto axes = makeaxes(a, axes_);
+  auto dims_a(copy_shape(a)), dims_b(copy_shape(b)), dims_out(dims_a);
+  auto s_a=copy_strides(a), s_b=copy_strides(b);
+  auto d_a=reinterpret_cast<const char *>(a.data());
+  auto d_b=reinterpret_cast<const char *>(b.data());
+  vector<bool> transformed(dims_a.size(), false);
+  shape_t nfft, start;
+  for (auto ax: axes)
+    {
+    if (transformed[ax])
+      throw invalid_argument("repeated axis");
+    transformed[ax] = true;
+    size_t na=dims_a[ax], nb=dims_b[ax];
+    if ((na==0) || (nb==0))
+      throw invalid_argument("empty array along a convolution axis");
+    size_t full = na+nb-1;
+    if (mode=="full")
+      { dims_out[ax]=full; start.push_back(0); }
+    else if (mode=="same")
+      { dims_out[ax]=na; start.push_back((full-na)/2); }
+    else
+      { dims_out[ax]=max(na,nb)-min(na,nb)+1; start.push_back(min(na,nb)-1); }
+    nfft.push_back(pocketfft::detail::util::good_size(full));
+    if (correlate) // walk b backwards along this axis
+      {
+      d_b += ptrdiff_t(nb-1)*s_b[ax];
+      s_b[ax] = -s_b[ax];
+      }
+    }
+  for (size_t d=0; d<dims_a.size(); ++d)
+    {
+    if (transformed[d] || (dims_a[d]==dims_b[d])) continue;
+    if (dims_a[d]==1)
+      { dims_a[d]=dims_out[d]=dims_b[d]; s_a[d]=0; }
+    else if (dims_b[d]==1)
+      { dims_b[d]=dims_a[d]; s_b[d]=0; }
+    else
+      throw invalid_argument("array shapes cannot be broadcast together");
+    }
+  py::array res = py::array_t<T>(dims_out);
+  auto s_out=copy_strides(res);
+  auto d_out=reinterpret_cast<T *>(res.mutable_data());
+  {
+  py::gil_scoped_release release;
+  pocketfft::convolve(dims_a, s_a, reinterpret_cast<const T *>(d_a), dims_b,
+    s_b, reinterpret_cast<const T *>(d_b), dims_out, s_out, d_out, axes, nfft,
+    start, nthreads);
+  }
+  return res;
+  }
+
+py::array convolve(const py::array &a, const py::array &b,
+  const py::object &axes_, const string &mode, size_t nthreads)
+  {
+  DISPATCH(a, f64, f32, flong, convolve_internal, (a, b, axes_, mode, false,
+    nthreads))
+  }
+
+py::array correlate(const py::array &a, const py::array &b,
+  const py::object &axes_, const string &mode, size_t nthreads)
+  {
+  DISPATCH(a, f64, f32, flong, convolve_internal, (a, b, axes_, mode, true,
+    nthreads))
+  }
+
+// Windowed spectra of the segments along the last axis of a real array,
+// computed in double precision
+template<typename Tin> py::array segment_spectra_internal(const py::array &a,
+  const py::array &window, size_t step, size_t nfft, int detrend,
+  const string &mode, double fct, size_t nthreads)
+  {
+  using pocketfft::detail::cmplx;
+  pocketfft::spectra_mode smode;
+  if (mode=="spectra") smode = pocketfft::detail::SPECTRA;
+  else if (mode=="power") smode = pocketfft::detail::POWER;
+  else if (mode=="power_sum") smode = pocketfft::detail::POWER_SUM;
+  else
+    throw invalid_argument("mode must be 'spectra', 'power' or 'power_sum'");
+  if ((detrend<0) || (detrend>2))
+    throw invalid_argument("detrend must be 0, 1 or 2");
+  auto win = window.cast<py::array_t<double, py::array::c_style |
+    py::array::forcecast>>();
+  if (win.ndim()!=1)
+    throw invalid_argument("window must be one-dimensional");
+  if (a.ndim()<1)
+    throw invalid_argument("input must have at least one dimension");
+  auto dims(copy_shape(a));
+  auto s_a(copy_strides(a));
+  size_t ndim=dims.size(), len=dims[ndim-1], nperseg=size_t(win.shape(0));
+  if ((nperseg==0) || (nperseg>len))
+    throw invalid_argument("window must not be empty or longer than the input");
+  if (nfft<nperseg)
+    throw invalid_argument("nfft must not be less than the window length");
+  if (step==0)
+    throw invalid_argument("step must be positive");
+  for (auto &s: s_a)
+    {
+    if (s%ptrdiff_t(sizeof(Tin))!=0)
+      throw invalid_argument("input is not aligned");
+    s /= ptrdiff_t(sizeof(Tin));
+    }
+  size_t nseg=(len-nperseg)/step+1, nfreq=nfft/2+1;
+  // offsets of the lines along the last axis
+  vector<ptrdiff_t> ofs(1, 0);
+  for (size_t d=0; d+1<ndim; ++d)
+    {
+    vector<ptrdiff_t> tmp;
+    tmp.reserve(ofs.size()*dims[d]);
+    for (auto o: ofs)
+      for (size_t i=0; i<dims[d]; ++i)
+        tmp.push_back(o+ptrdiff_t(i)*s_a[d]);
+    ofs.swap(tmp);
+    }
+  shape_t dims_out(dims.begin(), dims.end()-1);
+  if (smode!=pocketfft::detail::POWER_SUM)
+    dims_out.push_back(nseg);
+  dims_out.push_back(nfreq);
+  py::array res;
+  cmplx<double> *spec=nullptr;
+  double *pow=nullptr;
+  if (smode==pocketfft::detail::SPECTRA)
+    {
+    res = py::array_t<complex<double>>(dims_out);
+    spec = reinterpret_cast<cmplx<double> *>(res.mutable_data());
+    }
+  else
+    {
+    res = py::array_t<double>(dims_out);
+    pow = reinterpret_cast<double *>(res.mutable_data());
+    }
+  auto d_a = reinterpret_cast<const Tin *>(a.data());
+  auto d_win = win.data();
+  {
+  py::gil_scoped_release release;
+  pocketfft::segment_spectra<Tin, double>(d_a, ofs, s_a[ndim-1], nseg, step,
+    d_win, nperseg, nfft, detrend, smode, fct, spec, pow, nthreads);
+  }
+  return res;
+  }
+
+py::array segment_spectra(const py::array &a, const py::array &window,
+  size_t step, size_t nfft, int detrend, const string &mode, double fct,
+  size_t nthreads)
+  {
+  auto dtype = a.dtype();
+  if (dtype.is(f64))
+    return segment_spectra_internal<double>(a, window, step, nfft, detrend,
+      mode, fct, nthreads);
+  if (dtype.is(f32))
+    return segment_spectra_internal<float>(a, window, step, nfft, detrend,
+      mode, fct, nthreads);
+  throw runtime_error("unsupported data type");
+  }
+
+// A reusable transform of one length and precision along a single axis.
+// Executing it skips the global plan cache and reuses the temporary
+// storage of earlier calls; executions of the same plan are serialized.
+class fft_plan
+  {
+  private:
+    string kind_;
+    size_t length_;
+    py::dtype dtype_;
+    shared_ptr<void> plan_;
+    pocketfft::detail::thread_scratch scratch_;
+    mutex mut_;
+
+    template<typename T> void make_plan()
+      {
+      using namespace pocketfft::detail;
+      if (kind_=="c2c")
+        plan_ = make_shared<pocketfft_c<T>>(length_);
+      else
+        plan_ = make_shared<pocketfft_r<T>>(length_);
+      }
+
+    template<typename T> py::array exec_c2c(const py::array &in,
+      size_t axis, bool forward, int inorm, py::object &out_, size_t nthreads)
+      {
+      using namespace pocketfft::detail;
+      auto dims(copy_shape(in));
+      auto res = prepare_output<complex<T>>(out_, dims, in);
+      auto s_in=copy_strides(in);
+      auto s_out=copy_strides(res);
+      if (util::prod(dims)==0) return res;
+      {
+      py::gil_scoped_release release;
+      lock_guard<mutex> lock(mut_);
+      util::sanity_check(dims, s_in, s_out, in.data()==res.data(), axis);
+      cndarr<cmplx<T>> ain(in.data(), dims, s_in);
+      ndarr<cmplx<T>> aout(res.mutable_data(), dims, s_out);
+      general_c(ain, aout, {axis}, forward, norm_fct<T>(inorm, length_),
+        nthreads, static_cast<pocketfft_c<T> *>(plan_.get()), &scratch_);
+      }
+      return res;
+      }
+
+    template<typename T> py::array exec_r2c(const py::array &in,
+      size_t axis, bool forward, int inorm, py::object &out_, size_t nthreads)
+      {
+      using namespace pocketfft::detail;
+      auto dims_in(copy_shape(in)), dims_out(dims_in);
+      dims_out[axis] = (dims_out[axis]>>1)+1;
+      py::array res = prepare_output<complex<T>>(out_, dims_out, in);
+      auto s_in=copy_strides(in);
+      auto s_out=copy_strides(res);
+      if (util::prod(dims_in)==0) return res;
+      {
+      py::gil_scoped_release release;
+      lock_guard<mutex> lock(mut_);
+      util::sanity_check(dims_in, s_in, s_out, false, axis);
+      cndarr<T> ain(in.data(), dims_in, s_in);
+      ndarr<cmplx<T>> aout(res.mutable_data(), dims_out, s_out);
+      general_r2c(ain, aout, axis, forward, norm_fct<T>(inorm, length_),
+        nthreads, static_cast<pocketfft_r<T> *>(plan_.get()), &scratch_);
+      }
+      return res;
+      }
+
+    template<typename T> py::array exec_c2r(const py::array &in,
+      size_t axis, bool forward, int inorm, py::object &out_, size_t nthreads)
+      {
+      using namespace pocketfft::detail;
+      auto dims_in(copy_shape(in)), dims_out(dims_in);
+      if ((length_/2)+1 != dims_in[axis])
+        throw invalid_argument("axis length does not match the plan");
+      dims_out[axis] = length_;
+      py::array res = prepare_output<T>(out_, dims_out, in);
+      auto s_in=copy_strides(in);
+      auto s_out=copy_strides(res);
+      if (util::prod(dims_out)==0) return res;
+      {
+      py::gil_scoped_release release;
+      lock_guard<mutex> lock(mut_);
+      util::sanity_check(dims_out, s_in, s_out, false, axis);
+      cndarr<cmplx<T>> ain(in.data(), dims_in, s_in);
+      ndarr<T> aout(res.mutable_data(), dims_out, s_out);
+      general_c2r(ain, aout, axis, forward, norm_fct<T>(inorm, length_),
+        nthreads, static_cast<pocketfft_r<T> *>(plan_.get()), &scratch_);
+      }
+      return res;
+      }
+
+    template<typename T> py::array exec_internal(const py::array &in,
+      size_t axis, bool forward, int inorm, py::object &out_, size_t nthreads)
+      {
+      if (kind_=="c2c")
+        return exec_c2c<T>(in, axis, forward, inorm, out_, nthreads);
+      if (kind_=="r2c")
+        return exec_r2c<T>(in, axis, forward, inorm, out_, nthreads);
+      return exec_c2r<T>(in, axis, forward, inorm, out_, nthreads);
+      }
+
+  public:
+    fft_plan(const string &kind, size_t length, const py::object &dtype)
+      : kind_(kind), length_(length), dtype_(py::dtype::from_args(dtype))
+      {
+      if ((kind_!="c2c") && (kind_!="r2c") && (kind_!="c2r"))
+        throw invalid_argument("kind must be 'c2c', 'r2c' or 'c2r'");
+      if (length_==0)
+        throw invalid_argument("zero-length FFT requested");
+      // r2c plans take real input, c2c and c2r plans complex input
+      bool cplx = kind_!="r2c";
+      if (dtype_.is(cplx ? c128 : f64))
+        make_plan<double>();
+      else if (dtype_.is(cplx ? c64 : f32))
+        make_plan<float>();
+      else if (dtype_.is(cplx ? clong : flong))
+        make_plan<ldbl_t>();
+      else
+        throw invalid_argument("unsupported data type for this kind of plan");
+      }
+
+    py::array execute(const py::array &in, ptrdiff_t axis_, bool forward,
+      int inorm, py::object &out_, size_t nthreads)
+      {
+      if (!in.dtype().is(dtype_))
+        throw invalid_argument("input data type does not match the plan");
+      auto axis = makeaxes(in, py::make_tuple(axis_))[0];
+      bool cplx = kind_!="r2c";
+      if (dtype_.is(cplx ? c128 : f64))
+        return exec_internal<double>(in, axis, forward, inorm, out_, nthreads);
+      if (dtype_.is(cplx ? c64 : f32))
+        return exec_internal<float>(in, axis, forward, inorm, out_, nthreads);
+      return exec_internal<ldbl_t>(in, axis, forward, inorm, out_, nthreads);
+      }
+
+    const string &kind() const { return kind_; }
+    size_t length() const { return length_; }
+    const py::dtype &dtype() const { return dtype_; }
+  };
+
+// A streaming FIR filter over blocks of a 1D signal.
+class fir_filter
+  {
+  private:
+    py::dtype dtype_;
+    shared_ptr<void> filter_;
+    size_t klen_, nfft_, blk_;
+    mutex mut_;
+
+    template<typename T> void make_filter(const py::array &kernel,
+      size_t block)
+      {
+      auto k = kernel.cast<py::array_t<T, py::array::c_style>>();
+      auto f = make_shared<pocketfft::overlap_save<T>>(k.data(),
+        size_t(k.shape(0)), block);
+      klen_ = f->kernel_length();
+      nfft_ = f->fft_length();
+      blk_ = f->block_length();
+      filter_ = f;
+      }
+
+    template<typename T> py::array filter_internal(const py::array &in,
+      py::object &out_)
+      {
+      auto x = in.cast<py::array_t<T, py::array::c_style>>();
+      shape_t dims(copy_shape(x));
+      auto res = prepare_output<T>(out_, dims, in);
+      if ((res.ndim()!=1) || (size_t(res.shape(0))!=dims[0]))
+        throw invalid_argument("output array has the wrong shape");
+      if ((dims[0]>1) && (res.strides(0)!=ptrdiff_t(sizeof(T))))
+        throw invalid_argument("output array must be contiguous");
+      auto d_in=x.data();
+      auto d_out=res.mutable_data();
+      {
+      py::gil_scoped_release release;
+      lock_guard<mutex> lock(mut_);
+      static_cast<pocketfft::overlap_save<T> *>(filter_.get())->filter(
+        d_in, d_out, dims[0]);
+      }
+      return res;
+      }
+
+    template<typename T> void reset_internal()
+      { static_cast<pocketfft::overlap_save<T> *>(filter_.get())->reset(); }
+
+  public:
+    fir_filter(const py::array &kernel, size_t block)
+      : dtype_(kernel.dtype())
+      {
+      if (kernel.ndim()!=1)
+        throw invalid_argument("kernel must be one-dimensional");
+      if (dtype_.is(f64))
+        make_filter<double>(kernel, block);
+      else if (dtype_.is(f32))
+        make_filter<float>(kernel, block);
+      else if (dtype_.is(flong))
+        make_filter<ldbl_t>(kernel, block);
+      else
+        throw invalid_argument("unsupported data type");
+      }
+
+    py::array filter(const py::array &in, py::object &out_)
+      {
+      if (!in.dtype().is(dtype_))
+        throw invalid_argument("input data type does not match the kernel");
+      if (in.ndim()!=1)
+        throw invalid_argument("input must be one-dimensional");
+      if (dtype_.is(f64)) return filter_internal<double>(in, out_);
+      if (dtype_.is(f32)) return filter_internal<float>(in, out_);
+      return filter_internal<ldbl_t>(in, out_);
+      }
+
+    void reset()
+      {
+      lock_guard<mutex> lock(mut_);
+      if (dtype_.is(f64)) reset_internal<double>();
+      else if (dtype_.is(f32)) reset_internal<float>();
+      else reset_internal<ldbl_t>();
+      }
+
+    size_t kernel_length() const { return klen_; }
+    size_t fft_length() const { return nfft_; }
+    size_t block_length() const { return blk_; }
+    const py::dtype &dtype() const { return dtype_; }
+  };
+
+const char *pypocketfft_DS = R"""(Fast Fourier, trigonometric and Hartley transforms.
 
 This module supports
 - single, double, and long double precision
@@ -351,8 +882,7 @@ out : numpy.ndarray (same shape as `a`, complex type with same accuracy as `a`)
     May be identical to `a`, but if it isn't, it must not overlap with `a`.
     If None, a new array is allocated to store the output.
 nthreads : int
-    Number of threads to use. If 0, use the system default (typically governed
-    by the `OMP_NUM_THREADS` environment variable).
+    Number of threads to use. If 0, use the number of hardware threads.
 
 Returns
 -------
@@ -382,8 +912,7 @@ out : numpy.ndarray (complex type with same accuracy as `a`)
     Must not overlap with `a`.
     If None, a new array is allocated to store the output.
 nthreads : int
-    Number of threads to use. If 0, use the system default (typically governed
-    by the `OMP_NUM_THREADS` environment variable).
+    Number of threads to use. If 0, use the number of hardware threads.
 
 Returns
 -------
@@ -417,8 +946,7 @@ out : numpy.ndarray (real type with same accuracy as `a`)
     Must not overlap with `a`.
     If None, a new array is allocated to store the output.
 nthreads : int
-    Number of threads to use. If 0, use the system default (typically governed
-    by the `OMP_NUM_THREADS` environment variable).
+    Number of threads to use. If 0, use the number of hardware threads.
 
 Returns
 -------
@@ -428,6 +956,73 @@ numpy.ndarray (real type with same accuracy as `a`)
     entries.
 )""";
 
+const char *r2c_inplace_DS = R"""(Performs an FFT of real input in place.
+
+The input uses the padded layout of FFTW's in-place real transforms. Along
+the last transformed axis, `a` holds ``2*(n//2+1)`` real values, of which
+the first `n` are the data and the rest is padding. The ``n//2+1`` complex
+results overwrite `a`.
+
+Parameters
+----------
+a : numpy.ndarray (any real type, writeable)
+    The input data. It is contiguous along the last transformed axis and
+    has length ``2*(n//2+1)`` there.
+n : int
+    The length of the data along the last transformed axis.
+axes : list of integers
+    The axes along which the FFT is carried out.
+    If not set, all axes will be transformed.
+forward : bool
+    If `True`, a negative sign is used in the exponent, else a positive one.
+inorm : int
+    Normalization type
+      0 : no normalization
+      1 : divide by sqrt(N)
+      2 : divide by N
+    where N is the product of the lengths of the transformed input axes.
+nthreads : int
+    Number of threads to use. If 0, use the number of hardware threads.
+
+Returns
+-------
+numpy.ndarray (the complex type matching the type of `a`)
+    A view of the memory of `a` holding the result. Its shape is that of
+    `a`, but with ``n//2+1`` along the last transformed axis.
+)""";
+
+const char *c2r_inplace_DS = R"""(Performs an FFT with real output in place.
+
+This is the inverse of `r2c_inplace` and writes the real results over the
+complex input.
+
+Parameters
+----------
+a : numpy.ndarray (any complex type, writeable)
+    The input data. It is contiguous along the last transformed axis.
+axes : list of integers
+    The axes along which the FFT is carried out.
+    If not set, all axes will be transformed.
+lastsize : the output size of the last axis to be transformed.
+    If the corresponding input axis has size n, this can be 2*n-2 or 2*n-1.
+forward : bool
+    If `True`, a negative sign is used in the exponent, else a positive one.
+inorm : int
+    Normalization type
+      0 : no normalization
+      1 : divide by sqrt(N)
+      2 : divide by N
+    where N is the product of the lengths of the transformed output axes.
+nthreads : int
+    Number of threads to use. If 0, use the number of hardware threads.
+
+Returns
+-------
+numpy.ndarray (the real type matching the type of `a`)
+    A view of the memory of `a` holding the result. Its shape is that of
+    `a`, but with `lastsize` along the last transformed axis.
+)""";
+
 const char *r2r_fftpack_DS = R"""(Performs a real-valued FFT using the FFTPACK storage scheme.
 
 Parameters
@@ -453,8 +1048,7 @@ out : numpy.ndarray (same shape and data type as `a`)
     May be identical to `a`, but if it isn't, it must not overlap with `a`.
     If None, a new array is allocated to store the output.
 nthreads : int
-    Number of threads to use. If 0, use the system default (typically governed
-    by the `OMP_NUM_THREADS` environment variable).
+    Number of threads to use. If 0, use the number of hardware threads.
 
 Returns
 -------
@@ -484,8 +1078,7 @@ out : numpy.ndarray (same shape and data type as `a`)
     May be identical to `a`, but if it isn't, it must not overlap with `a`.
     If None, a new array is allocated to store the output.
 nthreads : int
-    Number of threads to use. If 0, use the system default (typically governed
-    by the `OMP_NUM_THREADS` environment variable).
+    Number of threads to use. If 0, use the number of hardware threads.
 
 Returns
 -------
@@ -516,8 +1109,63 @@ out : numpy.ndarray (same shape and data type as `a`)
     May be identical to `a`, but if it isn't, it must not overlap with `a`.
     If None, a new array is allocated to store the output.
 nthreads : int
-    Number of threads to use. If 0, use the system default (typically governed
-    by the `OMP_NUM_THREADS` environment variable).
+    Number of threads to use. If 0, use the number of hardware threads.
+
+Returns
+-------
+numpy.ndarray (same shape and data type as `a`)
+    The transformed data
+)""";
+
+const char *dct_DS = R"""(Performs a discrete cosine transform.
+
+Parameters
+----------
+a : numpy.ndarray (any real type)
+    The input data
+type : integer
+    the type of DCT. Must be in [1; 4].
+axes : list of integers
+    The axes along which the transform is carried out.
+    If not set, all axes will be transformed.
+inorm : int
+    Normalization type
+      0 : no normalization
+      1 : orthonormal scaling, as ``scipy.fftpack.dct`` uses
+          for ``norm='ortho'``
+out : numpy.ndarray (same shape and data type as `a`)
+    May be identical to `a`, but if it isn't, it must not overlap with `a`.
+    If None, a new array is allocated to store the output.
+nthreads : int
+    Number of threads to use. If 0, use the number of hardware threads.
+
+Returns
+-------
+numpy.ndarray (same shape and data type as `a`)
+    The transformed data
+)""";
+
+const char *dst_DS = R"""(Performs a discrete sine transform.
+
+Parameters
+----------
+a : numpy.ndarray (any real type)
+    The input data
+type : integer
+    the type of DST. Must be in [1; 4].
+axes : list of integers
+    The axes along which the transform is carried out.
+    If not set, all axes will be transformed.
+inorm : int
+    Normalization type
+      0 : no normalization
+      1 : orthonormal scaling, as ``scipy.fftpack.dst`` uses
+          for ``norm='ortho'``
+out : numpy.ndarray (same shape and data type as `a`)
+    May be identical to `a`, but if it isn't, it must not overlap with `a`.
+    If None, a new array is allocated to store the output.
+nthreads : int
+    Number of threads to use. If 0, use the number of hardware threads.
 
 Returns
 -------
@@ -525,23 +1173,274 @@ numpy.ndarray (same shape and data type as `a`)
     The transformed data
 )""";
 
+const char *convolve_DS = R"""(Computes the linear convolution of two real arrays.
+
+Both arrays are zero-padded to a fast FFT length along the requested axes,
+multiplied in the frequency domain and transformed back; only the requested
+part of the result is written. Along the other axes, the arrays are broadcast
+against each other.
+
+Parameters
+----------
+a, b : numpy.ndarray (any real type, both of the same type)
+    The input data, with the same number of dimensions.
+axes : list of integers
+    The axes along which the convolution is carried out.
+    If not set, all axes are used.
+mode : str
+    'full' returns the full convolution, of length ``na+nb-1``;
+    'same' returns its central ``na`` elements, centered as
+    ``scipy.signal.fftconvolve`` does; 'valid' returns the
+    ``abs(na-nb)+1`` elements that do not depend on the zero padding.
+nthreads : int
+    Number of threads to use. If 0, use the number of hardware threads.
+
+Returns
+-------
+numpy.ndarray (same data type as `a`)
+    The convolution
+)""";
+
+const char *correlate_DS = R"""(Computes the linear cross-correlation of two real arrays.
+
+This is `convolve` with `b` reversed along the requested axes, i.e.
+``out[k] = sum_n a[n+k-(nb-1)]*b[n]`` for mode 'full'.
+
+Parameters
+----------
+a, b : numpy.ndarray (any real type, both of the same type)
+    The input data, with the same number of dimensions.
+axes : list of integers
+    The axes along which the correlation is carried out.
+    If not set, all axes are used.
+mode : str
+    'full', 'same' or 'valid'; see `convolve`.
+nthreads : int
+    Number of threads to use. If 0, use the number of hardware threads.
+
+Returns
+-------
+numpy.ndarray (same data type as `a`)
+    The cross-correlation
+)""";
+
+const char *segment_spectra_DS = R"""(Computes windowed spectra of overlapping segments.
+
+The segments are taken along the last axis of `a`: segment ``s`` holds the
+``len(window)`` samples starting at ``s*step``, and only complete segments
+are used. Each is detrended, multiplied by `window`, zero-padded to `nfft`
+and transformed by an r2c FFT, all in one buffer per thread and in double
+precision, so no segment array is built.
+
+Parameters
+----------
+a : numpy.ndarray (float32 or float64)
+    The input data.
+window : numpy.ndarray (1D, real)
+    The window, whose length is the segment length.
+step : int
+    The distance between the starts of consecutive segments.
+nfft : int
+    The FFT length, at least the segment length.
+detrend : int
+    0 to leave the segments as they are, 1 to remove their mean, 2 to remove
+    their least-squares line.
+mode : str
+    'spectra' for the spectra times `fct`, 'power' for their squared
+    magnitudes times `fct` (doubled at the bins that stand for both a
+    positive and a negative frequency), 'power_sum' for the sum of 'power'
+    over the segments.
+fct : float
+    The scale factor.
+nthreads : int
+    Number of threads to use. If 0, use the number of hardware threads.
+
+Returns
+-------
+numpy.ndarray (complex128 for 'spectra', else float64)
+    The shape of `a` with the last axis replaced by ``(nseg, nfft//2+1)``,
+    or ``nfft//2+1`` for 'power_sum'.
+)""";
+
+const char *fir_filter_DS = R"""(A streaming FIR filter using FFT overlap-save.
+
+The spectrum of the kernel is computed once. Each call to `filter` continues
+the causal convolution ``y[n] = sum_k kernel[k]*x[n-k]`` of all samples
+passed so far, so a long or unbounded signal can be filtered in blocks of any
+size. Apart from the output array, which can be passed as `out`, filtering
+allocates no memory.
+
+Parameters
+----------
+kernel : numpy.ndarray (1D, any real type)
+    The filter coefficients. Their data type is that of the filtered data.
+block : int
+    The number of new samples processed by one FFT. If 0, the FFT length is
+    chosen as about four times the kernel length.
+)""";
+
+const char *fir_filter_filter_DS = R"""(Filters the next block of the signal.
+
+Parameters
+----------
+a : numpy.ndarray (1D, of the kernel's data type)
+    The next samples of the signal.
+out : numpy.ndarray (1D, same shape and data type as `a`)
+    Contiguous storage for the result. May be identical to `a`.
+    If None, a new array is allocated to store the output.
+
+Returns
+-------
+numpy.ndarray (same shape and data type as `a`)
+    The filtered samples, one per input sample.
+)""";
+
+const char *plan_DS = R"""(A reusable 1D FFT of fixed length and data type.
+
+The transform is precomputed once, and executing it on many arrays reuses it
+and its temporary storage without consulting the global plan cache.
+Executions of the same plan from several threads are serialized; use one plan
+per thread for concurrent transforms.
+
+Parameters
+----------
+kind : str
+    'c2c' for a complex FFT, 'r2c' for an FFT of real input and 'c2r' for an
+    FFT with real output.
+length : int
+    The length of the transformed axis; for 'c2r' the length of the output,
+    which has ``length//2+1`` complex input values.
+dtype : numpy.dtype
+    The data type of the input: a complex type for 'c2c' and 'c2r', a real
+    type for 'r2c'.
+)""";
+
+const char *plan_execute_DS = R"""(Executes the plan along one axis.
+
+Parameters
+----------
+a : numpy.ndarray (of the plan's data type)
+    The input data
+axis : int
+    The axis along which the FFT is carried out.
+forward : bool
+    If `True`, a negative sign is used in the exponent, else a positive one.
+inorm : int
+    Normalization type
+      0 : no normalization
+      1 : divide by sqrt(N)
+      2 : divide by N
+    where N is the length of the plan.
+out : numpy.ndarray (complex for 'c2c' and 'r2c', real for 'c2r')
+    For 'c2c', may be identical to `a`, but if it isn't, it must not overlap
+    with `a`. If None, a new array is allocated to store the output.
+nthreads : int
+    Number of threads to use. If 0, use the number of hardware threads.
+
+Returns
+-------
+numpy.ndarray
+    The transformed data, shaped like the output of `c2c`, `r2c` or `c2r`
+    for the same arguments.
+)""";
+
+// The vector instruction set this module was compiled for
+#if defined(__AVX512F__)
+const char *isa = "avx512f";
+#elif defined(__AVX2__)
+const char *isa = "avx2";
+#else
+const char *isa = "baseline";
+#endif
+
+// The instruction sets of the pypocketfft_<isa> modules that the running
+// CPU supports. This is evaluated in the baseline module.
+py::list cpu_features()
+  {
+  py::list res;
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    res.append("avx2");
+  if (__builtin_cpu_supports("avx512f"))
+    res.append("avx512f");
+#endif
+  return res;
+  }
+
+const char *cpu_features_DS = R"""(Vector instruction sets of the running CPU.
+
+Returns
+-------
+list of str
+    The instruction sets, out of those with a ``pypocketfft_<isa>`` build,
+    that the CPU and operating system support.
+)""";
+
 } // unnamed namespace
 
+// The same source is compiled once per instruction set; the non-baseline
+// builds come from pypocketfft_<isa>.cxx, which define POCKETFFT_ISA_<isa>.
+#if defined(POCKETFFT_ISA_AVX512F)
+PYBIND11_MODULE(pypocketfft_avx512f, m)
+#elif defined(POCKETFFT_ISA_AVX2)
+PYBIND11_MODULE(pypocketfft_avx2, m)
+#else
 PYBIND11_MODULE(pypocketfft, m)
+#endif
   {
   using namespace pybind11::literals;
 
   m.doc() = pypocketfft_DS;
+  m.attr("isa") = isa;
+  m.def("cpu_features", cpu_features, cpu_features_DS);
   m.def("c2c", c2c, c2c_DS, "a"_a, "axes"_a=None, "forward"_a=true,
     "inorm"_a=0, "out"_a=None, "nthreads"_a=1);
   m.def("r2c", r2c, r2c_DS, "a"_a, "axes"_a=None, "forward"_a=true,
     "inorm"_a=0, "out"_a=None, "nthreads"_a=1);
   m.def("c2r", c2r, c2r_DS, "a"_a, "axes"_a=None, "lastsize"_a=0,
     "forward"_a=true, "inorm"_a=0, "out"_a=None, "nthreads"_a=1);
+  m.def("r2c_inplace", r2c_inplace, r2c_inplace_DS, "a"_a, "n"_a,
+    "axes"_a=None, "forward"_a=true, "inorm"_a=0, "nthreads"_a=1);
+  m.def("c2r_inplace", c2r_inplace, c2r_inplace_DS, "a"_a, "axes"_a=None,
+    "lastsize"_a=0, "forward"_a=true, "inorm"_a=0, "nthreads"_a=1);
   m.def("r2r_fftpack", r2r_fftpack, r2r_fftpack_DS, "a"_a, "axes"_a,
     "real2hermitian"_a, "forward"_a, "inorm"_a=0, "out"_a=None, "nthreads"_a=1);
   m.def("separable_hartley", separable_hartley, separable_hartley_DS, "a"_a,
     "axes"_a=None, "inorm"_a=0, "out"_a=None, "nthreads"_a=1);
   m.def("genuine_hartley", genuine_hartley, genuine_hartley_DS, "a"_a,
     "axes"_a=None, "inorm"_a=0, "out"_a=None, "nthreads"_a=1);
+  m.def("dct", dct, dct_DS, "a"_a, "type"_a, "axes"_a=None, "inorm"_a=0,
+    "out"_a=None, "nthreads"_a=1);
+  m.def("dst", dst, dst_DS, "a"_a, "type"_a, "axes"_a=None, "inorm"_a=0,
+    "out"_a=None, "nthreads"_a=1);
+
+  m.def("convolve", convolve, convolve_DS, "a"_a, "b"_a, "axes"_a=None,
+    "mode"_a="full", "nthreads"_a=1);
+  m.def("correlate", correlate, correlate_DS, "a"_a, "b"_a, "axes"_a=None,
+    "mode"_a="full", "nthreads"_a=1);
+
+  m.def("segment_spectra", segment_spectra, segment_spectra_DS, "a"_a,
+    "window"_a, "step"_a, "nfft"_a, "detrend"_a=0, "mode"_a="spectra",
+    "fct"_a=1., "nthreads"_a=1);
+
+  py::class_<fft_plan>(m, "plan", plan_DS)
+    .def(py::init<const string &, size_t, const py::object &>(), "kind"_a,
+      "length"_a, "dtype"_a)
+    .def("execute", &fft_plan::execute, plan_execute_DS, "a"_a, "axis"_a=-1,
+      "forward"_a=true, "inorm"_a=0, "out"_a=None, "nthreads"_a=1)
+    .def_property_readonly("kind", &fft_plan::kind)
+    .def_property_readonly("length", &fft_plan::length)
+    .def_property_readonly("dtype", &fft_plan::dtype);
+
+  py::class_<fir_filter>(m, "fir_filter", fir_filter_DS)
+    .def(py::init<const py::array &, size_t>(), "kernel"_a, "block"_a=0)
+    .def("filter", &fir_filter::filter, fir_filter_filter_DS, "a"_a,
+      "out"_a=None)
+    .def("reset", &fir_filter::reset, "Forgets all samples passed so far.")
+    .def_property_readonly("kernel_length", &fir_filter::kernel_length)
+    .def_property_readonly("fft_length", &fir_filter::fft_length)
+    .def_property_readonly("block_length", &fir_filter::block_length)
+    .def_property_readonly("dtype", &fir_filter::dtype);
   }
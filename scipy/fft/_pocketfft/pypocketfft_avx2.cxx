@@ -0,0 +1,12 @@
+/*
+ * This file is part of pocketfft.
+ * Licensed under a 3-clause BSD style license - see LICENSE.md
+ */
+
+/*
+ *  Build of the Python interface for the avx2 instruction set; setup.py
+ *  compiles this file with the corresponding compiler flags.
+ */
+
+#define POCKETFFT_ISA_AVX2
+#include "pypocketfft.cxx"
@@ -0,0 +1,126 @@
+"""
+Real spectrum transforms (DCT, DST) - realtransforms.py
+"""
+from __future__ import division, print_function, absolute_import
+
+import numpy as np
+import functools
+from scipy.fft._pocketfft._isa import pypocketfft as pfft
+from scipy.fftpack.helper import _init_nd_shape_and_axes
+from .basic import (_asfarray, _datacopied, _fix_shape, _fix_shape_1d,
+                    _normalization, _workers)
+
+__all__ = ['dct', 'idct', 'dst', 'idst', 'dctn', 'idctn', 'dstn', 'idstn']
+
+# Inverse/forward type table
+_inverse_type = {1: 1, 2: 3, 3: 2, 4: 4}
+
+
+def _check_type(type):
+    if type not in _inverse_type:
+        raise ValueError("invalid transform type {0}, should be one of "
+                         "1, 2, 3 or 4".format(type))
+
+
+def _execute(pf, x, type, axes, norm, overwrite_x, workers):
+    """
+    Run the pypocketfft transform `pf` on `x`, handling complex input as
+    separate real and imaginary parts.
+    """
+    if np.iscomplexobj(x):
+        return (_execute(pf, x.real, type, axes, norm, False, workers) +
+                1j * _execute(pf, x.imag, type, axes, norm, False, workers))
+
+    out = (x if overwrite_x else None)
+    return pf(x, type, axes, norm, out, _workers(workers))
+
+
+def _r2r(inverse, pf, name, x, type=2, n=None, axis=-1, norm=None,
+         overwrite_x=False, workers=None):
+    """Forward or backward 1-D DCT/DST
+
+    Parameters
+    ----------
+    inverse : bool
+        If True, compute the inverse of the transform of type `type`.
+    pf : callable
+        The pypocketfft transform to call, ``pfft.dct`` or ``pfft.dst``.
+    name : str
+        ``'DCT'`` or ``'DST'``, used in error messages.
+    """
+    _check_type(type)
+    if inverse:
+        type = _inverse_type[type]
+
+    tmp = _asfarray(x)
+    overwrite_x = overwrite_x or _datacopied(tmp, x)
+    norm = _normalization(norm, True)
+
+    if n is not None:
+        tmp, copied = _fix_shape_1d(tmp, n, axis)
+        overwrite_x = overwrite_x or copied
+    elif tmp.shape[axis] < 1:
+        raise ValueError("invalid number of data points ({0}) specified"
+                         .format(tmp.shape[axis]))
+
+    if type == 1 and tmp.shape[axis] < 2:
+        raise ValueError("{0}-I is not defined for size < 2".format(name))
+
+    return _execute(pf, tmp, type, (axis,), norm, overwrite_x, workers)
+
+
+dct = functools.partial(_r2r, False, pfft.dct, 'DCT')
+dct.__name__ = 'dct'
+idct = functools.partial(_r2r, True, pfft.dct, 'DCT')
+idct.__name__ = 'idct'
+
+dst = functools.partial(_r2r, False, pfft.dst, 'DST')
+dst.__name__ = 'dst'
+idst = functools.partial(_r2r, True, pfft.dst, 'DST')
+idst.__name__ = 'idst'
+
+
+def _r2rn(inverse, pf, name, x, type=2, shape=None, axes=None, norm=None,
+          overwrite_x=False, workers=None):
+    """Forward or backward nd DCT/DST
+
+    Parameters
+    ----------
+    inverse : bool
+        If True, compute the inverse of the transform of type `type`.
+    pf : callable
+        The pypocketfft transform to call, ``pfft.dct`` or ``pfft.dst``.
+    name : str
+        ``'DCT'`` or ``'DST'``, used in error messages.
+    """
+    _check_type(type)
+    if inverse:
+        type = _inverse_type[type]
+
+    tmp = _asfarray(x)
+
+    shape, axes = _init_nd_shape_and_axes(tmp, shape, axes)
+    overwrite_x = overwrite_x or _datacopied(tmp, x)
+
+    if len(axes) == 0:
+        return x
+
+    tmp, copied = _fix_shape(tmp, shape, axes)
+    overwrite_x = overwrite_x or copied
+
+    if type == 1 and any(tmp.shape[a] < 2 for a in axes):
+        raise ValueError("{0}-I is not defined for size < 2".format(name))
+
+    norm = _normalization(norm, True)
+    return _execute(pf, tmp, type, axes, norm, overwrite_x, workers)
+
+
+dctn = functools.partial(_r2rn, False, pfft.dct, 'DCT')
+dctn.__name__ = 'dctn'
+idctn = functools.partial(_r2rn, True, pfft.dct, 'DCT')
+idctn.__name__ = 'idctn'
+
+dstn = functools.partial(_r2rn, False, pfft.dst, 'DST')
+dstn.__name__ = 'dstn'
+idstn = functools.partial(_r2rn, True, pfft.dst, 'DST')
+idstn.__name__ = 'idstn'
@@ -1,72 +1,38 @@
-
-def try_compile(compiler, code=None, flags=[], ext='.cpp'):
-    """Returns True if the compiler is able to compile the given code"""
-    import tempfile
-    from distutils.errors import CompileError
-    import os
-
-    code = code or 'int main (int argc, char **argv) { return 0; }'
-
-    with tempfile.TemporaryDirectory() as temp_dir:
-        fname = os.path.join(temp_dir, 'main'+ext)
-        with open(fname, 'w') as f:
-            f.write(code)
-
-        try:
-            compiler.compile([fname], extra_postargs=flags)
-        except CompileError:
-            return False
-    return True
-
-
-def has_flag(compiler, flag):
-    return try_compile(compiler, flags=[flag])
-
-
-def get_std_flag(compiler):
-    # Test the compiler for the highest available c++ standard flag
-    gnu_flags = ['--std=c++14', '--std=c++11']
-    flags_by_cc = {
-        'msvc': ['/std:c++14', None],
-        'intelw': ['/Qstd=c++14', '/Qstd=c++11']
-    }
-    flags = flags_by_cc.get(compiler.compiler_type, gnu_flags)
-
-    for flag in flags:
-        if flag is None:
-            return None
-
-        if has_flag(compiler, flag):
-            return flag
-
-    from numpy.distutils import log
-    log.warn('Could not detect c++ standard flag')
-    return None
-
-
-def try_add_flag(args, compiler, flag):
-    """Appends flag to the list of arguments if supported by the compiler"""
-    if try_compile(compiler, flags=args+[flag]):
-        args.append(flag)
-
-
 def pre_build_hook(build_ext, ext):
+    from scipy._build_utils.compiler_helper import (
+        set_cxx_threads_flags_hook, try_add_flag, try_compile)
     cc = build_ext._cxx_compiler
     args = ext.extra_compile_args
 
-    std_flag = get_std_flag(build_ext._cxx_compiler)
-    if std_flag is not None:
-        args.append(std_flag)
+    set_cxx_threads_flags_hook(build_ext, ext)
 
-    if cc.compiler_type == 'msvc':
-        args.append('/EHsc')
-    else:
+    if cc.compiler_type != 'msvc':
         try_add_flag(args, cc, '-fvisibility=hidden')
 
-        import sys
-        if sys.platform == 'darwin':
-            args.append('-mmacosx-version-min=10.7')
-            try_add_flag(args, cc, '-stdlib=libc++')
+        # restart the thread pool after fork() with pthread_atfork
+        if try_compile(cc, code='#include <pthread.h>\n'
+                               'int main() { return 0; }'):
+            ext.define_macros.append(('POCKETFFT_PTHREADS', None))
+
+
+def isa_pre_build_hook(flags):
+    """pre_build_hook for a build with the vector instruction set `flags`"""
+    def hook(build_ext, ext):
+        from scipy._build_utils.compiler_helper import try_add_flag
+        pre_build_hook(build_ext, ext)
+        cc = build_ext._cxx_compiler
+        # MSVC builds do not use vector instructions at all, so they are
+        # left at the baseline and never selected
+        if cc.compiler_type != 'msvc':
+            for flag in flags:
+                try_add_flag(ext.extra_compile_args, cc, flag)
+    return hook
+
+
+# Extra builds of pypocketfft for instruction sets beyond the baseline, the
+# best one supported by the CPU is selected at import time (see _isa.py)
+ISA_BUILDS = [('avx2', ['-mavx2']),
+              ('avx512f', ['-mavx512f'])]
 
 
 def configuration(parent_package='', top_path=None):
@@ -82,6 +48,15 @@ def configuration(parent_package='', top_path=None):
                                language='c++')
     ext._pre_build_hook = pre_build_hook
 
+    for isa, flags in ISA_BUILDS:
+        ext = config.add_extension('pypocketfft_' + isa,
+                                   sources=['pypocketfft_' + isa + '.cxx'],
+                                   depends=['pypocketfft.cxx',
+                                            'pocketfft_hdronly.h'],
+                                   include_dirs=include_dirs,
+                                   language='c++')
+        ext._pre_build_hook = isa_pre_build_hook(flags)
+
     config.add_data_files('LICENSE.md')
     config.add_data_dir('tests')
     return config
@@ -5,10 +5,12 @@ from __future__ import division, print_function, absolute_import
 from numpy.testing import (assert_, assert_equal, assert_array_almost_equal,
                            assert_array_almost_equal_nulp, assert_array_less,
                            assert_allclose)
+import os
 import pytest
 from pytest import raises as assert_raises
 from scipy.fft._pocketfft import (ifft, fft, fftn, ifftn,
                                   rfft, irfft, rfftn, irfftn, fft2)
+from scipy.fft._pocketfft import pypocketfft as pfft
 
 from numpy import (arange, add, array, asarray, zeros, dot, exp, pi,
                    swapaxes, double, cdouble)
@@ -1002,3 +1004,372 @@ def test_invalid_norm(func):
     with assert_raises(ValueError,
                        match='Invalid norm value o, should be None or "ortho"'):
         func(x, norm='o')
+
+
+@pytest.mark.parametrize('func, kwargs', [(fft, {'axis': -1}),
+                                          (ifft, {'axis': 0}),
+                                          (rfft, {'axis': -1}),
+                                          (irfft, {'axis': 1}),
+                                          (fftn, {'axes': (0, 1)}),
+                                          (ifftn, {'axes': (1, 2)}),
+                                          (rfftn, {'axes': (0, 2)}),
+                                          (irfftn, {'axes': (0, 1)})])
+@pytest.mark.parametrize('workers', [2, 4, -1])
+def test_workers(func, kwargs, workers):
+    x = np.random.RandomState(1234).randn(16, 32, 8)
+    expected = func(x, **kwargs)
+    # the lines are split between the threads, each computed as before
+    assert_allclose(func(x, workers=workers, **kwargs), expected,
+                    rtol=1e-12, atol=1e-12)
+
+
+def test_invalid_workers():
+    x = np.arange(16, dtype=float)
+    assert_raises(ValueError, fft, x, workers=0)
+    assert_raises(ValueError, fft, x, workers=-os.cpu_count() - 1)
+
+
+@pytest.mark.parametrize('n', [2**18, 2**19 * 3, 2**18 + 2])
+def test_workers_long_1d(n):
+    # a single long line is split with the four-step algorithm
+    x = np.random.RandomState(1234).randn(2 * n + 1)
+    z = x[:n] + 1j * x[n:2*n]
+    zs = x[:2*n:2] + 1j * x[1:2*n:2]
+
+    for y in [z, zs]:
+        for func in [fft, ifft]:
+            expected = func(y)
+            assert_allclose(func(y, workers=4), expected,
+                            rtol=1e-12, atol=1e-12 * abs(expected).max())
+
+    r = x[:n]
+    expected = rfft(r)
+    assert_allclose(rfft(r, workers=4), expected,
+                    rtol=1e-12, atol=1e-12 * abs(expected).max())
+    assert_allclose(irfft(expected, n, workers=4), r,
+                    rtol=1e-12, atol=1e-12)
+
+
+@pytest.mark.parametrize('dtype', [np.float32, np.float64, np.longfloat])
+@pytest.mark.parametrize('n', [16, 29, 100])
+def test_plan(dtype, n):
+    rtol = 1e-5 if dtype == np.float32 else 1e-12
+    cdtype = np.result_type(dtype, np.complex64)
+    rng = np.random.RandomState(1234)
+
+    p = pfft.plan('c2c', n, cdtype)
+    assert_equal((p.kind, p.length, p.dtype), ('c2c', n, np.dtype(cdtype)))
+    pr = pfft.plan('r2c', n, dtype)
+    pc = pfft.plan('c2r', n, cdtype)
+
+    # one plan executed on several arrays and axes
+    for shape, axis in [((n,), -1), ((3, n), 1), ((n, 5), 0), ((2, n, 4), 1)]:
+        x = rng.randn(*shape).astype(dtype)
+        z = (x + 1j * rng.randn(*shape)).astype(cdtype)
+        expected = pfft.c2c(z, (axis,), True, 0)
+        assert_allclose(p.execute(z, axis), expected, rtol=rtol,
+                        atol=rtol * abs(expected).max())
+        expected = pfft.c2c(z, (axis,), False, 2)
+        assert_allclose(p.execute(z, axis, False, 2), expected, rtol=rtol,
+                        atol=rtol * abs(expected).max())
+        h = pr.execute(x, axis)
+        expected = pfft.r2c(x, (axis,), True, 0)
+        assert_allclose(h, expected, rtol=rtol,
+                        atol=rtol * abs(expected).max())
+        assert_allclose(pc.execute(h, axis, False, 2, None, 2), x, rtol=rtol,
+                        atol=rtol * abs(x).max())
+
+    z = (rng.randn(n) + 1j * rng.randn(n)).astype(cdtype)
+    expected = pfft.c2c(z, (0,), True, 1)
+    assert_allclose(p.execute(z, 0, True, 1, z), expected, rtol=rtol,
+                    atol=rtol * abs(expected).max())
+    assert_allclose(z, expected, rtol=rtol, atol=rtol * abs(expected).max())
+
+
+def test_plan_invalid():
+    assert_raises(ValueError, pfft.plan, 'foo', 16, np.complex128)
+    assert_raises(ValueError, pfft.plan, 'c2c', 0, np.complex128)
+    assert_raises(ValueError, pfft.plan, 'c2c', 16, np.float64)
+    assert_raises(ValueError, pfft.plan, 'r2c', 16, np.complex128)
+    assert_raises(ValueError, pfft.plan, 'c2c', 16, np.int64)
+
+    p = pfft.plan('c2c', 16, np.complex128)
+    assert_raises(ValueError, p.execute, np.zeros(16, np.complex64))
+    assert_raises(RuntimeError, p.execute, np.zeros(15, np.complex128))
+    pc = pfft.plan('c2r', 16, np.complex128)
+    assert_raises(ValueError, pc.execute, np.zeros(8, np.complex128))
+
+
+@pytest.mark.parametrize('isa', ['avx2', 'avx512f'])
+def test_isa_builds(isa):
+    # every build the CPU can run gives the results of the baseline build
+    if isa not in pfft.cpu_features():
+        pytest.skip("CPU does not support {}".format(isa))
+    mod = pytest.importorskip('scipy.fft._pocketfft.pypocketfft_' + isa)
+
+    x = np.random.RandomState(1234).randn(16, 30, 8)
+    z = x + 1j * x[::-1]
+    for axes in [(0,), (1,), (0, 1, 2)]:
+        expected = pfft.c2c(z, axes, True, 0)
+        assert_allclose(mod.c2c(z, axes, True, 0), expected, rtol=1e-12,
+                        atol=1e-12 * abs(expected).max())
+        expected = pfft.r2c(x, axes, True, 0)
+        assert_allclose(mod.r2c(x, axes, True, 0), expected, rtol=1e-12,
+                        atol=1e-12 * abs(expected).max())
+        expected = pfft.dct(x, 2, axes)
+        assert_allclose(mod.dct(x, 2, axes), expected, rtol=1e-12,
+                        atol=1e-12 * abs(expected).max())
+
+
+def test_isa_selected():
+    from scipy.fft._pocketfft._isa import pypocketfft as selected
+    features = pfft.cpu_features()
+    assert_(selected.isa == 'baseline' or selected.isa in features)
+
+
+def _window(full, na, nb, mode):
+    """The part of a full convolution returned by `mode`."""
+    if mode == 'same':
+        return full[(len(full) - na) // 2:][:na]
+    elif mode == 'valid':
+        return full[min(na, nb) - 1:][:abs(na - nb) + 1]
+    return full
+
+
+@pytest.mark.parametrize('mode', ['full', 'same', 'valid'])
+@pytest.mark.parametrize('dtype, rtol', [(np.float32, 1e-5),
+                                         (np.float64, 1e-12)])
+def test_convolve_1d(mode, dtype, rtol):
+    rng = np.random.RandomState(1234)
+    for na, nb in [(1, 1), (10, 3), (3, 10), (37, 37), (128, 17)]:
+        a = rng.randn(na).astype(dtype)
+        b = rng.randn(nb).astype(dtype)
+        a64, b64 = a.astype(np.float64), b.astype(np.float64)
+        for func, expected in [(pfft.convolve, np.convolve(a64, b64)),
+                               (pfft.correlate, np.convolve(a64, b64[::-1]))]:
+            expected = _window(expected, na, nb, mode)
+            res = func(a, b, mode=mode, nthreads=2)
+            assert_equal(res.dtype, dtype)
+            assert_allclose(res, expected, rtol=rtol,
+                            atol=rtol * abs(expected).max())
+
+
+@pytest.mark.parametrize('axes', [(0,), (2,), (0, 2), (0, 1, 2)])
+def test_convolve_nd(axes):
+    rng = np.random.RandomState(1234)
+    a = rng.randn(9, 6, 11)
+    b = rng.randn(*[(4, 3, 15)[ax] if ax in axes else a.shape[ax]
+                    for ax in range(3)])
+    if axes == (2,):
+        b = b[:1]  # broadcast along axis 0
+    for mode in ['full', 'same', 'valid']:
+        expected = _direct_convolve(a, b, axes)
+        full = np.array(expected.shape)
+        start = np.zeros(3, dtype=int)
+        size = full.copy()
+        for ax in axes:
+            na, nb = a.shape[ax], b.shape[ax]
+            if mode == 'same':
+                size[ax], start[ax] = na, (full[ax] - na) // 2
+            elif mode == 'valid':
+                size[ax], start[ax] = abs(na - nb) + 1, min(na, nb) - 1
+        expected = expected[tuple(slice(s, s + n)
+                                  for s, n in zip(start, size))]
+        res = pfft.convolve(a, b, axes=axes, mode=mode, nthreads=3)
+        assert_allclose(res, expected, rtol=1e-12,
+                        atol=1e-12 * abs(expected).max())
+        flipped = b[tuple(slice(None, None, -1) if ax in axes else slice(None)
+                          for ax in range(3))]
+        assert_allclose(pfft.correlate(a, flipped, axes=axes, mode=mode),
+                        expected, rtol=1e-12,
+                        atol=1e-12 * abs(expected).max())
+
+
+def _direct_convolve(a, b, axes):
+    """Full convolution of `a` and `b` over `axes`, broadcasting elsewhere."""
+    shape = [a.shape[ax] + b.shape[ax] - 1 if ax in axes
+             else max(a.shape[ax], b.shape[ax]) for ax in range(a.ndim)]
+    res = np.zeros(shape)
+    for idx in np.ndindex(*[b.shape[ax] if ax in axes else 1
+                            for ax in range(a.ndim)]):
+        sl = tuple(slice(i, i + a.shape[ax]) if ax in axes else slice(None)
+                   for ax, i in enumerate(idx))
+        bsl = tuple(slice(i, i + 1) if ax in axes else slice(None)
+                    for ax, i in enumerate(idx))
+        res[sl] += a * b[bsl]
+    return res
+
+
+def test_convolve_invalid():
+    a = np.zeros((4, 5))
+    assert_raises(ValueError, pfft.convolve, a, a, mode='foo')
+    assert_raises(ValueError, pfft.convolve, a, a.astype(np.float32))
+    assert_raises(ValueError, pfft.convolve, a, np.zeros(5))
+    assert_raises(ValueError, pfft.convolve, a, np.zeros((3, 5)), axes=(1,))
+    assert_raises(ValueError, pfft.convolve, a, np.zeros((4, 0)), axes=(1,))
+
+
+@pytest.mark.parametrize('klen, block', [(1, 0), (7, 0), (33, 10), (101, 0)])
+@pytest.mark.parametrize('dtype, rtol', [(np.float32, 1e-5),
+                                         (np.float64, 1e-12)])
+def test_fir_filter(klen, block, dtype, rtol):
+    rng = np.random.RandomState(1234)
+    kernel = rng.randn(klen).astype(dtype)
+    x = rng.randn(2000).astype(dtype)
+    expected = np.convolve(kernel.astype(np.float64),
+                           x.astype(np.float64))[:len(x)]
+
+    f = pfft.fir_filter(kernel, block)
+    assert_equal(f.kernel_length, klen)
+    assert_(f.block_length + klen - 1 == f.fft_length)
+    # blocks of varying size, including empty and longer than block_length
+    bounds = [0, 0, 1, 5, 17, 300, 301, 1200, 2000]
+    res = np.concatenate([f.filter(x[lo:hi])
+                          for lo, hi in zip(bounds[:-1], bounds[1:])])
+    assert_equal(res.dtype, dtype)
+    assert_allclose(res, expected, rtol=rtol, atol=rtol * abs(expected).max())
+
+    f.reset()
+    y = x.copy()
+    assert_(f.filter(y, out=y) is y)
+    assert_allclose(y, expected, rtol=rtol, atol=rtol * abs(expected).max())
+
+
+def test_fir_filter_invalid():
+    assert_raises(ValueError, pfft.fir_filter, np.zeros(0))
+    assert_raises(ValueError, pfft.fir_filter, np.zeros((2, 2)))
+    assert_raises(ValueError, pfft.fir_filter, np.zeros(4, dtype=np.int64))
+    f = pfft.fir_filter(np.ones(4))
+    assert_raises(ValueError, f.filter, np.zeros(8, dtype=np.float32))
+    assert_raises(ValueError, f.filter, np.zeros((2, 8)))
+    assert_raises(ValueError, f.filter, np.zeros(8), out=np.zeros(16)[::2])
+
+
+@pytest.mark.parametrize('nperseg, step, nfft', [(1, 1, 1), (16, 5, 16),
+                                                  (31, 31, 40)])
+@pytest.mark.parametrize('dtype', [np.float32, np.float64])
+def test_segment_spectra(nperseg, step, nfft, dtype):
+    rng = np.random.RandomState(1234)
+    x = rng.randn(3, 2, 200).astype(dtype).transpose(1, 0, 2)[..., ::-1]
+    win = rng.rand(nperseg)
+    nseg = (200 - nperseg) // step + 1
+    nfreq = nfft // 2 + 1
+    seg = np.stack([x[..., s*step:s*step + nperseg] for s in range(nseg)], -2)
+    seg = seg.astype(np.float64)
+    t = np.arange(nperseg)
+    for detrend in [0, 1, 2]:
+        d = seg
+        if detrend == 1:
+            d = seg - seg.mean(-1, keepdims=True)
+        elif detrend == 2 and nperseg > 1:
+            fit = np.polyfit(t, seg.reshape(-1, nperseg).T, 1)
+            d = seg - (np.outer(t, fit[0]) + fit[1]).T.reshape(seg.shape)
+        elif detrend == 2:
+            d = seg - seg
+        spec = np.fft.rfft(d * win, nfft)
+        power = 2 * abs(spec)**2
+        power[..., 0] /= 2
+        if nfft % 2 == 0:
+            power[..., -1] /= 2
+        for nthreads in [1, 2]:
+            res = pfft.segment_spectra(x, win, step, nfft, detrend, 'spectra',
+                                       0.5, nthreads)
+            assert_equal(res.shape, (2, 3, nseg, nfreq))
+            assert_allclose(res, 0.5 * spec, rtol=1e-12, atol=1e-12)
+            res = pfft.segment_spectra(x, win, step, nfft, detrend, 'power',
+                                       0.5, nthreads)
+            assert_allclose(res, 0.5 * power, rtol=1e-12, atol=1e-12)
+            res = pfft.segment_spectra(x, win, step, nfft, detrend,
+                                       'power_sum', 0.5, nthreads)
+            assert_equal(res.shape, (2, 3, nfreq))
+            assert_allclose(res, 0.5 * power.sum(-2), rtol=1e-12, atol=1e-12)
+
+
+def test_segment_spectra_invalid():
+    x = np.zeros(10)
+    assert_raises(ValueError, pfft.segment_spectra, x, np.ones(11), 1, 11)
+    assert_raises(ValueError, pfft.segment_spectra, x, np.ones(0), 1, 4)
+    assert_raises(ValueError, pfft.segment_spectra, x, np.ones(4), 1, 3)
+    assert_raises(ValueError, pfft.segment_spectra, x, np.ones(4), 0, 4)
+    assert_raises(ValueError, pfft.segment_spectra, x, np.ones(4), 1, 4, 3)
+    assert_raises(ValueError, pfft.segment_spectra, x, np.ones(4), 1, 4, 0,
+                  'psd')
+    assert_raises(RuntimeError, pfft.segment_spectra, x.astype(complex),
+                  np.ones(4), 1, 4)
+
+
+@pytest.mark.parametrize('n', [1, 10, 11])
+@pytest.mark.parametrize('axes', [(2,), (0, 2), (0, 1, 2), (1,)])
+@pytest.mark.parametrize('dtype, rtol', [(np.float32, 1e-5),
+                                         (np.float64, 1e-12)])
+def test_inplace_real(n, axes, dtype, rtol):
+    rng = np.random.RandomState(1234)
+    shape = [4, 6, 9]
+    shape[axes[-1]] = n
+    x = rng.randn(*shape).astype(dtype)
+    expected = pfft.r2c(x, axes, True, 0)
+
+    # padded layout, contiguous along the last transformed axis
+    padded = list(shape)
+    padded[axes[-1]] = 2 * (n // 2 + 1)
+    order = [ax for ax in range(3) if ax != axes[-1]] + [axes[-1]]
+    buf = np.zeros([padded[ax] for ax in order], dtype).transpose(
+        np.argsort(order))
+    buf[tuple(slice(s) for s in shape)] = x
+
+    res = pfft.r2c_inplace(buf, n, axes, nthreads=2)
+    assert_(np.shares_memory(res, buf))
+    assert_equal(res.shape, expected.shape)
+    assert_allclose(res, expected, rtol=rtol, atol=rtol * abs(expected).max())
+
+    back = pfft.c2r_inplace(res, axes, n, False, 2, nthreads=2)
+    assert_(np.shares_memory(back, buf))
+    assert_allclose(back, x, rtol=rtol, atol=rtol * abs(x).max())
+
+
+def test_inplace_real_invalid():
+    a = np.zeros((4, 10))
+    assert_raises(ValueError, pfft.r2c_inplace, a, 10)
+    assert_raises(ValueError, pfft.r2c_inplace, a, 8, (1, 0))
+    assert_raises(ValueError, pfft.r2c_inplace, np.zeros((12, 4)), 10, (1, 0))
+    a.flags.writeable = False
+    assert_raises(ValueError, pfft.r2c_inplace, a, 9)
+    b = np.zeros((4, 10), complex)[:, ::2]
+    assert_raises(ValueError, pfft.c2r_inplace, b)
+
+
+@pytest.mark.parametrize('func, x', [
+    (lambda x: pfft.c2c(x, None), np.ones((6, 8), complex)),
+    (lambda x: pfft.r2c(x, (0, 1)), np.ones((6, 8))),
+    (lambda x: pfft.c2r(x, (0, 1), 14), np.ones((6, 8), complex)),
+    (lambda x: pfft.dct(x, 2), np.ones((6, 8)))])
+def test_fortran_order_output(func, x):
+    # Fortran-ordered input gives Fortran-ordered output without a copy
+    xf = np.asfortranarray(x)
+    res = func(xf)
+    assert_(res.flags.f_contiguous)
+    assert_allclose(res, func(np.ascontiguousarray(x)), rtol=1e-12,
+                    atol=1e-12)
+
+
+@pytest.mark.parametrize('dtype', [np.float32, np.float64])
+@pytest.mark.parametrize('axes', [(0,), (1,), (0, 1), (0, 2)])
+def test_long_stride_axes(dtype, axes):
+    # axes with strides of many kB are transformed in blocks of lines;
+    # compare with the same data stored contiguously along the axes
+    rng = np.random.RandomState(1234)
+    x = rng.randn(48, 33, 40).astype(dtype)
+    z = x + 1j * x[::-1]
+    rtol = 1e-5 if dtype == np.float32 else 1e-12
+    perm = [ax for ax in range(3) if ax not in axes] + list(axes)
+    inv = np.argsort(perm)
+    newaxes = tuple(range(3 - len(axes), 3))
+    for nthreads in [1, 3]:
+        expected = pfft.c2c(np.ascontiguousarray(z.transpose(perm)),
+                            newaxes, True, 0).transpose(inv)
+        assert_allclose(pfft.c2c(z, axes, True, 0, None, nthreads), expected,
+                        rtol=rtol, atol=rtol * abs(expected).max())
+        expected = pfft.r2c(np.ascontiguousarray(x.transpose(perm)),
+                            newaxes, True, 0).transpose(inv)
+        assert_allclose(pfft.r2c(x, axes, True, 0, None, nthreads), expected,
+                        rtol=rtol, atol=rtol * abs(expected).max())
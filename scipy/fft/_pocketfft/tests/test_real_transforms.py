@@ -0,0 +1,129 @@
+from __future__ import division, print_function, absolute_import
+
+from numpy.testing import assert_allclose, assert_equal
+import pytest
+from pytest import raises as assert_raises
+import numpy as np
+
+import scipy.fftpack as fftpack
+from scipy.fft._pocketfft import (dct, idct, dst, idst, dctn, idctn, dstn,
+                                  idstn)
+
+fftpack_funcs = {dct: fftpack.dct, idct: fftpack.idct,
+                 dst: fftpack.dst, idst: fftpack.idst,
+                 dctn: fftpack.dctn, idctn: fftpack.idctn,
+                 dstn: fftpack.dstn, idstn: fftpack.idstn}
+
+
+def _definition(x, type, cosine):
+    """Direct evaluation of the unnormalized 1-D DCT/DST of `x`."""
+    N = len(x)
+    k = np.arange(N)[:, None]
+    n = np.arange(N)[None, :]
+    if cosine:
+        if type == 1:
+            m = 2 * np.cos(np.pi * k * n / (N - 1))
+            m[:, 0] /= 2
+            m[:, -1] /= 2
+        elif type == 2:
+            m = 2 * np.cos(np.pi * k * (2*n + 1) / (2*N))
+        elif type == 3:
+            m = 2 * np.cos(np.pi * n * (2*k + 1) / (2*N))
+            m[:, 0] = 1
+        else:
+            m = 2 * np.cos(np.pi * (2*n + 1) * (2*k + 1) / (4*N))
+    else:
+        if type == 1:
+            m = 2 * np.sin(np.pi * (k + 1) * (n + 1) / (N + 1))
+        elif type == 2:
+            m = 2 * np.sin(np.pi * (k + 1) * (2*n + 1) / (2*N))
+        elif type == 3:
+            m = 2 * np.sin(np.pi * (2*k + 1) * (n + 1) / (2*N))
+            m[:, -1] = (-1.)**k[:, 0]
+        else:
+            m = 2 * np.sin(np.pi * (2*k + 1) * (2*n + 1) / (4*N))
+    return m.dot(x)
+
+
+@pytest.mark.parametrize('func, cosine', [(dct, True), (dst, False)])
+@pytest.mark.parametrize('type', [1, 2, 3, 4])
+@pytest.mark.parametrize('n', [2, 3, 4, 7, 8, 15, 16, 29, 64, 97])
+def test_definition(func, cosine, type, n):
+    x = np.random.RandomState(1234).randn(n)
+    assert_allclose(func(x, type=type), _definition(x, type, cosine),
+                    rtol=1e-12, atol=1e-12 * n)
+
+
+@pytest.mark.parametrize('func', [dct, idct, dst, idst])
+@pytest.mark.parametrize('type', [1, 2, 3, 4])
+@pytest.mark.parametrize('norm', [None, 'ortho'])
+@pytest.mark.parametrize('dtype, rtol', [(np.float32, 1e-5),
+                                         (np.float64, 1e-12)])
+def test_fftpack_1d(func, type, norm, dtype, rtol):
+    x = np.random.RandomState(1234).randn(7, 16, 13).astype(dtype)
+    for axis in [0, 1, -1]:
+        expected = fftpack_funcs[func](x, type=type, axis=axis, norm=norm)
+        y = func(x, type=type, axis=axis, norm=norm)
+        assert_equal(y.dtype, dtype)
+        assert_allclose(y, expected, rtol=rtol,
+                        atol=rtol * abs(expected).max())
+
+
+@pytest.mark.parametrize('func', [dctn, idctn, dstn, idstn])
+@pytest.mark.parametrize('type', [1, 2, 3, 4])
+@pytest.mark.parametrize('norm', [None, 'ortho'])
+@pytest.mark.parametrize('shape, axes', [(None, None), (None, (0, 2)),
+                                         ((5, 20), (2, 0)), ((12,), (1,))])
+def test_fftpack_nd(func, type, norm, shape, axes):
+    x = np.random.RandomState(1234).randn(7, 16, 13)
+    expected = fftpack_funcs[func](x, type=type, shape=shape, axes=axes,
+                                   norm=norm)
+    assert_allclose(func(x, type=type, shape=shape, axes=axes, norm=norm),
+                    expected, rtol=1e-12, atol=1e-12 * abs(expected).max())
+
+
+@pytest.mark.parametrize('forward, backward', [(dct, idct), (dst, idst)])
+@pytest.mark.parametrize('type', [1, 2, 3, 4])
+@pytest.mark.parametrize('dtype', [np.float64, np.longfloat])
+def test_ortho_inverse(forward, backward, type, dtype):
+    x = np.random.RandomState(1234).randn(31).astype(dtype)
+    y = backward(forward(x, type=type, norm='ortho'), type=type, norm='ortho')
+    assert_equal(y.dtype, dtype)
+    eps = np.finfo(dtype).eps
+    assert_allclose(y, x, rtol=100 * eps, atol=100 * eps)
+
+
+def test_complex_input():
+    x = np.random.RandomState(1234).randn(2, 10, 16)
+    z = x[0] + 1j * x[1]
+    assert_allclose(dct(z), dct(x[0]) + 1j * dct(x[1]), rtol=1e-14)
+    assert_allclose(dstn(z, type=1),
+                    dstn(x[0], type=1) + 1j * dstn(x[1], type=1), rtol=1e-14)
+
+
+@pytest.mark.parametrize('func, kwargs', [(dct, {'axis': 0}),
+                                          (idst, {'axis': -1}),
+                                          (dctn, {'axes': (0, 1)}),
+                                          (idstn, {'axes': (1, 2)})])
+@pytest.mark.parametrize('type', [1, 2, 3, 4])
+def test_workers(func, kwargs, type):
+    x = np.random.RandomState(1234).randn(16, 32, 8)
+    expected = func(x, type=type, **kwargs)
+    assert_allclose(func(x, type=type, workers=4, **kwargs), expected,
+                    rtol=1e-12, atol=1e-12)
+
+
+def test_overwrite_x():
+    x = np.random.RandomState(1234).randn(32)
+    expected = dct(x, type=2)
+    y = x.copy()
+    assert_allclose(dct(y, type=2, overwrite_x=True), expected, rtol=1e-14)
+
+
+@pytest.mark.parametrize('func', [dct, idct, dst, idst, dctn, idctn, dstn,
+                                  idstn])
+def test_invalid_arguments(func):
+    x = np.arange(10, dtype=float)
+    assert_raises(ValueError, func, x, type=5)
+    assert_raises(ValueError, func, x, norm='o')
+    assert_raises(ValueError, func, x[:1], type=1)
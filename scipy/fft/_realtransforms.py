@@ -1,32 +1,48 @@
+import re
 import scipy.fftpack as _fftpack
+from . import _pocketfft
 
 __all__ = ['dct', 'idct', 'dst', 'idst', 'dctn', 'idctn', 'dstn', 'idstn']
 
+_workers_doc = """\
+    workers : int, optional
+        Maximum number of workers to use for parallel computation. If negative,
+        the value wraps around from ``os.cpu_count()``.
+        See :func:`~scipy.fft.fft` for more details.
+"""
+
+
 def _doc_wrap(transform_func, new_func):
     doc = transform_func.__doc__ or ''
-    new_func.__doc__ = doc.replace('fftpack', 'fft')
+    doc = doc.replace('fftpack', 'fft')
+    # document ``workers`` after the last parameter, ``overwrite_x``
+    doc = re.sub(r'(\n    overwrite_x : .*?\n)(?=\n)', r'\1' + _workers_doc,
+                 doc, count=1, flags=re.S)
+    new_func.__doc__ = doc
     new_func.__name__ = transform_func.__name__
     return new_func
 
 
-def _doc_wrap_1d(transform_func):
-    def inner(x, type=2, n=None, axis=-1, norm=None, overwrite_x=False):
-        return transform_func(x, type, n, axis, norm, overwrite_x)
+def _doc_wrap_1d(transform_func, pocketfft_func):
+    def inner(x, type=2, n=None, axis=-1, norm=None, overwrite_x=False,
+              workers=None):
+        return pocketfft_func(x, type, n, axis, norm, overwrite_x, workers)
     return _doc_wrap(transform_func, inner)
 
 
-def _doc_wrap_nd(transform_func):
-    def inner(x, type=2, shape=None, axes=None, norm=None, overwrite_x=False):
-        return transform_func(x, type, shape, axes, norm, overwrite_x)
+def _doc_wrap_nd(transform_func, pocketfft_func):
+    def inner(x, type=2, shape=None, axes=None, norm=None, overwrite_x=False,
+              workers=None):
+        return pocketfft_func(x, type, shape, axes, norm, overwrite_x, workers)
     return _doc_wrap(transform_func, inner)
 
 
-dctn = _doc_wrap_nd(_fftpack.dctn)
-idctn = _doc_wrap_nd(_fftpack.idctn)
-dstn = _doc_wrap_nd(_fftpack.dstn)
-idstn = _doc_wrap_nd(_fftpack.idstn)
+dctn = _doc_wrap_nd(_fftpack.dctn, _pocketfft.dctn)
+idctn = _doc_wrap_nd(_fftpack.idctn, _pocketfft.idctn)
+dstn = _doc_wrap_nd(_fftpack.dstn, _pocketfft.dstn)
+idstn = _doc_wrap_nd(_fftpack.idstn, _pocketfft.idstn)
 
-dct = _doc_wrap_1d(_fftpack.dct)
-idct = _doc_wrap_1d(_fftpack.idct)
-dst = _doc_wrap_1d(_fftpack.dst)
-idst = _doc_wrap_1d(_fftpack.idst)
+dct = _doc_wrap_1d(_fftpack.dct, _pocketfft.dct)
+idct = _doc_wrap_1d(_fftpack.idct, _pocketfft.idct)
+dst = _doc_wrap_1d(_fftpack.dst, _pocketfft.dst)
+idst = _doc_wrap_1d(_fftpack.idst, _pocketfft.idst)
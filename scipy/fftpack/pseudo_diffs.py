@@ -10,20 +10,99 @@ __all__ = ['diff',
            'cs_diff','cc_diff','sc_diff','ss_diff',
            'shift']
 
+import threading
+from collections import OrderedDict
+
+import numpy as np
 from numpy import pi, asarray, sin, cos, sinh, cosh, tanh, iscomplexobj
-from . import convolve
 
-from scipy.fftpack.basic import _datacopied
 
-import atexit
-atexit.register(convolve.destroy_convolve_cache)
-del atexit
+class _KernelCache(object):
+    """
+    Bounded cache of the Fourier multipliers of the operators, keyed by the
+    operator, the length and its parameters. It is shared by all threads,
+    and the least recently used multipliers are dropped when it is full.
+    """
+
+    def __init__(self, maxsize):
+        self.maxsize = maxsize
+        self._kernels = OrderedDict()
+        self._lock = threading.Lock()
+
+    def get(self, key, make):
+        with self._lock:
+            w = self._kernels.get(key)
+            if w is not None:
+                self._kernels.move_to_end(key)
+                return w
 
+        # computed outside the lock; a concurrent miss computes it twice
+        w = make()
+        w.setflags(write=False)
+        with self._lock:
+            self._kernels[key] = w
+            while len(self._kernels) > self.maxsize:
+                self._kernels.popitem(last=False)
+        return w
 
-_cache = {}
 
+_kernels = _KernelCache(maxsize=64)
 
-def diff(x,order=1,period=None, _cache=_cache):
+
+def _multipliers(n, K, d=0, zero_nyquist=None):
+    """
+    Fourier multipliers ``i**d * K[k]`` of the modes k = 0, ..., n//2.
+
+    As in FFTPACK's `init_convolution_kernel`, the mean mode is multiplied by
+    ``K[0]``, and for even `n` the Nyquist mode by the real number
+    ``+-K[n//2]``, or by zero if `zero_nyquist` (default: `d` odd).
+    """
+    if zero_nyquist is None:
+        zero_nyquist = d % 2
+    w = K * (1, 1j, -1, -1j)[d % 4]
+    w[0] = K[0]
+    if n % 2 == 0:
+        w[-1] = 0 if zero_nyquist else (1, 1, -1, -1)[d % 4] * K[-1]
+    return w
+
+
+def _convolve(x, key, kernel, axis):
+    """
+    Apply to `x` along `axis` the operator with the Fourier multipliers
+    returned by ``kernel(n, k)`` for the modes ``k = arange(n//2 + 1)``.
+
+    Real input is transformed with pypocketfft's r2c and c2r, all the
+    sequences along the other axes in one call. Complex input is handled as
+    its real and imaginary parts.
+    """
+    from scipy.fft._pocketfft._isa import pypocketfft as pfft
+
+    tmp = asarray(x)
+    if iscomplexobj(tmp):
+        return (_convolve(tmp.real, key, kernel, axis)
+                + 1j*_convolve(tmp.imag, key, kernel, axis))
+    tmp = asarray(tmp, dtype=np.float64)
+    if tmp.ndim == 0:
+        raise ValueError("x must be at least 1-D")
+
+    n = tmp.shape[axis]
+    if n < 1:
+        raise ValueError("invalid number of data points (%d) specified" % n)
+
+    def make():
+        k = np.arange(n//2 + 1, dtype=np.float64)
+        with np.errstate(all='ignore'):
+            return kernel(n, k)
+    w = _kernels.get((n,) + key, make)
+
+    axis = axis % tmp.ndim
+    spectrum = pfft.r2c(tmp, axes=(axis,), forward=True)
+    spectrum *= w.reshape((-1,) + (1,)*(tmp.ndim - axis - 1))
+    return pfft.c2r(spectrum, axes=(axis,), lastsize=n, forward=False,
+                    inorm=2)
+
+
+def diff(x, order=1, period=None, axis=-1):
     """
     Return k-th derivative (or integral) of a periodic sequence x.
 
@@ -43,6 +122,9 @@ def diff(x,order=1,period=None, _cache=_cache):
         that ``x_0 == 0``.
     period : float, optional
         The assumed period of the sequence. Default is ``2*pi``.
+    axis : int, optional
+        Axis along which the operator is applied; default is over the
+        last axis (i.e., ``axis=-1``).
 
     Notes
     -----
@@ -52,41 +134,18 @@ def diff(x,order=1,period=None, _cache=_cache):
     For odd order and even ``len(x)``, the Nyquist mode is taken zero.
 
     """
-    tmp = asarray(x)
     if order == 0:
-        return tmp
-    if iscomplexobj(tmp):
-        return diff(tmp.real,order,period)+1j*diff(tmp.imag,order,period)
-    if period is not None:
-        c = 2*pi/period
-    else:
-        c = 1.0
-    n = len(x)
-    omega = _cache.get((n,order,c))
-    if omega is None:
-        if len(_cache) > 20:
-            while _cache:
-                _cache.popitem()
-
-        def kernel(k,order=order,c=c):
-            if k:
-                return pow(c*k,order)
-            return 0
-        omega = convolve.init_convolution_kernel(n,kernel,d=order,
-                                                 zero_nyquist=1)
-        _cache[(n,order,c)] = omega
-    overwrite_x = _datacopied(tmp, x)
-    return convolve.convolve(tmp,omega,swap_real_imag=order % 2,
-                             overwrite_x=overwrite_x)
-
-
-del _cache
-
+        return asarray(x)
+    c = 1.0 if period is None else 2*pi/period
 
-_cache = {}
+    def kernel(n, k):
+        K = (c*k)**order
+        K[0] = 0
+        return _multipliers(n, K, order, zero_nyquist=1)
+    return _convolve(x, ('diff', order, c), kernel, axis)
 
 
-def tilbert(x, h, period=None, _cache=_cache):
+def tilbert(x, h, period=None, axis=-1):
     """
     Return h-Tilbert transform of a periodic sequence x.
 
@@ -104,6 +163,9 @@ def tilbert(x, h, period=None, _cache=_cache):
         Defines the parameter of the Tilbert transform.
     period : float, optional
         The assumed period of the sequence.  Default period is ``2*pi``.
+    axis : int, optional
+        Axis along which the operator is applied; default is over the
+        last axis (i.e., ``axis=-1``).
 
     Returns
     -------
@@ -122,41 +184,17 @@ def tilbert(x, h, period=None, _cache=_cache):
     For even ``len(x)``, the Nyquist mode of ``x`` is taken zero.
 
     """
-    tmp = asarray(x)
-    if iscomplexobj(tmp):
-        return tilbert(tmp.real, h, period) + \
-               1j * tilbert(tmp.imag, h, period)
-
     if period is not None:
         h = h * 2 * pi / period
 
-    n = len(x)
-    omega = _cache.get((n, h))
-    if omega is None:
-        if len(_cache) > 20:
-            while _cache:
-                _cache.popitem()
-
-        def kernel(k, h=h):
-            if k:
-                return 1.0/tanh(h*k)
-
-            return 0
+    def kernel(n, k):
+        K = 1.0/tanh(h*k)
+        K[0] = 0
+        return _multipliers(n, K, 1)
+    return _convolve(x, ('tilbert', h), kernel, axis)
 
-        omega = convolve.init_convolution_kernel(n, kernel, d=1)
-        _cache[(n,h)] = omega
 
-    overwrite_x = _datacopied(tmp, x)
-    return convolve.convolve(tmp,omega,swap_real_imag=1,overwrite_x=overwrite_x)
-
-
-del _cache
-
-
-_cache = {}
-
-
-def itilbert(x,h,period=None, _cache=_cache):
+def itilbert(x, h, period=None, axis=-1):
     """
     Return inverse h-Tilbert transform of a periodic sequence x.
 
@@ -169,36 +207,15 @@ def itilbert(x,h,period=None, _cache=_cache):
     For more details, see `tilbert`.
 
     """
-    tmp = asarray(x)
-    if iscomplexobj(tmp):
-        return itilbert(tmp.real,h,period) + \
-               1j*itilbert(tmp.imag,h,period)
     if period is not None:
         h = h*2*pi/period
-    n = len(x)
-    omega = _cache.get((n,h))
-    if omega is None:
-        if len(_cache) > 20:
-            while _cache:
-                _cache.popitem()
-
-        def kernel(k,h=h):
-            if k:
-                return -tanh(h*k)
-            return 0
-        omega = convolve.init_convolution_kernel(n,kernel,d=1)
-        _cache[(n,h)] = omega
-    overwrite_x = _datacopied(tmp, x)
-    return convolve.convolve(tmp,omega,swap_real_imag=1,overwrite_x=overwrite_x)
 
+    def kernel(n, k):
+        return _multipliers(n, -tanh(h*k), 1)
+    return _convolve(x, ('itilbert', h), kernel, axis)
 
-del _cache
 
-
-_cache = {}
-
-
-def hilbert(x, _cache=_cache):
+def hilbert(x, axis=-1):
     """
     Return Hilbert transform of a periodic sequence x.
 
@@ -212,8 +229,9 @@ def hilbert(x, _cache=_cache):
     ----------
     x : array_like
         The input array, should be periodic.
-    _cache : dict, optional
-        Dictionary that contains the kernel used to do a convolution with.
+    axis : int, optional
+        Axis along which the operator is applied; default is over the
+        last axis (i.e., ``axis=-1``).
 
     Returns
     -------
@@ -237,32 +255,12 @@ def hilbert(x, _cache=_cache):
     function.
 
     """
-    tmp = asarray(x)
-    if iscomplexobj(tmp):
-        return hilbert(tmp.real)+1j*hilbert(tmp.imag)
-    n = len(x)
-    omega = _cache.get(n)
-    if omega is None:
-        if len(_cache) > 20:
-            while _cache:
-                _cache.popitem()
-
-        def kernel(k):
-            if k > 0:
-                return 1.0
-            elif k < 0:
-                return -1.0
-            return 0.0
-        omega = convolve.init_convolution_kernel(n,kernel,d=1)
-        _cache[n] = omega
-    overwrite_x = _datacopied(tmp, x)
-    return convolve.convolve(tmp,omega,swap_real_imag=1,overwrite_x=overwrite_x)
-
-
-del _cache
-
-
-def ihilbert(x):
+    def kernel(n, k):
+        return _multipliers(n, np.sign(k), 1)
+    return _convolve(x, ('hilbert',), kernel, axis)
+
+
+def ihilbert(x, axis=-1):
     """
     Return inverse Hilbert transform of a periodic sequence x.
 
@@ -273,13 +271,10 @@ def ihilbert(x):
       y_0 = 0
 
     """
-    return -hilbert(x)
-
+    return -hilbert(x, axis)
 
-_cache = {}
 
-
-def cs_diff(x, a, b, period=None, _cache=_cache):
+def cs_diff(x, a, b, period=None, axis=-1):
     """
     Return (a,b)-cosh/sinh pseudo-derivative of a periodic sequence.
 
@@ -298,6 +293,9 @@ def cs_diff(x, a, b, period=None, _cache=_cache):
         operator.
     period : float, optional
         The period of the sequence. Default period is ``2*pi``.
+    axis : int, optional
+        Axis along which the operator is applied; default is over the
+        last axis (i.e., ``axis=-1``).
 
     Returns
     -------
@@ -309,37 +307,18 @@ def cs_diff(x, a, b, period=None, _cache=_cache):
     For even len(`x`), the Nyquist mode of `x` is taken as zero.
 
     """
-    tmp = asarray(x)
-    if iscomplexobj(tmp):
-        return cs_diff(tmp.real,a,b,period) + \
-               1j*cs_diff(tmp.imag,a,b,period)
     if period is not None:
         a = a*2*pi/period
         b = b*2*pi/period
-    n = len(x)
-    omega = _cache.get((n,a,b))
-    if omega is None:
-        if len(_cache) > 20:
-            while _cache:
-                _cache.popitem()
-
-        def kernel(k,a=a,b=b):
-            if k:
-                return -cosh(a*k)/sinh(b*k)
-            return 0
-        omega = convolve.init_convolution_kernel(n,kernel,d=1)
-        _cache[(n,a,b)] = omega
-    overwrite_x = _datacopied(tmp, x)
-    return convolve.convolve(tmp,omega,swap_real_imag=1,overwrite_x=overwrite_x)
-
-
-del _cache
-
 
-_cache = {}
+    def kernel(n, k):
+        K = -cosh(a*k)/sinh(b*k)
+        K[0] = 0
+        return _multipliers(n, K, 1)
+    return _convolve(x, ('cs_diff', a, b), kernel, axis)
 
 
-def sc_diff(x, a, b, period=None, _cache=_cache):
+def sc_diff(x, a, b, period=None, axis=-1):
     """
     Return (a,b)-sinh/cosh pseudo-derivative of a periodic sequence x.
 
@@ -358,6 +337,9 @@ def sc_diff(x, a, b, period=None, _cache=_cache):
         operator.
     period : float, optional
         The period of the sequence x. Default is 2*pi.
+    axis : int, optional
+        Axis along which the operator is applied; default is over the
+        last axis (i.e., ``axis=-1``).
 
     Notes
     -----
@@ -365,37 +347,18 @@ def sc_diff(x, a, b, period=None, _cache=_cache):
     For even ``len(x)``, the Nyquist mode of x is taken as zero.
 
     """
-    tmp = asarray(x)
-    if iscomplexobj(tmp):
-        return sc_diff(tmp.real,a,b,period) + \
-               1j*sc_diff(tmp.imag,a,b,period)
     if period is not None:
         a = a*2*pi/period
         b = b*2*pi/period
-    n = len(x)
-    omega = _cache.get((n,a,b))
-    if omega is None:
-        if len(_cache) > 20:
-            while _cache:
-                _cache.popitem()
-
-        def kernel(k,a=a,b=b):
-            if k:
-                return sinh(a*k)/cosh(b*k)
-            return 0
-        omega = convolve.init_convolution_kernel(n,kernel,d=1)
-        _cache[(n,a,b)] = omega
-    overwrite_x = _datacopied(tmp, x)
-    return convolve.convolve(tmp,omega,swap_real_imag=1,overwrite_x=overwrite_x)
-
 
-del _cache
+    def kernel(n, k):
+        K = sinh(a*k)/cosh(b*k)
+        K[0] = 0
+        return _multipliers(n, K, 1)
+    return _convolve(x, ('sc_diff', a, b), kernel, axis)
 
 
-_cache = {}
-
-
-def ss_diff(x, a, b, period=None, _cache=_cache):
+def ss_diff(x, a, b, period=None, axis=-1):
     """
     Return (a,b)-sinh/sinh pseudo-derivative of a periodic sequence x.
 
@@ -414,43 +377,27 @@ def ss_diff(x, a, b, period=None, _cache=_cache):
         operator.
     period : float, optional
         The period of the sequence x. Default is ``2*pi``.
+    axis : int, optional
+        Axis along which the operator is applied; default is over the
+        last axis (i.e., ``axis=-1``).
 
     Notes
     -----
     ``ss_diff(ss_diff(x,a,b),b,a) == x``
 
     """
-    tmp = asarray(x)
-    if iscomplexobj(tmp):
-        return ss_diff(tmp.real,a,b,period) + \
-               1j*ss_diff(tmp.imag,a,b,period)
     if period is not None:
         a = a*2*pi/period
         b = b*2*pi/period
-    n = len(x)
-    omega = _cache.get((n,a,b))
-    if omega is None:
-        if len(_cache) > 20:
-            while _cache:
-                _cache.popitem()
-
-        def kernel(k,a=a,b=b):
-            if k:
-                return sinh(a*k)/sinh(b*k)
-            return float(a)/b
-        omega = convolve.init_convolution_kernel(n,kernel)
-        _cache[(n,a,b)] = omega
-    overwrite_x = _datacopied(tmp, x)
-    return convolve.convolve(tmp,omega,overwrite_x=overwrite_x)
 
+    def kernel(n, k):
+        K = sinh(a*k)/sinh(b*k)
+        K[0] = float(a)/b
+        return _multipliers(n, K)
+    return _convolve(x, ('ss_diff', a, b), kernel, axis)
 
-del _cache
 
-
-_cache = {}
-
-
-def cc_diff(x, a, b, period=None, _cache=_cache):
+def cc_diff(x, a, b, period=None, axis=-1):
     """
     Return (a,b)-cosh/cosh pseudo-derivative of a periodic sequence.
 
@@ -468,6 +415,9 @@ def cc_diff(x, a, b, period=None, _cache=_cache):
         operator.
     period : float, optional
         The period of the sequence x. Default is ``2*pi``.
+    axis : int, optional
+        Axis along which the operator is applied; default is over the
+        last axis (i.e., ``axis=-1``).
 
     Returns
     -------
@@ -479,35 +429,16 @@ def cc_diff(x, a, b, period=None, _cache=_cache):
     ``cc_diff(cc_diff(x,a,b),b,a) == x``
 
     """
-    tmp = asarray(x)
-    if iscomplexobj(tmp):
-        return cc_diff(tmp.real,a,b,period) + \
-               1j*cc_diff(tmp.imag,a,b,period)
     if period is not None:
         a = a*2*pi/period
         b = b*2*pi/period
-    n = len(x)
-    omega = _cache.get((n,a,b))
-    if omega is None:
-        if len(_cache) > 20:
-            while _cache:
-                _cache.popitem()
-
-        def kernel(k,a=a,b=b):
-            return cosh(a*k)/cosh(b*k)
-        omega = convolve.init_convolution_kernel(n,kernel)
-        _cache[(n,a,b)] = omega
-    overwrite_x = _datacopied(tmp, x)
-    return convolve.convolve(tmp,omega,overwrite_x=overwrite_x)
-
-
-del _cache
-
 
-_cache = {}
+    def kernel(n, k):
+        return _multipliers(n, cosh(a*k)/cosh(b*k))
+    return _convolve(x, ('cc_diff', a, b), kernel, axis)
 
 
-def shift(x, a, period=None, _cache=_cache):
+def shift(x, a, period=None, axis=-1):
     """
     Shift periodic sequence x by a: y(u) = x(u+a).
 
@@ -524,34 +455,15 @@ def shift(x, a, period=None, _cache=_cache):
         Defines the parameters of the sinh/sinh pseudo-differential
     period : float, optional
         The period of the sequences x and y. Default period is ``2*pi``.
+    axis : int, optional
+        Axis along which the operator is applied; default is over the
+        last axis (i.e., ``axis=-1``).
+
     """
-    tmp = asarray(x)
-    if iscomplexobj(tmp):
-        return shift(tmp.real,a,period)+1j*shift(tmp.imag,a,period)
     if period is not None:
         a = a*2*pi/period
-    n = len(x)
-    omega = _cache.get((n,a))
-    if omega is None:
-        if len(_cache) > 20:
-            while _cache:
-                _cache.popitem()
-
-        def kernel_real(k,a=a):
-            return cos(a*k)
-
-        def kernel_imag(k,a=a):
-            return sin(a*k)
-        omega_real = convolve.init_convolution_kernel(n,kernel_real,d=0,
-                                                      zero_nyquist=0)
-        omega_imag = convolve.init_convolution_kernel(n,kernel_imag,d=1,
-                                                      zero_nyquist=0)
-        _cache[(n,a)] = omega_real,omega_imag
-    else:
-        omega_real,omega_imag = omega
-    overwrite_x = _datacopied(tmp, x)
-    return convolve.convolve_z(tmp,omega_real,omega_imag,
-                               overwrite_x=overwrite_x)
-
-
-del _cache
+
+    def kernel(n, k):
+        return (_multipliers(n, cos(a*k), 0, zero_nyquist=0)
+                + _multipliers(n, sin(a*k), 1, zero_nyquist=0))
+    return _convolve(x, ('shift', a), kernel, axis)
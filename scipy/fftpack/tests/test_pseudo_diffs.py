@@ -11,7 +11,7 @@ Run tests if fftpack is not installed:
   python tests/test_pseudo_diffs.py [<level>]
 """
 
-from numpy.testing import (assert_equal, assert_almost_equal,
+from numpy.testing import (assert_, assert_equal, assert_almost_equal,
                            assert_array_almost_equal)
 from scipy.fftpack import (diff, fft, ifft, tilbert, itilbert, hilbert,
                            ihilbert, shift, fftfreq, cs_diff, sc_diff,
@@ -380,3 +380,51 @@ class TestOverwrite(object):
     def test_shift(self):
         for dtype in self.dtypes:
             self._check_1d(shift, dtype, (16,), 1.0)
+
+
+class TestAxis(object):
+    """Check the operators on n-D arrays, and their kernel cache"""
+
+    routines = [(diff, ()), (diff, (3,)), (diff, (-2,)), (tilbert, (1.6,)),
+                (itilbert, (1.6,)), (hilbert, ()), (ihilbert, ()),
+                (cs_diff, (1.0, 4.0)), (sc_diff, (1.0, 4.0)),
+                (ss_diff, (1.0, 4.0)), (cc_diff, (1.0, 4.0)), (shift, (1.0,))]
+
+    def test_axis(self):
+        np.random.seed(1234)
+        for shape in [(16, 5, 3), (17, 4, 2)]:
+            x = np.random.randn(*shape) + 1j*np.random.randn(*shape)
+            for routine, args in self.routines:
+                for axis in range(3):
+                    y = routine(x, *args, axis=axis)
+                    xt = np.moveaxis(x, axis, -1).reshape(-1, shape[axis])
+                    expected = np.array([routine(row, *args) for row in xt])
+                    yt = np.moveaxis(y, axis, -1).reshape(-1, shape[axis])
+                    assert_array_almost_equal(yt, expected)
+
+                    y2 = routine(x, *args, axis=axis - 3)
+                    assert_equal(y2, y)
+
+    def test_threads(self):
+        import threading
+        from scipy.fftpack import pseudo_diffs
+
+        x = np.random.randn(8, 64)
+        expected = [diff(x, k % 3 + 1, period=k + 1) for k in range(80)]
+        results = [None] * 80
+
+        def worker(start):
+            for k in range(start, 80, 4):
+                results[k] = diff(x, k % 3 + 1, period=k + 1)
+
+        threads = [threading.Thread(target=worker, args=(i,))
+                   for i in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        for k in range(80):
+            assert_equal(results[k], expected[k])
+
+        cache = pseudo_diffs._kernels
+        assert_(len(cache._kernels) <= cache.maxsize)
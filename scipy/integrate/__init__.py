@@ -13,6 +13,7 @@ Integrating functions, given function object
 
    quad          -- General purpose integration
    quad_vec      -- General purpose integration of vector-valued functions
+   quad_vec_batch -- Integration of batches of vector-valued functions
    dblquad       -- General purpose double integration
    tplquad       -- General purpose triple integration
    nquad         -- General purpose n-dimensional integration
@@ -50,6 +51,7 @@ The solvers are implemented as individual classes which can be used directly
    :toctree: generated/
 
    solve_ivp     -- Convenient function for ODE integration.
+   solve_ivp_ensemble -- ODE integration of many independent systems.
    RK23          -- Explicit Runge-Kutta solver of order 3(2).
    RK45          -- Explicit Runge-Kutta solver of order 5(4).
    Radau         -- Implicit Runge-Kutta solver of order 5.
@@ -92,9 +94,9 @@ from .odepack import *
 from .quadpack import *
 from ._ode import *
 from ._bvp import solve_bvp
-from ._ivp import (solve_ivp, OdeSolution, DenseOutput,
+from ._ivp import (solve_ivp, solve_ivp_ensemble, OdeSolution, DenseOutput,
                    OdeSolver, RK23, RK45, Radau, BDF, LSODA)
-from ._quad_vec import quad_vec
+from ._quad_vec import quad_vec, quad_vec_batch
 
 __all__ = [s for s in dir() if not s.startswith('_')]
 
@@ -8,6 +8,7 @@
   {"_qawfe", quadpack_qawfe, METH_VARARGS, doc_qawfe},
   {"_qawse", quadpack_qawse, METH_VARARGS, doc_qawse},
   {"_qawce", quadpack_qawce, METH_VARARGS, doc_qawce},
+  {"_qvec_batch", quadpack_qvec_batch, METH_VARARGS, doc_qvec_batch},
  */
 /* link libraries: (should be listed in separate lines)
    quadpack
@@ -24,6 +25,7 @@
 #include <setjmp.h>
 
 #include "ccallback.h"
+#include "qvec_batch.h"
 
 #include "numpy/arrayobject.h"
 
@@ -956,3 +958,162 @@ static PyObject *quadpack_qawse(PyObject *dummy, PyObject *args) {
   Py_XDECREF(ap_iord);
   return NULL;
 }
+
+
+static ccallback_signature_t qvec_batch_signatures[] = {
+    {"int (npy_intp, npy_intp, double *, npy_intp, double *, void *)"},
+    {"int (intptr_t, intptr_t, double *, intptr_t, double *, void *)"},
+#if NPY_SIZEOF_LONG == NPY_SIZEOF_INTP
+    {"int (long, long, double *, long, double *, void *)"},
+#endif
+#if NPY_SIZEOF_LONGLONG == NPY_SIZEOF_INTP
+    {"int (long long, long long, double *, long long, double *, void *)"},
+#endif
+    {NULL}
+};
+
+
+/* Evaluates a Python function fun(k, x) returning an (npoints, nout) array */
+static int qvec_batch_py_thunk(ptrdiff_t k, ptrdiff_t npoints, const double *x,
+                               ptrdiff_t nout, double *f, void *data)
+{
+    ccallback_t *callback = (ccallback_t *)data;
+    PyObject *ap_x = NULL, *res = NULL;
+    PyArrayObject *ap_f = NULL;
+    npy_intp dims[1];
+    int error = -1;
+
+    /* stop at the first exception, the remaining integrals are abandoned */
+    if (PyErr_Occurred()) {
+        return -1;
+    }
+
+    dims[0] = npoints;
+    ap_x = PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+    if (ap_x == NULL) {
+        goto done;
+    }
+    memcpy(PyArray_DATA((PyArrayObject *)ap_x), x, npoints * sizeof(double));
+
+    res = PyObject_CallFunction(callback->py_function, "nO", (Py_ssize_t)k,
+                                ap_x);
+    if (res == NULL) {
+        goto done;
+    }
+
+    ap_f = (PyArrayObject *)PyArray_ContiguousFromObject(res, NPY_DOUBLE, 0, 2);
+    if (ap_f == NULL) {
+        goto done;
+    }
+    if (PyArray_SIZE(ap_f) != npoints * nout) {
+        PyErr_Format(PyExc_ValueError,
+                     "integrand returned %" NPY_INTP_FMT " values, "
+                     "expected an array of shape (%" NPY_INTP_FMT
+                     ", %" NPY_INTP_FMT ")",
+                     (npy_intp)PyArray_SIZE(ap_f), (npy_intp)npoints,
+                     (npy_intp)nout);
+        goto done;
+    }
+    memcpy(f, PyArray_DATA(ap_f), npoints * nout * sizeof(double));
+    error = 0;
+
+done:
+    Py_XDECREF(ap_x);
+    Py_XDECREF(res);
+    Py_XDECREF(ap_f);
+    return error;
+}
+
+
+static int qvec_batch_c_thunk(ptrdiff_t k, ptrdiff_t npoints, const double *x,
+                              ptrdiff_t nout, double *f, void *data)
+{
+    ccallback_t *callback = (ccallback_t *)data;
+
+    return ((int(*)(npy_intp, npy_intp, double *, npy_intp, double *, void *))
+            callback->c_function)(k, npoints, (double *)x, nout, f,
+                                  callback->user_data);
+}
+
+
+static char doc_qvec_batch[] = "[result,abserr,neval,status] = _qvec_batch(fun, a, b, nout, epsabs, epsrel, max_norm, limit, nthreads)";
+
+static PyObject *quadpack_qvec_batch(PyObject *dummy, PyObject *args) {
+
+  PyObject *fcn, *a_obj, *b_obj;
+  PyArrayObject *ap_a = NULL, *ap_b = NULL;
+  PyArrayObject *ap_result = NULL, *ap_abserr = NULL;
+  PyArrayObject *ap_neval = NULL, *ap_status = NULL;
+  npy_intp nint, nout, limit, dims[2];
+  double   epsabs, epsrel;
+  int      max_norm, nthreads, ret;
+  ccallback_t callback;
+
+  if (!PyArg_ParseTuple(args, "OOOnddini", &fcn, &a_obj, &b_obj, &nout, &epsabs, &epsrel, &max_norm, &limit, &nthreads)) return NULL;
+
+  if (nout < 1 || limit < 1) {
+      PyErr_SetString(PyExc_ValueError, "nout and limit must be positive");
+      return NULL;
+  }
+
+  ap_a = (PyArrayObject *)PyArray_ContiguousFromObject(a_obj, NPY_DOUBLE, 1, 1);
+  ap_b = (PyArrayObject *)PyArray_ContiguousFromObject(b_obj, NPY_DOUBLE, 1, 1);
+  if (ap_a == NULL || ap_b == NULL) goto fail_free;
+  nint = PyArray_DIM(ap_a, 0);
+  if (PyArray_DIM(ap_b, 0) != nint) {
+      PyErr_SetString(PyExc_ValueError, "a and b must have the same length");
+      goto fail_free;
+  }
+
+  dims[0] = nint;
+  dims[1] = nout;
+  ap_result = (PyArrayObject *)PyArray_SimpleNew(2, dims, NPY_DOUBLE);
+  ap_abserr = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+  ap_neval = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_INTP);
+  ap_status = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_INT);
+  if (ap_result == NULL || ap_abserr == NULL || ap_neval == NULL || ap_status == NULL) goto fail_free;
+
+  ret = ccallback_prepare(&callback, qvec_batch_signatures, fcn, CCALLBACK_DEFAULTS);
+  if (ret == -1) goto fail_free;
+
+  if (callback.py_function != NULL) {
+      /* Python integrands need the GIL, so they are run on one thread */
+      ret = qvec_batch(nint, nout, (double *)PyArray_DATA(ap_a),
+                       (double *)PyArray_DATA(ap_b), qvec_batch_py_thunk,
+                       &callback, epsabs, epsrel, max_norm, limit, 1,
+                       (double *)PyArray_DATA(ap_result),
+                       (double *)PyArray_DATA(ap_abserr),
+                       (npy_intp *)PyArray_DATA(ap_neval),
+                       (int *)PyArray_DATA(ap_status));
+  }
+  else {
+      Py_BEGIN_ALLOW_THREADS
+      ret = qvec_batch(nint, nout, (double *)PyArray_DATA(ap_a),
+                       (double *)PyArray_DATA(ap_b), qvec_batch_c_thunk,
+                       &callback, epsabs, epsrel, max_norm, limit, nthreads,
+                       (double *)PyArray_DATA(ap_result),
+                       (double *)PyArray_DATA(ap_abserr),
+                       (npy_intp *)PyArray_DATA(ap_neval),
+                       (int *)PyArray_DATA(ap_status));
+      Py_END_ALLOW_THREADS
+  }
+
+  if (ccallback_release(&callback) != 0 || PyErr_Occurred()) goto fail_free;
+  if (ret == QVEC_NOMEM) {
+      PyErr_SetString(PyExc_MemoryError, "failed to allocate memory");
+      goto fail_free;
+  }
+
+  Py_DECREF(ap_a);
+  Py_DECREF(ap_b);
+  return Py_BuildValue("NNNN", PyArray_Return(ap_result), PyArray_Return(ap_abserr), PyArray_Return(ap_neval), PyArray_Return(ap_status));
+
+ fail_free:
+  Py_XDECREF(ap_a);
+  Py_XDECREF(ap_b);
+  Py_XDECREF(ap_result);
+  Py_XDECREF(ap_abserr);
+  Py_XDECREF(ap_neval);
+  Py_XDECREF(ap_status);
+  return NULL;
+}
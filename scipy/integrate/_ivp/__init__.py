@@ -2,6 +2,7 @@
 from __future__ import division, print_function, absolute_import
 
 from .ivp import solve_ivp
+from .ensemble import solve_ivp_ensemble
 from .rk import RK23, RK45
 from .radau import Radau
 from .bdf import BDF
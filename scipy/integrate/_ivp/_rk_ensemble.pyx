@@ -0,0 +1,103 @@
+"""
+Compiled kernels for ensembles of explicit Runge-Kutta integrations
+
+The states of ``m`` independent systems of size ``n`` are stacked into
+``(m, n)`` arrays and the RK stages into an ``(n_stages + 1, m, n)``
+array ``K``. Each system has its own step ``h[i]``; systems that do not
+take a step have ``h[i] = 0``. Used by ``ensemble.py``.
+
+"""
+#
+# Distributed under the same BSD license as Scipy.
+#
+
+from __future__ import absolute_import
+
+cimport cython
+from libc.math cimport sqrt, fabs
+
+__all__ = ['rk_stage', 'rk_error_norm', 'rk_dense_eval']
+
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+def rk_stage(const double[:, :] y, const double[:, :, :] K, Py_ssize_t s,
+             const double[:] a, const double[:] h, double[:, :] out):
+    """
+    ``out[i] = y[i] + h[i] * sum(a[j] * K[j, i] for j < s)``.
+    """
+    cdef Py_ssize_t i, j, c
+    cdef Py_ssize_t m = y.shape[0], n = y.shape[1]
+    cdef double acc
+
+    with nogil:
+        for i in range(m):
+            for c in range(n):
+                acc = 0
+                for j in range(s):
+                    acc = acc + a[j] * K[j, i, c]
+                out[i, c] = y[i, c] + h[i] * acc
+
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+@cython.cdivision(True)
+def rk_error_norm(const double[:, :] y, const double[:, :] y_new,
+                  const double[:, :, :] K, const double[:] E,
+                  const double[:] h, double rtol, const double[:] atol,
+                  double[:] out):
+    """
+    RMS norms of the error estimates ``h[i] * sum(E[j] * K[j, i])``,
+    relative to ``atol + max(|y[i]|, |y_new[i]|) * rtol``.
+    """
+    cdef Py_ssize_t i, j, c
+    cdef Py_ssize_t m = y.shape[0], n = y.shape[1], ns = E.shape[0]
+    cdef double acc, scale, s
+
+    with nogil:
+        for i in range(m):
+            s = 0
+            for c in range(n):
+                acc = 0
+                for j in range(ns):
+                    acc = acc + E[j] * K[j, i, c]
+                scale = fabs(y[i, c])
+                if fabs(y_new[i, c]) > scale:
+                    scale = fabs(y_new[i, c])
+                scale = atol[c] + scale * rtol
+                acc = h[i] * acc / scale
+                s = s + acc * acc
+            out[i] = sqrt(s / n) if n > 0 else 0
+
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+@cython.cdivision(True)
+def rk_dense_eval(const double[:, :] y_old, const double[:, :, :] K,
+                  const double[:, :] P, const double[:] t_old,
+                  const double[:] h, const double[:] t_eval,
+                  const Py_ssize_t[:] start, const Py_ssize_t[:] stop,
+                  double[:, :, :] out):
+    """
+    Evaluates the dense output of the step from ``t_old[i]`` of length
+    ``h[i]`` at ``t_eval[start[i]:stop[i]]``, into ``out[i, :, k]``.
+    """
+    cdef Py_ssize_t i, j, c, k, p
+    cdef Py_ssize_t m = y_old.shape[0], n = y_old.shape[1]
+    cdef Py_ssize_t ns = P.shape[0], order = P.shape[1]
+    cdef double x, xp, q, acc
+
+    with nogil:
+        for i in range(m):
+            for k in range(start[i], stop[i]):
+                x = (t_eval[k] - t_old[i]) / h[i]
+                for c in range(n):
+                    acc = 0
+                    xp = x
+                    for p in range(order):
+                        q = 0
+                        for j in range(ns):
+                            q = q + K[j, i, c] * P[j, p]
+                        acc = acc + q * xp
+                        xp = xp * x
+                    out[i, c, k] = y_old[i, c] + h[i] * acc
@@ -0,0 +1,271 @@
+from __future__ import division, print_function, absolute_import
+import numpy as np
+from .rk import RK23, RK45, SAFETY, MIN_FACTOR, MAX_FACTOR
+from .common import validate_max_step, validate_tol, validate_first_step
+from .ivp import OdeResult
+from ._rk_ensemble import rk_stage, rk_error_norm, rk_dense_eval
+
+
+METHODS = {'RK23': RK23,
+           'RK45': RK45}
+
+
+MESSAGES = {0: "All systems reached the end of the integration interval.",
+            -1: "Integration step failed for some systems."}
+
+
+def _norm(x):
+    """Compute the RMS norm of each row."""
+    return np.sqrt(np.mean(x**2, axis=1))
+
+
+def _select_initial_step(fun, t0, y0, f0, direction, order, rtol, atol):
+    """Select initial steps like `select_initial_step`, for each system."""
+    if y0.shape[1] == 0:
+        return np.full(y0.shape[0], np.inf)
+
+    scale = atol + np.abs(y0) * rtol
+    d0 = _norm(y0 / scale)
+    d1 = _norm(f0 / scale)
+    with np.errstate(divide='ignore', invalid='ignore'):
+        h0 = np.where((d0 < 1e-5) | (d1 < 1e-5), 1e-6, 0.01 * d0 / d1)
+
+    y1 = y0 + (h0 * direction)[:, None] * f0
+    f1 = fun(t0 + h0 * direction, y1)
+    d2 = _norm((f1 - f0) / scale) / h0
+
+    with np.errstate(divide='ignore'):
+        h1 = np.where((d1 <= 1e-15) & (d2 <= 1e-15),
+                      np.maximum(1e-6, h0 * 1e-3),
+                      (0.01 / np.maximum(d1, d2)) ** (1 / (order + 1)))
+
+    return np.minimum(100 * h0, h1)
+
+
+def solve_ivp_ensemble(fun, t_span, y0, method='RK45', t_eval=None,
+                       args=None, max_step=np.inf, rtol=1e-3, atol=1e-6,
+                       first_step=None):
+    """Solve initial value problems for an ensemble of independent systems.
+
+    Integrates ``m`` systems ``dy_i / dt = f(t, y_i)`` of size ``n`` from
+    the same ``t_span``, typically with different initial values or
+    parameters. Each system takes its own adaptive steps as in `solve_ivp`,
+    but the steps of all the systems are taken together: the right-hand
+    side is called once per Runge-Kutta stage for the whole ensemble, and
+    the Runge-Kutta arithmetic is done in compiled code.
+
+    Parameters
+    ----------
+    fun : callable
+        Right-hand side of the systems. The calling signature is
+        ``fun(t, y)``, where ``t`` has shape (m,) and ``y`` has shape
+        (m, n), and it must return an array_like of shape (m, n) whose
+        row ``i`` is the derivative of system ``i`` at ``t[i]``. Rows of
+        systems which are not stepping are computed but not used.
+    t_span : 2-tuple of floats
+        Interval of integration (t0, tf).
+    y0 : array_like, shape (m, n)
+        Initial states.
+    method : {'RK45', 'RK23'}, optional
+        Explicit Runge-Kutta method to use, as in `solve_ivp`.
+    t_eval : array_like or None, optional
+        Times at which to store the solutions, sorted and within `t_span`.
+        If None (default), only the final states are returned.
+    args : tuple, optional
+        Additional arguments to pass to `fun`.
+    max_step : float, optional
+        Maximum allowed step size. Default is np.inf.
+    rtol, atol : float or array_like, optional
+        Relative and absolute tolerances, as in `solve_ivp`. `atol` may
+        have shape (n,).
+    first_step : float or None, optional
+        Initial step size. Default is None, which selects one for each
+        system.
+
+    Returns
+    -------
+    Bunch object with the following fields defined:
+    t : ndarray
+        Time points: `t_eval` if given, otherwise the final time of each
+        system, of shape (m,).
+    y : ndarray
+        Values of the solutions, of shape (m, n, n_points) if `t_eval` is
+        given, otherwise the final states, of shape (m, n). Values at
+        `t_eval` beyond the point where a system failed are nan.
+    nfev : int
+        Number of evaluations of `fun`, each for the whole ensemble.
+    nstep : ndarray, shape (m,)
+        Number of accepted steps of each system.
+    status : ndarray, shape (m,)
+        Reason for the termination of each system:
+
+            * -1: Integration step failed.
+            *  0: The system reached the end of `tspan`.
+
+    message : string
+        Human readable description of the termination reason.
+    success : bool
+        True if all the systems reached the end of `tspan`.
+
+    See Also
+    --------
+    solve_ivp : Solve an initial value problem for one system.
+
+    Notes
+    -----
+    The systems stop stepping as soon as they reach the end of the
+    interval or fail, so that the time step sequence of each of them is
+    the one `solve_ivp` would take with the same method.
+
+    .. versionadded:: 1.4.0
+
+    Examples
+    --------
+    Exponential decay for a range of rates:
+
+    >>> from scipy.integrate import solve_ivp_ensemble
+    >>> k = np.linspace(0.1, 1, 4)
+    >>> def fun(t, y):
+    ...     return -k[:, None] * y
+    >>> sol = solve_ivp_ensemble(fun, [0, 10], np.ones((4, 1)), rtol=1e-6)
+    >>> np.abs(sol.y[:, 0] - np.exp(-10 * k)).max() < 1e-6
+    True
+
+    """
+    if method not in METHODS:
+        raise ValueError("`method` must be one of {}.".format(list(METHODS)))
+    solver = METHODS[method]
+
+    t0, tf = float(t_span[0]), float(t_span[1])
+    direction = np.sign(tf - t0) if tf != t0 else 1
+
+    y0 = np.asarray(y0)
+    if np.issubdtype(y0.dtype, np.complexfloating):
+        raise ValueError("`y0` must be real.")
+    y0 = y0.astype(float)
+    if y0.ndim != 2:
+        raise ValueError("`y0` must be 2-dimensional.")
+    m, n = y0.shape
+
+    if args is not None:
+        fun_args = fun
+        fun = lambda t, y: fun_args(t, y, *args)
+
+    nfev = [0]
+
+    def fun_ensemble(t, y):
+        nfev[0] += 1
+        f = np.asarray(fun(t, y), dtype=float)
+        if f.shape != (m, n):
+            raise ValueError("`fun` must return an array of shape {}, got {}."
+                             .format((m, n), f.shape))
+        return f
+
+    if t_eval is not None:
+        t_eval = np.asarray(t_eval, dtype=float)
+        if t_eval.ndim != 1:
+            raise ValueError("`t_eval` must be 1-dimensional.")
+
+        if np.any(t_eval < min(t0, tf)) or np.any(t_eval > max(t0, tf)):
+            raise ValueError("Values in `t_eval` are not within `t_span`.")
+
+        d = np.diff(t_eval)
+        if tf > t0 and np.any(d <= 0) or tf < t0 and np.any(d >= 0):
+            raise ValueError("Values in `t_eval` are not properly sorted.")
+
+        ys = np.full((m, n, t_eval.size), np.nan)
+        ys[:, :, t_eval == t0] = y0[:, :, None]
+        # t_eval[:t_eval_i[k]] holds the points passed by system k
+        t_eval_i = np.full(m, np.searchsorted(direction * t_eval,
+                                              direction * t0, side='right'),
+                           dtype=np.intp)
+
+    max_step = validate_max_step(max_step)
+    rtol, atol = validate_tol(rtol, atol, n)
+    atol = np.ascontiguousarray(np.broadcast_to(atol, (n,)), dtype=float)
+    order = solver.order
+    A = [np.asarray(a, dtype=float) for a in solver.A]
+    B = np.asarray(solver.B, dtype=float)
+    C = np.asarray(solver.C, dtype=float)
+    E = np.asarray(solver.E, dtype=float)
+    P = np.asarray(solver.P, dtype=float)
+
+    t = np.full(m, t0)
+    y = y0.copy()
+    f = fun_ensemble(t, y)
+    if first_step is None:
+        h_abs = _select_initial_step(fun_ensemble, t, y, f, direction, order,
+                                     rtol, atol)
+    else:
+        h_abs = np.full(m, validate_first_step(first_step, t0, tf))
+
+    status = np.zeros(m, dtype=int)
+    nstep = np.zeros(m, dtype=np.intp)
+    active = t != tf
+    rejected = np.zeros(m, dtype=bool)
+
+    K = np.empty((solver.n_stages + 1, m, n))
+    y_stage = np.empty((m, n))
+    y_new = np.empty((m, n))
+    error_norm = np.empty(m)
+
+    while np.any(active):
+        min_step = 10 * np.abs(np.nextafter(t, direction * np.inf) - t)
+
+        # as in RungeKutta._step_impl, a new step is clipped to the
+        # allowed range, and a retried one fails if it has become too small
+        new = active & ~rejected
+        h_abs[new] = np.minimum(np.maximum(h_abs[new], min_step[new]),
+                                max_step)
+        failed = rejected & (h_abs < min_step)
+        status[failed] = -1
+        active &= ~failed
+        rejected &= ~failed
+        if not np.any(active):
+            break
+
+        t_new = np.where(active, t + h_abs * direction, t)
+        t_new[direction * (t_new - tf) > 0] = tf
+        h = t_new - t
+
+        K[0] = f
+        for s, (a, c) in enumerate(zip(A, C), start=1):
+            rk_stage(y, K, s, a, h, y_stage)
+            K[s] = fun_ensemble(t + c * h, y_stage)
+        rk_stage(y, K, solver.n_stages, B, h, y_new)
+        K[-1] = fun_ensemble(t + h, y_new)
+        rk_error_norm(y, y_new, K, E, h, rtol, atol, error_norm)
+
+        h_abs = np.abs(h)
+        accepted = active & (error_norm < 1)
+        rejected = active & ~accepted
+        with np.errstate(divide='ignore', invalid='ignore'):
+            factor = SAFETY * error_norm ** (-1 / (order + 1))
+        h_abs[accepted] *= np.where(
+            error_norm[accepted] == 0, MAX_FACTOR,
+            np.minimum(MAX_FACTOR, np.maximum(1, factor[accepted])))
+        h_abs[rejected] *= np.fmax(MIN_FACTOR, factor[rejected])
+
+        if t_eval is not None:
+            t_eval_stop = np.where(
+                accepted, np.searchsorted(direction * t_eval,
+                                          direction * t_new, side='right'),
+                t_eval_i)
+            rk_dense_eval(y, K, P, t, h, t_eval, t_eval_i, t_eval_stop, ys)
+            t_eval_i = t_eval_stop
+
+        t[accepted] = t_new[accepted]
+        y[accepted] = y_new[accepted]
+        f[accepted] = K[-1, accepted]
+        nstep[accepted] += 1
+        active &= t != tf
+
+    if t_eval is None:
+        ts = t
+        ys = y
+    else:
+        ts = t_eval
+
+    status_all = -1 if np.any(status == -1) else 0
+    return OdeResult(t=ts, y=ys, nfev=nfev[0], nstep=nstep, status=status,
+                     message=MESSAGES[status_all], success=status_all == 0)
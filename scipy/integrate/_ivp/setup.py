@@ -0,0 +1,17 @@
+from __future__ import division, print_function, absolute_import
+
+
+def configuration(parent_package='', top_path=None):
+    from numpy.distutils.misc_util import Configuration
+
+    config = Configuration('_ivp', parent_package, top_path)
+
+    config.add_extension('_rk_ensemble',
+                         sources=['_rk_ensemble.c'])
+
+    return config
+
+
+if __name__ == '__main__':
+    from numpy.distutils.core import setup
+    setup(**configuration(top_path='').todict())
@@ -29,8 +29,11 @@ the result tuple when the full_output argument is non-zero.
 */
 
 #include "Python.h"
+#include <setjmp.h>
 #include "numpy/npy_3kcompat.h"
 
+#include "ccallback.h"
+
 #include "numpy/arrayobject.h"
 
 #define PYERR(errobj,message) {\
@@ -360,6 +363,114 @@ ode_jacobian_function(int *n, double *t, double *y, int *ml, int *mu,
 }
 
 
+/*
+ * LowLevelCallable versions of func and Dfun. The Jacobian callback is
+ * stored in the info_p field of the callback of func, which ode_function_c
+ * and ode_jacobian_function_c obtain from thread-local storage.
+ *
+ * func computes ydot = f(t, y), and Dfun stores df_i/dy_j in pd in the
+ * Fortran layout of LSODA: in pd[i + j*nrowpd] for a full Jacobian, and in
+ * pd[i - j + mu + j*nrowpd] for a banded one. A nonzero return value stops
+ * the integration.
+ */
+
+static ccallback_signature_t odeint_signatures[] = {
+    {"int (int, double, double *, double *, void *)"},
+    {NULL}
+};
+
+static ccallback_signature_t odeint_jac_signatures[] = {
+    {"int (int, double, double *, double *, int, void *)", 1},
+    {"int (int, double, double *, int, int, double *, int, void *)", 4},
+    {NULL}
+};
+
+
+static void
+ode_function_c(int *n, double *t, double *y, double *ydot)
+{
+    ccallback_t *callback = ccallback_obtain();
+
+    if (((int (*)(int, double, double *, double *, void *))
+            callback->c_function)(*n, *t, y, ydot, callback->user_data)) {
+        longjmp(callback->error_buf, 1);
+    }
+}
+
+
+static int
+ode_jacobian_function_c(int *n, double *t, double *y, int *ml, int *mu,
+                        double *pd, int *nrowpd)
+{
+    ccallback_t *callback = ccallback_obtain();
+    ccallback_t *jac = (ccallback_t *)callback->info_p;
+    int ret;
+
+    if (jac->signature->value == 4) {
+        ret = ((int (*)(int, double, double *, int, int, double *, int,
+                        void *))jac->c_function)(*n, *t, y, *ml, *mu, pd,
+                                                 *nrowpd, jac->user_data);
+    }
+    else {
+        ret = ((int (*)(int, double, double *, double *, int, void *))
+               jac->c_function)(*n, *t, y, pd, *nrowpd, jac->user_data);
+    }
+    if (ret) {
+        longjmp(callback->error_buf, 1);
+    }
+    return 0;
+}
+
+
+/*
+ * Prepares callback (and jac_callback) if func is a LowLevelCallable.
+ * Returns 1 if it is, 0 if func is a Python function and -1 on error.
+ */
+static int
+init_lowlevel_callbacks(ccallback_t *callback, ccallback_t *jac_callback,
+                        PyObject *fcn, PyObject *Dfun, PyObject *extra_args,
+                        int jt)
+{
+    /* LowLevelCallable is a tuple subclass */
+    if (PyCallable_Check(fcn) || !PyTuple_Check(fcn)) {
+        return 0;
+    }
+    if (ccallback_prepare(callback, odeint_signatures, fcn,
+                          CCALLBACK_OBTAIN) != 0) {
+        return -1;
+    }
+    callback->info_p = NULL;
+
+    if (PyTuple_GET_SIZE(extra_args) != 0) {
+        PyErr_SetString(PyExc_ValueError,
+                        "args cannot be passed to a LowLevelCallable; "
+                        "use its user_data instead.");
+        ccallback_release(callback);
+        return -1;
+    }
+
+    if (Dfun != Py_None) {
+        if (ccallback_prepare(jac_callback, odeint_jac_signatures, Dfun,
+                              CCALLBACK_DEFAULTS) != 0) {
+            ccallback_release(callback);
+            return -1;
+        }
+        if (jac_callback->py_function != NULL ||
+                jac_callback->signature->value != jt) {
+            PyErr_Format(PyExc_ValueError,
+                         "Dfun must be a LowLevelCallable with the signature "
+                         "%s when func is a LowLevelCallable.",
+                         odeint_jac_signatures[jt == 4].signature);
+            ccallback_release(jac_callback);
+            ccallback_release(callback);
+            return -1;
+        }
+        callback->info_p = (void *)jac_callback;
+    }
+    return 1;
+}
+
+
 int
 setup_extra_inputs(PyArrayObject **ap_rtol, PyObject *o_rtol,
                    PyArrayObject **ap_atol, PyObject *o_atol,
@@ -505,6 +616,8 @@ odepack_odeint(PyObject *dummy, PyObject *args, PyObject *kwdict)
                              "h0", "hmax", "hmin", "ixpr", "mxstep", "mxhnil",
                              "mxordn", "mxords", "tfirst", NULL};
     odepack_params save_params;
+    ccallback_t callback, jac_callback;
+    int lowlevel = 0, lowlevel_error;
 
     if (!PyArg_ParseTupleAndKeywords(args, kwdict, "OOO|OOiiiiOOOdddiiiiii", kwlist,
                                      &fcn, &y0, &p_tout, &extra_args, &Dfun,
@@ -555,7 +668,15 @@ odepack_odeint(PyObject *dummy, PyObject *args, PyObject *kwdict)
     if (!PyTuple_Check(extra_args)) {
         PYERR(odepack_error, "Extra arguments must be in a tuple");
     }
-    if (!PyCallable_Check(fcn) || (Dfun != Py_None && !PyCallable_Check(Dfun))) {
+
+    lowlevel = init_lowlevel_callbacks(&callback, &jac_callback, fcn, Dfun,
+                                       extra_args, jt);
+    if (lowlevel < 0) {
+        lowlevel = 0;
+        goto fail;
+    }
+    if (!lowlevel && (!PyCallable_Check(fcn) ||
+                      (Dfun != Py_None && !PyCallable_Check(Dfun)))) {
         PYERR(odepack_error, "The function and its Jacobian must be callable functions.");
     }
 
@@ -695,9 +816,32 @@ odepack_odeint(PyObject *dummy, PyObject *args, PyObject *kwdict)
             itask = 1;  /* No more critical values */
         }
 
-        LSODA(ode_function, &neq, y, &t, tout_ptr, &itol, rtol, atol, &itask,
-              &istate, &iopt, rwork, &lrw, iwork, &liw,
-              ode_jacobian_function, &jt);
+        if (lowlevel) {
+            lowlevel_error = 0;
+            /* the callbacks need neither the GIL nor global_params */
+#ifdef CCALLBACK_NATIVE_TLS
+            Py_BEGIN_ALLOW_THREADS
+#endif
+            if (setjmp(callback.error_buf) == 0) {
+                LSODA(ode_function_c, &neq, y, &t, tout_ptr, &itol, rtol,
+                      atol, &itask, &istate, &iopt, rwork, &lrw, iwork, &liw,
+                      ode_jacobian_function_c, &jt);
+            }
+            else {
+                lowlevel_error = 1;
+            }
+#ifdef CCALLBACK_NATIVE_TLS
+            Py_END_ALLOW_THREADS
+#endif
+            if (lowlevel_error) {
+                PYERR(odepack_error, "The LowLevelCallable returned an error.");
+            }
+        }
+        else {
+            LSODA(ode_function, &neq, y, &t, tout_ptr, &itol, rtol, atol,
+                  &itask, &istate, &iopt, rwork, &lrw, iwork, &liw,
+                  ode_jacobian_function, &jt);
+        }
         if (full_output) {
             *((double *)PyArray_DATA(ap_hu) + (k-1)) = rwork[10];
             *((double *)PyArray_DATA(ap_tcur) + (k-1)) = rwork[12];
@@ -728,6 +872,13 @@ odepack_odeint(PyObject *dummy, PyObject *args, PyObject *kwdict)
     /* Restore global_params from the previously stashed save_params. */
     memcpy(&global_params, &save_params, sizeof(save_params));
 
+    if (lowlevel) {
+        if (Dfun != Py_None) {
+            ccallback_release(&jac_callback);
+        }
+        ccallback_release(&callback);
+    }
+
     Py_DECREF(extra_args);
     Py_DECREF(ap_atol);
     Py_DECREF(ap_rtol);
@@ -762,6 +913,13 @@ fail:
     /* Restore global_params from the previously stashed save_params. */
     memcpy(&global_params, &save_params, sizeof(save_params));
 
+    if (lowlevel) {
+        if (Dfun != Py_None) {
+            ccallback_release(&jac_callback);
+        }
+        ccallback_release(&callback);
+    }
+
     Py_XDECREF(extra_args);
     Py_XDECREF(ap_y);
     Py_XDECREF(ap_rtol);
@@ -11,6 +11,7 @@ static struct PyMethodDef quadpack_module_methods[] = {
 {"_qawfe", quadpack_qawfe, METH_VARARGS, doc_qawfe},
 {"_qawse", quadpack_qawse, METH_VARARGS, doc_qawse},
 {"_qawce", quadpack_qawce, METH_VARARGS, doc_qawce},
+{"_qvec_batch", quadpack_qvec_batch, METH_VARARGS, doc_qvec_batch},
 {NULL,		NULL, 0, NULL}
 };
 
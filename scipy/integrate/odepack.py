@@ -54,10 +54,20 @@ def odeint(func, y0, t, args=(), Dfun=None, col_deriv=0, full_output=0,
 
     Parameters
     ----------
-    func : callable(y, t, ...) or callable(t, y, ...)
+    func : callable(y, t, ...) or callable(t, y, ...) or LowLevelCallable
         Computes the derivative of y at t.
         If the signature is ``callable(t, y, ...)``, then the argument
         `tfirst` must be set ``True``.
+        A `LowLevelCallable` must have the signature::
+
+            int func(int n, double t, double *y, double *ydot,
+                     void *user_data)
+
+        store the derivative in ``ydot`` and return 0; any other return
+        value stops the integration with an error. The integration is then
+        carried out without the GIL, and `args` cannot be given.
+
+        .. versionadded:: 1.4.0
     y0 : array
         Initial condition on y (can be a vector).
     t : array
@@ -67,10 +77,26 @@ def odeint(func, y0, t, args=(), Dfun=None, col_deriv=0, full_output=0,
         decreasing; repeated values are allowed.
     args : tuple, optional
         Extra arguments to pass to function.
-    Dfun : callable(y, t, ...) or callable(t, y, ...)
+    Dfun : callable(y, t, ...) or callable(t, y, ...) or LowLevelCallable
         Gradient (Jacobian) of `func`.
         If the signature is ``callable(t, y, ...)``, then the argument
         `tfirst` must be set ``True``.
+        If `func` is a `LowLevelCallable`, `Dfun` must be one as well, and
+        writes the Jacobian directly into the workspace of LSODA, in
+        Fortran order. A full Jacobian has the signature::
+
+            int Dfun(int n, double t, double *y, double *pd, int nrowpd,
+                     void *user_data)
+
+        and stores the derivative of the ``i``-th equation with respect to
+        the ``j``-th state variable in ``pd[i + j*nrowpd]``. If `ml` or `mu`
+        is given, only the bands are stored, in ``pd[i - j + mu + j*nrowpd]``,
+        by a function with the signature::
+
+            int Dfun(int n, double t, double *y, int ml, int mu, double *pd,
+                     int nrowpd, void *user_data)
+
+        `col_deriv` is ignored in both cases.
     col_deriv : bool, optional
         True if `Dfun` defines derivatives down columns (faster),
         otherwise `Dfun` should define derivatives across rows.
@@ -0,0 +1,469 @@
+/*
+ * Adaptive integration of batches of vector-valued functions, see
+ * qvec_batch.h. The error estimates follow _quadrature_gk of
+ * _quad_vec.py.
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "qvec_batch.h"
+#include "zeros_threads.h"
+
+
+/* Gauss-Kronrod 21-point nodes and weights, and 10-point Gauss weights */
+static const double gk21_x[21] = {
+    0.995657163025808080735527280689003,
+    0.973906528517171720077964012084452,
+    0.930157491355708226001207180059508,
+    0.865063366688984510732096688423493,
+    0.780817726586416897063717578345042,
+    0.679409568299024406234327365114874,
+    0.562757134668604683339000099272694,
+    0.433395394129247190799265943165784,
+    0.294392862701460198131126603103866,
+    0.148874338981631210884826001129720,
+    0,
+    -0.148874338981631210884826001129720,
+    -0.294392862701460198131126603103866,
+    -0.433395394129247190799265943165784,
+    -0.562757134668604683339000099272694,
+    -0.679409568299024406234327365114874,
+    -0.780817726586416897063717578345042,
+    -0.865063366688984510732096688423493,
+    -0.930157491355708226001207180059508,
+    -0.973906528517171720077964012084452,
+    -0.995657163025808080735527280689003
+};
+
+static const double gk21_w[10] = {
+    0.066671344308688137593568809893332,
+    0.149451349150580593145776339657697,
+    0.219086362515982043995534934228163,
+    0.269266719309996355091226921569469,
+    0.295524224714752870173892994651338,
+    0.295524224714752870173892994651338,
+    0.269266719309996355091226921569469,
+    0.219086362515982043995534934228163,
+    0.149451349150580593145776339657697,
+    0.066671344308688137593568809893332
+};
+
+static const double gk21_v[21] = {
+    0.011694638867371874278064396062192,
+    0.032558162307964727478818972459390,
+    0.054755896574351996031381300244580,
+    0.075039674810919952767043140916190,
+    0.093125454583697605535065465083366,
+    0.109387158802297641899210590325805,
+    0.123491976262065851077958109831074,
+    0.134709217311473325928054001771707,
+    0.142775938577060080797094273138717,
+    0.147739104901338491374841515972068,
+    0.149445554002916905664936468389821,
+    0.147739104901338491374841515972068,
+    0.142775938577060080797094273138717,
+    0.134709217311473325928054001771707,
+    0.123491976262065851077958109831074,
+    0.109387158802297641899210590325805,
+    0.093125454583697605535065465083366,
+    0.075039674810919952767043140916190,
+    0.054755896574351996031381300244580,
+    0.032558162307964727478818972459390,
+    0.011694638867371874278064396062192
+};
+
+
+typedef struct {
+    ptrdiff_t nout, cap, n;
+    /* the intervals, their integrals (cap x nout) and error estimates */
+    double *lo, *hi, *ig, *err;
+    /* max-heap of interval indices by error */
+    ptrdiff_t *heap;
+    /* nodes and values of one bisection, and vectors of length nout */
+    double *x, *fx, *total, *sk, *sg, *sabs, *sdabs;
+} qvec_work;
+
+static void
+work_free(qvec_work *w)
+{
+    free(w->lo);
+    free(w->hi);
+    free(w->ig);
+    free(w->err);
+    free(w->heap);
+    free(w->x);
+    free(w->fx);
+    free(w->total);
+    memset(w, 0, sizeof(*w));
+}
+
+static int
+work_init(qvec_work *w, ptrdiff_t nout)
+{
+    memset(w, 0, sizeof(*w));
+    w->nout = nout;
+    w->x = malloc(42 * sizeof(double));
+    w->fx = malloc(42 * nout * sizeof(double));
+    w->total = malloc(5 * nout * sizeof(double));
+    if (w->x == NULL || w->fx == NULL || w->total == NULL) {
+        work_free(w);
+        return QVEC_NOMEM;
+    }
+    w->sk = w->total + nout;
+    w->sg = w->sk + nout;
+    w->sabs = w->sg + nout;
+    w->sdabs = w->sabs + nout;
+    return 0;
+}
+
+/* Makes room for n intervals */
+static int
+work_reserve(qvec_work *w, ptrdiff_t n)
+{
+    ptrdiff_t cap = w->cap > 0 ? w->cap : 16;
+    void *p;
+
+    if (n <= w->cap) {
+        return 0;
+    }
+    while (cap < n) {
+        cap *= 2;
+    }
+#define GROW(field, size) \
+    p = realloc(w->field, cap * (size)); \
+    if (p == NULL) { \
+        return QVEC_NOMEM; \
+    } \
+    w->field = p;
+    GROW(lo, sizeof(double))
+    GROW(hi, sizeof(double))
+    GROW(err, sizeof(double))
+    GROW(heap, sizeof(ptrdiff_t))
+    GROW(ig, w->nout * sizeof(double))
+#undef GROW
+    w->cap = cap;
+    return 0;
+}
+
+static void
+heap_push(qvec_work *w, ptrdiff_t i)
+{
+    ptrdiff_t pos = w->n++, parent;
+
+    while (pos > 0) {
+        parent = (pos - 1) / 2;
+        if (w->err[w->heap[parent]] >= w->err[i]) {
+            break;
+        }
+        w->heap[pos] = w->heap[parent];
+        pos = parent;
+    }
+    w->heap[pos] = i;
+}
+
+/* Replaces the top of the heap with interval i */
+static void
+heap_replace_top(qvec_work *w, ptrdiff_t i)
+{
+    ptrdiff_t pos = 0, child;
+
+    for (;;) {
+        child = 2 * pos + 1;
+        if (child >= w->n) {
+            break;
+        }
+        if (child + 1 < w->n
+                && w->err[w->heap[child + 1]] > w->err[w->heap[child]]) {
+            child++;
+        }
+        if (w->err[w->heap[child]] <= w->err[i]) {
+            break;
+        }
+        w->heap[pos] = w->heap[child];
+        pos = child;
+    }
+    w->heap[pos] = i;
+}
+
+static double
+vec_norm(const double *v, ptrdiff_t n, double scale, int max_norm)
+{
+    double s = 0.0;
+    ptrdiff_t j;
+
+    if (max_norm) {
+        for (j = 0; j < n; j++) {
+            double t = fabs(v[j] * scale);
+
+            if (t > s || t != t) {
+                s = t;
+            }
+        }
+        return s;
+    }
+    for (j = 0; j < n; j++) {
+        s += (v[j] * scale) * (v[j] * scale);
+    }
+    return sqrt(s);
+}
+
+static void
+set_nodes(double *x, double lo, double hi)
+{
+    double c = 0.5 * (lo + hi), h = 0.5 * (hi - lo);
+    int i;
+
+    for (i = 0; i < 21; i++) {
+        x[i] = c + h * gk21_x[i];
+    }
+}
+
+/*
+ * Gauss-Kronrod rule on [lo, hi] from the values fv (21 x nout); stores
+ * the integral in ig, and returns the error and rounding error estimates.
+ */
+static void
+gk21(qvec_work *w, double lo, double hi, const double *fv, int max_norm,
+     double *ig, double *err, double *round_err)
+{
+    ptrdiff_t nout = w->nout, j;
+    double h = 0.5 * (hi - lo), e, dabs, r;
+    int i;
+
+    for (j = 0; j < nout; j++) {
+        w->sk[j] = 0.0;
+        w->sg[j] = 0.0;
+        w->sabs[j] = 0.0;
+        w->sdabs[j] = 0.0;
+    }
+    for (i = 0; i < 21; i++) {
+        const double *f = fv + i * nout;
+
+        for (j = 0; j < nout; j++) {
+            w->sk[j] += gk21_v[i] * f[j];
+            w->sabs[j] += gk21_v[i] * fabs(f[j]);
+        }
+    }
+    for (i = 0; i < 10; i++) {
+        const double *f = fv + (2 * i + 1) * nout;
+
+        for (j = 0; j < nout; j++) {
+            w->sg[j] += gk21_w[i] * f[j];
+        }
+    }
+    for (i = 0; i < 21; i++) {
+        const double *f = fv + i * nout;
+
+        for (j = 0; j < nout; j++) {
+            w->sdabs[j] += gk21_v[i] * fabs(f[j] - 0.5 * w->sk[j]);
+        }
+    }
+
+    for (j = 0; j < nout; j++) {
+        ig[j] = h * w->sk[j];
+        w->sg[j] = w->sk[j] - w->sg[j];
+    }
+    e = vec_norm(w->sg, nout, h, max_norm);
+    dabs = vec_norm(w->sdabs, nout, h, max_norm);
+    if (dabs != 0 && e != 0) {
+        double t = pow(200 * e / dabs, 1.5);
+
+        e = dabs * (t < 1.0 ? t : 1.0);
+    }
+    r = vec_norm(w->sabs, nout, 50 * DBL_EPSILON * h, max_norm);
+    if (r > DBL_MIN && r > e) {
+        e = r;
+    }
+    *err = e;
+    *round_err = r;
+}
+
+static int
+integrate(qvec_work *w, ptrdiff_t k, double a, double b, qvec_func_t *f,
+          void *data, double epsabs, double epsrel, int max_norm,
+          ptrdiff_t limit, double *res, double *abserr, ptrdiff_t *neval)
+{
+    ptrdiff_t nout = w->nout, i, j, l, r;
+    double error, rounding, e1, e2, r1, r2, tol, mid;
+    int status = QVEC_NOT_CONVERGED;
+
+    w->n = 0;
+    *neval = 0;
+    if (work_reserve(w, 2) != 0) {
+        return QVEC_NOMEM;
+    }
+
+    /* initial interval */
+    set_nodes(w->x, a, b);
+    if (f(k, 21, w->x, nout, w->fx, data) != 0) {
+        return QVEC_FUNC_ERROR;
+    }
+    *neval += 21;
+    w->lo[0] = a;
+    w->hi[0] = b;
+    gk21(w, a, b, w->fx, max_norm, w->ig, &w->err[0], &rounding);
+    error = w->err[0];
+    memcpy(w->total, w->ig, nout * sizeof(double));
+    heap_push(w, 0);
+
+    while (w->n < limit) {
+        if (work_reserve(w, w->n + 1) != 0) {
+            status = QVEC_NOMEM;
+            break;
+        }
+
+        /* bisect the interval with the largest error, evaluating the
+           nodes of both halves at once */
+        l = w->heap[0];
+        r = w->n;
+        mid = 0.5 * (w->lo[l] + w->hi[l]);
+        set_nodes(w->x, w->lo[l], mid);
+        set_nodes(w->x + 21, mid, w->hi[l]);
+        if (f(k, 42, w->x, nout, w->fx, data) != 0) {
+            status = QVEC_FUNC_ERROR;
+            break;
+        }
+        *neval += 42;
+
+        for (j = 0; j < nout; j++) {
+            w->total[j] -= w->ig[l * nout + j];
+        }
+        error -= w->err[l];
+        w->lo[r] = mid;
+        w->hi[r] = w->hi[l];
+        w->hi[l] = mid;
+        gk21(w, w->lo[l], mid, w->fx, max_norm, w->ig + l * nout, &e1, &r1);
+        gk21(w, mid, w->hi[r], w->fx + 21 * nout, max_norm,
+             w->ig + r * nout, &e2, &r2);
+        w->err[l] = e1;
+        w->err[r] = e2;
+        for (j = 0; j < nout; j++) {
+            w->total[j] += w->ig[l * nout + j] + w->ig[r * nout + j];
+        }
+        error += e1 + e2;
+        rounding += r1 + r2;
+        heap_replace_top(w, l);
+        heap_push(w, r);
+
+        tol = vec_norm(w->total, nout, 1.0, max_norm) * epsrel;
+        if (tol < epsabs) {
+            tol = epsabs;
+        }
+        if (error < tol / 8) {
+            status = QVEC_CONVERGED;
+            break;
+        }
+        if (error < rounding) {
+            status = QVEC_ROUNDING_ERROR;
+            break;
+        }
+        if (!(isfinite(error) && isfinite(rounding))) {
+            status = QVEC_NOT_A_NUMBER;
+            break;
+        }
+    }
+
+    /* sum the intervals afresh rather than returning the running total */
+    for (j = 0; j < nout; j++) {
+        res[j] = 0.0;
+    }
+    for (i = 0; i < w->n; i++) {
+        for (j = 0; j < nout; j++) {
+            res[j] += w->ig[i * nout + j];
+        }
+    }
+    *abserr = error + rounding;
+    return status;
+}
+
+
+typedef struct {
+    ptrdiff_t nint, nout, limit;
+    const double *a, *b;
+    qvec_func_t *f;
+    void *data;
+    double epsabs, epsrel;
+    int max_norm;
+    double *res, *err;
+    ptrdiff_t *neval;
+    int *status;
+    /* shared between the threads */
+    zeros_mutex lock;
+    ptrdiff_t next;
+    int nomem;
+} qvec_batch_data;
+
+static void
+batch_thread(void *arg)
+{
+    qvec_batch_data *d = (qvec_batch_data *)arg;
+    qvec_work w;
+    ptrdiff_t k;
+    int nomem = work_init(&w, d->nout) != 0;
+
+    for (;;) {
+        zeros_mutex_lock(&d->lock);
+        if (nomem) {
+            d->nomem = 1;
+        }
+        k = d->next++;
+        if (d->nomem || k >= d->nint) {
+            zeros_mutex_unlock(&d->lock);
+            break;
+        }
+        zeros_mutex_unlock(&d->lock);
+
+        d->status[k] = integrate(&w, k, d->a[k], d->b[k], d->f, d->data,
+                                 d->epsabs, d->epsrel, d->max_norm, d->limit,
+                                 d->res + k * d->nout, d->err + k,
+                                 d->neval + k);
+        nomem = d->status[k] == QVEC_NOMEM;
+    }
+    work_free(&w);
+}
+
+int
+qvec_batch(ptrdiff_t nint, ptrdiff_t nout, const double *a, const double *b,
+           qvec_func_t *f, void *data, double epsabs, double epsrel,
+           int max_norm, ptrdiff_t limit, int nthreads, double *res,
+           double *err, ptrdiff_t *neval, int *status)
+{
+    qvec_batch_data d;
+    ptrdiff_t k;
+
+    d.nint = nint;
+    d.nout = nout;
+    d.limit = limit;
+    d.a = a;
+    d.b = b;
+    d.f = f;
+    d.data = data;
+    d.epsabs = epsabs;
+    d.epsrel = epsrel;
+    d.max_norm = max_norm;
+    d.res = res;
+    d.err = err;
+    d.neval = neval;
+    d.status = status;
+    d.next = 0;
+    d.nomem = 0;
+    for (k = 0; k < nint; k++) {
+        status[k] = QVEC_NOMEM;
+        neval[k] = 0;
+    }
+
+    if (nthreads > nint) {
+        nthreads = nint > 1 ? (int)nint : 1;
+    }
+    if (nthreads < 1) {
+        nthreads = 1;
+    }
+    zeros_mutex_init(&d.lock);
+    zeros_run_threads(nthreads, batch_thread, &d);
+    zeros_mutex_destroy(&d.lock);
+
+    return d.nomem ? QVEC_NOMEM : 0;
+}
@@ -0,0 +1,47 @@
+/*
+ * Adaptive integration of batches of vector-valued functions.
+ *
+ * qvec_batch integrates nint independent integrands f_k: [a_k, b_k] ->
+ * R^nout with the global adaptive strategy of quad_vec: all nout
+ * components share one subdivision, the interval with the largest error
+ * estimate (in the max- or 2-norm) is bisected until the total error is
+ * small enough, and each interval is integrated with the Gauss-Kronrod
+ * 21-point rule. The integrand is evaluated at all nodes of a bisection
+ * (42 points) in one call. The integrals are distributed over a number of
+ * threads.
+ */
+#ifndef QVEC_BATCH_H
+#define QVEC_BATCH_H
+
+#include <stddef.h>
+
+/* status of an integral */
+#define QVEC_CONVERGED       0
+#define QVEC_NOT_CONVERGED   1  /* limit on the number of intervals */
+#define QVEC_ROUNDING_ERROR  2
+#define QVEC_NOT_A_NUMBER    3
+#define QVEC_FUNC_ERROR      4  /* the integrand returned nonzero */
+#define QVEC_NOMEM          -1  /* also returned by qvec_batch */
+
+/*
+ * Stores f_k(x[i])[j] in f[i*nout + j] for the npoints nodes x. Returns 0
+ * on success. Called concurrently for different k.
+ */
+typedef int qvec_func_t(ptrdiff_t k, ptrdiff_t npoints, const double *x,
+                        ptrdiff_t nout, double *f, void *data);
+
+/*
+ * Integrates f_k over [a[k], b[k]] for k < nint, to the tolerance
+ * max(epsabs, epsrel * |result|) in the max-norm if max_norm, else in the
+ * 2-norm, with at most limit intervals each. Stores the integrals in
+ * res[k*nout:(k+1)*nout], the error estimates in err[k], the number of
+ * function evaluations in neval[k] and the status in status[k].
+ *
+ * Returns 0, or QVEC_NOMEM if some workspace could not be allocated.
+ */
+int qvec_batch(ptrdiff_t nint, ptrdiff_t nout, const double *a,
+               const double *b, qvec_func_t *f, void *data, double epsabs,
+               double epsrel, int max_norm, ptrdiff_t limit, int nthreads,
+               double *res, double *err, ptrdiff_t *neval, int *status);
+
+#endif
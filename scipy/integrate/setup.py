@@ -44,12 +44,19 @@ def configuration(parent_package='',top_path=None):
         lapack_opt = dict(lapack_opt)
         include_dirs.extend(lapack_opt.pop('include_dirs'))
 
+    quadvec_include_dirs = [join(os.path.dirname(__file__), 'quadvec'),
+                            join(os.path.dirname(__file__), '..', 'optimize',
+                                 'Zeros')]
     config.add_extension('_quadpack',
-                         sources=['_quadpackmodule.c'],
+                         sources=['_quadpackmodule.c',
+                                  join('quadvec', 'qvec_batch.c')],
                          libraries=['quadpack', 'mach'] + lapack_libs,
-                         depends=(['__quadpack.h']
+                         depends=(['__quadpack.h',
+                                   join('quadvec', 'qvec_batch.h'),
+                                   join('..', 'optimize', 'Zeros',
+                                        'zeros_threads.h')]
                                   + quadpack_src + mach_src),
-                         include_dirs=include_dirs,
+                         include_dirs=include_dirs + quadvec_include_dirs,
                          **lapack_opt)
 
     # odepack/lsoda-odeint
@@ -59,6 +66,7 @@ def configuration(parent_package='',top_path=None):
                          sources=['_odepackmodule.c'],
                          libraries=['lsoda', 'mach'] + lapack_libs,
                          depends=(lsoda_src + mach_src),
+                         include_dirs=include_dirs,
                          **odepack_opts)
 
     # vode
@@ -46,6 +46,87 @@ _sin_3(int ndim, double *x)
     return sin(x[0]);
 }
 
+/* the batch of functions x**(j + k) exp(-c x), with c in user_data */
+static int
+_qvec_powexp(Py_ssize_t k, Py_ssize_t npoints, double *x, Py_ssize_t nout,
+             double *f, void *user_data)
+{
+    double c = (user_data == NULL) ? 0 : *(double *)user_data;
+    Py_ssize_t i, j;
+
+    for (i = 0; i < npoints; ++i) {
+        for (j = 0; j < nout; ++j) {
+            f[i*nout + j] = pow(x[i], (double)(j + k)) * exp(-c * x[i]);
+        }
+    }
+    return 0;
+}
+
+static int
+_qvec_fail(Py_ssize_t k, Py_ssize_t npoints, double *x, Py_ssize_t nout,
+           double *f, void *user_data)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < npoints * nout; ++i) {
+        f[i] = 1;
+    }
+    return k == 1;
+}
+
+/* odeint right-hand sides and Jacobians of ydot = C y, with the n x n
+   matrix C in user_data */
+static int
+_odeint_linear(int n, double t, double *y, double *ydot, void *user_data)
+{
+    double *c = (double *)user_data;
+    int i, j;
+
+    for (i = 0; i < n; ++i) {
+        ydot[i] = 0;
+        for (j = 0; j < n; ++j) {
+            ydot[i] += c[i*n + j] * y[j];
+        }
+    }
+    return 0;
+}
+
+static int
+_odeint_linear_jac(int n, double t, double *y, double *pd, int nrowpd,
+                   void *user_data)
+{
+    double *c = (double *)user_data;
+    int i, j;
+
+    for (j = 0; j < n; ++j) {
+        for (i = 0; i < n; ++i) {
+            pd[i + j*nrowpd] = c[i*n + j];
+        }
+    }
+    return 0;
+}
+
+static int
+_odeint_linear_bjac(int n, double t, double *y, int ml, int mu, double *pd,
+                    int nrowpd, void *user_data)
+{
+    double *c = (double *)user_data;
+    int i, j;
+
+    for (j = 0; j < n; ++j) {
+        for (i = (j > mu ? j - mu : 0); i < n && i <= j + ml; ++i) {
+            pd[i - j + mu + j*nrowpd] = c[i*n + j];
+        }
+    }
+    return 0;
+}
+
+static int
+_odeint_fail(int n, double t, double *y, double *ydot, void *user_data)
+{
+    return 1;
+}
+
 
 typedef struct {
     char *name;
@@ -60,7 +141,13 @@ static const routine_t routines[] = {
     {"_sin_0", &_sin_0},
     {"_sin_1", &_sin_1},
     {"_sin_2", &_sin_2},
-    {"_sin_3", &_sin_3}
+    {"_sin_3", &_sin_3},
+    {"_qvec_powexp", &_qvec_powexp},
+    {"_qvec_fail", &_qvec_fail},
+    {"_odeint_linear", &_odeint_linear},
+    {"_odeint_linear_jac", &_odeint_linear_jac},
+    {"_odeint_linear_bjac", &_odeint_linear_bjac},
+    {"_odeint_fail", &_odeint_fail}
 };
 
 
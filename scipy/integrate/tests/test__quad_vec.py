@@ -1,9 +1,14 @@
 from __future__ import division, print_function, absolute_import
 
+import ctypes
+
 import numpy as np
 from numpy.testing import assert_allclose, assert_equal
+from pytest import raises as assert_raises
 
-from scipy.integrate import quad_vec
+from scipy import LowLevelCallable
+from scipy.integrate import quad_vec, quad_vec_batch
+import scipy.integrate._test_multivariate as clib_test
 
 
 def test_quad_vec_simple():
@@ -123,3 +128,72 @@ def test_nan_inf():
 
     res, err, info = quad_vec(f_inf, 0, 1, full_output=True)
     assert info.status == 3
+
+
+def test_quad_vec_batch():
+    p = np.arange(4)
+    c = np.array([0.0, 0.5, 1.0, 2.0, 3.0])
+    b = np.array([1.0, 2.0, 0.5, 3.0, 1.0])
+
+    def f(k, x):
+        return x[:,None]**p * np.exp(-c[k]*x[:,None])
+
+    for norm in ['max', '2']:
+        res, err, info = quad_vec_batch(f, np.zeros(5), b, nout=4,
+                                        norm=norm, epsrel=1e-10,
+                                        full_output=True)
+        assert res.shape == (5, 4)
+        assert_equal(info.status, 0)
+        for k in range(5):
+            exact, _ = quad_vec(lambda x: f(k, np.atleast_1d(x))[0],
+                                0, b[k], norm=norm, epsrel=1e-12)
+            tol = 1e-9 * np.linalg.norm(exact)
+            assert_allclose(res[k], exact, rtol=0, atol=tol)
+            assert err[k] < tol
+
+
+def test_quad_vec_batch_lowlevel():
+    argtypes = (ctypes.c_ssize_t, ctypes.c_ssize_t,
+                ctypes.POINTER(ctypes.c_double), ctypes.c_ssize_t,
+                ctypes.POINTER(ctypes.c_double), ctypes.c_void_p)
+    func_type = ctypes.CFUNCTYPE(ctypes.c_int, *argtypes)
+
+    c = ctypes.c_double(1.5)
+    powexp = LowLevelCallable(
+        ctypes.cast(clib_test._qvec_powexp, func_type),
+        ctypes.cast(ctypes.pointer(c), ctypes.c_void_p))
+
+    nint = 20
+    b = np.linspace(0.5, 4, nint)
+    res1, err1, info1 = quad_vec_batch(powexp, np.zeros(nint), b, nout=3,
+                                       full_output=True)
+    res2, err2, info2 = quad_vec_batch(powexp, np.zeros(nint), b, nout=3,
+                                       workers=4, full_output=True)
+    assert_equal(res1, res2)
+    assert_equal(info1.neval, info2.neval)
+
+    def f(k, x):
+        return x[:,None]**(np.arange(3) + k) * np.exp(-1.5*x[:,None])
+
+    res3 = quad_vec_batch(f, np.zeros(nint), b, nout=3)[0]
+    assert_allclose(res1, res3, rtol=1e-12)
+
+    fail = LowLevelCallable(ctypes.cast(clib_test._qvec_fail, func_type))
+    res, err, info = quad_vec_batch(fail, [0, 0, 0], [1, 1, 1], nout=2,
+                                    workers=2, full_output=True)
+    assert_equal(info.status, [0, 4, 0])
+    assert_allclose(res[[0, 2]], 1)
+
+
+def test_quad_vec_batch_errors():
+    def f(k, x):
+        return np.ones((len(x), 3))
+
+    assert_raises(ValueError, quad_vec_batch, f, [0], [np.inf], 3)
+    assert_raises(ValueError, quad_vec_batch, f, [0, 1], [1], 3)
+    assert_raises(ValueError, quad_vec_batch, f, [0], [1], 2)
+
+    def g(k, x):
+        raise ZeroDivisionError()
+
+    assert_raises(ZeroDivisionError, quad_vec_batch, g, [0, 1], [1, 2], 3)
@@ -4,6 +4,8 @@ Tests for numerical integration.
 """
 from __future__ import division, print_function, absolute_import
 
+import ctypes
+
 import numpy as np
 from numpy import (arange, zeros, array, dot, sqrt, cos, sin, eye, pi, exp,
                    allclose)
@@ -15,7 +17,10 @@ from numpy.testing import (
     assert_, assert_array_almost_equal,
     assert_allclose, assert_array_equal, assert_equal)
 from pytest import raises as assert_raises
+from scipy import LowLevelCallable
 from scipy.integrate import odeint, ode, complex_ode
+from scipy.integrate._odepack import error as odeint_error
+import scipy.integrate._test_multivariate as clib_test
 
 #------------------------------------------------------------------------------
 # Test ODE integrators
@@ -747,6 +752,56 @@ def test_odeint_banded_jacobian():
     assert_allclose(sol1, sol1ty, rtol=1e-12, err_msg="sol1 != sol1ty")
 
 
+def test_odeint_lowlevel():
+    # func and Dfun given as LowLevelCallables, with the matrix of
+    # test_odeint_banded_jacobian as user_data.
+    c = array([[-205, 0.01, 0.00, 0.0],
+               [0.1, -2.50, 0.02, 0.0],
+               [1e-3, 0.01, -2.0, 0.01],
+               [0.00, 0.00, 0.1, -1.0]])
+    c_data = ctypes.cast(c.ctypes.data, ctypes.c_void_p)
+    p_double = ctypes.POINTER(ctypes.c_double)
+    c_int = ctypes.c_int
+    c_double = ctypes.c_double
+
+    def lowlevel(name, *argtypes):
+        func_type = ctypes.CFUNCTYPE(c_int, *argtypes)
+        func = ctypes.cast(getattr(clib_test, name), func_type)
+        return LowLevelCallable(func, c_data)
+
+    func = lowlevel('_odeint_linear', c_int, c_double, p_double, p_double,
+                    ctypes.c_void_p)
+    jac = lowlevel('_odeint_linear_jac', c_int, c_double, p_double,
+                   p_double, c_int, ctypes.c_void_p)
+    bjac = lowlevel('_odeint_linear_bjac', c_int, c_double, p_double, c_int,
+                    c_int, p_double, c_int, ctypes.c_void_p)
+    fail = lowlevel('_odeint_fail', c_int, c_double, p_double, p_double,
+                    ctypes.c_void_p)
+
+    y0 = np.ones(4)
+    t = np.array([0, 5, 10, 100])
+    opts = dict(full_output=True, atol=1e-13, rtol=1e-11, mxstep=10000)
+
+    sol0, info0 = odeint(lambda y, t: c.dot(y), y0, t,
+                         Dfun=lambda y, t: c, **opts)
+    sol1, info1 = odeint(func, y0, t, Dfun=jac, **opts)
+    assert_allclose(sol1, sol0, rtol=1e-12)
+    assert_array_equal(info1['nje'], info0['nje'])
+
+    sol2, info2 = odeint(func, y0, t, Dfun=bjac, ml=2, mu=1, **opts)
+    assert_allclose(sol2, sol1, atol=1e-12)
+    assert_array_equal(info2['nje'], info1['nje'])
+
+    sol3 = odeint(func, y0, t, atol=1e-13, rtol=1e-11, mxstep=10000)
+    assert_allclose(sol3, sol1, atol=1e-10)
+
+    assert_raises(odeint_error, odeint, fail, y0, t)
+    assert_raises(ValueError, odeint, func, y0, t, args=(1,))
+    assert_raises(ValueError, odeint, func, y0, t, Dfun=bjac)
+    assert_raises(ValueError, odeint, func, y0, t, Dfun=jac, ml=2, mu=1)
+    assert_raises(ValueError, odeint, func, y0, t, Dfun=lambda y, t: c)
+
+
 def test_odeint_errors():
     def sys1d(x, t):
         return -100*x
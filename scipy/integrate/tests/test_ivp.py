@@ -7,7 +7,8 @@ from pytest import raises as assert_raises
 from scipy._lib._numpy_compat import suppress_warnings
 import numpy as np
 from scipy.optimize._numdiff import group_columns
-from scipy.integrate import solve_ivp, RK23, RK45, Radau, BDF, LSODA
+from scipy.integrate import (solve_ivp, solve_ivp_ensemble, RK23, RK45, Radau,
+                             BDF, LSODA)
 from scipy.integrate import OdeSolution
 from scipy.integrate._ivp.common import num_jac
 from scipy.integrate._ivp.base import ConstantDenseOutput
@@ -898,3 +899,65 @@ def test_args():
     assert_allclose(y0events[0], np.ones_like(y0events[0]))
     assert_allclose(y0events[1], np.zeros_like(y0events[1]), atol=5e-14)
     assert_allclose(zfinalevents[2], [zfinal])
+
+
+@pytest.mark.parametrize('method', ['RK23', 'RK45'])
+def test_ensemble(method):
+    np.random.seed(1234)
+    y0 = np.random.uniform(-1, 1, size=(10, 2))
+    p = np.random.uniform(0.5, 2, size=10)
+    rtol, atol = 1e-6, 1e-8
+
+    def fun(t, y):
+        return p[:, None] * fun_linear(t, y.T).T
+
+    def fun_i(t, y, p_i):
+        return p_i * fun_linear(t, y)
+
+    for t_span in ([0, 5], [5, 0]):
+        sol = solve_ivp_ensemble(fun, t_span, y0, method=method, rtol=rtol,
+                                 atol=atol)
+        assert_(sol.success)
+        assert_equal(sol.status, 0)
+        assert_equal(sol.t, t_span[1])
+        assert_equal(sol.y.shape, (10, 2))
+        for i in range(10):
+            res = solve_ivp(fun_i, t_span, y0[i], method=method, rtol=rtol,
+                            atol=atol, args=(p[i],))
+            assert_equal(sol.nstep[i], res.t.size - 1)
+            assert_allclose(sol.y[i], res.y[:, -1], rtol=1e-10, atol=1e-14)
+
+        t_eval = np.linspace(t_span[0], t_span[1], 7)
+        sol = solve_ivp_ensemble(fun, t_span, y0, method=method,
+                                 t_eval=t_eval, rtol=rtol, atol=atol)
+        assert_equal(sol.t, t_eval)
+        assert_equal(sol.y.shape, (10, 2, 7))
+        for i in range(10):
+            res = solve_ivp(fun_i, t_span, y0[i], method=method,
+                            t_eval=t_eval, rtol=rtol, atol=atol,
+                            args=(p[i],))
+            assert_allclose(sol.y[i], res.y, rtol=1e-10, atol=1e-14)
+
+
+def test_ensemble_args_and_failure():
+    def fun(t, y, c):
+        return c * y**2
+
+    y0 = [[1.0], [0.1]]
+    t_eval = [0, 0.5, 2]
+    with suppress_warnings() as sup:
+        sup.filter(RuntimeWarning, "")
+        sol = solve_ivp_ensemble(fun, [0, 2], y0, t_eval=t_eval,
+                                 args=(1,))
+    assert_(not sol.success)
+    assert_equal(sol.status, [-1, 0])
+    assert_allclose(sol.y[:, 0, :2], [[1, 2], [0.1, 0.1/0.95]], rtol=1e-2)
+    assert_(np.isnan(sol.y[0, 0, 2]))
+    assert_allclose(sol.y[1, 0, 2], 0.125, rtol=1e-2)
+
+    assert_raises(ValueError, solve_ivp_ensemble, fun, [0, 1], [1.0],
+                  args=(1,))
+    assert_raises(ValueError, solve_ivp_ensemble, fun, [0, 1], y0,
+                  method='Radau', args=(1,))
+    assert_raises(ValueError, solve_ivp_ensemble, lambda t, y: y[:, :1],
+                  [0, 1], np.ones((2, 2)))
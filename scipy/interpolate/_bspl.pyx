@@ -9,6 +9,7 @@ import numpy as np
 cimport numpy as cnp
 
 cimport cython
+from libc.stdlib cimport malloc, free
 
 cdef extern from "src/__fitpack.h":
     void _deBoor_D(const double *t, double x, int k, int ell, int m, double *result) nogil
@@ -16,6 +17,16 @@ cdef extern from "src/__fitpack.h":
 cdef extern from "numpy/npy_math.h":
     double nan "NPY_NAN"
 
+cdef extern from "zeros_threads.h":
+    ctypedef struct zeros_mutex:
+        pass
+    void zeros_mutex_init(zeros_mutex *m) nogil
+    void zeros_mutex_destroy(zeros_mutex *m) nogil
+    void zeros_mutex_lock(zeros_mutex *m) nogil
+    void zeros_mutex_unlock(zeros_mutex *m) nogil
+    void zeros_run_threads(int nthreads, void (*func)(void *) nogil,
+                           void *arg) nogil
+
 ctypedef double complex double_complex
 
 ctypedef fused double_or_complex:
@@ -27,6 +38,55 @@ ctypedef fused double_or_complex:
 # B-splines
 #------------------------------------------------------------------------------
 
+cdef inline int _find_interval(const double *t,
+                               int nt,
+                               int k,
+                               double xval,
+                               int prev_l,
+                               bint extrapolate) nogil:
+    """
+    Find an interval such that t[interval] <= xval < t[interval+1].
+
+    The interval where the previous value was located and the next one are
+    tried first, so that sorted values are located in constant time;
+    otherwise a binary search is used. See `find_interval` for the
+    parameters; `nt` is the number of knots.
+
+    """
+    cdef:
+        int l, lo, hi, mid
+        int n = nt - k - 1
+        double tb = t[k]
+        double te = t[n]
+
+    if xval != xval:
+        # nan
+        return -1
+
+    if ((xval < tb) or (xval > te)) and not extrapolate:
+        return -1
+
+    # the interval is the largest l in [k, n-1] with t[l] <= xval, or k
+    l = prev_l if k < prev_l < n else k
+    if t[l] <= xval and (l == n - 1 or xval < t[l + 1]):
+        return l
+    l += 1
+    if l < n and t[l] <= xval and (l == n - 1 or xval < t[l + 1]):
+        return l
+
+    lo = k
+    hi = n - 1
+    if t[hi] <= xval:
+        return hi
+    while hi - lo > 1:
+        mid = (lo + hi) // 2
+        if t[mid] <= xval:
+            lo = mid
+        else:
+            hi = mid
+    return lo
+
+
 @cython.wraparound(False)
 @cython.boundscheck(False)
 cdef inline int find_interval(const double[::1] t,
@@ -37,7 +97,7 @@ cdef inline int find_interval(const double[::1] t,
     """
     Find an interval such that t[interval] <= xval < t[interval+1].
 
-    Uses a linear search with locality, see fitpack's splev.
+    Uses a search with locality, see fitpack's splev.
 
     Parameters
     ----------
@@ -60,30 +120,101 @@ cdef inline int find_interval(const double[::1] t,
         Suitable interval or -1 if xval was nan.
 
     """
-    cdef:
-        int l
-        int n = t.shape[0] - k - 1
-        double tb = t[k]
-        double te = t[n]
+    return _find_interval(&t[0], t.shape[0], k, xval, prev_l, extrapolate)
+
+
+cdef struct spline_work:
+    # The shared state of the threads of evaluate_spline. c and out are
+    # double or double complex arrays, as given by is_complex.
+    const double *t
+    const double *xp
+    void *c
+    void *out
+    bint is_complex
+    bint extrapolate
+    int nt, k, nu, m
+    Py_ssize_t npts, block, nblocks
+    # next block of points to claim, and whether a thread ran out of memory
+    Py_ssize_t next
+    bint nomem
+    zeros_mutex lock
+
+
+cdef Py_ssize_t _claim(spline_work *w) nogil:
+    # Returns the index of the next unprocessed block of points, or -1
+    cdef Py_ssize_t b
+    zeros_mutex_lock(&w.lock)
+    b = w.next
+    w.next += 1
+    if w.nomem or b >= w.nblocks:
+        b = -1
+    zeros_mutex_unlock(&w.lock)
+    return b
 
-    if xval != xval:
-        # nan
-        return -1
 
-    if ((xval < tb) or (xval > te)) and not extrapolate:
-        return -1
+@cython.cdivision(True)
+cdef void _evaluate_blocks(const double_or_complex *c,
+                           double_or_complex *out,
+                           spline_work *w) nogil:
+    """
+    Evaluates the spline at blocks of points, each with its own search of
+    the intervals.
+    """
+    cdef Py_ssize_t b, ip, stop
+    cdef int jp, a, interval, k = w.k, m = w.m
+    cdef double xval
+    cdef const double_or_complex *c_row
+    cdef double_or_complex *out_row
+    cdef double *work = <double *>malloc((2*k + 2) * sizeof(double))
+
+    if work == NULL:
+        zeros_mutex_lock(&w.lock)
+        w.nomem = 1
+        zeros_mutex_unlock(&w.lock)
+        return
+
+    b = _claim(w)
+    while b >= 0:
+        stop = min(w.npts, (b + 1) * w.block)
+        interval = k
+        for ip in range(b * w.block, stop):
+            xval = w.xp[ip]
+            out_row = out + ip * m
 
-    l = prev_l if k < prev_l < n else k
+            # Find correct interval
+            interval = _find_interval(w.t, w.nt, k, xval, interval,
+                                      w.extrapolate)
 
-    # xval is in support, search for interval s.t. t[interval] <= xval < t[l+1]
-    while(xval < t[l] and l != k):
-        l -= 1
+            if interval < 0:
+                # xval was nan etc
+                for jp in range(m):
+                    out_row[jp] = nan
+                continue
 
-    l += 1
-    while(xval >= t[l] and l != n):
-        l += 1
+            # Evaluate (k+1) b-splines which are non-zero on the interval.
+            # on return, first k+1 elemets of work are B_{m-k},..., B_{m}
+            _deBoor_D(w.t, xval, k, interval, w.nu, work)
+
+            # Form linear combinations
+            c_row = c + (interval - k) * m
+            for jp in range(m):
+                out_row[jp] = 0.
+            for a in range(k+1):
+                for jp in range(m):
+                    out_row[jp] = out_row[jp] + c_row[jp] * work[a]
+                c_row += m
+        b = _claim(w)
+
+    free(work)
 
-    return l-1
+
+cdef void _evaluate_thread(void *arg) nogil:
+    cdef spline_work *w = <spline_work *>arg
+    if w.is_complex:
+        _evaluate_blocks(<const double complex *>w.c,
+                         <double complex *>w.out, w)
+    else:
+        _evaluate_blocks(<const double *>w.c, <double *>w.out, w)
 
 
 @cython.wraparound(False)
@@ -95,7 +226,8 @@ def evaluate_spline(const double[::1] t,
              const double[::1] xp,
              int nu,
              bint extrapolate,
-             double_or_complex[:, ::1] out):
+             double_or_complex[:, ::1] out,
+             int nthreads=1):
     """
     Evaluate a spline in the B-spline basis.
 
@@ -114,12 +246,11 @@ def evaluate_spline(const double[::1] t,
     out : ndarray, shape (s, m)
         Computed values of the spline at each of the input points.
         This argument is modified in-place.
+    nthreads : int, optional
+        Number of threads evaluating blocks of points.
 
     """
-
-    cdef int ip, jp, n, a
-    cdef int i, interval
-    cdef double xval
+    cdef spline_work w
 
     # shape checks
     if out.shape[0] != xp.shape[0]:
@@ -131,33 +262,34 @@ def evaluate_spline(const double[::1] t,
     if nu < 0:
         raise NotImplementedError("Cannot do derivative order %s." % nu)
 
-    n = c.shape[0]
-    cdef double[::1] work = np.empty(2*k+2, dtype=np.float_)
+    if xp.shape[0] == 0 or c.shape[1] == 0:
+        return
+
+    w.t = &t[0]
+    w.xp = &xp[0]
+    w.c = &c[0, 0]
+    w.out = &out[0, 0]
+    w.is_complex = double_or_complex is double_complex
+    w.extrapolate = extrapolate
+    w.nt = t.shape[0]
+    w.k = k
+    w.nu = nu
+    w.m = c.shape[1]
+    w.npts = xp.shape[0]
+    # blocks of points, each starting its search of the intervals anew
+    w.block = 4096 if nthreads > 1 else w.npts
+    w.nblocks = (w.npts + w.block - 1) // w.block
+    w.next = 0
+    w.nomem = 0
+    nthreads = max(1, min(nthreads, w.nblocks))
 
     # evaluate
+    zeros_mutex_init(&w.lock)
     with nogil:
-        interval = k
-        for ip in range(xp.shape[0]):
-            xval = xp[ip]
-
-            # Find correct interval
-            interval = find_interval(t, k, xval, interval, extrapolate)
-
-            if interval < 0:
-                # xval was nan etc
-                for jp in range(c.shape[1]):
-                    out[ip, jp] = nan
-                continue
-
-            # Evaluate (k+1) b-splines which are non-zero on the interval.
-            # on return, first k+1 elemets of work are B_{m-k},..., B_{m}
-            _deBoor_D(&t[0], xval, k, interval, nu, &work[0])
-
-            # Form linear combinations
-            for jp in range(c.shape[1]):
-                out[ip, jp] = 0.
-                for a in range(k+1):
-                    out[ip, jp] = out[ip, jp] + c[interval + a - k, jp] * work[a]
+        zeros_run_threads(nthreads, _evaluate_thread, &w)
+    zeros_mutex_destroy(&w.lock)
+    if w.nomem:
+        raise MemoryError()
 
 
 def evaluate_all_bspl(const double[::1] t, int k, double xval, int m, int nu=0):
@@ -414,3 +546,260 @@ def _norm_eq_lsq(const double[::1] x,
                 # ... and A.T @ y
                 for ci in range(rhs.shape[1]):
                     rhs[row, ci] = rhs[row, ci] + wrk[r] * y[j, ci] * wval
+
+
+#------------------------------------------------------------------------------
+# Tensor-product splines
+#------------------------------------------------------------------------------
+
+cdef struct bispline_work:
+    # The shared state of the threads of evaluate_bispline. The basis
+    # functions of the grid axes are computed beforehand, those of
+    # scattered points by each thread.
+    const double *tx
+    const double *ty
+    const double *c
+    int nx, ny, kx, ky, dx, dy
+    const double *x
+    const double *y
+    Py_ssize_t mx, my
+    bint grid
+    const int *lx
+    const int *ly
+    const double *bx
+    const double *by
+    double *out
+    # blocks of points (or of grid rows), the next one to claim, and whether
+    # a thread ran out of memory
+    Py_ssize_t block, nblocks, next
+    bint nomem
+    zeros_mutex lock
+
+
+cdef Py_ssize_t _claim_bispline(bispline_work *w) nogil:
+    # Returns the index of the next unprocessed block, or -1
+    cdef Py_ssize_t b
+    zeros_mutex_lock(&w.lock)
+    b = w.next
+    w.next += 1
+    if w.nomem or b >= w.nblocks:
+        b = -1
+    zeros_mutex_unlock(&w.lock)
+    return b
+
+
+cdef inline int _bispline_basis(const double *t, int nt, int k, int nu,
+                                double xval, int prev_l,
+                                double *work) nogil:
+    """
+    Computes in work[:k+1] the nu-th derivatives of the B-splines which
+    are non-zero at xval, clipped to the base interval as FITPACK does,
+    and returns the interval, or -1 if xval is nan. work has 2*k + 2
+    entries.
+    """
+    cdef int l
+    if xval != xval:
+        return -1
+    xval = min(max(xval, t[k]), t[nt - k - 1])
+    l = _find_interval(t, nt, k, xval, prev_l, 0)
+    if l >= 0:
+        _deBoor_D(t, xval, k, l, nu, work)
+    return l
+
+
+@cython.cdivision(True)
+cdef void _bispline_thread(void *arg) nogil:
+    """
+    Evaluates a tensor-product spline at blocks of points, or at blocks of
+    rows of a grid.
+
+    On a grid, the coefficients of each row are first combined along x,
+    so that each value only takes a combination of ky + 1 of them.
+
+    """
+    cdef bispline_work *w = <bispline_work *>arg
+    cdef Py_ssize_t b, i, j
+    cdef int a, q, l, ly, ncy = w.ny - w.ky - 1
+    cdef int kx = w.kx, ky = w.ky
+    cdef double s
+    cdef const double *cx
+    cdef const double *wy
+    cdef double *wx
+    cdef double *out
+    cdef double *row = NULL
+    cdef double *work = <double *>malloc(
+        (2*kx + 2 + 2*ky + 2) * sizeof(double))
+    cdef int lx = kx, lyp = ky
+
+    if w.grid:
+        row = <double *>malloc(ncy * sizeof(double))
+    if work == NULL or (w.grid and row == NULL):
+        zeros_mutex_lock(&w.lock)
+        w.nomem = True
+        zeros_mutex_unlock(&w.lock)
+
+    b = _claim_bispline(w)
+    while b >= 0:
+        for i in range(b * w.block, min(w.mx, (b + 1) * w.block)):
+            if w.grid:
+                # the row of coefficients along y at x[i]
+                l = w.lx[i]
+                out = w.out + i * w.my
+                if l < 0:
+                    for j in range(w.my):
+                        out[j] = nan
+                    continue
+                for q in range(ncy):
+                    row[q] = 0
+                for a in range(kx + 1):
+                    s = w.bx[i * (kx + 1) + a]
+                    cx = w.c + (l - kx + a) * ncy
+                    for q in range(ncy):
+                        row[q] += s * cx[q]
+
+                for j in range(w.my):
+                    ly = w.ly[j]
+                    if ly < 0:
+                        out[j] = nan
+                        continue
+                    wy = w.by + j * (ky + 1)
+                    s = 0
+                    for a in range(ky + 1):
+                        s += wy[a] * row[ly - ky + a]
+                    out[j] = s
+            else:
+                wx = work
+                lx = _bispline_basis(w.tx, w.nx, kx, w.dx, w.x[i], lx, wx)
+                lyp = _bispline_basis(w.ty, w.ny, ky, w.dy, w.y[i], lyp,
+                                      work + 2*kx + 2)
+                if lx < 0 or lyp < 0:
+                    w.out[i] = nan
+                    lx = kx
+                    lyp = ky
+                    continue
+                s = 0
+                for a in range(kx + 1):
+                    cx = w.c + (lx - kx + a) * ncy + (lyp - ky)
+                    for q in range(ky + 1):
+                        s += wx[a] * work[2*kx + 2 + q] * cx[q]
+                w.out[i] = s
+        b = _claim_bispline(w)
+
+    free(work)
+    free(row)
+
+
+cdef int _axis_basis(const double[::1] t, int k, int nu,
+                     const double[::1] x, int[::1] l,
+                     double[:, ::1] basis) except -1:
+    # The intervals and basis functions of the points x of a grid axis
+    cdef Py_ssize_t i
+    cdef int a, prev = k
+    cdef double *work = <double *>malloc((2*k + 2) * sizeof(double))
+    if work == NULL:
+        raise MemoryError()
+    with nogil:
+        for i in range(x.shape[0]):
+            l[i] = _bispline_basis(&t[0], t.shape[0], k, nu, x[i], prev,
+                                   work)
+            if l[i] >= 0:
+                prev = l[i]
+                for a in range(k + 1):
+                    basis[i, a] = work[a]
+    free(work)
+    return 0
+
+
+def evaluate_bispline(const double[::1] tx, const double[::1] ty,
+                      const double[::1] c, int kx, int ky,
+                      const double[::1] x, const double[::1] y,
+                      int dx, int dy, bint grid, double[:, ::1] out,
+                      int nthreads=1):
+    """
+    Evaluate a tensor-product spline, as FITPACK's bispev and bispeu.
+
+    Parameters
+    ----------
+    tx, ty : ndarray
+        The knots along x and y.
+    c : ndarray, shape ((len(tx) - kx - 1) * (len(ty) - ky - 1),)
+        The B-spline coefficients, in C order.
+    kx, ky : int
+        The degrees along x and y.
+    x, y : ndarray
+        The points; sorted axes of a grid if `grid`. Points beyond the base
+        interval of the knots are moved onto its edge.
+    dx, dy : int
+        The orders of the derivatives along x and y.
+    grid : bool
+        Whether to evaluate at the grid ``x x y`` or at the points
+        ``(x[i], y[i])``.
+    out : ndarray, shape (len(x), len(y)) or (len(x), 1)
+        The values, nan at nan points. Modified in place.
+    nthreads : int, optional
+        Number of threads evaluating blocks of points or of grid rows.
+
+    """
+    cdef bispline_work w
+    cdef int[::1] lx, ly
+    cdef double[:, ::1] bx, by
+    cdef Py_ssize_t ncx = tx.shape[0] - kx - 1, ncy = ty.shape[0] - ky - 1
+
+    if kx < 0 or ky < 0 or ncx < kx + 1 or ncy < ky + 1:
+        raise ValueError("too few knots for the degrees")
+    if c.shape[0] != ncx * ncy:
+        raise ValueError("c and the knots have incompatible shapes")
+    if not (0 <= dx <= kx and 0 <= dy <= ky):
+        raise ValueError("invalid derivative orders")
+    if grid:
+        if out.shape[0] != x.shape[0] or out.shape[1] != y.shape[0]:
+            raise ValueError("out and x, y have incompatible shapes")
+    elif (y.shape[0] != x.shape[0] or out.shape[0] != x.shape[0]
+          or out.shape[1] != 1):
+        raise ValueError("out and x, y have incompatible shapes")
+    if out.shape[0] == 0 or out.shape[1] == 0:
+        return
+
+    w.tx = &tx[0]
+    w.ty = &ty[0]
+    w.c = &c[0]
+    w.nx = tx.shape[0]
+    w.ny = ty.shape[0]
+    w.kx = kx
+    w.ky = ky
+    w.dx = dx
+    w.dy = dy
+    w.x = &x[0]
+    w.y = &y[0]
+    w.mx = x.shape[0]
+    w.my = y.shape[0]
+    w.grid = grid
+    w.out = &out[0, 0]
+
+    if grid:
+        lx = np.empty(x.shape[0], dtype=np.intc)
+        ly = np.empty(y.shape[0], dtype=np.intc)
+        bx = np.empty((x.shape[0], kx + 1))
+        by = np.empty((y.shape[0], ky + 1))
+        _axis_basis(tx, kx, dx, x, lx, bx)
+        _axis_basis(ty, ky, dy, y, ly, by)
+        w.lx = &lx[0]
+        w.ly = &ly[0]
+        w.bx = &bx[0, 0]
+        w.by = &by[0, 0]
+        # rows of about 4096 values at least
+        w.block = max(1, 4096 // w.my)
+    else:
+        w.block = 4096 if nthreads > 1 else w.mx
+
+    w.nblocks = (w.mx + w.block - 1) // w.block
+    w.next = 0
+    w.nomem = False
+    nthreads = max(1, min(nthreads, w.nblocks))
+
+    zeros_mutex_init(&w.lock)
+    with nogil:
+        zeros_run_threads(nthreads, _bispline_thread, &w)
+    zeros_mutex_destroy(&w.lock)
+    if w.nomem:
+        raise MemoryError()
@@ -2,6 +2,7 @@ from __future__ import division, print_function, absolute_import
 
 import functools
 import operator
+from multiprocessing import cpu_count
 
 import numpy as np
 from scipy._lib.six import string_types
@@ -307,7 +308,7 @@ class BSpline(object):
         c[k] = 1.
         return cls.construct_fast(t, c, k, extrapolate)
 
-    def __call__(self, x, nu=0, extrapolate=None):
+    def __call__(self, x, nu=0, extrapolate=None, workers=1):
         """
         Evaluate a spline function.
 
@@ -321,6 +322,11 @@ class BSpline(object):
             whether to extrapolate based on the first and last intervals
             or return nans. If 'periodic', periodic extrapolation is used.
             Default is `self.extrapolate`.
+        workers : int, optional
+            Number of threads evaluating blocks of points; -1 uses all
+            CPUs. Default is 1.
+
+            .. versionadded:: 1.4.0
 
         Returns
         -------
@@ -345,7 +351,7 @@ class BSpline(object):
 
         out = np.empty((len(x), prod(self.c.shape[1:])), dtype=self.c.dtype)
         self._ensure_c_contiguous()
-        self._evaluate(x, nu, extrapolate, out)
+        self._evaluate(x, nu, extrapolate, out, workers)
         out = out.reshape(x_shape + self.c.shape[1:])
         if self.axis != 0:
             # transpose to move the calculated values to the interpolation axis
@@ -354,9 +360,10 @@ class BSpline(object):
             out = out.transpose(l)
         return out
 
-    def _evaluate(self, xp, nu, extrapolate, out):
+    def _evaluate(self, xp, nu, extrapolate, out, workers=1):
+        nthreads = cpu_count() if workers == -1 else max(int(workers), 1)
         _bspl.evaluate_spline(self.t, self.c.reshape(self.c.shape[0], -1),
-                self.k, xp, nu, extrapolate, out)
+                self.k, xp, nu, extrapolate, out, nthreads)
 
     def _ensure_c_contiguous(self):
         """
@@ -27,8 +27,11 @@ __all__ = ['splrep', 'splprep', 'splev', 'splint', 'sproot', 'spalde',
            'bisplrep', 'bisplev', 'insert', 'splder', 'splantider']
 
 import warnings
+from multiprocessing import cpu_count
+
 import numpy as np
 from . import _fitpack
+from . import _bspl
 from numpy import (atleast_1d, array, ones, zeros, sqrt, ravel, transpose,
                    empty, iinfo, intc, asarray)
 
@@ -1044,12 +1047,16 @@ def bisplev(x, y, tck, dx=0, dy=0):
     x, y = map(atleast_1d, [x, y])
     if (len(x.shape) != 1) or (len(y.shape) != 1):
         raise ValueError("First two entries should be rank-1 arrays.")
-    z, ier = _fitpack._bispev(tx, ty, c, kx, ky, x, y, dx, dy)
-    if ier == 10:
-        raise ValueError("Invalid input data")
-    if ier:
-        raise TypeError("An error occurred")
-    z.shape = len(x), len(y)
+    z = None
+    if x.size > 0 and y.size > 0:
+        z = _evaluate_bispline((tx, ty, c), kx, ky, x, y, dx, dy, True, 1)
+    if z is None:
+        z, ier = _fitpack._bispev(tx, ty, c, kx, ky, x, y, dx, dy)
+        if ier == 10:
+            raise ValueError("Invalid input data")
+        if ier:
+            raise TypeError("An error occurred")
+        z.shape = len(x), len(y)
     if len(z) > 1:
         return z
     if len(z[0]) > 1:
@@ -1057,6 +1064,34 @@ def bisplev(x, y, tck, dx=0, dy=0):
     return z[0][0]
 
 
+def _evaluate_bispline(tck, kx, ky, x, y, dx, dy, grid, workers):
+    """
+    Evaluates a tensor-product spline in compiled code, as bispev/parder on
+    a grid or bispeu/pardeu at points, without their workspace. Returns
+    None where FITPACK would report an error, so that it reports it.
+    """
+    tx, ty, c = [np.ascontiguousarray(a, dtype=float) for a in tck]
+    if (x.ndim != 1 or y.ndim != 1 or not 0 <= dx < max(kx, 1)
+            or not 0 <= dy < max(ky, 1)
+            or len(tx) < 2*kx + 2 or len(ty) < 2*ky + 2
+            or c.shape != ((len(tx) - kx - 1) * (len(ty) - ky - 1),)
+            or np.iscomplexobj(x) or np.iscomplexobj(y)):
+        return None
+    x = np.ascontiguousarray(x, dtype=float)
+    y = np.ascontiguousarray(y, dtype=float)
+    if grid:
+        # bispev needs sorted axes
+        if np.any(x[1:] < x[:-1]) or np.any(y[1:] < y[:-1]):
+            return None
+        z = np.empty((x.size, y.size))
+    else:
+        z = np.empty((x.size, 1))
+    nthreads = cpu_count() if workers == -1 else max(int(workers), 1)
+    _bspl.evaluate_bispline(tx, ty, c, kx, ky, x, y, dx, dy, grid, z,
+                            nthreads)
+    return z if grid else z[:, 0]
+
+
 def dblint(xa, xb, ya, yb, tck):
     """Evaluate the integral of a spline over area [xa,xb] x [ya,yb].
 
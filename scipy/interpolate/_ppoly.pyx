@@ -24,13 +24,202 @@ cdef extern from "blas_defs.h":
     void c_dgeev(char *jobvl, char *jobvr, int *n, double *a,
                  int *lda, double *wr, double *wi, double *vl, int *ldvl,
                  double *vr, int *ldvr, double *work, int *lwork,
-                 int *info)
+                 int *info) nogil
 
 cdef extern from "numpy/npy_math.h":
     double nan "NPY_NAN"
 
+cdef extern from "zeros_threads.h":
+    ctypedef struct zeros_mutex:
+        pass
+    void zeros_mutex_init(zeros_mutex *m) nogil
+    void zeros_mutex_destroy(zeros_mutex *m) nogil
+    void zeros_mutex_lock(zeros_mutex *m) nogil
+    void zeros_mutex_unlock(zeros_mutex *m) nogil
+    void zeros_run_threads(int nthreads, void (*func)(void *) nogil,
+                           void *arg) nogil
+
 DEF MAX_DIMS = 64
 
+# Number of points, or of intervals for real_roots, in a block of work of
+# a thread
+DEF BLOCK_SIZE = 4096
+
+
+#------------------------------------------------------------------------------
+# Threads
+#------------------------------------------------------------------------------
+
+cdef struct ppoly_work:
+    # The shared state of the threads of evaluate, evaluate_bernstein and
+    # real_roots. c and out are double or double complex arrays, as given
+    # by is_complex; c has shape (k, m, n).
+    void *c
+    void *out
+    const double *x
+    const double *xp
+    bint is_complex, bernstein, ascending, extrapolate
+    int k, m, n, dx
+    Py_ssize_t npts
+    # real_roots: the polynomial, the right-hand side and the results for
+    # each interval
+    int jp
+    bint report_discont
+    double y
+    double *roots
+    int *nroots
+    int *discont
+    # blocks of work, the next one to claim, and whether a thread ran out
+    # of memory
+    Py_ssize_t nblocks, next
+    bint nomem
+    zeros_mutex lock
+
+
+cdef Py_ssize_t claim_block(ppoly_work *w) nogil:
+    # Returns the index of the next unprocessed block, or -1
+    cdef Py_ssize_t b
+    zeros_mutex_lock(&w.lock)
+    b = w.next
+    w.next += 1
+    if w.nomem or b >= w.nblocks:
+        b = -1
+    zeros_mutex_unlock(&w.lock)
+    return b
+
+
+cdef void set_nomem(ppoly_work *w) nogil:
+    zeros_mutex_lock(&w.lock)
+    w.nomem = 1
+    zeros_mutex_unlock(&w.lock)
+
+
+cdef int run_blocks(ppoly_work *w, Py_ssize_t nwork,
+                    void (*func)(void *) nogil, int nthreads) except -1:
+    """
+    Runs func(w) on up to nthreads threads, which claim the blocks of the
+    nwork points or intervals.
+    """
+    w.nblocks = (nwork + BLOCK_SIZE - 1) // BLOCK_SIZE
+    w.next = 0
+    w.nomem = 0
+    nthreads = max(1, min(nthreads, w.nblocks))
+    zeros_mutex_init(&w.lock)
+    with nogil:
+        zeros_run_threads(nthreads, func, w)
+    zeros_mutex_destroy(&w.lock)
+    if w.nomem:
+        raise MemoryError()
+    return 0
+
+
+@cython.cdivision(True)
+cdef void evaluate_blocks(const double_or_complex *c, double_or_complex *out,
+                          ppoly_work *w) nogil:
+    """
+    Evaluates a piecewise polynomial in the power or Bernstein basis at
+    blocks of points.
+    """
+    cdef Py_ssize_t b, ip, stop, stride = <Py_ssize_t>w.m * w.n
+    cdef int i, jp, interval
+    cdef double xval
+    cdef double_or_complex s, ds, ds_nu
+    cdef double_or_complex *wrk = NULL
+
+    if w.bernstein and w.dx > 0:
+        wrk = <double_or_complex *>libc.stdlib.malloc(
+            max(w.k - w.dx, 1) * sizeof(double_or_complex))
+        if wrk == NULL:
+            set_nomem(w)
+            return
+
+    b = claim_block(w)
+    while b >= 0:
+        stop = min(w.npts, (b + 1) * BLOCK_SIZE)
+        interval = 0
+        for ip in range(b * BLOCK_SIZE, stop):
+            xval = w.xp[ip]
+
+            # Find correct interval
+            if w.ascending:
+                i = find_interval_ascending(w.x, w.m + 1, xval, interval,
+                                            w.extrapolate)
+            else:
+                i = find_interval_descending(w.x, w.m + 1, xval, interval,
+                                             w.extrapolate)
+            if i < 0:
+                # xval was nan etc
+                for jp in range(w.n):
+                    out[ip*w.n + jp] = nan
+                continue
+            else:
+                interval = i
+
+            # Evaluate the local polynomial(s)
+            if not w.bernstein:
+                for jp in range(w.n):
+                    out[ip*w.n + jp] = poly1_eval(
+                        xval - w.x[interval], c + interval*w.n + jp,
+                        stride, w.k, w.dx)
+            else:
+                ds = w.x[interval+1] - w.x[interval]
+                ds_nu = ds**w.dx
+                for jp in range(w.n):
+                    s = (xval - w.x[interval]) / ds
+                    if w.dx == 0:
+                        out[ip*w.n + jp] = evaluate_bpoly1(
+                            s, c + interval*w.n + jp, stride, w.k)
+                    else:
+                        out[ip*w.n + jp] = evaluate_bpoly1_deriv(
+                            s, c + interval*w.n + jp, stride, w.k, w.dx,
+                            wrk) / ds_nu
+        b = claim_block(w)
+
+    libc.stdlib.free(wrk)
+
+
+cdef void evaluate_thread(void *arg) nogil:
+    cdef ppoly_work *w = <ppoly_work *>arg
+    if w.is_complex:
+        evaluate_blocks(<const double complex *>w.c,
+                        <double complex *>w.out, w)
+    else:
+        evaluate_blocks(<const double *>w.c, <double *>w.out, w)
+
+
+cdef int evaluate_points(double_or_complex[:,:,::1] c,
+                         const double[::1] x,
+                         const double[::1] xp,
+                         int dx,
+                         bint extrapolate,
+                         double_or_complex[:,::1] out,
+                         bint bernstein,
+                         int nthreads) except -1:
+    """
+    Evaluates a piecewise polynomial at the points xp in blocks, for
+    evaluate and evaluate_bernstein.
+    """
+    cdef ppoly_work w
+
+    if xp.shape[0] == 0 or c.shape[2] == 0:
+        return 0
+
+    w.c = &c[0, 0, 0]
+    w.out = &out[0, 0]
+    w.x = &x[0]
+    w.xp = &xp[0]
+    w.is_complex = double_or_complex is double_complex
+    w.bernstein = bernstein
+    w.ascending = x[x.shape[0] - 1] >= x[0]
+    w.extrapolate = extrapolate
+    w.k = c.shape[0]
+    w.m = c.shape[1]
+    w.n = c.shape[2]
+    w.dx = dx
+    w.npts = xp.shape[0]
+    return run_blocks(&w, w.npts, evaluate_thread, nthreads)
+
+
 #------------------------------------------------------------------------------
 # Piecewise power basis polynomials
 #------------------------------------------------------------------------------
@@ -43,7 +232,8 @@ def evaluate(double_or_complex[:,:,::1] c,
              const double[::1] xp,
              int dx,
              bint extrapolate,
-             double_or_complex[:,::1] out):
+             double_or_complex[:,::1] out,
+             int nthreads=1):
     """
     Evaluate a piecewise polynomial.
 
@@ -66,12 +256,10 @@ def evaluate(double_or_complex[:,:,::1] c,
     out : ndarray, shape (r, n)
         Value of each polynomial at each of the input points.
         This argument is modified in-place.
+    nthreads : int, optional
+        Number of threads evaluating blocks of points.
 
     """
-    cdef int ip, jp
-    cdef int interval
-    cdef double xval
-
     # check derivative order
     if dx < 0:
         raise ValueError("Order of derivative cannot be negative")
@@ -84,32 +272,7 @@ def evaluate(double_or_complex[:,:,::1] c,
     if c.shape[1] != x.shape[0] - 1:
         raise ValueError("x and c have incompatible shapes")
 
-    interval = 0
-    cdef bint ascending = x[x.shape[0] - 1] >= x[0]
-
-    # Evaluate.
-    for ip in range(len(xp)):
-        xval = xp[ip]
-
-        # Find correct interval
-        if ascending:
-            i = find_interval_ascending(&x[0], x.shape[0], xval, interval,
-                                        extrapolate)
-        else:
-            i = find_interval_descending(&x[0], x.shape[0], xval, interval,
-                                         extrapolate)
-        if i < 0:
-            # xval was nan etc
-            for jp in range(c.shape[2]):
-                out[ip, jp] = nan
-            continue
-        else:
-            interval = i
-
-        # Evaluate the local polynomial(s)
-        for jp in range(c.shape[2]):
-            out[ip, jp] = evaluate_poly1(xval - x[interval], c, interval,
-                                         jp, dx)
+    evaluate_points(c, x, xp, dx, extrapolate, out, False, nthreads)
 
 
 @cython.wraparound(False)
@@ -418,11 +581,105 @@ def integrate(double_or_complex[:,:,::1] c,
             out[jp] = -out[jp]
 
 
+@cython.cdivision(True)
+cdef void real_roots_thread(void *arg) nogil:
+    """
+    Finds the real roots of the polynomials jp of blocks of intervals, and
+    the sign changes of the polynomial across the breakpoints.
+    """
+    cdef ppoly_work *w = <ppoly_work *>arg
+    cdef const double *c
+    cdef Py_ssize_t b, interval, stride = <Py_ssize_t>w.m * w.n
+    cdef int k, i, nr
+    cdef double *wr
+    cdef double *wi
+    cdef double *rts
+    cdef void *workspace = NULL
+    cdef double va, vb, f, df, dx
+    cdef bint last
+
+    wr = <double*>libc.stdlib.malloc(w.k * sizeof(double))
+    wi = <double*>libc.stdlib.malloc(w.k * sizeof(double))
+    if wr == NULL or wi == NULL:
+        set_nomem(w)
+
+    b = claim_block(w)
+    while b >= 0:
+        for interval in range(b * BLOCK_SIZE, min(w.m, (b + 1) * BLOCK_SIZE)):
+            c = <const double *>w.c + interval*w.n + w.jp
+
+            # Check for sign change across intervals
+            w.discont[interval] = 0
+            if interval > 0 and w.report_discont:
+                va = poly1_eval(w.x[interval] - w.x[interval-1], c - w.n,
+                                stride, w.k, 0) - w.y
+                vb = poly1_eval(0, c, stride, w.k, 0) - w.y
+                w.discont[interval] = (va < 0 and vb > 0) or (va > 0 and vb < 0)
+
+            # Compute first the complex roots
+            k = poly1_croots(c, stride, w.k, w.y, wr, wi, &workspace)
+            if k == -3:
+                set_nomem(w)
+                break
+            elif k < 0:
+                # Zero everywhere, or an error occurred
+                w.nroots[interval] = k
+                continue
+
+            # Filter real roots
+            rts = w.roots + interval*w.k
+            nr = 0
+            last = interval == w.m - 1
+            for i in range(k):
+                # Check real root
+                #
+                # The reality of a root is a decision that can be left to LAPACK,
+                # which has to determine this in any case.
+                if wi[i] != 0:
+                    continue
+
+                # Refine root by one Newton iteration
+                f = poly1_eval(wr[i], c, stride, w.k, 0) - w.y
+                df = poly1_eval(wr[i], c, stride, w.k, 1)
+                if df != 0:
+                    dx = f/df
+                    if libc.math.fabs(dx) < libc.math.fabs(wr[i]):
+                        wr[i] = wr[i] - dx
+
+                # Check interval
+                wr[i] += w.x[interval]
+                if interval == 0 and w.extrapolate:
+                    # Half-open to the left/right.
+                    if (w.ascending and not wr[i] <= w.x[interval+1] or
+                        not w.ascending and not wr[i] >= w.x[interval + 1]):
+                            continue
+                elif last and w.extrapolate:
+                    # Half-open to the right/left.
+                    if (w.ascending and not wr[i] >= w.x[interval] or
+                        not w.ascending and not wr[i] <= w.x[interval]):
+                            continue
+                else:
+                    if (w.ascending and
+                        not w.x[interval] <= wr[i] <= w.x[interval+1] or
+                        not w.ascending and
+                        not w.x[interval + 1] <= wr[i] <= w.x[interval]):
+                            continue
+
+                rts[nr] = wr[i]
+                nr += 1
+            w.nroots[interval] = nr
+        b = claim_block(w)
+
+    libc.stdlib.free(workspace)
+    libc.stdlib.free(wr)
+    libc.stdlib.free(wi)
+
+
 @cython.wraparound(False)
 @cython.boundscheck(False)
 @cython.cdivision(True)
 def real_roots(double[:,:,::1] c, double[::1] x, double y, bint report_discont,
-               bint extrapolate):
+               bint extrapolate, int nthreads=1):
     """
     Compute real roots of a real-valued piecewise polynomial function.
 
@@ -445,17 +702,15 @@ def real_roots(double[:,:,::1] c, double[::1] x, double y, bint report_discont,
     extrapolate : bint, optional
         Whether to consider roots obtained by extrapolating based
         on first and last intervals.
+    nthreads : int, optional
+        Number of threads finding the roots in blocks of intervals.
 
     """
     cdef list roots
     cdef list cur_roots
-    cdef int interval, jp, k, i, p
-
-    cdef double *wr
-    cdef double *wi
-    cdef double last_root, va, vb
-    cdef double f, df, dx
-    cdef void *workspace
+    cdef int interval, jp, k, i
+    cdef double last_root
+    cdef ppoly_work w
 
     if c.shape[1] != x.shape[0] - 1:
         raise ValueError("x and c have incompatible shapes")
@@ -463,103 +718,70 @@ def real_roots(double[:,:,::1] c, double[::1] x, double y, bint report_discont,
     if c.shape[0] == 0:
         return np.array([], dtype=float)
 
-    wr = <double*>libc.stdlib.malloc(c.shape[0] * sizeof(double))
-    wi = <double*>libc.stdlib.malloc(c.shape[0] * sizeof(double))
-    workspace = NULL
+    # The real roots in each interval, how many there are (or -1 if the
+    # polynomial is zero there, < -1 on errors), and whether the sign
+    # changes across its left breakpoint
+    cdef double[:,::1] int_roots = np.empty((c.shape[1], c.shape[0]))
+    cdef int[::1] nroots = np.empty(c.shape[1], dtype=np.intc)
+    cdef int[::1] discont = np.empty(c.shape[1], dtype=np.intc)
+
+    w.c = &c[0, 0, 0]
+    w.x = &x[0]
+    w.ascending = x[x.shape[0] - 1] >= x[0]
+    w.extrapolate = extrapolate
+    w.k = c.shape[0]
+    w.m = c.shape[1]
+    w.n = c.shape[2]
+    w.y = y
+    w.report_discont = report_discont
+    if w.m > 0:
+        w.roots = &int_roots[0, 0]
+        w.nroots = &nroots[0]
+        w.discont = &discont[0]
 
     last_root = nan
 
-    cdef bint ascending = x[x.shape[0] - 1] >= x[0]
-
     roots = []
-    try:
-        for jp in range(c.shape[2]):
-            cur_roots = []
-            for interval in range(c.shape[1]):
-                # Check for sign change across intervals
-                if interval > 0 and report_discont:
-                    va = evaluate_poly1(x[interval] - x[interval-1],
-                                        c, interval-1, jp, 0) - y
-                    vb = evaluate_poly1(0, c, interval, jp, 0) - y
-                    if (va < 0 and vb > 0) or (va > 0 and vb < 0):
-                        # sign change between intervals
-                        if x[interval] != last_root:
-                            last_root = x[interval]
-                            cur_roots.append(float(last_root))
-
-                # Compute first the complex roots
-                k = croots_poly1(c, y, interval, jp, wr, wi, &workspace)
-
-                # Check for errors and identically zero values
-                if k == -1:
-                    # Zero everywhere
-                    if x[interval] == x[interval+1]:
-                        # Only a point
-                        if x[interval] != last_root:
-                            last_root = x[interval]
-                            cur_roots.append(x[interval])
-                    else:
-                        # A real interval
+    for jp in range(c.shape[2]):
+        w.jp = jp
+        run_blocks(&w, w.m, real_roots_thread, nthreads)
+
+        cur_roots = []
+        for interval in range(c.shape[1]):
+            if discont[interval]:
+                # sign change between intervals
+                if x[interval] != last_root:
+                    last_root = x[interval]
+                    cur_roots.append(float(last_root))
+
+            # Check for errors and identically zero values
+            k = nroots[interval]
+            if k == -1:
+                # Zero everywhere
+                if x[interval] == x[interval+1]:
+                    # Only a point
+                    if x[interval] != last_root:
+                        last_root = x[interval]
                         cur_roots.append(x[interval])
-                        cur_roots.append(np.nan)
-                        last_root = nan
-                    continue
-                elif k < -1:
-                    # An error occurred
-                    raise RuntimeError("Internal error in root finding; "
-                                       "please report this bug")
-                elif k == 0:
-                    # No roots
-                    continue
+                else:
+                    # A real interval
+                    cur_roots.append(x[interval])
+                    cur_roots.append(np.nan)
+                    last_root = nan
+                continue
+            elif k < -1:
+                # An error occurred
+                raise RuntimeError("Internal error in root finding; "
+                                   "please report this bug")
 
-                # Filter real roots
-                for i in range(k):
-                    # Check real root
-                    #
-                    # The reality of a root is a decision that can be left to LAPACK,
-                    # which has to determine this in any case.
-                    if wi[i] != 0:
-                        continue
-
-                    # Refine root by one Newton iteration
-                    f = evaluate_poly1(wr[i], c, interval, jp, 0) - y
-                    df = evaluate_poly1(wr[i], c, interval, jp, 1)
-                    if df != 0:
-                        dx = f/df
-                        if abs(dx) < abs(wr[i]):
-                            wr[i] = wr[i] - dx
-
-                    # Check interval
-                    wr[i] += x[interval]
-                    if interval == 0 and extrapolate:
-                        # Half-open to the left/right.
-                        if (ascending and not wr[i] <= x[interval+1] or
-                            not ascending and not wr[i] >= x[interval + 1]):
-                                continue
-                    elif interval == c.shape[1] - 1 and extrapolate:
-                        # Half-open to the right/left.
-                        if (ascending and not wr[i] >= x[interval] or
-                            not ascending and not wr[i] <= x[interval]):
-                                continue
-                    else:
-                        if (ascending and
-                            not x[interval] <= wr[i] <= x[interval+1] or
-                            not ascending and
-                            not x[interval + 1] <= wr[i] <= x[interval]):
-                                continue
-
-                    # Add to list
-                    if wr[i] != last_root:
-                        last_root = wr[i]
-                        cur_roots.append(float(last_root))
-
-            # Construct roots
-            roots.append(np.array(cur_roots, dtype=float))
-    finally:
-        if workspace != NULL:
-            libc.stdlib.free(workspace)
-        libc.stdlib.free(wr)
-        libc.stdlib.free(wi)
+            # Add to list
+            for i in range(k):
+                if int_roots[interval, i] != last_root:
+                    last_root = int_roots[interval, i]
+                    cur_roots.append(float(last_root))
+
+        # Construct roots
+        roots.append(np.array(cur_roots, dtype=float))
 
     return roots
 
@@ -567,7 +789,7 @@ def real_roots(double[:,:,::1] c, double[::1] x, double y, bint report_discont,
 @cython.wraparound(False)
 @cython.boundscheck(False)
 @cython.cdivision(True)
-cdef int find_interval_ascending(double *x,
+cdef int find_interval_ascending(const double *x,
                                  size_t nx,
                                  double xval,
                                  int prev_interval=0,
@@ -652,7 +874,7 @@ cdef int find_interval_ascending(double *x,
 @cython.wraparound(False)
 @cython.boundscheck(False)
 @cython.cdivision(True)
-cdef int find_interval_descending(double *x,
+cdef int find_interval_descending(const double *x,
                                  size_t nx,
                                  double xval,
                                  int prev_interval=0,
@@ -757,6 +979,19 @@ cdef double_or_complex evaluate_poly1(double s, double_or_complex[:,:,::1] c, in
     dx : int
         Order of derivative (> 0) or antiderivative (< 0) to evaluate.
 
+    """
+    return poly1_eval(s, &c[0, ci, cj], c.shape[1] * c.shape[2],
+                      c.shape[0], dx)
+
+
+@cython.cdivision(True)
+cdef double_or_complex poly1_eval(double s, const double_or_complex *c,
+                                  Py_ssize_t stride, int kc, int dx) nogil:
+    """
+    Evaluate polynomial, derivative, or antiderivative in a single interval,
+    for the `kc` coefficients c[0], c[stride], ..., highest order first.
+    See evaluate_poly1.
+
     """
     cdef int kp, k
     cdef double_or_complex res, z
@@ -769,7 +1004,7 @@ cdef double_or_complex evaluate_poly1(double s, double_or_complex[:,:,::1] c, in
         for k in range(-dx):
             z *= s
 
-    for kp in range(c.shape[0]):
+    for kp in range(kc):
         # prefactor of term after differentiation
         if dx == 0:
             prefactor = 1.0
@@ -787,10 +1022,10 @@ cdef double_or_complex evaluate_poly1(double s, double_or_complex[:,:,::1] c, in
             for k in range(kp, kp - dx):
                 prefactor /= k + 1
 
-        res = res + c[c.shape[0] - kp - 1, ci, cj] * z * prefactor
+        res = res + c[(kc - kp - 1) * stride] * z * prefactor
 
         # compute x**max(k-dx,0)
-        if kp < c.shape[0] - 1 and kp >= dx:
+        if kp < kc - 1 and kp >= dx:
             z *= s
 
     return res
@@ -831,20 +1066,94 @@ cdef int croots_poly1(double[:,:,::1] c, double y, int ci, int cj,
 
     Notes
     -----
-    Uses LAPACK + the companion matrix method.
+    Uses closed forms up to cubic polynomials, and LAPACK + the companion
+    matrix method for higher orders.
+
+    """
+    return poly1_croots(&c[0, ci, cj], c.shape[1] * c.shape[2], c.shape[0],
+                        y, wr, wi, workspace)
+
+
+cdef void sort_roots(double *wr, double *wi, int n) nogil:
+    """
+    Sort the complex roots wr + 1j*wi by their real parts (insertion sort).
+    """
+    cdef int i, j
+    cdef double br, bi
+
+    for i in range(n):
+        br = wr[i]
+        bi = wi[i]
+        for j in range(i - 1, -1, -1):
+            if wr[j] > br:
+                wr[j+1] = wr[j]
+                wi[j+1] = wi[j]
+            else:
+                wr[j+1] = br
+                wi[j+1] = bi
+                break
+        else:
+            wr[0] = br
+            wi[0] = bi
+
+
+@cython.cdivision(True)
+cdef void quadratic_roots(double a0, double a1, double a2,
+                          double *wr, double *wi) nogil:
+    """
+    Find the roots of a0*x**2 + a1*x + a2, with a0 != 0.
+    """
+    cdef double d
+
+    d = a1*a1 - 4*a0*a2
+    if d < 0:
+        # no real roots
+        d = libc.math.sqrt(-d)
+        wr[0] = -a1/(2*a0)
+        wi[0] = -d/(2*a0)
+        wr[1] = -a1/(2*a0)
+        wi[1] = d/(2*a0)
+        return
+
+    d = libc.math.sqrt(d)
+
+    # avoid cancellation in subtractions
+    if d == 0:
+        wr[0] = -a1/(2*a0)
+        wi[0] = 0
+        wr[1] = -a1/(2*a0)
+        wi[1] = 0
+    elif a1 < 0:
+        wr[0] = (2*a2) / (-a1 + d) # == (-a1 - d)/(2*a0)
+        wi[0] = 0
+        wr[1] = (-a1 + d) / (2*a0)
+        wi[1] = 0
+    else:
+        wr[0] = (-a1 - d)/(2*a0)
+        wi[0] = 0
+        wr[1] = (2*a2) / (-a1 - d) # == (-a1 + d)/(2*a0)
+        wi[1] = 0
+
+
+@cython.cdivision(True)
+cdef int poly1_croots(const double *c, Py_ssize_t stride, int n, double y,
+                      double *wr, double *wi, void **workspace) nogil:
+    """
+    Find all complex roots of the polynomial with the `n` coefficients
+    c[0], c[stride], ..., highest order first. See croots_poly1; returns
+    -3 if the workspace could not be allocated.
 
     """
     cdef double *a
     cdef double *work
-    cdef double a0, a1, a2, d, br, bi, cc
-    cdef int lwork, n, i, j, order
+    cdef double a0, a1, a2, a3, b1, b2, cc
+    cdef double s, p, q, d, r, u, phi, x1, f, df
+    cdef int lwork, i, j, order
     cdef int nworkspace, info
 
-    n = c.shape[0]
-
     # Check actual polynomial order
     for j in range(n):
-        if c[j,ci,cj] != 0:
+        if c[j*stride] != 0:
             order = n - 1 - j
             break
     else:
@@ -859,53 +1168,76 @@ cdef int croots_poly1(double[:,:,::1] c, double y, int ci, int cj,
     elif order == 0:
         # Nonzero constant polynomial: no roots
         # (unless r.h.s. is exactly equal to the coefficient, that is.)
-        if c[n-1, ci, cj] == y:
+        if c[(n-1)*stride] == y:
             return -1
         else:
             return 0
     elif order == 1:
         # Low-order polynomial: a0*x + a1
-        a0 = c[n-1-order,ci,cj]
-        a1 = c[n-1-order+1,ci,cj] - y
+        a0 = c[(n-1-order)*stride]
+        a1 = c[(n-1-order+1)*stride] - y
         wr[0] = -a1 / a0
         wi[0] = 0
         return 1
     elif order == 2:
         # Low-order polynomial: a0*x**2 + a1*x + a2
-        a0 = c[n-1-order,ci,cj]
-        a1 = c[n-1-order+1,ci,cj]
-        a2 = c[n-1-order+2,ci,cj] - y
-
-        d = a1*a1 - 4*a0*a2
-        if d < 0:
-            # no real roots
-            d = libc.math.sqrt(-d)
-            wr[0] = -a1/(2*a0)
-            wi[0] = -d/(2*a0)
-            wr[1] = -a1/(2*a0)
-            wi[1] = d/(2*a0)
-            return 2
-
-        d = libc.math.sqrt(d)
-
-        # avoid cancellation in subtractions
-        if d == 0:
-            wr[0] = -a1/(2*a0)
-            wi[0] = 0
-            wr[1] = -a1/(2*a0)
-            wi[1] = 0
-        elif a1 < 0:
-            wr[0] = (2*a2) / (-a1 + d) # == (-a1 - d)/(2*a0)
-            wi[0] = 0
-            wr[1] = (-a1 + d) / (2*a0)
-            wi[1] = 0
+        quadratic_roots(c[(n-1-order)*stride], c[(n-1-order+1)*stride],
+                        c[(n-1-order+2)*stride] - y, wr, wi)
+        return 2
+    elif order == 3:
+        # Cubic polynomial a0*x**3 + a1*x**2 + a2*x + a3. Its real root of
+        # the largest magnitude (Cardano if there is only one, else the
+        # trigonometric method) is refined by Newton iterations, and the
+        # others are those of the quotient, deflated backward from it.
+        a0 = c[(n-1-order)*stride]
+        a1 = c[(n-1-order+1)*stride]
+        a2 = c[(n-1-order+2)*stride]
+        a3 = c[(n-1-order+3)*stride] - y
+
+        # the depressed cubic t**3 + p*t + q, with x = t - a1/(3*a0)
+        s = a1/(3*a0)
+        p = a2/a0 - 3*s*s
+        q = (2*s*s - a2/a0)*s + a3/a0
+        d = q*q/4 + p*p*p/27
+
+        if d > 0:
+            # One real root; the sign of the square root avoids
+            # cancellation in u
+            r = -q/2
+            u = libc.math.cbrt(r + libc.math.copysign(libc.math.sqrt(d), r))
+            x1 = u - p/(3*u) - s
+        elif p == 0:
+            # Triple root
+            x1 = -s
         else:
-            wr[0] = (-a1 - d)/(2*a0)
-            wi[0] = 0
-            wr[1] = (2*a2) / (-a1 - d) # == (-a1 + d)/(2*a0)
-            wi[1] = 0
+            # Three real roots
+            r = 2*libc.math.sqrt(-p/3)
+            phi = libc.math.acos(max(-1., min(1., 3*q/(p*r)))) / 3
+            x1 = 0
+            for i in range(3):
+                u = r*libc.math.cos(phi - 2*libc.math.M_PI*i/3) - s
+                if libc.math.fabs(u) > libc.math.fabs(x1):
+                    x1 = u
+
+        for i in range(2):
+            f = ((a0*x1 + a1)*x1 + a2)*x1 + a3
+            df = (3*a0*x1 + 2*a1)*x1 + a2
+            if df != 0:
+                x1 -= f/df
+
+        # a0*x**3 + ... == (x - x1)*(a0*x**2 + b1*x + b2)
+        if x1 != 0 and x1*x1*libc.math.fabs(x1*a0) >= libc.math.fabs(a3):
+            b2 = -a3/x1
+            b1 = (b2 - a2)/x1
+        else:
+            b1 = a1 + x1*a0
+            b2 = a2 + x1*b1
 
-        return 2
+        quadratic_roots(a0, b1, b2, wr, wi)
+        wr[2] = x1
+        wi[2] = 0
+        sort_roots(wr, wi, 3)
+        return 3
 
     # Compute required workspace and allocate it
     lwork = 1 + 8*n
@@ -913,6 +1245,8 @@ cdef int croots_poly1(double[:,:,::1] c, double y, int ci, int cj,
     if workspace[0] == NULL:
         nworkspace = n*n + lwork
         workspace[0] = libc.stdlib.malloc(nworkspace * sizeof(double))
+        if workspace[0] == NULL:
+            return -3
 
     a = <double*>workspace[0]
     work = a + n*n
@@ -921,10 +1255,10 @@ cdef int croots_poly1(double[:,:,::1] c, double y, int ci, int cj,
     for j in range(order*order):
         a[j] = 0
     for j in range(order):
-        cc = c[n-1-j,ci,cj]
+        cc = c[(n-1-j)*stride]
         if j == 0:
             cc -= y
-        a[j + (order-1)*order] = -cc / c[n-1-order,ci,cj]
+        a[j + (order-1)*order] = -cc / c[(n-1-order)*stride]
         if j + 1 < order:
             a[j+1 + order*j] = 1
 
@@ -936,21 +1270,7 @@ cdef int croots_poly1(double[:,:,::1] c, double y, int ci, int cj,
         # Failure
         return -2
 
-    # Sort roots (insertion sort)
-    for i in range(order):
-        br = wr[i]
-        bi = wi[i]
-        for j in range(i - 1, -1, -1):
-            if wr[j] > br:
-                wr[j+1] = wr[j]
-                wi[j+1] = wi[j]
-            else:
-                wr[j+1] = br
-                wi[j+1] = bi
-                break
-        else:
-            wr[0] = br
-            wi[0] = bi
+    sort_roots(wr, wi, order)
 
     # Return with roots
     return order
@@ -1013,12 +1333,10 @@ def _croots_poly1(double[:,:,::1] c, double_complex[:,:,::1] w, double y=0):
 # Piecewise Bernstein basis polynomials
 #------------------------------------------------------------------------------
 
-@cython.wraparound(False)
-@cython.boundscheck(False)
 @cython.cdivision(True)
 cdef double_or_complex evaluate_bpoly1(double_or_complex s,
-                                       double_or_complex[:,:,::1] c,
-                                       int ci, int cj) nogil:
+                                       const double_or_complex *c,
+                                       Py_ssize_t stride, int kc) nogil:
     """
     Evaluate polynomial in the Bernstein basis in a single interval.
 
@@ -1032,46 +1350,46 @@ cdef double_or_complex evaluate_bpoly1(double_or_complex s,
     ----------
     s : double
         Polynomial x-value
-    c : double[:,:,:]
-        Polynomial coefficients. c[:,ci,cj] will be used
-    ci, cj : int
-        Which of the coefs to use
+    c : double*
+        Polynomial coefficients c[0], c[stride], ..., c[(kc-1)*stride]
+    stride : Py_ssize_t
+        Distance between the coefficients
+    kc : int
+        Number of coefficients
 
     """
     cdef int k, j
     cdef double_or_complex res, s1, comb
 
-    k = c.shape[0] - 1  # polynomial order
+    k = kc - 1  # polynomial order
     s1 = 1. - s
 
     # special-case lowest orders
     if k == 0:
-        res = c[0, ci, cj]
+        res = c[0]
     elif k == 1:
-        res = c[0, ci, cj] * s1 + c[1, ci, cj] * s
+        res = c[0] * s1 + c[stride] * s
     elif k == 2:
-        res = c[0, ci, cj] * s1*s1 + c[1, ci, cj] * 2.*s1*s + c[2, ci, cj] * s*s
+        res = c[0] * s1*s1 + c[stride] * 2.*s1*s + c[2*stride] * s*s
     elif k == 3:
-        res = (c[0, ci, cj] * s1*s1*s1 + c[1, ci, cj] * 3.*s1*s1*s +
-               c[2, ci, cj] * 3.*s1*s*s + c[3, ci, cj] * s*s*s)
+        res = (c[0] * s1*s1*s1 + c[stride] * 3.*s1*s1*s +
+               c[2*stride] * 3.*s1*s*s + c[3*stride] * s*s*s)
     else:
         # XX: replace with de Casteljau's algorithm if needs be
         res, comb = 0., 1.
         for j in range(k+1):
-            res += comb * s**j * s1**(k-j) * c[j, ci, cj]
+            res += comb * s**j * s1**(k-j) * c[j*stride]
             comb *= 1. * (k-j) / (j+1.)
 
     return res
 
 
-@cython.wraparound(False)
-@cython.boundscheck(False)
 @cython.cdivision(True)
 cdef double_or_complex evaluate_bpoly1_deriv(double_or_complex s,
-                                             double_or_complex[:,:,::1] c,
-                                             int ci, int cj,
+                                             const double_or_complex *c,
+                                             Py_ssize_t stride, int kc,
                                              int nu,
-                                             double_or_complex[:,:,::1] wrk) nogil:
+                                             double_or_complex *wrk) nogil:
     """
     Evaluate the derivative of a polynomial in the Bernstein basis
     in a single interval.
@@ -1088,25 +1406,27 @@ cdef double_or_complex evaluate_bpoly1_deriv(double_or_complex s,
     ----------
     s : double
         Polynomial x-value
-    c : double[:,:,:]
-        Polynomial coefficients. c[:,ci,cj] will be used
-    ci, cj : int
-        Which of the coefs to use
+    c : double*
+        Polynomial coefficients c[0], c[stride], ..., c[(kc-1)*stride]
+    stride : Py_ssize_t
+        Distance between the coefficients
+    kc : int
+        Number of coefficients
     nu : int
         Order of the derivative to evaluate. Assumed strictly positive
         (no checks are made).
-    wrk : double[:,:,::1]
-        A work array, shape (c.shape[0]-nu, 1, 1).
+    wrk : double*
+        A work array of size max(kc-nu, 1).
 
     """
     cdef int k, j, a
     cdef double_or_complex res, term
     cdef double comb, poch
 
-    k = c.shape[0] - 1  # polynomial order
+    k = kc - 1  # polynomial order
 
     if nu == 0:
-        res = evaluate_bpoly1(s, c, ci, cj)
+        res = evaluate_bpoly1(s, c, stride, kc)
     else:
         poch = 1.
         for a in range(nu):
@@ -1116,10 +1436,10 @@ cdef double_or_complex evaluate_bpoly1_deriv(double_or_complex s,
         for a in range(k - nu + 1):
             term, comb = 0., 1.
             for j in range(nu+1):
-                term += c[j+a, ci, cj] * (-1)**(j+nu) * comb
+                term += c[(j+a)*stride] * (-1)**(j+nu) * comb
                 comb *= 1. * (nu-j) / (j+1)
-            wrk[a, 0, 0] = term * poch
-        res = evaluate_bpoly1(s, wrk, 0, 0)
+            wrk[a] = term * poch
+        res = evaluate_bpoly1(s, <const double_or_complex *>wrk, 1, kc - nu)
     return res
 
 #
@@ -1133,7 +1453,8 @@ def evaluate_bernstein(double_or_complex[:,:,::1] c,
              double[::1] xp,
              int nu,
              bint extrapolate,
-             double_or_complex[:,::1] out):
+             double_or_complex[:,::1] out,
+             int nthreads=1):
     """
     Evaluate a piecewise polynomial in the Bernstein basis.
 
@@ -1156,15 +1477,10 @@ def evaluate_bernstein(double_or_complex[:,:,::1] c,
     out : ndarray, shape (r, n)
         Value of each polynomial at each of the input points.
         This argument is modified in-place.
+    nthreads : int, optional
+        Number of threads evaluating blocks of points.
 
     """
-
-    cdef int ip, jp
-    cdef int interval
-    cdef double xval
-    cdef double_or_complex s, ds, ds_nu
-    cdef double_or_complex[:,:,::1] wrk
-
     # check derivative order
     if nu < 0:
         raise NotImplementedError("Cannot do antiderivatives in the B-basis yet.")
@@ -1176,44 +1492,7 @@ def evaluate_bernstein(double_or_complex[:,:,::1] c,
         raise ValueError("out and c have incompatible shapes")
     if c.shape[1] != x.shape[0] - 1:
         raise ValueError("x and c have incompatible shapes")
+    if nu > c.shape[0]:
+        raise ValueError("negative dimensions are not allowed")
 
-    if nu > 0:
-        if double_or_complex is double_complex:
-            wrk = np.empty((c.shape[0]-nu, 1, 1), dtype=np.complex_)
-        else:
-            wrk = np.empty((c.shape[0]-nu, 1, 1), dtype=np.float_)
-
-
-    interval = 0
-    cdef bint ascending = x[x.shape[0] - 1] >= x[0]
-
-    # Evaluate.
-    for ip in range(len(xp)):
-        xval = xp[ip]
-
-        # Find correct interval
-        if ascending:
-            i = find_interval_ascending(&x[0], x.shape[0], xval, interval,
-                                        extrapolate)
-        else:
-            i = find_interval_descending(&x[0], x.shape[0], xval, interval,
-                                         extrapolate)
-
-        if i < 0:
-            # xval was nan etc
-            for jp in range(c.shape[2]):
-                out[ip, jp] = nan
-            continue
-        else:
-            interval = i
-
-        # Evaluate the local polynomial(s)
-        ds = x[interval+1] - x[interval]
-        ds_nu = ds**nu
-        for jp in range(c.shape[2]):
-            s = (xval - x[interval]) / ds
-            if nu == 0:
-                out[ip, jp] = evaluate_bpoly1(s, c, interval, jp)
-            else:
-                out[ip, jp] = evaluate_bpoly1_deriv(s, c, interval, jp,
-                        nu, wrk) / ds_nu
+    evaluate_points(c, x, xp, nu, extrapolate, out, True, nthreads)
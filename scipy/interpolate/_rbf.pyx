@@ -0,0 +1,369 @@
+"""
+Compiled evaluation of Rbf with the euclidean norm and a named function.
+
+The interpolant is summed over the nodes, or over the neighbours of each
+point, without forming the matrix of the basis functions at all points.
+Points are processed in blocks on several threads.
+
+"""
+
+from __future__ import absolute_import
+
+cimport cython
+from libc.math cimport sqrt, exp, log
+from libc.stdlib cimport malloc, free
+from scipy.linalg.cython_lapack cimport dgesv
+
+cdef extern from "zeros_threads.h":
+    ctypedef struct zeros_mutex:
+        pass
+    void zeros_mutex_init(zeros_mutex *m) nogil
+    void zeros_mutex_destroy(zeros_mutex *m) nogil
+    void zeros_mutex_lock(zeros_mutex *m) nogil
+    void zeros_mutex_unlock(zeros_mutex *m) nogil
+    void zeros_run_threads(int nthreads, void (*func)(void *) nogil,
+                           void *arg) nogil
+
+cdef extern from "numpy/npy_math.h":
+    double nan "NPY_NAN"
+
+__all__ = ['KERNELS', 'evaluate_all', 'evaluate_sparse', 'evaluate_local']
+
+# The radial basis functions known to the compiled code
+KERNELS = {'multiquadric': 0, 'inverse_multiquadric': 1, 'gaussian': 2,
+           'linear': 3, 'cubic': 4, 'quintic': 5, 'thin_plate': 6,
+           'wendland': 7}
+
+# Number of points in a block of work of a thread
+DEF BLOCK_SIZE = 256
+
+
+cdef struct rbf_work:
+    # The shared state of the threads. The nodes xi are of shape (n, ndim),
+    # and the values (nodes, or data for local solves) of shape (n, m).
+    const double *xi
+    const double *values
+    Py_ssize_t n, m
+    int ndim
+    const double *x
+    Py_ssize_t npts
+    int kernel
+    double epsilon, smooth
+    # neighbours of each point, in CSR form for a compact support, or k of
+    # them for local solves
+    const Py_ssize_t *indptr
+    const Py_ssize_t *indices
+    Py_ssize_t k
+    double *out
+    # blocks of points, the next one to claim, and whether a thread ran out
+    # of memory
+    Py_ssize_t nblocks, next
+    bint nomem
+    zeros_mutex lock
+
+
+cdef Py_ssize_t claim_block(rbf_work *w) nogil:
+    # Returns the index of the next unprocessed block of points, or -1
+    cdef Py_ssize_t b
+    zeros_mutex_lock(&w.lock)
+    b = w.next
+    w.next += 1
+    if w.nomem or b >= w.nblocks:
+        b = -1
+    zeros_mutex_unlock(&w.lock)
+    return b
+
+
+@cython.cdivision(True)
+cdef inline double kernel(int kind, double r, double epsilon) nogil:
+    """
+    The radial basis function `kind` of KERNELS at the distance r.
+    """
+    cdef double t
+    if kind == 0:
+        t = 1.0/epsilon*r
+        return sqrt(t*t + 1)
+    elif kind == 1:
+        t = 1.0/epsilon*r
+        return 1.0/sqrt(t*t + 1)
+    elif kind == 2:
+        t = 1.0/epsilon*r
+        return exp(-t*t)
+    elif kind == 3:
+        return r
+    elif kind == 4:
+        return r*r*r
+    elif kind == 5:
+        return r*r*r*r*r
+    elif kind == 6:
+        return r*r*log(r) if r != 0 else 0
+    else:
+        t = r/epsilon
+        if t >= 1:
+            return 0
+        return (1 - t)**4 * (4*t + 1)
+
+
+cdef inline double distance(const double *a, const double *b, int ndim) nogil:
+    cdef int d
+    cdef double s = 0
+    for d in range(ndim):
+        s += (a[d] - b[d]) * (a[d] - b[d])
+    return sqrt(s)
+
+
+cdef void all_thread(void *arg) nogil:
+    """
+    Sums the basis functions of all the nodes at blocks of points.
+    """
+    cdef rbf_work *w = <rbf_work *>arg
+    cdef Py_ssize_t b, p, i, j
+    cdef const double *x
+    cdef double *out
+    cdef double phi
+
+    b = claim_block(w)
+    while b >= 0:
+        for p in range(b * BLOCK_SIZE, min(w.npts, (b + 1) * BLOCK_SIZE)):
+            x = w.x + p * w.ndim
+            out = w.out + p * w.m
+            for j in range(w.m):
+                out[j] = 0
+            for i in range(w.n):
+                phi = kernel(w.kernel, distance(x, w.xi + i * w.ndim, w.ndim),
+                             w.epsilon)
+                for j in range(w.m):
+                    out[j] += phi * w.values[i * w.m + j]
+        b = claim_block(w)
+
+
+cdef void sparse_thread(void *arg) nogil:
+    """
+    Sums the basis functions of the neighbours indices[indptr[p]:
+    indptr[p+1]] at blocks of points p.
+    """
+    cdef rbf_work *w = <rbf_work *>arg
+    cdef Py_ssize_t b, p, i, j, q
+    cdef const double *x
+    cdef double *out
+    cdef double phi
+
+    b = claim_block(w)
+    while b >= 0:
+        for p in range(b * BLOCK_SIZE, min(w.npts, (b + 1) * BLOCK_SIZE)):
+            x = w.x + p * w.ndim
+            out = w.out + p * w.m
+            for j in range(w.m):
+                out[j] = 0
+            for q in range(w.indptr[p], w.indptr[p+1]):
+                i = w.indices[q]
+                phi = kernel(w.kernel, distance(x, w.xi + i * w.ndim, w.ndim),
+                             w.epsilon)
+                for j in range(w.m):
+                    out[j] += phi * w.values[i * w.m + j]
+        b = claim_block(w)
+
+
+cdef void local_thread(void *arg) nogil:
+    """
+    Interpolates blocks of points from their k neighbours alone: the
+    weights of the neighbours are solved for with the k x k matrix of their
+    basis functions, as Rbf does with all the nodes.
+    """
+    cdef rbf_work *w = <rbf_work *>arg
+    cdef Py_ssize_t b, p, i, j, a, c
+    cdef const Py_ssize_t *nbr
+    cdef const double *x
+    cdef double *out
+    cdef int k = <int>w.k, m = <int>w.m, info
+    cdef double *A = <double *>malloc(k * k * sizeof(double))
+    cdef double *B = <double *>malloc(k * m * sizeof(double))
+    cdef double *phi = <double *>malloc(k * sizeof(double))
+    cdef int *ipiv = <int *>malloc(k * sizeof(int))
+
+    if A == NULL or B == NULL or phi == NULL or ipiv == NULL:
+        zeros_mutex_lock(&w.lock)
+        w.nomem = True
+        zeros_mutex_unlock(&w.lock)
+
+    b = claim_block(w)
+    while b >= 0:
+        for p in range(b * BLOCK_SIZE, min(w.npts, (b + 1) * BLOCK_SIZE)):
+            x = w.x + p * w.ndim
+            out = w.out + p * m
+            nbr = w.indices + p * k
+
+            # the symmetric matrix, and the data in Fortran order
+            for a in range(k):
+                for c in range(a + 1):
+                    A[a + c*k] = kernel(w.kernel,
+                                        distance(w.xi + nbr[a] * w.ndim,
+                                                 w.xi + nbr[c] * w.ndim,
+                                                 w.ndim), w.epsilon)
+                    A[c + a*k] = A[a + c*k]
+                A[a + a*k] -= w.smooth
+                for j in range(m):
+                    B[a + j*k] = w.values[nbr[a] * m + j]
+                phi[a] = kernel(w.kernel,
+                                distance(x, w.xi + nbr[a] * w.ndim, w.ndim),
+                                w.epsilon)
+
+            dgesv(&k, &m, A, &k, ipiv, B, &k, &info)
+
+            for j in range(m):
+                out[j] = 0
+                if info != 0:
+                    out[j] = nan
+                    continue
+                for a in range(k):
+                    out[j] += phi[a] * B[a + j*k]
+        b = claim_block(w)
+
+    free(A)
+    free(B)
+    free(phi)
+    free(ipiv)
+
+
+cdef int run_blocks(rbf_work *w, const double[:, ::1] xi,
+                    const double[:, ::1] values, const double[:, ::1] x,
+                    str function, double epsilon, double[:, ::1] out,
+                    void (*func)(void *) nogil, int nthreads) except -1:
+    """
+    Runs func(w) on up to nthreads threads, which claim the blocks of
+    points.
+    """
+    if function not in KERNELS:
+        raise ValueError("unknown function %r" % (function,))
+    if x.shape[1] != xi.shape[1]:
+        raise ValueError("x and xi have incompatible shapes")
+    if out.shape[0] != x.shape[0] or out.shape[1] != values.shape[1]:
+        raise ValueError("x, values and out have incompatible shapes")
+    if x.shape[0] == 0 or values.shape[1] == 0:
+        return 0
+
+    w.xi = &xi[0, 0]
+    w.values = &values[0, 0]
+    w.n = xi.shape[0]
+    w.m = values.shape[1]
+    w.ndim = <int>xi.shape[1]
+    w.x = &x[0, 0]
+    w.npts = x.shape[0]
+    w.kernel = KERNELS[function]
+    w.epsilon = epsilon
+    w.out = &out[0, 0]
+
+    w.nblocks = (w.npts + BLOCK_SIZE - 1) // BLOCK_SIZE
+    w.next = 0
+    w.nomem = False
+    nthreads = max(1, min(nthreads, w.nblocks))
+    zeros_mutex_init(&w.lock)
+    with nogil:
+        zeros_run_threads(nthreads, func, w)
+    zeros_mutex_destroy(&w.lock)
+    if w.nomem:
+        raise MemoryError()
+    return 0
+
+
+def evaluate_all(const double[:, ::1] xi, const double[:, ::1] nodes,
+                 const double[:, ::1] x, str function, double epsilon,
+                 double[:, ::1] out, int nthreads=1):
+    """
+    Evaluates ``sum_i function(|x - xi[i]|) * nodes[i]`` at the points x.
+
+    Parameters
+    ----------
+    xi : ndarray, shape (n, ndim)
+        The nodes.
+    nodes : ndarray, shape (n, m)
+        The weights of the nodes.
+    x : ndarray, shape (npts, ndim)
+        The points to evaluate at.
+    function : str
+        One of the keys of `KERNELS`.
+    epsilon : float
+        The scale of the function.
+    out : ndarray, shape (npts, m)
+        The values at the points.
+    nthreads : int, optional
+        Number of threads evaluating blocks of points.
+
+    """
+    cdef rbf_work w
+    if nodes.shape[0] != xi.shape[0]:
+        raise ValueError("xi and nodes have incompatible shapes")
+    run_blocks(&w, xi, nodes, x, function, epsilon, out, all_thread, nthreads)
+
+
+def evaluate_sparse(const double[:, ::1] xi, const double[:, ::1] nodes,
+                    const double[:, ::1] x, const Py_ssize_t[::1] indices,
+                    const Py_ssize_t[::1] indptr, str function,
+                    double epsilon, double[:, ::1] out, int nthreads=1):
+    """
+    As `evaluate_all`, summing over the nodes
+    ``indices[indptr[p]:indptr[p+1]]`` at the point ``x[p]`` alone, which
+    are those within the support of a compactly supported function.
+    """
+    cdef rbf_work w
+    cdef Py_ssize_t p
+    if nodes.shape[0] != xi.shape[0]:
+        raise ValueError("xi and nodes have incompatible shapes")
+    if indptr.shape[0] != x.shape[0] + 1:
+        raise ValueError("x and indptr have incompatible shapes")
+    for p in range(indices.shape[0]):
+        if not 0 <= indices[p] < xi.shape[0]:
+            raise ValueError("indices out of bounds")
+    if indptr[0] != 0 or indptr[x.shape[0]] > indices.shape[0]:
+        raise ValueError("invalid indptr")
+    for p in range(x.shape[0]):
+        if indptr[p] > indptr[p+1]:
+            raise ValueError("invalid indptr")
+    w.indptr = &indptr[0]
+    w.indices = &indices[0] if indices.shape[0] > 0 else NULL
+    run_blocks(&w, xi, nodes, x, function, epsilon, out, sparse_thread,
+               nthreads)
+
+
+def evaluate_local(const double[:, ::1] xi, const double[:, ::1] di,
+                   const double[:, ::1] x, const Py_ssize_t[:, ::1] neighbors,
+                   str function, double epsilon, double smooth,
+                   double[:, ::1] out, int nthreads=1):
+    """
+    Interpolates at each point ``x[p]`` from its nearest nodes
+    ``neighbors[p]`` alone.
+
+    Parameters
+    ----------
+    xi : ndarray, shape (n, ndim)
+        The nodes.
+    di : ndarray, shape (n, m)
+        The data at the nodes.
+    x : ndarray, shape (npts, ndim)
+        The points to interpolate at.
+    neighbors : ndarray of intp, shape (npts, k)
+        The nodes to interpolate each point from.
+    function : str
+        One of the keys of `KERNELS`.
+    epsilon, smooth : float
+        The scale of the function and the smoothing, as in `Rbf`.
+    out : ndarray, shape (npts, m)
+        The interpolated values, nan where the local system is singular.
+    nthreads : int, optional
+        Number of threads interpolating blocks of points.
+
+    """
+    cdef rbf_work w
+    cdef Py_ssize_t p, a
+    if di.shape[0] != xi.shape[0]:
+        raise ValueError("xi and di have incompatible shapes")
+    if neighbors.shape[0] != x.shape[0] or neighbors.shape[1] == 0:
+        raise ValueError("x and neighbors have incompatible shapes")
+    for p in range(neighbors.shape[0]):
+        for a in range(neighbors.shape[1]):
+            if not 0 <= neighbors[p, a] < xi.shape[0]:
+                raise ValueError("neighbors out of bounds")
+    w.indices = &neighbors[0, 0] if neighbors.shape[0] > 0 else NULL
+    w.k = neighbors.shape[1]
+    w.smooth = smooth
+    run_blocks(&w, xi, di, x, function, epsilon, out, local_thread, nthreads)
@@ -0,0 +1,373 @@
+"""
+Compiled evaluation of RegularGridInterpolator.
+
+The grid axes are concatenated into one array; the values are seen as a
+2-D array whose rows are the grid points, in C order, and whose columns
+are the trailing dimensions of the data. Points are processed in blocks
+on several threads.
+
+"""
+
+from __future__ import absolute_import
+
+import numpy as np
+
+cimport cython
+from libc.stdlib cimport malloc, free
+
+cdef extern from "zeros_threads.h":
+    ctypedef struct zeros_mutex:
+        pass
+    void zeros_mutex_init(zeros_mutex *m) nogil
+    void zeros_mutex_destroy(zeros_mutex *m) nogil
+    void zeros_mutex_lock(zeros_mutex *m) nogil
+    void zeros_mutex_unlock(zeros_mutex *m) nogil
+    void zeros_run_threads(int nthreads, void (*func)(void *) nogil,
+                           void *arg) nogil
+
+cdef extern from "numpy/npy_math.h":
+    double nan "NPY_NAN"
+
+ctypedef fused float_or_double:
+    float
+    double
+
+__all__ = ['MAX_NDIM', 'evaluate_linear', 'find_nearest']
+
+# Largest number of dimensions of the grid; a point is interpolated from
+# 2**ndim corners
+MAX_NDIM = 16
+
+# Number of points in a block of work of a thread
+DEF BLOCK_SIZE = 1024
+
+
+cdef struct grid_work:
+    # The shared state of the threads. values is a float or double array of
+    # shape (nrows, nvals), as given by is_float.
+    const double *grid
+    const Py_ssize_t *start
+    const Py_ssize_t *size
+    const Py_ssize_t *stride
+    const double *inv_step
+    int ndim
+    const void *values
+    bint is_float
+    Py_ssize_t nvals
+    const double *xi
+    Py_ssize_t npts
+    double *out
+    Py_ssize_t *idx
+    unsigned char *oob
+    # blocks of points, the next one to claim, and whether a thread ran out
+    # of memory
+    Py_ssize_t nblocks, next
+    bint nomem
+    zeros_mutex lock
+
+
+cdef Py_ssize_t claim_block(grid_work *w) nogil:
+    # Returns the index of the next unprocessed block of points, or -1
+    cdef Py_ssize_t b
+    zeros_mutex_lock(&w.lock)
+    b = w.next
+    w.next += 1
+    if w.nomem or b >= w.nblocks:
+        b = -1
+    zeros_mutex_unlock(&w.lock)
+    return b
+
+
+@cython.cdivision(True)
+cdef inline Py_ssize_t find_index(const double *g, Py_ssize_t n, double x,
+                                  double inv_step) nogil:
+    """
+    Returns ``searchsorted(g, x) - 1`` clipped to ``[0, n - 2]``, that is
+    the interval with g[i] < x <= g[i+1] for x within the axis.
+
+    The interval is first guessed as if the axis were uniform, so that
+    uniform axes take constant time; otherwise a binary search is used.
+
+    """
+    cdef Py_ssize_t i, lo, hi
+    cdef double t
+
+    if x != x:
+        # nan, sorted last
+        return n - 2
+
+    t = (x - g[0]) * inv_step
+    if t <= 0:
+        i = 0
+    elif t >= n - 2:
+        i = n - 2
+    else:
+        i = <Py_ssize_t>t
+    if (i == 0 or g[i] < x) and (i == n - 2 or x <= g[i+1]):
+        return i
+
+    lo = 0
+    hi = n - 2
+    while lo < hi:
+        i = (lo + hi) // 2
+        if x <= g[i+1]:
+            hi = i
+        else:
+            lo = i + 1
+    return lo
+
+
+@cython.cdivision(True)
+cdef inline Py_ssize_t locate(const grid_work *w, int d, double x,
+                              double *y) nogil:
+    """
+    Returns the interval of x on axis d, and its distance from the lower
+    edge in units of the interval in y (nan on axes of a single point).
+    """
+    cdef const double *g = w.grid + w.start[d]
+    cdef Py_ssize_t i, n = w.size[d]
+
+    if n < 2:
+        y[0] = nan
+        return 0
+    i = find_index(g, n, x, w.inv_step[d])
+    y[0] = (x - g[i]) / (g[i+1] - g[i])
+    return i
+
+
+cdef inline bint outside_grid(const grid_work *w, const double *x) nogil:
+    cdef int d
+    cdef const double *g
+    for d in range(w.ndim):
+        g = w.grid + w.start[d]
+        if x[d] < g[0] or x[d] > g[w.size[d] - 1]:
+            return True
+    return False
+
+
+cdef void linear_blocks(const float_or_double *values, grid_work *w) nogil:
+    """
+    Multilinear interpolation at blocks of points.
+
+    The weights of the 2**ndim corners are products of the weights of the
+    axes; they are built one axis at a time, so that each product of the
+    first axes is computed once and reused for all the later ones.
+
+    """
+    cdef Py_ssize_t b, p, j, c, ncorners, base, i, up, row
+    cdef int d
+    cdef double y, wc
+    cdef const double *x
+    cdef double *out
+    cdef const float_or_double *v
+    cdef double *weight = <double *>malloc((1 << w.ndim) * sizeof(double))
+    cdef Py_ssize_t *offset = <Py_ssize_t *>malloc(
+        (1 << w.ndim) * sizeof(Py_ssize_t))
+
+    if weight == NULL or offset == NULL:
+        zeros_mutex_lock(&w.lock)
+        w.nomem = True
+        zeros_mutex_unlock(&w.lock)
+
+    b = claim_block(w)
+    while b >= 0:
+        for p in range(b * BLOCK_SIZE, min(w.npts, (b + 1) * BLOCK_SIZE)):
+            x = w.xi + p * w.ndim
+            w.oob[p] = outside_grid(w, x)
+
+            weight[0] = 1
+            offset[0] = 0
+            ncorners = 1
+            base = 0
+            for d in range(w.ndim):
+                i = locate(w, d, x[d], &y)
+                base += i * w.stride[d]
+                up = w.stride[d] if w.size[d] > 1 else 0
+                for c in range(ncorners):
+                    weight[c + ncorners] = weight[c] * y
+                    offset[c + ncorners] = offset[c] + up
+                    weight[c] = weight[c] * (1 - y)
+                ncorners *= 2
+
+            out = w.out + p * w.nvals
+            for j in range(w.nvals):
+                out[j] = 0
+            for c in range(ncorners):
+                wc = weight[c]
+                row = base + offset[c]
+                v = values + row * w.nvals
+                for j in range(w.nvals):
+                    out[j] += wc * v[j]
+        b = claim_block(w)
+
+    free(weight)
+    free(offset)
+
+
+cdef void linear_thread(void *arg) nogil:
+    cdef grid_work *w = <grid_work *>arg
+    if w.is_float:
+        linear_blocks(<const float *>w.values, w)
+    else:
+        linear_blocks(<const double *>w.values, w)
+
+
+cdef void nearest_thread(void *arg) nogil:
+    """
+    Finds the rows of the nearest grid points of blocks of points.
+    """
+    cdef grid_work *w = <grid_work *>arg
+    cdef Py_ssize_t b, p, i, row
+    cdef int d
+    cdef double y
+    cdef const double *x
+
+    b = claim_block(w)
+    while b >= 0:
+        for p in range(b * BLOCK_SIZE, min(w.npts, (b + 1) * BLOCK_SIZE)):
+            x = w.xi + p * w.ndim
+            w.oob[p] = outside_grid(w, x)
+
+            row = 0
+            for d in range(w.ndim):
+                i = locate(w, d, x[d], &y)
+                if not y <= .5 and w.size[d] > 1:
+                    i += 1
+                row += i * w.stride[d]
+            w.idx[p] = row
+        b = claim_block(w)
+
+
+cdef class _Grid(object):
+    # The axes of a grid, concatenated, with what the threads need to
+    # locate points on them
+    cdef double[::1] grid
+    cdef Py_ssize_t[::1] start, size, stride
+    cdef double[::1] inv_step
+    cdef int ndim
+
+    def __init__(self, tuple axes):
+        cdef int d
+        self.ndim = len(axes)
+        if self.ndim == 0 or self.ndim > MAX_NDIM:
+            raise ValueError("the grid must have 1 to %d dimensions"
+                             % MAX_NDIM)
+        sizes = np.array([len(g) for g in axes], dtype=np.intp)
+        self.grid = np.ascontiguousarray(np.concatenate(axes), dtype=float)
+        self.size = sizes
+        self.start = np.concatenate(([0], np.cumsum(sizes)[:-1])).astype(
+            np.intp)
+        self.stride = np.concatenate((np.cumprod(sizes[::-1])[-2::-1],
+                                      [1])).astype(np.intp)
+        self.inv_step = np.zeros(self.ndim)
+        for d in range(self.ndim):
+            if sizes[d] > 1:
+                self.inv_step[d] = (sizes[d] - 1) / (axes[d][-1] - axes[d][0])
+
+    cdef void setup(self, grid_work *w, const double[:, ::1] xi,
+                    unsigned char[::1] oob):
+        w.grid = &self.grid[0]
+        w.start = &self.start[0]
+        w.size = &self.size[0]
+        w.stride = &self.stride[0]
+        w.inv_step = &self.inv_step[0]
+        w.ndim = self.ndim
+        w.npts = xi.shape[0]
+        w.xi = &xi[0, 0]
+        w.oob = &oob[0]
+
+
+cdef int run_blocks(grid_work *w, void (*func)(void *) nogil,
+                    int nthreads) except -1:
+    """
+    Runs func(w) on up to nthreads threads, which claim the blocks of
+    points.
+    """
+    w.nblocks = (w.npts + BLOCK_SIZE - 1) // BLOCK_SIZE
+    w.next = 0
+    w.nomem = False
+    nthreads = max(1, min(nthreads, w.nblocks))
+    zeros_mutex_init(&w.lock)
+    with nogil:
+        zeros_run_threads(nthreads, func, w)
+    zeros_mutex_destroy(&w.lock)
+    if w.nomem:
+        raise MemoryError()
+    return 0
+
+
+def evaluate_linear(tuple axes, const float_or_double[:, ::1] values,
+                    const double[:, ::1] xi, double[:, ::1] out,
+                    unsigned char[::1] out_of_bounds, int nthreads=1):
+    """
+    Multilinear interpolation on a regular grid.
+
+    Parameters
+    ----------
+    axes : tuple of ndarray
+        The strictly ascending points of each axis of the grid.
+    values : ndarray, shape (m, nvals)
+        The values at the grid points, in C order.
+    xi : ndarray, shape (npts, ndim)
+        The points to interpolate at.
+    out : ndarray, shape (npts, nvals)
+        The interpolated values; extrapolated outside of the grid.
+    out_of_bounds : ndarray of uint8, shape (npts,)
+        Whether each point is outside of the grid.
+    nthreads : int, optional
+        Number of threads interpolating blocks of points.
+
+    """
+    cdef _Grid grid = _Grid(axes)
+    cdef grid_work w
+
+    if xi.shape[1] != grid.ndim:
+        raise ValueError("xi and axes have incompatible shapes")
+    if (values.shape[0] != np.prod([len(g) for g in axes])
+            or out.shape[0] != xi.shape[0] or out.shape[1] != values.shape[1]
+            or out_of_bounds.shape[0] != xi.shape[0]):
+        raise ValueError("values, xi and out have incompatible shapes")
+    if xi.shape[0] == 0 or values.shape[1] == 0:
+        out_of_bounds[:] = 0
+        return
+
+    grid.setup(&w, xi, out_of_bounds)
+    w.values = &values[0, 0]
+    w.is_float = float_or_double is float
+    w.nvals = values.shape[1]
+    w.out = &out[0, 0]
+    run_blocks(&w, linear_thread, nthreads)
+
+
+def find_nearest(tuple axes, const double[:, ::1] xi, Py_ssize_t[::1] idx,
+                 unsigned char[::1] out_of_bounds, int nthreads=1):
+    """
+    Nearest-neighbour lookup on a regular grid.
+
+    Parameters
+    ----------
+    axes : tuple of ndarray
+        The strictly ascending points of each axis of the grid.
+    xi : ndarray, shape (npts, ndim)
+        The points to look up.
+    idx : ndarray of intp, shape (npts,)
+        The flat indices, in C order, of the grid points nearest to `xi`.
+    out_of_bounds : ndarray of uint8, shape (npts,)
+        Whether each point is outside of the grid.
+    nthreads : int, optional
+        Number of threads looking up blocks of points.
+
+    """
+    cdef _Grid grid = _Grid(axes)
+    cdef grid_work w
+
+    if xi.shape[1] != grid.ndim:
+        raise ValueError("xi and axes have incompatible shapes")
+    if idx.shape[0] != xi.shape[0] or out_of_bounds.shape[0] != xi.shape[0]:
+        raise ValueError("xi and idx have incompatible shapes")
+    if xi.shape[0] == 0:
+        return
+
+    grid.setup(&w, xi, out_of_bounds)
+    w.idx = &idx[0]
+    run_blocks(&w, nearest_thread, nthreads)
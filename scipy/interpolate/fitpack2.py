@@ -28,6 +28,7 @@ import numpy as np
 
 from . import fitpack
 from . import dfitpack
+from ._fitpack_impl import _evaluate_bispline
 
 
 # ############### Univariate spline ####################
@@ -799,7 +800,7 @@ class _BivariateSplineBase(object):
         """ Return spline coefficients."""
         return self.tck[2]
 
-    def __call__(self, x, y, dx=0, dy=0, grid=True):
+    def __call__(self, x, y, dx=0, dy=0, grid=True, workers=1):
         """
         Evaluate the spline or its derivatives at given positions.
 
@@ -831,6 +832,12 @@ class _BivariateSplineBase(object):
             input arrays, or at points specified by the input arrays.
 
             .. versionadded:: 0.14.0
+        workers : int, optional
+            Number of threads evaluating blocks of points, or of rows of
+            the grid; -1 uses all CPUs. The results do not depend on it.
+            Default is 1.
+
+            .. versionadded:: 1.4.0
 
         """
         x = np.asarray(x)
@@ -842,6 +849,10 @@ class _BivariateSplineBase(object):
             if x.size == 0 or y.size == 0:
                 return np.zeros((x.size, y.size), dtype=self.tck[2].dtype)
 
+            z = _evaluate_bispline(self.tck[:3], kx, ky, x, y, dx, dy, True,
+                                   workers)
+            if z is not None:
+                return z
             if dx or dy:
                 z, ier = dfitpack.parder(tx, ty, c, kx, ky, dx, dy, x, y)
                 if not ier == 0:
@@ -862,6 +873,10 @@ class _BivariateSplineBase(object):
             if x.size == 0 or y.size == 0:
                 return np.zeros(shape, dtype=self.tck[2].dtype)
 
+            z = _evaluate_bispline(self.tck[:3], kx, ky, x, y, dx, dy, False,
+                                   workers)
+            if z is not None:
+                return z.reshape(shape)
             if dx or dy:
                 z, ier = dfitpack.pardeu(tx, ty, c, kx, ky, dx, dy, x, y)
                 if not ier == 0:
@@ -955,7 +970,7 @@ class BivariateSpline(_BivariateSplineBase):
         self.degrees = tck[3:]
         return self
 
-    def ev(self, xi, yi, dx=0, dy=0):
+    def ev(self, xi, yi, dx=0, dy=0, workers=1):
         """
         Evaluate the spline at points
 
@@ -974,8 +989,14 @@ class BivariateSpline(_BivariateSplineBase):
             Order of y-derivative
 
             .. versionadded:: 0.14.0
+        workers : int, optional
+            Number of threads evaluating blocks of points; -1 uses all
+            CPUs. Default is 1.
+
+            .. versionadded:: 1.4.0
         """
-        return self.__call__(xi, yi, dx=dx, dy=dy, grid=False)
+        return self.__call__(xi, yi, dx=dx, dy=dy, grid=False,
+                             workers=workers)
 
     def integral(self, xa, xb, ya, yb):
         """
@@ -7,6 +7,7 @@ import itertools
 import warnings
 import functools
 import operator
+from multiprocessing import cpu_count
 
 import numpy as np
 from numpy import (array, transpose, searchsorted, atleast_1d, atleast_2d,
@@ -22,11 +23,17 @@ from . import dfitpack
 from . import _fitpack
 from .polyint import _Interpolator1D
 from . import _ppoly
+from . import _rgi
 from .fitpack2 import RectBivariateSpline
 from .interpnd import _ndim_coords_from_arrays
 from ._bsplines import make_interp_spline, BSpline
 
 
+def _nthreads(workers):
+    """Number of threads for `workers`; -1 means all CPUs."""
+    return cpu_count() if workers == -1 else max(int(workers), 1)
+
+
 def prod(x):
     """Product of a list of numbers; ~40x faster vs np.prod for Python tuples"""
     if len(x) == 0:
@@ -869,7 +876,7 @@ class _PPolyBase(object):
 
         self.c = c2
 
-    def __call__(self, x, nu=0, extrapolate=None):
+    def __call__(self, x, nu=0, extrapolate=None, workers=1):
         """
         Evaluate the piecewise polynomial or its derivative.
 
@@ -884,6 +891,11 @@ class _PPolyBase(object):
             based on first and last intervals, or to return NaNs.
             If 'periodic', periodic extrapolation is used.
             If None (default), use `self.extrapolate`.
+        workers : int, optional
+            Number of threads evaluating blocks of points; -1 uses all
+            CPUs. Default is 1.
+
+            .. versionadded:: 1.4.0
 
         Returns
         -------
@@ -913,7 +925,7 @@ class _PPolyBase(object):
 
         out = np.empty((len(x), prod(self.c.shape[2:])), dtype=self.c.dtype)
         self._ensure_c_contiguous()
-        self._evaluate(x, nu, extrapolate, out)
+        self._evaluate(x, nu, extrapolate, out, workers)
         out = out.reshape(x_shape + self.c.shape[2:])
         if self.axis != 0:
             # transpose to move the calculated values to the interpolation axis
@@ -982,9 +994,10 @@ class PPoly(_PPolyBase):
     unstable.  Precision problems can start to appear for orders
     larger than 20-30.
     """
-    def _evaluate(self, x, nu, extrapolate, out):
+    def _evaluate(self, x, nu, extrapolate, out, workers=1):
         _ppoly.evaluate(self.c.reshape(self.c.shape[0], self.c.shape[1], -1),
-                        self.x, x, nu, bool(extrapolate), out)
+                        self.x, x, nu, bool(extrapolate), out,
+                        _nthreads(workers))
 
     def derivative(self, nu=1):
         """
@@ -1166,7 +1179,7 @@ class PPoly(_PPolyBase):
         range_int *= sign
         return range_int.reshape(self.c.shape[2:])
 
-    def solve(self, y=0., discontinuity=True, extrapolate=None):
+    def solve(self, y=0., discontinuity=True, extrapolate=None, workers=1):
         """
         Find real solutions of the the equation ``pp(x) == y``.
 
@@ -1181,6 +1194,11 @@ class PPoly(_PPolyBase):
             If bool, determines whether to return roots from the polynomial
             extrapolated based on first and last intervals, 'periodic' works
             the same as False. If None (default), use `self.extrapolate`.
+        workers : int, optional
+            Number of threads finding the roots in blocks of intervals; -1
+            uses all CPUs. Default is 1.
+
+            .. versionadded:: 1.4.0
 
         Returns
         -------
@@ -1226,7 +1244,7 @@ class PPoly(_PPolyBase):
         y = float(y)
         r = _ppoly.real_roots(self.c.reshape(self.c.shape[0], self.c.shape[1], -1),
                               self.x, y, bool(discontinuity),
-                              bool(extrapolate))
+                              bool(extrapolate), _nthreads(workers))
         if self.c.ndim == 2:
             return r[0]
         else:
@@ -1238,7 +1256,7 @@ class PPoly(_PPolyBase):
 
             return r2.reshape(self.c.shape[2:])
 
-    def roots(self, discontinuity=True, extrapolate=None):
+    def roots(self, discontinuity=True, extrapolate=None, workers=1):
         """
         Find real roots of the the piecewise polynomial.
 
@@ -1251,6 +1269,11 @@ class PPoly(_PPolyBase):
             If bool, determines whether to return roots from the polynomial
             extrapolated based on first and last intervals, 'periodic' works
             the same as False. If None (default), use `self.extrapolate`.
+        workers : int, optional
+            Number of threads finding the roots in blocks of intervals; -1
+            uses all CPUs. Default is 1.
+
+            .. versionadded:: 1.4.0
 
         Returns
         -------
@@ -1265,7 +1288,7 @@ class PPoly(_PPolyBase):
         --------
         PPoly.solve
         """
-        return self.solve(0, discontinuity, extrapolate)
+        return self.solve(0, discontinuity, extrapolate, workers)
 
     @classmethod
     def from_spline(cls, tck, extrapolate=None):
@@ -1414,10 +1437,10 @@ class BPoly(_PPolyBase):
 
     """
 
-    def _evaluate(self, x, nu, extrapolate, out):
+    def _evaluate(self, x, nu, extrapolate, out, workers=1):
         _ppoly.evaluate_bernstein(
             self.c.reshape(self.c.shape[0], self.c.shape[1], -1),
-            self.x, x, nu, bool(extrapolate), out)
+            self.x, x, nu, bool(extrapolate), out, _nthreads(workers))
 
     def derivative(self, nu=1):
         """
@@ -2350,6 +2373,10 @@ class RegularGridInterpolator(object):
     return an array of `nan` values. Nearest-neighbor interpolation will work
     as usual in this case.
 
+    Float32 and float64 data are interpolated in compiled code, which
+    locates points on uniform axes in constant time and builds the
+    weights of the cell corners one axis at a time.
+
     .. versionadded:: 0.14
 
     Examples
@@ -2443,7 +2470,7 @@ class RegularGridInterpolator(object):
         self.grid = tuple([np.asarray(p) for p in points])
         self.values = values
 
-    def __call__(self, xi, method=None):
+    def __call__(self, xi, method=None, workers=1):
         """
         Interpolation at coordinates
 
@@ -2456,6 +2483,12 @@ class RegularGridInterpolator(object):
             The method of interpolation to perform. Supported are "linear" and
             "nearest".
 
+        workers : int, optional
+            Number of threads interpolating blocks of points; -1 uses all
+            CPUs. Default is 1.
+
+            .. versionadded:: 1.4.0
+
         """
         method = self.method if method is None else method
         if method not in ["linear", "nearest"]:
@@ -2478,20 +2511,50 @@ class RegularGridInterpolator(object):
                     raise ValueError("One of the requested xi is out of bounds "
                                      "in dimension %d" % i)
 
-        indices, norm_distances, out_of_bounds = self._find_indices(xi.T)
-        if method == "linear":
-            result = self._evaluate_linear(indices,
-                                           norm_distances,
-                                           out_of_bounds)
-        elif method == "nearest":
-            result = self._evaluate_nearest(indices,
-                                            norm_distances,
-                                            out_of_bounds)
+        if self._compiled(xi):
+            result, out_of_bounds = self._evaluate_compiled(xi, method,
+                                                            workers)
+        else:
+            indices, norm_distances, out_of_bounds = self._find_indices(xi.T)
+            if method == "linear":
+                result = self._evaluate_linear(indices,
+                                               norm_distances,
+                                               out_of_bounds)
+            elif method == "nearest":
+                result = self._evaluate_nearest(indices,
+                                                norm_distances,
+                                                out_of_bounds)
         if not self.bounds_error and self.fill_value is not None:
             result[out_of_bounds] = self.fill_value
 
         return result.reshape(xi_shape[:-1] + self.values.shape[ndim:])
 
+    def _compiled(self, xi):
+        # whether the compiled engine handles the values and the points
+        return (isinstance(self.values, np.ndarray) and
+                self.values.dtype in (np.float32, np.float64) and
+                self.values.size > 0 and
+                0 < len(self.grid) <= _rgi.MAX_NDIM and
+                all(np.isrealobj(g) for g in self.grid) and
+                np.isrealobj(xi))
+
+    def _evaluate_compiled(self, xi, method, workers):
+        ndim = len(self.grid)
+        values = np.ascontiguousarray(self.values)
+        values = values.reshape(prod(values.shape[:ndim]), -1)
+        xi = np.ascontiguousarray(xi, dtype=float)
+        nthreads = _nthreads(workers)
+        out_of_bounds = np.empty(xi.shape[0], dtype=np.uint8)
+        if method == "linear":
+            result = np.empty((xi.shape[0], values.shape[1]))
+            _rgi.evaluate_linear(self.grid, values, xi, result,
+                                 out_of_bounds, nthreads)
+        else:
+            idx = np.empty(xi.shape[0], dtype=np.intp)
+            _rgi.find_nearest(self.grid, xi, idx, out_of_bounds, nthreads)
+            result = values[idx]
+        return result, out_of_bounds.view(bool)
+
     def _evaluate_linear(self, indices, norm_distances, out_of_bounds):
         # slice for broadcasting over trailing dimensions in self.values
         vslice = (slice(None),) + (None,)*(self.values.ndim - len(indices))
@@ -2698,8 +2761,8 @@ class _ppform(PPoly):
     def __call__(self, x):
         return PPoly.__call__(self, x, 0, False)
 
-    def _evaluate(self, x, nu, extrapolate, out):
-        PPoly._evaluate(self, x, nu, extrapolate, out)
+    def _evaluate(self, x, nu, extrapolate, out, workers=1):
+        PPoly._evaluate(self, x, nu, extrapolate, out, workers)
         out[~((x >= self.a) & (x <= self.b))] = self.fill
         return out
 
@@ -64,7 +64,7 @@ class NearestNDInterpolator(NDInterpolatorBase):
         self.tree = cKDTree(self.points, **tree_options)
         self.values = np.asarray(y)
 
-    def __call__(self, *args):
+    def __call__(self, *args, workers=1):
         """
         Evaluate interpolator at given points.
 
@@ -72,12 +72,17 @@ class NearestNDInterpolator(NDInterpolatorBase):
         ----------
         xi : ndarray of float, shape (..., ndim)
             Points where to interpolate data at.
+        workers : int, optional
+            Number of threads querying the tree; -1 uses all CPUs.
+            Default is 1.
+
+            .. versionadded:: 1.4.0
 
         """
         xi = _ndim_coords_from_arrays(args, ndim=self.points.shape[1])
         xi = self._check_call_shape(xi)
         xi = self._scale_x(xi)
-        dist, i = self.tree.query(xi)
+        dist, i = self.tree.query(xi, n_jobs=workers)
         return self.values[i]
 
 
@@ -86,7 +91,7 @@ class NearestNDInterpolator(NDInterpolatorBase):
 #------------------------------------------------------------------------------
 
 def griddata(points, values, xi, method='linear', fill_value=np.nan,
-             rescale=False):
+             rescale=False, workers=1):
     """
     Interpolate unstructured D-dimensional data.
 
@@ -131,7 +136,13 @@ def griddata(points, values, xi, method='linear', fill_value=np.nan,
         incommensurable units and differ by many orders of magnitude.
 
         .. versionadded:: 0.14.0
-        
+    workers : int, optional
+        Number of threads interpolating in 2 or more dimensions, and
+        estimating the gradients of the 'cubic' method; -1 uses all CPUs.
+        Default is 1.
+
+        .. versionadded:: 1.4.0
+
     Returns
     -------
     ndarray
@@ -215,15 +226,15 @@ def griddata(points, values, xi, method='linear', fill_value=np.nan,
         return ip(xi)
     elif method == 'nearest':
         ip = NearestNDInterpolator(points, values, rescale=rescale)
-        return ip(xi)
+        return ip(xi, workers=workers)
     elif method == 'linear':
         ip = LinearNDInterpolator(points, values, fill_value=fill_value,
                                   rescale=rescale)
-        return ip(xi)
+        return ip(xi, workers=workers)
     elif method == 'cubic' and ndim == 2:
         ip = CloughTocher2DInterpolator(points, values, fill_value=fill_value,
-                                        rescale=rescale)
-        return ip(xi)
+                                        rescale=rescale, workers=workers)
+        return ip(xi, workers=workers)
     else:
         raise ValueError("Unknown interpolation method %r for "
                          "%d dimensional data" % (method, ndim))
@@ -46,12 +46,16 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 from __future__ import division, print_function, absolute_import
 
 import sys
+from multiprocessing import cpu_count
+
 import numpy as np
 
 from scipy import linalg
 from scipy._lib.six import callable, get_method_function, get_function_code
 from scipy.special import xlogy
+from scipy.spatial import cKDTree
 from scipy.spatial.distance import cdist, pdist, squareform
+from . import _rbf
 
 __all__ = ['Rbf']
 
@@ -79,6 +83,12 @@ class Rbf(object):
             'cubic': r**3
             'quintic': r**5
             'thin_plate': r**2 * log(r)
+            'wendland': (1 - r/self.epsilon)**4 * (4*r/self.epsilon + 1)
+                        for r < self.epsilon, 0 beyond
+
+        'wendland' has a compact support of radius `epsilon`, which should
+        then span a few nodes. With the euclidean norm, its weights are
+        solved for with a sparse matrix, so that many nodes can be used.
 
         If callable, then it must take 2 arguments (self, r).  The epsilon
         parameter will be available as self.epsilon.  Other keyword
@@ -104,6 +114,14 @@ class Rbf(object):
         '1-D' the data `d` will be considered as one-dimensional and flattened
         internally. When it is 'N-D' the data `d` is assumed to be an array of
         shape (n_samples, m), where m is the dimension of the target domain.
+    neighbors : int, optional
+        If given, each point is interpolated from this many nearest nodes
+        alone, with weights solved for from their data as `Rbf` does with
+        all the nodes; `nodes` is then None. This takes time linear in the
+        number of nodes, but the interpolant is only piecewise smooth. The
+        function must be a name and the norm euclidean.
+
+        .. versionadded:: 1.4.0
 
 
     Attributes
@@ -126,8 +144,17 @@ class Rbf(object):
         Mode of the interpolation.  See description under Parameters.
     nodes : ndarray
         A 1-D array of node values for the interpolation.
+    neighbors : int or None
+        The number of nodes each point is interpolated from, if not all.
     A : internal property, do not use
 
+    Notes
+    -----
+    With the euclidean norm and a named function, the interpolant is
+    evaluated in compiled code, on several threads with
+    ``rbfi(xi, ..., workers=n)``, without forming the matrix of the basis
+    functions at all points and nodes.
+
     Examples
     --------
     >>> from scipy.interpolate import Rbf
@@ -162,8 +189,12 @@ class Rbf(object):
     def _h_thin_plate(self, r):
         return xlogy(r**2, r)
 
-    # Setup self._function and do smoke test on initial r
-    def _init_function(self, r):
+    def _h_wendland(self, r):
+        t = np.minimum(1.0/self.epsilon*r, 1)
+        return (1 - t)**4 * (4*t + 1)
+
+    # Lower-case and map the aliases of a named function
+    def _normalize_function(self):
         if isinstance(self.function, str):
             self.function = self.function.lower()
             _mapped = {'inverse': 'inverse_multiquadric',
@@ -172,6 +203,23 @@ class Rbf(object):
             if self.function in _mapped:
                 self.function = _mapped[self.function]
 
+    # The name of the function if it can be evaluated in compiled code
+    def _compiled_function(self):
+        if (not isinstance(self.function, str) or self.norm != 'euclidean'
+                or self.function not in _rbf.KERNELS):
+            return None
+        func_name = "_h_" + self.function
+        # a subclass may redefine the function
+        if getattr(type(self), func_name, None) is not getattr(Rbf,
+                                                               func_name):
+            return None
+        return self.function
+
+    # Setup self._function and do smoke test on initial r
+    def _init_function(self, r):
+        if isinstance(self.function, str):
+            self._normalize_function()
+
             func_name = "_h_" + self.function
             if hasattr(self, func_name):
                 self._function = getattr(self, func_name)
@@ -251,14 +299,30 @@ class Rbf(object):
 
         self.smooth = kwargs.pop('smooth', 0.0)
         self.function = kwargs.pop('function', 'multiquadric')
+        self.neighbors = kwargs.pop('neighbors', None)
 
         # attach anything left in kwargs to self for use by any user-callable
         # function or to save on the object returned.
         for item, value in kwargs.items():
             setattr(self, item, value)
 
+        self._normalize_function()
+        compiled = self._compiled_function()
+        if self.neighbors is not None or compiled == 'wendland':
+            self._tree = cKDTree(self.xi.T)
+
         # Compute weights
-        if self._target_dim > 1:  # If we have more than one target dimension,
+        if self.neighbors is not None:
+            if compiled is None:
+                raise ValueError("neighbors needs a named function and the "
+                                 "euclidean norm")
+            if int(self.neighbors) < 1:
+                raise ValueError("neighbors must be positive")
+            self.neighbors = min(int(self.neighbors), self.N)
+            self.nodes = None
+        elif compiled == 'wendland':
+            self.nodes = self._solve_sparse()
+        elif self._target_dim > 1:  # If we have more than one target dimension,
             # we first factorize the matrix
             self.nodes = np.zeros((self.N, self._target_dim), dtype=self.di.dtype)
             lu, piv = linalg.lu_factor(self.A)
@@ -267,6 +331,24 @@ class Rbf(object):
         else:
             self.nodes = linalg.solve(self.A, self.di)
 
+    def _solve_sparse(self):
+        # The matrix of a compactly supported function is sparse
+        from scipy.sparse import coo_matrix, identity
+        from scipy.sparse.linalg import splu
+
+        pairs = self._tree.sparse_distance_matrix(self._tree, self.epsilon,
+                                                  output_type='ndarray')
+        pairs = pairs[pairs['i'] != pairs['j']]
+        A = coo_matrix((self._h_wendland(pairs['v']),
+                        (pairs['i'], pairs['j'])), shape=(self.N, self.N))
+        A = (A + (1 - self.smooth) * identity(self.N)).tocsc()
+        lu = splu(A)
+        di = np.asarray(self.di)
+        if np.iscomplexobj(di):
+            return lu.solve(di.real.astype(float)) + 1j*lu.solve(
+                di.imag.astype(float))
+        return lu.solve(di.astype(float))
+
     @property
     def A(self):
         # this only exists for backwards compatibility: self.A was available
@@ -277,7 +359,50 @@ class Rbf(object):
     def _call_norm(self, x1, x2):
         return cdist(x1.T, x2.T, self.norm)
 
-    def __call__(self, *args):
+    def _evaluate_compiled(self, function, values, x, nthreads):
+        # values are the nodes, or the data with neighbors; complex ones are
+        # done as two real ones
+        values = np.asarray(values).reshape(self.N, -1)
+        if np.iscomplexobj(values):
+            return (self._evaluate_compiled(function, values.real, x,
+                                            nthreads) +
+                    1j*self._evaluate_compiled(function, values.imag, x,
+                                               nthreads))
+        values = np.ascontiguousarray(values, dtype=float)
+        xi = np.ascontiguousarray(self.xi.T)
+        out = np.empty((x.shape[0], values.shape[1]))
+        if self.neighbors is not None:
+            _, idx = self._tree.query(x, k=self.neighbors, n_jobs=nthreads)
+            idx = np.ascontiguousarray(idx.reshape(x.shape[0], -1),
+                                       dtype=np.intp)
+            _rbf.evaluate_local(xi, values, x, idx, function, self.epsilon,
+                                self.smooth, out, nthreads)
+        elif function == 'wendland':
+            indices, indptr = self._tree.query_ball_point(
+                x, self.epsilon, n_jobs=nthreads, output_type='csr')
+            _rbf.evaluate_sparse(xi, values, x, indices, indptr, function,
+                                 self.epsilon, out, nthreads)
+        else:
+            _rbf.evaluate_all(xi, values, x, function, self.epsilon, out,
+                              nthreads)
+        return out
+
+    def __call__(self, *args, workers=1):
+        """
+        Evaluate the interpolant at the points with coordinates `args`.
+
+        Parameters
+        ----------
+        *args : arrays
+            The coordinates of the points, all of the same shape.
+        workers : int, optional
+            Number of threads evaluating the interpolant, with the
+            euclidean norm and a named function; -1 uses all CPUs. The
+            results do not depend on it. Default is 1.
+
+            .. versionadded:: 1.4.0
+
+        """
         args = [np.asarray(x) for x in args]
         if not all([x.shape == y.shape for x in args for y in args]):
             raise ValueError("Array lengths must be equal")
@@ -286,5 +411,12 @@ class Rbf(object):
         else:
             shp = args[0].shape
         xa = np.asarray([a.flatten() for a in args], dtype=np.float_)
+        function = self._compiled_function()
+        if function is not None:
+            nthreads = cpu_count() if workers == -1 else max(int(workers), 1)
+            x = np.ascontiguousarray(xa.T)
+            values = self.di if self.neighbors is not None else self.nodes
+            return self._evaluate_compiled(function, values, x,
+                                           nthreads).reshape(shp)
         r = self._call_norm(xa, self.xi)
         return np.dot(self._function(r), self.nodes).reshape(shp)
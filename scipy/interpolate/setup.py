@@ -14,17 +14,35 @@ def configuration(parent_package='',top_path=None):
     fitpack_src = [join('fitpack', '*.f')]
     config.add_library('fitpack', sources=fitpack_src)
 
+    zeros_dir = join('..', 'optimize', 'Zeros')
     config.add_extension('interpnd',
-                         sources=['interpnd.c'])
+                         sources=['interpnd.c'],
+                         include_dirs=[zeros_dir],
+                         depends=[join(zeros_dir, 'zeros_threads.h')])
 
     config.add_extension('_ppoly',
                          sources=['_ppoly.c'],
-                         **lapack_opt)
+                         include_dirs=[zeros_dir],
+                         depends=[join(zeros_dir, 'zeros_threads.h')],
+                         extra_info=lapack_opt)
 
     config.add_extension('_bspl',
                          sources=['_bspl.c'],
                          libraries=['fitpack'],
-                         depends=['src/__fitpack.h'] + fitpack_src)
+                         include_dirs=[zeros_dir],
+                         depends=(['src/__fitpack.h',
+                                   join(zeros_dir, 'zeros_threads.h')]
+                                  + fitpack_src))
+
+    config.add_extension('_rgi',
+                         sources=['_rgi.c'],
+                         include_dirs=[zeros_dir],
+                         depends=[join(zeros_dir, 'zeros_threads.h')])
+
+    config.add_extension('_rbf',
+                         sources=['_rbf.c'],
+                         include_dirs=[zeros_dir],
+                         depends=[join(zeros_dir, 'zeros_threads.h')])
 
     config.add_extension('_fitpack',
                          sources=['src/_fitpackmodule.c'],
@@ -230,6 +230,29 @@ class TestBSpline(object):
         xx = np.linspace(t[k], t[-k], 100)
         assert_allclose(b(xx), pp(xx), atol=1e-14, rtol=1e-14)
 
+    def test_workers(self):
+        # unsorted points, with nans, several blocks of points and
+        # complex coefficients
+        np.random.seed(1234)
+        b = _make_random_spline()
+        t, c, k = b.tck
+        xx = np.random.uniform(t[0] - 1, t[-1] + 1, 10000)
+        xx[::97] = np.nan
+        order = np.argsort(xx)
+        for nu in [0, 1]:
+            for extrapolate in [True, False]:
+                expected = b(xx, nu, extrapolate)
+                assert_equal(b(xx, nu, extrapolate, workers=4), expected)
+                assert_equal(b(xx[order], nu, extrapolate), expected[order])
+
+        bc = BSpline(t, c * (1 + 2j), k)
+        assert_allclose(bc(xx, workers=4), b(xx) * (1 + 2j), rtol=1e-14)
+
+        # the binary search of the intervals
+        mask = (xx >= t[k]) & (xx <= t[-k-1])
+        assert_allclose(b(xx[mask]), splev(xx[mask], (t, c, k)),
+                        atol=1e-14)
+
     def test_derivative_rndm(self):
         b = _make_random_spline()
         t, c, k = b.tck
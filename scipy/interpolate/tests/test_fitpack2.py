@@ -8,6 +8,7 @@ from scipy._lib._numpy_compat import suppress_warnings
 from pytest import raises as assert_raises
 
 from numpy import array, diff, linspace, meshgrid, ones, pi, shape
+from scipy.interpolate import dfitpack
 from scipy.interpolate.fitpack import bisplrep, bisplev
 from scipy.interpolate.fitpack2 import (UnivariateSpline,
         LSQUnivariateSpline, InterpolatedUnivariateSpline,
@@ -440,6 +441,43 @@ class TestRectBivariateSpline(object):
         lut = RectBivariateSpline(x,y,z)
         assert_allclose(lut(x, y), lut(x[:,None], y[None,:], grid=False))
 
+    def test_compiled(self):
+        # The compiled evaluation agrees with FITPACK, also beyond the
+        # knots and for any number of threads
+        np.random.seed(1234)
+        x = np.linspace(0, 1, 30)
+        y = np.linspace(-1, 2, 40)
+        z = np.random.rand(30, 40)
+        lut = RectBivariateSpline(x, y, z, kx=3, ky=2, s=0.5)
+        tx, ty, c = lut.tck
+        kx, ky = lut.degrees
+
+        xg = np.sort(np.random.rand(500) * 1.4 - 0.2)
+        yg = np.sort(np.random.rand(300) * 4 - 1.5)
+        xp, yp = np.random.rand(2, 20000) * 3 - 1
+        for dx, dy in [(0, 0), (1, 0), (0, 1), (2, 1)]:
+            if dx or dy:
+                zg, ier = dfitpack.parder(tx, ty, c, kx, ky, dx, dy, xg, yg)
+                zp, ier = dfitpack.pardeu(tx, ty, c, kx, ky, dx, dy, xp, yp)
+            else:
+                zg, ier = dfitpack.bispev(tx, ty, c, kx, ky, xg, yg)
+                zp, ier = dfitpack.bispeu(tx, ty, c, kx, ky, xp, yp)
+            for workers in (1, 3, -1):
+                assert_allclose(lut(xg, yg, dx=dx, dy=dy, workers=workers),
+                                zg, rtol=1e-12, atol=1e-12)
+                assert_allclose(lut.ev(xp, yp, dx=dx, dy=dy,
+                                       workers=workers),
+                                zp, rtol=1e-12, atol=1e-12)
+            if dx == 0 and dy == 0:
+                assert_allclose(bisplev(xg, yg, (tx, ty, c, kx, ky)), zg,
+                                rtol=1e-12, atol=1e-12)
+
+        # FITPACK still reports errors
+        assert_raises(ValueError, lut, xg[::-1], yg)
+        assert_raises(ValueError, lut, xg, yg, dx=3)
+        assert_equal(np.isnan(lut.ev([np.nan, 0.5], [0.5, 0.5])),
+                     [True, False])
+
 
 class TestRectSphereBivariateSpline(object):
     def test_defaults(self):
@@ -168,6 +168,22 @@ class TestLinearNDInterpolation(object):
 
         assert_almost_equal(ip(0.5, 0.5), ip2(0.5, 0.5))
 
+    def test_workers(self):
+        # Threads interpolate blocks of points, with the same results
+        np.random.seed(1234)
+        x = np.random.rand(200, 3)
+        y = np.random.rand(200, 2) + 1j*np.random.rand(200, 2)
+        xi = np.random.rand(150000, 3) * 1.2 - 0.1
+
+        ip = interpnd.LinearNDInterpolator(x, y, fill_value=-1)
+        yi = ip(xi)
+        assert_equal(yi.shape, (150000, 2))
+        assert_equal(np.isnan(yi).any(), False)
+        for workers in (3, -1):
+            assert_equal(ip(xi, workers=workers), yi)
+            assert_equal(ip(xi[:10], workers=workers), yi[:10])
+            assert_equal(ip(xi[:0], workers=workers).shape, (0, 2))
+
 
 class TestEstimateGradients2DGlobal(object):
     def test_smoketest(self):
@@ -205,6 +221,30 @@ class TestEstimateGradients2DGlobal(object):
                        "Gradient estimation did not converge")
             interpnd.estimate_gradients_2d_global(tri, values, maxiter=1)
 
+    def test_workers(self):
+        # Large triangulations are relaxed on threads, colour by colour,
+        # independently of the number of threads
+        np.random.seed(1234)
+        x = np.random.rand(10000, 2)
+        tri = qhull.Delaunay(x)
+        z = np.column_stack([x[:,0]**2 + x[:,1], np.sin(3*x[:,0])])
+
+        with suppress_warnings() as sup:
+            sup.filter(interpnd.GradientEstimationWarning,
+                       "Gradient estimation did not converge")
+            dz2 = interpnd.estimate_gradients_2d_global(tri, z, maxiter=20,
+                                                        workers=2)
+            dz4 = interpnd.estimate_gradients_2d_global(tri, z, maxiter=20,
+                                                        workers=4)
+            assert_equal(dz2.shape, (10000, 2, 2))
+            assert_equal(dz2, dz4)
+
+            # Small ones are relaxed serially
+            tri = qhull.Delaunay(x[:100])
+            assert_equal(
+                interpnd.estimate_gradients_2d_global(tri, z[:100], workers=4),
+                interpnd.estimate_gradients_2d_global(tri, z[:100]))
+
 
 class TestCloughTocher2DInterpolator(object):
 
@@ -348,6 +388,19 @@ class TestCloughTocher2DInterpolator(object):
 
         assert_almost_equal(ip(0.5, 0.5), ip2(0.5, 0.5))
 
+    def test_workers(self):
+        # Threads interpolate blocks of points, with the same results
+        np.random.seed(1234)
+        x = np.random.rand(100, 2)
+        y = np.random.rand(100, 3) + 1j*np.random.rand(100, 3)
+        xi = np.random.rand(150000, 2) * 1.2 - 0.1
+
+        ip = interpnd.CloughTocher2DInterpolator(x, y, fill_value=0)
+        yi = ip(xi)
+        assert_equal(yi.shape, (150000, 3))
+        for workers in (3, -1):
+            assert_equal(ip(xi, workers=workers), yi)
+
     def test_boundary_tri_symmetry(self):
         # Interpolation at neighbourless triangles should retain
         # symmetry with mirroring the triangle.
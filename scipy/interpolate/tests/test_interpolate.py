@@ -912,6 +912,20 @@ class TestPPolyCommon(object):
                 assert_allclose(p(xp, nu).real, p_re(xp, nu))
                 assert_allclose(p(xp, nu).imag, p_im(xp, nu))
 
+    def test_workers(self):
+        # evaluation in blocks of points on several threads
+        np.random.seed(1234)
+        x = np.sort(np.random.random(40))
+        c = np.random.random((5, 39, 2)) * (1. + 0.3j)
+        xp = np.random.uniform(-0.1, 1.1, 10000)
+        xp[::97] = np.nan
+        for cls in (PPoly, BPoly):
+            for cc in (c.real, c):
+                for p in (cls(cc, x), cls(cc[:, ::-1], x[::-1])):
+                    for nu in [0, 2]:
+                        assert_equal(p(xp, nu, workers=3), p(xp, nu))
+                        assert_equal(p(xp, nu, workers=-1), p(xp, nu))
+
     def test_axis(self):
         np.random.seed(12345)
         c = np.random.rand(3, 4, 5, 6, 7, 8)
@@ -1452,6 +1466,43 @@ class TestPPoly(object):
                 res = res[~np.isnan(res)]
                 assert_allclose(res, 0, atol=1e-10)
 
+    def test_roots_cubic(self):
+        # Cubic polynomials are solved in closed form
+        c = np.array([[1, -6, 11, -6], [1, 0, 0, -1], [1, -3, 3, -1],
+                      [1, -1, -1, 1], [1e-6, 1, -1, 1e-7]])
+        c = np.ascontiguousarray(c.T[:, :, None])
+        w = np.empty(c.shape, dtype=complex)
+        _ppoly._croots_poly1(c, w)
+        assert_allclose(w[:3, 0, 0], [1, 2, 3])
+        assert_allclose(w[:3, 1, 0], [-0.5 - 0.75**0.5*1j,
+                                      -0.5 + 0.75**0.5*1j, 1])
+        assert_allclose(w[:3, 2, 0], [1, 1, 1])
+        assert_allclose(w[:3, 3, 0], [-1, 1, 1])
+
+        # widely separated roots, tiny leading coefficient
+        w = w[:3, 4, 0]
+        assert_allclose(np.polyval(c[:, 4, 0], w) /
+                        np.polyval(abs(c[:, 4, 0]), abs(w)), 0, atol=1e-14)
+        assert_allclose(w, [-1e6 - 1, 1e-7, 1], rtol=1e-5)
+
+    def test_roots_workers(self):
+        # intervals are searched for roots in blocks on several threads
+        np.random.seed(1234)
+        x = np.linspace(0, 100, 10001)
+        y = np.sin(x) + 0.1*np.random.rand(x.size)
+        spl = Akima1DInterpolator(x, y)
+        r = spl.roots()
+        assert_(r.size > 10)
+        assert_equal(spl.roots(workers=4), r)
+        assert_equal(spl.solve(0.5, workers=-1), spl.solve(0.5))
+
+        c = 2*np.random.rand(6, 9000, 2, 3) - 1
+        pp = PPoly(c, np.linspace(0, 1, 9001))
+        r, r2 = pp.roots(), pp.roots(workers=3)
+        for i in range(2):
+            for j in range(3):
+                assert_equal(r2[i, j], r[i, j])
+
     def test_extrapolate_attr(self):
         # [ 1 - x**2 ]
         c = np.array([[-1, 0, 1]]).T
@@ -2569,6 +2620,36 @@ class TestRegularGridInterpolator(object):
         interpolator = RegularGridInterpolator(points, values)
         interpolator = RegularGridInterpolator(points, values, fill_value=0.)
 
+    def test_compiled(self):
+        # the compiled engine agrees with the reference implementation, on
+        # uniform and nonuniform axes, for float32 data and in threads
+        np.random.seed(1234)
+        points = (np.linspace(0, 1, 7), np.sort(np.random.rand(5)),
+                  np.array([2., 3.]), np.linspace(-3, 3, 4)**3)
+        values = np.random.rand(7, 5, 2, 4, 2)
+        xi = np.random.uniform(-0.2, 1.2, (5000, 4))
+        xi[:, 2] += 1.8
+        xi[:, 3] *= 30
+        xi[:100] = np.array([p[0] for p in points])
+        xi[100:200, 0] = points[0][3]
+
+        for dtype in (np.float64, np.float32):
+            for method in ('linear', 'nearest'):
+                interp = RegularGridInterpolator(points, values.astype(dtype),
+                                                 method=method,
+                                                 bounds_error=False)
+                idx, dist, oob = interp._find_indices(xi.T)
+                if method == 'linear':
+                    expected = interp._evaluate_linear(idx, dist, oob)
+                else:
+                    expected = interp._evaluate_nearest(idx, dist, oob)
+                expected[oob] = np.nan
+
+                for workers in (1, 3, -1):
+                    v = interp(xi, workers=workers)
+                    assert_equal(v.dtype, expected.dtype)
+                    assert_allclose(v, expected, rtol=1e-13, atol=1e-13)
+
 
 class MyValue(object):
     """
@@ -76,6 +76,17 @@ class TestGriddata(object):
                 assert_allclose(yi, np.tile(y[:,None], (1, 3)),
                                 atol=1e-14, err_msg=msg)
 
+    def test_workers(self):
+        np.random.seed(1234)
+        x = np.random.rand(50, 2)
+        y = np.random.rand(50)
+        xi = np.random.rand(70000, 2)
+
+        for method in ('nearest', 'linear', 'cubic'):
+            yi = griddata(x, y, xi, method=method)
+            assert_array_equal(griddata(x, y, xi, method=method, workers=3),
+                               yi, err_msg=method)
+
     def test_1d(self):
         x = np.array([1, 2.5, 3, 4.5, 5, 6])
         y = np.array([1, 2, 0, 3.9, 2, 1])
@@ -5,7 +5,8 @@ from __future__ import division, print_function, absolute_import
 
 import numpy as np
 from numpy.testing import (assert_, assert_array_almost_equal,
-                           assert_almost_equal)
+                           assert_almost_equal, assert_allclose)
+from pytest import raises as assert_raises
 from numpy import linspace, sin, cos, random, exp, allclose
 from scipy.interpolate.rbf import Rbf
 
@@ -227,3 +228,62 @@ def test_rbf_epsilon_none_collinear():
     z = [5, 6, 7]
     rbf = Rbf(x, y, z, epsilon=None)
     assert_(rbf.epsilon > 0)
+
+
+def test_rbf_workers():
+    # The compiled evaluation does not form the matrix of all the points
+    # and nodes, and agrees with it
+    np.random.seed(1234)
+    x, y, d = np.random.rand(3, 300)
+    xi, yi = np.random.rand(2, 2000)
+    for function in FUNCTIONS + ('wendland',):
+        rbf = Rbf(x, y, d, function=function, epsilon=0.3)
+        r = rbf._call_norm(np.array([xi, yi]), rbf.xi)
+        rbf._init_function(r)
+        expected = np.dot(rbf._function(r), rbf.nodes)
+        atol = 1e-12 * np.abs(rbf.nodes).sum()
+        for workers in (1, 3, -1):
+            assert_allclose(rbf(xi, yi, workers=workers), expected,
+                            rtol=1e-10, atol=atol, err_msg=function)
+
+
+def test_rbf_wendland():
+    # A compactly supported function interpolates with a sparse system
+    np.random.seed(1234)
+    x, y = np.random.rand(2, 2000)
+    d = np.column_stack([sin(3*x) * y, cos(2*y)]) + 1j
+    rbf = Rbf(x, y, d, function='wendland', epsilon=0.1, mode='N-D')
+    assert_array_almost_equal(rbf(x, y), d)
+
+    dense = Rbf(x[:200], y[:200], d[:200], function='wendland',
+                epsilon=0.3, mode='N-D', norm=lambda u, v: np.sqrt(
+                    ((u - v)**2).sum()))
+    sparse = Rbf(x[:200], y[:200], d[:200], function='wendland',
+                 epsilon=0.3, mode='N-D')
+    assert_array_almost_equal(sparse.nodes, dense.nodes)
+
+
+def test_rbf_neighbors():
+    # Local interpolation from the nearest nodes
+    np.random.seed(1234)
+    x, y = np.random.rand(2, 1000)
+    d = sin(3*x) * y
+    xi, yi = np.random.rand(2, 500)
+    rbf = Rbf(x, y, d, function='thin_plate', neighbors=30)
+    assert_(rbf.nodes is None)
+    assert_array_almost_equal(rbf(x, y), d)
+    di = rbf(xi, yi)
+    assert_(np.abs(di - sin(3*xi) * yi).max() < 5e-2)
+    for workers in (3, -1):
+        assert_array_almost_equal(rbf(xi, yi, workers=workers), di,
+                                  decimal=14)
+
+    # with all the nodes as neighbours, it is the global interpolant
+    rbf = Rbf(x[:50], y[:50], d[:50], function='gaussian', epsilon=0.5,
+              neighbors=100)
+    assert_(rbf.neighbors == 50)
+    full = Rbf(x[:50], y[:50], d[:50], function='gaussian', epsilon=0.5)
+    assert_array_almost_equal(rbf(xi, yi), full(xi, yi), decimal=5)
+
+    assert_raises(ValueError, Rbf, x, y, d, function=lambda r: r,
+                  neighbors=10)
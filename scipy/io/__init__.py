@@ -75,6 +75,8 @@ Wav sound files (:mod:`scipy.io.wavfile`)
 
    read
    write
+   WavReader
+   WavWriter
    WavFileWarning
 
 Arff files (:mod:`scipy.io.arff`)
@@ -0,0 +1,635 @@
+/*
+ * _mmio_core module
+ *
+ * Compiled body of the coordinate format of Matrix Market files, as read
+ * and written by MMFile in mmio.py. The reader takes the whole file as a
+ * buffer, usually a memory map, cuts its body into chunks at line
+ * boundaries and parses them on several threads, straight into the COO
+ * arrays allocated by the caller. The writer formats a block of entries
+ * the same way, each thread into its own piece of the output.
+ *
+ * Lines which start with '%' and blank lines are skipped, and anything
+ * after the fields of an entry is ignored, as in the Python parser.
+ * Numbers with at most 19 significant digits and a small exponent are
+ * converted exactly by hand; others go to strtod and snprintf, which
+ * follow LC_NUMERIC, which Python leaves at "C".
+ */
+
+#include <Python.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <limits>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#define PY_ARRAY_UNIQUE_SYMBOL _scipy_io_mmio_ARRAY_API
+#include "numpy/arrayobject.h"
+#include "numpy/npy_math.h"
+
+#include "parallel.h"
+#include "_text_parse.h"
+
+/*
+ * Bytes of a body, and entries of a block to write, per unit of work
+ * passed to parallel_num_chunks; an entry takes some 32 bytes.
+ */
+#define MM_BYTES_PER_WORK 32
+
+enum {
+    MM_OK = PARSE_OK,
+    MM_SYNTAX = PARSE_SYNTAX,
+    MM_OVERFLOW = PARSE_OVERFLOW
+};
+
+/* no values in the pattern field */
+struct no_value {
+};
+
+
+/*
+ * Parsing
+ */
+
+/* Whether the line [p, end) holds an entry: it is no comment, nor blank */
+static inline bool is_entry(const char *p, const char *end)
+{
+    if (p < end && *p == '%') {
+        return false;
+    }
+    for (; p < end; ++p) {
+        if (!is_space(*p)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline const char *parse_value(const char *p, const char *end,
+                                      no_value *v, int *err)
+{
+    return p;
+}
+
+static inline const char *parse_value(const char *p, const char *end,
+                                      double *v, int *err)
+{
+    return parse_double(p, end, v, err);
+}
+
+static inline const char *parse_value(const char *p, const char *end,
+                                      npy_cdouble *v, int *err)
+{
+    p = parse_double(p, end, &v->real, err);
+    return p != NULL ? parse_double(p, end, &v->imag, err) : NULL;
+}
+
+template <class T>
+static inline const char *parse_value(const char *p, const char *end, T *v,
+                                      int *err)
+{
+    return parse_int(p, end, v, err);
+}
+
+template <class T>
+static inline T *value_at(T *val, npy_intp k)
+{
+    return val + k;
+}
+
+static inline no_value *value_at(no_value *val, npy_intp)
+{
+    return val;
+}
+
+/* Parses the indices, made 0-based, and the value of the entry [p, end) */
+template <class I, class T>
+static int parse_entry(const char *p, const char *end, I *row, I *col,
+                       T *val)
+{
+    int err = MM_OK;
+
+    p = parse_int(p, end, row, &err);
+    if (p != NULL) {
+        p = parse_int(p, end, col, &err);
+    }
+    if (p != NULL) {
+        p = parse_value(p, end, val, &err);
+    }
+    if (p == NULL) {
+        return err;
+    }
+    if (*row == std::numeric_limits<I>::min() ||
+        *col == std::numeric_limits<I>::min()) {
+        return MM_OVERFLOW;
+    }
+    --*row;
+    --*col;
+    return MM_OK;
+}
+
+/*
+ * Reads the entries of the body [begin, end) into row, col and val, of
+ * n_entries each, on up to workers threads. Returns the number of entries
+ * in the body, and if it is n_entries, an error of MM_SYNTAX or
+ * MM_OVERFLOW in *err with the (0-based) number of the first bad entry in
+ * *bad. The arrays are only written to if the number of entries matches.
+ */
+template <class I, class T>
+static npy_intp read_body(const char *begin, const char *end,
+                          npy_intp n_entries, I *row, I *col, T *val,
+                          int workers, int *err, npy_intp *bad)
+{
+    const npy_intp n_bytes = end - begin;
+    const npy_intp n_chunks = parallel_num_chunks(workers,
+                                                  n_bytes / MM_BYTES_PER_WORK);
+    std::vector<const char *> starts;
+    std::vector<npy_intp> first(n_chunks + 1, 0);
+    std::vector<int> errors(n_chunks, MM_OK);
+    std::vector<npy_intp> bad_entries(n_chunks, 0);
+
+    split_lines(begin, end, n_chunks, starts);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        npy_intp count = 0;
+        for (const char *p = starts[c]; p < starts[c + 1]; ) {
+            const char *q = line_end(p, end);
+            count += is_entry(p, q);
+            p = q < end ? q + 1 : end;
+        }
+        first[c + 1] = count;
+    });
+    for (npy_intp c = 0; c < n_chunks; ++c) {
+        first[c + 1] += first[c];
+    }
+    if (first[n_chunks] != n_entries) {
+        return first[n_chunks];
+    }
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        npy_intp k = first[c];
+        for (const char *p = starts[c]; p < starts[c + 1]; ) {
+            const char *q = line_end(p, end);
+            if (is_entry(p, q)) {
+                int e = parse_entry(p, q, &row[k], &col[k],
+                                    value_at(val, k));
+                if (e != MM_OK) {
+                    errors[c] = e;
+                    bad_entries[c] = k;
+                    return;
+                }
+                ++k;
+            }
+            p = q < end ? q + 1 : end;
+        }
+    });
+
+    *err = MM_OK;
+    for (npy_intp c = 0; c < n_chunks; ++c) {
+        if (errors[c] != MM_OK) {
+            *err = errors[c];
+            *bad = bad_entries[c];
+            break;
+        }
+    }
+    return n_entries;
+}
+
+/*
+ * Formatting
+ */
+
+static inline void write_uint(std::string &out, npy_uint64 v)
+{
+    char digits[20];
+    int n = 0;
+
+    do {
+        digits[n++] = '0' + (char)(v % 10);
+        v /= 10;
+    } while (v != 0);
+    while (n > 0) {
+        out += digits[--n];
+    }
+}
+
+static inline void write_value(std::string &out, npy_uint64 v,
+                               std::vector<char> &)
+{
+    write_uint(out, v);
+}
+
+static inline void write_value(std::string &out, npy_int64 v,
+                               std::vector<char> &)
+{
+    if (v < 0) {
+        out += '-';
+        write_uint(out, (npy_uint64)0 - (npy_uint64)v);
+    }
+    else {
+        write_uint(out, (npy_uint64)v);
+    }
+}
+
+/* %.{precision}e, with the names of Python for the special values */
+static inline void write_double(std::string &out, double v, int precision,
+                                std::vector<char> &buf)
+{
+    if (npy_isnan(v)) {
+        out += "nan";
+    }
+    else if (npy_isinf(v)) {
+        out += v < 0 ? "-inf" : "inf";
+    }
+    else {
+        int n = snprintf(&buf[0], buf.size(), "%.*e", precision, v);
+        out.append(&buf[0], n);
+    }
+}
+
+/*
+ * Lines "row col [value]" of the entries [k0, k1), with 1-based indices,
+ * appended to out. buf is a work array of precision + 32 characters.
+ */
+template <class I>
+static void write_entries(std::string &out, npy_intp k0, npy_intp k1,
+                          const I *row, const I *col, const no_value *,
+                          int, std::vector<char> &)
+{
+    for (npy_intp k = k0; k < k1; ++k) {
+        write_uint(out, (npy_uint64)row[k] + 1);
+        out += ' ';
+        write_uint(out, (npy_uint64)col[k] + 1);
+        out += '\n';
+    }
+}
+
+template <class I, class T>
+static void write_entries(std::string &out, npy_intp k0, npy_intp k1,
+                          const I *row, const I *col, const T *val,
+                          int, std::vector<char> &buf)
+{
+    for (npy_intp k = k0; k < k1; ++k) {
+        write_uint(out, (npy_uint64)row[k] + 1);
+        out += ' ';
+        write_uint(out, (npy_uint64)col[k] + 1);
+        out += ' ';
+        write_value(out, val[k], buf);
+        out += '\n';
+    }
+}
+
+template <class I>
+static void write_entries(std::string &out, npy_intp k0, npy_intp k1,
+                          const I *row, const I *col, const double *val,
+                          int precision, std::vector<char> &buf)
+{
+    for (npy_intp k = k0; k < k1; ++k) {
+        write_uint(out, (npy_uint64)row[k] + 1);
+        out += ' ';
+        write_uint(out, (npy_uint64)col[k] + 1);
+        out += ' ';
+        write_double(out, val[k], precision, buf);
+        out += '\n';
+    }
+}
+
+template <class I>
+static void write_entries(std::string &out, npy_intp k0, npy_intp k1,
+                          const I *row, const I *col, const npy_cdouble *val,
+                          int precision, std::vector<char> &buf)
+{
+    for (npy_intp k = k0; k < k1; ++k) {
+        write_uint(out, (npy_uint64)row[k] + 1);
+        out += ' ';
+        write_uint(out, (npy_uint64)col[k] + 1);
+        out += ' ';
+        write_double(out, val[k].real, precision, buf);
+        out += ' ';
+        write_double(out, val[k].imag, precision, buf);
+        out += '\n';
+    }
+}
+
+/* The lines of the n entries, in one piece per thread of up to workers */
+template <class I, class T>
+static void format_body(std::vector<std::string> &pieces, npy_intp n,
+                        const I *row, const I *col, const T *val,
+                        int precision, int workers)
+{
+    const npy_intp n_chunks = parallel_num_chunks(workers, n);
+
+    pieces.resize(n_chunks);
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        std::vector<char> buf(precision + 32);
+        std::string &out = pieces[c];
+
+        out.reserve((size_t)(n / n_chunks + 1) * (2 * precision + 32));
+        write_entries(out, n * c / n_chunks, n * (c + 1) / n_chunks, row,
+                      col, val, precision, buf);
+    });
+}
+
+
+/*
+ * Python interface
+ */
+
+/*
+ * Checks that row and col are vectors of the same integer type, and val,
+ * unless it is None, of the same length and a type of a field. Returns
+ * the typenum of val, NPY_NOTYPE for None, or -1 with an exception set.
+ */
+static int check_entries(PyArrayObject *row, PyArrayObject *col,
+                         PyObject *val, int writeable)
+{
+    const int index_type = PyArray_TYPE(row);
+    PyArrayObject *arrays[3] = {row, col, (PyArrayObject *)val};
+    int n_arrays = val == Py_None ? 2 : 3, value_type = NPY_NOTYPE;
+
+    if (val != Py_None) {
+        if (!PyArray_Check(val)) {
+            PyErr_SetString(PyExc_TypeError, "values must be an array");
+            return -1;
+        }
+        value_type = PyArray_TYPE((PyArrayObject *)val);
+    }
+    for (int k = 0; k < n_arrays; ++k) {
+        if (PyArray_NDIM(arrays[k]) != 1 ||
+            !PyArray_IS_C_CONTIGUOUS(arrays[k]) ||
+            (writeable && !PyArray_ISWRITEABLE(arrays[k])) ||
+            PyArray_DIM(arrays[k], 0) != PyArray_DIM(row, 0)) {
+            PyErr_SetString(PyExc_ValueError,
+                            "invalid arrays of coordinate entries");
+            return -1;
+        }
+    }
+    if ((index_type != NPY_INT32 && index_type != NPY_INT64) ||
+        PyArray_TYPE(col) != index_type ||
+        (value_type != NPY_NOTYPE && value_type != NPY_INT32 &&
+         value_type != NPY_INT64 && value_type != NPY_UINT64 &&
+         value_type != NPY_DOUBLE && value_type != NPY_CDOUBLE)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "unsupported types of coordinate entries");
+        return -1;
+    }
+    return value_type;
+}
+
+template <class I>
+static npy_intp run_read(const char *begin, const char *end,
+                         PyArrayObject *row, PyArrayObject *col,
+                         PyObject *val, int value_type, int workers,
+                         int *err, npy_intp *bad)
+{
+    const npy_intp n = PyArray_DIM(row, 0);
+    I *r = (I *)PyArray_DATA(row), *c = (I *)PyArray_DATA(col);
+    void *v = value_type != NPY_NOTYPE
+              ? PyArray_DATA((PyArrayObject *)val) : NULL;
+
+    switch (value_type) {
+    case NPY_INT32:
+        return read_body(begin, end, n, r, c, (npy_int32 *)v, workers, err,
+                         bad);
+    case NPY_INT64:
+        return read_body(begin, end, n, r, c, (npy_int64 *)v, workers, err,
+                         bad);
+    case NPY_UINT64:
+        return read_body(begin, end, n, r, c, (npy_uint64 *)v, workers, err,
+                         bad);
+    case NPY_DOUBLE:
+        return read_body(begin, end, n, r, c, (double *)v, workers, err,
+                         bad);
+    case NPY_CDOUBLE:
+        return read_body(begin, end, n, r, c, (npy_cdouble *)v, workers, err,
+                         bad);
+    default:
+        return read_body(begin, end, n, r, c, (no_value *)NULL, workers, err,
+                         bad);
+    }
+}
+
+static char read_coordinate_doc[] =
+"read_coordinate(buffer, offset, row, col, val, workers)\n\
+\n\
+Reads the entries of the coordinate body which starts at byte offset of\n\
+buffer into the vectors row and col (int32 or int64), with 0-based\n\
+indices, and val (int32, int64, uint64, float64 or complex128), or no\n\
+values if val is None, on up to workers threads. Returns the number of\n\
+entries in the body; the vectors are only filled if it is their length.";
+
+static PyObject *Py_read_coordinate(PyObject *self, PyObject *args)
+{
+    Py_buffer buffer;
+    Py_ssize_t offset;
+    PyArrayObject *row, *col;
+    PyObject *val;
+    int workers, value_type, err = MM_OK, no_memory = 0;
+    npy_intp n_found = 0, bad = 0;
+    PyThreadState *save;
+
+    if (!PyArg_ParseTuple(args, "s*nO!O!Oi", &buffer, &offset,
+                          &PyArray_Type, &row, &PyArray_Type, &col, &val,
+                          &workers)) {
+        return NULL;
+    }
+    value_type = check_entries(row, col, val, 1);
+    if (value_type == -1) {
+        PyBuffer_Release(&buffer);
+        return NULL;
+    }
+    if (offset < 0 || offset > buffer.len) {
+        PyBuffer_Release(&buffer);
+        PyErr_SetString(PyExc_ValueError, "offset out of the buffer");
+        return NULL;
+    }
+    workers = workers > 1 ? workers : 1;
+
+    const char *begin = (const char *)buffer.buf + offset;
+    const char *end = (const char *)buffer.buf + buffer.len;
+
+    save = PyEval_SaveThread();
+    try {
+        if (PyArray_TYPE(row) == NPY_INT32) {
+            n_found = run_read<npy_int32>(begin, end, row, col, val,
+                                          value_type, workers, &err, &bad);
+        }
+        else {
+            n_found = run_read<npy_int64>(begin, end, row, col, val,
+                                          value_type, workers, &err, &bad);
+        }
+    }
+    catch (const std::bad_alloc &) {
+        no_memory = 1;
+    }
+    PyEval_RestoreThread(save);
+    PyBuffer_Release(&buffer);
+
+    if (no_memory) {
+        return PyErr_NoMemory();
+    }
+    if (err == MM_SYNTAX) {
+        PyErr_Format(PyExc_ValueError, "Parse error in entry %zd",
+                     (Py_ssize_t)bad + 1);
+        return NULL;
+    }
+    if (err == MM_OVERFLOW) {
+        PyErr_Format(PyExc_OverflowError,
+                     "entry %zd does not fit in the data types of the matrix",
+                     (Py_ssize_t)bad + 1);
+        return NULL;
+    }
+    return PyLong_FromSsize_t((Py_ssize_t)n_found);
+}
+
+template <class I>
+static void run_format(std::vector<std::string> &pieces, PyArrayObject *row,
+                       PyArrayObject *col, PyObject *val, int value_type,
+                       int precision, int workers)
+{
+    const npy_intp n = PyArray_DIM(row, 0);
+    const I *r = (const I *)PyArray_DATA(row);
+    const I *c = (const I *)PyArray_DATA(col);
+    const void *v = value_type != NPY_NOTYPE
+                    ? PyArray_DATA((PyArrayObject *)val) : NULL;
+
+    switch (value_type) {
+    case NPY_INT64:
+        format_body(pieces, n, r, c, (const npy_int64 *)v, precision,
+                    workers);
+        break;
+    case NPY_UINT64:
+        format_body(pieces, n, r, c, (const npy_uint64 *)v, precision,
+                    workers);
+        break;
+    case NPY_DOUBLE:
+        format_body(pieces, n, r, c, (const double *)v, precision, workers);
+        break;
+    case NPY_CDOUBLE:
+        format_body(pieces, n, r, c, (const npy_cdouble *)v, precision,
+                    workers);
+        break;
+    default:
+        format_body(pieces, n, r, c, (const no_value *)v, precision,
+                    workers);
+    }
+}
+
+static char format_coordinate_doc[] =
+"format_coordinate(row, col, val, precision, workers)\n\
+\n\
+Returns the lines of the coordinate entries with 0-based indices in the\n\
+vectors row and col (int32 or int64) and values val (int64, uint64,\n\
+float64 or complex128), or none if val is None, as bytes. Indices are\n\
+written 1-based and real numbers as '%.{precision}e', on up to workers\n\
+threads.";
+
+static PyObject *Py_format_coordinate(PyObject *self, PyObject *args)
+{
+    PyArrayObject *row, *col;
+    PyObject *val, *result;
+    int precision, workers, value_type, no_memory = 0;
+    std::vector<std::string> pieces;
+    PyThreadState *save;
+
+    if (!PyArg_ParseTuple(args, "O!O!Oii", &PyArray_Type, &row,
+                          &PyArray_Type, &col, &val, &precision,
+                          &workers)) {
+        return NULL;
+    }
+    value_type = check_entries(row, col, val, 0);
+    if (value_type == -1) {
+        return NULL;
+    }
+    if (value_type == NPY_INT32) {
+        PyErr_SetString(PyExc_TypeError, "integer values must be int64");
+        return NULL;
+    }
+    if (precision < 0 || precision > 1000) {
+        PyErr_SetString(PyExc_ValueError, "invalid precision");
+        return NULL;
+    }
+    workers = workers > 1 ? workers : 1;
+
+    save = PyEval_SaveThread();
+    try {
+        if (PyArray_TYPE(row) == NPY_INT32) {
+            run_format<npy_int32>(pieces, row, col, val, value_type,
+                                  precision, workers);
+        }
+        else {
+            run_format<npy_int64>(pieces, row, col, val, value_type,
+                                  precision, workers);
+        }
+    }
+    catch (const std::bad_alloc &) {
+        no_memory = 1;
+    }
+    PyEval_RestoreThread(save);
+
+    if (no_memory) {
+        return PyErr_NoMemory();
+    }
+
+    Py_ssize_t size = 0;
+    for (size_t k = 0; k < pieces.size(); ++k) {
+        size += (Py_ssize_t)pieces[k].size();
+    }
+    result = PyBytes_FromStringAndSize(NULL, size);
+    if (result != NULL) {
+        char *p = PyBytes_AS_STRING(result);
+        for (size_t k = 0; k < pieces.size(); ++k) {
+            memcpy(p, pieces[k].data(), pieces[k].size());
+            p += pieces[k].size();
+        }
+    }
+    return result;
+}
+
+
+/*
+ * Main _mmio_core module
+ */
+
+static PyMethodDef core_methods[] = {
+    {"read_coordinate", (PyCFunction) Py_read_coordinate, METH_VARARGS,
+     read_coordinate_doc},
+    {"format_coordinate", (PyCFunction) Py_format_coordinate, METH_VARARGS,
+     format_coordinate_doc},
+    {NULL, NULL}
+};
+
+#if PY_VERSION_HEX >= 0x03000000
+
+static struct PyModuleDef moduledef = {
+    PyModuleDef_HEAD_INIT,
+    "_mmio_core",
+    NULL,
+    -1,
+    core_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+PyMODINIT_FUNC PyInit__mmio_core(void)
+{
+    import_array();
+
+    return PyModule_Create(&moduledef);
+}
+
+#else
+
+PyMODINIT_FUNC init_mmio_core(void)
+{
+    import_array();
+
+    Py_InitModule("_mmio_core", core_methods);
+}
+
+#endif
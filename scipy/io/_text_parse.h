@@ -0,0 +1,244 @@
+#ifndef __SCIPY_IO_TEXT_PARSE_H__
+#define __SCIPY_IO_TEXT_PARSE_H__
+
+/*
+ * Helpers for the compiled text parsers of scipy.io: conversion of decimal
+ * numbers, and splitting of a buffer at line boundaries so that its chunks
+ * can be parsed on several threads.
+ *
+ * Numbers with at most 19 significant digits and a small exponent are
+ * converted exactly by hand; others go to strtod, which follows
+ * LC_NUMERIC, which Python leaves at "C".
+ *
+ * Include after numpy/arrayobject.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+enum {
+    PARSE_OK = 0,
+    PARSE_SYNTAX,
+    PARSE_OVERFLOW
+};
+
+static inline bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static inline const char *line_end(const char *p, const char *end)
+{
+    const char *q = (const char *)memchr(p, '\n', end - p);
+    return q != NULL ? q : end;
+}
+
+static inline const char *skip_space(const char *p, const char *end)
+{
+    while (p < end && is_space(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+/*
+ * Parses the integer at p, in [p, end), into *v. Returns the end of the
+ * token, or NULL with the reason in *err.
+ */
+template <class T>
+static const char *parse_int(const char *p, const char *end, T *v, int *err)
+{
+    npy_uint64 m = 0;
+    bool neg = false, over = false;
+    const char *digits;
+
+    p = skip_space(p, end);
+    if (p < end && (*p == '+' || *p == '-')) {
+        neg = *p == '-';
+        ++p;
+    }
+    for (digits = p; p < end && is_digit(*p); ++p) {
+        const unsigned d = *p - '0';
+        if (m > (NPY_MAX_UINT64 - d) / 10) {
+            over = true;
+        }
+        m = 10 * m + d;
+    }
+    if (p == digits || (p < end && !is_space(*p))) {
+        *err = PARSE_SYNTAX;
+        return NULL;
+    }
+
+    const npy_uint64 max = (npy_uint64)std::numeric_limits<T>::max();
+    if (over || (m != 0 && ((neg && !std::numeric_limits<T>::is_signed) ||
+                            m - neg > max))) {
+        *err = PARSE_OVERFLOW;
+        return NULL;
+    }
+    else if (m == 0) {
+        *v = 0;
+    }
+    else {
+        /* -m as -(m - 1) - 1, which also reaches the minimum of T */
+        *v = neg ? -(T)(m - 1) - 1 : (T)m;
+    }
+    return p;
+}
+
+static const double pow10_exact[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+    1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/*
+ * As parse_int, for a floating point number. With fortran, the exponent
+ * may also be marked by 'd' or 'D'.
+ */
+static const char *parse_double(const char *p, const char *end, double *v,
+                                int *err, bool fortran = false)
+{
+    const char *q, *s;
+    npy_uint64 m = 0;
+    int n_digits = 0, n_significant = 0, exp10 = 0;
+    bool neg = false, exact = true;
+
+    p = skip_space(p, end);
+    for (q = p; q < end && !is_space(*q); ++q) {
+    }
+
+    /*
+     * Fast path: [sign] digits [. digits] [e [sign] digits], the digits
+     * gathered in m, whose value times 10**exp10 is the result. It is
+     * exact when m and 10**|exp10| are, i.e. below 2**53 and 1e23, and
+     * then so is the one rounding of the product or quotient.
+     */
+    s = p;
+    if (s < q && (*s == '+' || *s == '-')) {
+        neg = *s == '-';
+        ++s;
+    }
+    for (; s < q && is_digit(*s); ++s, ++n_digits) {
+        if (m == 0 && *s == '0') {
+            continue;
+        }
+        if (n_significant < 19) {
+            m = 10 * m + (*s - '0');
+            ++n_significant;
+        }
+        else {
+            exact = false;
+        }
+    }
+    if (s < q && *s == '.') {
+        for (++s; s < q && is_digit(*s); ++s, ++n_digits) {
+            if (m == 0 && *s == '0') {
+                --exp10;
+                continue;
+            }
+            if (n_significant < 19) {
+                m = 10 * m + (*s - '0');
+                ++n_significant;
+                --exp10;
+            }
+            else {
+                exact = false;
+            }
+        }
+    }
+    if (n_digits > 0 && s < q && (*s == 'e' || *s == 'E' ||
+                                  (fortran && (*s == 'd' || *s == 'D')))) {
+        int e = 0;
+        bool e_neg = false;
+        const char *e_digits;
+
+        ++s;
+        if (s < q && (*s == '+' || *s == '-')) {
+            e_neg = *s == '-';
+            ++s;
+        }
+        for (e_digits = s; s < q && is_digit(*s); ++s) {
+            e = std::min(10 * e + (*s - '0'), 100000);
+        }
+        if (s == e_digits) {
+            exact = false;
+        }
+        exp10 += e_neg ? -e : e;
+    }
+    if (n_digits > 0 && s == q && exact) {
+        if (m == 0) {
+            *v = neg ? -0.0 : 0.0;
+            return q;
+        }
+        if (m <= ((npy_uint64)1 << 53) && exp10 >= -22 && exp10 <= 22) {
+            double d = (double)m;
+            d = exp10 < 0 ? d / pow10_exact[-exp10] : d * pow10_exact[exp10];
+            *v = neg ? -d : d;
+            return q;
+        }
+    }
+
+    /* anything else, on a copy ended by a nul; no hexadecimal, as float */
+    const size_t len = q - p;
+    char small[64];
+    std::string large;
+    char *buf = small, *buf_end;
+
+    if (len == 0 || memchr(p, 'x', len) != NULL ||
+        memchr(p, 'X', len) != NULL) {
+        *err = PARSE_SYNTAX;
+        return NULL;
+    }
+    if (len >= sizeof(small)) {
+        large.assign(p, len);
+        buf = &large[0];
+    }
+    else {
+        memcpy(small, p, len);
+        small[len] = '\0';
+    }
+    if (fortran) {
+        std::replace(buf, buf + len, 'd', 'e');
+        std::replace(buf, buf + len, 'D', 'E');
+    }
+    *v = strtod(buf, &buf_end);
+    if (buf_end != buf + len) {
+        *err = PARSE_SYNTAX;
+        return NULL;
+    }
+    return q;
+}
+
+/*
+ * Sets starts[c] for c in [0, n_chunks] so that chunk c, [starts[c],
+ * starts[c + 1]), begins on the line after the one at c/n_chunks of
+ * [begin, end).
+ */
+static void split_lines(const char *begin, const char *end,
+                        npy_intp n_chunks, std::vector<const char *> &starts)
+{
+    const npy_intp n_bytes = end - begin;
+
+    starts.resize(n_chunks + 1);
+    starts[0] = begin;
+    for (npy_intp c = 1; c < n_chunks; ++c) {
+        const char *p = begin + n_bytes * c / n_chunks, *q;
+        if (starts[c - 1] == end) {
+            starts[c] = end;
+            continue;
+        }
+        q = line_end(std::max(p, starts[c - 1] + 1) - 1, end);
+        starts[c] = q < end ? q + 1 : end;
+    }
+    starts[n_chunks] = end;
+}
+
+#endif
@@ -0,0 +1,156 @@
+/*
+ * _wavfile_core module
+ *
+ * Compiled sample conversions of wavfile.py. 24-bit PCM has no NumPy
+ * dtype, so its samples are widened here in a single pass from the raw
+ * bytes of the data chunk, either to int32 with the sample in the most
+ * significant bytes or to float32 scaled to [-1, 1).
+ */
+
+#include <Python.h>
+
+#define PY_ARRAY_UNIQUE_SYMBOL _scipy_io_wavfile_ARRAY_API
+#include "numpy/arrayobject.h"
+
+
+static inline npy_int32 sample24(const unsigned char *p, int big_endian)
+{
+    npy_uint32 u;
+
+    if (big_endian) {
+        u = ((npy_uint32)p[0] << 24) | ((npy_uint32)p[1] << 16)
+            | ((npy_uint32)p[2] << 8);
+    }
+    else {
+        u = ((npy_uint32)p[2] << 24) | ((npy_uint32)p[1] << 16)
+            | ((npy_uint32)p[0] << 8);
+    }
+    return (npy_int32)u;
+}
+
+static void unpack_int32(const unsigned char *src, npy_intp n,
+                         npy_int32 *dst, int big_endian)
+{
+    if (big_endian) {
+        for (npy_intp k = 0; k < n; ++k, src += 3) {
+            dst[k] = sample24(src, 1);
+        }
+    }
+    else {
+        for (npy_intp k = 0; k < n; ++k, src += 3) {
+            dst[k] = sample24(src, 0);
+        }
+    }
+}
+
+static void unpack_float32(const unsigned char *src, npy_intp n,
+                           npy_float *dst, int big_endian)
+{
+    /* the int32 sample is exact in float32 up to its 24 bits */
+    const npy_float scale = 1.0f / 2147483648.0f;
+
+    if (big_endian) {
+        for (npy_intp k = 0; k < n; ++k, src += 3) {
+            dst[k] = (npy_float)sample24(src, 1) * scale;
+        }
+    }
+    else {
+        for (npy_intp k = 0; k < n; ++k, src += 3) {
+            dst[k] = (npy_float)sample24(src, 0) * scale;
+        }
+    }
+}
+
+static char unpack24_doc[] =
+"unpack24(buffer, out, big_endian)\n\
+\n\
+Widens the 24-bit samples in buffer, whose length is 3 times the size of\n\
+out, into the C-contiguous array out. For int32, each sample goes to the\n\
+3 most significant bytes and the lowest byte is zero; for float32 the\n\
+samples are divided by 2**23.";
+
+static PyObject *Py_unpack24(PyObject *self, PyObject *args)
+{
+    Py_buffer buffer;
+    PyArrayObject *out;
+    int big_endian;
+    PyThreadState *save;
+
+    if (!PyArg_ParseTuple(args, "s*O!i", &buffer, &PyArray_Type, &out,
+                          &big_endian)) {
+        return NULL;
+    }
+    if (!PyArray_ISCARRAY(out) || !PyArray_ISNOTSWAPPED(out)
+            || (PyArray_TYPE(out) != NPY_INT32
+                && PyArray_TYPE(out) != NPY_FLOAT32)) {
+        PyBuffer_Release(&buffer);
+        PyErr_SetString(PyExc_ValueError,
+                        "out must be a writeable, C-contiguous, native "
+                        "int32 or float32 array");
+        return NULL;
+    }
+    const npy_intp n = PyArray_SIZE(out);
+    if (buffer.len != 3 * n) {
+        PyBuffer_Release(&buffer);
+        PyErr_SetString(PyExc_ValueError,
+                        "buffer must have 3 bytes per element of out");
+        return NULL;
+    }
+
+    const unsigned char *src = (const unsigned char *)buffer.buf;
+
+    save = PyEval_SaveThread();
+    if (PyArray_TYPE(out) == NPY_INT32) {
+        unpack_int32(src, n, (npy_int32 *)PyArray_DATA(out), big_endian);
+    }
+    else {
+        unpack_float32(src, n, (npy_float *)PyArray_DATA(out),
+                       big_endian);
+    }
+    PyEval_RestoreThread(save);
+    PyBuffer_Release(&buffer);
+
+    Py_RETURN_NONE;
+}
+
+
+/*
+ * Main _wavfile_core module
+ */
+
+static PyMethodDef core_methods[] = {
+    {"unpack24", (PyCFunction) Py_unpack24, METH_VARARGS, unpack24_doc},
+    {NULL, NULL}
+};
+
+#if PY_VERSION_HEX >= 0x03000000
+
+static struct PyModuleDef moduledef = {
+    PyModuleDef_HEAD_INIT,
+    "_wavfile_core",
+    NULL,
+    -1,
+    core_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+PyMODINIT_FUNC PyInit__wavfile_core(void)
+{
+    import_array();
+
+    return PyModule_Create(&moduledef);
+}
+
+#else
+
+PyMODINIT_FUNC init_wavfile_core(void)
+{
+    import_array();
+
+    Py_InitModule("_wavfile_core", core_methods);
+}
+
+#endif
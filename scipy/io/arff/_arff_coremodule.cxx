@@ -0,0 +1,386 @@
+/*
+ * _arff_core module
+ *
+ * Compiled tokenizer of the data section of ARFF files, for the numeric
+ * and nominal attributes read by arffread.py. The section is cut into
+ * chunks at line boundaries; the records of each chunk are counted, then
+ * parsed on several threads straight into the record array.
+ *
+ * Only the plain comma-separated form is handled: lines which start with
+ * '%' and blank lines are skipped, values are not quoted and fields after
+ * the last attribute are ignored. Anything else is reported as a parse
+ * error, upon which the caller falls back to the csv module.
+ */
+
+#include <Python.h>
+
+#include <new>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#define PY_ARRAY_UNIQUE_SYMBOL _scipy_io_arff_ARRAY_API
+#include "numpy/arrayobject.h"
+#include "numpy/npy_math.h"
+
+#include "parallel.h"
+#include "_text_parse.h"
+
+/* Bytes of data per unit of work passed to parallel_num_chunks */
+#define ARFF_BYTES_PER_WORK 16
+
+/*
+ * An attribute stored at offset of a record: a float64 if width is 0,
+ * else a nominal value, one of the sorted values, in width bytes.
+ */
+struct field {
+    npy_intp offset;
+    npy_intp width;
+    std::vector<std::string> values;
+};
+
+static inline bool less_than(const std::string &value, const char *p,
+                             size_t len)
+{
+    int c = memcmp(value.data(), p, std::min(value.size(), len));
+    return c < 0 || (c == 0 && value.size() < len);
+}
+
+/* Whether the line [p, end) holds a record: it is no comment, nor blank */
+static inline bool is_record(const char *p, const char *end)
+{
+    if (p < end && *p == '%') {
+        return false;
+    }
+    return skip_space(p, end) < end;
+}
+
+/* Parses the value [p, end) of f into rec */
+static bool parse_field(const char *p, const char *end, const field &f,
+                        char *rec)
+{
+    if (memchr(p, '\'', end - p) != NULL ||
+            memchr(p, '"', end - p) != NULL) {
+        return false;
+    }
+    if (f.width == 0) {
+        double v;
+        int err = PARSE_OK;
+
+        if (memchr(p, '?', end - p) != NULL) {
+            v = NPY_NAN;
+        }
+        else {
+            const char *q = parse_double(p, end, &v, &err);
+            if (q == NULL || skip_space(q, end) != end) {
+                return false;
+            }
+        }
+        memcpy(rec + f.offset, &v, sizeof(v));
+        return true;
+    }
+
+    while (p < end && *p == ' ') {
+        ++p;
+    }
+    const size_t len = end - p;
+    if (!(len == 1 && *p == '?')) {
+        std::vector<std::string>::const_iterator it =
+            std::lower_bound(f.values.begin(), f.values.end(), p,
+                             [len](const std::string &v, const char *s) {
+                return less_than(v, s, len);
+            });
+        if (it == f.values.end() || it->size() != len ||
+                memcmp(it->data(), p, len) != 0) {
+            return false;
+        }
+    }
+    memcpy(rec + f.offset, p, len);
+    memset(rec + f.offset + len, 0, f.width - len);
+    return true;
+}
+
+/* Parses the record [p, end) into rec */
+static bool parse_record(const char *p, const char *end,
+                         const std::vector<field> &fields, char *rec)
+{
+    for (size_t k = 0; k < fields.size(); ++k) {
+        const char *q = (const char *)memchr(p, ',', end - p);
+        if (q == NULL) {
+            if (k + 1 < fields.size()) {
+                return false;
+            }
+            q = end;
+        }
+        if (!parse_field(p, q, fields[k], rec)) {
+            return false;
+        }
+        p = q + 1;
+    }
+    return true;
+}
+
+/* Counts the records of the chunks of [begin, end) into first[1:] */
+static void count_records(const char *begin, const char *end,
+                          const std::vector<const char *> &starts,
+                          std::vector<npy_intp> &first)
+{
+    const npy_intp n_chunks = (npy_intp)starts.size() - 1;
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        npy_intp count = 0;
+        for (const char *p = starts[c]; p < starts[c + 1]; ) {
+            const char *q = line_end(p, end);
+            count += is_record(p, q);
+            p = q < end ? q + 1 : end;
+        }
+        first[c + 1] = count;
+    });
+    for (npy_intp c = 0; c < n_chunks; ++c) {
+        first[c + 1] += first[c];
+    }
+}
+
+/*
+ * Parses the records of the chunks of [begin, end), the first of chunk c
+ * being number first[c], into out with records of itemsize bytes. Returns
+ * -1, or the (0-based) number of the first bad record.
+ */
+static npy_intp parse_records(const char *begin, const char *end,
+                              const std::vector<const char *> &starts,
+                              const std::vector<npy_intp> &first,
+                              const std::vector<field> &fields,
+                              char *out, npy_intp itemsize)
+{
+    const npy_intp n_chunks = (npy_intp)starts.size() - 1;
+    std::vector<npy_intp> bad_records(n_chunks, -1);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        npy_intp k = first[c];
+        for (const char *p = starts[c]; p < starts[c + 1]; ) {
+            const char *q = line_end(p, end);
+            if (is_record(p, q)) {
+                if (!parse_record(p, q, fields, out + k * itemsize)) {
+                    bad_records[c] = k;
+                    return;
+                }
+                ++k;
+            }
+            p = q < end ? q + 1 : end;
+        }
+    });
+
+    for (npy_intp c = 0; c < n_chunks; ++c) {
+        if (bad_records[c] != -1) {
+            return bad_records[c];
+        }
+    }
+    return -1;
+}
+
+/* Reads the (offset, width, values) tuples of the Python fields */
+static int get_fields(PyObject *seq, std::vector<field> &fields)
+{
+    Py_ssize_t n = PySequence_Size(seq);
+
+    if (n < 0) {
+        return -1;
+    }
+    fields.resize(n);
+    for (Py_ssize_t k = 0; k < n; ++k) {
+        PyObject *item = PySequence_GetItem(seq, k), *values;
+        Py_ssize_t offset, width;
+        int ok;
+
+        if (item == NULL) {
+            return -1;
+        }
+        ok = PyArg_ParseTuple(item, "nnO", &offset, &width, &values);
+        Py_DECREF(item);
+        if (!ok) {
+            return -1;
+        }
+        fields[k].offset = offset;
+        fields[k].width = width;
+        if (width == 0) {
+            continue;
+        }
+
+        Py_ssize_t n_values = PySequence_Size(values);
+        if (n_values < 0) {
+            return -1;
+        }
+        for (Py_ssize_t j = 0; j < n_values; ++j) {
+            PyObject *v = PySequence_GetItem(values, j);
+            char *s;
+            Py_ssize_t len;
+
+            if (v == NULL) {
+                return -1;
+            }
+            if (PyBytes_AsStringAndSize(v, &s, &len) == -1) {
+                Py_DECREF(v);
+                return -1;
+            }
+            if (len > width) {
+                Py_DECREF(v);
+                PyErr_SetString(PyExc_ValueError,
+                                "nominal value longer than its field");
+                return -1;
+            }
+            fields[k].values.push_back(std::string(s, len));
+            Py_DECREF(v);
+        }
+        std::sort(fields[k].values.begin(), fields[k].values.end());
+    }
+    return 0;
+}
+
+static int check_fields(const std::vector<field> &fields, npy_intp itemsize)
+{
+    for (size_t k = 0; k < fields.size(); ++k) {
+        const npy_intp size = fields[k].width == 0 ? (npy_intp)sizeof(double)
+                                                    : fields[k].width;
+        if (fields[k].offset < 0 || fields[k].width < 0 ||
+                fields[k].offset + size > itemsize) {
+            PyErr_SetString(PyExc_ValueError, "field out of the record");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static char read_records_doc[] =
+"read_records(buffer, dtype, fields, workers)\n\
+\n\
+Reads the records of the data section in buffer into a new vector of the\n\
+record type dtype, on up to workers threads. fields holds a tuple for\n\
+each attribute, (offset, 0, None) for a native float64 at byte offset of\n\
+a record, or (offset, width, values) for a nominal value stored as bytes\n\
+of width, which must be one of values or '?'. Raises ValueError on any\n\
+record it cannot read.";
+
+static PyObject *Py_read_records(PyObject *self, PyObject *args)
+{
+    Py_buffer buffer;
+    PyArray_Descr *dtype;
+    PyObject *seq;
+    PyArrayObject *out = NULL;
+    int workers, no_memory = 0;
+    npy_intp n_records = 0, bad = -1;
+    std::vector<field> fields;
+    std::vector<const char *> starts;
+    std::vector<npy_intp> first;
+    PyThreadState *save;
+
+    if (!PyArg_ParseTuple(args, "s*O!Oi", &buffer, &PyArrayDescr_Type,
+                          &dtype, &seq, &workers)) {
+        return NULL;
+    }
+    try {
+        if (get_fields(seq, fields) == -1 ||
+                check_fields(fields, dtype->elsize) == -1) {
+            PyBuffer_Release(&buffer);
+            return NULL;
+        }
+    }
+    catch (const std::bad_alloc &) {
+        PyBuffer_Release(&buffer);
+        return PyErr_NoMemory();
+    }
+    workers = workers > 1 ? workers : 1;
+
+    const char *begin = (const char *)buffer.buf;
+    const char *end = begin + buffer.len;
+    const npy_intp n_chunks = parallel_num_chunks(
+        workers, buffer.len / ARFF_BYTES_PER_WORK);
+
+    save = PyEval_SaveThread();
+    try {
+        first.assign(n_chunks + 1, 0);
+        split_lines(begin, end, n_chunks, starts);
+        count_records(begin, end, starts, first);
+        n_records = first[n_chunks];
+    }
+    catch (const std::bad_alloc &) {
+        no_memory = 1;
+    }
+    PyEval_RestoreThread(save);
+
+    if (!no_memory) {
+        Py_INCREF(dtype);
+        out = (PyArrayObject *)PyArray_NewFromDescr(
+            &PyArray_Type, dtype, 1, &n_records, NULL, NULL, 0, NULL);
+        if (out == NULL) {
+            PyBuffer_Release(&buffer);
+            return NULL;
+        }
+
+        save = PyEval_SaveThread();
+        try {
+            bad = parse_records(begin, end, starts, first, fields,
+                                (char *)PyArray_DATA(out),
+                                PyArray_ITEMSIZE(out));
+        }
+        catch (const std::bad_alloc &) {
+            no_memory = 1;
+        }
+        PyEval_RestoreThread(save);
+    }
+    PyBuffer_Release(&buffer);
+
+    if (no_memory) {
+        Py_XDECREF(out);
+        return PyErr_NoMemory();
+    }
+    if (bad != -1) {
+        Py_DECREF(out);
+        PyErr_Format(PyExc_ValueError, "Parse error in record %zd",
+                     (Py_ssize_t)bad + 1);
+        return NULL;
+    }
+    return (PyObject *)out;
+}
+
+
+/*
+ * Main _arff_core module
+ */
+
+static PyMethodDef core_methods[] = {
+    {"read_records", (PyCFunction) Py_read_records, METH_VARARGS,
+     read_records_doc},
+    {NULL, NULL}
+};
+
+#if PY_VERSION_HEX >= 0x03000000
+
+static struct PyModuleDef moduledef = {
+    PyModuleDef_HEAD_INIT,
+    "_arff_core",
+    NULL,
+    -1,
+    core_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+PyMODINIT_FUNC PyInit__arff_core(void)
+{
+    import_array();
+
+    return PyModule_Create(&moduledef);
+}
+
+#else
+
+PyMODINIT_FUNC init_arff_core(void)
+{
+    import_array();
+
+    Py_InitModule("_arff_core", core_methods);
+}
+
+#endif
@@ -1,8 +1,11 @@
 # Last Change: Mon Aug 20 08:00 PM 2007 J
 from __future__ import division, print_function, absolute_import
 
+import io
+import os
 import re
 import datetime
+import operator
 from collections import OrderedDict
 
 import numpy as np
@@ -11,6 +14,8 @@ from scipy._lib.six import next
 import csv
 import ctypes
 
+from . import _arff_core
+
 """A module to read arff files."""
 
 __all__ = ['MetaData', 'loadarff', 'ArffError', 'ParseArffError']
@@ -727,7 +732,7 @@ class MetaData(object):
         return attr_types
 
 
-def loadarff(f):
+def loadarff(f, workers=None):
     """
     Read an arff file.
 
@@ -741,6 +746,12 @@ def loadarff(f):
     ----------
     f : file-like or str
        File-like object to read from, or filename to open.
+    workers : int, optional
+       Number of threads reading the data of files with only numeric and
+       nominal attributes. The default, None, means 1; negative values wrap
+       around from ``os.cpu_count()``.
+
+       .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -771,6 +782,10 @@ def loadarff(f):
     read files with missing data (? in the file), representing the data
     points as NaNs.
 
+    The data of files with only numeric and nominal attributes, given as
+    plain comma-separated values, is read by compiled code. Other files,
+    for instance with quoted values, are read with the `csv` module.
+
     Examples
     --------
     >>> from scipy.io import arff
@@ -797,18 +812,62 @@ def loadarff(f):
     \tcolor's type is nominal, range is ('red', 'green', 'blue', 'yellow', 'black')
 
     """
+    workers = _check_workers(workers)
     if hasattr(f, 'read'):
         ofile = f
     else:
         ofile = open(f, 'rt')
     try:
-        return _loadarff(ofile)
+        return _loadarff(ofile, workers)
     finally:
         if ofile is not f:  # only close what we opened
             ofile.close()
 
 
-def _loadarff(ofile):
+def _check_workers(workers):
+    """Normalize a ``workers`` argument to a positive thread count.
+
+    ``None`` means a single thread, and negative values wrap around from
+    ``os.cpu_count()``, so that ``-1`` means all CPUs.
+    """
+    if workers is None:
+        return 1
+
+    workers = operator.index(workers)
+    if workers < 0:
+        cpu_count = os.cpu_count() or 1
+        if workers >= -cpu_count:
+            workers += 1 + cpu_count
+        else:
+            raise ValueError("workers value out of range; got {}, must not be"
+                             " less than {}".format(workers, -cpu_count))
+    elif workers == 0:
+        raise ValueError("workers must not be zero")
+    return workers
+
+
+def _record_fields(attr, dtype):
+    """
+    The ``(offset, width, values)`` of each attribute in the records of
+    dtype, as read by _arff_core, or None if it cannot read some attribute.
+    """
+    fields = []
+    for a in attr:
+        field_dtype, offset = dtype.fields[a.name][:2]
+        if isinstance(a, NumericAttribute):
+            fields.append((offset, 0, None))
+        elif isinstance(a, NominalAttribute):
+            try:
+                values = [v.encode('ascii') for v in a.values]
+            except UnicodeEncodeError:
+                return None
+            fields.append((offset, field_dtype.itemsize, values))
+        else:
+            return None
+    return fields
+
+
+def _loadarff(ofile, workers=1):
     # Parse the header file
     try:
         rel, attr = read_header(ofile)
@@ -838,6 +897,19 @@ def _loadarff(ofile):
         raise NotImplementedError("String attributes not supported yet, sorry")
 
     ni = len(attr)
+    dtype = np.dtype([(a.name, a.dtype) for a in attr])
+
+    fields = _record_fields(attr, dtype)
+    if fields:
+        content = ofile.read()
+        try:
+            data = _arff_core.read_records(content.encode('utf-8'), dtype,
+                                           fields, workers)
+            return data, meta
+        except ValueError:
+            # anything the compiled tokenizer does not handle goes through
+            # the csv module, which also reports bad records
+            ofile = io.StringIO(content)
 
     def generator(row_iter, delim=','):
         # TODO: this is where we are spending times (~80%). I think things
@@ -869,7 +941,7 @@ def _loadarff(ofile):
 
     a = list(generator(ofile))
     # No error should happen here: it is a bug otherwise
-    data = np.array(a, [(a.name, a.dtype) for a in attr])
+    data = np.array(a, dtype)
     return data, meta
 
 
@@ -1,9 +1,23 @@
 from __future__ import division, print_function, absolute_import
 
+from os.path import join
+
 
 def configuration(parent_package='io',top_path=None):
     from numpy.distutils.misc_util import Configuration
+    from scipy._build_utils.compiler_helper import set_cxx_threads_flags_hook
+
     config = Configuration('arff', parent_package, top_path)
+
+    # compiled data section of ARFF files
+    sparsetools_dir = join('..', '..', 'sparse', 'sparsetools')
+    ext = config.add_extension('_arff_core',
+                               sources=['_arff_coremodule.cxx'],
+                               include_dirs=['..', sparsetools_dir],
+                               depends=[join(sparsetools_dir, 'parallel.h'),
+                                        join('..', '_text_parse.h')])
+    ext._pre_build_hook = set_cxx_threads_flags_hook
+
     config.add_data_dir('tests')
     return config
 
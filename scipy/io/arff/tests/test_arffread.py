@@ -423,3 +423,42 @@ class TestQuotedNominalSpaces(object):
 
         assert_array_equal(self.data["age"], age_expected)
         assert_array_equal(self.data["smoker"], smoker_expected)
+
+
+class TestWorkers(object):
+    def setup_method(self):
+        rng = np.random.RandomState(1234)
+        n = 50000
+        self.x = rng.randn(n)
+        self.x[::97] = np.nan
+        self.colors = np.array(['red', 'green', 'blue', '?'])[
+            rng.randint(0, 4, n)]
+        lines = ["@relation workers",
+                 "@attribute x numeric",
+                 "@attribute color {red, green, blue}",
+                 "@data"]
+        for k, (x, color) in enumerate(zip(self.x, self.colors)):
+            if k % 1000 == 0:
+                lines.append("% comment")
+                lines.append("")
+            lines.append("%s, %s" % ('?' if np.isnan(x) else repr(x), color))
+        self.content = "\n".join(lines) + "\n"
+
+    def test_workers(self):
+        for workers in (None, 1, 4, -1):
+            data, meta = loadarff(StringIO(self.content), workers=workers)
+            assert_array_equal(data['x'], self.x)
+            assert_array_equal(data['color'], self.colors.astype('S5'))
+            assert_equal(data.dtype, np.dtype([('x', float),
+                                               ('color', 'S5')]))
+
+    def test_fallback(self):
+        # quoted values go through the csv module, with the same results
+        content = self.content.replace(', red', ', "red"')
+        data, meta = loadarff(StringIO(content), workers=2)
+        assert_array_equal(data['x'], self.x)
+        assert_array_equal(data['color'], self.colors.astype('S5'))
+
+        content = self.content.replace(", green\n", ", purple\n", 1)
+        assert_raises(ValueError, loadarff, StringIO(content), workers=2)
+        assert_raises(ValueError, loadarff, StringIO(self.content), workers=0)
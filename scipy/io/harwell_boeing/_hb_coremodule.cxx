@@ -0,0 +1,280 @@
+/*
+ * _hb_core module
+ *
+ * Compiled reader of the fixed-width data blocks of Harwell-Boeing files,
+ * the pointers, indices and values of the matrix, as read by hb.py. Each
+ * line of a block holds up to `repeat` fields of `width` characters, as
+ * given by the Fortran format of the block in the header; the fields need
+ * not be separated by blanks. The lines of a block are cut into chunks
+ * which are parsed on several threads, straight into the arrays allocated
+ * by the caller.
+ *
+ * Fields that are blank, as after the last value of a block, hold no
+ * value. Real values may have their exponent marked by 'D', as written by
+ * Fortran.
+ */
+
+#include <Python.h>
+
+#include <new>
+#include <vector>
+
+#define PY_ARRAY_UNIQUE_SYMBOL _scipy_io_hb_ARRAY_API
+#include "numpy/arrayobject.h"
+
+#include "parallel.h"
+#include "_text_parse.h"
+
+/* Bytes of a block per unit of work passed to parallel_num_chunks */
+#define HB_BYTES_PER_WORK 16
+
+
+static inline const char *parse_field(const char *p, const char *end,
+                                      npy_int32 *v, int *err)
+{
+    return parse_int(p, end, v, err);
+}
+
+static inline const char *parse_field(const char *p, const char *end,
+                                      npy_int64 *v, int *err)
+{
+    return parse_int(p, end, v, err);
+}
+
+static inline const char *parse_field(const char *p, const char *end,
+                                      double *v, int *err)
+{
+    return parse_double(p, end, v, err, true);
+}
+
+/*
+ * Calls f(p, q) for each nonblank field [p, q) of the line [p, end),
+ * until f returns false. Returns false if f did.
+ */
+template <class F>
+static bool for_each_field(const char *p, const char *end, npy_intp repeat,
+                           npy_intp width, const F &f)
+{
+    for (npy_intp k = 0; k < repeat && p < end; ++k) {
+        const char *q = end - p > width ? p + width : end;
+        if (skip_space(p, q) < q && !f(p, q)) {
+            return false;
+        }
+        p = q;
+    }
+    return true;
+}
+
+/*
+ * Reads the values of the block [begin, end) into out, of n_values, on up
+ * to workers threads. Returns the number of values in the block, and if
+ * it is n_values, an error of PARSE_SYNTAX or PARSE_OVERFLOW in *err with
+ * the (0-based) number of the first bad value in *bad. out is only written
+ * to if the number of values matches.
+ */
+template <class T>
+static npy_intp read_block(const char *begin, const char *end,
+                           npy_intp repeat, npy_intp width,
+                           npy_intp n_values, T *out, int workers, int *err,
+                           npy_intp *bad)
+{
+    const npy_intp n_chunks = parallel_num_chunks(
+        workers, (end - begin) / HB_BYTES_PER_WORK);
+    std::vector<const char *> starts;
+    std::vector<npy_intp> first(n_chunks + 1, 0);
+    std::vector<int> errors(n_chunks, PARSE_OK);
+    std::vector<npy_intp> bad_values(n_chunks, 0);
+
+    split_lines(begin, end, n_chunks, starts);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        npy_intp count = 0;
+        for (const char *p = starts[c]; p < starts[c + 1]; ) {
+            const char *q = line_end(p, end);
+            for_each_field(p, q, repeat, width,
+                           [&](const char *, const char *) {
+                ++count;
+                return true;
+            });
+            p = q < end ? q + 1 : end;
+        }
+        first[c + 1] = count;
+    });
+    for (npy_intp c = 0; c < n_chunks; ++c) {
+        first[c + 1] += first[c];
+    }
+    if (first[n_chunks] != n_values) {
+        return first[n_chunks];
+    }
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        npy_intp k = first[c];
+        for (const char *p = starts[c]; p < starts[c + 1]; ) {
+            const char *q = line_end(p, end);
+            bool ok = for_each_field(p, q, repeat, width,
+                                     [&](const char *f, const char *f_end) {
+                int e = PARSE_OK;
+                const char *r = parse_field(f, f_end, &out[k], &e);
+                if (r != NULL && skip_space(r, f_end) != f_end) {
+                    r = NULL;
+                    e = PARSE_SYNTAX;
+                }
+                if (r == NULL) {
+                    errors[c] = e;
+                    bad_values[c] = k;
+                    return false;
+                }
+                ++k;
+                return true;
+            });
+            if (!ok) {
+                return;
+            }
+            p = q < end ? q + 1 : end;
+        }
+    });
+
+    *err = PARSE_OK;
+    for (npy_intp c = 0; c < n_chunks; ++c) {
+        if (errors[c] != PARSE_OK) {
+            *err = errors[c];
+            *bad = bad_values[c];
+            break;
+        }
+    }
+    return n_values;
+}
+
+static char read_block_doc[] =
+"read_block(buffer, offset, nlines, repeat, width, out, workers)\n\
+\n\
+Reads the values of the block of nlines lines which starts at byte offset\n\
+of buffer, in fields of width characters, up to repeat per line, into the\n\
+vector out (int32, int64 or float64), on up to workers threads. Returns\n\
+the number of values in the block and the offset of its end; out is only\n\
+filled if the number is its length.";
+
+static PyObject *Py_read_block(PyObject *self, PyObject *args)
+{
+    Py_buffer buffer;
+    Py_ssize_t offset, nlines, repeat, width;
+    PyArrayObject *out;
+    int workers, err = PARSE_OK, no_memory = 0;
+    npy_intp n_found = 0, bad = 0;
+    PyThreadState *save;
+
+    if (!PyArg_ParseTuple(args, "s*nnnnO!i", &buffer, &offset, &nlines,
+                          &repeat, &width, &PyArray_Type, &out, &workers)) {
+        return NULL;
+    }
+    if (PyArray_NDIM(out) != 1 || !PyArray_ISCARRAY(out) ||
+            !PyArray_ISNOTSWAPPED(out) ||
+            (PyArray_TYPE(out) != NPY_INT32 &&
+             PyArray_TYPE(out) != NPY_INT64 &&
+             PyArray_TYPE(out) != NPY_DOUBLE)) {
+        PyBuffer_Release(&buffer);
+        PyErr_SetString(PyExc_ValueError,
+                        "out must be a writeable, contiguous, native int32, "
+                        "int64 or float64 vector");
+        return NULL;
+    }
+    if (offset < 0 || offset > buffer.len || nlines < 0 || repeat < 1 ||
+            width < 1) {
+        PyBuffer_Release(&buffer);
+        PyErr_SetString(PyExc_ValueError, "invalid block");
+        return NULL;
+    }
+    workers = workers > 1 ? workers : 1;
+
+    const char *begin = (const char *)buffer.buf + offset;
+    const char *buf_end = (const char *)buffer.buf + buffer.len;
+    const npy_intp n = PyArray_DIM(out, 0);
+    void *data = PyArray_DATA(out);
+    const int type = PyArray_TYPE(out);
+    const char *end = begin;
+
+    save = PyEval_SaveThread();
+    for (Py_ssize_t k = 0; k < nlines && end < buf_end; ++k) {
+        const char *q = line_end(end, buf_end);
+        end = q < buf_end ? q + 1 : buf_end;
+    }
+    try {
+        if (type == NPY_INT32) {
+            n_found = read_block(begin, end, repeat, width, n,
+                                 (npy_int32 *)data, workers, &err, &bad);
+        }
+        else if (type == NPY_INT64) {
+            n_found = read_block(begin, end, repeat, width, n,
+                                 (npy_int64 *)data, workers, &err, &bad);
+        }
+        else {
+            n_found = read_block(begin, end, repeat, width, n,
+                                 (double *)data, workers, &err, &bad);
+        }
+    }
+    catch (const std::bad_alloc &) {
+        no_memory = 1;
+    }
+    PyEval_RestoreThread(save);
+    const Py_ssize_t end_offset = end - (const char *)buffer.buf;
+    PyBuffer_Release(&buffer);
+
+    if (no_memory) {
+        return PyErr_NoMemory();
+    }
+    if (err == PARSE_SYNTAX) {
+        PyErr_Format(PyExc_ValueError, "Parse error in value %zd",
+                     (Py_ssize_t)bad + 1);
+        return NULL;
+    }
+    if (err == PARSE_OVERFLOW) {
+        PyErr_Format(PyExc_OverflowError,
+                     "value %zd does not fit in the data type",
+                     (Py_ssize_t)bad + 1);
+        return NULL;
+    }
+    return Py_BuildValue("nn", (Py_ssize_t)n_found, end_offset);
+}
+
+
+/*
+ * Main _hb_core module
+ */
+
+static PyMethodDef core_methods[] = {
+    {"read_block", (PyCFunction) Py_read_block, METH_VARARGS,
+     read_block_doc},
+    {NULL, NULL}
+};
+
+#if PY_VERSION_HEX >= 0x03000000
+
+static struct PyModuleDef moduledef = {
+    PyModuleDef_HEAD_INIT,
+    "_hb_core",
+    NULL,
+    -1,
+    core_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+PyMODINIT_FUNC PyInit__hb_core(void)
+{
+    import_array();
+
+    return PyModule_Create(&moduledef);
+}
+
+#else
+
+PyMODINIT_FUNC init_hb_core(void)
+{
+    import_array();
+
+    Py_InitModule("_hb_core", core_methods);
+}
+
+#endif
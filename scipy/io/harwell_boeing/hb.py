@@ -14,18 +14,20 @@ from __future__ import division, print_function, absolute_import
 # TODO:
 #   - Add more support (symmetric/complex matrices, non-assembled matrices ?)
 
-# XXX: reading is reasonably efficient (>= 85 % is in numpy.fromstring), but
-# takes a lot of memory. Being faster would require compiled code.
-# write is not efficient. Although not a terribly exciting task,
-# having reusable facilities to efficiently read/write fortran-formatted files
-# would be useful outside this module.
+# XXX: reading is done by compiled code (_hb_core), write is not efficient.
+# Although not a terribly exciting task, having reusable facilities to
+# efficiently write fortran-formatted files would be useful outside this
+# module.
 
 import warnings
 
 import numpy as np
 from scipy.sparse import csc_matrix
+from scipy.sparse.sputils import get_index_dtype
+from scipy.sparse._workers import _workers
 from scipy.io.harwell_boeing._fortran_format_parser import \
         FortranFormatParser, IntFormat, ExpFormat
+from scipy.io.harwell_boeing import _hb_core
 
 __all__ = ["MalformedHeader", "hb_read", "hb_write", "HBInfo", "HBFile",
            "HBMatrixType"]
@@ -309,27 +311,32 @@ def _expect_int(value, msg=None):
 
 
 def _read_hb_data(content, header):
-    # XXX: look at a way to reduce memory here (big string creation)
-    ptr_string = "".join([content.read(header.pointer_nbytes_full),
-                           content.readline()])
-    ptr = np.fromstring(ptr_string,
-            dtype=int, sep=' ')
-
-    ind_string = "".join([content.read(header.indices_nbytes_full),
-                       content.readline()])
-    ind = np.fromstring(ind_string,
-            dtype=int, sep=' ')
-
-    val_string = "".join([content.read(header.values_nbytes_full),
-                          content.readline()])
-    val = np.fromstring(val_string,
-            dtype=header.values_dtype, sep=' ')
-
-    try:
-        return csc_matrix((val, ind-1, ptr-1),
-                          shape=(header.nrows, header.ncols))
-    except ValueError as e:
-        raise e
+    data = content.read()
+    if not isinstance(data, bytes):
+        data = data.encode('utf-8')
+    workers = _workers(None)
+
+    # +1 for the one-based pointers
+    idx_dtype = get_index_dtype(maxval=max(header.nrows, header.ncols,
+                                           header.nnon_zeros) + 1)
+    ptr = np.empty(header.ncols + 1, dtype=idx_dtype)
+    ind = np.empty(header.nnon_zeros, dtype=idx_dtype)
+    val = np.empty(header.nnon_zeros, dtype=header.values_dtype)
+
+    offset = 0
+    for name, out, nlines, fmt in (
+            ("pointer", ptr, header.pointer_nlines, header.pointer_format),
+            ("indices", ind, header.indices_nlines, header.indices_format),
+            ("values", val, header.values_nlines, header.values_format)):
+        n, offset = _hb_core.read_block(data, offset, nlines,
+                                        fmt.repeat or 1, fmt.width, out,
+                                        workers)
+        if n != out.size:
+            raise ValueError("Expected %d %s, got %d" % (out.size, name, n))
+
+    ptr -= 1
+    ind -= 1
+    return csc_matrix((val, ind, ptr), shape=(header.nrows, header.ncols))
 
 
 def _write_data(m, fid, header):
@@ -492,6 +499,9 @@ def hb_read(path_or_open_file):
         - integer for pointer/indices
         - exponential format for float values, and int format
 
+    The pointers, indices and values are parsed by compiled code, on up to
+    ``scipy.sparse.get_workers()`` threads.
+
     """
     def _get_matrix(fid):
         hb = HBFile(fid)
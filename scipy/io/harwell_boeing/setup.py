@@ -1,9 +1,23 @@
 from __future__ import division, print_function, absolute_import
 
+from os.path import join
+
 
 def configuration(parent_package='',top_path=None):
     from numpy.distutils.misc_util import Configuration
+    from scipy._build_utils.compiler_helper import set_cxx_threads_flags_hook
+
     config = Configuration('harwell_boeing',parent_package,top_path)
+
+    # compiled data blocks of Harwell-Boeing files
+    sparsetools_dir = join('..', '..', 'sparse', 'sparsetools')
+    ext = config.add_extension('_hb_core',
+                               sources=['_hb_coremodule.cxx'],
+                               include_dirs=['..', sparsetools_dir],
+                               depends=[join(sparsetools_dir, 'parallel.h'),
+                                        join('..', '_text_parse.h')])
+    ext._pre_build_hook = set_cxx_threads_flags_hook
+
     config.add_data_dir('tests')
 
     return config
@@ -12,7 +12,9 @@ import numpy as np
 from numpy.testing import assert_equal, \
     assert_array_almost_equal_nulp
 
-from scipy.sparse import coo_matrix, csc_matrix, rand
+from pytest import raises as assert_raises
+
+from scipy.sparse import coo_matrix, csc_matrix, rand, set_workers
 
 from scipy.io import hb_read, hb_write
 
@@ -49,11 +51,40 @@ def assert_csc_almost_equal(r, l):
     assert_array_almost_equal_nulp(r.data, l.data, 10000)
 
 
+FIXED_WIDTH = """\
+No Title                                                                |No Key
+             3             1             1             1
+RUA                        2             2             2             0
+(3I1)           (2I1)           (2E10.3)
+123
+12
+ 1.000D+00-2.500E-01
+"""
+
+
 class TestHBReader(object):
     def test_simple(self):
         m = hb_read(StringIO(SIMPLE))
         assert_csc_almost_equal(m, SIMPLE_MATRIX)
 
+    def test_fixed_width(self):
+        # fields need not be separated, and exponents may be marked by D
+        m = hb_read(StringIO(FIXED_WIDTH))
+        assert_equal(m.toarray(), [[1, 0], [0, -0.25]])
+
+    def test_workers(self):
+        value = rand(2000, 3000, 0.03, format='csc', random_state=1234)
+        file = StringIO()
+        hb_write(file, value)
+        for workers in (1, 4):
+            file.seek(0)
+            with set_workers(workers):
+                value_loaded = hb_read(file)
+            assert_csc_almost_equal(value, value_loaded)
+
+        file = StringIO(FIXED_WIDTH.replace("12\n", "1x\n"))
+        assert_raises(ValueError, hb_read, file)
+
 
 class TestHBReadWrite(object):
 
@@ -71,6 +71,9 @@ def mat_reader_factory(file_name, appendmat=True, **kwargs):
     byte_stream, file_opened = _open_file(file_name, appendmat)
     mjv, mnv = get_matfile_version(byte_stream)
     if mjv == 0:
+        # v4 files are read in full
+        kwargs.pop('workers', None)
+        kwargs.pop('mmap', None)
         return MatFile4Reader(byte_stream, **kwargs), file_opened
     elif mjv == 1:
         return MatFile5Reader(byte_stream, **kwargs), file_opened
@@ -128,6 +131,21 @@ def loadmat(file_name, mdict=None, appendmat=True, **kwargs):
         MATLAB variables to read from the file.  The reader will skip any
         variable with a name not in this sequence, possibly saving some read
         processing.
+    workers : int, optional
+        Number of threads decompressing the variables of compressed (v7)
+        files ahead of the one being read, if all variables are read.
+        The default, None, means 1; negative values wrap around from
+        ``os.cpu_count()``.
+
+        .. versionadded:: 1.4.0
+    mmap : bool, optional
+        Whether to map the file into memory rather than read it, for the
+        uncompressed variables of v6 and v7 files. Their numeric and
+        sparse arrays are then views into the map, read from disk as they
+        are used; writing to them does not change the file. `file_name`
+        must be a name or an open file. Default is False.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
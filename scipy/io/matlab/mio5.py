@@ -76,6 +76,8 @@ import os
 import time
 import sys
 import zlib
+import threading
+from collections import deque
 
 from io import BytesIO
 
@@ -92,7 +94,7 @@ from .byteordercodes import native_code, swapped_code
 
 from .miobase import (MatFileReader, docfiller, matdims, read_dtype,
                       arr_to_chars, arr_dtype_number, MatWriteError,
-                      MatReadError, MatReadWarning)
+                      MatReadError, MatReadWarning, _check_workers)
 
 # Reader object for matlab 5 format variables
 from .mio5_utils import VarReader5
@@ -104,7 +106,7 @@ from .mio5_params import (MatlabObject, MatlabFunction, MDTYPES, NP_TO_MTYPES,
                           mxOBJECT_CLASS, mxCHAR_CLASS, mxSPARSE_CLASS,
                           mxDOUBLE_CLASS, mclass_info)
 
-from .streams import ZlibInputStream
+from .streams import ZlibInputStream, BufferStream
 
 
 class MatFile5Reader(MatFileReader):
@@ -137,7 +139,9 @@ class MatFile5Reader(MatFileReader):
                  matlab_compatible=False,
                  struct_as_record=True,
                  verify_compressed_data_integrity=True,
-                 uint16_codec=None
+                 uint16_codec=None,
+                 workers=None,
+                 mmap=False
                  ):
         '''Initializer for matlab 5 file format reader
 
@@ -147,6 +151,15 @@ class MatFile5Reader(MatFileReader):
     uint16_codec : {None, string}
         Set codec to use for uint16 char arrays (e.g. 'utf-8').
         Use system default codec if None
+    workers : int, optional
+        Number of threads decompressing variables ahead of the one being
+        read by `get_variables`. The default, None, means 1; negative
+        values wrap around from ``os.cpu_count()``.
+    mmap : bool, optional
+        Whether to read uncompressed variables from a copy-on-write memory
+        map of the file, so that their numeric arrays are views into it,
+        read from disk as they are used. Writing to them changes only the
+        memory. Default is False.
         '''
         super(MatFile5Reader, self).__init__(
             mat_stream,
@@ -162,6 +175,11 @@ class MatFile5Reader(MatFileReader):
         if not uint16_codec:
             uint16_codec = sys.getdefaultencoding()
         self.uint16_codec = uint16_codec
+        self.workers = _check_workers(workers)
+        if mmap and not hasattr(mat_stream, 'fileno'):
+            raise ValueError('Cannot use file object for mmap')
+        self.use_mmap = mmap
+        self._mm_buf = None
         # placeholders for readers - see initialize_read method
         self._file_reader = None
         self._matrix_reader = None
@@ -224,6 +242,10 @@ class MatFile5Reader(MatFileReader):
             self._matrix_reader.set_stream(stream)
             check_stream_limit = self.verify_compressed_data_integrity
             mdtype, byte_count = self._matrix_reader.read_full_tag()
+        elif self._mm_buf is not None:
+            check_stream_limit = False
+            self._matrix_reader.set_stream(
+                BufferStream(self._mm_buf[self.mat_stream.tell():next_pos]))
         else:
             check_stream_limit = False
             self._matrix_reader.set_stream(self.mat_stream)
@@ -232,6 +254,82 @@ class MatFile5Reader(MatFileReader):
         header = self._matrix_reader.read_header(check_stream_limit)
         return header, next_pos
 
+    def _var_index(self):
+        ''' Positions, types and sizes of the top level elements
+
+        Returns a list of ``(position, mdtype, byte_count)``, where
+        `position` is that of the data of the element, after its tag. The
+        stream is left at its end.
+        '''
+        index = []
+        while not self.end_of_stream():
+            mdtype, byte_count = self._file_reader.read_full_tag()
+            if not byte_count > 0:
+                raise ValueError("Did not read any bytes")
+            position = self.mat_stream.tell()
+            index.append((position, mdtype, byte_count))
+            self.mat_stream.seek(position + byte_count)
+        return index
+
+    def _read_var_headers(self, workers):
+        ''' Generate the results of read_var_header for the whole stream
+
+        With more than one worker, each element is read whole, and up to
+        `workers` compressed elements after the current one are
+        decompressed on threads meanwhile (zlib releases the GIL). The
+        matrix reader then reads from the element in memory, and numeric
+        arrays are views into it rather than copies.
+        '''
+        if workers == 1:
+            while not self.end_of_stream():
+                yield self.read_var_header()
+            return
+
+        def decompress(data, result):
+            try:
+                decompressor = zlib.decompressobj()
+                out = decompressor.decompress(data)
+                # as for ZlibInputStream, the end of stream may be missing
+                rest = decompressor.flush()
+                result.append(out + rest if rest else out)
+            except BaseException as e:
+                result.append(e)
+
+        def start(position, mdtype, byte_count):
+            if mdtype != miCOMPRESSED and self._mm_buf is not None:
+                return None, [self._mm_buf[position:position + byte_count]]
+            self.mat_stream.seek(position)
+            data = self.mat_stream.read(byte_count)
+            if len(data) != byte_count:
+                raise IOError('could not read bytes')
+            if mdtype != miCOMPRESSED:
+                return None, [data]
+            result = []
+            thread = threading.Thread(target=decompress, args=(data, result))
+            thread.daemon = True
+            thread.start()
+            return thread, result
+
+        index = self._var_index()
+        pending = deque()
+        for k, (position, mdtype, byte_count) in enumerate(index):
+            while len(pending) <= workers and k + len(pending) < len(index):
+                pending.append(start(*index[k + len(pending)]))
+            thread, result = pending.popleft()
+            if thread is not None:
+                thread.join()
+            if isinstance(result[0], BaseException):
+                raise result[0]
+            self._matrix_reader.set_stream(BufferStream(result[0]))
+            check_stream_limit = False
+            if mdtype == miCOMPRESSED:
+                check_stream_limit = self.verify_compressed_data_integrity
+                mdtype, _ = self._matrix_reader.read_full_tag()
+            if not mdtype == miMATRIX:
+                raise TypeError('Expecting miMATRIX type here, got %d' % mdtype)
+            header = self._matrix_reader.read_header(check_stream_limit)
+            yield header, position + byte_count
+
     def read_var_array(self, header, process=True):
         ''' Read array, given `header`
 
@@ -263,13 +361,18 @@ class MatFile5Reader(MatFileReader):
         elif variable_names is not None:
             variable_names = list(variable_names)
 
+        if self.use_mmap and self._mm_buf is None:
+            self._mm_buf = np.memmap(self.mat_stream, dtype=np.uint8,
+                                     mode='c')
         self.mat_stream.seek(0)
         # Here we pass all the parameters in self to the reading objects
         self.initialize_read()
         mdict = self.read_file_header()
         mdict['__globals__'] = []
-        while not self.end_of_stream():
-            hdr, next_position = self.read_var_header()
+        # decompress ahead only if all variables are read; otherwise, only
+        # the headers of those skipped need decompressing
+        workers = self.workers if variable_names is None else 1
+        for hdr, next_position in self._read_var_headers(workers):
             name = asstr(hdr.name)
             if name in mdict:
                 warnings.warn('Duplicate variable name "%s" in stream'
@@ -312,7 +312,8 @@ cdef class VarReader5:
                              cnp.uint32_t *mdtype_ptr,
                              cnp.uint32_t *byte_count_ptr,
                              void **pp,
-                             int copy=True):
+                             int copy=True,
+                             int shared=False):
         ''' Read data element into string buffer, return buffer
 
         The element is the atom of the matlab file format.
@@ -331,6 +332,10 @@ cdef class VarReader5:
            altered without interfering with other objects.  Otherwise
            return string that should not be written to, therefore saving
            unnecessary copies
+        shared : int
+           If not 0, the returned object may also hold the data of other
+           elements, which the caller should leave alone (see
+           ``GenericStream.read_shared``)
 
         Return
         ------
@@ -352,10 +357,10 @@ cdef class VarReader5:
         mdtype = mdtype_ptr[0]
         byte_count = byte_count_ptr[0]
         if tag_res == 1: # full format
-            data = self.cstream.read_string(
-                byte_count,
-                pp,
-                copy)
+            if shared:
+                data = self.cstream.read_shared(byte_count, pp, copy)
+            else:
+                data = self.cstream.read_string(byte_count, pp, copy)
             # Seek to next 64-bit boundary
             mod8 = byte_count % 8
             if mod8:
@@ -424,7 +429,9 @@ cdef class VarReader5:
         ----------
         copy : bool, optional
             Whether to copy the array before returning.  If False, return array
-            backed by bytes read from file.
+            backed by bytes read from file.  Reading from a ``BufferStream``,
+            the array is a view into its data either way, but writeable if
+            True.
         nnz : int, optional
             Number of non-zero values when reading numeric data from sparse
             matrices.  -1 if not reading sparse matrices, or to disable check
@@ -448,7 +455,7 @@ cdef class VarReader5:
         cdef cnp.npy_intp el_count
         cdef cnp.ndarray el
         cdef object data = self.read_element(
-            &mdtype, &byte_count, <void **>&data_ptr, copy)
+            &mdtype, &byte_count, <void **>&data_ptr, copy, True)
         cdef cnp.dtype dt = <cnp.dtype>self.dtypes[mdtype]
         if dt.itemsize != 1 and nnz != -1 and byte_count == nnz:
             el_count = <cnp.npy_intp> nnz
@@ -7,6 +7,7 @@ MATLAB is a registered trademark of the Mathworks inc.
 """
 from __future__ import division, print_function, absolute_import
 
+import os
 import sys
 import operator
 
@@ -28,6 +29,28 @@ class MatReadError(Exception):
     pass
 
 
+def _check_workers(workers):
+    """Normalize a ``workers`` argument to a positive thread count.
+
+    ``None`` means a single thread, and negative values wrap around from
+    ``os.cpu_count()``, so that ``-1`` means all CPUs.
+    """
+    if workers is None:
+        return 1
+
+    workers = operator.index(workers)
+    if workers < 0:
+        cpu_count = os.cpu_count() or 1
+        if workers >= -cpu_count:
+            workers += 1 + cpu_count
+        else:
+            raise ValueError("workers value out of range; got {}, must not be"
+                             " less than {}".format(workers, -cpu_count))
+    elif workers == 0:
+        raise ValueError("workers must not be zero")
+    return workers
+
+
 class MatWriteError(Exception):
     pass
 
@@ -7,5 +7,6 @@ cdef class GenericStream:
     cpdef long int tell(self) except -1
     cdef int read_into(self, void *buf, size_t n) except -1
     cdef object read_string(self, size_t n, void **pp, int copy=*)
+    cdef object read_shared(self, size_t n, void **pp, int copy=*)
 
 cpdef GenericStream make_stream(object fobj)
@@ -7,6 +7,8 @@ import zlib
 
 from cpython cimport PyBytes_FromStringAndSize, \
     PyBytes_AS_STRING, PyBytes_Size
+from cpython.buffer cimport PyObject_GetBuffer, PyBuffer_Release, \
+    PyBUF_SIMPLE
 
 from .pyalloc cimport pyalloc_v
 
@@ -99,6 +101,11 @@ cdef class GenericStream:
         self.read_into(pp[0], n)
         return d_copy
 
+    cdef object read_shared(self, size_t n, void **pp, int copy=True):
+        """As read_string, but the object returned may also hold other data,
+        which the caller should leave alone"""
+        return self.read_string(n, pp, copy)
+
 
 cdef class ZlibInputStream(GenericStream):
     """
@@ -236,6 +243,103 @@ cdef class ZlibInputStream(GenericStream):
         return 0
 
 
+cdef class BufferStream(GenericStream):
+    """
+    File-like object reading from bytes already in memory.
+
+    Parameters
+    ----------
+    data : bytes-like
+        Contiguous bytes to read, such as a decompressed miCOMPRESSED
+        element, or a slice of a copy-on-write memory map of the file.
+
+    Notes
+    -----
+    ``read_shared`` returns `data` itself, so that numeric arrays can be
+    views into it rather than copies; no one else should write to `data`.
+    """
+
+    cdef object _data
+    cdef Py_buffer _view
+    cdef bint _has_view
+    cdef size_t _size
+    cdef size_t _position
+
+    def __init__(self, data):
+        self.fobj = None
+        if self._has_view:
+            PyBuffer_Release(&self._view)
+            self._has_view = False
+        PyObject_GetBuffer(data, &self._view, PyBUF_SIMPLE)
+        self._has_view = True
+        self._data = data
+        self._size = self._view.len
+        self._position = 0
+
+    def __dealloc__(self):
+        if self._has_view:
+            PyBuffer_Release(&self._view)
+
+    cdef inline char *_advance(self, size_t n) except NULL:
+        """Pointer to the next n bytes, which are then read"""
+        cdef char *p
+        if n > self._size - self._position:
+            raise IOError('could not read bytes')
+        p = <char*>self._view.buf + self._position
+        self._position += n
+        return p
+
+    cdef int read_into(self, void *buf, size_t n) except -1:
+        """Read n bytes from stream into pre-allocated buffer `buf`
+        """
+        memcpy(buf, self._advance(n), n)
+        return 0
+
+    cdef object read_string(self, size_t n, void **pp, int copy=True):
+        """Make new memory, wrap with object"""
+        cdef object d_copy = pyalloc_v(n, pp)
+        memcpy(pp[0], self._advance(n), n)
+        return d_copy
+
+    cdef object read_shared(self, size_t n, void **pp, int copy=True):
+        """Point pp[0] into the data, and return the data
+
+        Bytes of our own may be written to, as those of ``pyalloc_v``, but
+        other read-only memory is copied if `copy` is set.
+        """
+        if copy and self._view.readonly and not isinstance(self._data, bytes):
+            return self.read_string(n, pp, copy)
+        pp[0] = self._advance(n)
+        return self._data
+
+    def read(self, n_bytes):
+        cdef void *p
+        return self.read_string(n_bytes, &p)
+
+    cpdef int all_data_read(self):
+        return self._position == self._size
+
+    cpdef long int tell(self) except -1:
+        return self._position
+
+    cpdef int seek(self, long int offset, int whence=0) except -1:
+        cdef long int new_pos
+        if whence == 0:
+            new_pos = offset
+        elif whence == 1:
+            new_pos = <long int>self._position + offset
+        elif whence == 2:
+            new_pos = <long int>self._size + offset
+        else:
+            raise ValueError("Invalid value for whence")
+
+        if new_pos < 0:
+            raise IOError("Invalid file position.")
+        # as for a zlib stream, seeking stops at the end of the data
+        self._position = min(<size_t>new_pos, self._size)
+        return 0
+
+
 cdef class cStringStream(GenericStream):
     
     cpdef int seek(self, long int offset, int whence=0) except -1:
@@ -1233,3 +1233,87 @@ def test_filenotfound():
     # Check the correct error is thrown
     assert_raises(IOError, loadmat, "NotExistentFile00.mat")
     assert_raises(IOError, loadmat, "NotExistentFile00")
+
+
+def test_loadmat_workers(tmpdir):
+    # variables decompressed ahead on threads are read as on one
+    rng = np.random.RandomState(1234)
+    variables = OrderedDict([
+        ('a', rng.rand(200, 300)),
+        ('b', rng.rand(50) + 1j * rng.rand(50)),
+        ('c', SP.random(100, 80, density=0.1, format='csc',
+                        random_state=rng)),
+        ('d', np.arange(10, dtype=np.int16)),
+        ('e', u'a string'),
+        ('f', {'x': np.eye(3), 'y': 'field'})])
+    for do_compression in (False, True):
+        fname = str(tmpdir.join('workers.mat'))
+        savemat(fname, variables, do_compression=do_compression)
+        expected = loadmat(fname)
+        for workers in (2, 4, -1):
+            res = loadmat(fname, workers=workers)
+            assert_equal(sorted(res), sorted(expected))
+            for name in ('a', 'b', 'd', 'e'):
+                assert_array_equal(res[name], expected[name])
+            assert_array_equal(res['c'].toarray(), variables['c'].toarray())
+            assert_array_equal(res['f']['x'][0, 0], np.eye(3))
+            assert_array_equal(res['f']['y'][0, 0], ['field'])
+            # numeric arrays are views into the decompressed data, but
+            # still writeable
+            res['a'][0, 0] = -1
+            assert_equal(res['a'][0, 0], -1)
+        res = loadmat(fname, workers=4, variable_names=['d'])
+        assert_array_equal(res['d'], expected['d'])
+    assert_raises(ValueError, loadmat, fname, workers=0)
+
+    # test data files, as far as compared here
+    for fname in glob(pjoin(test_data_path, '*_7.*.mat')):
+        with warnings.catch_warnings():
+            warnings.simplefilter('ignore')
+            expected = loadmat(fname)
+            res = loadmat(fname, workers=3)
+        assert_equal(sorted(res), sorted(expected))
+        for name in res:
+            if isinstance(res[name], np.ndarray) and res[name].dtype != object:
+                assert_array_equal(res[name], expected[name])
+
+
+def test_loadmat_mmap(tmpdir):
+    def in_memmap(arr):
+        while arr is not None:
+            if isinstance(arr, np.memmap):
+                return True
+            arr = arr.base
+        return False
+
+    rng = np.random.RandomState(1234)
+    variables = OrderedDict([
+        ('a', rng.rand(200, 300)),
+        ('b', rng.rand(50) + 1j * rng.rand(50)),
+        ('c', SP.random(100, 80, density=0.1, format='csc',
+                        random_state=rng)),
+        ('d', np.arange(10, dtype=np.int16)),
+        ('f', {'x': np.eye(3), 'y': 'field'})])
+    fname = str(tmpdir.join('mmap.mat'))
+    for do_compression in (False, True):
+        savemat(fname, variables, do_compression=do_compression)
+        for workers in (1, 2):
+            res = loadmat(fname, mmap=True, workers=workers)
+            assert_array_equal(res['a'], variables['a'])
+            assert_array_equal(res['b'], variables['b'][None, :])
+            assert_array_equal(res['c'].toarray(), variables['c'].toarray())
+            assert_array_equal(res['d'], variables['d'][None, :])
+            assert_array_equal(res['f']['x'][0, 0], np.eye(3))
+            assert_equal(in_memmap(res['a']), not do_compression)
+            assert_equal(in_memmap(res['c'].data), not do_compression)
+            assert_equal(in_memmap(res['f']['x'][0, 0]), not do_compression)
+            # writing to the arrays leaves the file alone
+            res['a'][0, 0] = -1
+            assert_array_equal(loadmat(fname)['a'], variables['a'])
+        res = loadmat(fname, mmap=True, variable_names=['d'])
+        assert_equal(sorted(res), ['__globals__', '__header__',
+                                   '__version__', 'd'])
+
+    with open(fname, 'rb') as f:
+        stream = BytesIO(f.read())
+    assert_raises(ValueError, loadmat, stream, mmap=True)
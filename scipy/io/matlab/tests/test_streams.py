@@ -24,7 +24,7 @@ from numpy.testing import assert_, assert_equal
 from pytest import raises as assert_raises
 
 from scipy.io.matlab.streams import (make_stream,
-    GenericStream, cStringStream, FileStream, ZlibInputStream,
+    GenericStream, cStringStream, FileStream, ZlibInputStream, BufferStream,
     _read_into, _read_string)
 
 IS_PYPY = ('__pypy__' in sys.modules)
@@ -182,3 +182,25 @@ class TestZlibInputStream(object):
         stream.seek(1024)
         assert_(stream.all_data_read())
 
+
+def test_buffer_stream():
+    data = np.random.randint(0, 256, 1024).astype(np.uint8).tostring()
+    stream = BufferStream(data)
+    assert_(make_stream(stream) is stream)
+
+    assert_equal(stream.read(11), data[:11])
+    assert_equal(_read_into(stream, 5), data[11:16])
+    assert_equal(_read_string(stream, 7), data[16:23])
+    stream.seek(321, 1)
+    p = 23 + 321
+    assert_equal(stream.tell(), p)
+    assert_equal(stream.read(21), data[p:p+21])
+    stream.seek(-10, 2)
+    assert_equal(stream.read(10), data[-10:])
+    assert_(stream.all_data_read())
+
+    assert_raises(IOError, stream.seek, -1, 0)
+    assert_raises(ValueError, stream.seek, 1, 123)
+    stream.seek(10000)
+    assert_equal(stream.tell(), len(data))
+    assert_raises(IOError, stream.read, 1)
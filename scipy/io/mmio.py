@@ -14,13 +14,17 @@ from __future__ import division, print_function, absolute_import
 
 import os
 import sys
+import mmap
 
 from numpy import (asarray, real, imag, conj, zeros, ndarray, concatenate,
-                   ones, can_cast)
+                   ones, can_cast, ascontiguousarray)
 from numpy.compat import asbytes, asstr
 
 from scipy._lib.six import string_types
 from scipy.sparse import coo_matrix, isspmatrix
+from scipy.sparse.sputils import get_index_dtype
+from scipy.sparse._workers import _workers
+from . import _mmio_core
 
 __all__ = ['mminfo', 'mmread', 'mmwrite', 'MMFile']
 
@@ -71,6 +75,12 @@ def mmread(source):
     a : ndarray or coo_matrix
         Dense or sparse matrix depending on the matrix format in the
         Matrix Market file.
+
+    Notes
+    -----
+    The entries of a sparse matrix are parsed on up to
+    ``scipy.sparse.get_workers()`` threads, from a memory map of the file
+    if it is not compressed. ``a.tocsr()`` then runs on as many threads.
     """
     return MMFile().read(source)
 
@@ -97,6 +107,11 @@ def mmwrite(target, a, comment='', field=None, precision=None, symmetry=None):
         Either 'general', 'symmetric', 'skew-symmetric', or 'hermitian'.
         If symmetry is None the symmetry type of 'a' is determined by its
         values.
+
+    Notes
+    -----
+    The entries of a sparse matrix are formatted on up to
+    ``scipy.sparse.get_workers()`` threads.
     """
     MMFile().write(target, a, comment, field, precision, symmetry)
 
@@ -593,8 +608,9 @@ class MMFile (object):
                 # empty matrix
                 return coo_matrix((rows, cols), dtype=dtype)
 
-            I = zeros(entries, dtype='intc')
-            J = zeros(entries, dtype='intc')
+            idx_dtype = get_index_dtype(maxval=max(rows, cols))
+            I = zeros(entries, dtype=idx_dtype)
+            J = zeros(entries, dtype=idx_dtype)
             if is_pattern:
                 V = ones(entries, dtype='int8')
             elif is_integer:
@@ -606,34 +622,22 @@ class MMFile (object):
             else:
                 V = zeros(entries, dtype='float')
 
-            entry_number = 0
-            for line in stream:
-                if not line or line.startswith(b'%') or not line.strip():
-                    continue
-
-                if entry_number+1 > entries:
-                    raise ValueError("'entries' in header is smaller than "
-                                     "number of entries")
-                l = line.split()
-                I[entry_number], J[entry_number] = map(int, l[:2])
-
-                if not is_pattern:
-                    if is_integer:
-                        V[entry_number] = int(l[2])
-                    elif is_unsigned_integer:
-                        V[entry_number] = int(l[2])
-                    elif is_complex:
-                        V[entry_number] = complex(*map(float, l[2:]))
-                    else:
-                        V[entry_number] = float(l[2])
-                entry_number += 1
-            if entry_number < entries:
+            # parse the rest of the file into I, J and V (0-based)
+            body, offset = _body_buffer(stream)
+            try:
+                found = _mmio_core.read_coordinate(
+                    body, offset, I, J, None if is_pattern else V,
+                    _workers(None))
+            finally:
+                if isinstance(body, mmap.mmap):
+                    body.close()
+            if found > entries:
+                raise ValueError("'entries' in header is smaller than "
+                                 "number of entries")
+            if found < entries:
                 raise ValueError("'entries' in header is larger than "
                                  "number of entries")
 
-            I -= 1  # adjust indices (base 1 -> base 0)
-            J -= 1
-
             if has_symmetry:
                 mask = (I != J)       # off diagonal mask
                 od_I = I[mask]
@@ -785,22 +789,53 @@ class MMFile (object):
             # write shape spec
             stream.write(asbytes('%i %i %i\n' % (rows, cols, coo.nnz)))
 
-            template = self._field_template(field, precision-1)
-
             if field == self.FIELD_PATTERN:
-                for r, c in zip(coo.row+1, coo.col+1):
-                    stream.write(asbytes("%i %i\n" % (r, c)))
-            elif field in (self.FIELD_INTEGER, self.FIELD_REAL, self.FIELD_UNSIGNED):
-                for r, c, d in zip(coo.row+1, coo.col+1, coo.data):
-                    stream.write(asbytes(("%i %i " % (r, c)) +
-                                         (template % d)))
+                data = None
+            elif field == self.FIELD_INTEGER:
+                data = coo.data.astype('int64')
+            elif field == self.FIELD_UNSIGNED:
+                data = coo.data.astype('uint64')
+            elif field == self.FIELD_REAL:
+                data = coo.data.astype('d')
             elif field == self.FIELD_COMPLEX:
-                for r, c, d in zip(coo.row+1, coo.col+1, coo.data):
-                    stream.write(asbytes(("%i %i " % (r, c)) +
-                                         (template % (d.real, d.imag))))
+                data = coo.data.astype('D')
             else:
                 raise TypeError('Unknown field type %s' % field)
 
+            # format the entries in blocks, each on several threads
+            row = ascontiguousarray(coo.row)
+            col = ascontiguousarray(coo.col)
+            workers = _workers(None)
+            for start in range(0, coo.nnz, _WRITE_BLOCK_SIZE):
+                block = slice(start, start + _WRITE_BLOCK_SIZE)
+                stream.write(_mmio_core.format_coordinate(
+                    row[block], col[block],
+                    None if data is None else data[block], precision - 1,
+                    workers))
+
+
+# Number of entries of a sparse matrix formatted at once by MMFile._write
+_WRITE_BLOCK_SIZE = 1 << 20
+
+
+def _body_buffer(stream):
+    """
+    Return a buffer with the rest of `stream`, and the offset in it where
+    the rest starts.
+
+    Files on disk are mapped into memory as a whole; other streams, such as
+    compressed files, are read to the end.
+    """
+    if sys.version_info[0] >= 3 and _is_fromfile_compatible(stream):
+        try:
+            offset = stream.tell()
+            return mmap.mmap(stream.fileno(), 0,
+                             access=mmap.ACCESS_READ), offset
+        except (AttributeError, EnvironmentError, ValueError):
+            # no file descriptor, or one which cannot be mapped
+            pass
+    return stream.read(), 0
+
 
 def _is_fromfile_compatible(stream):
     """
@@ -1,13 +1,30 @@
 from __future__ import division, print_function, absolute_import
 
+from os.path import join
+
 
 def configuration(parent_package='',top_path=None):
     from numpy.distutils.misc_util import Configuration
+    from scipy._build_utils.compiler_helper import set_cxx_threads_flags_hook
+
     config = Configuration('io', parent_package, top_path)
 
     config.add_extension('_test_fortran',
                          sources=['_test_fortran.pyf', '_test_fortran.f'])
 
+    # compiled coordinate body of Matrix Market files
+    sparsetools_dir = join('..', 'sparse', 'sparsetools')
+    ext = config.add_extension('_mmio_core',
+                               sources=['_mmio_coremodule.cxx'],
+                               include_dirs=[sparsetools_dir],
+                               depends=[join(sparsetools_dir, 'parallel.h'),
+                                        '_text_parse.h'])
+    ext._pre_build_hook = set_cxx_threads_flags_hook
+
+    # 24-bit samples of WAV files
+    config.add_extension('_wavfile_core',
+                         sources=['_wavfile_coremodule.cxx'])
+
     config.add_data_dir('tests')
     config.add_subpackage('matlab')
     config.add_subpackage('arff')
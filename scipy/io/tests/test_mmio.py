@@ -698,3 +698,28 @@ class TestMMIOCoordinate(object):
                 assert_array_equal(A.col, [n-1])
                 assert_array_almost_equal(A.data,
                     [float('%%.%dg' % precision % value)])
+
+    def test_workers(self):
+        # large enough for the body to be split between threads
+        np.random.seed(1234)
+        b = scipy.sparse.random(30000, 30000, density=2e-4, format='coo')
+        b.data[::7] *= -1e-300
+        fn_1 = os.path.join(self.tmpdir, 'workers_1.mtx')
+        with scipy.sparse.set_workers(1):
+            mmwrite(fn_1, b, precision=17)
+            a_1 = mmread(fn_1)
+        with scipy.sparse.set_workers(4):
+            mmwrite(self.fn, b, precision=17)
+            a_4 = mmread(self.fn)
+        with open(fn_1, 'rb') as f_1, open(self.fn, 'rb') as f_4:
+            assert_equal(f_1.read(), f_4.read())
+        for a in (a_1, a_4):
+            assert_array_equal(a.row, b.row)
+            assert_array_equal(a.col, b.col)
+            assert_array_equal(a.data, b.data)
+
+        # comments, blank lines and a wrong number of entries
+        with open(self.fn, 'ab') as f:
+            f.write(b'%\n\n1 1 1.5\n')
+        with scipy.sparse.set_workers(4):
+            assert_raises(ValueError, mmread, self.fn)
@@ -2,6 +2,7 @@ from __future__ import division, print_function, absolute_import
 
 import os
 import sys
+import struct
 import tempfile
 from io import BytesIO
 
@@ -157,3 +158,91 @@ def test_write_roundtrip():
                             dt = np.dtype('%s%s%s' % (endianness, dtypechar, size))
                             _check_roundtrip(realfile, rate, dt, channels)
 
+
+
+def _make_24bit(samples, channels, big_endian):
+    # hand-made header, since there is no 24-bit dtype to write
+    if big_endian:
+        fmt, riff = '>', b'RIFX'
+        raw = b''.join(struct.pack('>i', int(x))[1:] for x in samples)
+    else:
+        fmt, riff = '<', b'RIFF'
+        raw = b''.join(struct.pack('<i', int(x))[:3] for x in samples)
+    fmt_chunk = struct.pack(fmt + 'HHIIHH', 1, channels, 8000,
+                            8000*3*channels, 3*channels, 24)
+    body = (b'WAVE' + b'fmt ' + struct.pack(fmt + 'I', len(fmt_chunk)) +
+            fmt_chunk + b'data' + struct.pack(fmt + 'I', len(raw)) + raw)
+    return BytesIO(riff + struct.pack(fmt + 'I', len(body)) + body)
+
+
+def test_read_24bit():
+    samples = np.array([0, 1, -1, 2**23 - 1, -2**23, 12345, -54321, 7])
+    for big_endian in (False, True):
+        for channels in (1, 2):
+            fp = _make_24bit(samples, channels, big_endian)
+            rate, data = wavfile.read(fp)
+            assert_equal(rate, 8000)
+            assert_equal(data.dtype, np.int32)
+            assert_array_equal(data.ravel(), samples * 256)
+            assert_equal(data.shape[-1], channels if channels > 1 else 8)
+
+            with wavfile.WavReader(fp) as reader:
+                assert_equal(reader.nframes, 8 // channels)
+                blocks = list(reader.blocks(3, dtype=np.float32))
+            data = np.concatenate(blocks)
+            assert_equal(data.dtype, np.float32)
+            assert_array_equal(data.ravel(), samples / 2.0**23)
+
+
+def test_reader_blocks():
+    data = (np.random.rand(1000, 3) * 20000).astype(np.int16)
+    fp = BytesIO()
+    wavfile.write(fp, 8000, data)
+
+    with wavfile.WavReader(fp) as reader:
+        assert_equal((reader.rate, reader.channels, reader.nframes),
+                     (8000, 3, 1000))
+        assert_equal(reader.dtype, np.dtype('<i2'))
+        head = reader.read(10)
+        blocks = list(reader.blocks(64))
+    assert_array_equal(head, data[:10])
+    assert_equal([len(b) for b in blocks], [64] * 15 + [30])
+    assert_array_equal(np.concatenate(blocks), data[10:])
+    assert_equal(fp.tell(), 0)
+
+    with wavfile.WavReader(fp) as reader:
+        res = reader.read(dtype=np.float32)
+    assert_array_equal(res, data / np.float32(32768))
+
+    reader = wavfile.WavReader(fp)
+    reader.close()
+    assert_raises(ValueError, reader.read)
+
+
+def test_writer_roundtrip():
+    for dtype in ('u1', '<i2', '>i4', '<f4', '>f8'):
+        for channels in (1, 2):
+            data = np.random.rand(1000, channels)
+            if channels == 1:
+                data = data[:, 0]
+            if dtype[-2] != 'f':
+                data = data * 100
+            data = data.astype(dtype)
+
+            expected = BytesIO()
+            wavfile.write(expected, 8000, data)
+
+            fp = BytesIO()
+            with wavfile.WavWriter(fp, 8000, dtype, channels) as writer:
+                for k in range(0, 1000, 300):
+                    writer.write(data[k:k + 300])
+            assert_equal(writer.nframes, 1000)
+            assert_equal(fp.getvalue(), expected.getvalue())
+
+    fp = BytesIO()
+    writer = wavfile.WavWriter(fp, 8000, np.int16, 2)
+    assert_raises(ValueError, writer.write, np.zeros(10, np.int16))
+    assert_raises(TypeError, writer.write, np.zeros((10, 2)))
+    writer.close()
+    rate, data = wavfile.read(fp)
+    assert_equal(data.shape, (0, 2))
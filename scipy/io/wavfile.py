@@ -7,6 +7,10 @@ Functions
 
 `write`: Write a numpy array as a WAV file.
 
+`WavReader`: Read the samples of a WAV file in blocks.
+
+`WavWriter`: Write a WAV file block by block.
+
 """
 from __future__ import division, print_function, absolute_import
 
@@ -15,9 +19,13 @@ import numpy
 import struct
 import warnings
 
+from . import _wavfile_core
+
 
 __all__ = [
     'WavFileWarning',
+    'WavReader',
+    'WavWriter',
     'read',
     'write'
 ]
@@ -101,6 +109,31 @@ def _read_fmt_chunk(fid, is_big_endian):
             bit_depth)
 
 
+def _sample_dtype(format_tag, bit_depth, is_big_endian):
+    """Dtype of the samples as stored, or None for 24-bit PCM"""
+    if bit_depth == 8:
+        return numpy.dtype('u1')
+    if bit_depth == 24:
+        return None
+    if is_big_endian:
+        dtype = '>'
+    else:
+        dtype = '<'
+    if format_tag == WAVE_FORMAT_PCM:
+        dtype += 'i%d' % (bit_depth//8)
+    else:
+        dtype += 'f%d' % (bit_depth//8)
+    return numpy.dtype(dtype)
+
+
+def _unpack24(buf, is_big_endian, dtype=numpy.int32):
+    """Widen packed 24-bit samples, see _wavfile_core.unpack24"""
+    n = len(buf) // 3
+    data = numpy.empty(n, dtype=dtype)
+    _wavfile_core.unpack24(memoryview(buf)[:3*n], data, is_big_endian)
+    return data
+
+
 # assumes file pointer is immediately after the 'data' id
 def _read_data_chunk(fid, format_tag, channels, bit_depth, is_big_endian,
                      mmap=False):
@@ -114,18 +147,12 @@ def _read_data_chunk(fid, format_tag, channels, bit_depth, is_big_endian,
 
     # Number of bytes per sample
     bytes_per_sample = bit_depth//8
-    if bit_depth == 8:
-        dtype = 'u1'
-    else:
-        if is_big_endian:
-            dtype = '>'
-        else:
-            dtype = '<'
-        if format_tag == WAVE_FORMAT_PCM:
-            dtype += 'i%d' % bytes_per_sample
-        else:
-            dtype += 'f%d' % bytes_per_sample
-    if not mmap:
+    dtype = _sample_dtype(format_tag, bit_depth, is_big_endian)
+    if dtype is None:
+        if mmap:
+            raise ValueError("mmap is not compatible with 24-bit data")
+        data = _unpack24(fid.read(size), is_big_endian)
+    elif not mmap:
         data = numpy.frombuffer(fid.read(size), dtype=dtype)
     else:
         start = fid.tell()
@@ -177,6 +204,58 @@ def _read_riff_chunk(fid):
     return file_size, is_big_endian
 
 
+def _read_chunks(fid, file_size, is_big_endian, fmt_chunk):
+    """
+    Read the chunks up to the next data chunk, leaving the file pointer
+    after its 'data' id.
+
+    Returns
+    -------
+    fmt_chunk : tuple or None
+        ``(format_tag, channels, fs, bit_depth)`` of the last format chunk
+        read so far, starting with `fmt_chunk`
+    found : bool
+        Whether a data chunk was reached before the end of the file
+    """
+    while fid.tell() < file_size:
+        # read the next chunk
+        chunk_id = fid.read(4)
+
+        if not chunk_id:
+            raise ValueError("Unexpected end of file.")
+        elif len(chunk_id) < 4:
+            raise ValueError("Incomplete wav chunk.")
+
+        if chunk_id == b'fmt ':
+            res = _read_fmt_chunk(fid, is_big_endian)
+            format_tag, channels, fs = res[1:4]
+            bit_depth = res[6]
+            if bit_depth not in (8, 16, 24, 32, 64, 96, 128):
+                raise ValueError("Unsupported bit depth: the wav file "
+                                 "has {}-bit data.".format(bit_depth))
+            if bit_depth == 24 and format_tag != WAVE_FORMAT_PCM:
+                raise ValueError("Unsupported bit depth: the wav file "
+                                 "has 24-bit floating-point data.")
+            fmt_chunk = (format_tag, channels, fs, bit_depth)
+        elif chunk_id == b'fact':
+            _skip_unknown_chunk(fid, is_big_endian)
+        elif chunk_id == b'data':
+            if fmt_chunk is None:
+                raise ValueError("No fmt chunk before data")
+            return fmt_chunk, True
+        elif chunk_id == b'LIST':
+            # Someday this could be handled properly but for now skip it
+            _skip_unknown_chunk(fid, is_big_endian)
+        elif chunk_id in (b'JUNK', b'Fake'):
+            # Skip alignment chunks without warning
+            _skip_unknown_chunk(fid, is_big_endian)
+        else:
+            warnings.warn("Chunk (non-data) not understood, skipping it.",
+                          WavFileWarning)
+            _skip_unknown_chunk(fid, is_big_endian)
+    return fmt_chunk, False
+
+
 def read(filename, mmap=False):
     """
     Open a WAV file
@@ -201,10 +280,12 @@ def read(filename, mmap=False):
         Data read from wav file.  Data-type is determined from the file;
         see Notes.
 
+    See Also
+    --------
+    WavReader : read the data in blocks
+
     Notes
     -----
-    This function cannot read wav files with 24-bit data.
-
     Common data types: [1]_
 
     =====================  ===========  ===========  =============
@@ -212,11 +293,17 @@ def read(filename, mmap=False):
     =====================  ===========  ===========  =============
     32-bit floating-point  -1.0         +1.0         float32
     32-bit PCM             -2147483648  +2147483647  int32
+    24-bit PCM             -2147483648  +2147483392  int32
     16-bit PCM             -32768       +32767       int16
     8-bit PCM              0            255          uint8
     =====================  ===========  ===========  =============
 
-    Note that 8-bit PCM is unsigned.
+    Note that 8-bit PCM is unsigned. 24-bit samples are returned in the
+    3 most significant bytes of int32, with the lowest byte zero, and
+    cannot be memory-mapped.
+
+    .. versionchanged:: 1.4.0
+       24-bit data can be read.
 
     References
     ----------
@@ -234,44 +321,18 @@ def read(filename, mmap=False):
 
     try:
         file_size, is_big_endian = _read_riff_chunk(fid)
-        fmt_chunk_received = False
-        channels = 1
-        bit_depth = 8
-        format_tag = WAVE_FORMAT_PCM
-        while fid.tell() < file_size:
-            # read the next chunk
-            chunk_id = fid.read(4)
-
-            if not chunk_id:
-                raise ValueError("Unexpected end of file.")
-            elif len(chunk_id) < 4:
-                raise ValueError("Incomplete wav chunk.")
-
-            if chunk_id == b'fmt ':
-                fmt_chunk_received = True
-                fmt_chunk = _read_fmt_chunk(fid, is_big_endian)
-                format_tag, channels, fs = fmt_chunk[1:4]
-                bit_depth = fmt_chunk[6]
-                if bit_depth not in (8, 16, 32, 64, 96, 128):
-                    raise ValueError("Unsupported bit depth: the wav file "
-                                     "has {}-bit data.".format(bit_depth))
-            elif chunk_id == b'fact':
-                _skip_unknown_chunk(fid, is_big_endian)
-            elif chunk_id == b'data':
-                if not fmt_chunk_received:
-                    raise ValueError("No fmt chunk before data")
-                data = _read_data_chunk(fid, format_tag, channels, bit_depth,
-                                        is_big_endian, mmap)
-            elif chunk_id == b'LIST':
-                # Someday this could be handled properly but for now skip it
-                _skip_unknown_chunk(fid, is_big_endian)
-            elif chunk_id in (b'JUNK', b'Fake'):
-                # Skip alignment chunks without warning
-                _skip_unknown_chunk(fid, is_big_endian)
-            else:
-                warnings.warn("Chunk (non-data) not understood, skipping it.",
-                              WavFileWarning)
-                _skip_unknown_chunk(fid, is_big_endian)
+        fmt_chunk = None
+        data = None
+        while True:
+            fmt_chunk, found = _read_chunks(fid, file_size, is_big_endian,
+                                            fmt_chunk)
+            if not found:
+                break
+            format_tag, channels, fs, bit_depth = fmt_chunk
+            data = _read_data_chunk(fid, format_tag, channels, bit_depth,
+                                    is_big_endian, mmap)
+        if data is None:
+            raise ValueError("No data chunk in wav file")
     finally:
         if not hasattr(filename, 'read'):
             fid.close()
@@ -327,57 +388,17 @@ def write(filename, rate, data):
     else:
         fid = open(filename, 'wb')
 
-    fs = rate
-
     try:
-        dkind = data.dtype.kind
-        if not (dkind == 'i' or dkind == 'f' or (dkind == 'u' and
-                                                 data.dtype.itemsize == 1)):
-            raise ValueError("Unsupported data type '%s'" % data.dtype)
-
-        header_data = b''
-
-        header_data += b'RIFF'
-        header_data += b'\x00\x00\x00\x00'
-        header_data += b'WAVE'
-
-        # fmt chunk
-        header_data += b'fmt '
-        if dkind == 'f':
-            format_tag = WAVE_FORMAT_IEEE_FLOAT
-        else:
-            format_tag = WAVE_FORMAT_PCM
-        if data.ndim == 1:
-            channels = 1
-        else:
-            channels = data.shape[1]
-        bit_depth = data.dtype.itemsize * 8
-        bytes_per_second = fs*(bit_depth // 8)*channels
-        block_align = channels * (bit_depth // 8)
-
-        fmt_chunk_data = struct.pack('<HHIIHH', format_tag, channels, fs,
-                                     bytes_per_second, block_align, bit_depth)
-        if not (dkind == 'i' or dkind == 'u'):
-            # add cbSize field for non-PCM files
-            fmt_chunk_data += b'\x00\x00'
-
-        header_data += struct.pack('<I', len(fmt_chunk_data))
-        header_data += fmt_chunk_data
-
-        # fact chunk (non-PCM files)
-        if not (dkind == 'i' or dkind == 'u'):
-            header_data += b'fact'
-            header_data += struct.pack('<II', 4, data.shape[0])
+        header_data = _make_header(rate, data.dtype, _channels(data),
+                                   data.shape[0])
 
         # check data size (needs to be immediately before the data chunk)
-        if ((len(header_data)-4-4) + (4+4+data.nbytes)) > 0xFFFFFFFF:
+        if (len(header_data)-4-4) + data.nbytes > 0xFFFFFFFF:
             raise ValueError("Data exceeds wave file size limit")
 
         fid.write(header_data)
 
         # data chunk
-        fid.write(b'data')
-        fid.write(struct.pack('<I', data.nbytes))
         if data.dtype.byteorder == '>' or (data.dtype.byteorder == '=' and
                                            sys.byteorder == 'big'):
             data = data.byteswap()
@@ -396,6 +417,349 @@ def write(filename, rate, data):
             fid.seek(0)
 
 
+def _channels(data):
+    if data.ndim == 1:
+        return 1
+    else:
+        return data.shape[1]
+
+
+def _make_header(fs, dtype, channels, nframes):
+    """
+    Header of a WAV file of `nframes` frames of `dtype` samples, up to and
+    including the size of the data chunk. The size of the RIFF chunk is
+    left zero.
+    """
+    dkind = dtype.kind
+    if not (dkind == 'i' or dkind == 'f' or (dkind == 'u' and
+                                             dtype.itemsize == 1)):
+        raise ValueError("Unsupported data type '%s'" % dtype)
+
+    header_data = b''
+
+    header_data += b'RIFF'
+    header_data += b'\x00\x00\x00\x00'
+    header_data += b'WAVE'
+
+    # fmt chunk
+    header_data += b'fmt '
+    if dkind == 'f':
+        format_tag = WAVE_FORMAT_IEEE_FLOAT
+    else:
+        format_tag = WAVE_FORMAT_PCM
+    bit_depth = dtype.itemsize * 8
+    bytes_per_second = fs*(bit_depth // 8)*channels
+    block_align = channels * (bit_depth // 8)
+
+    fmt_chunk_data = struct.pack('<HHIIHH', format_tag, channels, fs,
+                                 bytes_per_second, block_align, bit_depth)
+    if not (dkind == 'i' or dkind == 'u'):
+        # add cbSize field for non-PCM files
+        fmt_chunk_data += b'\x00\x00'
+
+    header_data += struct.pack('<I', len(fmt_chunk_data))
+    header_data += fmt_chunk_data
+
+    # fact chunk (non-PCM files)
+    if not (dkind == 'i' or dkind == 'u'):
+        header_data += b'fact'
+        header_data += struct.pack('<II', 4, nframes)
+
+    # data chunk
+    header_data += b'data'
+    header_data += struct.pack('<I', nframes * block_align)
+    return header_data
+
+
+class WavReader(object):
+    """
+    Read the samples of a WAV file in blocks.
+
+    The header is read when the reader is created; the data is read from
+    the file as it is requested, so that long recordings can be processed
+    in constant memory.
+
+    Parameters
+    ----------
+    filename : string or open file handle
+        Input wav file.
+
+    Attributes
+    ----------
+    rate : int
+        Sample rate of wav file.
+    channels : int
+        Number of channels.
+    dtype : dtype
+        Data-type of the samples, as returned by `read`.
+    nframes : int
+        Number of frames, that is samples of every channel, in the file.
+
+    See Also
+    --------
+    read : read the whole file
+    WavWriter : write a file block by block
+
+    Notes
+    -----
+    Only the first data chunk is read. Data is returned in the same format
+    as by `read`; with ``dtype=numpy.float32``, samples are converted to
+    floating point in [-1, 1) instead. 24-bit samples are then converted
+    straight from the file.
+
+    .. versionadded:: 1.4.0
+
+    Examples
+    --------
+    >>> from scipy.io import wavfile
+    >>> peak = 0
+    >>> with wavfile.WavReader('recording.wav') as reader:  # doctest: +SKIP
+    ...     for block in reader.blocks(4096, dtype=np.float32):
+    ...         peak = max(peak, abs(block).max())
+
+    """
+    def __init__(self, filename):
+        if hasattr(filename, 'read'):
+            self._fid = filename
+        else:
+            self._fid = open(filename, 'rb')
+        self._filename = filename
+
+        try:
+            file_size, self._is_big_endian = _read_riff_chunk(self._fid)
+            fmt_chunk, found = _read_chunks(self._fid, file_size,
+                                            self._is_big_endian, None)
+            if not found:
+                raise ValueError("No data chunk in wav file")
+            self._format_tag, self.channels, self.rate, bit_depth = fmt_chunk
+            if self._is_big_endian:
+                fmt = '>I'
+            else:
+                fmt = '<I'
+            size = struct.unpack(fmt, self._fid.read(4))[0]
+        except Exception:
+            self.close()
+            raise
+
+        self._bit_depth = bit_depth
+        self._block_align = self.channels * (bit_depth // 8)
+        self._sample_dtype = _sample_dtype(self._format_tag, bit_depth,
+                                           self._is_big_endian)
+        if self._sample_dtype is None:
+            self.dtype = numpy.dtype(numpy.int32)
+        else:
+            self.dtype = self._sample_dtype
+        self.nframes = size // self._block_align
+        self._left = self.nframes
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, type, value, traceback):
+        self.close()
+
+    def close(self):
+        """Closes the file, unless it was passed open"""
+        if self._fid is None:
+            return
+        if not hasattr(self._filename, 'read'):
+            self._fid.close()
+        else:
+            self._fid.seek(0)
+        self._fid = None
+
+    def read(self, nframes=None, dtype=None):
+        """
+        Read the next frames.
+
+        Parameters
+        ----------
+        nframes : int, optional
+            Number of frames to read. Default is all the frames left.
+        dtype : {None, numpy.float32}, optional
+            None returns the samples as `read` does, float32 scales them
+            to [-1, 1).
+
+        Returns
+        -------
+        data : ndarray
+            Array of shape ``(n,)`` for one channel or ``(n, channels)``,
+            where ``n`` is `nframes` or the number of frames left if that
+            is fewer.
+        """
+        if self._fid is None:
+            raise ValueError("I/O operation on closed file")
+        if dtype is not None and numpy.dtype(dtype) != numpy.float32:
+            raise ValueError("dtype must be None or float32")
+        if nframes is None or nframes > self._left:
+            nframes = self._left
+        elif nframes < 0:
+            raise ValueError("nframes must not be negative")
+
+        buf = self._fid.read(nframes * self._block_align)
+        nframes = len(buf) // self._block_align
+        buf = buf[:nframes * self._block_align]
+        self._left -= nframes
+
+        if self._sample_dtype is None:
+            data = _unpack24(buf, self._is_big_endian,
+                             dtype if dtype is not None else numpy.int32)
+        else:
+            data = numpy.frombuffer(buf, dtype=self._sample_dtype)
+            if dtype is not None:
+                data = _to_float32(data, self._format_tag)
+
+        if self.channels > 1:
+            data = data.reshape(-1, self.channels)
+        return data
+
+    def blocks(self, blocksize, dtype=None):
+        """
+        Iterate over the frames left in blocks of `blocksize` frames; the
+        last block may be shorter. See `read` for `dtype`.
+        """
+        if blocksize < 1:
+            raise ValueError("blocksize must be positive")
+        while self._left > 0:
+            data = self.read(blocksize, dtype)
+            if data.shape[0] == 0:
+                # truncated file
+                break
+            yield data
+
+
+def _to_float32(data, format_tag):
+    if format_tag != WAVE_FORMAT_PCM:
+        return data.astype(numpy.float32)
+    if data.dtype.kind == 'u':
+        return (data.astype(numpy.float32) - 128) / 128
+    bits = data.dtype.itemsize * 8
+    return data.astype(numpy.float32) * numpy.float32(2.0**(1 - bits))
+
+
+class WavWriter(object):
+    """
+    Write a WAV file block by block.
+
+    Only the header is held in memory; the sizes in it are filled in when
+    the writer is closed.
+
+    Parameters
+    ----------
+    filename : string or open file handle
+        Output wav file.
+    rate : int
+        The sample rate (in samples/sec).
+    dtype : dtype
+        Data-type of the samples; see `write` for the supported types.
+    channels : int, optional
+        Number of channels. Default is 1.
+
+    See Also
+    --------
+    write : write a whole array
+    WavReader : read a file in blocks
+
+    Notes
+    -----
+    .. versionadded:: 1.4.0
+
+    Examples
+    --------
+    >>> from scipy.io import wavfile
+    >>> with wavfile.WavWriter('tone.wav', 8000, np.int16) as writer:  # doctest: +SKIP
+    ...     for k in range(60):
+    ...         t = np.arange(k*8000, (k+1)*8000) / 8000
+    ...         writer.write((10000*np.sin(2*np.pi*440*t)).astype(np.int16))
+
+    """
+    def __init__(self, filename, rate, dtype, channels=1):
+        dtype = numpy.dtype(dtype)
+        if dtype.itemsize > 1:
+            dtype = dtype.newbyteorder('<')
+        if channels < 1:
+            raise ValueError("channels must be positive")
+        header_data = _make_header(rate, dtype, channels, 0)
+
+        if hasattr(filename, 'write'):
+            self._fid = filename
+        else:
+            self._fid = open(filename, 'wb')
+        self._filename = filename
+
+        self.rate = rate
+        self.dtype = dtype
+        self.channels = channels
+        self.nframes = 0
+        self._start = self._fid.tell()
+        self._header_size = len(header_data)
+        self._has_fact = dtype.kind == 'f'
+        try:
+            self._fid.write(header_data)
+        except Exception:
+            self.close()
+            raise
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, type, value, traceback):
+        self.close()
+
+    def write(self, data):
+        """
+        Append frames to the file.
+
+        Parameters
+        ----------
+        data : array_like
+            Array of shape ``(n,)`` for one channel or ``(n, channels)``,
+            cast to the data-type of the file if that is of the same kind.
+        """
+        if self._fid is None:
+            raise ValueError("I/O operation on closed file")
+        data = numpy.asarray(data)
+        if data.ndim == 1 and self.channels == 1:
+            data = data[:, None]
+        if data.ndim != 2 or data.shape[1] != self.channels:
+            raise ValueError("data must have shape (n, %d)" % self.channels)
+        data = data.astype(self.dtype, casting='same_kind', copy=False)
+
+        size = (self.nframes + data.shape[0]) * self.dtype.itemsize
+        size *= self.channels
+        if (self._header_size-4-4) + size > 0xFFFFFFFF:
+            raise ValueError("Data exceeds wave file size limit")
+
+        _array_tofile(self._fid, data)
+        self.nframes += data.shape[0]
+
+    def close(self):
+        """
+        Fill in the sizes of the header and close the file, unless it was
+        passed open.
+        """
+        if self._fid is None:
+            return
+        try:
+            data_size = self.nframes * self.dtype.itemsize * self.channels
+            end = self._fid.tell()
+            self._fid.seek(self._start + 4)
+            self._fid.write(struct.pack('<I', self._header_size-8 +
+                                        data_size))
+            if self._has_fact:
+                self._fid.seek(self._start + self._header_size - 12)
+                self._fid.write(struct.pack('<I', self.nframes))
+            self._fid.seek(self._start + self._header_size - 4)
+            self._fid.write(struct.pack('<I', data_size))
+            self._fid.seek(end)
+        finally:
+            if not hasattr(self._filename, 'write'):
+                self._fid.close()
+            else:
+                self._fid.seek(0)
+            self._fid = None
+
+
 if sys.version_info[0] >= 3:
     def _array_tofile(fid, data):
         # ravel gives a c-contiguous buffer
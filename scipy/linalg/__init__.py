@@ -31,6 +31,7 @@ Basics
    solve_circulant - Solve a circulant system
    solve_triangular - Solve a triangular matrix
    solve_toeplitz - Solve a toeplitz matrix
+   solve_toeplitz_batch - Solve a stack of toeplitz matrices
    det - Find the determinant of a square matrix
    norm - Matrix and vector norm
    lstsq - Solve a linear least-squares problem
@@ -87,6 +88,9 @@ Decompositions
    qr_update - Rank k QR update
    qr_delete - QR downdate on row or column deletion
    qr_insert - QR update on row or column insertion
+   qr_update_batch - Rank k QR update of a stack of decompositions
+   qr_delete_batch - QR downdate on row deletion of a stack of decompositions
+   qr_insert_batch - QR update on row insertion of a stack of decompositions
    rq - RQ decomposition of a matrix
    qz - QZ decomposition of a pair of matrices
    ordqz - QZ decomposition of a pair of matrices with reordering
@@ -0,0 +1,287 @@
+"""
+Randomized interpolative and singular value decompositions by sketching.
+
+These are NumPy counterparts of the randomized routines of the ID package
+(``iddp_aid``, ``iddr_rid``, ``iddp_rsvd`` and so on). The matrix is only
+touched through products with blocks of vectors: a random sketch -- a
+Gaussian matrix, a sparse sign matrix, or a subsampled randomized
+trigonometric transform (SRFT) -- compresses it to a few rows or columns,
+and the decompositions are computed from the sketch with LAPACK.
+
+Dense arrays are multiplied with BLAS-3, sparse matrices with the threaded
+products of `scipy.sparse`, and `LinearOperator` objects with their
+``matmat``, split into blocks of columns that run on separate threads. The
+SRFT uses the threaded transforms of `scipy.fft`.
+
+References
+----------
+.. [1] N. Halko, P.G. Martinsson, J.A. Tropp. "Finding structure with
+   randomness: probabilistic algorithms for constructing approximate matrix
+   decompositions." *SIAM Rev.* 53 (2): 217--288, 2011.
+.. [2] J.A. Tropp, A. Yurtsever, M. Udell, V. Cevher. "Streaming low-rank
+   matrix approximation with an application to scientific simulation."
+   *SIAM J. Sci. Comput.* 41 (4): A2430--A2463, 2019.
+"""
+from __future__ import division, print_function, absolute_import
+
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+
+from .basic import solve_triangular
+from .decomp_qr import qr
+from .decomp_svd import svd as _svd
+
+__all__ = ['SKETCHES', 'interp_decomp', 'svd', 'estimate_rank']
+
+SKETCHES = ('gaussian', 'sparse', 'srft')
+
+# Oversampling of the sketches beyond the rank, and the number of rows or
+# columns of the first sketch when the rank is not known in advance.
+_OVERSAMPLE = 10
+_FIRST_SKETCH = 32
+
+# Nonzeros in each column of the sparse sign sketches.
+_SPARSE_NNZ = 8
+
+# Columns of the blocks transformed at a time by the SRFT.
+_SRFT_BLOCK = 512
+
+
+class _Operand(object):
+    """
+    The products with a dense array, sparse matrix or LinearOperator `A`
+    that the sketches need. `workers` threads are used by the products
+    with sparse matrices and LinearOperators.
+    """
+
+    def __init__(self, A, workers):
+        from scipy.sparse import issparse
+        from scipy.sparse.linalg import LinearOperator
+
+        if isinstance(A, np.ndarray):
+            self.kind = 'dense'
+        elif issparse(A):
+            self.kind = 'sparse'
+            A = A.tocsr()
+        elif isinstance(A, LinearOperator):
+            self.kind = 'operator'
+        else:
+            raise TypeError("invalid input type (must be array, sparse "
+                            "matrix or LinearOperator)")
+        if len(A.shape) != 2:
+            raise ValueError("A must be 2-D")
+        self.A = A
+        self.shape = A.shape
+        self.dtype = np.dtype(A.dtype)
+        self.workers = workers
+        self._AH = None
+
+    @property
+    def AH(self):
+        # the adjoint, as a CSC matrix or LinearOperator
+        if self._AH is None:
+            self._AH = self.A.getH() if self.kind == 'sparse' else self.A.H
+        return self._AH
+
+    def matmat(self, X):
+        """Return ``A @ X`` for a dense or sparse `X`."""
+        return self._product(self.A, X, False)
+
+    def rmatmat(self, X):
+        """Return ``A**H @ X`` for a dense or sparse `X`."""
+        if self.kind == 'dense':
+            return self._product(self.A, X, True)
+        return self._product(self.AH, X, False)
+
+    def _product(self, A, X, adjoint):
+        from scipy.sparse import issparse, set_workers
+
+        if self.kind == 'dense':
+            # (X**H A)**H and (X**T A**T)**T only copy the small matrices
+            with set_workers(self.workers):
+                if adjoint:
+                    return np.asarray(X.conj().T.dot(A)).conj().T
+                if issparse(X):
+                    return np.asarray(X.T.dot(A.T)).T
+                return A.dot(X)
+        elif self.kind == 'sparse':
+            with set_workers(self.workers):
+                Y = A.dot(X)
+            return Y.toarray() if issparse(Y) else np.asarray(Y)
+
+        if issparse(X):
+            X = X.toarray()
+        nblocks = min(self.workers, X.shape[1])
+        if nblocks <= 1:
+            return np.asarray(A.matmat(X))
+        blocks = np.array_split(X, nblocks, axis=1)
+        with ThreadPoolExecutor(nblocks) as pool:
+            return np.hstack([np.asarray(Y).reshape(A.shape[0], -1)
+                              for Y in pool.map(A.matmat, blocks)])
+
+
+def _sketch_matrix(n, l, sketch, complex_, rng):
+    """
+    An (n, l) Gaussian or sparse sign matrix, such that ``A @ S`` has the
+    range of `A` when `l` exceeds its rank.
+    """
+    from scipy.sparse import csr_matrix
+
+    if sketch == 'gaussian':
+        S = rng.standard_normal((n, l))
+        if complex_:
+            S = (S + 1j*rng.standard_normal((n, l))) * np.sqrt(0.5)
+        return S
+
+    # A few +-1 entries per row, at random columns; the rare repeated
+    # columns add up.
+    nnz = min(_SPARSE_NNZ, l)
+    rows = np.repeat(np.arange(n), nnz)
+    cols = rng.randint(l, size=n*nnz)
+    vals = (2.0*rng.randint(2, size=n*nnz) - 1) / np.sqrt(nnz)
+    return csr_matrix((vals, (rows, cols)), shape=(n, l))
+
+
+def _srft(op, l, rng, axis):
+    """
+    Transform the rows (`axis` 0) or columns (`axis` 1) of the array of `op`
+    with random signs or phases and a DCT or FFT, and keep `l` of them at
+    random. The other axis is transformed in blocks, to bound the memory.
+    """
+    from scipy import fft
+
+    if op.kind != 'dense':
+        raise ValueError("sketch='srft' requires A to be an array")
+
+    B = op.A if axis == 0 else op.A.T
+    size, other = B.shape
+    keep = rng.choice(size, l, replace=False)
+    Y = np.empty((l, other), dtype=op.dtype)
+    if np.iscomplexobj(B):
+        d = np.exp(2j*np.pi*rng.rand(size))[:, np.newaxis]
+    else:
+        d = (2.0*rng.randint(2, size=size) - 1)[:, np.newaxis]
+
+    for start in range(0, other, _SRFT_BLOCK):
+        block = d * B[:, start:start + _SRFT_BLOCK]
+        if np.iscomplexobj(block):
+            block = fft.fft(block, axis=0, norm='ortho', overwrite_x=True,
+                            workers=op.workers)
+        else:
+            block = fft.dct(block, axis=0, norm='ortho', overwrite_x=True,
+                            workers=op.workers)
+        Y[:, start:start + _SRFT_BLOCK] = block[keep]
+    Y *= np.sqrt(size / l)
+    return Y if axis == 0 else Y.T
+
+
+def _row_sketch(op, l, sketch, rng):
+    """An (l, n) sketch ``S @ A`` of the rows of `A`."""
+    if sketch == 'srft':
+        return _srft(op, l, rng, 0)
+    S = _sketch_matrix(op.shape[0], l, sketch, op.dtype.kind == 'c', rng)
+    return op.rmatmat(S).conj().T
+
+
+def _column_sketch(op, l, sketch, rng):
+    """An (m, l) sketch ``A @ S`` of the columns of `A`."""
+    if sketch == 'srft':
+        return _srft(op, l, rng, 1)
+    S = _sketch_matrix(op.shape[1], l, sketch, op.dtype.kind == 'c', rng)
+    return op.matmat(S)
+
+
+def _pivoted_rank(R, eps):
+    """The rank at which the diagonal of a pivoted QR drops below `eps`."""
+    d = np.abs(np.diag(R))
+    if d.size == 0 or d[0] == 0:
+        return 0
+    return int(np.count_nonzero(d > eps * d[0]))
+
+
+def _sketch_sizes(eps_or_k, limit):
+    """
+    The sketch sizes to try: one of rank + oversampling for a rank, and
+    doubling ones up to `limit` for a relative precision.
+    """
+    if eps_or_k >= 1:
+        yield min(int(eps_or_k) + _OVERSAMPLE, limit)
+        return
+    l = min(_FIRST_SKETCH, limit)
+    while True:
+        yield l
+        if l == limit:
+            return
+        l = min(2*l, limit)
+
+
+def _check_sketch(op, eps_or_k, sketch):
+    if sketch not in SKETCHES:
+        raise ValueError("sketch must be one of %s, got %r"
+                         % (", ".join(SKETCHES), sketch))
+    if eps_or_k >= 1 and int(eps_or_k) > min(op.shape):
+        raise ValueError("Approximation rank %s exceeds min(A.shape) = "
+                         " %s " % (int(eps_or_k), min(op.shape)))
+
+
+def _column_id(op, eps_or_k, sketch, rng):
+    """The rank and pivoted R of the ID of a sketch of the rows of `A`."""
+    m, n = op.shape
+    _check_sketch(op, eps_or_k, sketch)
+    for l in _sketch_sizes(eps_or_k, m):
+        Y = _row_sketch(op, l, sketch, rng)
+        R, P = qr(Y, mode='r', pivoting=True)
+        if eps_or_k >= 1:
+            return int(eps_or_k), R, P
+        k = _pivoted_rank(R, eps_or_k)
+        # the rank is found once the sketch has rows to spare
+        if k + _OVERSAMPLE <= l:
+            break
+    return k, R, P
+
+
+def interp_decomp(A, eps_or_k, sketch, rng, workers=1):
+    """
+    Column ID of `A` from the pivoted QR of a sketch of its rows.
+
+    Returns the rank, the permutation of the columns (0-based) and the
+    interpolation coefficients, as `scipy.linalg.interpolative.interp_decomp`.
+    """
+    op = _Operand(A, workers)
+    k, R, P = _column_id(op, eps_or_k, sketch, rng)
+    if k == 0 or k == op.shape[1]:
+        proj = np.zeros((k, op.shape[1] - k), dtype=R.dtype)
+    else:
+        proj = solve_triangular(R[:k, :k], R[:k, k:], check_finite=False)
+    return k, P, np.asfortranarray(proj)
+
+
+def estimate_rank(A, eps, sketch, rng, workers=1):
+    """Rank of `A` to the relative precision `eps`, from a sketch."""
+    op = _Operand(A, workers)
+    return _column_id(op, eps, sketch, rng)[0]
+
+
+def svd(A, eps_or_k, sketch, rng, workers=1):
+    """
+    SVD of `A` by the randomized range finder: `A` is projected on an
+    orthonormal basis of a sketch of its columns, and the small projection is
+    decomposed with LAPACK.
+
+    Returns ``U, S, V`` with ``A ~= U @ diag(S) @ V**H``.
+    """
+    op = _Operand(A, workers)
+    _check_sketch(op, eps_or_k, sketch)
+    for l in _sketch_sizes(eps_or_k, min(op.shape)):
+        Q = qr(_column_sketch(op, l, sketch, rng), mode='economic')[0]
+        B = op.rmatmat(Q).conj().T
+        U, S, Vh = _svd(B, full_matrices=False, check_finite=False)
+        if eps_or_k >= 1:
+            k = int(eps_or_k)
+            break
+        k = int(np.count_nonzero(S > eps_or_k * S[0])) if S[0] > 0 else 0
+        if k + _OVERSAMPLE <= l:
+            break
+    U = Q.dot(U[:, :k])
+    return U, S[:k], Vh[:k].conj().T
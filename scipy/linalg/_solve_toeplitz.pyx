@@ -3,16 +3,118 @@
 # cython: boundscheck=False, wraparound=False, cdivision=True
 from __future__ import absolute_import
 
+from libc.stdlib cimport malloc, free
 from numpy import zeros, asarray, complex128, float64
 from numpy.linalg import LinAlgError
 from numpy cimport complex128_t, float64_t
 
+cdef extern from "zeros_threads.h":
+    ctypedef struct zeros_mutex:
+        pass
+    void zeros_mutex_init(zeros_mutex *m) nogil
+    void zeros_mutex_destroy(zeros_mutex *m) nogil
+    void zeros_mutex_lock(zeros_mutex *m) nogil
+    void zeros_mutex_unlock(zeros_mutex *m) nogil
+    void zeros_run_threads(int nthreads, void (*func)(void *) nogil,
+                           void *arg) nogil
+
 
 cdef fused dz:
     float64_t
     complex128_t
 
 
+cdef int levinson_core(const dz *a, const dz *b, dz *x, dz *g, dz *h,
+                       dz *reflection_coeff, ssize_t n, ssize_t k) nogil:
+    """
+    Solves the Toeplitz system of `levinson` for the k right hand sides in
+    the columns of b, shape (n, k) in C order, into x, sharing the
+    recursion among them. g and h are workspaces of n elements, and the
+    reflection coefficients of the first column are stored into
+    reflection_coeff unless it is NULL.
+
+    Returns 0, or -1 for a singular principal minor.
+    """
+    # Adapted from toeplitz.f90 by Alan Miller, accessed at
+    # http://jblevins.org/mirror/amiller/toeplitz.f90
+    # Released under a Public domain declaration.
+
+    cdef ssize_t m, j, nmj, i, m2, c
+    cdef dz x_den, g_num, h_num, g_den
+    cdef dz gj, gk, hj, hk, c1, c2
+
+    if a[n-1] == 0:
+        return -1
+
+    for c in range(k):
+        x[c] = b[c] / a[n-1]
+    if reflection_coeff != NULL:
+        reflection_coeff[0] = 1
+        reflection_coeff[1] = x[0]
+
+    if (n == 1):
+        return 0
+
+    g[0] = a[n-2] / a[n-1]
+    h[0] = a[n] / a[n-1]
+
+    for m in range(1, n):
+        # Compute numerators and denominator of x[m]
+        x_den = -a[n-1]
+        for j in range(m):
+            x_den = x_den + a[n + m - (j+1)] * g[m-j-1]
+        if x_den == 0:
+            return -1
+        for c in range(k):
+            x[m*k + c] = -b[m*k + c]
+        for j in range(m):
+            nmj = n + m - (j+1)
+            for c in range(k):
+                x[m*k + c] = x[m*k + c] + a[nmj] * x[j*k + c]
+        for c in range(k):
+            x[m*k + c] = x[m*k + c] / x_den
+        if reflection_coeff != NULL:
+            reflection_coeff[m+1] = x[m*k]
+
+        # Compute x
+        for j in range(m):
+            for c in range(k):
+                x[j*k + c] = x[j*k + c] - x[m*k + c] * g[m-j-1]
+        if m == n-1:
+            return 0
+
+        # Compute the numerator and denominator of g[m] and h[m]
+        g_num = -a[n-m-2]
+        h_num = -a[n+m]
+        g_den = -a[n-1]
+        for j in range(m):
+            g_num = g_num + a[n+j-m-1] * g[j]
+            h_num = h_num + a[n+m-j-1] * h[j]
+            g_den = g_den + a[n+j-m-1] * h[m-j-1]
+
+        if g_den == 0.0:
+            return -1
+
+        # Compute g and h
+        g[m] = g_num / g_den
+        h[m] = h_num / x_den
+        i = m - 1
+        m2 = (m + 1) >> 1
+        c1 = g[m]
+        c2 = h[m]
+        for j in range(m2):
+            gj = g[j]
+            gk = g[i]
+            hj = h[j]
+            hk = h[i]
+            g[j] = gj - (c1 * hk)
+            g[i] = gk - (c1 * hj)
+            h[j] = hj - (c2 * gk)
+            h[i] = hk - (c2 * gj)
+            i -= 1
+    return 0
+
+
 def levinson(dz[::1] a, dz[::1] b):
     """Solve a linear Toeplitz system using Levinson recursion.
 
@@ -46,83 +148,186 @@ def levinson(dz[::1] a, dz[::1] b):
         then ``reflection_coeff`` also correspond to the partial
         autocorrelation function.
     """
-    # Adapted from toeplitz.f90 by Alan Miller, accessed at
-    # http://jblevins.org/mirror/amiller/toeplitz.f90
-    # Released under a Public domain declaration.
+    if dz is float64_t:
+        dtype = float64
+    else:
+        dtype = complex128
+
+    cdef ssize_t n = b.shape[0]
+    cdef int ret
+    cdef dz[::1] x = zeros(n, dtype=dtype)  # result
+    cdef dz[::1] g = zeros(n, dtype=dtype)  # workspace
+    cdef dz[::1] h = zeros(n, dtype=dtype)  # workspace
+    cdef dz[::1] reflection_coeff = zeros(n+1, dtype=dtype)  # history
+    assert len(a) == (2*n) - 1
+
+    with nogil:
+        ret = levinson_core(&a[0], &b[0], &x[0], &g[0], &h[0],
+                            &reflection_coeff[0], n, 1)
+    if ret < 0:
+        raise LinAlgError('Singular principal minor')
+    return asarray(x), asarray(reflection_coeff)
+
 
+def levinson_multi(dz[::1] a, dz[:, ::1] b):
+    """Solve a linear Toeplitz system for several right hand sides.
+
+    Parameters
+    ----------
+    a : array, dtype=double or complex128, shape=(2n-1,)
+        The matrix, as in `levinson`.
+    b : array, dtype=double or complex128, shape=(n, k)
+        The right hand sides, in the columns.
+
+    Returns
+    -------
+    x : array, shape=(n, k)
+        The solutions. The Levinson recursion is computed once for all the
+        columns.
+    """
     if dz is float64_t:
         dtype = float64
     else:
         dtype = complex128
 
-    cdef ssize_t n, m, j, nmj, k, m2
-    n = b.shape[0]
-    cdef dz x_num, g_num, h_num, x_den, g_den
-    cdef dz gj, gk, hj, hk, c1, c2
-    cdef dz[:] x = zeros(n, dtype=dtype)  # result
-    cdef dz[:] g = zeros(n, dtype=dtype)  # workspace
-    cdef dz[:] h = zeros(n, dtype=dtype)  # workspace
-    cdef dz[:] reflection_coeff = zeros(n+1, dtype=dtype)  # history
+    cdef ssize_t n = b.shape[0], k = b.shape[1]
+    cdef int ret
+    cdef dz[:, ::1] x = zeros((n, k), dtype=dtype)
+    cdef dz[::1] g = zeros(n, dtype=dtype)
+    cdef dz[::1] h = zeros(n, dtype=dtype)
     assert len(a) == (2*n) - 1
 
-    if a[n-1] == 0:
+    if k == 0:
+        return asarray(x)
+    with nogil:
+        ret = levinson_core(&a[0], &b[0, 0], &x[0, 0], &g[0], &h[0], NULL,
+                            n, k)
+    if ret < 0:
         raise LinAlgError('Singular principal minor')
+    return asarray(x)
 
-    x[0] = b[0] / a[n-1]
-    reflection_coeff[0] = 1
-    reflection_coeff[1] = x[0]
 
-    if (n == 1):
-        return asarray(x), asarray(reflection_coeff)
+ctypedef struct levinson_work:
+    # One of the pairs of arrays is set, as per the dtype
+    const float64_t *a_d
+    const float64_t *b_d
+    float64_t *x_d
+    const complex128_t *a_z
+    const complex128_t *b_z
+    complex128_t *x_z
+    ssize_t nsys
+    ssize_t n
+    ssize_t k
+    int *status
+    ssize_t next
+    zeros_mutex lock
+    bint nomem
 
-    g[0] = a[n-2] / a[n-1]
-    h[0] = a[n] / a[n-1]
 
-    for m in range(1, n):
-        # Compute numerator and denominator of x[m]
-        x_num = -b[m]
-        x_den = -a[n-1]
-        for j in range(m):
-            nmj = n + m - (j+1)
-            x_num = x_num + a[nmj] * x[j]
-            x_den = x_den + a[nmj] * g[m-j-1]
-        if x_den == 0:
-            raise LinAlgError('Singular principal minor')
-        x[m] = x_num / x_den
-        reflection_coeff[m+1] = x[m]
+cdef ssize_t claim_system(levinson_work *w) nogil:
+    cdef ssize_t i
+    zeros_mutex_lock(&w.lock)
+    i = w.next
+    if i < w.nsys:
+        w.next += 1
+    else:
+        i = -1
+    zeros_mutex_unlock(&w.lock)
+    return i
 
-        # Compute x
-        for j in range(m):
-            x[j] = x[j] - x[m] * g[m-j-1]
-        if m == n-1:
-            return asarray(x), asarray(reflection_coeff)
 
-        # Compute the numerator and denominator of g[m] and h[m]
-        g_num = -a[n-m-2]
-        h_num = -a[n+m]
-        g_den = -a[n-1]
-        for j in range(m):
-            g_num = g_num + a[n+j-m-1] * g[j]
-            h_num = h_num + a[n+m-j-1] * h[j]
-            g_den = g_den + a[n+j-m-1] * h[m-j-1]
+cdef void levinson_thread(void *arg) nogil:
+    """
+    Solves the systems it claims, with workspaces of its own.
+    """
+    cdef levinson_work *w = <levinson_work *>arg
+    cdef ssize_t i, n = w.n, k = w.k
+    cdef float64_t *work_d = NULL
+    cdef complex128_t *work_z = NULL
 
-        if g_den == 0.0:
-            raise LinAlgError("Singular principal minor")
+    if w.a_d != NULL:
+        work_d = <float64_t *>malloc(2 * n * sizeof(float64_t))
+    else:
+        work_z = <complex128_t *>malloc(2 * n * sizeof(complex128_t))
+    if work_d == NULL and work_z == NULL:
+        zeros_mutex_lock(&w.lock)
+        w.nomem = True
+        zeros_mutex_unlock(&w.lock)
+        return
 
-        # Compute g and h
-        g[m] = g_num / g_den
-        h[m] = h_num / x_den
-        k = m - 1
-        m2 = (m + 1) >> 1
-        c1 = g[m]
-        c2 = h[m]
-        for j in range(m2):
-            gj = g[j]
-            gk = g[k]
-            hj = h[j]
-            hk = h[k]
-            g[j] = gj - (c1 * hk)
-            g[k] = gk - (c1 * hj)
-            h[j] = hj - (c2 * gk)
-            h[k] = hk - (c2 * gj)
-            k -= 1
+    i = claim_system(w)
+    while i >= 0:
+        if work_d != NULL:
+            w.status[i] = levinson_core[float64_t](
+                w.a_d + i*(2*n - 1), w.b_d + i*n*k, w.x_d + i*n*k, work_d,
+                work_d + n, NULL, n, k)
+        else:
+            w.status[i] = levinson_core[complex128_t](
+                w.a_z + i*(2*n - 1), w.b_z + i*n*k, w.x_z + i*n*k, work_z,
+                work_z + n, NULL, n, k)
+        i = claim_system(w)
+    free(work_d)
+    free(work_z)
+
+
+def levinson_batch(dz[:, ::1] a, dz[:, :, ::1] b, int nthreads=1):
+    """Solve a stack of independent linear Toeplitz systems.
+
+    Parameters
+    ----------
+    a : array, dtype=double or complex128, shape=(m, 2n-1)
+        The matrices, each as in `levinson`.
+    b : array, dtype=double or complex128, shape=(m, n, k)
+        The right hand sides of each system, in the columns.
+    nthreads : int, optional
+        Number of threads solving the systems.
+
+    Returns
+    -------
+    x : array, shape=(m, n, k)
+        The solutions.
+    """
+    if dz is float64_t:
+        dtype = float64
+    else:
+        dtype = complex128
+
+    cdef levinson_work w
+    cdef ssize_t i
+    cdef dz[:, :, ::1] x = zeros((b.shape[0], b.shape[1], b.shape[2]),
+                                 dtype=dtype)
+    cdef int[::1] status = zeros(b.shape[0], dtype='intc')
+
+    if a.shape[0] != b.shape[0] or a.shape[1] != 2*b.shape[1] - 1:
+        raise ValueError('a and b have incompatible shapes')
+    if b.shape[0] == 0 or b.shape[2] == 0:
+        return asarray(x)
+
+    w.a_d = w.b_d = w.x_d = NULL
+    w.a_z = w.b_z = w.x_z = NULL
+    if dz is float64_t:
+        w.a_d = &a[0, 0]
+        w.b_d = &b[0, 0, 0]
+        w.x_d = &x[0, 0, 0]
+    else:
+        w.a_z = &a[0, 0]
+        w.b_z = &b[0, 0, 0]
+        w.x_z = &x[0, 0, 0]
+    w.nsys = b.shape[0]
+    w.n = b.shape[1]
+    w.k = b.shape[2]
+    w.status = &status[0]
+    w.next = 0
+    w.nomem = False
+
+    nthreads = max(1, min(nthreads, w.nsys))
+    zeros_mutex_init(&w.lock)
+    with nogil:
+        zeros_run_threads(nthreads, levinson_thread, &w)
+    zeros_mutex_destroy(&w.lock)
+    if w.nomem:
+        raise MemoryError()
+    for i in range(w.nsys):
+        if status[i] < 0:
+            raise LinAlgError('Singular principal minor in system %d' % i)
+    return asarray(x)
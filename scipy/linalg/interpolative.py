@@ -372,6 +372,25 @@ To simply generate some random numbers, type:
 
 where ``n`` is the number of random numbers to generate.
 
+Sketching engine
+----------------
+
+The routines :func:`interp_decomp`, :func:`svd` and :func:`estimate_rank`
+can also run on a NumPy engine, selected with the keyword ``sketch``:
+
+>>> k, idx, proj = sli.interp_decomp(A, eps, sketch='gaussian', workers=4)
+>>> U, S, V = sli.svd(L, k, sketch='sparse', workers=4)
+
+It compresses the matrix with a random sketch -- a Gaussian matrix, a
+sparse sign matrix (``'sparse'``) or a subsampled randomized trigonometric
+transform (``'srft'``, for arrays only) -- computed with matrix-matrix
+products, and decomposes the sketch with LAPACK. Besides arrays and
+LinearOperators, it accepts sparse matrices. The keyword ``workers`` sets
+the number of threads of the transforms, of the products with sparse
+matrices, and of the products with a LinearOperator, whose ``matmat`` is
+called on blocks of vectors. It is the method of choice for large matrices,
+in particular ones only available as a LinearOperator.
+
 Remarks
 -------
 
@@ -382,11 +401,16 @@ backend routine.
 """
 
 import scipy.linalg._interpolative_backend as backend
+import scipy.linalg._interpolative_sketch as sketch_backend
+from scipy.linalg.basic import _check_workers
 import numpy as np
 
 _DTYPE_ERROR = ValueError("invalid input dtype (input must be float64 or complex128)")
 _TYPE_ERROR = TypeError("invalid input type (must be array or LinearOperator)")
 
+# random numbers of the sketches, see `seed`
+_sketch_rng = np.random.RandomState()
+
 
 def _is_real(A):
     try:
@@ -422,24 +446,29 @@ def seed(seed=None):
         If `seed` is omitted (None), `numpy.random.rand` is used to
         initialize the generator.
 
+    The random sketches (see the `sketch` keyword of `interp_decomp`) are
+    seeded from the same state.
+
     """
     # For details, see :func:`backend.id_srand`, :func:`backend.id_srandi`,
     # and :func:`backend.id_srando`.
 
     if isinstance(seed, str) and seed == 'default':
         backend.id_srando()
+        _sketch_rng.seed(0)
+        return
     elif hasattr(seed, '__len__'):
         state = np.asfortranarray(seed, dtype=float)
         if state.shape != (55,):
             raise ValueError("invalid input size")
         elif state.min() < 0 or state.max() > 1:
             raise ValueError("values not in range [0,1]")
-        backend.id_srandi(state)
     elif seed is None:
-        backend.id_srandi(np.random.rand(55))
+        state = np.random.rand(55)
     else:
-        rnd = np.random.RandomState(seed)
-        backend.id_srandi(rnd.rand(55))
+        state = np.random.RandomState(seed).rand(55)
+    backend.id_srandi(state)
+    _sketch_rng.seed((state * (2.0**32 - 1)).astype(np.uint32))
 
 
 def rand(*shape):
@@ -460,7 +489,7 @@ def rand(*shape):
     return backend.id_srand(np.prod(shape)).reshape(shape)
 
 
-def interp_decomp(A, eps_or_k, rand=True):
+def interp_decomp(A, eps_or_k, rand=True, sketch=None, workers=None):
     """
     Compute ID of a matrix.
 
@@ -524,6 +553,24 @@ def interp_decomp(A, eps_or_k, rand=True):
         Whether to use random sampling if `A` is of type :class:`numpy.ndarray`
         (randomized algorithms are always used if `A` is of type
         :class:`scipy.sparse.linalg.LinearOperator`).
+    sketch : {None, 'gaussian', 'sparse', 'srft'}, optional
+        Random sketch of the NumPy engine, which is used instead of the ID
+        package if given (and implies `rand`): a Gaussian matrix (products
+        with BLAS-3), a sparse sign matrix (cheaper products, best for large
+        or sparse `A`), or a subsampled randomized trigonometric transform
+        (`A` must be an array). The engine also accepts sparse matrices and
+        :class:`scipy.sparse.linalg.LinearOperator` objects with `matmat`.
+        See Notes.
+
+        .. versionadded:: 1.4.0
+    workers : int, optional
+        Number of threads of the engine, for the transforms of the
+        ``'srft'`` sketch, products with sparse matrices, and the blocks of
+        the products with LinearOperators. If negative, the value wraps
+        around from ``os.cpu_count()``. Products with arrays use the threads
+        of BLAS. Default is 1.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -534,11 +581,30 @@ def interp_decomp(A, eps_or_k, rand=True):
         Column index array.
     proj : :class:`numpy.ndarray`
         Interpolation coefficients.
+
+    Notes
+    -----
+    With `sketch`, `A` is only touched through products with blocks of
+    random vectors: the ID is computed from the pivoted QR of a sketch
+    ``S @ A`` of ``k + 10`` rows. For a relative precision, the sketch size
+    starts at 32 rows and is doubled until the rank found leaves 10 rows to
+    spare.
     """
-    from scipy.sparse.linalg import LinearOperator
+    from scipy.sparse import issparse
+    from scipy.sparse.linalg import LinearOperator, aslinearoperator
 
     real = _is_real(A)
 
+    if sketch is not None:
+        k, idx, proj = sketch_backend.interp_decomp(
+            A, eps_or_k, sketch, _sketch_rng, _check_workers(workers))
+        if eps_or_k < 1:
+            return k, idx, proj
+        return idx, proj
+
+    if issparse(A):
+        A = aslinearoperator(A)
+
     if isinstance(A, np.ndarray):
         if eps_or_k < 1:
             eps = eps_or_k
@@ -816,7 +882,7 @@ def estimate_spectral_norm_diff(A, B, its=20):
             m, n, matveca1, matveca2, matvec1, matvec2, its=its)
 
 
-def svd(A, eps_or_k, rand=True):
+def svd(A, eps_or_k, rand=True, sketch=None, workers=None):
     """
     Compute SVD of a matrix via an ID.
 
@@ -853,6 +919,23 @@ def svd(A, eps_or_k, rand=True):
         Whether to use random sampling if `A` is of type :class:`numpy.ndarray`
         (randomized algorithms are always used if `A` is of type
         :class:`scipy.sparse.linalg.LinearOperator`).
+    sketch : {None, 'gaussian', 'sparse', 'srft'}, optional
+        Random sketch of the NumPy engine, which is used instead of the ID
+        package if given (and implies `rand`): a Gaussian matrix (products
+        with BLAS-3), a sparse sign matrix (cheaper products, best for large
+        or sparse `A`), or a subsampled randomized trigonometric transform
+        (`A` must be an array). The engine also accepts sparse matrices and
+        :class:`scipy.sparse.linalg.LinearOperator` objects with `matmat`.
+
+        .. versionadded:: 1.4.0
+    workers : int, optional
+        Number of threads of the engine, for the transforms of the
+        ``'srft'`` sketch, products with sparse matrices, and the blocks of
+        the products with LinearOperators. If negative, the value wraps
+        around from ``os.cpu_count()``. Products with arrays use the threads
+        of BLAS. Default is 1.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -862,11 +945,25 @@ def svd(A, eps_or_k, rand=True):
         Singular values.
     V : :class:`numpy.ndarray`
         Right singular vectors.
+
+    Notes
+    -----
+    With `sketch`, the SVD is that of the projection of `A` on an orthonormal
+    basis of a sketch ``A @ S`` of its columns, of ``k + 10`` columns or,
+    for a relative precision, of doubling sizes from 32 columns.
     """
-    from scipy.sparse.linalg import LinearOperator
+    from scipy.sparse import issparse
+    from scipy.sparse.linalg import LinearOperator, aslinearoperator
 
     real = _is_real(A)
 
+    if sketch is not None:
+        return sketch_backend.svd(A, eps_or_k, sketch, _sketch_rng,
+                                  _check_workers(workers))
+
+    if issparse(A):
+        A = aslinearoperator(A)
+
     if isinstance(A, np.ndarray):
         if eps_or_k < 1:
             eps = eps_or_k
@@ -916,7 +1013,7 @@ def svd(A, eps_or_k, rand=True):
     return U, S, V
 
 
-def estimate_rank(A, eps):
+def estimate_rank(A, eps, sketch=None, workers=None):
     """
     Estimate matrix rank to a specified relative precision using randomized
     methods.
@@ -939,16 +1036,38 @@ def estimate_rank(A, eps):
         with the `rmatvec` method (to apply the matrix adjoint).
     eps : float
         Relative error for numerical rank definition.
+    sketch : {None, 'gaussian', 'sparse', 'srft'}, optional
+        Random sketch of the NumPy engine, which is used instead of the ID
+        package if given, as in :func:`interp_decomp`. The rank is that of
+        the ID of the sketch.
+
+        .. versionadded:: 1.4.0
+    workers : int, optional
+        Number of threads of the engine, for the transforms of the
+        ``'srft'`` sketch, products with sparse matrices, and the blocks of
+        the products with LinearOperators. If negative, the value wraps
+        around from ``os.cpu_count()``. Products with arrays use the threads
+        of BLAS. Default is 1.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
     int
         Estimated matrix rank.
     """
-    from scipy.sparse.linalg import LinearOperator
+    from scipy.sparse import issparse
+    from scipy.sparse.linalg import LinearOperator, aslinearoperator
 
     real = _is_real(A)
 
+    if sketch is not None:
+        return sketch_backend.estimate_rank(A, eps, sketch, _sketch_rng,
+                                            _check_workers(workers))
+
+    if issparse(A):
+        A = aslinearoperator(A)
+
     if isinstance(A, np.ndarray):
         if real:
             rank = backend.idd_estrank(eps, A)
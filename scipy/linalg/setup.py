@@ -123,9 +123,11 @@ def configuration(parent_package='', top_path=None):
                          )
 
     # _solve_toeplitz:
+    zeros_dir = join('..', 'optimize', 'Zeros')
     config.add_extension('_solve_toeplitz',
                          sources=[('_solve_toeplitz.c')],
-                         include_dirs=[get_numpy_include_dirs()])
+                         include_dirs=[get_numpy_include_dirs(), zeros_dir],
+                         depends=[join(zeros_dir, 'zeros_threads.h')])
 
     config.add_data_dir('tests')
 
@@ -155,7 +157,9 @@ def configuration(parent_package='', top_path=None):
                          extra_info=lapack_opt)
 
     config.add_extension('_decomp_update',
-                         sources=['_decomp_update.c'])
+                         sources=['_decomp_update.c'],
+                         include_dirs=[zeros_dir],
+                         depends=[join(zeros_dir, 'zeros_threads.h')])
 
     # Add any license files
     config.add_data_files('src/id_dist/doc/doc.tex')
@@ -1693,4 +1693,144 @@ def check_form_qTu(q_order, q_shape, u_order, u_shape, u_ndim, dtype):
     res = _decomp_update._form_qTu(q, u)
     assert_allclose(res, expected, rtol=rtol, atol=atol)
 
- 
+
+class BaseQRbatch(BaseQRdeltas):
+    def generate_batch(self, nmat, shape, mode='full'):
+        np.random.seed(29382)
+        a = np.random.random((nmat,) + shape)
+        if np.iscomplexobj(self.dtype.type(1)):
+            a = a + 1j * np.random.random((nmat,) + shape)
+        a = a.astype(self.dtype)
+        qr = [linalg.qr(x, mode=mode) for x in a]
+        q = np.array([x[0] for x in qr])
+        r = np.array([x[1] for x in qr])
+        return a, q, r
+
+    def random(self, shape):
+        x = np.random.random(shape)
+        if np.iscomplexobj(self.dtype.type(1)):
+            x = x + 1j * np.random.random(shape)
+        return x.astype(self.dtype)
+
+    def check_update(self, shape, mode, p, workers):
+        a, q, r = self.generate_batch(6, shape, mode)
+        m, n = shape
+        if p == 1:
+            u = self.random((6, m))
+            v = self.random((6, n))
+        else:
+            u = self.random((6, m, p))
+            v = self.random((6, n, p))
+        q1, r1 = qr_update_batch(q, r, u, v, workers=workers)
+        assert_equal(q1.shape, q.shape)
+        assert_equal(r1.shape, r.shape)
+        for i in range(6):
+            q2, r2 = qr_update(q[i], r[i], u[i], v[i])
+            assert_allclose(q1[i], q2, rtol=self.rtol, atol=self.atol)
+            assert_allclose(r1[i], r2, rtol=self.rtol, atol=self.atol)
+            if p == 1:
+                a1 = a[i] + np.outer(u[i], v[i].conj())
+            else:
+                a1 = a[i] + np.dot(u[i], v[i].T.conj())
+            check_qr(q1[i], r1[i], a1, self.rtol, self.atol, mode == 'full')
+
+    def test_update(self):
+        for shape, mode, p, workers in itertools.product(
+                [(8, 8), (12, 7), (7, 12)], ['full'], [1, 3], [1, 4]):
+            self.check_update(shape, mode, p, workers)
+
+    def test_update_economic(self):
+        for p, workers in itertools.product([1, 3], [1, 4]):
+            self.check_update((12, 7), 'economic', p, workers)
+
+    def test_update_1xN(self):
+        self.check_update((1, 8), 'full', 1, 2)
+
+    def test_insert(self):
+        for shape, mode, p in itertools.product(
+                [(8, 8), (12, 7), (7, 12)], ['full', 'economic'], [1, 3]):
+            if mode == 'economic' and shape[0] <= shape[1]:
+                continue
+            a, q, r = self.generate_batch(6, shape, mode)
+            u = self.random((6, shape[1]) if p == 1 else (6, p, shape[1]))
+            for k in [0, 3, shape[0], -1]:
+                q1, r1 = qr_insert_batch(q, r, u, k, workers=3)
+                for i in range(6):
+                    q2, r2 = qr_insert(q[i], r[i], u[i], k)
+                    assert_allclose(q1[i], q2, rtol=self.rtol, atol=self.atol)
+                    assert_allclose(r1[i], r2, rtol=self.rtol, atol=self.atol)
+
+    def test_delete(self):
+        for shape, mode, p in itertools.product(
+                [(8, 8), (12, 7), (7, 12), (8, 1)], ['full', 'economic'],
+                [1, 3]):
+            if mode == 'economic' and shape[0] <= shape[1]:
+                continue
+            a, q, r = self.generate_batch(6, shape, mode)
+            for k in [0, 2, -p]:
+                q1, r1 = qr_delete_batch(q, r, k, p, workers=3)
+                for i in range(6):
+                    q2, r2 = qr_delete(q[i], r[i], k, p)
+                    assert_allclose(q1[i], q2, rtol=self.rtol, atol=self.atol)
+                    assert_allclose(r1[i], r2, rtol=self.rtol, atol=self.atol)
+
+    def test_batch_shape(self):
+        a, q, r = self.generate_batch(6, (8, 5))
+        u = self.random((6, 8))
+        v = self.random((6, 5))
+        q1, r1 = qr_update_batch(q, r, u, v)
+        q2, r2 = qr_update_batch(q.reshape(2, 3, 8, 8), r.reshape(2, 3, 8, 5),
+                                 u.reshape(2, 3, 8), v.reshape(2, 3, 5))
+        assert_equal(q2.shape, (2, 3, 8, 8))
+        assert_allclose(q2.reshape(q1.shape), q1)
+        assert_allclose(r2.reshape(r1.shape), r1)
+
+        q1, r1 = qr_update_batch(q[:0], r[:0], u[:0], v[:0])
+        assert_equal(q1.shape, (0, 8, 8))
+        assert_equal(r1.shape, (0, 8, 5))
+
+    def test_overwrite(self):
+        a, q, r = self.generate_batch(4, (8, 5))
+        u = self.random((4, 8))
+        v = self.random((4, 5))
+        q0 = np.ascontiguousarray(q.swapaxes(1, 2)).swapaxes(1, 2)
+        r0 = np.ascontiguousarray(r.swapaxes(1, 2)).swapaxes(1, 2)
+        qc, rc = q0.copy(), r0.copy()
+        q1, r1 = qr_update_batch(q0, r0, u, v)
+        assert_equal(q0, qc)
+        assert_equal(r0, rc)
+        q2, r2 = qr_update_batch(q0, r0, u.copy(), v.copy(),
+                                 overwrite_qruv=True)
+        assert_allclose(q0, q1)
+        assert_allclose(r0, r1)
+        assert_allclose(q2, q1)
+
+    def test_errors(self):
+        a, q, r = self.generate_batch(4, (8, 5))
+        u = self.random((4, 8))
+        v = self.random((4, 5))
+        assert_raises(ValueError, qr_update_batch, q[0], r[0], u[0], v[0])
+        assert_raises(ValueError, qr_update_batch, q[:3], r, u, v)
+        assert_raises(ValueError, qr_update_batch, q, r, u[:3], v)
+        assert_raises(ValueError, qr_update_batch, q, r, u[:, 1:], v)
+        assert_raises(ValueError, qr_update_batch, q, r, u, v[:, :, None])
+        assert_raises(ValueError, qr_update_batch, q, r, u, v, workers=0)
+        assert_raises(ValueError, qr_update_batch, q.astype(int), r, u, v)
+        u[1, 2] = np.nan
+        assert_raises(ValueError, qr_update_batch, q, r, u, v)
+        assert_raises(ValueError, qr_insert_batch, q, r, v, 9)
+        assert_raises(ValueError, qr_insert_batch, q, r, u, 0)
+        assert_raises(ValueError, qr_delete_batch, q, r, 8)
+        assert_raises(ValueError, qr_delete_batch, q, r, 6, 3)
+
+class TestQRbatch_f(BaseQRbatch):
+    dtype = np.dtype('f')
+
+class TestQRbatch_F(BaseQRbatch):
+    dtype = np.dtype('F')
+
+class TestQRbatch_d(BaseQRbatch):
+    dtype = np.dtype('d')
+
+class TestQRbatch_D(BaseQRbatch):
+    dtype = np.dtype('D')
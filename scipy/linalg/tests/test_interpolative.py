@@ -293,3 +293,91 @@ class TestInterpolativeDecomposition(object):
             B = A.copy()
             interp_decomp(A.T, eps, rand=rand)
             assert_(np.array_equal(A, B))
+
+
+class TestSketch(object):
+    def lowrank(self, dtype, m=120, n=100, k=12, density=1):
+        rng = np.random.RandomState(1234)
+        X = rng.randn(m, k) * (rng.rand(m, k) < density)
+        Y = rng.randn(k, n) * (rng.rand(k, n) < density)
+        if dtype == np.complex128:
+            X = X + 1j * rng.randn(m, k)
+            Y = Y + 1j * rng.randn(k, n)
+        return X.dot(Y).astype(dtype)
+
+    def test_id(self):
+        for dtype, sketch in itertools.product(
+                [np.float64, np.complex128], ['gaussian', 'sparse', 'srft']):
+            A = self.lowrank(dtype)
+            pymatrixid.seed(1234)
+            k, idx, proj = interp_decomp(A, 1e-10, sketch=sketch)
+            assert_(k == 12)
+            B = pymatrixid.reconstruct_skel_matrix(A, k, idx)
+            P = pymatrixid.reconstruct_interp_matrix(idx, proj)
+            assert_allclose(B.dot(P), A, rtol=1e-8, atol=1e-8)
+
+            idx, proj = interp_decomp(A, 12, sketch=sketch, workers=2)
+            B = pymatrixid.reconstruct_skel_matrix(A, 12, idx)
+            P = pymatrixid.reconstruct_interp_matrix(idx, proj)
+            assert_allclose(B.dot(P), A, rtol=1e-8, atol=1e-8)
+
+    def test_sparse_and_operator(self):
+        from scipy.sparse import csr_matrix
+        A = self.lowrank(np.float64, density=0.2)
+        r = np.linalg.matrix_rank(A)
+        for M, sketch in itertools.product(
+                [csr_matrix(A), aslinearoperator(A)], ['gaussian', 'sparse']):
+            k, idx, proj = interp_decomp(M, 1e-10, sketch=sketch, workers=3)
+            assert_(k == r)
+            B = pymatrixid.reconstruct_skel_matrix(A, k, idx)
+            P = pymatrixid.reconstruct_interp_matrix(idx, proj)
+            assert_allclose(B.dot(P), A, rtol=1e-8, atol=1e-8)
+
+            U, S, V = pymatrixid.svd(M, 1e-10, sketch=sketch, workers=3)
+            assert_(S.size == r)
+            assert_allclose(U.dot(np.diag(S)).dot(V.T), A, atol=1e-8)
+            assert_(pymatrixid.estimate_rank(M, 1e-10, sketch=sketch) == r)
+
+        # the ID package also takes sparse matrices now
+        k, idx, proj = interp_decomp(csr_matrix(A), 1e-10)
+        assert_(k >= r)
+
+    def test_svd(self):
+        for dtype, sketch in itertools.product(
+                [np.float64, np.complex128], ['gaussian', 'sparse', 'srft']):
+            A = self.lowrank(dtype)
+            U, S, V = pymatrixid.svd(A, 1e-10, sketch=sketch)
+            assert_(S.size == 12)
+            assert_allclose(S, svdvals(A)[:12], rtol=1e-8)
+            assert_allclose(U.dot(np.diag(S)).dot(V.conj().T), A, rtol=1e-8,
+                            atol=1e-8)
+
+            U, S, V = pymatrixid.svd(A, 5, sketch=sketch)
+            assert_(U.shape == (120, 5) and V.shape == (100, 5))
+            assert_allclose(S, svdvals(A)[:5], rtol=1e-8)
+
+    def test_slow_decay(self):
+        # the sketch grows until the rank leaves rows to spare
+        A = hilbert(300)
+        k, idx, proj = interp_decomp(A, 1e-12, sketch='gaussian')
+        B = pymatrixid.reconstruct_skel_matrix(A, k, idx)
+        P = pymatrixid.reconstruct_interp_matrix(idx, proj)
+        assert_(norm(A - B.dot(P), 2) < 1e-9)
+
+    def test_seed(self):
+        A = self.lowrank(np.float64)
+        pymatrixid.seed(4321)
+        U1, S1, V1 = pymatrixid.svd(A, 5, sketch='sparse')
+        pymatrixid.seed(4321)
+        U2, S2, V2 = pymatrixid.svd(A, 5, sketch='sparse')
+        assert_allclose(U1, U2)
+        assert_allclose(S1, S2)
+
+    def test_badcall(self):
+        A = self.lowrank(np.float64)
+        assert_raises(ValueError, interp_decomp, A, 1e-6, sketch='cauchy')
+        assert_raises(ValueError, interp_decomp, aslinearoperator(A), 1e-6,
+                      sketch='srft')
+        assert_raises(ValueError, pymatrixid.svd, A, 101, sketch='gaussian')
+        assert_raises(ValueError, interp_decomp, A, 5, sketch='gaussian',
+                      workers=0)
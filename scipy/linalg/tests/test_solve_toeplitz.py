@@ -3,8 +3,9 @@
 from __future__ import division, print_function, absolute_import
 
 import numpy as np
-from scipy.linalg._solve_toeplitz import levinson
-from scipy.linalg import solve, toeplitz, solve_toeplitz
+from scipy.linalg._solve_toeplitz import levinson, levinson_multi
+from scipy.linalg import (solve, toeplitz, solve_toeplitz,
+                          solve_toeplitz_batch)
 from numpy.testing import assert_equal, assert_allclose
 
 import pytest
@@ -121,3 +122,81 @@ def test_unstable():
 
     assert_allclose(solution1, solution2)
 
+
+
+def test_levinson_multi():
+    # The shared recursion gives the solutions of the columns one by one
+    random = np.random.RandomState(1234)
+    n = 6
+    for dtype in [np.float64, np.complex128]:
+        a = random.randn(2*n - 1).astype(dtype)
+        a[n-1] += n
+        b = random.randn(n, 3).astype(dtype)
+        x = levinson_multi(a, b)
+        for i in range(3):
+            assert_equal(x[:, i], levinson(a, b[:, i].copy())[0])
+
+
+def test_solve_toeplitz_batch():
+    random = np.random.RandomState(1234)
+    m, n = 7, 5
+    for offset in [0, 1j]:
+        c = random.randn(m, n) + offset
+        r = random.randn(m, n)
+        c[:, 0] += n
+        for yshape in ((m, n), (m, n, 3)):
+            y = random.randn(*yshape)
+            desired = np.array([solve_toeplitz((c[i], r[i]), y[i])
+                                for i in range(m)])
+            for workers in [None, 2, -1]:
+                actual = solve_toeplitz_batch((c, r), y, workers=workers)
+                assert_equal(actual.shape, yshape)
+                assert_allclose(actual, desired, rtol=1e-12)
+
+        # Hermitian matrices from the first columns alone
+        actual = solve_toeplitz_batch(c, y)
+        desired = np.array([solve_toeplitz(c[i], y[i]) for i in range(m)])
+        assert_allclose(actual, desired, rtol=1e-12)
+
+
+def test_solve_toeplitz_batch_errors():
+    random = np.random.RandomState(1234)
+    c = random.randn(3, 4)
+    c[:, 0] = 4
+    c[1, 0] = 0
+    y = random.randn(3, 4)
+    assert_raises(np.linalg.LinAlgError, solve_toeplitz_batch, c, y)
+    assert_raises(ValueError, solve_toeplitz_batch, c, y[:2])
+    assert_raises(ValueError, solve_toeplitz_batch, c[0], y[0])
+    assert_raises(ValueError, solve_toeplitz_batch, c, y, workers=0)
+
+
+def test_solve_toeplitz_pcg():
+    # Symmetric and Hermitian positive definite systems
+    random = np.random.RandomState(1234)
+    n = 300
+    k = np.arange(n)
+    for c in [0.9**k, 1 / (k + 1), (0.8 + 0.3j)**k]:
+        c = c.copy()
+        c[0] = 3
+        for yshape in ((n,), (n, 2)):
+            y = random.randn(*yshape)
+            actual = solve_toeplitz(c, y, method='pcg')
+            desired = solve_toeplitz(c, y)
+            assert_equal(actual.shape, yshape)
+            assert_allclose(actual, desired, rtol=1e-9, atol=1e-12)
+            actual = solve_toeplitz(c, y, method='pcg', workers=2)
+            assert_allclose(actual, desired, rtol=1e-9, atol=1e-12)
+
+
+def test_solve_toeplitz_pcg_errors():
+    random = np.random.RandomState(1234)
+    c = random.randn(4)
+    r = random.randn(4)
+    y = random.randn(4)
+    # not Hermitian
+    assert_raises(ValueError, solve_toeplitz, (c, r), y, method='pcg')
+    # not positive definite
+    assert_raises(np.linalg.LinAlgError, solve_toeplitz, [1, 2, 0, 0], y,
+                  method='pcg')
+    assert_raises(ValueError, solve_toeplitz, c, y, method='gko')
@@ -78,6 +78,7 @@ Measurements
    histogram - Histogram of the values of an array, optionally at labels
    label - Label features in an array
    labeled_comprehension
+   labeled_statistics - Several statistics of an array at labels, in one pass
    maximum
    maximum_position
    mean - Mean of the values of an array at labels
@@ -111,6 +111,36 @@ _prefilter_doc = (
     setting this to False, the output will be slightly blurred if
     `order > 1`, unless the input is prefiltered, i.e. it is the result
     of calling `spline_filter` on the original input.""")
+_workers_doc = (
+"""workers : int, optional
+    Number of threads over which the lines of the input are divided.
+    If negative, the value wraps around, so that -1 uses all CPUs. The
+    default is a single thread. Small inputs, and outputs that partially
+    overlap the input, are always processed on a single thread.
+
+    .. versionadded:: 1.4.0""")
+
+_precision_doc = (
+"""precision : {'double', 'single'}, optional
+    The precision of the accumulation. The default, 'double', sums in
+    double precision; ``float32`` lines are still processed without
+    conversion to ``float64``, with results identical to the ``float64``
+    path. 'single' additionally sums ``float32`` lines with ``float32``
+    weights, which is faster but less accurate. Other data types always
+    use double precision.
+
+    .. versionadded:: 1.4.0""")
+_chunk_size_doc = (
+"""chunk_size : int, optional
+    If given, the input is filtered in slabs of this many elements along
+    the first axis. Each slab is read together with the neighbouring
+    elements that the filter reaches, the next slab is read on a separate
+    thread while the current one is filtered, and the results are written
+    out slab by slab. This keeps large memory-mapped arrays streaming
+    through memory in order. By default the whole array is filtered at
+    once, as are outputs that may share memory with the input.
+
+    .. versionadded:: 1.4.0""")
 
 docdict = {
     'input': _input_doc,
@@ -124,7 +154,10 @@ docdict = {
     'origin_multiple': _origin_multiple_doc,
     'extra_arguments': _extra_arguments_doc,
     'extra_keywords': _extra_keywords_doc,
-    'prefilter': _prefilter_doc
+    'prefilter': _prefilter_doc,
+    'workers': _workers_doc,
+    'precision': _precision_doc,
+    'chunk_size': _chunk_size_doc
     }
 
 docfiller = doccer.filldoc(docdict)
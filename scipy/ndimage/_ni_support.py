@@ -30,6 +30,10 @@
 
 from __future__ import division, print_function, absolute_import
 
+import operator
+import os
+import threading
+
 import numpy
 
 from scipy._lib.six import string_types
@@ -89,3 +93,108 @@ def _check_axis(axis, rank):
     if axis < 0 or axis >= rank:
         raise ValueError('invalid axis')
     return axis
+
+
+def _check_workers(workers):
+    """Normalize a ``workers`` argument to a positive thread count.
+
+    ``None`` means a single thread, and negative values wrap around from
+    ``os.cpu_count()``, so that ``-1`` means all CPUs.
+    """
+    if workers is None:
+        return 1
+
+    workers = operator.index(workers)
+    if workers < 0:
+        cpu_count = os.cpu_count() or 1
+        if workers >= -cpu_count:
+            workers += 1 + cpu_count
+        else:
+            raise ValueError("workers value out of range; got {}, must not be"
+                             " less than {}".format(workers, -cpu_count))
+    elif workers == 0:
+        raise ValueError("workers must not be zero")
+    return workers
+
+
+def _check_precision(precision):
+    """Map a ``precision`` argument to the flag of the C correlation.
+
+    'double' accumulates in double precision, and 'single' allows lines of
+    ``float32`` to be accumulated in single precision.
+    """
+    if precision == 'double':
+        return 0
+    elif precision == 'single':
+        return 1
+    raise ValueError("precision must be 'double' or 'single'; got "
+                     "{!r}".format(precision))
+
+
+def _check_chunk_size(chunk_size, input, output):
+    """Normalize a ``chunk_size`` argument to the number of elements along
+    the first axis of a slab, or None if the array is filtered at once.
+
+    Arrays that fit in one slab, and outputs that may share memory with the
+    input, whose slabs would be read after their neighbours are written,
+    are filtered at once.
+    """
+    if chunk_size is None:
+        return None
+    chunk_size = operator.index(chunk_size)
+    if chunk_size < 1:
+        raise ValueError("chunk_size must be positive; got "
+                         "{}".format(chunk_size))
+    if (input.ndim == 0 or input.shape[0] <= chunk_size or
+            numpy.may_share_memory(input, output)):
+        return None
+    return chunk_size
+
+
+def _filter_chunked(function, input, output, halo, mode, chunk_size):
+    """Filter `input` into `output` in slabs along the first axis.
+
+    ``function(input_slab, output_slab)`` filters one slab held in memory.
+    Each slab of `chunk_size` elements is read together with the `halo`
+    elements on either side that the filter reaches, wrapping around if
+    `mode` is 'wrap'; at the ends of the axis the filter's own boundary
+    extension applies. The next slab is read on a thread while the current
+    one is filtered, and the slabs are written out in order, so that a
+    memory-mapped array is read and written sequentially.
+    """
+    length = input.shape[0]
+
+    def read(start, result):
+        try:
+            stop = min(start + chunk_size, length)
+            if mode == 'wrap':
+                index = numpy.arange(start - halo, stop + halo) % length
+                result.append((input.take(index, axis=0), halo))
+            else:
+                first = max(start - halo, 0)
+                slab = numpy.array(input[first:min(stop + halo, length)])
+                result.append((slab, start - first))
+        except BaseException as e:
+            result.append(e)
+
+    def prefetch(start):
+        result = []
+        thread = threading.Thread(target=read, args=(start, result))
+        thread.daemon = True
+        thread.start()
+        return thread, result
+
+    pending = prefetch(0)
+    for start in range(0, length, chunk_size):
+        thread, result = pending
+        thread.join()
+        if isinstance(result[0], BaseException):
+            raise result[0]
+        slab, offset = result[0]
+        if start + chunk_size < length:
+            pending = prefetch(start + chunk_size)
+        filtered = numpy.empty(slab.shape, dtype=output.dtype)
+        function(slab, filtered)
+        stop = min(start + chunk_size, length)
+        output[start:stop] = filtered[offset:offset + stop - start]
+    return output
@@ -53,7 +53,7 @@ def _invalid_origin(origin, lenw):
 
 @_ni_docstrings.docfiller
 def correlate1d(input, weights, axis=-1, output=None, mode="reflect",
-                cval=0.0, origin=0):
+                cval=0.0, origin=0, workers=None, precision='double'):
     """Calculate a one-dimensional correlation along the given axis.
 
     The lines of the array along the given axis are correlated with the
@@ -69,6 +69,8 @@ def correlate1d(input, weights, axis=-1, output=None, mode="reflect",
     %(mode)s
     %(cval)s
     %(origin)s
+    %(workers)s
+    %(precision)s
 
     Examples
     --------
@@ -91,14 +93,16 @@ def correlate1d(input, weights, axis=-1, output=None, mode="reflect",
                          '-(len(weights) // 2) <= origin <= '
                          '(len(weights)-1) // 2')
     mode = _ni_support._extend_mode_to_code(mode)
+    workers = _ni_support._check_workers(workers)
+    single = _ni_support._check_precision(precision)
     _nd_image.correlate1d(input, weights, axis, output, mode, cval,
-                          origin)
+                          origin, workers, single)
     return output
 
 
 @_ni_docstrings.docfiller
 def convolve1d(input, weights, axis=-1, output=None, mode="reflect",
-               cval=0.0, origin=0):
+               cval=0.0, origin=0, workers=None, precision='double'):
     """Calculate a one-dimensional convolution along the given axis.
 
     The lines of the array along the given axis are convolved with the
@@ -114,6 +118,8 @@ def convolve1d(input, weights, axis=-1, output=None, mode="reflect",
     %(mode)s
     %(cval)s
     %(origin)s
+    %(workers)s
+    %(precision)s
 
     Returns
     -------
@@ -130,7 +136,8 @@ def convolve1d(input, weights, axis=-1, output=None, mode="reflect",
     origin = -origin
     if not len(weights) & 1:
         origin -= 1
-    return correlate1d(input, weights, axis, output, mode, cval, origin)
+    return correlate1d(input, weights, axis, output, mode, cval, origin,
+                       workers, precision)
 
 
 def _gaussian_kernel1d(sigma, order, radius):
@@ -166,7 +173,8 @@ def _gaussian_kernel1d(sigma, order, radius):
 
 @_ni_docstrings.docfiller
 def gaussian_filter1d(input, sigma, axis=-1, order=0, output=None,
-                      mode="reflect", cval=0.0, truncate=4.0):
+                      mode="reflect", cval=0.0, truncate=4.0, workers=None,
+                      precision='double'):
     """One-dimensional Gaussian filter.
 
     Parameters
@@ -185,6 +193,8 @@ def gaussian_filter1d(input, sigma, axis=-1, order=0, output=None,
     truncate : float, optional
         Truncate the filter at this many standard deviations.
         Default is 4.0.
+    %(workers)s
+    %(precision)s
 
     Returns
     -------
@@ -214,12 +224,14 @@ def gaussian_filter1d(input, sigma, axis=-1, order=0, output=None,
     lw = int(truncate * sd + 0.5)
     # Since we are calling correlate, not convolve, revert the kernel
     weights = _gaussian_kernel1d(sigma, order, lw)[::-1]
-    return correlate1d(input, weights, axis, output, mode, cval, 0)
+    return correlate1d(input, weights, axis, output, mode, cval, 0, workers,
+                       precision)
 
 
 @_ni_docstrings.docfiller
 def gaussian_filter(input, sigma, order=0, output=None,
-                    mode="reflect", cval=0.0, truncate=4.0):
+                    mode="reflect", cval=0.0, truncate=4.0, workers=None,
+                    precision='double', chunk_size=None):
     """Multidimensional Gaussian filter.
 
     Parameters
@@ -241,6 +253,9 @@ def gaussian_filter(input, sigma, order=0, output=None,
     truncate : float
         Truncate the filter at this many standard deviations.
         Default is 4.0.
+    %(workers)s
+    %(precision)s
+    %(chunk_size)s
 
     Returns
     -------
@@ -290,13 +305,22 @@ def gaussian_filter(input, sigma, order=0, output=None,
     orders = _ni_support._normalize_sequence(order, input.ndim)
     sigmas = _ni_support._normalize_sequence(sigma, input.ndim)
     modes = _ni_support._normalize_sequence(mode, input.ndim)
+    chunk_size = _ni_support._check_chunk_size(chunk_size, input, output)
+    if chunk_size is not None:
+        halo = int(truncate * float(sigmas[0]) + 0.5)
+
+        def function(input, output):
+            gaussian_filter(input, sigma, order, output, mode, cval,
+                            truncate, workers, precision)
+        return _ni_support._filter_chunked(function, input, output, halo,
+                                           modes[0], chunk_size)
     axes = list(range(input.ndim))
     axes = [(axes[ii], sigmas[ii], orders[ii], modes[ii])
             for ii in range(len(axes)) if sigmas[ii] > 1e-15]
     if len(axes) > 0:
         for axis, sigma, order, mode in axes:
             gaussian_filter1d(input, sigma, axis, order, output,
-                              mode, cval, truncate)
+                              mode, cval, truncate, workers, precision)
             input = output
     else:
         output[...] = input[...]
@@ -593,8 +617,47 @@ def gaussian_gradient_magnitude(input, sigma, output=None,
                                       extra_keywords=kwargs)
 
 
+def _separable_weights(weights):
+    """Factor a rank-1 array of weights into one vector per axis.
+
+    Returns None unless the outer product of the vectors reproduces
+    `weights` to rounding, and filtering with them one axis at a time
+    takes fewer multiply-adds. All weights must be nonzero, so that the
+    one-dimensional passes read the same input points as the
+    n-dimensional filter, which skips zero weights.
+    """
+    if weights.ndim < 2 or weights.size == 0:
+        return None
+    if sum(weights.shape) >= weights.size:
+        return None
+    magnitudes = numpy.abs(weights)
+    if not (numpy.isfinite(weights).all() and
+            (magnitudes > numpy.finfo(numpy.float64).eps).all()):
+        return None
+    # the rows and columns through the largest weight span the factors
+    pivot = numpy.unravel_index(numpy.argmax(magnitudes), weights.shape)
+    scale = weights[pivot]
+    # all factors but the first one of length > 1 are normalized by the
+    # pivot, so that those of length one are one
+    first = weights.shape.index(max(weights.shape))
+    factors = []
+    for axis in range(weights.ndim):
+        index = list(pivot)
+        index[axis] = slice(None)
+        factor = weights[tuple(index)]
+        factors.append(factor if axis == first else factor / scale)
+    product = factors[0]
+    for factor in factors[1:]:
+        product = numpy.multiply.outer(product, factor)
+    tolerance = 16 * numpy.finfo(numpy.float64).eps * abs(scale)
+    if numpy.abs(product - weights).max() > tolerance:
+        return None
+    return factors
+
+
 def _correlate_or_convolve(input, weights, output, mode, cval, origin,
-                           convolution):
+                           convolution, workers=None, precision='double',
+                           chunk_size=None):
     input = numpy.asarray(input)
     if numpy.iscomplexobj(input):
         raise TypeError('Complex type not supported')
@@ -618,14 +681,43 @@ def _correlate_or_convolve(input, weights, output, mode, cval, origin,
     if not weights.flags.contiguous:
         weights = weights.copy()
     output = _ni_support._get_output(output, input)
+    workers = _ni_support._check_workers(workers)
+    single = _ni_support._check_precision(precision)
+    chunk_size = _ni_support._check_chunk_size(chunk_size, input, output)
+    if chunk_size is not None:
+        halo = wshape[0] // 2 + abs(origins[0])
+
+        # the weights and origins are already flipped for a convolution
+        def function(input, output):
+            _correlate_or_convolve(input, weights, output, mode, cval,
+                                   origins, False, workers, precision)
+        return _ni_support._filter_chunked(function, input, output, halo,
+                                           mode, chunk_size)
+    # A separable kernel is applied as a sequence of one-dimensional
+    # correlations. A constant border is not separable unless it is zero,
+    # and the intermediate results need the precision of the n-dimensional
+    # filter's accumulator, unless single precision was asked for.
+    if ((output.dtype == numpy.float64 or
+         (single and output.dtype == numpy.float32)) and
+            (mode != 'constant' or cval == 0)):
+        factors = _separable_weights(weights)
+        if factors is not None:
+            for axis, factor in enumerate(factors):
+                # the pivot of a length-one axis is normalized to one
+                if factor.shape[0] > 1:
+                    correlate1d(input, factor, axis, output, mode, cval,
+                                origins[axis], workers, precision)
+                    input = output
+            return output
     mode = _ni_support._extend_mode_to_code(mode)
-    _nd_image.correlate(input, weights, output, mode, cval, origins)
+    _nd_image.correlate(input, weights, output, mode, cval, origins,
+                        workers)
     return output
 
 
 @_ni_docstrings.docfiller
 def correlate(input, weights, output=None, mode='reflect', cval=0.0,
-              origin=0):
+              origin=0, workers=None, precision='double', chunk_size=None):
     """
     Multi-dimensional correlation.
 
@@ -640,18 +732,30 @@ def correlate(input, weights, output=None, mode='reflect', cval=0.0,
     %(mode_multiple)s
     %(cval)s
     %(origin_multiple)s
+    %(workers)s
+    %(precision)s
+    %(chunk_size)s
 
     See Also
     --------
     convolve : Convolve an image with a kernel.
+
+    Notes
+    -----
+    A kernel that is the outer product of one-dimensional kernels is
+    applied with `correlate1d` along each axis in turn, if the output is
+    of type ``float64`` and the boundary extension is separable, i.e.
+    any `mode` except 'constant' with nonzero `cval`. With
+    ``precision='single'`` this also applies to ``float32`` outputs.
     """
     return _correlate_or_convolve(input, weights, output, mode, cval,
-                                  origin, False)
+                                  origin, False, workers, precision,
+                                  chunk_size)
 
 
 @_ni_docstrings.docfiller
 def convolve(input, weights, output=None, mode='reflect', cval=0.0,
-             origin=0):
+             origin=0, workers=None, precision='double', chunk_size=None):
     """
     Multidimensional convolution.
 
@@ -668,6 +772,9 @@ def convolve(input, weights, output=None, mode='reflect', cval=0.0,
         Value to fill past edges of input if `mode` is 'constant'. Default
         is 0.0
     %(origin_multiple)s
+    %(workers)s
+    %(precision)s
+    %(chunk_size)s
 
     Returns
     -------
@@ -752,12 +859,13 @@ def convolve(input, weights, output=None, mode='reflect', cval=0.0,
 
     """
     return _correlate_or_convolve(input, weights, output, mode, cval,
-                                  origin, True)
+                                  origin, True, workers, precision,
+                                  chunk_size)
 
 
 @_ni_docstrings.docfiller
 def uniform_filter1d(input, size, axis=-1, output=None,
-                     mode="reflect", cval=0.0, origin=0):
+                     mode="reflect", cval=0.0, origin=0, workers=None):
     """Calculate a one-dimensional uniform filter along the given axis.
 
     The lines of the array along the given axis are filtered with a
@@ -773,6 +881,7 @@ def uniform_filter1d(input, size, axis=-1, output=None,
     %(mode)s
     %(cval)s
     %(origin)s
+    %(workers)s
 
     Examples
     --------
@@ -790,14 +899,15 @@ def uniform_filter1d(input, size, axis=-1, output=None,
     if (size // 2 + origin < 0) or (size // 2 + origin >= size):
         raise ValueError('invalid origin')
     mode = _ni_support._extend_mode_to_code(mode)
+    workers = _ni_support._check_workers(workers)
     _nd_image.uniform_filter1d(input, size, axis, output, mode, cval,
-                               origin)
+                               origin, workers)
     return output
 
 
 @_ni_docstrings.docfiller
 def uniform_filter(input, size=3, output=None, mode="reflect",
-                   cval=0.0, origin=0):
+                   cval=0.0, origin=0, workers=None, chunk_size=None):
     """Multi-dimensional uniform filter.
 
     Parameters
@@ -811,6 +921,8 @@ def uniform_filter(input, size=3, output=None, mode="reflect",
     %(mode_multiple)s
     %(cval)s
     %(origin_multiple)s
+    %(workers)s
+    %(chunk_size)s
 
     Returns
     -------
@@ -844,13 +956,21 @@ def uniform_filter(input, size=3, output=None, mode="reflect",
     sizes = _ni_support._normalize_sequence(size, input.ndim)
     origins = _ni_support._normalize_sequence(origin, input.ndim)
     modes = _ni_support._normalize_sequence(mode, input.ndim)
+    chunk_size = _ni_support._check_chunk_size(chunk_size, input, output)
+    if chunk_size is not None:
+        halo = int(sizes[0]) // 2 + abs(origins[0])
+
+        def function(input, output):
+            uniform_filter(input, size, output, mode, cval, origin, workers)
+        return _ni_support._filter_chunked(function, input, output, halo,
+                                           modes[0], chunk_size)
     axes = list(range(input.ndim))
     axes = [(axes[ii], sizes[ii], origins[ii], modes[ii])
             for ii in range(len(axes)) if sizes[ii] > 1]
     if len(axes) > 0:
         for axis, size, origin, mode in axes:
             uniform_filter1d(input, int(size), axis, output, mode,
-                             cval, origin)
+                             cval, origin, workers)
             input = output
     else:
         output[...] = input[...]
@@ -859,7 +979,7 @@ def uniform_filter(input, size=3, output=None, mode="reflect",
 
 @_ni_docstrings.docfiller
 def minimum_filter1d(input, size, axis=-1, output=None,
-                     mode="reflect", cval=0.0, origin=0):
+                     mode="reflect", cval=0.0, origin=0, workers=None):
     """Calculate a one-dimensional minimum filter along the given axis.
 
     The lines of the array along the given axis are filtered with a
@@ -875,17 +995,27 @@ def minimum_filter1d(input, size, axis=-1, output=None,
     %(mode)s
     %(cval)s
     %(origin)s
+    %(workers)s
 
     Notes
     -----
     This function implements the MINLIST algorithm [1]_, as described by
     Richard Harter [2]_, and has a guaranteed O(n) performance, `n` being
-    the `input` length, regardless of filter size.
+    the `input` length, regardless of filter size. For sizes of 8 and
+    more, lines without NaNs are filtered with the van Herk/Gil-Werman
+    algorithm [3]_, [4]_ instead, which takes three comparisons per
+    element.
 
     References
     ----------
     .. [1] http://citeseerx.ist.psu.edu/viewdoc/summary?doi=10.1.1.42.2777
     .. [2] http://www.richardhartersworld.com/cri/2001/slidingmin.html
+    .. [3] M. van Herk, "A fast algorithm for local minimum and maximum
+           filters on rectangular and octagonal kernels", Pattern
+           Recognition Letters, 13(7), pp. 517-521, 1992.
+    .. [4] J. Gil and M. Werman, "Computing 2-D min, median, and max
+           filters", IEEE Transactions on Pattern Analysis and Machine
+           Intelligence, 15(5), pp. 504-507, 1993.
 
 
     Examples
@@ -904,14 +1034,15 @@ def minimum_filter1d(input, size, axis=-1, output=None,
     if (size // 2 + origin < 0) or (size // 2 + origin >= size):
         raise ValueError('invalid origin')
     mode = _ni_support._extend_mode_to_code(mode)
+    workers = _ni_support._check_workers(workers)
     _nd_image.min_or_max_filter1d(input, size, axis, output, mode, cval,
-                                  origin, 1)
+                                  origin, 1, workers)
     return output
 
 
 @_ni_docstrings.docfiller
 def maximum_filter1d(input, size, axis=-1, output=None,
-                     mode="reflect", cval=0.0, origin=0):
+                     mode="reflect", cval=0.0, origin=0, workers=None):
     """Calculate a one-dimensional maximum filter along the given axis.
 
     The lines of the array along the given axis are filtered with a
@@ -927,6 +1058,7 @@ def maximum_filter1d(input, size, axis=-1, output=None,
     %(mode)s
     %(cval)s
     %(origin)s
+    %(workers)s
 
     Returns
     -------
@@ -938,12 +1070,21 @@ def maximum_filter1d(input, size, axis=-1, output=None,
     -----
     This function implements the MAXLIST algorithm [1]_, as described by
     Richard Harter [2]_, and has a guaranteed O(n) performance, `n` being
-    the `input` length, regardless of filter size.
+    the `input` length, regardless of filter size. For sizes of 8 and
+    more, lines without NaNs are filtered with the van Herk/Gil-Werman
+    algorithm [3]_, [4]_ instead, which takes three comparisons per
+    element.
 
     References
     ----------
     .. [1] http://citeseerx.ist.psu.edu/viewdoc/summary?doi=10.1.1.42.2777
     .. [2] http://www.richardhartersworld.com/cri/2001/slidingmin.html
+    .. [3] M. van Herk, "A fast algorithm for local minimum and maximum
+           filters on rectangular and octagonal kernels", Pattern
+           Recognition Letters, 13(7), pp. 517-521, 1992.
+    .. [4] J. Gil and M. Werman, "Computing 2-D min, median, and max
+           filters", IEEE Transactions on Pattern Analysis and Machine
+           Intelligence, 15(5), pp. 504-507, 1993.
 
     Examples
     --------
@@ -961,15 +1102,24 @@ def maximum_filter1d(input, size, axis=-1, output=None,
     if (size // 2 + origin < 0) or (size // 2 + origin >= size):
         raise ValueError('invalid origin')
     mode = _ni_support._extend_mode_to_code(mode)
+    workers = _ni_support._check_workers(workers)
     _nd_image.min_or_max_filter1d(input, size, axis, output, mode, cval,
-                                  origin, 0)
+                                  origin, 0, workers)
     return output
 
 
 def _min_or_max_filter(input, size, footprint, structure, output, mode,
-                       cval, origin, minimum):
+                       cval, origin, minimum, workers=None):
     if (size is not None) and (footprint is not None):
         warnings.warn("ignoring size because footprint is set", UserWarning, stacklevel=3)
+    if structure is not None:
+        structure = numpy.asarray(structure, dtype=numpy.float64)
+        if not structure.any():
+            # a flat structure is the same as its footprint, which can
+            # then be separable
+            if footprint is None:
+                footprint = numpy.ones(structure.shape, bool)
+            structure = None
     if structure is None:
         if footprint is None:
             if size is None:
@@ -986,7 +1136,6 @@ def _min_or_max_filter(input, size, footprint, structure, output, mode,
             else:
                 separable = False
     else:
-        structure = numpy.asarray(structure, dtype=numpy.float64)
         separable = False
         if footprint is None:
             footprint = numpy.ones(structure.shape, bool)
@@ -1009,7 +1158,8 @@ def _min_or_max_filter(input, size, footprint, structure, output, mode,
             filter_ = maximum_filter1d
         if len(axes) > 0:
             for axis, size, origin, mode in axes:
-                filter_(input, int(size), axis, output, mode, cval, origin)
+                filter_(input, int(size), axis, output, mode, cval, origin,
+                        workers)
                 input = output
         else:
             output[...] = input[...]
@@ -1035,7 +1185,7 @@ def _min_or_max_filter(input, size, footprint, structure, output, mode,
 
 @_ni_docstrings.docfiller
 def minimum_filter(input, size=None, footprint=None, output=None,
-                   mode="reflect", cval=0.0, origin=0):
+                   mode="reflect", cval=0.0, origin=0, workers=None):
     """Calculate a multi-dimensional minimum filter.
 
     Parameters
@@ -1046,6 +1196,7 @@ def minimum_filter(input, size=None, footprint=None, output=None,
     %(mode_multiple)s
     %(cval)s
     %(origin_multiple)s
+    %(workers)s
 
     Returns
     -------
@@ -1067,12 +1218,12 @@ def minimum_filter(input, size=None, footprint=None, output=None,
     >>> plt.show()
     """
     return _min_or_max_filter(input, size, footprint, None, output, mode,
-                              cval, origin, 1)
+                              cval, origin, 1, workers)
 
 
 @_ni_docstrings.docfiller
 def maximum_filter(input, size=None, footprint=None, output=None,
-                   mode="reflect", cval=0.0, origin=0):
+                   mode="reflect", cval=0.0, origin=0, workers=None):
     """Calculate a multi-dimensional maximum filter.
 
     Parameters
@@ -1083,6 +1234,7 @@ def maximum_filter(input, size=None, footprint=None, output=None,
     %(mode_multiple)s
     %(cval)s
     %(origin_multiple)s
+    %(workers)s
 
     Returns
     -------
@@ -1104,12 +1256,13 @@ def maximum_filter(input, size=None, footprint=None, output=None,
     >>> plt.show()
     """
     return _min_or_max_filter(input, size, footprint, None, output, mode,
-                              cval, origin, 0)
+                              cval, origin, 0, workers)
 
 
 @_ni_docstrings.docfiller
 def _rank_filter(input, rank, size=None, footprint=None, output=None,
-                 mode="reflect", cval=0.0, origin=0, operation='rank'):
+                 mode="reflect", cval=0.0, origin=0, operation='rank',
+                 workers=None):
     if (size is not None) and (footprint is not None):
         warnings.warn("ignoring size because footprint is set", UserWarning, stacklevel=3)
     input = numpy.asarray(input)
@@ -1150,21 +1303,22 @@ def _rank_filter(input, rank, size=None, footprint=None, output=None,
         raise RuntimeError('rank not within filter footprint size')
     if rank == 0:
         return minimum_filter(input, None, footprint, output, mode, cval,
-                              origins)
+                              origins, workers)
     elif rank == filter_size - 1:
         return maximum_filter(input, None, footprint, output, mode, cval,
-                              origins)
+                              origins, workers)
     else:
         output = _ni_support._get_output(output, input)
         mode = _ni_support._extend_mode_to_code(mode)
+        workers = _ni_support._check_workers(workers)
         _nd_image.rank_filter(input, rank, footprint, output, mode, cval,
-                              origins)
+                              origins, workers)
         return output
 
 
 @_ni_docstrings.docfiller
 def rank_filter(input, rank, size=None, footprint=None, output=None,
-                mode="reflect", cval=0.0, origin=0):
+                mode="reflect", cval=0.0, origin=0, workers=None):
     """Calculate a multi-dimensional rank filter.
 
     Parameters
@@ -1178,12 +1332,22 @@ def rank_filter(input, rank, size=None, footprint=None, output=None,
     %(mode_multiple)s
     %(cval)s
     %(origin_multiple)s
+    %(workers)s
 
     Returns
     -------
     rank_filter : ndarray
         Filtered array. Has the same shape as `input`.
 
+    Notes
+    -----
+    For inputs of 8 or 16 bit integers and large footprints, the window
+    is kept as a histogram that is updated as it slides along the last
+    axis, and footprints that change by only a few points on such a step
+    are kept as a sorted window, unless the input has NaNs. Both take
+    time proportional to the number of changed points, rather than the
+    footprint size.
+
     Examples
     --------
     >>> from scipy import ndimage, misc
@@ -1200,12 +1364,12 @@ def rank_filter(input, rank, size=None, footprint=None, output=None,
     """
     rank = operator.index(rank)
     return _rank_filter(input, rank, size, footprint, output, mode, cval,
-                        origin, 'rank')
+                        origin, 'rank', workers)
 
 
 @_ni_docstrings.docfiller
 def median_filter(input, size=None, footprint=None, output=None,
-                  mode="reflect", cval=0.0, origin=0):
+                  mode="reflect", cval=0.0, origin=0, workers=None):
     """
     Calculate a multidimensional median filter.
 
@@ -1217,6 +1381,7 @@ def median_filter(input, size=None, footprint=None, output=None,
     %(mode_multiple)s
     %(cval)s
     %(origin_multiple)s
+    %(workers)s
 
     Returns
     -------
@@ -1238,12 +1403,13 @@ def median_filter(input, size=None, footprint=None, output=None,
     >>> plt.show()
     """
     return _rank_filter(input, 0, size, footprint, output, mode, cval,
-                        origin, 'median')
+                        origin, 'median', workers)
 
 
 @_ni_docstrings.docfiller
 def percentile_filter(input, percentile, size=None, footprint=None,
-                      output=None, mode="reflect", cval=0.0, origin=0):
+                      output=None, mode="reflect", cval=0.0, origin=0,
+                      workers=None):
     """Calculate a multi-dimensional percentile filter.
 
     Parameters
@@ -1257,6 +1423,7 @@ def percentile_filter(input, percentile, size=None, footprint=None,
     %(mode_multiple)s
     %(cval)s
     %(origin_multiple)s
+    %(workers)s
 
     Returns
     -------
@@ -1278,13 +1445,13 @@ def percentile_filter(input, percentile, size=None, footprint=None,
     >>> plt.show()
     """
     return _rank_filter(input, percentile, size, footprint, output, mode,
-                        cval, origin, 'percentile')
+                        cval, origin, 'percentile', workers)
 
 
 @_ni_docstrings.docfiller
 def generic_filter1d(input, function, filter_size, axis=-1,
                      output=None, mode="reflect", cval=0.0, origin=0,
-                     extra_arguments=(), extra_keywords=None):
+                     extra_arguments=(), extra_keywords=None, workers=None):
     """Calculate a one-dimensional filter along the given axis.
 
     `generic_filter1d` iterates over the lines of the array, calling the
@@ -1308,6 +1475,14 @@ def generic_filter1d(input, function, filter_size, axis=-1,
     %(origin)s
     %(extra_arguments)s
     %(extra_keywords)s
+    workers : int, optional
+        Number of threads over which the lines of the input are divided,
+        if `function` is a batched low-level callback (see Notes). If
+        negative, the value wraps around, so that -1 uses all CPUs. The
+        default is a single thread. Other functions are always called on
+        a single thread.
+
+        .. versionadded:: 1.4.0
 
     Notes
     -----
@@ -1340,6 +1515,25 @@ def generic_filter1d(input, function, filter_size, axis=-1,
     before returning, otherwise a default error message is set by the
     calling function.
 
+    A batched callback function filters many lines in one call:
+
+    .. code:: c
+
+       int function(double *input_lines, npy_intp input_length,
+                    double *output_lines, npy_intp output_length,
+                    npy_intp n_lines, void *user_data)
+       int function(double *input_lines, intptr_t input_length,
+                    double *output_lines, intptr_t output_length,
+                    intptr_t n_lines, void *user_data)
+
+    The ``n_lines`` extended input lines follow each other in
+    ``input_lines``, ``input_length`` elements apart, and the output lines
+    follow each other in ``output_lines``, ``output_length`` elements
+    apart. A batched function is called without holding the GIL, from up
+    to `workers` threads at the same time, so it must not call the Python
+    C API and must be safe to call concurrently with the same
+    ``user_data``. If it returns zero, a `RuntimeError` is raised.
+
     In addition, some other low-level function pointer specifications
     are accepted, but these are for backward compatibility only and should
     not be used in new code.
@@ -1350,6 +1544,7 @@ def generic_filter1d(input, function, filter_size, axis=-1,
     input = numpy.asarray(input)
     if numpy.iscomplexobj(input):
         raise TypeError('Complex type not supported')
+    workers = _ni_support._check_workers(workers)
     output = _ni_support._get_output(output, input)
     if filter_size < 1:
         raise RuntimeError('invalid filter size')
@@ -1360,14 +1555,14 @@ def generic_filter1d(input, function, filter_size, axis=-1,
     mode = _ni_support._extend_mode_to_code(mode)
     _nd_image.generic_filter1d(input, function, filter_size, axis, output,
                                mode, cval, origin, extra_arguments,
-                               extra_keywords)
+                               extra_keywords, workers)
     return output
 
 
 @_ni_docstrings.docfiller
 def generic_filter(input, function, size=None, footprint=None,
                    output=None, mode="reflect", cval=0.0, origin=0,
-                   extra_arguments=(), extra_keywords=None):
+                   extra_arguments=(), extra_keywords=None, workers=None):
     """Calculate a multi-dimensional filter using the given function.
 
     At each element the provided function is called. The input values
@@ -1386,6 +1581,14 @@ def generic_filter(input, function, size=None, footprint=None,
     %(origin_multiple)s
     %(extra_arguments)s
     %(extra_keywords)s
+    workers : int, optional
+        Number of threads over which the lines of the output are divided,
+        if `function` is a batched low-level callback (see Notes). If
+        negative, the value wraps around, so that -1 uses all CPUs. The
+        default is a single thread. Other functions are always called on
+        a single thread.
+
+        .. versionadded:: 1.4.0
 
     Notes
     -----
@@ -1413,6 +1616,25 @@ def generic_filter(input, function, size=None, footprint=None,
     before returning, otherwise a default error message is set by the
     calling function.
 
+    A batched callback function filters many elements in one call:
+
+    .. code:: c
+
+       int callback(double *buffer, npy_intp filter_size,
+                    npy_intp n_elements, double *return_values,
+                    void *user_data)
+       int callback(double *buffer, intptr_t filter_size,
+                    intptr_t n_elements, double *return_values,
+                    void *user_data)
+
+    The footprints of ``n_elements`` elements follow each other in
+    ``buffer``, ``filter_size`` values apart, and the calculated values are
+    returned in ``return_values``. A batched function is called without
+    holding the GIL, from up to `workers` threads at the same time, so it
+    must not call the Python C API and must be safe to call concurrently
+    with the same ``user_data``. If it returns zero, a `RuntimeError` is
+    raised.
+
     In addition, some other low-level function pointer specifications
     are accepted, but these are for backward compatibility only and should
     not be used in new code.
@@ -1425,6 +1647,7 @@ def generic_filter(input, function, size=None, footprint=None,
     input = numpy.asarray(input)
     if numpy.iscomplexobj(input):
         raise TypeError('Complex type not supported')
+    workers = _ni_support._check_workers(workers)
     origins = _ni_support._normalize_sequence(origin, input.ndim)
     if footprint is None:
         if size is None:
@@ -1444,5 +1667,6 @@ def generic_filter(input, function, size=None, footprint=None,
     output = _ni_support._get_output(output, input)
     mode = _ni_support._extend_mode_to_code(mode)
     _nd_image.generic_filter(input, function, footprint, output, mode,
-                             cval, origins, extra_arguments, extra_keywords)
+                             cval, origins, extra_arguments, extra_keywords,
+                             workers)
     return output
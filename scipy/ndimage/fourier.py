@@ -70,7 +70,8 @@ def _get_output_fourier_complex(output, input):
     return output
 
 
-def fourier_gaussian(input, sigma, n=-1, axis=-1, output=None):
+def fourier_gaussian(input, sigma, n=-1, axis=-1, output=None,
+                     workers=None):
     """
     Multi-dimensional Gaussian fourier filter.
 
@@ -96,6 +97,13 @@ def fourier_gaussian(input, sigma, n=-1, axis=-1, output=None):
     output : ndarray, optional
         If given, the result of filtering the input is placed in this array.
         None is returned in this case.
+    workers : int, optional
+        Number of threads over which the lines of the input are divided.
+        If negative, the value wraps around, so that -1 uses all CPUs. The
+        default is a single thread. Small inputs, and outputs that partially
+        overlap the input, are always processed on a single thread.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -120,16 +128,18 @@ def fourier_gaussian(input, sigma, n=-1, axis=-1, output=None):
     input = numpy.asarray(input)
     output = _get_output_fourier(output, input)
     axis = _ni_support._check_axis(axis, input.ndim)
+    workers = _ni_support._check_workers(workers)
     sigmas = _ni_support._normalize_sequence(sigma, input.ndim)
     sigmas = numpy.asarray(sigmas, dtype=numpy.float64)
     if not sigmas.flags.contiguous:
         sigmas = sigmas.copy()
 
-    _nd_image.fourier_filter(input, sigmas, n, axis, output, 0)
+    _nd_image.fourier_filter(input, sigmas, n, axis, output, 0, workers)
     return output
 
 
-def fourier_uniform(input, size, n=-1, axis=-1, output=None):
+def fourier_uniform(input, size, n=-1, axis=-1, output=None,
+                    workers=None):
     """
     Multi-dimensional uniform fourier filter.
 
@@ -155,6 +165,13 @@ def fourier_uniform(input, size, n=-1, axis=-1, output=None):
     output : ndarray, optional
         If given, the result of filtering the input is placed in this array.
         None is returned in this case.
+    workers : int, optional
+        Number of threads over which the lines of the input are divided.
+        If negative, the value wraps around, so that -1 uses all CPUs. The
+        default is a single thread. Small inputs, and outputs that partially
+        overlap the input, are always processed on a single thread.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -179,15 +196,17 @@ def fourier_uniform(input, size, n=-1, axis=-1, output=None):
     input = numpy.asarray(input)
     output = _get_output_fourier(output, input)
     axis = _ni_support._check_axis(axis, input.ndim)
+    workers = _ni_support._check_workers(workers)
     sizes = _ni_support._normalize_sequence(size, input.ndim)
     sizes = numpy.asarray(sizes, dtype=numpy.float64)
     if not sizes.flags.contiguous:
         sizes = sizes.copy()
-    _nd_image.fourier_filter(input, sizes, n, axis, output, 1)
+    _nd_image.fourier_filter(input, sizes, n, axis, output, 1, workers)
     return output
 
 
-def fourier_ellipsoid(input, size, n=-1, axis=-1, output=None):
+def fourier_ellipsoid(input, size, n=-1, axis=-1, output=None,
+                      workers=None):
     """
     Multi-dimensional ellipsoid fourier filter.
 
@@ -213,6 +232,13 @@ def fourier_ellipsoid(input, size, n=-1, axis=-1, output=None):
     output : ndarray, optional
         If given, the result of filtering the input is placed in this array.
         None is returned in this case.
+    workers : int, optional
+        Number of threads over which the lines of the input are divided.
+        If negative, the value wraps around, so that -1 uses all CPUs. The
+        default is a single thread. Small inputs, and outputs that partially
+        overlap the input, are always processed on a single thread.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -241,15 +267,17 @@ def fourier_ellipsoid(input, size, n=-1, axis=-1, output=None):
     input = numpy.asarray(input)
     output = _get_output_fourier(output, input)
     axis = _ni_support._check_axis(axis, input.ndim)
+    workers = _ni_support._check_workers(workers)
     sizes = _ni_support._normalize_sequence(size, input.ndim)
     sizes = numpy.asarray(sizes, dtype=numpy.float64)
     if not sizes.flags.contiguous:
         sizes = sizes.copy()
-    _nd_image.fourier_filter(input, sizes, n, axis, output, 2)
+    _nd_image.fourier_filter(input, sizes, n, axis, output, 2, workers)
     return output
 
 
-def fourier_shift(input, shift, n=-1, axis=-1, output=None):
+def fourier_shift(input, shift, n=-1, axis=-1, output=None,
+                  workers=None):
     """
     Multi-dimensional fourier shift filter.
 
@@ -274,6 +302,13 @@ def fourier_shift(input, shift, n=-1, axis=-1, output=None):
     output : ndarray, optional
         If given, the result of shifting the input is placed in this array.
         None is returned in this case.
+    workers : int, optional
+        Number of threads over which the lines of the input are divided.
+        If negative, the value wraps around, so that -1 uses all CPUs. The
+        default is a single thread. Small inputs, and outputs that partially
+        overlap the input, are always processed on a single thread.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -298,9 +333,10 @@ def fourier_shift(input, shift, n=-1, axis=-1, output=None):
     input = numpy.asarray(input)
     output = _get_output_fourier_complex(output, input)
     axis = _ni_support._check_axis(axis, input.ndim)
+    workers = _ni_support._check_workers(workers)
     shifts = _ni_support._normalize_sequence(shift, input.ndim)
     shifts = numpy.asarray(shifts, dtype=numpy.float64)
     if not shifts.flags.contiguous:
         shifts = shifts.copy()
-    _nd_image.fourier_shift(input, shifts, n, axis, output)
+    _nd_image.fourier_shift(input, shifts, n, axis, output, workers)
     return output
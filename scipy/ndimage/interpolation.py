@@ -53,7 +53,7 @@ __all__ = ['spline_filter1d', 'spline_filter', 'geometric_transform',
 
 @docfiller
 def spline_filter1d(input, order=3, axis=-1, output=numpy.float64,
-                    mode='mirror'):
+                    mode='mirror', workers=None):
     """
     Calculate a one-dimensional spline filter along the given axis.
 
@@ -72,6 +72,7 @@ def spline_filter1d(input, order=3, axis=-1, output=numpy.float64,
         The array in which to place the output, or the dtype of the returned
         array. Default is ``numpy.float64``.
     %(mode)s
+    %(workers)s
 
     Returns
     -------
@@ -101,11 +102,13 @@ def spline_filter1d(input, order=3, axis=-1, output=numpy.float64,
     else:
         mode = _ni_support._extend_mode_to_code(mode)
         axis = _ni_support._check_axis(axis, input.ndim)
-        _nd_image.spline_filter1d(input, order, axis, output, mode)
+        workers = _ni_support._check_workers(workers)
+        _nd_image.spline_filter1d(input, order, axis, output, mode, workers)
     return output
 
 
-def spline_filter(input, order=3, output=numpy.float64, mode='mirror'):
+def spline_filter(input, order=3, output=numpy.float64, mode='mirror',
+                  workers=None):
     """
     Multi-dimensional spline filter.
 
@@ -132,7 +135,8 @@ def spline_filter(input, order=3, output=numpy.float64, mode='mirror'):
     output = _ni_support._get_output(output, input)
     if order not in [0, 1] and input.ndim > 0:
         for axis in range(input.ndim):
-            spline_filter1d(input, order, axis, output=output, mode=mode)
+            spline_filter1d(input, order, axis, output=output, mode=mode,
+                            workers=workers)
             input = output
     else:
         output[...] = input[...]
@@ -259,13 +263,13 @@ def geometric_transform(input, mapping, output_shape=None,
     output = _ni_support._get_output(output, input, shape=output_shape)
     _nd_image.geometric_transform(filtered, mapping, None, None, None, output,
                                   order, mode, cval, extra_arguments,
-                                  extra_keywords)
+                                  extra_keywords, 1)
     return output
 
 
 @docfiller
 def map_coordinates(input, coordinates, output=None, order=3,
-                    mode='constant', cval=0.0, prefilter=True):
+                    mode='constant', cval=0.0, prefilter=True, workers=None):
     """
     Map the input array to new coordinates by interpolation.
 
@@ -291,6 +295,7 @@ def map_coordinates(input, coordinates, output=None, order=3,
     %(mode)s
     %(cval)s
     %(prefilter)s
+    %(workers)s
 
     Returns
     -------
@@ -340,21 +345,24 @@ def map_coordinates(input, coordinates, output=None, order=3,
     if coordinates.shape[0] != input.ndim:
         raise RuntimeError('invalid shape for coordinate array')
     mode = _ni_support._extend_mode_to_code(mode)
+    workers = _ni_support._check_workers(workers)
     if prefilter and order > 1:
-        filtered = spline_filter(input, order, output=numpy.float64)
+        filtered = spline_filter(input, order, output=numpy.float64,
+                                 workers=workers)
     else:
         filtered = input
     output = _ni_support._get_output(output, input,
                                      shape=output_shape)
     _nd_image.geometric_transform(filtered, None, coordinates, None, None,
-                                  output, order, mode, cval, None, None)
+                                  output, order, mode, cval, None, None,
+                                  workers)
     return output
 
 
 @docfiller
 def affine_transform(input, matrix, offset=0.0, output_shape=None,
                      output=None, order=3,
-                     mode='constant', cval=0.0, prefilter=True):
+                     mode='constant', cval=0.0, prefilter=True, workers=None):
     """
     Apply an affine transformation.
 
@@ -403,6 +411,7 @@ def affine_transform(input, matrix, offset=0.0, output_shape=None,
     %(mode)s
     %(cval)s
     %(prefilter)s
+    %(workers)s
 
     Returns
     -------
@@ -440,8 +449,10 @@ def affine_transform(input, matrix, offset=0.0, output_shape=None,
     if input.ndim < 1 or len(output_shape) < 1:
         raise RuntimeError('input and output rank must be > 0')
     mode = _ni_support._extend_mode_to_code(mode)
+    workers = _ni_support._check_workers(workers)
     if prefilter and order > 1:
-        filtered = spline_filter(input, order, output=numpy.float64)
+        filtered = spline_filter(input, order, output=numpy.float64,
+                                 workers=workers)
     else:
         filtered = input
     output = _ni_support._get_output(output, input,
@@ -480,16 +491,25 @@ def affine_transform(input, matrix, offset=0.0, output_shape=None,
             "scipy 0.18.0."
         )
         _nd_image.zoom_shift(filtered, matrix, offset/matrix, output, order,
-                             mode, cval)
+                             mode, cval, workers)
     else:
         _nd_image.geometric_transform(filtered, None, None, matrix, offset,
-                                      output, order, mode, cval, None, None)
+                                      output, order, mode, cval, None, None,
+                                      workers)
     return output
 
 
+def _prefilter_type(input, precision):
+    """The type of the prefiltered array for the given precision."""
+    single = _ni_support._check_precision(precision)
+    if single and input.dtype == numpy.float32:
+        return numpy.float32
+    return numpy.float64
+
+
 @docfiller
 def shift(input, shift, output=None, order=3, mode='constant', cval=0.0,
-          prefilter=True):
+          prefilter=True, workers=None, precision='double'):
     """
     Shift an array.
 
@@ -510,6 +530,15 @@ def shift(input, shift, output=None, order=3, mode='constant', cval=0.0,
     %(mode)s
     %(cval)s
     %(prefilter)s
+    %(workers)s
+    precision : {'double', 'single'}, optional
+        The type of the temporary array of prefiltered values. The default,
+        'double', prefilters into ``float64``. 'single' prefilters a
+        ``float32`` input into ``float32``, which halves the memory traffic
+        of the interpolation at the cost of accuracy; other inputs are
+        always prefiltered into ``float64``.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -525,8 +554,11 @@ def shift(input, shift, output=None, order=3, mode='constant', cval=0.0,
     if input.ndim < 1:
         raise RuntimeError('input and output rank must be > 0')
     mode = _ni_support._extend_mode_to_code(mode)
+    workers = _ni_support._check_workers(workers)
+    prefilter_type = _prefilter_type(input, precision)
     if prefilter and order > 1:
-        filtered = spline_filter(input, order, output=numpy.float64)
+        filtered = spline_filter(input, order, output=prefilter_type,
+                                 workers=workers)
     else:
         filtered = input
     output = _ni_support._get_output(output, input)
@@ -535,13 +567,14 @@ def shift(input, shift, output=None, order=3, mode='constant', cval=0.0,
     shift = numpy.asarray(shift, dtype=numpy.float64)
     if not shift.flags.contiguous:
         shift = shift.copy()
-    _nd_image.zoom_shift(filtered, None, shift, output, order, mode, cval)
+    _nd_image.zoom_shift(filtered, None, shift, output, order, mode, cval,
+                         workers)
     return output
 
 
 @docfiller
 def zoom(input, zoom, output=None, order=3, mode='constant', cval=0.0,
-         prefilter=True):
+         prefilter=True, workers=None, precision='double'):
     """
     Zoom an array.
 
@@ -560,6 +593,15 @@ def zoom(input, zoom, output=None, order=3, mode='constant', cval=0.0,
     %(mode)s
     %(cval)s
     %(prefilter)s
+    %(workers)s
+    precision : {'double', 'single'}, optional
+        The type of the temporary array of prefiltered values. The default,
+        'double', prefilters into ``float64``. 'single' prefilters a
+        ``float32`` input into ``float32``, which halves the memory traffic
+        of the interpolation at the cost of accuracy; other inputs are
+        always prefiltered into ``float64``.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -594,8 +636,11 @@ def zoom(input, zoom, output=None, order=3, mode='constant', cval=0.0,
     if input.ndim < 1:
         raise RuntimeError('input and output rank must be > 0')
     mode = _ni_support._extend_mode_to_code(mode)
+    workers = _ni_support._check_workers(workers)
+    prefilter_type = _prefilter_type(input, precision)
     if prefilter and order > 1:
-        filtered = spline_filter(input, order, output=numpy.float64)
+        filtered = spline_filter(input, order, output=prefilter_type,
+                                 workers=workers)
     else:
         filtered = input
     zoom = _ni_support._normalize_sequence(zoom, input.ndim)
@@ -612,13 +657,14 @@ def zoom(input, zoom, output=None, order=3, mode='constant', cval=0.0,
     output = _ni_support._get_output(output, input,
                                      shape=output_shape)
     zoom = numpy.ascontiguousarray(zoom)
-    _nd_image.zoom_shift(filtered, zoom, None, output, order, mode, cval)
+    _nd_image.zoom_shift(filtered, zoom, None, output, order, mode, cval,
+                         workers)
     return output
 
 
 @docfiller
 def rotate(input, angle, axes=(1, 0), reshape=True, output=None, order=3,
-           mode='constant', cval=0.0, prefilter=True):
+           mode='constant', cval=0.0, prefilter=True, workers=None):
     """
     Rotate an array.
 
@@ -643,6 +689,7 @@ def rotate(input, angle, axes=(1, 0), reshape=True, output=None, order=3,
     %(mode)s
     %(cval)s
     %(prefilter)s
+    %(workers)s
 
     Returns
     -------
@@ -727,7 +774,7 @@ def rotate(input, angle, axes=(1, 0), reshape=True, output=None, order=3,
 
     if ndim <= 2:
         affine_transform(input_arr, rot_matrix, offset, output_shape, output,
-                         order, mode, cval, prefilter)
+                         order, mode, cval, prefilter, workers)
     else:
         # If ndim > 2, the rotation is applied over all the planes
         # parallel to axes
@@ -741,6 +788,6 @@ def rotate(input, angle, axes=(1, 0), reshape=True, output=None, order=3,
             ia = input_arr[coordinates]
             oa = output[coordinates]
             affine_transform(ia, rot_matrix, offset, out_plane_shape,
-                             oa, order, mode, cval, prefilter)
+                             oa, order, mode, cval, prefilter, workers)
 
     return output
@@ -40,10 +40,10 @@ from . import morphology
 __all__ = ['label', 'find_objects', 'labeled_comprehension', 'sum', 'mean',
            'variance', 'standard_deviation', 'minimum', 'maximum', 'median',
            'minimum_position', 'maximum_position', 'extrema', 'center_of_mass',
-           'histogram', 'watershed_ift']
+           'labeled_statistics', 'histogram', 'watershed_ift']
 
 
-def label(input, structure=None, output=None):
+def label(input, structure=None, output=None, workers=None):
     """
     Label features in an array.
 
@@ -73,6 +73,14 @@ def label(input, structure=None, output=None):
         operate in-place, by passing output=input.
         Note that the output must be able to store the largest label, or this
         function will raise an Exception.
+    workers : int, optional
+        Number of threads over which the slabs of the first axis are
+        labeled, before the labels of their faces are joined. If negative,
+        the value wraps around, so that -1 uses all CPUs. The default is a
+        single thread. Only 32 and 64 bit integer outputs in C order, that
+        do not partially overlap the input, are labeled on several threads.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -100,6 +108,9 @@ def label(input, structure=None, output=None):
     A centrosymmetric matrix is a matrix that is symmetric about the center.
     See [1]_ for more information.
 
+    The features are numbered in the order of their first element, in the
+    order of the elements in memory, for any number of `workers`.
+
     The `structure` matrix must be centrosymmetric to ensure
     two-way connections.
     For instance, if the `structure` matrix is not centrosymmetric
@@ -217,6 +228,22 @@ def label(input, structure=None, output=None):
         else:
             return output, maxlabel
 
+    workers = _ni_support._check_workers(workers)
+    if (workers > 1 and output.flags.c_contiguous and
+            output.dtype.kind in 'iu' and
+            (output.itemsize == 8 or
+             (output.itemsize == 4 and not need_64bits)) and
+            input.dtype.char in numpy.typecodes['AllInteger'] + '?fd' and
+            (output is input or not numpy.may_share_memory(input, output)) and
+            numpy.array_equal(structure,
+                              structure[(slice(None, None, -1),) *
+                                        structure.ndim])):
+        max_label = _nd_image.label(input, structure, output, workers)
+        if caller_provided_output:
+            return max_label
+        else:
+            return output, max_label
+
     try:
         max_label = _ni_label._label(input, structure, output)
     except _ni_label.NeedMoreBits:
@@ -1364,6 +1391,185 @@ def center_of_mass(input, labels=None, index=None):
     return [tuple(v) for v in numpy.array(results).T]
 
 
+_LABELED_STATISTICS = ('count', 'sum', 'mean', 'variance',
+                       'standard_deviation', 'minimum', 'maximum',
+                       'center_of_mass', 'bounding_box')
+
+
+def labeled_statistics(input, labels=None, index=None,
+                       statistics=('count', 'sum', 'mean'), workers=None):
+    """
+    Calculate several statistics of the values of an array at labels.
+
+    All the requested statistics are measured in a single pass over
+    `input`, instead of a pass for each of `sum`, `mean`, `variance`,
+    `minimum`, `maximum`, `center_of_mass` and `find_objects`.
+
+    Parameters
+    ----------
+    input : array_like
+        Values of the elements to measure.
+    labels : array_like, optional
+        Labels of the elements of `input`, broadcast against it. If not
+        given, all the elements of `input` are measured together.
+    index : int or sequence of ints, optional
+        Labels of the regions to measure. If not given, all the elements
+        where `labels` is greater than zero are measured together.
+    statistics : str or sequence of str, optional
+        Statistics to measure, from 'count', 'sum', 'mean', 'variance',
+        'standard_deviation', 'minimum', 'maximum', 'center_of_mass' and
+        'bounding_box'. Default is ('count', 'sum', 'mean').
+    workers : int, optional
+        Number of threads over which the elements are divided, each with
+        its own statistics, which are merged at the end. If negative, the
+        value wraps around, so that -1 uses all CPUs. The default is a
+        single thread.
+
+    Returns
+    -------
+    statistics : dict
+        The requested statistics by name. Each has the shape of `index`,
+        with a trailing axis of length ``input.ndim`` for 'center_of_mass',
+        and trailing axes of shape ``(2, input.ndim)`` for 'bounding_box',
+        which holds the first and one past the last coordinates of each
+        region along each axis. Regions without any elements have a count
+        and a sum of 0, an empty bounding box, and NaN for the other
+        statistics.
+
+    See Also
+    --------
+    sum, mean, variance, standard_deviation, minimum, maximum,
+    center_of_mass, find_objects
+
+    Notes
+    -----
+    The variance is accumulated with the updates of Welford [1]_, which are
+    merged between threads as in [2]_, so that it does not lose the
+    accuracy of the two passes of `variance`. The sums of the threads are
+    added at the end, and so may differ from those of one thread in the
+    last bits.
+
+    References
+    ----------
+    .. [1] B. P. Welford, "Note on a method for calculating corrected sums
+           of squares and products", Technometrics 4, 419-420, 1962.
+    .. [2] T. F. Chan, G. H. Golub and R. J. LeVeque, "Updating formulae
+           and a pairwise algorithm for computing sample variances",
+           Technical Report STAN-CS-79-773, Stanford University, 1979.
+
+    Examples
+    --------
+    >>> from scipy import ndimage
+    >>> a = np.array([[1, 2, 0, 0],
+    ...               [5, 3, 0, 4],
+    ...               [0, 0, 0, 7],
+    ...               [9, 3, 0, 0]])
+    >>> lbl, n = ndimage.label(a)
+    >>> stats = ndimage.labeled_statistics(a, lbl, np.arange(1, n + 1),
+    ...                                    ['sum', 'maximum'])
+    >>> stats['sum']
+    array([ 11.,  11.,  12.])
+    >>> stats['maximum']
+    array([ 5.,  7.,  9.])
+
+    """
+    if isinstance(statistics, str):
+        statistics = [statistics]
+    statistics = list(statistics)
+    for name in statistics:
+        if name not in _LABELED_STATISTICS:
+            raise ValueError('unknown statistic {!r}'.format(name))
+    input = numpy.asarray(input)
+    if numpy.iscomplexobj(input):
+        raise TypeError('Complex type not supported')
+    if input.dtype.char not in numpy.typecodes['AllInteger'] + '?fd':
+        input = input.astype(numpy.float64)
+    workers = _ni_support._check_workers(workers)
+
+    scalar = labels is None or index is None or numpy.isscalar(index)
+    if labels is None:
+        index = numpy.zeros(1, numpy.intp)
+    else:
+        input, labels = numpy.broadcast_arrays(input, labels)
+        if index is None:
+            labels = labels > 0
+            index = numpy.ones(1, numpy.intp)
+        else:
+            index = numpy.asarray(index)
+            if not _safely_castable_to_int(labels.dtype):
+                # number the labels, and the regions that are not there
+                # as -1
+                unique_labels, labels = numpy.unique(labels,
+                                                     return_inverse=True)
+                labels = labels.reshape(input.shape)
+                idxs = numpy.searchsorted(unique_labels, index)
+                idxs[idxs >= unique_labels.size] = 0
+                found = unique_labels[idxs] == index
+                index = numpy.where(found, idxs, -1)
+    shape = () if scalar else index.shape
+    index = numpy.asarray(index, numpy.intp).ravel()
+
+    # the bins are the range of labels from the smallest in the index,
+    # unless that range is much larger than the index
+    sorted_index = None
+    min_label = 0
+    if index.size == 0:
+        positions = index
+    elif index.max() - index.min() < 4 * index.size + 1024:
+        min_label = index.min()
+        positions = index - min_label
+    else:
+        sorted_index, positions = numpy.unique(index, return_inverse=True)
+    nbins = (positions.max() + 1) if positions.size else 0
+
+    def stat(wanted, shape=(), dtype=numpy.float64):
+        if wanted:
+            return numpy.zeros((nbins,) + shape, dtype)
+        return None
+
+    wanted = set(statistics)
+    centered = bool(wanted & {'variance', 'standard_deviation'})
+    extrema = bool(wanted & {'minimum', 'maximum'})
+    counts = stat(True, dtype=numpy.intp)
+    sums = stat(wanted & {'sum', 'mean', 'center_of_mass'})
+    means = stat(centered)
+    m2s = stat(centered)
+    minima = stat(extrema)
+    maxima = stat(extrema)
+    moments = stat('center_of_mass' in wanted, (input.ndim,))
+    bounds = stat('bounding_box' in wanted, (2, input.ndim), numpy.intp)
+    _nd_image.labeled_statistics(input, labels, sorted_index, min_label,
+                                 nbins, counts, sums, means, m2s, minima,
+                                 maxima, moments, bounds, workers)
+
+    empty = counts == 0
+    results = {}
+    with numpy.errstate(invalid='ignore', divide='ignore'):
+        for name in statistics:
+            if name == 'count':
+                value = counts
+            elif name == 'sum':
+                value = sums
+            elif name == 'mean':
+                value = sums / counts
+            elif name == 'variance':
+                value = numpy.where(empty, numpy.nan, m2s / counts)
+            elif name == 'standard_deviation':
+                value = numpy.where(empty, numpy.nan,
+                                    numpy.sqrt(m2s / counts))
+            elif name == 'minimum':
+                value = numpy.where(empty, numpy.nan, minima)
+            elif name == 'maximum':
+                value = numpy.where(empty, numpy.nan, maxima)
+            elif name == 'center_of_mass':
+                value = moments / sums[:, None]
+            else:
+                value = bounds
+            value = value[positions]
+            results[name] = value.reshape(shape + value.shape[1:])[()]
+    return results
+
+
 def histogram(input, min, max, bins, labels=None, index=None):
     """
     Calculate the histogram of the values of an array, optionally at labels.
@@ -1425,14 +1631,16 @@ def histogram(input, min, max, bins, labels=None, index=None):
                                  pass_positions=False)
 
 
-def watershed_ift(input, markers, structure=None, output=None):
+def watershed_ift(input, markers, structure=None, output=None, workers=None):
     """
     Apply watershed from markers using image foresting transform algorithm.
 
     Parameters
     ----------
     input : array_like
-        Input.
+        Input. Unsigned 8 and 16 bit inputs are used as they are, while
+        floating point inputs are quantized to 65536 levels between their
+        minimum and maximum.
     markers : array_like
         Markers are points within each watershed that form the beginning
         of the process.  Negative markers are considered background markers
@@ -1443,12 +1651,28 @@ def watershed_ift(input, markers, structure=None, output=None):
         connectivity equal to one.
     output : ndarray, optional
         An output array can optionally be provided.  The same shape as input.
+    workers : int, optional
+        Number of threads over which slabs along the first axis are
+        flooded, after which a flood from the faces between the slabs
+        joins the basins. The cost of every element is then the same as
+        with a single thread, but an element reached at equal cost from
+        two markers may take the label of either. If negative, the value
+        wraps around, so that -1 uses all CPUs. The default is a single
+        thread.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
     watershed_ift : ndarray
         Output.  Same shape as `input`.
 
+    Notes
+    -----
+    All the memory is taken up front: 32 bytes per element of `input`,
+    and for every thread a queue of 16 bytes per possible cost, that is
+    4 kB for 8 bit and 1 MB for 16 bit and floating point inputs.
+
     References
     ----------
     .. [1] A.X. Falcao, J. Stolfi and R. de Alencar Lotufo, "The image
@@ -1457,8 +1681,11 @@ def watershed_ift(input, markers, structure=None, output=None):
 
     """
     input = numpy.asarray(input)
+    if input.dtype.kind == 'f':
+        input = _quantize_levels(input)
     if input.dtype.type not in [numpy.uint8, numpy.uint16]:
-        raise TypeError('only 8 and 16 unsigned inputs are supported')
+        raise TypeError('only 8 and 16 unsigned and floating point inputs '
+                        'are supported')
 
     if structure is None:
         structure = morphology.generate_binary_structure(input.ndim, 1)
@@ -1493,6 +1720,19 @@ def watershed_ift(input, markers, structure=None, output=None):
     else:
         output = markers.dtype
 
+    workers = _ni_support._check_workers(workers)
     output = _ni_support._get_output(output, input)
-    _nd_image.watershed_ift(input, markers, structure, output)
+    _nd_image.watershed_ift(input, markers, structure, output, workers)
     return output
+
+
+def _quantize_levels(input):
+    """Map a floating point array linearly onto 16 bit levels."""
+    input = numpy.asarray(input, dtype=numpy.float64)
+    if input.size == 0:
+        return numpy.zeros(input.shape, numpy.uint16)
+    lo, hi = input.min(), input.max()
+    if not (numpy.isfinite(lo) and numpy.isfinite(hi)):
+        raise ValueError('input must be finite')
+    scale = 65535.0 / (hi - lo) if hi > lo else 0.0
+    return numpy.rint((input - lo) * scale).astype(numpy.uint16)
@@ -214,7 +214,7 @@ def generate_binary_structure(rank, connectivity):
 
 
 def _binary_erosion(input, structure, iterations, mask, output,
-                    border_value, origin, invert, brute_force):
+                    border_value, origin, invert, brute_force, workers=None):
     try:
         iterations = operator.index(iterations)
     except TypeError:
@@ -245,8 +245,18 @@ def _binary_erosion(input, structure, iterations, mask, output,
     else:
         output = bool
     output = _ni_support._get_output(output, input)
-
-    if iterations == 1:
+    workers = _ni_support._check_workers(workers)
+
+    # The bit-packed engine runs every iteration over the whole array, 64
+    # elements to a word. Repeated erosions on a single thread instead
+    # revisit only the neighbors of the elements that last changed.
+    if input.ndim > 0 and (iterations == 1 or not cit or brute_force or
+                           workers > 1):
+        _nd_image.binary_erosion_packed(input, structure, mask, output,
+                                        border_value, origin, invert,
+                                        iterations, workers)
+        return output
+    elif iterations == 1:
         _nd_image.binary_erosion(input, structure, mask, output,
                                  border_value, origin, invert, cit, 0)
         return output
@@ -286,7 +296,8 @@ def _binary_erosion(input, structure, iterations, mask, output,
 
 
 def binary_erosion(input, structure=None, iterations=1, mask=None, output=None,
-                   border_value=0, origin=0, brute_force=False):
+                   border_value=0, origin=0, brute_force=False,
+                   workers=None):
     """
     Multi-dimensional binary erosion with a given structuring element.
 
@@ -322,6 +333,12 @@ def binary_erosion(input, structure=None, iterations=1, mask=None, output=None,
         the current iteration; if True all pixels are considered as candidates
         for erosion, regardless of what happened in the previous iteration.
         False by default.
+    workers : int, optional
+        Number of threads over which the rows of the bit-packed array are
+        divided. If negative, the value wraps around, so that -1 uses all
+        CPUs. The default is a single thread.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -379,12 +396,13 @@ def binary_erosion(input, structure=None, iterations=1, mask=None, output=None,
 
     """
     return _binary_erosion(input, structure, iterations, mask,
-                           output, border_value, origin, 0, brute_force)
+                           output, border_value, origin, 0, brute_force,
+                           workers)
 
 
 def binary_dilation(input, structure=None, iterations=1, mask=None,
                     output=None, border_value=0, origin=0,
-                    brute_force=False):
+                    brute_force=False, workers=None):
     """
     Multi-dimensional binary dilation with the given structuring element.
 
@@ -418,6 +436,12 @@ def binary_dilation(input, structure=None, iterations=1, mask=None,
         in the current iteration; if True all pixels are considered as
         candidates for dilation, regardless of what happened in the previous
         iteration. False by default.
+    workers : int, optional
+        Number of threads over which the rows of the bit-packed array are
+        divided. If negative, the value wraps around, so that -1 uses all
+        CPUs. The default is a single thread.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -511,11 +535,13 @@ def binary_dilation(input, structure=None, iterations=1, mask=None,
             origin[ii] -= 1
 
     return _binary_erosion(input, structure, iterations, mask,
-                           output, border_value, origin, 1, brute_force)
+                           output, border_value, origin, 1, brute_force,
+                           workers)
 
 
 def binary_opening(input, structure=None, iterations=1, output=None,
-                   origin=0, mask=None, border_value=0, brute_force=False):
+                   origin=0, mask=None, border_value=0, brute_force=False,
+                   workers=None):
     """
     Multi-dimensional binary opening with the given structuring element.
 
@@ -558,6 +584,12 @@ def binary_opening(input, structure=None, iterations=1, output=None,
         current iteration; if true all pixels are considered as candidates for
         update, regardless of what happened in the previous iteration.
         False by default.
+    workers : int, optional
+        Number of threads over which the rows of the bit-packed array are
+        divided. If negative, the value wraps around, so that -1 uses all
+        CPUs. The default is a single thread.
+
+        .. versionadded:: 1.4.0
 
         .. versionadded:: 1.1.0
 
@@ -632,13 +664,14 @@ def binary_opening(input, structure=None, iterations=1, output=None,
         structure = generate_binary_structure(rank, 1)
 
     tmp = binary_erosion(input, structure, iterations, mask, None,
-                         border_value, origin, brute_force)
+                         border_value, origin, brute_force, workers)
     return binary_dilation(tmp, structure, iterations, mask, output,
-                           border_value, origin, brute_force)
+                           border_value, origin, brute_force, workers)
 
 
 def binary_closing(input, structure=None, iterations=1, output=None,
-                   origin=0, mask=None, border_value=0, brute_force=False):
+                   origin=0, mask=None, border_value=0, brute_force=False,
+                   workers=None):
     """
     Multi-dimensional binary closing with the given structuring element.
 
@@ -681,6 +714,12 @@ def binary_closing(input, structure=None, iterations=1, output=None,
         current iteration; if true al pixels are considered as candidates for
         update, regardless of what happened in the previous iteration.
         False by default.
+    workers : int, optional
+        Number of threads over which the rows of the bit-packed array are
+        divided. If negative, the value wraps around, so that -1 uses all
+        CPUs. The default is a single thread.
+
+        .. versionadded:: 1.4.0
 
         .. versionadded:: 1.1.0
 
@@ -778,9 +817,9 @@ def binary_closing(input, structure=None, iterations=1, output=None,
         structure = generate_binary_structure(rank, 1)
 
     tmp = binary_dilation(input, structure, iterations, mask, None,
-                          border_value, origin, brute_force)
+                          border_value, origin, brute_force, workers)
     return binary_erosion(tmp, structure, iterations, mask, output,
-                          border_value, origin, brute_force)
+                          border_value, origin, brute_force, workers)
 
 
 def binary_hit_or_miss(input, structure1=None, structure2=None,
@@ -1108,7 +1147,8 @@ def binary_fill_holes(input, structure=None, output=None, origin=0):
 
 
 def grey_erosion(input, size=None, footprint=None, structure=None,
-                 output=None, mode="reflect", cval=0.0, origin=0):
+                 output=None, mode="reflect", cval=0.0, origin=0,
+                 workers=None):
     """
     Calculate a greyscale erosion, using either a structuring element,
     or a footprint corresponding to a flat structuring element.
@@ -1143,6 +1183,13 @@ def grey_erosion(input, size=None, footprint=None, structure=None,
     origin : scalar, optional
         The `origin` parameter controls the placement of the filter.
         Default 0
+    workers : int, optional
+        Number of threads over which the lines of the input are divided,
+        when the structuring element is flat and full, and so is applied
+        one axis at a time. If negative, the value wraps around, so that
+        -1 uses all CPUs. The default is a single thread.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -1214,11 +1261,13 @@ def grey_erosion(input, size=None, footprint=None, structure=None,
         raise ValueError("size, footprint or structure must be specified")
 
     return filters._min_or_max_filter(input, size, footprint, structure,
-                                      output, mode, cval, origin, 1)
+                                      output, mode, cval, origin, 1,
+                                      workers)
 
 
 def grey_dilation(input, size=None, footprint=None, structure=None,
-                  output=None, mode="reflect", cval=0.0, origin=0):
+                  output=None, mode="reflect", cval=0.0, origin=0,
+                  workers=None):
     """
     Calculate a greyscale dilation, using either a structuring element,
     or a footprint corresponding to a flat structuring element.
@@ -1253,6 +1302,13 @@ def grey_dilation(input, size=None, footprint=None, structure=None,
     origin : scalar, optional
         The `origin` parameter controls the placement of the filter.
         Default 0
+    workers : int, optional
+        Number of threads over which the lines of the input are divided,
+        when the structuring element is flat and full, and so is applied
+        one axis at a time. If negative, the value wraps around, so that
+        -1 uses all CPUs. The default is a single thread.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -1362,7 +1418,8 @@ def grey_dilation(input, size=None, footprint=None, structure=None,
             origin[ii] -= 1
 
     return filters._min_or_max_filter(input, size, footprint, structure,
-                                      output, mode, cval, origin, 0)
+                                      output, mode, cval, origin, 0,
+                                      workers)
 
 
 def grey_opening(input, size=None, footprint=None, structure=None,
@@ -2064,7 +2121,8 @@ def distance_transform_cdt(input, metric='chessboard', return_distances=True,
 
 
 def distance_transform_edt(input, sampling=None, return_distances=True,
-                           return_indices=False, distances=None, indices=None):
+                           return_indices=False, distances=None, indices=None,
+                           workers=None):
     """
     Exact euclidean distance transform.
 
@@ -2087,9 +2145,16 @@ def distance_transform_edt(input, sampling=None, return_distances=True,
     return_indices : bool, optional
         Whether to return indices matrix. Default is False.
     distances : ndarray, optional
-        Used for output of distance array, must be of type float64.
+        Used for output of distance array, must be of type float64 or
+        float32.
     indices : ndarray, optional
         Used for output of indices, must be of type int32.
+    workers : int, optional
+        Number of threads over which the lines of each axis are divided.
+        If negative, the value wraps around, so that -1 uses all CPUs. The
+        default is a single thread.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -2111,6 +2176,21 @@ def distance_transform_edt(input, sampling=None, return_distances=True,
     Euclidean distance to input points x[i], and n is the
     number of dimensions.
 
+    If the indices are not requested, the distances are computed as the
+    lower envelopes of parabolas along each axis in turn [1]_, directly
+    into the distance array, without the temporary index array of the
+    feature transform [2]_. A float32 `distances` array then halves the
+    memory needed.
+
+    References
+    ----------
+    .. [1] P. F. Felzenszwalb and D. P. Huttenlocher, "Distance transforms
+           of sampled functions", Theory of Computing 8, 415-428, 2012.
+    .. [2] C. R. Maurer, Jr., R. Qi and V. Raghavan, "A linear time
+           algorithm for computing exact Euclidean distance transforms of
+           binary images in arbitrary dimensions", IEEE Trans. PAMI 25,
+           265-270, 2003.
+
     Examples
     --------
     >>> from scipy import ndimage
@@ -2186,34 +2266,48 @@ def distance_transform_edt(input, sampling=None, return_distances=True,
         if not sampling.flags.contiguous:
             sampling = sampling.copy()
 
-    if ft_inplace:
-        ft = indices
-        if ft.shape != (input.ndim,) + input.shape:
-            raise RuntimeError('indices has wrong shape')
-        if ft.dtype.type != numpy.int32:
-            raise RuntimeError('indices must be of int32 type')
-    else:
-        ft = numpy.zeros((input.ndim,) + input.shape, dtype=numpy.int32)
+    workers = _ni_support._check_workers(workers)
 
-    _nd_image.euclidean_feature_transform(input, sampling, ft)
-    # if requested, calculate the distance transform
-    if return_distances:
-        dt = ft - numpy.indices(input.shape, dtype=ft.dtype)
-        dt = dt.astype(numpy.float64)
-        if sampling is not None:
-            for ii in range(len(sampling)):
-                dt[ii, ...] *= sampling[ii]
-        numpy.multiply(dt, dt, dt)
+    if dt_inplace:
+        if distances.shape != input.shape:
+            raise RuntimeError('distances has wrong shape')
+        if distances.dtype.type not in (numpy.float64, numpy.float32):
+            raise RuntimeError('distances must be of float64 or float32 '
+                               'type')
+
+    # without any background, the feature transform is not defined, and
+    # the distances are those to its (-1, ..., -1) features
+    if return_distances and not return_indices and not input.all():
         if dt_inplace:
-            dt = numpy.add.reduce(dt, axis=0)
-            if distances.shape != dt.shape:
+            dt = distances
+        else:
+            dt = numpy.zeros(input.shape, dtype=numpy.float64)
+        _nd_image.euclidean_distance_transform(input, sampling, dt, workers)
+        numpy.sqrt(dt, dt)
+    else:
+        if ft_inplace:
+            ft = indices
+            if ft.shape != (input.ndim,) + input.shape:
                 raise RuntimeError('indices has wrong shape')
-            if distances.dtype.type != numpy.float64:
-                raise RuntimeError('indices must be of float64 type')
-            numpy.sqrt(dt, distances)
+            if ft.dtype.type != numpy.int32:
+                raise RuntimeError('indices must be of int32 type')
         else:
+            ft = numpy.zeros((input.ndim,) + input.shape, dtype=numpy.int32)
+
+        _nd_image.euclidean_feature_transform(input, sampling, ft, workers)
+        # if requested, calculate the distance transform
+        if return_distances:
+            dt = ft - numpy.indices(input.shape, dtype=ft.dtype)
+            dt = dt.astype(numpy.float64)
+            if sampling is not None:
+                for ii in range(len(sampling)):
+                    dt[ii, ...] *= sampling[ii]
+            numpy.multiply(dt, dt, dt)
             dt = numpy.add.reduce(dt, axis=0)
-            dt = numpy.sqrt(dt)
+            if dt_inplace:
+                numpy.sqrt(dt, distances)
+            else:
+                dt = numpy.sqrt(dt)
 
     # construct and return the result
     result = []
@@ -6,6 +6,7 @@ from numpy.distutils.core import setup
 from numpy.distutils.misc_util import Configuration
 from numpy import get_include
 from scipy._build_utils import numpy_nodepr_api
+from scipy._build_utils.compiler_helper import set_c_threads_flags_hook
 
 
 def configuration(parent_package='', top_path=None):
@@ -16,7 +17,7 @@ def configuration(parent_package='', top_path=None):
                     get_include(),
                     os.path.join(os.path.dirname(__file__), '..', '_lib', 'src')]
 
-    config.add_extension("_nd_image",
+    ext = config.add_extension("_nd_image",
         sources=["src/nd_image.c",
                  "src/ni_filters.c",
                  "src/ni_fourier.c",
@@ -25,8 +26,10 @@ def configuration(parent_package='', top_path=None):
                  "src/ni_morphology.c",
                  "src/ni_splines.c",
                  "src/ni_support.c"],
+        depends=["src/ni_threads.h"],
         include_dirs=include_dirs,
         **numpy_nodepr_api)
+    ext._pre_build_hook = set_c_threads_flags_hook
 
     # Cython wants the .c and .pyx to have the underscore.
     config.add_extension("_ni_label",
@@ -142,6 +142,109 @@ py_filter2d(PyObject *obj, PyObject *args)
 }
 
 
+#ifndef OLDAPI
+static int
+_filter1d_batched(double *input_lines, npy_intp input_length,
+		  double *output_lines, npy_intp output_length,
+		  npy_intp n_lines, void *callback_data)
+{
+    npy_intp k;
+
+    for (k = 0; k < n_lines; k++) {
+	_filter1d(input_lines + k*input_length, input_length,
+		  output_lines + k*output_length, output_length,
+		  callback_data);
+    }
+    return 1;
+}
+
+
+static PyObject *
+py_filter1d_batched(PyObject *obj, PyObject *args)
+{
+    npy_intp *callback_data = NULL;
+    PyObject *capsule = NULL;
+
+    callback_data = PyMem_Malloc(sizeof(npy_intp));
+    if (!callback_data) {
+	PyErr_NoMemory();
+	goto error;
+    }
+    if (!PyArg_ParseTuple(args, "n", callback_data)) goto error;
+
+    capsule = PyCapsule_New(_filter1d_batched,
+			    "int (double *, npy_intp, double *, npy_intp, "
+			    "npy_intp, void *)", _destructor);
+    if (!capsule) goto error;
+    if (PyCapsule_SetContext(capsule, callback_data) != 0) {
+	Py_DECREF(capsule);
+	goto error;
+    }
+    return capsule;
+ error:
+    PyMem_Free(callback_data);
+    return NULL;
+}
+
+
+static int
+_filter2d_batched(double *buffer, npy_intp filter_size, npy_intp n_elements,
+		  double *res, void *callback_data)
+{
+    npy_intp k;
+
+    for (k = 0; k < n_elements; k++) {
+	_filter2d(buffer + k*filter_size, filter_size, res + k,
+		  callback_data);
+    }
+    return 1;
+}
+
+
+static PyObject *
+py_filter2d_batched(PyObject *obj, PyObject *args)
+{
+    Py_ssize_t i, size;
+    double *callback_data = NULL;
+    PyObject *seq = NULL, *item = NULL, *capsule = NULL;
+
+    if (!PyArg_ParseTuple(args, "O", &seq)) goto error;
+
+    size = PySequence_Length(seq);
+    if (size == -1) goto error;
+    callback_data = PyMem_Malloc(size*sizeof(double));
+    if (!callback_data) {
+	PyErr_NoMemory();
+	goto error;
+    }
+
+    for (i = 0; i < size; i++) {
+	item = PySequence_GetItem(seq, i);
+	if (!item) {
+	    PyErr_SetString(PyExc_IndexError, "failed to get item");
+	    goto error;
+	}
+	callback_data[i] = PyFloat_AsDouble(item);
+	Py_DECREF(item);
+	if (PyErr_Occurred()) goto error;
+    }
+
+    capsule = PyCapsule_New(_filter2d_batched,
+			    "int (double *, npy_intp, npy_intp, double *, "
+			    "void *)", _destructor);
+    if (!capsule) goto error;
+    if (PyCapsule_SetContext(capsule, callback_data) != 0) {
+	Py_DECREF(capsule);
+	goto error;
+    }
+    return capsule;
+ error:
+    PyMem_Free(callback_data);
+    return NULL;
+}
+#endif
+
+
 static int
 _transform(npy_intp *output_coordinates, double *input_coordinates,
 	   npy_intp output_rank, npy_intp input_rank, void *callback_data)
@@ -190,6 +293,10 @@ static PyMethodDef _CTestMethods[] = {
     {"transform", (PyCFunction)py_transform, METH_VARARGS, ""},
     {"filter1d", (PyCFunction)py_filter1d, METH_VARARGS, ""},
     {"filter2d", (PyCFunction)py_filter2d, METH_VARARGS, ""},
+#ifndef OLDAPI
+    {"filter1d_batched", (PyCFunction)py_filter1d_batched, METH_VARARGS, ""},
+    {"filter2d_batched", (PyCFunction)py_filter2d_batched, METH_VARARGS, ""},
+#endif
     {NULL, NULL, 0, NULL}
 };
 				      
@@ -188,16 +188,17 @@ static PyObject *Py_Correlate1D(PyObject *obj, PyObject *args)
     int axis, mode;
     double cval;
     npy_intp origin;
+    int workers, single;
 
-    if (!PyArg_ParseTuple(args, "O&O&iO&idn" ,
+    if (!PyArg_ParseTuple(args, "O&O&iO&idnii" ,
                           NI_ObjectToInputArray, &input,
                           NI_ObjectToInputArray, &weights, &axis,
                           NI_ObjectToOutputArray, &output, &mode, &cval,
-                          &origin))
+                          &origin, &workers, &single))
         goto exit;
 
     NI_Correlate1D(input, weights, axis, output, (NI_ExtendMode)mode, cval,
-                   origin);
+                   origin, workers, single);
     #ifdef HAVE_WRITEBACKIFCOPY
         PyArray_ResolveWritebackIfCopy(output);
     #endif
@@ -213,14 +214,14 @@ static PyObject *Py_Correlate(PyObject *obj, PyObject *args)
 {
     PyArrayObject *input = NULL, *output = NULL, *weights = NULL;
     PyArray_Dims origin = {NULL, 0};
-    int mode;
+    int mode, workers;
     double cval;
 
-    if (!PyArg_ParseTuple(args, "O&O&O&idO&", NI_ObjectToInputArray, &input,
+    if (!PyArg_ParseTuple(args, "O&O&O&idO&i", NI_ObjectToInputArray, &input,
                           NI_ObjectToInputArray, &weights,
                           NI_ObjectToOutputArray, &output,
                           &mode, &cval,
-                          PyArray_IntpConverter, &origin)) {
+                          PyArray_IntpConverter, &origin, &workers)) {
         goto exit;
     }
     if (!_validate_origin(input, origin)) {
@@ -228,7 +229,7 @@ static PyObject *Py_Correlate(PyObject *obj, PyObject *args)
     }
 
     NI_Correlate(input, weights, output, (NI_ExtendMode)mode, cval,
-                 origin.ptr);
+                 origin.ptr, workers);
     #ifdef HAVE_WRITEBACKIFCOPY
         PyArray_ResolveWritebackIfCopy(output);
     #endif
@@ -244,19 +245,19 @@ exit:
 static PyObject *Py_UniformFilter1D(PyObject *obj, PyObject *args)
 {
     PyArrayObject *input = NULL, *output = NULL;
-    int axis, mode;
+    int axis, mode, workers;
     npy_intp filter_size, origin;
     double cval;
 
-    if (!PyArg_ParseTuple(args, "O&niO&idn",
+    if (!PyArg_ParseTuple(args, "O&niO&idni",
                           NI_ObjectToInputArray, &input,
                           &filter_size, &axis,
                           NI_ObjectToOutputArray, &output,
-                          &mode, &cval, &origin))
+                          &mode, &cval, &origin, &workers))
         goto exit;
 
     NI_UniformFilter1D(input, filter_size, axis, output, (NI_ExtendMode)mode,
-                       cval, origin);
+                       cval, origin, workers);
     #ifdef HAVE_WRITEBACKIFCOPY
         PyArray_ResolveWritebackIfCopy(output);
     #endif
@@ -270,19 +271,19 @@ exit:
 static PyObject *Py_MinOrMaxFilter1D(PyObject *obj, PyObject *args)
 {
     PyArrayObject *input = NULL, *output = NULL;
-    int axis, mode, minimum;
+    int axis, mode, minimum, workers;
     npy_intp filter_size, origin;
     double cval;
 
-    if (!PyArg_ParseTuple(args, "O&niO&idni",
+    if (!PyArg_ParseTuple(args, "O&niO&idnii",
                           NI_ObjectToInputArray, &input,
                           &filter_size, &axis,
                           NI_ObjectToOutputArray, &output,
-                          &mode, &cval, &origin, &minimum))
+                          &mode, &cval, &origin, &minimum, &workers))
         goto exit;
 
     NI_MinOrMaxFilter1D(input, filter_size, axis, output, (NI_ExtendMode)mode,
-                        cval, origin, minimum);
+                        cval, origin, minimum, workers);
     #ifdef HAVE_WRITEBACKIFCOPY
         PyArray_ResolveWritebackIfCopy(output);
     #endif
@@ -334,15 +335,15 @@ static PyObject *Py_RankFilter(PyObject *obj, PyObject *args)
 {
     PyArrayObject *input = NULL, *output = NULL, *footprint = NULL;
     PyArray_Dims origin = {NULL, 0};
-    int mode, rank;
+    int mode, rank, workers;
     double cval;
 
-    if (!PyArg_ParseTuple(args, "O&iO&O&idO&",
+    if (!PyArg_ParseTuple(args, "O&iO&O&idO&i",
                           NI_ObjectToInputArray, &input, &rank,
                           NI_ObjectToInputArray, &footprint,
                           NI_ObjectToOutputArray, &output,
                           &mode, &cval,
-                          PyArray_IntpConverter, &origin)) {
+                          PyArray_IntpConverter, &origin, &workers)) {
         goto exit;
     }
     if (!_validate_origin(input, origin)) {
@@ -350,7 +351,7 @@ static PyObject *Py_RankFilter(PyObject *obj, PyObject *args)
     }
 
     NI_RankFilter(input, rank, footprint, output, (NI_ExtendMode)mode, cval,
-                  origin.ptr);
+                  origin.ptr, workers);
     #ifdef HAVE_WRITEBACKIFCOPY
         PyArray_ResolveWritebackIfCopy(output);
     #endif
@@ -404,24 +405,32 @@ static PyObject *Py_GenericFilter1D(PyObject *obj, PyObject *args)
     PyObject *fnc = NULL, *extra_arguments = NULL, *extra_keywords = NULL;
     void *func = NULL, *data = NULL;
     NI_PythonCallbackData cbdata;
-    int axis, mode;
+    int axis, mode, workers, batched = 0;
     npy_intp origin, filter_size;
     double cval;
     ccallback_t callback;
+    /* the signatures with value 1 filter a batch of lines at a time: */
     static ccallback_signature_t callback_signatures[] = {
         {"int (double *, intptr_t, double *, intptr_t, void *)"},
         {"int (double *, npy_intp, double *, npy_intp, void *)"},
+        {"int (double *, intptr_t, double *, intptr_t, intptr_t, void *)", 1},
+        {"int (double *, npy_intp, double *, npy_intp, npy_intp, void *)", 1},
 #if NPY_SIZEOF_INTP == NPY_SIZEOF_SHORT
         {"int (double *, short, double *, short, void *)"},
+        {"int (double *, short, double *, short, short, void *)", 1},
 #endif
 #if NPY_SIZEOF_INTP == NPY_SIZEOF_INT
         {"int (double *, int, double *, int, void *)"},
+        {"int (double *, int, double *, int, int, void *)", 1},
 #endif
 #if NPY_SIZEOF_INTP == NPY_SIZEOF_LONG
         {"int (double *, long, double *, long, void *)"},
+        {"int (double *, long, double *, long, long, void *)", 1},
 #endif
 #if NPY_SIZEOF_INTP == NPY_SIZEOF_LONGLONG
         {"int (double *, long long, double *, long long, void *)"},
+        {"int (double *, long long, double *, long long, long long, void *)",
+         1},
 #endif
         {NULL}
     };
@@ -429,12 +438,12 @@ static PyObject *Py_GenericFilter1D(PyObject *obj, PyObject *args)
     callback.py_function = NULL;
     callback.c_function = NULL;
 
-    if (!PyArg_ParseTuple(args, "O&OniO&idnOO",
+    if (!PyArg_ParseTuple(args, "O&OniO&idnOOi",
                           NI_ObjectToInputArray, &input,
                           &fnc, &filter_size, &axis,
                           NI_ObjectToOutputArray, &output,
                           &mode, &cval, &origin,
-                          &extra_arguments, &extra_keywords))
+                          &extra_arguments, &extra_keywords, &workers))
         goto exit;
 
     if (!PyTuple_Check(extra_arguments)) {
@@ -474,11 +483,19 @@ static PyObject *Py_GenericFilter1D(PyObject *obj, PyObject *args)
         else {
             func = callback.c_function;
             data = callback.user_data;
+            batched = callback.signature->value;
         }
     }
 
-    NI_GenericFilter1D(input, func, data, filter_size, axis, output,
-                       (NI_ExtendMode)mode, cval, origin);
+    if (batched) {
+        NI_GenericFilter1DBatched(input, func, data, filter_size, axis,
+                                  output, (NI_ExtendMode)mode, cval, origin,
+                                  workers);
+    }
+    else {
+        NI_GenericFilter1D(input, func, data, filter_size, axis, output,
+                           (NI_ExtendMode)mode, cval, origin);
+    }
     #ifdef HAVE_WRITEBACKIFCOPY
         PyArray_ResolveWritebackIfCopy(output);
     #endif
@@ -527,24 +544,32 @@ static PyObject *Py_GenericFilter(PyObject *obj, PyObject *args)
     PyObject *fnc = NULL, *extra_arguments = NULL, *extra_keywords = NULL;
     void *func = NULL, *data = NULL;
     NI_PythonCallbackData cbdata;
-    int mode;
+    int mode, workers, batched = 0;
     PyArray_Dims origin = {NULL, 0};
     double cval;
     ccallback_t callback;
+    /* the signatures with value 1 filter a batch of neighbourhoods at a
+         time: */
     static ccallback_signature_t callback_signatures[] = {
         {"int (double *, intptr_t, double *, void *)"},
         {"int (double *, npy_intp, double *, void *)"},
+        {"int (double *, intptr_t, intptr_t, double *, void *)", 1},
+        {"int (double *, npy_intp, npy_intp, double *, void *)", 1},
 #if NPY_SIZEOF_INTP == NPY_SIZEOF_SHORT
         {"int (double *, short, double *, void *)"},
+        {"int (double *, short, short, double *, void *)", 1},
 #endif
 #if NPY_SIZEOF_INTP == NPY_SIZEOF_INT
         {"int (double *, int, double *, void *)"},
+        {"int (double *, int, int, double *, void *)", 1},
 #endif
 #if NPY_SIZEOF_INTP == NPY_SIZEOF_LONG
         {"int (double *, long, double *, void *)"},
+        {"int (double *, long, long, double *, void *)", 1},
 #endif
 #if NPY_SIZEOF_INTP == NPY_SIZEOF_LONGLONG
         {"int (double *, long long, double *, void *)"},
+        {"int (double *, long long, long long, double *, void *)", 1},
 #endif
         {NULL}
     };
@@ -552,14 +577,14 @@ static PyObject *Py_GenericFilter(PyObject *obj, PyObject *args)
     callback.py_function = NULL;
     callback.c_function = NULL;
 
-    if (!PyArg_ParseTuple(args, "O&OO&O&idO&OO",
+    if (!PyArg_ParseTuple(args, "O&OO&O&idO&OOi",
                           NI_ObjectToInputArray, &input,
                           &fnc,
                           NI_ObjectToInputArray, &footprint,
                           NI_ObjectToOutputArray, &output,
                           &mode, &cval,
                           PyArray_IntpConverter, &origin,
-                          &extra_arguments, &extra_keywords)) {
+                          &extra_arguments, &extra_keywords, &workers)) {
         goto exit;
     }
     if (!_validate_origin(input, origin)) {
@@ -601,11 +626,19 @@ static PyObject *Py_GenericFilter(PyObject *obj, PyObject *args)
         else {
             func = callback.c_function;
             data = callback.user_data;
+            batched = callback.signature->value;
         }
     }
 
-    NI_GenericFilter(input, func, data, footprint, output, (NI_ExtendMode)mode,
-                     cval, origin.ptr);
+    if (batched) {
+        NI_GenericFilterBatched(input, func, data, footprint, output,
+                                (NI_ExtendMode)mode, cval, origin.ptr,
+                                workers);
+    }
+    else {
+        NI_GenericFilter(input, func, data, footprint, output,
+                         (NI_ExtendMode)mode, cval, origin.ptr);
+    }
     #ifdef HAVE_WRITEBACKIFCOPY
         PyArray_ResolveWritebackIfCopy(output);
     #endif
@@ -624,18 +657,19 @@ exit:
 static PyObject *Py_FourierFilter(PyObject *obj, PyObject *args)
 {
     PyArrayObject *input = NULL, *output = NULL, *parameters = NULL;
-    int axis, filter_type;
+    int axis, filter_type, workers;
     npy_intp n;
 
-    if (!PyArg_ParseTuple(args, "O&O&niO&i",
+    if (!PyArg_ParseTuple(args, "O&O&niO&ii",
                           NI_ObjectToInputArray, &input,
                           NI_ObjectToInputArray, &parameters,
                           &n, &axis,
                           NI_ObjectToOutputArray, &output,
-                          &filter_type))
+                          &filter_type, &workers))
         goto exit;
 
-    NI_FourierFilter(input, parameters, n, axis, output, filter_type);
+    NI_FourierFilter(input, parameters, n, axis, output, filter_type,
+                     workers);
     #ifdef HAVE_WRITEBACKIFCOPY
         PyArray_ResolveWritebackIfCopy(output);
     #endif
@@ -650,17 +684,17 @@ exit:
 static PyObject *Py_FourierShift(PyObject *obj, PyObject *args)
 {
     PyArrayObject *input = NULL, *output = NULL, *shifts = NULL;
-    int axis;
+    int axis, workers;
     npy_intp n;
 
-    if (!PyArg_ParseTuple(args, "O&O&niO&",
+    if (!PyArg_ParseTuple(args, "O&O&niO&i",
                           NI_ObjectToInputArray, &input,
                           NI_ObjectToInputArray, &shifts,
                           &n, &axis,
-                          NI_ObjectToOutputArray, &output))
+                          NI_ObjectToOutputArray, &output, &workers))
         goto exit;
 
-    NI_FourierShift(input, shifts, n, axis, output);
+    NI_FourierShift(input, shifts, n, axis, output, workers);
     #ifdef HAVE_WRITEBACKIFCOPY
         PyArray_ResolveWritebackIfCopy(output);
     #endif
@@ -675,14 +709,14 @@ exit:
 static PyObject *Py_SplineFilter1D(PyObject *obj, PyObject *args)
 {
     PyArrayObject *input = NULL, *output = NULL;
-    int axis, order, mode;
+    int axis, order, mode, workers;
 
-    if (!PyArg_ParseTuple(args, "O&iiO&i",
+    if (!PyArg_ParseTuple(args, "O&iiO&ii",
                           NI_ObjectToInputArray, &input, &order, &axis,
-                          NI_ObjectToOutputArray, &output, &mode))
+                          NI_ObjectToOutputArray, &output, &mode, &workers))
         goto exit;
 
-    NI_SplineFilter1D(input, order, axis, mode, output);
+    NI_SplineFilter1D(input, order, axis, mode, output, workers);
     #ifdef HAVE_WRITEBACKIFCOPY
         PyArray_ResolveWritebackIfCopy(output);
     #endif
@@ -737,7 +771,7 @@ static PyObject *Py_GeometricTransform(PyObject *obj, PyObject *args)
     PyArrayObject *input = NULL, *output = NULL;
     PyArrayObject *coordinates = NULL, *matrix = NULL, *shift = NULL;
     PyObject *fnc = NULL, *extra_arguments = NULL, *extra_keywords = NULL;
-    int mode, order;
+    int mode, order, workers;
     double cval;
     void *func = NULL, *data = NULL;
     NI_PythonCallbackData cbdata;
@@ -763,7 +797,7 @@ static PyObject *Py_GeometricTransform(PyObject *obj, PyObject *args)
     callback.py_function = NULL;
     callback.c_function = NULL;
 
-    if (!PyArg_ParseTuple(args, "O&OO&O&O&O&iidOO",
+    if (!PyArg_ParseTuple(args, "O&OO&O&O&O&iidOOi",
                           NI_ObjectToInputArray, &input,
                           &fnc,
                           NI_ObjectToOptionalInputArray, &coordinates,
@@ -771,7 +805,7 @@ static PyObject *Py_GeometricTransform(PyObject *obj, PyObject *args)
                           NI_ObjectToOptionalInputArray, &shift,
                           NI_ObjectToOutputArray, &output,
                           &order, &mode, &cval,
-                          &extra_arguments, &extra_keywords))
+                          &extra_arguments, &extra_keywords, &workers))
         goto exit;
 
     if (fnc != Py_None) {
@@ -817,7 +851,8 @@ static PyObject *Py_GeometricTransform(PyObject *obj, PyObject *args)
     }
 
     NI_GeometricTransform(input, func, data, matrix, shift, coordinates,
-                          output, order, (NI_ExtendMode)mode, cval);
+                          output, order, (NI_ExtendMode)mode, cval,
+                          workers);
     #ifdef HAVE_WRITEBACKIFCOPY
         PyArray_ResolveWritebackIfCopy(output);
     #endif
@@ -838,18 +873,19 @@ static PyObject *Py_ZoomShift(PyObject *obj, PyObject *args)
 {
     PyArrayObject *input = NULL, *output = NULL, *shift = NULL;
     PyArrayObject *zoom = NULL;
-    int mode, order;
+    int mode, order, workers;
     double cval;
 
-    if (!PyArg_ParseTuple(args, "O&O&O&O&iid",
+    if (!PyArg_ParseTuple(args, "O&O&O&O&iidi",
                           NI_ObjectToInputArray, &input,
                           NI_ObjectToOptionalInputArray, &zoom,
                           NI_ObjectToOptionalInputArray, &shift,
                           NI_ObjectToOutputArray, &output,
-                          &order, &mode, &cval))
+                          &order, &mode, &cval, &workers))
         goto exit;
 
-    NI_ZoomShift(input, zoom, shift, output, order, (NI_ExtendMode)mode, cval);
+    NI_ZoomShift(input, zoom, shift, output, order, (NI_ExtendMode)mode, cval,
+                 workers);
     #ifdef HAVE_WRITEBACKIFCOPY
         PyArray_ResolveWritebackIfCopy(output);
     #endif
@@ -862,6 +898,80 @@ exit:
     return PyErr_Occurred() ? NULL : Py_BuildValue("");
 }
 
+static PyObject *Py_Label(PyObject *obj, PyObject *args)
+{
+    PyArrayObject *input = NULL, *strct = NULL, *output = NULL;
+    npy_intp max_label = 0;
+    int workers;
+
+    if (!PyArg_ParseTuple(args, "O&O&O&i",
+                          NI_ObjectToInputArray, &input,
+                          NI_ObjectToInputArray, &strct,
+                          NI_ObjectToOutputArray, &output, &workers))
+        goto exit;
+
+    NI_Label(input, strct, output, workers, &max_label);
+    #ifdef HAVE_WRITEBACKIFCOPY
+        PyArray_ResolveWritebackIfCopy(output);
+    #endif
+
+exit:
+    Py_XDECREF(input);
+    Py_XDECREF(strct);
+    Py_XDECREF(output);
+    return PyErr_Occurred() ? NULL : Py_BuildValue("n", max_label);
+}
+
+/* The data of an optional, C-contiguous and writeable array, made by the
+     caller for the statistics of Py_LabeledStatistics: */
+static int _StatisticsData(PyObject *object, void **data)
+{
+    if (object == Py_None) {
+        *data = NULL;
+        return 1;
+    }
+    if (!PyArray_Check(object) ||
+            !PyArray_IS_C_CONTIGUOUS((PyArrayObject *)object) ||
+            !PyArray_ISWRITEABLE((PyArrayObject *)object)) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "statistics must be writeable C-contiguous arrays");
+        return 0;
+    }
+    *data = PyArray_DATA((PyArrayObject *)object);
+    return 1;
+}
+
+static PyObject *Py_LabeledStatistics(PyObject *obj, PyObject *args)
+{
+    PyArrayObject *input = NULL, *labels = NULL;
+    NI_LabelStatistics stats;
+    void *index;
+    npy_intp min_label, nbins;
+    int workers;
+
+    if (!PyArg_ParseTuple(args, "O&O&O&nnO&O&O&O&O&O&O&O&i",
+                          NI_ObjectToInputArray, &input,
+                          NI_ObjectToOptionalInputArray, &labels,
+                          _StatisticsData, &index, &min_label, &nbins,
+                          _StatisticsData, &stats.counts,
+                          _StatisticsData, &stats.sums,
+                          _StatisticsData, &stats.means,
+                          _StatisticsData, &stats.m2s,
+                          _StatisticsData, &stats.minima,
+                          _StatisticsData, &stats.maxima,
+                          _StatisticsData, &stats.moments,
+                          _StatisticsData, &stats.bounds, &workers))
+        goto exit;
+
+    NI_LabeledStatistics(input, labels, index, min_label, nbins, &stats,
+                         workers);
+
+exit:
+    Py_XDECREF(input);
+    Py_XDECREF(labels);
+    return PyErr_Occurred() ? NULL : Py_BuildValue("");
+}
+
 static PyObject *Py_FindObjects(PyObject *obj, PyObject *args)
 {
     PyArrayObject *input = NULL;
@@ -957,13 +1067,14 @@ static PyObject *Py_WatershedIFT(PyObject *obj, PyObject *args)
 {
     PyArrayObject *input = NULL, *output = NULL, *markers = NULL;
     PyArrayObject *strct = NULL;
+    int workers;
 
-    if (!PyArg_ParseTuple(args, "O&O&O&O&", NI_ObjectToInputArray, &input,
+    if (!PyArg_ParseTuple(args, "O&O&O&O&i", NI_ObjectToInputArray, &input,
                     NI_ObjectToInputArray, &markers, NI_ObjectToInputArray,
-                    &strct, NI_ObjectToOutputArray, &output))
+                    &strct, NI_ObjectToOutputArray, &output, &workers))
         goto exit;
 
-    NI_WatershedIFT(input, markers, strct, output);
+    NI_WatershedIFT(input, markers, strct, output, workers);
     #ifdef HAVE_WRITEBACKIFCOPY
         PyArray_ResolveWritebackIfCopy(output);
     #endif
@@ -1027,14 +1138,16 @@ static PyObject *Py_EuclideanFeatureTransform(PyObject *obj,
                                                                                             PyObject *args)
 {
     PyArrayObject *input = NULL, *features = NULL, *sampling = NULL;
+    int workers;
 
-    if (!PyArg_ParseTuple(args, "O&O&O&",
+    if (!PyArg_ParseTuple(args, "O&O&O&i",
                           NI_ObjectToInputArray, &input,
                                                 NI_ObjectToOptionalInputArray, &sampling,
-                                                NI_ObjectToOutputArray, &features))
+                                                NI_ObjectToOutputArray, &features,
+                                                &workers))
         goto exit;
 
-    NI_EuclideanFeatureTransform(input, sampling, features);
+    NI_EuclideanFeatureTransform(input, sampling, features, workers);
 
 exit:
     Py_XDECREF(input);
@@ -1043,6 +1156,30 @@ exit:
     return PyErr_Occurred() ? NULL : Py_BuildValue("");
 }
 
+static PyObject *Py_EuclideanDistanceTransform(PyObject *obj,
+                                               PyObject *args)
+{
+    PyArrayObject *input = NULL, *distances = NULL, *sampling = NULL;
+    int workers;
+
+    if (!PyArg_ParseTuple(args, "O&O&O&i",
+                          NI_ObjectToInputArray, &input,
+                          NI_ObjectToOptionalInputArray, &sampling,
+                          NI_ObjectToOutputArray, &distances, &workers))
+        goto exit;
+
+    NI_EuclideanDistanceTransform(input, sampling, distances, workers);
+    #ifdef HAVE_WRITEBACKIFCOPY
+        PyArray_ResolveWritebackIfCopy(distances);
+    #endif
+
+exit:
+    Py_XDECREF(input);
+    Py_XDECREF(sampling);
+    Py_XDECREF(distances);
+    return PyErr_Occurred() ? NULL : Py_BuildValue("");
+}
+
 #ifdef NPY_PY3K
 static void _FreeCoordinateList(PyObject *obj)
 {
@@ -1145,6 +1282,41 @@ exit:
     return PyErr_Occurred() ? NULL : Py_BuildValue("");
 }
 
+static PyObject *Py_BinaryErosionPacked(PyObject *obj, PyObject *args)
+{
+    PyArrayObject *input = NULL, *output = NULL, *strct = NULL;
+    PyArrayObject *mask = NULL;
+    int border_value, invert, iterations, workers, changed = 0;
+    PyArray_Dims origin = {NULL, 0};
+
+    if (!PyArg_ParseTuple(args, "O&O&O&O&iO&iii",
+                          NI_ObjectToInputArray, &input,
+                          NI_ObjectToInputArray, &strct,
+                          NI_ObjectToOptionalInputArray, &mask,
+                          NI_ObjectToOutputArray, &output,
+                          &border_value,
+                          PyArray_IntpConverter, &origin,
+                          &invert, &iterations, &workers)) {
+        goto exit;
+    }
+    if (!_validate_origin(input, origin)) {
+        goto exit;
+    }
+    NI_BinaryErosionPacked(input, strct, mask, output, border_value,
+                           origin.ptr, invert, iterations, workers, &changed);
+    #ifdef HAVE_WRITEBACKIFCOPY
+        PyArray_ResolveWritebackIfCopy(output);
+    #endif
+
+exit:
+    Py_XDECREF(input);
+    Py_XDECREF(strct);
+    Py_XDECREF(mask);
+    Py_XDECREF(output);
+    PyDimMem_FREE(origin.ptr);
+    return PyErr_Occurred() ? NULL : Py_BuildValue("i", changed);
+}
+
 static PyMethodDef methods[] = {
     {"correlate1d",           (PyCFunction)Py_Correlate1D,
      METH_VARARGS, NULL},
@@ -1172,8 +1344,12 @@ static PyMethodDef methods[] = {
         METH_VARARGS, NULL},
     {"zoom_shift",            (PyCFunction)Py_ZoomShift,
      METH_VARARGS, NULL},
+    {"label",                 (PyCFunction)Py_Label,
+     METH_VARARGS, NULL},
     {"find_objects",          (PyCFunction)Py_FindObjects,
      METH_VARARGS, NULL},
+    {"labeled_statistics",    (PyCFunction)Py_LabeledStatistics,
+     METH_VARARGS, NULL},
     {"watershed_ift",         (PyCFunction)Py_WatershedIFT,
      METH_VARARGS, NULL},
     {"distance_transform_bf", (PyCFunction)Py_DistanceTransformBruteForce,
@@ -1183,10 +1359,15 @@ static PyMethodDef methods[] = {
     {"euclidean_feature_transform",
      (PyCFunction)Py_EuclideanFeatureTransform,
      METH_VARARGS, NULL},
+    {"euclidean_distance_transform",
+     (PyCFunction)Py_EuclideanDistanceTransform,
+     METH_VARARGS, NULL},
     {"binary_erosion",        (PyCFunction)Py_BinaryErosion,
      METH_VARARGS, NULL},
     {"binary_erosion2",       (PyCFunction)Py_BinaryErosion2,
      METH_VARARGS, NULL},
+    {"binary_erosion_packed", (PyCFunction)Py_BinaryErosionPacked,
+     METH_VARARGS, NULL},
     {NULL, NULL, 0, NULL}
 };
 
@@ -31,20 +31,133 @@
 
 #include "ni_support.h"
 #include "ni_filters.h"
+#include "ni_threads.h"
 #include <math.h>
 
 #define BUFFER_SIZE 256000
 
+typedef struct {
+    npy_double *fw;
+    npy_float *ffw;
+    npy_intp size1, size2;
+    int symmetric;
+} NI_Correlate1DData;
+
+static void _Correlate1DLine(double *iline, double *oline, npy_intp length,
+                             void *data, void *scratch)
+{
+    NI_Correlate1DData *cd = (NI_Correlate1DData *)data;
+    npy_double *fw = cd->fw;
+    npy_intp jj, ll, size1 = cd->size1, size2 = cd->size2;
+
+    iline += size1;
+    /* the correlation calculation: */
+    if (cd->symmetric > 0) {
+        for(ll = 0; ll < length; ll++) {
+            oline[ll] = iline[0] * fw[0];
+            for(jj = -size1 ; jj < 0; jj++)
+                oline[ll] += (iline[jj] + iline[-jj]) * fw[jj];
+            ++iline;
+        }
+    } else if (cd->symmetric < 0) {
+        for(ll = 0; ll < length; ll++) {
+            oline[ll] = iline[0] * fw[0];
+            for(jj = -size1 ; jj < 0; jj++)
+                oline[ll] += (iline[jj] - iline[-jj]) * fw[jj];
+            ++iline;
+        }
+    } else {
+        for(ll = 0; ll < length; ll++) {
+            oline[ll] = iline[size2] * fw[size2];
+            for(jj = -size1; jj < size2; jj++)
+                oline[ll] += iline[jj] * fw[jj];
+            ++iline;
+        }
+    }
+}
+
+/* The correlation of lines of floats, with the sums taken in double
+     precision as for lines of doubles: */
+static void _Correlate1DFloatLine(float *iline, float *oline,
+                                  npy_intp length, void *data, void *scratch)
+{
+    NI_Correlate1DData *cd = (NI_Correlate1DData *)data;
+    npy_double *fw = cd->fw;
+    npy_intp jj, ll, size1 = cd->size1, size2 = cd->size2;
+
+    iline += size1;
+    if (cd->symmetric > 0) {
+        for(ll = 0; ll < length; ll++) {
+            double tmp = iline[0] * fw[0];
+            for(jj = -size1 ; jj < 0; jj++)
+                tmp += ((double)iline[jj] + iline[-jj]) * fw[jj];
+            oline[ll] = (float)tmp;
+            ++iline;
+        }
+    } else if (cd->symmetric < 0) {
+        for(ll = 0; ll < length; ll++) {
+            double tmp = iline[0] * fw[0];
+            for(jj = -size1 ; jj < 0; jj++)
+                tmp += ((double)iline[jj] - iline[-jj]) * fw[jj];
+            oline[ll] = (float)tmp;
+            ++iline;
+        }
+    } else {
+        for(ll = 0; ll < length; ll++) {
+            double tmp = iline[size2] * fw[size2];
+            for(jj = -size1; jj < size2; jj++)
+                tmp += iline[jj] * fw[jj];
+            oline[ll] = (float)tmp;
+            ++iline;
+        }
+    }
+}
+
+/* The correlation of lines of floats in single precision: */
+static void _Correlate1DSingleLine(float *iline, float *oline,
+                                   npy_intp length, void *data,
+                                   void *scratch)
+{
+    NI_Correlate1DData *cd = (NI_Correlate1DData *)data;
+    npy_float *fw = cd->ffw;
+    npy_intp jj, ll, size1 = cd->size1, size2 = cd->size2;
+
+    iline += size1;
+    if (cd->symmetric > 0) {
+        for(ll = 0; ll < length; ll++) {
+            float tmp = iline[0] * fw[0];
+            for(jj = -size1 ; jj < 0; jj++)
+                tmp += (iline[jj] + iline[-jj]) * fw[jj];
+            oline[ll] = tmp;
+            ++iline;
+        }
+    } else if (cd->symmetric < 0) {
+        for(ll = 0; ll < length; ll++) {
+            float tmp = iline[0] * fw[0];
+            for(jj = -size1 ; jj < 0; jj++)
+                tmp += (iline[jj] - iline[-jj]) * fw[jj];
+            oline[ll] = tmp;
+            ++iline;
+        }
+    } else {
+        for(ll = 0; ll < length; ll++) {
+            float tmp = iline[size2] * fw[size2];
+            for(jj = -size1; jj < size2; jj++)
+                tmp += iline[jj] * fw[jj];
+            oline[ll] = tmp;
+            ++iline;
+        }
+    }
+}
+
 int NI_Correlate1D(PyArrayObject *input, PyArrayObject *weights,
                    int axis, PyArrayObject *output, NI_ExtendMode mode,
-                   double cval, npy_intp origin)
+                   double cval, npy_intp origin, int workers, int single)
 {
-    int symmetric = 0, more;
-    npy_intp ii, jj, ll, lines, length, size1, size2, filter_size;
-    double *ibuffer = NULL, *obuffer = NULL;
+    int symmetric = 0;
+    npy_intp ii, size1, size2, filter_size;
     npy_double *fw;
-    NI_LineBuffer iline_buffer, oline_buffer;
-    NPY_BEGIN_THREADS_DEF;
+    NI_Correlate1DData data;
 
     /* test for symmetry or anti-symmetry: */
     filter_size = PyArray_SIZE(weights);
@@ -69,69 +182,35 @@ int NI_Correlate1D(PyArrayObject *input, PyArrayObject *weights,
             }
         }
     }
-    /* allocate and initialize the line buffers: */
-    lines = -1;
-    if (!NI_AllocateLineBuffer(input, axis, size1 + origin, size2 - origin,
-                                                         &lines, BUFFER_SIZE, &ibuffer))
-        goto exit;
-    if (!NI_AllocateLineBuffer(output, axis, 0, 0, &lines, BUFFER_SIZE,
-                                                         &obuffer))
-        goto exit;
-    if (!NI_InitLineBuffer(input, axis, size1 + origin, size2 - origin,
-                                                            lines, ibuffer, mode, cval, &iline_buffer))
-        goto exit;
-    if (!NI_InitLineBuffer(output, axis, 0, 0, lines, obuffer, mode, 0.0,
-                                                 &oline_buffer))
-        goto exit;
-
-    NPY_BEGIN_THREADS;
-    length = PyArray_NDIM(input) > 0 ? PyArray_DIM(input, axis) : 1;
-    fw += size1;
-    /* iterate over all the array lines: */
-    do {
-        /* copy lines from array to buffer: */
-        if (!NI_ArrayToLineBuffer(&iline_buffer, &lines, &more)) {
-            goto exit;
+    data.fw = fw + size1;
+    data.ffw = NULL;
+    data.size1 = size1;
+    data.size2 = size2;
+    data.symmetric = symmetric;
+    if (NI_CanFilterFloatLines(input, output, mode, cval)) {
+        int ok;
+        if (!single) {
+            return NI_FloatLineFilter(input, output, axis, size1 + origin,
+                                      size2 - origin, mode, cval, 0,
+                                      _Correlate1DFloatLine, &data, 0,
+                                      workers);
         }
-        /* iterate over the lines in the buffers: */
-        for(ii = 0; ii < lines; ii++) {
-            /* get lines: */
-            double *iline = NI_GET_LINE(iline_buffer, ii) + size1;
-            double *oline = NI_GET_LINE(oline_buffer, ii);
-            /* the correlation calculation: */
-            if (symmetric > 0) {
-                for(ll = 0; ll < length; ll++) {
-                    oline[ll] = iline[0] * fw[0];
-                    for(jj = -size1 ; jj < 0; jj++)
-                        oline[ll] += (iline[jj] + iline[-jj]) * fw[jj];
-                    ++iline;
-                }
-            } else if (symmetric < 0) {
-                for(ll = 0; ll < length; ll++) {
-                    oline[ll] = iline[0] * fw[0];
-                    for(jj = -size1 ; jj < 0; jj++)
-                        oline[ll] += (iline[jj] - iline[-jj]) * fw[jj];
-                    ++iline;
-                }
-            } else {
-                for(ll = 0; ll < length; ll++) {
-                    oline[ll] = iline[size2] * fw[size2];
-                    for(jj = -size1; jj < size2; jj++)
-                        oline[ll] += iline[jj] * fw[jj];
-                    ++iline;
-                }
-            }
-        }
-        /* copy lines from buffer to array: */
-        if (!NI_LineBufferToArray(&oline_buffer)) {
-            goto exit;
+        data.ffw = malloc(filter_size * sizeof(npy_float));
+        if (!data.ffw) {
+            PyErr_NoMemory();
+            return 0;
         }
-    } while(more);
-exit:
-    NPY_END_THREADS;
-    free(ibuffer);
-    free(obuffer);
-    return PyErr_Occurred() ? 0 : 1;
+        for(ii = 0; ii < filter_size; ii++)
+            data.ffw[ii] = (npy_float)fw[ii];
+        data.ffw += size1;
+        ok = NI_FloatLineFilter(input, output, axis, size1 + origin,
+                                size2 - origin, mode, cval, 0,
+                                _Correlate1DSingleLine, &data, 0, workers);
+        free(data.ffw - size1);
+        return ok;
+    }
+    return NI_LineFilter(input, output, axis, size1 + origin, size2 - origin,
+                         mode, cval, 0, _Correlate1DLine, &data, 0, workers);
 }
 
 #define CASE_CORRELATE_POINT(_TYPE, _type, _pi, _weights, _offsets,        \
@@ -151,24 +230,204 @@ case _TYPE:                                                                \
 }                                                                          \
 break
 
+/* the same, for offsets that all lie inside the array: */
+#define CASE_CORRELATE_INTERIOR_POINT(_TYPE, _type, _pi, _weights,         \
+                                      _offsets, _filter_size, _res)        \
+case _TYPE:                                                                \
+{                                                                          \
+    npy_intp _ii;                                                          \
+    for (_ii = 0; _ii < _filter_size; ++_ii) {                             \
+        _res += _weights[_ii] *                                            \
+                (double)(*((_type *)(_pi + _offsets[_ii])));               \
+    }                                                                      \
+}                                                                          \
+break
+
 #define CASE_FILTER_OUT(_TYPE, _type, _po, _tmp) \
 case _TYPE:                                      \
     *(_type *)_po = (_type)_tmp;                 \
     break
 
+/* Minimum number of multiply-adds that justifies another thread: */
+#define CORRELATE_MIN_WORK_PER_THREAD 262144
+
+/* The range of output points of one thread: */
+typedef struct {
+    PyArrayObject *input, *output;
+    NI_FilterIterator *fi;
+    NI_Iterator ii, io;
+    npy_double *weights;
+    npy_intp *offsets;
+    npy_bool *border;
+    npy_intp filter_size, border_flag_value, first, last;
+    double cvalue;
+    int error;
+} NI_CorrelateTask;
+
+/* Move the point iterators of a filter to the point with the given index,
+     and return the filter offsets of that point: */
+static npy_intp *_FilterGoto(NI_FilterIterator *fi, npy_intp *offsets,
+                             PyArrayObject *input, NI_Iterator *ii,
+                             PyArrayObject *output, NI_Iterator *io,
+                             npy_intp index, char **pi, char **po)
+{
+    npy_intp coordinates[NPY_MAXDIMS], *oo = offsets;
+    int kk;
+
+    for(kk = ii->rank_m1; kk >= 0; kk--) {
+        npy_intp cc = index % (ii->dimensions[kk] + 1);
+        npy_intp b1 = fi->bound1[kk], b2 = fi->bound2[kk], jj;
+
+        index /= ii->dimensions[kk] + 1;
+        coordinates[kk] = cc;
+        /* the set of offsets that NI_FILTER_NEXT2 reaches at cc: */
+        if (cc < b1 || b2 < b1) {
+            jj = cc;
+        } else if (cc > b2) {
+            jj = cc + b1 - b2;
+        } else {
+            jj = b1;
+        }
+        oo += fi->strides[kk] * jj;
+    }
+    NI_ITERATOR_GOTO(*ii, coordinates, PyArray_BYTES(input), *pi);
+    NI_ITERATOR_GOTO(*io, coordinates, PyArray_BYTES(output), *po);
+    return oo;
+}
+
+static void _CorrelateTask(void *arg)
+{
+    NI_CorrelateTask *task = (NI_CorrelateTask *)arg;
+    npy_intp jj, *oo, filter_size = task->filter_size;
+    npy_intp border_flag_value = task->border_flag_value;
+    npy_double *ww = task->weights;
+    double cvalue = task->cvalue;
+    char *pi, *po;
+
+    if (task->first >= task->last) {
+        return;
+    }
+    oo = _FilterGoto(task->fi, task->offsets, task->input, &task->ii,
+                     task->output, &task->io, task->first, &pi, &po);
+    /* iterator over the elements: */
+    for(jj = task->first; jj < task->last; jj++) {
+        double tmp = 0.0;
+        /* only the offsets of border regions may point outside the
+             array: */
+        if (task->border &&
+                task->border[(oo - task->offsets) / filter_size]) {
+            switch (PyArray_TYPE(task->input)) {
+                CASE_CORRELATE_POINT(NPY_BOOL, npy_bool,
+                                     pi, ww, oo, filter_size, cvalue, tmp,
+                                     border_flag_value);
+                CASE_CORRELATE_POINT(NPY_UBYTE, npy_ubyte,
+                                     pi, ww, oo, filter_size, cvalue, tmp,
+                                     border_flag_value);
+                CASE_CORRELATE_POINT(NPY_USHORT, npy_ushort,
+                                     pi, ww, oo, filter_size, cvalue, tmp,
+                                     border_flag_value);
+                CASE_CORRELATE_POINT(NPY_UINT, npy_uint,
+                                     pi, ww, oo, filter_size, cvalue, tmp,
+                                     border_flag_value);
+                CASE_CORRELATE_POINT(NPY_ULONG, npy_ulong,
+                                     pi, ww, oo, filter_size, cvalue, tmp,
+                                     border_flag_value);
+                CASE_CORRELATE_POINT(NPY_ULONGLONG, npy_ulonglong,
+                                     pi, ww, oo, filter_size, cvalue, tmp,
+                                     border_flag_value);
+                CASE_CORRELATE_POINT(NPY_BYTE, npy_byte,
+                                     pi, ww, oo, filter_size, cvalue, tmp,
+                                     border_flag_value);
+                CASE_CORRELATE_POINT(NPY_SHORT, npy_short,
+                                     pi, ww, oo, filter_size, cvalue, tmp,
+                                     border_flag_value);
+                CASE_CORRELATE_POINT(NPY_INT, npy_int,
+                                     pi, ww, oo, filter_size, cvalue, tmp,
+                                     border_flag_value);
+                CASE_CORRELATE_POINT(NPY_LONG, npy_long,
+                                     pi, ww, oo, filter_size, cvalue, tmp,
+                                     border_flag_value);
+                CASE_CORRELATE_POINT(NPY_LONGLONG, npy_longlong,
+                                     pi, ww, oo, filter_size, cvalue, tmp,
+                                     border_flag_value);
+                CASE_CORRELATE_POINT(NPY_FLOAT, npy_float,
+                                     pi, ww, oo, filter_size, cvalue, tmp,
+                                     border_flag_value);
+                CASE_CORRELATE_POINT(NPY_DOUBLE, npy_double,
+                                     pi, ww, oo, filter_size, cvalue, tmp,
+                                     border_flag_value);
+            default:
+                task->error = 1;
+                return;
+            }
+        } else {
+            switch (PyArray_TYPE(task->input)) {
+                CASE_CORRELATE_INTERIOR_POINT(NPY_BOOL, npy_bool,
+                                              pi, ww, oo, filter_size, tmp);
+                CASE_CORRELATE_INTERIOR_POINT(NPY_UBYTE, npy_ubyte,
+                                              pi, ww, oo, filter_size, tmp);
+                CASE_CORRELATE_INTERIOR_POINT(NPY_USHORT, npy_ushort,
+                                              pi, ww, oo, filter_size, tmp);
+                CASE_CORRELATE_INTERIOR_POINT(NPY_UINT, npy_uint,
+                                              pi, ww, oo, filter_size, tmp);
+                CASE_CORRELATE_INTERIOR_POINT(NPY_ULONG, npy_ulong,
+                                              pi, ww, oo, filter_size, tmp);
+                CASE_CORRELATE_INTERIOR_POINT(NPY_ULONGLONG, npy_ulonglong,
+                                              pi, ww, oo, filter_size, tmp);
+                CASE_CORRELATE_INTERIOR_POINT(NPY_BYTE, npy_byte,
+                                              pi, ww, oo, filter_size, tmp);
+                CASE_CORRELATE_INTERIOR_POINT(NPY_SHORT, npy_short,
+                                              pi, ww, oo, filter_size, tmp);
+                CASE_CORRELATE_INTERIOR_POINT(NPY_INT, npy_int,
+                                              pi, ww, oo, filter_size, tmp);
+                CASE_CORRELATE_INTERIOR_POINT(NPY_LONG, npy_long,
+                                              pi, ww, oo, filter_size, tmp);
+                CASE_CORRELATE_INTERIOR_POINT(NPY_LONGLONG, npy_longlong,
+                                              pi, ww, oo, filter_size, tmp);
+                CASE_CORRELATE_INTERIOR_POINT(NPY_FLOAT, npy_float,
+                                              pi, ww, oo, filter_size, tmp);
+                CASE_CORRELATE_INTERIOR_POINT(NPY_DOUBLE, npy_double,
+                                              pi, ww, oo, filter_size, tmp);
+            default:
+                task->error = 1;
+                return;
+            }
+        }
+        switch (PyArray_TYPE(task->output)) {
+            CASE_FILTER_OUT(NPY_BOOL, npy_bool, po, tmp);
+            CASE_FILTER_OUT(NPY_UBYTE, npy_ubyte, po, tmp);
+            CASE_FILTER_OUT(NPY_USHORT, npy_ushort, po, tmp);
+            CASE_FILTER_OUT(NPY_UINT, npy_uint, po, tmp);
+            CASE_FILTER_OUT(NPY_ULONG, npy_ulong, po, tmp);
+            CASE_FILTER_OUT(NPY_ULONGLONG, npy_ulonglong, po, tmp);
+            CASE_FILTER_OUT(NPY_BYTE, npy_byte, po, tmp);
+            CASE_FILTER_OUT(NPY_SHORT, npy_short, po, tmp);
+            CASE_FILTER_OUT(NPY_INT, npy_int, po, tmp);
+            CASE_FILTER_OUT(NPY_LONG, npy_long, po, tmp);
+            CASE_FILTER_OUT(NPY_LONGLONG, npy_longlong, po, tmp);
+            CASE_FILTER_OUT(NPY_FLOAT, npy_float, po, tmp);
+            CASE_FILTER_OUT(NPY_DOUBLE, npy_double, po, tmp);
+        default:
+            task->error = 1;
+            return;
+        }
+        NI_FILTER_NEXT2(*task->fi, task->ii, task->io, oo, pi, po);
+    }
+}
+
 int NI_Correlate(PyArrayObject* input, PyArrayObject* weights,
                  PyArrayObject* output, NI_ExtendMode mode,
-                 double cvalue, npy_intp *origins)
+                 double cvalue, npy_intp *origins, int workers)
 {
-    npy_bool *pf = NULL;
+    npy_bool *pf = NULL, *border = NULL;
     npy_intp fsize, jj, kk, filter_size = 0, border_flag_value;
-    npy_intp *offsets = NULL, *oo, size;
+    npy_intp *offsets = NULL, size, line_length, lines, regions = 1;
     NI_FilterIterator fi;
-    NI_Iterator ii, io;
-    char *pi, *po;
+    NI_CorrelateTask *tasks = NULL;
+    void **args = NULL;
     npy_double *pw;
     npy_double *ww = NULL;
-    int err = 0;
+    int ntasks = 1, err = 0;
     NPY_BEGIN_THREADS_DEF;
 
     /* get the footprint: */
@@ -210,162 +469,154 @@ int NI_Correlate(PyArrayObject* input, PyArrayObject* weights,
                                &fi)) {
         goto exit;
     }
-    /* initialize input element iterator: */
-    if (!NI_InitPointIterator(input, &ii))
-        goto exit;
-    /* initialize output element iterator: */
-    if (!NI_InitPointIterator(output, &io))
-        goto exit;
+    /* only a constant boundary flags offsets outside the array, so find
+         the sets of offsets that need checking: */
+    if (mode == NI_EXTEND_CONSTANT && filter_size > 0) {
+        for(kk = 0; kk < PyArray_NDIM(input); kk++) {
+            npy_intp ad = PyArray_DIM(input, kk);
+            npy_intp fd = PyArray_DIM(weights, kk);
+            regions *= ad < fd ? ad : fd;
+        }
+        border = malloc(regions * sizeof(npy_bool));
+        if (!border) {
+            PyErr_NoMemory();
+            goto exit;
+        }
+        for(jj = 0; jj < regions; jj++) {
+            border[jj] = 0;
+            for(kk = 0; kk < filter_size; kk++) {
+                if (offsets[jj * filter_size + kk] == border_flag_value) {
+                    border[jj] = 1;
+                    break;
+                }
+            }
+        }
+    }
 
-    NPY_BEGIN_THREADS;
-    /* get data pointers an array size: */
-    pi = (void *)PyArray_DATA(input);
-    po = (void *)PyArray_DATA(output);
+    /* split the output into blocks of whole lines, one for each thread,
+         if the threads cannot see each other's output: */
     size = PyArray_SIZE(input);
-    /* iterator over the elements: */
-    oo = offsets;
-    for(jj = 0; jj < size; jj++) {
-        double tmp = 0.0;
-        switch (PyArray_TYPE(input)) {
-            CASE_CORRELATE_POINT(NPY_BOOL, npy_bool,
-                                 pi, ww, oo, filter_size, cvalue, tmp,
-                                 border_flag_value);
-            CASE_CORRELATE_POINT(NPY_UBYTE, npy_ubyte,
-                                 pi, ww, oo, filter_size, cvalue, tmp,
-                                 border_flag_value);
-            CASE_CORRELATE_POINT(NPY_USHORT, npy_ushort,
-                                 pi, ww, oo, filter_size, cvalue, tmp,
-                                 border_flag_value);
-            CASE_CORRELATE_POINT(NPY_UINT, npy_uint,
-                                 pi, ww, oo, filter_size, cvalue, tmp,
-                                 border_flag_value);
-            CASE_CORRELATE_POINT(NPY_ULONG, npy_ulong,
-                                 pi, ww, oo, filter_size, cvalue, tmp,
-                                 border_flag_value);
-            CASE_CORRELATE_POINT(NPY_ULONGLONG, npy_ulonglong,
-                                 pi, ww, oo, filter_size, cvalue, tmp,
-                                 border_flag_value);
-            CASE_CORRELATE_POINT(NPY_BYTE, npy_byte,
-                                 pi, ww, oo, filter_size, cvalue, tmp,
-                                 border_flag_value);
-            CASE_CORRELATE_POINT(NPY_SHORT, npy_short,
-                                 pi, ww, oo, filter_size, cvalue, tmp,
-                                 border_flag_value);
-            CASE_CORRELATE_POINT(NPY_INT, npy_int,
-                                 pi, ww, oo, filter_size, cvalue, tmp,
-                                 border_flag_value);
-            CASE_CORRELATE_POINT(NPY_LONG, npy_long,
-                                 pi, ww, oo, filter_size, cvalue, tmp,
-                                 border_flag_value);
-            CASE_CORRELATE_POINT(NPY_LONGLONG, npy_longlong,
-                                 pi, ww, oo, filter_size, cvalue, tmp,
-                                 border_flag_value);
-            CASE_CORRELATE_POINT(NPY_FLOAT, npy_float,
-                                 pi, ww, oo, filter_size, cvalue, tmp,
-                                 border_flag_value);
-            CASE_CORRELATE_POINT(NPY_DOUBLE, npy_double,
-                                 pi, ww, oo, filter_size, cvalue, tmp,
-                                 border_flag_value);
-            default:
-                err = 1;
-                goto exit;
+    line_length = PyArray_NDIM(input) > 0 ?
+                  PyArray_DIM(input, PyArray_NDIM(input) - 1) : 1;
+    lines = line_length > 0 ? size / line_length : 0;
+    if (workers > 1 && lines > 1 && !NI_ArraysOverlap(input, output)) {
+        npy_intp max_tasks = size * filter_size /
+                             CORRELATE_MIN_WORK_PER_THREAD;
+        if (max_tasks > lines) {
+            max_tasks = lines;
         }
-        switch (PyArray_TYPE(output)) {
-            CASE_FILTER_OUT(NPY_BOOL, npy_bool, po, tmp);
-            CASE_FILTER_OUT(NPY_UBYTE, npy_ubyte, po, tmp);
-            CASE_FILTER_OUT(NPY_USHORT, npy_ushort, po, tmp);
-            CASE_FILTER_OUT(NPY_UINT, npy_uint, po, tmp);
-            CASE_FILTER_OUT(NPY_ULONG, npy_ulong, po, tmp);
-            CASE_FILTER_OUT(NPY_ULONGLONG, npy_ulonglong, po, tmp);
-            CASE_FILTER_OUT(NPY_BYTE, npy_byte, po, tmp);
-            CASE_FILTER_OUT(NPY_SHORT, npy_short, po, tmp);
-            CASE_FILTER_OUT(NPY_INT, npy_int, po, tmp);
-            CASE_FILTER_OUT(NPY_LONG, npy_long, po, tmp);
-            CASE_FILTER_OUT(NPY_LONGLONG, npy_longlong, po, tmp);
-            CASE_FILTER_OUT(NPY_FLOAT, npy_float, po, tmp);
-            CASE_FILTER_OUT(NPY_DOUBLE, npy_double, po, tmp);
-            default:
-                err = 1;
-                goto exit;
+        if (max_tasks < workers) {
+            workers = max_tasks > 1 ? (int)max_tasks : 1;
         }
-        NI_FILTER_NEXT2(fi, ii, io, oo, pi, po);
+        ntasks = workers;
     }
-exit:
+    tasks = malloc(ntasks * sizeof(NI_CorrelateTask));
+    args = malloc(ntasks * sizeof(void *));
+    if (!tasks || !args) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+    for(kk = 0; kk < ntasks; kk++) {
+        NI_CorrelateTask *task = tasks + kk;
+
+        /* initialize the element iterators of the task: */
+        if (!NI_InitPointIterator(input, &task->ii))
+            goto exit;
+        if (!NI_InitPointIterator(output, &task->io))
+            goto exit;
+        task->input = input;
+        task->output = output;
+        task->fi = &fi;
+        task->weights = ww;
+        task->offsets = offsets;
+        task->border = border;
+        task->filter_size = filter_size;
+        task->border_flag_value = border_flag_value;
+        task->cvalue = cvalue;
+        task->first = lines * kk / ntasks * line_length;
+        task->last = lines * (kk + 1) / ntasks * line_length;
+        task->error = 0;
+        args[kk] = task;
+    }
+
+    NPY_BEGIN_THREADS;
+    NI_RunThreads(ntasks, _CorrelateTask, args);
     NPY_END_THREADS;
-    if (err == 1) {
+
+    for(kk = 0; kk < ntasks; kk++) {
+        err |= tasks[kk].error;
+    }
+    if (err) {
         PyErr_SetString(PyExc_RuntimeError, "array type not supported");
     }
+exit:
+    free(tasks);
+    free(args);
+    free(border);
     free(offsets);
     free(ww);
     free(pf);
     return PyErr_Occurred() ? 0 : 1;
 }
 
+static void _UniformFilter1DLine(double *iline, double *oline,
+                                 npy_intp length, void *data, void *scratch)
+{
+    npy_intp ll, filter_size = *(npy_intp *)data;
+    double tmp = 0.0;
+    double *l1 = iline;
+    double *l2 = iline + filter_size;
+
+    /* do the uniform filter: */
+    for (ll = 0; ll < filter_size; ++ll) {
+        tmp += iline[ll];
+    }
+    oline[0] = tmp / filter_size;
+    for (ll = 1; ll < length; ++ll) {
+        tmp += *l2++ - *l1++;
+        oline[ll] = tmp / filter_size;
+    }
+}
+
+/* The uniform filter of lines of floats, with the running sum kept in
+     double precision as for lines of doubles: */
+static void _UniformFilter1DFloatLine(float *iline, float *oline,
+                                      npy_intp length, void *data,
+                                      void *scratch)
+{
+    npy_intp ll, filter_size = *(npy_intp *)data;
+    double tmp = 0.0;
+    float *l1 = iline;
+    float *l2 = iline + filter_size;
+
+    for (ll = 0; ll < filter_size; ++ll) {
+        tmp += iline[ll];
+    }
+    oline[0] = (float)(tmp / filter_size);
+    for (ll = 1; ll < length; ++ll) {
+        tmp += (double)*l2++ - *l1++;
+        oline[ll] = (float)(tmp / filter_size);
+    }
+}
+
 int
 NI_UniformFilter1D(PyArrayObject *input, npy_intp filter_size,
                    int axis, PyArrayObject *output, NI_ExtendMode mode,
-                   double cval, npy_intp origin)
+                   double cval, npy_intp origin, int workers)
 {
-    npy_intp lines, kk, ll, length, size1, size2;
-    int more;
-    double *ibuffer = NULL, *obuffer = NULL;
-    NI_LineBuffer iline_buffer, oline_buffer;
-    NPY_BEGIN_THREADS_DEF;
+    npy_intp size1, size2;
 
     size1 = filter_size / 2;
     size2 = filter_size - size1 - 1;
-    /* allocate and initialize the line buffers: */
-    lines = -1;
-    if (!NI_AllocateLineBuffer(input, axis, size1 + origin, size2 - origin,
-                                                         &lines, BUFFER_SIZE, &ibuffer))
-        goto exit;
-    if (!NI_AllocateLineBuffer(output, axis, 0, 0, &lines, BUFFER_SIZE,
-                                                         &obuffer))
-        goto exit;
-    if (!NI_InitLineBuffer(input, axis, size1 + origin, size2 - origin,
-                                                            lines, ibuffer, mode, cval, &iline_buffer))
-        goto exit;
-    if (!NI_InitLineBuffer(output, axis, 0, 0, lines, obuffer, mode, 0.0,
-                                                 &oline_buffer))
-        goto exit;
-    NPY_BEGIN_THREADS;
-    length = PyArray_NDIM(input) > 0 ? PyArray_DIM(input, axis) : 1;
-
-    /* iterate over all the array lines: */
-    do {
-        /* copy lines from array to buffer: */
-        if (!NI_ArrayToLineBuffer(&iline_buffer, &lines, &more)) {
-            goto exit;
-        }
-        /* iterate over the lines in the buffers: */
-        for(kk = 0; kk < lines; kk++) {
-            /* get lines: */
-            double *iline = NI_GET_LINE(iline_buffer, kk);
-            double *oline = NI_GET_LINE(oline_buffer, kk);
-            /* do the uniform filter: */
-            double tmp = 0.0;
-            double *l1 = iline;
-            double *l2 = iline + filter_size;
-            for (ll = 0; ll < filter_size; ++ll) {
-                tmp += iline[ll];
-            }
-            oline[0] = tmp / filter_size;
-            for (ll = 1; ll < length; ++ll) {
-                tmp += *l2++ - *l1++;
-                oline[ll] = tmp / filter_size;
-            }
-        }
-        /* copy lines from buffer to array: */
-        if (!NI_LineBufferToArray(&oline_buffer)) {
-            goto exit;
-        }
-    } while(more);
-
- exit:
-    NPY_END_THREADS;
-    free(ibuffer);
-    free(obuffer);
-    return PyErr_Occurred() ? 0 : 1;
+    if (NI_CanFilterFloatLines(input, output, mode, cval)) {
+        return NI_FloatLineFilter(input, output, axis, size1 + origin,
+                                  size2 - origin, mode, cval, 0,
+                                  _UniformFilter1DFloatLine, &filter_size,
+                                  0, workers);
+    }
+    return NI_LineFilter(input, output, axis, size1 + origin, size2 - origin,
+                         mode, cval, 0, _UniformFilter1DLine, &filter_size,
+                         0, workers);
 }
 
 #define INCREASE_RING_PTR(ptr) \
@@ -380,116 +631,150 @@ NI_UniformFilter1D(PyArrayObject *input, npy_intp filter_size,
     }                          \
     (ptr)--;
 
-int
-NI_MinOrMaxFilter1D(PyArrayObject *input, npy_intp filter_size,
-                    int axis, PyArrayObject *output, NI_ExtendMode mode,
-                    double cval, npy_intp origin, int minimum)
-{
-    npy_intp lines, kk, ll, length, size1, size2;
-    int more;
-    double *ibuffer = NULL, *obuffer = NULL;
-    NI_LineBuffer iline_buffer, oline_buffer;
+/* The filter size from which lines are filtered with the van Herk/Gil-Werman
+     algorithm, rather than with the wedge of pairs, whose comparisons per
+     element depend on the data: */
+#define VAN_HERK_MIN_FILTER_SIZE 8
 
-    struct pairs {
-        double value;
-        npy_intp death;
-    } *ring = NULL, *minpair, *end, *last;
+typedef struct {
+    npy_intp filter_size;
+    int minimum;
+    int van_herk;
+} NI_MinOrMaxFilter1DData;
 
-    NPY_BEGIN_THREADS_DEF;
+/* ring is a dequeue of pairs implemented as a circular array */
+struct pairs {
+    double value;
+    npy_intp death;
+};
 
-    size1 = filter_size / 2;
-    size2 = filter_size - size1 - 1;
-    /* allocate and initialize the line buffers: */
-    lines = -1;
-    if (!NI_AllocateLineBuffer(input, axis, size1 + origin, size2 - origin,
-                                            &lines, BUFFER_SIZE, &ibuffer))
-        goto exit;
-    if (!NI_AllocateLineBuffer(output, axis, 0, 0, &lines, BUFFER_SIZE,
-                                                                &obuffer))
-        goto exit;
-    if (!NI_InitLineBuffer(input, axis, size1 + origin, size2 - origin,
-                                lines, ibuffer, mode, cval, &iline_buffer))
-        goto exit;
-    if (!NI_InitLineBuffer(output, axis, 0, 0, lines, obuffer, mode, 0.0,
-                                                            &oline_buffer))
-        goto exit;
+#define VAN_HERK_PASSES(_op)                                             \
+for (ll = 0; ll < size; ll += filter_size) {                             \
+    npy_intp _jj, _end = ll + filter_size < size ? ll + filter_size : size; \
+    gg[ll] = iline[ll];                                                  \
+    for (_jj = ll + 1; _jj < _end; _jj++) {                              \
+        gg[_jj] = iline[_jj] _op gg[_jj - 1] ? iline[_jj] : gg[_jj - 1]; \
+    }                                                                    \
+    hh[_end - 1] = iline[_end - 1];                                      \
+    for (_jj = _end - 2; _jj >= ll; _jj--) {                             \
+        hh[_jj] = iline[_jj] _op hh[_jj + 1] ? iline[_jj] : hh[_jj + 1]; \
+    }                                                                    \
+}                                                                        \
+for (ll = 0; ll < length; ll++) {                                        \
+    double _g = gg[ll + filter_size - 1];                                \
+    oline[ll] = hh[ll] _op _g ? hh[ll] : _g;                             \
+}
 
-    NPY_BEGIN_THREADS;
-    length = PyArray_NDIM(input) > 0 ? PyArray_DIM(input, axis) : 1;
+/* van Herk/Gil-Werman: the extended line is cut into blocks of the filter
+     size, and the extremum of every prefix (gg) and suffix (hh) of each
+     block is taken. A window then covers the suffix of one block and the
+     prefix of the next, so each output takes three comparisons per
+     element, whatever the filter size. Returns 0 without writing the
+     output if the line has a NaN, for which the result depends on the
+     order of the comparisons, so that the wedge is used instead: */
+static int _VanHerkLine(double *iline, double *oline, npy_intp length,
+                        npy_intp filter_size, int minimum, double *gg)
+{
+    npy_intp ll, size = length + filter_size - 1;
+    double *hh = gg + size;
 
-    /* ring is a dequeue of pairs implemented as a circular array */
-    ring = malloc(filter_size * sizeof(struct pairs));
-    if (!ring) {
-        goto exit;
+    for (ll = 0; ll < size; ll++) {
+        if (iline[ll] != iline[ll]) {
+            return 0;
+        }
     }
-    end = ring + filter_size;
+    if (minimum) {
+        VAN_HERK_PASSES(<)
+    }
+    else {
+        VAN_HERK_PASSES(>)
+    }
+    return 1;
+}
 
-    /* iterate over all the array lines: */
-    do {
-        /* copy lines from array to buffer: */
-        if (!NI_ArrayToLineBuffer(&iline_buffer, &lines, &more)) {
-            goto exit;
-        }
-        /* iterate over the lines in the buffers: */
-        for(kk = 0; kk < lines; kk++) {
-            /* get lines: */
-            double *iline = NI_GET_LINE(iline_buffer, kk);
-            double *oline = NI_GET_LINE(oline_buffer, kk);
+#undef VAN_HERK_PASSES
 
-            /* This check could be moved out to the Python wrapper */
-            if (filter_size == 1) {
-                memcpy(oline, iline, sizeof(double) * length);
-            }
-            else {
-                /*
-                 * Original code by Richard Harter, adapted from:
-                 * http://www.richardhartersworld.com/cri/2001/slidingmin.html
-                 */
-                minpair = ring;
-                minpair->value = *iline++;
-                minpair->death = filter_size;
-                last = ring;
-
-                for (ll = 1; ll < filter_size + length - 1; ll++) {
-                    double val = *iline++;
-                    if (minpair->death == ll) {
-                        INCREASE_RING_PTR(minpair)
-                    }
-                    if ((minimum && val <= minpair->value) ||
-                        (!minimum && val >= minpair->value)) {
-                        minpair->value = val;
-                        minpair->death = ll + filter_size;
-                        last = minpair;
-                    }
-                    else {
-                        while ((minimum && last->value >= val) ||
-                               (!minimum && last->value <= val)) {
-                            DECREASE_RING_PTR(last)
-                        }
-                        INCREASE_RING_PTR(last)
-                        last->value = val;
-                        last->death = ll + filter_size;
-                    }
-                    if (ll >= filter_size - 1) {
-                        *oline++ = minpair->value;
-                    }
-                }
+static void _MinOrMaxFilter1DLine(double *iline, double *oline,
+                                  npy_intp length, void *data, void *scratch)
+{
+    NI_MinOrMaxFilter1DData *md = (NI_MinOrMaxFilter1DData *)data;
+    npy_intp ll, filter_size = md->filter_size;
+    int minimum = md->minimum;
+    struct pairs *ring = (struct pairs *)scratch, *minpair, *last;
+    struct pairs *end = ring + filter_size;
+
+    /* This check could be moved out to the Python wrapper */
+    if (filter_size == 1) {
+        memcpy(oline, iline, sizeof(double) * length);
+        return;
+    }
+    if (md->van_herk && _VanHerkLine(iline, oline, length, filter_size,
+                                     minimum, (double *)end)) {
+        return;
+    }
+    /*
+     * Original code by Richard Harter, adapted from:
+     * http://www.richardhartersworld.com/cri/2001/slidingmin.html
+     */
+    minpair = ring;
+    minpair->value = *iline++;
+    minpair->death = filter_size;
+    last = ring;
+
+    for (ll = 1; ll < filter_size + length - 1; ll++) {
+        double val = *iline++;
+        if (minpair->death == ll) {
+            INCREASE_RING_PTR(minpair)
+        }
+        if ((minimum && val <= minpair->value) ||
+            (!minimum && val >= minpair->value)) {
+            minpair->value = val;
+            minpair->death = ll + filter_size;
+            last = minpair;
+        }
+        else {
+            while ((minimum && last->value >= val) ||
+                   (!minimum && last->value <= val)) {
+                DECREASE_RING_PTR(last)
             }
+            INCREASE_RING_PTR(last)
+            last->value = val;
+            last->death = ll + filter_size;
         }
-        /* copy lines from buffer to array: */
-        if (!NI_LineBufferToArray(&oline_buffer)) {
-            goto exit;
+        if (ll >= filter_size - 1) {
+            *oline++ = minpair->value;
         }
-    } while(more);
+    }
+}
 
- exit:
-    NPY_END_THREADS;
-    free(ibuffer);
-    free(obuffer);
-    free(ring);
-    return PyErr_Occurred() ? 0 : 1;
+int
+NI_MinOrMaxFilter1D(PyArrayObject *input, npy_intp filter_size,
+                    int axis, PyArrayObject *output, NI_ExtendMode mode,
+                    double cval, npy_intp origin, int minimum, int workers)
+{
+    npy_intp size1, size2;
+    size_t scratch_size = filter_size * sizeof(struct pairs);
+    NI_MinOrMaxFilter1DData data;
+
+    size1 = filter_size / 2;
+    size2 = filter_size - size1 - 1;
+    data.filter_size = filter_size;
+    data.minimum = minimum;
+    data.van_herk = filter_size >= VAN_HERK_MIN_FILTER_SIZE;
+    if (data.van_herk) {
+        /* the prefix and suffix extrema of the extended line follow the
+             ring of pairs, which is kept for lines with NaNs: */
+        npy_intp length = PyArray_NDIM(input) > 0 ?
+                                        PyArray_DIM(input, axis) : 1;
+        scratch_size += 2 * (length + filter_size - 1) * sizeof(double);
+    }
+    return NI_LineFilter(input, output, axis, size1 + origin, size2 - origin,
+                         mode, cval, 0, _MinOrMaxFilter1DLine, &data,
+                         scratch_size, workers);
 }
 
+#undef VAN_HERK_MIN_FILTER_SIZE
+
 #undef DECREASE_RING_PTR
 #undef INCREASE_RING_PTR
 
@@ -719,20 +1004,367 @@ case _TYPE:                                                        \
 }                                                                  \
 break
 
+/* Minimum number of points that justifies another rank filter thread: */
+#define RANK_MIN_POINTS_PER_THREAD 16384
 
+/* The range of output points of one rank filter thread: */
+typedef struct {
+    PyArrayObject *input, *output;
+    NI_FilterIterator *fi;
+    NI_Iterator ii, io;
+    npy_intp *offsets;
+    /* the footprint points that leave and enter the window on a step
+         along the last axis: */
+    npy_intp *leave, *enter;
+    npy_intp nleave, nenter;
+    npy_intp filter_size, border_flag_value, rank, first, last;
+    double cvalue;
+    /* the values of the window, or the bins of its histogram: */
+    void *buffer;
+    int error;
+} NI_RankTask;
+
+static int _WriteFilterOut(PyArrayObject *output, char *po, double tmp)
+{
+    switch (PyArray_TYPE(output)) {
+        CASE_FILTER_OUT(NPY_BOOL, npy_bool, po, tmp);
+        CASE_FILTER_OUT(NPY_UBYTE, npy_ubyte, po, tmp);
+        CASE_FILTER_OUT(NPY_USHORT, npy_ushort, po, tmp);
+        CASE_FILTER_OUT(NPY_UINT, npy_uint, po, tmp);
+        CASE_FILTER_OUT(NPY_ULONG, npy_ulong, po, tmp);
+        CASE_FILTER_OUT(NPY_ULONGLONG, npy_ulonglong, po, tmp);
+        CASE_FILTER_OUT(NPY_BYTE, npy_byte, po, tmp);
+        CASE_FILTER_OUT(NPY_SHORT, npy_short, po, tmp);
+        CASE_FILTER_OUT(NPY_INT, npy_int, po, tmp);
+        CASE_FILTER_OUT(NPY_LONG, npy_long, po, tmp);
+        CASE_FILTER_OUT(NPY_LONGLONG, npy_longlong, po, tmp);
+        CASE_FILTER_OUT(NPY_FLOAT, npy_float, po, tmp);
+        CASE_FILTER_OUT(NPY_DOUBLE, npy_double, po, tmp);
+        default:
+            return 0;
+    }
+    return 1;
+}
+
+/* Select the rank from a copy of the window at every point: */
+static void _RankSelect(void *arg)
+{
+    NI_RankTask *task = (NI_RankTask *)arg;
+    npy_intp jj, *oo, filter_size = task->filter_size, rank = task->rank;
+    npy_intp border_flag_value = task->border_flag_value;
+    double *buffer = task->buffer, cvalue = task->cvalue;
+    char *pi, *po;
+
+    if (task->first >= task->last) {
+        return;
+    }
+    oo = _FilterGoto(task->fi, task->offsets, task->input, &task->ii,
+                     task->output, &task->io, task->first, &pi, &po);
+    for(jj = task->first; jj < task->last; jj++) {
+        double tmp = 0.0;
+        switch (PyArray_TYPE(task->input)) {
+            CASE_RANK_POINT(NPY_BOOL, npy_bool,
+                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
+                            border_flag_value);
+            CASE_RANK_POINT(NPY_UBYTE, npy_ubyte,
+                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
+                            border_flag_value);
+            CASE_RANK_POINT(NPY_USHORT, npy_ushort,
+                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
+                            border_flag_value);
+            CASE_RANK_POINT(NPY_UINT, npy_uint,
+                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
+                            border_flag_value);
+            CASE_RANK_POINT(NPY_ULONG, npy_ulong,
+                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
+                            border_flag_value);
+            CASE_RANK_POINT(NPY_ULONGLONG, npy_ulonglong,
+                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
+                            border_flag_value);
+            CASE_RANK_POINT(NPY_BYTE, npy_byte,
+                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
+                            border_flag_value);
+            CASE_RANK_POINT(NPY_SHORT, npy_short,
+                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
+                            border_flag_value);
+            CASE_RANK_POINT(NPY_INT, npy_int,
+                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
+                            border_flag_value);
+            CASE_RANK_POINT(NPY_LONG, npy_long,
+                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
+                            border_flag_value);
+            CASE_RANK_POINT(NPY_LONGLONG, npy_longlong,
+                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
+                            border_flag_value);
+            CASE_RANK_POINT(NPY_FLOAT, npy_float,
+                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
+                            border_flag_value);
+            CASE_RANK_POINT(NPY_DOUBLE, npy_double,
+                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
+                            border_flag_value);
+            default:
+                task->error = 1;
+                return;
+        }
+        if (!_WriteFilterOut(task->output, po, tmp)) {
+            task->error = 1;
+            return;
+        }
+        NI_FILTER_NEXT2(*task->fi, task->ii, task->io, oo, pi, po);
+    }
+}
+
+/*
+ * The window engines below slide the window along the last axis, and
+ * only update it with the footprint points that leave and enter it. The
+ * offsets of a footprint point may change on a step into another border
+ * region, but the value at a logical position does not, so the points
+ * that stay in the window keep their values. At the start of every line
+ * the window is built from scratch.
+ */
+#define RANK_WINDOW_VALUE(_type, _p, _offset, _bfv, _cval) \
+    ((_offset) == (_bfv) ? (_cval) : *(_type *)((_p) + (_offset)))
+
+/*
+ * A histogram of all 2**(2 * _shift) values of 8 and 16 bit integers,
+ * with a second level of 2**_shift coarse bins, so that a rank is found
+ * after scanning at most 2**(_shift + 1) bins (Perreault and Hebert,
+ * 2007). _bias maps the smallest value of the type to the first bin.
+ */
+#define DEFINE_RANK_HISTOGRAM(_name, _type, _bias, _shift)                 \
+static void _name(void *arg)                                               \
+{                                                                          \
+    NI_RankTask *task = (NI_RankTask *)arg;                                \
+    const npy_intp nfine = (npy_intp)1 << (2 * (_shift));                  \
+    npy_intp *fine = task->buffer, *coarse = fine + nfine;                 \
+    npy_intp jj, kk, *oo, *prev_oo = NULL, bfv = task->border_flag_value;  \
+    npy_intp filter_size = task->filter_size, rank = task->rank;           \
+    _type cval = (_type)task->cvalue;                                      \
+    char *pi, *po, *prev_pi = NULL;                                        \
+    int last_axis = task->ii.rank_m1;                                      \
+                                                                           \
+    if (task->first >= task->last) {                                      \
+        return;                                                            \
+    }                                                                      \
+    for(kk = 0; kk < nfine + (nfine >> (_shift)); kk++) {                  \
+        fine[kk] = 0;                                                      \
+    }                                                                      \
+    oo = _FilterGoto(task->fi, task->offsets, task->input, &task->ii,      \
+                     task->output, &task->io, task->first, &pi, &po);      \
+    for(jj = task->first; jj < task->last; jj++) {                         \
+        npy_intp bin, cc, acc = 0;                                         \
+        if (jj == task->first || task->ii.coordinates[last_axis] == 0) {   \
+            if (jj != task->first) {                                       \
+                for(kk = 0; kk < filter_size; kk++) {                      \
+                    bin = RANK_WINDOW_VALUE(_type, prev_pi, prev_oo[kk],   \
+                                            bfv, cval) + (_bias);          \
+                    --fine[bin];                                           \
+                    --coarse[bin >> (_shift)];                             \
+                }                                                          \
+            }                                                              \
+            for(kk = 0; kk < filter_size; kk++) {                          \
+                bin = RANK_WINDOW_VALUE(_type, pi, oo[kk], bfv, cval) +    \
+                      (_bias);                                             \
+                ++fine[bin];                                               \
+                ++coarse[bin >> (_shift)];                                 \
+            }                                                              \
+        } else {                                                           \
+            for(kk = 0; kk < task->nleave; kk++) {                         \
+                bin = RANK_WINDOW_VALUE(_type, prev_pi,                    \
+                                        prev_oo[task->leave[kk]],          \
+                                        bfv, cval) + (_bias);              \
+                --fine[bin];                                               \
+                --coarse[bin >> (_shift)];                                 \
+            }                                                              \
+            for(kk = 0; kk < task->nenter; kk++) {                         \
+                bin = RANK_WINDOW_VALUE(_type, pi, oo[task->enter[kk]],    \
+                                        bfv, cval) + (_bias);              \
+                ++fine[bin];                                               \
+                ++coarse[bin >> (_shift)];                                 \
+            }                                                              \
+        }                                                                  \
+        /* the coarse bin of the rank, then its fine bin: */               \
+        for(cc = 0; acc + coarse[cc] <= rank; cc++) {                      \
+            acc += coarse[cc];                                             \
+        }                                                                  \
+        for(bin = cc << (_shift); acc + fine[bin] <= rank; bin++) {        \
+            acc += fine[bin];                                              \
+        }                                                                  \
+        if (!_WriteFilterOut(task->output, po,                             \
+                             (double)(_type)(bin - (_bias)))) {            \
+            task->error = 1;                                               \
+            return;                                                        \
+        }                                                                  \
+        prev_pi = pi;                                                      \
+        prev_oo = oo;                                                      \
+        NI_FILTER_NEXT2(*task->fi, task->ii, task->io, oo, pi, po);        \
+    }                                                                      \
+}
+
+DEFINE_RANK_HISTOGRAM(_RankHistogramBool, npy_bool, 0, 4)
+DEFINE_RANK_HISTOGRAM(_RankHistogramUByte, npy_ubyte, 0, 4)
+DEFINE_RANK_HISTOGRAM(_RankHistogramByte, npy_byte, 128, 4)
+DEFINE_RANK_HISTOGRAM(_RankHistogramUShort, npy_ushort, 0, 8)
+DEFINE_RANK_HISTOGRAM(_RankHistogramShort, npy_short, 32768, 8)
+
+static int _CompareDoubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/* Remove a value that is in a sorted window of n values: */
+static void _SortedWindowRemove(double *window, npy_intp *n, double value)
+{
+    npy_intp lo = 0, hi = *n;
+
+    while (lo < hi) {
+        npy_intp mid = lo + (hi - lo) / 2;
+        if (window[mid] < value) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    memmove(window + lo, window + lo + 1, (*n - lo - 1) * sizeof(double));
+    --*n;
+}
+
+/* Insert a value into a sorted window of n values: */
+static void _SortedWindowInsert(double *window, npy_intp *n, double value)
+{
+    npy_intp lo = 0, hi = *n;
+
+    while (lo < hi) {
+        npy_intp mid = lo + (hi - lo) / 2;
+        if (window[mid] <= value) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    memmove(window + lo + 1, window + lo, (*n - lo) * sizeof(double));
+    window[lo] = value;
+    ++*n;
+}
+
+/*
+ * A sorted copy of the window, for footprints that change by only a few
+ * points on every step, of any type without NaNs.
+ */
+#define DEFINE_RANK_SORTED(_name, _type)                                   \
+static void _name(void *arg)                                               \
+{                                                                          \
+    NI_RankTask *task = (NI_RankTask *)arg;                                \
+    double *window = task->buffer;                                         \
+    double cval = (double)(_type)task->cvalue;                             \
+    npy_intp jj, kk, n = 0, *oo, *prev_oo = NULL;                          \
+    npy_intp bfv = task->border_flag_value;                                \
+    char *pi, *po, *prev_pi = NULL;                                        \
+    int last_axis = task->ii.rank_m1;                                      \
+                                                                           \
+    if (task->first >= task->last) {                                      \
+        return;                                                            \
+    }                                                                      \
+    oo = _FilterGoto(task->fi, task->offsets, task->input, &task->ii,      \
+                     task->output, &task->io, task->first, &pi, &po);      \
+    for(jj = task->first; jj < task->last; jj++) {                         \
+        if (jj == task->first || task->ii.coordinates[last_axis] == 0) {   \
+            for(n = 0; n < task->filter_size; n++) {                       \
+                window[n] = RANK_WINDOW_VALUE(_type, pi, oo[n], bfv,       \
+                                              cval);                       \
+            }                                                              \
+            qsort(window, n, sizeof(double), _CompareDoubles);             \
+        } else {                                                           \
+            for(kk = 0; kk < task->nleave; kk++) {                         \
+                _SortedWindowRemove(window, &n,                            \
+                        RANK_WINDOW_VALUE(_type, prev_pi,                  \
+                                          prev_oo[task->leave[kk]],        \
+                                          bfv, cval));                     \
+            }                                                              \
+            for(kk = 0; kk < task->nenter; kk++) {                         \
+                _SortedWindowInsert(window, &n,                            \
+                        RANK_WINDOW_VALUE(_type, pi, oo[task->enter[kk]],  \
+                                          bfv, cval));                     \
+            }                                                              \
+        }                                                                  \
+        if (!_WriteFilterOut(task->output, po,                             \
+                             (double)(_type)window[task->rank])) {         \
+            task->error = 1;                                               \
+            return;                                                        \
+        }                                                                  \
+        prev_pi = pi;                                                      \
+        prev_oo = oo;                                                      \
+        NI_FILTER_NEXT2(*task->fi, task->ii, task->io, oo, pi, po);        \
+    }                                                                      \
+}
+
+DEFINE_RANK_SORTED(_RankSortedBool, npy_bool)
+DEFINE_RANK_SORTED(_RankSortedUByte, npy_ubyte)
+DEFINE_RANK_SORTED(_RankSortedUShort, npy_ushort)
+DEFINE_RANK_SORTED(_RankSortedUInt, npy_uint)
+DEFINE_RANK_SORTED(_RankSortedULong, npy_ulong)
+DEFINE_RANK_SORTED(_RankSortedULongLong, npy_ulonglong)
+DEFINE_RANK_SORTED(_RankSortedByte, npy_byte)
+DEFINE_RANK_SORTED(_RankSortedShort, npy_short)
+DEFINE_RANK_SORTED(_RankSortedInt, npy_int)
+DEFINE_RANK_SORTED(_RankSortedLong, npy_long)
+DEFINE_RANK_SORTED(_RankSortedLongLong, npy_longlong)
+DEFINE_RANK_SORTED(_RankSortedFloat, npy_float)
+DEFINE_RANK_SORTED(_RankSortedDouble, npy_double)
+
+#undef DEFINE_RANK_HISTOGRAM
+#undef DEFINE_RANK_SORTED
+#undef RANK_WINDOW_VALUE
+
+#define CASE_HAS_NAN(_TYPE, _type, _pi, _size, _iterator, _res) \
+case _TYPE:                                                     \
+{                                                               \
+    npy_intp _ii;                                               \
+    for (_ii = 0; _ii < _size; ++_ii) {                         \
+        if (*(_type *)_pi != *(_type *)_pi) {                   \
+            _res = 1;                                           \
+            break;                                              \
+        }                                                       \
+        NI_ITERATOR_NEXT(_iterator, _pi);                       \
+    }                                                           \
+}                                                               \
+break
+
+/* Whether a floating point array holds a NaN, the only value that is not
+     equal to itself, with which a sorted window cannot be maintained: */
+static int _HasNaN(PyArrayObject *array)
+{
+    NI_Iterator ii;
+    char *pi = PyArray_BYTES(array);
+    npy_intp size = PyArray_SIZE(array);
+    int res = 0;
+
+    NI_InitPointIterator(array, &ii);
+    switch (PyArray_TYPE(array)) {
+        CASE_HAS_NAN(NPY_FLOAT, npy_float, pi, size, ii, res);
+        CASE_HAS_NAN(NPY_DOUBLE, npy_double, pi, size, ii, res);
+        default:
+            break;
+    }
+    return res;
+}
 
 int NI_RankFilter(PyArrayObject* input, int rank,
                   PyArrayObject* footprint, PyArrayObject* output,
-                  NI_ExtendMode mode, double cvalue, npy_intp *origins)
+                  NI_ExtendMode mode, double cvalue, npy_intp *origins,
+                  int workers)
 {
-    npy_intp fsize, jj, filter_size = 0, border_flag_value;
-    npy_intp *offsets = NULL, *oo, size;
+    npy_intp fsize, jj, kk, filter_size = 0, border_flag_value;
+    npy_intp *offsets = NULL, *leave = NULL, *enter = NULL;
+    npy_intp nleave = 0, nenter = 0, flength, size, line_length, lines;
+    npy_intp buffer_size;
     NI_FilterIterator fi;
-    NI_Iterator ii, io;
-    char *pi, *po;
+    NI_RankTask *tasks = NULL;
+    NI_ThreadFunction *engine = _RankSelect;
+    void **args = NULL;
     npy_bool *pf = NULL;
-    double *buffer = NULL;
-    int err = 0;
+    int ntasks = 1, err = 0, rank_m1 = PyArray_NDIM(input) - 1;
     NPY_BEGIN_THREADS_DEF;
 
     /* get the footprint: */
@@ -743,14 +1375,28 @@ int NI_RankFilter(PyArrayObject* input, int rank,
             ++filter_size;
         }
     }
-    /* buffer for rank calculation: */
-    buffer = malloc(filter_size * sizeof(double));
-    if (!buffer) {
+    /* the footprint points that leave the window on a step along the last
+         axis, and those that enter it, by their index in the offsets: */
+    leave = malloc(filter_size * sizeof(npy_intp));
+    enter = malloc(filter_size * sizeof(npy_intp));
+    if (!leave || !enter) {
         PyErr_NoMemory();
         goto exit;
     }
-    /* iterator over the elements: */
-    oo = offsets;
+    flength = rank_m1 >= 0 ? PyArray_DIM(footprint, rank_m1) : 1;
+    kk = 0;
+    for(jj = 0; jj < fsize; jj++) {
+        if (pf[jj]) {
+            npy_intp pos = jj % flength;
+            if (pos == 0 || !pf[jj - 1]) {
+                leave[nleave++] = kk;
+            }
+            if (pos == flength - 1 || !pf[jj + 1]) {
+                enter[nenter++] = kk;
+            }
+            ++kk;
+        }
+    }
     /* initialize filter offsets: */
     if (!NI_InitFilterOffsets(input, pf, PyArray_DIMS(footprint), origins,
                               mode, &offsets, &border_flag_value, NULL)) {
@@ -762,93 +1408,164 @@ int NI_RankFilter(PyArrayObject* input, int rank,
                                &fi)) {
         goto exit;
     }
-    /* initialize input element iterator: */
-    if (!NI_InitPointIterator(input, &ii))
-        goto exit;
-    /* initialize output element iterator: */
-    if (!NI_InitPointIterator(output, &io))
-        goto exit;
 
-    NPY_BEGIN_THREADS;
-    /* get data pointers an array size: */
-    pi = (void *)PyArray_DATA(input);
-    po = (void *)PyArray_DATA(output);
-    size = PyArray_SIZE(input);
-    /* iterator over the elements: */
-    oo = offsets;
-    for(jj = 0; jj < size; jj++) {
-        double tmp = 0.0;
+    /* Choose the engine with the least work per point: selection takes a
+         few times filter_size operations, a histogram the number of
+         changed points and the scan of its bins, and a sorted window the
+         changed points times the moves to keep it sorted. */
+    buffer_size = filter_size * sizeof(double);
+    if (rank_m1 >= 0 && nleave + nenter + 32 < filter_size) {
         switch (PyArray_TYPE(input)) {
-            CASE_RANK_POINT(NPY_BOOL, npy_bool,
-                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
-                            border_flag_value);
-            CASE_RANK_POINT(NPY_UBYTE, npy_ubyte,
-                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
-                            border_flag_value);
-            CASE_RANK_POINT(NPY_USHORT, npy_ushort,
-                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
-                            border_flag_value);
-            CASE_RANK_POINT(NPY_UINT, npy_uint,
-                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
-                            border_flag_value);
-            CASE_RANK_POINT(NPY_ULONG, npy_ulong,
-                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
-                            border_flag_value);
-            CASE_RANK_POINT(NPY_ULONGLONG, npy_ulonglong,
-                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
-                            border_flag_value);
-            CASE_RANK_POINT(NPY_BYTE, npy_byte,
-                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
-                            border_flag_value);
-            CASE_RANK_POINT(NPY_SHORT, npy_short,
-                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
-                            border_flag_value);
-            CASE_RANK_POINT(NPY_INT, npy_int,
-                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
-                            border_flag_value);
-            CASE_RANK_POINT(NPY_LONG, npy_long,
-                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
-                            border_flag_value);
-            CASE_RANK_POINT(NPY_LONGLONG, npy_longlong,
-                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
-                            border_flag_value);
-            CASE_RANK_POINT(NPY_FLOAT, npy_float,
-                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
-                            border_flag_value);
-            CASE_RANK_POINT(NPY_DOUBLE, npy_double,
-                            pi, oo, filter_size, cvalue, rank, buffer, tmp,
-                            border_flag_value);
-            default:
-                err = 1;
-                goto exit;
+        case NPY_BOOL:
+            engine = _RankHistogramBool;
+            break;
+        case NPY_UBYTE:
+            engine = _RankHistogramUByte;
+            break;
+        case NPY_BYTE:
+            engine = _RankHistogramByte;
+            break;
+        default:
+            break;
         }
-        switch (PyArray_TYPE(output)) {
-            CASE_FILTER_OUT(NPY_BOOL, npy_bool, po, tmp);
-            CASE_FILTER_OUT(NPY_UBYTE, npy_ubyte, po, tmp);
-            CASE_FILTER_OUT(NPY_USHORT, npy_ushort, po, tmp);
-            CASE_FILTER_OUT(NPY_UINT, npy_uint, po, tmp);
-            CASE_FILTER_OUT(NPY_ULONG, npy_ulong, po, tmp);
-            CASE_FILTER_OUT(NPY_ULONGLONG, npy_ulonglong, po, tmp);
-            CASE_FILTER_OUT(NPY_BYTE, npy_byte, po, tmp);
-            CASE_FILTER_OUT(NPY_SHORT, npy_short, po, tmp);
-            CASE_FILTER_OUT(NPY_INT, npy_int, po, tmp);
-            CASE_FILTER_OUT(NPY_LONG, npy_long, po, tmp);
-            CASE_FILTER_OUT(NPY_LONGLONG, npy_longlong, po, tmp);
-            CASE_FILTER_OUT(NPY_FLOAT, npy_float, po, tmp);
-            CASE_FILTER_OUT(NPY_DOUBLE, npy_double, po, tmp);
-            default:
-                err = 1;
-                goto exit;
+        if (engine != _RankSelect) {
+            buffer_size = ((1 << 8) + (1 << 4)) * sizeof(npy_intp);
         }
-        NI_FILTER_NEXT2(fi, ii, io, oo, pi, po);
     }
-exit:
+    if (rank_m1 >= 0 && nleave + nenter + 512 < filter_size) {
+        switch (PyArray_TYPE(input)) {
+        case NPY_USHORT:
+            engine = _RankHistogramUShort;
+            break;
+        case NPY_SHORT:
+            engine = _RankHistogramShort;
+            break;
+        default:
+            break;
+        }
+        if (engine == _RankHistogramUShort || engine == _RankHistogramShort) {
+            buffer_size = ((1 << 16) + (1 << 8)) * sizeof(npy_intp);
+        }
+    }
+    if (engine == _RankSelect && rank_m1 >= 0 &&
+            nleave + nenter <= 4 && filter_size >= 16 && !_HasNaN(input)) {
+        switch (PyArray_TYPE(input)) {
+        case NPY_BOOL:
+            engine = _RankSortedBool;
+            break;
+        case NPY_UBYTE:
+            engine = _RankSortedUByte;
+            break;
+        case NPY_USHORT:
+            engine = _RankSortedUShort;
+            break;
+        case NPY_UINT:
+            engine = _RankSortedUInt;
+            break;
+        case NPY_ULONG:
+            engine = _RankSortedULong;
+            break;
+        case NPY_ULONGLONG:
+            engine = _RankSortedULongLong;
+            break;
+        case NPY_BYTE:
+            engine = _RankSortedByte;
+            break;
+        case NPY_SHORT:
+            engine = _RankSortedShort;
+            break;
+        case NPY_INT:
+            engine = _RankSortedInt;
+            break;
+        case NPY_LONG:
+            engine = _RankSortedLong;
+            break;
+        case NPY_LONGLONG:
+            engine = _RankSortedLongLong;
+            break;
+        case NPY_FLOAT:
+            engine = _RankSortedFloat;
+            break;
+        case NPY_DOUBLE:
+            engine = _RankSortedDouble;
+            break;
+        default:
+            break;
+        }
+    }
+
+    /* split the output into blocks of whole lines, one for each thread,
+         if the threads cannot see each other's output: */
+    size = PyArray_SIZE(input);
+    line_length = rank_m1 >= 0 ? PyArray_DIM(input, rank_m1) : 1;
+    lines = line_length > 0 ? size / line_length : 0;
+    if (workers > 1 && lines > 1 && !NI_ArraysOverlap(input, output)) {
+        npy_intp max_tasks = size / RANK_MIN_POINTS_PER_THREAD;
+        if (max_tasks > lines) {
+            max_tasks = lines;
+        }
+        if (max_tasks < workers) {
+            workers = max_tasks > 1 ? (int)max_tasks : 1;
+        }
+        ntasks = workers;
+    }
+    tasks = calloc(ntasks, sizeof(NI_RankTask));
+    args = malloc(ntasks * sizeof(void *));
+    if (!tasks || !args) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+    for(kk = 0; kk < ntasks; kk++) {
+        NI_RankTask *task = tasks + kk;
+
+        /* initialize the element iterators of the task: */
+        if (!NI_InitPointIterator(input, &task->ii))
+            goto exit;
+        if (!NI_InitPointIterator(output, &task->io))
+            goto exit;
+        task->buffer = malloc(buffer_size);
+        if (!task->buffer) {
+            PyErr_NoMemory();
+            goto exit;
+        }
+        task->input = input;
+        task->output = output;
+        task->fi = &fi;
+        task->offsets = offsets;
+        task->leave = leave;
+        task->enter = enter;
+        task->nleave = nleave;
+        task->nenter = nenter;
+        task->filter_size = filter_size;
+        task->border_flag_value = border_flag_value;
+        task->rank = rank;
+        task->cvalue = cvalue;
+        task->first = lines * kk / ntasks * line_length;
+        task->last = lines * (kk + 1) / ntasks * line_length;
+        args[kk] = task;
+    }
+
+    NPY_BEGIN_THREADS;
+    NI_RunThreads(ntasks, engine, args);
     NPY_END_THREADS;
-    if (err == 1) {
+
+    for(kk = 0; kk < ntasks; kk++) {
+        err |= tasks[kk].error;
+    }
+    if (err) {
         PyErr_SetString(PyExc_RuntimeError, "array type not supported");
     }
+exit:
+    if (tasks) {
+        for(kk = 0; kk < ntasks; kk++) {
+            free(tasks[kk].buffer);
+        }
+    }
+    free(tasks);
+    free(args);
     free(offsets);
-    free(buffer);
+    free(leave);
+    free(enter);
     return PyErr_Occurred() ? 0 : 1;
 }
 
@@ -1056,3 +1773,363 @@ exit:
     free(buffer);
     return PyErr_Occurred() ? 0 : 1;
 }
+
+/* Number of neighbourhoods, or lines, handed to one call of a batched
+     generic filter function: */
+#define GENERIC_FILTER_BATCH 256
+
+/* Minimum number of points that justifies another generic filter
+     thread: */
+#define GENERIC_MIN_POINTS_PER_THREAD 16384
+
+#define CASE_GATHER_POINT(_TYPE, _type, _pi, _offsets, _filter_size,  \
+                          _cvalue, _mv, _buffer)                      \
+case _TYPE:                                                           \
+{                                                                     \
+    npy_intp _ii;                                                     \
+    for (_ii = 0; _ii < _filter_size; ++_ii) {                        \
+        const npy_intp _offset = _offsets[_ii];                       \
+        if (_offset == _mv) {                                         \
+            _buffer[_ii] = (double)_cvalue;                           \
+        }                                                             \
+        else {                                                        \
+            _buffer[_ii] = (double)(*(_type*)(_pi + _offset));        \
+        }                                                             \
+    }                                                                 \
+}                                                                     \
+break
+
+/* The range of output points of one batched generic filter thread: */
+typedef struct {
+    PyArrayObject *input, *output;
+    NI_FilterIterator *fi;
+    NI_Iterator ii, io;
+    NI_GenericBatchFunction *function;
+    void *data;
+    npy_intp *offsets;
+    npy_intp filter_size, border_flag_value, first, last;
+    double cvalue;
+    /* the gathered neighbourhoods of a batch, their results, and where
+         the results go: */
+    double *buffer, *values;
+    char **outputs;
+    int error;
+} NI_GenericTask;
+
+static void _GenericTask(void *arg)
+{
+    NI_GenericTask *task = (NI_GenericTask *)arg;
+    npy_intp jj, kk, count = 0, *oo, filter_size = task->filter_size;
+    npy_intp border_flag_value = task->border_flag_value;
+    double cvalue = task->cvalue;
+    char *pi, *po;
+
+    if (task->first >= task->last) {
+        return;
+    }
+    oo = _FilterGoto(task->fi, task->offsets, task->input, &task->ii,
+                     task->output, &task->io, task->first, &pi, &po);
+    for(jj = task->first; jj < task->last; jj++) {
+        double *buffer = task->buffer + count * filter_size;
+        switch (PyArray_TYPE(task->input)) {
+            CASE_GATHER_POINT(NPY_BOOL, npy_bool, pi, oo, filter_size,
+                              cvalue, border_flag_value, buffer);
+            CASE_GATHER_POINT(NPY_UBYTE, npy_ubyte, pi, oo, filter_size,
+                              cvalue, border_flag_value, buffer);
+            CASE_GATHER_POINT(NPY_USHORT, npy_ushort, pi, oo, filter_size,
+                              cvalue, border_flag_value, buffer);
+            CASE_GATHER_POINT(NPY_UINT, npy_uint, pi, oo, filter_size,
+                              cvalue, border_flag_value, buffer);
+            CASE_GATHER_POINT(NPY_ULONG, npy_ulong, pi, oo, filter_size,
+                              cvalue, border_flag_value, buffer);
+            CASE_GATHER_POINT(NPY_ULONGLONG, npy_ulonglong, pi, oo,
+                              filter_size, cvalue, border_flag_value,
+                              buffer);
+            CASE_GATHER_POINT(NPY_BYTE, npy_byte, pi, oo, filter_size,
+                              cvalue, border_flag_value, buffer);
+            CASE_GATHER_POINT(NPY_SHORT, npy_short, pi, oo, filter_size,
+                              cvalue, border_flag_value, buffer);
+            CASE_GATHER_POINT(NPY_INT, npy_int, pi, oo, filter_size,
+                              cvalue, border_flag_value, buffer);
+            CASE_GATHER_POINT(NPY_LONG, npy_long, pi, oo, filter_size,
+                              cvalue, border_flag_value, buffer);
+            CASE_GATHER_POINT(NPY_LONGLONG, npy_longlong, pi, oo,
+                              filter_size, cvalue, border_flag_value,
+                              buffer);
+            CASE_GATHER_POINT(NPY_FLOAT, npy_float, pi, oo, filter_size,
+                              cvalue, border_flag_value, buffer);
+            CASE_GATHER_POINT(NPY_DOUBLE, npy_double, pi, oo, filter_size,
+                              cvalue, border_flag_value, buffer);
+            default:
+                task->error = 1;
+                return;
+        }
+        task->outputs[count++] = po;
+        /* filter a full batch, or the rest of the range: */
+        if (count == GENERIC_FILTER_BATCH || jj == task->last - 1) {
+            if (!task->function(task->buffer, filter_size, count,
+                                task->values, task->data)) {
+                task->error = 2;
+                return;
+            }
+            for(kk = 0; kk < count; kk++) {
+                if (!_WriteFilterOut(task->output, task->outputs[kk],
+                                     task->values[kk])) {
+                    task->error = 1;
+                    return;
+                }
+            }
+            count = 0;
+        }
+        NI_FILTER_NEXT2(*task->fi, task->ii, task->io, oo, pi, po);
+    }
+}
+
+/* Like NI_GenericFilter, but the function filters a batch of
+     neighbourhoods at a time, on up to workers threads, without the GIL: */
+int NI_GenericFilterBatched(PyArrayObject* input,
+            NI_GenericBatchFunction *function, void *data,
+            PyArrayObject* footprint, PyArrayObject* output,
+            NI_ExtendMode mode, double cvalue, npy_intp *origins,
+            int workers)
+{
+    npy_bool *pf = NULL;
+    npy_intp fsize, jj, filter_size = 0, border_flag_value;
+    npy_intp *offsets = NULL, size, line_length, lines;
+    NI_FilterIterator fi;
+    NI_GenericTask *tasks = NULL;
+    void **args = NULL;
+    int kk, ntasks = 1, err = 0, rank_m1 = PyArray_NDIM(input) - 1;
+    NPY_BEGIN_THREADS_DEF;
+
+    /* get the footprint: */
+    fsize = PyArray_SIZE(footprint);
+    pf = (npy_bool*)PyArray_DATA(footprint);
+    for(jj = 0; jj < fsize; jj++) {
+        if (pf[jj])
+            ++filter_size;
+    }
+    /* initialize filter offsets: */
+    if (!NI_InitFilterOffsets(input, pf, PyArray_DIMS(footprint), origins,
+                              mode, &offsets, &border_flag_value, NULL)) {
+        goto exit;
+    }
+    /* initialize filter iterator: */
+    if (!NI_InitFilterIterator(PyArray_NDIM(input), PyArray_DIMS(footprint),
+                               filter_size, PyArray_DIMS(input), origins,
+                               &fi)) {
+        goto exit;
+    }
+    /* split the output into blocks of whole lines, one for each thread,
+         if the threads cannot see each other's output: */
+    size = PyArray_SIZE(input);
+    line_length = rank_m1 >= 0 ? PyArray_DIM(input, rank_m1) : 1;
+    lines = line_length > 0 ? size / line_length : 0;
+    if (workers > 1 && lines > 1 && !NI_ArraysOverlap(input, output)) {
+        npy_intp max_tasks = size / GENERIC_MIN_POINTS_PER_THREAD;
+        if (max_tasks > lines) {
+            max_tasks = lines;
+        }
+        if (max_tasks < workers) {
+            workers = max_tasks > 1 ? (int)max_tasks : 1;
+        }
+        ntasks = workers;
+    }
+    tasks = calloc(ntasks, sizeof(NI_GenericTask));
+    args = malloc(ntasks * sizeof(void *));
+    if (!tasks || !args) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+    for(kk = 0; kk < ntasks; kk++) {
+        NI_GenericTask *task = tasks + kk;
+
+        /* initialize the element iterators of the task: */
+        if (!NI_InitPointIterator(input, &task->ii))
+            goto exit;
+        if (!NI_InitPointIterator(output, &task->io))
+            goto exit;
+        task->buffer = malloc(GENERIC_FILTER_BATCH * (filter_size + 1) *
+                              sizeof(double));
+        task->outputs = malloc(GENERIC_FILTER_BATCH * sizeof(char *));
+        if (!task->buffer || !task->outputs) {
+            PyErr_NoMemory();
+            goto exit;
+        }
+        task->values = task->buffer + GENERIC_FILTER_BATCH * filter_size;
+        task->input = input;
+        task->output = output;
+        task->fi = &fi;
+        task->function = function;
+        task->data = data;
+        task->offsets = offsets;
+        task->filter_size = filter_size;
+        task->border_flag_value = border_flag_value;
+        task->cvalue = cvalue;
+        task->first = lines * kk / ntasks * line_length;
+        task->last = lines * (kk + 1) / ntasks * line_length;
+        args[kk] = task;
+    }
+
+    NPY_BEGIN_THREADS;
+    NI_RunThreads(ntasks, _GenericTask, args);
+    NPY_END_THREADS;
+
+    for(kk = 0; kk < ntasks; kk++) {
+        err |= tasks[kk].error;
+    }
+    if (err & 2) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "unknown error in filter function");
+    }
+    else if (err) {
+        PyErr_SetString(PyExc_RuntimeError, "array type not supported");
+    }
+exit:
+    if (tasks) {
+        for(kk = 0; kk < ntasks; kk++) {
+            free(tasks[kk].buffer);
+            free(tasks[kk].outputs);
+        }
+    }
+    free(tasks);
+    free(args);
+    free(offsets);
+    return PyErr_Occurred() ? 0 : 1;
+}
+
+/* The lines of one batched generic 1D filter thread, with its own line
+     buffers: */
+typedef struct {
+    NI_LineBuffer iline_buffer, oline_buffer;
+    double *ibuffer, *obuffer;
+    NI_GenericLinesFunction *function;
+    void *data;
+    npy_intp length, size1, size2;
+    int error;
+} NI_GenericLinesTask;
+
+static void _GenericLinesTask(void *arg)
+{
+    NI_GenericLinesTask *task = (NI_GenericLinesTask *)arg;
+    npy_intp lines;
+    int more;
+
+    do {
+        /* copy lines from array to buffer: */
+        if (!NI_ArrayToLineBuffer(&task->iline_buffer, &lines, &more)) {
+            task->error = 1;
+            return;
+        }
+        /* the lines in a buffer follow each other, so they are filtered
+             in one call: */
+        if (lines > 0 &&
+                !task->function(task->ibuffer,
+                                task->length + task->size1 + task->size2,
+                                task->obuffer, task->length, lines,
+                                task->data)) {
+            task->error = 2;
+            return;
+        }
+        /* copy lines from buffer to array: */
+        if (!NI_LineBufferToArray(&task->oline_buffer)) {
+            task->error = 1;
+            return;
+        }
+    } while(more);
+}
+
+/* Like NI_GenericFilter1D, but the function filters all the lines of a
+     line buffer at a time, on up to workers threads, without the GIL: */
+int NI_GenericFilter1DBatched(PyArrayObject *input,
+            NI_GenericLinesFunction *function, void* data,
+            npy_intp filter_size, int axis, PyArrayObject *output,
+            NI_ExtendMode mode, double cval, npy_intp origin, int workers)
+{
+    NI_GenericLinesTask *tasks = NULL;
+    void **args = NULL;
+    npy_intp lines, array_lines, length, size, size1, size2;
+    int kk, ntasks = 1, err = 0;
+    NPY_BEGIN_THREADS_DEF;
+
+    size1 = filter_size / 2;
+    size2 = filter_size - size1 - 1;
+    length = PyArray_NDIM(input) > 0 ? PyArray_DIM(input, axis) : 1;
+    size = PyArray_SIZE(input);
+    array_lines = length > 0 ? size / length : 0;
+    if (workers > 1 && array_lines > 1 &&
+            !NI_ArraysOverlap(input, output)) {
+        npy_intp max_tasks = size / GENERIC_MIN_POINTS_PER_THREAD;
+        if (max_tasks > array_lines) {
+            max_tasks = array_lines;
+        }
+        if (max_tasks < workers) {
+            workers = max_tasks > 1 ? (int)max_tasks : 1;
+        }
+        ntasks = workers;
+    }
+    tasks = calloc(ntasks, sizeof(NI_GenericLinesTask));
+    args = malloc(ntasks * sizeof(void *));
+    if (!tasks || !args) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+    /* allocate and initialize the line buffers of each task: */
+    for(kk = 0; kk < ntasks; kk++) {
+        NI_GenericLinesTask *task = tasks + kk;
+        npy_intp first = array_lines * kk / ntasks;
+        npy_intp last = array_lines * (kk + 1) / ntasks;
+
+        args[kk] = task;
+        lines = -1;
+        if (!NI_AllocateLineBuffer(input, axis, size1 + origin,
+                                   size2 - origin, &lines, BUFFER_SIZE,
+                                   &task->ibuffer))
+            goto exit;
+        if (last > first && lines > last - first) {
+            lines = last - first;
+        }
+        if (!NI_AllocateLineBuffer(output, axis, 0, 0, &lines, BUFFER_SIZE,
+                                   &task->obuffer))
+            goto exit;
+        if (!NI_InitLineBuffer(input, axis, size1 + origin, size2 - origin,
+                               lines, task->ibuffer, mode, cval,
+                               &task->iline_buffer))
+            goto exit;
+        if (!NI_InitLineBuffer(output, axis, 0, 0, lines, task->obuffer,
+                               mode, 0.0, &task->oline_buffer))
+            goto exit;
+        NI_LineBufferSetRange(&task->iline_buffer, first, last);
+        NI_LineBufferSetRange(&task->oline_buffer, first, last);
+        task->function = function;
+        task->data = data;
+        task->length = length;
+        task->size1 = size1;
+        task->size2 = size2;
+    }
+
+    NPY_BEGIN_THREADS;
+    NI_RunThreads(ntasks, _GenericLinesTask, args);
+    NPY_END_THREADS;
+
+    for(kk = 0; kk < ntasks; kk++) {
+        err |= tasks[kk].error;
+    }
+    if (err & 2) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "unknown error in line processing function");
+    }
+    else if (err && !PyErr_Occurred()) {
+        PyErr_SetString(PyExc_RuntimeError, "line filter failed");
+    }
+exit:
+    if (tasks) {
+        for(kk = 0; kk < ntasks; kk++) {
+            free(tasks[kk].ibuffer);
+            free(tasks[kk].obuffer);
+        }
+    }
+    free(tasks);
+    free(args);
+    return PyErr_Occurred() ? 0 : 1;
+}
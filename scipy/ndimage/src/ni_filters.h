@@ -33,22 +33,40 @@
 #define NI_FILTERS_H
 
 int NI_Correlate1D(PyArrayObject*, PyArrayObject*, int, PyArrayObject*,
-                   NI_ExtendMode, double, npy_intp);
+                   NI_ExtendMode, double, npy_intp, int, int);
 int NI_Correlate(PyArrayObject*, PyArrayObject*, PyArrayObject*,
-                 NI_ExtendMode, double, npy_intp*);
+                 NI_ExtendMode, double, npy_intp*, int);
 int NI_UniformFilter1D(PyArrayObject*, npy_intp, int, PyArrayObject*,
-                       NI_ExtendMode, double, npy_intp);
+                       NI_ExtendMode, double, npy_intp, int);
 int NI_MinOrMaxFilter1D(PyArrayObject*, npy_intp, int, PyArrayObject*,
-                        NI_ExtendMode, double, npy_intp, int);
+                        NI_ExtendMode, double, npy_intp, int, int);
 int NI_MinOrMaxFilter(PyArrayObject*, PyArrayObject*, PyArrayObject*,
                       PyArrayObject*, NI_ExtendMode, double, npy_intp*,
                                             int);
 int NI_RankFilter(PyArrayObject*, int, PyArrayObject*, PyArrayObject*,
-                                    NI_ExtendMode, double, npy_intp*);
+                                    NI_ExtendMode, double, npy_intp*, int);
 int NI_GenericFilter1D(PyArrayObject*, int (*)(double*, npy_intp,
                        double*, npy_intp, void*), void*, npy_intp, int,
                        PyArrayObject*, NI_ExtendMode, double, npy_intp);
 int NI_GenericFilter(PyArrayObject*, int (*)(double*, npy_intp, double*,
                                          void*), void*, PyArrayObject*, PyArrayObject*,
                      NI_ExtendMode, double, npy_intp*);
+
+/* Filter a batch of neighbourhoods: the neighbourhoods one after the other,
+     the filter size, the number of neighbourhoods, the results, and the
+     callback data: */
+typedef int (NI_GenericBatchFunction)(double*, npy_intp, npy_intp, double*,
+                                      void*);
+/* Filter a batch of lines: the extended input lines one after the other,
+     their length, the output lines, their length, the number of lines, and
+     the callback data: */
+typedef int (NI_GenericLinesFunction)(double*, npy_intp, double*, npy_intp,
+                                      npy_intp, void*);
+
+int NI_GenericFilter1DBatched(PyArrayObject*, NI_GenericLinesFunction*,
+                              void*, npy_intp, int, PyArrayObject*,
+                              NI_ExtendMode, double, npy_intp, int);
+int NI_GenericFilterBatched(PyArrayObject*, NI_GenericBatchFunction*, void*,
+                            PyArrayObject*, PyArrayObject*, NI_ExtendMode,
+                            double, npy_intp*, int);
 #endif
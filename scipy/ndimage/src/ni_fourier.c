@@ -31,6 +31,7 @@
 
 #include "ni_support.h"
 #include "ni_fourier.h"
+#include "ni_threads.h"
 #include <stdlib.h>
 #include <math.h>
 #include <assert.h>
@@ -153,45 +154,356 @@ static double _bessel_j1(double x)
     return p * SQ2OPI / sqrt(x);
 }
 
-#define CASE_FOURIER_OUT_RR(_TYPE, _type, _po, _tmp) \
-case _TYPE:                                          \
-    *(_type *)_po = _tmp;                            \
-    break
-
-#define CASE_FOURIER_OUT_RC(_TYPE, _type, _po, _tmp) \
-case _TYPE:                                          \
-    ((_type *)_po)->real = tmp;                      \
-    ((_type *)_po)->imag = 0.0;                      \
-    break
-
-#define CASE_FOURIER_OUT_CC(_TYPE, _type, _po, _tmp_r, _tmp_i) \
-case _TYPE:                                                    \
-    ((_type *)_po)->real = _tmp_r;                             \
-    ((_type *)_po)->imag = _tmp_i;                             \
-    break
-
-#define CASE_FOURIER_FILTER_RC(_TYPE, _type, _pi, _tmp, _tmp_r, _tmp_i) \
-case _TYPE:                                                             \
-    _tmp_r = ((_type *)_pi)->real * _tmp;                               \
-    _tmp_i = ((_type *)_pi)->imag * _tmp;                               \
-    break
-
-#define CASE_FOURIER_FILTER_RR(_TYPE, _type, _pi, _tmp) \
-case _TYPE:                                             \
-    _tmp *= *(_type *)_pi;                              \
-    break
+/* Minimum number of elements that justifies another thread: */
+#define FOURIER_MIN_WORK_PER_THREAD 65536
+
+#define CASE_FOURIER_READ_R(_TYPE, _type, _pi, _stride, _length, _re, _im) \
+case _TYPE:                                                                \
+{                                                                          \
+    npy_intp _jj;                                                          \
+    for (_jj = 0; _jj < _length; _jj++) {                                  \
+        _re[_jj] = *(_type *)(_pi + _jj * _stride);                        \
+        _im[_jj] = 0.0;                                                    \
+    }                                                                      \
+}                                                                          \
+break
+
+#define CASE_FOURIER_READ_C(_TYPE, _type, _pi, _stride, _length, _re, _im) \
+case _TYPE:                                                                \
+{                                                                          \
+    npy_intp _jj;                                                          \
+    for (_jj = 0; _jj < _length; _jj++) {                                  \
+        _re[_jj] = ((_type *)(_pi + _jj * _stride))->real;                 \
+        _im[_jj] = ((_type *)(_pi + _jj * _stride))->imag;                 \
+    }                                                                      \
+}                                                                          \
+break
+
+#define CASE_FOURIER_WRITE_R(_TYPE, _type, _po, _stride, _length, _re) \
+case _TYPE:                                                            \
+{                                                                      \
+    npy_intp _jj;                                                      \
+    for (_jj = 0; _jj < _length; _jj++) {                              \
+        *(_type *)(_po + _jj * _stride) = _re[_jj];                    \
+    }                                                                  \
+}                                                                      \
+break
+
+#define CASE_FOURIER_WRITE_C(_TYPE, _type, _po, _stride, _length, _re, _im) \
+case _TYPE:                                                                 \
+{                                                                           \
+    npy_intp _jj;                                                           \
+    for (_jj = 0; _jj < _length; _jj++) {                                   \
+        ((_type *)(_po + _jj * _stride))->real = _re[_jj];                  \
+        ((_type *)(_po + _jj * _stride))->imag = _im[_jj];                  \
+    }                                                                       \
+}                                                                           \
+break
+
+/* The lines along the last axis of one Fourier filter thread. The tables
+     hold a factor, or the cosine and sine of a phase, for every frequency
+     of each axis, or are NULL for axes of length one: */
+typedef struct {
+    PyArrayObject *input, *output;
+    double **params, **sines;
+    int filter_type;
+    npy_intp first, last;
+    /* the line, split into real and imaginary parts, and its factors or
+         phases: */
+    double *re, *im, *fr, *fi;
+    int error;
+} NI_FourierTask;
+
+/* Read a line of the input into separate real and imaginary parts: */
+static int _FourierReadLine(PyArrayObject *input, char *pi, npy_intp length,
+                            double *re, double *im)
+{
+    const int rank_m1 = PyArray_NDIM(input) - 1;
+    const npy_intp stride = rank_m1 >= 0 ? PyArray_STRIDE(input, rank_m1) : 0;
+
+    switch (PyArray_TYPE(input)) {
+        CASE_FOURIER_READ_R(NPY_BOOL, npy_bool, pi, stride, length, re, im);
+        CASE_FOURIER_READ_R(NPY_UBYTE, npy_ubyte, pi, stride, length, re, im);
+        CASE_FOURIER_READ_R(NPY_USHORT, npy_ushort,
+                            pi, stride, length, re, im);
+        CASE_FOURIER_READ_R(NPY_UINT, npy_uint, pi, stride, length, re, im);
+        CASE_FOURIER_READ_R(NPY_ULONG, npy_ulong, pi, stride, length, re, im);
+        CASE_FOURIER_READ_R(NPY_ULONGLONG, npy_ulonglong,
+                            pi, stride, length, re, im);
+        CASE_FOURIER_READ_R(NPY_BYTE, npy_byte, pi, stride, length, re, im);
+        CASE_FOURIER_READ_R(NPY_SHORT, npy_short, pi, stride, length, re, im);
+        CASE_FOURIER_READ_R(NPY_INT, npy_int, pi, stride, length, re, im);
+        CASE_FOURIER_READ_R(NPY_LONG, npy_long, pi, stride, length, re, im);
+        CASE_FOURIER_READ_R(NPY_LONGLONG, npy_longlong,
+                            pi, stride, length, re, im);
+        CASE_FOURIER_READ_R(NPY_FLOAT, npy_float, pi, stride, length, re, im);
+        CASE_FOURIER_READ_R(NPY_DOUBLE, npy_double,
+                            pi, stride, length, re, im);
+        CASE_FOURIER_READ_C(NPY_CFLOAT, npy_cfloat,
+                            pi, stride, length, re, im);
+        CASE_FOURIER_READ_C(NPY_CDOUBLE, npy_cdouble,
+                            pi, stride, length, re, im);
+    default:
+        return 0;
+    }
+    return 1;
+}
+
+/* Write a line to the output, dropping the imaginary part if the output
+     is real: */
+static int _FourierWriteLine(PyArrayObject *output, char *po,
+                             npy_intp length, double *re, double *im)
+{
+    const int rank_m1 = PyArray_NDIM(output) - 1;
+    const npy_intp stride = rank_m1 >= 0 ? PyArray_STRIDE(output, rank_m1) : 0;
+
+    switch (PyArray_TYPE(output)) {
+        CASE_FOURIER_WRITE_R(NPY_FLOAT, npy_float, po, stride, length, re);
+        CASE_FOURIER_WRITE_R(NPY_DOUBLE, npy_double, po, stride, length, re);
+        CASE_FOURIER_WRITE_C(NPY_CFLOAT, npy_cfloat,
+                             po, stride, length, re, im);
+        CASE_FOURIER_WRITE_C(NPY_CDOUBLE, npy_cdouble,
+                             po, stride, length, re, im);
+    default:
+        return 0;
+    }
+    return 1;
+}
+
+/* Move to the line with the given index, returning the data pointers of
+     the input and output, and the coordinates of the line: */
+static void _FourierGotoLine(PyArrayObject *input, PyArrayObject *output,
+                             npy_intp line, npy_intp *coordinates,
+                             char **pi, char **po)
+{
+    int kk;
+
+    *pi = PyArray_BYTES(input);
+    *po = PyArray_BYTES(output);
+    for (kk = PyArray_NDIM(input) - 2; kk >= 0; kk--) {
+        coordinates[kk] = line % PyArray_DIM(input, kk);
+        line /= PyArray_DIM(input, kk);
+        *pi += coordinates[kk] * PyArray_STRIDE(input, kk);
+        *po += coordinates[kk] * PyArray_STRIDE(output, kk);
+    }
+}
+
+static void _FourierFilterTask(void *arg)
+{
+    NI_FourierTask *task = (NI_FourierTask *)arg;
+    PyArrayObject *input = task->input;
+    const int rank = PyArray_NDIM(input), rank_m1 = rank - 1;
+    const npy_intp length = rank > 0 ? PyArray_DIM(input, rank_m1) : 1;
+    double **params = task->params, *re = task->re, *im = task->im;
+    double *fr = task->fr, *last = rank > 0 ? params[rank_m1] : NULL;
+    npy_intp coordinates[NPY_MAXDIMS], line, jj;
+    int kk;
+
+    for (line = task->first; line < task->last; line++) {
+        char *pi, *po;
+        double outer;
+
+        _FourierGotoLine(input, task->output, line, coordinates, &pi, &po);
+        /* the factor of the outer axes, and those of the line: */
+        if (task->filter_type == _NI_ELLIPSOID) {
+            outer = 0.0;
+            for (kk = 0; kk < rank_m1; kk++) {
+                if (params[kk]) {
+                    outer += params[kk][coordinates[kk]];
+                }
+            }
+            for (jj = 0; jj < length; jj++) {
+                double tmp = outer + (last ? last[jj] : 0.0);
+                switch (rank) {
+                case 1:
+                    fr[jj] = tmp > 0.0 ? sin(tmp) / tmp : 1.0;
+                    break;
+                case 2:
+                    tmp = sqrt(tmp);
+                    fr[jj] = tmp > 0.0 ? 2.0 * _bessel_j1(tmp) / tmp : 1.0;
+                    break;
+                case 3:
+                    tmp = sqrt(tmp);
+                    fr[jj] = tmp > 0.0 ?
+                        3.0 * (sin(tmp) - tmp * cos(tmp)) / (tmp * tmp * tmp)
+                        : 1.0;
+                    break;
+                default:
+                    fr[jj] = 1.0;
+                    break;
+                }
+            }
+        }
+        else {
+            outer = 1.0;
+            for (kk = 0; kk < rank_m1; kk++) {
+                if (params[kk]) {
+                    outer *= params[kk][coordinates[kk]];
+                }
+            }
+            for (jj = 0; jj < length; jj++) {
+                fr[jj] = last ? outer * last[jj] : outer;
+            }
+        }
+        if (!_FourierReadLine(input, pi, length, re, im)) {
+            task->error = 1;
+            return;
+        }
+        for (jj = 0; jj < length; jj++) {
+            re[jj] *= fr[jj];
+            im[jj] *= fr[jj];
+        }
+        if (!_FourierWriteLine(task->output, po, length, re, im)) {
+            task->error = 1;
+            return;
+        }
+    }
+}
+
+static void _FourierShiftTask(void *arg)
+{
+    NI_FourierTask *task = (NI_FourierTask *)arg;
+    PyArrayObject *input = task->input;
+    const int rank = PyArray_NDIM(input), rank_m1 = rank - 1;
+    const npy_intp length = rank > 0 ? PyArray_DIM(input, rank_m1) : 1;
+    double **cosines = task->params, **sines = task->sines;
+    double *re = task->re, *im = task->im, *fr = task->fr, *fi = task->fi;
+    double *last_c = rank > 0 ? cosines[rank_m1] : NULL;
+    double *last_s = rank > 0 ? sines[rank_m1] : NULL;
+    npy_intp coordinates[NPY_MAXDIMS], line, jj;
+    int kk;
+
+    for (line = task->first; line < task->last; line++) {
+        char *pi, *po;
+        double outer_c = 1.0, outer_s = 0.0;
+
+        _FourierGotoLine(input, task->output, line, coordinates, &pi, &po);
+        /* the phase of the outer axes is the product of their phases: */
+        for (kk = 0; kk < rank_m1; kk++) {
+            if (cosines[kk]) {
+                const double c = cosines[kk][coordinates[kk]];
+                const double s = sines[kk][coordinates[kk]];
+                const double tmp = outer_c * c - outer_s * s;
+                outer_s = outer_c * s + outer_s * c;
+                outer_c = tmp;
+            }
+        }
+        if (last_c) {
+            for (jj = 0; jj < length; jj++) {
+                fr[jj] = outer_c * last_c[jj] - outer_s * last_s[jj];
+                fi[jj] = outer_c * last_s[jj] + outer_s * last_c[jj];
+            }
+        }
+        else {
+            for (jj = 0; jj < length; jj++) {
+                fr[jj] = outer_c;
+                fi[jj] = outer_s;
+            }
+        }
+        if (!_FourierReadLine(input, pi, length, re, im)) {
+            task->error = 1;
+            return;
+        }
+        for (jj = 0; jj < length; jj++) {
+            const double tmp = re[jj] * fr[jj] - im[jj] * fi[jj];
+            im[jj] = re[jj] * fi[jj] + im[jj] * fr[jj];
+            re[jj] = tmp;
+        }
+        if (!_FourierWriteLine(task->output, po, length, re, im)) {
+            task->error = 1;
+            return;
+        }
+    }
+}
+
+/* Run a Fourier filter task over the lines along the last axis, on up to
+     workers threads: */
+static int _FourierRun(PyArrayObject *input, PyArrayObject *output,
+                       double **params, double **sines, int filter_type,
+                       NI_ThreadFunction *func, int workers)
+{
+    NI_FourierTask *tasks = NULL;
+    void **args = NULL;
+    const int rank = PyArray_NDIM(input);
+    const npy_intp length = rank > 0 ? PyArray_DIM(input, rank - 1) : 1;
+    const npy_intp size = PyArray_SIZE(input);
+    const npy_intp lines = length > 0 ? size / length : 0;
+    int kk, ntasks = 1, err = 0;
+    NPY_BEGIN_THREADS_DEF;
+
+    if (workers > 1 && lines > 1 && NI_LinesAreIndependent(input, output)) {
+        npy_intp max_tasks = size / FOURIER_MIN_WORK_PER_THREAD;
+        if (max_tasks > lines) {
+            max_tasks = lines;
+        }
+        if (max_tasks < workers) {
+            workers = max_tasks > 1 ? (int)max_tasks : 1;
+        }
+        ntasks = workers;
+    }
+    tasks = calloc(ntasks, sizeof(NI_FourierTask));
+    args = malloc(ntasks * sizeof(void *));
+    if (!tasks || !args) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+    for (kk = 0; kk < ntasks; kk++) {
+        NI_FourierTask *task = tasks + kk;
+
+        task->re = malloc(4 * (length > 0 ? length : 1) * sizeof(double));
+        if (!task->re) {
+            PyErr_NoMemory();
+            goto exit;
+        }
+        task->im = task->re + length;
+        task->fr = task->im + length;
+        task->fi = task->fr + length;
+        task->input = input;
+        task->output = output;
+        task->params = params;
+        task->sines = sines;
+        task->filter_type = filter_type;
+        task->first = lines * kk / ntasks;
+        task->last = lines * (kk + 1) / ntasks;
+        args[kk] = task;
+    }
+
+    NPY_BEGIN_THREADS;
+    NI_RunThreads(ntasks, func, args);
+    NPY_END_THREADS;
+
+    for (kk = 0; kk < ntasks; kk++) {
+        err |= tasks[kk].error;
+    }
+    if (err) {
+        PyErr_SetString(PyExc_RuntimeError, "data type not supported");
+    }
+exit:
+    if (tasks) {
+        for (kk = 0; kk < ntasks; kk++) {
+            free(tasks[kk].re);
+        }
+    }
+    free(tasks);
+    free(args);
+    return PyErr_Occurred() ? 0 : 1;
+}
 
 int NI_FourierFilter(PyArrayObject *input, PyArrayObject* parameter_array,
                      npy_intp n, int axis, PyArrayObject* output,
-                     int filter_type)
+                     int filter_type, int workers)
 {
-    NI_Iterator ii, io;
-    char *pi, *po;
     double *parameters = NULL, **params = NULL;
-    npy_intp kk, hh, size;
+    npy_intp kk, hh;
     npy_double *iparameters = (void *)PyArray_DATA(parameter_array);
-    NPY_BEGIN_THREADS_DEF;
 
+    if ((PyArray_TYPE(input) == NPY_CFLOAT ||
+            PyArray_TYPE(input) == NPY_CDOUBLE) &&
+            PyArray_TYPE(output) != NPY_CFLOAT &&
+            PyArray_TYPE(output) != NPY_CDOUBLE) {
+        PyErr_SetString(PyExc_RuntimeError, "data type not supported");
+        goto exit;
+    }
     /* precalculate the parameters: */
     parameters = malloc(PyArray_NDIM(input) * sizeof(double));
     if (!parameters) {
@@ -234,8 +546,6 @@ int NI_FourierFilter(PyArrayObject *input, PyArrayObject* parameter_array,
         }
     }
 
-    NPY_BEGIN_THREADS;
-
     switch (filter_type) {
         case _NI_GAUSSIAN:
             /* calculate the tables of exponentials: */
@@ -293,7 +603,8 @@ int NI_FourierFilter(PyArrayObject *input, PyArrayObject* parameter_array,
             }
             break;
         case _NI_ELLIPSOID:
-            /* calculate the tables of parameters: */
+            /* calculate the tables of parameters; the table of an axis of
+                 length one would only hold a zero, and is left out: */
             for (hh = 0; hh < PyArray_NDIM(input); hh++) {
                 if (params[hh]) {
                     params[hh][0] = 1.0;
@@ -315,129 +626,22 @@ int NI_FourierFilter(PyArrayObject *input, PyArrayObject* parameter_array,
                         }
                     }
                 }
-                else if (PyArray_DIM(input, hh) > 0) {
-                    params[hh][0] = 1.0;
-                }
             }
             if (PyArray_NDIM(input) > 1)
                 for(hh = 0; hh < PyArray_NDIM(input); hh++)
-                    for(kk = 0; kk < PyArray_DIM(input, hh); kk++) {
-                        params[hh][kk] *= params[hh][kk];
-                    }
+                    if (params[hh])
+                        for(kk = 0; kk < PyArray_DIM(input, hh); kk++) {
+                            params[hh][kk] *= params[hh][kk];
+                        }
             break;
         default:
             break;
     }
-    /* initialize input element iterator: */
-    if (!NI_InitPointIterator(input, &ii))
-        goto exit;
-    /* initialize output element iterator: */
-    if (!NI_InitPointIterator(output, &io))
-        goto exit;
-    pi = (void *)PyArray_DATA(input);
-    po = (void *)PyArray_DATA(output);
-    size = PyArray_SIZE(input);
-    /* iterator over the elements: */
-    for(hh = 0; hh < size; hh++) {
-        double tmp = 1.0;
-        switch (filter_type) {
-        case _NI_GAUSSIAN:
-        case _NI_UNIFORM:
-            for (kk = 0; kk < PyArray_NDIM(input); kk++) {
-                if (params[kk])
-                    tmp *= params[kk][ii.coordinates[kk]];
-            }
-            break;
-        case _NI_ELLIPSOID:
-            switch (PyArray_NDIM(input)) {
-            case 1:
-                tmp = params[0][ii.coordinates[0]];
-                tmp = tmp > 0.0 ? sin(tmp) / (tmp) : 1.0;
-                break;
-            case 2:
-                tmp = 0.0;
-                for(kk = 0; kk < 2; kk++)
-                    tmp += params[kk][ii.coordinates[kk]];
-                tmp = sqrt(tmp);
-                tmp = tmp > 0.0 ? 2.0 * _bessel_j1(tmp) / tmp : 1.0;
-                break;
-            case 3:
-                {
-                    double r = 0.0;
-                    for(kk = 0; kk < 3; kk++)
-                        r += params[kk][ii.coordinates[kk]];
-                    r = sqrt(r);
-                    if (r > 0.0) {
-                        tmp = 3.0 * (sin(r) - r * cos(r));
-                        tmp /= r * r * r;
-                    } else {
-                        tmp = 1.0;
-                    }
-                }
-                break;
-            }
-            break;
-        default:
-            break;
-        }
-        if (PyArray_TYPE(input) == NPY_CFLOAT ||
-                PyArray_TYPE(input) == NPY_CDOUBLE) {
-            double tmp_r = 0.0, tmp_i = 0.0;
-            switch (PyArray_TYPE(input)) {
-                CASE_FOURIER_FILTER_RC(NPY_CFLOAT, npy_cfloat,
-                                       pi, tmp, tmp_r, tmp_i);
-                CASE_FOURIER_FILTER_RC(NPY_CDOUBLE, npy_cdouble,
-                                       pi, tmp, tmp_r, tmp_i);
-            default:
-                NPY_END_THREADS;
-                PyErr_SetString(PyExc_RuntimeError, "data type not supported");
-                goto exit;
-            }
-            switch (PyArray_TYPE(output)) {
-                CASE_FOURIER_OUT_CC(NPY_CFLOAT, npy_cfloat, po, tmp_r, tmp_i);
-                CASE_FOURIER_OUT_CC(NPY_CDOUBLE, npy_cdouble, po, tmp_r, tmp_i);
-            default:
-                NPY_END_THREADS;
-                PyErr_SetString(PyExc_RuntimeError, "data type not supported");
-                goto exit;
-            }
-        }
-        else {
-            switch (PyArray_TYPE(input)) {
-                CASE_FOURIER_FILTER_RR(NPY_BOOL, npy_bool, pi, tmp);
-                CASE_FOURIER_FILTER_RR(NPY_UBYTE, npy_ubyte, pi, tmp);
-                CASE_FOURIER_FILTER_RR(NPY_USHORT, npy_ushort, pi, tmp);
-                CASE_FOURIER_FILTER_RR(NPY_UINT, npy_uint, pi, tmp);
-                CASE_FOURIER_FILTER_RR(NPY_ULONG, npy_ulong, pi, tmp);
-                CASE_FOURIER_FILTER_RR(NPY_ULONGLONG, npy_ulonglong, pi, tmp);
-                CASE_FOURIER_FILTER_RR(NPY_BYTE, npy_byte, pi, tmp);
-                CASE_FOURIER_FILTER_RR(NPY_SHORT, npy_short, pi, tmp);
-                CASE_FOURIER_FILTER_RR(NPY_INT, npy_int, pi, tmp);
-                CASE_FOURIER_FILTER_RR(NPY_LONG, npy_long, pi, tmp);
-                CASE_FOURIER_FILTER_RR(NPY_LONGLONG, npy_longlong, pi, tmp);
-                CASE_FOURIER_FILTER_RR(NPY_FLOAT, npy_float, pi, tmp);
-                CASE_FOURIER_FILTER_RR(NPY_DOUBLE, npy_double, pi, tmp);
-            default:
-                NPY_END_THREADS;
-                PyErr_SetString(PyExc_RuntimeError, "data type not supported");
-                goto exit;
-            }
-            switch (PyArray_TYPE(output)) {
-                CASE_FOURIER_OUT_RR(NPY_FLOAT, npy_float, po, tmp);
-                CASE_FOURIER_OUT_RR(NPY_DOUBLE, npy_double, po, tmp);
-                CASE_FOURIER_OUT_RC(NPY_CFLOAT, npy_cfloat, po, tmp);
-                CASE_FOURIER_OUT_RC(NPY_CDOUBLE, npy_cdouble, po, tmp);
-            default:
-                NPY_END_THREADS;
-                PyErr_SetString(PyExc_RuntimeError, "data type not supported");
-                goto exit;
-            }
-        }
-        NI_ITERATOR_NEXT2(ii, io, pi, po);
-    }
+
+    _FourierRun(input, output, params, NULL, filter_type,
+                _FourierFilterTask, workers);
 
  exit:
-    NPY_END_THREADS;
     free(parameters);
     if (params) {
         for (kk = 0; kk < PyArray_NDIM(input); kk++) {
@@ -448,29 +652,18 @@ int NI_FourierFilter(PyArrayObject *input, PyArrayObject* parameter_array,
     return PyErr_Occurred() ? 0 : 1;
 }
 
-#define CASE_FOURIER_SHIFT_R(_TYPE, _type, _pi, _tmp, _r, _i, _cost, _sint) \
-case _TYPE:                                                                 \
-    _tmp = *(_type *)_pi;                                                   \
-    _r = _tmp * _cost;                                                      \
-    _i = _tmp * _sint;                                                      \
-    break
-
-#define CASE_FOURIER_SHIFT_C(_TYPE, _type, _pi, _r, _i, _cost, _sint) \
-case _TYPE:                                                           \
-    _r = ((_type *)_pi)->real * _cost - ((_type *)_pi)->imag * _sint; \
-    _i = ((_type *)_pi)->real * _sint + ((_type *)_pi)->imag * _cost; \
-    break
-
 int NI_FourierShift(PyArrayObject *input, PyArrayObject* shift_array,
-            npy_intp n, int axis, PyArrayObject* output)
+            npy_intp n, int axis, PyArrayObject* output, int workers)
 {
-    NI_Iterator ii, io;
-    char *pi, *po;
-    double *shifts = NULL, **params = NULL;
-    npy_intp kk, hh, size;
+    double *shifts = NULL, **cosines = NULL, **sines = NULL;
+    npy_intp kk, hh;
     npy_double *ishifts = (void *)PyArray_DATA(shift_array);
-    NPY_BEGIN_THREADS_DEF;
 
+    if (PyArray_TYPE(output) != NPY_CFLOAT &&
+            PyArray_TYPE(output) != NPY_CDOUBLE) {
+        PyErr_SetString(PyExc_RuntimeError, "data type not supported");
+        goto exit;
+    }
     /* precalculate the shifts: */
     shifts = malloc(PyArray_NDIM(input) * sizeof(double));
     if (!shifts) {
@@ -485,118 +678,64 @@ int NI_FourierShift(PyArrayObject *input, PyArrayObject* shift_array,
                 (n < 0 ? PyArray_DIM(input, kk) : n) : PyArray_DIM(input, kk);
         shifts[kk] = -2.0 * M_PI * *ishifts++ / (double)shape;
     }
-    /* allocate memory for tables: */
-    params = malloc(PyArray_NDIM(input) * sizeof(double*));
-    if (!params) {
+    /* allocate memory for the tables of the cosines and sines of the phases
+         along each axis, which make the phase of an element a product: */
+    cosines = malloc(PyArray_NDIM(input) * sizeof(double*));
+    sines = malloc(PyArray_NDIM(input) * sizeof(double*));
+    if (!cosines || !sines) {
         PyErr_NoMemory();
         goto exit;
     }
     for (kk = 0; kk < PyArray_NDIM(input); kk++) {
-        params[kk] = NULL;
+        cosines[kk] = sines[kk] = NULL;
     }
     for (kk = 0; kk < PyArray_NDIM(input); kk++) {
         if (PyArray_DIM(input, kk) > 1) {
-            params[kk] = malloc(PyArray_DIM(input, kk) * sizeof(double));
-            if (!params[kk]) {
+            cosines[kk] = malloc(PyArray_DIM(input, kk) * sizeof(double));
+            sines[kk] = malloc(PyArray_DIM(input, kk) * sizeof(double));
+            if (!cosines[kk] || !sines[kk]) {
                 PyErr_NoMemory();
                 goto exit;
             }
         }
     }
 
-    NPY_BEGIN_THREADS;
-
     for (hh = 0; hh < PyArray_NDIM(input); hh++) {
-        if (params[hh]) {
+        if (cosines[hh]) {
             if (hh == axis && n >= 0) {
                 for (kk = 0; kk < PyArray_DIM(input, hh); kk++) {
-                    params[hh][kk] = shifts[hh] * kk;
+                    cosines[hh][kk] = cos(shifts[hh] * kk);
+                    sines[hh][kk] = sin(shifts[hh] * kk);
                 }
             }
             else {
                 int jj = 0;
                 for (kk = 0; kk < (PyArray_DIM(input, hh) + 1) / 2; kk++) {
-                    params[hh][jj++] = shifts[hh] * kk;
+                    cosines[hh][jj] = cos(shifts[hh] * kk);
+                    sines[hh][jj++] = sin(shifts[hh] * kk);
                 }
                 for (kk = -(PyArray_DIM(input, hh) / 2); kk < 0; kk++) {
-                    params[hh][jj++] = shifts[hh] * kk;
+                    cosines[hh][jj] = cos(shifts[hh] * kk);
+                    sines[hh][jj++] = sin(shifts[hh] * kk);
                 }
             }
         }
     }
-    /* initialize input element iterator: */
-    if (!NI_InitPointIterator(input, &ii))
-        goto exit;
-    /* initialize output element iterator: */
-    if (!NI_InitPointIterator(output, &io))
-        goto exit;
-    pi = (void *)PyArray_DATA(input);
-    po = (void *)PyArray_DATA(output);
-    size = PyArray_SIZE(input);
-    /* iterator over the elements: */
-    for(hh = 0; hh < size; hh++) {
-        double tmp = 0.0, sint, cost, r = 0.0, i = 0.0;
-        for (kk = 0; kk < PyArray_NDIM(input); kk++) {
-            if (params[kk])
-                tmp += params[kk][ii.coordinates[kk]];
-        }
-        sint = sin(tmp);
-        cost = cos(tmp);
-        switch (PyArray_TYPE(input)) {
-            CASE_FOURIER_SHIFT_R(NPY_BOOL, npy_bool,
-                                 pi, tmp, r, i, cost, sint);
-            CASE_FOURIER_SHIFT_R(NPY_UBYTE, npy_ubyte,
-                                 pi, tmp, r, i, cost, sint);
-            CASE_FOURIER_SHIFT_R(NPY_USHORT, npy_ushort,
-                                 pi, tmp, r, i, cost, sint);
-            CASE_FOURIER_SHIFT_R(NPY_UINT, npy_uint,
-                                 pi, tmp, r, i, cost, sint);
-            CASE_FOURIER_SHIFT_R(NPY_ULONG, npy_ulong,
-                                 pi, tmp, r, i, cost, sint);
-            CASE_FOURIER_SHIFT_R(NPY_ULONGLONG, npy_ulonglong,
-                                 pi, tmp, r, i, cost, sint);
-            CASE_FOURIER_SHIFT_R(NPY_BYTE, npy_byte,
-                                 pi, tmp, r, i, cost, sint);
-            CASE_FOURIER_SHIFT_R(NPY_SHORT, npy_short,
-                                 pi, tmp, r, i, cost, sint);
-            CASE_FOURIER_SHIFT_R(NPY_INT, npy_int,
-                                 pi, tmp, r, i, cost, sint);
-            CASE_FOURIER_SHIFT_R(NPY_LONG, npy_long,
-                                 pi, tmp, r, i, cost, sint);
-            CASE_FOURIER_SHIFT_R(NPY_LONGLONG, npy_longlong,
-                                 pi, tmp, r, i, cost, sint);
-            CASE_FOURIER_SHIFT_R(NPY_FLOAT, npy_float,
-                                 pi, tmp, r, i, cost, sint);
-            CASE_FOURIER_SHIFT_R(NPY_DOUBLE, npy_double,
-                                 pi, tmp, r, i, cost, sint);
-            CASE_FOURIER_SHIFT_C(NPY_CFLOAT, npy_cfloat,
-                                 pi, r, i, cost, sint);
-            CASE_FOURIER_SHIFT_C(NPY_CDOUBLE, npy_cdouble,
-                                 pi, r, i, cost, sint);
-        default:
-            NPY_END_THREADS;
-            PyErr_SetString(PyExc_RuntimeError, "data type not supported");
-            goto exit;
-        }
-        switch (PyArray_TYPE(output)) {
-            CASE_FOURIER_OUT_CC(NPY_CFLOAT, npy_cfloat, po, r, i);
-            CASE_FOURIER_OUT_CC(NPY_CDOUBLE, npy_cdouble, po, r, i);
-        default:
-            NPY_END_THREADS;
-            PyErr_SetString(PyExc_RuntimeError, "data type not supported");
-            goto exit;
-        }
-        NI_ITERATOR_NEXT2(ii, io, pi, po);
-    }
+
+    _FourierRun(input, output, cosines, sines, 0, _FourierShiftTask,
+                workers);
 
  exit:
-    NPY_END_THREADS;
     free(shifts);
-    if (params) {
-        for (kk = 0; kk < PyArray_NDIM(input); kk++) {
-            free(params[kk]);
+    for (kk = 0; kk < PyArray_NDIM(input); kk++) {
+        if (cosines) {
+            free(cosines[kk]);
+        }
+        if (sines) {
+            free(sines[kk]);
         }
-        free(params);
     }
+    free(cosines);
+    free(sines);
     return PyErr_Occurred() ? 0 : 1;
 }
@@ -32,7 +32,9 @@
 #include "ni_support.h"
 #include "ni_interpolation.h"
 #include "ni_splines.h"
+#include "ni_threads.h"
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 
@@ -121,72 +123,71 @@ map_coordinate(double in, npy_intp len, int mode)
     return in;
 }
 
-#define BUFFER_SIZE 256000
 #define TOLERANCE 1e-15
 
 
 /* one-dimensional spline filter: */
+typedef struct {
+    double poles[MAX_SPLINE_FILTER_POLES];
+    int npoles;
+    NI_ExtendMode mode;
+} NI_SplineFilter1DData;
+
+static void _SplineFilter1DLine(double *iline, double *oline, npy_intp len,
+                                void *data, void *scratch)
+{
+    NI_SplineFilter1DData *sd = (NI_SplineFilter1DData *)data;
+
+    /* spline filter, in place: */
+    if (len > 1) {
+        apply_filter(oline, len, sd->poles, sd->npoles, sd->mode);
+    }
+}
+
+/* The spline filter of lines of floats, through a line of doubles in the
+     scratch space, so that the recursion keeps double precision: */
+static void _SplineFilter1DFloatLine(float *iline, float *oline, npy_intp len,
+                                     void *data, void *scratch)
+{
+    NI_SplineFilter1DData *sd = (NI_SplineFilter1DData *)data;
+    double *line = (double *)scratch;
+    npy_intp ll;
+
+    if (len > 1) {
+        for(ll = 0; ll < len; ll++)
+            line[ll] = oline[ll];
+        apply_filter(line, len, sd->poles, sd->npoles, sd->mode);
+        for(ll = 0; ll < len; ll++)
+            oline[ll] = (float)line[ll];
+    }
+}
+
 int NI_SplineFilter1D(PyArrayObject *input, int order, int axis,
-                      NI_ExtendMode mode, PyArrayObject *output)
+                      NI_ExtendMode mode, PyArrayObject *output, int workers)
 {
-    int npoles = 0, more;
-    npy_intp kk, lines, len;
-    double *buffer = NULL, poles[MAX_SPLINE_FILTER_POLES];
-    NI_LineBuffer iline_buffer, oline_buffer;
-    NPY_BEGIN_THREADS_DEF;
+    npy_intp len;
+    NI_SplineFilter1DData data;
 
     len = PyArray_NDIM(input) > 0 ? PyArray_DIM(input, axis) : 1;
     if (len < 1)
-        goto exit;
+        return 1;
 
     /* these are used in the spline filter calculation below: */
-    if (get_filter_poles(order, &npoles, poles)) {
-        goto exit;
+    if (get_filter_poles(order, &data.npoles, data.poles)) {
+        return 1;
     }
+    data.mode = mode;
 
-    /* allocate an initialize the line buffer, only a single one is used,
-         because the calculation is in-place: */
-    lines = -1;
-    if (!NI_AllocateLineBuffer(input, axis, 0, 0, &lines, BUFFER_SIZE,
-                               &buffer)) {
-        goto exit;
-    }
-    if (!NI_InitLineBuffer(input, axis, 0, 0, lines, buffer,
-                           NI_EXTEND_DEFAULT, 0.0, &iline_buffer)) {
-        goto exit;
-    }
-    if (!NI_InitLineBuffer(output, axis, 0, 0, lines, buffer,
-                           NI_EXTEND_DEFAULT, 0.0, &oline_buffer)) {
-        goto exit;
+    if (NI_CanFilterFloatLines(input, output, NI_EXTEND_DEFAULT, 0.0)) {
+        return NI_FloatLineFilter(input, output, axis, 0, 0,
+                                  NI_EXTEND_DEFAULT, 0.0, 1,
+                                  _SplineFilter1DFloatLine, &data,
+                                  len * sizeof(double), workers);
     }
-    NPY_BEGIN_THREADS;
-
-    /* iterate over all the array lines: */
-    do {
-        /* copy lines from array to buffer: */
-        if (!NI_ArrayToLineBuffer(&iline_buffer, &lines, &more)) {
-            goto exit;
-        }
-        /* iterate over the lines in the buffer: */
-        for(kk = 0; kk < lines; kk++) {
-            /* get line: */
-            double *ln = NI_GET_LINE(iline_buffer, kk);
-            /* spline filter: */
-            if (len > 1) {
-                apply_filter(ln, len, poles, npoles, mode);
-            }
-        }
-
-        /* copy lines from buffer to array: */
-        if (!NI_LineBufferToArray(&oline_buffer)) {
-            goto exit;
-        }
-    } while(more);
-
- exit:
-    NPY_END_THREADS;
-    free(buffer);
-    return PyErr_Occurred() ? 0 : 1;
+    /* only a single line buffer is used, because the calculation is
+         in-place: */
+    return NI_LineFilter(input, output, axis, 0, 0, NI_EXTEND_DEFAULT, 0.0, 1,
+                         _SplineFilter1DLine, &data, 0, workers);
 }
 
 /* copy row of coordinate array from location at _p to _coor */
@@ -227,224 +228,379 @@ case NPY_##_TYPE:                                    \
     *(_type *)_po = (_type)_t;                       \
     break
 
-int
-NI_GeometricTransform(PyArrayObject *input, int (*map)(npy_intp*, double*,
-                int, int, void*), void* map_data, PyArrayObject* matrix_ar,
-                PyArrayObject* shift_ar, PyArrayObject *coordinates,
-                PyArrayObject *output, int order, int mode, double cval)
-{
-    char *po, *pi, *pc = NULL;
-    npy_intp **edge_offsets = NULL, **data_offsets = NULL, filter_size;
-    npy_intp ftmp[NPY_MAXDIMS], *fcoordinates = NULL, *foffsets = NULL;
-    npy_intp cstride = 0, kk, hh, ll, jj;
-    npy_intp size;
-    double **splvals = NULL, icoor[NPY_MAXDIMS];
+/* Minimum number of multiply-adds that justifies another thread: */
+#define INTERP_MIN_WORK_PER_THREAD 262144
+
+/* The taps of the spline filter, common to all output points: their
+     coordinates within the filter, and their offsets in the input if no
+     tap crosses the border: */
+typedef struct {
+    npy_intp *fcoordinates, *foffsets, filter_size;
     npy_intp idimensions[NPY_MAXDIMS], istrides[NPY_MAXDIMS];
-    NI_Iterator io, ic;
-    npy_double *matrix = matrix_ar ? (npy_double*)PyArray_DATA(matrix_ar) : NULL;
-    npy_double *shift = shift_ar ? (npy_double*)PyArray_DATA(shift_ar) : NULL;
-    int irank = 0, orank;
-    NPY_BEGIN_THREADS_DEF;
+    int rank, order;
+} NI_SplineTaps;
 
-    NPY_BEGIN_THREADS;
+static int _InitSplineTaps(PyArrayObject *input, int order,
+                           NI_SplineTaps *taps)
+{
+    npy_intp ftmp[NPY_MAXDIMS], hh, kk;
+    int jj, rank = PyArray_NDIM(input);
 
-    for(kk = 0; kk < PyArray_NDIM(input); kk++) {
-        idimensions[kk] = PyArray_DIM(input, kk);
-        istrides[kk] = PyArray_STRIDE(input, kk);
+    taps->rank = rank;
+    taps->order = order;
+    taps->filter_size = 1;
+    for(jj = 0; jj < rank; jj++) {
+        taps->idimensions[jj] = PyArray_DIM(input, jj);
+        taps->istrides[jj] = PyArray_STRIDE(input, jj);
+        taps->filter_size *= order + 1;
+    }
+    taps->fcoordinates = malloc((rank > 0 ? rank : 1) * taps->filter_size *
+                                sizeof(npy_intp));
+    taps->foffsets = malloc(taps->filter_size * sizeof(npy_intp));
+    if (NPY_UNLIKELY(!taps->fcoordinates || !taps->foffsets)) {
+        PyErr_NoMemory();
+        return 0;
+    }
+    for(jj = 0; jj < rank; jj++)
+        ftmp[jj] = 0;
+    kk = 0;
+    for(hh = 0; hh < taps->filter_size; hh++) {
+        for(jj = 0; jj < rank; jj++)
+            taps->fcoordinates[jj + hh * rank] = ftmp[jj];
+        taps->foffsets[hh] = kk;
+        for(jj = rank - 1; jj >= 0; jj--) {
+            if (ftmp[jj] < order) {
+                ftmp[jj]++;
+                kk += taps->istrides[jj];
+                break;
+            } else {
+                ftmp[jj] = 0;
+                kk -= taps->istrides[jj] * order;
+            }
+        }
     }
-    irank = PyArray_NDIM(input);
-    orank = PyArray_NDIM(output);
+    return 1;
+}
 
-    /* if the mapping is from array coordinates: */
-    if (coordinates) {
-        /* initialize a line iterator along the first axis: */
-        if (!NI_InitPointIterator(coordinates, &ic))
-            goto exit;
-        cstride = ic.strides[0];
-        if (!NI_LineIterator(&ic, 0))
-            goto exit;
-        pc = (void *)(PyArray_DATA(coordinates));
+/* The offsets of the taps along an axis, relative to the first one, for a
+     filter that starts at start and crosses the border: */
+static void _EdgeOffsets(npy_intp start, npy_intp len, npy_intp stride,
+                         int order, npy_intp *offsets)
+{
+    int hh;
+
+    for(hh = 0; hh <= order; hh++) {
+        npy_intp idx = start + hh;
+        if (len <= 1) {
+            idx = 0;
+        } else {
+            npy_intp s2 = 2 * len - 2;
+            if (idx < 0) {
+                idx = s2 * (npy_intp)(-idx / s2) + idx;
+                idx = idx <= 1 - len ? idx + s2 : -idx;
+            } else if (idx >= len) {
+                idx -= s2 * (npy_intp)(idx / s2);
+                if (idx >= len)
+                    idx = s2 - idx;
+            }
+        }
+        offsets[hh] = stride * (idx - start);
     }
+}
 
-    /* offsets used at the borders: */
-    edge_offsets = malloc(irank * sizeof(npy_intp*));
-    data_offsets = malloc(irank * sizeof(npy_intp*));
-    if (NPY_UNLIKELY(!edge_offsets || !data_offsets)) {
-        NPY_END_THREADS;
-        PyErr_NoMemory();
-        goto exit;
+/* The first tap along an axis of the filter at coordinate cc: */
+#define SPLINE_START(_cc, _order)                                    \
+    ((_order) & 1 ? (npy_intp)floor(_cc) - (_order) / 2              \
+                  : (npy_intp)floor((_cc) + 0.5) - (_order) / 2)
+
+/* sum the taps of the filter at offset, with edge_offsets[jj] the tap
+     offsets along axis jj if they cross the border, and weights[jj] their
+     spline weights. The type switch is taken once for all taps: */
+#define CASE_INTERP_TAPS(_TYPE, _type, _pi, _offset, _edge, _edge_offsets, \
+                         _weights, _taps, _t)                              \
+case _TYPE:                                                                \
+{                                                                          \
+    npy_intp _hh, *_ff = (_taps)->fcoordinates;                            \
+    int _ll, _rank = (_taps)->rank;                                        \
+    for(_hh = 0; _hh < (_taps)->filter_size; _hh++) {                      \
+        npy_intp _idx = 0;                                                 \
+        double _coeff;                                                     \
+        if (NPY_UNLIKELY(_edge)) {                                         \
+            for(_ll = 0; _ll < _rank; _ll++) {                             \
+                if (_edge_offsets[_ll])                                    \
+                    _idx += _edge_offsets[_ll][_ff[_ll]];                  \
+                else                                                       \
+                    _idx += _ff[_ll] * (_taps)->istrides[_ll];             \
+            }                                                              \
+        } else {                                                           \
+            _idx = (_taps)->foffsets[_hh];                                 \
+        }                                                                  \
+        _coeff = *(_type *)(_pi + _offset + _idx);                         \
+        if ((_taps)->order > 0) {                                          \
+            for(_ll = 0; _ll < _rank; _ll++)                               \
+                _coeff *= _weights[_ll][_ff[_ll]];                         \
+        }                                                                  \
+        _t += _coeff;                                                      \
+        _ff += _rank;                                                      \
+    }                                                                      \
+}                                                                          \
+break
+
+/* Interpolate the input at one point, returns 0 if the input type is not
+     supported: */
+static int _InterpolatePoint(int type_num, char *pi, npy_intp offset,
+                             int edge, npy_intp **edge_offsets,
+                             double **weights, NI_SplineTaps *taps,
+                             double *res)
+{
+    double t = 0.0;
+
+    switch (type_num) {
+        CASE_INTERP_TAPS(NPY_BOOL, npy_bool, pi, offset, edge,
+                         edge_offsets, weights, taps, t);
+        CASE_INTERP_TAPS(NPY_UBYTE, npy_ubyte, pi, offset, edge,
+                         edge_offsets, weights, taps, t);
+        CASE_INTERP_TAPS(NPY_USHORT, npy_ushort, pi, offset, edge,
+                         edge_offsets, weights, taps, t);
+        CASE_INTERP_TAPS(NPY_UINT, npy_uint, pi, offset, edge,
+                         edge_offsets, weights, taps, t);
+        CASE_INTERP_TAPS(NPY_ULONG, npy_ulong, pi, offset, edge,
+                         edge_offsets, weights, taps, t);
+        CASE_INTERP_TAPS(NPY_ULONGLONG, npy_ulonglong, pi, offset, edge,
+                         edge_offsets, weights, taps, t);
+        CASE_INTERP_TAPS(NPY_BYTE, npy_byte, pi, offset, edge,
+                         edge_offsets, weights, taps, t);
+        CASE_INTERP_TAPS(NPY_SHORT, npy_short, pi, offset, edge,
+                         edge_offsets, weights, taps, t);
+        CASE_INTERP_TAPS(NPY_INT, npy_int, pi, offset, edge,
+                         edge_offsets, weights, taps, t);
+        CASE_INTERP_TAPS(NPY_LONG, npy_long, pi, offset, edge,
+                         edge_offsets, weights, taps, t);
+        CASE_INTERP_TAPS(NPY_LONGLONG, npy_longlong, pi, offset, edge,
+                         edge_offsets, weights, taps, t);
+        CASE_INTERP_TAPS(NPY_FLOAT, npy_float, pi, offset, edge,
+                         edge_offsets, weights, taps, t);
+        CASE_INTERP_TAPS(NPY_DOUBLE, npy_double, pi, offset, edge,
+                         edge_offsets, weights, taps, t);
+    default:
+        return 0;
     }
-    for(jj = 0; jj < irank; jj++)
-        data_offsets[jj] = NULL;
-    for(jj = 0; jj < irank; jj++) {
-        data_offsets[jj] = malloc((order + 1) * sizeof(npy_intp));
-        if (NPY_UNLIKELY(!data_offsets[jj])) {
-            NPY_END_THREADS;
-            PyErr_NoMemory();
-            goto exit;
-        }
+    *res = t;
+    return 1;
+}
+
+/* Store an output value, returns 0 if the output type is not supported: */
+static int _WriteInterpOut(int type_num, char *po, double t)
+{
+    switch (type_num) {
+        CASE_INTERP_OUT(NPY_BOOL, npy_bool, po, t);
+        CASE_INTERP_OUT_UINT(UBYTE, npy_ubyte, po, t);
+        CASE_INTERP_OUT_UINT(USHORT, npy_ushort, po, t);
+        CASE_INTERP_OUT_UINT(UINT, npy_uint, po, t);
+        CASE_INTERP_OUT_UINT(ULONG, npy_ulong, po, t);
+        CASE_INTERP_OUT_UINT(ULONGLONG, npy_ulonglong, po, t);
+        CASE_INTERP_OUT_INT(BYTE, npy_byte, po, t);
+        CASE_INTERP_OUT_INT(SHORT, npy_short, po, t);
+        CASE_INTERP_OUT_INT(INT, npy_int, po, t);
+        CASE_INTERP_OUT_INT(LONG, npy_long, po, t);
+        CASE_INTERP_OUT_INT(LONGLONG, npy_longlong, po, t);
+        CASE_INTERP_OUT(NPY_FLOAT, npy_float, po, t);
+        CASE_INTERP_OUT(NPY_DOUBLE, npy_double, po, t);
+    default:
+        return 0;
     }
-    /* will hold the spline coefficients: */
-    splvals = malloc(irank * sizeof(double*));
-    if (NPY_UNLIKELY(!splvals)) {
-        NPY_END_THREADS;
-        PyErr_NoMemory();
-        goto exit;
+    return 1;
+}
+
+/* The number of threads over which the output points are divided, in
+     blocks of whole lines along the last axis: */
+static int _InterpolationTasks(PyArrayObject *input, PyArrayObject *output,
+                               PyArrayObject *coordinates,
+                               npy_intp filter_size, int workers)
+{
+    npy_intp size = PyArray_SIZE(output), line_length, lines, max_tasks;
+
+    line_length = PyArray_NDIM(output) > 0 ?
+                  PyArray_DIM(output, PyArray_NDIM(output) - 1) : 1;
+    lines = line_length > 0 ? size / line_length : 0;
+    if (workers <= 1 || lines <= 1 || NI_ArraysOverlap(input, output) ||
+            (coordinates && NI_ArraysOverlap(coordinates, output))) {
+        return 1;
     }
-    for(jj = 0; jj < irank; jj++)
-        splvals[jj] = NULL;
-    for(jj = 0; jj < irank; jj++) {
-        splvals[jj] = malloc((order + 1) * sizeof(double));
-        if (NPY_UNLIKELY(!splvals[jj])) {
-            NPY_END_THREADS;
-            PyErr_NoMemory();
-            goto exit;
-        }
+    max_tasks = size * filter_size / INTERP_MIN_WORK_PER_THREAD;
+    if (max_tasks > lines) {
+        max_tasks = lines;
     }
+    if (max_tasks < workers) {
+        workers = max_tasks > 1 ? (int)max_tasks : 1;
+    }
+    return workers;
+}
 
-    filter_size = 1;
-    for(jj = 0; jj < irank; jj++)
-        filter_size *= order + 1;
+/* The first output point of task kk of ntasks, at the start of a line: */
+static npy_intp _InterpolationTaskFirst(PyArrayObject *output, int kk,
+                                        int ntasks)
+{
+    npy_intp size = PyArray_SIZE(output), line_length;
 
-    /* initialize output iterator: */
-    if (!NI_InitPointIterator(output, &io))
-        goto exit;
+    line_length = PyArray_NDIM(output) > 0 ?
+                  PyArray_DIM(output, PyArray_NDIM(output) - 1) : 1;
+    if (line_length <= 0) {
+        return 0;
+    }
+    return size / line_length * kk / ntasks * line_length;
+}
 
-    /* get data pointers: */
-    pi = (void *)PyArray_DATA(input);
-    po = (void *)PyArray_DATA(output);
+/* Move a point iterator to the point with the given index: */
+static void _IteratorGoto(NI_Iterator *it, npy_intp index, char *base,
+                          char **pointer)
+{
+    npy_intp coordinates[NPY_MAXDIMS];
+    int kk;
 
-    /* make a table of all possible coordinates within the spline filter: */
-    fcoordinates = malloc(irank * filter_size * sizeof(npy_intp));
-    /* make a table of all offsets within the spline filter: */
-    foffsets = malloc(filter_size * sizeof(npy_intp));
-    if (NPY_UNLIKELY(!fcoordinates || !foffsets)) {
-        NPY_END_THREADS;
-        PyErr_NoMemory();
-        goto exit;
+    for(kk = it->rank_m1; kk >= 0; kk--) {
+        coordinates[kk] = index % (it->dimensions[kk] + 1);
+        index /= it->dimensions[kk] + 1;
     }
-    for(jj = 0; jj < irank; jj++)
-        ftmp[jj] = 0;
-    kk = 0;
-    for(hh = 0; hh < filter_size; hh++) {
-        for(jj = 0; jj < irank; jj++)
-            fcoordinates[jj + hh * irank] = ftmp[jj];
-        foffsets[hh] = kk;
-        for(jj = irank - 1; jj >= 0; jj--) {
-            if (ftmp[jj] < order) {
-                ftmp[jj]++;
-                kk += istrides[jj];
-                break;
-            } else {
-                ftmp[jj] = 0;
-                kk -= istrides[jj] * order;
-            }
-        }
+    NI_ITERATOR_GOTO(*it, coordinates, base, *pointer);
+}
+
+/* The range of output points of one thread of NI_GeometricTransform: */
+typedef struct {
+    PyArrayObject *input, *output, *coordinates;
+    int (*map)(npy_intp*, double*, int, int, void*);
+    void *map_data;
+    npy_double *matrix, *shift;
+    NI_SplineTaps *taps;
+    NI_Iterator io, ic;
+    npy_intp cstride, first, last;
+    npy_intp *data_offsets;
+    double *splvals;
+    double cval;
+    int mode, error;
+} NI_GeometricTask;
+
+static void _GeometricTask(void *arg)
+{
+    NI_GeometricTask *task = (NI_GeometricTask *)arg;
+    NI_SplineTaps *taps = task->taps;
+    npy_intp *edge_offsets[NPY_MAXDIMS], kk, hh, ll;
+    double *weights[NPY_MAXDIMS], icoor[NPY_MAXDIMS], base[NPY_MAXDIMS];
+    char *po, *pc = NULL, *pi = PyArray_BYTES(task->input);
+    npy_double *matrix = task->matrix;
+    const int type_num = PyArray_TYPE(task->input);
+    const int otype_num = PyArray_TYPE(task->output);
+    int irank = taps->rank, orank = PyArray_NDIM(task->output);
+    int order = taps->order;
+
+    if (task->first >= task->last) {
+        return;
+    }
+    for(hh = 0; hh < irank; hh++)
+        weights[hh] = task->splvals + hh * (order + 1);
+    _IteratorGoto(&task->io, task->first, PyArray_BYTES(task->output), &po);
+    if (task->coordinates) {
+        NI_ITERATOR_GOTO(task->ic, task->io.coordinates,
+                         PyArray_BYTES(task->coordinates), pc);
     }
 
-    size = PyArray_SIZE(output);
-    for(kk = 0; kk < size; kk++) {
+    for(kk = task->first; kk < task->last; kk++) {
         double t = 0.0;
         int constant = 0, edge = 0;
         npy_intp offset = 0;
-        if (map) {
-            NPY_END_THREADS;
-            /* call mappint functions: */
-            if (!map(io.coordinates, icoor, orank, irank, map_data)) {
-                if (!PyErr_Occurred())
-                    PyErr_SetString(PyExc_RuntimeError,
-                                    "unknown error in mapping function");
-                goto exit;
+        if (task->map) {
+            /* call the mapping function, which may need the interpreter: */
+            PyGILState_STATE gstate = PyGILState_Ensure();
+            int ok = task->map(task->io.coordinates, icoor, orank, irank,
+                               task->map_data);
+            if (!ok && !PyErr_Occurred())
+                PyErr_SetString(PyExc_RuntimeError,
+                                "unknown error in mapping function");
+            PyGILState_Release(gstate);
+            if (!ok) {
+                task->error = -1;
+                return;
             }
-            NPY_BEGIN_THREADS;
         } else if (matrix) {
-            /* do an affine transformation: */
-            npy_double *p = matrix;
+            /* do an affine transformation, with the sums over the leading
+                 axes taken once per line: */
+            if (orank > 0 && (kk == task->first ||
+                              task->io.coordinates[orank - 1] == 0)) {
+                npy_double *p = matrix;
+                for(hh = 0; hh < irank; hh++) {
+                    base[hh] = 0.0;
+                    for(ll = 0; ll < orank - 1; ll++)
+                        base[hh] += task->io.coordinates[ll] * *p++;
+                    ++p;
+                }
+            }
             for(hh = 0; hh < irank; hh++) {
-                icoor[hh] = 0.0;
-                for(ll = 0; ll < orank; ll++)
-                    icoor[hh] += io.coordinates[ll] * *p++;
-                icoor[hh] += shift[hh];
+                if (orank > 0) {
+                    icoor[hh] = base[hh] +
+                                task->io.coordinates[orank - 1] *
+                                matrix[hh * orank + orank - 1];
+                } else {
+                    icoor[hh] = 0.0;
+                }
+                icoor[hh] += task->shift[hh];
             }
-        } else if (coordinates) {
+        } else if (task->coordinates) {
             /* mapping is from an coordinates array: */
             char *p = pc;
-            switch (PyArray_TYPE(coordinates)) {
+            switch (PyArray_TYPE(task->coordinates)) {
                 CASE_MAP_COORDINATES(NPY_BOOL, npy_bool,
-                                     p, icoor, irank, cstride);
+                                     p, icoor, irank, task->cstride);
                 CASE_MAP_COORDINATES(NPY_UBYTE, npy_ubyte,
-                                     p, icoor, irank, cstride);
+                                     p, icoor, irank, task->cstride);
                 CASE_MAP_COORDINATES(NPY_USHORT, npy_ushort,
-                                     p, icoor, irank, cstride);
+                                     p, icoor, irank, task->cstride);
                 CASE_MAP_COORDINATES(NPY_UINT, npy_uint,
-                                     p, icoor, irank, cstride);
+                                     p, icoor, irank, task->cstride);
                 CASE_MAP_COORDINATES(NPY_ULONG, npy_ulong,
-                                     p, icoor, irank, cstride);
+                                     p, icoor, irank, task->cstride);
                 CASE_MAP_COORDINATES(NPY_ULONGLONG, npy_ulonglong,
-                                     p, icoor, irank, cstride);
+                                     p, icoor, irank, task->cstride);
                 CASE_MAP_COORDINATES(NPY_BYTE, npy_byte,
-                                     p, icoor, irank, cstride);
+                                     p, icoor, irank, task->cstride);
                 CASE_MAP_COORDINATES(NPY_SHORT, npy_short,
-                                     p, icoor, irank, cstride);
+                                     p, icoor, irank, task->cstride);
                 CASE_MAP_COORDINATES(NPY_INT, npy_int,
-                                     p, icoor, irank, cstride);
+                                     p, icoor, irank, task->cstride);
                 CASE_MAP_COORDINATES(NPY_LONG, npy_long,
-                                     p, icoor, irank, cstride);
+                                     p, icoor, irank, task->cstride);
                 CASE_MAP_COORDINATES(NPY_LONGLONG, npy_longlong,
-                                     p, icoor, irank, cstride);
+                                     p, icoor, irank, task->cstride);
                 CASE_MAP_COORDINATES(NPY_FLOAT, npy_float,
-                                     p, icoor, irank, cstride);
+                                     p, icoor, irank, task->cstride);
                 CASE_MAP_COORDINATES(NPY_DOUBLE, npy_double,
-                                     p, icoor, irank, cstride);
+                                     p, icoor, irank, task->cstride);
             default:
-                NPY_END_THREADS;
-                PyErr_SetString(PyExc_RuntimeError,
-                                "coordinate array data type not supported");
-                goto exit;
+                task->error = 2;
+                return;
             }
         }
         /* iterate over axes: */
         for(hh = 0; hh < irank; hh++) {
             /* if the input coordinate is outside the borders, map it: */
-            double cc = map_coordinate(icoor[hh], idimensions[hh], mode);
+            double cc = map_coordinate(icoor[hh], taps->idimensions[hh],
+                                       task->mode);
             if (cc > -1.0) {
                 /* find the filter location along this axis: */
-                npy_intp start;
-                if (order & 1) {
-                    start = (npy_intp)floor(cc) - order / 2;
-                } else {
-                    start = (npy_intp)floor(cc + 0.5) - order / 2;
-                }
+                npy_intp start = SPLINE_START(cc, order);
                 /* get the offset to the start of the filter: */
-                offset += istrides[hh] * start;
-                if (start < 0 || start + order >= idimensions[hh]) {
+                offset += taps->istrides[hh] * start;
+                if (start < 0 || start + order >= taps->idimensions[hh]) {
                     /* implement border mapping, if outside border: */
                     edge = 1;
-                    edge_offsets[hh] = data_offsets[hh];
-                    for(ll = 0; ll <= order; ll++) {
-                        npy_intp idx = start + ll;
-                        npy_intp len = idimensions[hh];
-                        if (len <= 1) {
-                            idx = 0;
-                        } else {
-                            npy_intp s2 = 2 * len - 2;
-                            if (idx < 0) {
-                                idx = s2 * (-idx / s2) + idx;
-                                idx = idx <= 1 - len ? idx + s2 : -idx;
-                            } else if (idx >= len) {
-                                idx -= s2 * (idx / s2);
-                                if (idx >= len)
-                                    idx = s2 - idx;
-                            }
-                        }
-                        /* calculate and store the offests at this edge: */
-                        edge_offsets[hh][ll] = istrides[hh] * (idx - start);
-                    }
+                    edge_offsets[hh] = task->data_offsets + hh * (order + 1);
+                    _EdgeOffsets(start, taps->idimensions[hh],
+                                 taps->istrides[hh], order,
+                                 edge_offsets[hh]);
                 } else {
                     /* we are not at the border, use precalculated offsets: */
                     edge_offsets[hh] = NULL;
                 }
-                get_spline_interpolation_weights(cc, order, splvals[hh]);
+                get_spline_interpolation_weights(cc, order, weights[hh]);
             } else {
                 /* we use the constant border condition: */
                 constant = 1;
@@ -453,190 +609,250 @@ NI_GeometricTransform(PyArrayObject *input, int (*map)(npy_intp*, double*,
         }
 
         if (!constant) {
-            npy_intp *ff = fcoordinates;
-            const int type_num = PyArray_TYPE(input);
-            t = 0.0;
-            for(hh = 0; hh < filter_size; hh++) {
-                double coeff = 0.0;
-                npy_intp idx = 0;
-
-                if (NPY_UNLIKELY(edge)) {
-                    for(ll = 0; ll < irank; ll++) {
-                        if (edge_offsets[ll])
-                            idx += edge_offsets[ll][ff[ll]];
-                        else
-                            idx += ff[ll] * istrides[ll];
-                    }
-                } else {
-                    idx = foffsets[hh];
-                }
-                idx += offset;
-                switch (type_num) {
-                    CASE_INTERP_COEFF(NPY_BOOL, npy_bool,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_UBYTE, npy_ubyte,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_USHORT, npy_ushort,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_UINT, npy_uint,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_ULONG, npy_ulong,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_ULONGLONG, npy_ulonglong,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_BYTE, npy_byte,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_SHORT, npy_short,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_INT, npy_int,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_LONG, npy_long,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_LONGLONG, npy_longlong,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_FLOAT, npy_float,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_DOUBLE, npy_double,
-                                      coeff, pi, idx);
-                default:
-                    NPY_END_THREADS;
-                    PyErr_SetString(PyExc_RuntimeError,
-                                    "data type not supported");
-                    goto exit;
-                }
-                /* calculate the interpolated value: */
-                for(ll = 0; ll < irank; ll++)
-                    if (order > 0)
-                        coeff *= splvals[ll][ff[ll]];
-                t += coeff;
-                ff += irank;
+            if (!_InterpolatePoint(type_num, pi, offset, edge, edge_offsets,
+                                   weights, taps, &t)) {
+                task->error = 1;
+                return;
             }
         } else {
-            t = cval;
+            t = task->cval;
         }
         /* store output value: */
-        switch (PyArray_TYPE(output)) {
-            CASE_INTERP_OUT(NPY_BOOL, npy_bool, po, t);
-            CASE_INTERP_OUT_UINT(UBYTE, npy_ubyte, po, t);
-            CASE_INTERP_OUT_UINT(USHORT, npy_ushort, po, t);
-            CASE_INTERP_OUT_UINT(UINT, npy_uint, po, t);
-            CASE_INTERP_OUT_UINT(ULONG, npy_ulong, po, t);
-            CASE_INTERP_OUT_UINT(ULONGLONG, npy_ulonglong, po, t);
-            CASE_INTERP_OUT_INT(BYTE, npy_byte, po, t);
-            CASE_INTERP_OUT_INT(SHORT, npy_short, po, t);
-            CASE_INTERP_OUT_INT(INT, npy_int, po, t);
-            CASE_INTERP_OUT_INT(LONG, npy_long, po, t);
-            CASE_INTERP_OUT_INT(LONGLONG, npy_longlong, po, t);
-            CASE_INTERP_OUT(NPY_FLOAT, npy_float, po, t);
-            CASE_INTERP_OUT(NPY_DOUBLE, npy_double, po, t);
-        default:
-            NPY_END_THREADS;
-            PyErr_SetString(PyExc_RuntimeError, "data type not supported");
-            goto exit;
+        if (!_WriteInterpOut(otype_num, po, t)) {
+            task->error = 1;
+            return;
         }
-        if (coordinates) {
-            NI_ITERATOR_NEXT2(io, ic, po, pc);
+        if (task->coordinates) {
+            NI_ITERATOR_NEXT2(task->io, task->ic, po, pc);
         } else {
-            NI_ITERATOR_NEXT(io, po);
+            NI_ITERATOR_NEXT(task->io, po);
         }
     }
-
- exit:
-    NPY_END_THREADS;
-    free(edge_offsets);
-    if (data_offsets) {
-        for(jj = 0; jj < irank; jj++)
-            free(data_offsets[jj]);
-        free(data_offsets);
-    }
-    if (splvals) {
-        for(jj = 0; jj < irank; jj++)
-            free(splvals[jj]);
-        free(splvals);
-    }
-    free(foffsets);
-    free(fcoordinates);
-    return PyErr_Occurred() ? 0 : 1;
 }
 
-int NI_ZoomShift(PyArrayObject *input, PyArrayObject* zoom_ar,
-                 PyArrayObject* shift_ar, PyArrayObject *output,
-                 int order, int mode, double cval)
+int
+NI_GeometricTransform(PyArrayObject *input, int (*map)(npy_intp*, double*,
+                int, int, void*), void* map_data, PyArrayObject* matrix_ar,
+                PyArrayObject* shift_ar, PyArrayObject *coordinates,
+                PyArrayObject *output, int order, int mode, double cval,
+                int workers)
 {
-    char *po, *pi;
-    npy_intp **zeros = NULL, **offsets = NULL, ***edge_offsets = NULL;
-    npy_intp ftmp[NPY_MAXDIMS], *fcoordinates = NULL, *foffsets = NULL;
-    npy_intp jj, hh, kk, filter_size, odimensions[NPY_MAXDIMS];
-    npy_intp idimensions[NPY_MAXDIMS], istrides[NPY_MAXDIMS];
-    npy_intp size;
-    double ***splvals = NULL;
-    NI_Iterator io;
-    npy_double *zooms = zoom_ar ? (npy_double*)PyArray_DATA(zoom_ar) : NULL;
-    npy_double *shifts = shift_ar ? (npy_double*)PyArray_DATA(shift_ar) : NULL;
-    int rank = 0;
+    NI_SplineTaps taps = {NULL, NULL, 0};
+    NI_GeometricTask *tasks = NULL;
+    void **args = NULL;
+    npy_intp cstride = 0, scratch;
+    NI_Iterator ic;
+    int ntasks = 1, kk, err = 0;
     NPY_BEGIN_THREADS_DEF;
 
-    NPY_BEGIN_THREADS;
+    /* if the mapping is from array coordinates: */
+    if (coordinates) {
+        /* initialize a line iterator along the first axis: */
+        if (!NI_InitPointIterator(coordinates, &ic))
+            goto exit;
+        cstride = ic.strides[0];
+        if (!NI_LineIterator(&ic, 0))
+            goto exit;
+    }
+    if (!_InitSplineTaps(input, order, &taps))
+        goto exit;
 
-    for (kk = 0; kk < PyArray_NDIM(input); kk++) {
-        idimensions[kk] = PyArray_DIM(input, kk);
-        istrides[kk] = PyArray_STRIDE(input, kk);
-        odimensions[kk] = PyArray_DIM(output, kk);
+    /* a mapping function may call into Python, so it keeps to a single
+         thread: */
+    if (!map) {
+        ntasks = _InterpolationTasks(input, output, coordinates,
+                                     taps.filter_size, workers);
+    }
+    scratch = (taps.rank > 0 ? taps.rank : 1) * (order + 1);
+    tasks = calloc(ntasks, sizeof(NI_GeometricTask));
+    args = malloc(ntasks * sizeof(void *));
+    if (NPY_UNLIKELY(!tasks || !args)) {
+        PyErr_NoMemory();
+        goto exit;
     }
-    rank = PyArray_NDIM(input);
+    for(kk = 0; kk < ntasks; kk++) {
+        NI_GeometricTask *task = tasks + kk;
 
-    /* if the mode is 'constant' we need some temps later: */
-    if (mode == NI_EXTEND_CONSTANT) {
-        zeros = malloc(rank * sizeof(npy_intp*));
-        if (NPY_UNLIKELY(!zeros)) {
-            NPY_END_THREADS;
+        /* the border offsets and weights of the point at hand: */
+        task->data_offsets = malloc(scratch * sizeof(npy_intp));
+        task->splvals = malloc(scratch * sizeof(double));
+        if (NPY_UNLIKELY(!task->data_offsets || !task->splvals)) {
             PyErr_NoMemory();
             goto exit;
         }
-        for(jj = 0; jj < rank; jj++)
-            zeros[jj] = NULL;
-        for(jj = 0; jj < rank; jj++) {
-            zeros[jj] = malloc(odimensions[jj] * sizeof(npy_intp));
-            if (NPY_UNLIKELY(!zeros[jj])) {
-                NPY_END_THREADS;
-                PyErr_NoMemory();
-                goto exit;
-            }
+        if (!NI_InitPointIterator(output, &task->io))
+            goto exit;
+        if (coordinates)
+            task->ic = ic;
+        task->input = input;
+        task->output = output;
+        task->coordinates = coordinates;
+        task->map = map;
+        task->map_data = map_data;
+        task->matrix = matrix_ar ? (npy_double*)PyArray_DATA(matrix_ar) :
+                                   NULL;
+        task->shift = shift_ar ? (npy_double*)PyArray_DATA(shift_ar) : NULL;
+        task->taps = &taps;
+        task->cstride = cstride;
+        task->first = _InterpolationTaskFirst(output, kk, ntasks);
+        task->last = _InterpolationTaskFirst(output, kk + 1, ntasks);
+        task->cval = cval;
+        task->mode = mode;
+        args[kk] = task;
+    }
+
+    NPY_BEGIN_THREADS;
+    NI_RunThreads(ntasks, _GeometricTask, args);
+    NPY_END_THREADS;
+
+    for(kk = 0; kk < ntasks; kk++) {
+        if (tasks[kk].error < 0) {
+            /* the mapping function has set the error */
+            goto exit;
         }
+        err |= tasks[kk].error;
+    }
+    if (err & 2) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "coordinate array data type not supported");
+    } else if (err) {
+        PyErr_SetString(PyExc_RuntimeError, "data type not supported");
     }
 
-    /* store offsets, along each axis: */
-    offsets = malloc(rank * sizeof(npy_intp*));
-    /* store spline coefficients, along each axis: */
-    splvals = malloc(rank * sizeof(double**));
-    /* store offsets at all edges: */
-    edge_offsets = malloc(rank * sizeof(npy_intp**));
-    if (NPY_UNLIKELY(!offsets || !splvals || !edge_offsets)) {
-        NPY_END_THREADS;
-        PyErr_NoMemory();
-        goto exit;
+ exit:
+    if (tasks) {
+        for(kk = 0; kk < ntasks; kk++) {
+            free(tasks[kk].data_offsets);
+            free(tasks[kk].splvals);
+        }
     }
-    for(jj = 0; jj < rank; jj++) {
-        offsets[jj] = NULL;
-        splvals[jj] = NULL;
-        edge_offsets[jj] = NULL;
+    free(tasks);
+    free(args);
+    free(taps.foffsets);
+    free(taps.fcoordinates);
+    return PyErr_Occurred() ? 0 : 1;
+}
+
+/* The per-axis tables of NI_ZoomShift, with an entry for each output
+     coordinate along the axis: the offset of the first tap, the offsets of
+     the taps if they cross the border and NULL otherwise, the spline
+     weights of the taps, and whether the point takes the constant value: */
+typedef struct {
+    npy_intp *offsets[NPY_MAXDIMS];
+    npy_intp **edge_offsets[NPY_MAXDIMS];
+    npy_intp *edge_data[NPY_MAXDIMS];
+    double *splvals[NPY_MAXDIMS];
+    npy_bool *zeros[NPY_MAXDIMS];
+} NI_ZoomShiftTables;
+
+/* The range of output points of one thread of NI_ZoomShift: */
+typedef struct {
+    PyArrayObject *input, *output;
+    NI_SplineTaps *taps;
+    NI_ZoomShiftTables *tables;
+    NI_Iterator io;
+    npy_intp first, last;
+    double cval;
+    int error;
+} NI_ZoomShiftTask;
+
+static void _ZoomShiftTask(void *arg)
+{
+    NI_ZoomShiftTask *task = (NI_ZoomShiftTask *)arg;
+    NI_SplineTaps *taps = task->taps;
+    NI_ZoomShiftTables *tables = task->tables;
+    npy_intp *edge_offsets[NPY_MAXDIMS], kk;
+    double *weights[NPY_MAXDIMS];
+    char *po, *pi = PyArray_BYTES(task->input);
+    const int type_num = PyArray_TYPE(task->input);
+    const int otype_num = PyArray_TYPE(task->output);
+    int hh, rank = taps->rank, order = taps->order;
+
+    if (task->first >= task->last) {
+        return;
+    }
+    _IteratorGoto(&task->io, task->first, PyArray_BYTES(task->output), &po);
+    for(kk = task->first; kk < task->last; kk++) {
+        double t = 0.0;
+        npy_intp oo = 0;
+        int edge = 0, zero = 0;
+
+        for(hh = 0; hh < rank; hh++) {
+            npy_intp cc = task->io.coordinates[hh];
+            if (tables->zeros[hh] && tables->zeros[hh][cc]) {
+                /* we use constant border condition */
+                zero = 1;
+                break;
+            }
+            oo += tables->offsets[hh][cc];
+            edge_offsets[hh] = tables->edge_offsets[hh][cc];
+            if (edge_offsets[hh])
+                edge = 1;
+            weights[hh] = tables->splvals[hh] + cc * (order + 1);
+        }
+
+        if (!zero) {
+            if (!_InterpolatePoint(type_num, pi, oo, edge, edge_offsets,
+                                   weights, taps, &t)) {
+                task->error = 1;
+                return;
+            }
+        } else {
+            t = task->cval;
+        }
+        /* store output: */
+        if (!_WriteInterpOut(otype_num, po, t)) {
+            task->error = 1;
+            return;
+        }
+        NI_ITERATOR_NEXT(task->io, po);
     }
+}
+
+int NI_ZoomShift(PyArrayObject *input, PyArrayObject* zoom_ar,
+                 PyArrayObject* shift_ar, PyArrayObject *output,
+                 int order, int mode, double cval, int workers)
+{
+    NI_SplineTaps taps = {NULL, NULL, 0};
+    NI_ZoomShiftTables tables;
+    NI_ZoomShiftTask *tasks = NULL;
+    void **args = NULL;
+    npy_intp jj, kk, odimensions[NPY_MAXDIMS];
+    npy_double *zooms = zoom_ar ? (npy_double*)PyArray_DATA(zoom_ar) : NULL;
+    npy_double *shifts = shift_ar ? (npy_double*)PyArray_DATA(shift_ar) : NULL;
+    int rank = PyArray_NDIM(input), ntasks = 1, err = 0;
+    NPY_BEGIN_THREADS_DEF;
+
+    memset(&tables, 0, sizeof(tables));
+    if (!_InitSplineTaps(input, order, &taps))
+        goto exit;
+
+    /* allocate the tables of each axis: */
     for(jj = 0; jj < rank; jj++) {
-        offsets[jj] = malloc(odimensions[jj] * sizeof(npy_intp));
-        splvals[jj] = malloc(odimensions[jj] * sizeof(double*));
-        edge_offsets[jj] = malloc(odimensions[jj] * sizeof(npy_intp*));
-        if (NPY_UNLIKELY(!offsets[jj] || !splvals[jj] || !edge_offsets[jj])) {
-            NPY_END_THREADS;
+        npy_intp len;
+
+        odimensions[jj] = PyArray_DIM(output, jj);
+        len = odimensions[jj] > 0 ? odimensions[jj] : 1;
+        tables.offsets[jj] = malloc(len * sizeof(npy_intp));
+        tables.edge_offsets[jj] = malloc(len * sizeof(npy_intp*));
+        tables.edge_data[jj] = malloc(len * (order + 1) * sizeof(npy_intp));
+        tables.splvals[jj] = malloc(len * (order + 1) * sizeof(double));
+        if (NPY_UNLIKELY(!tables.offsets[jj] || !tables.edge_offsets[jj] ||
+                         !tables.edge_data[jj] || !tables.splvals[jj])) {
             PyErr_NoMemory();
             goto exit;
         }
-        for(hh = 0; hh < odimensions[jj]; hh++) {
-            splvals[jj][hh] = NULL;
-            edge_offsets[jj][hh] = NULL;
+        /* if the mode is 'constant' some points take the constant: */
+        if (mode == NI_EXTEND_CONSTANT) {
+            tables.zeros[jj] = malloc(len * sizeof(npy_bool));
+            if (NPY_UNLIKELY(!tables.zeros[jj])) {
+                PyErr_NoMemory();
+                goto exit;
+            }
         }
     }
 
-    /* precalculate offsets, and offsets at the edge: */
+    /* precalculate offsets, offsets at the edge and spline weights: */
     for(jj = 0; jj < rank; jj++) {
         double shift = 0.0, zoom = 0.0;
         if (shifts)
@@ -649,231 +865,78 @@ int NI_ZoomShift(PyArrayObject *input, PyArrayObject* zoom_ar,
                 cc += shift;
             if (zooms)
                 cc *= zoom;
-            cc = map_coordinate(cc, idimensions[jj], mode);
+            cc = map_coordinate(cc, taps.idimensions[jj], mode);
+            tables.edge_offsets[jj][kk] = NULL;
             if (cc > -1.0) {
-                npy_intp start;
-                if (zeros && zeros[jj])
-                    zeros[jj][kk] = 0;
-                if (order & 1) {
-                    start = (npy_intp)floor(cc) - order / 2;
-                } else {
-                    start = (npy_intp)floor(cc + 0.5) - order / 2;
-                }
-                offsets[jj][kk] = istrides[jj] * start;
-                if (start < 0 || start + order >= idimensions[jj]) {
-                    edge_offsets[jj][kk] = malloc((order + 1) * sizeof(npy_intp));
-                    if (NPY_UNLIKELY(!edge_offsets[jj][kk])) {
-                        NPY_END_THREADS;
-                        PyErr_NoMemory();
-                        goto exit;
-                    }
-                    for(hh = 0; hh <= order; hh++) {
-                        npy_intp idx = start + hh;
-                        npy_intp len = idimensions[jj];
-                        if (len <= 1) {
-                            idx = 0;
-                        } else {
-                            npy_intp s2 = 2 * len - 2;
-                            if (idx < 0) {
-                                idx = s2 * (npy_intp)(-idx / s2) + idx;
-                                idx = idx <= 1 - len ? idx + s2 : -idx;
-                            } else if (idx >= len) {
-                                idx -= s2 * (npy_intp)(idx / s2);
-                                if (idx >= len)
-                                    idx = s2 - idx;
-                            }
-                        }
-                        edge_offsets[jj][kk][hh] = istrides[jj] * (idx - start);
-                    }
+                npy_intp start = SPLINE_START(cc, order);
+                if (tables.zeros[jj])
+                    tables.zeros[jj][kk] = 0;
+                tables.offsets[jj][kk] = taps.istrides[jj] * start;
+                if (start < 0 || start + order >= taps.idimensions[jj]) {
+                    npy_intp *eo = tables.edge_data[jj] + kk * (order + 1);
+                    _EdgeOffsets(start, taps.idimensions[jj],
+                                 taps.istrides[jj], order, eo);
+                    tables.edge_offsets[jj][kk] = eo;
                 }
                 if (order > 0) {
-                    splvals[jj][kk] = malloc((order + 1) * sizeof(double));
-                    if (NPY_UNLIKELY(!splvals[jj][kk])) {
-                        NPY_END_THREADS;
-                        PyErr_NoMemory();
-                        goto exit;
-                    }
-                    get_spline_interpolation_weights(cc, order, splvals[jj][kk]);
+                    get_spline_interpolation_weights(
+                        cc, order, tables.splvals[jj] + kk * (order + 1));
                 }
             } else {
-                zeros[jj][kk] = 1;
+                tables.zeros[jj][kk] = 1;
             }
         }
     }
 
-    filter_size = 1;
-    for(jj = 0; jj < rank; jj++)
-        filter_size *= order + 1;
-
-    if (!NI_InitPointIterator(output, &io))
-        goto exit;
-
-    pi = (void *)PyArray_DATA(input);
-    po = (void *)PyArray_DATA(output);
-
-    /* store all coordinates and offsets with filter: */
-    fcoordinates = malloc(rank * filter_size * sizeof(npy_intp));
-    foffsets = malloc(filter_size * sizeof(npy_intp));
-    if (NPY_UNLIKELY(!fcoordinates || !foffsets)) {
-        NPY_END_THREADS;
+    ntasks = _InterpolationTasks(input, output, NULL, taps.filter_size,
+                                 workers);
+    tasks = malloc(ntasks * sizeof(NI_ZoomShiftTask));
+    args = malloc(ntasks * sizeof(void *));
+    if (NPY_UNLIKELY(!tasks || !args)) {
         PyErr_NoMemory();
         goto exit;
     }
+    for(kk = 0; kk < ntasks; kk++) {
+        NI_ZoomShiftTask *task = tasks + kk;
 
-    for(jj = 0; jj < rank; jj++)
-        ftmp[jj] = 0;
-    kk = 0;
-    for(hh = 0; hh < filter_size; hh++) {
-        for(jj = 0; jj < rank; jj++)
-            fcoordinates[jj + hh * rank] = ftmp[jj];
-        foffsets[hh] = kk;
-        for(jj = rank - 1; jj >= 0; jj--) {
-            if (ftmp[jj] < order) {
-                ftmp[jj]++;
-                kk += istrides[jj];
-                break;
-            } else {
-                ftmp[jj] = 0;
-                kk -= istrides[jj] * order;
-            }
-        }
+        if (!NI_InitPointIterator(output, &task->io))
+            goto exit;
+        task->input = input;
+        task->output = output;
+        task->taps = &taps;
+        task->tables = &tables;
+        task->first = _InterpolationTaskFirst(output, kk, ntasks);
+        task->last = _InterpolationTaskFirst(output, kk + 1, ntasks);
+        task->cval = cval;
+        task->error = 0;
+        args[kk] = task;
     }
-    size = PyArray_SIZE(output);
-    for(kk = 0; kk < size; kk++) {
-        double t = 0.0;
-        npy_intp edge = 0, oo = 0, zero = 0;
 
-        for(hh = 0; hh < rank; hh++) {
-            if (zeros && zeros[hh][io.coordinates[hh]]) {
-                /* we use constant border condition */
-                zero = 1;
-                break;
-            }
-            oo += offsets[hh][io.coordinates[hh]];
-            if (edge_offsets[hh][io.coordinates[hh]])
-                edge = 1;
-        }
+    NPY_BEGIN_THREADS;
+    NI_RunThreads(ntasks, _ZoomShiftTask, args);
+    NPY_END_THREADS;
 
-        if (!zero) {
-            npy_intp *ff = fcoordinates;
-            const int type_num = PyArray_TYPE(input);
-            t = 0.0;
-            for(hh = 0; hh < filter_size; hh++) {
-                npy_intp idx = 0;
-                double coeff = 0.0;
-
-                if (NPY_UNLIKELY(edge)) {
-                    /* use precalculated edge offsets: */
-                    for(jj = 0; jj < rank; jj++) {
-                        if (edge_offsets[jj][io.coordinates[jj]])
-                            idx += edge_offsets[jj][io.coordinates[jj]][ff[jj]];
-                        else
-                            idx += ff[jj] * istrides[jj];
-                    }
-                    idx += oo;
-                } else {
-                    /* use normal offsets: */
-                    idx += oo + foffsets[hh];
-                }
-                switch (type_num) {
-                    CASE_INTERP_COEFF(NPY_BOOL, npy_bool,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_UBYTE, npy_ubyte,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_USHORT, npy_ushort,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_UINT, npy_uint,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_ULONG, npy_ulong,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_ULONGLONG, npy_ulonglong,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_BYTE, npy_byte,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_SHORT, npy_short,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_INT, npy_int,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_LONG, npy_long,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_LONGLONG, npy_longlong,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_FLOAT, npy_float,
-                                      coeff, pi, idx);
-                    CASE_INTERP_COEFF(NPY_DOUBLE, npy_double,
-                                      coeff, pi, idx);
-                default:
-                    NPY_END_THREADS;
-                    PyErr_SetString(PyExc_RuntimeError,
-                                    "data type not supported");
-                    goto exit;
-                }
-                /* calculate interpolated value: */
-                for(jj = 0; jj < rank; jj++)
-                    if (order > 0)
-                        coeff *= splvals[jj][io.coordinates[jj]][ff[jj]];
-                t += coeff;
-                ff += rank;
-            }
-        } else {
-            t = cval;
-        }
-        /* store output: */
-        switch (PyArray_TYPE(output)) {
-            CASE_INTERP_OUT(NPY_BOOL, npy_bool, po, t);
-            CASE_INTERP_OUT_UINT(UBYTE, npy_ubyte, po, t);
-            CASE_INTERP_OUT_UINT(USHORT, npy_ushort, po, t);
-            CASE_INTERP_OUT_UINT(UINT, npy_uint, po, t);
-            CASE_INTERP_OUT_UINT(ULONG, npy_ulong, po, t);
-            CASE_INTERP_OUT_UINT(ULONGLONG, npy_ulonglong, po, t);
-            CASE_INTERP_OUT_INT(BYTE, npy_byte, po, t);
-            CASE_INTERP_OUT_INT(SHORT, npy_short, po, t);
-            CASE_INTERP_OUT_INT(INT, npy_int, po, t);
-            CASE_INTERP_OUT_INT(LONG, npy_long, po, t);
-            CASE_INTERP_OUT_INT(LONGLONG, npy_longlong, po, t);
-            CASE_INTERP_OUT(NPY_FLOAT, npy_float, po, t);
-            CASE_INTERP_OUT(NPY_DOUBLE, npy_double, po, t);
-        default:
-            NPY_END_THREADS;
-            PyErr_SetString(PyExc_RuntimeError, "data type not supported");
-            goto exit;
-        }
-        NI_ITERATOR_NEXT(io, po);
+    for(kk = 0; kk < ntasks; kk++) {
+        err |= tasks[kk].error;
+    }
+    if (err) {
+        PyErr_SetString(PyExc_RuntimeError, "data type not supported");
     }
 
  exit:
-    NPY_END_THREADS;
-    if (zeros) {
-        for(jj = 0; jj < rank; jj++)
-            free(zeros[jj]);
-        free(zeros);
-    }
-    if (offsets) {
-        for(jj = 0; jj < rank; jj++)
-            free(offsets[jj]);
-        free(offsets);
-    }
-    if (splvals) {
-        for(jj = 0; jj < rank; jj++) {
-            if (splvals[jj]) {
-                for(hh = 0; hh < odimensions[jj]; hh++)
-                    free(splvals[jj][hh]);
-                free(splvals[jj]);
-            }
-        }
-        free(splvals);
-    }
-    if (edge_offsets) {
-        for(jj = 0; jj < rank; jj++) {
-            if (edge_offsets[jj]) {
-                for(hh = 0; hh < odimensions[jj]; hh++)
-                    free(edge_offsets[jj][hh]);
-                free(edge_offsets[jj]);
-            }
-        }
-        free(edge_offsets);
+    for(jj = 0; jj < rank; jj++) {
+        free(tables.offsets[jj]);
+        free(tables.edge_offsets[jj]);
+        free(tables.edge_data[jj]);
+        free(tables.splvals[jj]);
+        free(tables.zeros[jj]);
     }
-    free(foffsets);
-    free(fcoordinates);
+    free(tasks);
+    free(args);
+    free(taps.foffsets);
+    free(taps.fcoordinates);
     return PyErr_Occurred() ? 0 : 1;
 }
+
+#undef CASE_INTERP_TAPS
+#undef SPLINE_START
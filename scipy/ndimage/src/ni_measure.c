@@ -31,6 +31,7 @@
 
 #include "ni_support.h"
 #include "ni_measure.h"
+#include "ni_threads.h"
 #include <stdlib.h>
 #include <math.h>
 #include <float.h>
@@ -138,28 +139,852 @@ int NI_FindObjects(PyArrayObject* input, npy_intp max_label,
 }
 
 
-#define WS_GET_INDEX(_TYPE, _type, _index, _c_strides,      \
-                     _b_strides, _rank, _out,  _contiguous) \
-do {                                                        \
-    if (_contiguous) {                                      \
-        _out = _index * sizeof(_type);                      \
-    }                                                       \
-    else {                                                  \
-        int _qq;                                            \
-        npy_intp _cc;                                       \
-        npy_intp _idx = _index;                             \
-        _out = 0;                                           \
-        for (_qq = 0; _qq < _rank; _qq++) {                 \
-            _cc = _idx / _c_strides[_qq];                   \
-            _idx -= _cc * _c_strides[_qq];                  \
-            _out += _b_strides[_qq] * _cc;                  \
-        }                                                   \
-    }                                                       \
-} while(0)
+#define LABEL_MIN_WORK_PER_THREAD 65536
+#define LABEL_TABLE_SIZE 1024
+
+#define CASE_NONZERO_LINE(_TYPE, _type, _pi, _stride, _mask, _length) \
+case _TYPE:                                                           \
+{                                                                     \
+    npy_intp _ll;                                                     \
+    for (_ll = 0; _ll < _length; _ll++) {                             \
+        _mask[_ll] = *(_type *)(_pi + _ll * _stride) != 0;            \
+    }                                                                 \
+}                                                                     \
+break
+
+/* The labels of a slab of planes along the first axis, of one thread. A
+     slab is labeled on its own with a local union-find table, whose roots
+     are then numbered in the order of their first element. The slabs are
+     joined through the labels of their faces in a global union-find
+     table, shared by all the threads: */
+typedef struct {
+    PyArrayObject *input, *output;
+    const npy_intp *offsets, *loffsets;
+    npy_intp noffsets, first, last, nlabels, table_size, global;
+    npy_intp *table;
+    volatile npy_intp *parent;
+    char *mask;
+    int phase, is64, error;
+} NI_LabelTask;
+
+static NPY_INLINE npy_intp _GetLabel(const char *po, npy_intp index,
+                                     int is64)
+{
+    return is64 ? (npy_intp)((const npy_int64 *)po)[index] :
+                  (npy_intp)((const npy_int32 *)po)[index];
+}
+
+static NPY_INLINE void _SetLabel(char *po, npy_intp index, int is64,
+                                 npy_intp label)
+{
+    if (is64) {
+        ((npy_int64 *)po)[index] = label;
+    } else {
+        ((npy_int32 *)po)[index] = (npy_int32)label;
+    }
+}
+
+/* The root of a label in a table whose entries point at smaller labels: */
+static NPY_INLINE npy_intp _LabelRoot(const npy_intp *table, npy_intp label)
+{
+    while (table[label] != label) {
+        label = table[label];
+    }
+    return label;
+}
+
+/* Join the trees of two labels of the local table, under the smaller
+     root, and point the labels straight at it: */
+static void _LocalUnion(npy_intp *table, npy_intp a, npy_intp b)
+{
+    npy_intp ra = _LabelRoot(table, a), rb = _LabelRoot(table, b);
+    npy_intp root = ra < rb ? ra : rb;
+
+    table[ra] = table[rb] = root;
+    while (table[a] != root) {
+        npy_intp next = table[a];
+        table[a] = root;
+        a = next;
+    }
+    while (table[b] != root) {
+        npy_intp next = table[b];
+        table[b] = root;
+        b = next;
+    }
+}
+
+/* Join the trees of two labels of the shared table. A root only ever
+     changes into a smaller label, so that a failed exchange just means
+     that another thread moved the root first: */
+static void _SharedUnion(volatile npy_intp *parent, npy_intp a, npy_intp b)
+{
+    for (;;) {
+        while (parent[a] != a) {
+            a = parent[a];
+        }
+        while (parent[b] != b) {
+            b = parent[b];
+        }
+        if (a == b) {
+            return;
+        }
+        if (a < b) {
+            npy_intp t = a;
+            a = b;
+            b = t;
+        }
+        if (NI_AtomicCompareExchange(parent + a, a, b)) {
+            return;
+        }
+    }
+}
+
+/* Move the coordinates of a C-ordered array on by count elements along its
+     last axis, where they may not move past the end of that axis: */
+static NPY_INLINE void _LabelCoordinatesNext(npy_intp *coor,
+                                             const npy_intp *dims, int rank,
+                                             npy_intp count)
+{
+    int kk = rank - 1;
+
+    coor[kk] += count;
+    while (kk > 0 && coor[kk] >= dims[kk]) {
+        coor[kk] = 0;
+        ++coor[--kk];
+    }
+}
+
+/* Whether an element plus a neighbor offset stays in the array, and in the
+     planes from first on: */
+static NPY_INLINE int _LabelNeighborInside(const npy_intp *coor,
+                                          const npy_intp *offset,
+                                          const npy_intp *dims, int rank,
+                                          npy_intp first)
+{
+    int kk;
+
+    for (kk = 0; kk < rank; kk++) {
+        npy_intp cc = coor[kk] + offset[kk];
+        if (cc < (kk == 0 ? first : 0) || cc >= dims[kk]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Label the slab of the task, with local labels from 1 on: */
+static void _LabelSlab(NI_LabelTask *task)
+{
+    PyArrayObject *input = task->input, *output = task->output;
+    const npy_intp *dims = PyArray_DIMS(output);
+    int rank = PyArray_NDIM(output), kk;
+    npy_intp plane = PyArray_SIZE(output) / dims[0], length = dims[rank - 1];
+    npy_intp index = task->first * plane, end = task->last * plane;
+    npy_intp coor[NPY_MAXDIMS], nn, ll, next = 1;
+    char *po = PyArray_BYTES(output);
+    int is64 = task->is64;
+
+    for (kk = 0; kk < rank; kk++) {
+        coor[kk] = 0;
+    }
+    coor[0] = task->first;
+    while (index < end) {
+        npy_intp x0 = coor[rank - 1], count = length - x0;
+        char *pi = PyArray_BYTES(input);
+        int interior = 1;
+
+        if (count > end - index) {
+            count = end - index;
+        }
+        for (kk = 0; kk < rank; kk++) {
+            pi += coor[kk] * PyArray_STRIDE(input, kk);
+        }
+        switch (PyArray_TYPE(input)) {
+            CASE_NONZERO_LINE(NPY_BOOL, npy_bool, pi,
+                              PyArray_STRIDE(input, rank - 1), task->mask,
+                              count);
+            CASE_NONZERO_LINE(NPY_UBYTE, npy_ubyte, pi,
+                              PyArray_STRIDE(input, rank - 1), task->mask,
+                              count);
+            CASE_NONZERO_LINE(NPY_USHORT, npy_ushort, pi,
+                              PyArray_STRIDE(input, rank - 1), task->mask,
+                              count);
+            CASE_NONZERO_LINE(NPY_UINT, npy_uint, pi,
+                              PyArray_STRIDE(input, rank - 1), task->mask,
+                              count);
+            CASE_NONZERO_LINE(NPY_ULONG, npy_ulong, pi,
+                              PyArray_STRIDE(input, rank - 1), task->mask,
+                              count);
+            CASE_NONZERO_LINE(NPY_ULONGLONG, npy_ulonglong, pi,
+                              PyArray_STRIDE(input, rank - 1), task->mask,
+                              count);
+            CASE_NONZERO_LINE(NPY_BYTE, npy_byte, pi,
+                              PyArray_STRIDE(input, rank - 1), task->mask,
+                              count);
+            CASE_NONZERO_LINE(NPY_SHORT, npy_short, pi,
+                              PyArray_STRIDE(input, rank - 1), task->mask,
+                              count);
+            CASE_NONZERO_LINE(NPY_INT, npy_int, pi,
+                              PyArray_STRIDE(input, rank - 1), task->mask,
+                              count);
+            CASE_NONZERO_LINE(NPY_LONG, npy_long, pi,
+                              PyArray_STRIDE(input, rank - 1), task->mask,
+                              count);
+            CASE_NONZERO_LINE(NPY_LONGLONG, npy_longlong, pi,
+                              PyArray_STRIDE(input, rank - 1), task->mask,
+                              count);
+            CASE_NONZERO_LINE(NPY_FLOAT, npy_float, pi,
+                              PyArray_STRIDE(input, rank - 1), task->mask,
+                              count);
+            CASE_NONZERO_LINE(NPY_DOUBLE, npy_double, pi,
+                              PyArray_STRIDE(input, rank - 1), task->mask,
+                              count);
+        default:
+            task->error = 1;
+            return;
+        }
+        /* the neighbors of a line away from the borders need no checks: */
+        for (kk = 0; kk < rank - 1; kk++) {
+            if (coor[kk] <= (kk == 0 ? task->first : 0) ||
+                    coor[kk] >= dims[kk] - 1) {
+                interior = 0;
+                break;
+            }
+        }
+        for (ll = 0; ll < count; ll++) {
+            npy_intp x = x0 + ll, label = 0;
+
+            if (!task->mask[ll]) {
+                _SetLabel(po, index + ll, is64, 0);
+                continue;
+            }
+            coor[rank - 1] = x;
+            for (nn = 0; nn < task->noffsets; nn++) {
+                npy_intp neighbor;
+                if (!(interior && x > (rank == 1 ? task->first : 0) &&
+                      x < length - 1) &&
+                        !_LabelNeighborInside(coor,
+                                              task->offsets + nn * rank,
+                                              dims, rank, task->first)) {
+                    continue;
+                }
+                neighbor = _GetLabel(po, index + ll + task->loffsets[nn],
+                                     is64);
+                if (neighbor) {
+                    if (!label) {
+                        label = neighbor;
+                    } else if (neighbor != label) {
+                        _LocalUnion(task->table, label, neighbor);
+                    }
+                }
+            }
+            if (!label) {
+                if (next >= task->table_size) {
+                    npy_intp *table = realloc(task->table,
+                                2 * task->table_size * sizeof(npy_intp));
+                    if (!table) {
+                        task->error = 1;
+                        return;
+                    }
+                    task->table = table;
+                    task->table_size *= 2;
+                }
+                task->table[next] = next;
+                label = next++;
+            }
+            _SetLabel(po, index + ll, is64, label);
+        }
+        coor[rank - 1] = x0;
+        _LabelCoordinatesNext(coor, dims, rank, count);
+        index += count;
+    }
+    /* number the roots, the entries of a label pointing at a smaller one
+         whose entry already holds the number of its root: */
+    task->nlabels = 0;
+    for (ll = 1; ll < next; ll++) {
+        npy_intp root = task->table[ll];
+        task->table[ll] = root == ll ? ++task->nlabels : task->table[root];
+    }
+}
+
+/* Join the labels of the first plane of the slab of the task to those of
+     the last plane of the slab before it: */
+static void _LabelFace(NI_LabelTask *task)
+{
+    NI_LabelTask *prev = task - 1;
+    PyArrayObject *output = task->output;
+    const npy_intp *dims = PyArray_DIMS(output);
+    int rank = PyArray_NDIM(output), kk;
+    npy_intp plane = PyArray_SIZE(output) / dims[0];
+    npy_intp index = task->first * plane, ll, nn;
+    npy_intp coor[NPY_MAXDIMS];
+    char *po = PyArray_BYTES(output);
+    int is64 = task->is64;
+
+    for (kk = 0; kk < rank; kk++) {
+        coor[kk] = 0;
+    }
+    coor[0] = task->first;
+    for (ll = 0; ll < plane; ll++, index++) {
+        npy_intp label = _GetLabel(po, index, is64);
+
+        if (label) {
+            label = task->global + task->table[label] - 1;
+            for (nn = 0; nn < task->noffsets; nn++) {
+                const npy_intp *offset = task->offsets + nn * rank;
+                npy_intp neighbor;
+                if (offset[0] != -1 ||
+                        !_LabelNeighborInside(coor, offset, dims, rank, 0)) {
+                    continue;
+                }
+                neighbor = _GetLabel(po, index + task->loffsets[nn], is64);
+                if (neighbor) {
+                    _SharedUnion(task->parent, label,
+                                 prev->global + prev->table[neighbor] - 1);
+                }
+            }
+        }
+        if (rank > 1) {
+            _LabelCoordinatesNext(coor, dims, rank, 1);
+        }
+    }
+}
+
+/* Replace the local labels of the slab of the task by the final ones: */
+static void _RelabelSlab(NI_LabelTask *task)
+{
+    PyArrayObject *output = task->output;
+    npy_intp plane = PyArray_SIZE(output) / PyArray_DIM(output, 0);
+    npy_intp index, end = task->last * plane;
+    char *po = PyArray_BYTES(output);
+    int is64 = task->is64;
+
+    for (index = task->first * plane; index < end; index++) {
+        npy_intp label = _GetLabel(po, index, is64);
+        if (label) {
+            _SetLabel(po, index, is64,
+                      task->parent[task->global + task->table[label] - 1]);
+        }
+    }
+}
+
+static void _LabelTask(void *arg)
+{
+    NI_LabelTask *task = (NI_LabelTask *)arg;
+
+    switch (task->phase) {
+    case 0:
+        _LabelSlab(task);
+        break;
+    case 1:
+        if (task->first > 0) {
+            _LabelFace(task);
+        }
+        break;
+    default:
+        _RelabelSlab(task);
+        break;
+    }
+}
+
+/* Label the connected nonzero elements of input into output, a C-ordered
+     array of 32 or 64 bit integers, for the connectivity of the 3 x 3 x ...
+     structure strct. The labels are numbered in the order of the first
+     element of each object, as the line by line labeling does, and the
+     slabs of planes of the first axis are labeled on up to workers
+     threads. The number of objects is returned in max_label. */
+int NI_Label(PyArrayObject *input, PyArrayObject *strct,
+             PyArrayObject *output, int workers, npy_intp *max_label)
+{
+    NI_LabelTask *tasks = NULL;
+    void **args = NULL;
+    npy_intp *offsets = NULL, *loffsets = NULL, *parent = NULL;
+    npy_intp noffsets = 0, size = PyArray_SIZE(output), total = 0, kk, jj;
+    npy_intp dim0, center = 1, cstride;
+    int rank = PyArray_NDIM(output), ntasks = 1, tt, ii;
+    NPY_BEGIN_THREADS_DEF;
+
+    *max_label = 0;
+    if (!PyArray_ISINTEGER(output) || !PyArray_IS_C_CONTIGUOUS(output) ||
+            (PyArray_ITEMSIZE(output) != 4 && PyArray_ITEMSIZE(output) != 8)) {
+        PyErr_SetString(PyExc_RuntimeError, "output must be a C-contiguous "
+                        "array of 32 or 64 bit integers");
+        return 0;
+    }
+    if (rank < 1 || size == 0) {
+        return 1;
+    }
+    dim0 = PyArray_DIM(output, 0);
+    for (ii = 0; ii < rank; ii++) {
+        center *= 3;
+    }
+    center /= 2;
+    /* the offsets of the neighbors that come before an element: */
+    offsets = malloc(center * rank * sizeof(npy_intp));
+    loffsets = malloc(center * sizeof(npy_intp));
+    if (!offsets || !loffsets) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+    for (kk = 0; kk < center; kk++) {
+        npy_intp index = kk, *offset = offsets + noffsets * rank;
+        char *ps = PyArray_BYTES(strct);
+
+        loffsets[noffsets] = 0;
+        cstride = 1;
+        for (ii = rank - 1; ii >= 0; ii--) {
+            offset[ii] = index % 3 - 1;
+            index /= 3;
+            ps += (offset[ii] + 1) * PyArray_STRIDE(strct, ii);
+            loffsets[noffsets] += offset[ii] * cstride;
+            cstride *= PyArray_DIM(output, ii);
+        }
+        if (*(npy_bool *)ps) {
+            ++noffsets;
+        }
+    }
+
+    if (workers > 1) {
+        npy_intp max_tasks = size / LABEL_MIN_WORK_PER_THREAD;
+        if (max_tasks > dim0) {
+            max_tasks = dim0;
+        }
+        if (max_tasks < workers) {
+            workers = max_tasks > 1 ? (int)max_tasks : 1;
+        }
+        ntasks = workers;
+    }
+    tasks = calloc(ntasks, sizeof(NI_LabelTask));
+    args = malloc(ntasks * sizeof(void *));
+    if (!tasks || !args) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+    for (tt = 0; tt < ntasks; tt++) {
+        NI_LabelTask *task = tasks + tt;
+
+        args[tt] = task;
+        task->input = input;
+        task->output = output;
+        task->offsets = offsets;
+        task->loffsets = loffsets;
+        task->noffsets = noffsets;
+        task->first = dim0 * tt / ntasks;
+        task->last = dim0 * (tt + 1) / ntasks;
+        task->is64 = PyArray_ITEMSIZE(output) == 8;
+        task->table_size = LABEL_TABLE_SIZE;
+        task->table = malloc(task->table_size * sizeof(npy_intp));
+        task->mask = malloc(PyArray_DIM(output, rank - 1));
+        if (!task->table || !task->mask) {
+            PyErr_NoMemory();
+            goto exit;
+        }
+    }
+
+    NPY_BEGIN_THREADS;
+    NI_RunThreads(ntasks, _LabelTask, args);
+    for (tt = 0; tt < ntasks; tt++) {
+        if (tasks[tt].error) {
+            break;
+        }
+        tasks[tt].global = total;
+        total += tasks[tt].nlabels;
+    }
+    if (tt == ntasks) {
+        parent = malloc((total + 1) * sizeof(npy_intp));
+    }
+    if (parent) {
+        for (jj = 0; jj < total; jj++) {
+            parent[jj] = jj;
+        }
+        for (tt = 0; tt < ntasks; tt++) {
+            tasks[tt].parent = parent;
+            tasks[tt].phase = 1;
+        }
+        NI_RunThreads(ntasks, _LabelTask, args);
+        /* number the roots of the joined labels from 1 on: */
+        for (jj = 0; jj < total; jj++) {
+            npy_intp root = parent[jj];
+            parent[jj] = root == jj ? ++*max_label : parent[root];
+        }
+        for (tt = 0; tt < ntasks; tt++) {
+            tasks[tt].phase = 2;
+        }
+        NI_RunThreads(ntasks, _LabelTask, args);
+    }
+    NPY_END_THREADS;
+
+    for (tt = 0; tt < ntasks; tt++) {
+        if (tasks[tt].error) {
+            break;
+        }
+    }
+    if (tt < ntasks) {
+        switch (PyArray_TYPE(input)) {
+        case NPY_BOOL: case NPY_UBYTE: case NPY_USHORT: case NPY_UINT:
+        case NPY_ULONG: case NPY_ULONGLONG: case NPY_BYTE: case NPY_SHORT:
+        case NPY_INT: case NPY_LONG: case NPY_LONGLONG: case NPY_FLOAT:
+        case NPY_DOUBLE:
+            PyErr_NoMemory();
+            break;
+        default:
+            PyErr_SetString(PyExc_RuntimeError, "data type not supported");
+            break;
+        }
+    } else if (!parent) {
+        PyErr_NoMemory();
+    }
+
+ exit:
+    if (tasks) {
+        for (tt = 0; tt < ntasks; tt++) {
+            free(tasks[tt].table);
+            free(tasks[tt].mask);
+        }
+    }
+    free(tasks);
+    free(args);
+    free(offsets);
+    free(loffsets);
+    free(parent);
+    return PyErr_Occurred() ? 0 : 1;
+}
+
+
+#define STATS_MIN_WORK_PER_THREAD 262144
+
+#define CASE_GET_STATS_LABEL(_TYPE, _type, _label, _pl) \
+case _TYPE:                                             \
+    _label = (npy_intp)*(_type *)_pl;                   \
+    break
+
+#define CASE_GET_STATS_VALUE(_TYPE, _type, _value, _pi) \
+case _TYPE:                                             \
+    _value = (double)*(_type *)_pi;                     \
+    break
+
+/* Move an iterator to the element with the given index in C order: */
+static void _StatisticsIteratorGoto(NI_Iterator *it, npy_intp index,
+                                    char *base, char **pointer)
+{
+    npy_intp coordinates[NPY_MAXDIMS];
+    int kk;
+
+    for(kk = it->rank_m1; kk >= 0; kk--) {
+        coordinates[kk] = index % (it->dimensions[kk] + 1);
+        index /= it->dimensions[kk] + 1;
+    }
+    NI_ITERATOR_GOTO(*it, coordinates, base, *pointer);
+}
+
+/* The elements of one thread of NI_LabeledStatistics, with its own
+     statistics, except for the first thread, that takes the results: */
+typedef struct {
+    PyArrayObject *input, *labels;
+    const npy_intp *index;
+    npy_intp nindex, min_label, nbins, first, last;
+    NI_LabelStatistics stats;
+    int error;
+} NI_LabelStatisticsTask;
+
+/* The bin of a label, or -1 if it is not measured: */
+static NPY_INLINE npy_intp _StatisticsBin(const NI_LabelStatisticsTask *task,
+                                          npy_intp label)
+{
+    if (task->index) {
+        npy_intp low = 0, high = task->nindex;
+        while (low < high) {
+            npy_intp mid = low + (high - low) / 2;
+            if (task->index[mid] < label) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return low < task->nindex && task->index[low] == label ? low : -1;
+    }
+    label -= task->min_label;
+    return label >= 0 && label < task->nbins ? label : -1;
+}
+
+static void _LabelStatisticsTask(void *arg)
+{
+    NI_LabelStatisticsTask *task = (NI_LabelStatisticsTask *)arg;
+    NI_LabelStatistics *st = &task->stats;
+    NI_Iterator ii, il;
+    char *pi = NULL, *pl = NULL;
+    int rank = PyArray_NDIM(task->input), kk;
+    npy_intp jj;
+
+    if (task->first >= task->last) {
+        return;
+    }
+    if (!NI_InitPointIterator(task->input, &ii) ||
+            (task->labels && !NI_InitPointIterator(task->labels, &il))) {
+        task->error = 1;
+        return;
+    }
+    _StatisticsIteratorGoto(&ii, task->first, PyArray_BYTES(task->input), &pi);
+    if (task->labels) {
+        NI_ITERATOR_GOTO(il, ii.coordinates, PyArray_BYTES(task->labels), pl);
+    }
+    for (jj = task->first; jj < task->last; jj++) {
+        npy_intp label = 0, bin, count;
+        double value = 0.0;
+
+        if (task->labels) {
+            switch (PyArray_TYPE(task->labels)) {
+                CASE_GET_STATS_LABEL(NPY_BOOL, npy_bool, label, pl);
+                CASE_GET_STATS_LABEL(NPY_UBYTE, npy_ubyte, label, pl);
+                CASE_GET_STATS_LABEL(NPY_USHORT, npy_ushort, label, pl);
+                CASE_GET_STATS_LABEL(NPY_UINT, npy_uint, label, pl);
+                CASE_GET_STATS_LABEL(NPY_ULONG, npy_ulong, label, pl);
+                CASE_GET_STATS_LABEL(NPY_ULONGLONG, npy_ulonglong, label, pl);
+                CASE_GET_STATS_LABEL(NPY_BYTE, npy_byte, label, pl);
+                CASE_GET_STATS_LABEL(NPY_SHORT, npy_short, label, pl);
+                CASE_GET_STATS_LABEL(NPY_INT, npy_int, label, pl);
+                CASE_GET_STATS_LABEL(NPY_LONG, npy_long, label, pl);
+                CASE_GET_STATS_LABEL(NPY_LONGLONG, npy_longlong, label, pl);
+            default:
+                task->error = 1;
+                return;
+            }
+        }
+        bin = _StatisticsBin(task, label);
+        if (bin >= 0) {
+            switch (PyArray_TYPE(task->input)) {
+                CASE_GET_STATS_VALUE(NPY_BOOL, npy_bool, value, pi);
+                CASE_GET_STATS_VALUE(NPY_UBYTE, npy_ubyte, value, pi);
+                CASE_GET_STATS_VALUE(NPY_USHORT, npy_ushort, value, pi);
+                CASE_GET_STATS_VALUE(NPY_UINT, npy_uint, value, pi);
+                CASE_GET_STATS_VALUE(NPY_ULONG, npy_ulong, value, pi);
+                CASE_GET_STATS_VALUE(NPY_ULONGLONG, npy_ulonglong, value, pi);
+                CASE_GET_STATS_VALUE(NPY_BYTE, npy_byte, value, pi);
+                CASE_GET_STATS_VALUE(NPY_SHORT, npy_short, value, pi);
+                CASE_GET_STATS_VALUE(NPY_INT, npy_int, value, pi);
+                CASE_GET_STATS_VALUE(NPY_LONG, npy_long, value, pi);
+                CASE_GET_STATS_VALUE(NPY_LONGLONG, npy_longlong, value, pi);
+                CASE_GET_STATS_VALUE(NPY_FLOAT, npy_float, value, pi);
+                CASE_GET_STATS_VALUE(NPY_DOUBLE, npy_double, value, pi);
+            default:
+                task->error = 1;
+                return;
+            }
+            count = ++st->counts[bin];
+            if (st->sums) {
+                st->sums[bin] += value;
+            }
+            if (st->means) {
+                /* the running mean and sum of squared deviations: */
+                double delta = value - st->means[bin];
+                st->means[bin] += delta / count;
+                st->m2s[bin] += delta * (value - st->means[bin]);
+            }
+            if (st->minima) {
+                if (count == 1 || value < st->minima[bin]) {
+                    st->minima[bin] = value;
+                }
+                if (count == 1 || value > st->maxima[bin]) {
+                    st->maxima[bin] = value;
+                }
+            }
+            if (st->moments) {
+                for (kk = 0; kk < rank; kk++) {
+                    st->moments[bin * rank + kk] +=
+                                            value * ii.coordinates[kk];
+                }
+            }
+            if (st->bounds) {
+                npy_intp *lower = st->bounds + 2 * rank * bin;
+                for (kk = 0; kk < rank; kk++) {
+                    npy_intp cc = ii.coordinates[kk];
+                    if (count == 1 || cc < lower[kk]) {
+                        lower[kk] = cc;
+                    }
+                    if (count == 1 || cc + 1 > lower[kk + rank]) {
+                        lower[kk + rank] = cc + 1;
+                    }
+                }
+            }
+        }
+        if (task->labels) {
+            NI_ITERATOR_NEXT2(ii, il, pi, pl);
+        } else {
+            NI_ITERATOR_NEXT(ii, pi);
+        }
+    }
+}
+
+/* Add the statistics of src to those of dst: */
+static void _MergeLabelStatistics(NI_LabelStatistics *dst,
+                                  const NI_LabelStatistics *src,
+                                  npy_intp nbins, int rank)
+{
+    npy_intp bin;
+    int kk;
+
+    for (bin = 0; bin < nbins; bin++) {
+        npy_intp n1 = dst->counts[bin], n2 = src->counts[bin], n = n1 + n2;
+
+        if (n2 == 0) {
+            continue;
+        }
+        dst->counts[bin] = n;
+        if (dst->sums) {
+            dst->sums[bin] += src->sums[bin];
+        }
+        if (dst->means) {
+            /* the pairwise update of Chan, Golub and LeVeque: */
+            double delta = src->means[bin] - dst->means[bin];
+            dst->means[bin] += delta * n2 / n;
+            dst->m2s[bin] += src->m2s[bin] + delta * delta * n1 / n * n2;
+        }
+        if (dst->minima) {
+            if (n1 == 0 || src->minima[bin] < dst->minima[bin]) {
+                dst->minima[bin] = src->minima[bin];
+            }
+            if (n1 == 0 || src->maxima[bin] > dst->maxima[bin]) {
+                dst->maxima[bin] = src->maxima[bin];
+            }
+        }
+        if (dst->moments) {
+            for (kk = 0; kk < rank; kk++) {
+                dst->moments[bin * rank + kk] += src->moments[bin * rank + kk];
+            }
+        }
+        if (dst->bounds) {
+            npy_intp *lower = dst->bounds + 2 * rank * bin;
+            const npy_intp *slower = src->bounds + 2 * rank * bin;
+            for (kk = 0; kk < rank; kk++) {
+                if (n1 == 0 || slower[kk] < lower[kk]) {
+                    lower[kk] = slower[kk];
+                }
+                if (n1 == 0 || slower[kk + rank] > lower[kk + rank]) {
+                    lower[kk + rank] = slower[kk + rank];
+                }
+            }
+        }
+    }
+}
+
+/* Allocate zeroed statistics like those of like, or free them: */
+static int _AllocateLabelStatistics(NI_LabelStatistics *st,
+                                    const NI_LabelStatistics *like,
+                                    npy_intp nbins, int rank)
+{
+    st->counts = calloc(nbins, sizeof(npy_intp));
+    st->sums = like->sums ? calloc(nbins, sizeof(double)) : NULL;
+    st->means = like->means ? calloc(nbins, sizeof(double)) : NULL;
+    st->m2s = like->means ? calloc(nbins, sizeof(double)) : NULL;
+    st->minima = like->minima ? calloc(nbins, sizeof(double)) : NULL;
+    st->maxima = like->minima ? calloc(nbins, sizeof(double)) : NULL;
+    st->moments = like->moments ? calloc(nbins * rank, sizeof(double)) : NULL;
+    st->bounds = like->bounds ? calloc(nbins * 2 * rank, sizeof(npy_intp))
+                              : NULL;
+    return st->counts && (st->sums || !like->sums) &&
+           (st->means || !like->means) && (st->m2s || !like->means) &&
+           (st->minima || !like->minima) && (st->maxima || !like->minima) &&
+           (st->moments || !like->moments) && (st->bounds || !like->bounds);
+}
+
+static void _FreeLabelStatistics(NI_LabelStatistics *st)
+{
+    free(st->counts);
+    free(st->sums);
+    free(st->means);
+    free(st->m2s);
+    free(st->minima);
+    free(st->maxima);
+    free(st->moments);
+    free(st->bounds);
+}
+
+/* Measure the elements of input for each label in one pass. The bins of
+     the statistics are the labels in the sorted index, if given, or else
+     the labels from min_label on. Without labels, all the elements are in
+     the first bin. The statistics that are not NULL in stats must hold
+     nbins zeroed values, or nbins * rank of them for the moments, and
+     nbins * 2 * rank for the bounds. The means and m2s come as a pair, and
+     so do the minima and maxima. The elements are divided over up to
+     workers threads, whose statistics are then merged. */
+int NI_LabeledStatistics(PyArrayObject *input, PyArrayObject *labels,
+                         const npy_intp *index, npy_intp min_label,
+                         npy_intp nbins, NI_LabelStatistics *stats,
+                         int workers)
+{
+    NI_LabelStatisticsTask *tasks = NULL;
+    void **args = NULL;
+    npy_intp size = PyArray_SIZE(input);
+    int rank = PyArray_NDIM(input), ntasks = 1, kk;
+    NPY_BEGIN_THREADS_DEF;
+
+    if (workers > 1 && nbins > 0) {
+        npy_intp max_tasks = size / STATS_MIN_WORK_PER_THREAD;
+        /* every thread has statistics for all the bins to merge: */
+        if (max_tasks > size / nbins) {
+            max_tasks = size / nbins;
+        }
+        if (max_tasks < workers) {
+            workers = max_tasks > 1 ? (int)max_tasks : 1;
+        }
+        ntasks = workers;
+    }
+    tasks = calloc(ntasks, sizeof(NI_LabelStatisticsTask));
+    args = malloc(ntasks * sizeof(void *));
+    if (!tasks || !args) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+    for (kk = 0; kk < ntasks; kk++) {
+        NI_LabelStatisticsTask *task = tasks + kk;
+
+        args[kk] = task;
+        task->input = input;
+        task->labels = labels;
+        task->index = index;
+        task->nindex = nbins;
+        task->min_label = min_label;
+        task->nbins = nbins;
+        task->first = size * kk / ntasks;
+        task->last = size * (kk + 1) / ntasks;
+        if (kk == 0) {
+            task->stats = *stats;
+        } else if (!_AllocateLabelStatistics(&task->stats, stats, nbins,
+                                             rank)) {
+            PyErr_NoMemory();
+            goto exit;
+        }
+    }
+
+    NPY_BEGIN_THREADS;
+    NI_RunThreads(ntasks, _LabelStatisticsTask, args);
+    for (kk = 1; kk < ntasks; kk++) {
+        _MergeLabelStatistics(stats, &tasks[kk].stats, nbins, rank);
+    }
+    NPY_END_THREADS;
+
+    for (kk = 0; kk < ntasks; kk++) {
+        if (tasks[kk].error) {
+            PyErr_SetString(PyExc_RuntimeError, "data type not supported");
+            break;
+        }
+    }
+
+ exit:
+    if (tasks) {
+        for (kk = 1; kk < ntasks; kk++) {
+            _FreeLabelStatistics(&tasks[kk].stats);
+        }
+    }
+    free(tasks);
+    free(args);
+    return PyErr_Occurred() ? 0 : 1;
+}
+
 
 #define CASE_GET_INPUT(_TYPE, _type, _ival, _pi) \
 case _TYPE:                                      \
-    _ival = *(_type *)_pi;                     \
+    _ival = *(_type *)_pi;                       \
     break
 
 #define CASE_GET_LABEL(_TYPE, _type, _label, _pm) \
@@ -169,123 +994,365 @@ case _TYPE:                                       \
 
 #define CASE_PUT_LABEL(_TYPE, _type, _label, _pl) \
 case _TYPE:                                       \
-    *(_type *)_pl = _label;                       \
-    break
-
-#define CASE_WINDEX1(_TYPE, _type, _v_index, _p_index, _strides, _istrides, \
-                     _irank, _icont, _p_idx, _v_idx, _pi, _vval, _pval)     \
-case _TYPE:                                                                 \
-    WS_GET_INDEX(_TYPE, _type, _v_index, _strides, _istrides, _irank,       \
-                 _p_idx, _icont);                                           \
-    WS_GET_INDEX(_TYPE, _type, _p_index, _strides, _istrides, _irank,       \
-                 _v_idx, _icont);                                           \
-    _vval = *(_type *)(_pi + _v_idx);                                       \
-    _pval = *(_type *)(_pi + _p_idx);                                       \
+    *(_type *)_pl = (_type)_label;                \
     break
 
-#define CASE_WINDEX2(_TYPE, _type, _v_index, _strides, _ostrides, \
-                     _irank, _idx, _ocont, _label, _pl)           \
-case _TYPE:                                                       \
-    WS_GET_INDEX(_TYPE, _type, _v_index, _strides, _ostrides,     \
-                 _irank, _idx, _ocont);                           \
-    _label = *(_type *)(_pl + _idx);                              \
-    break
+#define WS_MIN_WORK_PER_THREAD 65536
+#define WS_WORDS(_n) (((_n) + 63) / 64)
 
-#define CASE_WINDEX3(_TYPE, _type, _p_index, _strides, _ostrides, \
-                     _irank, _idx, _ocont, _label, _pl)           \
-case _TYPE:                                                       \
-    WS_GET_INDEX(_TYPE, _type, _p_index, _strides, _ostrides,     \
-                 _irank, _idx, _ocont);                           \
-    *(_type *)(_pl + _idx) = _label;                              \
-break
+typedef struct {
+    npy_intp next, prev, label;
+    npy_uint32 cost;
+    npy_uint16 value;
+    npy_uint8 done, queued;
+} NI_WatershedElement;
 
-#define WS_MAXDIM 7
+/* A queue with a bucket for every cost, and two levels of bitmaps
+   marking the buckets that are not empty. The next bucket to flood is
+   found in a few word operations, however sparse the costs are: */
+typedef struct {
+    npy_intp *first, *last;
+    npy_uint64 *occupied, *summary;
+    npy_intp nbuckets, level;
+} NI_WatershedQueue;
 
 typedef struct {
-    npy_intp index;
-    void *next, *prev;
-    npy_uint16 done;
-    npy_uint8 cost;
-} NI_WatershedElement;
+    NI_WatershedElement *elements;
+    NI_WatershedQueue queue;
+    const npy_intp *offsets, *deltas, *dims, *strides;
+    npy_intp nneigh, first, last;
+    int rank, clear_done;
+} NI_WatershedTask;
 
-int NI_WatershedIFT(PyArrayObject* input, PyArrayObject* markers,
-                                        PyArrayObject* strct, PyArrayObject* output)
+static NPY_INLINE int _WatershedLowestBit(npy_uint64 word)
 {
-    char *pl, *pm, *pi;
+#if defined(__GNUC__)
+    return __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+static npy_intp _WatershedQueueSize(npy_intp nbuckets)
+{
+    return 2 * nbuckets * sizeof(npy_intp) +
+           (WS_WORDS(nbuckets) + WS_WORDS(WS_WORDS(nbuckets))) *
+           sizeof(npy_uint64);
+}
+
+static char *_WatershedQueueInit(NI_WatershedQueue *queue,
+                                 npy_intp nbuckets, char *block)
+{
+    npy_intp jj, nwords = WS_WORDS(nbuckets);
+
+    queue->nbuckets = nbuckets;
+    queue->level = 0;
+    queue->first = (npy_intp *)block;
+    queue->last = queue->first + nbuckets;
+    queue->occupied = (npy_uint64 *)(queue->last + nbuckets);
+    queue->summary = queue->occupied + nwords;
+    for (jj = 0; jj < nbuckets; jj++) {
+        queue->first[jj] = queue->last[jj] = -1;
+    }
+    for (jj = 0; jj < nwords + WS_WORDS(nwords); jj++) {
+        queue->occupied[jj] = 0;
+    }
+    return block + _WatershedQueueSize(nbuckets);
+}
+
+static NPY_INLINE void _WatershedPush(NI_WatershedQueue *queue,
+                                      NI_WatershedElement *elements,
+                                      npy_intp index, npy_intp cost,
+                                      int front)
+{
+    NI_WatershedElement *e = elements + index;
+    npy_intp word = cost >> 6;
+
+    if (queue->first[cost] < 0) {
+        e->next = e->prev = -1;
+        queue->first[cost] = queue->last[cost] = index;
+        queue->occupied[word] |= (npy_uint64)1 << (cost & 63);
+        queue->summary[word >> 6] |= (npy_uint64)1 << (word & 63);
+    } else if (front) {
+        e->prev = -1;
+        e->next = queue->first[cost];
+        elements[e->next].prev = index;
+        queue->first[cost] = index;
+    } else {
+        e->next = -1;
+        e->prev = queue->last[cost];
+        elements[e->prev].next = index;
+        queue->last[cost] = index;
+    }
+    e->queued = 1;
+}
+
+static NPY_INLINE void _WatershedRemove(NI_WatershedQueue *queue,
+                                        NI_WatershedElement *elements,
+                                        npy_intp index, npy_intp cost)
+{
+    NI_WatershedElement *e = elements + index;
+
+    if (e->prev >= 0) {
+        elements[e->prev].next = e->next;
+    } else {
+        queue->first[cost] = e->next;
+    }
+    if (e->next >= 0) {
+        elements[e->next].prev = e->prev;
+    } else {
+        queue->last[cost] = e->prev;
+    }
+    if (queue->first[cost] < 0) {
+        npy_intp word = cost >> 6;
+
+        queue->occupied[word] &= ~((npy_uint64)1 << (cost & 63));
+        if (!queue->occupied[word]) {
+            queue->summary[word >> 6] &= ~((npy_uint64)1 << (word & 63));
+        }
+    }
+    e->queued = 0;
+}
+
+/* Remove and return the first element of the lowest bucket, or -1 if
+   the queue is empty. Costs never drop below the last bucket flooded,
+   so the search starts there: */
+static npy_intp _WatershedPop(NI_WatershedQueue *queue,
+                              NI_WatershedElement *elements)
+{
+    npy_intp word = queue->level >> 6, index;
+    npy_uint64 bits = queue->occupied[word] &
+                      (~(npy_uint64)0 << (queue->level & 63));
+
+    if (!bits) {
+        npy_intp nsummary = WS_WORDS(WS_WORDS(queue->nbuckets));
+        npy_intp ss = (word + 1) >> 6;
+        npy_uint64 sbits = 0;
+
+        if (ss < nsummary) {
+            sbits = queue->summary[ss] & (~(npy_uint64)0 << ((word + 1) & 63));
+        }
+        while (!sbits && ++ss < nsummary) {
+            sbits = queue->summary[ss];
+        }
+        if (!sbits) {
+            return -1;
+        }
+        word = ss * 64 + _WatershedLowestBit(sbits);
+        bits = queue->occupied[word];
+    }
+    queue->level = word * 64 + _WatershedLowestBit(bits);
+    index = queue->first[queue->level];
+    _WatershedRemove(queue, elements, index, queue->level);
+    return index;
+}
+
+/* Flood from the queued elements, visiting only neighbors whose first
+   coordinate lies in [first, last): */
+static void _WatershedFlood(NI_WatershedTask *task)
+{
+    NI_WatershedElement *elements = task->elements;
+    npy_intp coordinates[NPY_MAXDIMS], v, hh, index;
     int ll;
-    npy_intp size, jj, hh, kk, maxval;
-    npy_intp strides[WS_MAXDIM], coordinates[WS_MAXDIM];
-    npy_intp *nstrides = NULL, nneigh, ssize;
-    int i_contiguous, o_contiguous;
-    NI_WatershedElement *temp = NULL, **first = NULL, **last = NULL;
-    npy_bool *ps = NULL;
-    NI_Iterator mi, ii, li;
+
+    while ((v = _WatershedPop(&task->queue, elements)) >= 0) {
+        NI_WatershedElement *ev = elements + v;
+        const npy_intp *delta = task->deltas;
+
+        ev->done = 1;
+        index = v;
+        for (ll = 0; ll < task->rank; ll++) {
+            coordinates[ll] = index / task->strides[ll];
+            index -= coordinates[ll] * task->strides[ll];
+        }
+        for (hh = 0; hh < task->nneigh; hh++, delta += task->rank) {
+            NI_WatershedElement *ep;
+            npy_uint32 cost, wvp;
+
+            for (ll = 0; ll < task->rank; ll++) {
+                npy_intp cc = coordinates[ll] + delta[ll];
+                if (cc < (ll ? 0 : task->first) ||
+                        cc >= (ll ? task->dims[ll] : task->last)) {
+                    break;
+                }
+            }
+            if (ll < task->rank) {
+                continue;
+            }
+            index = v + task->offsets[hh];
+            ep = elements + index;
+            if (ep->done) {
+                continue;
+            }
+            wvp = ep->value > ev->value ? ep->value - ev->value
+                                        : ev->value - ep->value;
+            cost = ev->cost > wvp ? ev->cost : wvp;
+            if (cost < ep->cost) {
+                /* background labels lose ties, by queueing at the end: */
+                if (ep->queued) {
+                    _WatershedRemove(&task->queue, elements, index, ep->cost);
+                }
+                ep->cost = cost;
+                ep->label = ev->label;
+                _WatershedPush(&task->queue, elements, index, cost,
+                               ev->label >= 0);
+            }
+        }
+    }
+}
+
+static void _WatershedTask(void *arg)
+{
+    NI_WatershedTask *task = (NI_WatershedTask *)arg;
+    NI_WatershedElement *elements = task->elements;
+    npy_intp stride = task->rank > 0 ? task->strides[0] : 1;
+    npy_intp jj, end = task->last * stride;
+
+    for (jj = task->first * stride; jj < end; jj++) {
+        if (elements[jj].label) {
+            elements[jj].cost = 0;
+            _WatershedPush(&task->queue, elements, jj, 0,
+                           elements[jj].label > 0);
+        } else {
+            elements[jj].cost = (npy_uint32)task->queue.nbuckets;
+        }
+    }
+    _WatershedFlood(task);
+    if (task->clear_done) {
+        for (jj = task->first * stride; jj < end; jj++) {
+            elements[jj].done = 0;
+        }
+    }
+}
+
+int NI_WatershedIFT(PyArrayObject* input, PyArrayObject* markers,
+                    PyArrayObject* strct, PyArrayObject* output, int workers)
+{
+    NI_WatershedTask *tasks = NULL;
+    NI_WatershedElement *elements;
+    NI_Iterator ii, mi, li;
+    void **args = NULL;
+    char *block = NULL, *qblock, *pi, *pm, *pl;
+    npy_bool *ps;
+    npy_intp strides[NPY_MAXDIMS], coordinates[NPY_MAXDIMS];
+    npy_intp *offsets = NULL, *deltas = NULL, nneigh = 0, nbuckets;
+    npy_intp size = PyArray_SIZE(input), ssize = PyArray_SIZE(strct);
+    npy_intp dim0, stride0, jj, kk;
+    int rank = PyArray_NDIM(input), ntasks = 1, tt, ll;
     NPY_BEGIN_THREADS_DEF;
 
-    i_contiguous = PyArray_ISCONTIGUOUS(input);
-    o_contiguous = PyArray_ISCONTIGUOUS(output);
-    ssize = PyArray_SIZE(strct);
-    if (PyArray_NDIM(input) > WS_MAXDIM) {
-        PyErr_SetString(PyExc_RuntimeError, "too many dimensions");
-        goto exit;
+    switch (PyArray_TYPE(input)) {
+    case NPY_UINT8:
+        nbuckets = 256;
+        break;
+    case NPY_UINT16:
+        nbuckets = 65536;
+        break;
+    default:
+        PyErr_SetString(PyExc_RuntimeError, "data type not supported");
+        return 0;
     }
-    size = PyArray_SIZE(input);
-    /* Storage for the temporary queue data. */
-    temp = malloc(size * sizeof(NI_WatershedElement));
-    if (!temp) {
+    if (size == 0) {
+        return 1;
+    }
+    if (rank > 0) {
+        strides[rank - 1] = 1;
+        for (ll = rank - 2; ll >= 0; ll--) {
+            strides[ll] = PyArray_DIM(input, ll + 1) * strides[ll + 1];
+        }
+    }
+    dim0 = rank > 0 ? PyArray_DIM(input, 0) : 1;
+    stride0 = size / dim0;
+
+    /* the offsets and coordinate steps of the neighbors: */
+    offsets = malloc(ssize * sizeof(npy_intp));
+    deltas = malloc((ssize * rank + 1) * sizeof(npy_intp));
+    if (!offsets || !deltas) {
         PyErr_NoMemory();
         goto exit;
     }
+    ps = (npy_bool *)PyArray_DATA(strct);
+    for (ll = 0; ll < rank; ll++) {
+        coordinates[ll] = -1;
+    }
+    for (kk = 0; kk < ssize; kk++) {
+        if (ps[kk] && kk != ssize / 2) {
+            offsets[nneigh] = 0;
+            for (ll = 0; ll < rank; ll++) {
+                offsets[nneigh] += coordinates[ll] * strides[ll];
+                deltas[nneigh * rank + ll] = coordinates[ll];
+            }
+            ++nneigh;
+        }
+        for (ll = rank - 1; ll >= 0; ll--) {
+            if (coordinates[ll] < 1) {
+                coordinates[ll]++;
+                break;
+            } else {
+                coordinates[ll] = -1;
+            }
+        }
+    }
 
-    NPY_BEGIN_THREADS;
-
-    pi = (void *)PyArray_DATA(input);
-    if (!NI_InitPointIterator(input, &ii))
-        goto exit;
-    /* Initialization and find the maximum of the input. */
-    maxval = 0;
-    for(jj = 0; jj < size; jj++) {
-        npy_intp ival = 0;
-        switch (PyArray_TYPE(input)) {
-            CASE_GET_INPUT(NPY_UINT8, npy_uint8, ival, pi);
-            CASE_GET_INPUT(NPY_UINT16, npy_uint16, ival, pi);
-        default:
-            NPY_END_THREADS;
-            PyErr_SetString(PyExc_RuntimeError, "data type not supported");
-            goto exit;
+    if (workers > 1) {
+        npy_intp max_tasks = size / WS_MIN_WORK_PER_THREAD;
+        if (max_tasks > dim0) {
+            max_tasks = dim0;
         }
-        temp[jj].index = jj;
-        temp[jj].done = 0;
-        if (ival > maxval)
-            maxval = ival;
-        NI_ITERATOR_NEXT(ii, pi);
+        if (max_tasks < workers) {
+            workers = max_tasks > 1 ? (int)max_tasks : 1;
+        }
+        ntasks = workers;
     }
-    pi = (void *)PyArray_DATA(input);
-    /* Allocate and initialize the storage for the queue. */
-    first = malloc((maxval + 1) * sizeof(NI_WatershedElement*));
-    last = malloc((maxval + 1) * sizeof(NI_WatershedElement*));
-    if (NPY_UNLIKELY(!first || !last)) {
-        NPY_END_THREADS;
+    /* All the memory is taken here: an element per array element, and a
+       queue of first/last links and bitmaps per thread. */
+    block = malloc(size * sizeof(NI_WatershedElement) +
+                   ntasks * _WatershedQueueSize(nbuckets));
+    tasks = malloc(ntasks * sizeof(NI_WatershedTask));
+    args = malloc(ntasks * sizeof(void *));
+    if (!block || !tasks || !args) {
         PyErr_NoMemory();
         goto exit;
     }
-    for(hh = 0; hh <= maxval; hh++) {
-        first[hh] = NULL;
-        last[hh] = NULL;
+    elements = (NI_WatershedElement *)block;
+    qblock = block + size * sizeof(NI_WatershedElement);
+    for (tt = 0; tt < ntasks; tt++) {
+        NI_WatershedTask *task = tasks + tt;
+
+        args[tt] = task;
+        task->elements = elements;
+        qblock = _WatershedQueueInit(&task->queue, nbuckets, qblock);
+        task->offsets = offsets;
+        task->deltas = deltas;
+        task->dims = PyArray_DIMS(input);
+        task->strides = strides;
+        task->nneigh = nneigh;
+        task->first = dim0 * tt / ntasks;
+        task->last = dim0 * (tt + 1) / ntasks;
+        task->rank = rank;
+        task->clear_done = ntasks > 1;
     }
-    if (!NI_InitPointIterator(markers, &mi))
+    if (!NI_InitPointIterator(input, &ii) ||
+            !NI_InitPointIterator(markers, &mi) ||
+            !NI_InitPointIterator(output, &li)) {
         goto exit;
-    if (!NI_InitPointIterator(output, &li))
-        goto exit;
-    pm = (void *)PyArray_DATA(markers);
-    pl = (void *)PyArray_DATA(output);
-    /* initialize all nodes */
-    for (ll = 0; ll < PyArray_NDIM(input); ll++) {
-        coordinates[ll] = 0;
     }
-    for(jj = 0; jj < size; jj++) {
-        /* get marker */
-        int label = 0;
+
+    NPY_BEGIN_THREADS;
+
+    pi = (void *)PyArray_DATA(input);
+    pm = (void *)PyArray_DATA(markers);
+    for (jj = 0; jj < size; jj++) {
+        npy_intp ival = 0, label = 0;
+        switch (PyArray_TYPE(input)) {
+            CASE_GET_INPUT(NPY_UINT8, npy_uint8, ival, pi);
+            CASE_GET_INPUT(NPY_UINT16, npy_uint16, ival, pi);
+        }
         switch (PyArray_TYPE(markers)) {
             CASE_GET_LABEL(NPY_UBYTE, npy_ubyte, label, pm);
             CASE_GET_LABEL(NPY_USHORT, npy_ushort, label, pm);
@@ -302,6 +1369,46 @@ int NI_WatershedIFT(PyArrayObject* input, PyArrayObject* markers,
             PyErr_SetString(PyExc_RuntimeError, "data type not supported");
             goto exit;
         }
+        elements[jj].next = elements[jj].prev = -1;
+        elements[jj].label = label;
+        elements[jj].value = (npy_uint16)ival;
+        elements[jj].done = elements[jj].queued = 0;
+        NI_ITERATOR_NEXT2(ii, mi, pi, pm);
+    }
+
+    /* Flood the slabs, each from its own markers: */
+    NI_RunThreads(ntasks, _WatershedTask, args);
+    if (ntasks > 1) {
+        /* The slab floods are optimal apart from paths that cross a
+           face between slabs. Flooding the whole array again from the
+           elements on those faces, at their present costs, corrects
+           every element that such a path improves. */
+        NI_WatershedTask *task = tasks;
+
+        for (tt = 0; tt < ntasks; tt++) {
+            npy_intp row = tasks[tt].first;
+
+            while (row < tasks[tt].last) {
+                for (jj = row * stride0; jj < (row + 1) * stride0; jj++) {
+                    if (elements[jj].cost < nbuckets) {
+                        _WatershedPush(&task->queue, elements, jj,
+                                       elements[jj].cost,
+                                       elements[jj].label > 0);
+                    }
+                }
+                row = row < tasks[tt].last - 1 ? tasks[tt].last - 1
+                                               : tasks[tt].last;
+            }
+        }
+        task->first = 0;
+        task->last = dim0;
+        task->queue.level = 0;
+        _WatershedFlood(task);
+    }
+
+    pl = (void *)PyArray_DATA(output);
+    for (jj = 0; jj < size; jj++) {
+        npy_intp label = elements[jj].label;
         switch (PyArray_TYPE(output)) {
             CASE_PUT_LABEL(NPY_UBYTE, npy_ubyte, label, pl);
             CASE_PUT_LABEL(NPY_USHORT, npy_ushort, label, pl);
@@ -318,303 +1425,15 @@ int NI_WatershedIFT(PyArrayObject* input, PyArrayObject* markers,
             PyErr_SetString(PyExc_RuntimeError, "data type not supported");
             goto exit;
         }
-        NI_ITERATOR_NEXT2(mi, li, pm, pl);
-        if (label != 0) {
-            /* This node is a marker */
-            temp[jj].cost = 0;
-            if (!first[0]) {
-                first[0] = &(temp[jj]);
-                first[0]->next = NULL;
-                first[0]->prev = NULL;
-                last[0] = first[0];
-            } else {
-                if (label > 0) {
-                    /* object markers are enqueued at the beginning, so they
-                       are processed first. */
-                    temp[jj].next = first[0];
-                    temp[jj].prev = NULL;
-                    first[0]->prev = &(temp[jj]);
-                    first[0] = &(temp[jj]);
-                } else {
-                    /* background markers are enqueued at the end, so they are
-                         processed after the object markers. */
-                    temp[jj].next = NULL;
-                    temp[jj].prev = last[0];
-                    last[0]->next = &(temp[jj]);
-                    last[0] = &(temp[jj]);
-                }
-            }
-        } else {
-            /* This node is not a marker */
-            temp[jj].cost = maxval + 1;
-            temp[jj].next = NULL;
-            temp[jj].prev = NULL;
-        }
-        for (ll = PyArray_NDIM(input) - 1; ll >= 0; ll--) {
-            if (coordinates[ll] < PyArray_DIMS(input)[ll] - 1) {
-                coordinates[ll]++;
-                break;
-            } else {
-                coordinates[ll] = 0;
-            }
-        }
+        NI_ITERATOR_NEXT(li, pl);
     }
+    NPY_END_THREADS;
 
-    pl = (void *)PyArray_DATA(output);
-    ps = (npy_bool*)PyArray_DATA(strct);
-    nneigh = 0;
-    for (kk = 0; kk < ssize; kk++)
-        if (ps[kk] && kk != (ssize / 2))
-            ++nneigh;
-    nstrides = malloc(nneigh * sizeof(npy_intp));
-    if (NPY_UNLIKELY(!nstrides)) {
-        NPY_END_THREADS;
-        PyErr_NoMemory();
-        goto exit;
-    }
-    strides[PyArray_NDIM(input) - 1] = 1;
-    for (ll = PyArray_NDIM(input) - 2; ll >= 0; ll--) {
-        strides[ll] = PyArray_DIM(input, ll + 1) * strides[ll + 1];
-    }
-    for (ll = 0; ll < PyArray_NDIM(input); ll++) {
-        coordinates[ll] = -1;
-    }
-    for(kk = 0; kk < nneigh; kk++)
-        nstrides[kk] = 0;
-    jj = 0;
-    for(kk = 0; kk < ssize; kk++) {
-        if (ps[kk]) {
-            int offset = 0;
-            for (ll = 0; ll < PyArray_NDIM(input); ll++) {
-                offset += coordinates[ll] * strides[ll];
-            }
-            if (offset != 0)
-                nstrides[jj++] += offset;
-        }
-        for (ll = PyArray_NDIM(input) - 1; ll >= 0; ll--) {
-            if (coordinates[ll] < 1) {
-                coordinates[ll]++;
-                break;
-            } else {
-                coordinates[ll] = -1;
-            }
-        }
-    }
-    /* Propagation phase: */
-    for(jj = 0; jj <= maxval; jj++) {
-        while (first[jj]) {
-            /* dequeue first element: */
-            NI_WatershedElement *v = first[jj];
-            first[jj] = first[jj]->next;
-            if (first[jj])
-                first[jj]->prev = NULL;
-            v->prev = NULL;
-            v->next = NULL;
-            /* Mark element as done: */
-            v->done = 1;
-            /* Iterate over the neighbors of the element: */
-            for(hh = 0; hh < nneigh; hh++) {
-                npy_intp v_index = v->index, p_index = v->index, idx, cc;
-                int qq, outside = 0;
-                p_index += nstrides[hh];
-                /* check if the neighbor is within the extent of the array: */
-                idx = p_index;
-                for (qq = 0; qq < PyArray_NDIM(input); qq++) {
-                    cc = idx / strides[qq];
-                    if (cc < 0 || cc >= PyArray_DIM(input, qq)) {
-                        outside = 1;
-                        break;
-                    }
-                    idx -= cc * strides[qq];
-                }
-                if (!outside) {
-                    NI_WatershedElement *p = &(temp[p_index]);
-                    if (!(p->done)) {
-                        /* If the neighbor was not processed yet: */
-                        int max, pval, vval, wvp, pcost, label, p_idx, v_idx;
-                        switch (PyArray_TYPE(input)) {
-                            CASE_WINDEX1(NPY_UBYTE, npy_ubyte,
-                                v_index, p_index, strides,
-                                PyArray_STRIDES(input), PyArray_NDIM(input),
-                                i_contiguous, p_idx, v_idx, pi, vval, pval);
-                            CASE_WINDEX1(NPY_USHORT, npy_ushort,
-                                v_index, p_index, strides,
-                                PyArray_STRIDES(input), PyArray_NDIM(input),
-                                i_contiguous, p_idx, v_idx, pi, vval, pval);
-                        default:
-                            NPY_END_THREADS;
-                            PyErr_SetString(PyExc_RuntimeError,
-                                            "data type not supported");
-                            goto exit;
-                        }
-                        /* Calculate cost: */
-                        wvp = pval - vval;
-                        if (wvp < 0)
-                            wvp = -wvp;
-                        /* Find the maximum of this cost and the current
-                             element cost: */
-                        pcost = p->cost;
-                        max = v->cost > wvp ? v->cost : wvp;
-                        if (max < pcost) {
-                            /* If this maximum is less than the neighbors cost,
-                                 adapt the cost and the label of the neighbor: */
-                            int idx;
-                            p->cost = max;
-                            switch (PyArray_TYPE(output)) {
-                                CASE_WINDEX2(NPY_UBYTE, npy_ubyte,
-                                             v_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                                CASE_WINDEX2(NPY_USHORT, npy_ushort,
-                                             v_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                                CASE_WINDEX2(NPY_UINT, npy_uint,
-                                             v_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                                CASE_WINDEX2(NPY_ULONG, npy_ulong,
-                                             v_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                                CASE_WINDEX2(NPY_ULONGLONG, npy_ulonglong,
-                                             v_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                                CASE_WINDEX2(NPY_BYTE, npy_byte,
-                                             v_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                                CASE_WINDEX2(NPY_SHORT, npy_short,
-                                             v_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                                CASE_WINDEX2(NPY_INT, npy_int,
-                                             v_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                                CASE_WINDEX2(NPY_LONG, npy_long,
-                                             v_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                                CASE_WINDEX2(NPY_LONGLONG, npy_longlong,
-                                             v_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                            default:
-                                NPY_END_THREADS;
-                                PyErr_SetString(PyExc_RuntimeError,
-                                                "data type not supported");
-                                goto exit;
-                            }
-                            switch (PyArray_TYPE(output)) {
-                                CASE_WINDEX3(NPY_UBYTE, npy_ubyte,
-                                             p_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                                CASE_WINDEX3(NPY_USHORT, npy_ushort,
-                                             p_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                                CASE_WINDEX3(NPY_UINT, npy_uint,
-                                             p_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                                CASE_WINDEX3(NPY_ULONG, npy_ulong,
-                                             p_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                                CASE_WINDEX3(NPY_ULONGLONG, npy_ulonglong,
-                                             p_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                                CASE_WINDEX3(NPY_BYTE, npy_byte,
-                                             p_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                                CASE_WINDEX3(NPY_SHORT, npy_short,
-                                             p_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                                CASE_WINDEX3(NPY_INT, npy_int,
-                                             p_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                                CASE_WINDEX3(NPY_LONG, npy_long,
-                                             p_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                                CASE_WINDEX3(NPY_LONGLONG, npy_longlong,
-                                             p_index, strides,
-                                             PyArray_STRIDES(output),
-                                             PyArray_NDIM(input),
-                                             idx, o_contiguous, label, pl);
-                            default:
-                                NPY_END_THREADS;
-                                PyErr_SetString(PyExc_RuntimeError,
-                                                "data type not supported");
-                                goto exit;
-                            }
-                            /* If the neighbor is in a queue, remove it: */
-                            if (p->next || p->prev) {
-                                NI_WatershedElement *prev = p->prev, *next = p->next;
-                                if (first[pcost] == p)
-                                    first[pcost] = next;
-                                if (last[pcost] == p)
-                                    last[pcost] = prev;
-                                if (prev)
-                                    prev->next = next;
-                                if (next)
-                                    next->prev = prev;
-                            }
-                            /* Insert the neighbor in the appropriate queue: */
-                            if (label < 0) {
-                                p->prev = last[max];
-                                p->next = NULL;
-                                if (last[max])
-                                    last[max]->next = p;
-                                last[max] = p;
-                                if (!first[max])
-                                    first[max] = p;
-                            } else {
-                                p->next = first[max];
-                                p->prev = NULL;
-                                if (first[max])
-                                    first[max]->prev = p;
-                                first[max] = p;
-                                if (!last[max])
-                                    last[max] = p;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
  exit:
-    NPY_END_THREADS;
-    free(temp);
-    free(first);
-    free(last);
-    free(nstrides);
+    free(block);
+    free(tasks);
+    free(args);
+    free(offsets);
+    free(deltas);
     return PyErr_Occurred() ? 0 : 1;
 }
@@ -34,7 +34,20 @@
 
 int NI_FindObjects(PyArrayObject*, npy_intp, npy_intp*);
 
+int NI_Label(PyArrayObject*, PyArrayObject*, PyArrayObject*, int,
+             npy_intp*);
+
+/* Per label statistics of NI_LabeledStatistics, NULL if not wanted: */
+typedef struct {
+    npy_intp *counts;
+    double *sums, *means, *m2s, *minima, *maxima, *moments;
+    npy_intp *bounds;
+} NI_LabelStatistics;
+
+int NI_LabeledStatistics(PyArrayObject*, PyArrayObject*, const npy_intp*,
+                         npy_intp, npy_intp, NI_LabelStatistics*, int);
+
 int NI_WatershedIFT(PyArrayObject*, PyArrayObject*, PyArrayObject*,
-                    PyArrayObject*);
+                    PyArrayObject*, int);
 
 #endif
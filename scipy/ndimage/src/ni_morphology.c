@@ -31,6 +31,7 @@
 
 #include "ni_support.h"
 #include "ni_morphology.h"
+#include "ni_threads.h"
 #include <stdlib.h>
 #include <math.h>
 #include <limits.h>
@@ -569,6 +570,495 @@ int NI_BinaryErosion2(PyArrayObject* array, PyArrayObject* strct,
 }
 
 
+#define PACKED_MIN_WORK_PER_THREAD 16384
+
+#define CASE_PACK_BITS(_TYPE, _type, _pi, _stride, _length, _bits, _invert) \
+case _TYPE:                                                                 \
+{                                                                           \
+    npy_intp _ii;                                                           \
+    for (_ii = 0; _ii < _length; _ii++) {                                   \
+        if ((*(_type *)(_pi + _ii * _stride) != 0) != _invert) {            \
+            _bits[_ii >> 6] |= (npy_uint64)1 << (_ii & 63);                 \
+        }                                                                   \
+    }                                                                       \
+}                                                                           \
+break
+
+#define CASE_UNPACK_BITS(_TYPE, _type, _po, _stride, _length, _bits,       \
+                         _invert)                                          \
+case _TYPE:                                                                \
+{                                                                          \
+    npy_intp _ii;                                                          \
+    for (_ii = 0; _ii < _length; _ii++) {                                  \
+        int _bit = (int)((_bits[_ii >> 6] >> (_ii & 63)) & 1);             \
+        *(_type *)(_po + _ii * _stride) = (_type)(_bit != _invert);        \
+    }                                                                      \
+}                                                                          \
+break
+
+/* The array is packed 64 elements to a word along its longest axis, the
+   packed axis. The other axes index the rows, each stored with `pad`
+   words of border bits on both sides, so that any shift along the
+   packed axis by the structuring element can be read without tests. */
+typedef struct {
+    int row_rank, invert;
+    npy_uint64 fill, tail;
+    npy_intp length, nwords, pad, row_size, nelements, nrows;
+    npy_intp row_dims[NPY_MAXDIMS], row_strides[NPY_MAXDIMS];
+    npy_intp istrides[NPY_MAXDIMS], ostrides[NPY_MAXDIMS];
+    npy_intp mstrides[NPY_MAXDIMS];
+    npy_intp istride, ostride, mstride;
+    /* per structuring element: the shift along the packed axis, the
+       offset in rows, and the steps along the row axes: */
+    npy_intp *shifts, *row_offsets, *deltas;
+} NI_PackedLayout;
+
+typedef struct {
+    const NI_PackedLayout *layout;
+    PyArrayObject *input, *mask, *output;
+    npy_uint64 *src, *dst, *mask_bits;
+    const npy_uint64 *border;
+    npy_intp first, last;
+    int phase, changed, error;
+} NI_PackedErosionTask;
+
+static void _PackedRowCoordinates(const NI_PackedLayout *layout,
+                                  npy_intp row, npy_intp *coordinates)
+{
+    int kk;
+
+    for (kk = 0; kk < layout->row_rank; kk++) {
+        coordinates[kk] = row / layout->row_strides[kk];
+        row -= coordinates[kk] * layout->row_strides[kk];
+    }
+}
+
+static int _PackRow(NI_PackedErosionTask *task, npy_intp row,
+                    const npy_intp *coordinates)
+{
+    const NI_PackedLayout *layout = task->layout;
+    npy_uint64 *src = task->src + row * layout->row_size;
+    npy_uint64 *dst = task->dst + row * layout->row_size;
+    npy_uint64 *bits = src + layout->pad;
+    char *pi = PyArray_BYTES(task->input);
+    npy_intp jj, stride = layout->istride, length = layout->length;
+    int kk, invert = layout->invert;
+
+    for (jj = 0; jj < layout->row_size; jj++) {
+        src[jj] = dst[jj] = layout->fill;
+    }
+    for (jj = 0; jj < layout->nwords; jj++) {
+        bits[jj] = 0;
+    }
+    for (kk = 0; kk < layout->row_rank; kk++) {
+        pi += coordinates[kk] * layout->istrides[kk];
+    }
+    switch (PyArray_TYPE(task->input)) {
+        CASE_PACK_BITS(NPY_BOOL, npy_bool, pi, stride, length, bits, invert);
+        CASE_PACK_BITS(NPY_UBYTE, npy_ubyte, pi, stride, length, bits,
+                       invert);
+        CASE_PACK_BITS(NPY_USHORT, npy_ushort, pi, stride, length, bits,
+                       invert);
+        CASE_PACK_BITS(NPY_UINT, npy_uint, pi, stride, length, bits, invert);
+        CASE_PACK_BITS(NPY_ULONG, npy_ulong, pi, stride, length, bits,
+                       invert);
+        CASE_PACK_BITS(NPY_ULONGLONG, npy_ulonglong, pi, stride, length,
+                       bits, invert);
+        CASE_PACK_BITS(NPY_BYTE, npy_byte, pi, stride, length, bits, invert);
+        CASE_PACK_BITS(NPY_SHORT, npy_short, pi, stride, length, bits,
+                       invert);
+        CASE_PACK_BITS(NPY_INT, npy_int, pi, stride, length, bits, invert);
+        CASE_PACK_BITS(NPY_LONG, npy_long, pi, stride, length, bits, invert);
+        CASE_PACK_BITS(NPY_LONGLONG, npy_longlong, pi, stride, length, bits,
+                       invert);
+        CASE_PACK_BITS(NPY_FLOAT, npy_float, pi, stride, length, bits,
+                       invert);
+        CASE_PACK_BITS(NPY_DOUBLE, npy_double, pi, stride, length, bits,
+                       invert);
+    default:
+        return 0;
+    }
+    bits[layout->nwords - 1] |= layout->fill & ~layout->tail;
+
+    if (task->mask_bits) {
+        char *pm = PyArray_BYTES(task->mask);
+
+        bits = task->mask_bits + row * layout->row_size + layout->pad;
+        stride = layout->mstride;
+        for (jj = 0; jj < layout->nwords; jj++) {
+            bits[jj] = 0;
+        }
+        for (kk = 0; kk < layout->row_rank; kk++) {
+            pm += coordinates[kk] * layout->mstrides[kk];
+        }
+        switch (PyArray_TYPE(task->mask)) {
+            CASE_PACK_BITS(NPY_BOOL, npy_bool, pm, stride, length, bits, 0);
+            CASE_PACK_BITS(NPY_UBYTE, npy_ubyte, pm, stride, length, bits,
+                           0);
+            CASE_PACK_BITS(NPY_USHORT, npy_ushort, pm, stride, length, bits,
+                           0);
+            CASE_PACK_BITS(NPY_UINT, npy_uint, pm, stride, length, bits, 0);
+            CASE_PACK_BITS(NPY_ULONG, npy_ulong, pm, stride, length, bits,
+                           0);
+            CASE_PACK_BITS(NPY_ULONGLONG, npy_ulonglong, pm, stride, length,
+                           bits, 0);
+            CASE_PACK_BITS(NPY_BYTE, npy_byte, pm, stride, length, bits, 0);
+            CASE_PACK_BITS(NPY_SHORT, npy_short, pm, stride, length, bits,
+                           0);
+            CASE_PACK_BITS(NPY_INT, npy_int, pm, stride, length, bits, 0);
+            CASE_PACK_BITS(NPY_LONG, npy_long, pm, stride, length, bits, 0);
+            CASE_PACK_BITS(NPY_LONGLONG, npy_longlong, pm, stride, length,
+                           bits, 0);
+            CASE_PACK_BITS(NPY_FLOAT, npy_float, pm, stride, length, bits,
+                           0);
+            CASE_PACK_BITS(NPY_DOUBLE, npy_double, pm, stride, length, bits,
+                           0);
+        default:
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int _UnpackRow(NI_PackedErosionTask *task, npy_intp row,
+                      const npy_intp *coordinates)
+{
+    const NI_PackedLayout *layout = task->layout;
+    const npy_uint64 *bits = task->src + row * layout->row_size + layout->pad;
+    char *po = PyArray_BYTES(task->output);
+    npy_intp stride = layout->ostride, length = layout->length;
+    int kk, invert = layout->invert;
+
+    for (kk = 0; kk < layout->row_rank; kk++) {
+        po += coordinates[kk] * layout->ostrides[kk];
+    }
+    switch (PyArray_TYPE(task->output)) {
+        CASE_UNPACK_BITS(NPY_BOOL, npy_bool, po, stride, length, bits,
+                         invert);
+        CASE_UNPACK_BITS(NPY_UBYTE, npy_ubyte, po, stride, length, bits,
+                         invert);
+        CASE_UNPACK_BITS(NPY_USHORT, npy_ushort, po, stride, length, bits,
+                         invert);
+        CASE_UNPACK_BITS(NPY_UINT, npy_uint, po, stride, length, bits,
+                         invert);
+        CASE_UNPACK_BITS(NPY_ULONG, npy_ulong, po, stride, length, bits,
+                         invert);
+        CASE_UNPACK_BITS(NPY_ULONGLONG, npy_ulonglong, po, stride, length,
+                         bits, invert);
+        CASE_UNPACK_BITS(NPY_BYTE, npy_byte, po, stride, length, bits,
+                         invert);
+        CASE_UNPACK_BITS(NPY_SHORT, npy_short, po, stride, length, bits,
+                         invert);
+        CASE_UNPACK_BITS(NPY_INT, npy_int, po, stride, length, bits, invert);
+        CASE_UNPACK_BITS(NPY_LONG, npy_long, po, stride, length, bits,
+                         invert);
+        CASE_UNPACK_BITS(NPY_LONGLONG, npy_longlong, po, stride, length,
+                         bits, invert);
+        CASE_UNPACK_BITS(NPY_FLOAT, npy_float, po, stride, length, bits,
+                         invert);
+        CASE_UNPACK_BITS(NPY_DOUBLE, npy_double, po, stride, length, bits,
+                         invert);
+    default:
+        return 0;
+    }
+    return 1;
+}
+
+/* Erode a row of src into dst: the AND over the structuring element of
+   the rows it touches, each shifted along the packed axis. Returns
+   whether the row changed. */
+static int _ErodePackedRow(NI_PackedErosionTask *task, npy_intp row,
+                           const npy_intp *coordinates)
+{
+    const NI_PackedLayout *layout = task->layout;
+    const npy_uint64 *cur = task->src + row * layout->row_size + layout->pad;
+    npy_uint64 *out = task->dst + row * layout->row_size + layout->pad;
+    const npy_intp *delta = layout->deltas;
+    npy_intp ee, jj, nwords = layout->nwords;
+    int kk, changed = 0;
+
+    for (jj = 0; jj < nwords; jj++) {
+        out[jj] = ~(npy_uint64)0;
+    }
+    for (ee = 0; ee < layout->nelements; ee++, delta += layout->row_rank) {
+        const npy_uint64 *pr = task->border;
+        npy_intp shift = layout->shifts[ee], qq, rr;
+
+        for (kk = 0; kk < layout->row_rank; kk++) {
+            npy_intp cc = coordinates[kk] + delta[kk];
+            if (cc < 0 || cc >= layout->row_dims[kk]) {
+                break;
+            }
+        }
+        if (kk == layout->row_rank) {
+            pr = task->src + (row + layout->row_offsets[ee]) *
+                             layout->row_size;
+        }
+        /* split the shift into words and bits, rounding down: */
+        qq = shift >= 0 ? shift / 64 : -((63 - shift) / 64);
+        rr = shift - 64 * qq;
+        pr += layout->pad + qq;
+        if (rr == 0) {
+            for (jj = 0; jj < nwords; jj++) {
+                out[jj] &= pr[jj];
+            }
+        } else {
+            for (jj = 0; jj < nwords; jj++) {
+                out[jj] &= (pr[jj] >> rr) | (pr[jj + 1] << (64 - rr));
+            }
+        }
+    }
+    out[nwords - 1] = (out[nwords - 1] & layout->tail) |
+                      (layout->fill & ~layout->tail);
+    if (task->mask_bits) {
+        const npy_uint64 *pm = task->mask_bits + row * layout->row_size +
+                               layout->pad;
+        for (jj = 0; jj < nwords; jj++) {
+            out[jj] = (out[jj] & pm[jj]) | (cur[jj] & ~pm[jj]);
+        }
+    }
+    for (jj = 0; jj < nwords; jj++) {
+        if (out[jj] != cur[jj]) {
+            changed = 1;
+            break;
+        }
+    }
+    return changed;
+}
+
+static void _PackedErosionTask(void *arg)
+{
+    NI_PackedErosionTask *task = (NI_PackedErosionTask *)arg;
+    npy_intp coordinates[NPY_MAXDIMS], row;
+
+    task->changed = 0;
+    for (row = task->first; row < task->last; row++) {
+        _PackedRowCoordinates(task->layout, row, coordinates);
+        switch (task->phase) {
+        case 0:
+            if (!_PackRow(task, row, coordinates)) {
+                task->error = 1;
+                return;
+            }
+            break;
+        case 1:
+            task->changed |= _ErodePackedRow(task, row, coordinates);
+            break;
+        default:
+            if (!_UnpackRow(task, row, coordinates)) {
+                task->error = 1;
+                return;
+            }
+            break;
+        }
+    }
+}
+
+int NI_BinaryErosionPacked(PyArrayObject* input, PyArrayObject* strct,
+                           PyArrayObject* mask, PyArrayObject* output,
+                           int bdr_value, npy_intp *origins, int invert,
+                           int iterations, int workers, int *changed)
+{
+    NI_PackedLayout layout;
+    NI_PackedErosionTask *tasks = NULL;
+    void **args = NULL;
+    npy_uint64 *buffer = NULL, *border, *tmp;
+    npy_intp coordinates[NPY_MAXDIMS], ssize = PyArray_SIZE(strct);
+    npy_intp nbuffer, jj, kk, iteration = 0;
+    npy_bool *ps = (npy_bool *)PyArray_DATA(strct);
+    int rank = PyArray_NDIM(input), axis = 0, ntasks = 1, tt, ll, ii;
+    NPY_BEGIN_THREADS_DEF;
+
+    *changed = 0;
+    if (rank < 1) {
+        PyErr_SetString(PyExc_RuntimeError, "input must have at least "
+                        "one dimension");
+        return 0;
+    }
+    if (PyArray_SIZE(input) == 0) {
+        return 1;
+    }
+    layout.shifts = layout.row_offsets = layout.deltas = NULL;
+    for (ll = 1; ll < rank; ll++) {
+        if (PyArray_DIM(input, ll) > PyArray_DIM(input, axis)) {
+            axis = ll;
+        }
+    }
+    layout.invert = invert;
+    layout.fill = (invert ? !bdr_value : !!bdr_value) ? ~(npy_uint64)0 : 0;
+    layout.length = PyArray_DIM(input, axis);
+    layout.nwords = (layout.length + 63) / 64;
+    layout.tail = layout.length % 64 ?
+                  ((npy_uint64)1 << (layout.length % 64)) - 1 : ~(npy_uint64)0;
+    layout.istride = PyArray_STRIDE(input, axis);
+    layout.ostride = PyArray_STRIDE(output, axis);
+    layout.mstride = mask ? PyArray_STRIDE(mask, axis) : 0;
+    layout.row_rank = rank - 1;
+    for (ll = 0, kk = 0; ll < rank; ll++) {
+        if (ll != axis) {
+            layout.row_dims[kk] = PyArray_DIM(input, ll);
+            layout.istrides[kk] = PyArray_STRIDE(input, ll);
+            layout.ostrides[kk] = PyArray_STRIDE(output, ll);
+            layout.mstrides[kk] = mask ? PyArray_STRIDE(mask, ll) : 0;
+            ++kk;
+        }
+    }
+    layout.nrows = 1;
+    for (kk = layout.row_rank - 1; kk >= 0; kk--) {
+        layout.row_strides[kk] = layout.nrows;
+        layout.nrows *= layout.row_dims[kk];
+    }
+
+    /* the steps of the structuring element, relative to its origin: */
+    layout.nelements = 0;
+    for (jj = 0; jj < ssize; jj++) {
+        layout.nelements += ps[jj] != 0;
+    }
+    layout.shifts = malloc((layout.nelements + 1) * sizeof(npy_intp));
+    layout.row_offsets = malloc((layout.nelements + 1) * sizeof(npy_intp));
+    layout.deltas = malloc((layout.nelements * layout.row_rank + 1) *
+                           sizeof(npy_intp));
+    if (!layout.shifts || !layout.row_offsets || !layout.deltas) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+    layout.pad = 1;
+    for (ll = 0; ll < rank; ll++) {
+        coordinates[ll] = 0;
+    }
+    for (jj = 0, ii = 0; jj < ssize; jj++) {
+        if (ps[jj]) {
+            npy_intp *delta = layout.deltas + ii * layout.row_rank, qq;
+
+            layout.row_offsets[ii] = 0;
+            for (ll = 0, kk = 0; ll < rank; ll++) {
+                npy_intp step = coordinates[ll] - PyArray_DIM(strct, ll) / 2 -
+                                origins[ll];
+                if (ll == axis) {
+                    layout.shifts[ii] = step;
+                } else {
+                    delta[kk] = step;
+                    layout.row_offsets[ii] += step * layout.row_strides[kk];
+                    ++kk;
+                }
+            }
+            qq = layout.shifts[ii] >= 0 ? layout.shifts[ii] / 64
+                                        : -((63 - layout.shifts[ii]) / 64);
+            if (-qq > layout.pad) {
+                layout.pad = -qq;
+            }
+            if (qq + 1 > layout.pad) {
+                layout.pad = qq + 1;
+            }
+            ++ii;
+        }
+        for (ll = rank - 1; ll >= 0; ll--) {
+            if (coordinates[ll] < PyArray_DIM(strct, ll) - 1) {
+                coordinates[ll]++;
+                break;
+            }
+            coordinates[ll] = 0;
+        }
+    }
+    layout.row_size = layout.nwords + 2 * layout.pad;
+
+    if (workers > 1) {
+        npy_intp max_tasks = layout.nrows * layout.nwords *
+                             (layout.nelements + 1) /
+                             PACKED_MIN_WORK_PER_THREAD;
+        if (max_tasks > layout.nrows) {
+            max_tasks = layout.nrows;
+        }
+        if (max_tasks < workers) {
+            workers = max_tasks > 1 ? (int)max_tasks : 1;
+        }
+        ntasks = workers;
+    }
+    /* source, destination and mask rows, and a row of border bits: */
+    nbuffer = (mask ? 3 : 2) * layout.nrows * layout.row_size +
+              layout.row_size;
+    buffer = malloc(nbuffer * sizeof(npy_uint64));
+    tasks = malloc(ntasks * sizeof(NI_PackedErosionTask));
+    args = malloc(ntasks * sizeof(void *));
+    if (!buffer || !tasks || !args) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+    border = buffer + nbuffer - layout.row_size;
+    for (jj = 0; jj < layout.row_size; jj++) {
+        border[jj] = layout.fill;
+    }
+    for (tt = 0; tt < ntasks; tt++) {
+        NI_PackedErosionTask *task = tasks + tt;
+
+        args[tt] = task;
+        task->layout = &layout;
+        task->input = input;
+        task->mask = mask;
+        task->output = output;
+        task->src = buffer;
+        task->dst = buffer + layout.nrows * layout.row_size;
+        task->mask_bits = mask ? buffer + 2 * layout.nrows * layout.row_size
+                               : NULL;
+        task->border = border;
+        task->first = layout.nrows * tt / ntasks;
+        task->last = layout.nrows * (tt + 1) / ntasks;
+        task->phase = 0;
+        task->changed = task->error = 0;
+    }
+
+    NPY_BEGIN_THREADS;
+
+    NI_RunThreads(ntasks, _PackedErosionTask, args);
+    for (tt = 0; tt < ntasks; tt++) {
+        if (tasks[tt].error) {
+            break;
+        }
+    }
+    if (tt == ntasks) {
+        int iteration_changed;
+
+        do {
+            iteration_changed = 0;
+            for (tt = 0; tt < ntasks; tt++) {
+                tasks[tt].phase = 1;
+            }
+            NI_RunThreads(ntasks, _PackedErosionTask, args);
+            for (tt = 0; tt < ntasks; tt++) {
+                iteration_changed |= tasks[tt].changed;
+                tmp = tasks[tt].src;
+                tasks[tt].src = tasks[tt].dst;
+                tasks[tt].dst = tmp;
+            }
+            *changed |= iteration_changed;
+            ++iteration;
+        } while (iterations < 1 ? iteration_changed : iteration < iterations);
+        for (tt = 0; tt < ntasks; tt++) {
+            tasks[tt].phase = 2;
+        }
+        NI_RunThreads(ntasks, _PackedErosionTask, args);
+    }
+
+    NPY_END_THREADS;
+
+    for (tt = 0; tt < ntasks; tt++) {
+        if (tasks[tt].error) {
+            PyErr_SetString(PyExc_RuntimeError, "data type not supported");
+            break;
+        }
+    }
+
+ exit:
+    free(layout.shifts);
+    free(layout.row_offsets);
+    free(layout.deltas);
+    free(buffer);
+    free(tasks);
+    free(args);
+    return PyErr_Occurred() ? 0 : 1;
+}
+
+
 #define NI_DISTANCE_EUCLIDIAN  1
 #define NI_DISTANCE_CITY_BLOCK 2
 #define NI_DISTANCE_CHESSBOARD 3
@@ -936,114 +1426,250 @@ static void _VoronoiFT(char *pf, npy_intp len, npy_intp *coor, int rank,
 }
 
 
-/* Recursive feature transform */
-static void _ComputeFT(char *pi, char *pf, npy_intp *ishape,
-                       const npy_intp *istrides, const npy_intp *fstrides,
-                       int rank, int d, npy_intp *coor, npy_intp **f,
-                       npy_intp *g, PyArrayObject *features,
-                       const npy_double *sampling)
+#define EDT_MIN_WORK_PER_THREAD 65536
+
+/* The lines along one axis of the feature transform, of one thread: */
+typedef struct {
+    char *pi, *pf;
+    const npy_intp *ishape, *istrides, *fstrides;
+    const npy_double *sampling;
+    npy_intp **f, *g;
+    npy_intp first, last;
+    int rank, axis;
+} NI_FeatureTransformTask;
+
+/* The feature transform along axis d only depends on the transform of the
+     lower axes of the same line, so the recursion of the algorithm is done
+     as one pass over all the lines of each axis in turn: */
+static void _FeatureTransformTask(void *arg)
 {
-    npy_intp kk;
-    npy_intp jj;
+    NI_FeatureTransformTask *task = (NI_FeatureTransformTask *)arg;
+    const npy_intp *ishape = task->ishape, *fstrides = task->fstrides;
+    npy_intp coor[NPY_MAXDIMS], line, index, jj, kk;
+    int rank = task->rank, d = task->axis;
+
+    for(line = task->first; line < task->last; line++) {
+        char *pf = task->pf, *pi = task->pi;
 
-    if (d == 0) {
-        char *tf1 = pf;
-        for(jj = 0; jj < ishape[0]; jj++) {
-            if (*(npy_int8*)pi) {
-                *(npy_int32*)tf1 = -1;
+        /* the coordinates of the line, from its index: */
+        index = line;
+        for(kk = rank - 1; kk >= 0; kk--) {
+            if (kk == d) {
+                coor[kk] = 0;
             } else {
-                char *tf2 = tf1;
-                *(npy_int32*)tf2 = jj;
-                for(kk = 1; kk < rank; kk++) {
-                    tf2 += fstrides[0];
-                    *(npy_int32*)tf2 = coor[kk];
-                }
+                coor[kk] = index % ishape[kk];
+                index /= ishape[kk];
+                pf += coor[kk] * fstrides[kk + 1];
+                pi += coor[kk] * task->istrides[kk];
             }
-            pi += istrides[0];
-            tf1 += fstrides[1];
-        }
-        _VoronoiFT(pf, ishape[0], coor, rank, 0, fstrides[1], fstrides[0], f,
-                             g, sampling);
-    } else {
-        npy_uint32 axes = 0;
-        char *tf = pf;
-        npy_intp size = 1;
-        NI_Iterator ii;
-
-        for(jj = 0; jj < ishape[d]; jj++) {
-            coor[d] = jj;
-            _ComputeFT(pi, tf, ishape, istrides, fstrides, rank, d - 1, coor, f,
-                                 g, features, sampling);
-            pi += istrides[d];
-            tf += fstrides[d + 1];
         }
-
-        for(jj = 0; jj < d; jj++) {
-            axes |= (npy_uint32)1 << (jj + 1);
-            size *= ishape[jj];
-        }
-        NI_InitPointIterator(features, &ii);
-        NI_SubspaceIterator(&ii, axes);
-        tf = pf;
-        for(jj = 0; jj < size; jj++) {
-            for(kk = 0; kk < d; kk++)
-                coor[kk] = ii.coordinates[kk];
-            _VoronoiFT(tf, ishape[d], coor, rank, d, fstrides[d + 1],
-                                 fstrides[0], f, g, sampling);
-            NI_ITERATOR_NEXT(ii, tf);
+        if (d == 0) {
+            char *tf1 = pf;
+            for(jj = 0; jj < ishape[0]; jj++) {
+                if (*(npy_int8*)pi) {
+                    *(npy_int32*)tf1 = -1;
+                } else {
+                    char *tf2 = tf1;
+                    *(npy_int32*)tf2 = jj;
+                    for(kk = 1; kk < rank; kk++) {
+                        tf2 += fstrides[0];
+                        *(npy_int32*)tf2 = coor[kk];
+                    }
+                }
+                pi += task->istrides[0];
+                tf1 += fstrides[1];
+            }
         }
-        for(kk = 0; kk < d; kk++)
-            coor[kk] = 0;
+        _VoronoiFT(pf, ishape[d], coor, rank, d, fstrides[d + 1],
+                   fstrides[0], task->f, task->g, task->sampling);
     }
 }
 
 /* Exact euclidean feature transform, as described in: C. R. Maurer,
      Jr., R. Qi, V. Raghavan, "A linear time algorithm for computing
      exact euclidean distance transforms of binary images in arbitrary
-     dimensions. IEEE Trans. PAMI 25, 265-270, 2003. */
+     dimensions. IEEE Trans. PAMI 25, 265-270, 2003. The lines of each
+     axis are divided over up to workers threads. */
 int NI_EuclideanFeatureTransform(PyArrayObject* input,
-                                                                 PyArrayObject *sampling_arr,
-                                                                 PyArrayObject* features)
+                                 PyArrayObject *sampling_arr,
+                                 PyArrayObject* features, int workers)
 {
-    int ii;
-    npy_intp coor[NPY_MAXDIMS], mx = 0, jj;
-    npy_intp *tmp = NULL, **f = NULL, *g = NULL;
-    char *pi, *pf;
+    int ii, kk, ntasks = 1, rank = PyArray_NDIM(input);
+    npy_intp mx = 0, jj, size = PyArray_SIZE(input);
+    NI_FeatureTransformTask *tasks = NULL;
+    void **args = NULL;
     npy_double *sampling = sampling_arr ? ((void *)PyArray_DATA(sampling_arr)) : NULL;
     NPY_BEGIN_THREADS_DEF;
 
-    pi = (void *)PyArray_DATA(input);
-    pf = (void *)PyArray_DATA(features);
-    for (ii = 0; ii < PyArray_NDIM(input); ii++) {
-        coor[ii] = 0;
+    for (ii = 0; ii < rank; ii++) {
         if (PyArray_DIMS(input)[ii] > mx) {
             mx = PyArray_DIM(input, ii);
         }
     }
+    if (size == 0) {
+        return 1;
+    }
+    if (workers > 1) {
+        npy_intp max_tasks = size / EDT_MIN_WORK_PER_THREAD;
+        if (max_tasks < workers) {
+            workers = max_tasks > 1 ? (int)max_tasks : 1;
+        }
+        ntasks = workers;
+    }
 
-    /* Some temporaries */
-    f = malloc(mx * sizeof(npy_intp*));
-    g = malloc(mx * sizeof(npy_intp));
-    tmp = malloc(mx * PyArray_NDIM(input) * sizeof(npy_intp));
-    if (!f || !g || !tmp) {
+    /* Some temporaries for each task */
+    tasks = calloc(ntasks, sizeof(NI_FeatureTransformTask));
+    args = malloc(ntasks * sizeof(void *));
+    if (!tasks || !args) {
         PyErr_NoMemory();
         goto exit;
     }
-    for(jj = 0; jj < mx; jj++) {
-        f[jj] = tmp + jj * PyArray_NDIM(input);
+    for(kk = 0; kk < ntasks; kk++) {
+        NI_FeatureTransformTask *task = tasks + kk;
+        npy_intp *tmp;
+
+        args[kk] = task;
+        task->f = malloc(mx * sizeof(npy_intp*));
+        task->g = malloc(mx * sizeof(npy_intp));
+        tmp = malloc(mx * rank * sizeof(npy_intp));
+        if (!task->f || !task->g || !tmp) {
+            free(task->f);
+            free(tmp);
+            task->f = NULL;
+            PyErr_NoMemory();
+            goto exit;
+        }
+        for(jj = 0; jj < mx; jj++) {
+            task->f[jj] = tmp + jj * rank;
+        }
+        task->pi = (void *)PyArray_DATA(input);
+        task->pf = (void *)PyArray_DATA(features);
+        task->ishape = PyArray_DIMS(input);
+        task->istrides = PyArray_STRIDES(input);
+        task->fstrides = PyArray_STRIDES(features);
+        task->sampling = sampling;
+        task->rank = rank;
     }
 
-    /* First call of recursive feature transform */
     NPY_BEGIN_THREADS;
-    _ComputeFT(pi, pf, PyArray_DIMS(input), PyArray_STRIDES(input),
-               PyArray_STRIDES(features), PyArray_NDIM(input),
-               PyArray_NDIM(input) - 1, coor, f, g, features, sampling);
+    for(ii = 0; ii < rank; ii++) {
+        npy_intp lines = size / PyArray_DIM(input, ii);
+        int nt = lines < ntasks ? (int)lines : ntasks;
+
+        for(kk = 0; kk < nt; kk++) {
+            tasks[kk].axis = ii;
+            tasks[kk].first = lines * kk / nt;
+            tasks[kk].last = lines * (kk + 1) / nt;
+        }
+        NI_RunThreads(nt, _FeatureTransformTask, args);
+    }
     NPY_END_THREADS;
 
  exit:
-    free(f);
-    free(g);
-    free(tmp);
-
+    if (tasks) {
+        for(kk = 0; kk < ntasks; kk++) {
+            if (tasks[kk].f) {
+                free(tasks[kk].f[0]);
+            }
+            free(tasks[kk].f);
+            free(tasks[kk].g);
+        }
+    }
+    free(tasks);
+    free(args);
     return PyErr_Occurred() ? 0 : 1;
 }
+
+typedef struct {
+    double sampling;
+    int binary;
+} NI_SquaredDistanceData;
+
+/* Where the parabolas rooted at p < q of the line f intersect: */
+static NPY_INLINE double _ParabolaIntersection(const double *f, npy_intp q,
+                                               npy_intp p, double w)
+{
+    return ((f[q] - f[p]) / (w * w * (q - p)) + q + p) / 2.0;
+}
+
+/* The squared euclidean distance transform along one line, as the lower
+     envelope of the parabolas rooted at the finite elements of the line,
+     as described in: P. F. Felzenszwalb, D. P. Huttenlocher, "Distance
+     transforms of sampled functions", Theory of Computing 8, 415-428,
+     2012. On the first axis, the line holds the binary input, and its
+     nonzero elements are infinitely far away: */
+static void _SquaredDistanceLine(double *iline, double *oline, npy_intp len,
+                                 void *data, void *scratch)
+{
+    NI_SquaredDistanceData *sd = (NI_SquaredDistanceData *)data;
+    double w = sd->sampling, *z = (double *)scratch;
+    npy_intp *v = (npy_intp *)(z + len + 1);
+    npy_intp q, k = -1;
+
+    if (sd->binary) {
+        for(q = 0; q < len; q++) {
+            iline[q] = iline[q] != 0.0 ? HUGE_VAL : 0.0;
+        }
+    }
+    for(q = 0; q < len; q++) {
+        double s;
+        if (iline[q] == HUGE_VAL) {
+            continue;
+        }
+        if (k < 0) {
+            v[++k] = q;
+            continue;
+        }
+        /* drop the parabolas that the new one hides, z[k] being the
+             left end of the part of parabola k on the envelope: */
+        s = _ParabolaIntersection(iline, q, v[k], w);
+        while (k > 0 && s <= z[k]) {
+            --k;
+            s = _ParabolaIntersection(iline, q, v[k], w);
+        }
+        v[++k] = q;
+        z[k] = s;
+    }
+    if (k < 0) {
+        for(q = 0; q < len; q++) {
+            oline[q] = HUGE_VAL;
+        }
+        return;
+    }
+    z[k + 1] = HUGE_VAL;
+    for(q = 0, k = 0; q < len; q++) {
+        double t;
+        while (z[k + 1] < q) {
+            ++k;
+        }
+        t = (q - v[k]) * w;
+        oline[q] = t * t + iline[v[k]];
+    }
+}
+
+/* Exact euclidean distance transform, as the squared distances of
+     successive one-dimensional transforms along each axis, without the
+     feature transform. The lines of each axis are divided over up to
+     workers threads, and the square root is left to the caller. */
+int NI_EuclideanDistanceTransform(PyArrayObject* input,
+                                  PyArrayObject *sampling_arr,
+                                  PyArrayObject* distances, int workers)
+{
+    npy_double *sampling = sampling_arr ? ((void *)PyArray_DATA(sampling_arr)) : NULL;
+    NI_SquaredDistanceData data;
+    int ii;
+
+    for(ii = 0; ii < PyArray_NDIM(input); ii++) {
+        npy_intp len = PyArray_DIM(input, ii);
+
+        data.sampling = sampling ? sampling[ii] : 1.0;
+        data.binary = ii == 0;
+        if (!NI_LineFilter(ii == 0 ? input : distances, distances, ii, 0, 0,
+                           NI_EXTEND_DEFAULT, 0.0, 0, _SquaredDistanceLine,
+                           &data, (len + 1) * sizeof(double) +
+                           len * sizeof(npy_intp), workers)) {
+            return 0;
+        }
+    }
+    return 1;
+}
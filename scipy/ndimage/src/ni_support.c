@@ -30,6 +30,7 @@
  */
 
 #include "ni_support.h"
+#include "ni_threads.h"
 
 /* initialize iterations over single array elements: */
 int NI_InitPointIterator(PyArrayObject *array, NI_Iterator *iterator)
@@ -223,110 +224,117 @@ int NI_InitLineBuffer(PyArrayObject *array, int axis, npy_intp size1,
     return 1;
 }
 
-/* Extend a line in memory to implement boundary conditions: */
-int NI_ExtendLine(double *buffer, npy_intp line_length,
-                  npy_intp size_before, npy_intp size_after,
-                  NI_ExtendMode extend_mode, double extend_value)
-{
-    double *first = buffer + size_before;
-    double *last = first + line_length;
-    double *src, *dst, val;
-
-    switch (extend_mode) {
-        /* aaaaaaaa|abcd|dddddddd */
-        case NI_EXTEND_NEAREST:
-            src = first;
-            dst = buffer;
-            val = *src;
-            while (size_before--) {
-                *dst++ = val;
-            }
-            src = last - 1;
-            dst = last;
-            val = *src;
-            while (size_after--) {
-                *dst++ = val;
-            }
-            break;
-        /* abcdabcd|abcd|abcdabcd */
-        case NI_EXTEND_WRAP:
-            src = last - 1;
-            dst = first - 1;
-            while (size_before--) {
-                *dst-- = *src--;
-            }
-            src = first;
-            dst = last;
-            while (size_after--) {
-                *dst++ = *src++;
-            }
-            break;
-        /* abcddcba|abcd|dcbaabcd */
-        case NI_EXTEND_REFLECT:
-            src = first;
-            dst = first - 1;
-            while (size_before && src < last) {
-                *dst-- = *src++;
-                --size_before;
-            }
-            src = last - 1;
-            while (size_before--) {
-                *dst-- = *src--;
-            }
-            src = last - 1;
-            dst = last;
-            while (size_after && src >= first) {
-                *dst++ = *src--;
-                --size_after;
-            }
-            src = first;
-            while (size_after--) {
-                *dst++ = *src++;
-            }
-            break;
-        /* cbabcdcb|abcd|cbabcdcb */
-        case NI_EXTEND_MIRROR:
-            src = first + 1;
-            dst = first - 1;
-            while (size_before && src < last) {
-                *dst-- = *src++;
-                --size_before;
-            }
-            src = last - 2;
-            while (size_before--) {
-                *dst-- = *src--;
-            }
-            src = last - 2;
-            dst = last;
-            while (size_after && src >= first) {
-                *dst++ = *src--;
-                --size_after;
-            }
-            src = first + 1;
-            while (size_after--) {
-                *dst++ = *src++;
-            }
-            break;
-        /* kkkkkkkk|abcd]kkkkkkkk */
-        case NI_EXTEND_CONSTANT:
-            val = extend_value;
-            dst = buffer;
-            while (size_before--) {
-                *dst++ = val;
-            }
-            dst = last;
-            while (size_after--) {
-                *dst++ = val;
-            }
-            break;
-        default:
-            PyErr_Format(PyExc_RuntimeError,
-                         "mode %d not supported", extend_mode);
-            return 0;
-    }
-    return 1;
+/* Extend a line in memory to implement boundary conditions, for lines of
+     doubles and of floats: */
+#define DEFINE_EXTEND_LINE(_name, _type)                                    \
+int _name(_type *buffer, npy_intp line_length,                              \
+          npy_intp size_before, npy_intp size_after,                        \
+          NI_ExtendMode extend_mode, _type extend_value)                    \
+{                                                                           \
+    _type *first = buffer + size_before;                                    \
+    _type *last = first + line_length;                                      \
+    _type *src, *dst, val;                                                  \
+                                                                            \
+    switch (extend_mode) {                                                  \
+        /* aaaaaaaa|abcd|dddddddd */                                        \
+        case NI_EXTEND_NEAREST:                                             \
+            src = first;                                                    \
+            dst = buffer;                                                   \
+            val = *src;                                                     \
+            while (size_before--) {                                         \
+                *dst++ = val;                                               \
+            }                                                               \
+            src = last - 1;                                                 \
+            dst = last;                                                     \
+            val = *src;                                                     \
+            while (size_after--) {                                          \
+                *dst++ = val;                                               \
+            }                                                               \
+            break;                                                          \
+        /* abcdabcd|abcd|abcdabcd */                                        \
+        case NI_EXTEND_WRAP:                                                \
+            src = last - 1;                                                 \
+            dst = first - 1;                                                \
+            while (size_before--) {                                         \
+                *dst-- = *src--;                                            \
+            }                                                               \
+            src = first;                                                    \
+            dst = last;                                                     \
+            while (size_after--) {                                          \
+                *dst++ = *src++;                                            \
+            }                                                               \
+            break;                                                          \
+        /* abcddcba|abcd|dcbaabcd */                                        \
+        case NI_EXTEND_REFLECT:                                             \
+            src = first;                                                    \
+            dst = first - 1;                                                \
+            while (size_before && src < last) {                             \
+                *dst-- = *src++;                                            \
+                --size_before;                                              \
+            }                                                               \
+            src = last - 1;                                                 \
+            while (size_before--) {                                         \
+                *dst-- = *src--;                                            \
+            }                                                               \
+            src = last - 1;                                                 \
+            dst = last;                                                     \
+            while (size_after && src >= first) {                            \
+                *dst++ = *src--;                                            \
+                --size_after;                                               \
+            }                                                               \
+            src = first;                                                    \
+            while (size_after--) {                                          \
+                *dst++ = *src++;                                            \
+            }                                                               \
+            break;                                                          \
+        /* cbabcdcb|abcd|cbabcdcb */                                        \
+        case NI_EXTEND_MIRROR:                                              \
+            src = first + 1;                                                \
+            dst = first - 1;                                                \
+            while (size_before && src < last) {                             \
+                *dst-- = *src++;                                            \
+                --size_before;                                              \
+            }                                                               \
+            src = last - 2;                                                 \
+            while (size_before--) {                                         \
+                *dst-- = *src--;                                            \
+            }                                                               \
+            src = last - 2;                                                 \
+            dst = last;                                                     \
+            while (size_after && src >= first) {                            \
+                *dst++ = *src--;                                            \
+                --size_after;                                               \
+            }                                                               \
+            src = first + 1;                                                \
+            while (size_after--) {                                          \
+                *dst++ = *src++;                                            \
+            }                                                               \
+            break;                                                          \
+        /* kkkkkkkk|abcd]kkkkkkkk */                                        \
+        case NI_EXTEND_CONSTANT:                                            \
+            val = extend_value;                                             \
+            dst = buffer;                                                   \
+            while (size_before--) {                                         \
+                *dst++ = val;                                               \
+            }                                                               \
+            dst = last;                                                     \
+            while (size_after--) {                                          \
+                *dst++ = val;                                               \
+            }                                                               \
+            break;                                                          \
+        default:                                                            \
+            PyErr_Format(PyExc_RuntimeError,                                \
+                         "mode %d not supported", extend_mode);             \
+            return 0;                                                       \
+    }                                                                       \
+    return 1;                                                               \
 }
 
+DEFINE_EXTEND_LINE(NI_ExtendLine, double)
+DEFINE_EXTEND_LINE(NI_ExtendLineFloat, float)
+
+#undef DEFINE_EXTEND_LINE
+
 
 #define CASE_COPY_DATA_TO_LINE(_TYPE, _type, _pi, _po, _length, _stride) \
 case _TYPE:                                                              \
@@ -476,6 +484,423 @@ int NI_LineBufferToArray(NI_LineBuffer *buffer)
     return 1;
 }
 
+/* Restrict a line buffer that was just initialized to the array lines
+     first, ..., last - 1: */
+int NI_LineBufferSetRange(NI_LineBuffer *buffer, npy_intp first,
+                          npy_intp last)
+{
+    int ii;
+    npy_intp line = first;
+
+    /* the lines are numbered in the order of the line iterator, so the
+         coordinates of a line are the digits of its number: */
+    if (first > 0) {
+        for(ii = buffer->iterator.rank_m1; ii >= 0; ii--) {
+            npy_intp dim = buffer->iterator.dimensions[ii] + 1;
+            npy_intp coordinate = line % dim;
+            buffer->iterator.coordinates[ii] = coordinate;
+            buffer->array_data += coordinate * buffer->iterator.strides[ii];
+            line /= dim;
+        }
+    }
+    buffer->next_line = first;
+    buffer->array_lines = last;
+    return 1;
+}
+
+/******************************************************************/
+/* Threaded line filters */
+/******************************************************************/
+
+#define LINE_FILTER_BUFFER_SIZE 256000
+
+/* Minimum number of array elements that justifies another thread: */
+#define LINE_FILTER_MIN_WORK_PER_THREAD 65536
+
+/* Range of the memory touched by an array: */
+static void _ArrayExtents(PyArrayObject *array, char **low, char **high)
+{
+    int ii;
+
+    *low = *high = PyArray_BYTES(array);
+    if (PyArray_SIZE(array) == 0) {
+        return;
+    }
+    *high += PyArray_ITEMSIZE(array);
+    for(ii = 0; ii < PyArray_NDIM(array); ii++) {
+        npy_intp extent = (PyArray_DIM(array, ii) - 1) *
+                          PyArray_STRIDE(array, ii);
+        if (extent < 0) {
+            *low += extent;
+        } else {
+            *high += extent;
+        }
+    }
+}
+
+/* Whether the memory ranges of two arrays overlap: */
+int NI_ArraysOverlap(PyArrayObject *array1, PyArrayObject *array2)
+{
+    char *low1, *high1, *low2, *high2;
+
+    _ArrayExtents(array1, &low1, &high1);
+    _ArrayExtents(array2, &low2, &high2);
+    return low1 < high2 && low2 < high1;
+}
+
+/* Lines can be filtered independently of each other if the output does not
+     overlap the input, or overlaps it exactly, element for element: */
+int NI_LinesAreIndependent(PyArrayObject *input, PyArrayObject *output)
+{
+    int ii;
+
+    if (PyArray_BYTES(input) == PyArray_BYTES(output) &&
+            PyArray_ITEMSIZE(input) == PyArray_ITEMSIZE(output)) {
+        for(ii = 0; ii < PyArray_NDIM(input); ii++) {
+            if (PyArray_STRIDE(input, ii) != PyArray_STRIDE(output, ii)) {
+                break;
+            }
+        }
+        if (ii == PyArray_NDIM(input)) {
+            return 1;
+        }
+    }
+    return !NI_ArraysOverlap(input, output);
+}
+
+/* The lines of one thread, with its own line buffers: */
+typedef struct {
+    NI_LineBuffer iline_buffer, oline_buffer;
+    double *ibuffer, *obuffer;
+    void *scratch;
+    NI_LineFunction *func;
+    void *data;
+    npy_intp length;
+    int error;
+} NI_LineFilterTask;
+
+static void _LineFilterTask(void *arg)
+{
+    NI_LineFilterTask *task = (NI_LineFilterTask *)arg;
+    npy_intp kk, lines;
+    int more;
+
+    /* iterate over all the array lines of the task: */
+    do {
+        /* copy lines from array to buffer: */
+        if (!NI_ArrayToLineBuffer(&task->iline_buffer, &lines, &more)) {
+            task->error = 1;
+            return;
+        }
+        /* iterate over the lines in the buffers: */
+        for(kk = 0; kk < lines; kk++) {
+            task->func(NI_GET_LINE(task->iline_buffer, kk),
+                       NI_GET_LINE(task->oline_buffer, kk), task->length,
+                       task->data, task->scratch);
+        }
+        /* copy lines from buffer to array: */
+        if (!NI_LineBufferToArray(&task->oline_buffer)) {
+            task->error = 1;
+            return;
+        }
+    } while(more);
+}
+
+/* Filter all the lines of input along axis into output, on up to workers
+     threads. Input lines are extended by size1 elements before and size2
+     after. If in_place is set, func is passed the same line twice, and
+     size1 and size2 must be zero. Each thread processes a disjoint range
+     of lines, with its own line buffers and scratch_size bytes of scratch
+     space for func. */
+int NI_LineFilter(PyArrayObject *input, PyArrayObject *output, int axis,
+                  npy_intp size1, npy_intp size2, NI_ExtendMode mode,
+                  double cval, int in_place, NI_LineFunction *func,
+                  void *data, size_t scratch_size, int workers)
+{
+    NI_LineFilterTask *tasks = NULL;
+    void **args = NULL;
+    npy_intp lines, array_lines, length, size;
+    int ntasks = 1, kk;
+    NPY_BEGIN_THREADS_DEF;
+
+    if (size1 + size2 > 0 &&
+            ((int)mode < NI_EXTEND_FIRST || (int)mode > NI_EXTEND_LAST)) {
+        PyErr_Format(PyExc_RuntimeError, "mode %d not supported",
+                     (int)mode);
+        goto exit;
+    }
+    length = PyArray_NDIM(input) > 0 ? PyArray_DIM(input, axis) : 1;
+    size = PyArray_SIZE(input);
+    array_lines = length > 0 ? size / length : 0;
+
+    if (workers > 1 && array_lines > 1 &&
+            NI_LinesAreIndependent(input, output)) {
+        npy_intp max_tasks = size / LINE_FILTER_MIN_WORK_PER_THREAD;
+        if (max_tasks > array_lines) {
+            max_tasks = array_lines;
+        }
+        if (max_tasks < workers) {
+            workers = max_tasks > 1 ? (int)max_tasks : 1;
+        }
+        ntasks = workers;
+    }
+
+    tasks = calloc(ntasks, sizeof(NI_LineFilterTask));
+    args = malloc(ntasks * sizeof(void *));
+    if (!tasks || !args) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+    /* allocate and initialize the line buffers of each task: */
+    for(kk = 0; kk < ntasks; kk++) {
+        NI_LineFilterTask *task = tasks + kk;
+        npy_intp first = array_lines * kk / ntasks;
+        npy_intp last = array_lines * (kk + 1) / ntasks;
+
+        args[kk] = task;
+        lines = -1;
+        if (!NI_AllocateLineBuffer(input, axis, size1, size2, &lines,
+                                   LINE_FILTER_BUFFER_SIZE, &task->ibuffer))
+            goto exit;
+        if (last > first && lines > last - first) {
+            lines = last - first;
+        }
+        if (in_place) {
+            task->obuffer = task->ibuffer;
+        } else if (!NI_AllocateLineBuffer(output, axis, 0, 0, &lines,
+                                          LINE_FILTER_BUFFER_SIZE,
+                                          &task->obuffer)) {
+            goto exit;
+        }
+        if (!NI_InitLineBuffer(input, axis, size1, size2, lines,
+                               task->ibuffer, mode, cval,
+                               &task->iline_buffer))
+            goto exit;
+        if (!NI_InitLineBuffer(output, axis, 0, 0, lines, task->obuffer,
+                               mode, 0.0, &task->oline_buffer))
+            goto exit;
+        NI_LineBufferSetRange(&task->iline_buffer, first, last);
+        NI_LineBufferSetRange(&task->oline_buffer, first, last);
+        if (scratch_size > 0) {
+            task->scratch = malloc(scratch_size);
+            if (!task->scratch) {
+                PyErr_NoMemory();
+                goto exit;
+            }
+        }
+        task->func = func;
+        task->data = data;
+        task->length = length;
+    }
+
+    NPY_BEGIN_THREADS;
+    NI_RunThreads(ntasks, _LineFilterTask, args);
+    NPY_END_THREADS;
+
+    for(kk = 0; kk < ntasks; kk++) {
+        if (tasks[kk].error && !PyErr_Occurred()) {
+            PyErr_SetString(PyExc_RuntimeError, "line filter failed");
+        }
+    }
+
+exit:
+    if (tasks) {
+        for(kk = 0; kk < ntasks; kk++) {
+            if (tasks[kk].obuffer != tasks[kk].ibuffer) {
+                free(tasks[kk].obuffer);
+            }
+            free(tasks[kk].ibuffer);
+            free(tasks[kk].scratch);
+        }
+    }
+    free(tasks);
+    free(args);
+    return PyErr_Occurred() ? 0 : 1;
+}
+
+/* Whether the lines of input can be filtered into output as lines of
+     floats, with the same result as lines of doubles up to the rounding of
+     the filter itself: both arrays are float32, a constant border value is
+     a float, and the threads of NI_FloatLineFilter, which read one line at
+     a time, cannot see each other's output: */
+int NI_CanFilterFloatLines(PyArrayObject *input, PyArrayObject *output,
+                           NI_ExtendMode mode, double cval)
+{
+    if (PyArray_TYPE(input) != NPY_FLOAT ||
+            PyArray_TYPE(output) != NPY_FLOAT) {
+        return 0;
+    }
+    if (mode == NI_EXTEND_CONSTANT && cval == cval &&
+            (double)(float)cval != cval) {
+        return 0;
+    }
+    return NI_LinesAreIndependent(input, output);
+}
+
+/* The float lines of one thread, filtered one at a time: */
+typedef struct {
+    PyArrayObject *input, *output;
+    NI_Iterator ii, io;
+    float *iline, *oline;
+    void *scratch;
+    NI_FloatLineFunction *func;
+    void *data;
+    npy_intp length, istride, ostride, size1, size2, first, last;
+    NI_ExtendMode mode;
+    float cval;
+} NI_FloatLineFilterTask;
+
+/* Move a line iterator to the line with the given index: */
+static char *_LineGoto(NI_Iterator *iterator, npy_intp index, char *base)
+{
+    npy_intp coordinates[NPY_MAXDIMS];
+    char *pointer;
+    int kk;
+
+    for(kk = iterator->rank_m1; kk >= 0; kk--) {
+        coordinates[kk] = index % (iterator->dimensions[kk] + 1);
+        index /= iterator->dimensions[kk] + 1;
+    }
+    NI_ITERATOR_GOTO(*iterator, coordinates, base, pointer);
+    return pointer;
+}
+
+static void _FloatLineFilterTask(void *arg)
+{
+    NI_FloatLineFilterTask *task = (NI_FloatLineFilterTask *)arg;
+    npy_intp kk, ll, length = task->length;
+    float *iline = task->iline + task->size1, *oline = task->oline;
+    char *pi, *po;
+
+    if (task->first >= task->last) {
+        return;
+    }
+    pi = _LineGoto(&task->ii, task->first, PyArray_BYTES(task->input));
+    po = _LineGoto(&task->io, task->first, PyArray_BYTES(task->output));
+    for(kk = task->first; kk < task->last; kk++) {
+        char *pp = pi;
+        /* copy the line, and extend it at the borders: */
+        for(ll = 0; ll < length; ll++) {
+            iline[ll] = *(npy_float *)pp;
+            pp += task->istride;
+        }
+        if (task->size1 + task->size2 > 0) {
+            NI_ExtendLineFloat(task->iline, length, task->size1, task->size2,
+                               task->mode, task->cval);
+        }
+        task->func(task->iline, oline, length, task->data, task->scratch);
+        pp = po;
+        for(ll = 0; ll < length; ll++) {
+            *(npy_float *)pp = oline[ll];
+            pp += task->ostride;
+        }
+        NI_ITERATOR_NEXT(task->ii, pi);
+        NI_ITERATOR_NEXT(task->io, po);
+    }
+}
+
+/* Filter all the lines of input along axis into output as lines of floats,
+     on up to workers threads, like NI_LineFilter. The arrays must pass
+     NI_CanFilterFloatLines. If in_place is set, func is passed the same
+     line twice, and size1 and size2 must be zero. */
+int NI_FloatLineFilter(PyArrayObject *input, PyArrayObject *output, int axis,
+                       npy_intp size1, npy_intp size2, NI_ExtendMode mode,
+                       double cval, int in_place, NI_FloatLineFunction *func,
+                       void *data, size_t scratch_size, int workers)
+{
+    NI_FloatLineFilterTask *tasks = NULL;
+    void **args = NULL;
+    npy_intp array_lines, length, size;
+    int ntasks = 1, kk;
+    NPY_BEGIN_THREADS_DEF;
+
+    if (size1 + size2 > 0 &&
+            ((int)mode < NI_EXTEND_FIRST || (int)mode > NI_EXTEND_LAST)) {
+        PyErr_Format(PyExc_RuntimeError, "mode %d not supported",
+                     (int)mode);
+        goto exit;
+    }
+    length = PyArray_NDIM(input) > 0 ? PyArray_DIM(input, axis) : 1;
+    size = PyArray_SIZE(input);
+    array_lines = length > 0 ? size / length : 0;
+
+    if (workers > 1 && array_lines > 1) {
+        npy_intp max_tasks = size / LINE_FILTER_MIN_WORK_PER_THREAD;
+        if (max_tasks > array_lines) {
+            max_tasks = array_lines;
+        }
+        if (max_tasks < workers) {
+            workers = max_tasks > 1 ? (int)max_tasks : 1;
+        }
+        ntasks = workers;
+    }
+
+    tasks = calloc(ntasks, sizeof(NI_FloatLineFilterTask));
+    args = malloc(ntasks * sizeof(void *));
+    if (!tasks || !args) {
+        PyErr_NoMemory();
+        goto exit;
+    }
+    for(kk = 0; kk < ntasks; kk++) {
+        NI_FloatLineFilterTask *task = tasks + kk;
+
+        args[kk] = task;
+        task->iline = malloc((length + size1 + size2 + 1) * sizeof(float));
+        task->oline = in_place ? task->iline :
+                                 malloc((length + 1) * sizeof(float));
+        if (!task->iline || !task->oline) {
+            PyErr_NoMemory();
+            goto exit;
+        }
+        if (scratch_size > 0) {
+            task->scratch = malloc(scratch_size);
+            if (!task->scratch) {
+                PyErr_NoMemory();
+                goto exit;
+            }
+        }
+        if (!NI_InitPointIterator(input, &task->ii) ||
+                !NI_LineIterator(&task->ii, axis))
+            goto exit;
+        if (!NI_InitPointIterator(output, &task->io) ||
+                !NI_LineIterator(&task->io, axis))
+            goto exit;
+        task->input = input;
+        task->output = output;
+        task->func = func;
+        task->data = data;
+        task->length = length;
+        task->istride = PyArray_NDIM(input) > 0 ?
+                        PyArray_STRIDE(input, axis) : 0;
+        task->ostride = PyArray_NDIM(output) > 0 ?
+                        PyArray_STRIDE(output, axis) : 0;
+        task->size1 = size1;
+        task->size2 = size2;
+        task->first = array_lines * kk / ntasks;
+        task->last = array_lines * (kk + 1) / ntasks;
+        task->mode = mode;
+        task->cval = (float)cval;
+    }
+
+    NPY_BEGIN_THREADS;
+    NI_RunThreads(ntasks, _FloatLineFilterTask, args);
+    NPY_END_THREADS;
+
+exit:
+    if (tasks) {
+        for(kk = 0; kk < ntasks; kk++) {
+            if (tasks[kk].oline != tasks[kk].iline) {
+                free(tasks[kk].oline);
+            }
+            free(tasks[kk].iline);
+            free(tasks[kk].scratch);
+        }
+    }
+    free(tasks);
+    free(args);
+    return PyErr_Occurred() ? 0 : 1;
+}
+
 /******************************************************************/
 /* Multi-dimensional filter support functions */
 /******************************************************************/
@@ -185,6 +185,8 @@ int NI_InitLineBuffer(PyArrayObject*, int, npy_intp, npy_intp, npy_intp,
 
 /* Extend a line in memory to implement boundary conditions: */
 int NI_ExtendLine(double*, npy_intp, npy_intp, npy_intp, NI_ExtendMode, double);
+int NI_ExtendLineFloat(float*, npy_intp, npy_intp, npy_intp, NI_ExtendMode,
+                       float);
 
 /* Copy a line from an array to a buffer: */
 int NI_ArrayToLineBuffer(NI_LineBuffer*, npy_intp*, int*);
@@ -192,6 +194,37 @@ int NI_ArrayToLineBuffer(NI_LineBuffer*, npy_intp*, int*);
 /* Copy a line from a buffer to an array: */
 int NI_LineBufferToArray(NI_LineBuffer*);
 
+/* Restrict a line buffer to a range of the array lines: */
+int NI_LineBufferSetRange(NI_LineBuffer*, npy_intp, npy_intp);
+
+/* Filter one line: input line with its boundary extension, output line,
+     line length, filter data, and scratch space of the calling thread: */
+typedef void (NI_LineFunction)(double*, double*, npy_intp, void*, void*);
+
+/* Whether the memory ranges of two arrays overlap: */
+int NI_ArraysOverlap(PyArrayObject*, PyArrayObject*);
+
+/* Whether the lines of an output can be computed independently of each
+     other from those of an input, on separate threads: */
+int NI_LinesAreIndependent(PyArrayObject*, PyArrayObject*);
+
+/* Filter all array lines along an axis, on up to a number of threads: */
+int NI_LineFilter(PyArrayObject*, PyArrayObject*, int, npy_intp, npy_intp,
+                  NI_ExtendMode, double, int, NI_LineFunction*, void*,
+                  size_t, int);
+
+/* Filter one line of floats, with the arguments of NI_LineFunction: */
+typedef void (NI_FloatLineFunction)(float*, float*, npy_intp, void*, void*);
+
+/* Whether NI_FloatLineFilter can filter input into output: */
+int NI_CanFilterFloatLines(PyArrayObject*, PyArrayObject*, NI_ExtendMode,
+                           double);
+
+/* Filter all float32 array lines along an axis as lines of floats: */
+int NI_FloatLineFilter(PyArrayObject*, PyArrayObject*, int, npy_intp,
+                       npy_intp, NI_ExtendMode, double, int,
+                       NI_FloatLineFunction*, void*, size_t, int);
+
 /******************************************************************/
 /* Multi-dimensional filter support functions */
 /******************************************************************/
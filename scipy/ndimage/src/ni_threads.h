@@ -0,0 +1,120 @@
+/*
+ * Minimal portable threads for the ndimage filters, and an atomic
+ * compare-and-exchange for the structures they share.
+ *
+ * NI_RunThreads runs func(args[k]) for k = 0..nthreads-1, each on its own
+ * thread, and returns when all of them have finished. args[0] always runs
+ * on the calling thread. If a thread cannot be started, its call is made
+ * on the calling thread instead, once the others have been started.
+ *
+ * The GIL must be released while the threads run, so func must not touch
+ * any Python objects.
+ */
+#ifndef NI_THREADS_H
+#define NI_THREADS_H
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+
+#include <windows.h>
+#include <process.h>
+
+typedef HANDLE NI_ThreadHandle;
+#define NI_THREAD_RETURN unsigned __stdcall
+
+#else
+
+#include <pthread.h>
+
+typedef pthread_t NI_ThreadHandle;
+#define NI_THREAD_RETURN void *
+
+#endif
+
+typedef void (NI_ThreadFunction)(void *arg);
+
+typedef struct {
+    NI_ThreadFunction *func;
+    void *arg;
+    NI_ThreadHandle handle;
+    int started;
+} NI_Thread;
+
+static NI_THREAD_RETURN
+NI_ThreadMain(void *arg)
+{
+    NI_Thread *th = (NI_Thread *)arg;
+    th->func(th->arg);
+    return 0;
+}
+
+static NPY_INLINE int
+NI_ThreadStart(NI_Thread *th)
+{
+#ifdef _WIN32
+    th->handle = (HANDLE)_beginthreadex(NULL, 0, NI_ThreadMain, th, 0, NULL);
+    return th->handle != 0;
+#else
+    return pthread_create(&th->handle, NULL, NI_ThreadMain, th) == 0;
+#endif
+}
+
+static NPY_INLINE void
+NI_ThreadJoin(NI_Thread *th)
+{
+#ifdef _WIN32
+    WaitForSingleObject(th->handle, INFINITE);
+    CloseHandle(th->handle);
+#else
+    pthread_join(th->handle, NULL);
+#endif
+}
+
+static NPY_INLINE void
+NI_RunThreads(int nthreads, NI_ThreadFunction *func, void **args)
+{
+    NI_Thread *threads = NULL;
+    int kk;
+
+    if (nthreads > 1) {
+        threads = calloc(nthreads - 1, sizeof(NI_Thread));
+    }
+    for (kk = 1; kk < nthreads; ++kk) {
+        if (threads) {
+            NI_Thread *th = threads + (kk - 1);
+            th->func = func;
+            th->arg = args[kk];
+            th->started = NI_ThreadStart(th);
+        }
+    }
+    func(args[0]);
+    for (kk = 1; kk < nthreads; ++kk) {
+        if (threads && threads[kk - 1].started) {
+            NI_ThreadJoin(threads + (kk - 1));
+        }
+        else {
+            /* the work of this range must still be done */
+            func(args[kk]);
+        }
+    }
+    free(threads);
+}
+
+/* Replace *ptr by desired if it still holds expected, as one atomic
+ * operation, and return whether it did. */
+static NPY_INLINE int
+NI_AtomicCompareExchange(volatile npy_intp *ptr, npy_intp expected,
+                         npy_intp desired)
+{
+#ifdef _WIN32
+    return InterlockedCompareExchangePointer((PVOID volatile *)ptr,
+                                             (PVOID)desired,
+                                             (PVOID)expected) ==
+           (PVOID)expected;
+#else
+    return __sync_bool_compare_and_swap(ptr, expected, desired);
+#endif
+}
+
+#endif
@@ -82,6 +82,35 @@ def test_generic_filter1d():
         check(j)
 
 
+def test_generic_filter_batched():
+    im = np.random.RandomState(0).rand(400, 300)
+    footprint = np.array([[0, 1, 0], [1, 1, 1], [0, 1, 0]])
+    weights = np.arange(1, 6)/15.
+
+    std = ndimage.generic_filter(im, _ctest.filter2d(weights),
+                                 footprint=footprint)
+    for workers in [1, 4]:
+        res = ndimage.generic_filter(
+            im, LowLevelCallable(_ctest.filter2d_batched(weights)),
+            footprint=footprint, workers=workers)
+        assert_allclose(res, std, err_msg="workers={}".format(workers))
+
+
+def test_generic_filter1d_batched():
+    im = np.random.RandomState(0).rand(400, 300)
+    filter_size = 5
+
+    for axis in [0, 1]:
+        std = ndimage.generic_filter1d(im, _ctest.filter1d(filter_size),
+                                       filter_size, axis=axis)
+        for workers in [1, 4]:
+            res = ndimage.generic_filter1d(
+                im, LowLevelCallable(_ctest.filter1d_batched(filter_size)),
+                filter_size, axis=axis, workers=workers)
+            assert_allclose(res, std, err_msg="axis={}, workers={}".format(
+                axis, workers))
+
+
 def test_geometric_transform():
     def transform(output_coordinates, shift):
         return output_coordinates[0] - shift, output_coordinates[1] - shift
@@ -6,6 +6,7 @@ import numpy as np
 
 from numpy.testing import (assert_equal, assert_allclose,
                            assert_array_equal, assert_almost_equal)
+import pytest
 from pytest import raises as assert_raises
 
 import scipy.ndimage as sndi
@@ -376,6 +377,184 @@ class TestThreading(object):
         assert_array_equal(os, ot)
 
 
+class TestWorkers(object):
+    # large enough to be divided over several threads
+    shape = (600, 700)
+
+    @pytest.mark.parametrize('axis', [0, 1])
+    @pytest.mark.parametrize('func, args', [
+        (sndi.correlate1d, ([1, 3, 2, -1],)),
+        (sndi.gaussian_filter1d, (2.5,)),
+        (sndi.uniform_filter1d, (5,)),
+        (sndi.minimum_filter1d, (4,)),
+        (sndi.maximum_filter1d, (3,)),
+        (sndi.spline_filter1d, ()),
+    ])
+    def test_filter1d(self, func, args, axis):
+        np.random.seed(1234)
+        d = np.random.randn(*self.shape)
+        expected = func(d, *args, axis=axis)
+        for workers in [3, -1]:
+            assert_array_equal(func(d, *args, axis=axis, workers=workers),
+                               expected)
+        # lines that are not contiguous, and an output of another type
+        d = d[::2].T
+        expected = func(d, *args, axis=axis, output=np.float32)
+        assert_array_equal(func(d, *args, axis=axis, output=np.float32,
+                                workers=3), expected)
+
+    @pytest.mark.parametrize('func, args', [
+        (sndi.gaussian_filter, (2.5,)),
+        (sndi.uniform_filter, (5,)),
+        (sndi.minimum_filter, (4,)),
+        (sndi.maximum_filter, (3,)),
+        (sndi.spline_filter, ()),
+    ])
+    def test_filter_in_place(self, func, args):
+        np.random.seed(1234)
+        d = np.random.randn(*self.shape)
+        expected = func(d, *args)
+        out = d.copy()
+        func(out, *args, output=out, workers=4)
+        assert_array_equal(out, expected)
+
+    @pytest.mark.parametrize('mode, cval', [
+        ('reflect', 0), ('nearest', 0), ('wrap', 0), ('mirror', 0),
+        ('constant', 0), ('constant', 1.5)])
+    def test_correlate(self, mode, cval):
+        np.random.seed(1234)
+        d = np.random.randn(*self.shape)
+        # not separable
+        k = np.random.randn(5, 4)
+        expected = sndi.correlate(d, k, mode=mode, cval=cval)
+        for workers in [3, -1]:
+            assert_array_equal(sndi.correlate(d, k, mode=mode, cval=cval,
+                                              workers=workers), expected)
+        # a small array, along which the kernel is longer
+        d = d[:3]
+        expected = sndi.correlate(d, k, mode=mode, cval=cval)
+        assert_array_equal(sndi.correlate(d, k, mode=mode, cval=cval,
+                                          workers=3), expected)
+
+    @pytest.mark.parametrize('dtype', [np.uint8, np.int16, np.float64])
+    def test_rank_filter(self, dtype):
+        np.random.seed(1234)
+        d = np.random.randint(0, 100, self.shape).astype(dtype)
+        for size in [(3, 3), (1, 9), (15, 17)]:
+            expected = sndi.median_filter(d, size)
+            for workers in [3, -1]:
+                assert_array_equal(sndi.median_filter(d, size,
+                                                      workers=workers),
+                                   expected)
+
+    def test_invalid_workers(self):
+        d = np.ones(10)
+        assert_raises(ValueError, sndi.uniform_filter1d, d, 3, workers=0)
+        assert_raises(TypeError, sndi.uniform_filter1d, d, 3, workers=1.5)
+
+
+class TestFloat32(object):
+
+    @pytest.mark.parametrize('axis', [0, 1])
+    @pytest.mark.parametrize('func, args', [
+        (sndi.correlate1d, ([1, 3, 2, -1],)),
+        (sndi.gaussian_filter1d, (2.5,)),
+        (sndi.uniform_filter1d, (5,)),
+        (sndi.spline_filter1d, ()),
+    ])
+    def test_filter1d(self, func, args, axis):
+        # lines of float32 are accumulated in double precision, as are the
+        # same values converted to float64
+        np.random.seed(1234)
+        d = np.random.randn(60, 70).astype(np.float32)
+        kwargs = dict(axis=axis, output=np.float32)
+        expected = func(d.astype(np.float64), *args, **kwargs)
+        assert_array_equal(func(d, *args, **kwargs), expected)
+        assert_array_equal(func(d, *args, workers=3, **kwargs), expected)
+        assert_array_equal(func(d[::2].T, *args, **kwargs),
+                           func(d[::2].T.astype(np.float64), *args,
+                                **kwargs))
+
+    @pytest.mark.parametrize('mode, cval', [
+        ('reflect', 0), ('constant', 0), ('constant', 1.5), ('wrap', 0)])
+    def test_single_precision(self, mode, cval):
+        np.random.seed(1234)
+        d = np.random.randn(60, 70).astype(np.float32)
+        expected = sndi.gaussian_filter(d, 2.5, mode=mode, cval=cval)
+        actual = sndi.gaussian_filter(d, 2.5, mode=mode, cval=cval,
+                                      precision='single')
+        assert_equal(actual.dtype, np.float32)
+        assert_allclose(actual, expected, rtol=1e-5, atol=1e-5)
+        k = np.outer([1, 2, 1], [1, 0, -1])
+        expected = sndi.correlate(d, k, mode=mode, cval=cval)
+        actual = sndi.correlate(d, k, mode=mode, cval=cval,
+                                precision='single')
+        assert_allclose(actual, expected, rtol=1e-5, atol=1e-5)
+
+    def test_invalid_precision(self):
+        d = np.ones(10, dtype=np.float32)
+        assert_raises(ValueError, sndi.correlate1d, d, [1, 2],
+                      precision='half')
+        assert_raises(ValueError, sndi.correlate, d, [1, 2],
+                      precision='float')
+
+
+@pytest.mark.parametrize('mode, pad_mode', [
+    ('reflect', 'symmetric'), ('nearest', 'edge'), ('wrap', 'wrap'),
+    ('mirror', 'reflect'), ('constant', 'constant')])
+@pytest.mark.parametrize('shape', [(7, 5), (1, 6), (4, 1, 3)])
+def test_correlate_separable(mode, pad_mode, shape):
+    # rank-1 kernels are applied as a sequence of 1d correlations
+    np.random.seed(1234)
+    factors = [np.random.uniform(0.5, 2, n) for n in shape]
+    k = factors[0]
+    for f in factors[1:]:
+        k = np.multiply.outer(k, f)
+    d = np.random.randn(*[20 + n for n in range(len(shape))])
+    origin = [(n - 1) // 2 for n in shape]
+
+    pad = [(n // 2 + o, n - 1 - n // 2 - o) for n, o in zip(shape, origin)]
+    padded = np.pad(d, pad, mode=pad_mode)
+    expected = np.zeros_like(d)
+    for index in np.ndindex(*shape):
+        window = tuple(slice(i, i + n) for i, n in zip(index, d.shape))
+        expected += k[index] * padded[window]
+
+    assert_allclose(sndi.correlate(d, k, mode=mode, origin=origin),
+                    expected, rtol=1e-13, atol=1e-13)
+    if all(n % 2 for n in shape):
+        flipped = k[(slice(None, None, -1),) * k.ndim]
+        assert_allclose(sndi.convolve(d, flipped, mode=mode),
+                        sndi.correlate(d, k, mode=mode),
+                        rtol=1e-13, atol=1e-13)
+
+
+@pytest.mark.parametrize('dtype', [np.bool_, np.uint8, np.int8, np.uint16,
+                                   np.int16, np.int32, np.float32,
+                                   np.float64])
+@pytest.mark.parametrize('size', [(5, 5), (1, 7), (3, 1), (9, 21), (40, 1)])
+def test_rank_filter_engines(dtype, size):
+    # every window against a sort of its values, for the sizes that pick
+    # each of the rank engines
+    np.random.seed(1234)
+    d = np.random.randint(-40, 60, (31, 43))
+    if dtype == np.bool_:
+        d = d > 0
+    elif np.dtype(dtype).kind == 'u':
+        d += 40
+    d = d.astype(dtype)
+    pad = [(n // 2, n - 1 - n // 2) for n in size]
+    padded = np.pad(d, pad, mode='symmetric')
+    windows = np.empty(d.shape + (size[0] * size[1],), dtype)
+    for k, index in enumerate(np.ndindex(*size)):
+        window = tuple(slice(i, i + n) for i, n in zip(index, d.shape))
+        windows[..., k] = padded[window]
+    windows.sort(axis=-1)
+    for rank in [1, windows.shape[-1] // 2, -2]:
+        assert_array_equal(sndi.rank_filter(d, rank, size),
+                           windows[..., rank])
+
+
 def test_minmaximum_filter1d():
     # Regression gh-3898
     in_ = np.arange(10)
@@ -405,6 +584,34 @@ def test_minmaximum_filter1d():
     assert_equal([9, 9, 4, 5, 6, 7, 8, 9, 9, 9], out)
 
 
+@pytest.mark.parametrize('size', [2, 7, 8, 13, 40])
+def test_minmaximum_filter1d_windows(size):
+    # every window against its extremum, for the sizes that pick the
+    # wedge and the van Herk/Gil-Werman lines
+    np.random.seed(1234)
+    d = np.random.randint(-50, 50, (7, 31)).astype(np.float64)
+    d[3, 5] = np.nan
+    pad = (size // 2, size - 1 - size // 2)
+    padded = np.pad(d, [(0, 0), pad], mode='symmetric')
+    windows = np.stack([padded[:, k:k + d.shape[1]] for k in range(size)])
+    nan_free = ~np.isnan(d).any(axis=1)
+    out = sndi.minimum_filter1d(d, size)
+    assert_array_equal(out[nan_free], windows.min(axis=0)[nan_free])
+    out = sndi.maximum_filter1d(d, size, workers=3)
+    assert_array_equal(out[nan_free], windows.max(axis=0)[nan_free])
+
+
+def test_grey_dilation_flat_structure():
+    np.random.seed(1234)
+    d = np.random.randint(0, 100, (40, 50))
+    expected = sndi.grey_dilation(d, footprint=np.ones((9, 4), bool))
+    assert_array_equal(sndi.grey_dilation(d, structure=np.zeros((9, 4)),
+                                          workers=3), expected)
+    expected = sndi.grey_erosion(d, footprint=np.ones((3, 11), bool))
+    assert_array_equal(sndi.grey_erosion(d, structure=np.zeros((3, 11)),
+                                         workers=-1), expected)
+
+
 def test_uniform_filter1d_roundoff_errors():
     # gh-6930
     in_ = np.repeat([0, 1, 0], [9, 9, 9])
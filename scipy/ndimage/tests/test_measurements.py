@@ -347,6 +347,39 @@ def test_label_default_dtype():
     ndimage.find_objects(label)
 
 
+def test_label_workers():
+    np.random.seed(1234)
+    for shape, p in [((3000,), 0.5), ((400, 500), 0.45), ((40, 50, 60), 0.3)]:
+        data = np.random.rand(*shape) < p
+        for connectivity in range(1, len(shape) + 1):
+            s = ndimage.generate_binary_structure(len(shape), connectivity)
+            expected, n = ndimage.label(data, s)
+            for workers in [2, 7, -1]:
+                labels, m = ndimage.label(data, s, workers=workers)
+                assert_equal(m, n)
+                assert_array_equal(labels, expected)
+            output = np.empty(shape, np.int64)
+            assert_equal(ndimage.label(data.astype(np.float32), s, output,
+                                       workers=3), n)
+            assert_array_equal(output, expected)
+    # labeled in place
+    expected, n = ndimage.label(data)
+    output = data.astype(np.int32)
+    assert_equal(ndimage.label(output, output=output, workers=3), n)
+    assert_array_equal(output, expected)
+
+
+def test_label_structuring_elements_workers():
+    data = np.loadtxt(os.path.join(os.path.dirname(__file__), "data", "label_inputs.txt"))
+    strels = np.loadtxt(os.path.join(os.path.dirname(__file__), "data", "label_strels.txt"))
+    data = data.reshape((-1, 7, 7))
+    strels = strels.reshape((-1, 3, 3))
+    for d in data:
+        for s in strels:
+            assert_equal(ndimage.label(d, s, workers=2),
+                         ndimage.label(d, s))
+
+
 def test_find_objects01():
     data = np.ones([], dtype=int)
     out = ndimage.find_objects(data)
@@ -1056,6 +1089,64 @@ def test_center_of_mass09():
     assert_array_almost_equal(output, expected)
 
 
+def test_labeled_statistics():
+    np.random.seed(1234)
+    data = np.random.randn(60, 70)
+    labels = np.random.randint(0, 50, data.shape)
+    names = ['count', 'sum', 'mean', 'variance', 'standard_deviation',
+             'minimum', 'maximum', 'center_of_mass', 'bounding_box']
+    for index in [np.arange(50), [3, 7, 7, 1], 12, None]:
+        for workers in [1, 3]:
+            stats = ndimage.labeled_statistics(data, labels, index, names,
+                                               workers=workers)
+            assert_array_almost_equal(stats['sum'],
+                                      ndimage.sum(data, labels, index))
+            for name, func in [('mean', ndimage.mean),
+                               ('variance', ndimage.variance),
+                               ('standard_deviation',
+                                ndimage.standard_deviation),
+                               ('minimum', ndimage.minimum),
+                               ('maximum', ndimage.maximum)]:
+                assert_array_almost_equal(stats[name],
+                                          func(data, labels, index))
+            if index is not None and np.ndim(index):
+                assert_array_almost_equal(
+                    stats['center_of_mass'][:3],
+                    ndimage.center_of_mass(data, labels, index[:3]))
+    # the bounding boxes are those of find_objects
+    stats = ndimage.labeled_statistics(data, labels, np.arange(1, 50),
+                                       'bounding_box', workers=-1)
+    for box, slices in zip(stats['bounding_box'],
+                           ndimage.find_objects(labels)):
+        assert_equal(box, [[sl.start for sl in slices],
+                           [sl.stop for sl in slices]])
+
+
+def test_labeled_statistics_no_labels():
+    data = np.arange(12.).reshape(3, 4)
+    stats = ndimage.labeled_statistics(data, statistics=['count', 'mean',
+                                                         'center_of_mass'])
+    assert_equal(stats['count'], 12)
+    assert_almost_equal(stats['mean'], 5.5)
+    assert_array_almost_equal(stats['center_of_mass'],
+                              ndimage.center_of_mass(data))
+    # labels that are not integers, and sparse ones
+    for labels in [np.array([[0.5, 1.5, 0.5, 2.5]] * 3),
+                   np.array([[0, 10**12, 0, 3]] * 3)]:
+        index = np.unique(labels)
+        stats = ndimage.labeled_statistics(data, labels, index, 'sum')
+        assert_array_almost_equal(stats['sum'],
+                                  ndimage.sum(data, labels, index))
+    # a region without elements
+    stats = ndimage.labeled_statistics(data, labels, [0, 7],
+                                       ['count', 'sum', 'minimum'])
+    assert_equal(stats['count'], [6, 0])
+    assert_array_almost_equal(stats['sum'], [30, 0])
+    assert_equal(stats['minimum'], [0, np.nan])
+    assert_raises(ValueError, ndimage.labeled_statistics, data,
+                  statistics='median')
+
+
 def test_histogram01():
     expected = np.ones(10)
     input = np.arange(10)
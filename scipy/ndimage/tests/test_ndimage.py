@@ -477,6 +477,28 @@ class TestNdimage:
         output2 = ndimage.gaussian_filter(input, 1.0, output=otype)
         assert_array_almost_equal(output1, output2)
 
+    @pytest.mark.parametrize('mode', ['reflect', 'constant', 'nearest',
+                                      'mirror', 'wrap'])
+    def test_filters_chunked(self, mode):
+        array = numpy.random.RandomState(0).rand(50, 20)
+        weights = numpy.random.RandomState(1).rand(4, 3)
+        filters = [
+            lambda a, **kw: ndimage.gaussian_filter(a, 1.5, order=[1, 0],
+                                                    mode=mode, cval=2.0,
+                                                    **kw),
+            lambda a, **kw: ndimage.uniform_filter(a, [5, 3], mode=mode,
+                                                   origin=[1, 0], **kw),
+            lambda a, **kw: ndimage.correlate(a, weights, mode=mode,
+                                              cval=2.0, origin=[-1, 0],
+                                              **kw),
+            lambda a, **kw: ndimage.convolve(a, weights, mode=mode, **kw),
+        ]
+        for filter_ in filters:
+            expected = filter_(array)
+            for chunk_size in [1, 7, 25, 50]:
+                output = filter_(array, chunk_size=chunk_size)
+                assert_array_almost_equal(output, expected)
+
     def test_prewitt01(self):
         for type_ in self.types:
             array = numpy.array([[3, 2, 5, 1, 4],
@@ -1335,6 +1357,30 @@ class TestNdimage:
                 a = fft.ifft(a, shape[0], 0)
                 assert_almost_equal(ndimage.sum(a.real), 1.0, decimal=dec)
 
+    def test_fourier_shift_separable(self):
+        # the phase of each element is a product of phases along each axis
+        shape = (6, 7, 5)
+        shift = [1.5, -2.25, 0.75]
+        a = numpy.random.RandomState(0).rand(*shape) + 1j
+        freqs = numpy.meshgrid(*[fft.fftfreq(n) for n in shape],
+                               indexing='ij')
+        phase = sum(-2 * numpy.pi * s * f for s, f in zip(shift, freqs))
+        assert_array_almost_equal(ndimage.fourier_shift(a, shift),
+                                  a * numpy.exp(1j * phase), decimal=13)
+
+    def test_fourier_workers(self):
+        a = numpy.random.RandomState(0).rand(100, 60, 50)
+        a = fft.rfftn(a, axes=(0, 1, 2))
+        for filter_, arg in [(ndimage.fourier_gaussian, [2.0, 1.0, 3.0]),
+                             (ndimage.fourier_uniform, [3.0, 2.0, 1.0]),
+                             (ndimage.fourier_ellipsoid, [3.0, 2.0, 1.0]),
+                             (ndimage.fourier_shift, [1.5, 2.5, -0.5])]:
+            expected = filter_(a, arg, 50, 2)
+            for workers in [2, -1]:
+                assert_array_almost_equal(filter_(a, arg, 50, 2,
+                                                  workers=workers),
+                                          expected, decimal=14)
+
     def test_spline01(self):
         for type_ in self.types:
             data = numpy.ones([], type_)
@@ -2155,6 +2201,49 @@ class TestNdimage:
         out = ndimage.zoom(arr, zoom)
         assert_array_equal(out.shape, (4, 15, 29))
 
+    @pytest.mark.parametrize('order', [0, 1, 3])
+    @pytest.mark.parametrize('mode', ['constant', 'nearest', 'reflect',
+                                      'wrap'])
+    def test_interpolation_workers(self, order, mode):
+        numpy.random.seed(1234)
+        data = numpy.random.randn(130, 170)
+        matrix = numpy.array([[0.9, 0.2], [-0.3, 1.1]])
+        offset = [3.5, -7.25]
+        coords = numpy.indices((150, 160), dtype=numpy.float64)
+        coords = numpy.tensordot(matrix, coords, 1)
+        coords += numpy.reshape(offset, (2, 1, 1))
+        calls = [
+            (ndimage.zoom, (data, (1.7, 0.6))),
+            (ndimage.shift, (data, (2.3, -4.6))),
+            (ndimage.affine_transform, (data, matrix, offset, (150, 160))),
+            (ndimage.map_coordinates, (data, coords)),
+        ]
+        for func, args in calls:
+            expected = func(*args, order=order, mode=mode)
+            for workers in [3, -1]:
+                assert_array_equal(func(*args, order=order, mode=mode,
+                                        workers=workers), expected)
+        # the affine transform is the map of its coordinates, where both
+        # are continuous in them
+        if order > 0 and mode == 'nearest':
+            assert_array_almost_equal(
+                ndimage.affine_transform(data, matrix, offset, (150, 160),
+                                         order=order, mode=mode, workers=3),
+                ndimage.map_coordinates(data, coords, order=order,
+                                        mode=mode))
+
+    @pytest.mark.parametrize('order', range(2, 6))
+    def test_interpolation_single_precision(self, order):
+        numpy.random.seed(1234)
+        data = numpy.random.randn(40, 50).astype(numpy.float32)
+        for func, arg in [(ndimage.zoom, (1.7, 0.6)),
+                          (ndimage.shift, (2.3, -4.6))]:
+            expected = func(data, arg, order=order)
+            actual = func(data, arg, order=order, precision='single')
+            assert_equal(actual.dtype, numpy.float32)
+            assert_array_almost_equal(actual, expected, decimal=4)
+        assert_raises(ValueError, ndimage.zoom, data, 2, precision='half')
+
     def test_rotate01(self):
         data = numpy.array([[0, 0, 0, 0],
                             [0, 1, 1, 0],
@@ -2489,6 +2578,57 @@ class TestNdimage:
                     [-1, -1, -1, -1, -1, -1, -1]]
         assert_array_almost_equal(out, expected)
 
+    def test_watershed_ift08(self):
+        # costs above 255 of 16 bit inputs must not wrap around
+        data = numpy.array([[0, 256, 0, 0, 0, 300, 290, 0]], numpy.uint16)
+        markers = numpy.array([[1, 0, 0, 0, 0, 0, 0, 2]], numpy.int8)
+        out = ndimage.watershed_ift(data, markers)
+        expected = [[1, 1, 1, 1, 1, 2, 2, 2]]
+        assert_array_equal(out, expected)
+
+    def test_watershed_ift09(self):
+        # floating point inputs are quantized
+        data = numpy.array([[0, 0, 0, 0, 0, 0, 0],
+                            [0, 1, 1, 1, 1, 1, 0],
+                            [0, 1, 0, 1, 0, 1, 0],
+                            [0, 1, 0, 1, 0, 1, 0],
+                            [0, 1, 0, 1, 0, 1, 0],
+                            [0, 1, 1, 1, 1, 1, 0],
+                            [0, 0, 0, 0, 0, 0, 0]], numpy.uint8)
+        markers = numpy.array([[0, 0, 0, 0, 0, 0, 0],
+                               [0, 0, 0, 0, 0, 0, 0],
+                               [0, 0, 0, 0, 0, 0, 0],
+                               [0, 0, 2, 0, 3, 0, 0],
+                               [0, 0, 0, 0, 0, 0, 0],
+                               [0, 0, 0, 0, 0, 0, 0],
+                               [0, 0, 0, 0, 0, 0, -1]], numpy.int8)
+        expected = ndimage.watershed_ift(data, markers)
+        for type_ in [numpy.float32, numpy.float64]:
+            out = ndimage.watershed_ift(data.astype(type_) * 0.3 - 2,
+                                        markers)
+            assert_array_equal(out, expected)
+        assert_raises(ValueError, ndimage.watershed_ift,
+                      data.astype(numpy.float64) * numpy.inf, markers)
+
+    def test_watershed_ift_workers(self):
+        # the top left basin lies in the first slab only, the right basin
+        # crosses into it from the second
+        data = numpy.zeros((600, 300), numpy.uint8)
+        data[300, :200] = 10
+        data[:, 200] = 20
+        markers = numpy.zeros(data.shape, numpy.int16)
+        markers[100, 150] = 1
+        markers[500, 150] = 2
+        markers[550, 250] = -1
+        expected = numpy.empty(data.shape, numpy.int16)
+        expected[:300, :200] = 1
+        expected[300:, :200] = 2
+        expected[:, 200:] = -1
+        valleys = data == 0
+        for workers in [1, 2, 3]:
+            out = ndimage.watershed_ift(data, markers, workers=workers)
+            assert_array_equal(out[valleys], expected[valleys])
+
     def test_distance_transform_bf01(self):
         # brute force (bf) distance transform
         for type_ in self.types:
@@ -2991,6 +3131,32 @@ class TestNdimage:
         out = ndimage.distance_transform_edt(False)
         assert_array_almost_equal(out, [0.])
 
+    @pytest.mark.parametrize('sampling', [None, [1.5, 0.7, 2]])
+    def test_distance_transform_edt_workers(self, sampling):
+        numpy.random.seed(1234)
+        data = numpy.random.rand(50, 60, 70) > 0.02
+        ref, ft = ndimage.distance_transform_edt(data, sampling=sampling,
+                                                 return_indices=True)
+        for workers in [1, 3, -1]:
+            assert_array_equal(
+                ndimage.distance_transform_edt(data, sampling=sampling,
+                                               return_indices=True,
+                                               workers=workers)[1], ft)
+            out = ndimage.distance_transform_edt(data, sampling=sampling,
+                                                 workers=workers)
+            assert_array_almost_equal(out, ref)
+        out = numpy.empty(data.shape, numpy.float32)
+        assert_equal(ndimage.distance_transform_edt(data, sampling=sampling,
+                                                    distances=out,
+                                                    workers=3), None)
+        assert_array_almost_equal(out, ref, decimal=5)
+
+    def test_distance_transform_edt_no_background(self):
+        data = numpy.ones((3, 4))
+        ref = ndimage.distance_transform_edt(data, return_indices=True)[0]
+        out = ndimage.distance_transform_edt(data)
+        assert_array_almost_equal(out, ref)
+
     def test_generate_structure01(self):
         struct = ndimage.generate_binary_structure(0, 1)
         assert_array_almost_equal(struct, 1)
@@ -4249,6 +4415,31 @@ class TestNdimage:
             out = ndimage.binary_closing(data, struct)
             assert_array_almost_equal(out, expected)
 
+    def test_binary_morphology_workers(self):
+        # packed along the longer first axis, in rows of three words with
+        # a ragged last word; the iterated erosions track changed elements
+        # on a single thread and run bit-packed on several
+        numpy.random.seed(3)
+        data = numpy.random.random((150, 131)) > 0.2
+        struct = ndimage.generate_binary_structure(2, 2)
+        mask = numpy.random.random(data.shape) > 0.1
+        for func in [ndimage.binary_erosion, ndimage.binary_dilation]:
+            for iterations in [1, 3, 0]:
+                expected = func(data, struct, iterations, mask)
+                for workers in [2, 4]:
+                    out = func(data, struct, iterations, mask,
+                               workers=workers)
+                    assert_array_equal(out, expected)
+                out = func(data, struct, iterations, mask, brute_force=True)
+                assert_array_equal(out, expected)
+        for func in [ndimage.binary_opening, ndimage.binary_closing]:
+            expected = func(data, struct, 2, origin=(0, 1))
+            out = func(data, struct, 2, origin=(0, 1), workers=3)
+            assert_array_equal(out, expected)
+        # packed along the last axis
+        out = ndimage.binary_erosion(data.T.copy(), workers=2)
+        assert_array_equal(out, ndimage.binary_erosion(data).T)
+
     def test_binary_fill_holes01(self):
         expected = numpy.array([[0, 0, 0, 0, 0, 0, 0, 0],
                                 [0, 0, 1, 1, 1, 1, 0, 0],
@@ -17,6 +17,7 @@ Package Content
    ODR           -- Gathers all info & manages the main fitting routine.
    Output        -- Result from the fit.
    odr           -- Low-level function for ODR.
+   odr_batch     -- ODR of a batch of independent datasets.
 
    OdrWarning    -- Warning about potential problems when running ODR
    OdrError      -- Error exception.
@@ -69,6 +70,11 @@ covariances between dimensions of the variables.
 The `scipy.odr` package offers an object-oriented interface to
 ODRPACK, in addition to the low-level `odr` function.
 
+The fitting functions can also be written in C and passed as
+`scipy.LowLevelCallable` objects (see `Model`). ODRPACK then runs without
+the GIL, and `odr_batch` fits many independent datasets on several
+threads.
+
 Additional background information about ODRPACK can be found in the
 `ODRPACK User's Guide
 <https://docs.scipy.org/doc/external/odrpack_guide.pdf>`_, reading
@@ -37,7 +37,145 @@ void F_FUNC(dlunc,DLUNC)(int *lun);
 
 
 
-/* callback to pass to DODRC; calls the Python function in the global structure |odr_global| */
+/* signature of the model functions given as LowLevelCallables */
+static ccallback_signature_t odr_signatures[] = {
+  {"int (int, int, int, int, double *, double *, double *, void *)", 0},
+  {NULL}
+};
+
+
+/* releases the callbacks set up by prepare_callbacks */
+static void release_callbacks(ODR_callbacks * callbacks)
+{
+  if (callbacks->have_fjacd)
+    {
+      ccallback_release(&callbacks->fjacd);
+    }
+  if (callbacks->have_fjacb)
+    {
+      ccallback_release(&callbacks->fjacb);
+    }
+  ccallback_release(&callbacks->fcn);
+}
+
+
+/* sets up the model functions of a fit, with fcn as the thread-local
+   callback; returns 1 if they are LowLevelCallables, 0 if they are Python
+   functions and -1 with an exception set on failure */
+static int prepare_callbacks(ODR_callbacks * callbacks, PyObject * fcn,
+                             PyObject * fjacb, PyObject * fjacd,
+                             PyObject * extra_args)
+{
+  int lowlevel;
+
+  callbacks->have_fjacb = callbacks->have_fjacd = 0;
+
+  if (ccallback_prepare(&callbacks->fcn, odr_signatures, fcn,
+                        CCALLBACK_OBTAIN) != 0)
+    {
+      return -1;
+    }
+  callbacks->fcn.info_p = (void *)callbacks;
+  lowlevel = (callbacks->fcn.c_function != NULL);
+
+  if (fjacb != NULL)
+    {
+      if (ccallback_prepare(&callbacks->fjacb, odr_signatures, fjacb,
+                            CCALLBACK_DEFAULTS) != 0)
+        {
+          goto fail;
+        }
+      callbacks->have_fjacb = 1;
+      if ((callbacks->fjacb.c_function != NULL) != lowlevel)
+        {
+          goto mixed;
+        }
+    }
+  if (fjacd != NULL)
+    {
+      if (ccallback_prepare(&callbacks->fjacd, odr_signatures, fjacd,
+                            CCALLBACK_DEFAULTS) != 0)
+        {
+          goto fail;
+        }
+      callbacks->have_fjacd = 1;
+      if ((callbacks->fjacd.c_function != NULL) != lowlevel)
+        {
+          goto mixed;
+        }
+    }
+
+  if (lowlevel && extra_args != NULL)
+    {
+      PyErr_SetString(PyExc_ValueError,
+                      "extra_args cannot be used with LowLevelCallable "
+                      "model functions; pass the data as user_data");
+      goto fail;
+    }
+
+  return lowlevel;
+
+mixed:
+  PyErr_SetString(PyExc_ValueError,
+                  "fcn, fjacb and fjacd must either all be LowLevelCallables "
+                  "or all be Python functions");
+fail:
+  release_callbacks(callbacks);
+  return -1;
+}
+
+
+/* evaluates the LowLevelCallable model functions for DODRC; the value
+   returned by a function is passed on as ISTOP */
+static void fcn_ccallback(ODR_callbacks * callbacks, int *n, int *m,
+                          int *np, int *nq, double *beta, double *xplusd,
+                          int *ideval, double *f, double *fjacb,
+                          double *fjacd, int *istop)
+{
+  odr_model_func *func;
+  int ret = 0;
+
+  if ((*ideval % 10) >= 1)
+    {
+      func = (odr_model_func *) callbacks->fcn.c_function;
+      ret = func(*n, *m, *np, *nq, beta, xplusd, f,
+                 callbacks->fcn.user_data);
+    }
+
+  if (ret == 0 && ((*ideval) / 10) % 10 >= 1)
+    {
+      if (!callbacks->have_fjacb)
+        {
+          ret = -1;
+        }
+      else
+        {
+          func = (odr_model_func *) callbacks->fjacb.c_function;
+          ret = func(*n, *m, *np, *nq, beta, xplusd, fjacb,
+                     callbacks->fjacb.user_data);
+        }
+    }
+
+  if (ret == 0 && ((*ideval) / 100) % 10 >= 1)
+    {
+      if (!callbacks->have_fjacd)
+        {
+          ret = -1;
+        }
+      else
+        {
+          func = (odr_model_func *) callbacks->fjacd.c_function;
+          ret = func(*n, *m, *np, *nq, beta, xplusd, fjacd,
+                     callbacks->fjacd.user_data);
+        }
+    }
+
+  *istop = ret;
+}
+
+
+/* callback to pass to DODRC; calls the LowLevelCallables of the thread-local
+   callback, or the Python function in the global structure |odr_global| */
 void fcn_callback(int *n, int *m, int *np, int *nq, int *ldn, int *ldm,
                   int *ldnp, double *beta, double *xplusd, int *ifixb,
                   int *ifixx, int *ldfix, int *ideval, double *f,
@@ -48,6 +186,14 @@ void fcn_callback(int *n, int *m, int *np, int *nq, int *ldn, int *ldm,
   PyArrayObject *result_array = NULL;
   PyArrayObject *pyXplusD;
   void *beta_dst;
+  ccallback_t *callback = ccallback_obtain();
+
+  if (callback->c_function != NULL)
+    {
+      fcn_ccallback((ODR_callbacks *) callback->info_p, n, m, np, nq, beta,
+                    xplusd, ideval, f, fjacb, fjacd, istop);
+      return;
+    }
 
   arg01 = PyTuple_New(2);
 
@@ -285,7 +431,7 @@ PyObject *gen_output(int n, int m, int np, int nq, int ldwe, int ld2we,
 
   npy_intp dim1[1], dim2[2];
 
-  if (info == 50005) {
+  if (info == 50005 && PyErr_Occurred()) {
       /* fatal error in fcn call; return NULL to propagate the exception */
 
       return NULL;
@@ -493,6 +639,9 @@ PyObject *odr(PyObject * self, PyObject * args, PyObject * kwds)
   PyObject *result;
   npy_intp dim1[1], dim2[2], dim3[3];
   int implicit;                 /* flag for implicit model */
+  ODR_callbacks callbacks;
+  int lowlevel;
+  PyThreadState *thread_state = NULL;
 
 
   if (kwds == NULL)
@@ -527,7 +676,8 @@ PyObject *odr(PyObject * self, PyObject * args, PyObject * kwds)
 
   /* Check the validity of all arguments */
 
-  if (!PyCallable_Check(fcn))
+  /* LowLevelCallables are tuples; their contents are checked later */
+  if (!PyCallable_Check(fcn) && !PyTuple_Check(fcn))
     {
       PYERR(PyExc_TypeError, "fcn must be callable");
     }
@@ -563,11 +713,11 @@ PyObject *odr(PyObject * self, PyObject * args, PyObject * kwds)
     {
       PYERR(PyExc_TypeError, "wd must be a sequence or a number");
     }
-  if (fjacb != NULL && !PyCallable_Check(fjacb))
+  if (fjacb != NULL && !PyCallable_Check(fjacb) && !PyTuple_Check(fjacb))
     {
       PYERR(PyExc_TypeError, "fjacb must be callable");
     }
-  if (fjacd != NULL && !PyCallable_Check(fjacd))
+  if (fjacd != NULL && !PyCallable_Check(fjacd) && !PyTuple_Check(fjacd))
     {
       PYERR(PyExc_TypeError, "fjacd must be callable");
     }
@@ -1159,6 +1309,13 @@ PyObject *odr(PyObject * self, PyObject * args, PyObject * kwds)
         }
     }
 
+  /* set up the model functions; LowLevelCallables run without the GIL */
+  lowlevel = prepare_callbacks(&callbacks, fcn, fjacb, fjacd, extra_args);
+  if (lowlevel < 0)
+    {
+      goto fail;
+    }
+
   /* setup the global data for the callback */
   odr_global.fcn = fcn;
   Py_INCREF(fcn);
@@ -1172,6 +1329,10 @@ PyObject *odr(PyObject * self, PyObject * args, PyObject * kwds)
   Py_XINCREF(extra_args);
 
   /* now call DODRC */
+  if (lowlevel)
+    {
+      thread_state = PyEval_SaveThread();
+    }
   F_FUNC(dodrc,DODRC)(fcn_callback, &n, &m, &np, &nq, (double *)(beta->data),
         (double *)(y->data), &ldy, (double *)(x->data), &ldx,
         (double *)(we->data), &ldwe, &ld2we,
@@ -1183,6 +1344,11 @@ PyObject *odr(PyObject * self, PyObject * args, PyObject * kwds)
         (double *)(sclb->data), (double *)(scld->data), &ldscld,
         (double *)(work->data), &lwork, (int *)(iwork->data), &liwork,
         &info);
+  if (lowlevel)
+    {
+      PyEval_RestoreThread(thread_state);
+    }
+  release_callbacks(&callbacks);
 
   result = gen_output(n, m, np, nq, ldwe, ld2we,
                       beta, work, iwork, isodr, info, full_output);
@@ -1254,6 +1420,418 @@ fail:
 }
 
 
+/* independent fits of datasets of the same sizes, shared between threads */
+typedef struct {
+  int n, m, np, nq, ldy, ldx, ldwe, ld2we, ldwd, ld2wd, ldifx;
+  int job, ndigit, maxit, lwork, liwork;
+  double taufac, sstol, partol;
+  double *beta, *y, *x, *we, *wd;
+  npy_intp y_step, we_step, wd_step;
+  int *ifixb, *ifixx;
+  double *stpb, *stpd, *sclb, *scld;
+  /* the outputs, and their C indices in the work array */
+  double *sd_beta, *cov_beta, *delta, *eps, *xplus, *fn;
+  double *res_var, *sum_square, *sum_square_delta, *sum_square_eps;
+  double *inv_condnum, *rel_error;
+  int *info;
+  int sd, vcv, idelta, ieps, ixplus, ifn, rvar, wss, wssde, wssep;
+  int rcond, eta;
+  npy_intp nfits, next;
+  int failed;
+  zeros_mutex lock;
+} ODR_batch;
+
+
+/* claims fits from the batch and runs them with work arrays of its own;
+   ODRPACK keeps no state between calls, so fits can run concurrently */
+static void batch_worker(void *arg)
+{
+  ODR_batch *b = (ODR_batch *) arg;
+  int n = b->n, m = b->m, np = b->np, nq = b->nq;
+  int ldy = b->ldy, ldx = b->ldx, ldwe = b->ldwe, ld2we = b->ld2we;
+  int ldwd = b->ldwd, ld2wd = b->ld2wd, ldifx = b->ldifx;
+  int job = b->job, ndigit = b->ndigit, maxit = b->maxit;
+  int lwork = b->lwork, liwork = b->liwork;
+  double taufac = b->taufac, sstol = b->sstol, partol = b->partol;
+  int iprint = 0, lunerr = 0, lunrpt = 0, ldstpd = 1, ldscld = 1, info;
+  double *work;
+  int *iwork;
+  npy_intp i;
+
+  work = (double *)malloc(lwork * sizeof(double));
+  iwork = (int *)malloc(liwork * sizeof(int));
+  if (work == NULL || iwork == NULL)
+    {
+      zeros_mutex_lock(&b->lock);
+      b->failed = 1;
+      zeros_mutex_unlock(&b->lock);
+      free(work);
+      free(iwork);
+      return;
+    }
+
+  for (;;)
+    {
+      zeros_mutex_lock(&b->lock);
+      if (b->failed || b->next >= b->nfits)
+        {
+          zeros_mutex_unlock(&b->lock);
+          break;
+        }
+      i = b->next++;
+      zeros_mutex_unlock(&b->lock);
+
+      info = 0;
+      F_FUNC(dodrc,DODRC)(fcn_callback, &n, &m, &np, &nq, b->beta + i * np,
+            b->y + i * b->y_step, &ldy, b->x + i * m * n, &ldx,
+            b->we + i * b->we_step, &ldwe, &ld2we,
+            b->wd + i * b->wd_step, &ldwd, &ld2wd,
+            b->ifixb, b->ifixx, &ldifx,
+            &job, &ndigit, &taufac, &sstol, &partol, &maxit,
+            &iprint, &lunerr, &lunrpt,
+            b->stpb, b->stpd, &ldstpd, b->sclb, b->scld, &ldscld,
+            work, &lwork, iwork, &liwork, &info);
+
+      memcpy(b->sd_beta + i * np, work + b->sd, np * sizeof(double));
+      memcpy(b->cov_beta + i * np * np, work + b->vcv,
+             np * np * sizeof(double));
+      memcpy(b->delta + i * m * n, work + b->idelta, m * n * sizeof(double));
+      memcpy(b->eps + i * nq * n, work + b->ieps, nq * n * sizeof(double));
+      memcpy(b->xplus + i * m * n, work + b->ixplus, m * n * sizeof(double));
+      memcpy(b->fn + i * nq * n, work + b->ifn, nq * n * sizeof(double));
+
+      b->res_var[i] = work[b->rvar];
+      b->sum_square[i] = work[b->wss];
+      b->sum_square_delta[i] = work[b->wssde];
+      b->sum_square_eps[i] = work[b->wssep];
+      b->inv_condnum[i] = work[b->rcond];
+      b->rel_error[i] = work[b->eta];
+      b->info[i] = info;
+    }
+
+  free(work);
+  free(iwork);
+}
+
+
+/* fits LowLevelCallable models to a batch of datasets on several threads;
+   the arguments are normalized by scipy.odr.odr_batch */
+PyObject *odr_batch(PyObject * self, PyObject * args)
+{
+  PyObject *fcn, *pbeta, *py, *px, *pwe, *pwd, *fjacb, *fjacd;
+  PyObject *pifixb, *pifixx, *result = NULL;
+  PyArrayObject *beta = NULL, *y = NULL, *x = NULL, *we = NULL, *wd = NULL;
+  PyArrayObject *ifixb = NULL, *ifixx = NULL;
+  PyArrayObject *sd_beta = NULL, *cov_beta = NULL, *deltaA = NULL;
+  PyArrayObject *epsA = NULL, *xplusA = NULL, *fnA = NULL;
+  PyArrayObject *res_var = NULL, *sum_square = NULL;
+  PyArrayObject *sum_square_delta = NULL, *sum_square_eps = NULL;
+  PyArrayObject *inv_condnum = NULL, *rel_error = NULL, *infoA = NULL;
+  double *stpb = NULL, *stpd = NULL, *sclb = NULL, *scld = NULL;
+  int n, m, np, nq, job, ndigit, maxit, workers, isodr, lwkmn;
+  int ind[37];
+  double taufac, sstol, partol;
+  npy_intp nfits, dim1[1], dim2[2], dim3[3];
+  ODR_callbacks callbacks;
+  ODR_batch b;
+  int lowlevel;
+
+  if (!PyArg_ParseTuple(args, "OOOOiOOOOOOiidddii:_odr_batch",
+                        &fcn, &pbeta, &py, &px, &nq, &pwe, &pwd,
+                        &fjacb, &fjacd, &pifixb, &pifixx, &job, &ndigit,
+                        &taufac, &sstol, &partol, &maxit, &workers))
+    {
+      return NULL;
+    }
+  if (fjacb == Py_None)
+    {
+      fjacb = NULL;
+    }
+  if (fjacd == Py_None)
+    {
+      fjacd = NULL;
+    }
+
+  if ((beta = (PyArrayObject *) PyArray_FROMANY(pbeta, NPY_DOUBLE, 2, 2,
+                                                NPY_ARRAY_CARRAY |
+                                                NPY_ARRAY_ENSURECOPY)) == NULL
+      || (x = (PyArrayObject *) PyArray_FROMANY(px, NPY_DOUBLE, 3, 3,
+                                                NPY_ARRAY_IN_ARRAY)) == NULL
+      || (we = (PyArrayObject *) PyArray_FROMANY(pwe, NPY_DOUBLE, 4, 4,
+                                                 NPY_ARRAY_IN_ARRAY)) == NULL
+      || (wd = (PyArrayObject *) PyArray_FROMANY(pwd, NPY_DOUBLE, 4, 4,
+                                                 NPY_ARRAY_IN_ARRAY)) == NULL
+      || (ifixb = (PyArrayObject *) PyArray_FROMANY(pifixb, NPY_INT, 1, 1,
+                                                    NPY_ARRAY_IN_ARRAY)) == NULL
+      || (ifixx = (PyArrayObject *) PyArray_FROMANY(pifixx, NPY_INT, 2, 2,
+                                                    NPY_ARRAY_IN_ARRAY)) == NULL)
+    {
+      goto fail;
+    }
+
+  nfits = beta->dimensions[0];
+  np = beta->dimensions[1];
+  m = x->dimensions[1];
+  n = x->dimensions[2];
+  b.y_step = 0;
+  b.ldy = 1;
+
+  if (job % 10 == 1)
+    {
+      /* implicit model; y is never referenced */
+      dim1[0] = 1;
+      y = (PyArrayObject *) PyArray_SimpleNew(1, dim1, NPY_DOUBLE);
+      if (y == NULL)
+        {
+          goto fail;
+        }
+    }
+  else
+    {
+      if ((y = (PyArrayObject *) PyArray_FROMANY(py, NPY_DOUBLE, 3, 3,
+                                                 NPY_ARRAY_IN_ARRAY)) == NULL)
+        {
+          goto fail;
+        }
+      if (y->dimensions[0] != nfits || y->dimensions[1] != nq
+          || y->dimensions[2] != n)
+        {
+          PYERR(PyExc_ValueError, "y does not match the batch");
+        }
+      b.y_step = nq * n;
+      b.ldy = n;
+    }
+
+  if (x->dimensions[0] != nfits
+      || (we->dimensions[0] != 1 && we->dimensions[0] != nfits)
+      || we->dimensions[1] != nq
+      || (wd->dimensions[0] != 1 && wd->dimensions[0] != nfits)
+      || wd->dimensions[1] != m
+      || ifixb->dimensions[0] != np || ifixx->dimensions[0] != m)
+    {
+      PYERR(PyExc_ValueError, "x, we, wd, ifixb or ifixx do not match "
+            "the batch");
+    }
+
+  if ((job / 1000) % 100 >= 1)
+    {
+      PYERR(PyExc_ValueError,
+            "batch fits cannot be restarts or start from given deltas");
+    }
+  if ((job / 10) % 10 >= 2 && (fjacb == NULL || fjacd == NULL))
+    {
+      PYERR(PyExc_ValueError,
+            "need fjacb and fjacd to calculate derivatives");
+    }
+
+  b.n = n;
+  b.m = m;
+  b.np = np;
+  b.nq = nq;
+  b.ldx = n;
+  b.ld2we = we->dimensions[2];
+  b.ldwe = we->dimensions[3];
+  b.ld2wd = wd->dimensions[2];
+  b.ldwd = wd->dimensions[3];
+  b.ldifx = ifixx->dimensions[1];
+  b.we_step = (we->dimensions[0] == 1) ? 0 : nq * b.ld2we * b.ldwe;
+  b.wd_step = (wd->dimensions[0] == 1) ? 0 : m * b.ld2wd * b.ldwd;
+  b.job = job;
+  b.ndigit = ndigit;
+  b.maxit = maxit;
+  b.taufac = taufac;
+  b.sstol = sstol;
+  b.partol = partol;
+
+  if (job % 10 < 2)
+    {
+      /* ODR, not OLS */
+      b.lwork =
+        18 + 11 * np + np * np + m + m * m + 4 * n * nq + 6 * n * m +
+        2 * n * nq * np + 2 * n * nq * m + nq * nq + 5 * nq + nq * (np + m) +
+        b.ldwe * b.ld2we * nq;
+      isodr = 1;
+    }
+  else
+    {
+      /* OLS, not ODR */
+      b.lwork =
+        18 + 11 * np + np * np + m + m * m + 4 * n * nq + 2 * n * m +
+        2 * n * nq * np + 5 * nq + nq * (np + m) + b.ldwe * b.ld2we * nq;
+      isodr = 0;
+    }
+  b.liwork = 20 + np + nq * (np + m);
+
+  /* the default step sizes and scalings, shared by all fits */
+  stpb = (double *)calloc(np, sizeof(double));
+  sclb = (double *)calloc(np, sizeof(double));
+  stpd = (double *)calloc(m, sizeof(double));
+  scld = (double *)calloc(m, sizeof(double));
+  if (stpb == NULL || sclb == NULL || stpd == NULL || scld == NULL)
+    {
+      PyErr_NoMemory();
+      goto fail;
+    }
+
+  /* the outputs are at the same place in the work array of every fit */
+  lwkmn = b.lwork;
+  F_FUNC(dwinf,DWINF)(&n, &m, &np, &nq, &b.ldwe, &b.ld2we, &isodr,
+        &b.idelta, &b.ieps, &b.ixplus, &b.ifn, &b.sd, &b.vcv, &b.rvar,
+        &b.wss, &b.wssde, &b.wssep, &b.rcond, &b.eta, &ind[0], &ind[1],
+        &ind[2], &ind[3], &ind[4], &ind[5], &ind[6], &ind[7], &ind[8],
+        &ind[9], &ind[10], &ind[11], &ind[12], &ind[13], &ind[14],
+        &ind[15], &ind[16], &ind[17], &ind[18], &ind[19], &ind[20],
+        &ind[21], &ind[22], &ind[23], &ind[24], &ind[25], &ind[26],
+        &ind[27], &ind[28], &ind[29], &ind[30], &ind[31], &ind[32],
+        &ind[33], &ind[34], &ind[35], &ind[36], &lwkmn);
+
+  /* convert FORTRAN indices to C indices */
+  b.idelta--;
+  b.ieps--;
+  b.ixplus--;
+  b.ifn--;
+  b.sd--;
+  b.vcv--;
+  b.rvar--;
+  b.wss--;
+  b.wssde--;
+  b.wssep--;
+  b.rcond--;
+  b.eta--;
+
+  dim1[0] = nfits;
+  dim2[0] = nfits;
+  dim2[1] = np;
+  dim3[0] = nfits;
+  dim3[1] = np;
+  dim3[2] = np;
+  sd_beta = (PyArrayObject *) PyArray_SimpleNew(2, dim2, NPY_DOUBLE);
+  cov_beta = (PyArrayObject *) PyArray_SimpleNew(3, dim3, NPY_DOUBLE);
+  dim3[1] = m;
+  dim3[2] = n;
+  deltaA = (PyArrayObject *) PyArray_SimpleNew(3, dim3, NPY_DOUBLE);
+  xplusA = (PyArrayObject *) PyArray_SimpleNew(3, dim3, NPY_DOUBLE);
+  dim3[1] = nq;
+  epsA = (PyArrayObject *) PyArray_SimpleNew(3, dim3, NPY_DOUBLE);
+  fnA = (PyArrayObject *) PyArray_SimpleNew(3, dim3, NPY_DOUBLE);
+  res_var = (PyArrayObject *) PyArray_SimpleNew(1, dim1, NPY_DOUBLE);
+  sum_square = (PyArrayObject *) PyArray_SimpleNew(1, dim1, NPY_DOUBLE);
+  sum_square_delta =
+    (PyArrayObject *) PyArray_SimpleNew(1, dim1, NPY_DOUBLE);
+  sum_square_eps = (PyArrayObject *) PyArray_SimpleNew(1, dim1, NPY_DOUBLE);
+  inv_condnum = (PyArrayObject *) PyArray_SimpleNew(1, dim1, NPY_DOUBLE);
+  rel_error = (PyArrayObject *) PyArray_SimpleNew(1, dim1, NPY_DOUBLE);
+  infoA = (PyArrayObject *) PyArray_SimpleNew(1, dim1, NPY_INT);
+  if (sd_beta == NULL || cov_beta == NULL || deltaA == NULL
+      || xplusA == NULL || epsA == NULL || fnA == NULL || res_var == NULL
+      || sum_square == NULL || sum_square_delta == NULL
+      || sum_square_eps == NULL || inv_condnum == NULL || rel_error == NULL
+      || infoA == NULL)
+    {
+      goto fail;
+    }
+
+  b.beta = (double *)(beta->data);
+  b.y = (double *)(y->data);
+  b.x = (double *)(x->data);
+  b.we = (double *)(we->data);
+  b.wd = (double *)(wd->data);
+  b.ifixb = (int *)(ifixb->data);
+  b.ifixx = (int *)(ifixx->data);
+  b.stpb = stpb;
+  b.stpd = stpd;
+  b.sclb = sclb;
+  b.scld = scld;
+  b.sd_beta = (double *)(sd_beta->data);
+  b.cov_beta = (double *)(cov_beta->data);
+  b.delta = (double *)(deltaA->data);
+  b.eps = (double *)(epsA->data);
+  b.xplus = (double *)(xplusA->data);
+  b.fn = (double *)(fnA->data);
+  b.res_var = (double *)(res_var->data);
+  b.sum_square = (double *)(sum_square->data);
+  b.sum_square_delta = (double *)(sum_square_delta->data);
+  b.sum_square_eps = (double *)(sum_square_eps->data);
+  b.inv_condnum = (double *)(inv_condnum->data);
+  b.rel_error = (double *)(rel_error->data);
+  b.info = (int *)(infoA->data);
+  b.nfits = nfits;
+  b.next = 0;
+  b.failed = 0;
+
+  lowlevel = prepare_callbacks(&callbacks, fcn, fjacb, fjacd, NULL);
+  if (lowlevel < 0)
+    {
+      goto fail;
+    }
+  if (!lowlevel)
+    {
+      release_callbacks(&callbacks);
+      PYERR(PyExc_ValueError,
+            "batch fits need LowLevelCallable model functions");
+    }
+
+  if (workers > nfits)
+    {
+      workers = (nfits > 0) ? (int)nfits : 1;
+    }
+
+  zeros_mutex_init(&b.lock);
+  Py_BEGIN_ALLOW_THREADS
+  ccallback_pool_run(&callbacks.fcn, workers, batch_worker, &b);
+  Py_END_ALLOW_THREADS
+  zeros_mutex_destroy(&b.lock);
+  release_callbacks(&callbacks);
+
+  if (b.failed)
+    {
+      PyErr_NoMemory();
+      goto fail;
+    }
+
+  result =
+    Py_BuildValue
+    ("OOO{s:O,s:O,s:O,s:O,s:O,s:O,s:O,s:O,s:O,s:O,s:O}",
+     PyArray_Return(beta), PyArray_Return(sd_beta),
+     PyArray_Return(cov_beta), "delta", PyArray_Return(deltaA), "eps",
+     PyArray_Return(epsA), "xplus", PyArray_Return(xplusA), "y",
+     PyArray_Return(fnA), "res_var", PyArray_Return(res_var), "sum_square",
+     PyArray_Return(sum_square), "sum_square_delta",
+     PyArray_Return(sum_square_delta), "sum_square_eps",
+     PyArray_Return(sum_square_eps), "inv_condnum",
+     PyArray_Return(inv_condnum), "rel_error", PyArray_Return(rel_error),
+     "info", PyArray_Return(infoA));
+
+fail:
+  free(stpb);
+  free(stpd);
+  free(sclb);
+  free(scld);
+  Py_XDECREF(beta);
+  Py_XDECREF(y);
+  Py_XDECREF(x);
+  Py_XDECREF(we);
+  Py_XDECREF(wd);
+  Py_XDECREF(ifixb);
+  Py_XDECREF(ifixx);
+  Py_XDECREF(sd_beta);
+  Py_XDECREF(cov_beta);
+  Py_XDECREF(deltaA);
+  Py_XDECREF(epsA);
+  Py_XDECREF(xplusA);
+  Py_XDECREF(fnA);
+  Py_XDECREF(res_var);
+  Py_XDECREF(sum_square);
+  Py_XDECREF(sum_square_delta);
+  Py_XDECREF(sum_square_eps);
+  Py_XDECREF(inv_condnum);
+  Py_XDECREF(rel_error);
+  Py_XDECREF(infoA);
+
+  return result;
+}
+
+
 PyObject *set_exceptions(PyObject * self, PyObject * args, PyObject * kwds)
 {
     PyObject *exc_error, *exc_stop;
@@ -1273,6 +1851,7 @@ PyObject *set_exceptions(PyObject * self, PyObject * args, PyObject * kwds)
 static PyMethodDef methods[] = {
   {"_set_exceptions", (PyCFunction) set_exceptions, METH_VARARGS, NULL},
   {"odr", (PyCFunction) odr, METH_VARARGS | METH_KEYWORDS, NULL},
+  {"_odr_batch", (PyCFunction) odr_batch, METH_VARARGS, NULL},
   {NULL, NULL},
 };
 
@@ -19,6 +19,10 @@ add_newdoc('scipy.odr', 'odr',
     `Model` and `Data` classes together. The parameters of this
     function are explained in the class documentation.
 
+    The model functions `fcn`, `fjacb` and `fjacd` can be given as
+    `scipy.LowLevelCallable` objects, as described for `Model`; the fit
+    then runs without the GIL.
+
     """)
 
 add_newdoc('scipy.odr.__odrpack', '_set_exceptions',
@@ -28,3 +32,12 @@ add_newdoc('scipy.odr.__odrpack', '_set_exceptions',
     Internal function: set exception classes.
 
     """)
+
+add_newdoc('scipy.odr.__odrpack', '_odr_batch',
+    """
+    _odr_batch(fcn, beta0, y, x, q, we, wd, fjacb, fjacd, ifixb, ifixx, job, ndigit, taufac, sstol, partol, maxit, workers)
+
+    Internal function: fit LowLevelCallable models on threads; the
+    arguments are normalized by `odr_batch`.
+
+    """)
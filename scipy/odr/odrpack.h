@@ -3,6 +3,9 @@
 
 #include "numpy/npy_3kcompat.h"
 
+#include "ccallback_pool.h"
+#include "zeros_threads.h"
+
 #if defined(NO_APPEND_FORTRAN)
 #if defined(UPPERCASE_FORTRAN)
 #define F_FUNC(f,F) F
@@ -36,6 +39,21 @@ typedef struct ODR_info_ ODR_info;
 
 static ODR_info odr_global;
 
+/* Model functions given as LowLevelCallables; fcn is the thread-local
+   callback of the fit, with info_p pointing back to this structure */
+typedef int odr_model_func(int n, int m, int np, int nq, double *beta,
+                           double *x, double *out, void *user_data);
+
+struct ODR_callbacks_ {
+  ccallback_t fcn;
+  ccallback_t fjacb;
+  ccallback_t fjacd;
+  int have_fjacb;
+  int have_fjacd;
+};
+
+typedef struct ODR_callbacks_ ODR_callbacks;
+
 static PyObject *odr_error=NULL;
 static PyObject *odr_stop=NULL;
 
@@ -50,6 +68,8 @@ PyObject *gen_output(int n, int m, int np, int nq, int ldwe, int ld2we,
 
 PyObject *odr(PyObject *self, PyObject *args, PyObject *kwds);
 
+PyObject *odr_batch(PyObject *self, PyObject *args);
+
 #define PyArray_CONTIGUOUS(m) (ISCONTIGUOUS(m) ? Py_INCREF(m), m : \
 (PyArrayObject *)(PyArray_ContiguousFromObject((PyObject *)(m), \
 (m)->descr->type_num, 0,0)))
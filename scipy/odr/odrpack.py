@@ -38,11 +38,15 @@ robert.kern@gmail.com
 
 from __future__ import division, print_function, absolute_import
 
+import operator
+import os
+
 import numpy
 from warnings import warn
 from scipy.odr import __odrpack
+from scipy._lib._ccallback import LowLevelCallable
 
-__all__ = ['odr', 'OdrWarning', 'OdrError', 'OdrStop',
+__all__ = ['odr', 'odr_batch', 'OdrWarning', 'OdrError', 'OdrStop',
            'Data', 'RealData', 'Model', 'Output', 'ODR',
            'odr_error', 'odr_stop']
 
@@ -180,6 +184,229 @@ def _report_error(info):
         return [stopreason]
 
 
+def _check_workers(workers):
+    """Normalize a ``workers`` argument to a positive thread count.
+
+    ``None`` means a single thread, and negative values wrap around from
+    ``os.cpu_count()``, so that ``-1`` means all CPUs.
+    """
+    if workers is None:
+        return 1
+
+    workers = operator.index(workers)
+    if workers < 0:
+        cpu_count = os.cpu_count() or 1
+        if workers >= -cpu_count:
+            workers += 1 + cpu_count
+        else:
+            raise ValueError("workers value out of range; got {}, must not be"
+                             " less than {}".format(workers, -cpu_count))
+    elif workers == 0:
+        raise ValueError("workers must not be zero")
+    return workers
+
+
+def _batch_item(w, nfits, i, name):
+    """ The weights or fixed observations of the i'th fit of a batch.
+    """
+
+    if w is None or numpy.ndim(w) == 0:
+        return w
+    w = numpy.asarray(w)
+    if w.ndim < 2 or w.shape[0] not in (1, nfits):
+        raise ValueError("%s must be a scalar or have a leading axis of "
+                         "length 1 or %d" % (name, nfits))
+    return w[i] if w.shape[0] > 1 else w[0]
+
+
+def _batch_weights(w, nfits, d, n, name, sign):
+    """ The weights of a batch as an array of shape (1 or nfits, d, ld2, ld),
+    the layout of ODRPACK's WE and WD with leading dimensions ld and ld2. As
+    in `odr`, a scalar is passed in the first element, multiplied by `sign`,
+    and -1 there selects the default weights.
+    """
+
+    if w is None or numpy.ndim(w) == 0:
+        out = numpy.zeros((1, d, 1, 1))
+        out.flat[0] = -1.0 if w is None else sign * float(w)
+        return out
+
+    w = numpy.asarray(w, dtype=float)
+    if w.ndim < 2 or w.shape[0] not in (1, nfits):
+        raise ValueError("%s must be a scalar or have a leading axis of "
+                         "length 1 or %d" % (name, nfits))
+
+    shape = w.shape[1:]
+    if d == 1 and shape == (n,):
+        ld2, ld = 1, n
+    elif shape == (d,):
+        ld2, ld = 1, 1
+    elif shape in ((d, d), (d, d, 1)):
+        ld2, ld = d, 1
+    elif shape == (d, n):
+        ld2, ld = 1, n
+    elif shape == (d, d, n):
+        ld2, ld = d, n
+    else:
+        raise ValueError("could not convert %s to a suitable array" % name)
+    return numpy.ascontiguousarray(w.reshape(w.shape[0], d, ld2, ld))
+
+
+def odr_batch(fcn, beta0, y, x, we=None, wd=None, fjacb=None, fjacd=None,
+              extra_args=None, ifixx=None, ifixb=None, job=0, ndigit=0,
+              taufac=0.0, sstol=-1.0, partol=-1.0, maxit=-1, workers=None):
+    """
+    Fit a model to a batch of independent datasets.
+
+    Each of the ``k`` datasets is fitted as by `odr` with ``full_output=1``.
+    All of them have the same numbers of observations and of input and
+    response variables.
+
+    Parameters
+    ----------
+    fcn : callable or `scipy.LowLevelCallable`
+        The model function, as for `Model`.
+    beta0 : array_like
+        Initial parameter values, of shape ``(p,)`` for all fits or
+        ``(k, p)``.
+    y : array_like or int
+        Observed responses, of shape ``(k, n)`` or ``(k, q, n)``, or the
+        dimensionality ``q`` of the response of an implicit model.
+    x : array_like
+        Observed inputs, of shape ``(k, n)`` or ``(k, m, n)``.
+    we, wd : array_like, optional
+        Weights as for `Data`, either a scalar or an array with a leading
+        axis of length ``k``, or of length 1 to use the same weights for
+        all datasets.
+    fjacb, fjacd : callable or `scipy.LowLevelCallable`, optional
+        Jacobians of the model function, as for `Model`.
+    extra_args : tuple, optional
+        Extra arguments of Python model functions, as for `Model`.
+    ifixx, ifixb, job, ndigit, taufac, sstol, partol, maxit : optional
+        As for `ODR`; `ifixx` and `ifixb` apply to all fits. Restarts and
+        initial values of ``delta`` are not supported.
+    workers : int, optional
+        Number of threads running fits at once. If negative, the value
+        wraps around from ``os.cpu_count()``. Only used when the model
+        functions are `scipy.LowLevelCallable` objects; fits of Python
+        functions run one after the other. Default is 1.
+
+    Returns
+    -------
+    beta : ndarray
+        Estimated parameters, of shape ``(k, p)``.
+    sd_beta : ndarray
+        Their standard errors, of shape ``(k, p)``.
+    cov_beta : ndarray
+        Their covariance matrices, of shape ``(k, p, p)``.
+    output : dict
+        The other outputs of `odr`, ``delta``, ``eps``, ``xplus``, ``y``,
+        ``res_var``, ``sum_square``, ``sum_square_delta``,
+        ``sum_square_eps``, ``inv_condnum``, ``rel_error`` and ``info``,
+        each with a leading axis of length ``k``.
+
+    See Also
+    --------
+    odr, Model
+
+    Notes
+    -----
+    With `scipy.LowLevelCallable` model functions (see `Model`) the fits run
+    on `workers` threads without the GIL. A fit stopped by a negative return
+    value of the model functions is reported in its ``info``.
+
+    .. versionadded:: 1.4.0
+
+    """
+    workers = _check_workers(workers)
+    implicit = (job % 10 == 1)
+
+    x = numpy.asarray(x, dtype=float)
+    if x.ndim not in (2, 3):
+        raise ValueError("x must be of shape (k, n) or (k, m, n)")
+    nfits, n = x.shape[0], x.shape[-1]
+    m = 1 if x.ndim == 2 else x.shape[1]
+
+    if implicit:
+        q = operator.index(y)
+        y_shape = (nfits, n) if q == 1 else (nfits, q, n)
+    else:
+        y = numpy.asarray(y, dtype=float)
+        if (y.ndim not in (2, 3) or y.shape[0] != nfits
+                or y.shape[-1] != n):
+            raise ValueError("y must be of shape (k, n) or (k, q, n) "
+                             "matching x")
+        q = 1 if y.ndim == 2 else y.shape[1]
+        y_shape = y.shape
+
+    beta0 = numpy.asarray(beta0, dtype=float)
+    if beta0.ndim == 1:
+        beta0 = numpy.broadcast_to(beta0, (nfits, beta0.shape[0]))
+    elif beta0.ndim != 2 or beta0.shape[0] != nfits:
+        raise ValueError("beta0 must be of shape (p,) or (k, p)")
+    p = beta0.shape[1]
+
+    if job % 100000 // 1000 != 0:
+        raise ValueError("batch fits cannot be restarts or start from "
+                         "given deltas")
+
+    if not isinstance(fcn, LowLevelCallable):
+        # Python functions hold the GIL, so the fits run in turn
+        kwds = dict(fjacb=fjacb, fjacd=fjacd, extra_args=extra_args,
+                    ifixx=ifixx, ifixb=ifixb, job=job, ndigit=ndigit,
+                    taufac=taufac, sstol=sstol, partol=partol, maxit=maxit)
+        kwds = dict((k, v) for k, v in kwds.items() if v is not None)
+        fits = []
+        for i in range(nfits):
+            for name, w in (('we', we), ('wd', wd)):
+                w = _batch_item(w, nfits, i, name)
+                if w is not None:
+                    kwds[name] = w
+            fits.append(odr(fcn, beta0[i], q if implicit else y[i], x[i],
+                            full_output=1, **kwds))
+
+        output = dict((key, numpy.array([fit[3][key] for fit in fits]))
+                      for key in ('delta', 'eps', 'xplus', 'y', 'res_var',
+                                  'sum_square', 'sum_square_delta',
+                                  'sum_square_eps', 'inv_condnum',
+                                  'rel_error', 'info'))
+        beta, sd_beta, cov_beta = [
+            numpy.array([fit[j] for fit in fits]).reshape((nfits,) + shape)
+            for j, shape in ((0, (p,)), (1, (p,)), (2, (p, p)))]
+        return beta, sd_beta, cov_beta, output
+
+    if extra_args is not None:
+        raise ValueError("extra_args cannot be used with LowLevelCallable "
+                         "model functions; pass the data as user_data")
+
+    if ifixb is None:
+        ifixb = numpy.full(p, -1, dtype=numpy.intc)
+    if ifixx is None:
+        ifixx = numpy.full((m, 1), -1, dtype=numpy.intc)
+    else:
+        ifixx = numpy.asarray(ifixx, dtype=numpy.intc)
+        if ifixx.shape == (m,):
+            ifixx = ifixx.reshape(m, 1)
+        elif ifixx.shape == (n,) and m == 1:
+            ifixx = ifixx.reshape(1, n)
+        elif ifixx.shape != (m, n):
+            raise ValueError("could not convert ifixx to a suitable array")
+
+    beta, sd_beta, cov_beta, output = __odrpack._odr_batch(
+        fcn, beta0, None if implicit else y.reshape(nfits, q, n),
+        x.reshape(nfits, m, n), q,
+        _batch_weights(we, nfits, q, n, 'we', 1.0 if implicit else -1.0),
+        _batch_weights(wd, nfits, m, n, 'wd', -1.0),
+        fjacb, fjacd, ifixb, ifixx, job, ndigit, taufac, sstol, partol,
+        maxit, workers)
+
+    for key in ('delta', 'xplus'):
+        output[key] = output[key].reshape(x.shape)
+    for key in ('eps', 'y'):
+        output[key] = output[key].reshape(y_shape)
+    return beta, sd_beta, cov_beta, output
+
+
 class Data(object):
     """
     The data to fit.
@@ -441,13 +668,13 @@ class Model(object):
 
     Parameters
     ----------
-    fcn : function
+    fcn : function or `scipy.LowLevelCallable`
           fcn(beta, x) --> y
-    fjacb : function
+    fjacb : function or `scipy.LowLevelCallable`
           Jacobian of fcn wrt the fit parameters beta.
 
           fjacb(beta, x) --> @f_i(x,B)/@B_j
-    fjacd : function
+    fjacd : function or `scipy.LowLevelCallable`
           Jacobian of fcn wrt the (possibly multidimensional) input
           variable.
 
@@ -504,6 +731,20 @@ class Model(object):
         point.  If `q == 1`, then the return array's shape is `(m, n)`. If
         `m == 1`, the shape is (q, n). If `m == q == 1`, the shape is `(n,)`.
 
+    The model functions can also be given as `scipy.LowLevelCallable`
+    objects with the signature::
+
+        int func(int n, int m, int p, int q, double *beta, double *x,
+                 double *out, void *user_data)
+
+    They fill `out` with the C-ordered values of the corresponding Python
+    function above at `beta` and `x` (of shape ``(m, n)``) and return 0. A
+    positive value rejects `beta`, so that ODRPACK tries a shorter step, and
+    a negative one stops the fit. Either all or none of the functions of a
+    model are low-level, and `extra_args` is then replaced by `user_data`.
+    Low-level functions are called without the GIL, and `odr_batch` runs
+    their fits on several threads.
+
     """
 
     def __init__(self, fcn, fjacb=None, fjacd=None,
@@ -825,28 +1066,29 @@ class ODR(object):
             fjacb_perms.append((n,))
 
         # try evaluating the supplied functions to make sure they provide
-        # sensible outputs
-
-        arglist = (self.beta0, self.data.x)
-        if self.model.extra_args is not None:
-            arglist = arglist + self.model.extra_args
-        res = self.model.fcn(*arglist)
-
-        if res.shape not in fcn_perms:
-            print(res.shape)
-            print(fcn_perms)
-            raise OdrError("fcn does not output %s-shaped array" % y_s)
-
-        if self.model.fjacd is not None:
-            res = self.model.fjacd(*arglist)
-            if res.shape not in fjacd_perms:
-                raise OdrError(
-                    "fjacd does not output %s-shaped array" % repr((q, m, n)))
-        if self.model.fjacb is not None:
-            res = self.model.fjacb(*arglist)
-            if res.shape not in fjacb_perms:
-                raise OdrError(
-                    "fjacb does not output %s-shaped array" % repr((q, p, n)))
+        # sensible outputs; low-level functions cannot be called from Python
+
+        if not isinstance(self.model.fcn, LowLevelCallable):
+            arglist = (self.beta0, self.data.x)
+            if self.model.extra_args is not None:
+                arglist = arglist + self.model.extra_args
+            res = self.model.fcn(*arglist)
+
+            if res.shape not in fcn_perms:
+                print(res.shape)
+                print(fcn_perms)
+                raise OdrError("fcn does not output %s-shaped array" % y_s)
+
+            if self.model.fjacd is not None:
+                res = self.model.fjacd(*arglist)
+                if res.shape not in fjacd_perms:
+                    raise OdrError("fjacd does not output %s-shaped array"
+                                   % repr((q, m, n)))
+            if self.model.fjacb is not None:
+                res = self.model.fjacb(*arglist)
+                if res.shape not in fjacb_perms:
+                    raise OdrError("fjacb does not output %s-shaped array"
+                                   % repr((q, p, n)))
 
         # check shape of delta0
 
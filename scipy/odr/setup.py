@@ -25,12 +25,18 @@ def configuration(parent_package='', top_path=None):
 
     sources = ['__odrpack.c']
     libraries = ['odrpack'] + blas_info.pop('libraries', [])
-    include_dirs = ['.'] + blas_info.pop('include_dirs', [])
+    ccallback_dir = join('..', '_lib', 'src')
+    zeros_dir = join('..', 'optimize', 'Zeros')
+    include_dirs = (['.', ccallback_dir, zeros_dir] +
+                    blas_info.pop('include_dirs', []))
     config.add_extension('__odrpack',
         sources=sources,
         libraries=libraries,
         include_dirs=include_dirs,
-        depends=(['odrpack.h'] + odrpack_src),
+        depends=(['odrpack.h'] + odrpack_src +
+                 [join(ccallback_dir, 'ccallback.h'),
+                  join(ccallback_dir, 'ccallback_pool.h'),
+                  join(zeros_dir, 'zeros_threads.h')]),
         **blas_info
     )
 
@@ -1,12 +1,34 @@
 from __future__ import division, print_function, absolute_import
 
+import ctypes
+
 # SciPy imports.
 import numpy as np
 from numpy import pi
-from numpy.testing import (assert_array_almost_equal,
+from numpy.testing import (assert_array_almost_equal, assert_allclose,
                            assert_equal, assert_warns)
 from pytest import raises as assert_raises
-from scipy.odr import Data, Model, ODR, RealData, OdrStop, OdrWarning
+from scipy import LowLevelCallable
+from scipy.odr import (Data, Model, ODR, RealData, OdrStop, OdrWarning,
+                       odr, odr_batch)
+
+
+def lowlevel(func, ret=0):
+    """A ctypes LowLevelCallable evaluating the Python model function func."""
+    argtypes = ((ctypes.c_int,)*4 + (ctypes.POINTER(ctypes.c_double),)*3 +
+                (ctypes.c_void_p,))
+
+    def callback(n, m, p, q, beta, x, out, user_data):
+        B = np.ctypeslib.as_array(beta, shape=(p,))
+        X = np.ctypeslib.as_array(x, shape=(m, n))
+        res = np.ravel(func(B.copy(), X[0].copy() if m == 1 else X.copy()))
+        np.ctypeslib.as_array(out, shape=res.shape)[:] = res
+        return ret
+
+    return LowLevelCallable(
+        ctypes.CFUNCTYPE(ctypes.c_int, *argtypes)(callback),
+        signature="int (int, int, int, int, double *, double *, double *, "
+                  "void *)")
 
 
 class TestODR(object):
@@ -358,3 +380,111 @@ class TestODR(object):
         odr2 = ODR(data, model, beta0=np.array([1.]), ifixx=fix)
         sol2 = odr2.run()
         assert_equal(sol1.beta, sol2.beta)
+
+    # LowLevelCallable model functions and batches
+
+    def explicit_data(self, k=0):
+        x = np.array([0., 0., 5., 7., 7.5, 10., 16., 26., 30., 34., 34.5,
+                      100.])
+        y = np.array([1265., 1263.6, 1258., 1254., 1253., 1249.8, 1237.,
+                      1218., 1220.6, 1213.8, 1215.5, 1212.])
+        return x, y + 2.0*k + np.sin(x + k)
+
+    def test_lowlevel(self):
+        x, y = self.explicit_data()
+        beta0 = [1500.0, -50.0, -0.1]
+        ifixx = [0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0]
+
+        for deriv in (0, 2):
+            out = []
+            for fcn, fjb, fjd in [
+                    (self.explicit_fcn, self.explicit_fjb, self.explicit_fjd),
+                    (lowlevel(self.explicit_fcn), lowlevel(self.explicit_fjb),
+                     lowlevel(self.explicit_fjd))]:
+                model = Model(fcn, fjacb=fjb, fjacd=fjd)
+                fit = ODR(Data(x, y), model, beta0=beta0, ifixx=ifixx)
+                fit.set_job(deriv=deriv)
+                out.append(fit.run())
+            assert_allclose(out[1].beta, out[0].beta, rtol=1e-12)
+            assert_allclose(out[1].cov_beta, out[0].cov_beta, rtol=1e-10)
+            assert_equal(out[1].info, out[0].info)
+
+        # a negative return value stops the fit
+        stop = lowlevel(self.explicit_fcn, ret=-1)
+        out = ODR(Data(x, y), Model(stop), beta0=beta0).run()
+        assert 'Error occurred in callback' in out.stopreason
+
+        # the functions of a model are all low-level or all Python
+        assert_raises(ValueError, odr, stop, beta0, y, x,
+                      fjacb=self.explicit_fjb)
+        assert_raises(ValueError, odr, stop, beta0, y, x, extra_args=(1,))
+
+    def test_batch(self):
+        k = 5
+        data = [self.explicit_data(i) for i in range(k)]
+        x = np.array([d[0] for d in data])
+        y = np.array([d[1] for d in data])
+        beta0 = [1500.0, -50.0, -0.1]
+        we = np.linspace(1, 2, k)[:, np.newaxis] * np.ones(12)
+
+        expected = [odr(self.explicit_fcn, beta0, y[i], x[i], we=we[i],
+                        wd=2.0, fjacb=self.explicit_fjb,
+                        fjacd=self.explicit_fjd, job=20, full_output=1)
+                    for i in range(k)]
+
+        fcn = lowlevel(self.explicit_fcn)
+        fjb = lowlevel(self.explicit_fjb)
+        fjd = lowlevel(self.explicit_fjd)
+        for args, workers in [((self.explicit_fcn, self.explicit_fjb,
+                                self.explicit_fjd), None),
+                              ((fcn, fjb, fjd), 1), ((fcn, fjb, fjd), 3)]:
+            beta, sd_beta, cov_beta, output = odr_batch(
+                args[0], beta0, y, x, we=we, wd=2.0, fjacb=args[1],
+                fjacd=args[2], job=20, workers=workers)
+            assert_equal(beta.shape, (k, 3))
+            assert_equal(cov_beta.shape, (k, 3, 3))
+            assert_equal(output['delta'].shape, x.shape)
+            assert_equal(output['y'].shape, y.shape)
+            for i in range(k):
+                assert_allclose(beta[i], expected[i][0], rtol=1e-10)
+                assert_allclose(sd_beta[i], expected[i][1], rtol=1e-8)
+                assert_allclose(cov_beta[i], expected[i][2], rtol=1e-8)
+                assert_allclose(output['delta'][i], expected[i][3]['delta'],
+                                rtol=1e-8, atol=1e-12)
+                assert_allclose(output['res_var'][i],
+                                expected[i][3]['res_var'], rtol=1e-8)
+                assert_equal(output['info'][i], expected[i][3]['info'])
+
+    def test_batch_implicit(self):
+        x = np.array([[0.5, 1.2, 1.6, 1.86, 2.12, 2.36, 2.44, 2.36, 2.06,
+                       1.74, 1.34, 0.9, -0.28, -0.78, -1.36, -1.9, -2.5,
+                       -2.88, -3.18, -3.44],
+                      [-0.12, -0.6, -1., -1.4, -2.54, -3.36, -4., -4.75,
+                       -5.25, -5.64, -5.97, -6.32, -6.44, -6.44, -6.41,
+                       -6.25, -5.88, -5.5, -5.24, -4.86]])
+        x = np.array([x, x + 0.1])
+        beta0 = [-1.0, -3.0, 0.09, 0.02, 0.08]
+
+        res1 = odr_batch(self.implicit_fcn, beta0, 1, x, job=1)
+        res2 = odr_batch(lowlevel(self.implicit_fcn), beta0, 1, x, job=1,
+                         workers=2)
+        assert_allclose(res1[0][0], [-0.9993809167281279, -2.9310484652026476,
+                                     0.0875730502693354, 0.0162299708984738,
+                                     0.0797537982976416], rtol=1e-6)
+        assert_allclose(res2[0], res1[0], rtol=1e-10)
+        assert_equal(res2[3]['eps'].shape, (2, 20))
+
+    def test_batch_errors(self):
+        x, y = self.explicit_data()
+        x, y = np.array([x, x]), np.array([y, y])
+        fcn = lowlevel(self.explicit_fcn)
+        beta0 = [1500.0, -50.0, -0.1]
+
+        assert_raises(ValueError, odr_batch, fcn, beta0, y, x, workers=0)
+        assert_raises(ValueError, odr_batch, fcn, beta0, y[:1], x)
+        assert_raises(ValueError, odr_batch, fcn, [beta0]*3, y, x)
+        assert_raises(ValueError, odr_batch, fcn, beta0, y, x,
+                      we=np.ones((3, 12)))
+        assert_raises(ValueError, odr_batch, fcn, beta0, y, x, job=10000)
+        assert_raises(ValueError, odr_batch, fcn, beta0, y, x,
+                      fjacb=self.explicit_fjb)
@@ -0,0 +1,457 @@
+/*
+ * Batched versions of bisect, ridder, brenth and brentq.
+ *
+ * Each solver is written here in reverse-communication form: a lane
+ * holds the state of one problem between evaluations, *_next advances it
+ * to its next point of evaluation and *_update consumes the value of the
+ * function there. The steps are those of bisect.c, ridder.c, brenth.c and
+ * brentq.c, so a problem solved in a batch gets the same root, iterations
+ * and function calls as when solved alone.
+ *
+ * The problems are taken in chunks. Within a chunk the unconverged lanes
+ * are kept packed at the front of the work arrays, so that each round of
+ * evaluations is one call of the callback on contiguous arrays. Chunks are
+ * independent, and are shared out between threads if workers > 1.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include "zeros.h"
+#include "zeros_threads.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define SIGN(a) ((a) > 0. ? 1. : -1.)
+
+typedef struct {
+    double xa, fa, dm, xm;
+} bisect_lane;
+
+typedef struct {
+    double xa, fa, xb, fb, xm, fm, xn, dm, tol;
+    int stage;
+} ridder_lane;
+
+typedef struct {
+    double xpre, fpre, xcur, fcur, xblk, fblk, spre, scur;
+} brent_lane;
+
+typedef struct {
+    union {
+        bisect_lane bisect;
+        ridder_lane ridder;
+        brent_lane brent;
+    } s;
+    double root;
+    int iterations;
+    int funcalls;
+} batch_lane;
+
+typedef struct {
+    double xtol, rtol;
+    int iter;
+} batch_params;
+
+
+static int
+bisect_next(batch_lane *lane, const batch_params *p, double *x)
+{
+    bisect_lane *s = &lane->s.bisect;
+
+    if (lane->iterations >= p->iter) {
+        lane->root = s->xa;
+        return CONVERR;
+    }
+    lane->iterations++;
+    s->dm *= .5;
+    s->xm = s->xa + s->dm;
+    *x = s->xm;
+    return INPROGRESS;
+}
+
+static int
+bisect_update(batch_lane *lane, double fm, const batch_params *p, double *x)
+{
+    bisect_lane *s = &lane->s.bisect;
+
+    if (fm*s->fa >= 0) {
+        s->xa = s->xm;
+    }
+    if (fm == 0 || fabs(s->dm) < p->xtol + p->rtol*fabs(s->xm)) {
+        lane->root = s->xm;
+        return CONVERGED;
+    }
+    return bisect_next(lane, p, x);
+}
+
+static int
+ridder_next(batch_lane *lane, const batch_params *p, double *x)
+{
+    ridder_lane *s = &lane->s.ridder;
+
+    if (lane->iterations >= p->iter) {
+        lane->root = s->xn;
+        return CONVERR;
+    }
+    lane->iterations++;
+    s->dm = 0.5*(s->xb - s->xa);
+    s->xm = s->xa + s->dm;
+    s->stage = 0;
+    *x = s->xm;
+    return INPROGRESS;
+}
+
+static int
+ridder_update(batch_lane *lane, double fx, const batch_params *p, double *x)
+{
+    ridder_lane *s = &lane->s.ridder;
+    double dn, fn;
+
+    if (s->stage == 0) {
+        s->fm = fx;
+        dn = SIGN(s->fb - s->fa)*s->dm*s->fm/sqrt(s->fm*s->fm - s->fa*s->fb);
+        s->xn = s->xm - SIGN(dn)*MIN(fabs(dn), fabs(s->dm) - .5*s->tol);
+        s->stage = 1;
+        *x = s->xn;
+        return INPROGRESS;
+    }
+    fn = fx;
+    if (fn*s->fm < 0.0) {
+        s->xa = s->xn; s->fa = fn; s->xb = s->xm; s->fb = s->fm;
+    }
+    else if (fn*s->fa < 0.0) {
+        s->xb = s->xn; s->fb = fn;
+    }
+    else {
+        s->xa = s->xn; s->fa = fn;
+    }
+    s->tol = p->xtol + p->rtol*s->xn;
+    if (fn == 0.0 || fabs(s->xb - s->xa) < s->tol) {
+        lane->root = s->xn;
+        return CONVERGED;
+    }
+    return ridder_next(lane, p, x);
+}
+
+/* One iteration of brentq, or of brenth if hyperbolic is nonzero, up to
+   the next evaluation. */
+static int
+brent_next(batch_lane *lane, const batch_params *p, int hyperbolic,
+           double *x)
+{
+    brent_lane *s = &lane->s.brent;
+    double delta, sbis, stry, dpre, dblk;
+
+    if (lane->iterations >= p->iter) {
+        lane->root = s->xcur;
+        return CONVERR;
+    }
+    lane->iterations++;
+    if (s->fpre*s->fcur < 0) {
+        s->xblk = s->xpre;
+        s->fblk = s->fpre;
+        s->spre = s->scur = s->xcur - s->xpre;
+    }
+    if (fabs(s->fblk) < fabs(s->fcur)) {
+        s->xpre = s->xcur;
+        s->xcur = s->xblk;
+        s->xblk = s->xpre;
+
+        s->fpre = s->fcur;
+        s->fcur = s->fblk;
+        s->fblk = s->fpre;
+    }
+
+    delta = (p->xtol + p->rtol*fabs(s->xcur))/2;
+    sbis = (s->xblk - s->xcur)/2;
+    if (s->fcur == 0 || fabs(sbis) < delta) {
+        lane->root = s->xcur;
+        return CONVERGED;
+    }
+
+    if (fabs(s->spre) > delta && fabs(s->fcur) < fabs(s->fpre)) {
+        if (s->xpre == s->xblk) {
+            /* interpolate */
+            stry = -s->fcur*(s->xcur - s->xpre)/(s->fcur - s->fpre);
+        }
+        else {
+            /* extrapolate */
+            dpre = (s->fpre - s->fcur)/(s->xpre - s->xcur);
+            dblk = (s->fblk - s->fcur)/(s->xblk - s->xcur);
+            if (hyperbolic) {
+                stry = -s->fcur*(s->fblk - s->fpre)
+                    /(s->fblk*dpre - s->fpre*dblk);
+            }
+            else {
+                stry = -s->fcur*(s->fblk*dblk - s->fpre*dpre)
+                    /(dblk*dpre*(s->fblk - s->fpre));
+            }
+        }
+        if (2*fabs(stry) < MIN(fabs(s->spre), 3*fabs(sbis) - delta)) {
+            /* good short step */
+            s->spre = s->scur;
+            s->scur = stry;
+        }
+        else {
+            /* bisect */
+            s->spre = sbis;
+            s->scur = sbis;
+        }
+    }
+    else {
+        /* bisect */
+        s->spre = sbis;
+        s->scur = sbis;
+    }
+
+    s->xpre = s->xcur;
+    s->fpre = s->fcur;
+    if (fabs(s->scur) > delta) {
+        s->xcur += s->scur;
+    }
+    else {
+        s->xcur += (sbis > 0 ? delta : -delta);
+    }
+    *x = s->xcur;
+    return INPROGRESS;
+}
+
+/* Sets up a lane from the values at the ends of its bracket, and gives
+   its first point of evaluation if it is not already done. */
+static int
+batch_start(int method, batch_lane *lane, double xa, double xb, double fa,
+            double fb, const batch_params *p, double *x)
+{
+    lane->iterations = 0;
+    lane->funcalls = 2;
+    if (fa*fb > 0) {
+        lane->root = 0.;
+        return SIGNERR;
+    }
+    if (fa == 0) {
+        lane->root = xa;
+        return CONVERGED;
+    }
+    if (fb == 0) {
+        lane->root = xb;
+        return CONVERGED;
+    }
+
+    switch (method) {
+    case BATCH_BISECT:
+        lane->s.bisect.xa = xa;
+        lane->s.bisect.fa = fa;
+        lane->s.bisect.dm = xb - xa;
+        return bisect_next(lane, p, x);
+    case BATCH_RIDDER:
+        lane->s.ridder.xa = xa;
+        lane->s.ridder.fa = fa;
+        lane->s.ridder.xb = xb;
+        lane->s.ridder.fb = fb;
+        lane->s.ridder.xn = 0.0;
+        lane->s.ridder.tol = p->xtol + p->rtol*MIN(fabs(xa), fabs(xb));
+        return ridder_next(lane, p, x);
+    default:
+        lane->s.brent.xpre = xa;
+        lane->s.brent.fpre = fa;
+        lane->s.brent.xcur = xb;
+        lane->s.brent.fcur = fb;
+        lane->s.brent.xblk = 0.;
+        lane->s.brent.fblk = 0.;
+        lane->s.brent.spre = 0.;
+        lane->s.brent.scur = 0.;
+        return brent_next(lane, p, method == BATCH_BRENTH, x);
+    }
+}
+
+static int
+batch_update(int method, batch_lane *lane, double fx, const batch_params *p,
+             double *x)
+{
+    lane->funcalls++;
+    switch (method) {
+    case BATCH_BISECT:
+        return bisect_update(lane, fx, p, x);
+    case BATCH_RIDDER:
+        return ridder_update(lane, fx, p, x);
+    default:
+        lane->s.brent.fcur = fx;
+        return brent_next(lane, p, method == BATCH_BRENTH, x);
+    }
+}
+
+
+typedef struct {
+    int method;
+    batch_callback_type f;
+    void *func_data;
+    batch_params p;
+    const double *xa, *xb;
+    double *roots;
+    scipy_zeros_info *solver_stats;
+    ptrdiff_t n, chunk;
+    /* shared between the threads */
+    zeros_mutex lock;
+    ptrdiff_t next;
+    int status;
+} batch_task;
+
+/* Solves problems lo..hi-1, with work arrays for at least hi - lo lanes. */
+static int
+batch_solve_chunk(batch_task *t, ptrdiff_t lo, ptrdiff_t hi,
+                  batch_lane *state, ptrdiff_t *lanes, double *x, double *fx)
+{
+    ptrdiff_t m = hi - lo, nact, i, k;
+    int err, rc;
+
+    for (i = 0; i < m; i++) {
+        lanes[i] = lo + i;
+        x[i] = t->xa[lo + i];
+    }
+    rc = t->f(m, lanes, x, fx, t->func_data);
+    if (rc) {
+        return rc;
+    }
+    for (i = 0; i < m; i++) {
+        /* keep f(xa) until both ends are known */
+        state[i].root = fx[i];
+        x[i] = t->xb[lo + i];
+    }
+    rc = t->f(m, lanes, x, fx, t->func_data);
+    if (rc) {
+        return rc;
+    }
+
+    nact = 0;
+    for (i = 0; i < m; i++) {
+        err = batch_start(t->method, state + i, t->xa[lo + i],
+                          t->xb[lo + i], state[i].root, fx[i], &t->p,
+                          x + nact);
+        if (err == INPROGRESS) {
+            lanes[nact++] = lo + i;
+        }
+        else if (t->solver_stats) {
+            t->solver_stats[lo + i].error_num = err;
+        }
+    }
+
+    while (nact > 0) {
+        rc = t->f(nact, lanes, x, fx, t->func_data);
+        if (rc) {
+            return rc;
+        }
+        k = 0;
+        for (i = 0; i < nact; i++) {
+            ptrdiff_t lane = lanes[i];
+            err = batch_update(t->method, state + (lane - lo), fx[i], &t->p,
+                               x + k);
+            if (err == INPROGRESS) {
+                lanes[k++] = lane;
+            }
+            else if (t->solver_stats) {
+                t->solver_stats[lane].error_num = err;
+            }
+        }
+        nact = k;
+    }
+
+    for (i = 0; i < m; i++) {
+        t->roots[lo + i] = state[i].root;
+        if (t->solver_stats) {
+            t->solver_stats[lo + i].funcalls = state[i].funcalls;
+            t->solver_stats[lo + i].iterations = state[i].iterations;
+        }
+    }
+    return 0;
+}
+
+static void
+batch_thread(void *arg)
+{
+    batch_task *t = (batch_task *)arg;
+    ptrdiff_t lo, hi, m = MIN(t->chunk, t->n);
+    batch_lane *state;
+    ptrdiff_t *lanes;
+    double *x, *fx;
+    int rc = 0;
+
+    state = malloc(m*sizeof(batch_lane));
+    lanes = malloc(m*sizeof(ptrdiff_t));
+    x = malloc(m*sizeof(double));
+    fx = malloc(m*sizeof(double));
+    if (!state || !lanes || !x || !fx) {
+        rc = BATCH_NOMEM;
+    }
+
+    for (;;) {
+        zeros_mutex_lock(&t->lock);
+        if (rc && !t->status) {
+            t->status = rc;
+        }
+        lo = t->next;
+        if (t->status || lo >= t->n) {
+            zeros_mutex_unlock(&t->lock);
+            break;
+        }
+        hi = lo + MIN(t->chunk, t->n - lo);
+        t->next = hi;
+        zeros_mutex_unlock(&t->lock);
+
+        rc = batch_solve_chunk(t, lo, hi, state, lanes, x, fx);
+    }
+    free(state);
+    free(lanes);
+    free(x);
+    free(fx);
+}
+
+/*
+ * Solves the n problems bracketed by xa and xb with the given method,
+ * storing the roots in roots and, unless it is NULL, the statistics of
+ * each problem in solver_stats. The problems are solved chunk problems at
+ * a time, on up to workers threads; unless the callback is thread-safe
+ * workers must be 1.
+ *
+ * Returns 0 on success, BATCH_NOMEM if the work arrays cannot be
+ * allocated, or else the nonzero value with which the callback stopped
+ * the solver, in which case the contents of roots and solver_stats are
+ * unspecified.
+ */
+int
+scipy_zeros_batch(int method, batch_callback_type f, ptrdiff_t n,
+                  const double *xa, const double *xb, double xtol,
+                  double rtol, int iter, void *func_data, ptrdiff_t chunk,
+                  int workers, double *roots, scipy_zeros_info *solver_stats)
+{
+    batch_task t;
+    ptrdiff_t nchunks;
+    int nthreads;
+
+    if (n <= 0) {
+        return 0;
+    }
+    if (chunk <= 0) {
+        chunk = n;
+    }
+    t.method = method;
+    t.f = f;
+    t.func_data = func_data;
+    t.p.xtol = xtol;
+    t.p.rtol = rtol;
+    t.p.iter = iter;
+    t.xa = xa;
+    t.xb = xb;
+    t.roots = roots;
+    t.solver_stats = solver_stats;
+    t.n = n;
+    t.chunk = chunk;
+    t.next = 0;
+    t.status = 0;
+
+    nchunks = (n + chunk - 1)/chunk;
+    nthreads = workers > 1 ? (int)MIN((ptrdiff_t)workers, nchunks) : 1;
+
+    zeros_mutex_init(&t.lock);
+    zeros_run_threads(nthreads, batch_thread, &t);
+    zeros_mutex_destroy(&t.lock);
+    return t.status;
+}
@@ -6,6 +6,8 @@
 #ifndef ZEROS_H
 #define ZEROS_H
 
+#include <stddef.h>
+
 typedef struct {
     int funcalls;
     int iterations;
@@ -37,4 +39,31 @@ extern double brentq(callback_type f, double xa, double xb, double xtol,
                      double rtol, int iter, void *func_data,
                      scipy_zeros_info *solver_stats);
 
+/*
+ * Batched solvers: the same methods applied to n independent problems at
+ * once, problem k being bracketed by xa[k] and xb[k]. All unconverged
+ * problems advance in lockstep, and each round of evaluations is a single
+ * call of a batch_callback_type, which must store f_lanes[i](x[i]) in fx[i]
+ * for i = 0..n-1, where lanes[i] is the index of the problem being
+ * evaluated. A callback returns 0, or a positive value to stop the solver.
+ */
+
+#define BATCH_BISECT 0
+#define BATCH_RIDDER 1
+#define BATCH_BRENTH 2
+#define BATCH_BRENTQ 3
+
+/* Returned by scipy_zeros_batch if its workspace cannot be allocated */
+#define BATCH_NOMEM -1
+
+typedef int (*batch_callback_type)(ptrdiff_t n, const ptrdiff_t *lanes,
+                                   const double *x, double *fx,
+                                   void *func_data);
+
+extern int scipy_zeros_batch(int method, batch_callback_type f, ptrdiff_t n,
+                             const double *xa, const double *xb,
+                             double xtol, double rtol, int iter,
+                             void *func_data, ptrdiff_t chunk, int workers,
+                             double *roots, scipy_zeros_info *solver_stats);
+
 #endif
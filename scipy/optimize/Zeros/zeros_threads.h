@@ -0,0 +1,113 @@
+/*
+ * Minimal portable threads for the batched solvers of scipy.optimize.
+ *
+ * zeros_run_threads runs func(arg) on nthreads threads, one of them the
+ * calling thread, and returns when all of them have finished. If a thread
+ * cannot be started its call is simply dropped, so func must be written
+ * such that any one call can do all of the work (by claiming chunks from
+ * a shared counter under a zeros_mutex).
+ */
+#ifndef ZEROS_THREADS_H
+#define ZEROS_THREADS_H
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+
+#include <windows.h>
+#include <process.h>
+
+typedef CRITICAL_SECTION zeros_mutex;
+
+#define zeros_mutex_init(m) InitializeCriticalSection(m)
+#define zeros_mutex_destroy(m) DeleteCriticalSection(m)
+#define zeros_mutex_lock(m) EnterCriticalSection(m)
+#define zeros_mutex_unlock(m) LeaveCriticalSection(m)
+
+typedef HANDLE zeros_thread_handle;
+#define ZEROS_THREAD_RETURN unsigned __stdcall
+
+#else
+
+#include <pthread.h>
+
+typedef pthread_mutex_t zeros_mutex;
+
+#define zeros_mutex_init(m) pthread_mutex_init(m, NULL)
+#define zeros_mutex_destroy(m) pthread_mutex_destroy(m)
+#define zeros_mutex_lock(m) pthread_mutex_lock(m)
+#define zeros_mutex_unlock(m) pthread_mutex_unlock(m)
+
+typedef pthread_t zeros_thread_handle;
+#define ZEROS_THREAD_RETURN void *
+
+#endif
+
+typedef void zeros_thread_func(void *arg);
+
+typedef struct {
+    zeros_thread_func *func;
+    void *arg;
+    zeros_thread_handle handle;
+    int started;
+} zeros_thread;
+
+static ZEROS_THREAD_RETURN
+zeros_thread_main(void *arg)
+{
+    zeros_thread *th = (zeros_thread *)arg;
+    th->func(th->arg);
+    return 0;
+}
+
+static int
+zeros_thread_start(zeros_thread *th)
+{
+#ifdef _WIN32
+    th->handle = (HANDLE)_beginthreadex(NULL, 0, zeros_thread_main, th, 0,
+                                        NULL);
+    return th->handle != 0;
+#else
+    return pthread_create(&th->handle, NULL, zeros_thread_main, th) == 0;
+#endif
+}
+
+static void
+zeros_thread_join(zeros_thread *th)
+{
+#ifdef _WIN32
+    WaitForSingleObject(th->handle, INFINITE);
+    CloseHandle(th->handle);
+#else
+    pthread_join(th->handle, NULL);
+#endif
+}
+
+static void
+zeros_run_threads(int nthreads, zeros_thread_func *func, void *arg)
+{
+    zeros_thread *threads = NULL;
+    int k;
+
+    if (nthreads > 1) {
+        threads = calloc(nthreads - 1, sizeof(zeros_thread));
+    }
+    if (threads) {
+        for (k = 0; k < nthreads - 1; k++) {
+            threads[k].func = func;
+            threads[k].arg = arg;
+            threads[k].started = zeros_thread_start(threads + k);
+        }
+    }
+    func(arg);
+    if (threads) {
+        for (k = 0; k < nthreads - 1; k++) {
+            if (threads[k].started) {
+                zeros_thread_join(threads + k);
+            }
+        }
+        free(threads);
+    }
+}
+
+#endif
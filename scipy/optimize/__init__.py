@@ -47,6 +47,7 @@ Local (Multivariate) Optimization
    :toctree: generated/
 
    minimize - Interface for minimizers of multivariate functions.
+   minimize_lbfgsb_batch - L-BFGS-B on many problems in compiled code.
 
 The `minimize` function supports the following methods:
 
@@ -152,6 +153,7 @@ Scalar functions
    bisect - Bisection method.
    newton - Newton's method (also Secant and Halley's methods).
    toms748 - Alefeld, Potra & Shi Algorithm 748
+   root_scalar_batch - Bracketing methods over arrays of independent problems.
    RootResults - The root finding result returned by some root finders.
 
 The `root_scalar` function supports the following methods:
@@ -393,7 +395,8 @@ from ._root import *
 from ._root_scalar import *
 from .minpack import *
 from .zeros import *
-from .lbfgsb import fmin_l_bfgs_b, LbfgsInvHessProduct
+from .lbfgsb import (fmin_l_bfgs_b, minimize_lbfgsb_batch,
+                     LbfgsInvHessProduct)
 from .tnc import fmin_tnc
 from .cobyla import fmin_cobyla
 from .nonlin import *
@@ -0,0 +1,111 @@
+"""
+Sparse basis factorization for the revised simplex method.
+
+The basis matrix is factorized by SuperLU (`scipy.sparse.linalg.splu`) and
+basis changes are represented in product form, [1]_: after updates
+``E_1, ..., E_k`` the basis matrix is ``B_0 E_1 ... E_k``, where each
+elementary matrix ``E_i`` is the identity with one column replaced by the
+representation of the entering column in the previous basis. Only the
+nonzeros of these "eta" columns are stored, so an update costs one sparse
+solve and the fill-in of the factorization does not grow with the number
+of updates. The basis is refactorized as `BGLU` does.
+
+References
+----------
+.. [1] Dantzig, George B., and Wm Orchard-Hays. "The product form for the
+       inverse in the simplex method." Mathematical Tables and Other Aids
+       to Computation 8.46 (1954): 64-67.
+"""
+from __future__ import division, absolute_import, print_function
+
+import numpy as np
+import scipy.sparse as sps
+from scipy.sparse.linalg import splu
+from scipy.linalg import LinAlgError
+from ._bglu_dense import _consider_refactor
+
+__all__ = ['SparseBGLU']
+
+
+class SparseBGLU(object):
+    """
+    Represents a sparse LU factorization of a basis matrix with product form
+    updates. Has the interface of `BGLU`.
+    """
+
+    def __init__(self, A, b, max_updates=10, mast=False):
+        """
+        Given sparse matrix A and basis indices b, perform LU factorization of
+        basis matrix B
+        """
+        self.A = sps.csc_matrix(A)
+        self.b = b
+        self.m, self.n = A.shape
+        self.max_updates = max_updates  # maximum updates between refactor
+        self.refactor()
+        self.mast = mast
+
+    @_consider_refactor
+    def refactor(self):
+        self.B = self.A[:, self.b]  # get basis matrix
+        try:
+            self.lu = splu(self.B)
+        except RuntimeError:
+            # singular; reported by the next solve like a dense NaN result
+            self.lu = None
+        # b[i] is column slot[i] of the factorized matrix; entering columns
+        # take the slot of the leaving one while b shifts
+        self.slot = np.arange(self.m)
+        self.etas = []  # (slot, pivot, indices, values) in order
+
+        self.bglu_time = 0  # cumulative time spent updating and solving
+        self.solves = 0     # number of solves since refactoring
+        self.updates = 0    # number of updates since refactoring
+        self.average_solve_times = [np.inf, np.inf]  # current and last average solve time
+
+    def update_basis(self, i, j):
+        self.b[i:self.m-1] = self.b[i+1:self.m]  # eliminate i from basis
+        self.b[-1] = j  # add j to end of basis
+        s = self.slot[i]
+        self.slot[i:self.m-1] = self.slot[i+1:self.m]
+        self.slot[-1] = s
+
+    @_consider_refactor
+    def update(self, i, j):
+        """ Perform rank-one update to basis and factorization """
+        s = self.slot[i]
+        d = self._solve_slots(self.A[:, j].toarray().ravel())
+        self.update_basis(i, j)
+
+        # the entering column replaces slot s of the factorized matrix
+        idx = np.nonzero(d)[0]
+        idx = idx[idx != s]
+        self.etas.append((s, d[s], idx, d[idx]))
+
+    def _solve_slots(self, q):
+        """ Solve the system with the basis matrix in slot order """
+        if self.lu is None:
+            raise LinAlgError("Basis matrix is singular")
+        w = self.lu.solve(q)
+        for s, pivot, idx, values in self.etas:
+            ws = w[s]/pivot
+            w[idx] -= values*ws
+            w[s] = ws
+        return w
+
+    @_consider_refactor
+    def solve(self, q, transposed=False):
+        """
+        Solve B @ v = q efficiently using factorization
+        """
+        q = np.asarray(q, dtype=float)
+        if not transposed:
+            return self._solve_slots(q)[self.slot]
+
+        if self.lu is None:
+            raise LinAlgError("Basis matrix is singular")
+        w = np.empty(self.m)
+        w[self.slot] = q
+        for s, pivot, idx, values in reversed(self.etas):
+            w[s] = (w[s] - values.dot(w[idx]))/pivot
+        return self.lu.solve(w, trans='T')
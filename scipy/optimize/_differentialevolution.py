@@ -25,7 +25,7 @@ def differential_evolution(func, bounds, args=(), strategy='best1bin',
                            mutation=(0.5, 1), recombination=0.7, seed=None,
                            callback=None, disp=False, polish=True,
                            init='latinhypercube', atol=0, updating='immediate',
-                           workers=1, constraints=()):
+                           workers=1, constraints=(), vectorized=False):
     """Finds the global minimum of a multivariate function.
 
     Differential Evolution is stochastic in nature (does not use gradient
@@ -172,6 +172,18 @@ def differential_evolution(func, bounds, args=(), strategy='best1bin',
 
         .. versionadded:: 1.4.0
 
+    vectorized : bool, optional
+        If ``vectorized is True``, `func` is sent an `x` array with
+        ``x.shape == (N, S)``, and is expected to return an array of shape
+        ``(S,)``, where `S` is the number of solution vectors to be
+        calculated. A whole generation is then evaluated by a single call,
+        which is much faster for cheap objectives written with array
+        operations. When polishing, `func` is called with ``S == 1``.
+        This option will override the `workers` keyword, and the `updating`
+        keyword to ``updating='deferred'``.
+
+        .. versionadded:: 1.4.0
+
     Returns
     -------
     res : OptimizeResult
@@ -222,6 +234,9 @@ def differential_evolution(func, bounds, args=(), strategy='best1bin',
     convergence as trial vectors can immediately benefit from improved
     solutions. To use the original Storn and Price behaviour, updating the best
     solution once per iteration, set ``updating='deferred'``.
+    With deferred updating all the trial candidates of a generation are built
+    together with array operations, and evaluated together, in parallel with
+    `workers` or by one call of a `vectorized` function.
 
     .. versionadded:: 0.15.0
 
@@ -302,7 +317,8 @@ def differential_evolution(func, bounds, args=(), strategy='best1bin',
                                      disp=disp, init=init, atol=atol,
                                      updating=updating,
                                      workers=workers,
-                                     constraints=constraints) as solver:
+                                     constraints=constraints,
+                                     vectorized=vectorized) as solver:
         ret = solver.solve()
 
     return ret
@@ -445,6 +461,12 @@ class DifferentialEvolutionSolver(object):
     constraints : {NonLinearConstraint, LinearConstraint, Bounds}
         Constraints on the solver, over and above those applied by the `bounds`
         kwd. Uses the approach by Lampinen.
+    vectorized : bool, optional
+        If ``vectorized is True``, `func` is sent an `x` array with
+        ``x.shape == (N, S)``, and is expected to return an array of shape
+        ``(S,)``, where `S` is the number of solution vectors to be
+        calculated. This option will override the `workers` keyword, and the
+        `updating` keyword to `updating='deferred'`.
     """
 
     # Dispatch of mutation strategy method (binomial or exponential).
@@ -470,7 +492,7 @@ class DifferentialEvolutionSolver(object):
                  tol=0.01, mutation=(0.5, 1), recombination=0.7, seed=None,
                  maxfun=np.inf, callback=None, disp=False, polish=True,
                  init='latinhypercube', atol=0, updating='immediate',
-                 workers=1, constraints=()):
+                 workers=1, constraints=(), vectorized=False):
 
         if strategy in self._binomial:
             self.mutation_func = getattr(self, self._binomial[strategy])
@@ -487,6 +509,20 @@ class DifferentialEvolutionSolver(object):
         if updating in ['immediate', 'deferred']:
             self._updating = updating
 
+        self._vectorized = vectorized
+        if vectorized:
+            # the whole population is evaluated by one call of func
+            if workers != 1:
+                warnings.warn("differential_evolution: the 'vectorized'"
+                              " keyword has overridden the 'workers'"
+                              " keyword", UserWarning)
+                workers = 1
+            if updating == 'immediate':
+                warnings.warn("differential_evolution: the 'vectorized'"
+                              " keyword has overridden updating='immediate'"
+                              " to updating='deferred'", UserWarning)
+                self._updating = 'deferred'
+
         # want to use parallelisation, but updating is immediate
         if workers != 1 and updating == 'immediate':
             warnings.warn("differential_evolution: the 'workers' keyword has"
@@ -811,7 +847,12 @@ class DifferentialEvolutionSolver(object):
                                   " attempting to polish from the least"
                                   " infeasible solution", UserWarning)
 
-            result = minimize(self.func,
+            func = self.func
+            if self._vectorized:
+                def func(x):
+                    return self.func(x[:, np.newaxis])[0]
+
+            result = minimize(func,
                               np.copy(DE_result.x),
                               method=polish_method,
                               bounds=self.limits.T,
@@ -873,6 +914,18 @@ class DifferentialEvolutionSolver(object):
         energies = np.full(num_members, np.inf)
 
         parameters_pop = self._scale_parameters(population)
+        if self._vectorized:
+            if nfevs > 0:
+                calc_energies = np.asarray(
+                    self.func(parameters_pop[0:nfevs].T))
+                if calc_energies.shape != (nfevs,):
+                    raise RuntimeError("The vectorized function must return"
+                                       " an array of shape (S,) when given"
+                                       " an array of shape (len(x), S)")
+                energies[0:nfevs] = calc_energies
+            self._nfev += nfevs
+            return energies
+
         try:
             calc_energies = list(self._mapwrapper(self.func,
                                                   parameters_pop[0:nfevs]))
@@ -1104,8 +1157,7 @@ class DifferentialEvolutionSolver(object):
 
             # 'deferred' approach, vectorised form.
             # create trial solutions
-            trial_pop = np.array(
-                [self._mutate(i) for i in range(self.num_population_members)])
+            trial_pop = self._mutate_population()
 
             # enforce bounds
             self._ensure_constraint(trial_pop)
@@ -1194,6 +1246,41 @@ class DifferentialEvolutionSolver(object):
 
             return trial
 
+    def _mutate_population(self):
+        """
+        Create trial vectors for the whole population at once, as `_mutate`
+        does for one candidate.
+        """
+        rng = self.random_number_generator
+        num_members, parameter_count = self.population_shape
+        candidates = np.arange(num_members)
+
+        fill_point = rng.randint(0, parameter_count, size=num_members)
+
+        # the strategies work on rows of samples as well as on single ones
+        samples = self._select_samples_population(5)
+        if self.strategy in ['currenttobest1exp', 'currenttobest1bin']:
+            bprime = self.mutation_func(candidates, samples)
+        else:
+            bprime = self.mutation_func(samples)
+
+        if self.strategy in self._binomial:
+            crossovers = rng.rand(num_members, parameter_count)
+            crossovers = crossovers < self.cross_over_probability
+            crossovers[candidates, fill_point] = True
+        else:
+            # the parameters from fill_point on (in modulo) are taken from
+            # bprime up to the first failed draw
+            draws = (rng.rand(num_members, parameter_count) <
+                     self.cross_over_probability)
+            lengths = np.where(np.all(draws, axis=1), parameter_count,
+                               np.argmin(draws, axis=1))
+            offsets = ((np.arange(parameter_count) - fill_point[:, np.newaxis])
+                       % parameter_count)
+            crossovers = offsets < lengths[:, np.newaxis]
+
+        return np.where(crossovers, bprime, self.population)
+
     def _best1(self, samples):
         """best1bin, best1exp"""
         r0, r1 = samples[:2]
@@ -1252,6 +1339,31 @@ class DifferentialEvolutionSolver(object):
         idxs = idxs[:number_samples]
         return idxs
 
+    def _select_samples_population(self, number_samples):
+        """
+        obtain for every candidate random integers from
+        range(self.num_population_members), without replacement and
+        excluding the candidate. Row k of the result holds the k-th sample
+        of each candidate.
+        """
+        rng = self.random_number_generator
+        num_members = self.num_population_members
+        # like _select_samples, return fewer if there are not enough members
+        number_samples = min(number_samples, num_members - 1)
+        samples = np.empty((number_samples + 1, num_members), dtype=int)
+        samples[0] = np.arange(num_members)
+        for k in range(1, number_samples + 1):
+            # redraw the samples that coincide with an earlier one until
+            # there are none
+            redraw = np.arange(num_members)
+            while redraw.size:
+                samples[k, redraw] = rng.randint(0, num_members,
+                                                 size=redraw.size)
+                clash = np.any(samples[:k, redraw] == samples[k, redraw],
+                               axis=0)
+                redraw = redraw[clash]
+        return samples[1:]
+
 
 class _FunctionWrapper(object):
     """
@@ -62,46 +62,51 @@ def group_dense(int m, int n, int [:, :] A):
     return groups.base
 
 
+@cython.boundscheck(False)
 @cython.wraparound(False)
 def group_sparse(int m, int n, int [:] indices, int [:] indptr):
+    # Assigning each column in turn to the first group with none of its
+    # rows gives the same groups as building the groups one after the
+    # other, as group_dense does. Bit g of used[i, :] records whether row i
+    # is in group g, so the groups of a column's neighbours are found with
+    # one pass over its rows.
     cdef int [:] groups = np.full(n, -1, dtype=np.int32)
-    cdef int current_group = 0
-
-    cdef int i, j, k
-
-    union = np.empty(m, dtype=np.int32)
-    cdef int [:] union_v = union
-
-    for i in range(n):
-        if groups[i] >= 0:
-            continue
-
-        groups[i] = current_group
-        all_grouped = True
-
-        union.fill(0)
-        for k in range(indptr[i], indptr[i + 1]):
-            union_v[indices[k]] = 1
-
-        for j in range(groups.shape[0]):
-            if groups[j] < 0:
-                all_grouped = False
-            else:
-                continue
-
-            intersect = False
-            for k in range(indptr[j], indptr[j + 1]):
-                if union_v[indices[k]] == 1:
-                    intersect = True
-                    break
-            if not intersect:
-                for k in range(indptr[j], indptr[j + 1]):
-                    union_v[indices[k]] = 1
-                groups[j] = current_group
-
-        if all_grouped:
-            break
-
-        current_group += 1
+    cdef int n_words = 1
+
+    used = np.zeros((m, n_words), dtype=np.uint64)
+    cdef np.uint64_t [:, ::1] used_v = used
+    cdef np.uint64_t [::1] forbidden = np.empty(n_words, dtype=np.uint64)
+    cdef np.uint64_t bits
+
+    cdef int i, j, k, w, g
+
+    for j in range(n):
+        forbidden[:] = 0
+        for k in range(indptr[j], indptr[j + 1]):
+            i = indices[k]
+            for w in range(n_words):
+                forbidden[w] |= used_v[i, w]
+
+        g = -1
+        for w in range(n_words):
+            bits = ~forbidden[w]
+            if bits != 0:
+                g = 64 * w
+                while not (bits & 1):
+                    bits >>= 1
+                    g += 1
+                break
+
+        if g < 0:
+            # All groups so far meet the column, add words for new ones.
+            g = 64 * n_words
+            used = np.hstack((used, np.zeros((m, n_words), dtype=np.uint64)))
+            used_v = used
+            n_words *= 2
+            forbidden = np.empty(n_words, dtype=np.uint64)
+
+        groups[j] = g
+        for k in range(indptr[j], indptr[j + 1]):
+            used_v[indices[k], g >> 6] |= (<np.uint64_t>1) << (g & 63)
 
     return groups.base
@@ -0,0 +1,412 @@
+/*
+ * Compiled driver of L-BFGS-B, for objectives given as scipy.LowLevelCallable.
+ *
+ * The reverse-communication loop of _minimize_lbfgsb, calling setulb and
+ * evaluating the objective and its gradient whenever setulb asks for them,
+ * is run here in C with the GIL released. A batch of independent problems,
+ * differing in their starting points and, through an index passed to the
+ * objective, in their data, can be shared out between threads.
+ */
+
+#include "Python.h"
+#include <string.h>
+
+#define PY_ARRAY_UNIQUE_SYMBOL _scipy_optimize_lbfgsb_driver_ARRAY_API
+#include "numpy/arrayobject.h"
+
+#include "ccallback.h"
+#include "Zeros/zeros_threads.h"
+
+#if defined(NO_APPEND_FORTRAN)
+#if defined(UPPERCASE_FORTRAN)
+#define F_FUNC(f,F) F
+#else
+#define F_FUNC(f,F) f
+#endif
+#else
+#if defined(UPPERCASE_FORTRAN)
+#define F_FUNC(f,F) F##_
+#else
+#define F_FUNC(f,F) f##_
+#endif
+#endif
+
+/* lbfgsb_src/setulb_wrap.f */
+extern void F_FUNC(setulbw,SETULBW)(int *n, int *m, double *x,
+                                    const double *l, const double *u,
+                                    const int *nbd, double *f, double *g,
+                                    double *factr, double *pgtol, double *wa,
+                                    int *iwa, int *task, int *iprint,
+                                    int *csave, int *lsave, int *isave,
+                                    double *dsave, int *maxls);
+
+/* The signatures with value 1 take the index of the problem in the batch */
+static ccallback_signature_t callback_signatures[] = {
+    {"double (int, double *, double *, void *)", 0},
+    {"double (int, double *, double *, intptr_t, void *)", 1},
+    {"double (int, double *, double *, npy_intp, void *)", 1},
+#if NPY_SIZEOF_INTP == NPY_SIZEOF_INT
+    {"double (int, double *, double *, int, void *)", 1},
+#endif
+#if NPY_SIZEOF_INTP == NPY_SIZEOF_LONG
+    {"double (int, double *, double *, long, void *)", 1},
+#endif
+#if NPY_SIZEOF_INTP == NPY_SIZEOF_LONGLONG
+    {"double (int, double *, double *, long long, void *)", 1},
+#endif
+    {NULL}
+};
+
+typedef double lbfgsb_func(int n, double *x, double *g, void *user_data);
+typedef double lbfgsb_batch_func(int n, double *x, double *g, npy_intp k,
+                                 void *user_data);
+
+#define TASK_LEN 60
+
+typedef struct {
+    void *func;
+    int indexed;
+    void *user_data;
+    int n, m, iprint, maxfun, maxiter, maxls;
+    double factr, pgtol;
+    const double *l, *u;
+    const int *nbd;
+    npy_intp nprob;
+    /* results: x holds the starting points on entry */
+    double *x, *f, *g;
+    int *nfev, *nit, *warnflag;
+    npy_uint8 *task;
+    /* the last corrections, when wanted, else NULL */
+    double *s, *y;
+    int *nupd;
+    /* shared between the threads */
+    zeros_mutex lock;
+    npy_intp next;
+    int nomem;
+} lbfgsb_batch;
+
+
+static void
+set_task(int *task, const char *msg)
+{
+    int i;
+
+    for (i = 0; i < TASK_LEN && msg[i]; i++) {
+        task[i] = (unsigned char)msg[i];
+    }
+    for (; i < TASK_LEN; i++) {
+        task[i] = ' ';
+    }
+}
+
+static int
+task_startswith(const int *task, const char *prefix)
+{
+    int i;
+
+    for (i = 0; prefix[i]; i++) {
+        if (task[i] != (unsigned char)prefix[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Runs the loop of _minimize_lbfgsb for problem k. */
+static void
+lbfgsb_solve(lbfgsb_batch *b, npy_intp k, double *wa, int *iwa)
+{
+    int n = b->n, m = b->m;
+    double *x = b->x + k*n, *g = b->g + k*n;
+    double f = 0.0, factr = b->factr, pgtol = b->pgtol;
+    double dsave[29];
+    int task[TASK_LEN], csave[TASK_LEN], lsave[4], isave[44];
+    int iprint = b->iprint, maxls = b->maxls;
+    int nfev = 0, nit = 0, i;
+    npy_intp lwa = 2*(npy_intp)m*n + 5*(npy_intp)n + 11*(npy_intp)m*m + 8*m;
+
+    memset(wa, 0, lwa*sizeof(double));
+    memset(iwa, 0, 3*(size_t)n*sizeof(int));
+    memset(g, 0, n*sizeof(double));
+    memset(dsave, 0, sizeof(dsave));
+    memset(lsave, 0, sizeof(lsave));
+    memset(isave, 0, sizeof(isave));
+    set_task(task, "START");
+    set_task(csave, "");
+
+    for (;;) {
+        F_FUNC(setulbw,SETULBW)(&n, &m, x, b->l, b->u, b->nbd, &f, g,
+                                &factr, &pgtol, wa, iwa, task, &iprint,
+                                csave, lsave, isave, dsave, &maxls);
+        if (task_startswith(task, "FG")) {
+            if (b->indexed) {
+                f = ((lbfgsb_batch_func *)b->func)(n, x, g, k,
+                                                   b->user_data);
+            }
+            else {
+                f = ((lbfgsb_func *)b->func)(n, x, g, b->user_data);
+            }
+            nfev++;
+        }
+        else if (task_startswith(task, "NEW_X")) {
+            nit++;
+            if (nit >= b->maxiter) {
+                set_task(task, "STOP: TOTAL NO. of ITERATIONS REACHED LIMIT");
+            }
+            else if (nfev > b->maxfun) {
+                set_task(task, "STOP: TOTAL NO. of f AND g EVALUATIONS "
+                               "EXCEEDS LIMIT");
+            }
+        }
+        else {
+            break;
+        }
+    }
+
+    b->f[k] = f;
+    b->nfev[k] = nfev;
+    b->nit[k] = nit;
+    if (task_startswith(task, "CONV")) {
+        b->warnflag[k] = 0;
+    }
+    else if (nfev > b->maxfun || nit >= b->maxiter) {
+        b->warnflag[k] = 1;
+    }
+    else {
+        b->warnflag[k] = 2;
+    }
+    for (i = 0; i < TASK_LEN; i++) {
+        b->task[k*TASK_LEN + i] = (npy_uint8)task[i];
+    }
+    if (b->s != NULL) {
+        /* the first two blocks of wa, see mainlb in lbfgsb.f */
+        npy_intp mn = (npy_intp)m*n;
+
+        memcpy(b->s + k*mn, wa, mn*sizeof(double));
+        memcpy(b->y + k*mn, wa + mn, mn*sizeof(double));
+        /* isave(31), the total number of BFGS updates */
+        b->nupd[k] = isave[30];
+    }
+}
+
+static void
+lbfgsb_thread(void *arg)
+{
+    lbfgsb_batch *b = (lbfgsb_batch *)arg;
+    npy_intp k;
+    int n = b->n, m = b->m;
+    double *wa;
+    int *iwa;
+
+    wa = malloc((2*(size_t)m*n + 5*(size_t)n + 11*(size_t)m*m + 8*m)
+                *sizeof(double));
+    iwa = malloc(3*(size_t)n*sizeof(int));
+
+    for (;;) {
+        zeros_mutex_lock(&b->lock);
+        if (wa == NULL || iwa == NULL) {
+            b->nomem = 1;
+        }
+        k = b->next++;
+        if (b->nomem || k >= b->nprob) {
+            zeros_mutex_unlock(&b->lock);
+            break;
+        }
+        zeros_mutex_unlock(&b->lock);
+
+        lbfgsb_solve(b, k, wa, iwa);
+    }
+    free(wa);
+    free(iwa);
+}
+
+
+static PyObject *
+minimize(PyObject *self, PyObject *args)
+{
+    PyObject *fun, *x0_obj, *l_obj, *u_obj, *nbd_obj, *ret = NULL;
+    PyArrayObject *x0 = NULL, *l = NULL, *u = NULL, *nbd = NULL;
+    PyArrayObject *x = NULL, *f = NULL, *g = NULL, *nfev = NULL, *nit = NULL;
+    PyArrayObject *warnflag = NULL, *task = NULL;
+    PyArrayObject *s = NULL, *y = NULL, *nupd = NULL;
+    ccallback_t callback;
+    lbfgsb_batch b;
+    npy_intp dims[3];
+    int m, iprint, maxfun, maxiter, maxls, workers, want_corrections;
+    int nthreads;
+    double factr, pgtol;
+
+    callback.py_function = NULL;
+    callback.c_function = NULL;
+
+    if (!PyArg_ParseTuple(args, "OOOOOiddiiiiii", &fun, &x0_obj, &l_obj,
+                          &u_obj, &nbd_obj, &m, &factr, &pgtol, &iprint,
+                          &maxfun, &maxiter, &maxls, &workers,
+                          &want_corrections)) {
+        return NULL;
+    }
+
+    x0 = (PyArrayObject *)PyArray_FROMANY(x0_obj, NPY_DOUBLE, 2, 2,
+                                          NPY_ARRAY_CARRAY_RO);
+    l = (PyArrayObject *)PyArray_FROMANY(l_obj, NPY_DOUBLE, 1, 1,
+                                         NPY_ARRAY_CARRAY_RO);
+    u = (PyArrayObject *)PyArray_FROMANY(u_obj, NPY_DOUBLE, 1, 1,
+                                         NPY_ARRAY_CARRAY_RO);
+    nbd = (PyArrayObject *)PyArray_FROMANY(nbd_obj, NPY_INT, 1, 1,
+                                           NPY_ARRAY_CARRAY_RO);
+    if (x0 == NULL || l == NULL || u == NULL || nbd == NULL) {
+        goto fail;
+    }
+    dims[0] = PyArray_DIM(x0, 0);
+    dims[1] = PyArray_DIM(x0, 1);
+    if (dims[1] < 1 || dims[1] > NPY_MAX_INT / 3 ||
+            PyArray_DIM(l, 0) != dims[1] || PyArray_DIM(u, 0) != dims[1] ||
+            PyArray_DIM(nbd, 0) != dims[1]) {
+        PyErr_SetString(PyExc_ValueError,
+                        "x0 and the bounds have inconsistent sizes");
+        goto fail;
+    }
+    if (m < 1 || maxls < 1) {
+        PyErr_SetString(PyExc_ValueError, "maxcor and maxls must be positive");
+        goto fail;
+    }
+
+    if (ccallback_prepare(&callback, callback_signatures, fun,
+                          CCALLBACK_DEFAULTS) != 0) {
+        goto fail;
+    }
+    if (callback.py_function != NULL) {
+        PyErr_SetString(PyExc_ValueError,
+                        "fun must be a scipy.LowLevelCallable");
+        goto fail;
+    }
+
+    x = (PyArrayObject *)PyArray_NewCopy(x0, NPY_CORDER);
+    g = (PyArrayObject *)PyArray_SimpleNew(2, dims, NPY_DOUBLE);
+    f = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+    nfev = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_INT);
+    nit = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_INT);
+    warnflag = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_INT);
+    dims[1] = TASK_LEN;
+    task = (PyArrayObject *)PyArray_SimpleNew(2, dims, NPY_UINT8);
+    if (x == NULL || g == NULL || f == NULL || nfev == NULL || nit == NULL ||
+            warnflag == NULL || task == NULL) {
+        goto fail;
+    }
+    if (want_corrections) {
+        dims[1] = m;
+        dims[2] = PyArray_DIM(x0, 1);
+        s = (PyArrayObject *)PyArray_SimpleNew(3, dims, NPY_DOUBLE);
+        y = (PyArrayObject *)PyArray_SimpleNew(3, dims, NPY_DOUBLE);
+        nupd = (PyArrayObject *)PyArray_SimpleNew(1, dims, NPY_INT);
+        if (s == NULL || y == NULL || nupd == NULL) {
+            goto fail;
+        }
+    }
+
+    b.func = callback.c_function;
+    b.indexed = callback.signature->value;
+    b.user_data = callback.user_data;
+    b.n = (int)PyArray_DIM(x0, 1);
+    b.m = m;
+    b.iprint = iprint;
+    b.maxfun = maxfun;
+    b.maxiter = maxiter;
+    b.maxls = maxls;
+    b.factr = factr;
+    b.pgtol = pgtol;
+    b.l = (const double *)PyArray_DATA(l);
+    b.u = (const double *)PyArray_DATA(u);
+    b.nbd = (const int *)PyArray_DATA(nbd);
+    b.nprob = PyArray_DIM(x0, 0);
+    b.x = (double *)PyArray_DATA(x);
+    b.f = (double *)PyArray_DATA(f);
+    b.g = (double *)PyArray_DATA(g);
+    b.nfev = (int *)PyArray_DATA(nfev);
+    b.nit = (int *)PyArray_DATA(nit);
+    b.warnflag = (int *)PyArray_DATA(warnflag);
+    b.task = (npy_uint8 *)PyArray_DATA(task);
+    b.s = s ? (double *)PyArray_DATA(s) : NULL;
+    b.y = y ? (double *)PyArray_DATA(y) : NULL;
+    b.nupd = nupd ? (int *)PyArray_DATA(nupd) : NULL;
+    b.next = 0;
+    b.nomem = 0;
+
+    nthreads = workers > 1 ? workers : 1;
+    if (nthreads > b.nprob) {
+        nthreads = b.nprob > 1 ? (int)b.nprob : 1;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    zeros_mutex_init(&b.lock);
+    zeros_run_threads(nthreads, lbfgsb_thread, &b);
+    zeros_mutex_destroy(&b.lock);
+    Py_END_ALLOW_THREADS
+
+    if (b.nomem) {
+        PyErr_NoMemory();
+        goto fail;
+    }
+
+    if (want_corrections) {
+        ret = Py_BuildValue("NNNNNNNNNN", x, f, g, nfev, nit, warnflag, task,
+                            s, y, nupd);
+    }
+    else {
+        ret = Py_BuildValue("NNNNNNNOOO", x, f, g, nfev, nit, warnflag, task,
+                            Py_None, Py_None, Py_None);
+    }
+    x = f = g = nfev = nit = warnflag = task = s = y = nupd = NULL;
+
+fail:
+    if (callback.py_function != NULL || callback.c_function != NULL) {
+        ccallback_release(&callback);
+    }
+    Py_XDECREF(x0);
+    Py_XDECREF(l);
+    Py_XDECREF(u);
+    Py_XDECREF(nbd);
+    Py_XDECREF(x);
+    Py_XDECREF(f);
+    Py_XDECREF(g);
+    Py_XDECREF(nfev);
+    Py_XDECREF(nit);
+    Py_XDECREF(warnflag);
+    Py_XDECREF(task);
+    Py_XDECREF(s);
+    Py_XDECREF(y);
+    Py_XDECREF(nupd);
+    return ret;
+}
+
+
+static PyMethodDef lbfgsb_driver_methods[] = {
+    {"minimize", minimize, METH_VARARGS, NULL},
+    {NULL, NULL}
+};
+
+#if PY_VERSION_HEX >= 0x03000000
+static struct PyModuleDef moduledef = {
+    PyModuleDef_HEAD_INIT,
+    "_lbfgsb_driver",
+    NULL,
+    -1,
+    lbfgsb_driver_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+PyObject *PyInit__lbfgsb_driver(void)
+{
+    import_array();
+    return PyModule_Create(&moduledef);
+}
+#else
+PyMODINIT_FUNC init_lbfgsb_driver(void)
+{
+    import_array();
+    Py_InitModule("_lbfgsb_driver", lbfgsb_driver_methods);
+}
+#endif
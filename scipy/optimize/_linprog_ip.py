@@ -27,6 +27,7 @@ from warnings import warn
 from scipy.linalg import LinAlgError
 from .optimize import OptimizeWarning, OptimizeResult, _check_unknown_options
 from ._linprog_util import _postsolve
+from ._normal_eq import NormalEquations
 has_umfpack = True
 has_cholmod = True
 try:
@@ -40,7 +41,7 @@ except ImportError:
 
 
 def _get_solver(M, sparse=False, lstsq=False, sym_pos=True,
-                cholesky=True, permc_spec='MMD_AT_PLUS_A'):
+                cholesky=True, permc_spec='MMD_AT_PLUS_A', normal=None):
     """
     Given solver options, return a handle to the appropriate linear system
     solver.
@@ -74,6 +75,9 @@ def _get_solver(M, sparse=False, lstsq=False, sym_pos=True,
         - ``COLAMD``: approximate minimum degree column ordering.
 
         See SuperLU documentation.
+    normal : NormalEquations, optional
+        The object `M` was computed with, if any. Without scikit-sparse, its
+        Cholesky factorization is used for sparse `M`.
 
     Returns
     -------
@@ -87,7 +91,10 @@ def _get_solver(M, sparse=False, lstsq=False, sym_pos=True,
                 def solve(r, sym_pos=False):
                     return sps.linalg.lsqr(M, r)[0]
             elif cholesky:
-                solve = cholmod(M)
+                if has_cholmod or normal is None:
+                    solve = cholmod(M)
+                else:
+                    solve = normal.cholesky()
             else:
                 if has_umfpack and sym_pos:
                     solve = sps.linalg.factorized(M)
@@ -136,7 +143,8 @@ def _get_delta(
         cholesky=True,
         pc=True,
         ip=False,
-        permc_spec='MMD_AT_PLUS_A'
+        permc_spec='MMD_AT_PLUS_A',
+        normal=None
         ):
     """
     Given standard form problem defined by ``A``, ``b``, and ``c``;
@@ -189,6 +197,9 @@ def _get_delta(
         interior point algorithm; test different values to determine which
         performs best for your problem. For more information, refer to
         ``scipy.sparse.linalg.splu``.
+    normal : NormalEquations, optional
+        Forms the sparse normal equation matrix and factorizes it, reusing
+        the analysis of its sparsity pattern from previous iterations.
 
     Returns
     -------
@@ -217,11 +228,14 @@ def _get_delta(
     #  Assemble M from [4] Equation 8.31
     Dinv = x / z
 
-    if sparse:
+    if sparse and normal is not None:
+        M = normal.update(Dinv)
+    elif sparse:
         M = A.dot(sps.diags(Dinv, 0, format="csc").dot(A.T))
     else:
         M = A.dot(Dinv.reshape(-1, 1) * A.T)
-    solve = _get_solver(M, sparse, lstsq, sym_pos, cholesky, permc_spec)
+    solve = _get_solver(M, sparse, lstsq, sym_pos, cholesky, permc_spec,
+                        normal)
 
     # pc: "predictor-corrector" [4] Section 4.1
     # In development this option could be turned off
@@ -270,7 +284,8 @@ def _get_delta(
         # 3. scipy.linalg.solve w/ sym_pos = False, and if all else fails
         # 4. scipy.linalg.lstsq
         # For sparse systems, the order is:
-        # 1. sksparse.cholmod.cholesky (if available)
+        # 1. sksparse.cholmod.cholesky (if available) or the Cholesky
+        #    factorization of NormalEquations
         # 2. scipy.sparse.linalg.factorized (if umfpack available)
         # 3. scipy.sparse.linalg.splu
         # 4. scipy.sparse.linalg.lsqr
@@ -322,7 +337,7 @@ def _get_delta(
                 else:
                     raise e
                 solve = _get_solver(M, sparse, lstsq, sym_pos,
-                                    cholesky, permc_spec)
+                                    cholesky, permc_spec, normal)
         # [4] Results after 8.29
         d_tau = ((rhatg + 1 / tau * rhattk - (-c.dot(u) + b.dot(v))) /
                  (1 / tau * kappa + (-c.dot(p) + b.dot(q))))
@@ -567,7 +582,8 @@ def _display_iter(rho_p, rho_d, rho_g, alpha, rho_mu, obj, header=False):
 
 
 def _ip_hsd(A, b, c, c0, alpha0, beta, maxiter, disp, tol, sparse, lstsq,
-            sym_pos, cholesky, pc, ip, permc_spec, callback, _T_o):
+            sym_pos, cholesky, pc, ip, permc_spec, callback, _T_o,
+            workers=1):
     r"""
     Solve a linear programming problem in standard form:
 
@@ -677,6 +693,10 @@ def _ip_hsd(A, b, c, c0, alpha0, beta, maxiter, disp, tol, sparse, lstsq,
             message : str
                 A string descriptor of the exit status of the optimization.
 
+    workers : int
+        Number of threads forming the normal equation matrix of sparse
+        problems; -1 uses all CPUs.
+
     Returns
     -------
     x_hat : float
@@ -735,11 +755,14 @@ def _ip_hsd(A, b, c, c0, alpha0, beta, maxiter, disp, tol, sparse, lstsq,
     status = 0
     message = "Optimization terminated successfully."
 
+    normal = None
     if sparse:
         A = sps.csc_matrix(A)
         A.T = A.transpose()  # A.T is defined for sparse matrices but is slow
         # Redefine it to avoid calculating again
         # This is fine as long as A doesn't change
+        if A.shape[0] > 0:
+            normal = NormalEquations(A, permc_spec, workers)
 
     while go:
 
@@ -765,7 +788,8 @@ def _ip_hsd(A, b, c, c0, alpha0, beta, maxiter, disp, tol, sparse, lstsq,
             # Solve [4] 8.6 and 8.7/8.13/8.23
             d_x, d_y, d_z, d_tau, d_kappa = _get_delta(
                 A, b, c, x, y, z, tau, kappa, gamma, eta,
-                sparse, lstsq, sym_pos, cholesky, pc, ip, permc_spec)
+                sparse, lstsq, sym_pos, cholesky, pc, ip, permc_spec,
+                normal)
 
             if ip:  # initial point
                 # [4] 4.4
@@ -854,6 +878,7 @@ def _linprog_ip(
         pc=True,
         ip=False,
         permc_spec='MMD_AT_PLUS_A',
+        workers=1,
         **unknown_options):
     r"""
     Minimize a linear objective function subject to linear
@@ -934,6 +959,8 @@ def _linprog_ip(
         (Has effect only with ``sparse = True``, ``lstsq = False``, ``sym_pos =
         True``, and no SuiteSparse.)
         A matrix is factorized in each iteration of the algorithm.
+        With ``cholesky = True``, the ordering is determined once and reused
+        in all iterations.
         This option specifies how to permute the columns of the matrix for
         sparsity preservation. Acceptable values are:
 
@@ -946,6 +973,12 @@ def _linprog_ip(
         interior point algorithm; test different values to determine which
         performs best for your problem. For more information, refer to
         ``scipy.sparse.linalg.splu``.
+    workers : int (default = 1)
+        (Has effect only with ``sparse = True``.) Number of threads used to
+        form the normal equation matrix ``A D A^T`` in each iteration;
+        ``-1`` uses all available CPUs.
+
+        .. versionadded:: 1.4.0
     unkown_options : dict
         Optional arguments not used by this particular solver. If
         `unknown_options` is non-empty a warning is issued listing all
@@ -1014,7 +1047,10 @@ def _linprog_ip(
 
     For sparse problems:
 
-    1. ``sksparse.cholmod.cholesky`` (if scikit-sparse and SuiteSparse are installed)
+    1. ``sksparse.cholmod.cholesky`` (if scikit-sparse and SuiteSparse are
+       installed), otherwise a sparse Cholesky factorization distributed with
+       SciPy, the symbolic analysis of which is done once and reused in all
+       iterations.
 
     2. ``scipy.sparse.linalg.factorized`` (if scikit-umfpack and SuiteSparse are installed)
 
@@ -1107,13 +1143,6 @@ def _linprog_ip(
     _check_unknown_options(unknown_options)
 
     # These should be warnings, not errors
-    if (cholesky or cholesky is None) and sparse and not has_cholmod:
-        if cholesky:
-            warn("Sparse cholesky is only available with scikit-sparse. "
-                 "Setting `cholesky = False`",
-                 OptimizeWarning, stacklevel=3)
-        cholesky = False
-
     if sparse and lstsq:
         warn("Option combination 'sparse':True and 'lstsq':True "
              "is not recommended.",
@@ -1146,6 +1175,6 @@ def _linprog_ip(
                                             maxiter, disp, tol, sparse,
                                             lstsq, sym_pos, cholesky,
                                             pc, ip, permc_spec, callback,
-                                            _T_o)
+                                            _T_o, workers)
 
     return x, status, message, iteration
@@ -19,10 +19,13 @@ References
 
 from __future__ import division, absolute_import, print_function
 import numpy as np
+import scipy.sparse as sps
 from scipy.linalg import solve
+from scipy.sparse.linalg import splu
 from .optimize import _check_unknown_options
 from ._bglu_dense import LU
 from ._bglu_dense import BGLU as BGLU
+from ._bglu_sparse import SparseBGLU
 from scipy.linalg import LinAlgError
 from numpy.linalg.linalg import LinAlgError as LinAlgError2
 from ._linprog_util import _postsolve
@@ -71,6 +74,10 @@ def _phase_one(A, b, x0, maxiter, tol, maxupdate, mast, pivot, callback=None,
     # TODO: make solve more efficient with BGLU? This could take a while.
     keep_rows = np.ones(m, dtype=bool)
     for basis_column in basis[basis >= n]:
+        if sps.issparse(A):
+            status = _replace_artificial_column(A, basis, basis_column, n,
+                                                keep_rows, tol, status)
+            continue
         B = A[:, basis]
         try:
             basis_finder = np.abs(solve(B, A))  # inefficient
@@ -96,6 +103,42 @@ def _phase_one(A, b, x0, maxiter, tol, maxupdate, mast, pivot, callback=None,
     return x, basis, A, b, residual, status, iter_k
 
 
+def _replace_artificial_column(A, basis, basis_column, n, keep_rows, tol,
+                               status):
+    """
+    Sparse counterpart of one step of the loop in `_phase_one`. Only the row
+    of ``solve(B, A)`` belonging to the artificial basis column is needed,
+    which is ``A.T @ solve(B.T, e)`` for a unit vector ``e``.
+    """
+    try:
+        lu = splu(A[:, basis])
+    except RuntimeError:
+        return 4
+    pertinent_row = np.nonzero(basis == basis_column)[0][0]
+    e = np.zeros(len(basis))
+    e[pertinent_row] = 1
+    basis_finder = np.abs(A[:, :n].T.dot(lu.solve(e, trans='T')))
+    eligible_columns = np.ones(n, dtype=bool)
+    eligible_columns[basis[basis < n]] = 0
+    eligible_column_indices = np.where(eligible_columns)[0]
+    index = np.argmax(basis_finder[eligible_columns])
+    new_basis_column = eligible_column_indices[index]
+    if basis_finder[new_basis_column] < tol:
+        keep_rows[pertinent_row] = False
+    else:
+        basis[basis == basis_column] = new_basis_column
+    return status
+
+
+def _dense_columns(A, columns):
+    """
+    Returns columns of A, which may be a sparse matrix, as a 2D array.
+    """
+    if sps.issparse(A):
+        return A[:, columns].toarray()
+    return A[:, columns]
+
+
 def _get_more_basis_columns(A, basis):
     """
     Called when the auxiliary problem terminates with artificial columns in
@@ -113,7 +156,7 @@ def _get_more_basis_columns(A, basis):
 
     # form basis matrix
     B = np.zeros((m, m))
-    B[:, 0:len(basis)] = A[:, basis]
+    B[:, 0:len(basis)] = _dense_columns(A, basis)
 
     if (basis.size > 0 and
             np.linalg.matrix_rank(B[:, :len(basis)]) < len(basis)):
@@ -123,7 +166,8 @@ def _get_more_basis_columns(A, basis):
     for i in range(n):  # somewhat arbitrary, but we need another way out
         # permute the options, and take as many as needed
         new_basis = np.random.permutation(options)[:m-len(basis)]
-        B[:, len(basis):] = A[:, new_basis]  # update the basis matrix
+        # update the basis matrix
+        B[:, len(basis):] = _dense_columns(A, new_basis)
         rank = np.linalg.matrix_rank(B)      # check the rank
         if rank == m:
             break
@@ -165,7 +209,10 @@ def _generate_auxiliary_problem(A, b, x0, tol):
 
     r = b - A@x  # residual; this must be all zeros for feasibility
 
-    A[r < 0] = -A[r < 0]  # express problem with RHS positive for trivial BFS
+    if sps.issparse(A):  # express problem with RHS positive for trivial BFS
+        A = sps.diags(np.where(r < 0, -1., 1.)).dot(A).tocsc()
+    else:
+        A[r < 0] = -A[r < 0]
     b[r < 0] = -b[r < 0]  # to the auxiliary problem
     r[r < 0] *= -1
 
@@ -214,12 +261,20 @@ def _generate_auxiliary_problem(A, b, x0, tol):
     basis_ng_rows = np.concatenate((rows, arows))  # rows we need to zero
 
     # add auxiliary singleton columns
-    A = np.hstack((A, np.zeros((m, n_aux))))
-    A[arows, acols] = 1
+    if sps.issparse(A):
+        A_aux = sps.csc_matrix((np.ones(n_aux), (arows, np.arange(n_aux))),
+                               shape=(m, n_aux))
+        A = sps.hstack((A, A_aux), format="csc")
+        pivots = np.ones(len(basis_ng))
+        pivots[:len(cols)] = _entries(A, rows, cols)
+    else:
+        A = np.hstack((A, np.zeros((m, n_aux))))
+        A[arows, acols] = 1
+        pivots = A[basis_ng_rows, basis_ng]
 
     # generate initial BFS
     x = np.concatenate((x, np.zeros(n_aux)))
-    x[basis_ng] = r[basis_ng_rows]/A[basis_ng_rows, basis_ng]
+    x[basis_ng] = r[basis_ng_rows]/pivots
 
     # generate costs to minimize infeasibility
     c = np.zeros(n_aux + n)
@@ -242,6 +297,9 @@ def _select_singleton_columns(A, b):
     located. For each of these rows, returns the indices of the one singleton
     column and its corresponding row.
     """
+    if sps.issparse(A):
+        return _select_singleton_columns_sparse(A, b)
+
     # find indices of all singleton columns and corresponding row indicies
     column_indices = np.nonzero(np.sum(np.abs(A) != 0, axis=0) == 1)[0]
     columns = A[:, column_indices]          # array of singleton columns
@@ -266,6 +324,34 @@ def _select_singleton_columns(A, b):
     return column_indices[first_columns], unique_row_indices
 
 
+def _select_singleton_columns_sparse(A, b):
+    """
+    `_select_singleton_columns` for a sparse matrix A.
+    """
+    A = sps.csc_matrix(A, copy=True)   # explicit zeros are removed
+    A.eliminate_zeros()
+    column_indices = np.nonzero(np.diff(A.indptr) == 1)[0]
+    row_indices = A.indices[A.indptr[column_indices]]
+    values = A.data[A.indptr[column_indices]]
+
+    # see _select_singleton_columns
+    same_sign = values*b[row_indices] >= 0
+    column_indices = column_indices[same_sign][::-1]
+    row_indices = row_indices[same_sign][::-1]
+    unique_row_indices, first_columns = np.unique(row_indices,
+                                                  return_index=True)
+    return column_indices[first_columns], unique_row_indices
+
+
+def _entries(A, rows, cols):
+    """
+    Returns the elements ``A[rows[k], cols[k]]`` of a sparse matrix A.
+    """
+    if len(rows) == 0:
+        return np.zeros(0)
+    return np.asarray(A.tocsr()[rows, cols], dtype=float).ravel()
+
+
 def _find_nonzero_rows(A, tol):
     """
     Returns logical array indicating the locations of rows with at least
@@ -325,7 +411,12 @@ def _phase_two(c, A, x, b, maxiter, tol, maxupdate, mast, pivot, iteration=0,
     status = 0
     a = np.arange(n)                    # indices of columns of A
     ab = np.arange(m)                   # indices of columns of B
-    if maxupdate:
+    sparse = sps.issparse(A)
+    if sparse:
+        # sparse LU factorization with product form updates; with
+        # maxupdate = 0 it is refactorized after every update
+        B = SparseBGLU(A, b, maxupdate, mast)
+    elif maxupdate:
         # basis matrix factorization object; similar to B = A[:, b]
         B = BGLU(A, b, maxupdate, mast)
     else:
@@ -366,7 +457,10 @@ def _phase_two(c, A, x, b, maxiter, tol, maxupdate, mast, pivot, iteration=0,
             break
 
         # TODO: cythonize?
-        c_hat = c - v.dot(A)    # reduced cost
+        if sparse:
+            c_hat = c - A.T.dot(v)
+        else:
+            c_hat = c - v.dot(A)    # reduced cost
         c_hat = c_hat[~bl]
         # Above is much faster than:
         # N = A[:, ~bl]                 # slow!
@@ -377,7 +471,10 @@ def _phase_two(c, A, x, b, maxiter, tol, maxupdate, mast, pivot, iteration=0,
             break
 
         j = _select_enter_pivot(c_hat, bl, a, rule=pivot, tol=tol)
-        u = B.solve(A[:, j])        # similar to u = solve(B, A[:, j])
+        if sparse:
+            u = B.solve(A[:, j].toarray().ravel())
+        else:
+            u = B.solve(A[:, j])    # similar to u = solve(B, A[:, j])
 
         i = u > tol                 # if none of the u are positive, unbounded
         if not np.any(i):
@@ -400,7 +497,7 @@ def _phase_two(c, A, x, b, maxiter, tol, maxupdate, mast, pivot, iteration=0,
 
 def _linprog_rs(c, c0, A, b, x0=None, callback=None, maxiter=5000, tol=1e-12,
                 maxupdate=10, mast=False, pivot="mrc", _T_o=[], disp=False,
-                **unknown_options):
+                sparse=False, **unknown_options):
     """
     Solve the following linear programming problem via a two-phase
     revised simplex algorithm.::
@@ -485,6 +582,15 @@ def _linprog_rs(c, c0, A, b, x0=None, callback=None, maxiter=5000, tol=1e-12,
     disp : bool
         Set to ``True`` if indicators of optimization status are to be printed
         to the console each iteration.
+    sparse : bool
+        Set to ``True`` if the problem is to be treated as sparse; this is
+        done automatically if ``A`` is a sparse matrix. The basis matrix is
+        then factorized with `scipy.sparse.linalg.splu` and updated in
+        product form, so that the work per iteration depends on the number
+        of nonzeros rather than on the size of the basis. ``maxupdate`` and
+        ``mast`` control refactorization as in the dense case.
+
+        .. versionadded:: 1.4.0
     unkown_options : dict
         Optional arguments not used by this particular solver. If
         `unknown_options` is non-empty a warning is issued listing all
@@ -539,9 +645,12 @@ def _linprog_rs(c, c0, A, b, x0=None, callback=None, maxiter=5000, tol=1e-12,
     _T_o = list(_T_o)
     _T_o.insert(-1, False)
 
-    if A.size == 0:  # address test_unbounded_below_no_presolve_corrected
+    if 0 in A.shape:  # address test_unbounded_below_no_presolve_corrected
         return np.zeros(c.shape), 5, messages[5], 0
 
+    if sparse or sps.issparse(A):
+        A = sps.csc_matrix(A)
+
     x, basis, A, b, residual, status, iteration = (
         _phase_one(A, b, x0, maxiter, tol, maxupdate,
                    mast, pivot, callback, _T_o, disp))
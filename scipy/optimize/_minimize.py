@@ -17,6 +17,7 @@ from warnings import warn
 import numpy as np
 
 from scipy._lib.six import callable
+from scipy._lib._ccallback import LowLevelCallable
 
 # unconstrained minimization
 from .optimize import (_minimize_neldermead, _minimize_powell, _minimize_cg,
@@ -548,7 +549,7 @@ def minimize(fun, x0, args=(), method=None, jac=None, hess=None,
                      "options for 'jac'. Using '2-point' instead." % jac)
             jac = None
         elif not callable(jac):
-            if bool(jac):
+            if bool(jac) and not isinstance(fun, LowLevelCallable):
                 fun = MemoizeJac(fun)
                 jac = fun.derivative
             else:
@@ -0,0 +1,181 @@
+"""
+Normal equations of the interior-point method of linprog for sparse
+constraint matrices, with the sparsity analysis of ``A D A^T`` and of its
+Cholesky factorization done once. Used by ._linprog_ip.
+"""
+
+from __future__ import absolute_import
+
+from multiprocessing import cpu_count
+
+import numpy as np
+import scipy.sparse as sps
+from scipy.sparse.linalg import splu
+from scipy.linalg import LinAlgError
+
+cimport numpy as np
+from libc.stddef cimport ptrdiff_t
+
+np.import_array()
+
+
+cdef extern from "normal_eq.h":
+    int NORMAL_EQ_NOT_POSDEF
+    int NORMAL_EQ_NOMEM
+
+    ctypedef struct normal_eq_adat:
+        ptrdiff_t *Mp
+        ptrdiff_t *Mi
+
+    ctypedef struct normal_eq_chol:
+        pass
+
+    int normal_eq_adat_analyze(normal_eq_adat *S, ptrdiff_t m,
+                               const ptrdiff_t *Ap, const ptrdiff_t *Aj,
+                               const double *Ax, const ptrdiff_t *Bp,
+                               const ptrdiff_t *Bi, const double *Bx)
+    void normal_eq_adat_values(const normal_eq_adat *S, const double *d,
+                               double *Mx, int nthreads) nogil
+    void normal_eq_adat_free(normal_eq_adat *S)
+
+    int normal_eq_chol_analyze(normal_eq_chol *F, ptrdiff_t n,
+                               const ptrdiff_t *Mp, const ptrdiff_t *Mi,
+                               const ptrdiff_t *perm)
+    int normal_eq_chol_factor(normal_eq_chol *F, const double *Mx) nogil
+    void normal_eq_chol_solve(normal_eq_chol *F, double *b) nogil
+    void normal_eq_chol_free(normal_eq_chol *F)
+
+
+cdef class NormalEquations(object):
+    """
+    The matrices ``M = A @ diag(d) @ A.T`` for a fixed sparse ``A`` and
+    varying ``d``.
+
+    Parameters
+    ----------
+    A : sparse matrix
+        The constraint matrix.
+    permc_spec : str
+        Fill-reducing ordering for the Cholesky factorization, as for
+        `scipy.sparse.linalg.splu`. It is determined once, by SuperLU, from
+        the first matrix factorized.
+    workers : int
+        Number of threads computing the values of ``M``; -1 uses all CPUs.
+    """
+
+    cdef normal_eq_adat adat
+    cdef normal_eq_chol chol
+    cdef bint analyzed
+    cdef int nthreads
+    cdef public object permc_spec
+    cdef np.ndarray Mx, full_map
+    cdef object M
+
+    def __cinit__(self):
+        self.analyzed = False
+
+    def __init__(self, A, permc_spec='MMD_AT_PLUS_A', workers=1):
+        cdef ptrdiff_t m = A.shape[0]
+        A_csr = sps.csr_matrix(A)
+        A_csc = sps.csc_matrix(A)
+        cdef np.ndarray Ap = np.asarray(A_csr.indptr, dtype=np.intp)
+        cdef np.ndarray Aj = np.asarray(A_csr.indices, dtype=np.intp)
+        cdef np.ndarray Ax = np.asarray(A_csr.data, dtype=float)
+        cdef np.ndarray Bp = np.asarray(A_csc.indptr, dtype=np.intp)
+        cdef np.ndarray Bi = np.asarray(A_csc.indices, dtype=np.intp)
+        cdef np.ndarray Bx = np.asarray(A_csc.data, dtype=float)
+
+        ret = normal_eq_adat_analyze(&self.adat, m,
+                                     <ptrdiff_t *>np.PyArray_DATA(Ap),
+                                     <ptrdiff_t *>np.PyArray_DATA(Aj),
+                                     <double *>np.PyArray_DATA(Ax),
+                                     <ptrdiff_t *>np.PyArray_DATA(Bp),
+                                     <ptrdiff_t *>np.PyArray_DATA(Bi),
+                                     <double *>np.PyArray_DATA(Bx))
+        if ret == NORMAL_EQ_NOMEM:
+            raise MemoryError("could not allocate the pattern of A D A^T")
+
+        self.permc_spec = permc_spec
+        self.nthreads = cpu_count() if workers == -1 else max(int(workers), 1)
+
+        # M is returned with its full pattern; full_map gathers its values
+        # from those of the upper triangle
+        cdef ptrdiff_t k, nnz = self.adat.Mp[m]
+        Mp = np.empty(m + 1, dtype=np.intp)
+        Mi = np.empty(nnz, dtype=np.intp)
+        cdef np.intp_t[::1] Mp_v = Mp, Mi_v = Mi
+        for k in range(m + 1):
+            Mp_v[k] = self.adat.Mp[k]
+        for k in range(nnz):
+            Mi_v[k] = self.adat.Mi[k]
+        Mj = np.repeat(np.arange(m), np.diff(Mp))
+        strict = Mi != Mj
+        index = np.arange(1, nnz + 1, dtype=float)
+        full = sps.csc_matrix((np.concatenate((index, index[strict])),
+                               (np.concatenate((Mi, Mj[strict])),
+                                np.concatenate((Mj, Mi[strict])))),
+                              shape=(m, m))
+        self.full_map = full.data.astype(np.intp) - 1
+        self.M = full
+        self.Mx = np.empty(nnz)
+
+    def __dealloc__(self):
+        normal_eq_adat_free(&self.adat)
+        if self.analyzed:
+            normal_eq_chol_free(&self.chol)
+
+    def update(self, d):
+        """
+        Computes ``M = A @ diag(d) @ A.T`` and returns it as a CSC matrix.
+        """
+        cdef np.ndarray dd = np.ascontiguousarray(d, dtype=float)
+        cdef double *d_ptr = <double *>np.PyArray_DATA(dd)
+        cdef double *Mx_ptr = <double *>np.PyArray_DATA(self.Mx)
+
+        with nogil:
+            normal_eq_adat_values(&self.adat, d_ptr, Mx_ptr, self.nthreads)
+        self.M = sps.csc_matrix((self.Mx[self.full_map], self.M.indices,
+                                 self.M.indptr), shape=self.M.shape)
+        return self.M
+
+    def _analyze(self):
+        cdef ptrdiff_t m = self.M.shape[0]
+        cdef np.ndarray perm
+        try:
+            lu = splu(self.M, permc_spec=self.permc_spec,
+                      options=dict(SymmetricMode=True))
+            perm = np.argsort(lu.perm_c).astype(np.intp)
+        except RuntimeError:
+            perm = np.arange(m, dtype=np.intp)
+
+        ret = normal_eq_chol_analyze(&self.chol, m, self.adat.Mp,
+                                     self.adat.Mi,
+                                     <ptrdiff_t *>np.PyArray_DATA(perm))
+        if ret == NORMAL_EQ_NOMEM:
+            raise MemoryError("could not allocate the Cholesky factor")
+        self.analyzed = True
+
+    def cholesky(self):
+        """
+        Cholesky factorization of the last matrix returned by `update`.
+        Returns a function solving systems with it, or raises LinAlgError
+        if the matrix is not positive definite.
+        """
+        cdef double *Mx_ptr = <double *>np.PyArray_DATA(self.Mx)
+        cdef int ret
+
+        if not self.analyzed:
+            self._analyze()
+        with nogil:
+            ret = normal_eq_chol_factor(&self.chol, Mx_ptr)
+        if ret == NORMAL_EQ_NOT_POSDEF:
+            raise LinAlgError("matrix is not positive definite")
+        return self._solve
+
+    def _solve(self, r):
+        cdef np.ndarray x = np.array(r, dtype=float)
+        cdef double *x_ptr = <double *>np.PyArray_DATA(x)
+
+        with nogil:
+            normal_eq_chol_solve(&self.chol, x_ptr)
+        return x
@@ -5,6 +5,7 @@ from __future__ import division
 import numpy as np
 from numpy.linalg import norm
 
+from scipy._lib._util import MapWrapper
 from scipy.sparse.linalg import LinearOperator
 from ..sparse import issparse, csc_matrix, csr_matrix, coo_matrix, find
 from ._group_columns import group_dense, group_sparse
@@ -177,7 +178,8 @@ def group_columns(A, order=0):
 
 def approx_derivative(fun, x0, method='3-point', rel_step=None, f0=None,
                       bounds=(-np.inf, np.inf), sparsity=None,
-                      as_linear_operator=False, args=(), kwargs={}):
+                      as_linear_operator=False, args=(), kwargs={},
+                      workers=1):
     """Compute finite difference approximation of the derivatives of a
     vector-valued function.
 
@@ -250,6 +252,20 @@ def approx_derivative(fun, x0, method='3-point', rel_step=None, f0=None,
     args, kwargs : tuple and dict, optional
         Additional arguments passed to `fun`. Both empty by default.
         The calling signature is ``fun(x, *args, **kwargs)``.
+    workers : int or map-like callable, optional
+        If `workers` is an int the perturbed points, one for each column or
+        group of columns (two with the '3-point' method), are evaluated in
+        parallel on that many processes (uses
+        `multiprocessing.Pool <multiprocessing>`).
+        Supply -1 to use all cores available to the Process.
+        Alternatively supply a map-like callable, such as
+        `multiprocessing.pool.ThreadPool.map`, for evaluating them in
+        parallel. This evaluation is carried out as ``workers(fun, iterable)``.
+        Requires that `fun`, `args` and `kwargs` be pickleable if a process
+        pool is used. Parallel evaluation pays off when `fun` is expensive;
+        it is not used when `as_linear_operator` is True. Default is 1.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -344,12 +360,7 @@ def approx_derivative(fun, x0, method='3-point', rel_step=None, f0=None,
         raise ValueError("Bounds not supported when "
                          "`as_linear_operator` is True.")
 
-    def fun_wrapped(x):
-        f = np.atleast_1d(fun(x, *args, **kwargs))
-        if f.ndim > 1:
-            raise RuntimeError("`fun` return value has "
-                               "more than 1 dimension.")
-        return f
+    fun_wrapped = _Fun_Wrapper(fun, args, kwargs)
 
     if f0 is None:
         f0 = fun_wrapped(x0)
@@ -380,8 +391,9 @@ def approx_derivative(fun, x0, method='3-point', rel_step=None, f0=None,
             use_one_sided = False
 
         if sparsity is None:
-            return _dense_difference(fun_wrapped, x0, f0, h,
-                                     use_one_sided, method)
+            with MapWrapper(workers) as mapper:
+                return _dense_difference(fun_wrapped, x0, f0, h,
+                                         use_one_sided, method, mapper)
         else:
             if not issparse(sparsity) and len(sparsity) == 2:
                 structure, groups = sparsity
@@ -395,9 +407,28 @@ def approx_derivative(fun, x0, method='3-point', rel_step=None, f0=None,
                 structure = np.atleast_2d(structure)
 
             groups = np.atleast_1d(groups)
-            return _sparse_difference(fun_wrapped, x0, f0, h,
-                                      use_one_sided, structure,
-                                      groups, method)
+            with MapWrapper(workers) as mapper:
+                return _sparse_difference(fun_wrapped, x0, f0, h,
+                                          use_one_sided, structure,
+                                          groups, method, mapper)
+
+
+class _Fun_Wrapper(object):
+    """
+    Object to wrap the user function of approx_derivative, allowing
+    picklability
+    """
+    def __init__(self, fun, args, kwargs):
+        self.fun = fun
+        self.args = args
+        self.kwargs = kwargs
+
+    def __call__(self, x):
+        f = np.atleast_1d(self.fun(x, *self.args, **self.kwargs))
+        if f.ndim > 1:
+            raise RuntimeError("`fun` return value has "
+                               "more than 1 dimension.")
+        return f
 
 
 def _linear_operator_difference(fun, x0, f0, h, method):
@@ -441,33 +472,49 @@ def _linear_operator_difference(fun, x0, f0, h, method):
     return LinearOperator((m, n), matvec)
 
 
-def _dense_difference(fun, x0, f0, h, use_one_sided, method):
+def _dense_difference(fun, x0, f0, h, use_one_sided, method, mapper=map):
     m = f0.size
     n = x0.size
     J_transposed = np.empty((n, m))
     h_vecs = np.diag(h)
 
+    def points():
+        # The points at which fun is evaluated, in the order they are used
+        # below. They are generated lazily so that map holds one at a time.
+        for i in range(h.size):
+            if method == '2-point':
+                yield x0 + h_vecs[i]
+            elif method == '3-point' and use_one_sided[i]:
+                yield x0 + h_vecs[i]
+                yield x0 + 2 * h_vecs[i]
+            elif method == '3-point' and not use_one_sided[i]:
+                yield x0 - h_vecs[i]
+                yield x0 + h_vecs[i]
+            elif method == 'cs':
+                yield x0 + h_vecs[i]*1.j
+            else:
+                raise RuntimeError("Never be here.")
+
+    values = iter(mapper(fun, points()))
+
     for i in range(h.size):
+        # dx is recomputed as exactly representable number, the difference
+        # of the i-th components of the points.
         if method == '2-point':
-            x = x0 + h_vecs[i]
-            dx = x[i] - x0[i]  # Recompute dx as exactly representable number.
-            df = fun(x) - f0
+            dx = (x0[i] + h[i]) - x0[i]
+            df = next(values) - f0
         elif method == '3-point' and use_one_sided[i]:
-            x1 = x0 + h_vecs[i]
-            x2 = x0 + 2 * h_vecs[i]
-            dx = x2[i] - x0[i]
-            f1 = fun(x1)
-            f2 = fun(x2)
+            dx = (x0[i] + 2 * h[i]) - x0[i]
+            f1 = next(values)
+            f2 = next(values)
             df = -3.0 * f0 + 4 * f1 - f2
         elif method == '3-point' and not use_one_sided[i]:
-            x1 = x0 - h_vecs[i]
-            x2 = x0 + h_vecs[i]
-            dx = x2[i] - x1[i]
-            f1 = fun(x1)
-            f2 = fun(x2)
+            dx = (x0[i] + h[i]) - (x0[i] - h[i])
+            f1 = next(values)
+            f2 = next(values)
             df = f2 - f1
         elif method == 'cs':
-            f1 = fun(x0 + h_vecs[i]*1.j)
+            f1 = next(values)
             df = f1.imag
             dx = h_vecs[i, i]
         else:
@@ -482,13 +529,17 @@ def _dense_difference(fun, x0, f0, h, use_one_sided, method):
 
 
 def _sparse_difference(fun, x0, f0, h, use_one_sided,
-                       structure, groups, method):
+                       structure, groups, method, mapper=map):
     m = f0.size
     n = x0.size
     row_indices = []
     col_indices = []
     fractions = []
 
+    # First collect the points at which fun is evaluated, so that they can
+    # be evaluated together by mapper, and the steps of each group.
+    points = []
+    steps = []
     n_groups = np.max(groups) + 1
     for group in range(n_groups):
         # Perturb variables which are in the same group simultaneously.
@@ -497,14 +548,7 @@ def _sparse_difference(fun, x0, f0, h, use_one_sided,
         if method == '2-point':
             x = x0 + h_vec
             dx = x - x0
-            df = fun(x) - f0
-            # The result is  written to columns which correspond to perturbed
-            # variables.
-            cols, = np.nonzero(e)
-            # Find all non-zero elements in selected columns of Jacobian.
-            i, j, _ = find(structure[:, cols])
-            # Restore column indices in the full array.
-            j = cols[j]
+            points.append(x)
         elif method == '3-point':
             # Here we do conceptually the same but separate one-sided
             # and two-sided schemes.
@@ -523,12 +567,31 @@ def _sparse_difference(fun, x0, f0, h, use_one_sided,
             dx[mask_1] = x2[mask_1] - x0[mask_1]
             dx[mask_2] = x2[mask_2] - x1[mask_2]
 
-            f1 = fun(x1)
-            f2 = fun(x2)
+            points.append(x1)
+            points.append(x2)
+        elif method == 'cs':
+            dx = h_vec
+            points.append(x0 + h_vec*1.j)
+        else:
+            raise ValueError("Never be here.")
+        steps.append((e, dx))
+
+    values = iter(mapper(fun, points))
 
-            cols, = np.nonzero(e)
-            i, j, _ = find(structure[:, cols])
-            j = cols[j]
+    for e, dx in steps:
+        # The result is  written to columns which correspond to perturbed
+        # variables.
+        cols, = np.nonzero(e)
+        # Find all non-zero elements in selected columns of Jacobian.
+        i, j, _ = find(structure[:, cols])
+        # Restore column indices in the full array.
+        j = cols[j]
+
+        if method == '2-point':
+            df = next(values) - f0
+        elif method == '3-point':
+            f1 = next(values)
+            f2 = next(values)
 
             mask = use_one_sided[j]
             df = np.empty(m)
@@ -539,14 +602,8 @@ def _sparse_difference(fun, x0, f0, h, use_one_sided,
             rows = i[~mask]
             df[rows] = f2[rows] - f1[rows]
         elif method == 'cs':
-            f1 = fun(x0 + h_vec*1.j)
+            f1 = next(values)
             df = f1.imag
-            dx = h_vec
-            cols, = np.nonzero(e)
-            i, j, _ = find(structure[:, cols])
-            j = cols[j]
-        else:
-            raise ValueError("Never be here.")
 
         # All that's left is to compute the fraction. We store i, j and
         # fractions as separate arrays and later construct coo_matrix.
@@ -1,6 +1,7 @@
-from ._trlib import TRLIBQuadraticSubproblem
+from ._trlib import TRLIBQuadraticSubproblem, solve_subproblem_batch
 
-__all__ = ['TRLIBQuadraticSubproblem', 'get_trlib_quadratic_subproblem']
+__all__ = ['TRLIBQuadraticSubproblem', 'get_trlib_quadratic_subproblem',
+           'solve_subproblem_batch']
 
 
 def get_trlib_quadratic_subproblem(tol_rel_i=-2.0, tol_rel_b=-3.0, disp=False):
@@ -1,10 +1,128 @@
 from scipy.optimize._trustregion import (_minimize_trust_region, BaseQuadraticSubproblem)
+from multiprocessing import cpu_count
 import numpy as np
-from . cimport ctrlib
+import scipy.sparse
 cimport libc.stdio
+from libc.stddef cimport ptrdiff_t
 cimport numpy as np
 
 from scipy._lib.messagestream cimport MessageStream
+from scipy._lib.ccallback cimport (ccallback_t, ccallback_prepare,
+                                   ccallback_release, CCALLBACK_DEFAULTS,
+                                   ccallback_signature_t)
+
+np.import_array()
+
+
+cdef extern from "trlib_driver.h":
+    long TRLIB_DRIVER_FAIL_HESSP
+
+    ctypedef int (*trlib_driver_hessp_t)(ptrdiff_t k, long n, const double *p,
+                                         double *Hp, void *data)
+
+    ctypedef struct trlib_driver_csr:
+        const long *indptr
+        const long *indices
+        const double *data
+
+    ctypedef struct trlib_driver_work:
+        pass
+
+    int trlib_driver_csr_hessp(ptrdiff_t k, long n, const double *p,
+                               double *Hp, void *data) nogil
+    long trlib_driver_itmax(long n)
+    void trlib_driver_memory_size(long n, long itmax, long *iwork_size,
+                                  long *fwork_size)
+    void trlib_driver_init(trlib_driver_work *w, long n, long itmax,
+                           long *iwork, double *fwork)
+    long trlib_driver_solve(trlib_driver_work *w, double radius,
+                            const double *grad, trlib_driver_hessp_t hessp,
+                            ptrdiff_t k, void *data, double tol_rel_i,
+                            double tol_rel_b, long verbose,
+                            libc.stdio.FILE *fout, double *s,
+                            double *lam) nogil
+    long trlib_driver_solve_batch(ptrdiff_t nprob, long n,
+                                  const double *radius, const double *grad,
+                                  trlib_driver_hessp_t hessp, void *data,
+                                  double tol_rel_i, double tol_rel_b,
+                                  int nthreads, double *s, double *lam,
+                                  long *status) nogil
+
+
+# Hessian-vector products given as scipy.LowLevelCallable; the signatures
+# with value 1 take the index of the subproblem in the batch
+sigs = [
+    (b"int (int, double *, double *, void *)", 0),
+    (b"int (int, double *, double *, intptr_t, void *)", 1),
+    (b"int (int, double *, double *, npy_intp, void *)", 1),
+]
+
+if sizeof(np.npy_intp) == sizeof(int):
+    sigs.append((b"int (int, double *, double *, int, void *)", 1))
+if sizeof(np.npy_intp) == sizeof(long):
+    sigs.append((b"int (int, double *, double *, long, void *)", 1))
+if sizeof(np.npy_intp) == sizeof(long long):
+    sigs.append((b"int (int, double *, double *, long long, void *)", 1))
+
+cdef ccallback_signature_t signatures[7]
+
+for idx, sig in enumerate(sigs):
+    signatures[idx].signature = sig[0]
+    signatures[idx].value = sig[1]
+
+signatures[idx + 1].signature = NULL
+
+
+cdef int _lowlevel_hessp(ptrdiff_t k, long n, const double *p, double *Hp,
+                         void *data) nogil:
+    cdef ccallback_t *callback = <ccallback_t *>data
+
+    if callback.signature.value == 0:
+        return (<int(*)(int, double *, double *, void *) nogil>callback.c_function)(
+            n, <double *>p, Hp, callback.user_data)
+    return (<int(*)(int, double *, double *, np.npy_intp, void *) nogil>callback.c_function)(
+        n, <double *>p, Hp, k, callback.user_data)
+
+
+cdef int _python_hessp(ptrdiff_t k, long n, const double *p, double *Hp,
+                       void *data):
+    # data is a list [hessp]; an exception raised by hessp is appended to it
+    cdef list state = <object>data
+
+    try:
+        Hp_arr = np.asarray(<double[:n]>Hp)
+        Hp_arr[...] = state[0](np.array(<double[:n]><double *>p))
+    except BaseException as e:
+        state.append(e)
+        return -1
+    return 0
+
+
+cdef class _KrylovWorkspace:
+    # The workspace of trlib_driver_solve, kept between the solves of a
+    # subproblem with different radii
+
+    cdef trlib_driver_work work
+    cdef np.ndarray iwork, fwork
+
+    def __cinit__(self, long n, long itmax):
+        cdef long iwork_size, fwork_size
+
+        trlib_driver_memory_size(n, itmax, &iwork_size, &fwork_size)
+        self.iwork = np.empty([iwork_size], dtype=np.int_)
+        self.fwork = np.empty([fwork_size])
+        trlib_driver_init(&self.work, n, itmax,
+                          <long *>np.PyArray_DATA(self.iwork),
+                          <double *>np.PyArray_DATA(self.fwork))
+
+
+def _csr_arrays(H, n):
+    H = scipy.sparse.csr_matrix(H)
+    if H.shape != (n, n):
+        raise ValueError("the Hessian must be of shape (%d, %d)" % (n, n))
+    return (np.ascontiguousarray(H.indptr, dtype=np.int_),
+            np.ascontiguousarray(H.indices, dtype=np.int_),
+            np.ascontiguousarray(H.data, dtype=np.float64))
 
 
 class TRLIBQuadraticSubproblem(BaseQuadraticSubproblem):
@@ -15,136 +133,180 @@ class TRLIBQuadraticSubproblem(BaseQuadraticSubproblem):
         self.tol_rel_i = tol_rel_i
         self.tol_rel_b = tol_rel_b
         self.disp = disp
-        self.itmax = int(min(1e9/self.jac.shape[0], 2*self.jac.shape[0]))
-        cdef long itmax, iwork_size, fwork_size, h_pointer
-        itmax = self.itmax
-        ctrlib.trlib_krylov_memory_size(itmax, &iwork_size, &fwork_size,
-                                        &h_pointer)
-        self.h_pointer = h_pointer
-        self.fwork = np.empty([fwork_size])
-        cdef double [:] fwork_view = self.fwork
-        cdef double *fwork_ptr = NULL
-        if fwork_view.shape[0] > 0:
-            fwork_ptr = &fwork_view[0]
-        ctrlib.trlib_krylov_prepare_memory(itmax, fwork_ptr)
-        self.iwork = np.zeros([iwork_size], dtype=np.int)
-        self.s  = np.empty(self.jac.shape)
-        self.g  = np.empty(self.jac.shape)
-        self.v  = np.empty(self.jac.shape)
-        self.gm = np.empty(self.jac.shape)
-        self.p  = np.empty(self.jac.shape)
-        self.Hp = np.empty(self.jac.shape)
-        self.Q  = np.empty([self.itmax+1, self.jac.shape[0]])
-        self.timing = np.zeros([ctrlib.trlib_krylov_timing_size()],
-                               dtype=np.int)
-        self.init = ctrlib._TRLIB_CLS_INIT
+        self.itmax = trlib_driver_itmax(self.jac.shape[0])
+        self.work = _KrylovWorkspace(self.jac.shape[0], self.itmax)
+        self.csr = None
 
     def solve(self, double trust_radius):
 
-        cdef long equality = 0
-        cdef long itmax_lanczos = 100
+        cdef _KrylovWorkspace work = self.work
+        cdef long n = self.jac.shape[0]
+        cdef long verbose = 0
+        cdef long ret
+        cdef double lam = 0.0
         cdef double tol_r_i = self.tol_rel_i
-        cdef double tol_a_i =  0.0 
         cdef double tol_r_b = self.tol_rel_b
-        cdef double tol_a_b =  0.0 
-        cdef double zero = 2e-16
-        cdef double obj_lb = -1e20
-        cdef long ctl_invariant = 0
-        cdef long convexify = 1
-        cdef long earlyterm = 1
-        cdef double g_dot_g = 0.0
-        cdef double v_dot_g = 0.0
-        cdef double p_dot_Hp = 0.0
-        cdef long refine = 1
-        cdef long verbose = 0
-        cdef long unicode = 1
-        cdef long ret = 0
-        cdef long action = 0
-        cdef long it = 0
-        cdef long ityp = 0
-        cdef long itmax = self.itmax
-        cdef long init  = self.init
-        cdef double flt1 = 0.0
-        cdef double flt2 = 0.0
-        cdef double flt3 = 0.0
-        prefix = b""
-        cdef long   [:] iwork_view  = self.iwork
-        cdef double [:] fwork_view  = self.fwork
-        cdef long   [:] timing_view = self.timing
-        cdef long   *iwork_ptr = NULL
-        cdef double *fwork_ptr = NULL
-        cdef long   *timing_ptr = NULL
+        cdef np.ndarray jac = np.ascontiguousarray(self.jac, dtype=np.float64)
+        cdef np.ndarray s = np.empty([n])
+        cdef double *jac_ptr = <double *>np.PyArray_DATA(jac)
+        cdef double *s_ptr = <double *>np.PyArray_DATA(s)
+        cdef trlib_driver_csr csr
+        cdef list state
+        cdef MessageStream messages = None
+        cdef libc.stdio.FILE *fout = NULL
 
         if self.disp:
             verbose = 2
+            messages = MessageStream()
+            fout = messages.handle
 
-        if iwork_view.shape[0] > 0:
-            iwork_ptr = &iwork_view[0]
-        if fwork_view.shape[0] > 0:
-            fwork_ptr = &fwork_view[0]
-        if timing_view.shape[0] > 0:
-            timing_ptr = &timing_view[0]
-
-        cdef MessageStream messages = MessageStream()
         try:
-            while True:
-                messages.clear()
-                ret = ctrlib.trlib_krylov_min(init, trust_radius, equality,
-                          itmax, itmax_lanczos, tol_r_i, tol_a_i,
-                          tol_r_b, tol_a_b, zero, obj_lb, ctl_invariant,
-                          convexify, earlyterm, g_dot_g, v_dot_g, p_dot_Hp,
-                          iwork_ptr, fwork_ptr, refine, verbose, unicode,
-                          prefix, messages.handle,
-                          timing_ptr, &action, &it, &ityp, &flt1, &flt2, &flt3)
-                if self.disp:
-                    msg = messages.get()
-                    if msg:
-                        print(msg)
-
-                init = 0
-                if action == ctrlib._TRLIB_CLA_INIT:
-                    self.s[:]  = 0.0
-                    self.gm[:] = 0.0
-                    self.g[:]  = self.jac
-                    self.v[:]  = self.g
-                    g_dot_g = np.dot(self.g, self.g)
-                    v_dot_g = np.dot(self.v, self.g)
-                    self.p[:]  = - self.v
-                    self.Hp[:] = self.hessp(self.p)
-                    p_dot_Hp = np.dot(self.p, self.Hp)
-                    self.Q[0,:] = self.v/np.sqrt(v_dot_g)
-                if action == ctrlib._TRLIB_CLA_RETRANSF:
-                    self.s[:] = np.dot(self.fwork[self.h_pointer:self.h_pointer+it+1],
-                                       self.Q[:it+1,:])
-                if action == ctrlib._TRLIB_CLA_UPDATE_STATIO:
-                    if ityp == ctrlib._TRLIB_CLT_CG:
-                        self.s += flt1 * self.p
-                if action == ctrlib._TRLIB_CLA_UPDATE_GRAD:
-                    if ityp == ctrlib._TRLIB_CLT_CG:
-                        self.Q[it,:] = flt2*self.v
-                        self.gm[:] = self.g
-                        self.g    += flt1*self.Hp
-                    if ityp == ctrlib._TRLIB_CLT_L:
-                        self.s[:]  = self.Hp + flt1*self.g + flt2*self.gm
-                        self.gm[:] = flt3*self.g
-                        self.g[:]  = self.s
-                    self.v[:] = self.g
-                    g_dot_g = np.dot(self.g, self.g)
-                    v_dot_g = np.dot(self.v, self.g)
-                if action == ctrlib._TRLIB_CLA_UPDATE_DIR:
-                    self.p[:]  = flt1 * self.v + flt2 * self.p
-                    self.Hp[:] = self.hessp(self.p)
-                    p_dot_Hp = np.dot(self.p, self.Hp)
-                    if ityp == ctrlib._TRLIB_CLT_L:
-                        self.Q[it,:] = self.p
-                if action == ctrlib._TRLIB_CLA_OBJVAL:
-                    g_dot_g = .5*np.dot(self.s, self.hessp(self.s))
-                    g_dot_g += np.dot(self.s, self.jac)
-                if ret < 10:
-                    break
-                self.init = ctrlib._TRLIB_CLS_HOTSTART
-            self.lam = self.fwork[7]
+            if self._hessp is None and scipy.sparse.issparse(self.hess):
+                # Sparse Hessians are multiplied in compiled code
+                if self.csr is None:
+                    self.csr = _csr_arrays(self.hess, n)
+                csr.indptr = <long *>np.PyArray_DATA(self.csr[0])
+                csr.indices = <long *>np.PyArray_DATA(self.csr[1])
+                csr.data = <double *>np.PyArray_DATA(self.csr[2])
+                with nogil:
+                    ret = trlib_driver_solve(
+                        &work.work, trust_radius, jac_ptr,
+                        trlib_driver_csr_hessp, 0, &csr, tol_r_i, tol_r_b,
+                        verbose, fout, s_ptr, &lam)
+            else:
+                state = [self.hessp]
+                ret = trlib_driver_solve(
+                    &work.work, trust_radius, jac_ptr, _python_hessp, 0,
+                    <void *>state, tol_r_i, tol_r_b, verbose, fout, s_ptr,
+                    &lam)
+                if ret == TRLIB_DRIVER_FAIL_HESSP:
+                    raise state[1]
+            if self.disp:
+                msg = messages.get()
+                if msg:
+                    print(msg)
         finally:
-            messages.close()
+            if messages is not None:
+                messages.close()
 
+        self.s = s
+        self.lam = lam
         return self.s, self.lam > 0.0
+
+
+def solve_subproblem_batch(jac, trust_radius, hess=None, hessp=None,
+                           tol_rel_i=-2.0, tol_rel_b=-3.0, workers=1):
+    """
+    Solve a batch of independent trust-region subproblems with trlib.
+
+    Minimizes ``jac[k] @ s + 0.5 * s @ H_k @ s`` subject to
+    ``norm(s) <= trust_radius[k]`` for each ``k``, running the Krylov
+    iteration of `TRLIBQuadraticSubproblem` in compiled code on a pool of
+    threads.
+
+    Parameters
+    ----------
+    jac : array_like, shape (nprob, n)
+        Gradients of the subproblems.
+    trust_radius : array_like, shape (nprob,)
+        Trust radii, broadcast against the number of subproblems.
+    hess : sequence of nprob (n, n) matrices, optional
+        Hessians, dense or sparse. They are converted to CSR format.
+    hessp : scipy.LowLevelCallable, optional
+        Hessian-vector products, computing ``Hp = H_k @ p``, with one of
+        the signatures::
+
+            int hessp(int n, double *p, double *Hp, void *user_data)
+            int hessp(int n, double *p, double *Hp, npy_intp k, void *user_data)
+
+        returning 0 on success. It is called from several threads at once
+        if ``workers > 1``.
+    tol_rel_i, tol_rel_b : float, optional
+        Tolerances of `trlib_krylov_min` for interior and boundary
+        convergence, see ``_trlib/trlib/trlib_krylov.h``.
+    workers : int, optional
+        Number of threads, -1 for one per CPU.
+
+    Returns
+    -------
+    s : ndarray, shape (nprob, n)
+        The steps.
+    hits_boundary : ndarray of bool, shape (nprob,)
+        Whether each step lies on the boundary of its trust region.
+    status : ndarray of int, shape (nprob,)
+        The return codes of `trlib_krylov_min`, nonnegative on convergence.
+        They are -100 where `hessp` returned nonzero.
+
+    """
+    cdef np.ndarray jac_arr, radius, s, lam, status
+    cdef np.npy_intp nprob, k
+    cdef long n, ret
+    cdef int nthreads
+    cdef double tol_r_i = tol_rel_i
+    cdef double tol_r_b = tol_rel_b
+    cdef double *radius_ptr
+    cdef double *jac_ptr
+    cdef double *s_ptr
+    cdef double *lam_ptr
+    cdef long *status_ptr
+    cdef trlib_driver_csr *csr = NULL
+    cdef ccallback_t callback
+    cdef void *data
+    cdef trlib_driver_hessp_t hessp_func
+
+    if (hess is None) == (hessp is None):
+        raise ValueError("exactly one of hess and hessp must be given")
+
+    jac_arr = np.ascontiguousarray(jac, dtype=np.float64)
+    if jac_arr.ndim != 2 or jac_arr.shape[1] == 0:
+        raise ValueError("jac must be a nonempty array of shape (nprob, n)")
+    nprob = jac_arr.shape[0]
+    n = jac_arr.shape[1]
+    radius = np.ascontiguousarray(
+        np.broadcast_to(np.asarray(trust_radius, dtype=np.float64), (nprob,)))
+
+    nthreads = cpu_count() if workers == -1 else max(int(workers), 1)
+
+    s = np.zeros([nprob, n])
+    lam = np.zeros([nprob])
+    status = np.empty([nprob], dtype=np.int_)
+
+    if hess is not None:
+        if len(hess) != nprob:
+            raise ValueError("hess must hold one matrix per subproblem")
+        arrays = [_csr_arrays(H, n) for H in hess]
+        csr_buf = np.empty([max(nprob, 1) * sizeof(trlib_driver_csr)],
+                           dtype=np.uint8)
+        csr = <trlib_driver_csr *>np.PyArray_DATA(csr_buf)
+        for k in range(nprob):
+            csr[k].indptr = <long *>np.PyArray_DATA(arrays[k][0])
+            csr[k].indices = <long *>np.PyArray_DATA(arrays[k][1])
+            csr[k].data = <double *>np.PyArray_DATA(arrays[k][2])
+        hessp_func = trlib_driver_csr_hessp
+        data = csr
+    else:
+        ccallback_prepare(&callback, signatures, hessp, CCALLBACK_DEFAULTS)
+        if callback.py_function != NULL:
+            ccallback_release(&callback)
+            raise ValueError("hessp must be a scipy.LowLevelCallable")
+        hessp_func = _lowlevel_hessp
+        data = &callback
+
+    radius_ptr = <double *>np.PyArray_DATA(radius)
+    jac_ptr = <double *>np.PyArray_DATA(jac_arr)
+    s_ptr = <double *>np.PyArray_DATA(s)
+    lam_ptr = <double *>np.PyArray_DATA(lam)
+    status_ptr = <long *>np.PyArray_DATA(status)
+    try:
+        with nogil:
+            ret = trlib_driver_solve_batch(nprob, n, radius_ptr, jac_ptr,
+                                           hessp_func, data, tol_r_i, tol_r_b,
+                                           nthreads, s_ptr, lam_ptr,
+                                           status_ptr)
+    finally:
+        if hess is None:
+            ccallback_release(&callback)
+
+    if ret != 0:
+        raise MemoryError()
+    return s, lam > 0.0, status
@@ -14,8 +14,13 @@ def configuration(parent_package='', top_path=None):
     config.add_extension('_trlib',
                          sources=['_trlib.c', 'trlib_krylov.c',
                                   'trlib_eigen_inverse.c', 'trlib_leftmost.c',
-                                  'trlib_quadratic_zero.c', 'trlib_tri_factor.c'],
-                         include_dirs=[get_include(), lib_inc, 'trlib'],
+                                  'trlib_quadratic_zero.c', 'trlib_tri_factor.c',
+                                  'trlib_driver.c'],
+                         include_dirs=[get_include(), lib_inc,
+                                       join(lib_inc, 'src'), 'trlib',
+                                       join('..', 'Zeros')],
+                         depends=['trlib_driver.h',
+                                  join('..', 'Zeros', 'zeros_threads.h')],
                          extra_info=lapack_opt,
                          )
     return config
@@ -0,0 +1,294 @@
+/*
+ * Compiled driver of trlib_krylov_min, see trlib_driver.h.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trlib_driver.h"
+#include "zeros_threads.h"
+
+
+int
+trlib_driver_csr_hessp(ptrdiff_t k, trlib_int_t n, const double *p,
+                       double *Hp, void *data)
+{
+    const trlib_driver_csr *H = (const trlib_driver_csr *)data + k;
+    trlib_int_t i, j;
+
+    for (i = 0; i < n; i++) {
+        double sum = 0.0;
+
+        for (j = H->indptr[i]; j < H->indptr[i + 1]; j++) {
+            sum += H->data[j] * p[H->indices[j]];
+        }
+        Hp[i] = sum;
+    }
+    return 0;
+}
+
+trlib_int_t
+trlib_driver_itmax(trlib_int_t n)
+{
+    double itmax = 1e9 / n;
+
+    if (itmax > 2.0 * n) {
+        itmax = 2.0 * n;
+    }
+    return (trlib_int_t)itmax;
+}
+
+void
+trlib_driver_memory_size(trlib_int_t n, trlib_int_t itmax,
+                         trlib_int_t *iwork_size, trlib_int_t *fwork_size)
+{
+    trlib_int_t h_pointer;
+
+    trlib_krylov_memory_size(itmax, iwork_size, fwork_size, &h_pointer);
+    *iwork_size += trlib_krylov_timing_size();
+    *fwork_size += (7 + itmax) * n;
+}
+
+void
+trlib_driver_init(trlib_driver_work *w, trlib_int_t n, trlib_int_t itmax,
+                  trlib_int_t *iwork, double *fwork)
+{
+    trlib_int_t iwork_size, fwork_size;
+
+    trlib_krylov_memory_size(itmax, &iwork_size, &fwork_size, &w->h_pointer);
+    memset(iwork, 0, (iwork_size + trlib_krylov_timing_size())
+                     * sizeof(trlib_int_t));
+    trlib_krylov_prepare_memory(itmax, fwork);
+    w->n = n;
+    w->itmax = itmax;
+    w->init = TRLIB_CLS_INIT;
+    w->iwork = iwork;
+    w->timing = iwork + iwork_size;
+    w->fwork = fwork;
+    w->g = fwork + fwork_size;
+    w->v = w->g + n;
+    w->gm = w->v + n;
+    w->p = w->gm + n;
+    w->Hp = w->p + n;
+    w->Hs = w->Hp + n;
+    w->Q = w->Hs + n;
+}
+
+static double
+dot(trlib_int_t n, const double *a, const double *b)
+{
+    double sum = 0.0;
+    trlib_int_t i;
+
+    for (i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+/* The reverse communication of trlib_krylov_min, as in _trlib.pyx */
+trlib_int_t
+trlib_driver_solve(trlib_driver_work *w, double radius, const double *grad,
+                   trlib_driver_hessp_t hessp, ptrdiff_t k, void *data,
+                   double tol_rel_i, double tol_rel_b, trlib_int_t verbose,
+                   FILE *fout, double *s, double *lam)
+{
+    trlib_int_t n = w->n, init = w->init, i, j;
+    trlib_int_t ret, action = 0, it = 0, ityp = 0;
+    double g_dot_g = 0.0, v_dot_g = 0.0, p_dot_Hp = 0.0;
+    double flt1 = 0.0, flt2 = 0.0, flt3 = 0.0;
+    double *g = w->g, *v = w->v, *gm = w->gm, *p = w->p, *Hp = w->Hp;
+    double *Q = w->Q;
+    char prefix[] = "";
+
+    for (;;) {
+        ret = trlib_krylov_min(init, radius, 0, w->itmax, 100,
+                               tol_rel_i, 0.0, tol_rel_b, 0.0, 2e-16, -1e20,
+                               0, 1, 1, g_dot_g, v_dot_g, p_dot_Hp,
+                               w->iwork, w->fwork, 1, verbose, 1, prefix,
+                               fout, w->timing, &action, &it, &ityp,
+                               &flt1, &flt2, &flt3);
+        init = 0;
+        switch (action) {
+        case TRLIB_CLA_INIT:
+            for (i = 0; i < n; i++) {
+                s[i] = 0.0;
+                gm[i] = 0.0;
+                g[i] = grad[i];
+                v[i] = g[i];
+                p[i] = -v[i];
+            }
+            g_dot_g = dot(n, g, g);
+            v_dot_g = dot(n, v, g);
+            if (hessp(k, n, p, Hp, data) != 0) {
+                return TRLIB_DRIVER_FAIL_HESSP;
+            }
+            p_dot_Hp = dot(n, p, Hp);
+            for (i = 0; i < n; i++) {
+                Q[i] = v[i] / sqrt(v_dot_g);
+            }
+            break;
+        case TRLIB_CLA_RETRANSF:
+            {
+                const double *h = w->fwork + w->h_pointer;
+
+                for (i = 0; i < n; i++) {
+                    s[i] = 0.0;
+                }
+                for (j = 0; j <= it; j++) {
+                    for (i = 0; i < n; i++) {
+                        s[i] += h[j] * Q[j*n + i];
+                    }
+                }
+            }
+            break;
+        case TRLIB_CLA_UPDATE_STATIO:
+            if (ityp == TRLIB_CLT_CG) {
+                for (i = 0; i < n; i++) {
+                    s[i] += flt1 * p[i];
+                }
+            }
+            break;
+        case TRLIB_CLA_UPDATE_GRAD:
+            if (ityp == TRLIB_CLT_CG) {
+                for (i = 0; i < n; i++) {
+                    Q[it*n + i] = flt2 * v[i];
+                    gm[i] = g[i];
+                    g[i] += flt1 * Hp[i];
+                }
+            }
+            if (ityp == TRLIB_CLT_L) {
+                /* s is only needed after TRLIB_CLA_RETRANSF */
+                for (i = 0; i < n; i++) {
+                    s[i] = Hp[i] + flt1 * g[i] + flt2 * gm[i];
+                    gm[i] = flt3 * g[i];
+                    g[i] = s[i];
+                }
+            }
+            for (i = 0; i < n; i++) {
+                v[i] = g[i];
+            }
+            g_dot_g = dot(n, g, g);
+            v_dot_g = dot(n, v, g);
+            break;
+        case TRLIB_CLA_UPDATE_DIR:
+            for (i = 0; i < n; i++) {
+                p[i] = flt1 * v[i] + flt2 * p[i];
+            }
+            if (hessp(k, n, p, Hp, data) != 0) {
+                return TRLIB_DRIVER_FAIL_HESSP;
+            }
+            p_dot_Hp = dot(n, p, Hp);
+            if (ityp == TRLIB_CLT_L) {
+                memcpy(Q + it*n, p, n * sizeof(double));
+            }
+            break;
+        case TRLIB_CLA_OBJVAL:
+            if (hessp(k, n, s, w->Hs, data) != 0) {
+                return TRLIB_DRIVER_FAIL_HESSP;
+            }
+            g_dot_g = 0.5 * dot(n, s, w->Hs) + dot(n, s, grad);
+            break;
+        }
+        if (ret < 10) {
+            break;
+        }
+        w->init = TRLIB_CLS_HOTSTART;
+    }
+    *lam = w->fwork[7];
+    return ret;
+}
+
+
+typedef struct {
+    ptrdiff_t nprob;
+    trlib_int_t n;
+    const double *radius, *grad;
+    trlib_driver_hessp_t hessp;
+    void *data;
+    double tol_rel_i, tol_rel_b;
+    double *s, *lam;
+    trlib_int_t *status;
+    /* shared between the threads */
+    zeros_mutex lock;
+    ptrdiff_t next;
+    int nomem;
+} trlib_driver_batch;
+
+static void
+batch_thread(void *arg)
+{
+    trlib_driver_batch *b = (trlib_driver_batch *)arg;
+    trlib_int_t n = b->n, itmax = trlib_driver_itmax(n);
+    trlib_int_t iwork_size, fwork_size;
+    trlib_int_t *iwork;
+    double *fwork;
+    trlib_driver_work w;
+    ptrdiff_t k;
+
+    trlib_driver_memory_size(n, itmax, &iwork_size, &fwork_size);
+    iwork = malloc(iwork_size * sizeof(trlib_int_t));
+    fwork = malloc(fwork_size * sizeof(double));
+
+    for (;;) {
+        zeros_mutex_lock(&b->lock);
+        if (iwork == NULL || fwork == NULL) {
+            b->nomem = 1;
+        }
+        k = b->next++;
+        if (b->nomem || k >= b->nprob) {
+            zeros_mutex_unlock(&b->lock);
+            break;
+        }
+        zeros_mutex_unlock(&b->lock);
+
+        trlib_driver_init(&w, n, itmax, iwork, fwork);
+        b->status[k] = trlib_driver_solve(&w, b->radius[k], b->grad + k*n,
+                                          b->hessp, k, b->data,
+                                          b->tol_rel_i, b->tol_rel_b, 0, NULL,
+                                          b->s + k*n, b->lam + k);
+    }
+    free(iwork);
+    free(fwork);
+}
+
+trlib_int_t
+trlib_driver_solve_batch(ptrdiff_t nprob, trlib_int_t n, const double *radius,
+                         const double *grad, trlib_driver_hessp_t hessp,
+                         void *data, double tol_rel_i, double tol_rel_b,
+                         int nthreads, double *s, double *lam,
+                         trlib_int_t *status)
+{
+    trlib_driver_batch b;
+    ptrdiff_t k;
+
+    b.nprob = nprob;
+    b.n = n;
+    b.radius = radius;
+    b.grad = grad;
+    b.hessp = hessp;
+    b.data = data;
+    b.tol_rel_i = tol_rel_i;
+    b.tol_rel_b = tol_rel_b;
+    b.s = s;
+    b.lam = lam;
+    b.status = status;
+    b.next = 0;
+    b.nomem = 0;
+    for (k = 0; k < nprob; k++) {
+        status[k] = TRLIB_DRIVER_NOMEM;
+    }
+
+    if (nthreads > nprob) {
+        nthreads = nprob > 1 ? (int)nprob : 1;
+    }
+    if (nthreads < 1) {
+        nthreads = 1;
+    }
+    zeros_mutex_init(&b.lock);
+    zeros_run_threads(nthreads, batch_thread, &b);
+    zeros_mutex_destroy(&b.lock);
+
+    return b.nomem ? TRLIB_DRIVER_NOMEM : 0;
+}
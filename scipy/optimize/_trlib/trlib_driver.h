@@ -0,0 +1,101 @@
+/*
+ * Compiled driver of trlib_krylov_min.
+ *
+ * trlib_driver_solve runs the whole reverse-communication cycle of
+ * trlib_krylov_min for one trust-region subproblem
+ *
+ *     min  g^T s + 1/2 s^T H s   subject to  ||s|| <= radius,
+ *
+ * given the gradient g and a function computing products with H, as the
+ * loop of TRLIBQuadraticSubproblem.solve does in Python. Its workspace
+ * is supplied by the caller and kept between calls, so that the solve
+ * with a smaller radius after a rejected step is hotstarted.
+ *
+ * trlib_driver_solve_batch solves independent subproblems of the same
+ * dimension on a number of threads.
+ */
+#ifndef TRLIB_DRIVER_H
+#define TRLIB_DRIVER_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "trlib.h"
+
+/* Returned instead of a TRLIB_CLR_* code when hessp fails */
+#define TRLIB_DRIVER_FAIL_HESSP (-100)
+/* Returned when the workspace of a batch cannot be allocated */
+#define TRLIB_DRIVER_NOMEM      (-101)
+
+/*
+ * Stores H_k p in Hp for the subproblem k of a batch (k = 0 for a single
+ * one). Returns 0 on success; anything else stops that subproblem with
+ * TRLIB_DRIVER_FAIL_HESSP.
+ */
+typedef int (*trlib_driver_hessp_t)(ptrdiff_t k, trlib_int_t n,
+                                    const double *p, double *Hp, void *data);
+
+/* A Hessian in CSR format, for trlib_driver_csr_hessp */
+typedef struct {
+    const trlib_int_t *indptr;
+    const trlib_int_t *indices;
+    const double *data;
+} trlib_driver_csr;
+
+/* data is an array of trlib_driver_csr, one for each subproblem */
+int trlib_driver_csr_hessp(ptrdiff_t k, trlib_int_t n, const double *p,
+                           double *Hp, void *data);
+
+typedef struct {
+    trlib_int_t n, itmax, h_pointer, init;
+    trlib_int_t *iwork, *timing;
+    double *fwork;
+    /* vectors of length n, and the Lanczos basis Q of (itmax+1) rows */
+    double *g, *v, *gm, *p, *Hp, *Hs, *Q;
+} trlib_driver_work;
+
+/* The iteration limit of TRLIBQuadraticSubproblem for dimension n */
+trlib_int_t trlib_driver_itmax(trlib_int_t n);
+
+/* Sizes of the integer and floating point workspace for trlib_driver_init */
+void trlib_driver_memory_size(trlib_int_t n, trlib_int_t itmax,
+                              trlib_int_t *iwork_size,
+                              trlib_int_t *fwork_size);
+
+/* Lays out w in iwork and fwork, which must not be moved afterwards */
+void trlib_driver_init(trlib_driver_work *w, trlib_int_t n, trlib_int_t itmax,
+                       trlib_int_t *iwork, double *fwork);
+
+/*
+ * Solves subproblem k with gradient grad, storing the step in s and the
+ * Lagrange multiplier of the trust-region constraint in lam. The first
+ * call after trlib_driver_init starts from scratch; later ones reuse
+ * the Krylov space of the previous one and must use the same grad and
+ * hessp. verbose and fout are those of trlib_krylov_min.
+ *
+ * Returns the final TRLIB_CLR_* code or TRLIB_DRIVER_FAIL_HESSP.
+ */
+trlib_int_t trlib_driver_solve(trlib_driver_work *w, double radius,
+                               const double *grad, trlib_driver_hessp_t hessp,
+                               ptrdiff_t k, void *data, double tol_rel_i,
+                               double tol_rel_b, trlib_int_t verbose,
+                               FILE *fout, double *s, double *lam);
+
+/*
+ * Solves the nprob subproblems with gradients grad[k*n:(k+1)*n] and radii
+ * radius[k] from scratch on up to nthreads threads, each with workspace
+ * of its own. Stores the steps in s[k*n:(k+1)*n], the multipliers in
+ * lam[k] and the return codes of trlib_driver_solve in status[k].
+ *
+ * hessp may be called concurrently for different k. Returns 0, or
+ * TRLIB_DRIVER_NOMEM if the workspace could not be allocated, in which
+ * case the status of the unsolved subproblems is TRLIB_DRIVER_NOMEM.
+ */
+trlib_int_t trlib_driver_solve_batch(ptrdiff_t nprob, trlib_int_t n,
+                                     const double *radius, const double *grad,
+                                     trlib_driver_hessp_t hessp, void *data,
+                                     double tol_rel_i, double tol_rel_b,
+                                     int nthreads, double *s, double *lam,
+                                     trlib_int_t *status);
+
+#endif
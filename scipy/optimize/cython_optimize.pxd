@@ -1,2 +1,4 @@
 from .cython_optimize._zeros cimport (
-    brentq, brenth, ridder, bisect, zeros_full_output)
+    brentq, brenth, ridder, bisect, zeros_full_output,
+    brentq_batch, brenth_batch, ridder_batch, bisect_batch,
+    batch_callback_type)
@@ -129,4 +129,32 @@ error, and 0 means the solver converged. Continuing from the previous example::
     #  'funcalls': 6,
     #  'iterations': 5,
     #  'root': 0.6999942848231314}
+
+
+Batches
+-------
+``bisect_batch``, ``ridder_batch``, ``brenth_batch`` and ``brentq_batch``
+solve ``n`` independent problems, bracketed by the arrays ``xa`` and ``xb``,
+with the same steps as the scalar functions. All unconverged problems take
+their steps together, so the callback is called once per step with the
+points of all of them::
+
+    int (*batch_callback_type)(ptrdiff_t n, const ptrdiff_t *lanes,
+                               const double *x, double *fx, void *args)
+
+It must store the value at ``x[i]`` of the function of problem ``lanes[i]``
+in ``fx[i]`` for ``i < n``, and return 0, or a positive value to stop the
+solver. The solvers are called as ::
+
+    from scipy.optimize.cython_optimize cimport brentq_batch
+
+    status = brentq_batch(f, n, xa, xb, &myargs, xtol, rtol, mitr, workers,
+                          roots, full_output)
+
+storing the roots in ``roots`` and, unless ``full_output`` is ``NULL``, the
+full output of each problem in the array ``full_output``. The problems are
+shared out between ``workers`` threads, in chunks, so with ``workers > 1`` the
+callback must be thread-safe and must not need the GIL. The return value is 0
+on success, -1 if there was not enough memory, or else the value with which
+the callback stopped the solver.
 """
@@ -1,4 +1,8 @@
+from libc.stddef cimport ptrdiff_t
+
 ctypedef double (*callback_type)(double, void*)
+ctypedef int (*batch_callback_type)(ptrdiff_t, const ptrdiff_t*,
+                                    const double*, double*, void*)
 
 ctypedef struct zeros_parameters:
     callback_type function
@@ -25,3 +29,23 @@ cdef double brenth(callback_type f, double xa, double xb, void* args,
 cdef double brentq(callback_type f, double xa, double xb, void* args,
                    double xtol, double rtol, int iter,
                    zeros_full_output *full_output) nogil
+
+cdef int bisect_batch(batch_callback_type f, Py_ssize_t n, const double *xa,
+                      const double *xb, void* args, double xtol, double rtol,
+                      int iter, int workers, double *roots,
+                      zeros_full_output *full_output) nogil
+
+cdef int ridder_batch(batch_callback_type f, Py_ssize_t n, const double *xa,
+                      const double *xb, void* args, double xtol, double rtol,
+                      int iter, int workers, double *roots,
+                      zeros_full_output *full_output) nogil
+
+cdef int brenth_batch(batch_callback_type f, Py_ssize_t n, const double *xa,
+                      const double *xb, void* args, double xtol, double rtol,
+                      int iter, int workers, double *roots,
+                      zeros_full_output *full_output) nogil
+
+cdef int brentq_batch(batch_callback_type f, Py_ssize_t n, const double *xa,
+                      const double *xb, void* args, double xtol, double rtol,
+                      int iter, int workers, double *roots,
+                      zeros_full_output *full_output) nogil
@@ -1,9 +1,19 @@
+from libc.stddef cimport ptrdiff_t
+
 cdef extern from "../Zeros/zeros.h":
     ctypedef double (*callback_type)(double, void*)
     ctypedef struct scipy_zeros_info:
         int funcalls
         int iterations
         int error_num
+    ctypedef int (*batch_callback_type)(ptrdiff_t, const ptrdiff_t*,
+                                        const double*, double*, void*)
+    enum:
+        BATCH_BISECT
+        BATCH_RIDDER
+        BATCH_BRENTH
+        BATCH_BRENTQ
+        BATCH_NOMEM
 
 cdef extern from "../Zeros/bisect.c" nogil:
     double bisect(callback_type f, double xa, double xb, double xtol,
@@ -24,3 +34,10 @@ cdef extern from "../Zeros/brentq.c" nogil:
     double brentq(callback_type f, double xa, double xb, double xtol,
                   double rtol, int iter, void *func_data,
                   scipy_zeros_info *solver_stats)
+
+cdef extern from "../Zeros/batch.c" nogil:
+    int scipy_zeros_batch(int method, batch_callback_type f, ptrdiff_t n,
+                          const double *xa, const double *xb, double xtol,
+                          double rtol, int iter, void *func_data,
+                          ptrdiff_t chunk, int workers, double *roots,
+                          scipy_zeros_info *solver_stats)
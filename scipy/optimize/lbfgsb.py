@@ -5,6 +5,7 @@ Functions
    :toctree: generated/
 
     fmin_l_bfgs_b
+    minimize_lbfgsb_batch
 
 """
 
@@ -35,15 +36,18 @@ Functions
 
 from __future__ import division, print_function, absolute_import
 
+from multiprocessing import cpu_count
+
 import numpy as np
 from numpy import array, asarray, float64, int32, zeros
-from . import _lbfgsb
+from scipy._lib._ccallback import LowLevelCallable
+from . import _lbfgsb, _lbfgsb_driver
 from .optimize import (MemoizeJac, OptimizeResult,
                        _check_unknown_options, wrap_function,
                        _approx_fprime_helper)
 from scipy.sparse.linalg import LinearOperator
 
-__all__ = ['fmin_l_bfgs_b', 'LbfgsInvHessProduct']
+__all__ = ['fmin_l_bfgs_b', 'minimize_lbfgsb_batch', 'LbfgsInvHessProduct']
 
 
 def fmin_l_bfgs_b(func, x0, fprime=None, args=(),
@@ -57,8 +61,9 @@ def fmin_l_bfgs_b(func, x0, fprime=None, args=(),
 
     Parameters
     ----------
-    func : callable f(x,*args)
-        Function to minimise.
+    func : callable f(x,*args) or scipy.LowLevelCallable
+        Function to minimise. A `scipy.LowLevelCallable` computes both the
+        value and the gradient, see `minimize_lbfgsb_batch`.
     x0 : ndarray
         Initial guess.
     fprime : callable fprime(x,*args), optional
@@ -171,7 +176,7 @@ def fmin_l_bfgs_b(func, x0, fprime=None, args=(),
 
     """
     # handle fprime/approx_grad
-    if approx_grad:
+    if approx_grad or isinstance(func, LowLevelCallable):
         fun = func
         jac = None
     elif fprime is None:
@@ -251,6 +256,12 @@ def _minimize_lbfgsb(fun, x0, args=(), jac=None, bounds=None,
     I.e., `factr` multiplies the default machine floating-point precision to
     arrive at `ftol`.
 
+    If `fun` is a `scipy.LowLevelCallable` with the signature
+    ``double (int n, double *x, double *grad, void *user_data)``, returning
+    the objective and storing its gradient in `grad`, the iteration runs in
+    compiled code without returning to Python; `jac` is then ignored, and
+    `args` and `callback` cannot be used. See also `minimize_lbfgsb_batch`.
+
     """
     _check_unknown_options(unknown_options)
     m = maxcor
@@ -261,12 +272,7 @@ def _minimize_lbfgsb(fun, x0, args=(), jac=None, bounds=None,
     x0 = asarray(x0).ravel()
     n, = x0.shape
 
-    if bounds is None:
-        bounds = [(None, None)] * n
-    if len(bounds) != n:
-        raise ValueError('length of x0 != length of bounds')
-    # unbounded variables must use None, not +-inf, for optimizer to work properly
-    bounds = [(None if l == -np.inf else l, None if u == np.inf else u) for l, u in bounds]
+    nbd, low_bnd, upper_bnd = _bounds_arrays(bounds, n)
 
     if disp is not None:
         if disp == 0:
@@ -274,6 +280,27 @@ def _minimize_lbfgsb(fun, x0, args=(), jac=None, bounds=None,
         else:
             iprint = disp
 
+    if not maxls > 0:
+        raise ValueError('maxls must be positive.')
+
+    if isinstance(fun, LowLevelCallable):
+        if args:
+            raise ValueError("args cannot be used with a LowLevelCallable "
+                             "objective; pass its data as user_data")
+        if callback is not None:
+            raise ValueError("callback cannot be used with a "
+                             "LowLevelCallable objective")
+        (x, f, g, nfev, nit, warnflag, task,
+         s, y, n_bfgs_updates) = _lbfgsb_driver.minimize(
+             fun, x0[np.newaxis], low_bnd, upper_bnd, nbd, m, factr, pgtol,
+             iprint, maxfun, maxiter, maxls, 1, True)
+        task_str = task[0].tostring().strip(b'\x00').strip()
+        n_corrs = min(n_bfgs_updates[0], maxcor)
+        hess_inv = LbfgsInvHessProduct(s[0, :n_corrs], y[0, :n_corrs])
+        return OptimizeResult(fun=f[0], jac=g[0], nfev=nfev[0], nit=nit[0],
+                              status=warnflag[0], message=task_str, x=x[0],
+                              success=(warnflag[0] == 0), hess_inv=hess_inv)
+
     n_function_evals, fun = wrap_function(fun, ())
     if jac is None:
         def func_and_grad(x):
@@ -286,26 +313,6 @@ def _minimize_lbfgsb(fun, x0, args=(), jac=None, bounds=None,
             g = jac(x, *args)
             return f, g
 
-    nbd = zeros(n, int32)
-    low_bnd = zeros(n, float64)
-    upper_bnd = zeros(n, float64)
-    bounds_map = {(None, None): 0,
-                  (1, None): 1,
-                  (1, 1): 2,
-                  (None, 1): 3}
-    for i in range(0, n):
-        l, u = bounds[i]
-        if l is not None:
-            low_bnd[i] = l
-            l = 1
-        if u is not None:
-            upper_bnd[i] = u
-            u = 1
-        nbd[i] = bounds_map[l, u]
-
-    if not maxls > 0:
-        raise ValueError('maxls must be positive.')
-
     x = array(x0, float64)
     f = array(0.0, float64)
     g = zeros((n,), float64)
@@ -372,6 +379,133 @@ def _minimize_lbfgsb(fun, x0, args=(), jac=None, bounds=None,
                           x=x, success=(warnflag == 0), hess_inv=hess_inv)
 
 
+def _bounds_arrays(bounds, n):
+    """The bounds in the form of setulb: nbd, l and u."""
+    if bounds is None:
+        bounds = [(None, None)] * n
+    if len(bounds) != n:
+        raise ValueError('length of x0 != length of bounds')
+    # unbounded variables must use None, not +-inf, for optimizer to work properly
+    bounds = [(None if l == -np.inf else l, None if u == np.inf else u) for l, u in bounds]
+
+    nbd = zeros(n, int32)
+    low_bnd = zeros(n, float64)
+    upper_bnd = zeros(n, float64)
+    bounds_map = {(None, None): 0,
+                  (1, None): 1,
+                  (1, 1): 2,
+                  (None, 1): 3}
+    for i in range(0, n):
+        l, u = bounds[i]
+        if l is not None:
+            low_bnd[i] = l
+            l = 1
+        if u is not None:
+            upper_bnd[i] = u
+            u = 1
+        nbd[i] = bounds_map[l, u]
+    return nbd, low_bnd, upper_bnd
+
+
+def minimize_lbfgsb_batch(fun, x0, bounds=None, maxcor=10,
+                          ftol=2.2204460492503131e-09, gtol=1e-5,
+                          maxfun=15000, maxiter=15000, maxls=20, workers=1):
+    """
+    Minimize many independent problems with L-BFGS-B, in compiled code.
+
+    The whole L-BFGS-B iteration, including the calls of the objective, is
+    run in C with the GIL released, so that cheap objectives are not
+    dominated by the cost of returning to Python at every evaluation, and
+    the problems can be solved on several threads.
+
+    Parameters
+    ----------
+    fun : scipy.LowLevelCallable
+        Objective function and its gradient, with one of the signatures::
+
+            double func(int n, double *x, double *grad, void *user_data)
+            double func(int n, double *x, double *grad, intptr_t k,
+                        void *user_data)
+
+        It returns the value of the objective at the `n` variables `x` and
+        stores its gradient in `grad`. The second form is passed also the
+        index `k` of the problem being solved, so that each problem can
+        have its own data. With ``workers > 1`` `fun` is called from several
+        threads at once, so it must be thread-safe.
+    x0 : array_like, shape (n,) or (nprob, n)
+        Initial guess of each problem; all problems start at `x0` if it is
+        1-D.
+    bounds : sequence, optional
+        ``(min, max)`` pairs for each of the `n` variables, shared by all
+        problems. Use None or +-inf for one of ``min`` or ``max`` when there
+        is no bound in that direction.
+    maxcor, ftol, gtol, maxfun, maxiter, maxls : optional
+        As for ``minimize(method='L-BFGS-B')``, applying to each problem.
+    workers : int, optional
+        Number of threads to solve the problems on; -1 uses all CPUs.
+
+    Returns
+    -------
+    res : OptimizeResult
+        The attributes ``x``, ``fun``, ``jac``, ``nfev``, ``nit``,
+        ``status``, ``success`` and ``message`` have one entry (or row) for
+        each problem, as in the result of ``minimize(method='L-BFGS-B')``.
+        A 1-D `x0` gives a single problem, with results as from `minimize`.
+
+    See Also
+    --------
+    minimize : which also accepts a `scipy.LowLevelCallable` of the first
+        form for ``method='L-BFGS-B'``.
+
+    Examples
+    --------
+    Fit many small models, the objective of model `k` being compiled C
+    code that reads its data through `k` (here a ctypes function of
+    ``libobjective``)::
+
+        import ctypes
+        import numpy as np
+        from scipy import LowLevelCallable
+        from scipy.optimize import minimize_lbfgsb_batch
+
+        lib = ctypes.CDLL('libobjective.so')
+        lib.objective.restype = ctypes.c_double
+        lib.objective.argtypes = (ctypes.c_int,
+                                  ctypes.POINTER(ctypes.c_double),
+                                  ctypes.POINTER(ctypes.c_double),
+                                  ctypes.c_ssize_t, ctypes.c_void_p)
+        res = minimize_lbfgsb_batch(LowLevelCallable(lib.objective),
+                                    np.zeros((100000, 3)), workers=-1)
+
+    """
+    if not isinstance(fun, LowLevelCallable):
+        raise ValueError("fun must be a scipy.LowLevelCallable")
+    x0 = asarray(x0, dtype=float64)
+    single = x0.ndim == 1
+    x0 = np.atleast_2d(x0)
+    if x0.ndim != 2:
+        raise ValueError("x0 must be 1-D or 2-D")
+    nbd, low_bnd, upper_bnd = _bounds_arrays(bounds, x0.shape[1])
+    if not maxls > 0:
+        raise ValueError('maxls must be positive.')
+    if workers == -1:
+        workers = cpu_count()
+    factr = ftol / np.finfo(float).eps
+
+    (x, f, g, nfev, nit, warnflag, task,
+     _, _, _) = _lbfgsb_driver.minimize(
+         fun, x0, low_bnd, upper_bnd, nbd, maxcor, factr, gtol, -1,
+         maxfun, maxiter, maxls, workers, False)
+    message = task.view('S60')[:, 0]
+    message = np.array([m.strip(b'\x00').strip() for m in message])
+    res = OptimizeResult(fun=f, jac=g, nfev=nfev, nit=nit, status=warnflag,
+                         message=message, x=x, success=(warnflag == 0))
+    if single:
+        for key in res:
+            res[key] = res[key][0]
+    return res
+
+
 class LbfgsInvHessProduct(LinearOperator):
     """Linear operator for the L-BFGS approximate inverse Hessian.
 
@@ -0,0 +1,27 @@
+c     Wrapper of setulb for the compiled driver of _lbfgsb_driver.c. It
+c     takes TASK and CSAVE as arrays of 60 character codes, so that no
+c     character arguments need to be passed from C.
+
+      subroutine setulbw(n, m, x, l, u, nbd, f, g, factr, pgtol, wa,
+     &                   iwa, itask, iprint, icsave, lsave, isave,
+     &                   dsave, maxls)
+      integer n, m, iprint, maxls
+      integer nbd(n), iwa(3*n), isave(44), itask(60), icsave(60)
+      logical lsave(4)
+      double precision f, factr, pgtol
+      double precision x(n), l(n), u(n), g(n), dsave(29)
+      double precision wa(2*m*n + 5*n + 11*m*m + 8*m)
+      character*60 task, csave
+      integer i
+
+      do 10 i = 1, 60
+         task(i:i) = char(itask(i))
+         csave(i:i) = char(icsave(i))
+   10 continue
+      call setulb(n, m, x, l, u, nbd, f, g, factr, pgtol, wa, iwa,
+     &            task, iprint, csave, lsave, isave, dsave, maxls)
+      do 20 i = 1, 60
+         itask(i) = ichar(task(i:i))
+         icsave(i) = ichar(csave(i:i))
+   20 continue
+      end
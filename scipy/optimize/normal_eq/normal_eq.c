@@ -0,0 +1,437 @@
+/*
+ * Normal equations of the interior-point method of linprog, see
+ * normal_eq.h.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "normal_eq.h"
+#include "zeros_threads.h"
+
+
+static int
+compare_index(const void *a, const void *b)
+{
+    ptrdiff_t i = *(const ptrdiff_t *)a, j = *(const ptrdiff_t *)b;
+
+    return (i > j) - (i < j);
+}
+
+int
+normal_eq_adat_analyze(normal_eq_adat *S, ptrdiff_t m,
+                       const ptrdiff_t *Ap, const ptrdiff_t *Aj,
+                       const double *Ax, const ptrdiff_t *Bp,
+                       const ptrdiff_t *Bi, const double *Bx)
+{
+    ptrdiff_t *mark, *loc, i, j, k, p, q, nnz;
+
+    memset(S, 0, sizeof(*S));
+    S->m = m;
+    S->Mp = malloc((m + 1) * sizeof(ptrdiff_t));
+    mark = malloc((m > 0 ? m : 1) * sizeof(ptrdiff_t));
+    loc = malloc((m > 0 ? m : 1) * sizeof(ptrdiff_t));
+    if (S->Mp == NULL || mark == NULL || loc == NULL) {
+        goto fail;
+    }
+
+    /* pattern of column j of the upper triangle: rows i <= j sharing a
+       column k of A with row j */
+    for (i = 0; i < m; i++) {
+        mark[i] = -1;
+    }
+    S->Mp[0] = 0;
+    for (j = 0; j < m; j++) {
+        nnz = 0;
+        for (p = Ap[j]; p < Ap[j + 1]; p++) {
+            k = Aj[p];
+            for (q = Bp[k]; q < Bp[k + 1]; q++) {
+                i = Bi[q];
+                if (i <= j && mark[i] != j) {
+                    mark[i] = j;
+                    nnz++;
+                }
+            }
+        }
+        S->Mp[j + 1] = S->Mp[j] + nnz;
+    }
+    nnz = S->Mp[m];
+
+    S->Mi = malloc((nnz > 0 ? nnz : 1) * sizeof(ptrdiff_t));
+    S->tp = malloc((nnz + 1) * sizeof(ptrdiff_t));
+    if (S->Mi == NULL || S->tp == NULL) {
+        goto fail;
+    }
+    for (i = 0; i < m; i++) {
+        mark[i] = -1;
+    }
+    for (j = 0; j < m; j++) {
+        ptrdiff_t top = S->Mp[j];
+
+        for (p = Ap[j]; p < Ap[j + 1]; p++) {
+            k = Aj[p];
+            for (q = Bp[k]; q < Bp[k + 1]; q++) {
+                i = Bi[q];
+                if (i <= j && mark[i] != j) {
+                    mark[i] = j;
+                    S->Mi[top++] = i;
+                }
+            }
+        }
+        qsort(S->Mi + S->Mp[j], S->Mp[j + 1] - S->Mp[j], sizeof(ptrdiff_t),
+              compare_index);
+    }
+
+    /* number of products of each entry */
+    S->tp[0] = 0;
+    for (j = 0; j < m; j++) {
+        for (p = S->Mp[j]; p < S->Mp[j + 1]; p++) {
+            loc[S->Mi[p]] = p;
+            S->tp[p + 1] = 0;
+        }
+        for (p = Ap[j]; p < Ap[j + 1]; p++) {
+            k = Aj[p];
+            for (q = Bp[k]; q < Bp[k + 1]; q++) {
+                i = Bi[q];
+                if (i <= j) {
+                    S->tp[loc[i] + 1]++;
+                }
+            }
+        }
+    }
+    for (p = 0; p < nnz; p++) {
+        S->tp[p + 1] += S->tp[p];
+    }
+
+    S->tk = malloc((S->tp[nnz] > 0 ? S->tp[nnz] : 1) * sizeof(ptrdiff_t));
+    S->tv = malloc((S->tp[nnz] > 0 ? S->tp[nnz] : 1) * sizeof(double));
+    if (S->tk == NULL || S->tv == NULL) {
+        goto fail;
+    }
+    /* the products themselves; loc now holds the next free slot */
+    for (j = 0; j < m; j++) {
+        for (p = S->Mp[j]; p < S->Mp[j + 1]; p++) {
+            loc[S->Mi[p]] = S->tp[p];
+        }
+        for (p = Ap[j]; p < Ap[j + 1]; p++) {
+            k = Aj[p];
+            for (q = Bp[k]; q < Bp[k + 1]; q++) {
+                i = Bi[q];
+                if (i <= j) {
+                    S->tk[loc[i]] = k;
+                    S->tv[loc[i]++] = Bx[q] * Ax[p];
+                }
+            }
+        }
+    }
+
+    free(mark);
+    free(loc);
+    return 0;
+
+fail:
+    free(mark);
+    free(loc);
+    normal_eq_adat_free(S);
+    return NORMAL_EQ_NOMEM;
+}
+
+
+/* Entries are claimed in chunks of this size */
+#define ADAT_CHUNK 4096
+
+typedef struct {
+    const normal_eq_adat *S;
+    const double *d;
+    double *Mx;
+    /* shared between the threads */
+    zeros_mutex lock;
+    ptrdiff_t next;
+} adat_values;
+
+static void
+adat_thread(void *arg)
+{
+    adat_values *v = (adat_values *)arg;
+    const normal_eq_adat *S = v->S;
+    ptrdiff_t nnz = S->Mp[S->m], start, end, p, t;
+
+    for (;;) {
+        zeros_mutex_lock(&v->lock);
+        start = v->next;
+        v->next += ADAT_CHUNK;
+        zeros_mutex_unlock(&v->lock);
+        if (start >= nnz) {
+            break;
+        }
+        end = start + ADAT_CHUNK < nnz ? start + ADAT_CHUNK : nnz;
+
+        for (p = start; p < end; p++) {
+            double sum = 0.0;
+
+            for (t = S->tp[p]; t < S->tp[p + 1]; t++) {
+                sum += S->tv[t] * v->d[S->tk[t]];
+            }
+            v->Mx[p] = sum;
+        }
+    }
+}
+
+void
+normal_eq_adat_values(const normal_eq_adat *S, const double *d, double *Mx,
+                      int nthreads)
+{
+    adat_values v;
+    ptrdiff_t nchunks = (S->Mp[S->m] + ADAT_CHUNK - 1) / ADAT_CHUNK;
+
+    v.S = S;
+    v.d = d;
+    v.Mx = Mx;
+    v.next = 0;
+    if (nthreads > nchunks) {
+        nthreads = nchunks > 1 ? (int)nchunks : 1;
+    }
+    if (nthreads < 1) {
+        nthreads = 1;
+    }
+    zeros_mutex_init(&v.lock);
+    zeros_run_threads(nthreads, adat_thread, &v);
+    zeros_mutex_destroy(&v.lock);
+}
+
+void
+normal_eq_adat_free(normal_eq_adat *S)
+{
+    free(S->Mp);
+    free(S->Mi);
+    free(S->tp);
+    free(S->tk);
+    free(S->tv);
+    memset(S, 0, sizeof(*S));
+}
+
+
+/*
+ * Nonzero pattern of row k of L, in s[top:n] (cs_ereach of [1]). Nodes
+ * i with w[i] == k are marked.
+ */
+static ptrdiff_t
+ereach(const normal_eq_chol *F, ptrdiff_t k)
+{
+    ptrdiff_t n = F->n, top = n, i, p, len;
+    ptrdiff_t *s = F->s, *w = F->w;
+
+    w[k] = k;
+    for (p = F->Cp[k]; p < F->Cp[k + 1]; p++) {
+        i = F->Ci[p];
+        if (i > k) {
+            continue;
+        }
+        for (len = 0; w[i] != k; i = F->parent[i]) {
+            s[len++] = i;
+            w[i] = k;
+        }
+        while (len > 0) {
+            s[--top] = s[--len];
+        }
+    }
+    return top;
+}
+
+int
+normal_eq_chol_analyze(normal_eq_chol *F, ptrdiff_t n, const ptrdiff_t *Mp,
+                       const ptrdiff_t *Mi, const ptrdiff_t *perm)
+{
+    ptrdiff_t *pinv = NULL, *ancestor, i, j, k, p, a, b, top, nnz = Mp[n];
+    size_t size = (n > 0 ? n : 1) * sizeof(ptrdiff_t);
+
+    memset(F, 0, sizeof(*F));
+    F->n = n;
+    F->perm = malloc(size);
+    F->Cp = malloc((n + 1) * sizeof(ptrdiff_t));
+    F->Ci = malloc((nnz > 0 ? nnz : 1) * sizeof(ptrdiff_t));
+    F->Cmap = malloc((nnz > 0 ? nnz : 1) * sizeof(ptrdiff_t));
+    F->Cx = malloc((nnz > 0 ? nnz : 1) * sizeof(double));
+    F->parent = malloc(size);
+    F->Lp = malloc((n + 1) * sizeof(ptrdiff_t));
+    F->c = malloc(size);
+    F->s = malloc(size);
+    F->w = malloc(size);
+    F->x = malloc((n > 0 ? n : 1) * sizeof(double));
+    pinv = malloc(size);
+    if (F->perm == NULL || F->Cp == NULL || F->Ci == NULL
+            || F->Cmap == NULL || F->Cx == NULL || F->parent == NULL
+            || F->Lp == NULL || F->c == NULL || F->s == NULL || F->w == NULL
+            || F->x == NULL || pinv == NULL) {
+        goto fail;
+    }
+    memcpy(F->perm, perm, n * sizeof(ptrdiff_t));
+    for (k = 0; k < n; k++) {
+        pinv[perm[k]] = k;
+    }
+
+    /* upper triangle of C = P M P^T, using c for the column counts */
+    memset(F->c, 0, size);
+    for (j = 0; j < n; j++) {
+        for (p = Mp[j]; p < Mp[j + 1]; p++) {
+            a = pinv[Mi[p]];
+            b = pinv[j];
+            F->c[a > b ? a : b]++;
+        }
+    }
+    F->Cp[0] = 0;
+    for (k = 0; k < n; k++) {
+        F->Cp[k + 1] = F->Cp[k] + F->c[k];
+        F->c[k] = F->Cp[k];
+    }
+    for (j = 0; j < n; j++) {
+        for (p = Mp[j]; p < Mp[j + 1]; p++) {
+            a = pinv[Mi[p]];
+            b = pinv[j];
+            k = F->c[a > b ? a : b]++;
+            F->Ci[k] = a < b ? a : b;
+            F->Cmap[p] = k;
+        }
+    }
+
+    /* elimination tree (cs_etree of [1]), using w for the ancestors */
+    ancestor = F->w;
+    for (k = 0; k < n; k++) {
+        F->parent[k] = -1;
+        ancestor[k] = -1;
+        for (p = F->Cp[k]; p < F->Cp[k + 1]; p++) {
+            ptrdiff_t inext;
+
+            for (i = F->Ci[p]; i != -1 && i < k; i = inext) {
+                inext = ancestor[i];
+                ancestor[i] = k;
+                if (inext == -1) {
+                    F->parent[i] = k;
+                }
+            }
+        }
+    }
+
+    /* column counts of L from the row patterns */
+    for (k = 0; k < n; k++) {
+        F->c[k] = 1;
+        F->w[k] = -1;
+    }
+    for (k = 0; k < n; k++) {
+        for (top = ereach(F, k); top < n; top++) {
+            F->c[F->s[top]]++;
+        }
+    }
+    F->Lp[0] = 0;
+    for (k = 0; k < n; k++) {
+        F->Lp[k + 1] = F->Lp[k] + F->c[k];
+    }
+    F->Li = malloc((F->Lp[n] > 0 ? F->Lp[n] : 1) * sizeof(ptrdiff_t));
+    F->Lx = malloc((F->Lp[n] > 0 ? F->Lp[n] : 1) * sizeof(double));
+    if (F->Li == NULL || F->Lx == NULL) {
+        goto fail;
+    }
+
+    free(pinv);
+    return 0;
+
+fail:
+    free(pinv);
+    normal_eq_chol_free(F);
+    return NORMAL_EQ_NOMEM;
+}
+
+/* Up-looking Cholesky factorization (cs_chol of [1]) */
+int
+normal_eq_chol_factor(normal_eq_chol *F, const double *Mx)
+{
+    ptrdiff_t n = F->n, nnz = F->Cp[n], i, k, p, top;
+    ptrdiff_t *Lp = F->Lp, *Li = F->Li, *c = F->c, *s = F->s;
+    double *Lx = F->Lx, *x = F->x, d, lki;
+
+    for (p = 0; p < nnz; p++) {
+        F->Cx[F->Cmap[p]] = Mx[p];
+    }
+    for (k = 0; k < n; k++) {
+        c[k] = Lp[k];
+        F->w[k] = -1;
+        x[k] = 0.0;
+    }
+
+    for (k = 0; k < n; k++) {
+        top = ereach(F, k);
+        for (p = F->Cp[k]; p < F->Cp[k + 1]; p++) {
+            x[F->Ci[p]] += F->Cx[p];
+        }
+        d = x[k];
+        x[k] = 0.0;
+        for (; top < n; top++) {
+            i = s[top];
+            lki = x[i] / Lx[Lp[i]];
+            x[i] = 0.0;
+            for (p = Lp[i] + 1; p < c[i]; p++) {
+                x[Li[p]] -= Lx[p] * lki;
+            }
+            d -= lki * lki;
+            p = c[i]++;
+            Li[p] = k;
+            Lx[p] = lki;
+        }
+        if (!(d > 0.0)) {
+            return NORMAL_EQ_NOT_POSDEF;
+        }
+        p = c[k]++;
+        Li[p] = k;
+        Lx[p] = sqrt(d);
+    }
+    return 0;
+}
+
+void
+normal_eq_chol_solve(normal_eq_chol *F, double *b)
+{
+    ptrdiff_t n = F->n, j, p;
+    ptrdiff_t *Lp = F->Lp, *Li = F->Li;
+    double *Lx = F->Lx, *x = F->x;
+
+    for (j = 0; j < n; j++) {
+        x[j] = b[F->perm[j]];
+    }
+    /* L y = P b */
+    for (j = 0; j < n; j++) {
+        x[j] /= Lx[Lp[j]];
+        for (p = Lp[j] + 1; p < Lp[j + 1]; p++) {
+            x[Li[p]] -= Lx[p] * x[j];
+        }
+    }
+    /* L^T z = y */
+    for (j = n - 1; j >= 0; j--) {
+        for (p = Lp[j] + 1; p < Lp[j + 1]; p++) {
+            x[j] -= Lx[p] * x[Li[p]];
+        }
+        x[j] /= Lx[Lp[j]];
+    }
+    for (j = 0; j < n; j++) {
+        b[F->perm[j]] = x[j];
+    }
+}
+
+void
+normal_eq_chol_free(normal_eq_chol *F)
+{
+    free(F->perm);
+    free(F->Cp);
+    free(F->Ci);
+    free(F->Cmap);
+    free(F->Cx);
+    free(F->parent);
+    free(F->Lp);
+    free(F->Li);
+    free(F->Lx);
+    free(F->c);
+    free(F->s);
+    free(F->w);
+    free(F->x);
+    memset(F, 0, sizeof(*F));
+}
@@ -0,0 +1,90 @@
+/*
+ * Normal equations of the interior-point method of linprog.
+ *
+ * Each iteration solves a system with M = A D A^T, where A is a fixed
+ * sparse matrix and D a positive diagonal matrix that changes from one
+ * iteration to the next. Everything that depends only on the sparsity
+ * pattern of A is computed once:
+ *
+ * normal_eq_adat_analyze finds the pattern of the upper triangle of M and,
+ * for each of its entries, the products a_ik a_jk that contribute to it,
+ * so that normal_eq_adat_values recomputes the values of M for a new D
+ * without any searching. The entries are independent and are computed on
+ * a number of threads.
+ *
+ * normal_eq_chol_analyze does the symbolic part of a sparse Cholesky
+ * factorization P M P^T = L L^T for a given fill-reducing ordering: the
+ * elimination tree and the column counts of L. normal_eq_chol_factor then
+ * only does the numerical part, after the up-looking algorithm of [1].
+ *
+ * [1] Davis, Timothy A. "Direct Methods for Sparse Linear Systems."
+ *     SIAM, 2006.
+ */
+#ifndef NORMAL_EQ_H
+#define NORMAL_EQ_H
+
+#include <stddef.h>
+
+/* Returned by normal_eq_chol_factor if M is not positive definite */
+#define NORMAL_EQ_NOT_POSDEF (-1)
+/* Returned when memory cannot be allocated */
+#define NORMAL_EQ_NOMEM      (-2)
+
+typedef struct {
+    ptrdiff_t m;
+    /* upper triangle of M by columns, with sorted row indices */
+    ptrdiff_t *Mp, *Mi;
+    /* products of entry p are tv[tp[p]:tp[p+1]], times d[tk[...]] */
+    ptrdiff_t *tp, *tk;
+    double *tv;
+} normal_eq_adat;
+
+/*
+ * Analyzes A (m x n) given in CSR (Ap, Aj, Ax) and in CSC (Bp, Bi, Bx)
+ * form. Returns 0 or NORMAL_EQ_NOMEM.
+ */
+int normal_eq_adat_analyze(normal_eq_adat *S, ptrdiff_t m,
+                           const ptrdiff_t *Ap, const ptrdiff_t *Aj,
+                           const double *Ax, const ptrdiff_t *Bp,
+                           const ptrdiff_t *Bi, const double *Bx);
+
+/* Stores the values of the upper triangle of A diag(d) A^T in Mx */
+void normal_eq_adat_values(const normal_eq_adat *S, const double *d,
+                           double *Mx, int nthreads);
+
+void normal_eq_adat_free(normal_eq_adat *S);
+
+typedef struct {
+    ptrdiff_t n;
+    /* the ordering, perm[new] = old, and the upper triangle of P M P^T by
+       columns; entry p of M is entry Cmap[p] of C */
+    ptrdiff_t *perm, *Cp, *Ci, *Cmap;
+    double *Cx;
+    /* elimination tree, and L by columns with the diagonal first */
+    ptrdiff_t *parent, *Lp, *Li;
+    double *Lx;
+    /* workspace */
+    ptrdiff_t *c, *s, *w;
+    double *x;
+} normal_eq_chol;
+
+/*
+ * Symbolic factorization of the matrix with upper triangle of pattern
+ * (Mp, Mi) and ordering perm. Returns 0 or NORMAL_EQ_NOMEM.
+ */
+int normal_eq_chol_analyze(normal_eq_chol *F, ptrdiff_t n,
+                           const ptrdiff_t *Mp, const ptrdiff_t *Mi,
+                           const ptrdiff_t *perm);
+
+/*
+ * Numerical factorization given the values Mx of the upper triangle.
+ * Returns 0 or NORMAL_EQ_NOT_POSDEF.
+ */
+int normal_eq_chol_factor(normal_eq_chol *F, const double *Mx);
+
+/* Overwrites b with the solution of M x = b */
+void normal_eq_chol_solve(normal_eq_chol *F, double *b);
+
+void normal_eq_chol_free(normal_eq_chol *F);
+
+#endif
@@ -23,7 +23,7 @@ def configuration(parent_package='',top_path=None):
                          **numpy_nodepr_api)
 
     rootfind_src = [join('Zeros','*.c')]
-    rootfind_hdr = [join('Zeros','zeros.h')]
+    rootfind_hdr = [join('Zeros','zeros.h'), join('Zeros','zeros_threads.h')]
     config.add_library('rootfind',
                        sources=rootfind_src,
                        headers=rootfind_hdr,
@@ -47,6 +47,18 @@ def configuration(parent_package='',top_path=None):
                          sources=[join('lbfgsb_src',x) for x in sources],
                          **lapack)
 
+    # the same L-BFGS-B, driven from C for LowLevelCallable objectives
+    sources = ['lbfgsb.f', 'linpack.f', 'timer.f', 'setulb_wrap.f']
+    config.add_library('lbfgsb_driver',
+                       sources=[join('lbfgsb_src', x) for x in sources])
+    config.add_extension('_lbfgsb_driver',
+                         sources=['_lbfgsb_driver.c'],
+                         libraries=['lbfgsb_driver'],
+                         include_dirs=include_dirs,
+                         depends=([join('lbfgsb_src', x) for x in sources]
+                                  + [join('Zeros', 'zeros_threads.h')]),
+                         extra_info=lapack)
+
     sources = ['moduleTNC.c','tnc.c']
     config.add_extension('moduleTNC',
                          sources=[join('tnc',x) for x in sources],
@@ -76,6 +88,13 @@ def configuration(parent_package='',top_path=None):
 
     config.add_extension('_bglu_dense', sources=['_bglu_dense.c'])
 
+    config.add_extension('_normal_eq',
+                         sources=['_normal_eq.c',
+                                  join('normal_eq', 'normal_eq.c')],
+                         include_dirs=['normal_eq', 'Zeros'],
+                         depends=[join('normal_eq', 'normal_eq.h'),
+                                  join('Zeros', 'zeros_threads.h')])
+
     config.add_subpackage('_lsq')
 
     config.add_subpackage('_trlib')
@@ -297,6 +297,46 @@ class TestDifferentialEvolutionSolver(object):
         assert_equal(
             len(np.unique(np.array([candidate, r1, r2, r3, r4, r5]))), 6)
 
+    def test_select_samples_population(self):
+        # each candidate gets 5 distinct samples, none of them itself
+        limits = np.arange(12., dtype='float64').reshape(2, 6)
+        bounds = list(zip(limits[0, :], limits[1, :]))
+        solver = DifferentialEvolutionSolver(None, bounds, popsize=1)
+        samples = solver._select_samples_population(5)
+        assert_equal(samples.shape, (5, solver.num_population_members))
+        for candidate in range(solver.num_population_members):
+            assert_equal(len(np.unique(np.append(samples[:, candidate],
+                                                 candidate))), 6)
+
+    def test_mutate_population(self):
+        strategies = (list(DifferentialEvolutionSolver._binomial) +
+                      list(DifferentialEvolutionSolver._exponential))
+        for strategy in strategies:
+            solver = DifferentialEvolutionSolver(rosen, self.bounds,
+                                                 strategy=strategy, seed=1)
+            population = solver.population
+
+            solver.cross_over_probability = 1
+            trial = solver._mutate_population()
+            assert_equal(trial.shape, population.shape)
+            # the whole trial vectors come from bprime
+            assert_(np.all(trial != population))
+
+            solver.cross_over_probability = 0
+            trial = solver._mutate_population()
+            changed = np.sum(trial != population, axis=1)
+            if strategy in DifferentialEvolutionSolver._binomial:
+                # only the fill point comes from bprime
+                assert_equal(changed, 1)
+            else:
+                assert_equal(changed, 0)
+
+            # deferred updating uses _mutate_population
+            result = differential_evolution(rosen, self.bounds,
+                                            strategy=strategy,
+                                            updating='deferred', seed=1)
+            assert_allclose(result.x, [1., 1.], rtol=1e-4)
+
     def test_maxiter_stops_solve(self):
         # test that if the maximum number of iterations is exceeded
         # the solver stops.
@@ -555,6 +595,37 @@ class TestDifferentialEvolutionSolver(object):
             assert_(solver._updating == 'deferred')
             solver.solve()
 
+    def test_vectorized(self):
+        def vrosen(x):
+            assert_equal(x.ndim, 2)
+            assert_equal(x.shape[0], 2)
+            return rosen(x)
+
+        bounds = [(0., 2.), (0., 2.)]
+        res = differential_evolution(rosen, bounds, updating='deferred',
+                                     seed=1)
+        res_v = differential_evolution(vrosen, bounds, updating='deferred',
+                                       vectorized=True, seed=1)
+        assert_equal(res_v.x, res.x)
+        assert_equal(res_v.fun, res.fun)
+        assert_equal(res_v.nfev, res.nfev)
+        assert_equal(res_v.nit, res.nit)
+
+        # vectorized overrides updating and workers
+        with warns(UserWarning):
+            solver = DifferentialEvolutionSolver(vrosen, bounds,
+                                                 vectorized=True)
+        assert_(solver._updating == 'deferred')
+        with warns(UserWarning):
+            solver = DifferentialEvolutionSolver(vrosen, bounds,
+                                                 updating='deferred',
+                                                 vectorized=True, workers=2)
+        assert_(solver._mapwrapper._mapfunc is map)
+
+        # the function must return one energy per solution vector
+        assert_raises(RuntimeError, differential_evolution, lambda x: x,
+                      bounds, updating='deferred', vectorized=True)
+
     def test_converged(self):
         solver = DifferentialEvolutionSolver(rosen, [(0, 2), (0, 2)])
         solver.solve()
@@ -2,6 +2,7 @@ from __future__ import division
 
 import math
 from itertools import product
+from multiprocessing.pool import ThreadPool
 
 import numpy as np
 from numpy.testing import assert_allclose, assert_equal, assert_
@@ -42,6 +43,25 @@ def test_group_columns():
     assert_equal(groups_1, groups_2)
 
 
+def test_group_columns_sparse_dense():
+    # group_sparse and group_dense must find the same groups, also when
+    # there are more than 64 of them.
+    np.random.seed(1234)
+    for m, n, density in [(30, 40, 0.1), (20, 100, 0.5), (200, 150, 0.9)]:
+        A = (np.random.rand(m, n) < density).astype(int)
+        groups_dense = group_columns(A)
+        groups_sparse = group_columns(csc_matrix(A))
+        assert_equal(groups_sparse, groups_dense)
+
+        # Columns of a group never share a row.
+        for g in range(groups_sparse.max() + 1):
+            assert_(np.all(A[:, groups_sparse == g].sum(axis=1) <= 1))
+
+
+def fun_parallel(x):
+    return np.hstack((np.sin(x[:-1]) * x[1:], np.sum(x**2)))
+
+
 class TestAdjustSchemeToBounds(object):
     def test_no_bounds(self):
         x0 = np.zeros(3)
@@ -380,6 +400,21 @@ class TestApproxDerivativesDense(object):
                                     self.jac_zero_jacobian, x0)
         assert_(accuracy == 0)
 
+    def test_workers(self):
+        x0 = np.linspace(0.1, 1.0, 7)
+        pool = ThreadPool(3)
+        try:
+            for method in ['2-point', '3-point', 'cs']:
+                J = approx_derivative(fun_parallel, x0, method=method)
+                J_threads = approx_derivative(fun_parallel, x0, method=method,
+                                              workers=pool.map)
+                assert_equal(J_threads, J)
+                J_processes = approx_derivative(fun_parallel, x0,
+                                                method=method, workers=2)
+                assert_equal(J_processes, J)
+        finally:
+            pool.close()
+
 
 class TestApproxDerivativeSparse(object):
     # Example from Numerical Optimization 2nd edition, p. 198.
@@ -458,6 +493,20 @@ class TestApproxDerivativeSparse(object):
                 self.fun, self.x0, sparsity=(structure, groups), method=method)
             assert_equal(J_dense, J_sparse.toarray())
 
+    def test_workers(self):
+        A = self.structure(self.n)
+        pool = ThreadPool(3)
+        try:
+            for method in ['2-point', '3-point', 'cs']:
+                J = approx_derivative(self.fun, self.x0, method=method,
+                                      bounds=(self.lb, self.ub), sparsity=A)
+                J_threads = approx_derivative(
+                    self.fun, self.x0, method=method,
+                    bounds=(self.lb, self.ub), sparsity=A, workers=pool.map)
+                assert_equal(J_threads.toarray(), J.toarray())
+        finally:
+            pool.close()
+
     def test_check_derivative(self):
         def jac(x):
             return csr_matrix(self.jac(x))
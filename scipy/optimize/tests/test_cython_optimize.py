@@ -14,6 +14,7 @@ in `scipy.optimize.cython_optimze` for more information.
 """
 
 from __future__ import division, print_function, absolute_import
+import pytest
 import numpy.testing as npt
 from scipy.optimize.cython_optimize import _zeros
 
@@ -91,3 +92,23 @@ def test_brentq_full_output():
     npt.assert_equal(6, output['iterations'])
     npt.assert_equal(7, output['funcalls'])
     npt.assert_equal(0, output['error_num'])
+
+
+# test the batched solvers against the scalar ones, on one and more threads
+@pytest.mark.parametrize('method', ['bisect', 'ridder', 'brenth', 'brentq'])
+def test_batch(method):
+    a0 = [-2.0 - x/10000.0 for x in range(10000)]
+    output = _zeros.batch_example(
+        method, a0, ARGS, XLO, XHI, XTOL, RTOL, MITR)
+    npt.assert_allclose(
+        [(-x) ** (1.0/3.0) for x in a0], [out['root'] for out in output],
+        rtol=RTOL, atol=XTOL)
+    npt.assert_equal([0]*len(a0), [out['error_num'] for out in output])
+    npt.assert_equal(
+        _zeros.batch_example(method, A0, ARGS, XLO, XHI, XTOL, RTOL, MITR),
+        [_zeros.batch_example(method, [x], ARGS, XLO, XHI, XTOL, RTOL,
+                              MITR)[0] for x in A0])
+    npt.assert_equal(
+        output,
+        _zeros.batch_example(
+            method, a0, ARGS, XLO, XHI, XTOL, RTOL, MITR, workers=4))
@@ -10,8 +10,12 @@ from numpy.testing import (assert_, assert_allclose, assert_equal,
 from pytest import raises as assert_raises
 from scipy.optimize import linprog, OptimizeWarning
 from scipy._lib._numpy_compat import _assert_warns, suppress_warnings
+from scipy.sparse import csc_matrix, eye as sparse_eye, hstack as sparse_hstack
+from scipy.sparse import random as sparse_random
 from scipy.sparse.linalg import MatrixRankWarning
-from scipy.linalg import LinAlgWarning
+from scipy.linalg import LinAlgError, LinAlgWarning
+from scipy.optimize._bglu_sparse import SparseBGLU
+from scipy.optimize._normal_eq import NormalEquations
 import pytest
 
 has_umfpack = True
@@ -1507,6 +1511,10 @@ class TestLinprogIPSparse(LinprogIPTests):
                 _assert_success(res, desired_fun=1.730550597)
 
 
+class TestLinprogIPSparseCholesky(LinprogIPTests):
+    options = {"sparse": True, "cholesky": True, "workers": 2}
+
+
 class TestLinprogIPSparsePresolve(LinprogIPTests):
     options = {"sparse": True, "_sparse_presolve": True}
 
@@ -1662,3 +1670,67 @@ class TestLinprogRSCommon(LinprogRSTests):
 
 class TestLinprogRSBland(LinprogRSTests):
     options = {"pivot": "bland"}
+
+
+class TestLinprogRSSparse(LinprogRSTests):
+    options = {"sparse": True}
+
+    def test_sparse_dense_agree(self):
+        # refactorize often and rarely to exercise the product form updates
+        A_eq, b_eq, c, N = magic_square(3)
+        with suppress_warnings() as sup:
+            sup.filter(OptimizeWarning, "A_eq does not appear...")
+            for maxupdate in (0, 1, 10, 100):
+                o = {"maxupdate": maxupdate}
+                res_d = linprog(c, A_eq=A_eq, b_eq=b_eq, method=self.method,
+                                options=o)
+                o["sparse"] = True
+                res_s = linprog(c, A_eq=A_eq, b_eq=b_eq, method=self.method,
+                                options=o)
+                _assert_success(res_s, desired_fun=res_d.fun)
+
+
+def test_sparse_bglu_solve():
+    # solves with the updated factorization match the basis matrix
+    np.random.seed(0)
+    m, n = 20, 40
+    A = np.hstack((np.eye(m), sparse_random(m, n, density=0.2).toarray()))
+    A = csc_matrix(A)
+    basis = np.arange(m)
+    B = SparseBGLU(A, basis.copy(), max_updates=100)
+    for j in range(m, m + n):
+        i = np.random.randint(m)
+        B_new = A[:, basis].toarray()
+        B_new[:, i] = A[:, j].toarray().ravel()
+        if abs(np.linalg.det(B_new)) < 1e-8:
+            continue
+        B.update(i, j)
+        basis[i:m-1] = basis[i+1:m].copy()
+        basis[-1] = j
+        assert_equal(B.b, basis)
+
+        B_dense = A[:, basis].toarray()
+        q = np.random.rand(m)
+        assert_allclose(B_dense.dot(B.solve(q)), q, atol=1e-10)
+        assert_allclose(B_dense.T.dot(B.solve(q, transposed=True)), q,
+                        atol=1e-10)
+
+
+def test_normal_equations():
+    # A D A^T and its Cholesky factorization with the pattern analyzed once
+    np.random.seed(0)
+    m, n = 20, 50
+    A = sparse_hstack((sparse_eye(m), sparse_random(m, n - m, density=0.1)))
+    A_dense = A.toarray()
+    normal = NormalEquations(A, workers=2)
+    for i in range(3):
+        d = np.random.rand(n) + 0.1
+        M = normal.update(d)
+        M_dense = (A_dense * d).dot(A_dense.T)
+        assert_allclose(M.toarray(), M_dense, atol=1e-14)
+        solve = normal.cholesky()
+        r = np.random.rand(m)
+        assert_allclose(M_dense.dot(solve(r)), r, atol=1e-12)
+
+    normal.update(-d)
+    assert_raises(LinAlgError, normal.cholesky)
@@ -11,6 +11,7 @@ To run it in its simplest form::
 """
 from __future__ import division, print_function, absolute_import
 
+import ctypes
 import itertools
 
 import numpy as np
@@ -22,7 +23,7 @@ import pytest
 from pytest import raises as assert_raises
 
 from scipy._lib._numpy_compat import suppress_warnings
-from scipy import optimize
+from scipy import optimize, LowLevelCallable
 
 
 def test_check_grad():
@@ -970,6 +971,97 @@ class TestLBFGSBBounds(object):
         assert_allclose(res.x, self.solution, atol=1e-6)
 
 
+class TestLBFGSBCompiled(object):
+    # The compiled driver, with ctypes callbacks running the same Python
+    # code as the objectives given to the Python loop
+
+    def setup_method(self):
+        self.bounds = [(None, None), (-0.5, 1.2), (None, 3.0), (0.0, None)]
+        self.x0 = np.array([-1.2, 1.0, 0.5, 2.0])
+
+    def fg(self, x, shift=0.0):
+        return optimize.rosen(x - shift), optimize.rosen_der(x - shift)
+
+    def low_level(self, indexed):
+        argtypes = [ctypes.c_int, ctypes.POINTER(ctypes.c_double),
+                    ctypes.POINTER(ctypes.c_double)]
+        if indexed:
+            argtypes.append(ctypes.c_ssize_t)
+        argtypes.append(ctypes.c_void_p)
+
+        def fg(n, x, g, *args):
+            shift = 0.01*args[0] if indexed else 0.0
+            f, grad = self.fg(np.ctypeslib.as_array(x, (n,)), shift)
+            np.ctypeslib.as_array(g, (n,))[:] = grad
+            return f
+
+        # keep the ctypes function alive along with the test
+        self.cfunc = ctypes.CFUNCTYPE(ctypes.c_double, *argtypes)(fg)
+        return LowLevelCallable(self.cfunc)
+
+    def test_minimize(self):
+        res = optimize.minimize(self.fg, self.x0, jac=True,
+                                method='L-BFGS-B', bounds=self.bounds)
+        for fun, jac in [(self.low_level(False), None),
+                         (self.low_level(False), True)]:
+            res_c = optimize.minimize(fun, self.x0, jac=jac,
+                                      method='L-BFGS-B', bounds=self.bounds)
+            assert_equal(res_c.x, res.x)
+            assert_equal(res_c.fun, res.fun)
+            assert_equal(res_c.jac, res.jac)
+            assert_equal(res_c.nit, res.nit)
+            assert_equal(res_c.nfev, res.nfev)
+            assert_equal(res_c.message, res.message)
+            assert_allclose(res_c.hess_inv.todense(), res.hess_inv.todense())
+
+        x, f, d = optimize.fmin_l_bfgs_b(self.fg, self.x0,
+                                         bounds=self.bounds, maxiter=5)
+        x_c, f_c, d_c = optimize.fmin_l_bfgs_b(self.low_level(False),
+                                               self.x0, bounds=self.bounds,
+                                               maxiter=5)
+        assert_equal(x_c, x)
+        assert_equal(d_c['warnflag'], d['warnflag'])
+        assert_equal(d_c['task'], d['task'])
+
+    @pytest.mark.parametrize('workers', [1, 3])
+    def test_batch(self, workers):
+        x0 = self.x0 + 0.1*np.arange(7)[:, np.newaxis]
+        res = optimize.minimize_lbfgsb_batch(self.low_level(True), x0,
+                                             bounds=self.bounds,
+                                             workers=workers)
+        assert_equal(res.x.shape, x0.shape)
+        for k in range(len(x0)):
+            res_k = optimize.minimize(self.fg, x0[k], args=(0.01*k,),
+                                      jac=True, method='L-BFGS-B',
+                                      bounds=self.bounds)
+            assert_equal(res.x[k], res_k.x)
+            assert_equal(res.fun[k], res_k.fun)
+            assert_equal(res.nit[k], res_k.nit)
+            assert_equal(res.nfev[k], res_k.nfev)
+            assert_equal(res.status[k], res_k.status)
+            assert_equal(res.message[k], res_k.message)
+
+        res_1 = optimize.minimize_lbfgsb_batch(self.low_level(False),
+                                               self.x0, bounds=self.bounds)
+        res = optimize.minimize(self.fg, self.x0, jac=True,
+                                method='L-BFGS-B', bounds=self.bounds)
+        assert_equal(res_1.x, res.x)
+        assert_equal(res_1.nit, res.nit)
+
+    def test_errors(self):
+        fun = self.low_level(False)
+        assert_raises(ValueError, optimize.minimize, fun, self.x0,
+                      args=(1.0,), method='L-BFGS-B')
+        assert_raises(ValueError, optimize.minimize, fun, self.x0,
+                      method='L-BFGS-B', callback=lambda x: None)
+        assert_raises(ValueError, optimize.minimize_lbfgsb_batch, self.fg,
+                      self.x0)
+        fun = LowLevelCallable(ctypes.CFUNCTYPE(
+            ctypes.c_double, ctypes.c_double)(lambda x: x))
+        assert_raises(ValueError, optimize.minimize_lbfgsb_batch, fun,
+                      self.x0)
+
+
 class TestOptimizeScalar(object):
     def setup_method(self):
         self.solution = 1.5
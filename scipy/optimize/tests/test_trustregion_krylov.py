@@ -7,12 +7,19 @@ To run it in its simplest form::
 """
 from __future__ import division, print_function, absolute_import
 
+import ctypes
+
 import numpy as np
-from scipy.optimize._trlib import (get_trlib_quadratic_subproblem)
+import pytest
+from scipy import LowLevelCallable
+from scipy.sparse import csr_matrix
+from scipy.optimize._trlib import (get_trlib_quadratic_subproblem,
+                                   solve_subproblem_batch)
 from numpy.testing import (assert_, assert_array_equal,
                            assert_almost_equal,
                            assert_equal, assert_array_almost_equal,
-                           assert_array_less)
+                           assert_array_less, assert_allclose,
+                           assert_raises)
 
 KrylovQP = get_trlib_quadratic_subproblem(tol_rel_i=1e-8, tol_rel_b=1e-6)
 KrylovQP_disp = get_trlib_quadratic_subproblem(tol_rel_i=1e-8, tol_rel_b=1e-6, disp=True)
@@ -171,3 +178,112 @@ class TestKrylovQuadraticSubproblem(object):
         out, err = capsys.readouterr()
         assert_(out.startswith(' TR Solving trust region problem'), repr(out))
 
+
+    def test_sparse_hess(self):
+        H = np.array([[1.0, 0.0, 4.0],
+                      [0.0, 2.0, 0.0],
+                      [4.0, 0.0, 3.0]])
+        g = np.array([5.0, 0.0, 4.0])
+
+        subprob = KrylovQP(x=0,
+                           fun=lambda x: 0,
+                           jac=lambda x: g,
+                           hess=lambda x: csr_matrix(H),
+                           hessp=None)
+        dense = KrylovQP(x=0,
+                         fun=lambda x: 0,
+                         jac=lambda x: g,
+                         hess=lambda x: None,
+                         hessp=lambda x, y: H.dot(y))
+        for trust_radius in [1.0, 0.5]:
+            p, hits_boundary = subprob.solve(trust_radius)
+            p_dense, hits_boundary_dense = dense.solve(trust_radius)
+            assert_allclose(p, p_dense, rtol=1e-8, atol=1e-12)
+            assert_equal(hits_boundary, hits_boundary_dense)
+
+    def test_hessp_error(self):
+        def hessp(x, y):
+            raise ZeroDivisionError()
+
+        subprob = KrylovQP(x=0,
+                           fun=lambda x: 0,
+                           jac=lambda x: np.ones(3),
+                           hess=lambda x: None,
+                           hessp=hessp)
+        assert_raises(ZeroDivisionError, subprob.solve, 1.0)
+
+
+def _batch_problems(nprob, n):
+    np.random.seed(1234)
+    H = []
+    for k in range(nprob):
+        A = np.random.randn(n, n)
+        A[np.abs(A) < 0.5] = 0
+        H.append(A + A.T)
+    return H, np.random.randn(nprob, n), np.linspace(0.1, 2.0, nprob)
+
+
+class TestSubproblemBatch(object):
+
+    @pytest.mark.parametrize('workers', [1, 3])
+    def test_hess(self, workers):
+        H, g, radius = _batch_problems(7, 6)
+        s, hits_boundary, status = solve_subproblem_batch(
+            g, radius, hess=[csr_matrix(A) for A in H],
+            tol_rel_i=1e-8, tol_rel_b=1e-6, workers=workers)
+
+        assert_(np.all(status >= 0))
+        for k in range(7):
+            subprob = KrylovQP(x=0,
+                               fun=lambda x: 0,
+                               jac=lambda x: g[k],
+                               hess=lambda x: None,
+                               hessp=lambda x, y: H[k].dot(y))
+            p, hb = subprob.solve(radius[k])
+            assert_allclose(s[k], p, rtol=1e-8, atol=1e-12)
+            assert_equal(hits_boundary[k], hb)
+
+    @pytest.mark.parametrize('workers', [1, 3])
+    def test_lowlevel_hessp(self, workers):
+        H, g, radius = _batch_problems(5, 4)
+        H = np.array(H)
+        n = 4
+
+        @ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_int,
+                          ctypes.POINTER(ctypes.c_double),
+                          ctypes.POINTER(ctypes.c_double), ctypes.c_ssize_t,
+                          ctypes.c_void_p)
+        def hessp(n, p, Hp, k, user_data):
+            p = np.ctypeslib.as_array(p, (n,))
+            np.ctypeslib.as_array(Hp, (n,))[...] = H[k].dot(p)
+            return 0
+
+        s, hits_boundary, status = solve_subproblem_batch(
+            g, radius, hessp=LowLevelCallable(hessp), workers=workers)
+        s_ref, hits_boundary_ref, status_ref = solve_subproblem_batch(
+            g, radius, hess=H)
+        assert_allclose(s, s_ref, rtol=1e-8, atol=1e-12)
+        assert_array_equal(hits_boundary, hits_boundary_ref)
+        assert_array_equal(status, status_ref)
+
+        @ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_int,
+                          ctypes.POINTER(ctypes.c_double),
+                          ctypes.POINTER(ctypes.c_double), ctypes.c_void_p)
+        def failing(n, p, Hp, user_data):
+            return 1
+
+        s, hits_boundary, status = solve_subproblem_batch(
+            g, radius, hessp=LowLevelCallable(failing), workers=workers)
+        assert_array_equal(status, -100)
+
+    def test_errors(self):
+        g = np.ones((2, 3))
+        H = [np.eye(3), np.eye(3)]
+        assert_raises(ValueError, solve_subproblem_batch, g, 1.0)
+        assert_raises(ValueError, solve_subproblem_batch, g, 1.0, hess=H,
+                      hessp=lambda p: p)
+        assert_raises(ValueError, solve_subproblem_batch, g, 1.0,
+                      hessp=lambda p: p)
+        assert_raises(ValueError, solve_subproblem_batch, g, 1.0, hess=H[:1])
+        assert_raises(ValueError, solve_subproblem_batch, g, 1.0,
+                      hess=[np.eye(2), np.eye(2)])
@@ -706,3 +706,49 @@ def test_gh9551_raise_error_if_disp_true():
         result = zeros.newton(f, 1.0, f_p)
     root = zeros.newton(f, complex(10.0, 10.0), f_p)
     assert_allclose(root, complex(0.0, 1.0))
+
+
+@pytest.mark.parametrize('method', ['brentq', 'brenth', 'ridder', 'bisect'])
+def test_root_scalar_batch(method):
+    # Each problem is solved with the same steps as by the scalar solver
+    c = np.linspace(0.5, 20, 70000).reshape(7, 10000)
+    p = np.linspace(-1, 1, 10000)
+    nsteps = []
+
+    def f(x, c, p):
+        nsteps.append(np.size(x))
+        return (x*x + p)*x - c
+
+    scalar = getattr(zeros, method)
+    x, r = zeros.root_scalar_batch(f, -1.0, 3.0, args=(c, p),
+                                   method=method, full_output=True)
+    assert_equal(x.shape, c.shape)
+    assert_(r.converged.all())
+    assert_(max(nsteps) <= 1 << 16)
+    for k in [(0, 0), (3, 4321), (6, 9999)]:
+        x0, r0 = scalar(f, -1.0, 3.0, args=(c[k], p[k[1]]),
+                        full_output=True)
+        assert_equal(x[k], x0)
+        assert_equal(r.iterations[k], r0.iterations)
+        assert_equal(r.function_calls[k], r0.function_calls)
+
+
+def test_root_scalar_batch_failures():
+    def f(x, c):
+        return x**2 - c
+
+    c = np.array([1.0, -1.0, 4.0])
+    with pytest.raises(ValueError, match='different signs'):
+        zeros.root_scalar_batch(f, 0, 3, args=(c,))
+    with pytest.raises(RuntimeError, match='1 of 2 problems failed'):
+        zeros.root_scalar_batch(f, 0, [2, 3], args=(c[[0, 2]],),
+                                method='bisect', maxiter=2)
+    with pytest.raises(ValueError, match='shape of its argument'):
+        zeros.root_scalar_batch(lambda x: x[:1], -1, [1, 2])
+
+    x, r = zeros.root_scalar_batch(f, 0, 3, args=(c,), method='bisect',
+                                   maxiter=3, full_output=True, disp=False)
+    assert_equal(r.flag, [zeros.CONVERR, zeros.SIGNERR, zeros.CONVERR])
+    assert_equal(r.converged, [False, False, False])
+    assert_(np.isnan(x[1]))
+    assert_equal(r.iterations[[0, 2]], 3)
@@ -6,6 +6,8 @@
 
 #include "Python.h"
 #include <setjmp.h>
+#include <string.h>
+#include <numpy/arrayobject.h>
 #include <numpy/npy_math.h>
 #include "Zeros/zeros.h"
 
@@ -174,6 +176,155 @@ _brentq(PyObject *self, PyObject *args)
         return call_solver(brentq,self,args);
 }
 
+/*
+ * Batched solvers. The Python callback is called as f(x, lanes), with x
+ * the points at which to evaluate the problems whose indices are in lanes,
+ * and must return an array of the shape of x.
+ */
+
+static int
+scipy_zeros_batch_func(ptrdiff_t n, const ptrdiff_t *lanes, const double *x,
+                       double *fx, void *params)
+{
+    PyObject *f = (PyObject *)params;
+    PyObject *xarr = NULL, *larr = NULL, *retval = NULL, *fxarr = NULL;
+    npy_intp dim = n, i;
+    npy_intp *ldata;
+
+    xarr = PyArray_SimpleNew(1, &dim, NPY_DOUBLE);
+    larr = PyArray_SimpleNew(1, &dim, NPY_INTP);
+    if (xarr == NULL || larr == NULL) {
+        goto fail;
+    }
+    memcpy(PyArray_DATA((PyArrayObject *)xarr), x, n*sizeof(double));
+    ldata = (npy_intp *)PyArray_DATA((PyArrayObject *)larr);
+    for (i = 0; i < n; i++) {
+        ldata[i] = lanes[i];
+    }
+
+    retval = PyObject_CallFunctionObjArgs(f, xarr, larr, NULL);
+    if (retval == NULL) {
+        goto fail;
+    }
+    fxarr = PyArray_FROMANY(retval, NPY_DOUBLE, 1, 1, NPY_ARRAY_CARRAY_RO);
+    if (fxarr == NULL) {
+        goto fail;
+    }
+    if (PyArray_DIM((PyArrayObject *)fxarr, 0) != n) {
+        PyErr_SetString(PyExc_ValueError,
+                "f must return an array of the shape of its argument");
+        goto fail;
+    }
+    memcpy(fx, PyArray_DATA((PyArrayObject *)fxarr), n*sizeof(double));
+
+    Py_DECREF(xarr);
+    Py_DECREF(larr);
+    Py_DECREF(retval);
+    Py_DECREF(fxarr);
+    return 0;
+
+fail:
+    Py_XDECREF(xarr);
+    Py_XDECREF(larr);
+    Py_XDECREF(retval);
+    Py_XDECREF(fxarr);
+    return 1;
+}
+
+static PyObject *
+_batch(PyObject *self, PyObject *args)
+{
+    PyObject *f, *a, *b;
+    PyArrayObject *xa = NULL, *xb = NULL;
+    PyArrayObject *roots = NULL, *funcalls = NULL, *iterations = NULL;
+    PyArrayObject *flags = NULL;
+    scipy_zeros_info *solver_stats = NULL;
+    double xtol, rtol;
+    int method, iter, status;
+    npy_intp n, i;
+    Py_ssize_t chunk;
+
+    if (!PyArg_ParseTuple(args, "iOOOddin",
+                &method, &f, &a, &b, &xtol, &rtol, &iter, &chunk)) {
+        return NULL;
+    }
+    if (method < BATCH_BISECT || method > BATCH_BRENTQ) {
+        PyErr_SetString(PyExc_ValueError, "unknown method");
+        return NULL;
+    }
+    if (xtol < 0) {
+        PyErr_SetString(PyExc_ValueError, "xtol must be >= 0");
+        return NULL;
+    }
+    if (iter < 0) {
+        PyErr_SetString(PyExc_ValueError, "maxiter should be > 0");
+        return NULL;
+    }
+
+    xa = (PyArrayObject *)PyArray_FROMANY(a, NPY_DOUBLE, 1, 1,
+                                          NPY_ARRAY_CARRAY_RO);
+    xb = (PyArrayObject *)PyArray_FROMANY(b, NPY_DOUBLE, 1, 1,
+                                          NPY_ARRAY_CARRAY_RO);
+    if (xa == NULL || xb == NULL) {
+        goto fail;
+    }
+    n = PyArray_DIM(xa, 0);
+    if (PyArray_DIM(xb, 0) != n) {
+        PyErr_SetString(PyExc_ValueError,
+                "a and b must have the same shape");
+        goto fail;
+    }
+
+    roots = (PyArrayObject *)PyArray_SimpleNew(1, &n, NPY_DOUBLE);
+    funcalls = (PyArrayObject *)PyArray_SimpleNew(1, &n, NPY_INT);
+    iterations = (PyArrayObject *)PyArray_SimpleNew(1, &n, NPY_INT);
+    flags = (PyArrayObject *)PyArray_SimpleNew(1, &n, NPY_INT);
+    if (roots == NULL || funcalls == NULL || iterations == NULL ||
+            flags == NULL) {
+        goto fail;
+    }
+    solver_stats = malloc((n > 0 ? n : 1)*sizeof(scipy_zeros_info));
+    if (solver_stats == NULL) {
+        PyErr_NoMemory();
+        goto fail;
+    }
+
+    /* The callback needs the GIL, so the chunks are solved one by one */
+    status = scipy_zeros_batch(method, scipy_zeros_batch_func, n,
+                               (double *)PyArray_DATA(xa),
+                               (double *)PyArray_DATA(xb), xtol, rtol, iter,
+                               (void *)f, chunk, 1,
+                               (double *)PyArray_DATA(roots), solver_stats);
+    if (status == BATCH_NOMEM) {
+        PyErr_NoMemory();
+        goto fail;
+    }
+    if (status != 0) {
+        /* error return from Python function */
+        goto fail;
+    }
+
+    for (i = 0; i < n; i++) {
+        ((int *)PyArray_DATA(funcalls))[i] = solver_stats[i].funcalls;
+        ((int *)PyArray_DATA(iterations))[i] = solver_stats[i].iterations;
+        ((int *)PyArray_DATA(flags))[i] = solver_stats[i].error_num;
+    }
+    free(solver_stats);
+    Py_DECREF(xa);
+    Py_DECREF(xb);
+    return Py_BuildValue("NNNN", roots, funcalls, iterations, flags);
+
+fail:
+    free(solver_stats);
+    Py_XDECREF(xa);
+    Py_XDECREF(xb);
+    Py_XDECREF(roots);
+    Py_XDECREF(funcalls);
+    Py_XDECREF(iterations);
+    Py_XDECREF(flags);
+    return NULL;
+}
+
 /*
  * Standard Python module interface
  */
@@ -184,6 +335,7 @@ Zerosmethods[] = {
 	{"_ridder", _ridder, METH_VARARGS, "a"},
 	{"_brenth", _brenth, METH_VARARGS, "a"},
 	{"_brentq", _brentq, METH_VARARGS, "a"},
+	{"_batch", _batch, METH_VARARGS, "a"},
 	{NULL, NULL}
 };
 
@@ -205,6 +357,7 @@ PyObject *PyInit__zeros(void)
     PyObject *m;
 
     m = PyModule_Create(&moduledef);
+    import_array();
 
     return m;
 }
@@ -212,5 +365,6 @@ PyObject *PyInit__zeros(void)
 PyMODINIT_FUNC init_zeros(void)
 {
         Py_InitModule("_zeros", Zerosmethods);
+        import_array();
 }
 #endif
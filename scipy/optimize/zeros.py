@@ -11,7 +11,7 @@ _xtol = 2e-12
 _rtol = 4 * np.finfo(float).eps
 
 __all__ = ['newton', 'bisect', 'ridder', 'brentq', 'brenth', 'toms748',
-           'RootResults']
+           'root_scalar_batch', 'RootResults']
 
 # Must agree with CONVERGED, SIGNERR, CONVERR, ...  in zeros.h
 _ECONVERGED = 0
@@ -880,6 +880,145 @@ def brenth(f, a, b, args=(),
     return results_c(full_output, r)
 
 
+# Must agree with BATCH_BISECT, ...  in zeros.h
+_BATCH_METHODS = {'bisect': 0, 'ridder': 1, 'brenth': 2, 'brentq': 3}
+
+# The problems solved in lockstep by each call of the function
+_BATCH_CHUNK = 1 << 16
+
+
+def root_scalar_batch(f, a, b, args=(), method='brentq',
+                      xtol=_xtol, rtol=_rtol, maxiter=_iter,
+                      full_output=False, disp=True):
+    """Find roots of many independent scalar functions in bracketing
+    intervals.
+
+    Solves ``f(x, *args)[k] = 0`` for ``x[k]`` between ``a[k]`` and ``b[k]``
+    for every ``k``, with one of the bracketing methods `brentq`, `brenth`,
+    `ridder` or `bisect`. Rather than calling a scalar function once per
+    problem and point, all unconverged problems take their steps together,
+    and `f` is called once per step with the points of all of them.
+
+    Parameters
+    ----------
+    f : function
+        Vectorized Python function. It is called as ``f(x, *args)``, with
+        `x` a 1-D array of points, one for each problem still being solved,
+        and must return an array of the same shape holding the values of
+        the functions of those problems there. The extra arguments are
+        reduced to the same problems (see `args`).
+    a : array_like
+        One end of each bracketing interval.
+    b : array_like
+        The other end of each bracketing interval.
+    args : tuple, optional
+        Extra arguments for `f`. Scalars are passed as they are. `a`, `b`
+        and the arguments that are arrays are broadcast together, to the
+        shape of the batch of problems, and the arrays are passed to `f`
+        flattened, with only the entries of the problems in `x`.
+    method : {'brentq', 'brenth', 'ridder', 'bisect'}, optional
+        The bracketing method to use. Each problem is solved with exactly
+        the same steps as by the scalar function of that name.
+    xtol, rtol : number, optional
+        The tolerances, as in the scalar function.
+    maxiter : int, optional
+        The maximum number of iterations of each problem. Must be >= 0.
+    full_output : bool, optional
+        If `full_output` is False, the roots are returned. If True, the
+        return value is ``(x, r)``, where `x` is the array of roots, and `r`
+        is a `RootResults` object whose attributes are arrays with an entry
+        for each problem.
+    disp : bool, optional
+        If True, raise ValueError if ``f(a)`` and ``f(b)`` have the same
+        sign for any problem, and RuntimeError if any problem did not
+        converge. Otherwise the root of a problem with a sign error is nan,
+        and the status of each problem is recorded in any `RootResults`
+        return object.
+
+    Returns
+    -------
+    x0 : ndarray
+        Zeros of the functions, in the shape of the batch.
+    r : `RootResults` (present if ``full_output = True``)
+        Object containing information about the convergence of each
+        problem. In particular, ``r.converged`` is a boolean array.
+
+    See Also
+    --------
+    brentq, brenth, ridder, bisect : one problem at a time
+    scipy.optimize.cython_optimize : batched solvers for compiled callbacks
+
+    Notes
+    -----
+    The problems are taken 65536 at a time, so that `f` sees arrays of at
+    most that length, and the work arrays of the solver stay small however
+    large the batch is. `f` is called ``2 + maxiter`` times per chunk at
+    most (``2 + 2*maxiter`` for ``ridder``), and with fewer points as the
+    problems converge.
+
+    Examples
+    --------
+    Find the cube roots of 2, 3 and 4 in [0, 2]:
+
+    >>> from scipy import optimize
+    >>> def f(x, c):
+    ...     return x**3 - c
+
+    >>> optimize.root_scalar_batch(f, 0, 2, args=([2, 3, 4],))
+    array([1.25992105, 1.44224957, 1.58740105])
+
+    """
+    try:
+        imethod = _BATCH_METHODS[method.lower()]
+    except (KeyError, AttributeError):
+        raise ValueError("Unknown solver %s" % (method,))
+    if not isinstance(args, tuple):
+        args = (args,)
+    if xtol <= 0:
+        raise ValueError("xtol too small (%g <= 0)" % xtol)
+    if rtol < _rtol:
+        raise ValueError("rtol too small (%g < %g)" % (rtol, _rtol))
+
+    a = np.asarray(a, dtype=float)
+    b = np.asarray(b, dtype=float)
+    shape = np.broadcast(a, b, *[arg for arg in args
+                                 if np.ndim(arg) > 0]).shape
+    lane_args = []
+    for arg in args:
+        if np.ndim(arg) > 0:
+            lane_args.append((np.broadcast_to(arg, shape).ravel(), True))
+        else:
+            lane_args.append((arg, False))
+
+    def fun(x, lanes):
+        return f(x, *[arg[lanes] if per_lane else arg
+                      for arg, per_lane in lane_args])
+
+    x, funcalls, iterations, flags = _zeros._batch(
+        imethod, fun, np.broadcast_to(a, shape).ravel(),
+        np.broadcast_to(b, shape).ravel(), xtol, rtol, maxiter, _BATCH_CHUNK)
+
+    signerr = flags == _ESIGNERR
+    if disp and signerr.any():
+        raise ValueError("f(a) and f(b) must have different signs")
+    if disp and (flags == _ECONVERR).any():
+        raise RuntimeError("%d of %d problems failed to converge after %d "
+                           "iterations." % ((flags == _ECONVERR).sum(),
+                                            flags.size, maxiter))
+    x[signerr] = np.nan
+    x = x.reshape(shape)
+    if full_output:
+        names = np.array([CONVERGED, SIGNERR, CONVERR])
+        r = RootResults(root=x,
+                        iterations=iterations.reshape(shape),
+                        function_calls=funcalls.reshape(shape),
+                        flag=_ECONVERGED)
+        r.converged = (flags == _ECONVERGED).reshape(shape)
+        r.flag = names[-flags].reshape(shape)
+        return x, r
+    return x
+
+
 ################################
 # TOMS "Algorithm 748: Enclosing Zeros of Continuous Functions", by
 #  Alefeld, G. E. and Potra, F. A. and Shi, Yixun,
@@ -23,8 +23,17 @@ int D_IIR_forback1(double,double,double*,double*,int,int,int,double);
 void D_FIR_mirror_symmetric(double*,double*,int,double*,int,int,int);
 int D_separable_2Dconvolve_mirror(double*,double*,int,int,double*,double*,int,int,npy_intp*,npy_intp*);
 int D_IIR_forback2(double,double,double*,double*,int,int,int,double); 
-int D_cubic_spline2D(double*,double*,int,int,double,npy_intp*,npy_intp*,double);
-int D_quadratic_spline2D(double*,double*,int,int,double,npy_intp*,npy_intp*,double);
+int D_cubic_spline2D(double*,double*,npy_intp,int,int,double,npy_intp*,npy_intp*,double,int);
+int D_quadratic_spline2D(double*,double*,npy_intp,int,int,double,npy_intp*,npy_intp*,double,int);
+
+typedef int spline_line_func(const void*,char*,char*,int,npy_intp,npy_intp,char*);
+int spline2D_stack(spline_line_func*,const void*,int,char*,char*,npy_intp,int,int,npy_intp*,npy_intp*,int);
+
+typedef struct D_forback_plan D_forback_plan;
+static void D_forback_plan_free(D_forback_plan*);
+static int D_forback1_plan(D_forback_plan*,double,double,int,double);
+static int D_forback2_plan(D_forback_plan*,double,double,int,double);
+static int D_forback_line(const void*,char*,char*,int,npy_intp,npy_intp,char*);
 
 /* Implement the following difference equation */
 /* y[n] = a1 * x[n] + a2 * y[n-1]  */
@@ -97,6 +106,58 @@ D_IIR_order2_cascade(double cs, double z1, double z2, double y1_0,
 }
 
 
+/* The weights of the mirror-symmetric starting values of D_IIR_forback1
+   and D_IIR_forback2. They only depend on the filter, so the lines of an
+   image share them instead of summing the series again for each line.
+   Sum i has the nw[i] weights w[i], or nw[i] = -1 if it did not converge
+   within the maxN terms that were tried.  */
+
+struct D_forback_plan {
+    int order;
+    double c0, z1;                  /* first order */
+    double cs, a2, a3, h0, h1;      /* second order */
+    int nw[4];
+    double *w[4];
+};
+
+static void
+D_forback_plan_free(D_forback_plan *plan)
+{
+    int i;
+
+    for (i = 0; i < 4; i++) free(plan->w[i]);
+}
+
+static int
+D_forback1_plan(D_forback_plan *plan, double c0, double z1, int maxN,
+                double precision)
+{
+    double powz1 = 1.0;
+    double err;
+    int k;
+
+    memset(plan, 0, sizeof(*plan));
+    plan->order = 1;
+    plan->c0 = c0;
+    plan->z1 = z1;
+    if (ABSQ(z1) >= 1.0) return -2; /* z1 not less than 1 */
+    if ((plan->w[0] = malloc((maxN+1)*sizeof(double)))==NULL) return -1;
+
+    /* yp[0] = x[0] + Sum(z1^(k+1) x[k]) */
+    precision *= precision;
+    plan->nw[0] = -1;
+    for (k = 0; k < maxN; k++) {
+        powz1 *= z1;
+        plan->w[0][k] = powz1;
+        err = ABSQ(powz1);
+        if (err <= precision) {
+            plan->nw[0] = k + 1;
+            break;
+        }
+    }
+    return 0;
+}
+
 /* Implement a smoothing IIR filter with mirror-symmetric boundary conditions
    using a cascade of first-order sections.  The second section uses a 
    reversed sequence.  This implements the following transfer function:
@@ -129,48 +190,19 @@ int
 D_IIR_forback1(double c0, double z1, double *x, double *y,
                int N, int stridex, int stridey, double precision)
 { 
+    D_forback_plan plan;
     double *yp = NULL; 
-    double *xptr = x;
-    double yp0;
-    double powz1;  
-    double diff;
-    double err;
-    int k;
+    int ret;
 
-    if (ABSQ(z1) >= 1.0) return -2; /* z1 not less than 1 */
-
-    /* Initialize memory for loop */ 
-    if ((yp = malloc(N*sizeof(double)))==NULL) return -1; 
-
-   /* Fix starting value assuming mirror-symmetric boundary conditions. */
-    yp0 = x[0];
-    powz1 = 1.0;
-    k = 0;
-    precision *= precision;
-    do {
-	yp[0] = yp0;
-	powz1 *= z1;
-	yp0 += powz1 * (*xptr);
-	diff = powz1;
-	err = ABSQ(diff);
-	xptr += stridex;
-	k++;
-    } while((err > precision) && (k < N));
-    if (k >= N){
-        /* sum did not converge */
-        free(yp);
-        return -3;
+    ret = D_forback1_plan(&plan, c0, z1, N, precision);
+    if (ret == 0) {
+        if ((yp = malloc(N*sizeof(double)))==NULL) ret = -1;
+        else ret = D_forback_line(&plan, (char *)x, (char *)y, N,
+                                  stridex, stridey, (char *)yp);
     }
-    yp[0] = yp0;
-
-    D_IIR_order1(1.0, z1, x, yp, N, stridex, 1); 
-
-    *(y + (N-1)*stridey) = -c0 / (z1 - 1.0) * yp[N-1];
-
-    D_IIR_order1(c0, z1, yp+N-1, y+(N-1)*stridey, N, -1, -stridey);
-
     free(yp);
-    return 0;
+    D_forback_plan_free(&plan);
+    return ret;
 }
 
 
@@ -320,6 +352,123 @@ D_hs(int k, double cs, double rsq, double omega)
 }
 
 
+static int
+D_forback2_plan(D_forback_plan *plan, double r, double omega, int maxN,
+                double precision)
+{
+    double rsq;
+    double diff;
+    double err;
+    int i, k;
+
+    memset(plan, 0, sizeof(*plan));
+    plan->order = 2;
+    if (r >= 1.0) return -2; /* z1 not less than 1 */
+    for (i = 0; i < 4; i++) {
+        if ((plan->w[i] = malloc((maxN+1)*sizeof(double)))==NULL) return -1;
+        plan->nw[i] = -1;
+    }
+
+    rsq = r * r;
+    plan->a2 = 2 * r * cos(omega);
+    plan->a3 = -rsq;
+    plan->cs = 1 - 2 * r * cos(omega) + rsq;
+    plan->h0 = D_hc(0, plan->cs, r, omega);
+    plan->h1 = D_hc(1, plan->cs, r, omega);
+
+    /* the weights of yp[0], yp[1], y[N-1] and y[N-2] */
+    precision *= precision;
+    for (i = 0; i < 4; i++) {
+        for (k = 0; k < maxN; k++) {
+            switch (i) {
+            case 0:
+                diff = D_hc(k+1, plan->cs, r, omega);
+                break;
+            case 1:
+                diff = D_hc(k+2, plan->cs, r, omega);
+                break;
+            case 2:
+                diff = (D_hs(k, plan->cs, rsq, omega) +
+                        D_hs(k+1, plan->cs, rsq, omega));
+                break;
+            default:
+                diff = (D_hs(k-1, plan->cs, rsq, omega) +
+                        D_hs(k+2, plan->cs, rsq, omega));
+                break;
+            }
+            plan->w[i][k] = diff;
+            err = diff * diff;
+            if (err <= precision) {
+                plan->nw[i] = k + 1;
+                break;
+            }
+        }
+    }
+    return 0;
+}
+
+/* Filter one line with D_IIR_forback1 or D_IIR_forback2, as planned;
+   work holds room for N samples. */
+static int
+D_forback_line(const void *plan_, char *x_, char *y_, int N,
+               npy_intp stridex_, npy_intp stridey_, char *work)
+{
+    const D_forback_plan *plan = (const D_forback_plan *)plan_;
+    double *x = (double *)x_, *y = (double *)y_, *yp = (double *)work;
+    int stridex = (int)stridex_, stridey = (int)stridey_;
+    double yp0;
+    double yp1;
+    const double *w;
+    int i, k;
+
+    for (i = 0; i < (plan->order == 1 ? 1 : 4); i++) {
+        /* sum did not converge */
+        if (plan->nw[i] < 0 || plan->nw[i] >= N) return -3;
+    }
+
+    if (plan->order == 1) {
+        w = plan->w[0];
+        yp0 = x[0];
+        for (k = 0; k < plan->nw[0]; k++) yp0 += w[k] * x[k*stridex];
+        yp[0] = yp0;
+
+        D_IIR_order1(1.0, plan->z1, x, yp, N, stridex, 1); 
+
+        *(y + (N-1)*stridey) = -plan->c0 / (plan->z1 - 1.0) * yp[N-1];
+
+        D_IIR_order1(plan->c0, plan->z1, yp+N-1, y+(N-1)*stridey, N, -1,
+                     -stridey);
+        return 0;
+    }
+
+    w = plan->w[0];
+    yp0 = plan->h0 * x[0];
+    for (k = 0; k < plan->nw[0]; k++) yp0 += w[k] * x[k*stridex];
+    yp[0] = yp0;
+
+    w = plan->w[1];
+    yp1 = plan->h0 * x[stridex];
+    yp1 += plan->h1 * x[0];
+    for (k = 0; k < plan->nw[1]; k++) yp1 += w[k] * x[k*stridex];
+    yp[1] = yp1;
+
+    D_IIR_order2(plan->cs, plan->a2, plan->a3, x, yp, N, stridex, 1); 
+
+    w = plan->w[2];
+    yp0 = 0.0;
+    for (k = 0; k < plan->nw[2]; k++) yp0 += w[k] * x[(N-1-k)*stridex];
+    y[(N-1)*stridey] = yp0;
+
+    w = plan->w[3];
+    yp1 = 0.0;
+    for (k = 0; k < plan->nw[3]; k++) yp1 += w[k] * x[(N-1-k)*stridex];
+    y[(N-2)*stridey] = yp1;
+
+    D_IIR_order2(plan->cs, plan->a2, plan->a3, yp+N-1, y+(N-1)*stridey, N,
+                 -1, -stridey);
+    return 0;
+}
+
 /* Implement a smoothing IIR filter with mirror-symmetric boundary conditions
    using a cascade of second-order sections.  The second section uses a 
    reversed sequence.  This implements the following transfer function:
@@ -359,106 +508,31 @@ int
 D_IIR_forback2(double r, double omega, double *x, double *y,
                int N, int stridex, int stridey, double precision)
 {
-    double cs;
+    D_forback_plan plan;
     double *yp = NULL; 
-    double *yptr;
-    double *xptr;
-    double yp0;
-    double yp1;
-    double rsq;
-    double diff;
-    double err; 
-    double a2, a3;
-    int k;
-
-    if (r >= 1.0) return -2; /* z1 not less than 1 */
-
-    /* Initialize memory for loop */ 
-    if ((yp = malloc(N*sizeof(double)))==NULL) return -1; 
-    
-    rsq = r * r;
-    a2 = 2 * r * cos(omega);
-    a3 = -rsq;
-    cs = 1 - 2 * r * cos(omega) + rsq;
-
-   /* Fix starting values assuming mirror-symmetric boundary conditions. */
-    yp0 = D_hc(0, cs, r, omega) * x[0];
-    k = 0;
-    precision *= precision;
-    xptr = x;
-    do {
-	yp[0] = yp0;
-	diff = D_hc(k+1, cs, r, omega); 
-  	yp0 += diff * (*xptr); 
-	err = diff * diff;
-	xptr += stridex;
-	k++;
-    } while((err > precision) && (k < N));
-    if (k >= N) {free(yp); return -3;}     /* sum did not converge */ 
-    yp[0] = yp0;
-
-    yp1 = D_hc(0, cs, r, omega) * (*(x+stridex));
-    yp1 += D_hc(1, cs, r, omega) * x[0];
-    k = 0;
-    xptr = x;
-    do {
-	yp[1] = yp1;
-	diff = D_hc(k+2, cs, r, omega);
-	yp1 += diff * (*xptr);
-	err = diff * diff;
-	xptr += stridex;
-	k++;
-    } while((err > precision) && (k < N));
-    if (k >= N) {free(yp); return -3;}     /* sum did not converge */ 
-    yp[1] = yp1;
-
-    D_IIR_order2(cs, a2, a3, x, yp, N, stridex, 1); 
-
-   /* Fix starting values assuming mirror-symmetric boundary conditions. */
-    yp0 = 0.0;
-    k = 0;
-    yptr = y + (N-1)*stridey;
-    xptr = x + (N-1)*stridex;
-    do {
-	*yptr = yp0;
-	diff = (D_hs(k, cs, rsq, omega) + D_hs(k+1, cs, rsq, omega));
-	yp0 += diff * (*xptr);
-	err = diff * diff;
-	xptr -= stridex;
-	k++;
-    } while((err > precision) && (k < N));
-    if (k >= N) {free(yp); return -3;}     /* sum did not converge */ 
-    *yptr = yp0;
-
-    yp1 = 0.0;
-    k = 0;
-    yptr -= stridey;        /* Initialize in next-to-last slot in output array */
-    xptr = x + (N-1)*stridex;
-    do {
-	*yptr = yp1;
-	diff = (D_hs(k-1, cs, rsq, omega) + D_hs(k+2, cs, rsq, omega));
-	yp1 += diff * (*xptr);
-	err = diff * diff;
-	xptr -= stridex;
-	k++;
-    } while((err > precision) && (k < N));
-    if (k >= N) {free(yp); return -3;}     /* sum did not converge */ 
-    *yptr = yp1;
-
-    D_IIR_order2(cs, a2, a3, yp+N-1, yptr+stridey, N, -1, -stridey);
+    int ret;
 
+    ret = D_forback2_plan(&plan, r, omega, N, precision);
+    if (ret == 0) {
+        if ((yp = malloc(N*sizeof(double)))==NULL) ret = -1;
+        else ret = D_forback_line(&plan, (char *)x, (char *)y, N,
+                                  stridex, stridey, (char *)yp);
+    }
     free(yp);
-    return 0;
+    D_forback_plan_free(&plan);
+    return ret;
 }
 
-/* Find the cubic spline coefficients of an image 
-   image is M rows by N columns stored rowise in memory (vary column number
-          first). It will be replaced with the spline coefficients. 
+/* Find the cubic spline coefficients of a stack of images
+   image is nimages images of M rows by N columns each; the coefficients
+          are written to coeffs, which may be the same memory.
    lambda is a smoothing parameter (lambda = 100 approximately corresponds
           to a cutoff frequency of 0.1*(sample freq))
-   strides is an integer array [rowstride, colstride]
-          telling how much memory in units of sizeof(double) bytes to skip
-	  to get to the next element.
+   strides and cstrides are integer arrays [imagestride, rowstride,
+          colstride] telling how much memory in units of sizeof(double)
+	  bytes to skip to get to the next element of image and coeffs.
+   workers is the number of threads the rows and columns are shared
+          between.
 */
 
 /* to get the (smoothed) image back mirror-symmetric convolve with a length 
@@ -466,87 +540,45 @@ D_IIR_forback2(double r, double omega, double *x, double *y,
 */
 
 int 
-D_cubic_spline2D(double *image, double *coeffs, int M, int N, double lambda,
-                 npy_intp *strides, npy_intp *cstrides, double precision)
+D_cubic_spline2D(double *image, double *coeffs, npy_intp nimages, int M, int N,
+                 double lambda, npy_intp *strides, npy_intp *cstrides,
+                 double precision, int workers)
 {
+    D_forback_plan plan;
     double r, omega;
-    double *inptr;
-    double *coptr;
-    double *tmpmem;
-    double *tptr;
-    int m,n, retval=0;
-
-    tmpmem = malloc(N*M*sizeof(double));
-    if (tmpmem == NULL) return -1;
+    int retval;
 
     if (lambda <= 1.0 / 144.0) { 
 	/* normal cubic spline */	
 	r = -2 + sqrt(3.0);
-
-	/* Loop over rows */
-	inptr = image;
-	tptr = tmpmem;    
-	for (m = 0; m < M; m++) { 
-	    retval = D_IIR_forback1 (-r*6.0, r, inptr, tptr, N, strides[1], 1, precision);
-	    if (retval < 0) break;
-	    inptr += strides[0];   
-	    tptr += N;
-	}
-
-	if (retval >=0) {
-	    /* Loop over columns */
-	    tptr = tmpmem;
-	    coptr = coeffs;
-	    for (n = 0; n < N; n++) {
-		retval = D_IIR_forback1 (-r*6.0, r, tptr, coptr, M, N, cstrides[0], precision);
-		if (retval < 0) break;
-		coptr += cstrides[1];
-		tptr += 1;
-	    }
-	}
-	free(tmpmem);
-	return retval;
+        retval = D_forback1_plan(&plan, -r*6.0, r, M > N ? M : N, precision);
     }
-
-    /* Smoothing spline */
-
-    /* Compute r and omega from lambda */
-    compute_root_from_lambda(lambda, &r, &omega);
-
-    /* Loop over rows */
-    inptr = image;
-    tptr = tmpmem;    
-    for (m = 0; m < M; m++) {
-	retval = D_IIR_forback2 (r, omega, inptr, tptr, N, strides[1], 
-				       1, precision);
-	if (retval < 0) break;
-	inptr += strides[0];   
-	tptr += N;
-    }
-    /* Loop over columns */
-    tptr = tmpmem;
-    coptr = coeffs;
-    for (n = 0; n < N; n++) {
-	retval = D_IIR_forback2 (r, omega, tptr, coptr, M, N, 
-				       cstrides[0], precision);
-	if (retval < 0) break;
-	coptr += cstrides[1];
-	tptr += 1;
+    else {
+        /* Smoothing spline */
+        compute_root_from_lambda(lambda, &r, &omega);
+        retval = D_forback2_plan(&plan, r, omega, M > N ? M : N, precision);
     }
 
-    free(tmpmem);
+    if (retval == 0) {
+        retval = spline2D_stack(D_forback_line, &plan, sizeof(double),
+                                (char *)image, (char *)coeffs, nimages, M, N,
+                                strides, cstrides, workers);
+    }
+    D_forback_plan_free(&plan);
     return retval;
 }
 
-/* Find the quadratic spline coefficients of an image 
-   image is M rows by N columns stored rowise in memory (vary column number
-          first). It will be replaced with the spline coefficients. 
+/* Find the quadratic spline coefficients of a stack of images
+   image is nimages images of M rows by N columns each; the coefficients
+          are written to coeffs, which may be the same memory.
    lambda is a smoothing parameter (lambda = 100 approximately corresponds
           to a cutoff frequency of 0.1*(sample freq))
 	  must be zero for now.
-   strides is an integer array [rowstride, colstride]
-          telling how much memory in units of sizeof(double) bytes to skip
-	  to get to the next element.
+   strides and cstrides are integer arrays [imagestride, rowstride,
+          colstride] telling how much memory in units of sizeof(double)
+	  bytes to skip to get to the next element of image and coeffs.
+   workers is the number of threads the rows and columns are shared
+          between.
 */
 
 /* to get the (smoothed) image back mirror-symmetric convolve with a length 
@@ -554,45 +586,24 @@ D_cubic_spline2D(double *image, double *coeffs, int M, int N, double lambda,
 */
 
 int 
-D_quadratic_spline2D(double *image, double *coeffs, int M, int N, double lambda,
-                     npy_intp *strides, npy_intp *cstrides, double precision)
+D_quadratic_spline2D(double *image, double *coeffs, npy_intp nimages, int M,
+                     int N, double lambda, npy_intp *strides,
+                     npy_intp *cstrides, double precision, int workers)
 {    
+    D_forback_plan plan;
     double r;
-    double *inptr;
-    double *coptr;
-    double *tmpmem;
-    double *tptr;
-    int m,n, retval=0;
+    int retval;
 
     if (lambda > 0) return -2;
 
-    tmpmem = malloc(N*M*sizeof(double));
-    if (tmpmem == NULL) return -1;
-
     /* normal quadratic spline */	
     r = -3 + 2*sqrt(2.0);
-    
-    /* Loop over rows */
-    inptr = image;
-    tptr = tmpmem;    
-    for (m = 0; m < M; m++) { 
-      retval = D_IIR_forback1 (-r*8.0, r, inptr, tptr, N, strides[1], 1, precision);
-      if (retval < 0) break;
-      inptr += strides[0];   
-      tptr += N;
+    retval = D_forback1_plan(&plan, -r*8.0, r, M > N ? M : N, precision);
+    if (retval == 0) {
+        retval = spline2D_stack(D_forback_line, &plan, sizeof(double),
+                                (char *)image, (char *)coeffs, nimages, M, N,
+                                strides, cstrides, workers);
     }
-    
-    if (retval >=0) {
-    /* Loop over columns */
-      tptr = tmpmem;
-      coptr = coeffs;
-      for (n = 0; n < N; n++) {
-	retval = D_IIR_forback1 (-r*8.0, r, tptr, coptr, M, N, cstrides[0], precision);
-	if (retval < 0) break;
-	coptr += cstrides[1];
-	tptr += 1;
-      }
-    }
-    free(tmpmem);
+    D_forback_plan_free(&plan);
     return retval;
 }
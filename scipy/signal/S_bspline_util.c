@@ -24,8 +24,17 @@ void S_FIR_mirror_symmetric(float*,float*,int,float*,int,int,int);
 int S_separable_2Dconvolve_mirror(float*,float*,int,int,float*,float*,int,int,
                                   npy_intp*,npy_intp*);
 int S_IIR_forback2(double,double,float*,float*,int,int,int,float); 
-int S_cubic_spline2D(float*,float*,int,int,double,npy_intp*,npy_intp*,float);
-int S_quadratic_spline2D(float*,float*,int,int,double,npy_intp*,npy_intp*,float);
+int S_cubic_spline2D(float*,float*,npy_intp,int,int,double,npy_intp*,npy_intp*,float,int);
+int S_quadratic_spline2D(float*,float*,npy_intp,int,int,double,npy_intp*,npy_intp*,float,int);
+
+typedef int spline_line_func(const void*,char*,char*,int,npy_intp,npy_intp,char*);
+int spline2D_stack(spline_line_func*,const void*,int,char*,char*,npy_intp,int,int,npy_intp*,npy_intp*,int);
+
+typedef struct S_forback_plan S_forback_plan;
+static void S_forback_plan_free(S_forback_plan*);
+static int S_forback1_plan(S_forback_plan*,float,float,int,float);
+static int S_forback2_plan(S_forback_plan*,double,double,int,float);
+static int S_forback_line(const void*,char*,char*,int,npy_intp,npy_intp,char*);
 
 /* Implement the following difference equation */
 /* y[n] = a1 * x[n] + a2 * y[n-1]  */
@@ -94,6 +103,58 @@ S_IIR_order2_cascade (float cs, float z1, float z2, float y1_0,
 }
 
 
+/* The weights of the mirror-symmetric starting values of S_IIR_forback1
+   and S_IIR_forback2. They only depend on the filter, so the lines of an
+   image share them instead of summing the series again for each line.
+   Sum i has the nw[i] weights w[i], or nw[i] = -1 if it did not converge
+   within the maxN terms that were tried.  */
+
+struct S_forback_plan {
+    int order;
+    float c0, z1;                  /* first order */
+    float cs, a2, a3, h0, h1;      /* second order */
+    int nw[4];
+    float *w[4];
+};
+
+static void
+S_forback_plan_free(S_forback_plan *plan)
+{
+    int i;
+
+    for (i = 0; i < 4; i++) free(plan->w[i]);
+}
+
+static int
+S_forback1_plan(S_forback_plan *plan, float c0, float z1, int maxN,
+                float precision)
+{
+    float powz1 = 1.0;
+    float err;
+    int k;
+
+    memset(plan, 0, sizeof(*plan));
+    plan->order = 1;
+    plan->c0 = c0;
+    plan->z1 = z1;
+    if (ABSQ(z1) >= 1.0) return -2; /* z1 not less than 1 */
+    if ((plan->w[0] = malloc((maxN+1)*sizeof(float)))==NULL) return -1;
+
+    /* yp[0] = x[0] + Sum(z1^(k+1) x[k]) */
+    precision *= precision;
+    plan->nw[0] = -1;
+    for (k = 0; k < maxN; k++) {
+        powz1 *= z1;
+        plan->w[0][k] = powz1;
+        err = ABSQ(powz1);
+        if (err <= precision) {
+            plan->nw[0] = k + 1;
+            break;
+        }
+    }
+    return 0;
+}
+
 /* Implement a smoothing IIR filter with mirror-symmetric boundary conditions
    using a cascade of first-order sections.  The second section uses a 
    reversed sequence.  This implements the following transfer function:
@@ -123,50 +184,22 @@ S_IIR_order2_cascade (float cs, float z1, float z2, float y1_0,
 */
 
 int 
-S_IIR_forback1 (float c0, float z1, float *x, float *y, 
-		int N, int stridex, int stridey, float precision) { 
+S_IIR_forback1(float c0, float z1, float *x, float *y,
+               int N, int stridex, int stridey, float precision)
+{ 
+    S_forback_plan plan;
     float *yp = NULL; 
-    float *xptr = x;
-    float yp0;
-    float powz1;  
-    float diff;
-    float err;
-    int k;
-
-    if (ABSQ(z1) >= 1.0) return -2; /* z1 not less than 1 */
-
-    /* Initialize memory for loop */ 
-    if ((yp = malloc(N*sizeof(float)))==NULL) return -1; 
-
-   /* Fix starting value assuming mirror-symmetric boundary conditions. */
-    yp0 = x[0];
-    powz1 = 1.0;
-    k = 0;
-    precision *= precision;
-    do {
-	yp[0] = yp0;
-	powz1 *= z1;
-	yp0 += powz1 * (*xptr);
-	diff = powz1;
-	err = ABSQ(diff);
-	xptr += stridex;
-	k++;
-    } while((err > precision) && (k < N));
-    if (k >= N) {
-        /* sum did not converge */
-        free(yp);
-        return -3;
-    } 
-    yp[0] = yp0;
-
-    S_IIR_order1(1.0, z1, x, yp, N, stridex, 1); 
-
-    *(y + (N-1)*stridey) = -c0 / (z1 - 1.0) * yp[N-1];
-
-    S_IIR_order1(c0, z1, yp+N-1, y+(N-1)*stridey, N, -1, -stridey);
+    int ret;
 
+    ret = S_forback1_plan(&plan, c0, z1, N, precision);
+    if (ret == 0) {
+        if ((yp = malloc(N*sizeof(float)))==NULL) ret = -1;
+        else ret = S_forback_line(&plan, (char *)x, (char *)y, N,
+                                  stridex, stridey, (char *)yp);
+    }
     free(yp);
-    return 0;
+    S_forback_plan_free(&plan);
+    return ret;
 }
 
 
@@ -313,6 +346,123 @@ S_hs(int k, float cs, double rsq, double omega) {
 }
 
 
+static int
+S_forback2_plan(S_forback_plan *plan, double r, double omega, int maxN,
+                float precision)
+{
+    double rsq;
+    float diff;
+    float err;
+    int i, k;
+
+    memset(plan, 0, sizeof(*plan));
+    plan->order = 2;
+    if (r >= 1.0) return -2; /* z1 not less than 1 */
+    for (i = 0; i < 4; i++) {
+        if ((plan->w[i] = malloc((maxN+1)*sizeof(float)))==NULL) return -1;
+        plan->nw[i] = -1;
+    }
+
+    rsq = r * r;
+    plan->a2 = 2 * r * cos(omega);
+    plan->a3 = -rsq;
+    plan->cs = 1 - 2 * r * cos(omega) + rsq;
+    plan->h0 = S_hc(0, plan->cs, r, omega);
+    plan->h1 = S_hc(1, plan->cs, r, omega);
+
+    /* the weights of yp[0], yp[1], y[N-1] and y[N-2] */
+    precision *= precision;
+    for (i = 0; i < 4; i++) {
+        for (k = 0; k < maxN; k++) {
+            switch (i) {
+            case 0:
+                diff = S_hc(k+1, plan->cs, r, omega);
+                break;
+            case 1:
+                diff = S_hc(k+2, plan->cs, r, omega);
+                break;
+            case 2:
+                diff = (S_hs(k, plan->cs, rsq, omega) +
+                        S_hs(k+1, plan->cs, rsq, omega));
+                break;
+            default:
+                diff = (S_hs(k-1, plan->cs, rsq, omega) +
+                        S_hs(k+2, plan->cs, rsq, omega));
+                break;
+            }
+            plan->w[i][k] = diff;
+            err = diff * diff;
+            if (err <= precision) {
+                plan->nw[i] = k + 1;
+                break;
+            }
+        }
+    }
+    return 0;
+}
+
+/* Filter one line with S_IIR_forback1 or S_IIR_forback2, as planned;
+   work holds room for N samples. */
+static int
+S_forback_line(const void *plan_, char *x_, char *y_, int N,
+               npy_intp stridex_, npy_intp stridey_, char *work)
+{
+    const S_forback_plan *plan = (const S_forback_plan *)plan_;
+    float *x = (float *)x_, *y = (float *)y_, *yp = (float *)work;
+    int stridex = (int)stridex_, stridey = (int)stridey_;
+    float yp0;
+    float yp1;
+    const float *w;
+    int i, k;
+
+    for (i = 0; i < (plan->order == 1 ? 1 : 4); i++) {
+        /* sum did not converge */
+        if (plan->nw[i] < 0 || plan->nw[i] >= N) return -3;
+    }
+
+    if (plan->order == 1) {
+        w = plan->w[0];
+        yp0 = x[0];
+        for (k = 0; k < plan->nw[0]; k++) yp0 += w[k] * x[k*stridex];
+        yp[0] = yp0;
+
+        S_IIR_order1(1.0, plan->z1, x, yp, N, stridex, 1); 
+
+        *(y + (N-1)*stridey) = -plan->c0 / (plan->z1 - 1.0) * yp[N-1];
+
+        S_IIR_order1(plan->c0, plan->z1, yp+N-1, y+(N-1)*stridey, N, -1,
+                     -stridey);
+        return 0;
+    }
+
+    w = plan->w[0];
+    yp0 = plan->h0 * x[0];
+    for (k = 0; k < plan->nw[0]; k++) yp0 += w[k] * x[k*stridex];
+    yp[0] = yp0;
+
+    w = plan->w[1];
+    yp1 = plan->h0 * x[stridex];
+    yp1 += plan->h1 * x[0];
+    for (k = 0; k < plan->nw[1]; k++) yp1 += w[k] * x[k*stridex];
+    yp[1] = yp1;
+
+    S_IIR_order2(plan->cs, plan->a2, plan->a3, x, yp, N, stridex, 1); 
+
+    w = plan->w[2];
+    yp0 = 0.0;
+    for (k = 0; k < plan->nw[2]; k++) yp0 += w[k] * x[(N-1-k)*stridex];
+    y[(N-1)*stridey] = yp0;
+
+    w = plan->w[3];
+    yp1 = 0.0;
+    for (k = 0; k < plan->nw[3]; k++) yp1 += w[k] * x[(N-1-k)*stridex];
+    y[(N-2)*stridey] = yp1;
+
+    S_IIR_order2(plan->cs, plan->a2, plan->a3, yp+N-1, y+(N-1)*stridey, N,
+                 -1, -stridey);
+    return 0;
+}
+
 /* Implement a smoothing IIR filter with mirror-symmetric boundary conditions
    using a cascade of second-order sections.  The second section uses a 
    reversed sequence.  This implements the following transfer function:
@@ -349,108 +499,34 @@ S_hs(int k, float cs, double rsq, double omega) {
 */
 
 int 
-S_IIR_forback2 (double r, double omega, float *x, float *y, 
-		int N, int stridex, int stridey, float precision) { 
-    float cs;
+S_IIR_forback2(double r, double omega, float *x, float *y,
+               int N, int stridex, int stridey, float precision)
+{
+    S_forback_plan plan;
     float *yp = NULL; 
-    float *yptr;
-    float *xptr;
-    float yp0;
-    float yp1;
-    double rsq;
-    float diff;
-    float err; 
-    float a2, a3;
-    int k;
-
-    if (r >= 1.0) return -2; /* z1 not less than 1 */
-
-    /* Initialize memory for loop */ 
-    if ((yp = malloc(N*sizeof(float)))==NULL) return -1; 
-    
-    rsq = r * r;
-    a2 = 2 * r * cos(omega);
-    a3 = -rsq;
-    cs = 1 - 2 * r * cos(omega) + rsq;
-
-   /* Fix starting values assuming mirror-symmetric boundary conditions. */
-    yp0 = S_hc(0, cs, r, omega) * x[0];
-    k = 0;
-    precision *= precision;
-    xptr = x;
-    do {
-	yp[0] = yp0;
-	diff = S_hc(k+1, cs, r, omega); 
-  	yp0 += diff * (*xptr); 
-	err = diff * diff;
-	xptr += stridex;
-	k++;
-    } while((err > precision) && (k < N));
-    if (k >= N) {free(yp); return -3;}     /* sum did not converge */ 
-    yp[0] = yp0;
-
-    yp1 = S_hc(0, cs, r, omega) * (*(x+stridex));
-    yp1 += S_hc(1, cs, r, omega) * x[0];
-    k = 0;
-    xptr = x;
-    do {
-	yp[1] = yp1;
-	diff = S_hc(k+2, cs, r, omega);
-	yp1 += diff * (*xptr);
-	err = diff * diff;
-	xptr += stridex;
-	k++;
-    } while((err > precision) && (k < N));
-    if (k >= N) {free(yp); return -3;}     /* sum did not converge */ 
-    yp[1] = yp1;
-
-    S_IIR_order2(cs, a2, a3, x, yp, N, stridex, 1); 
-
-   /* Fix starting values assuming mirror-symmetric boundary conditions. */
-    yp0 = 0.0;
-    k = 0;
-    yptr = y + (N-1)*stridey;
-    xptr = x + (N-1)*stridex;
-    do {
-	*yptr = yp0;
-	diff = (S_hs(k, cs, rsq, omega) + S_hs(k+1, cs, rsq, omega));
-	yp0 += diff * (*xptr);
-	err = diff * diff;
-	xptr -= stridex;
-	k++;
-    } while((err > precision) && (k < N));
-    if (k >= N) {free(yp); return -3;}     /* sum did not converge */ 
-    *yptr = yp0;
-
-    yp1 = 0.0;
-    k = 0;
-    yptr -= stridey;        /* Initialize in next-to-last slot in output array */
-    xptr = x + (N-1)*stridex;
-    do {
-	*yptr = yp1;
-	diff = (S_hs(k-1, cs, rsq, omega) + S_hs(k+2, cs, rsq, omega));
-	yp1 += diff * (*xptr);
-	err = diff * diff;
-	xptr -= stridex;
-	k++;
-    } while((err > precision) && (k < N));
-    if (k >= N) {free(yp); return -3;}     /* sum did not converge */ 
-    *yptr = yp1;
-
-    S_IIR_order2(cs, a2, a3, yp+N-1, yptr+stridey, N, -1, -stridey);
+    int ret;
 
+    ret = S_forback2_plan(&plan, r, omega, N, precision);
+    if (ret == 0) {
+        if ((yp = malloc(N*sizeof(float)))==NULL) ret = -1;
+        else ret = S_forback_line(&plan, (char *)x, (char *)y, N,
+                                  stridex, stridey, (char *)yp);
+    }
     free(yp);
-    return 0;
+    S_forback_plan_free(&plan);
+    return ret;
 }
 
-/* Find the cubic spline coefficients of an image 
-   image is M rows by N columns stored rowise in memory (vary column number
-          first). It will be replaced with the spline coefficients. 
+/* Find the cubic spline coefficients of a stack of images
+   image is nimages images of M rows by N columns each; the coefficients
+          are written to coeffs, which may be the same memory.
    lambda is a smoothing parameter (lambda = 100 approximately corresponds
           to a cutoff frequency of 0.1*(sample freq))
-   strides is an integer array [rowstride, colstride]
-          telling how much memory in units of sizeof(float) bytes to skip
-	  to get to the next element.
+   strides and cstrides are integer arrays [imagestride, rowstride,
+          colstride] telling how much memory in units of sizeof(float)
+	  bytes to skip to get to the next element of image and coeffs.
+   workers is the number of threads the rows and columns are shared
+          between.
 */
 
 /* to get the (smoothed) image back mirror-symmetric convolve with a length 
@@ -458,86 +534,45 @@ S_IIR_forback2 (double r, double omega, float *x, float *y,
 */
 
 int 
-S_cubic_spline2D(float *image, float *coeffs, int M, int N, double lambda,
-		 npy_intp *strides, npy_intp *cstrides, float precision) {    
+S_cubic_spline2D(float *image, float *coeffs, npy_intp nimages, int M, int N,
+                 double lambda, npy_intp *strides, npy_intp *cstrides,
+                 float precision, int workers)
+{
+    S_forback_plan plan;
     double r, omega;
-    float *inptr;
-    float *coptr;
-    float *tmpmem;
-    float *tptr;
-    int m,n, retval=0;
-
-    tmpmem = malloc(N*M*sizeof(float));
-    if (tmpmem == NULL) return -1;
+    int retval;
 
     if (lambda <= 1.0 / 144.0) { 
 	/* normal cubic spline */	
 	r = -2 + sqrt(3.0);
-
-	/* Loop over rows */
-	inptr = image;
-	tptr = tmpmem;    
-	for (m = 0; m < M; m++) { 
-	    retval = S_IIR_forback1 (-r*6.0, r, inptr, tptr, N, strides[1], 1, precision);
-	    if (retval < 0) break;
-	    inptr += strides[0];   
-	    tptr += N;
-	}
-
-	if (retval >=0) {
-	    /* Loop over columns */
-	    tptr = tmpmem;
-	    coptr = coeffs;
-	    for (n = 0; n < N; n++) {
-		retval = S_IIR_forback1 (-r*6.0, r, tptr, coptr, M, N, cstrides[0], precision);
-		if (retval < 0) break;
-		coptr += cstrides[1];
-		tptr += 1;
-	    }
-	}
-	free(tmpmem);
-	return retval;
+        retval = S_forback1_plan(&plan, -r*6.0, r, M > N ? M : N, precision);
     }
-
-    /* Smoothing spline */
-
-    /* Compute r and omega from lambda */
-    compute_root_from_lambda(lambda, &r, &omega);
-
-    /* Loop over rows */
-    inptr = image;
-    tptr = tmpmem;    
-    for (m = 0; m < M; m++) {
-	retval = S_IIR_forback2 (r, omega, inptr, tptr, N, strides[1], 
-				       1, precision);
-	if (retval < 0) break;
-	inptr += strides[0];   
-	tptr += N;
-    }
-    /* Loop over columns */
-    tptr = tmpmem;
-    coptr = coeffs;
-    for (n = 0; n < N; n++) {
-	retval = S_IIR_forback2 (r, omega, tptr, coptr, M, N, 
-				       cstrides[0], precision);
-	if (retval < 0) break;
-	coptr += cstrides[1];
-	tptr += 1;
+    else {
+        /* Smoothing spline */
+        compute_root_from_lambda(lambda, &r, &omega);
+        retval = S_forback2_plan(&plan, r, omega, M > N ? M : N, precision);
     }
 
-    free(tmpmem);
+    if (retval == 0) {
+        retval = spline2D_stack(S_forback_line, &plan, sizeof(float),
+                                (char *)image, (char *)coeffs, nimages, M, N,
+                                strides, cstrides, workers);
+    }
+    S_forback_plan_free(&plan);
     return retval;
 }
 
-/* Find the quadratic spline coefficients of an image 
-   image is M rows by N columns stored rowise in memory (vary column number
-          first). It will be replaced with the spline coefficients. 
+/* Find the quadratic spline coefficients of a stack of images
+   image is nimages images of M rows by N columns each; the coefficients
+          are written to coeffs, which may be the same memory.
    lambda is a smoothing parameter (lambda = 100 approximately corresponds
           to a cutoff frequency of 0.1*(sample freq))
 	  must be zero for now.
-   strides is an integer array [rowstride, colstride]
-          telling how much memory in units of sizeof(float) bytes to skip
-	  to get to the next element.
+   strides and cstrides are integer arrays [imagestride, rowstride,
+          colstride] telling how much memory in units of sizeof(float)
+	  bytes to skip to get to the next element of image and coeffs.
+   workers is the number of threads the rows and columns are shared
+          between.
 */
 
 /* to get the (smoothed) image back mirror-symmetric convolve with a length 
@@ -545,45 +580,25 @@ S_cubic_spline2D(float *image, float *coeffs, int M, int N, double lambda,
 */
 
 int 
-S_quadratic_spline2D(float *image, float *coeffs, int M, int N, double lambda,
-		     npy_intp *strides, npy_intp *cstrides, float precision) {    
+S_quadratic_spline2D(float *image, float *coeffs, npy_intp nimages, int M,
+                     int N, double lambda, npy_intp *strides,
+                     npy_intp *cstrides, float precision, int workers)
+{    
+    S_forback_plan plan;
     double r;
-    float *inptr;
-    float *coptr;
-    float *tmpmem;
-    float *tptr;
-    int m,n, retval=0;
+    int retval;
 
     if (lambda > 0) return -2;
 
-    tmpmem = malloc(N*M*sizeof(float));
-    if (tmpmem == NULL) return -1;
-
     /* normal quadratic spline */	
     r = -3 + 2*sqrt(2.0);
-    
-    /* Loop over rows */
-    inptr = image;
-    tptr = tmpmem;    
-    for (m = 0; m < M; m++) { 
-      retval = S_IIR_forback1 (-r*8.0, r, inptr, tptr, N, strides[1], 1, precision);
-      if (retval < 0) break;
-      inptr += strides[0];   
-      tptr += N;
+    retval = S_forback1_plan(&plan, -r*8.0, r, M > N ? M : N, precision);
+    if (retval == 0) {
+        retval = spline2D_stack(S_forback_line, &plan, sizeof(float),
+                                (char *)image, (char *)coeffs, nimages, M, N,
+                                strides, cstrides, workers);
     }
-    
-    if (retval >=0) {
-    /* Loop over columns */
-      tptr = tmpmem;
-      coptr = coeffs;
-      for (n = 0; n < N; n++) {
-	retval = S_IIR_forback1 (-r*8.0, r, tptr, coptr, M, N, cstrides[0], precision);
-	if (retval < 0) break;
-	coptr += cstrides[1];
-	tptr += 1;
-      }
-    }
-    free(tmpmem);
+    S_forback_plan_free(&plan);
     return retval;
 }
 
@@ -69,6 +69,7 @@ Filtering
    detrend       -- Remove linear and/or constant trends from data.
    resample      -- Resample using Fourier method.
    resample_poly -- Resample using polyphase filtering method.
+   ResamplePoly  -- Resample a signal in chunks using polyphase filtering.
    upfirdn       -- Upsample, apply FIR filter, downsample.
 
 Filter design
@@ -106,6 +107,7 @@ Filter design
    savgol_coeffs -- Compute the FIR filter coefficients for a Savitzky-Golay
                     -- filter.
    remez         -- Optimal FIR filter design.
+   remez_batch   -- Optimal FIR filter design of several filters at once.
 
    unique_roots  -- Unique roots and their multiplicities.
    residue       -- Partial fraction expansion of b(s) / a(s).
@@ -261,6 +263,7 @@ Peak finding
    argrelmax        -- Calculate the relative maxima of data
    argrelextrema    -- Calculate the relative extrema of data
    find_peaks       -- Find a subset of peaks inside a signal.
+   find_peaks_batch -- Find a subset of peaks inside each row of a 2-D array.
    find_peaks_cwt   -- Find peaks in a 1-D array with wavelet transformation.
    peak_prominences -- Calculate the prominence of each peak in a signal.
    peak_widths      -- Calculate the width of each peak in a signal.
@@ -273,6 +276,7 @@ Spectral Analysis
 
    periodogram    -- Compute a (modified) periodogram
    welch          -- Compute a periodogram using Welch's method
+   WelchEstimator -- Estimate a PSD with Welch's method, in chunks
    csd            -- Compute the cross spectral density, using Welch's method
    coherence      -- Compute the magnitude squared coherence, using Welch's method
    spectrogram    -- Compute the spectrogram
@@ -4,6 +4,7 @@ Functions for identifying peaks in signals.
 from __future__ import division, print_function, absolute_import
 
 import math
+import threading
 import numpy as np
 
 from scipy._lib.six import xrange
@@ -11,15 +12,15 @@ from scipy.signal.wavelets import cwt, ricker
 from scipy.stats import scoreatpercentile
 
 from ._peak_finding_utils import (
-    _local_maxima_1d,
-    _select_by_peak_distance,
     _peak_prominences,
-    _peak_widths
+    _peak_widths,
+    _find_peaks_fused
 )
+from .signaltools import _check_workers
 
 
 __all__ = ['argrelmin', 'argrelmax', 'argrelextrema', 'peak_prominences',
-           'peak_widths', 'find_peaks', 'find_peaks_cwt']
+           'peak_widths', 'find_peaks', 'find_peaks_batch', 'find_peaks_cwt']
 
 
 def _boolrelextrema(data, comparator, axis=0, order=1, mode='clip'):
@@ -640,89 +641,6 @@ def _unpack_condition_args(interval, x, peaks):
     return imin, imax
 
 
-def _select_by_property(peak_properties, pmin, pmax):
-    """
-    Evaluate where the generic property of peaks confirms to an interval.
-
-    Parameters
-    ----------
-    peak_properties : ndarray
-        An array with properties for each peak.
-    pmin : None or number or ndarray
-        Lower interval boundary for `peak_properties`. ``None`` is interpreted as
-        an open border.
-    pmax : None or number or ndarray
-        Upper interval boundary for `peak_properties`. ``None`` is interpreted as
-        an open border.
-
-    Returns
-    -------
-    keep : bool
-        A boolean mask evaluating to true where `peak_properties` confirms to the
-        interval.
-
-    See Also
-    --------
-    find_peaks
-
-    Notes
-    -----
-
-    .. versionadded:: 1.1.0
-    """
-    keep = np.ones(peak_properties.size, dtype=bool)
-    if pmin is not None:
-        keep &= (pmin <= peak_properties)
-    if pmax is not None:
-        keep &= (peak_properties <= pmax)
-    return keep
-
-
-def _select_by_peak_threshold(x, peaks, tmin, tmax):
-    """
-    Evaluate which peaks fulfill the threshold condition.
-
-    Parameters
-    ----------
-    x : ndarray
-        A one-dimensional array which is indexable by `peaks`.
-    peaks : ndarray
-        Indices of peaks in `x`.
-    tmin, tmax : scalar or ndarray or None
-         Minimal and / or maximal required thresholds. If supplied as ndarrays
-         their size must match `peaks`. ``None`` is interpreted as an open
-         border.
-
-    Returns
-    -------
-    keep : bool
-        A boolean mask evaluating to true where `peaks` fulfill the threshold
-        condition.
-    left_thresholds, right_thresholds : ndarray
-        Array matching `peak` containing the thresholds of each peak on
-        both sides.
-
-    Notes
-    -----
-
-    .. versionadded:: 1.1.0
-    """
-    # Stack thresholds on both sides to make min / max operations easier:
-    # tmin is compared with the smaller, and tmax with the greater thresold to
-    # each peak's side
-    stacked_thresholds = np.vstack([x[peaks] - x[peaks - 1],
-                                    x[peaks] - x[peaks + 1]])
-    keep = np.ones(peaks.size, dtype=bool)
-    if tmin is not None:
-        min_thresholds = np.min(stacked_thresholds, axis=0)
-        keep &= (tmin <= min_thresholds)
-    if tmax is not None:
-        max_thresholds = np.max(stacked_thresholds, axis=0)
-        keep &= (max_thresholds <= tmax)
-
-    return keep, stacked_thresholds[0], stacked_thresholds[1]
-
-
 def find_peaks(x, height=None, threshold=None, distance=None,
                prominence=None, width=None, wlen=None, rel_height=0.5,
                plateau_size=None):
@@ -822,6 +740,8 @@ def find_peaks(x, height=None, threshold=None, distance=None,
 
     See Also
     --------
+    find_peaks_batch
+        Find peaks in each row of a 2-D array on several threads.
     find_peaks_cwt
         Find peaks using the wavelet transformation.
     peak_prominences
@@ -854,7 +774,10 @@ def find_peaks(x, height=None, threshold=None, distance=None,
     * The conditions are evaluated in the following order: `plateau_size`,
       `height`, `threshold`, `distance`, `prominence`, `width`. In most cases
       this order is the fastest one because faster operations are applied first
-      to reduce the number of peaks that need to be evaluated later.
+      to reduce the number of peaks that need to be evaluated later. The
+      local maxima are tested against the first three conditions while they
+      are found, and the prominence and width conditions are evaluated in a
+      single pass, so that no property is calculated for an excluded peak.
     * While indices in `peaks` are guaranteed to be at least `distance` samples
       apart, edges of flat peaks may be closer than the allowed `distance`.
     * Use `wlen` to reduce the time it takes to evaluate the conditions for
@@ -931,79 +854,171 @@ def find_peaks(x, height=None, threshold=None, distance=None,
     ...            xmax=properties["right_ips"], color = "C1")
     >>> plt.show()
     """
-    # _argmaxima1d expects array of dtype 'float64'
+    # _find_peaks_fused expects array of dtype 'float64'
     x = _arg_x_as_expected(x)
+    conditions = _find_peaks_conditions(
+        x, height, threshold, distance, prominence, width, wlen,
+        rel_height, plateau_size)
+    return _find_peaks_properties(x, _find_peaks_fused(x, *conditions),
+                                  height, threshold, prominence, width,
+                                  plateau_size)
+
+
+def _condition_borders(interval, x):
+    """
+    Parse a condition argument of `find_peaks` for `_find_peaks_fused`.
+
+    Parameters
+    ----------
+    interval : number or ndarray or sequence or None
+        As for `_unpack_condition_args`.
+    x : ndarray
+        The signal, or one like it, whose size arrays given as borders have to
+        match.
+
+    Returns
+    -------
+    imin, imax : ndarray
+        The borders as float64 arrays, which are empty if the border is open,
+        hold one value if it is a number or else one value per sample.
+    """
+    borders = _unpack_condition_args(interval, x, Ellipsis)
+    return tuple(np.empty(0) if border is None
+                 else np.ascontiguousarray(border.ravel(), dtype=np.float64)
+                 if isinstance(border, np.ndarray)
+                 else np.full(1, border, dtype=np.float64)
+                 for border in borders)
+
+
+def _find_peaks_conditions(x, height, threshold, distance, prominence,
+                           width, wlen, rel_height, plateau_size):
+    """The arguments of `find_peaks` as `_find_peaks_fused` takes them."""
     if distance is not None and distance < 1:
         raise ValueError('`distance` must be greater or equal to 1')
-
-    peaks, left_edges, right_edges = _local_maxima_1d(x)
+    if width is not None and rel_height < 0:
+        raise ValueError('`rel_height` must be greater or equal to 0.0')
+    if prominence is not None or width is not None:
+        wlen = _arg_wlen_as_expected(wlen)
+    else:
+        wlen = -1
+    return (_condition_borders(plateau_size, x)
+            + _condition_borders(height, x)
+            + _condition_borders(threshold, x)
+            + (distance, prominence is not None or width is not None, wlen)
+            + _condition_borders(prominence, x)
+            + (width is not None, rel_height)
+            + _condition_borders(width, x))
+
+
+def _find_peaks_properties(x, fused, height, threshold, prominence, width,
+                           plateau_size):
+    """The peaks and properties `find_peaks` returns, from those which
+    `_find_peaks_fused` found."""
+    (peaks, left_edges, right_edges, left_thresholds, right_thresholds,
+     prominences, left_bases, right_bases,
+     widths, width_heights, left_ips, right_ips) = fused
     properties = {}
-
     if plateau_size is not None:
-        # Evaluate plateau size
-        plateau_sizes = right_edges - left_edges + 1
-        pmin, pmax = _unpack_condition_args(plateau_size, x, peaks)
-        keep = _select_by_property(plateau_sizes, pmin, pmax)
-        peaks = peaks[keep]
-        properties["plateau_sizes"] = plateau_sizes
+        properties["plateau_sizes"] = right_edges - left_edges + 1
         properties["left_edges"] = left_edges
         properties["right_edges"] = right_edges
-        properties = {key: array[keep] for key, array in properties.items()}
-
     if height is not None:
-        # Evaluate height condition
-        peak_heights = x[peaks]
-        hmin, hmax = _unpack_condition_args(height, x, peaks)
-        keep = _select_by_property(peak_heights, hmin, hmax)
-        peaks = peaks[keep]
-        properties["peak_heights"] = peak_heights
-        properties = {key: array[keep] for key, array in properties.items()}
-
+        properties["peak_heights"] = x[peaks]
     if threshold is not None:
-        # Evaluate threshold condition
-        tmin, tmax = _unpack_condition_args(threshold, x, peaks)
-        keep, left_thresholds, right_thresholds = _select_by_peak_threshold(
-            x, peaks, tmin, tmax)
-        peaks = peaks[keep]
         properties["left_thresholds"] = left_thresholds
         properties["right_thresholds"] = right_thresholds
-        properties = {key: array[keep] for key, array in properties.items()}
+    if prominence is not None or width is not None:
+        properties["prominences"] = prominences
+        properties["left_bases"] = left_bases
+        properties["right_bases"] = right_bases
+    if width is not None:
+        properties["widths"] = widths
+        properties["width_heights"] = width_heights
+        properties["left_ips"] = left_ips
+        properties["right_ips"] = right_ips
+    return peaks, properties
 
-    if distance is not None:
-        # Evaluate distance condition
-        keep = _select_by_peak_distance(peaks, x[peaks], distance)
-        peaks = peaks[keep]
-        properties = {key: array[keep] for key, array in properties.items()}
 
-    if prominence is not None or width is not None:
-        # Calculate prominence (required for both conditions)
-        wlen = _arg_wlen_as_expected(wlen)
-        properties.update(zip(
-            ['prominences', 'left_bases', 'right_bases'],
-            _peak_prominences(x, peaks, wlen=wlen)
-        ))
-
-    if prominence is not None:
-        # Evaluate prominence condition
-        pmin, pmax = _unpack_condition_args(prominence, x, peaks)
-        keep = _select_by_property(properties['prominences'], pmin, pmax)
-        peaks = peaks[keep]
-        properties = {key: array[keep] for key, array in properties.items()}
+def find_peaks_batch(x, height=None, threshold=None, distance=None,
+                     prominence=None, width=None, wlen=None, rel_height=0.5,
+                     plateau_size=None, workers=None):
+    """
+    Find peaks inside each row of a 2-D array of signals.
 
-    if width is not None:
-        # Calculate widths
-        properties.update(zip(
-            ['widths', 'width_heights', 'left_ips', 'right_ips'],
-            _peak_widths(x, peaks, rel_height, properties['prominences'],
-                         properties['left_bases'], properties['right_bases'])
-        ))
-        # Evaluate width condition
-        wmin, wmax = _unpack_condition_args(width, x, peaks)
-        keep = _select_by_property(properties['widths'], wmin, wmax)
-        peaks = peaks[keep]
-        properties = {key: array[keep] for key, array in properties.items()}
+    Applies `find_peaks` with the same conditions to every row of `x`, sharing
+    the rows between threads.
 
-    return peaks, properties
+    Parameters
+    ----------
+    x : array_like
+        A 2-D array with one signal in each row.
+    height, threshold, distance, prominence, width, wlen, rel_height, \
+plateau_size
+        The conditions of `find_peaks`, which apply to each signal. Arrays
+        given as interval borders have to match a row of `x`.
+    workers : int, optional
+        Number of threads to share the rows between. If negative, the value
+        wraps around from ``os.cpu_count()``. Default is a single thread.
+
+    Returns
+    -------
+    peaks : list of ndarray
+        The peaks `find_peaks` finds in each row of `x`.
+    properties : list of dict
+        The properties `find_peaks` returns for the peaks of each row.
+
+    See Also
+    --------
+    find_peaks
+
+    Notes
+    -----
+    .. versionadded:: 1.4.0
+
+    Examples
+    --------
+    >>> from scipy.signal import find_peaks_batch
+    >>> x = np.sin(np.linspace(0, 4 * np.pi, 200) + np.arange(3)[:, None])
+    >>> peaks, properties = find_peaks_batch(x, height=0.5, workers=2)
+    >>> [p.size for p in peaks]
+    [2, 2, 2]
+
+    """
+    x = np.asarray(x, order='C', dtype=np.float64)
+    if x.ndim != 2:
+        raise ValueError('`x` must be a 2D array')
+    workers = _check_workers(workers)
+    conditions = _find_peaks_conditions(
+        np.empty(x.shape[1]), height, threshold, distance, prominence, width, wlen,
+        rel_height, plateau_size)
+
+    results = [None] * x.shape[0]
+    errors = []
+
+    def find(start, stop):
+        try:
+            for row in range(start, stop):
+                results[row] = _find_peaks_properties(
+                    x[row], _find_peaks_fused(x[row], *conditions), height,
+                    threshold, prominence, width, plateau_size)
+        except BaseException as e:
+            errors.append(e)
+
+    # Contiguous blocks of rows, the first of which is found on this thread
+    nthreads = max(min(workers, x.shape[0]), 1)
+    bounds = [x.shape[0] * k // nthreads for k in range(nthreads + 1)]
+    threads = [threading.Thread(target=find, args=bounds[k:k + 2])
+               for k in range(1, nthreads)]
+    for thread in threads:
+        thread.start()
+    find(bounds[0], bounds[1])
+    for thread in threads:
+        thread.join()
+    if errors:
+        raise errors[0]
+
+    return ([result[0] for result in results],
+            [result[1] for result in results])
 
 
 def _identify_ridge_lines(matr, max_distances, gap_thresh):
@@ -13,7 +13,7 @@ from libc.math cimport ceil
 
 
 __all__ = ['_local_maxima_1d', '_select_by_peak_distance', '_peak_prominences',
-           '_peak_widths']
+           '_peak_widths', '_find_peaks_fused']
 
 
 def _local_maxima_1d(np.float64_t[::1] x not None):
@@ -372,3 +372,260 @@ def _peak_widths(np.float64_t[::1] x not None,
         warnings.warn("some peaks have a width of 0",
                       PeakPropertyWarning, stacklevel=2)
     return widths.base, width_heights.base, left_ips.base, right_ips.base
+
+
+cdef inline bint _in_bounds(np.float64_t[::1] lo, np.float64_t[::1] hi,
+                            np.intp_t i, np.float64_t value) nogil:
+    """
+    Whether `value`, a property of the peak at index `i`, lies within the
+    interval [`lo`, `hi`]. An empty border is open, a border of size 1 applies
+    to every sample and a larger one holds a border for each sample.
+    """
+    if lo.shape[0] > 0 and not lo[i if lo.shape[0] > 1 else 0] <= value:
+        return False
+    if hi.shape[0] > 0 and not value <= hi[i if hi.shape[0] > 1 else 0]:
+        return False
+    return True
+
+
+def _find_peaks_fused(np.float64_t[::1] x not None,
+                      np.float64_t[::1] plateau_min not None,
+                      np.float64_t[::1] plateau_max not None,
+                      np.float64_t[::1] height_min not None,
+                      np.float64_t[::1] height_max not None,
+                      np.float64_t[::1] threshold_min not None,
+                      np.float64_t[::1] threshold_max not None,
+                      distance,
+                      bint prominence,
+                      np.intp_t wlen,
+                      np.float64_t[::1] prominence_min not None,
+                      np.float64_t[::1] prominence_max not None,
+                      bint width,
+                      np.float64_t rel_height,
+                      np.float64_t[::1] width_min not None,
+                      np.float64_t[::1] width_max not None):
+    """
+    Find the peaks in a 1D array which fulfill the conditions of `find_peaks`.
+
+    The local maxima are tested against the plateau size, height and threshold
+    conditions while they are found, the survivors against the distance
+    condition, and those against the prominence and width conditions while
+    the prominences and widths are calculated, so that no property is
+    calculated for, or stored of, a peak which was already rejected.
+
+    Parameters
+    ----------
+    x : ndarray
+        The array to search for peaks.
+    plateau_min, plateau_max, height_min, height_max, threshold_min, \
+threshold_max, prominence_min, prominence_max, width_min, width_max : ndarray
+        The interval borders of each condition: empty if the border is open,
+        of size 1 if it applies to every sample, or else of the size of `x`.
+    distance : np.float64 or None
+        Minimal distance that peaks must be spaced, if any.
+    prominence, width : bool
+        Whether to calculate the prominences (and bases) and the widths (and
+        their heights and intersection points) of the peaks. Widths require
+        prominences.
+    wlen : np.intp
+        The window length for the prominences (see `_peak_prominences`).
+    rel_height : np.float64
+        The relative height at which the widths are measured (see
+        `_peak_widths`).
+
+    Returns
+    -------
+    peaks : ndarray
+        Indices of the peaks in `x` which fulfill all conditions.
+    left_edges, right_edges, left_thresholds, right_thresholds : ndarray
+        Edges of the plateaus and thresholds to both sides of each peak.
+    prominences, left_bases, right_bases : ndarray or None
+        As returned by `_peak_prominences`, if `prominence` is true.
+    widths, width_heights, left_ips, right_ips : ndarray or None
+        As returned by `_peak_widths`, if `width` is true.
+
+    Warns
+    -----
+    PeakPropertyWarning
+        If a prominence of 0 was calculated for any peak tested against the
+        prominence condition, or a width of 0 for any peak tested against the
+        width condition.
+
+    Notes
+    -----
+    Gives the same peaks and properties as calling `_local_maxima_1d`,
+    `_select_by_peak_distance`, `_peak_prominences` and `_peak_widths` in
+    turn and selecting peaks by their properties in between.
+
+    .. versionadded:: 1.4.0
+    """
+    cdef:
+        np.intp_t[::1] peaks, left_edges, right_edges, left_bases, right_bases
+        np.float64_t[::1] left_thresholds, right_thresholds, prominences
+        np.float64_t[::1] widths, width_heights, left_ips, right_ips
+        np.uint8_t[::1] keep
+        np.intp_t m, n, p, k, i, i_ahead, i_max, i_min, peak
+        np.float64_t left_threshold, right_threshold, left_min, right_min
+        np.float64_t prom, height, left_ip, right_ip
+        bint prominence_warning = False, width_warning = False
+
+    # Preallocate, there can't be more maxima than half the size of `x`
+    n = x.shape[0] // 2
+    peaks = np.empty(n, dtype=np.intp)
+    left_edges = np.empty(n, dtype=np.intp)
+    right_edges = np.empty(n, dtype=np.intp)
+    left_thresholds = np.empty(n, dtype=np.float64)
+    right_thresholds = np.empty(n, dtype=np.float64)
+    m = 0  # Pointer to the end of valid area in allocated arrays
+
+    with nogil:
+        # Find the local maxima as `_local_maxima_1d` does
+        i = 1
+        i_max = x.shape[0] - 1
+        while i < i_max:
+            if x[i - 1] < x[i]:
+                i_ahead = i + 1
+                while i_ahead < i_max and x[i_ahead] == x[i]:
+                    i_ahead += 1
+
+                if x[i_ahead] < x[i]:
+                    peak = (i + i_ahead - 1) // 2
+                    left_threshold = x[peak] - x[peak - 1]
+                    right_threshold = x[peak] - x[peak + 1]
+                    # The smaller threshold has to exceed `threshold_min`, the
+                    # larger one to stay below `threshold_max`
+                    if (_in_bounds(plateau_min, plateau_max, peak,
+                                   <np.float64_t>(i_ahead - i))
+                            and _in_bounds(height_min, height_max, peak,
+                                           x[peak])
+                            and _in_bounds(threshold_min, threshold_max, peak,
+                                           left_threshold)
+                            and _in_bounds(threshold_min, threshold_max, peak,
+                                           right_threshold)):
+                        peaks[m] = peak
+                        left_edges[m] = i
+                        right_edges[m] = i_ahead - 1
+                        left_thresholds[m] = left_threshold
+                        right_thresholds[m] = right_threshold
+                        m += 1
+                    i = i_ahead
+            i += 1
+
+    if distance is not None and m > 1:
+        keep = _select_by_peak_distance(
+            np.asarray(peaks)[:m], np.asarray(x)[np.asarray(peaks)[:m]],
+            distance).view(np.uint8)
+        k = 0
+        for p in range(m):
+            if keep[p]:
+                peaks[k] = peaks[p]
+                left_edges[k] = left_edges[p]
+                right_edges[k] = right_edges[p]
+                left_thresholds[k] = left_thresholds[p]
+                right_thresholds[k] = right_thresholds[p]
+                k += 1
+        m = k
+
+    if prominence:
+        prominences = np.empty(m, dtype=np.float64)
+        left_bases = np.empty(m, dtype=np.intp)
+        right_bases = np.empty(m, dtype=np.intp)
+    if width:
+        widths = np.empty(m, dtype=np.float64)
+        width_heights = np.empty(m, dtype=np.float64)
+        left_ips = np.empty(m, dtype=np.float64)
+        right_ips = np.empty(m, dtype=np.float64)
+
+    if prominence:
+        with nogil:
+            k = 0
+            for p in range(m):
+                peak = peaks[p]
+
+                # Prominence and bases, as in `_peak_prominences`
+                i_min = 0
+                i_max = x.shape[0] - 1
+                if 2 <= wlen:
+                    i_min = max(peak - wlen // 2, i_min)
+                    i_max = min(peak + wlen // 2, i_max)
+
+                i = left_bases[k] = peak
+                left_min = x[peak]
+                while i_min <= i and x[i] <= x[peak]:
+                    if x[i] < left_min:
+                        left_min = x[i]
+                        left_bases[k] = i
+                    i -= 1
+
+                i = right_bases[k] = peak
+                right_min = x[peak]
+                while i <= i_max and x[i] <= x[peak]:
+                    if x[i] < right_min:
+                        right_min = x[i]
+                        right_bases[k] = i
+                    i += 1
+
+                prom = prominences[k] = x[peak] - max(left_min, right_min)
+                if prom == 0:
+                    prominence_warning = True
+                if not _in_bounds(prominence_min, prominence_max, peak, prom):
+                    continue
+
+                if width:
+                    # Width at the relative height, as in `_peak_widths`
+                    i_min = left_bases[k]
+                    i_max = right_bases[k]
+                    height = width_heights[k] = x[peak] - prom * rel_height
+
+                    i = peak
+                    while i_min < i and height < x[i]:
+                        i -= 1
+                    left_ip = <np.float64_t>i
+                    if x[i] < height:
+                        left_ip += (height - x[i]) / (x[i + 1] - x[i])
+
+                    i = peak
+                    while i < i_max and height < x[i]:
+                        i += 1
+                    right_ip = <np.float64_t>i
+                    if x[i] < height:
+                        right_ip -= (height - x[i]) / (x[i - 1] - x[i])
+
+                    widths[k] = right_ip - left_ip
+                    if widths[k] == 0:
+                        width_warning = True
+                    left_ips[k] = left_ip
+                    right_ips[k] = right_ip
+                    if not _in_bounds(width_min, width_max, peak, widths[k]):
+                        continue
+
+                peaks[k] = peak
+                left_edges[k] = left_edges[p]
+                right_edges[k] = right_edges[p]
+                left_thresholds[k] = left_thresholds[p]
+                right_thresholds[k] = right_thresholds[p]
+                k += 1
+            m = k
+
+    if prominence_warning:
+        warnings.warn("some peaks have a prominence of 0",
+                      PeakPropertyWarning, stacklevel=2)
+    if width_warning:
+        warnings.warn("some peaks have a width of 0",
+                      PeakPropertyWarning, stacklevel=2)
+
+    # Keep only valid part of array memory.
+    result = [peaks, left_edges, right_edges, left_thresholds,
+              right_thresholds]
+    if prominence:
+        result += [prominences, left_bases, right_bases]
+    if width:
+        result += [widths, width_heights, left_ips, right_ips]
+    result = [array.base for array in result]
+    for array in result:
+        array.resize(m, refcheck=False)
+    if not prominence:
+        result += [None] * 3
+    if not width:
+        result += [None] * 4
+    return tuple(result)
@@ -74,21 +74,41 @@ class _UpFIRDn(object):
         self._h_trans_flip = _pad_h(h, self._up)
         self._h_trans_flip = np.ascontiguousarray(self._h_trans_flip)
 
-    def apply_filter(self, x, axis=-1):
+    def apply_filter(self, x, axis=-1, workers=1):
         """Apply the prepared filter to the specified axis of a nD signal x"""
         output_len = _output_len(len(self._h_trans_flip), x.shape[axis],
                                  self._up, self._down)
         output_shape = np.asarray(x.shape)
         output_shape[axis] = output_len
-        out = np.zeros(output_shape, dtype=self._output_type, order='C')
+        out = np.empty(output_shape, dtype=self._output_type, order='C')
         axis = axis % x.ndim
         _apply(np.asarray(x, self._output_type),
                self._h_trans_flip, out,
-               self._up, self._down, axis)
+               self._up, self._down, axis, workers)
         return out
 
+    def apply_stream(self, x, zi, pos, axis=-1, workers=1):
+        """Continue filtering streams along the specified axis of x
+
+        `zi` holds the last ``len(h_trans_flip) // up - 1`` inputs of each
+        line, C contiguous with the axis last, and is updated in place.
+        `pos` is the upsampled position of the next output, from the start
+        of `x`. Returns the outputs up to the end of `x`, and the position
+        of the next one from the end of `x`.
+        """
+        len_up = x.shape[axis] * self._up
+        output_len = max(-(-(len_up - pos) // self._down), 0)
+        output_shape = np.asarray(x.shape)
+        output_shape[axis] = output_len
+        out = np.empty(output_shape, dtype=self._output_type, order='C')
+        axis = axis % x.ndim
+        _apply(np.asarray(x, self._output_type),
+               self._h_trans_flip, out,
+               self._up, self._down, axis, workers, zi, pos)
+        return out, pos + output_len * self._down - len_up
+
 
-def upfirdn(h, x, up=1, down=1, axis=-1):
+def upfirdn(h, x, up=1, down=1, axis=-1, workers=None):
     """Upsample, FIR filter, and downsample
 
     Parameters
@@ -105,6 +125,10 @@ def upfirdn(h, x, up=1, down=1, axis=-1):
         The axis of the input data array along which to apply the
         linear filter. The filter is applied to each subarray along
         this axis. Default is -1.
+    workers : int, optional
+        Number of threads to filter the subarrays along `axis` on. If
+        negative, the value wraps around from ``os.cpu_count()``. Default is
+        a single thread.
 
     Returns
     -------
@@ -124,7 +148,9 @@ def upfirdn(h, x, up=1, down=1, axis=-1):
     The direct approach of upsampling by factor of P with zero insertion,
     FIR filtering of length ``N``, and downsampling by factor of Q is
     O(N*Q) per output sample. The polyphase implementation used here is
-    O(N/P).
+    O(N/P). Each output is the dot product of one phase of the filter with
+    a contiguous stretch of the input, which is evaluated with independent
+    partial sums so that it can be vectorized.
 
     .. versionadded:: 0.18
 
@@ -177,7 +203,10 @@ def upfirdn(h, x, up=1, down=1, axis=-1):
            [ 6.,  7.]])
 
     """
+    # signaltools imports this module, so its helper is imported here
+    from .signaltools import _check_workers
+
     x = np.asarray(x)
     ufd = _UpFIRDn(h, x.dtype, up, down)
     # This is equivalent to (but faster than) using np.apply_along_axis
-    return ufd.apply_filter(x, axis)
+    return ufd.apply_filter(x, axis, _check_workers(workers))
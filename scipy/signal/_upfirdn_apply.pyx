@@ -40,6 +40,19 @@ cimport numpy as np
 import numpy as np
 from cython import bint  # boolean integer type
 from libc.stdlib cimport malloc, free
+from libc.string cimport memcpy, memset
+
+
+cdef extern from "sig_threads.h":
+    ctypedef struct sig_mutex:
+        pass
+    ctypedef void sig_thread_func(void *arg) nogil
+    void sig_mutex_init(sig_mutex *m) nogil
+    void sig_mutex_destroy(sig_mutex *m) nogil
+    void sig_mutex_lock(sig_mutex *m) nogil
+    void sig_mutex_unlock(sig_mutex *m) nogil
+    void sig_run_threads(int nthreads, sig_thread_func *func,
+                         void **args) nogil
 
 
 ctypedef double complex double_complex
@@ -47,17 +60,43 @@ ctypedef float complex float_complex
 
 ctypedef fused DTYPE_t:
     # Eventually we could add "object", too, but then we'd lose the "nogil"
-    # on the _apply_impl function.
+    # on the _filter_lines function.
     float
     float_complex
     double
     double_complex
 
+
+# The multiply-adds a thread must have to do before another is started
+DEF MIN_WORK_PER_THREAD = 1000000
+
 cdef struct ArrayInfo:
     np.intp_t * shape
     np.intp_t * strides
     np.intp_t ndim
 
+cdef struct ApplyTask:
+    # 0 to 3 for float, float_complex, double and double_complex
+    int typecode
+    char *data
+    char *output
+    char *h_trans_flip
+    # The last h_per_phase - 1 inputs of each line, or NULL for zeros
+    char *zi
+    ArrayInfo data_info
+    ArrayInfo output_info
+    np.intp_t axis
+    np.intp_t h_per_phase
+    np.intp_t up
+    np.intp_t down
+    # Upsampled position of the first output, from the start of the line
+    np.intp_t pos
+    # Zeros appended to each line
+    np.intp_t len_post
+    np.intp_t num_lines
+    np.intp_t *next_line
+    sig_mutex *mutex
+
 
 def _output_len(np.intp_t len_h,
                 np.intp_t in_len,
@@ -75,177 +114,193 @@ def _output_len(np.intp_t len_h,
 
 
 def _apply(np.ndarray data, DTYPE_t [::1] h_trans_flip, np.ndarray out,
-           np.intp_t up, np.intp_t down, np.intp_t axis):
-    cdef ArrayInfo data_info, output_info
-    cdef np.intp_t len_h = h_trans_flip.size
-    cdef DTYPE_t *data_ptr
-    cdef DTYPE_t *filter_ptr
-    cdef DTYPE_t *out_ptr
-    cdef int retval
-
-    data_info.ndim = data.ndim
-    data_info.strides = <np.intp_t *> data.strides
-    data_info.shape = <np.intp_t *> data.shape
-
-    output_info.ndim = out.ndim
-    output_info.strides = <np.intp_t *> out.strides
-    output_info.shape = <np.intp_t *> out.shape
-
-    data_ptr = <DTYPE_t*> data.data
-    filter_ptr = <DTYPE_t*> &h_trans_flip[0]
-    out_ptr = <DTYPE_t*> out.data
+           np.intp_t up, np.intp_t down, np.intp_t axis, int workers=1,
+           np.ndarray zi=None, np.intp_t pos=0):
+    """Filter the lines of `data` along `axis` into `out`.
+
+    Without `zi`, each line is padded with zeros on both sides, and `out`
+    holds the whole upfirdn output. With `zi`, a C contiguous array holding
+    the last ``h_per_phase - 1`` inputs of each line from the previous call,
+    the lines continue a stream: `out` holds the outputs from the upsampled
+    position `pos` of the line onwards, and `zi` is updated in place.
+    """
+    cdef ApplyTask run
+    cdef ApplyTask *tasks
+    cdef void **args
+    cdef sig_mutex mutex
+    cdef np.intp_t next_line = 0
+    cdef np.intp_t nthreads, work, i
+
+    if data.ndim != out.ndim:
+        raise ValueError("data and output arrays must have the same number "
+                         "of dimensions.")
+    if not 0 <= axis < data.ndim:
+        raise ValueError("axis = {} is out of range for {} dimensions."
+                         .format(axis, data.ndim))
+
+    if DTYPE_t is float:
+        run.typecode = 0
+    elif DTYPE_t is float_complex:
+        run.typecode = 1
+    elif DTYPE_t is double:
+        run.typecode = 2
+    else:
+        run.typecode = 3
+
+    run.data_info.ndim = data.ndim
+    run.data_info.strides = <np.intp_t *> data.strides
+    run.data_info.shape = <np.intp_t *> data.shape
+    run.output_info.ndim = out.ndim
+    run.output_info.strides = <np.intp_t *> out.strides
+    run.output_info.shape = <np.intp_t *> out.shape
+    run.data = data.data
+    run.output = out.data
+    run.h_trans_flip = <char *> &h_trans_flip[0]
+    run.axis = axis
+    run.h_per_phase = h_trans_flip.shape[0] // up
+    run.up = up
+    run.down = down
+    run.pos = pos
+    run.num_lines = 1
+    for i in range(out.ndim):
+        if i != axis:
+            run.num_lines *= out.shape[i]
+    if zi is None:
+        run.zi = NULL
+        run.len_post = run.h_per_phase - 1
+    else:
+        if (zi.size != run.num_lines * (run.h_per_phase - 1) or
+                not zi.flags.c_contiguous or zi.dtype != out.dtype):
+            raise ValueError("zi does not match the lines of data.")
+        run.zi = zi.data
+        run.len_post = 0
+    if run.num_lines == 0 or (zi is None and out.shape[axis] == 0):
+        return out
+    run.next_line = &next_line
+    run.mutex = &mutex
+
+    work = (run.num_lines * out.shape[axis] * run.h_per_phase //
+            MIN_WORK_PER_THREAD)
+    nthreads = max(min(workers, run.num_lines, work), 1)
+    tasks = <ApplyTask *> malloc(nthreads * sizeof(ApplyTask))
+    args = <void **> malloc(nthreads * sizeof(void *))
+    if not tasks or not args:
+        free(tasks)
+        free(args)
+        raise MemoryError()
+    for i in range(nthreads):
+        tasks[i] = run
+        args[i] = &tasks[i]
 
     with nogil:
-        retval = _apply_axis_inner(data_ptr, data_info,
-                                   filter_ptr, len_h,
-                                   out_ptr, output_info,
-                                   up, down, axis)
-    if retval == 1:
-        raise ValueError("failure in _apply_axis_inner: data and output arrays"
-                         " must have the same number of dimensions.")
-    elif retval == 2:
-        raise ValueError(
-            ("failure in _apply_axis_inner: axis = {}, ".format(axis) +
-             "but data_info.ndim is only {}.".format(data_info.ndim)))
-    elif retval == 3 or retval == 4:
+        sig_mutex_init(&mutex)
+        sig_run_threads(nthreads, _apply_task, args)
+        sig_mutex_destroy(&mutex)
+    free(args)
+    free(tasks)
+
+    if next_line < run.num_lines:
         raise MemoryError()
     return out
 
 
+cdef void _apply_task(void *arg) nogil:
+    cdef ApplyTask *task = <ApplyTask *> arg
+    if task.typecode == 0:
+        _filter_lines(task, <float *> task.h_trans_flip)
+    elif task.typecode == 1:
+        _filter_lines(task, <float_complex *> task.h_trans_flip)
+    elif task.typecode == 2:
+        _filter_lines(task, <double *> task.h_trans_flip)
+    else:
+        _filter_lines(task, <double_complex *> task.h_trans_flip)
+
+
 @cython.cdivision(True)
-cdef int _apply_axis_inner(DTYPE_t* data, ArrayInfo data_info,
-                           DTYPE_t* h_trans_flip, np.intp_t len_h,
-                           DTYPE_t* output, ArrayInfo output_info,
-                           np.intp_t up, np.intp_t down,
-                           np.intp_t axis) nogil:
-    cdef np.intp_t i
-    cdef np.intp_t num_loops = 1
-    cdef bint make_temp_data, make_temp_output
-    cdef DTYPE_t* temp_data = NULL
-    cdef DTYPE_t* temp_output = NULL
-
-    if data_info.ndim != output_info.ndim:
-        return 1
-    if axis >= data_info.ndim:
-        return 2
-
-    make_temp_data = data_info.strides[axis] != sizeof(DTYPE_t);
-    make_temp_output = output_info.strides[axis] != sizeof(DTYPE_t);
-    if make_temp_data:
-        temp_data = <DTYPE_t*>malloc(data_info.shape[axis] * sizeof(DTYPE_t))
-        if not temp_data:
-            free(temp_data)
-            return 3
-    if make_temp_output:
-        temp_output = <DTYPE_t*>malloc(output_info.shape[axis] * sizeof(DTYPE_t))
-        if not temp_output:
-            free(temp_data)
-            free(temp_output)
-            return 4
-
-    for i in range(output_info.ndim):
-        if i != axis:
-            num_loops *= output_info.shape[i]
-
-    cdef np.intp_t j
-    cdef np.intp_t data_offset
-    cdef np.intp_t output_offset
-    cdef DTYPE_t* data_row
-    cdef DTYPE_t* output_row
-    cdef np.intp_t reduced_idx
-    cdef np.intp_t j_rev
-    cdef np.intp_t axis_idx
-    cdef DTYPE_t* tmp_ptr = NULL
-    for i in range(num_loops):
-        data_offset = 0
-        output_offset = 0
-        # Calculate offset into linear buffer
-        reduced_idx = i
-        for j in range(output_info.ndim):
-            j_rev = output_info.ndim - 1 - j
-            if j_rev != axis:
-                axis_idx = reduced_idx % output_info.shape[j_rev]
-                reduced_idx /= output_info.shape[j_rev]
-                data_offset += (axis_idx * data_info.strides[j_rev])
-                output_offset += (axis_idx * output_info.strides[j_rev])
-
-        # Copy to temporary data if necessary
-        if make_temp_data:
-            for j in range(data_info.shape[axis]):
-                # Offsets are byte offsets, to need to cast to char and back
-                tmp_ptr = <DTYPE_t *>((<char *> data) + data_offset +
-                    j * data_info.strides[axis])
-                temp_data[j] = tmp_ptr[0]
-
-        # Select temporary or direct output and data
-        if make_temp_data:
-            data_row = temp_data
-        else:
-            data_row = <DTYPE_t *>((<char *>data) + data_offset)
-        if make_temp_output:
-            output_row = temp_output
-            for j in range(output_info.shape[axis]):
-                output_row[j] = 0.0  # initialize as zeros
+@cython.boundscheck(False)
+@cython.wraparound(False)
+cdef void _filter_lines(ApplyTask *task, DTYPE_t *h_trans_flip) nogil:
+    """Claim lines until none are left.
+
+    Each line is copied behind its h_per_phase - 1 previous inputs, and
+    followed by len_post zeros, so that every output is a plain dot product
+    of a phase of the filter with a contiguous stretch of the line.
+    """
+    cdef np.intp_t h_per_phase = task.h_per_phase
+    cdef np.intp_t len_x = task.data_info.shape[task.axis]
+    cdef np.intp_t len_out = task.output_info.shape[task.axis]
+    cdef np.intp_t stride_x = task.data_info.strides[task.axis]
+    cdef np.intp_t stride_out = task.output_info.strides[task.axis]
+    cdef np.intp_t len_ext = h_per_phase - 1 + len_x + task.len_post
+    cdef np.intp_t line, reduced_idx, axis_idx, j, j_rev, p
+    cdef char *data_row
+    cdef char *output_row
+    cdef DTYPE_t *zi_row
+    cdef DTYPE_t *ext
+
+    ext = <DTYPE_t *> malloc(len_ext * sizeof(DTYPE_t))
+    if not ext:
+        return
+
+    while True:
+        sig_mutex_lock(task.mutex)
+        line = task.next_line[0]
+        task.next_line[0] += 1
+        sig_mutex_unlock(task.mutex)
+        if line >= task.num_lines:
+            break
+
+        # Calculate offsets into the data and output
+        data_row = task.data
+        output_row = task.output
+        reduced_idx = line
+        for j in range(task.output_info.ndim):
+            j_rev = task.output_info.ndim - 1 - j
+            if j_rev != task.axis:
+                axis_idx = reduced_idx % task.output_info.shape[j_rev]
+                reduced_idx /= task.output_info.shape[j_rev]
+                data_row += axis_idx * task.data_info.strides[j_rev]
+                output_row += axis_idx * task.output_info.strides[j_rev]
+
+        if task.zi:
+            zi_row = <DTYPE_t *> task.zi + line * (h_per_phase - 1)
+            memcpy(ext, zi_row, (h_per_phase - 1) * sizeof(DTYPE_t))
         else:
-            output_row = <DTYPE_t *>((<char *>output) + output_offset)
-
-        # call 1D upfirdn
-        _apply_impl(data_row, data_info.shape[axis],
-                    h_trans_flip, len_h, output_row, up, down)
-
-        # Copy from temporary output if necessary
-        if make_temp_output:
-            for j in range(output_info.shape[axis]):
-                # Offsets are byte offsets, to need to cast to char and back
-                tmp_ptr = <DTYPE_t *>((<char *>output) + output_offset +
-                    j * output_info.strides[axis])
-                tmp_ptr[0] = output_row[j]
-
-    # cleanup
-    free(temp_data)
-    free(temp_output)
-    return 0
-
-
-@cython.cdivision(True)  # faster modulo
-@cython.boundscheck(False)  # designed to stay within bounds
-@cython.wraparound(False)  # we don't use negative indexing
-cdef void _apply_impl(DTYPE_t *x, np.intp_t len_x, DTYPE_t *h_trans_flip,
-                      np.intp_t len_h, DTYPE_t *out,
-                      np.intp_t up, np.intp_t down) nogil:
-    cdef np.intp_t h_per_phase = len_h / up
-    cdef np.intp_t padded_len = len_x + h_per_phase - 1
-    cdef np.intp_t x_idx = 0
-    cdef np.intp_t y_idx = 0
-    cdef np.intp_t h_idx = 0
-    cdef np.intp_t t = 0
-    cdef np.intp_t x_conv_idx = 0
-
-    while x_idx < len_x:
-        h_idx = t * h_per_phase
-        x_conv_idx = x_idx - h_per_phase + 1
-        if x_conv_idx < 0:
-            h_idx -= x_conv_idx
-            x_conv_idx = 0
-        for x_conv_idx in range(x_conv_idx, x_idx + 1):
-            out[y_idx] = out[y_idx] + x[x_conv_idx] * h_trans_flip[h_idx]
-            h_idx += 1
-        # store and increment
-        y_idx += 1
-        t += down
-        x_idx += t / up  # integer div
-        # which phase of the filter to use
-        t = t % up
-
-    # Use a second simplified loop to flush out the last bits
-    while x_idx < padded_len:
-        h_idx = t * h_per_phase
-        x_conv_idx = x_idx - h_per_phase + 1
-        for x_conv_idx in range(x_conv_idx, x_idx + 1):
-            if x_conv_idx < len_x and x_conv_idx >= 0:
-                out[y_idx] = out[y_idx] + x[x_conv_idx] * h_trans_flip[h_idx]
-            h_idx += 1
-        y_idx += 1
-        t += down
-        x_idx += t / up  # integer div
-        t = t % up
+            memset(ext, 0, (h_per_phase - 1) * sizeof(DTYPE_t))
+        for j in range(len_x):
+            ext[h_per_phase - 1 + j] = (<DTYPE_t *> (data_row +
+                                                     j * stride_x))[0]
+        memset(ext + h_per_phase - 1 + len_x, 0,
+               task.len_post * sizeof(DTYPE_t))
+
+        p = task.pos
+        for j in range(len_out):
+            (<DTYPE_t *> (output_row + j * stride_out))[0] = _dot(
+                ext + p // task.up,
+                h_trans_flip + (p % task.up) * h_per_phase, h_per_phase)
+            p += task.down
+
+        if task.zi:
+            memcpy(zi_row, ext + len_ext - (h_per_phase - 1),
+                   (h_per_phase - 1) * sizeof(DTYPE_t))
+
+    free(ext)
+
+
+@cython.boundscheck(False)
+@cython.wraparound(False)
+cdef inline DTYPE_t _dot(DTYPE_t *x, DTYPE_t *h, np.intp_t n) nogil:
+    # Four independent sums, so that the multiply-adds can be pipelined
+    # and vectorized
+    cdef DTYPE_t s0 = 0, s1 = 0, s2 = 0, s3 = 0
+    cdef np.intp_t k = 0
+    while k + 4 <= n:
+        s0 = s0 + x[k] * h[k]
+        s1 = s1 + x[k + 1] * h[k + 1]
+        s2 = s2 + x[k + 2] * h[k + 2]
+        s3 = s3 + x[k + 3] * h[k + 3]
+        k += 4
+    while k < n:
+        s0 = s0 + x[k] * h[k]
+        k += 1
+    return (s0 + s1) + (s2 + s3)
@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include "sig_threads.h"
 
 void compute_root_from_lambda(double, double *, double *);
 
@@ -24,3 +25,208 @@ compute_root_from_lambda(lambda, r, omega)
 	* sqrt((48*lambda + 24*lambda*tmp))/tmp2;
     return;
 }
+
+
+/*
+ * Threaded row and column passes of a separable recursive filter over a
+ * stack of images, shared by the S_ and D_ spline routines.
+ *
+ * Each row of an image goes through `line` into a temporary image, and each
+ * column of that through `line` into the coefficients. `line` filters N
+ * samples of x (stride stridex) into y (stride stridey), with work holding
+ * room for at least N samples, and returns 0 or a negative error code.
+ * Strides are in elements: strides and cstrides hold the image, row and
+ * column strides of the input and of the coefficients.
+ */
+typedef int spline_line_func(const void *plan, char *x, char *y, int N,
+                             npy_intp stridex, npy_intp stridey, char *work);
+
+int spline2D_stack(spline_line_func *, const void *, int, char *, char *,
+                   npy_intp, int, int, npy_intp *, npy_intp *, int);
+
+/* Samples per thread below which more threads do not pay off */
+#define SPLINE_MIN_WORK_PER_THREAD 65536
+/* Rows or columns claimed at a time */
+#define SPLINE_LINES_PER_CLAIM 16
+
+typedef struct {
+    spline_line_func *line;
+    const void *plan;
+    int elsize, M, N;
+    char *image, *coeffs, *tmp;
+    npy_intp *strides, *cstrides;
+    int pass;           /* 0: whole images, 1: rows, 2: columns */
+    npy_intp image_index, total, *next;
+    int *status;
+    sig_mutex *mutex;
+} SplineTask;
+
+static int
+spline_rows(SplineTask *t, npy_intp i, int m0, int m1, char *tmp, char *work)
+{
+    char *in = t->image + i * t->strides[0] * t->elsize;
+    int m, ret;
+
+    for (m = m0; m < m1; m++) {
+        ret = t->line(t->plan, in + m * t->strides[1] * t->elsize,
+                      tmp + (npy_intp)m * t->N * t->elsize, t->N,
+                      t->strides[2], 1, work);
+        if (ret < 0) return ret;
+    }
+    return 0;
+}
+
+static int
+spline_columns(SplineTask *t, npy_intp i, int n0, int n1, char *tmp,
+               char *work)
+{
+    char *out = t->coeffs + i * t->cstrides[0] * t->elsize;
+    int n, ret;
+
+    for (n = n0; n < n1; n++) {
+        ret = t->line(t->plan, tmp + (npy_intp)n * t->elsize,
+                      out + n * t->cstrides[2] * t->elsize, t->M, t->N,
+                      t->cstrides[1], work);
+        if (ret < 0) return ret;
+    }
+    return 0;
+}
+
+/*
+ * Claim images, rows or columns until none are left or a line has failed.
+ * The scratch buffers are allocated once per thread; if that fails, nothing
+ * is claimed and the work is left to the other threads.
+ */
+static void
+spline2D_task(void *arg)
+{
+    SplineTask *t = (SplineTask *)arg;
+    int L = t->M > t->N ? t->M : t->N;
+    npy_intp lo, hi, chunk = t->pass == 0 ? 1 : SPLINE_LINES_PER_CLAIM;
+    char *work, *tmp = t->tmp;
+    int ret = 0;
+
+    work = malloc((size_t)L * t->elsize);
+    if (t->pass == 0) {
+        tmp = malloc((size_t)t->M * t->N * t->elsize);
+    }
+    if (work == NULL || tmp == NULL) goto done;
+
+    while (ret == 0) {
+        sig_mutex_lock(t->mutex);
+        lo = *t->status ? t->total : *t->next;
+        *t->next = lo + chunk;
+        sig_mutex_unlock(t->mutex);
+        if (lo >= t->total) break;
+        hi = lo + chunk < t->total ? lo + chunk : t->total;
+
+        switch (t->pass) {
+        case 0:
+            ret = spline_rows(t, lo, 0, t->M, tmp, work);
+            if (ret == 0) ret = spline_columns(t, lo, 0, t->N, tmp, work);
+            break;
+        case 1:
+            ret = spline_rows(t, t->image_index, (int)lo, (int)hi, tmp, work);
+            break;
+        default:
+            ret = spline_columns(t, t->image_index, (int)lo, (int)hi, tmp,
+                                 work);
+            break;
+        }
+        if (ret < 0) {
+            sig_mutex_lock(t->mutex);
+            if (*t->status == 0) *t->status = ret;
+            sig_mutex_unlock(t->mutex);
+        }
+    }
+
+ done:
+    free(work);
+    if (t->pass == 0) free(tmp);
+}
+
+/* Run one pass on nthreads threads; returns -1 if any work was dropped. */
+static int
+spline2D_pass(SplineTask *run, int pass, npy_intp total, int nthreads)
+{
+    SplineTask *tasks;
+    void **args;
+    sig_mutex mutex;
+    npy_intp next = 0;
+    int status = 0, k;
+
+    if (nthreads > total) nthreads = (int)total;
+    tasks = malloc(nthreads * sizeof(SplineTask));
+    args = malloc(nthreads * sizeof(void *));
+    if (tasks == NULL || args == NULL) {
+        free(tasks);
+        free(args);
+        return -1;
+    }
+    run->pass = pass;
+    run->total = total;
+    run->next = &next;
+    run->status = &status;
+    run->mutex = &mutex;
+    sig_mutex_init(&mutex);
+    for (k = 0; k < nthreads; k++) {
+        tasks[k] = *run;
+        args[k] = tasks + k;
+    }
+    sig_run_threads(nthreads, spline2D_task, args);
+    sig_mutex_destroy(&mutex);
+    free(args);
+    free(tasks);
+
+    if (status < 0) return status;
+    return next < total ? -1 : 0;
+}
+
+/*
+ * Filter the rows and columns of nimages M x N images on up to `workers`
+ * threads. With at least as many images as threads every thread takes
+ * whole images; otherwise the rows and then the columns of each image are
+ * split between the threads. Returns 0, -1 if out of memory, or the error
+ * code of `line`.
+ */
+int
+spline2D_stack(spline_line_func *line, const void *plan, int elsize,
+               char *image, char *coeffs, npy_intp nimages, int M, int N,
+               npy_intp *strides, npy_intp *cstrides, int workers)
+{
+    SplineTask run;
+    npy_intp work, i;
+    int nthreads, ret = 0;
+
+    if (nimages == 0 || M == 0 || N == 0) return 0;
+
+    work = nimages * M * N / SPLINE_MIN_WORK_PER_THREAD;
+    nthreads = workers > 1 ? workers : 1;
+    if (nthreads > work) nthreads = work > 1 ? (int)work : 1;
+
+    run.line = line;
+    run.plan = plan;
+    run.elsize = elsize;
+    run.M = M;
+    run.N = N;
+    run.image = image;
+    run.coeffs = coeffs;
+    run.tmp = NULL;
+    run.image_index = 0;
+    run.strides = strides;
+    run.cstrides = cstrides;
+
+    if (nimages >= nthreads) {
+        return spline2D_pass(&run, 0, nimages, nthreads);
+    }
+
+    run.tmp = malloc((size_t)M * N * elsize);
+    if (run.tmp == NULL) return -1;
+    for (i = 0; i < nimages && ret == 0; i++) {
+        run.image_index = i;
+        ret = spline2D_pass(&run, 1, M, nthreads);
+        if (ret == 0) ret = spline2D_pass(&run, 2, N, nthreads);
+    }
+    free(run.tmp);
+    return ret;
+}
@@ -16,7 +16,8 @@ from scipy._lib.six import string_types
 from . import sigtools
 
 __all__ = ['kaiser_beta', 'kaiser_atten', 'kaiserord',
-           'firwin', 'firwin2', 'remez', 'firls', 'minimum_phase']
+           'firwin', 'firwin2', 'remez', 'remez_batch', 'firls',
+           'minimum_phase']
 
 
 def _get_fs(fs, nyq):
@@ -672,7 +673,7 @@ def firwin2(numtaps, freq, gain, nfreqs=None, window='hamming', nyq=None,
 
 
 def remez(numtaps, bands, desired, weight=None, Hz=None, type='bandpass',
-          maxiter=25, grid_density=16, fs=None):
+          maxiter=25, grid_density=16, fs=None, workers=None):
     """
     Calculate the minimax optimal filter using the Remez exchange algorithm.
 
@@ -717,6 +718,13 @@ def remez(numtaps, bands, desired, weight=None, Hz=None, type='bandpass',
         ``(numtaps + 1) * grid_density``. Default is 16.
     fs : float, optional
         The sampling frequency of the signal.  Default is 1.
+    workers : int, optional
+        Number of threads to evaluate the error on the dense grid with.
+        Only large designs are shared between threads. If negative, the
+        value wraps around from ``os.cpu_count()``. Default is a single
+        thread.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -726,6 +734,7 @@ def remez(numtaps, bands, desired, weight=None, Hz=None, type='bandpass',
 
     See Also
     --------
+    remez_batch
     firls
     firwin
     firwin2
@@ -820,6 +829,15 @@ def remez(numtaps, bands, desired, weight=None, Hz=None, type='bandpass',
     >>> plt.show()
 
     """
+    from .signaltools import _check_workers
+    return sigtools._remez(*(_remez_args(numtaps, bands, desired, weight, Hz,
+                                         type, maxiter, grid_density, fs) +
+                             (_check_workers(workers),)))
+
+
+def _remez_args(numtaps, bands, desired, weight=None, Hz=None,
+                type='bandpass', maxiter=25, grid_density=16, fs=None):
+    """The arguments of `remez`, as `sigtools._remez` takes them."""
     if Hz is None and fs is None:
         fs = 1.0
     elif Hz is not None:
@@ -839,8 +857,52 @@ def remez(numtaps, bands, desired, weight=None, Hz=None, type='bandpass',
         weight = [1] * len(desired)
 
     bands = np.asarray(bands).copy()
-    return sigtools._remez(numtaps, bands, desired, weight, tnum, fs,
-                           maxiter, grid_density)
+    return (numtaps, bands, desired, weight, tnum, fs, maxiter, grid_density)
+
+
+def remez_batch(specs, workers=None):
+    """
+    Design several minimax optimal filters with the Remez exchange algorithm.
+
+    Parameters
+    ----------
+    specs : iterable of dict
+        The keyword arguments of `remez` for each filter, e.g.
+        ``dict(numtaps=101, bands=[0, 0.2, 0.25, 0.5], desired=[1, 0])``.
+    workers : int, optional
+        Number of threads to share the designs between. If negative, the
+        value wraps around from ``os.cpu_count()``. Default is a single
+        thread.
+
+    Returns
+    -------
+    out : list of ndarray
+        The coefficients of each filter, in the order of `specs`.  They are
+        the same as those `remez` returns for each specification.
+
+    See Also
+    --------
+    remez
+
+    Notes
+    -----
+    .. versionadded:: 1.4.0
+
+    Examples
+    --------
+    A bank of lowpass filters with different cutoffs:
+
+    >>> from scipy import signal
+    >>> specs = [dict(numtaps=201, bands=[0, fc, fc + 0.02, 0.5],
+    ...               desired=[1, 0]) for fc in (0.05, 0.1, 0.2, 0.3)]
+    >>> taps = signal.remez_batch(specs, workers=-1)
+    >>> len(taps), taps[0].shape
+    (4, (201,))
+
+    """
+    from .signaltools import _check_workers
+    args = [_remez_args(**spec) for spec in specs]
+    return sigtools._remez_batch(args, _check_workers(workers))
 
 
 def firls(numtaps, bands, desired, weight=None, nyq=None, fs=None):
@@ -4,124 +4,340 @@
 #include "Python.h"
 #define NO_IMPORT_ARRAY
 #include "numpy/ndarrayobject.h"
+#include "sig_threads.h"
 
 
 /* defined below */
-void f_medfilt2(float*,float*,npy_intp*,npy_intp*);
-void d_medfilt2(double*,double*,npy_intp*,npy_intp*);
-void b_medfilt2(unsigned char*,unsigned char*,npy_intp*,npy_intp*);
-extern char *check_malloc (int);
+int f_medfilt2(float*,float*,npy_intp*,npy_intp*,int);
+int d_medfilt2(double*,double*,npy_intp*,npy_intp*,int);
+int b_medfilt2(unsigned char*,unsigned char*,npy_intp*,npy_intp*,int);
 
+/* The window values a thread must insert before another is started: */
+#define MEDFILT_MIN_WORK_PER_THREAD 1000000
 
-/* The QUICK_SELECT routine is based on Hoare's Quickselect algorithm,
- * with unrolled recursion. 
- * Author: Thouis R. Jones, 2008 
+
+/* The MEDIATOR routines keep the median of a sliding window, after the
+ * "mediator" of Andrew Ashelly, 2011: the last N values of a stream are
+ * kept in a circular buffer, and indexed by a max-heap of the values below
+ * the median and a min-heap of the values above it, which meet at the
+ * median. Replacing the oldest value with a new one takes O(log N)
+ * exchanges, instead of the O(N) of selecting the median from scratch.
  */
 
-#define ELEM_SWAP(t, a, x, y) {register t temp = (a)[x]; (a)[x] = (a)[y]; (a)[y] = temp;}
-#define FIRST_LOWEST(x, y, z) (((x) < (y)) && ((x) < (z)))
-#define FIRST_HIGHEST(x, y, z) (((x) > (y)) && ((x) > (z)))
-#define LOWEST_IDX(a, x, y) (((a)[x] < (a)[y]) ? (x) : (y))
-#define HIGHEST_IDX(a, x, y) (((a)[x] > (a)[y]) ? (x) : (y))
+typedef struct {
+    void *data;      /* the window, as a circular buffer */
+    npy_intp *pos;   /* the heap slot of each window value */
+    npy_intp *heap;  /* the window value of each heap slot: the max-heap is
+                        at slots -1 to -maxct, the min-heap at slots 1 to
+                        minct, and the median at slot 0 */
+    npy_intp *slots;
+    npy_intp n, idx, minct, maxct;
+} Mediator;
+
+static int mediator_init(Mediator *m, npy_intp n, size_t itemsize)
+{
+    npy_intp i;
 
-/* if (l is index of lowest) {return lower of mid,hi} else if (l is index of highest) {return higher of mid,hi} else return l */
-#define MEDIAN_IDX(a, l, m, h) (FIRST_LOWEST((a)[l], (a)[m], (a)[h]) ? LOWEST_IDX(a, m, h) : (FIRST_HIGHEST((a)[l], (a)[m], (a)[h]) ? HIGHEST_IDX(a, m, h) : (l)))
+    m->n = n;
+    m->idx = 0;
+    /* the lower of the middle values for even n, as in quick select */
+    m->maxct = (n - 1) / 2;
+    m->minct = n / 2;
+    m->data = calloc(n, itemsize);
+    m->pos = malloc(n * sizeof(npy_intp));
+    m->slots = malloc(n * sizeof(npy_intp));
+    if (m->data == NULL || m->pos == NULL || m->slots == NULL) {
+        free(m->data);
+        free(m->pos);
+        free(m->slots);
+        return -1;
+    }
+    m->heap = m->slots + m->maxct;
+    for (i = 0; i < n; i++) {
+        m->pos[i] = i - m->maxct;
+        m->heap[i - m->maxct] = i;
+    }
+    return 0;
+}
 
-#define QUICK_SELECT(NAME, TYPE)                                        \
-TYPE NAME(TYPE arr[], int n)                                            \
+static void mediator_free(Mediator *m)
+{
+    free(m->data);
+    free(m->pos);
+    free(m->slots);
+}
+
+#define MEDIATOR(NAME, TYPE)                                            \
+static int NAME##_cmpexch(Mediator *m, npy_intp i, npy_intp j)          \
 {                                                                       \
-    int lo, hi, mid, md;                                                \
-    int median_idx;                                                     \
-    int ll, hh;                                                         \
-    TYPE piv;                                                           \
+    TYPE *data = (TYPE *)m->data;                                       \
+    npy_intp t = m->heap[i];                                            \
                                                                         \
-    lo = 0; hi = n-1;                                                   \
-    median_idx = (n - 1) / 2; /* lower of middle values for even-length arrays */ \
+    if (!(data[t] < data[m->heap[j]])) return 0;                        \
+    m->heap[i] = m->heap[j];                                            \
+    m->heap[j] = t;                                                     \
+    m->pos[m->heap[i]] = i;                                             \
+    m->pos[t] = j;                                                      \
+    return 1;                                                           \
+}                                                                       \
                                                                         \
-    while (1) {                                                         \
-        if ((hi - lo) < 2) {                                            \
-            if (arr[hi] < arr[lo]) ELEM_SWAP(TYPE, arr, lo, hi);        \
-            return arr[median_idx];                                     \
-        }                                                               \
+/* sift down the min-heap from slot i, a child of the slot to fix */    \
+static void NAME##_min_down(Mediator *m, npy_intp i)                    \
+{                                                                       \
+    TYPE *data = (TYPE *)m->data;                                       \
                                                                         \
-        mid = (hi + lo) / 2;                                            \
-        /* put the median of lo,mid,hi at position lo - this will be the pivot */ \
-        md = MEDIAN_IDX(arr, lo, mid, hi);                              \
-        ELEM_SWAP(TYPE, arr, lo, md);                                   \
+    for (; i <= m->minct; i *= 2) {                                     \
+        if (i > 1 && i < m->minct &&                                    \
+                data[m->heap[i+1]] < data[m->heap[i]]) ++i;             \
+        if (!NAME##_cmpexch(m, i, i / 2)) break;                        \
+    }                                                                   \
+}                                                                       \
                                                                         \
-        /* Nibble from each end towards middle, swapping misordered items */ \
-        piv = arr[lo];                                                  \
-        for (ll = lo+1, hh = hi;; ll++, hh--) {                         \
-	    while (arr[ll] < piv) ll++;					\
-	    while (arr[hh] > piv) hh--;					\
-	    if (hh < ll) break;						\
-	    ELEM_SWAP(TYPE, arr, ll, hh);				\
-        }                                                               \
-        /* move pivot to top of lower partition */                      \
-        ELEM_SWAP(TYPE, arr, hh, lo);                                   \
-        /* set lo, hi for new range to search */                        \
-        if (hh < median_idx) /* search upper partition */               \
-            lo = hh+1;                                                  \
-        else if (hh > median_idx) /* search lower partition */          \
-            hi = hh-1;                                                  \
-        else                                                            \
-            return piv;                                                 \
+/* sift down the max-heap from slot i, a child of the slot to fix */    \
+static void NAME##_max_down(Mediator *m, npy_intp i)                    \
+{                                                                       \
+    TYPE *data = (TYPE *)m->data;                                       \
+                                                                        \
+    for (; i >= -m->maxct; i *= 2) {                                    \
+        if (i < -1 && i > -m->maxct &&                                  \
+                data[m->heap[i]] < data[m->heap[i-1]]) --i;             \
+        if (!NAME##_cmpexch(m, i / 2, i)) break;                        \
+    }                                                                   \
+}                                                                       \
+                                                                        \
+/* sift up from slot i, returning whether the value reached the median */ \
+static int NAME##_min_up(Mediator *m, npy_intp i)                       \
+{                                                                       \
+    while (i > 0 && NAME##_cmpexch(m, i, i / 2)) i /= 2;                \
+    return i == 0;                                                      \
+}                                                                       \
+                                                                        \
+static int NAME##_max_up(Mediator *m, npy_intp i)                       \
+{                                                                       \
+    while (i < 0 && NAME##_cmpexch(m, i / 2, i)) i /= 2;                \
+    return i == 0;                                                      \
+}                                                                       \
+                                                                        \
+/* replace the oldest value of the window with v */                     \
+static void NAME##_insert(Mediator *m, TYPE v)                          \
+{                                                                       \
+    TYPE *data = (TYPE *)m->data;                                       \
+    npy_intp p = m->pos[m->idx];                                        \
+    TYPE old = data[m->idx];                                            \
+                                                                        \
+    data[m->idx] = v;                                                   \
+    if (++m->idx == m->n) m->idx = 0;                                   \
+    if (p > 0) {                                                        \
+        if (old < v) NAME##_min_down(m, p * 2);                         \
+        else if (NAME##_min_up(m, p)) NAME##_max_down(m, -1);           \
+    }                                                                   \
+    else if (p < 0) {                                                   \
+        if (v < old) NAME##_max_down(m, p * 2);                         \
+        else if (NAME##_max_up(m, p)) NAME##_min_down(m, 1);            \
+    }                                                                   \
+    else {                                                              \
+        if (m->maxct) NAME##_max_down(m, -1);                           \
+        if (m->minct) NAME##_min_down(m, 1);                            \
     }                                                                   \
 }
 
 
-/* 2-D median filter with zero-padding on edges. */
-#define MEDIAN_FILTER_2D(NAME, TYPE, SELECT)                            \
-void NAME(TYPE* in, TYPE* out, npy_intp* Nwin, npy_intp* Ns)                    \
+/* 2-D median filter with zero-padding on edges, one row of the output at a
+ * time. The window slides along the row a column at a time, the values of
+ * the new column replacing those of the oldest one in the mediator.
+ */
+#define MEDIAN_FILTER_ROW(NAME, TYPE, MED)                              \
+static void NAME(const TYPE* in, TYPE* out, npy_intp ny,                \
+                 const npy_intp* Nwin, const npy_intp* Ns, Mediator *m) \
 {                                                                       \
-    int nx, ny, hN[2];                                                  \
-    int pre_x, pre_y, pos_x, pos_y;                                     \
-    int subx, suby, k, totN;                                            \
-    TYPE *myvals, *fptr1, *fptr2, *ptr1, *ptr2;                         \
-                                                                        \
-    totN = Nwin[0] * Nwin[1];                                           \
-    myvals = (TYPE *) check_malloc( totN * sizeof(TYPE));               \
-                                                                        \
-    hN[0] = Nwin[0] >> 1;                                               \
-    hN[1] = Nwin[1] >> 1;                                               \
-    ptr1 = in;                                                          \
-    fptr1 = out;                                                        \
-    for (ny = 0; ny < Ns[0]; ny++)                                      \
-        for (nx = 0; nx < Ns[1]; nx++) {                                \
-            pre_x = hN[1];                                              \
-            pre_y = hN[0];                                              \
-            pos_x = hN[1];                                              \
-            pos_y = hN[0];                                              \
-            if (nx < hN[1]) pre_x = nx;                                 \
-            if (nx >= Ns[1] - hN[1]) pos_x = Ns[1] - nx - 1;            \
-            if (ny < hN[0]) pre_y = ny;                                 \
-            if (ny >= Ns[0] - hN[0]) pos_y = Ns[0] - ny - 1;            \
-            fptr2 = myvals;                                             \
-            ptr2 = ptr1 - pre_x - pre_y*Ns[1];                          \
-            for (suby = -pre_y; suby <= pos_y; suby++) {                \
-                for (subx = -pre_x; subx <= pos_x; subx++)              \
-                    *fptr2++ = *ptr2++;                                 \
-                ptr2 += Ns[1] - (pre_x + pos_x + 1);                    \
-            }                                                           \
-            ptr1++;                                                     \
+    npy_intp nx, c, r, r0, r1;                                          \
+    npy_intp hx = Nwin[1] >> 1, hy = Nwin[0] >> 1;                      \
+    TYPE *data = (TYPE *)m->data;                                       \
                                                                         \
-            /* Zero pad */                                              \
-            for (k = (pre_x + pos_x + 1)*(pre_y + pos_y + 1); k < totN; k++) \
-                *fptr2++ = 0.0;                                         \
+    /* the window starts out on the zero padding */                     \
+    for (c = 0; c < m->n; c++) data[c] = 0;                             \
+    m->idx = 0;                                                         \
                                                                         \
-            /*      *fptr1++ = median(myvals,totN); */                  \
-            *fptr1++ = SELECT(myvals,totN);                             \
+    r0 = ny - hy;                                                       \
+    r1 = r0 + Nwin[0];                                                  \
+    for (c = -hx; c < Ns[1] - hx + Nwin[1] - 1; c++) {                  \
+        for (r = r0; r < r1; r++) {                                     \
+            MED##_insert(m, (r < 0 || r >= Ns[0] || c < 0 || c >= Ns[1]) \
+                            ? (TYPE)0 : in[r*Ns[1] + c]);               \
         }                                                               \
-    free(myvals);                                                       \
+        nx = c - Nwin[1] + 1 + hx;                                      \
+        if (nx >= 0) out[ny*Ns[1] + nx] = data[m->heap[0]];             \
+    }                                                                   \
+}
+
+
+MEDIATOR(f_mediator, float)
+MEDIATOR(d_mediator, double)
+
+MEDIAN_FILTER_ROW(f_medfilt_row, float, f_mediator)
+MEDIAN_FILTER_ROW(d_medfilt_row, double, d_mediator)
+
+
+/* For unsigned characters, the window is kept as a histogram instead, after
+ * Huang, Yang and Tang, 1979. The median bin moves from where it was for the
+ * previous window, counting the values below it.
+ */
+static void b_medfilt_row(const unsigned char* in, unsigned char* out,
+                          npy_intp ny, const npy_intp* Nwin,
+                          const npy_intp* Ns, npy_intp *hist)
+{
+    npy_intp nx, c, r, r0, r1, med, lt, rank;
+    npy_intp hx = Nwin[1] >> 1, hy = Nwin[0] >> 1;
+    unsigned char vin, vout;
+
+    /* the window starts out on the zero padding */
+    memset(hist, 0, 256 * sizeof(npy_intp));
+    hist[0] = Nwin[0] * Nwin[1];
+    rank = (hist[0] - 1) / 2;
+    med = 0;
+    lt = 0;
+
+    r0 = ny - hy;
+    r1 = r0 + Nwin[0];
+    for (c = -hx; c < Ns[1] - hx + Nwin[1] - 1; c++) {
+        for (r = r0; r < r1; r++) {
+            int inside = r >= 0 && r < Ns[0];
+
+            vin = (inside && c >= 0 && c < Ns[1]) ? in[r*Ns[1] + c] : 0;
+            vout = (inside && c - Nwin[1] >= 0 && c - Nwin[1] < Ns[1])
+                   ? in[r*Ns[1] + c - Nwin[1]] : 0;
+            if (vin == vout) continue;
+            hist[vin]++;
+            hist[vout]--;
+            lt += (vin < med) - (vout < med);
+        }
+        nx = c - Nwin[1] + 1 + hx;
+        if (nx < 0) continue;
+        while (lt > rank) lt -= hist[--med];
+        while (lt + hist[med] <= rank) lt += hist[med++];
+        out[ny*Ns[1] + nx] = (unsigned char)med;
+    }
 }
 
 
-/* define quick_select for floats, doubles, and unsigned characters */
-QUICK_SELECT(f_quick_select, float)
-QUICK_SELECT(d_quick_select, double)
-QUICK_SELECT(b_quick_select, unsigned char)
+typedef struct {
+    int typenum;
+    const char *in;
+    char *out;
+    npy_intp Nwin[2], Ns[2];
+    npy_intp *next_row;
+    sig_mutex *mutex;
+} MedianFilterTask;
+
+/*
+ * Claim rows of the output until none are left. If the window cannot be
+ * allocated, no rows are claimed, and the others are left to the other
+ * threads.
+ */
+static void medfilt2_task(void *arg)
+{
+    MedianFilterTask *task = (MedianFilterTask *)arg;
+    Mediator m;
+    npy_intp *hist = NULL, row;
+
+    if (task->typenum == NPY_UBYTE) {
+        hist = malloc(256 * sizeof(npy_intp));
+        if (hist == NULL) return;
+    }
+    else if (mediator_init(&m, task->Nwin[0] * task->Nwin[1],
+                           task->typenum == NPY_FLOAT ? sizeof(float)
+                                                      : sizeof(double))) {
+        return;
+    }
+
+    for (;;) {
+        sig_mutex_lock(task->mutex);
+        row = (*task->next_row)++;
+        sig_mutex_unlock(task->mutex);
+        if (row >= task->Ns[0]) break;
+
+        switch (task->typenum) {
+        case NPY_UBYTE:
+            b_medfilt_row((const unsigned char *)task->in,
+                          (unsigned char *)task->out, row, task->Nwin,
+                          task->Ns, hist);
+            break;
+        case NPY_FLOAT:
+            f_medfilt_row((const float *)task->in, (float *)task->out, row,
+                          task->Nwin, task->Ns, &m);
+            break;
+        default:
+            d_medfilt_row((const double *)task->in, (double *)task->out, row,
+                          task->Nwin, task->Ns, &m);
+            break;
+        }
+    }
+
+    if (hist != NULL) free(hist);
+    else mediator_free(&m);
+}
+
+/* Filter the rows on up to `workers` threads; returns -1 if out of memory. */
+static int medfilt2(int typenum, const char* in, char* out, npy_intp* Nwin,
+                    npy_intp* Ns, int workers)
+{
+    MedianFilterTask run, *tasks;
+    void **args;
+    sig_mutex mutex;
+    npy_intp next_row = 0, nthreads, work, k;
+
+    run.typenum = typenum;
+    run.in = in;
+    run.out = out;
+    run.Nwin[0] = Nwin[0];
+    run.Nwin[1] = Nwin[1];
+    run.Ns[0] = Ns[0];
+    run.Ns[1] = Ns[1];
+    run.next_row = &next_row;
+    run.mutex = &mutex;
+    if (Ns[0] == 0 || Ns[1] == 0) return 0;
+
+    work = Ns[0] * (Ns[1] + Nwin[1]) * Nwin[0] / MEDFILT_MIN_WORK_PER_THREAD;
+    nthreads = workers > 1 ? workers : 1;
+    if (nthreads > Ns[0]) nthreads = Ns[0];
+    if (nthreads > work) nthreads = work > 1 ? work : 1;
+
+    tasks = malloc(nthreads * sizeof(MedianFilterTask));
+    args = malloc(nthreads * sizeof(void *));
+    if (tasks == NULL || args == NULL) {
+        free(tasks);
+        free(args);
+        return -1;
+    }
+    sig_mutex_init(&mutex);
+    for (k = 0; k < nthreads; k++) {
+        tasks[k] = run;
+        args[k] = tasks + k;
+    }
+    sig_run_threads((int)nthreads, medfilt2_task, args);
+    sig_mutex_destroy(&mutex);
+    free(args);
+    free(tasks);
+
+    return next_row < Ns[0] ? -1 : 0;
+}
+
 
 /* define medfilt for floats, doubles, and unsigned characters */
-MEDIAN_FILTER_2D(f_medfilt2, float, f_quick_select)
-MEDIAN_FILTER_2D(d_medfilt2, double, d_quick_select)
-MEDIAN_FILTER_2D(b_medfilt2, unsigned char, b_quick_select)
+int f_medfilt2(float* in, float* out, npy_intp* Nwin, npy_intp* Ns,
+               int workers)
+{
+    return medfilt2(NPY_FLOAT, (char *)in, (char *)out, Nwin, Ns, workers);
+}
+
+int d_medfilt2(double* in, double* out, npy_intp* Nwin, npy_intp* Ns,
+               int workers)
+{
+    return medfilt2(NPY_DOUBLE, (char *)in, (char *)out, Nwin, Ns, workers);
+}
+
+int b_medfilt2(unsigned char* in, unsigned char* out, npy_intp* Nwin,
+               npy_intp* Ns, int workers)
+{
+    return medfilt2(NPY_UBYTE, (char *)in, (char *)out, Nwin, Ns, workers);
+}
@@ -16,7 +16,7 @@ def configuration(parent_package='', top_path=None):
                          sources=['sigtoolsmodule.c', 'firfilter.c',
                                   'medianfilter.c', 'lfilter.c.src',
                                   'correlate_nd.c.src'],
-                         depends=['sigtools.h'],
+                         depends=['sigtools.h', 'sig_threads.h'],
                          include_dirs=['.'],
                          **numpy_nodepr_api)
 
@@ -24,10 +24,13 @@ def configuration(parent_package='', top_path=None):
     config.add_extension('_max_len_seq_inner', sources=['_max_len_seq_inner.c'])
     config.add_extension('_peak_finding_utils',
                          sources=['_peak_finding_utils.c'])
-    config.add_extension('_upfirdn_apply', sources=['_upfirdn_apply.c'])
+    config.add_extension('_upfirdn_apply', sources=['_upfirdn_apply.c'],
+                         depends=['sig_threads.h'], include_dirs=['.'])
     spline_src = ['splinemodule.c', 'S_bspline_util.c', 'D_bspline_util.c',
                   'C_bspline_util.c', 'Z_bspline_util.c', 'bspline_util.c']
-    config.add_extension('spline', sources=spline_src, **numpy_nodepr_api)
+    config.add_extension('spline', sources=spline_src,
+                         depends=['sig_threads.h'], include_dirs=['.'],
+                         **numpy_nodepr_api)
 
     return config
 
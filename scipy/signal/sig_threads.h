@@ -0,0 +1,118 @@
+/*
+ * Minimal portable threads for the sigtools filter engines.
+ *
+ * sig_run_threads runs func(args[k]) for k = 0..nthreads-1, each on its
+ * own thread, and returns when all of them have finished. args[0] always
+ * runs on the calling thread. If a thread cannot be started, its call is
+ * simply dropped, so func must be written such that any one call can do
+ * all of the work (e.g. by claiming tasks from a shared counter).
+ *
+ * The GIL is released while the threads run, so func must not touch any
+ * Python objects.
+ */
+#ifndef SIG_THREADS_H
+#define SIG_THREADS_H
+
+#include <stdlib.h>
+#include "numpy/npy_common.h"
+
+#ifdef _WIN32
+
+#include <windows.h>
+#include <process.h>
+
+typedef CRITICAL_SECTION sig_mutex;
+
+#define sig_mutex_init(m) InitializeCriticalSection(m)
+#define sig_mutex_destroy(m) DeleteCriticalSection(m)
+#define sig_mutex_lock(m) EnterCriticalSection(m)
+#define sig_mutex_unlock(m) LeaveCriticalSection(m)
+
+typedef HANDLE sig_thread_handle;
+#define SIG_THREAD_RETURN unsigned __stdcall
+
+#else
+
+#include <pthread.h>
+
+typedef pthread_mutex_t sig_mutex;
+
+#define sig_mutex_init(m) pthread_mutex_init(m, NULL)
+#define sig_mutex_destroy(m) pthread_mutex_destroy(m)
+#define sig_mutex_lock(m) pthread_mutex_lock(m)
+#define sig_mutex_unlock(m) pthread_mutex_unlock(m)
+
+typedef pthread_t sig_thread_handle;
+#define SIG_THREAD_RETURN void *
+
+#endif
+
+typedef void sig_thread_func(void *arg);
+
+typedef struct {
+    sig_thread_func *func;
+    void *arg;
+    sig_thread_handle handle;
+    int started;
+} sig_thread;
+
+static SIG_THREAD_RETURN
+sig_thread_main(void *arg)
+{
+    sig_thread *th = (sig_thread *)arg;
+    th->func(th->arg);
+    return 0;
+}
+
+static NPY_INLINE int
+sig_thread_start(sig_thread *th)
+{
+#ifdef _WIN32
+    th->handle = (HANDLE)_beginthreadex(NULL, 0, sig_thread_main, th, 0,
+                                        NULL);
+    return th->handle != 0;
+#else
+    return pthread_create(&th->handle, NULL, sig_thread_main, th) == 0;
+#endif
+}
+
+static NPY_INLINE void
+sig_thread_join(sig_thread *th)
+{
+#ifdef _WIN32
+    WaitForSingleObject(th->handle, INFINITE);
+    CloseHandle(th->handle);
+#else
+    pthread_join(th->handle, NULL);
+#endif
+}
+
+static NPY_INLINE void
+sig_run_threads(int nthreads, sig_thread_func *func, void **args)
+{
+    sig_thread *threads = NULL;
+    int k;
+
+    if (nthreads > 1) {
+        threads = calloc(nthreads - 1, sizeof(sig_thread));
+    }
+    if (threads) {
+        for (k = 1; k < nthreads; ++k) {
+            sig_thread *th = threads + (k - 1);
+            th->func = func;
+            th->arg = args[k];
+            th->started = sig_thread_start(th);
+        }
+    }
+    func(args[0]);
+    if (threads) {
+        for (k = 1; k < nthreads; ++k) {
+            if (threads[k - 1].started) {
+                sig_thread_join(threads + (k - 1));
+            }
+        }
+        free(threads);
+    }
+}
+
+#endif
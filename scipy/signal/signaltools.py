@@ -4,15 +4,15 @@
 from __future__ import division, print_function, absolute_import
 
 import operator
-import threading
+import os
 import sys
 import timeit
 
 from . import sigtools, dlti
-from ._upfirdn import upfirdn, _output_len
+from ._upfirdn import upfirdn, _output_len, _UpFIRDn
 from scipy._lib.six import callable
-from scipy._lib._version import NumpyVersion
 from scipy import fftpack, linalg
+from scipy.fft._pocketfft._isa import pypocketfft
 from scipy.fftpack.helper import _init_nd_shape_and_axes_sorted
 from numpy import (allclose, angle, arange, argsort, array, asarray,
                    atleast_1d, atleast_2d, cast, dot, exp, expand_dims,
@@ -39,7 +39,7 @@ __all__ = ['correlate', 'fftconvolve', 'convolve', 'convolve2d', 'correlate2d',
            'order_filter', 'medfilt', 'medfilt2d', 'wiener', 'lfilter',
            'lfiltic', 'sosfilt', 'deconvolve', 'hilbert', 'hilbert2',
            'cmplx_sort', 'unique_roots', 'invres', 'invresz', 'residue',
-           'residuez', 'resample', 'resample_poly', 'detrend',
+           'residuez', 'resample', 'resample_poly', 'ResamplePoly', 'detrend',
            'lfilter_zi', 'sosfilt_zi', 'sosfiltfilt', 'choose_conv_method',
            'filtfilt', 'decimate', 'vectorstrength']
 
@@ -50,11 +50,6 @@ _boundarydict = {'fill': 0, 'pad': 0, 'wrap': 2, 'circular': 2, 'symm': 1,
                  'symmetric': 1, 'reflect': 4}
 
 
-_rfft_mt_safe = (NumpyVersion(np.__version__) >= '1.9.0.dev-e24486e')
-
-_rfft_lock = threading.Lock()
-
-
 def _valfrommode(mode):
     try:
         return _modedict[mode]
@@ -63,6 +58,28 @@ def _valfrommode(mode):
                          " 'same', or 'full'.")
 
 
+def _check_workers(workers):
+    """Normalize a ``workers`` argument to a positive thread count.
+
+    ``None`` means a single thread, and negative values wrap around from
+    ``os.cpu_count()``, so that ``-1`` means all CPUs.
+    """
+    if workers is None:
+        return 1
+
+    workers = operator.index(workers)
+    if workers < 0:
+        cpu_count = os.cpu_count() or 1
+        if workers >= -cpu_count:
+            workers += 1 + cpu_count
+        else:
+            raise ValueError("workers value out of range; got {}, must not be"
+                             " less than {}".format(workers, -cpu_count))
+    elif workers == 0:
+        raise ValueError("workers must not be zero")
+    return workers
+
+
 def _bvalfromboundary(boundary):
     try:
         return _boundarydict[boundary] << 2
@@ -102,7 +119,7 @@ def _inputs_swap_needed(mode, shape1, shape2):
     return False
 
 
-def correlate(in1, in2, mode='full', method='auto'):
+def correlate(in1, in2, mode='full', method='auto', workers=None):
     r"""
     Cross-correlate two N-dimensional arrays.
 
@@ -142,6 +159,10 @@ def correlate(in1, in2, mode='full', method='auto'):
            of which is faster (default).  See `convolve` Notes for more detail.
 
            .. versionadded:: 0.19.0
+    workers : int, optional
+        Number of threads to use for the direct N-D correlation, and for the
+        Fourier transforms when both inputs are real. If negative, the value
+        wraps around from ``os.cpu_count()``. Default is a single thread.
 
     Returns
     -------
@@ -218,8 +239,29 @@ def correlate(in1, in2, mode='full', method='auto'):
         raise ValueError("Acceptable mode flags are 'valid',"
                          " 'same', or 'full'.")
 
-    # this either calls fftconvolve or this function with method=='direct'
-    if method in ('fft', 'auto'):
+    workers = _check_workers(workers)
+
+    if method == 'auto':
+        if _inputs_swap_needed(mode, in1.shape, in2.shape):
+            method = choose_conv_method(in2, in1, mode=mode)
+        else:
+            method = choose_conv_method(in1, in2, mode=mode)
+
+    if method == 'fft':
+        if (in1.size and in2.size and
+                _numeric_arrays([in1, in2], kinds='buif')):
+            # Real inputs are correlated by pypocketfft directly, which walks
+            # in2 backwards instead of reversing a copy of it
+            _inputs_swap_needed(mode, in1.shape, in2.shape)
+            out = pypocketfft.correlate(asarray(in1, dtype=np.float64),
+                                        asarray(in2, dtype=np.float64),
+                                        axes=list(range(in1.ndim)),
+                                        mode=mode, nthreads=workers)
+            result_type = np.result_type(in1, in2)
+            if result_type.kind in {'u', 'i'}:
+                out = np.around(out)
+            return out.astype(result_type)
+
         return convolve(in1, _reverse_and_conj(in2), mode, method)
 
     elif method == 'direct':
@@ -241,7 +283,7 @@ def correlate(in1, in2, mode='full', method='auto'):
             ps = [i - j + 1 for i, j in zip(in1.shape, in2.shape)]
             out = np.empty(ps, in1.dtype)
 
-            z = sigtools._correlateND(in1, in2, out, val)
+            z = sigtools._correlateND(in1, in2, out, val, workers)
 
         else:
             ps = [i + j - 1 for i, j in zip(in1.shape, in2.shape)]
@@ -256,7 +298,7 @@ def correlate(in1, in2, mode='full', method='auto'):
             elif mode == 'same':
                 out = np.empty(in1.shape, in1.dtype)
 
-            z = sigtools._correlateND(in1zpadded, in2, out, val)
+            z = sigtools._correlateND(in1zpadded, in2, out, val, workers)
 
         if swapped_inputs:
             # Reverse and conjugate to undo the effect of swapping inputs
@@ -393,6 +435,10 @@ def fftconvolve(in1, in2, mode="full", axes=None):
         raise ValueError("incompatible shapes for in1 and in2:"
                          " {0} and {1}".format(in1.shape, in2.shape))
 
+    if mode not in ('full', 'same', 'valid'):
+        raise ValueError("acceptable mode flags are 'valid',"
+                         " 'same', or 'full'")
+
     complex_result = (np.issubdtype(in1.dtype, np.complexfloating)
                       or np.issubdtype(in2.dtype, np.complexfloating))
     shape = np.maximum(s1, s2)
@@ -403,41 +449,32 @@ def fftconvolve(in1, in2, mode="full", axes=None):
         # Convolution is commutative; order doesn't have any effect on output
         in1, s1, in2, s2 = in2, s2, in1, s1
 
+    if not complex_result:
+        # pypocketfft pads, transforms, multiplies and crops in one call,
+        # without materializing the padded inputs or the full output
+        ret = pypocketfft.convolve(asarray(in1, dtype=np.float64),
+                                   asarray(in2, dtype=np.float64),
+                                   axes=[int(a) for a in axes], mode=mode)
+        if mode == "same":
+            # also crops any broadcast axes that are not convolved
+            ret = _centered(ret, s1)
+        return ret
+
     # Speed up FFT by padding to optimal size for FFTPACK
     fshape = [fftpack.helper.next_fast_len(d) for d in shape[axes]]
     fslice = tuple([slice(sz) for sz in shape])
-    # Pre-1.9 NumPy FFT routines are not threadsafe.  For older NumPys, make
-    # sure we only call rfftn/irfftn from one thread at a time.
-    if not complex_result and (_rfft_mt_safe or _rfft_lock.acquire(False)):
-        try:
-            sp1 = np.fft.rfftn(in1, fshape, axes=axes)
-            sp2 = np.fft.rfftn(in2, fshape, axes=axes)
-            ret = np.fft.irfftn(sp1 * sp2, fshape, axes=axes)[fslice].copy()
-        finally:
-            if not _rfft_mt_safe:
-                _rfft_lock.release()
-    else:
-        # If we're here, it's either because we need a complex result, or we
-        # failed to acquire _rfft_lock (meaning rfftn isn't threadsafe and
-        # is already in use by another thread).  In either case, use the
-        # (threadsafe but slower) SciPy complex-FFT routines instead.
-        sp1 = fftpack.fftn(in1, fshape, axes=axes)
-        sp2 = fftpack.fftn(in2, fshape, axes=axes)
-        ret = fftpack.ifftn(sp1 * sp2, axes=axes)[fslice].copy()
-        if not complex_result:
-            ret = ret.real
+    sp1 = fftpack.fftn(in1, fshape, axes=axes)
+    sp2 = fftpack.fftn(in2, fshape, axes=axes)
+    ret = fftpack.ifftn(sp1 * sp2, axes=axes)[fslice].copy()
 
     if mode == "full":
         return ret
     elif mode == "same":
         return _centered(ret, s1)
-    elif mode == "valid":
+    else:
         shape_valid = shape.copy()
         shape_valid[axes] = s1[axes] - s2[axes] + 1
         return _centered(ret, shape_valid)
-    else:
-        raise ValueError("acceptable mode flags are 'valid',"
-                         " 'same', or 'full'")
 
 
 def _numeric_arrays(arrays, kinds='buifc'):
@@ -906,8 +943,11 @@ def medfilt(volume, kernel_size=None):
 
     Notes
     -------
-    The more general function `scipy.ndimage.median_filter` has a more
-    efficient implementation of a median filter and therefore runs much faster.
+    1-D and 2-D arrays of uint8, float32 and float64 are filtered by
+    `medfilt2d`, which slides the window along the rows instead of finding
+    the median of every window from scratch. For other arrays, the more
+    general function `scipy.ndimage.median_filter` has a more efficient
+    implementation of a median filter and therefore runs much faster.
     """
     volume = atleast_1d(volume)
     if kernel_size is None:
@@ -920,6 +960,11 @@ def medfilt(volume, kernel_size=None):
         if (kernel_size[k] % 2) != 1:
             raise ValueError("Each element of kernel_size should be odd.")
 
+    if volume.ndim <= 2 and volume.dtype.char in 'Bfd':
+        image = volume.reshape((1,) * (2 - volume.ndim) + volume.shape)
+        size = np.concatenate([[1] * (2 - volume.ndim), kernel_size])
+        return sigtools._medfilt2d(image, size).reshape(volume.shape)
+
     domain = ones(kernel_size)
 
     numels = prod(kernel_size, axis=0)
@@ -1162,7 +1207,7 @@ def correlate2d(in1, in2, mode='full', boundary='fill', fillvalue=0):
     return out
 
 
-def medfilt2d(input, kernel_size=3):
+def medfilt2d(input, kernel_size=3, workers=None):
     """
     Median filter a 2-dimensional array.
 
@@ -1180,6 +1225,10 @@ def medfilt2d(input, kernel_size=3):
         `kernel_size` should be odd.  If `kernel_size` is a scalar,
         then this scalar is used as the size in each dimension.
         Default is a kernel of size (3, 3).
+    workers : int, optional
+        Number of threads to filter the rows of the array on. If negative,
+        the value wraps around from ``os.cpu_count()``. Default is a single
+        thread.
 
     Returns
     -------
@@ -1193,8 +1242,12 @@ def medfilt2d(input, kernel_size=3):
 
     Notes
     -------
-    The more general function `scipy.ndimage.median_filter` has a more
-    efficient implementation of a median filter and therefore runs much faster.
+    The window slides along each row, so that moving it by one column only
+    replaces the values of one column of the window: uint8 windows are kept
+    as histograms, and float32 and float64 windows in a pair of heaps that
+    meet at the median. Each replaced value costs O(log(n)) for a window of n
+    values, instead of the O(n) per point of selecting the median from
+    scratch.
     """
     image = asarray(input)
     if kernel_size is None:
@@ -1207,10 +1260,10 @@ def medfilt2d(input, kernel_size=3):
         if (size % 2) != 1:
             raise ValueError("Each element of kernel_size should be odd.")
 
-    return sigtools._medfilt2d(image, kernel_size)
+    return sigtools._medfilt2d(image, kernel_size, _check_workers(workers))
 
 
-def lfilter(b, a, x, axis=-1, zi=None):
+def lfilter(b, a, x, axis=-1, zi=None, workers=None):
     """
     Filter data along one-dimension with an IIR or FIR filter.
 
@@ -1241,6 +1294,13 @@ def lfilter(b, a, x, axis=-1, zi=None):
         (or array of vectors for an N-dimensional input) of length
         ``max(len(a), len(b)) - 1``.  If `zi` is None or is not given then
         initial rest is assumed.  See `lfiltic` for more information.
+    workers : int, optional
+        Number of threads to filter independent lines of `x` with, for
+        N-dimensional input. Negative values count back from the number of
+        CPUs, so that ``-1`` uses all of them. Default is 1. Object arrays
+        are always filtered on a single thread.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -1290,6 +1350,11 @@ def lfilter(b, a, x, axis=-1, zi=None):
                              -1              -N
                  a[0] + a[1]z  + ... + a[N] z
 
+    Lines of real input are filtered several at a time, side by side, with
+    their states interleaved so that each step of the recursion can run in
+    SIMD lanes; this is most effective when many short or medium length
+    signals are filtered together.
+
     Examples
     --------
     Generate a noisy signal to be filtered:
@@ -1332,6 +1397,7 @@ def lfilter(b, a, x, axis=-1, zi=None):
     >>> plt.show()
 
     """
+    workers = _check_workers(workers)
     a = np.atleast_1d(a)
     if len(a) == 1:
         # This path only supports types fdgFDGO to mirror _linear_filter below.
@@ -1397,10 +1463,7 @@ def lfilter(b, a, x, axis=-1, zi=None):
             zf = out_full[tuple(ind)]
             return out, zf
     else:
-        if zi is None:
-            return sigtools._linear_filter(b, a, x, axis)
-        else:
-            return sigtools._linear_filter(b, a, x, axis, zi)
+        return sigtools._linear_filter(b, a, x, axis, zi, workers)
 
 
 def lfiltic(b, a, y, x=None):
@@ -2294,7 +2357,65 @@ def resample(x, num, t=None, axis=0, window=None):
         return y, new_t
 
 
-def resample_poly(x, up, down, axis=0, window=('kaiser', 5.0)):
+# Low-pass filters designed by resample_poly, by (up, down, window)
+_resample_poly_filters = {}
+
+
+def _resample_poly_factors(up, down):
+    """Check the factors of `resample_poly`, and reduce them to lowest terms.
+    """
+    if up != int(up):
+        raise ValueError("up must be an integer")
+    if down != int(down):
+        raise ValueError("down must be an integer")
+    up = int(up)
+    down = int(down)
+    if up < 1 or down < 1:
+        raise ValueError('up and down must be >= 1')
+
+    # Determine our up and down factors
+    # Use a rational approximation to save computation time on really long
+    # signals
+    g_ = gcd(up, down)
+    return up // g_, down // g_
+
+
+def _resample_poly_filter(up, down, window):
+    """The FIR filter of `resample_poly`, zero-padded in front so that the
+    outputs are centered, and the number of outputs this puts ahead of them.
+
+    Designed filters are cached, since windows like Kaiser's are costly to
+    compute for large factors.
+    """
+    if isinstance(window, (list, np.ndarray)):
+        window = array(window)  # use array to force a copy (we modify it)
+        if window.ndim > 1:
+            raise ValueError('window must be 1-D')
+        half_len = (window.size - 1) // 2
+        h = window
+    else:
+        # Design a linear-phase low-pass FIR filter
+        max_rate = max(up, down)
+        half_len = 10 * max_rate  # reasonable cutoff for our sinc-like function
+        try:
+            h = _resample_poly_filters[up, down, window].copy()
+        except KeyError:
+            f_c = 1. / max_rate  # cutoff of FIR filter (rel. to Nyquist)
+            h = firwin(2 * half_len + 1, f_c, window=window)
+            _resample_poly_filters[up, down, window] = h.copy()
+        except TypeError:
+            # an unhashable window, such as a tuple holding an array
+            h = firwin(2 * half_len + 1, 1. / max_rate, window=window)
+    h *= up
+
+    # Zero-pad our filter to put the output samples at the center
+    n_pre_pad = (down - half_len % down)
+    n_pre_remove = (half_len + n_pre_pad) // down
+    h = np.concatenate((np.zeros(n_pre_pad, dtype=h.dtype), h))
+    return h, n_pre_remove
+
+
+def resample_poly(x, up, down, axis=0, window=('kaiser', 5.0), workers=None):
     """
     Resample `x` along the given axis using polyphase filtering.
 
@@ -2317,6 +2438,12 @@ def resample_poly(x, up, down, axis=0, window=('kaiser', 5.0)):
     window : string, tuple, or array_like, optional
         Desired window to use to design the low-pass filter, or the FIR filter
         coefficients to employ. See below for details.
+    workers : int, optional
+        Number of threads to resample the subarrays along `axis` on. If
+        negative, the value wraps around from ``os.cpu_count()``. Default is
+        a single thread.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -2327,6 +2454,7 @@ def resample_poly(x, up, down, axis=0, window=('kaiser', 5.0)):
     --------
     decimate : Downsample the signal after applying an FIR or IIR filter.
     resample : Resample up or down using the FFT method.
+    ResamplePoly : Resample a signal that arrives in chunks.
 
     Notes
     -----
@@ -2350,7 +2478,8 @@ def resample_poly(x, up, down, axis=0, window=('kaiser', 5.0)):
 
     For any other type of `window`, the functions `scipy.signal.get_window`
     and `scipy.signal.firwin` are called to generate the appropriate filter
-    coefficients.
+    coefficients. These filters are cached, so that resampling many signals
+    by the same factors designs the filter only once.
 
     The first sample of the returned vector is the same as the first
     sample of the input vector. The spacing between samples is changed
@@ -2378,59 +2507,178 @@ def resample_poly(x, up, down, axis=0, window=('kaiser', 5.0)):
     >>> plt.show()
     """
     x = asarray(x)
-    if up != int(up):
-        raise ValueError("up must be an integer")
-    if down != int(down):
-        raise ValueError("down must be an integer")
-    up = int(up)
-    down = int(down)
-    if up < 1 or down < 1:
-        raise ValueError('up and down must be >= 1')
-
-    # Determine our up and down factors
-    # Use a rational approximation to save computation time on really long
-    # signals
-    g_ = gcd(up, down)
-    up //= g_
-    down //= g_
+    up, down = _resample_poly_factors(up, down)
     if up == down == 1:
         return x.copy()
     n_out = x.shape[axis] * up
     n_out = n_out // down + bool(n_out % down)
 
-    if isinstance(window, (list, np.ndarray)):
-        window = array(window)  # use array to force a copy (we modify it)
-        if window.ndim > 1:
-            raise ValueError('window must be 1-D')
-        half_len = (window.size - 1) // 2
-        h = window
-    else:
-        # Design a linear-phase low-pass FIR filter
-        max_rate = max(up, down)
-        f_c = 1. / max_rate  # cutoff of FIR filter (rel. to Nyquist)
-        half_len = 10 * max_rate  # reasonable cutoff for our sinc-like function
-        h = firwin(2 * half_len + 1, f_c, window=window)
-    h *= up
-
-    # Zero-pad our filter to put the output samples at the center
-    n_pre_pad = (down - half_len % down)
+    h, n_pre_remove = _resample_poly_filter(up, down, window)
     n_post_pad = 0
-    n_pre_remove = (half_len + n_pre_pad) // down
     # We should rarely need to do this given our filter lengths...
-    while _output_len(len(h) + n_pre_pad + n_post_pad, x.shape[axis],
+    while _output_len(len(h) + n_post_pad, x.shape[axis],
                       up, down) < n_out + n_pre_remove:
         n_post_pad += 1
-    h = np.concatenate((np.zeros(n_pre_pad, dtype=h.dtype), h,
-                        np.zeros(n_post_pad, dtype=h.dtype)))
+    h = np.concatenate((h, np.zeros(n_post_pad, dtype=h.dtype)))
     n_pre_remove_end = n_pre_remove + n_out
 
     # filter then remove excess
-    y = upfirdn(h, x, up, down, axis=axis)
+    y = upfirdn(h, x, up, down, axis=axis, workers=workers)
     keep = [slice(None), ]*x.ndim
     keep[axis] = slice(n_pre_remove, n_pre_remove_end)
     return y[tuple(keep)]
 
 
+class ResamplePoly(object):
+    """
+    Resample a signal that arrives in chunks, using polyphase filtering.
+
+    The chunks are resampled as `resample_poly` would resample the whole
+    signal: the filter is designed once, and the last inputs of each chunk
+    are kept to filter the first outputs of the next one.
+
+    Parameters
+    ----------
+    up : int
+        The upsampling factor.
+    down : int
+        The downsampling factor.
+    axis : int, optional
+        The axis of the chunks that is resampled. Default is 0.
+    window : string, tuple, or array_like, optional
+        Desired window to use to design the low-pass filter, or the FIR filter
+        coefficients to employ. See `resample_poly` for details.
+    workers : int, optional
+        Number of threads to resample the subarrays along `axis` on. If
+        negative, the value wraps around from ``os.cpu_count()``. Default is
+        a single thread.
+
+    See Also
+    --------
+    resample_poly : Resample a whole signal using polyphase filtering.
+
+    Notes
+    -----
+    Each call to `process` returns the outputs that only depend on the
+    inputs so far, and `flush` returns the rest, once the signal has ended.
+    The outputs of a signal are therefore delayed by about half the length
+    of the filter.
+
+    All chunks of a signal must have the same shape, apart from their length
+    along `axis`, and are resampled in the data type of the first chunk.
+
+    .. versionadded:: 1.4.0
+
+    Examples
+    --------
+    Convert two channels from 48 kHz to 44.1 kHz, a second at a time:
+
+    >>> from scipy import signal
+    >>> x = np.random.randn(2, 48000 * 5)
+    >>> resampler = signal.ResamplePoly(441, 480, axis=-1)
+    >>> chunks = [resampler.process(x[:, i:i + 48000])
+    ...           for i in range(0, x.shape[-1], 48000)]
+    >>> y = np.concatenate(chunks + [resampler.flush()], axis=-1)
+    >>> np.allclose(y, signal.resample_poly(x, 441, 480, axis=-1))
+    True
+
+    """
+    def __init__(self, up, down, axis=0, window=('kaiser', 5.0),
+                 workers=None):
+        self._up, self._down = _resample_poly_factors(up, down)
+        self._axis = axis
+        self._workers = _check_workers(workers)
+        if self._up == self._down == 1:
+            self._h, self._n_pre_remove = None, 0
+        else:
+            self._h, self._n_pre_remove = _resample_poly_filter(
+                self._up, self._down, window)
+        self.reset()
+
+    def reset(self):
+        """Forget the signal so far, to start resampling a new one."""
+        self._ufd = None
+        self._zi = None
+        self._shape = None
+        self._pos = 0
+        self._n_in = 0
+        self._n_done = 0
+
+    def process(self, x):
+        """Resample the next chunk of the signal.
+
+        Parameters
+        ----------
+        x : array_like
+            The next chunk of the signal.
+
+        Returns
+        -------
+        y : ndarray
+            The resampled signal, up to the last output that only depends on
+            the chunks so far.
+        """
+        x = asarray(x)
+        axis = self._axis % x.ndim
+        shape = x.shape[:axis] + x.shape[axis + 1:]
+        if self._shape is None:
+            self._shape = shape
+        elif self._shape != shape:
+            raise ValueError("x must have the shape of the previous chunks, "
+                             "apart from along axis.")
+        if self._h is None:
+            return x.copy()
+        if self._ufd is None:
+            self._ufd = _UpFIRDn(self._h, x.dtype, self._up, self._down)
+            h_per_phase = len(self._ufd._h_trans_flip) // self._up
+            self._zi = np.zeros(shape + (h_per_phase - 1,),
+                                self._ufd._output_type)
+
+        y, self._pos = self._ufd.apply_stream(x, self._zi, self._pos, axis,
+                                              self._workers)
+        self._n_in += x.shape[axis]
+        return self._keep(y, y.shape[axis], axis)
+
+    def flush(self):
+        """Resample the end of the signal, and start a new one.
+
+        Returns
+        -------
+        y : ndarray
+            The last outputs of the signal, from zeros past its end.
+        """
+        if self._ufd is None:
+            # nothing is held back
+            shape = list(self._shape or ())
+            shape.insert(self._axis % (len(shape) + 1), 0)
+            self.reset()
+            return np.zeros(shape)
+
+        axis = self._axis % self._zi.ndim
+        n_out = self._n_in * self._up
+        n_out = n_out // self._down + bool(n_out % self._down)
+        n_last = max(self._n_pre_remove + n_out - self._n_done, 0)
+        n_zeros = (self._pos + max(n_last - 1, 0) * self._down) // self._up + 1
+
+        shape = list(self._zi.shape[:-1])
+        shape.insert(axis, n_zeros)
+        y, _ = self._ufd.apply_stream(np.zeros(shape, self._zi.dtype),
+                                      self._zi, self._pos, axis,
+                                      self._workers)
+        y = self._keep(y, n_last, axis)
+        self.reset()
+        return y
+
+    def _keep(self, y, n, axis):
+        # Drop the outputs ahead of the first sample of the signal, and
+        # anything past the first n
+        start = min(max(self._n_pre_remove - self._n_done, 0), n)
+        self._n_done += n
+        keep = [slice(None)] * y.ndim
+        keep[axis] = slice(start, n)
+        return y[tuple(keep)]
+
+
 def vectorstrength(events, period):
     '''
     Determine the vector strength of the events corresponding to the given
@@ -3217,13 +3465,14 @@ def _validate_pad(padtype, padlen, x, axis, ntaps):
     return edge, ext
 
 
-def sosfilt(sos, x, axis=-1, zi=None):
+def sosfilt(sos, x, axis=-1, zi=None, workers=None):
     """
     Filter data along one dimension using cascaded second-order sections.
 
     Filter a data sequence, `x`, using a digital IIR filter defined by
-    `sos`. This is implemented by performing `lfilter` for each
-    second-order section.  See `lfilter` for details.
+    `sos`. Each sample is passed through all of the second-order sections
+    in turn, as if `lfilter` were applied for each section.  See `lfilter`
+    for details.
 
     Parameters
     ----------
@@ -3247,6 +3496,12 @@ def sosfilt(sos, x, axis=-1, zi=None):
         (i.e. all zeros) is assumed.
         Note that these initial conditions are *not* the same as the initial
         conditions given by `lfiltic` or `lfilter_zi`.
+    workers : int, optional
+        Number of threads to filter independent lines of `x` with, for
+        N-dimensional input. Negative values count back from the number of
+        CPUs, so that ``-1`` uses all of them. Default is 1.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -3288,6 +3543,7 @@ def sosfilt(sos, x, axis=-1, zi=None):
     >>> plt.show()
 
     """
+    workers = _check_workers(workers)
     x = np.asarray(x)
     sos, n_sections = _validate_sos(sos)
     use_zi = zi is not None
@@ -3301,8 +3557,33 @@ def sosfilt(sos, x, axis=-1, zi=None):
                              'shape %r, and an sos array with %d sections, zi '
                              'must have shape %r, got %r.' %
                              (axis, x.shape, n_sections, x_zi_shape, zi.shape))
-        zf = zeros_like(zi)
 
+    dtype = np.result_type(sos, x, *([zi] if use_zi else []))
+    if dtype.char in 'fdgFDG' and -x.ndim <= axis < x.ndim:
+        # Filter the lines of a C contiguous copy of x, with the filtered
+        # axis last, in place, with all sections applied to each sample in
+        # turn.
+        axis = axis % x.ndim
+        x = np.array(np.moveaxis(x, axis, -1), dtype=dtype, order='C')
+        shape = x.shape
+        x = x.reshape(int(np.prod(shape[:-1])), shape[-1])
+        if use_zi:
+            zf = np.array(np.moveaxis(zi, (0, axis + 1), (-2, -1)),
+                          dtype=dtype, order='C')
+        else:
+            zf = zeros(shape[:-1] + (n_sections, 2), dtype=dtype)
+        zf = zf.reshape(x.shape[0], n_sections, 2)
+        sigtools._sosfilt(np.ascontiguousarray(sos, dtype=dtype), x, zf,
+                          workers)
+        x = np.moveaxis(x.reshape(shape), -1, axis)
+        if not use_zi:
+            return x
+        zf = np.moveaxis(zf.reshape(shape[:-1] + (n_sections, 2)),
+                         (-2, -1), (0, axis + 1))
+        return x, zf
+
+    if use_zi:
+        zf = zeros_like(zi)
     for section in range(n_sections):
         if use_zi:
             x, zf[section] = lfilter(sos[section, :3], sos[section, 3:],
@@ -3313,7 +3594,7 @@ def sosfilt(sos, x, axis=-1, zi=None):
     return out
 
 
-def sosfiltfilt(sos, x, axis=-1, padtype='odd', padlen=None):
+def sosfiltfilt(sos, x, axis=-1, padtype='odd', padlen=None, workers=None):
     """
     A forward-backward digital filter using cascaded second-order sections.
 
@@ -3350,6 +3631,12 @@ def sosfiltfilt(sos, x, axis=-1, padtype='odd', padlen=None):
         and zeros at the origin (e.g. for odd-order filters) to yield
         equivalent estimates of `padlen` to those of `filtfilt` for
         second-order section filters built with `scipy.signal` functions.
+    workers : int, optional
+        Number of threads to filter independent lines of `x` with, for
+        N-dimensional input. Negative values count back from the number of
+        CPUs, so that ``-1`` uses all of them. Default is 1.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -3401,6 +3688,7 @@ def sosfiltfilt(sos, x, axis=-1, padtype='odd', padlen=None):
     >>> plt.show()
 
     """
+    workers = _check_workers(workers)
     sos, n_sections = _validate_sos(sos)
 
     # `method` is "pad"...
@@ -3411,6 +3699,22 @@ def sosfiltfilt(sos, x, axis=-1, padtype='odd', padlen=None):
 
     # These steps follow the same form as filtfilt with modifications
     zi = sosfilt_zi(sos)  # shape (n_sections, 2) --> (n_sections, ..., 2, ...)
+    dtype = np.result_type(sos, ext)
+    if dtype.char in 'fdgFDG':
+        # Both passes run in place on a C contiguous array with the
+        # filtered axis last: the extension, unless it is x itself.
+        axis = axis % ext.ndim
+        y = np.array(np.moveaxis(ext, axis, -1), dtype=dtype, order='C',
+                     copy=ext is x)
+        shape = y.shape
+        sigtools._sosfiltfilt(np.ascontiguousarray(sos, dtype=dtype),
+                              y.reshape(int(np.prod(shape[:-1])), shape[-1]),
+                              np.ascontiguousarray(zi, dtype=dtype), workers)
+        y = np.moveaxis(y, -1, axis)
+        if edge > 0:
+            y = axis_slice(y, start=edge, stop=-edge, axis=axis)
+        return y
+
     zi_shape = [1] * x.ndim
     zi_shape[axis] = 2
     zi.shape = [n_sections] + zi_shape
@@ -53,6 +53,12 @@ typedef void (MultAddFunction) (char *, npy_intp, char *, npy_intp, char *,
 PyObject*
 scipy_signal_sigtools_linear_filter(PyObject * NPY_UNUSED(dummy), PyObject * args);
 
+PyObject*
+scipy_signal_sigtools_sos_filter(PyObject * NPY_UNUSED(dummy), PyObject * args);
+
+PyObject*
+scipy_signal_sigtools_sos_filtfilt(PyObject * NPY_UNUSED(dummy), PyObject * args);
+
 PyObject*
 scipy_signal_sigtools_correlateND(PyObject *NPY_UNUSED(dummy), PyObject *args);
 
@@ -9,6 +9,7 @@ is granted under the SciPy License.
 #include "numpy/ndarrayobject.h"
 
 #include "sigtools.h"
+#include "sig_threads.h"
 #include <setjmp.h>
 #include <stdlib.h>
 
@@ -177,16 +178,16 @@ static double lagrange_interp(int k, int n, int m, double *x)
  * FUNCTION: freq_eval (gee)
  *  FUNCTION TO EVALUATE THE FREQUENCY RESPONSE USING THE
  *  LAGRANGE INTERPOLATION FORMULA IN THE BARYCENTRIC FORM
+ *  AT xf = cos(2 pi f)
  *-----------------------------------------------------------------------
  */
-static double freq_eval(int k, int n, double *grid, double *x, double *y, double *ad)
+static double freq_eval(double xf, int n, double *x, double *y, double *ad)
 {
     int j;
-    double p,c,d,xf;
+    double p,c,d;
 
     d = 0.0;
     p = 0.0;
-    xf = cos(TWOPI * grid[k]);
 
     DOloop(j,1,n) {
 	c = ad[j] / (xf - x[j]);
@@ -197,6 +198,89 @@ static double freq_eval(int k, int n, double *grid, double *x, double *y, double
     return p/d;
 }
 
+/*
+ * The weighted error of the current approximation on the dense grid,
+ * where xgrid[l] = cos(2 pi grid[l]).  remez evaluates it on demand while
+ * it searches for the extremal frequencies, or, for large grids, on
+ * several threads for the whole grid at once (remez_grid_error).
+ */
+#define REMEZ_ERR(l) (errv != NULL ? errv[l] : \
+    (freq_eval(xgrid[l],nz,x,y,ad)-des[l]) * wt[l])
+
+#define REMEZ_MIN_WORK_PER_THREAD 65536
+#define REMEZ_POINTS_PER_CLAIM 256
+
+typedef struct {
+    const double *xgrid, *des, *wt;
+    double *x, *y, *ad, *errv;
+    int nz, ngrid;
+    int *next;
+    sig_mutex *mutex;
+} RemezGridTask;
+
+static void remez_grid_task(void *arg)
+{
+    RemezGridTask *task = (RemezGridTask *)arg;
+    int l, lo, hi;
+
+    for (;;) {
+        sig_mutex_lock(task->mutex);
+        lo = *task->next;
+        *task->next += REMEZ_POINTS_PER_CLAIM;
+        sig_mutex_unlock(task->mutex);
+        if (lo > task->ngrid) break;
+        hi = lo + REMEZ_POINTS_PER_CLAIM - 1;
+        if (hi > task->ngrid) hi = task->ngrid;
+        DOloop(l,lo,hi) {
+            task->errv[l] = (freq_eval(task->xgrid[l], task->nz, task->x,
+                                       task->y, task->ad) - task->des[l])
+                            * task->wt[l];
+        }
+    }
+}
+
+/* Fill errv[1..ngrid] on nthreads threads; returns -1 if out of memory. */
+static int remez_grid_error(int nthreads, const double *xgrid,
+                            const double *des, const double *wt, int ngrid,
+                            int nz, double *x, double *y, double *ad,
+                            double *errv)
+{
+    RemezGridTask run, *tasks;
+    void **args;
+    sig_mutex mutex;
+    int next = 1, k;
+
+    run.xgrid = xgrid;
+    run.des = des;
+    run.wt = wt;
+    run.x = x;
+    run.y = y;
+    run.ad = ad;
+    run.errv = errv;
+    run.nz = nz;
+    run.ngrid = ngrid;
+    run.next = &next;
+    run.mutex = &mutex;
+
+    tasks = malloc(nthreads * sizeof(RemezGridTask));
+    args = malloc(nthreads * sizeof(void *));
+    if (tasks == NULL || args == NULL) {
+        free(tasks);
+        free(args);
+        return -1;
+    }
+    sig_mutex_init(&mutex);
+    for (k = 0; k < nthreads; k++) {
+        tasks[k] = run;
+        args[k] = tasks + k;
+    }
+    sig_run_threads(nthreads, remez_grid_task, args);
+    sig_mutex_destroy(&mutex);
+    free(args);
+    free(tasks);
+    return 0;
+}
+
 
 /*
  *-----------------------------------------------------------------------
@@ -215,20 +299,25 @@ static double freq_eval(int k, int n, double *grid, double *x, double *y, double
  */
 static int remez(double *dev, double des[], double grid[], double edge[],  
 	   double wt[], int ngrid, int nbands, int iext[], double alpha[],
-	   int nfcns, int itrmax, double *work, int dimsize, int *niter_out)
+	   int nfcns, int itrmax, double *work, int dimsize, int *niter_out,
+	   double xgrid[], double *errv, int workers)
 		/* dev, iext, alpha                         are output types */
 		/* des, grid, edge, wt, ngrid, nbands, nfcns are input types */
+		/* xgrid is cos(2 pi grid); errv, if not NULL, has room for the
+		   error on the grid, which is then found on up to workers
+		   threads */
 {
     int k, k1, kkk, kn, knz, klow, kup, nz, nzz, nm1;
     int cn;
     int j, jchnge, jet, jm1, jp1;
     int l, luck=0, nu, nut, nut1=0, niter;
 
-    double ynz=0.0, comp=0.0, devl, gtemp, fsh, y1=0.0, err, dtemp, delf, dnum, dden;
+    double ynz=0.0, comp=0.0, devl, fsh, y1=0.0, err, dtemp, delf, dnum, dden;
     double aa=0.0, bb=0.0, ft, xe, xt;
+    int nthreads = 1;
 
-    static double *a, *p, *q;
-    static double *ad, *x, *y;
+    double *a, *p, *q;
+    double *ad, *x, *y;
 
     a = work; p = a + dimsize+1; q = p + dimsize+1; 
     ad = q + dimsize+1; x = ad + dimsize+1; y = x + dimsize+1;
@@ -237,6 +326,14 @@ static int remez(double *dev, double des[], double grid[], double edge[],
     nzz = nfcns+2;
     niter = 0;
 
+    if (errv != NULL) {
+	nthreads = (int)((double)ngrid * nz / REMEZ_MIN_WORK_PER_THREAD);
+	if (nthreads > workers) nthreads = workers;
+	/* The search only visits about half of the grid, so it does not pay
+	   to evaluate all of it on fewer threads */
+	if (nthreads < 3) errv = NULL;
+    }
+
     do {
     L100:
 	iext[nzz] = ngrid + 1;
@@ -247,7 +344,7 @@ static int remez(double *dev, double des[], double grid[], double edge[],
 	/* printf("ITERATION %2d: ",niter); */
 
 	DOloop(j,1,nz) {
-	    x[j] = cos(grid[iext[j]]*TWOPI);
+	    x[j] = xgrid[iext[j]];
 	}
 	jet = (nfcns-1) / 15 + 1;
 
@@ -284,6 +381,11 @@ static int remez(double *dev, double des[], double grid[], double edge[],
 	    return -1;
 	}
 	devl = (*dev);
+	if (errv != NULL &&
+	    remez_grid_error(nthreads, xgrid, des, wt, ngrid, nz,
+			     x, y, ad, errv) < 0) {
+	    errv = NULL;    /* out of memory: evaluate on demand instead */
+	}
 	jchnge = 0;
 	k1 = iext[1];
 	knz = iext[nz];
@@ -304,12 +406,12 @@ static int remez(double *dev, double des[], double grid[], double edge[],
 	if (j == 2) y1 = comp;
 	comp = (*dev);
 	if (l >= kup) goto L220;
-	err = (freq_eval(l,nz,grid,x,y,ad)-des[l]) * wt[l];
+	err = REMEZ_ERR(l);
 	if (((double)nut*err-comp) <= 0.0) goto L220;
 	comp = (double)nut * err;
     L210:
 	if (++l >= kup) goto L215;
-	err = (freq_eval(l,nz,grid,x,y,ad)-des[l]) * wt[l];
+	err = REMEZ_ERR(l);
 	if (((double)nut*err-comp) <= 0.0) goto L215;
 	comp = (double)nut * err;
 	GOBACK L210;
@@ -324,7 +426,7 @@ static int remez(double *dev, double des[], double grid[], double edge[],
 	--l;
     L225:
 	if (--l <= klow) goto L250;
-	err = (freq_eval(l,nz,grid,x,y,ad)-des[l]) * wt[l];
+	err = REMEZ_ERR(l);
 	if (((double)nut*err-comp) > 0.0) goto L230;
 	if (jchnge <= 0) goto L225;
 	goto L260;
@@ -333,7 +435,7 @@ static int remez(double *dev, double des[], double grid[], double edge[],
 	comp = (double)nut * err;
     L235:
 	if (--l <= klow) goto L240;
-	err = (freq_eval(l,nz,grid,x,y,ad)-des[l]) * wt[l];
+	err = REMEZ_ERR(l);
 	if (((double)nut*err-comp) <= 0.0) goto L240;
 	comp = (double)nut * err;
 	GOBACK L235;
@@ -350,7 +452,7 @@ static int remez(double *dev, double des[], double grid[], double edge[],
 
     L255:
 	if (++l >= kup) goto L260;
-	err = (freq_eval(l,nz,grid,x,y,ad)-des[l]) * wt[l];
+	err = REMEZ_ERR(l);
 	if (((double)nut*err-comp) <= 0.0) GOBACK L255;
 	comp = (double)nut * err;
 
@@ -371,7 +473,7 @@ static int remez(double *dev, double des[], double grid[], double edge[],
 	luck = 1;
     L310:
 	if (++l >= kup) goto L315;
-	err = (freq_eval(l,nz,grid,x,y,ad)-des[l]) * wt[l];
+	err = REMEZ_ERR(l);
 	if (((double)nut*err-comp) <= 0.0) GOBACK L310;
 	comp = (double) nut * err;
 	j = nzz;
@@ -392,7 +494,7 @@ static int remez(double *dev, double des[], double grid[], double edge[],
 	comp = y1*(1.00001);
     L330:
 	if (--l <= klow) goto L340;
-	err = (freq_eval(l,nz,grid,x,y,ad)-des[l]) * wt[l];
+	err = REMEZ_ERR(l);
 	if (((double)nut*err-comp) <= 0.0) GOBACK L330;
 	j = nzz;
 	comp = (double) nut * err;
@@ -421,7 +523,6 @@ static int remez(double *dev, double des[], double grid[], double edge[],
  */
     nm1 = nfcns - 1;
     fsh = 1.0e-06;
-    gtemp = grid[1];
     x[nzz] = -2.0;
     cn  = 2*nfcns - 1;
     delf = 1.0/cn;
@@ -462,13 +563,11 @@ L415:
 	goto L425;
 L420:
 	if ((xt-xe) < fsh) GOBACK L415;
-	grid[1] = ft;
-	a[j] = freq_eval(1,nz,grid,x,y,ad);
+	a[j] = freq_eval(cos(TWOPI*ft),nz,x,y,ad);
 L425:
 	if (l > 1) l = l-1;
     }
 
-    grid[1] = gtemp;
     dden = TWOPI / cn;
     DOloop (j,1,nfcns) {
 	dtemp = 0.0;
@@ -563,14 +662,14 @@ static double wate(double freq, double *fx, double *wtx, int lband, int jtype)
 
 static int pre_remez(double *h2, int numtaps, int numbands, double *bands,
                      double *response, double *weight, int type, int maxiter,
-                     int grid_density, int *niter_out) {
+                     int grid_density, int workers, int *niter_out) {
   
   int jtype, nbands, nfilt, lgrid, nz;
   int neg, nodd, nm1;
   int j, k, l, lband, dimsize;
   double delf, change, fup, temp;
   double *tempstor, *edge, *h, *fx, *wtx;
-  double *des, *grid, *wt, *alpha, *work;
+  double *des, *grid, *wt, *xgrid, *errv, *alpha, *work;
   double dev;
   int ngrid;
   int *iext;
@@ -587,13 +686,15 @@ static int pre_remez(double *h2, int numtaps, int numbands, double *bands,
   fx = response - 1;
   wtx = weight - 1;
 
-  total_dsize = (dimsize+1)*7 + 3*(wrksize+1);
+  total_dsize = (dimsize+1)*7 + (workers > 1 ? 5 : 4)*(wrksize+1);
   total_isize = (dimsize+1);
   /* Need space for:  (all arrays ignore the first element).
 
      des  (wrksize+1)
      grid (wrksize+1)
      wt   (wrksize+1)
+     xgrid (wrksize+1)
+     errv (wrksize+1)   (only with several workers)
      iext (dimsize+1)   (integer)
      alpha (dimsize+1)
      work  (dimsize+1)*6 
@@ -603,8 +704,15 @@ static int pre_remez(double *h2, int numtaps, int numbands, double *bands,
   if (tempstor == NULL) return -2;
 
   des = tempstor; grid = des + wrksize+1;
-  wt = grid + wrksize+1; alpha = wt + wrksize+1;
-  work = alpha + dimsize+1; iext = (int *)(work + (dimsize+1)*6);
+  wt = grid + wrksize+1; xgrid = wt + wrksize+1;
+  alpha = xgrid + wrksize+1; work = alpha + dimsize+1;
+  errv = NULL;
+  if (workers > 1) {
+      errv = work + (dimsize+1)*6; iext = (int *)(errv + wrksize+1);
+  }
+  else {
+      iext = (int *)(work + (dimsize+1)*6);
+  }
 
   /* Set up problem on dense_grid */
 
@@ -697,8 +805,13 @@ static int pre_remez(double *h2, int numtaps, int numbands, double *bands,
     nm1 = nfcns - 1;
     nz  = nfcns + 1;
 
+    /* The dense grid is fixed from here on, so its cosines are too */
+    DOloop(j,1,ngrid) {
+	xgrid[j] = cos(grid[j]*TWOPI);
+    }
+
     if (remez(&dev, des, grid, edge, wt, ngrid, numbands, iext, alpha, nfcns,
-              maxiter, work, dimsize, niter_out) < 0) {
+              maxiter, work, dimsize, niter_out, xgrid, errv, workers) < 0) {
         free(tempstor);
         return -1;
     }
@@ -1192,51 +1305,78 @@ static PyObject *sigtools_order_filterND(PyObject *NPY_UNUSED(dummy),
 
 
 static char doc_remez[] =
-    "h = _remez(numtaps, bands, des, weight, type, fs, maxiter, grid_density)\n"
+    "h = _remez(numtaps, bands, des, weight, type, fs, maxiter, grid_density,\n"
+    "           workers=1)\n"
     "  returns the optimal (in the Chebyshev/minimax sense) FIR filter impulse\n"
     "  response given a set of band edges, the desired response on those bands,\n"
     "  and the weight given to the error in those bands.  Bands is a monotonic\n"
     "  vector with band edges given in frequency domain where fs is the sampling\n"
-    "  frequency.";
-
-static PyObject *sigtools_remez(PyObject *NPY_UNUSED(dummy), PyObject *args)
+    "  frequency.  The error on large dense grids is evaluated on up to workers\n"
+    "  threads.";
+
+static char doc_remez_batch[] =
+    "hs = _remez_batch(specs, workers=1)\n"
+    "  designs one filter for each tuple (numtaps, bands, des, weight, type,\n"
+    "  fs, maxiter, grid_density) of the sequence specs, as _remez does,\n"
+    "  sharing the designs between up to workers threads, and returns the list\n"
+    "  of their impulse responses.";
+
+/* The validated arguments, and the result, of one remez design. */
+typedef struct {
+    PyArrayObject *a_bands, *a_des, *a_weight, *h;
+    int numtaps, numbands, type, maxiter, grid_density;
+    int err, niter;
+} RemezSpec;
+
+static void remez_spec_clear(RemezSpec *spec)
 {
-    PyObject *bands, *des, *weight;
-    int k, numtaps, numbands, type = BANDPASS, err; 
-    PyArrayObject *a_bands=NULL, *a_des=NULL, *a_weight=NULL;
-    PyArrayObject *h=NULL;
-    npy_intp ret_dimens; int maxiter = 25, grid_density = 16;
-    double oldvalue, *dptr, fs = 1.0;
-    char mystr[255];
-    int niter = -1;
-
-    if (!PyArg_ParseTuple(args, "iOOO|idii", &numtaps, &bands, &des, &weight, 
-                          &type, &fs, &maxiter, &grid_density)) {
-        return NULL;
-    }
+    Py_XDECREF(spec->a_bands);
+    Py_XDECREF(spec->a_des);
+    Py_XDECREF(spec->a_weight);
+    Py_XDECREF(spec->h);
+    spec->a_bands = spec->a_des = spec->a_weight = spec->h = NULL;
+}
 
-    if (type != BANDPASS && type != DIFFERENTIATOR && type != HILBERT) {
+/* Check the _remez arguments and set up spec with them; returns -1 with a
+   Python exception set if they are not valid. */
+static int remez_spec_init(RemezSpec *spec, int numtaps, PyObject *bands,
+                           PyObject *des, PyObject *weight, int type,
+                           double fs, int maxiter, int grid_density)
+{
+    int k;
+    npy_intp ret_dimens;
+    double oldvalue, *dptr;
+
+    memset(spec, 0, sizeof(*spec));
+    spec->numtaps = numtaps;
+    spec->type = type;
+    spec->maxiter = maxiter;
+    spec->grid_density = grid_density;
+    spec->niter = -1;
+
+    if (spec->type != BANDPASS && spec->type != DIFFERENTIATOR &&
+        spec->type != HILBERT) {
         PyErr_SetString(PyExc_ValueError,
                         "The type must be BANDPASS, DIFFERENTIATOR, or HILBERT.");
-        return NULL;
+        return -1;
 	}
 
-    if (numtaps < 2) {
+    if (spec->numtaps < 2) {
         PyErr_SetString(PyExc_ValueError,
                         "The number of taps must be greater than 1.");
-        return NULL;
+        return -1;
     }
 
-    a_bands = (PyArrayObject *)PyArray_ContiguousFromObject(bands, NPY_DOUBLE,1,1);
-    if (a_bands == NULL) goto fail;
-    a_des = (PyArrayObject *)PyArray_ContiguousFromObject(des, NPY_DOUBLE,1,1);
-    if (a_des == NULL) goto fail;
-    a_weight = (PyArrayObject *)PyArray_ContiguousFromObject(weight, NPY_DOUBLE,1,1);
-    if (a_weight == NULL) goto fail;
+    spec->a_bands = (PyArrayObject *)PyArray_ContiguousFromObject(bands, NPY_DOUBLE,1,1);
+    if (spec->a_bands == NULL) goto fail;
+    spec->a_des = (PyArrayObject *)PyArray_ContiguousFromObject(des, NPY_DOUBLE,1,1);
+    if (spec->a_des == NULL) goto fail;
+    spec->a_weight = (PyArrayObject *)PyArray_ContiguousFromObject(weight, NPY_DOUBLE,1,1);
+    if (spec->a_weight == NULL) goto fail;
 
-    numbands = PyArray_DIMS(a_des)[0];
-    if ((PyArray_DIMS(a_bands)[0] != 2*numbands) || 
-        (PyArray_DIMS(a_weight)[0] != numbands)) {
+    spec->numbands = PyArray_DIMS(spec->a_des)[0];
+    if ((PyArray_DIMS(spec->a_bands)[0] != 2*spec->numbands) || 
+        (PyArray_DIMS(spec->a_weight)[0] != spec->numbands)) {
 	    PyErr_SetString(PyExc_ValueError,
                         "The inputs desired and weight must have same length.\n  "
                         "The input bands must have twice this length.");
@@ -1247,9 +1387,9 @@ static PyObject *sigtools_remez(PyObject *NPY_UNUSED(dummy), PyObject *args)
      * Check the bands input to see if it is monotonic, divide by 
      * fs to take from range 0 to 0.5 and check to see if in that range
      */ 
-    dptr = (double *)PyArray_DATA(a_bands);
+    dptr = (double *)PyArray_DATA(spec->a_bands);
     oldvalue = 0;
-    for (k=0; k < 2*numbands; k++) {
+    for (k=0; k < 2*spec->numbands; k++) {
         if (*dptr < oldvalue) {
             PyErr_SetString(PyExc_ValueError,
                             "Bands must be monotonic starting at zero.");
@@ -1265,56 +1405,224 @@ static PyObject *sigtools_remez(PyObject *NPY_UNUSED(dummy), PyObject *args)
         dptr++;
     }
 
-    ret_dimens = numtaps;
-    h = (PyArrayObject *)PyArray_SimpleNew(1, &ret_dimens, NPY_DOUBLE);
-    if (h == NULL) goto fail;
-
-    err = pre_remez((double *)PyArray_DATA(h), numtaps, numbands, 
-                    (double *)PyArray_DATA(a_bands),
-                    (double *)PyArray_DATA(a_des),
-                    (double *)PyArray_DATA(a_weight),
-                    type, maxiter, grid_density, &niter);
-    if (err < 0) {
-        if (err == -1) {
-            sprintf(mystr, "Failure to converge at iteration %d, try reducing transition band width.\n", niter);
+    ret_dimens = spec->numtaps;
+    spec->h = (PyArrayObject *)PyArray_SimpleNew(1, &ret_dimens, NPY_DOUBLE);
+    if (spec->h == NULL) goto fail;
+    return 0;
+
+fail:
+    remez_spec_clear(spec);
+    return -1;
+}
+
+static void remez_spec_run(RemezSpec *spec, int workers)
+{
+    spec->err = pre_remez((double *)PyArray_DATA(spec->h), spec->numtaps,
+                          spec->numbands,
+                          (double *)PyArray_DATA(spec->a_bands),
+                          (double *)PyArray_DATA(spec->a_des),
+                          (double *)PyArray_DATA(spec->a_weight),
+                          spec->type, spec->maxiter, spec->grid_density,
+                          workers, &spec->niter);
+}
+
+/* Set the Python exception for a failed design; returns -1 if it failed. */
+static int remez_spec_check(RemezSpec *spec)
+{
+    char mystr[255];
+
+    if (spec->err < 0) {
+        if (spec->err == -1) {
+            sprintf(mystr, "Failure to converge at iteration %d, try reducing transition band width.\n", spec->niter);
 	        PyErr_SetString(PyExc_ValueError, mystr);
-	        goto fail;
         }
-        else if (err == -2) {
+        else {
             PyErr_NoMemory();
+        }
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject *sigtools_remez(PyObject *NPY_UNUSED(dummy), PyObject *args)
+{
+    RemezSpec spec;
+    PyObject *bands, *des, *weight;
+    int numtaps, type = BANDPASS, maxiter = 25, grid_density = 16;
+    int workers = 1;
+    double fs = 1.0;
+    NPY_BEGIN_THREADS_DEF;
+
+    if (!PyArg_ParseTuple(args, "iOOO|idiii", &numtaps, &bands, &des, &weight, 
+                          &type, &fs, &maxiter, &grid_density, &workers)) {
+        return NULL;
+    }
+    if (remez_spec_init(&spec, numtaps, bands, des, weight, type, fs,
+                        maxiter, grid_density) < 0) {
+        return NULL;
+    }
+
+    NPY_BEGIN_THREADS;
+    remez_spec_run(&spec, workers);
+    NPY_END_THREADS;
+    if (remez_spec_check(&spec) < 0) {
+        remez_spec_clear(&spec);
+        return NULL;
+    }
+
+    Py_DECREF(spec.a_bands);
+    Py_DECREF(spec.a_des);
+    Py_DECREF(spec.a_weight);
+
+	return PyArray_Return(spec.h);
+}
+
+typedef struct {
+    RemezSpec *specs;
+    npy_intp nspecs;
+    int workers;
+    npy_intp *next;
+    sig_mutex *mutex;
+} RemezBatchTask;
+
+static void remez_batch_task(void *arg)
+{
+    RemezBatchTask *task = (RemezBatchTask *)arg;
+    npy_intp k;
+
+    for (;;) {
+        sig_mutex_lock(task->mutex);
+        k = (*task->next)++;
+        sig_mutex_unlock(task->mutex);
+        if (k >= task->nspecs) break;
+        remez_spec_run(task->specs + k, task->workers);
+    }
+}
+
+/* Run the designs on up to workers threads; returns -1 if out of memory. */
+static int remez_batch(RemezSpec *specs, npy_intp nspecs, int workers)
+{
+    RemezBatchTask run, *tasks;
+    void **args;
+    sig_mutex mutex;
+    npy_intp next = 0, nthreads, k;
+
+    if (nspecs == 0) return 0;
+    nthreads = workers > 1 ? workers : 1;
+    if (nthreads > nspecs) nthreads = nspecs;
+
+    run.specs = specs;
+    run.nspecs = nspecs;
+    /* Threads left over from the designs evaluate their dense grids */
+    run.workers = workers / nthreads;
+    run.next = &next;
+    run.mutex = &mutex;
+
+    tasks = malloc(nthreads * sizeof(RemezBatchTask));
+    args = malloc(nthreads * sizeof(void *));
+    if (tasks == NULL || args == NULL) {
+        free(tasks);
+        free(args);
+        return -1;
+    }
+    sig_mutex_init(&mutex);
+    for (k = 0; k < nthreads; k++) {
+        tasks[k] = run;
+        args[k] = tasks + k;
+    }
+    sig_run_threads((int)nthreads, remez_batch_task, args);
+    sig_mutex_destroy(&mutex);
+    free(args);
+    free(tasks);
+    return 0;
+}
+
+static PyObject *sigtools_remez_batch(PyObject *NPY_UNUSED(dummy),
+                                      PyObject *args)
+{
+    PyObject *specs = NULL, *seq = NULL, *item, *out = NULL;
+    PyObject *bands, *des, *weight;
+    RemezSpec *a_specs = NULL;
+    npy_intp nspecs = 0, k, ninit = 0;
+    int numtaps, type, maxiter, grid_density, workers = 1, st;
+    double fs;
+    NPY_BEGIN_THREADS_DEF;
+
+    if (!PyArg_ParseTuple(args, "O|i", &specs, &workers)) return NULL;
+
+    seq = PySequence_Fast(specs, "specs must be a sequence of tuples");
+    if (seq == NULL) return NULL;
+    nspecs = PySequence_Fast_GET_SIZE(seq);
+
+    a_specs = malloc((nspecs > 0 ? nspecs : 1) * sizeof(RemezSpec));
+    if (a_specs == NULL) {
+        PyErr_NoMemory();
+        goto fail;
+    }
+    for (ninit = 0; ninit < nspecs; ninit++) {
+        item = PySequence_Fast_GET_ITEM(seq, ninit);
+        if (!PyTuple_Check(item)) {
+            PyErr_SetString(PyExc_TypeError,
+                            "specs must be a sequence of tuples");
+            goto fail;
+        }
+        type = BANDPASS;
+        fs = 1.0;
+        maxiter = 25;
+        grid_density = 16;
+        if (!PyArg_ParseTuple(item, "iOOO|idii", &numtaps, &bands, &des,
+                              &weight, &type, &fs, &maxiter, &grid_density)) {
+            goto fail;
+        }
+        if (remez_spec_init(a_specs + ninit, numtaps, bands, des, weight,
+                            type, fs, maxiter, grid_density) < 0) {
             goto fail;
         }
     }
 
-    Py_DECREF(a_bands);
-    Py_DECREF(a_des);
-    Py_DECREF(a_weight);
+    NPY_BEGIN_THREADS;
+    st = remez_batch(a_specs, nspecs, workers);
+    NPY_END_THREADS;
+    if (st < 0) {
+        PyErr_NoMemory();
+        goto fail;
+    }
 
-	return PyArray_Return(h);
+    /* Report the first design that failed, in the order given */
+    for (k = 0; k < nspecs; k++) {
+        if (remez_spec_check(a_specs + k) < 0) goto fail;
+    }
+
+    out = PyList_New(nspecs);
+    if (out == NULL) goto fail;
+    for (k = 0; k < nspecs; k++) {
+        PyList_SET_ITEM(out, k, PyArray_Return(a_specs[k].h));
+        a_specs[k].h = NULL;
+    }
 
 fail:
-    Py_XDECREF(a_bands);
-    Py_XDECREF(a_des);
-    Py_XDECREF(a_weight);
-    Py_XDECREF(h);
-    return NULL;
+    for (k = 0; k < ninit; k++) remez_spec_clear(a_specs + k);
+    free(a_specs);
+    Py_DECREF(seq);
+    return out;
 }
 
-static char doc_median2d[] = "filt = _median2d(data, size)";
+static char doc_median2d[] = "filt = _median2d(data, size, workers=1)";
 
-extern void f_medfilt2(float*,float*,npy_intp*,npy_intp*);
-extern void d_medfilt2(double*,double*,npy_intp*,npy_intp*);
-extern void b_medfilt2(unsigned char*,unsigned char*,npy_intp*,npy_intp*);
+extern int f_medfilt2(float*,float*,npy_intp*,npy_intp*,int);
+extern int d_medfilt2(double*,double*,npy_intp*,npy_intp*,int);
+extern int b_medfilt2(unsigned char*,unsigned char*,npy_intp*,npy_intp*,int);
 
 static PyObject *sigtools_median2d(PyObject *NPY_UNUSED(dummy), PyObject *args)
 {
     PyObject *image=NULL, *size=NULL;
-    int typenum;
+    int typenum, workers = 1, st = 0;
     PyArrayObject *a_image=NULL, *a_size=NULL;
     PyArrayObject *a_out=NULL;
     npy_intp Nwin[2] = {3,3};
+    NPY_BEGIN_THREADS_DEF;
 
-    if (!PyArg_ParseTuple(args, "O|O", &image, &size)) return NULL;
+    if (!PyArg_ParseTuple(args, "O|Oi", &image, &size, &workers)) return NULL;
 
     typenum = PyArray_ObjectType(image, 0);
     a_image = (PyArrayObject *)PyArray_ContiguousFromObject(image, typenum, 2, 2);
@@ -1328,33 +1636,37 @@ static PyObject *sigtools_median2d(PyObject *NPY_UNUSED(dummy), PyObject *args)
 	Nwin[0] = ((npy_intp *)PyArray_DATA(a_size))[0];
 	Nwin[1] = ((npy_intp *)PyArray_DATA(a_size))[1];
     }  
+    if (Nwin[0] < 1 || Nwin[1] < 1)
+	PYERR("Size must be positive");
 
     a_out = (PyArrayObject *)PyArray_SimpleNew(2, PyArray_DIMS(a_image), typenum);
     if (a_out == NULL) goto fail;
 
-    if (setjmp(MALLOC_FAIL)) {
-	PYERR("Memory allocation error.");
+    if (typenum != NPY_UBYTE && typenum != NPY_FLOAT && typenum != NPY_DOUBLE)
+	PYERR("2D median filter only supports uint8, float32, and float64.");
+
+    NPY_BEGIN_THREADS;
+    switch (typenum) {
+    case NPY_UBYTE:
+	st = b_medfilt2((unsigned char *)PyArray_DATA(a_image),
+			(unsigned char *)PyArray_DATA(a_out),
+			Nwin, PyArray_DIMS(a_image), workers);
+	break;
+    case NPY_FLOAT:
+	st = f_medfilt2((float *)PyArray_DATA(a_image),
+			(float *)PyArray_DATA(a_out), Nwin,
+			PyArray_DIMS(a_image), workers);
+	break;
+    case NPY_DOUBLE:
+	st = d_medfilt2((double *)PyArray_DATA(a_image),
+			(double *)PyArray_DATA(a_out), Nwin,
+			PyArray_DIMS(a_image), workers);
+	break;
     }
-    else {
-	switch (typenum) {
-	case NPY_UBYTE:
-	    b_medfilt2((unsigned char *)PyArray_DATA(a_image),
-                       (unsigned char *)PyArray_DATA(a_out),
-                       Nwin, PyArray_DIMS(a_image));
-	    break;
-	case NPY_FLOAT:
-	    f_medfilt2((float *)PyArray_DATA(a_image),
-                       (float *)PyArray_DATA(a_out), Nwin,
-                       PyArray_DIMS(a_image));
-	    break;
-	case NPY_DOUBLE:
-	    d_medfilt2((double *)PyArray_DATA(a_image),
-                       (double *)PyArray_DATA(a_out), Nwin,
-                       PyArray_DIMS(a_image));
-	    break;
-	default:
-	  PYERR("2D median filter only supports uint8, float32, and float64.");
-	}
+    NPY_END_THREADS;
+    if (st) {
+	PyErr_NoMemory();
+	goto fail;
     }
 
     Py_DECREF(a_image);
@@ -1371,16 +1683,30 @@ static PyObject *sigtools_median2d(PyObject *NPY_UNUSED(dummy), PyObject *args)
 }
 
 static char doc_linear_filter[] =
-    "(y,Vf) = _linear_filter(b,a,X,Dim=-1,Vi=None)  " \
+    "(y,Vf) = _linear_filter(b,a,X,Dim=-1,Vi=None,workers=1)  " \
     "implemented using Direct Form II transposed flow " \
     "diagram. If Vi is not given, Vf is not returned.";
 
+static char doc_sos_filter[] =
+    "_sosfilt(sos,X,Zi,workers=1)  filters the rows of the C contiguous " \
+    "X in place with the second order sections sos, carrying the delays " \
+    "of shape (X.shape[0], len(sos), 2) in Zi, also in place.";
+
+static char doc_sos_filtfilt[] =
+    "_sosfiltfilt(sos,X,Zi,workers=1)  filters the rows of the C contiguous " \
+    "X forwards and backwards in place with the second order sections sos, " \
+    "each pass starting from the delays Zi, of shape (len(sos), 2), " \
+    "scaled by its first sample.";
+
 static struct PyMethodDef toolbox_module_methods[] = {
 	{"_correlateND", scipy_signal_sigtools_correlateND, METH_VARARGS, doc_correlateND},
 	{"_convolve2d", sigtools_convolve2d, METH_VARARGS, doc_convolve2d},
 	{"_order_filterND", sigtools_order_filterND, METH_VARARGS, doc_order_filterND},
 	{"_linear_filter", scipy_signal_sigtools_linear_filter, METH_VARARGS, doc_linear_filter},
+	{"_sosfilt", scipy_signal_sigtools_sos_filter, METH_VARARGS, doc_sos_filter},
+	{"_sosfiltfilt", scipy_signal_sigtools_sos_filtfilt, METH_VARARGS, doc_sos_filtfilt},
 	{"_remez",sigtools_remez, METH_VARARGS, doc_remez},
+	{"_remez_batch",sigtools_remez_batch, METH_VARARGS, doc_remez_batch},
 	{"_medfilt2d", sigtools_median2d, METH_VARARGS, doc_median2d},
 	{NULL, NULL, 0, NULL}		/* sentinel */
 };
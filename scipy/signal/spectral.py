@@ -5,6 +5,7 @@ from __future__ import division, print_function, absolute_import
 
 import numpy as np
 from scipy import fftpack
+from scipy.fft._pocketfft._isa import pypocketfft
 from . import signaltools
 from .windows import get_window
 from ._spectral import _lombscargle
@@ -14,7 +15,8 @@ import warnings
 from scipy._lib.six import string_types
 
 __all__ = ['periodogram', 'welch', 'lombscargle', 'csd', 'coherence',
-           'spectrogram', 'stft', 'istft', 'check_COLA', 'check_NOLA']
+           'spectrogram', 'stft', 'istft', 'check_COLA', 'check_NOLA',
+           'WelchEstimator']
 
 
 def lombscargle(x,
@@ -457,6 +459,198 @@ def welch(x, fs=1.0, window='hann', nperseg=None, noverlap=None, nfft=None,
     return freqs, Pxx.real
 
 
+class WelchEstimator(object):
+    """
+    Estimate the power spectral density of a signal that arrives in chunks,
+    using Welch's method.
+
+    The segments are taken from the signal as `welch` would take them from
+    the whole of it, and their periodograms are added up as they complete.
+    Only the samples of the next, incomplete segment are kept between
+    chunks, so the memory used is bounded by `nperseg` rather than by the
+    length of the signal.
+
+    Parameters
+    ----------
+    fs : float, optional
+        Sampling frequency of the signal. Defaults to 1.0.
+    window : str or tuple or array_like, optional
+        Desired window to use. See `welch` for details. Defaults to a Hann
+        window.
+    nperseg : int, optional
+        Length of each segment. Defaults to None, but if window is str or
+        tuple, is set to 256, and if window is array_like, is set to the
+        length of the window.
+    noverlap : int, optional
+        Number of points to overlap between segments. If `None`,
+        ``noverlap = nperseg // 2``. Defaults to `None`.
+    nfft : int, optional
+        Length of the FFT used, if a zero padded FFT is desired. If
+        `None`, the FFT length is `nperseg`. Defaults to `None`.
+    detrend : str or function or `False`, optional
+        Specifies how to detrend each segment. See `welch` for details.
+        Defaults to 'constant'.
+    return_onesided : bool, optional
+        If `True`, return a one-sided spectrum for real data. If
+        `False` return a two-sided spectrum. Defaults to `True`, but for
+        complex data, a two-sided spectrum is always returned.
+    scaling : { 'density', 'spectrum' }, optional
+        Selects between computing the power spectral density ('density')
+        and the power spectrum ('spectrum'). See `welch` for details.
+        Defaults to 'density'.
+    axis : int, optional
+        Axis of the chunks along which the signal runs; the default is
+        over the last axis (i.e. ``axis=-1``).
+
+    See Also
+    --------
+    welch : Estimate the power spectral density of a whole signal.
+
+    Notes
+    -----
+    All chunks of a signal must have the same shape, apart from their length
+    along `axis`. Whether the signal is complex, and the data type of the
+    estimate, are decided by the first chunk. The periodograms are averaged
+    by their mean; a median average would need all of them at once.
+
+    .. versionadded:: 1.4.0
+
+    Examples
+    --------
+    >>> from scipy import signal
+    >>> fs = 10e3
+    >>> x = np.random.randn(10 * int(fs))
+    >>> estimator = signal.WelchEstimator(fs, nperseg=1024)
+    >>> for i in range(0, len(x), int(fs)):
+    ...     estimator.process(x[i:i + int(fs)])
+    >>> f, Pxx = estimator.psd()
+    >>> np.allclose(Pxx, signal.welch(x, fs, nperseg=1024)[1])
+    True
+
+    """
+    def __init__(self, fs=1.0, window='hann', nperseg=None, noverlap=None,
+                 nfft=None, detrend='constant', return_onesided=True,
+                 scaling='density', axis=-1):
+        if nperseg is not None:
+            nperseg = int(nperseg)
+            if nperseg < 1:
+                raise ValueError('nperseg must be a positive integer')
+        win, nperseg = _triage_segments(window, nperseg,
+                                        input_length=np.inf)
+        if nfft is None:
+            nfft = nperseg
+        elif nfft < nperseg:
+            raise ValueError('nfft must be greater than or equal to nperseg.')
+        if noverlap is None:
+            noverlap = nperseg//2
+        elif noverlap >= nperseg:
+            raise ValueError('noverlap must be less than nperseg.')
+        if scaling == 'density':
+            scale = 1.0 / (fs * (win*win).sum())
+        elif scaling == 'spectrum':
+            scale = 1.0 / win.sum()**2
+        else:
+            raise ValueError('Unknown scaling: %r' % scaling)
+
+        self._fs = fs
+        self._win = win
+        self._nperseg = nperseg
+        self._nstep = nperseg - int(noverlap)
+        self._nfft = int(nfft)
+        self._detrend = detrend
+        self._detrend_func = _detrend_func(detrend, int(axis))
+        self._return_onesided = return_onesided
+        self._scale = scale
+        self._axis = int(axis)
+        self.reset()
+
+    def reset(self):
+        """Forget the signal so far, to start estimating a new one."""
+        self._tail = None
+        self._sides = None
+        self._dtype = None
+        self._sum = None
+        self._nseg = 0
+
+    def process(self, x):
+        """Add the segments that the next chunk of the signal completes.
+
+        Parameters
+        ----------
+        x : array_like
+            The next chunk of the signal.
+        """
+        x = np.asarray(x)
+        x = np.rollaxis(x, self._axis % x.ndim, x.ndim)
+        if self._tail is None:
+            if np.iscomplexobj(x):
+                self._sides = 'twosided'
+                if self._return_onesided:
+                    warnings.warn('Input data is complex, switching to '
+                                  'return_onesided=False')
+            elif self._return_onesided:
+                self._sides = 'onesided'
+            else:
+                self._sides = 'twosided'
+            self._dtype = np.finfo(np.result_type(x, np.complex64)).dtype
+            self._tail = x[..., :0]
+        elif self._tail.shape[:-1] != x.shape[:-1]:
+            raise ValueError("x must have the shape of the previous chunks, "
+                             "apart from along axis.")
+        elif self._sides == 'onesided' and np.iscomplexobj(x):
+            raise ValueError("x must be real, like the previous chunks.")
+
+        x = np.concatenate((self._tail, x), axis=-1)
+        nseg = max((x.shape[-1] - self._nperseg) // self._nstep + 1, 0)
+        if nseg > 0:
+            end = (nseg - 1) * self._nstep + self._nperseg
+            power = self._power_sum(x[..., :end])
+            self._sum = power if self._sum is None else self._sum + power
+            self._nseg += nseg
+        # Keep a copy, so that the chunk itself is not held on to
+        self._tail = x[..., nseg * self._nstep:].copy()
+
+    def psd(self):
+        """Return the estimate from the complete segments so far.
+
+        Returns
+        -------
+        f : ndarray
+            Array of sample frequencies.
+        Pxx : ndarray
+            Power spectral density or power spectrum of the signal so far.
+        """
+        if self._nseg == 0:
+            raise ValueError("No complete segment has been processed yet.")
+        if self._sides == 'onesided':
+            freqs = np.fft.rfftfreq(self._nfft, 1/self._fs)
+        else:
+            freqs = fftpack.fftfreq(self._nfft, 1/self._fs)
+        Pxx = self._sum * (self._scale / self._nseg)
+        Pxx = np.rollaxis(Pxx, -1, self._axis % Pxx.ndim)
+        return freqs, Pxx.astype(self._dtype)
+
+    def _power_sum(self, x):
+        # The sum of the doubled one-sided or the two-sided periodograms of
+        # the segments of x, unscaled
+        if self._sides == 'onesided':
+            result = _segment_spectra(x, self._win, self._nstep, self._nfft,
+                                      self._detrend, 'power_sum')
+            if result is not None:
+                return result
+        result = _fft_helper(x, self._win, self._detrend_func,
+                             self._nperseg, self._nperseg - self._nstep,
+                             self._nfft, self._sides)
+        result = (np.conjugate(result) * result).real.sum(axis=-2)
+        if self._sides == 'onesided':
+            if self._nfft % 2:
+                result[..., 1:] *= 2
+            else:
+                # Last point is unpaired Nyquist freq point, don't double
+                result[..., 1:-1] *= 2
+        return result
+
+
 def csd(x, y, fs=1.0, window='hann', nperseg=None, noverlap=None, nfft=None,
         detrend='constant', return_onesided=True, scaling='density',
         axis=-1, average='mean'):
@@ -583,7 +777,7 @@ def csd(x, y, fs=1.0, window='hann', nperseg=None, noverlap=None, nfft=None,
 
     freqs, _, Pxy = _spectral_helper(x, y, fs, window, nperseg, noverlap, nfft,
                                      detrend, return_onesided, scaling, axis,
-                                     mode='psd')
+                                     mode='psd', mean=(average == 'mean'))
 
     # Average over windows.
     if len(Pxy.shape) >= 2 and Pxy.size > 0:
@@ -1582,7 +1776,7 @@ def coherence(x, y, fs=1.0, window='hann', nperseg=None, noverlap=None,
 def _spectral_helper(x, y, fs=1.0, window='hann', nperseg=None, noverlap=None,
                      nfft=None, detrend='constant', return_onesided=True,
                      scaling='density', axis=-1, mode='psd', boundary=None,
-                     padded=False):
+                     padded=False, mean=False):
     """
     Calculate various forms of windowed FFTs for PSD, CSD, etc.
 
@@ -1654,6 +1848,10 @@ def _spectral_helper(x, y, fs=1.0, window='hann', nperseg=None, noverlap=None,
         segments, so that all of the signal is included in the output.
         Defaults to `False`. Padding occurs after boundary extension, if
         `boundary` is not `None`, and `padded` is `True`.
+    mean : bool, optional
+        If `True` and `mode` is 'psd', the result may instead hold the mean
+        over the segments, as a single segment. Defaults to `False`.
+
     Returns
     -------
     freqs : ndarray
@@ -1783,21 +1981,7 @@ def _spectral_helper(x, y, fs=1.0, window='hann', nperseg=None, noverlap=None,
             y = np.concatenate((y, np.zeros(zeros_shape)), axis=-1)
 
     # Handle detrending and window functions
-    if not detrend:
-        def detrend_func(d):
-            return d
-    elif not hasattr(detrend, '__call__'):
-        def detrend_func(d):
-            return signaltools.detrend(d, type=detrend, axis=-1)
-    elif axis != -1:
-        # Wrap this function so that it receives a shape that it could
-        # reasonably expect to receive.
-        def detrend_func(d):
-            d = np.rollaxis(d, -1, axis)
-            d = detrend(d)
-            return np.rollaxis(d, axis, len(d.shape))
-    else:
-        detrend_func = detrend
+    detrend_func = _detrend_func(detrend, axis)
 
     if np.result_type(win, np.complex64) != outdtype:
         win = win.astype(outdtype)
@@ -1832,35 +2016,63 @@ def _spectral_helper(x, y, fs=1.0, window='hann', nperseg=None, noverlap=None,
     elif sides == 'onesided':
         freqs = np.fft.rfftfreq(nfft, 1/fs)
 
-    # Perform the windowed FFTs
-    result = _fft_helper(x, win, detrend_func, nperseg, noverlap, nfft, sides)
-
-    if not same_data:
-        # All the same operations on the y data
-        result_y = _fft_helper(y, win, detrend_func, nperseg, noverlap, nfft,
-                               sides)
-        result = np.conjugate(result) * result_y
-    elif mode == 'psd':
-        result = np.conjugate(result) * result
-
-    result *= scale
-    if sides == 'onesided' and mode == 'psd':
-        if nfft % 2:
-            result[..., 1:] *= 2
+    # Perform the windowed FFTs. pypocketfft computes the one-sided spectra
+    # of real data, or the scaled power of a single input, in one pass over
+    # the segments.
+    result = None
+    scaled = False
+    if sides == 'onesided' and same_data:
+        if mode == 'stft':
+            result = _segment_spectra(x, win, nstep, nfft, detrend, 'spectra',
+                                      scale)
+        elif mean:
+            result = _segment_spectra(x, win, nstep, nfft, detrend,
+                                      'power_sum', scale)
+            if result is not None:
+                result /= (x.shape[-1] - nperseg) // nstep + 1
+                result = result[..., np.newaxis, :]
         else:
-            # Last point is unpaired Nyquist freq point, don't double
-            result[..., 1:-1] *= 2
+            result = _segment_spectra(x, win, nstep, nfft, detrend, 'power',
+                                      scale)
+        scaled = result is not None
+    elif sides == 'onesided':
+        result = _segment_spectra(x, win, nstep, nfft, detrend, 'spectra')
+        if result is not None:
+            result_y = _segment_spectra(y, win, nstep, nfft, detrend,
+                                        'spectra')
+            result = None if result_y is None else (np.conjugate(result) *
+                                                    result_y)
+
+    if result is None:
+        result = _fft_helper(x, win, detrend_func, nperseg, noverlap, nfft,
+                             sides)
+        if not same_data:
+            # All the same operations on the y data
+            result_y = _fft_helper(y, win, detrend_func, nperseg, noverlap,
+                                   nfft, sides)
+            result = np.conjugate(result) * result_y
+        elif mode == 'psd':
+            result = np.conjugate(result) * result
+
+    if not scaled:
+        result *= scale
+        if sides == 'onesided' and mode == 'psd':
+            if nfft % 2:
+                result[..., 1:] *= 2
+            else:
+                # Last point is unpaired Nyquist freq point, don't double
+                result[..., 1:-1] *= 2
 
     time = np.arange(nperseg/2, x.shape[-1] - nperseg/2 + 1,
                      nperseg - noverlap)/float(fs)
     if boundary is not None:
         time -= (nperseg/2) / fs
 
-    result = result.astype(outdtype)
-
     # All imaginary parts are zero anyways
     if same_data and mode != 'stft':
-        result = result.real
+        result = result.real.astype(np.finfo(outdtype).dtype, copy=False)
+    else:
+        result = result.astype(outdtype, copy=False)
 
     # Output is going to have new last axis for time/window index, so a
     # negative axis index shifts down one
@@ -1923,6 +2135,62 @@ def _fft_helper(x, win, detrend_func, nperseg, noverlap, nfft, sides):
     return result
 
 
+def _detrend_func(detrend, axis):
+    """
+    Turn the `detrend` argument of `_spectral_helper` into a function that
+    detrends segments along the last axis, for data whose segments were
+    taken along `axis`.
+    """
+    if not detrend:
+        def detrend_func(d):
+            return d
+    elif not hasattr(detrend, '__call__'):
+        def detrend_func(d):
+            return signaltools.detrend(d, type=detrend, axis=-1)
+    elif axis != -1:
+        # Wrap this function so that it receives a shape that it could
+        # reasonably expect to receive.
+        def detrend_func(d):
+            d = np.rollaxis(d, -1, axis)
+            d = detrend(d)
+            return np.rollaxis(d, axis, len(d.shape))
+    else:
+        detrend_func = detrend
+    return detrend_func
+
+
+# The detrend types of _spectral_helper that pypocketfft applies itself
+_segment_detrend = {'constant': 1, 'c': 1, 'linear': 2, 'l': 2}
+
+
+def _segment_spectra(x, win, nstep, nfft, detrend, mode, scale=1.0):
+    """
+    Calculate the one-sided windowed FFTs of the segments of `x` with
+    pypocketfft, for internal use by scipy.signal._spectral_helper
+
+    Each segment is detrended, windowed, zero-padded and transformed in one
+    buffer, and `mode` is passed on to ``pypocketfft.segment_spectra``. The
+    data axis is assumed to be the last axis of x. Returns None if `x`, `win`
+    or `detrend` are not supported, in which case `_fft_helper` is needed.
+    """
+    if not detrend:
+        detrend_code = 0
+    elif isinstance(detrend, string_types) and detrend in _segment_detrend:
+        detrend_code = _segment_detrend[detrend]
+    else:
+        return None
+    if x.dtype.kind not in 'biuf' or x.dtype.itemsize > 8:
+        return None
+    if np.iscomplexobj(win):
+        if win.imag.any():
+            return None
+        win = win.real
+    if x.dtype not in (np.float32, np.float64):
+        x = x.astype(np.float64)
+    return pypocketfft.segment_spectra(x, win, nstep, nfft, detrend_code,
+                                       mode, scale)
+
+
 def _triage_segments(window, nperseg, input_length):
     """
     Parses window and nperseg arguments for spectrogram and _spectral_helper.
@@ -7,14 +7,14 @@
 
 static void convert_strides(npy_intp*,npy_intp*,int,int);
 
-extern int S_cubic_spline2D(float*,float*,int,int,double,npy_intp*,npy_intp*,float);
-extern int S_quadratic_spline2D(float*,float*,int,int,double,npy_intp*,npy_intp*,float);
+extern int S_cubic_spline2D(float*,float*,npy_intp,int,int,double,npy_intp*,npy_intp*,float,int);
+extern int S_quadratic_spline2D(float*,float*,npy_intp,int,int,double,npy_intp*,npy_intp*,float,int);
 extern int S_IIR_forback1(float,float,float*,float*,int,int,int,float);
 extern int S_IIR_forback2(double,double,float*,float*,int,int,int,float); 
 extern int S_separable_2Dconvolve_mirror(float*,float*,int,int,float*,float*,int,int,npy_intp*,npy_intp*);
 
-extern int D_cubic_spline2D(double*,double*,int,int,double,npy_intp*,npy_intp*,double);
-extern int D_quadratic_spline2D(double*,double*,int,int,double,npy_intp*,npy_intp*,double);
+extern int D_cubic_spline2D(double*,double*,npy_intp,int,int,double,npy_intp*,npy_intp*,double,int);
+extern int D_quadratic_spline2D(double*,double*,npy_intp,int,int,double,npy_intp*,npy_intp*,double,int);
 extern int D_IIR_forback1(double,double,double*,double*,int,int,int,double);
 extern int D_IIR_forback2(double,double,double*,double*,int,int,int,double); 
 extern int D_separable_2Dconvolve_mirror(double*,double*,int,int,double*,double*,int,int,npy_intp*,npy_intp*);
@@ -43,7 +43,7 @@ convert_strides(npy_intp* instrides,npy_intp* convstrides,int size,int N)
 }
 
 
-static char doc_cspline2d[] = "cspline2d(input {, lambda, precision}) -> ck\n"
+static char doc_cspline2d[] = "cspline2d(input {, lambda, precision, workers}) -> ck\n"
 "\n"
 "  Description:\n"
 "\n"
@@ -51,47 +51,68 @@ static char doc_cspline2d[] = "cspline2d(input {, lambda, precision}) -> ck\n"
 "    input grid for the two-dimensional input image.  The lambda argument\n" 
 "    specifies the amount of smoothing.  The precision argument allows specifying\n"
 "    the precision used when computing the infinite sum needed to apply mirror-\n"
-"    symmetric boundary conditions.\n";
+"    symmetric boundary conditions.  A three-dimensional input is a stack of\n"
+"    images, and the coefficients of each input[i] are returned in ck[i].\n"
+"    The rows and columns are filtered on up to workers threads (default 1).\n";
 
  
-static PyObject *cspline2d(PyObject *NPY_UNUSED(dummy), PyObject *args)
+static PyObject *cspline2d(PyObject *NPY_UNUSED(dummy), PyObject *args, PyObject *kwds)
 {
+  static char *kwlist[] = {"input", "lambda", "precision", "workers", NULL};
   PyObject *image=NULL;
   PyArrayObject *a_image=NULL, *ck=NULL;
   double lambda = 0.0;
   double precision = -1.0;
-  int thetype, M, N, retval=0;
-  npy_intp outstrides[2], instrides[2];
+  int thetype, M, N, nd, workers = 1, retval=0;
+  npy_intp nimages, outstrides[3], instrides[3];
+  NPY_BEGIN_THREADS_DEF;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|ddi", kwlist, &image,
+                                   &lambda, &precision, &workers))
+    return NULL;
 
-  if (!PyArg_ParseTuple(args, "O|dd", &image, &lambda, &precision)) return NULL;
+  if (workers < 1) PYERR("workers must be a positive integer.");
 
   thetype = PyArray_ObjectType(image, NPY_FLOAT);
   thetype = PyArray_MIN(thetype, NPY_DOUBLE);
-  a_image = (PyArrayObject *)PyArray_FromObject(image, thetype, 2, 2);
+  a_image = (PyArrayObject *)PyArray_FromObject(image, thetype, 2, 3);
   if (a_image == NULL) goto fail;
  
-  ck = (PyArrayObject *)PyArray_SimpleNew(2, PyArray_DIMS(a_image), thetype);
+  nd = PyArray_NDIM(a_image);
+  ck = (PyArrayObject *)PyArray_SimpleNew(nd, PyArray_DIMS(a_image), thetype);
   if (ck == NULL) goto fail;
-  M = PyArray_DIMS(a_image)[0];
-  N = PyArray_DIMS(a_image)[1];
-
-  convert_strides(PyArray_STRIDES(a_image), instrides, PyArray_ITEMSIZE(a_image), 2);
-  outstrides[0] = N;
-  outstrides[1] = 1;
-
+  nimages = (nd == 3) ? PyArray_DIMS(a_image)[0] : 1;
+  M = PyArray_DIMS(a_image)[nd-2];
+  N = PyArray_DIMS(a_image)[nd-1];
+
+  instrides[0] = 0;
+  convert_strides(PyArray_STRIDES(a_image), instrides + 3 - nd,
+                  PyArray_ITEMSIZE(a_image), nd);
+  outstrides[0] = (npy_intp)M * N;
+  outstrides[1] = N;
+  outstrides[2] = 1;
+
+  NPY_BEGIN_THREADS;
   if (thetype == NPY_FLOAT) {
     if ((precision <= 0.0) || (precision > 1.0)) precision = 1e-3;
     retval = S_cubic_spline2D((float *)PyArray_DATA(a_image),
-                              (float *)PyArray_DATA(ck),
-                              M, N, lambda, instrides, outstrides, precision);
+                              (float *)PyArray_DATA(ck), nimages,
+                              M, N, lambda, instrides, outstrides, precision,
+                              workers);
   }
   else if (thetype == NPY_DOUBLE) {
     if ((precision <= 0.0) || (precision > 1.0)) precision = 1e-6;
     retval = D_cubic_spline2D((double *)PyArray_DATA(a_image),
-                              (double *)PyArray_DATA(ck),
-                              M, N, lambda, instrides, outstrides, precision);
+                              (double *)PyArray_DATA(ck), nimages,
+                              M, N, lambda, instrides, outstrides, precision,
+                              workers);
   }
+  NPY_END_THREADS;
 
+  if (retval == -1) {
+    PyErr_NoMemory();
+    goto fail;
+  }
   if (retval == -3) PYERR("Precision too high.  Error did not converge.");
   if (retval < 0) PYERR("Problem occurred inside routine");
 
@@ -105,56 +126,78 @@ static PyObject *cspline2d(PyObject *NPY_UNUSED(dummy), PyObject *args)
 
 }
 
-static char doc_qspline2d[] = "qspline2d(input {, lambda, precision}) -> qk\n"
+static char doc_qspline2d[] = "qspline2d(input {, lambda, precision, workers}) -> qk\n"
 "\n"
 "  Description:\n"
 "\n"
-"    Return the second-order B-spline coefficients over a regularly spaced\n"
+"    Return the second-order B-spline coefficients over a regularly spaced\n" 
 "    input grid for the two-dimensional input image.  The lambda argument\n" 
 "    specifies the amount of smoothing.  The precision argument allows specifying\n"
 "    the precision used when computing the infinite sum needed to apply mirror-\n"
-"    symmetric boundary conditions.\n";
+"    symmetric boundary conditions.  A three-dimensional input is a stack of\n"
+"    images, and the coefficients of each input[i] are returned in qk[i].\n"
+"    The rows and columns are filtered on up to workers threads (default 1).\n";
+
  
-static PyObject *qspline2d(PyObject *NPY_UNUSED(dummy), PyObject *args)
+static PyObject *qspline2d(PyObject *NPY_UNUSED(dummy), PyObject *args, PyObject *kwds)
 {
+  static char *kwlist[] = {"input", "lambda", "precision", "workers", NULL};
   PyObject *image=NULL;
   PyArrayObject *a_image=NULL, *ck=NULL;
   double lambda = 0.0;
   double precision = -1.0;
-  int thetype, M, N, retval=0;
-  npy_intp outstrides[2], instrides[2];
+  int thetype, M, N, nd, workers = 1, retval=0;
+  npy_intp nimages, outstrides[3], instrides[3];
+  NPY_BEGIN_THREADS_DEF;
 
-  if (!PyArg_ParseTuple(args, "O|dd", &image, &lambda, &precision)) return NULL;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|ddi", kwlist, &image,
+                                   &lambda, &precision, &workers))
+    return NULL;
 
   if (lambda != 0.0) PYERR("Smoothing spline not yet implemented.");
 
+  if (workers < 1) PYERR("workers must be a positive integer.");
+
   thetype = PyArray_ObjectType(image, NPY_FLOAT);
   thetype = PyArray_MIN(thetype, NPY_DOUBLE);
-  a_image = (PyArrayObject *)PyArray_FromObject(image, thetype, 2, 2);
+  a_image = (PyArrayObject *)PyArray_FromObject(image, thetype, 2, 3);
   if (a_image == NULL) goto fail;
  
-  ck = (PyArrayObject *)PyArray_SimpleNew(2, PyArray_DIMS(a_image), thetype);
+  nd = PyArray_NDIM(a_image);
+  ck = (PyArrayObject *)PyArray_SimpleNew(nd, PyArray_DIMS(a_image), thetype);
   if (ck == NULL) goto fail;
-  M = PyArray_DIMS(a_image)[0];
-  N = PyArray_DIMS(a_image)[1];
-
-  convert_strides(PyArray_STRIDES(a_image), instrides, PyArray_ITEMSIZE(a_image), 2);
-  outstrides[0] = N;
-  outstrides[1] = 1;
-
+  nimages = (nd == 3) ? PyArray_DIMS(a_image)[0] : 1;
+  M = PyArray_DIMS(a_image)[nd-2];
+  N = PyArray_DIMS(a_image)[nd-1];
+
+  instrides[0] = 0;
+  convert_strides(PyArray_STRIDES(a_image), instrides + 3 - nd,
+                  PyArray_ITEMSIZE(a_image), nd);
+  outstrides[0] = (npy_intp)M * N;
+  outstrides[1] = N;
+  outstrides[2] = 1;
+
+  NPY_BEGIN_THREADS;
   if (thetype == NPY_FLOAT) {
     if ((precision <= 0.0) || (precision > 1.0)) precision = 1e-3;
     retval = S_quadratic_spline2D((float *)PyArray_DATA(a_image),
-                                  (float *)PyArray_DATA(ck),
-                                  M, N, lambda, instrides, outstrides, precision);
+                              (float *)PyArray_DATA(ck), nimages,
+                              M, N, lambda, instrides, outstrides, precision,
+                              workers);
   }
   else if (thetype == NPY_DOUBLE) {
     if ((precision <= 0.0) || (precision > 1.0)) precision = 1e-6;
     retval = D_quadratic_spline2D((double *)PyArray_DATA(a_image),
-                                  (double *)PyArray_DATA(ck),
-                                  M, N, lambda, instrides, outstrides, precision);
+                              (double *)PyArray_DATA(ck), nimages,
+                              M, N, lambda, instrides, outstrides, precision,
+                              workers);
   }
+  NPY_END_THREADS;
 
+  if (retval == -1) {
+    PyErr_NoMemory();
+    goto fail;
+  }
   if (retval == -3) PYERR("Precision too high.  Error did not converge.");
   if (retval < 0) PYERR("Problem occurred inside routine");
 
@@ -466,8 +509,10 @@ static PyObject *IIRsymorder2(PyObject *NPY_UNUSED(dummy), PyObject *args)
 
 
 static struct PyMethodDef toolbox_module_methods[] = {
-    {"cspline2d", cspline2d, METH_VARARGS, doc_cspline2d},
-    {"qspline2d", qspline2d, METH_VARARGS, doc_qspline2d},
+    {"cspline2d", (PyCFunction)cspline2d, METH_VARARGS | METH_KEYWORDS,
+     doc_cspline2d},
+    {"qspline2d", (PyCFunction)qspline2d, METH_VARARGS | METH_KEYWORDS,
+     doc_qspline2d},
     {"sepfir2d", FIRsepsym2d, METH_VARARGS, doc_FIRsepsym2d},
     {"symiirorder1", IIRsymorder1, METH_VARARGS, doc_IIRsymorder1},
     {"symiirorder2", IIRsymorder2, METH_VARARGS, doc_IIRsymorder2}, 
@@ -222,3 +222,26 @@ class TestBSplines(object):
                       7.32718426, 7.874, 7.81016848, 7.433, 7.03980488, 6.759,
                       6.71900226, 6.203, 4.49418159])
         assert_allclose(bsp.qspline1d_eval(cj, newx, dx=dx, x0=x[0]), newy)
+
+    def test_spline2d_stack(self):
+        from scipy.signal import cspline2d, qspline2d
+        np.random.seed(12466)
+        for dtype in (np.float32, np.float64):
+            images = np.random.rand(3, 96, 80).astype(dtype)
+            for func, lmbda in ((cspline2d, 0.0), (cspline2d, 2.0),
+                                (qspline2d, 0.0)):
+                ck = func(images, lmbda)
+                assert_equal(ck.dtype, dtype)
+                for image, expected in zip(images, ck):
+                    assert_array_equal(func(image, lmbda), expected)
+                # Whole images, or the rows and columns of one, per thread
+                assert_array_equal(func(images, lmbda, workers=4), ck)
+                assert_array_equal(func(images[0], lmbda, workers=4), ck[0])
+                assert_array_equal(func(images.transpose(0, 2, 1), lmbda,
+                                        workers=2),
+                                   func(images.transpose(0, 2, 1).copy(),
+                                        lmbda))
+        raises(ValueError, cspline2d, images, workers=0)
+        raises(ValueError, cspline2d, np.ones(5))
+        # Starting values that do not converge within a short row
+        raises(ValueError, cspline2d, np.ones((100, 3)), 100.0)
@@ -2,7 +2,7 @@ from __future__ import division, print_function, absolute_import
 
 import numpy as np
 from numpy.testing import (assert_almost_equal, assert_array_almost_equal,
-                           assert_equal, assert_,
+                           assert_equal, assert_array_equal, assert_,
                            assert_allclose, assert_warns)
 from pytest import raises as assert_raises
 import pytest
@@ -10,7 +10,7 @@ import pytest
 from scipy.linalg import LinAlgWarning
 from scipy.special import sinc
 from scipy.signal import kaiser_beta, kaiser_atten, kaiserord, \
-        firwin, firwin2, freqz, remez, firls, minimum_phase
+        firwin, firwin2, freqz, remez, remez_batch, firls, minimum_phase
 
 
 def test_kaiser_beta():
@@ -447,6 +447,34 @@ class TestRemez(object):
         assert_allclose(remez(21, [0, 0.8, 0.9, 1], [0, 1], Hz=2.), h)
         assert_allclose(remez(21, [0, 0.8, 0.9, 1], [0, 1], fs=2.), h)
 
+    def test_workers(self):
+        # Large enough for the dense grid to be evaluated on threads
+        bands = [0, 0.1, 0.12, 0.3, 0.32, 0.5]
+        h = remez(400, bands, [0, 1, 0])
+        assert_array_equal(remez(400, bands, [0, 1, 0], workers=4), h)
+        assert_array_equal(remez(400, bands, [0, 1, 0], workers=-1), h)
+        assert_raises(ValueError, remez, 400, bands, [0, 1, 0], workers=0)
+
+    def test_batch(self):
+        specs = [dict(numtaps=12, bands=[0, 0.3, 0.5, 1], desired=[1, 0],
+                      fs=2.),
+                 dict(numtaps=11, bands=[0.1, 0.4], desired=[1],
+                      type='hilbert'),
+                 dict(numtaps=400, bands=[0, 0.1, 0.12, 0.3, 0.32, 0.5],
+                      desired=[0, 1, 0], weight=[1, 2, 1])]
+        for workers in (1, 2, 8):
+            hs = remez_batch(specs, workers=workers)
+            assert_equal(len(hs), len(specs))
+            for spec, h in zip(specs, hs):
+                assert_array_equal(h, remez(**spec))
+        assert_equal(remez_batch([]), [])
+        specs.append(dict(numtaps=11, bands=[0.1, 0.4], desired=[1],
+                          type='pooka'))
+        assert_raises(ValueError, remez_batch, specs)
+        specs[-1] = dict(numtaps=11, bands=[0.1, 0.4, 0.3, 0.5],
+                         desired=[1, 0])
+        assert_raises(ValueError, remez_batch, specs, workers=2)
+
 
 class TestFirls(object):
 
@@ -20,10 +20,15 @@ from scipy.signal._peak_finding import (
     peak_widths,
     _unpack_condition_args,
     find_peaks,
+    find_peaks_batch,
     find_peaks_cwt,
     _identify_ridge_lines
 )
-from scipy.signal._peak_finding_utils import _local_maxima_1d, PeakPropertyWarning
+from scipy.signal._peak_finding_utils import (
+    _local_maxima_1d,
+    _select_by_peak_distance,
+    PeakPropertyWarning
+)
 
 
 def _gen_gaussians(center_locs, sigmas, total_length):
@@ -773,6 +778,129 @@ class TestFindPeaks(object):
             assert_equal(props[key], peaks)
 
 
+def find_peaks_stepwise(x, height=None, threshold=None, distance=None,
+                        prominence=None, width=None, wlen=None, rel_height=0.5,
+                        plateau_size=None):
+    """
+    Select peaks condition by condition, each over all remaining peaks, as
+    `find_peaks` is specified to.
+    """
+    x = np.asarray(x, dtype=np.float64)
+    peaks, left_edges, right_edges = _local_maxima_1d(x)
+    props = {}
+
+    def select(values, interval):
+        imin, imax = _unpack_condition_args(interval, x, peaks)
+        keep = np.ones(peaks.size, dtype=bool)
+        if imin is not None:
+            keep &= imin <= values
+        if imax is not None:
+            keep &= values <= imax
+        return keep
+
+    def apply(keep):
+        return peaks[keep], {key: value[keep] for key, value in props.items()}
+
+    if plateau_size is not None:
+        props.update(plateau_sizes=right_edges - left_edges + 1,
+                     left_edges=left_edges, right_edges=right_edges)
+        peaks, props = apply(select(props['plateau_sizes'], plateau_size))
+    if height is not None:
+        props['peak_heights'] = x[peaks]
+        peaks, props = apply(select(x[peaks], height))
+    if threshold is not None:
+        props['left_thresholds'] = x[peaks] - x[peaks - 1]
+        props['right_thresholds'] = x[peaks] - x[peaks + 1]
+        stacked = np.vstack([props['left_thresholds'],
+                             props['right_thresholds']])
+        imin, imax = _unpack_condition_args(threshold, x, peaks)
+        keep = np.ones(peaks.size, dtype=bool)
+        if imin is not None:
+            keep &= imin <= stacked.min(axis=0)
+        if imax is not None:
+            keep &= stacked.max(axis=0) <= imax
+        peaks, props = apply(keep)
+    if distance is not None:
+        peaks, props = apply(_select_by_peak_distance(peaks, x[peaks],
+                                                      distance))
+    if prominence is not None or width is not None:
+        props.update(zip(['prominences', 'left_bases', 'right_bases'],
+                         peak_prominences(x, peaks, wlen)))
+    if prominence is not None:
+        peaks, props = apply(select(props['prominences'], prominence))
+    if width is not None:
+        props.update(zip(['widths', 'width_heights', 'left_ips', 'right_ips'],
+                         peak_widths(x, peaks, rel_height,
+                                     (props['prominences'],
+                                      props['left_bases'],
+                                      props['right_bases']))))
+        peaks, props = apply(select(props['widths'], width))
+    return peaks, props
+
+
+@pytest.mark.filterwarnings("ignore:some peaks have a prominence of 0",
+                            "ignore:some peaks have a width of 0")
+class TestFindPeaksFused(object):
+
+    def conditions(self, x):
+        np.random.seed(1234)
+        border = np.abs(np.random.randn(x.size))
+        yield {}
+        yield dict(height=(None, None), threshold=(None, None),
+                   prominence=(None, None), width=(None, None),
+                   plateau_size=(None, None))
+        yield dict(height=0.5, distance=5)
+        yield dict(height=(-border, border), threshold=(0.1, 3))
+        yield dict(plateau_size=(2, None), prominence=1)
+        yield dict(threshold=(None, border), distance=2.5,
+                   prominence=(0.5, 3 * border), wlen=31)
+        yield dict(prominence=(None, 2), width=(2, 20), rel_height=0.8)
+        yield dict(height=0, width=border * 10, wlen=11, rel_height=1.)
+
+    @pytest.mark.parametrize('plateaus', [False, True])
+    def test_stepwise(self, plateaus):
+        np.random.seed(4321)
+        x = np.cumsum(np.random.randn(5000))
+        if plateaus:
+            x = np.round(x)
+        for kwargs in self.conditions(x):
+            peaks, props = find_peaks(x, **kwargs)
+            peaks_true, props_true = find_peaks_stepwise(x, **kwargs)
+            assert_equal(peaks, peaks_true)
+            assert_equal(sorted(props), sorted(props_true))
+            for key in props:
+                assert_equal(props[key], props_true[key])
+                assert_equal(props[key].dtype, props_true[key].dtype)
+
+    def test_batch(self):
+        np.random.seed(4321)
+        x = np.round(np.cumsum(np.random.randn(7, 1000), axis=1))
+        for kwargs in self.conditions(x[0]):
+            for workers in (1, 3, -1):
+                peaks, props = find_peaks_batch(x, workers=workers, **kwargs)
+                assert_equal(len(peaks), x.shape[0])
+                assert_equal(len(props), x.shape[0])
+                for row in range(x.shape[0]):
+                    peaks_true, props_true = find_peaks(x[row], **kwargs)
+                    assert_equal(peaks[row], peaks_true)
+                    assert_equal(sorted(props[row]), sorted(props_true))
+                    for key in props_true:
+                        assert_equal(props[row][key], props_true[key])
+        assert_equal(find_peaks_batch(np.empty((0, 10))), ([], []))
+
+    def test_batch_raises(self):
+        with raises(ValueError, match="2D array"):
+            find_peaks_batch(np.ones(10))
+        with raises(ValueError, match="array size of lower"):
+            find_peaks_batch(np.ones((2, 10)), height=np.ones(20))
+        with raises(ValueError, match="distance"):
+            find_peaks_batch(np.ones((2, 10)), distance=0)
+        with raises(ValueError, match="rel_height"):
+            find_peaks_batch(np.ones((2, 10)), width=1, rel_height=-1)
+        with raises(ValueError):
+            find_peaks_batch(np.ones((2, 10)), workers=0)
+
+
 class TestFindPeaksCwt(object):
 
     def test_find_peaks_exact(self):
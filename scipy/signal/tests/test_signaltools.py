@@ -824,6 +824,26 @@ class TestMedFilt(object):
                                [0, 7, 11, 7, 4, 4, 19, 19, 24, 0]])
         assert_array_equal(d, e)
 
+    @pytest.mark.parametrize('dtype', [np.uint8, np.float32, np.float64])
+    def test_sliding_window(self, dtype):
+        # The sliding windows of medfilt2d against the per-point selection
+        # that medfilt still does for int64
+        np.random.seed(1234)
+        x = np.random.randint(0, 100, size=(37, 251))
+
+        expected = signal.medfilt(x[0], 101)
+        assert_array_equal(signal.medfilt(x[0].astype(dtype), 101), expected)
+
+        expected = signal.medfilt(x, [5, 21])
+        for workers in [None, 3, -1]:
+            y = signal.medfilt2d(x.astype(dtype), [5, 21], workers=workers)
+            assert_equal(y.dtype, dtype)
+            assert_array_equal(y, expected)
+
+        # Windows larger than the array are all zero padding at the edges
+        assert_array_equal(signal.medfilt2d(x[:3, :4].astype(dtype), 9),
+                           signal.medfilt(x[:3, :4], 9))
+
     def test_none(self):
         # Ticket #1124. Ensure this does not segfault.
         signal.medfilt(None)
@@ -914,6 +934,28 @@ class TestResample(object):
         y = signal.resample_poly(x, 1, 2, window=h)
         assert_(y.dtype == np.float32)
 
+    @pytest.mark.parametrize('up, down', [(441, 480), (3, 2), (1, 7), (5, 5)])
+    @pytest.mark.parametrize('axis', [0, -1])
+    def test_polyphase_stream(self, up, down, axis):
+        # Chunks resampled one after the other, as a whole signal would be
+        np.random.seed(1234)
+        x = np.random.randn(3, 2000)
+        if axis == 0:
+            x = x.T
+        expected = signal.resample_poly(x, up, down, axis=axis)
+        assert_allclose(signal.resample_poly(x, up, down, axis=axis,
+                                             workers=2), expected)
+
+        resampler = signal.ResamplePoly(up, down, axis=axis, workers=-1)
+        for cuts in [[0, 1, 700, 703, 2000], [0, 2000], [0, 5, 2000]]:
+            chunks = [resampler.process(np.take(x, range(a, b), axis=axis))
+                      for a, b in zip(cuts[:-1], cuts[1:])]
+            y = np.concatenate(chunks + [resampler.flush()], axis=axis)
+            assert_allclose(y, expected, atol=1e-12)
+
+        resampler.process(np.ones((4, 4)))
+        assert_raises(ValueError, resampler.process, np.ones((5, 5)))
+
     def _test_data(self, method, ext=False):
         # Test resampling of sinusoids and random noise (1-sec)
         rate = 100
@@ -1445,6 +1487,21 @@ class _TestLinearFilter(object):
         assert_equal(b, b0)
         assert_equal(a, a0)
 
+    def test_lines_side_by_side(self):
+        # Real lines are filtered several at a time; every line, including
+        # those that do not fill a group, must match filtering it alone.
+        x = self.convert_dtype(np.arange(11 * 20.).reshape(11, 20) % 7)
+        b = self.convert_dtype([1, -1, 0.5])
+        a = self.convert_dtype([2, -1, 0.5])
+        zi = self.convert_dtype(np.arange(11 * 2.).reshape(11, 2) % 5)
+        y, zf = lfilter(b, a, x, zi=zi, workers=2)
+        for k in range(x.shape[0]):
+            y_k, zf_k = lfilter(b, a, x[k], zi=zi[k])
+            assert_array_almost_equal(y[k], y_k)
+            assert_array_almost_equal(zf[k], zf_k)
+        y = lfilter(b, a, x.T, axis=0)
+        assert_array_almost_equal(y.T, lfilter(b, a, x))
+
 
 class TestLinearFilterFloat32(_TestLinearFilter):
     dtype = np.dtype('f')
@@ -1662,6 +1719,38 @@ class TestCorrelate(object):
         assert_allclose(correlate(a, b, mode='full'), [6, 17, 32, 23, 12])
         assert_allclose(correlate(a, b, mode='valid'), [32])
 
+    @pytest.mark.parametrize('mode', ['full', 'valid', 'same'])
+    @pytest.mark.parametrize('dt', [np.int32, np.float64, np.complex128])
+    def test_workers(self, mode, dt):
+        # Large enough for the direct correlation to run on several threads
+        np.random.seed(1234)
+        a = (10 * np.random.rand(40, 50, 60)).astype(dt)
+        b = (10 * np.random.rand(3, 4, 5)).astype(dt)
+        if np.iscomplexobj(a):
+            a += 1j * np.random.rand(*a.shape)
+            b -= 2j * np.random.rand(*b.shape)
+
+        expected = correlate(a, b, mode=mode, method='direct')
+        for workers in [4, -1]:
+            direct = correlate(a, b, mode=mode, method='direct',
+                               workers=workers)
+            assert_equal(direct, expected)
+            fft = correlate(a, b, mode=mode, method='fft', workers=workers)
+            assert_equal(fft.dtype, expected.dtype)
+            assert_allclose(fft, expected, rtol=1e-10, atol=1e-10)
+
+        # Non-contiguous inputs and swapped 'valid' inputs take the same path
+        assert_equal(correlate(a[:, ::-1], b, mode=mode, method='direct',
+                               workers=2),
+                     correlate(a[:, ::-1].copy(), b, mode=mode,
+                               method='direct'))
+        if mode == 'valid':
+            assert_allclose(correlate(b, a, mode=mode, method='fft'),
+                            correlate(b, a, mode=mode, method='direct'),
+                            rtol=1e-10, atol=1e-10)
+
+        assert_raises(ValueError, correlate, a, b, workers=0)
+
 
 @pytest.mark.parametrize('dt', [np.csingle, np.cdouble, np.clongdouble])
 class TestCorrelateComplex(object):
@@ -1926,6 +2015,32 @@ class TestSOSFiltFilt(TestFiltFilt):
             y_sos = sosfiltfilt(sos, x)
             assert_allclose(y, y_sos, atol=1e-12, err_msg='order=%s' % order)
 
+    @pytest.mark.parametrize('axis', [0, -1])
+    def test_complex_and_workers(self, axis):
+        sos = signal.butter(12, 0.1, output='sos')
+        rng = np.random.RandomState(1)
+        x_re = rng.randn(67, 1500)
+        x_im = rng.randn(67, 1500)
+        x = x_re + 1j*x_im
+
+        y = sosfiltfilt(sos, x, axis=axis)
+        assert_equal(y.dtype, np.complex128)
+        assert_allclose(y, sosfiltfilt(sos, x_re, axis=axis) +
+                        1j*sosfiltfilt(sos, x_im, axis=axis),
+                        rtol=1e-13, atol=1e-13)
+        y_f = sosfilt(sos, x, axis=axis)
+        assert_allclose(y_f, sosfilt(sos, x_re, axis=axis) +
+                        1j*sosfilt(sos, x_im, axis=axis),
+                        rtol=1e-13, atol=1e-13)
+        for workers in [2, -1]:
+            assert_allclose(sosfiltfilt(sos, x, axis=axis, workers=workers),
+                            y, rtol=1e-13, atol=1e-13)
+            assert_allclose(sosfilt(sos, x, axis=axis, workers=workers),
+                            y_f, rtol=1e-13, atol=1e-13)
+        y32 = sosfiltfilt(sos.astype(np.float32), x_re.astype(np.float32),
+                          axis=axis)
+        assert_equal(y32.dtype, np.float32)
+
 
 def filtfilt_gust_opt(b, a, x):
     """
@@ -2479,9 +2594,9 @@ class TestVectorstrength(object):
 
 class TestSOSFilt(object):
 
-    # For sosfilt we only test a single datatype. Since sosfilt wraps
-    # to lfilter under the hood, it's hopefully good enough to ensure
-    # lfilter is extensively tested.
+    # For sosfilt we only test a single datatype. Since sosfilt computes
+    # the same recursion as lfilter applied section by section, it's
+    # hopefully good enough to ensure lfilter is extensively tested.
     dt = np.float64
 
     # The test_rank* tests are pulled from _TestLinearFilter
@@ -2633,6 +2748,35 @@ class TestSOSFilt(object):
         zi = np.empty((4, 3, 3, 2))  # Correct shape is (4, 3, 2, 3)
         assert_raises(ValueError, sosfilt, sos, x, zi=zi, axis=1)
 
+    @pytest.mark.parametrize('axis', [0, 1, -1])
+    def test_workers(self, axis):
+        sos = signal.butter(6, 0.2, output='sos')
+        np.random.seed(1234)
+        x = np.random.randn(67, 3000)
+        shape = [sos.shape[0], 67, 3000]
+        shape[axis % 2 + 1] = 2
+        zi = np.random.randn(*shape)
+        b, a = signal.sos2tf(sos)
+
+        y_ref = x
+        zf_ref = np.empty_like(zi)
+        for k in range(sos.shape[0]):
+            y_ref, zf_ref[k] = lfilter(sos[k, :3], sos[k, 3:], y_ref,
+                                       axis=axis, zi=zi[k])
+        for workers in [1, 4, -1]:
+            y, zf = sosfilt(sos, x, axis=axis, zi=zi, workers=workers)
+            assert_allclose(y, y_ref, rtol=1e-12, atol=1e-12)
+            assert_allclose(zf, zf_ref, rtol=1e-12, atol=1e-12)
+            y = sosfilt(sos.astype(np.float32), x.astype(np.float32),
+                        axis=axis, workers=workers)
+            assert_equal(y.dtype, np.float32)
+            assert_allclose(y, sosfilt(sos, x, axis=axis), rtol=1e-3,
+                            atol=1e-3)
+            assert_allclose(lfilter(b, a, x, axis=axis, workers=workers),
+                            lfilter(b, a, x, axis=axis), rtol=1e-13,
+                            atol=1e-13)
+        assert_raises(ValueError, sosfilt, sos, x, workers=0)
+
     def test_sosfilt_zi(self):
         sos = signal.butter(6, 0.2, output='sos')
         zi = sosfilt_zi(sos)
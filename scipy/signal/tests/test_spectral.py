@@ -10,7 +10,8 @@ from pytest import raises as assert_raises
 from scipy._lib._numpy_compat import suppress_warnings
 from scipy import signal, fftpack
 from scipy.signal import (periodogram, welch, lombscargle, csd, coherence,
-                          spectrogram, stft, istft, check_COLA, check_NOLA)
+                          spectrogram, stft, istft, check_COLA, check_NOLA,
+                          WelchEstimator)
 from scipy.signal.spectral import _spectral_helper
 
 
@@ -535,6 +536,66 @@ class TestWelch(object):
         assert_raises(ValueError, welch, x, nperseg=8,
                       average='unrecognised-average')
 
+    @pytest.mark.parametrize('detrend', ['constant', 'linear', False])
+    def test_fused_segments(self, detrend):
+        # Real data are windowed, detrended and transformed by pypocketfft;
+        # an equivalent detrend function takes the general path
+        np.random.seed(1234)
+        x = np.random.randn(3, 1000) + np.arange(1000) / 100.
+        def func(axis):
+            if detrend:
+                return lambda seg: signal.detrend(seg, axis, type=detrend)
+            return lambda seg: seg
+        for kwargs in [dict(nperseg=64), dict(nperseg=65, nfft=80),
+                       dict(nperseg=50, noverlap=13, scaling='spectrum')]:
+            f1, p1 = welch(x, detrend=detrend, **kwargs)
+            f2, p2 = welch(x, detrend=func(-1), **kwargs)
+            assert_allclose(p1, p2, rtol=1e-10, atol=1e-15)
+            _, _, s1 = spectrogram(x.T, detrend=detrend, axis=0, **kwargs)
+            _, _, s2 = spectrogram(x.T, detrend=func(0), axis=0, **kwargs)
+            assert_allclose(s1, s2, rtol=1e-10, atol=1e-15)
+
+    @pytest.mark.parametrize('axis', [0, -1])
+    def test_estimator(self, axis):
+        np.random.seed(1234)
+        x = np.random.randn(2, 5000).astype(np.float32)
+        x = np.moveaxis(x, -1, axis)
+        for detrend in ['constant', 'linear',
+                        lambda seg: signal.detrend(seg, axis)]:
+            f, p = welch(x, nperseg=100, noverlap=30, detrend=detrend,
+                         axis=axis)
+            estimator = WelchEstimator(nperseg=100, noverlap=30,
+                                       detrend=detrend, axis=axis)
+            assert_raises(ValueError, estimator.psd)
+            start = 0
+            for n in [1, 99, 150, 2000, 7, 2743]:
+                chunk = x[:, start:start + n] if axis else x[start:start + n]
+                estimator.process(chunk)
+                start += n
+            f_est, p_est = estimator.psd()
+            assert_allclose(f_est, f)
+            assert_allclose(p_est, p, rtol=1e-5)
+            assert_equal(p_est.dtype, p.dtype)
+            # held back between chunks: less than one segment
+            assert_(estimator._tail.shape[-1] < 100)
+
+    def test_estimator_complex(self):
+        np.random.seed(1234)
+        x = np.random.randn(3000) + 1j*np.random.randn(3000)
+        with suppress_warnings() as sup:
+            sup.filter(UserWarning, "Input data is complex")
+            f, p = welch(x, nperseg=128)
+            estimator = WelchEstimator(nperseg=128)
+            for i in range(0, x.size, 1000):
+                estimator.process(x[i:i + 1000])
+        f_est, p_est = estimator.psd()
+        assert_allclose(f_est, f)
+        assert_allclose(p_est, p)
+        estimator.reset()
+        estimator.process(x.real[:500])
+        assert_raises(ValueError, estimator.process, x[500:])
+        assert_raises(ValueError, estimator.process, np.ones((2, 10)))
+
 
 class TestCSD:
     def test_pad_shorter_x(self):
@@ -35,6 +35,8 @@
 import numpy as np
 from itertools import product
 
+import pytest
+
 from numpy.testing import assert_equal, assert_allclose
 from pytest import raises as assert_raises
 
@@ -110,6 +112,21 @@ class TestUpfirdn(object):
         assert_raises(ValueError, upfirdn, [1], [1], 1, 0)  # up or down < 1
         assert_raises(ValueError, upfirdn, [], [1], 1, 1)  # h.ndim != 1
         assert_raises(ValueError, upfirdn, [[1]], [1], 1, 1)
+        assert_raises(ValueError, upfirdn, [1], [1], 1, 1, workers=0)
+
+    @pytest.mark.parametrize('axis', [0, 1])
+    def test_workers(self, axis):
+        # Enough lines and work to filter them on several threads
+        random_state = np.random.RandomState(17)
+        x = random_state.randn(8, 50000)
+        if axis == 0:
+            x = x.T
+        h = firwin(301, 1. / 3, window='hamming')
+        y = upfirdn(h, x, 3, 2, axis=axis)
+        assert_allclose(upfirdn(h, x, 3, 2, axis=axis, workers=4), y)
+        assert_allclose(upfirdn(h, x, 3, 2, axis=axis, workers=-1), y)
+        assert_allclose(y, np.apply_along_axis(upfirdn_naive, axis, x,
+                                               h, 3, 2))
 
     def test_vs_lfilter(self):
         # Check that up=1.0 gives same answer as lfilter + slicing
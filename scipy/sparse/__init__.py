@@ -47,6 +47,7 @@ Building sparse matrices:
    vstack - Stack sparse matrices vertically (row wise)
    rand - Random values in a given shape
    random - Random values in a given shape
+   SparseBuilder - Incremental builder of sparse matrices
 
 Save and load sparse matrices:
 
@@ -63,6 +64,14 @@ Sparse matrix tools:
 
    find
 
+Threading control:
+
+.. autosummary::
+   :toctree: generated/
+
+   set_workers - Context manager for the default number of workers
+   get_workers - Get the default number of workers
+
 Identifying sparse matrices:
 
 .. autosummary::
@@ -109,7 +118,8 @@ There are seven available sparse matrix types:
     6. coo_matrix: COOrdinate format (aka IJV, triplet format)
     7. dia_matrix: DIAgonal format
 
-To construct a matrix efficiently, use either dok_matrix or lil_matrix.
+To construct a matrix efficiently, use either dok_matrix or lil_matrix,
+or for large matrices assembled from many entries, SparseBuilder.
 The lil_matrix class supports basic slicing and fancy indexing with a
 similar syntax to NumPy arrays. As illustrated below, the COO format
 may also be used to efficiently construct matrices. Despite their
@@ -237,6 +247,8 @@ from .bsr import *
 from .construct import *
 from .extract import *
 from ._matrix_io import *
+from ._workers import *
+from ._builder import *
 
 # For backward compatibility with v0.19.
 from . import csgraph
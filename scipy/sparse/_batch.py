@@ -0,0 +1,116 @@
+"""Batches of small CSR matrices, applied in a single sparsetools call"""
+from __future__ import division, print_function, absolute_import
+
+import numpy as np
+
+from ._sparsetools import csr_matvec_batch
+from ._workers import _workers
+from .csr import csr_matrix
+from .sputils import get_index_dtype, upcast, upcast_char
+
+__all__ = []
+
+
+class _csr_batch(object):
+    """Stack of CSR matrices for batched matrix-vector products.
+
+    The matrices are converted, validated and concatenated once, when the
+    batch is built. Each `matvec` call then handles the whole batch in a
+    single call into sparsetools, which amortizes the per-call overhead
+    when the matrices are small.
+
+    Parameters
+    ----------
+    matrices : sequence of sparse matrices or array_like
+        The matrices in the batch. They may have different shapes.
+
+    Attributes
+    ----------
+    shapes : ndarray, shape (n_batch, 2)
+        Shapes of the matrices.
+    dtype : dtype
+        Common data type of the matrices.
+
+    """
+    def __init__(self, matrices):
+        matrices = [csr_matrix(A) for A in matrices]
+        if not matrices:
+            raise ValueError("batch must contain at least one matrix")
+        for A in matrices:
+            A.check_format(full_check=True)
+
+        self.shapes = np.array([A.shape for A in matrices], dtype=np.intp)
+        self.dtype = upcast(*[A.dtype for A in matrices])
+
+        nnz = np.array([A.nnz for A in matrices], dtype=np.intp)
+        nnz_ptr = np.concatenate(([0], np.cumsum(nnz)))
+        row_ptr = np.concatenate(([0], np.cumsum(self.shapes[:, 0])))
+        col_ptr = np.concatenate(([0], np.cumsum(self.shapes[:, 1])))
+
+        idx_dtype = get_index_dtype(maxval=max(nnz_ptr[-1], row_ptr[-1],
+                                               col_ptr[-1]))
+        self.row_ptr = row_ptr.astype(idx_dtype)
+        self.col_ptr = col_ptr.astype(idx_dtype)
+        self.indptr = np.concatenate(
+            [A.indptr[:-1].astype(idx_dtype) + off
+             for A, off in zip(matrices, nnz_ptr)] + [nnz_ptr[-1:]]
+        ).astype(idx_dtype)
+        self.indices = np.concatenate(
+            [A.indices for A in matrices]).astype(idx_dtype)
+        self.data = np.concatenate(
+            [A.data for A in matrices]).astype(self.dtype)
+
+    def __len__(self):
+        return len(self.shapes)
+
+    def matvec(self, x, workers=None):
+        """Multiply each matrix of the batch with its own vector.
+
+        Parameters
+        ----------
+        x : ndarray or sequence of ndarray
+            The vectors. Either a sequence of 1-D arrays, one per matrix; a
+            2-D array with one row per matrix, if all matrices have the
+            same number of columns; or a 1-D array holding the vectors one
+            after another.
+        workers : int, optional
+            Maximum number of threads to use. Defaults to the
+            `scipy.sparse.set_workers` setting.
+
+        Returns
+        -------
+        y : ndarray or list of ndarray
+            The products, in the same layout as `x`. For 2-D `x`, `y` is
+            2-D only if all matrices have the same number of rows;
+            otherwise it is a list.
+
+        """
+        n_batch = len(self.shapes)
+        n_col = self.col_ptr[-1]
+
+        if isinstance(x, np.ndarray):
+            layout = x.ndim
+            if x.ndim == 2 and (x.shape[0] != n_batch or
+                                np.any(self.shapes[:, 1] != x.shape[1])):
+                raise ValueError('dimension mismatch')
+            xx = x.reshape(-1)
+        else:
+            layout = None
+            if len(x) != n_batch:
+                raise ValueError('dimension mismatch')
+            x = [np.asarray(v) for v in x]
+            xx = np.concatenate([v.reshape(-1) for v in x])
+        if xx.shape != (n_col,):
+            raise ValueError('dimension mismatch')
+
+        dtype = upcast_char(self.dtype.char, xx.dtype.char)
+        y = np.zeros(self.row_ptr[-1], dtype=dtype)
+        csr_matvec_batch(n_batch, self.row_ptr, self.col_ptr, self.indptr,
+                         self.indices, self.data.astype(dtype, copy=False),
+                         xx.astype(dtype, copy=False), y, _workers(workers))
+
+        if layout == 1:
+            return y
+        if layout == 2 and np.all(self.shapes[:, 0] == self.shapes[0, 0]):
+            return y.reshape(n_batch, -1)
+        return np.split(y, self.row_ptr[1:-1])
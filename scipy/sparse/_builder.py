@@ -0,0 +1,191 @@
+"""Incremental assembly of sparse matrices in a compiled hash table."""
+from __future__ import division, print_function, absolute_import
+
+import operator
+
+import numpy as np
+
+from . import _sparsetools
+from ._workers import _workers
+from .sputils import getdtype, check_shape, get_index_dtype
+
+__all__ = ['SparseBuilder']
+
+# The table is grown when it would get more than half full
+_MIN_CAPACITY = 16
+
+
+class SparseBuilder(object):
+    """
+    Incremental builder of a sparse matrix, summing the values added to
+    each entry
+
+    Entries are added in batches of arrays and kept in a compiled
+    open-addressing hash table keyed by (row, column), which takes about
+    32 bytes per entry. For assembling large matrices element by element,
+    such as finite element matrices, this is much faster and more compact
+    than `dok_matrix` and `lil_matrix`, which store Python objects.
+
+    Parameters
+    ----------
+    shape : tuple of ints
+        Shape of the matrix.
+    dtype : dtype, optional
+        Data type of the matrix. Default is float64.
+    capacity : int, optional
+        Expected number of distinct entries, to size the table up front.
+
+    Attributes
+    ----------
+    shape : tuple of ints
+        Shape of the matrix.
+    dtype : dtype
+        Data type of the matrix.
+    nnz : int
+        Number of distinct entries added so far.
+
+    Notes
+    -----
+    Values that cancel, and zeros that are added, are kept as explicit
+    zeros.
+
+    A builder must not be used from several threads at once. Adding
+    entries releases the GIL, so threads can each assemble into their own
+    builder; the builders can then be combined with `merge`.
+
+    .. versionadded:: 1.4.0
+
+    Examples
+    --------
+    >>> from scipy.sparse import SparseBuilder
+    >>> B = SparseBuilder((3, 4))
+    >>> B.add([0, 1, 0], [0, 2, 0], [1., 2., 3.])
+    >>> B.add(2, 3, 5.)
+    >>> B.tocsr().toarray()
+    array([[4., 0., 0., 0.],
+           [0., 0., 2., 0.],
+           [0., 0., 0., 5.]])
+
+    """
+
+    def __init__(self, shape, dtype=None, capacity=None):
+        self.shape = check_shape(shape)
+        if self.shape[0] * self.shape[1] >= 2**63:
+            raise ValueError("matrices with more than 2**63 elements are "
+                             "not supported")
+        self.dtype = getdtype(dtype, default=float)
+        self.nnz = 0
+
+        n = _MIN_CAPACITY
+        if capacity is not None:
+            capacity = operator.index(capacity)
+            while n < 2 * capacity:
+                n *= 2
+        self._keys = np.full(n, -1, dtype=np.int64)
+        self._vals = np.zeros(n, dtype=self.dtype)
+
+    def add(self, rows, cols, values):
+        """
+        Add `values` to the entries at `rows` and `cols`
+
+        Parameters
+        ----------
+        rows, cols : array_like of ints
+            Row and column indices of the entries. Negative indices are
+            not allowed.
+        values : array_like
+            Values to add, broadcast against `rows` and `cols`. Values
+            added to the same entry, in this or earlier calls, are summed.
+
+        """
+        rows, cols, values = np.broadcast_arrays(np.asarray(rows),
+                                                 np.asarray(cols),
+                                                 np.asarray(values))
+        if rows.size == 0:
+            return
+        if rows.dtype.kind not in 'iu' or cols.dtype.kind not in 'iu':
+            raise TypeError("row and column indices must be integers")
+
+        M, N = self.shape
+        if rows.min() < 0 or rows.max() >= M:
+            raise IndexError("row index out of bounds")
+        if cols.min() < 0 or cols.max() >= N:
+            raise IndexError("column index out of bounds")
+
+        keys = rows.astype(np.int64).ravel()
+        keys *= N
+        keys += cols.astype(np.int64).ravel()
+        self._add_keys(keys, np.ascontiguousarray(values.ravel(),
+                                                  dtype=self.dtype))
+
+    def merge(self, other):
+        """
+        Add the entries of another `SparseBuilder` of the same shape
+
+        The other builder is not changed.
+        """
+        if not isinstance(other, SparseBuilder):
+            raise TypeError("can only merge a SparseBuilder")
+        if other.shape != self.shape:
+            raise ValueError("shapes of the builders differ")
+        # the empty slots of the other table are skipped
+        self._add_keys(other._keys, other._vals.astype(self.dtype,
+                                                       copy=False))
+
+    def _add_keys(self, keys, vals):
+        # Add in slices that fit in the table, growing it when it is full;
+        # repeated keys then only grow it as far as their distinct number
+        # requires.
+        start = 0
+        while start < len(keys):
+            capacity = len(self._keys)
+            room = capacity // 2 - self.nnz
+            if room < min(len(keys) - start, capacity // 8):
+                self._grow(2 * capacity)
+                continue
+            stop = min(len(keys), start + room)
+            self.nnz += _sparsetools.coo_hash_add(
+                stop - start, keys[start:stop], vals[start:stop], capacity,
+                self._keys, self._vals)
+            start = stop
+
+    def _grow(self, capacity):
+        keys, vals = self._keys, self._vals
+        self._keys = np.full(capacity, -1, dtype=np.int64)
+        self._vals = np.zeros(capacity, dtype=self.dtype)
+        _sparsetools.coo_hash_add(len(keys), keys, vals, capacity,
+                                  self._keys, self._vals)
+
+    def tocsr(self):
+        """
+        Return the matrix built so far in canonical CSR format
+
+        The conversion runs on the threads set by
+        `scipy.sparse.set_workers`.
+        """
+        from .csr import csr_matrix
+
+        M, N = self.shape
+        nnz = self.nnz
+        if nnz == 0:
+            return csr_matrix(self.shape, dtype=self.dtype)
+
+        idx_dtype = get_index_dtype(maxval=max(M, N, nnz))
+        row = np.empty(nnz, dtype=idx_dtype)
+        col = np.empty(nnz, dtype=idx_dtype)
+        data = np.empty(nnz, dtype=self.dtype)
+        _sparsetools.coo_hash_extract(len(self._keys), self._keys,
+                                      self._vals, N, row, col, data)
+
+        indptr = np.empty(M + 1, dtype=idx_dtype)
+        indices = np.empty_like(col)
+        x = np.empty_like(data)
+        _sparsetools.coo_tocsr_canonical(M, N, nnz, row, col, data,
+                                         indptr, indices, x, _workers(None))
+        A = csr_matrix((x, indices, indptr), shape=self.shape)
+        A.has_canonical_format = True
+        return A
+
+    def tocoo(self):
+        """Return the matrix built so far in COO format"""
+        return self.tocsr().tocoo()
@@ -0,0 +1,97 @@
+"""Sliced ELLPACK (SELL-C-sigma) representation for repeated matvecs"""
+from __future__ import division, print_function, absolute_import
+
+import numpy as np
+
+from ._sparsetools import csr_tosell_pass1, csr_tosell_pass2, sell_matvec
+from ._workers import _workers
+from .sputils import get_index_dtype, upcast_char
+
+__all__ = []
+
+
+class _sell_matrix(object):
+    """Read-only SELL-C-sigma copy of a sparse matrix, for fast matvecs.
+
+    The rows are grouped into slices of `C` rows, each padded to the length
+    of its longest row and stored column-major, so that a matvec can work
+    on `C` rows at once. Before slicing, rows are sorted by decreasing
+    length within windows of `sigma` rows, which reduces the padding.
+
+    Converting costs about as much as a few CSR matvecs, so this pays off
+    when the same matrix is applied many times, e.g. in an iterative solver.
+    The object has ``shape``, ``dtype`` and ``matvec``, so it can be passed
+    to `scipy.sparse.linalg.aslinearoperator`.
+
+    Parameters
+    ----------
+    A : sparse matrix
+        Matrix to convert; it is converted to CSR first.
+    C : int, optional
+        Number of rows per slice. 4, 8, 16 and 32 use unrolled kernels.
+    sigma : int, optional
+        Size of the sorting windows. 1 disables sorting. Defaults to
+        ``32*C``.
+
+    """
+    def __init__(self, A, C=8, sigma=None):
+        A = A.tocsr()
+        C = int(C)
+        if C < 1:
+            raise ValueError("C must be positive")
+        if sigma is None:
+            sigma = 32 * C
+        sigma = int(sigma)
+        if sigma < 1:
+            raise ValueError("sigma must be positive")
+
+        M, N = A.shape
+        n_slices = -(-M // C)
+        row_nnz = np.diff(A.indptr)
+        max_row_nnz = row_nnz.max() if M > 0 else 0
+        idx_dtype = get_index_dtype((A.indptr, A.indices),
+                                    maxval=max(n_slices * C * max_row_nnz,
+                                               sigma, N))
+
+        indptr = np.asarray(A.indptr, dtype=idx_dtype)
+        self.perm = np.empty(M, dtype=idx_dtype)
+        self.slice_ptr = np.empty(n_slices + 1, dtype=idx_dtype)
+        csr_tosell_pass1(M, indptr, C, sigma, self.perm, self.slice_ptr)
+
+        nnz = self.slice_ptr[-1]
+        self.indices = np.empty(nnz, dtype=idx_dtype)
+        self.data = np.empty(nnz, dtype=A.dtype)
+        csr_tosell_pass2(M, indptr,
+                         np.asarray(A.indices, dtype=idx_dtype),
+                         A.data, C, self.perm, self.slice_ptr,
+                         self.indices, self.data)
+
+        self.shape = (M, N)
+        self.dtype = A.dtype
+        self.C = C
+        self.sigma = sigma
+
+    def matvec(self, x, workers=None):
+        """Compute ``A @ x`` for a 1-D or ``(N, 1)`` array `x`."""
+        x = np.asarray(x)
+        M, N = self.shape
+        if x.shape != (N,) and x.shape != (N, 1):
+            raise ValueError('dimension mismatch')
+
+        dtype = upcast_char(self.dtype.char, x.dtype.char)
+        y = np.zeros(M, dtype=dtype)
+        sell_matvec(M, self.C, self.perm, self.slice_ptr, self.indices,
+                    self.data.astype(dtype, copy=False),
+                    np.ravel(x).astype(dtype, copy=False), y,
+                    _workers(workers))
+
+        if x.ndim == 2:
+            y = y.reshape(M, 1)
+        return y
+
+    dot = matvec
+
+    def __repr__(self):
+        return "<%dx%d SELL-%d-%d matrix of type '%s' with %d stored " \
+               "elements (including padding)>" % (self.shape + (self.C,
+                        self.sigma, self.dtype.type, self.data.size))
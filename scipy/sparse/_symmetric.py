@@ -0,0 +1,70 @@
+"""Symmetric matrices stored as their upper triangle in CSR format"""
+from __future__ import division, print_function, absolute_import
+
+import numpy as np
+
+from ._sparsetools import csr_symmetric_matvec_threaded
+from ._workers import _workers
+from .construct import triu
+from .sputils import upcast_char
+
+__all__ = []
+
+
+class _symmetric_csr(object):
+    """Read-only symmetric matrix that only stores its upper triangle.
+
+    A matvec reads each off-diagonal entry once and applies it to both
+    mirrored positions, so this takes about half the memory and memory
+    traffic of the full CSR matrix. The object has ``shape``, ``dtype``
+    and ``matvec``, so it can be passed to
+    `scipy.sparse.linalg.aslinearoperator`.
+
+    Parameters
+    ----------
+    A : sparse matrix
+        Square matrix. Only its upper triangle is used; the lower one is
+        assumed to mirror it.
+    check : bool, optional
+        Whether to check that `A` is symmetric.
+
+    """
+    def __init__(self, A, check=True):
+        M, N = A.shape
+        if M != N:
+            raise ValueError("matrix must be square")
+        if check and (abs(A - A.T) > 0).nnz != 0:
+            raise ValueError("matrix is not symmetric")
+
+        U = triu(A, format='csr')
+        U.sum_duplicates()
+        self.indptr = U.indptr
+        self.indices = U.indices
+        self.data = U.data
+        self.shape = (M, N)
+        self.dtype = U.dtype
+
+    def matvec(self, x, workers=None):
+        """Compute ``A @ x`` for a 1-D or ``(N, 1)`` array `x`."""
+        x = np.asarray(x)
+        M, N = self.shape
+        if x.shape != (N,) and x.shape != (N, 1):
+            raise ValueError('dimension mismatch')
+
+        dtype = upcast_char(self.dtype.char, x.dtype.char)
+        y = np.zeros(M, dtype=dtype)
+        csr_symmetric_matvec_threaded(M, self.indptr, self.indices,
+                                      self.data.astype(dtype, copy=False),
+                                      np.ravel(x).astype(dtype, copy=False),
+                                      y, _workers(workers))
+
+        if x.ndim == 2:
+            y = y.reshape(M, 1)
+        return y
+
+    dot = matvec
+
+    def __repr__(self):
+        return "<%dx%d symmetric matrix of type '%s' with %d stored " \
+               "elements in upper triangle>" % (self.shape + (self.dtype.type,
+                                                  self.data.size))
@@ -0,0 +1,130 @@
+"""Control of the number of threads used by sparse matrix kernels."""
+from __future__ import division, print_function, absolute_import
+
+import os
+import operator
+import threading
+import contextlib
+
+__all__ = ['set_workers', 'get_workers']
+
+_config = threading.local()
+_cpu_count = os.cpu_count() or 1
+
+
+def _workers(workers):
+    """Normalize a ``workers`` argument to a positive thread count.
+
+    ``None`` means the current default (see `set_workers`), and negative
+    values wrap around from ``os.cpu_count()``, so that ``-1`` means all
+    CPUs.
+    """
+    if workers is None:
+        return getattr(_config, 'default_workers', 1)
+
+    workers = operator.index(workers)
+    if workers < 0:
+        if workers >= -_cpu_count:
+            workers += 1 + _cpu_count
+        else:
+            raise ValueError("workers value out of range; got {}, must not be"
+                             " less than {}".format(workers, -_cpu_count))
+    elif workers == 0:
+        raise ValueError("workers must not be zero")
+    return workers
+
+
+@contextlib.contextmanager
+def set_workers(workers):
+    """Context manager for the default number of workers used in
+    `scipy.sparse`
+
+    Parameters
+    ----------
+    workers : int
+        The default number of workers to use. If negative, the value wraps
+        around from ``os.cpu_count()``.
+
+    Notes
+    -----
+    Only some operations run on multiple threads; currently these are
+
+    - products of CSR and CSC matrices with dense vectors and matrices,
+      including ``A.T @ x`` for a CSR matrix ``A``, which uses its CSC view
+    - products of DIA matrices with dense vectors
+    - products of two CSR or two CSC matrices
+    - elementwise operations between two CSR, CSC or BSR matrices
+    - conversions between CSR and CSC, and from COO with duplicates
+    - sorting the indices of CSR, CSC and BSR matrices
+    - conversions from CSR and CSC to BSR, and the estimation of their
+      blocksize
+    - indexing CSR and CSC matrices with arrays of rows and columns,
+      ``A[rows, cols]``, and assigning to such entries
+    - selecting rows of a CSR matrix, or columns of a CSC matrix, with an
+      index array
+    - ``sum``, ``min``, ``max``, ``argmin``, ``argmax`` and ``getnnz``
+      along an axis of CSR and CSC matrices
+    - assembling CSR and CSC matrices from blocks with
+      `scipy.sparse.bmat`, `scipy.sparse.hstack`, `scipy.sparse.vstack` and
+      `scipy.sparse.block_diag`
+    - `scipy.sparse.kron`
+    - drawing the positions of the nonzeros in `scipy.sparse.random` and
+      `scipy.sparse.rand`
+    - converting a `scipy.sparse.SparseBuilder` to CSR or COO format
+    - weak and undirected `scipy.sparse.csgraph.connected_components`
+    - `scipy.sparse.csgraph.dijkstra` and `scipy.sparse.csgraph.johnson`,
+      searching from several sources at once, or with delta-stepping for
+      a single search on a large graph (a breadth-first search if
+      unweighted)
+    - `scipy.sparse.csgraph.breadth_first_order` and
+      `scipy.sparse.csgraph.breadth_first_tree`, one level at a time
+    - `scipy.sparse.csgraph.floyd_warshall`, on the tiles of the matrix
+    - `scipy.sparse.csgraph.minimum_spanning_tree` with
+      ``method='boruvka'``
+    - the breadth-first searches of
+      `scipy.sparse.csgraph.maximum_bipartite_matching` and
+      `scipy.sparse.csgraph.structural_rank`
+    - the connected components of
+      `scipy.sparse.csgraph.reverse_cuthill_mckee`
+    - `scipy.sparse.csgraph.laplacian` of CSR and CSC graphs
+    - parsing and formatting the entries of sparse matrices in
+      `scipy.io.mmread` and `scipy.io.mmwrite`
+    - parsing the pointers, indices and values of `scipy.io.hb_read`
+
+    Small problems are always run on a single thread. The setting is local
+    to the calling thread.
+
+    Examples
+    --------
+    >>> import numpy as np
+    >>> from scipy import sparse
+    >>> A = sparse.random(10000, 10000, density=1e-3, format='csr')
+    >>> x = np.ones(10000)
+    >>> with sparse.set_workers(4):
+    ...     y = A.dot(x)
+    >>> np.allclose(y, A.toarray().dot(x))
+    True
+
+    """
+    old_workers = get_workers()
+    _config.default_workers = _workers(workers)
+    try:
+        yield
+    finally:
+        _config.default_workers = old_workers
+
+
+def get_workers():
+    """Returns the default number of workers within the current context
+
+    Examples
+    --------
+    >>> from scipy import sparse
+    >>> sparse.get_workers()
+    1
+    >>> with sparse.set_workers(4):
+    ...     sparse.get_workers()
+    4
+
+    """
+    return getattr(_config, 'default_workers', 1)
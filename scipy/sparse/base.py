@@ -932,7 +932,8 @@ class spmatrix(object):
         the resultant bsr_matrix.
 
         When blocksize=(R, C) is provided, it will be used for construction of
-        the bsr_matrix.
+        the bsr_matrix. Otherwise the blocksize is chosen from the fill
+        ratios of the blocks, with `scipy.sparse.spfuncs.estimate_blocksize`.
         """
         return self.tocsr(copy=False).tobsr(blocksize=blocksize, copy=copy)
 
@@ -11,14 +11,15 @@ from warnings import warn
 import numpy as np
 
 from .data import _data_matrix, _minmax_mixin
-from .compressed import _cs_matrix
+from .compressed import _cs_matrix, _binop_codes
 from .base import isspmatrix, _formats, spmatrix
 from .sputils import (isshape, getdtype, to_native, upcast, get_index_dtype,
                       check_shape)
 from . import _sparsetools
 from ._sparsetools import (bsr_matvec, bsr_matvecs, csr_matmat_pass1,
                            bsr_matmat_pass2, bsr_transpose, bsr_sort_indices,
-                           bsr_tocsr)
+                           bsr_sort_indices_threaded, bsr_tocsr)
+from ._workers import _workers
 
 
 class bsr_matrix(_cs_matrix, _minmax_mixin):
@@ -602,7 +603,14 @@ class bsr_matrix(_cs_matrix, _minmax_mixin):
         R,C = self.blocksize
         M,N = self.shape
 
-        bsr_sort_indices(M//R, N//C, R, C, self.indptr, self.indices, self.data.ravel())
+        workers = _workers(None)
+        if workers > 1:
+            bsr_sort_indices_threaded(M//R, N//C, R, C, self.indptr,
+                                      self.indices, self.data.ravel(),
+                                      workers)
+        else:
+            bsr_sort_indices(M//R, N//C, R, C, self.indptr, self.indices,
+                             self.data.ravel())
 
         self.has_sorted_indices = True
 
@@ -652,16 +660,24 @@ class bsr_matrix(_cs_matrix, _minmax_mixin):
         else:
             data = np.empty(R*C*max_bnnz, dtype=upcast(self.dtype,other.dtype))
 
-        fn(self.shape[0]//R, self.shape[1]//C, R, C,
-           self.indptr.astype(idx_dtype),
-           self.indices.astype(idx_dtype),
-           self.data,
-           other.indptr.astype(idx_dtype),
-           other.indices.astype(idx_dtype),
-           np.ravel(other.data),
-           indptr,
-           indices,
-           data)
+        args = (self.shape[0]//R, self.shape[1]//C, R, C,
+                self.indptr.astype(idx_dtype),
+                self.indices.astype(idx_dtype),
+                self.data,
+                other.indptr.astype(idx_dtype),
+                other.indices.astype(idx_dtype),
+                np.ravel(other.data),
+                indptr,
+                indices,
+                data)
+
+        workers = _workers(None)
+        if workers > 1:
+            kind = 'cmpop' if op in bool_ops else 'binop'
+            fn = getattr(_sparsetools, 'bsr_' + kind + '_bsr_threaded')
+            fn(*(args + (_binop_codes[op], workers)))
+        else:
+            fn(*args)
 
         actual_bnnz = indptr[-1]
         indices = indices[:actual_bnnz]
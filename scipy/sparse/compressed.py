@@ -18,10 +18,27 @@ from ._sparsetools import (get_csr_submatrix, csr_sample_offsets, csr_todense,
                            csr_sample_values, csr_row_index, csr_row_slice,
                            csr_column_index1, csr_column_index2)
 from ._index import IndexMixin
+from ._workers import _workers
 from .sputils import (upcast, upcast_char, to_native, isdense, isshape,
                       getdtype, isscalarlike, isintlike, get_index_dtype,
                       downcast_intp_index, get_sum_dtype, check_shape,
-                      matrix, asmatrix)
+                      matrix, asmatrix, validateaxis)
+
+
+# Operator codes of the *_binop_*_threaded and *_cmpop_*_threaded
+# sparsetools routines; these must match the enums in sparsetools/csr.h
+_binop_codes = {'_plus_': 0, '_minus_': 1, '_elmul_': 2, '_eldiv_': 3,
+                '_maximum_': 4, '_minimum_': 5,
+                '_ne_': 0, '_lt_': 1, '_gt_': 2, '_le_': 3, '_ge_': 4}
+
+# Data types that csr_matvec_mixed and csr_matvecs_mixed sum in a wider
+# type, mapped to that type; these must match ACC_TYPES in
+# generate_sparsetools.py
+_acc_chars = {'f': 'd', 'F': 'D'}
+
+# Number of vectors from which csr_matvecs_tiled is used for CSR products;
+# its panel width, SPMM_PANEL_WIDTH in sparsetools/csr.h
+_spmm_panel_width = 32
 
 
 class _cs_matrix(_data_matrix, _minmax_mixin, IndexMixin):
@@ -114,10 +131,12 @@ class _cs_matrix(_data_matrix, _minmax_mixin, IndexMixin):
             if axis < 0:
                 axis += 2
             axis, _ = self._swap((axis, 1 - axis))
-            _, N = self._swap(self.shape)
+            M, N = self._swap(self.shape)
             if axis == 0:
-                return np.bincount(downcast_intp_index(self.indices),
-                                   minlength=N)
+                counts = np.empty(N, dtype=self.indices.dtype)
+                _sparsetools.csr_column_nnz(M, N, self.indptr, self.indices,
+                                            counts, _workers(None))
+                return counts
             elif axis == 1:
                 return np.diff(self.indptr)
             raise ValueError('axis out of bounds')
@@ -468,6 +487,22 @@ class _cs_matrix(_data_matrix, _minmax_mixin, IndexMixin):
         result = np.zeros(M, dtype=upcast_char(self.dtype.char,
                                                other.dtype.char))
 
+        workers = _workers(None)
+        if (self.format == 'csr' and
+                _acc_chars.get(self.dtype.char) == result.dtype.char):
+            # e.g. float32 data with a float64 vector: sum in float64
+            # instead of converting a copy of the data
+            _sparsetools.csr_matvec_mixed(M, N, self.indptr, self.indices,
+                                          self.data, other, result, workers)
+            return result
+
+        if workers > 1:
+            # csr_matvec_threaded or csc_matvec_threaded
+            fn = getattr(_sparsetools, self.format + '_matvec_threaded')
+            fn(M, N, self.indptr, self.indices, self.data, other, result,
+               workers)
+            return result
+
         # csr_matvec or csc_matvec
         fn = getattr(_sparsetools, self.format + '_matvec')
         fn(M, N, self.indptr, self.indices, self.data, other, result)
@@ -481,6 +516,33 @@ class _cs_matrix(_data_matrix, _minmax_mixin, IndexMixin):
         result = np.zeros((M, n_vecs),
                           dtype=upcast_char(self.dtype.char, other.dtype.char))
 
+        workers = _workers(None)
+        if (self.format == 'csr' and
+                _acc_chars.get(self.dtype.char) == result.dtype.char):
+            _sparsetools.csr_matvecs_mixed(M, N, n_vecs, self.indptr,
+                                           self.indices, self.data,
+                                           other.ravel(), result.ravel(),
+                                           workers)
+            return result
+
+        x_fortran = other.flags.f_contiguous and not other.flags.c_contiguous
+        if self.format == 'csr' and (x_fortran or
+                                     n_vecs >= _spmm_panel_width):
+            # panels of columns; a Fortran-ordered X needs no copy
+            _sparsetools.csr_matvecs_tiled(M, N, n_vecs, self.indptr,
+                                           self.indices, self.data,
+                                           int(x_fortran),
+                                           other.ravel(order='A'),
+                                           result.ravel(), workers)
+            return result
+
+        if workers > 1:
+            # csr_matvecs_threaded or csc_matvecs_threaded
+            fn = getattr(_sparsetools, self.format + '_matvecs_threaded')
+            fn(M, N, n_vecs, self.indptr, self.indices, self.data,
+               other.ravel(), result.ravel(), workers)
+            return result
+
         # csr_matvecs or csc_matvecs
         fn = getattr(_sparsetools, self.format + '_matvecs')
         fn(M, N, n_vecs, self.indptr, self.indices, self.data,
@@ -500,13 +562,18 @@ class _cs_matrix(_data_matrix, _minmax_mixin, IndexMixin):
                                     maxval=M*N)
         indptr = np.empty(major_axis + 1, dtype=idx_dtype)
 
-        fn = getattr(_sparsetools, self.format + '_matmat_pass1')
+        # csr_matmat_pass1, csc_matmat_pass1 or their threaded variants
+        workers = _workers(None)
+        suffix = '_threaded' if workers > 1 else ''
+        extra_args = (workers,) if workers > 1 else ()
+
+        fn = getattr(_sparsetools, self.format + '_matmat_pass1' + suffix)
         fn(M, N,
            np.asarray(self.indptr, dtype=idx_dtype),
            np.asarray(self.indices, dtype=idx_dtype),
            np.asarray(other.indptr, dtype=idx_dtype),
            np.asarray(other.indices, dtype=idx_dtype),
-           indptr)
+           indptr, *extra_args)
 
         nnz = indptr[-1]
         idx_dtype = get_index_dtype((self.indptr, self.indices,
@@ -516,14 +583,14 @@ class _cs_matrix(_data_matrix, _minmax_mixin, IndexMixin):
         indices = np.empty(nnz, dtype=idx_dtype)
         data = np.empty(nnz, dtype=upcast(self.dtype, other.dtype))
 
-        fn = getattr(_sparsetools, self.format + '_matmat_pass2')
+        fn = getattr(_sparsetools, self.format + '_matmat_pass2' + suffix)
         fn(M, N, np.asarray(self.indptr, dtype=idx_dtype),
            np.asarray(self.indices, dtype=idx_dtype),
            self.data,
            np.asarray(other.indptr, dtype=idx_dtype),
            np.asarray(other.indices, dtype=idx_dtype),
            other.data,
-           indptr, indices, data)
+           indptr, indices, data, *extra_args)
 
         return self.__class__((data, indices, indptr), shape=(M, N))
 
@@ -587,29 +654,38 @@ class _cs_matrix(_data_matrix, _minmax_mixin, IndexMixin):
         """Sum the matrix over the given axis.  If the axis is None, sum
         over both rows and columns, returning a scalar.
         """
-        # The spmatrix base class already does axis=0 and axis=1 efficiently
-        # so we only do the case axis=None here
-        if (not hasattr(self, 'blocksize') and
-                axis in self._swap(((1, -1), (0, 2)))[0]):
-            # faster than multiplication for large minor axis in CSC/CSR
-            res_dtype = get_sum_dtype(self.dtype)
-            ret = np.zeros(len(self.indptr) - 1, dtype=res_dtype)
-
-            major_index, value = self._minor_reduce(np.add)
-            ret[major_index] = value
-            ret = asmatrix(ret)
-            if axis % 2 == 1:
-                ret = ret.T
-
-            if out is not None and out.shape != ret.shape:
-                raise ValueError('dimensions do not match')
-
-            return ret.sum(axis=(), dtype=dtype, out=out)
-        # spmatrix will handle the remaining situations when axis
-        # is in {None, -1, 0, 1}
-        else:
+        validateaxis(axis)
+        # The spmatrix base class sums BSR matrices, and over both axes
+        if hasattr(self, 'blocksize') or axis is None:
             return spmatrix.sum(self, axis=axis, dtype=dtype, out=out)
 
+        if axis < 0:
+            axis += 2
+        M, N = self._swap(self.shape)
+        res_dtype = get_sum_dtype(self.dtype)
+        data = self.data
+        if data.dtype != res_dtype:
+            data = data.astype(res_dtype)
+
+        # summing over axis 1 of CSR, or axis 0 of CSC, sums each row of
+        # the CSR arrays
+        if axis == self._swap((1, 0))[0]:
+            ret = np.empty(M, dtype=res_dtype)
+            fn = _sparsetools.csr_row_sums
+        else:
+            ret = np.empty(N, dtype=res_dtype)
+            fn = _sparsetools.csr_column_sums
+        fn(M, N, self.indptr, self.indices, data, ret, _workers(None))
+
+        ret = asmatrix(ret)
+        if axis == 1:
+            ret = ret.T
+
+        if out is not None and out.shape != ret.shape:
+            raise ValueError('dimensions do not match')
+
+        return ret.sum(axis=(), dtype=dtype, out=out)
+
     sum.__doc__ = spmatrix.sum.__doc__
 
     def _minor_reduce(self, ufunc, data=None):
@@ -661,8 +737,14 @@ class _cs_matrix(_data_matrix, _minmax_mixin, IndexMixin):
         minor = np.asarray(minor, dtype=idx_dtype)
 
         val = np.empty(major.size, dtype=self.dtype)
-        csr_sample_values(M, N, self.indptr, self.indices, self.data,
-                          major.size, major.ravel(), minor.ravel(), val)
+        workers = _workers(None)
+        if workers > 1:
+            _sparsetools.csr_sample_values_threaded(
+                M, N, self.indptr, self.indices, self.data, major.size,
+                major.ravel(), minor.ravel(), val, workers)
+        else:
+            csr_sample_values(M, N, self.indptr, self.indices, self.data,
+                              major.size, major.ravel(), minor.ravel(), val)
         if major.ndim == 1:
             return asmatrix(val)
         return self.__class__(val.reshape(major.shape))
@@ -684,16 +766,31 @@ class _cs_matrix(_data_matrix, _minmax_mixin, IndexMixin):
         if M == 0:
             return self.__class__(new_shape)
 
-        row_nnz = np.diff(self.indptr)
+        return self._gather_major(indices, _workers(None))
+
+    def _gather_major(self, indices, workers):
+        """Gather the rows (columns for CSC) `indices`, given as an index
+        array of the indices dtype with nonnegative entries.
+        """
+        _, N = self._swap(self.shape)
+        M = len(indices)
+        new_shape = self._swap((M, N))
+
         idx_dtype = self.indices.dtype
         res_indptr = np.zeros(M+1, dtype=idx_dtype)
-        np.cumsum(row_nnz[idx], out=res_indptr[1:])
+        np.cumsum(self.indptr[indices + 1] - self.indptr[indices],
+                  out=res_indptr[1:])
 
         nnz = res_indptr[-1]
         res_indices = np.empty(nnz, dtype=idx_dtype)
         res_data = np.empty(nnz, dtype=self.dtype)
-        csr_row_index(M, indices, self.indptr, self.indices, self.data,
-                      res_indices, res_data)
+        if workers > 1:
+            _sparsetools.csr_row_index_threaded(
+                M, indices, self.indptr, self.indices, self.data, res_indptr,
+                res_indices, res_data, workers)
+        else:
+            csr_row_index(M, indices, self.indptr, self.indices, self.data,
+                          res_indices, res_data)
 
         return self.__class__((res_data, res_indices, res_indptr),
                               shape=new_shape, copy=False)
@@ -870,6 +967,17 @@ class _cs_matrix(_data_matrix, _minmax_mixin, IndexMixin):
         check_bounds(j, N)
         return i, j, M, N
 
+    def _sample_offsets(self, i, j, offsets):
+        """Offsets into the data of entries (i, j), see csr_sample_offsets"""
+        M, N = self._swap(self.shape)
+        workers = _workers(None)
+        if workers > 1:
+            return _sparsetools.csr_sample_offsets_threaded(
+                M, N, self.indptr, self.indices, len(offsets), i, j, offsets,
+                workers)
+        return csr_sample_offsets(M, N, self.indptr, self.indices,
+                                  len(offsets), i, j, offsets)
+
     def _set_many(self, i, j, x):
         """Sets value at each (i, j) to x
 
@@ -881,13 +989,11 @@ class _cs_matrix(_data_matrix, _minmax_mixin, IndexMixin):
 
         n_samples = x.size
         offsets = np.empty(n_samples, dtype=self.indices.dtype)
-        ret = csr_sample_offsets(M, N, self.indptr, self.indices, n_samples,
-                                 i, j, offsets)
+        ret = self._sample_offsets(i, j, offsets)
         if ret == 1:
             # rinse and repeat
             self.sum_duplicates()
-            csr_sample_offsets(M, N, self.indptr, self.indices, n_samples,
-                               i, j, offsets)
+            self._sample_offsets(i, j, offsets)
 
         if -1 not in offsets:
             # only affects existing non-zero cells
@@ -918,13 +1024,11 @@ class _cs_matrix(_data_matrix, _minmax_mixin, IndexMixin):
 
         n_samples = len(i)
         offsets = np.empty(n_samples, dtype=self.indices.dtype)
-        ret = csr_sample_offsets(M, N, self.indptr, self.indices, n_samples,
-                                 i, j, offsets)
+        ret = self._sample_offsets(i, j, offsets)
         if ret == 1:
             # rinse and repeat
             self.sum_duplicates()
-            csr_sample_offsets(M, N, self.indptr, self.indices, n_samples,
-                               i, j, offsets)
+            self._sample_offsets(i, j, offsets)
 
         # only assign zeros to the existing sparsity structure
         self.data[offsets[offsets > -1]] = 0
@@ -1132,8 +1236,16 @@ class _cs_matrix(_data_matrix, _minmax_mixin, IndexMixin):
         """
 
         if not self.has_sorted_indices:
-            _sparsetools.csr_sort_indices(len(self.indptr) - 1, self.indptr,
-                                          self.indices, self.data)
+            workers = _workers(None)
+            if workers > 1:
+                _sparsetools.csr_sort_indices_threaded(len(self.indptr) - 1,
+                                                       self.indptr,
+                                                       self.indices,
+                                                       self.data, workers)
+            else:
+                _sparsetools.csr_sort_indices(len(self.indptr) - 1,
+                                              self.indptr, self.indices,
+                                              self.data)
             self.has_sorted_indices = True
 
     def prune(self):
@@ -1226,14 +1338,24 @@ class _cs_matrix(_data_matrix, _minmax_mixin, IndexMixin):
         else:
             data = np.empty(maxnnz, dtype=upcast(self.dtype, other.dtype))
 
-        fn(self.shape[0], self.shape[1],
-           np.asarray(self.indptr, dtype=idx_dtype),
-           np.asarray(self.indices, dtype=idx_dtype),
-           self.data,
-           np.asarray(other.indptr, dtype=idx_dtype),
-           np.asarray(other.indices, dtype=idx_dtype),
-           other.data,
-           indptr, indices, data)
+        args = (self.shape[0], self.shape[1],
+                np.asarray(self.indptr, dtype=idx_dtype),
+                np.asarray(self.indices, dtype=idx_dtype),
+                self.data,
+                np.asarray(other.indptr, dtype=idx_dtype),
+                np.asarray(other.indices, dtype=idx_dtype),
+                other.data,
+                indptr, indices, data)
+
+        workers = _workers(None)
+        if workers > 1:
+            # e.g. csr_binop_csr_threaded, csr_cmpop_csr_threaded
+            kind = 'cmpop' if op in bool_ops else 'binop'
+            fn = getattr(_sparsetools, '{0}_{1}_{0}_threaded'.format(
+                self.format, kind))
+            fn(*(args + (_binop_codes[op], workers)))
+        else:
+            fn(*args)
 
         A = self.__class__((data, indices, indptr), shape=self.shape)
         A.prune()
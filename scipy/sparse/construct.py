@@ -22,6 +22,8 @@ from .coo import coo_matrix
 from .dia import dia_matrix
 
 from .base import issparse
+from . import _sparsetools
+from ._workers import _workers
 
 
 def spdiags(data, diags, m, n, format=None):
@@ -283,7 +285,8 @@ def kron(A, B, format=None):
     B : sparse or dense matrix
         second matrix of the product
     format : str, optional
-        format of the result (e.g. "csr")
+        format of the result (e.g. "csr"). By default, a BSR matrix is
+        returned if `B` is fairly dense, and a CSR matrix otherwise.
 
     Returns
     -------
@@ -309,6 +312,7 @@ def kron(A, B, format=None):
 
     """
     B = coo_matrix(B)
+    workers = _workers(None)
 
     if (format is None or format == "bsr") and 2*B.nnz >= B.shape[0] * B.shape[1]:
         # B is fairly dense, use BSR
@@ -320,39 +324,51 @@ def kron(A, B, format=None):
             # kronecker product is the zero matrix
             return coo_matrix(output_shape)
 
-        B = B.toarray()
-        data = A.data.repeat(B.size).reshape(-1,B.shape[0],B.shape[1])
-        data = data * B
+        dtype = upcast(A.dtype, B.dtype)
+        B = B.toarray().astype(dtype, copy=False)
+        data = np.empty((A.nnz,) + B.shape, dtype=dtype)
+        _sparsetools.csr_kron_bsr(A.shape[0], A.indptr,
+                                  A.data.astype(dtype, copy=False),
+                                  B.shape[0], B.shape[1], B.ravel(),
+                                  data.ravel(), workers)
 
         return bsr_matrix((data,A.indices,A.indptr), shape=output_shape)
     else:
-        # use COO
-        A = coo_matrix(A)
+        # use CSR; a CSC result is the transpose of the CSR product of
+        # the transposes
+        if format == 'csc':
+            A = csc_matrix(A).T
+            B = B.tocsc().T
+        else:
+            A = csr_matrix(A)
+            B = B.tocsr()
         output_shape = (A.shape[0]*B.shape[0], A.shape[1]*B.shape[1])
 
         if A.nnz == 0 or B.nnz == 0:
             # kronecker product is the zero matrix
-            return coo_matrix(output_shape)
-
-        # expand entries of a into blocks
-        row = A.row.repeat(B.nnz)
-        col = A.col.repeat(B.nnz)
-        data = A.data.repeat(B.nnz)
-
-        row *= B.shape[0]
-        col *= B.shape[1]
-
-        # increment block indices
-        row,col = row.reshape(-1,B.nnz),col.reshape(-1,B.nnz)
-        row += B.row
-        col += B.col
-        row,col = row.reshape(-1),col.reshape(-1)
-
-        # compute block entries
-        data = data.reshape(-1,B.nnz) * B.data
-        data = data.reshape(-1)
-
-        return coo_matrix((data,(row,col)), shape=output_shape).asformat(format)
+            C = coo_matrix(output_shape)
+            return (C.T if format == 'csc' else C).asformat(format)
+
+        nnz = A.nnz * B.nnz
+        idx_dtype = get_index_dtype(maxval=max(output_shape + (nnz,)))
+        dtype = upcast(A.dtype, B.dtype)
+        indptr = np.empty(output_shape[0] + 1, dtype=idx_dtype)
+        indices = np.empty(nnz, dtype=idx_dtype)
+        data = np.empty(nnz, dtype=dtype)
+        _sparsetools.csr_kron(A.shape[0], A.shape[1],
+                              A.indptr.astype(idx_dtype, copy=False),
+                              A.indices.astype(idx_dtype, copy=False),
+                              A.data.astype(dtype, copy=False),
+                              B.shape[0], B.shape[1],
+                              B.indptr.astype(idx_dtype, copy=False),
+                              B.indices.astype(idx_dtype, copy=False),
+                              B.data.astype(dtype, copy=False),
+                              indptr, indices, data, workers)
+
+        C = csr_matrix((data, indices, indptr), shape=output_shape)
+        if format == 'csc':
+            return C.T
+        return C.asformat(format)
 
 
 def kronsum(A, B, format=None):
@@ -432,6 +448,105 @@ def _compressed_sparse_stack(blocks, axis):
                           shape=(constant_dim, sum_dim))
 
 
+def _block_shapes(blocks):
+    """
+    Check the shapes of a grid of blocks, converting those that are not
+    sparse to COO in place, and return the mask of the blocks given and the
+    numbers of rows and columns of the block rows and columns.
+    """
+    M, N = blocks.shape
+    block_mask = np.zeros(blocks.shape, dtype=bool)
+    brow_lengths = np.zeros(M, dtype=np.int64)
+    bcol_lengths = np.zeros(N, dtype=np.int64)
+
+    for i in range(M):
+        for j in range(N):
+            if blocks[i,j] is not None:
+                A = blocks[i,j]
+                if not issparse(A):
+                    A = coo_matrix(A)
+                    blocks[i,j] = A
+                block_mask[i,j] = True
+
+                if brow_lengths[i] == 0:
+                    brow_lengths[i] = A.shape[0]
+                elif brow_lengths[i] != A.shape[0]:
+                    msg = ('blocks[{i},:] has incompatible row dimensions. '
+                           'Got blocks[{i},{j}].shape[0] == {got}, '
+                           'expected {exp}.'.format(i=i, j=j,
+                                                    exp=brow_lengths[i],
+                                                    got=A.shape[0]))
+                    raise ValueError(msg)
+
+                if bcol_lengths[j] == 0:
+                    bcol_lengths[j] = A.shape[1]
+                elif bcol_lengths[j] != A.shape[1]:
+                    msg = ('blocks[:,{j}] has incompatible row dimensions. '
+                           'Got blocks[{i},{j}].shape[1] == {got}, '
+                           'expected {exp}.'.format(i=i, j=j,
+                                                    exp=bcol_lengths[j],
+                                                    got=A.shape[1]))
+                    raise ValueError(msg)
+
+    return block_mask, brow_lengths, bcol_lengths
+
+
+def _compressed_sparse_bmat(blocks, brow_lengths, bcol_lengths, format,
+                            dtype):
+    """
+    Assemble a grid of blocks straight into the arrays of a CSR or CSC
+    matrix. The entries of each row are counted first; then the blocks of
+    each block row are copied into place, from left to right, by
+    csr_append_block. A CSC matrix is assembled as the CSR matrix of its
+    transpose.
+    """
+    if format == 'csc':
+        blocks = blocks.T
+        brow_lengths, bcol_lengths = bcol_lengths, brow_lengths
+        blocks = [[None if b is None else b.tocsc().T for b in row]
+                  for row in blocks]
+    else:
+        blocks = [[None if b is None else b.tocsr() for b in row]
+                  for row in blocks]
+
+    given = [b for row in blocks for b in row if b is not None]
+    nnz = sum(b.nnz for b in given)
+    if dtype is None:
+        dtype = upcast(*[b.dtype for b in given]) if given else None
+
+    row_offsets = np.append(0, np.cumsum(brow_lengths))
+    col_offsets = np.append(0, np.cumsum(bcol_lengths))
+    shape = (int(row_offsets[-1]), int(col_offsets[-1]))
+    idx_dtype = get_index_dtype(maxval=max(shape + (nnz,)))
+
+    # the number of entries of each row, then the row pointer
+    indptr = np.zeros(shape[0] + 1, dtype=idx_dtype)
+    for i, row in enumerate(blocks):
+        counts = indptr[row_offsets[i] + 1:row_offsets[i + 1] + 1]
+        for b in row:
+            if b is not None:
+                counts += np.diff(b.indptr)
+    np.cumsum(indptr, out=indptr)
+
+    indices = np.empty(nnz, dtype=idx_dtype)
+    data = np.empty(nnz, dtype=dtype)
+    workers = _workers(None)
+    for i, row in enumerate(blocks):
+        next_pos = indptr[row_offsets[i]:row_offsets[i + 1]].copy()
+        for j, b in enumerate(row):
+            if b is None or b.nnz == 0:
+                continue
+            _sparsetools.csr_append_block(
+                b.shape[0], int(col_offsets[j]),
+                b.indptr.astype(idx_dtype, copy=False),
+                b.indices.astype(idx_dtype, copy=False),
+                b.data.astype(dtype, copy=False),
+                next_pos, indices, data, workers)
+
+    A = csr_matrix((data, indices, indptr), shape=shape)
+    return A.T if format == 'csc' else A
+
+
 def hstack(blocks, format=None, dtype=None):
     """
     Stack sparse matrices horizontally (column wise)
@@ -563,37 +678,20 @@ def bmat(blocks, format=None, dtype=None):
             A = A.astype(dtype)
         return A
 
-    block_mask = np.zeros(blocks.shape, dtype=bool)
-    brow_lengths = np.zeros(M, dtype=np.int64)
-    bcol_lengths = np.zeros(N, dtype=np.int64)
-
-    # convert everything to COO format
-    for i in range(M):
-        for j in range(N):
-            if blocks[i,j] is not None:
-                A = coo_matrix(blocks[i,j])
-                blocks[i,j] = A
-                block_mask[i,j] = True
+    block_mask, brow_lengths, bcol_lengths = _block_shapes(blocks)
 
-                if brow_lengths[i] == 0:
-                    brow_lengths[i] = A.shape[0]
-                elif brow_lengths[i] != A.shape[0]:
-                    msg = ('blocks[{i},:] has incompatible row dimensions. '
-                           'Got blocks[{i},{j}].shape[0] == {got}, '
-                           'expected {exp}.'.format(i=i, j=j,
-                                                    exp=brow_lengths[i],
-                                                    got=A.shape[0]))
-                    raise ValueError(msg)
+    # CSR and CSC results are assembled without going through COO
+    if format is None and block_mask.any():
+        formats = set(b.format for b in blocks[block_mask])
+        if formats == {'csr'} or formats == {'csc'}:
+            format = formats.pop()
+    if format in ('csr', 'csc'):
+        return _compressed_sparse_bmat(blocks, brow_lengths, bcol_lengths,
+                                       format, dtype)
 
-                if bcol_lengths[j] == 0:
-                    bcol_lengths[j] = A.shape[1]
-                elif bcol_lengths[j] != A.shape[1]:
-                    msg = ('blocks[:,{j}] has incompatible row dimensions. '
-                           'Got blocks[{i},{j}].shape[1] == {got}, '
-                           'expected {exp}.'.format(i=i, j=j,
-                                                    exp=bcol_lengths[j],
-                                                    got=A.shape[1]))
-                    raise ValueError(msg)
+    # convert everything to COO format
+    for i, j in zip(*np.nonzero(block_mask)):
+        blocks[i,j] = coo_matrix(blocks[i,j])
 
     nnz = sum(block.nnz for block in blocks[block_mask])
     if dtype is None:
@@ -665,16 +763,43 @@ def block_diag(mats, format=None, dtype=None):
            [0, 0, 0, 7]])
 
     """
-    nmat = len(mats)
-    rows = []
-    for ia, a in enumerate(mats):
-        row = [None]*nmat
-        if issparse(a):
-            row[ia] = a
-        else:
-            row[ia] = coo_matrix(a)
-        rows.append(row)
-    return bmat(rows, format=format, dtype=dtype)
+    mats = [a if issparse(a) else coo_matrix(a) for a in mats]
+    # a CSC result is the transpose of the block diagonal of the transposes
+    if format == 'csc':
+        mats = [a.tocsc().T for a in mats]
+    else:
+        mats = [a.tocsr() for a in mats]
+
+    nnz = sum(a.nnz for a in mats)
+    if dtype is None:
+        dtype = upcast(*[a.dtype for a in mats]) if mats else None
+    shape = (sum(a.shape[0] for a in mats), sum(a.shape[1] for a in mats))
+    idx_dtype = get_index_dtype(maxval=max(shape + (nnz,)))
+
+    # each block is copied into its rows by csr_append_block
+    indptr = np.zeros(shape[0] + 1, dtype=idx_dtype)
+    indices = np.empty(nnz, dtype=idx_dtype)
+    data = np.empty(nnz, dtype=dtype)
+    workers = _workers(None)
+    row = col = pos = 0
+    for a in mats:
+        n_row = a.shape[0]
+        indptr[row + 1:row + n_row + 1] = a.indptr[1:] - a.indptr[0] + pos
+        if a.nnz:
+            next_pos = indptr[row:row + n_row].copy()
+            _sparsetools.csr_append_block(
+                n_row, col, a.indptr.astype(idx_dtype, copy=False),
+                a.indices.astype(idx_dtype, copy=False),
+                a.data.astype(dtype, copy=False),
+                next_pos, indices, data, workers)
+        row += n_row
+        col += a.shape[1]
+        pos += a.nnz
+
+    A = csr_matrix((data, indices, indptr), shape=shape)
+    if format == 'csc':
+        return A.T
+    return A.asformat('coo' if format is None else format)
 
 
 def random(m, n, density=0.01, format='coo', dtype=None,
@@ -715,6 +840,13 @@ def random(m, n, density=0.01, format='coo', dtype=None,
     -----
     Only float types are supported for now.
 
+    When `random_state` is a `numpy.random.RandomState` or the singleton
+    numpy.random, the matrix is generated directly in canonical CSR
+    format: the number of nonzeros in each row is drawn first, and the
+    columns of the rows are then drawn in compiled code, on the threads set
+    by `scipy.sparse.set_workers`. The rows use independent random streams,
+    so that the result does not depend on the number of threads.
+
     Examples
     --------
     >>> from scipy.sparse import random
@@ -785,6 +917,13 @@ greater than %d - this is not supported on this machine
         else:
             data_rvs = random_state.rand
 
+    if random_state is np.random or type(random_state) is np.random.RandomState:
+        indptr, indices = _random_csr_structure(m, n, k, random_state)
+        vals = data_rvs(k).astype(dtype, copy=False)
+        A = csr_matrix((vals, indices, indptr), shape=(m, n))
+        A.has_canonical_format = True
+        return A.asformat(format, copy=False)
+
     ind = random_state.choice(mn, size=k, replace=False)
 
     j = np.floor(ind * 1. / m).astype(tp, copy=False)
@@ -794,6 +933,51 @@ greater than %d - this is not supported on this machine
                                                              copy=False)
 
 
+def _random_row_counts(m, n, k, random_state):
+    """
+    The number of nonzeros in each row of an (m, n) matrix with `k`
+    nonzeros at uniformly random positions
+
+    The counts follow a multivariate hypergeometric distribution, which is
+    drawn by splitting the rows in halves: the nonzeros of a block of rows
+    fall in its first half with a hypergeometric distribution, all blocks
+    of a level being drawn at once.
+    """
+    sizes = np.array([m], dtype=np.int64)
+    counts = np.array([k], dtype=np.int64)
+    while len(sizes) < m:
+        half = sizes // 2
+        left = np.zeros_like(counts)
+        split = (half > 0) & (counts > 0)
+        if split.any():
+            left[split] = random_state.hypergeometric(
+                half[split] * n, (sizes - half)[split] * n, counts[split])
+        sizes = np.column_stack((half, sizes - half)).ravel()
+        counts = np.column_stack((left, counts - left)).ravel()
+        nonempty = sizes > 0
+        sizes = sizes[nonempty]
+        counts = counts[nonempty]
+    return counts
+
+
+def _random_csr_structure(m, n, k, random_state):
+    """
+    The row pointer and sorted column indices of an (m, n) CSR matrix with
+    `k` nonzeros at uniformly random positions
+    """
+    idx_dtype = get_index_dtype(maxval=max(m, n, k))
+    indptr = np.zeros(m + 1, dtype=idx_dtype)
+    indices = np.empty(k, dtype=idx_dtype)
+    if k == 0:
+        return indptr, indices
+
+    np.cumsum(_random_row_counts(m, n, k, random_state), out=indptr[1:])
+    seed = random_state.randint(np.iinfo(np.int64).max, dtype=np.int64)
+    _sparsetools.csr_random_indices(m, n, indptr, seed, indices,
+                                    _workers(None))
+    return indptr, indices
+
+
 def rand(m, n, density=0.01, format="coo", dtype=None, random_state=None):
     """Generate a sparse matrix of the given shape and density with uniformly
     distributed values.
@@ -834,7 +1018,7 @@ def rand(m, n, density=0.01, format="coo", dtype=None, random_state=None):
     <3x4 sparse matrix of type '<class 'numpy.float64'>'
        with 3 stored elements in Compressed Sparse Row format>
     >>> matrix.todense()
-    matrix([[0.05641158, 0.        , 0.        , 0.65088847],
+    matrix([[0.05641158, 0.        , 0.        , 0.65088847],   # random
             [0.        , 0.        , 0.        , 0.14286682],
             [0.        , 0.        , 0.        , 0.        ]])
 
@@ -11,7 +11,9 @@ import numpy as np
 
 from scipy._lib.six import zip as izip
 
-from ._sparsetools import coo_tocsr, coo_todense, coo_matvec
+from ._sparsetools import (coo_tocsr, coo_tocsr_canonical, coo_todense,
+                           coo_matvec)
+from ._workers import _workers
 from .base import isspmatrix, SparseEfficiencyWarning, spmatrix
 from .data import _data_matrix, _minmax_mixin
 from .sputils import (upcast, upcast_char, to_native, isshape, getdtype,
@@ -363,12 +365,16 @@ class coo_matrix(_data_matrix, _minmax_mixin):
             indices = np.empty_like(row, dtype=idx_dtype)
             data = np.empty_like(self.data, dtype=upcast(self.dtype))
 
-            coo_tocsr(N, M, self.nnz, col, row, self.data,
-                      indptr, indices, data)
+            if self.has_canonical_format:
+                coo_tocsr(N, M, self.nnz, col, row, self.data,
+                          indptr, indices, data)
+                return csc_matrix((data, indices, indptr), shape=self.shape)
 
+            # sorts and sums duplicates, leaving indptr[-1] <= nnz entries
+            coo_tocsr_canonical(N, M, self.nnz, col, row, self.data,
+                                indptr, indices, data, _workers(None))
             x = csc_matrix((data, indices, indptr), shape=self.shape)
-            if not self.has_canonical_format:
-                x.sum_duplicates()
+            x.has_canonical_format = True
             return x
 
     def tocsr(self, copy=False):
@@ -405,12 +411,16 @@ class coo_matrix(_data_matrix, _minmax_mixin):
             indices = np.empty_like(col, dtype=idx_dtype)
             data = np.empty_like(self.data, dtype=upcast(self.dtype))
 
-            coo_tocsr(M, N, self.nnz, row, col, self.data,
-                      indptr, indices, data)
+            if self.has_canonical_format:
+                coo_tocsr(M, N, self.nnz, row, col, self.data,
+                          indptr, indices, data)
+                return csr_matrix((data, indices, indptr), shape=self.shape)
 
+            # sorts and sums duplicates, leaving indptr[-1] <= nnz entries
+            coo_tocsr_canonical(M, N, self.nnz, row, col, self.data,
+                                indptr, indices, data, _workers(None))
             x = csr_matrix((data, indices, indptr), shape=self.shape)
-            if not self.has_canonical_format:
-                x.sum_duplicates()
+            x.has_canonical_format = True
             return x
 
     def tocoo(self, copy=False):
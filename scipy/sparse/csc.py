@@ -9,7 +9,8 @@ __all__ = ['csc_matrix', 'isspmatrix_csc']
 import numpy as np
 
 from .base import spmatrix
-from ._sparsetools import csc_tocsr, expandptr
+from ._sparsetools import csc_tocsr, csc_tocsr_threaded, expandptr
+from ._workers import _workers
 from .sputils import upcast, get_index_dtype
 
 from .compressed import _cs_matrix
@@ -141,13 +142,19 @@ class csc_matrix(_cs_matrix):
         indices = np.empty(self.nnz, dtype=idx_dtype)
         data = np.empty(self.nnz, dtype=upcast(self.dtype))
 
-        csc_tocsr(M, N,
-                  self.indptr.astype(idx_dtype),
-                  self.indices.astype(idx_dtype),
-                  self.data,
-                  indptr,
-                  indices,
-                  data)
+        args = (M, N,
+                self.indptr.astype(idx_dtype),
+                self.indices.astype(idx_dtype),
+                self.data,
+                indptr,
+                indices,
+                data)
+
+        workers = _workers(None)
+        if workers > 1:
+            csc_tocsr_threaded(*(args + (workers,)))
+        else:
+            csc_tocsr(*args)
 
         from .csr import csr_matrix
         A = csr_matrix((data, indices, indptr), shape=self.shape, copy=False)
@@ -0,0 +1,105 @@
+/*
+ * Min-plus kernels of the blocked Floyd-Warshall algorithm in
+ * _shortest_path.pyx.
+ *
+ * The distance matrix D is n x n in C order, and so is the predecessor
+ * matrix P when it is not NULL. A tile update relaxes the entries of
+ * rows [i0, i1) and columns [j0, j1) through the nodes [k0, k1):
+ *
+ *     D[i, j] = min(D[i, j], D[i, k] + D[k, j])
+ *
+ * and, when an entry decreases, P[i, j] = P[k, j]. With seq set, k is
+ * the outer loop, as the tiles which contain some of the nodes k need;
+ * otherwise, for the tiles which do not, the rows of D[i, k] are taken
+ * one at a time, which keeps the tile in the cache.
+ *
+ * The innermost loop runs over a row of the tile, and is a select
+ * between the current distances and the candidates, which compilers
+ * vectorize without -ffast-math. GCC does so only from -O3 on, which is
+ * asked for here.
+ */
+#ifndef FLOYD_WARSHALL_H
+#define FLOYD_WARSHALL_H
+
+#include <numpy/npy_common.h>
+#include <numpy/npy_math.h>
+
+#if defined(__GNUC__) && !defined(__clang__) && !defined(__INTEL_COMPILER)
+#define FW_LOOP_OPT __attribute__((optimize("O3")))
+#else
+#define FW_LOOP_OPT
+#endif
+
+#define FW_KERNELS(T, SUFFIX)                                               \
+                                                                            \
+static FW_LOOP_OPT void                                                     \
+fw_row##SUFFIX(T *NPY_RESTRICT c, const T *NPY_RESTRICT b, T a,             \
+               npy_intp len)                                                \
+{                                                                           \
+    npy_intp j;                                                             \
+    for (j = 0; j < len; j++) {                                             \
+        T s = a + b[j];                                                     \
+        c[j] = (s < c[j]) ? s : c[j];                                       \
+    }                                                                       \
+}                                                                           \
+                                                                            \
+static FW_LOOP_OPT void                                                     \
+fw_row_pred##SUFFIX(T *NPY_RESTRICT c, int *NPY_RESTRICT p,                 \
+                    const T *NPY_RESTRICT b, const int *NPY_RESTRICT pb,    \
+                    T a, npy_intp len)                                      \
+{                                                                           \
+    npy_intp j;                                                             \
+    for (j = 0; j < len; j++) {                                             \
+        T s = a + b[j];                                                     \
+        if (s < c[j]) {                                                     \
+            c[j] = s;                                                       \
+            p[j] = pb[j];                                                   \
+        }                                                                   \
+    }                                                                       \
+}                                                                           \
+                                                                            \
+/* row i through node k; row k itself does not change unless D[k, k] < 0,  \
+ * in which case there is a negative cycle either way */                   \
+static NPY_INLINE void                                                      \
+fw_relax##SUFFIX(T *D, int *P, npy_intp n, npy_intp i, npy_intp k,          \
+                 npy_intp j0, npy_intp j1)                                  \
+{                                                                           \
+    T a = D[i * n + k];                                                     \
+    if (i == k || a == NPY_INFINITY) {                                      \
+        return;                                                             \
+    }                                                                       \
+    if (P == NULL) {                                                        \
+        fw_row##SUFFIX(D + i * n + j0, D + k * n + j0, a, j1 - j0);         \
+    }                                                                       \
+    else {                                                                  \
+        fw_row_pred##SUFFIX(D + i * n + j0, P + i * n + j0,                 \
+                            D + k * n + j0, P + k * n + j0, a, j1 - j0);    \
+    }                                                                       \
+}                                                                           \
+                                                                            \
+static void                                                                 \
+fw_tile##SUFFIX(T *D, int *P, npy_intp n, npy_intp i0, npy_intp i1,         \
+                npy_intp j0, npy_intp j1, npy_intp k0, npy_intp k1,         \
+                int seq)                                                    \
+{                                                                           \
+    npy_intp i, k;                                                          \
+    if (seq) {                                                              \
+        for (k = k0; k < k1; k++) {                                         \
+            for (i = i0; i < i1; i++) {                                     \
+                fw_relax##SUFFIX(D, P, n, i, k, j0, j1);                    \
+            }                                                               \
+        }                                                                   \
+    }                                                                       \
+    else {                                                                  \
+        for (i = i0; i < i1; i++) {                                         \
+            for (k = k0; k < k1; k++) {                                     \
+                fw_relax##SUFFIX(D, P, n, i, k, j0, j1);                    \
+            }                                                               \
+        }                                                                   \
+    }                                                                       \
+}
+
+FW_KERNELS(double, _d)
+FW_KERNELS(float, _f)
+
+#endif
@@ -11,6 +11,9 @@ from __future__ import division, print_function, absolute_import
 
 import numpy as np
 from scipy.sparse import isspmatrix
+from scipy.sparse._sparsetools import csr_laplacian_degrees, csr_laplacian
+from scipy.sparse._workers import _workers
+from scipy.sparse.sputils import get_index_dtype
 
 
 ###############################################################################
@@ -49,6 +52,11 @@ def laplacian(csgraph, normed=False, return_diag=False, use_out_degree=False):
     parts of spectral graph theory.  In particular, the eigen-decomposition
     of the laplacian matrix can give insight into many properties of the graph.
 
+    For a CSR or CSC graph, the Laplacian is returned in the same format. It
+    is built in compiled code from one pass computing the degrees and one
+    writing the result, on the threads that `scipy.sparse.set_workers`
+    allows.
+
     Examples
     --------
     >>> from scipy.sparse import csgraph
@@ -85,7 +93,43 @@ def _setdiag_dense(A, d):
     A.flat[::len(d)+1] = d
 
 
+def _laplacian_compressed(graph, normed=False, axis=0):
+    # A CSC matrix is the CSR matrix of its transpose, whose in- and
+    # out-degrees are swapped, and whose Laplacian is the transpose.
+    n = graph.shape[0]
+    nnz = graph.indptr[-1]
+    out_degree = (axis == 1) == (graph.format == 'csr')
+    workers = _workers(None)
+
+    idx_dtype = get_index_dtype((graph.indptr, graph.indices),
+                                maxval=nnz + n)
+    indptr = graph.indptr.astype(idx_dtype, copy=False)
+    indices = graph.indices.astype(idx_dtype, copy=False)
+    data = graph.data
+
+    w = np.empty(n, dtype=data.dtype)
+    csr_laplacian_degrees(n, indptr, indices, data, out_degree, w, workers)
+    if normed:
+        isolated_node_mask = (w == 0)
+        w = np.where(isolated_node_mask, 1, np.sqrt(w)).astype(data.dtype)
+        diag = (1 - isolated_node_mask).astype(data.dtype)
+    else:
+        diag = w
+
+    lap_indptr = np.empty(n + 1, dtype=idx_dtype)
+    lap_indices = np.empty(nnz + n, dtype=idx_dtype)
+    lap_data = np.empty(nnz + n, dtype=data.dtype)
+    csr_laplacian(n, indptr, indices, data, diag, normed, w,
+                  lap_indptr, lap_indices, lap_data, workers)
+    lap_nnz = lap_indptr[-1]
+    m = graph.__class__((lap_data[:lap_nnz], lap_indices[:lap_nnz],
+                         lap_indptr), shape=graph.shape)
+    return m, w
+
+
 def _laplacian_sparse(graph, normed=False, axis=0):
+    if graph.format in ('csr', 'csc') and graph.dtype.kind in 'iufc':
+        return _laplacian_compressed(graph, normed=normed, axis=axis)
     if graph.format in ('lil', 'dok'):
         m = graph.tocoo()
         needs_copy = False
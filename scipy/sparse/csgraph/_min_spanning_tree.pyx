@@ -9,18 +9,21 @@ cimport cython
 
 from scipy.sparse import csr_matrix, isspmatrix_csc, isspmatrix
 from scipy.sparse.csgraph._validation import validate_graph
+from scipy.sparse._sparsetools import cs_graph_mst_boruvka
+from scipy.sparse._workers import _workers
 
 include 'parameters.pxi'
 
-def minimum_spanning_tree(csgraph, overwrite=False):
+def minimum_spanning_tree(csgraph, overwrite=False, method='kruskal'):
     r"""
-    minimum_spanning_tree(csgraph, overwrite=False)
+    minimum_spanning_tree(csgraph, overwrite=False, method='kruskal')
 
     Return a minimum spanning tree of an undirected graph
 
     A minimum spanning tree is a graph consisting of the subset of edges
     which together connect all connected nodes, while minimizing the total
-    sum of weights on the edges.  This is computed using the Kruskal algorithm.
+    sum of weights on the edges.  This is computed using the Kruskal algorithm,
+    or Boruvka's algorithm.
 
     .. versionadded:: 0.11.0
 
@@ -32,6 +35,10 @@ def minimum_spanning_tree(csgraph, overwrite=False):
     overwrite : bool, optional
         if true, then parts of the input graph will be overwritten for
         efficiency.
+    method : {'kruskal', 'boruvka'}, optional
+        Algorithm to use (see notes below). Default is 'kruskal'.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -46,6 +53,20 @@ def minimum_spanning_tree(csgraph, overwrite=False):
     have an edge connecting them.  If either is nonzero, then the two are
     connected by the minimum nonzero value of the two.
 
+    Kruskal's algorithm sorts all of the edges by weight, and adds them to
+    the tree in that order. Boruvka's algorithm [1]_ instead grows the
+    tree in rounds: each subtree found so far adds its lightest edge to
+    another one at once, and the edges within subtrees are dropped. It
+    needs no sort, and runs on several threads if
+    `scipy.sparse.set_workers` allows. Where weights are equal, the two
+    may return different trees of the same total weight.
+
+    References
+    ----------
+    .. [1] D. A. Bader, G. Cong, "Fast shared-memory algorithms for
+           computing the minimum spanning forest of sparse graphs",
+           Journal of Parallel and Distributed Computing 66, 2006
+
     Examples
     --------
     The following example shows the computation of a minimum spanning tree
@@ -81,6 +102,9 @@ def minimum_spanning_tree(csgraph, overwrite=False):
            [0, 0, 0, 0]])
     """
     global NULL_IDX
+
+    if method not in ('kruskal', 'boruvka'):
+        raise ValueError("method must be 'kruskal' or 'boruvka'")
     
     csgraph = validate_graph(csgraph, True, DTYPE, dense_output=False,
                              copy_if_sparse=not overwrite)
@@ -90,14 +114,19 @@ def minimum_spanning_tree(csgraph, overwrite=False):
     indices = csgraph.indices
     indptr = csgraph.indptr
 
-    rank = np.zeros(N, dtype=ITYPE)
-    predecessors = np.arange(N, dtype=ITYPE)
+    if method == 'boruvka':
+        keep = np.zeros(len(data), dtype=bool)
+        cs_graph_mst_boruvka(N, indptr, indices, data, keep, _workers(None))
+        data[~keep] = 0
+    else:
+        rank = np.zeros(N, dtype=ITYPE)
+        predecessors = np.arange(N, dtype=ITYPE)
 
-    i_sort = np.argsort(data).astype(ITYPE)
-    row_indices = np.zeros(len(data), dtype=ITYPE)
+        i_sort = np.argsort(data).astype(ITYPE)
+        row_indices = np.zeros(len(data), dtype=ITYPE)
 
-    _min_spanning_tree(data, indices, indptr, i_sort,
-                       row_indices, predecessors, rank)
+        _min_spanning_tree(data, indices, indptr, i_sort,
+                           row_indices, predecessors, rank)
 
     sp_tree = csr_matrix((data, indices, indptr), (N, N))
     sp_tree.eliminate_zeros()
@@ -10,12 +10,15 @@ from warnings import warn
 from scipy.sparse import (csc_matrix, isspmatrix, isspmatrix_coo, 
                         isspmatrix_csc, isspmatrix_csr,
                         SparseEfficiencyWarning)
+from scipy.sparse._sparsetools import (cs_graph_bipartite_matching,
+                                      cs_graph_rcm)
+from scipy.sparse._workers import _workers
 
 include 'parameters.pxi'
 
-def reverse_cuthill_mckee(graph, symmetric_mode=False):
+def reverse_cuthill_mckee(graph, symmetric_mode=False, start='min_degree'):
     """
-    reverse_cuthill_mckee(graph, symmetric_mode=False)
+    reverse_cuthill_mckee(graph, symmetric_mode=False, start='min_degree')
     
     Returns the permutation array that orders a sparse CSR or CSC matrix
     in Reverse-Cuthill McKee ordering.  
@@ -31,6 +34,12 @@ def reverse_cuthill_mckee(graph, symmetric_mode=False):
         Input sparse in CSC or CSR sparse matrix format.
     symmetric_mode : bool, optional
         Is input matrix guaranteed to be symmetric.
+    start : {'min_degree', 'pseudo_peripheral'}, optional
+        Where the ordering of each connected component starts: at a node of
+        lowest degree, as in the original paper, or at a pseudo-peripheral
+        node found from it [2]_, which usually gives a smaller bandwidth.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -39,12 +48,20 @@ def reverse_cuthill_mckee(graph, symmetric_mode=False):
  
     Notes
     -----
+    The connected components are ordered on several threads if
+    `scipy.sparse.set_workers` allows; the ordering does not depend on the
+    number of threads.
+
     .. versionadded:: 0.15.0
 
     References
     ----------
-    E. Cuthill and J. McKee, "Reducing the Bandwidth of Sparse Symmetric Matrices",
-    ACM '69 Proceedings of the 1969 24th national conference, (1969).
+    .. [1] E. Cuthill and J. McKee, "Reducing the Bandwidth of Sparse
+           Symmetric Matrices", ACM '69 Proceedings of the 1969 24th
+           national conference, (1969).
+    .. [2] A. George and J. W. H. Liu, "An Implementation of a
+           Pseudoperipheral Node Finder", ACM Trans. Math. Softw. 5,
+           (1979).
 
     Examples
     --------
@@ -71,15 +88,18 @@ def reverse_cuthill_mckee(graph, symmetric_mode=False):
     """
     if not (isspmatrix_csc(graph) or isspmatrix_csr(graph)):
         raise TypeError('Input must be in CSC or CSR sparse matrix format.')
+    if start not in ('min_degree', 'pseudo_peripheral'):
+        raise ValueError("start must be 'min_degree' or 'pseudo_peripheral'")
     nrows = graph.shape[0]
     if not symmetric_mode:
         graph = graph+graph.transpose()
-    return _reverse_cuthill_mckee(graph.indices, graph.indptr, nrows)
+    return _reverse_cuthill_mckee(graph.indices, graph.indptr, nrows,
+                                  start == 'pseudo_peripheral')
 
 
-def maximum_bipartite_matching(graph, perm_type='row'):
+def maximum_bipartite_matching(graph, perm_type='row', initial_matching=None):
     """
-    maximum_bipartite_matching(graph, perm_type='row')
+    maximum_bipartite_matching(graph, perm_type='row', initial_matching=None)
     
     Returns an array of row or column permutations that makes
     the diagonal of a nonsingular square CSC sparse matrix zero free.  
@@ -95,6 +115,12 @@ def maximum_bipartite_matching(graph, perm_type='row'):
         Input sparse in CSC format
     perm_type : str, {'row', 'column'}
         Type of permutation to generate.
+    initial_matching : ndarray, optional
+        A permutation returned by an earlier call with the same `perm_type`,
+        for instance on a slightly different graph, to start from. Its
+        pairs which are not in `graph` are dropped.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -103,17 +129,20 @@ def maximum_bipartite_matching(graph, perm_type='row'):
 
     Notes
     -----
-    This function relies on a maximum cardinality bipartite matching 
-    algorithm based on a breadth-first search (BFS) of the underlying 
-    graph.
+    This function relies on the maximum cardinality bipartite matching
+    algorithm of Hopcroft and Karp [2]_, started from a greedy matching.
+    Its breadth-first searches run on several threads if
+    `scipy.sparse.set_workers` allows.
 
     .. versionadded:: 0.15.0
 
     References
     ----------
-    I. S. Duff, K. Kaya, and B. Ucar, "Design, Implementation, and 
-    Analysis of Maximum Transversal Algorithms", ACM Trans. Math. Softw.
-    38, no. 2, (2011).
+    .. [1] I. S. Duff, K. Kaya, and B. Ucar, "Design, Implementation, and
+           Analysis of Maximum Transversal Algorithms", ACM Trans. Math.
+           Softw. 38, no. 2, (2011).
+    .. [2] J. E. Hopcroft, R. M. Karp, "An n^{5/2} algorithm for maximum
+           matchings in bipartite graphs", SIAM J. Comput. 2, 1973.
 
     Examples
     --------
@@ -150,7 +179,7 @@ def maximum_bipartite_matching(graph, perm_type='row'):
         raise TypeError("graph must be in CSC, CSR, or COO format.")
     if perm_type == 'column':
         graph = graph.transpose().tocsc()
-    perm = _maximum_bipartite_matching(graph.indices, graph.indptr, nrows)
+    perm = _maximum_bipartite_matching(graph, initial_matching)
     if np.any(perm==-1):
         raise Exception('Possibly singular input matrix.')
     return perm
@@ -179,128 +208,40 @@ cdef _node_degrees(
 
 def _reverse_cuthill_mckee(np.ndarray[int32_or_int64, ndim=1, mode="c"] ind,
         np.ndarray[int32_or_int64, ndim=1, mode="c"] ptr,
-        np.npy_intp num_rows):
+        np.npy_intp num_rows, bint pseudo_peripheral=False):
     """
     Reverse Cuthill-McKee ordering of a sparse symmetric CSR or CSC matrix.  
-    We follow the original Cuthill-McKee paper and always start the routine
-    at a node of lowest degree for each connected component.
+    We follow the original Cuthill-McKee paper and, unless
+    pseudo_peripheral, always start the routine at a node of lowest degree
+    for each connected component.
     """
-    cdef np.npy_intp N = 0, N_old, level_start, level_end, temp
-    cdef np.npy_intp zz, ii, jj, kk, ll, level_len
-    cdef np.ndarray[int32_or_int64] order = np.zeros(num_rows, dtype=ind.dtype)
-    cdef np.ndarray[int32_or_int64] degree = _node_degrees(ind, ptr, num_rows)
-    cdef np.ndarray[np.npy_intp] inds = np.argsort(degree)
-    cdef np.ndarray[np.npy_intp] rev_inds = np.argsort(inds)
-    cdef np.ndarray[ITYPE_t] temp_degrees = np.zeros(np.max(degree), dtype=ITYPE)
-    cdef int32_or_int64 i, j, seed, temp2
-    
-    # loop over zz takes into account possible disconnected graph.
-    for zz in range(num_rows):
-        if inds[zz] != -1:   # Do BFS with seed=inds[zz]
-            seed = inds[zz]
-            order[N] = seed
-            N += 1
-            inds[rev_inds[seed]] = -1
-            level_start = N - 1
-            level_end = N
-
-            while level_start < level_end:
-                for ii in range(level_start, level_end):
-                    i = order[ii]
-                    N_old = N
-
-                    # add unvisited neighbors
-                    for jj in range(ptr[i], ptr[i + 1]):
-                        # j is node number connected to i
-                        j = ind[jj]
-                        if inds[rev_inds[j]] != -1:
-                            inds[rev_inds[j]] = -1
-                            order[N] = j
-                            N += 1
-
-                    # Add values to temp_degrees array for insertion sort
-                    level_len = 0
-                    for kk in range(N_old, N):
-                        temp_degrees[level_len] = degree[order[kk]]
-                        level_len += 1
-                
-                    # Do insertion sort for nodes from lowest to highest degree
-                    for kk in range(1,level_len):
-                        temp = temp_degrees[kk]
-                        temp2 = order[N_old+kk]
-                        ll = kk
-                        while (ll > 0) and (temp < temp_degrees[ll-1]):
-                            temp_degrees[ll] = temp_degrees[ll-1]
-                            order[N_old+ll] = order[N_old+ll-1]
-                            ll -= 1
-                        temp_degrees[ll] = temp
-                        order[N_old+ll] = temp2
-                
-                # set next level start and end ranges
-                level_start = level_end
-                level_end = N
-
-        if N == num_rows:
-            break
+    degree = _node_degrees(ind, ptr, num_rows)
+    inds = np.argsort(degree).astype(ind.dtype)
+    order = np.empty(num_rows, dtype=ind.dtype)
+    cs_graph_rcm(num_rows, ptr, ind, degree, inds, pseudo_peripheral, order,
+                 _workers(None))
 
     # return reversed order for RCM ordering
     return order[::-1]
 
 
-def _maximum_bipartite_matching(
-        np.ndarray[int32_or_int64, ndim=1, mode="c"] inds,
-        np.ndarray[int32_or_int64, ndim=1, mode="c"] ptrs,
-        np.npy_intp n):
+def _maximum_bipartite_matching(graph, initial_matching=None):
     """
-    Maximum bipartite matching of a graph in CSC format.
+    Maximum bipartite matching of the rows and columns of a graph in CSC
+    format: the row matched to each column, or -1.
     """
-    cdef np.ndarray[int32_or_int64] visited = np.zeros(n, dtype=inds.dtype)
-    cdef np.ndarray[ITYPE_t] queue = np.zeros(n, dtype=ITYPE)
-    cdef np.ndarray[ITYPE_t] previous = np.zeros(n, dtype=ITYPE)
-    cdef np.ndarray[int32_or_int64] match = np.empty(n, dtype=inds.dtype)
-    cdef np.ndarray[ITYPE_t] row_match = np.empty(n, dtype=ITYPE)
-    cdef np.npy_intp queue_ptr, queue_col, ptr, i, j, queue_size
-    cdef np.npy_intp col, next_num = 1
-    cdef int32_or_int64 row, temp, eptr
-
-    for i in range(n):
-        match[i] = -1
-        row_match[i] = -1
-
-    for i in range(n):
-        if match[i] == -1 and (ptrs[i] != ptrs[i + 1]):
-            queue[0] = i
-            queue_ptr = 0
-            queue_size = 1
-            while (queue_size > queue_ptr):
-                queue_col = queue[queue_ptr]
-                queue_ptr += 1
-                eptr = ptrs[queue_col + 1]
-                for ptr in range(ptrs[queue_col], eptr):
-                    row = inds[ptr]
-                    temp = visited[row]
-                    if (temp != next_num and temp != -1):
-                        previous[row] = queue_col
-                        visited[row] = next_num
-                        col = row_match[row]
-                        if (col == -1):
-                            while (row != -1):
-                                col = previous[row]
-                                temp = match[col]
-                                match[col] = row
-                                row_match[row] = col
-                                row = temp
-                            next_num += 1
-                            queue_size = 0
-                            break
-                        else:
-                            queue[queue_size] = col
-                            queue_size += 1
-
-            if match[i] == -1:
-                for j in range(1, queue_size):
-                    visited[match[queue[j]]] = -1
-
+    idx_dtype = np.promote_types(graph.indices.dtype, graph.indptr.dtype)
+    indices = graph.indices.astype(idx_dtype, copy=False)
+    indptr = graph.indptr.astype(idx_dtype, copy=False)
+    if initial_matching is None:
+        match = np.full(graph.shape[1], -1, dtype=idx_dtype)
+    else:
+        match = np.array(initial_matching, dtype=idx_dtype)
+        if match.shape != (graph.shape[1],):
+            raise ValueError("initial_matching must have one entry per "
+                             "column of the graph")
+    cs_graph_bipartite_matching(graph.shape[0], graph.shape[1],
+                                indptr, indices, match, _workers(None))
     return match
 
 
@@ -371,8 +312,7 @@ def structural_rank(graph):
     # If A is a tall matrix, then transpose.
     if graph.shape[0] > graph.shape[1]:
         graph = graph.T.tocsc()
-    rank = np.sum(_maximum_bipartite_matching(graph.indices, 
-                    graph.indptr, graph.shape[1]) >= 0)
+    rank = np.sum(_maximum_bipartite_matching(graph) >= 0)
     return rank
 
 
@@ -3,7 +3,7 @@ Routines for performing shortest-path graph searches
 
 The main interface is in the function :func:`shortest_path`.  This
 calls cython routines that compute the shortest path using
-the Floyd-Warshall algorithm, Dijkstra's algorithm with Fibonacci Heaps,
+the Floyd-Warshall algorithm, Dijkstra's algorithm with binary heaps,
 the Bellman-Ford algorithm, or Johnson's Algorithm.
 """
 
@@ -18,14 +18,62 @@ cimport numpy as np
 
 from scipy.sparse import csr_matrix, isspmatrix, isspmatrix_csr, isspmatrix_csc
 from scipy.sparse.csgraph._validation import validate_graph
+from scipy.sparse._sparsetools import cs_graph_bfs_parallel
+from scipy.sparse._workers import _workers
 
 cimport cython
 
-from libc.stdlib cimport malloc, free
+from libc.stdlib cimport malloc, calloc, realloc, free
 from numpy.math cimport INFINITY
 
+cdef extern from "zeros_threads.h":
+    ctypedef struct zeros_mutex:
+        pass
+    void zeros_mutex_init(zeros_mutex *m) nogil
+    void zeros_mutex_destroy(zeros_mutex *m) nogil
+    void zeros_mutex_lock(zeros_mutex *m) nogil
+    void zeros_mutex_unlock(zeros_mutex *m) nogil
+    void zeros_run_threads(int nthreads, void (*func)(void *) nogil,
+                           void *arg) nogil
+
 include 'parameters.pxi'
 
+ctypedef fused float_or_double:
+    float
+    double
+
+cdef extern from "_floyd_warshall.h":
+    void fw_tile_d(double *D, ITYPE_t *P, Py_ssize_t n,
+                   Py_ssize_t i0, Py_ssize_t i1, Py_ssize_t j0, Py_ssize_t j1,
+                   Py_ssize_t k0, Py_ssize_t k1, int seq) nogil
+    void fw_tile_f(float *D, ITYPE_t *P, Py_ssize_t n,
+                   Py_ssize_t i0, Py_ssize_t i1, Py_ssize_t j0, Py_ssize_t j1,
+                   Py_ssize_t k0, Py_ssize_t k1, int seq) nogil
+
+# States of the nodes of a BinaryHeap other than their position in it
+DEF NOT_IN_HEAP = -1
+DEF SCANNED = -2
+
+# Minimum number of nodes and edges touched by the searches from several
+# sources that justifies starting an additional thread
+DEF DIJKSTRA_MIN_WORK = 32768
+
+# Delta-stepping is used for a single search on several threads if the
+# graph has at least this many nodes and edges
+DEF DELTA_STEPPING_MIN_SIZE = 65536
+
+# Number of frontier nodes in a block of work of delta-stepping, minimum
+# number of nodes or requests for a phase to run on several threads, and
+# maximum number of buckets
+DEF DELTA_BLOCK = 256
+DEF DELTA_PARALLEL_MIN = 4096
+DEF DELTA_MAX_BUCKETS = 4096
+
+# Side of the tiles of the blocked Floyd-Warshall algorithm, and the
+# smallest graph it runs on several threads
+DEF FW_BLOCK = 64
+DEF FW_PARALLEL_MIN = 256
+
 
 class NegativeCycleError(Exception):
     def __init__(self, message=''):
@@ -61,7 +109,7 @@ def shortest_path(csgraph, method='auto',
                      approximately ``O[N^3]``.  The input csgraph will be
                      converted to a dense representation.
 
-           'D'    -- Dijkstra's algorithm with Fibonacci heaps.  Computational
+           'D'    -- Dijkstra's algorithm with binary heaps.  Computational
                      cost is approximately ``O[N(N*k + N*log(N))]``, where
                      ``k`` is the average number of connected edges per node.
                      The input csgraph will be converted to a csr
@@ -208,10 +256,11 @@ def shortest_path(csgraph, method='auto',
 def floyd_warshall(csgraph, directed=True,
                    return_predecessors=False,
                    unweighted=False,
-                   overwrite=False):
+                   overwrite=False,
+                   dtype=np.float64):
     """
     floyd_warshall(csgraph, directed=True, return_predecessors=False,
-                   unweighted=False, overwrite=False)
+                   unweighted=False, overwrite=False, dtype=np.float64)
 
     Compute the shortest path lengths using the Floyd-Warshall algorithm
 
@@ -235,7 +284,12 @@ def floyd_warshall(csgraph, directed=True,
         find the path such that the number of edges is minimized.
     overwrite : bool, optional
         If True, overwrite csgraph with the result.  This applies only if
-        csgraph is a dense, c-ordered array with dtype=float64.
+        csgraph is a dense, c-ordered array with the given `dtype`.
+    dtype : {np.float64, np.float32}, optional
+        Floating-point type of the distances. float32 halves the memory of
+        the distance matrix, at the cost of precision.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -257,6 +311,19 @@ def floyd_warshall(csgraph, directed=True,
     NegativeCycleError:
         if there are negative cycles in the graph
 
+    Notes
+    -----
+    The matrix is processed in square tiles [1]_, so that each step works
+    on data in the cache. If `scipy.sparse.set_workers` allows more than
+    one thread, the independent tiles of each step are shared out between
+    the threads.
+
+    References
+    ----------
+    .. [1] G. Venkataraman, S. Sahni, S. Mukhopadhyaya, "A Blocked
+           All-Pairs Shortest-Paths Algorithm", Journal of Experimental
+           Algorithmics 8, 2003
+
     Examples
     --------
     >>> from scipy.sparse import csr_matrix
@@ -290,9 +357,15 @@ def floyd_warshall(csgraph, directed=True,
            [    1,     3,     3, -9999]], dtype=int32)
 
     """
-    dist_matrix = validate_graph(csgraph, directed, DTYPE,
+    dtype = np.dtype(dtype)
+    if dtype != np.float64 and dtype != np.float32:
+        raise ValueError("dtype must be float64 or float32")
+
+    dist_matrix = validate_graph(csgraph, directed, dtype,
                                  csr_output=False,
                                  copy_if_dense=not overwrite)
+    if not dist_matrix.flags.c_contiguous:
+        dist_matrix = np.ascontiguousarray(dist_matrix)
 
     if unweighted:
         dist_matrix[~np.isinf(dist_matrix)] = 1
@@ -303,9 +376,16 @@ def floyd_warshall(csgraph, directed=True,
     else:
         predecessor_matrix = np.empty((0, 0), dtype=ITYPE)
 
-    _floyd_warshall(dist_matrix,
-                    predecessor_matrix,
-                    int(directed))
+    if dtype == np.float32:
+        _floyd_warshall[cython.float](dist_matrix,
+                                      predecessor_matrix,
+                                      int(directed),
+                                      _workers(None))
+    else:
+        _floyd_warshall[cython.double](dist_matrix,
+                                       predecessor_matrix,
+                                       int(directed),
+                                       _workers(None))
 
     if np.any(dist_matrix.diagonal() < 0):
         raise NegativeCycleError("Negative cycle in nodes %s"
@@ -317,11 +397,109 @@ def floyd_warshall(csgraph, directed=True,
         return dist_matrix
 
 
+cdef struct fw_work:
+    # The shared state of the threads of a phase of the blocked
+    # Floyd-Warshall algorithm: the matrices, their number of tiles along
+    # each side, the tile of the current nodes k, and the next task to
+    # claim
+    void *dist
+    ITYPE_t *pred
+    bint is_float
+    Py_ssize_t N, ntiles, kt
+    Py_ssize_t ntasks, next
+    zeros_mutex lock
+
+
+cdef inline void _fw_tile(fw_work *w, Py_ssize_t it, Py_ssize_t jt,
+                          int seq) nogil:
+    # Relaxes tile (it, jt) through the nodes of tile kt
+    cdef Py_ssize_t N = w.N
+    cdef Py_ssize_t i0 = it * FW_BLOCK, j0 = jt * FW_BLOCK
+    cdef Py_ssize_t k0 = w.kt * FW_BLOCK
+    if w.is_float:
+        fw_tile_f(<float *>w.dist, w.pred, N,
+                  i0, min(i0 + FW_BLOCK, N), j0, min(j0 + FW_BLOCK, N),
+                  k0, min(k0 + FW_BLOCK, N), seq)
+    else:
+        fw_tile_d(<double *>w.dist, w.pred, N,
+                  i0, min(i0 + FW_BLOCK, N), j0, min(j0 + FW_BLOCK, N),
+                  k0, min(k0 + FW_BLOCK, N), seq)
+
+
+cdef Py_ssize_t _fw_claim(fw_work *w) nogil:
+    cdef Py_ssize_t t
+    zeros_mutex_lock(&w.lock)
+    t = w.next
+    w.next += 1
+    zeros_mutex_unlock(&w.lock)
+    return t if t < w.ntasks else -1
+
+
+cdef void _fw_cross_thread(void *arg) nogil:
+    # The tiles in the row and the column of tile (kt, kt), which depend
+    # on it only
+    cdef fw_work *w = <fw_work *>arg
+    cdef Py_ssize_t t = _fw_claim(w), m = w.ntiles - 1
+    while t >= 0:
+        if t < m:
+            _fw_tile(w, w.kt, t + (t >= w.kt), 1)
+        else:
+            _fw_tile(w, t - m + (t - m >= w.kt), w.kt, 1)
+        t = _fw_claim(w)
+
+
+cdef void _fw_rest_thread(void *arg) nogil:
+    # The other tiles, which depend on the row and the column only
+    cdef fw_work *w = <fw_work *>arg
+    cdef Py_ssize_t t = _fw_claim(w), m = w.ntiles - 1, it, jt
+    while t >= 0:
+        it = t // m
+        jt = t % m
+        _fw_tile(w, it + (it >= w.kt), jt + (jt >= w.kt), 0)
+        t = _fw_claim(w)
+
+
+cdef void _fw_phase(fw_work *w, void (*func)(void *) nogil,
+                    Py_ssize_t ntasks, int nthreads) nogil:
+    w.ntasks = ntasks
+    w.next = 0
+    zeros_run_threads(max(1, min(nthreads, ntasks)), func, w)
+
+
+cdef void _floyd_warshall_blocked(fw_work *w, int nthreads) nogil:
+    """
+    The blocked Floyd-Warshall algorithm [Venkataraman et al. 2003].
+
+    For each tile of nodes k, the diagonal tile is relaxed first, then
+    the tiles in its row and column, then all the others. The tiles of
+    each of the last two phases are independent, and are shared out
+    between the threads.
+    """
+    cdef Py_ssize_t kt, m = w.ntiles - 1
+
+    for kt in range(w.ntiles):
+        w.kt = kt
+        _fw_tile(w, kt, kt, 1)
+        _fw_phase(w, _fw_cross_thread, 2 * m, nthreads)
+        _fw_phase(w, _fw_rest_thread, m * m, nthreads)
+
+
 @cython.boundscheck(False)
-cdef void _floyd_warshall(
-               np.ndarray[DTYPE_t, ndim=2, mode='c'] dist_matrix,
-               np.ndarray[ITYPE_t, ndim=2, mode='c'] predecessor_matrix,
-               int directed=0):
+cdef void _fw_symmetrize(float_or_double[:, ::1] dist_matrix) nogil:
+    cdef Py_ssize_t i, j, N = dist_matrix.shape[0]
+    for i in range(N):
+        for j in range(i + 1, N):
+            if dist_matrix[j, i] <= dist_matrix[i, j]:
+                dist_matrix[i, j] = dist_matrix[j, i]
+            else:
+                dist_matrix[j, i] = dist_matrix[i, j]
+
+
+cdef int _floyd_warshall(
+               float_or_double[:, ::1] dist_matrix,
+               int[:, ::1] predecessor_matrix,
+               int directed=0,
+               int nthreads=1) except -1:
     # dist_matrix : in/out
     #    on input, the graph
     #    on output, the matrix of shortest paths
@@ -331,24 +509,19 @@ cdef void _floyd_warshall(
     cdef int N = dist_matrix.shape[0]
     assert dist_matrix.shape[1] == N
 
-    cdef unsigned int i, j, k
-
-    cdef DTYPE_t d_ijk
+    cdef fw_work w
+    dist = dist_matrix.base
 
     # ----------------------------------------------------------------------
     #  Initialize distance matrix
     #   - set non-edges to infinity
     #   - set diagonal to zero
     #   - symmetrize matrix if non-directed graph is desired
-    dist_matrix[dist_matrix == 0] = INFINITY
-    dist_matrix.flat[::N + 1] = 0
+    dist[dist == 0] = INFINITY
+    dist.flat[::N + 1] = 0
     if not directed:
-        for i in range(N):
-            for j in range(i + 1, N):
-                if dist_matrix[j, i] <= dist_matrix[i, j]:
-                    dist_matrix[i, j] = dist_matrix[j, i]
-                else:
-                    dist_matrix[j, i] = dist_matrix[i, j]
+        with nogil:
+            _fw_symmetrize(dist_matrix)
 
     #----------------------------------------------------------------------
     #  Initialize predecessor matrix
@@ -361,33 +534,31 @@ cdef void _floyd_warshall(
         store_predecessors = True
         assert predecessor_matrix.shape[0] == N
         assert predecessor_matrix.shape[1] == N
-        predecessor_matrix.fill(NULL_IDX)
-        i_edge = np.where(~np.isinf(dist_matrix))
-        predecessor_matrix[i_edge] = i_edge[0]
-        predecessor_matrix.flat[::N + 1] = NULL_IDX
+        pred = predecessor_matrix.base
+        pred.fill(NULL_IDX)
+        i_edge = np.where(~np.isinf(dist))
+        pred[i_edge] = i_edge[0]
+        pred.flat[::N + 1] = NULL_IDX
+
+    if N == 0:
+        return 0
 
     # Now perform the Floyd-Warshall algorithm.
     # In each loop, this finds the shortest path from point i
     #  to point j using intermediate nodes 0 ... k
-    if store_predecessors:
-        for k in range(N):
-            for i in range(N):
-                if dist_matrix[i, k] == INFINITY:
-                    continue
-                for j in range(N):
-                    d_ijk = dist_matrix[i, k] + dist_matrix[k, j]
-                    if d_ijk < dist_matrix[i, j]:
-                        dist_matrix[i, j] = d_ijk
-                        predecessor_matrix[i, j] = predecessor_matrix[k, j]
-    else:
-        for k in range(N):
-            for i in range(N):
-                if dist_matrix[i, k] == INFINITY:
-                    continue
-                for j in range(N):
-                    d_ijk = dist_matrix[i, k] + dist_matrix[k, j]
-                    if d_ijk < dist_matrix[i, j]:
-                        dist_matrix[i, j] = d_ijk
+    w.dist = &dist_matrix[0, 0]
+    w.pred = &predecessor_matrix[0, 0] if store_predecessors else NULL
+    w.is_float = float_or_double is float
+    w.N = N
+    w.ntiles = (N + FW_BLOCK - 1) // FW_BLOCK
+    if N < FW_PARALLEL_MIN:
+        nthreads = 1
+
+    zeros_mutex_init(&w.lock)
+    with nogil:
+        _floyd_warshall_blocked(&w, nthreads)
+    zeros_mutex_destroy(&w.lock)
+    return 0
 
 
 def dijkstra(csgraph, directed=True, indices=None,
@@ -398,7 +569,7 @@ def dijkstra(csgraph, directed=True, indices=None,
     dijkstra(csgraph, directed=True, indices=None, return_predecessors=False,
              unweighted=False, limit=np.inf)
 
-    Dijkstra algorithm using Fibonacci Heaps
+    Dijkstra algorithm using binary heaps
 
     .. versionadded:: 0.11.0
 
@@ -477,6 +648,20 @@ def dijkstra(csgraph, directed=True, indices=None,
     be handled by specialized algorithms such as Bellman-Ford's algorithm
     or Johnson's algorithm.
 
+    If `scipy.sparse.set_workers` allows more than one thread, the
+    searches from several `indices` run concurrently. A single search
+    (from one index, or with ``min_only=True``) on a large graph without
+    negative weights then uses the delta-stepping algorithm [1]_ instead,
+    which expands all the nodes within a band of distances at once, or
+    with ``unweighted=True`` a parallel breadth-first search, as in
+    `breadth_first_order`. It finds the same distances; where several
+    shortest paths exist, the predecessors may describe a different one.
+
+    References
+    ----------
+    .. [1] U. Meyer, P. Sanders, "Delta-stepping: a parallelizable
+           shortest path algorithm", Journal of Algorithms 49, 2003
+
     Examples
     --------
     >>> from scipy.sparse import csr_matrix
@@ -567,7 +752,44 @@ def dijkstra(csgraph, directed=True, indices=None,
     else:
         csr_data = csgraph.data
 
+    nthreads = _workers(None)
     if directed:
+        csgraphT = None
+    else:
+        csgraphT = csgraph.T.tocsr()
+        if unweighted:
+            csrT_data = csr_data
+        else:
+            csrT_data = csgraphT.data
+
+    if (nthreads > 1 and (min_only or len(indices) == 1)
+            and N + csgraph.nnz >= DELTA_STEPPING_MIN_SIZE and unweighted):
+        if not min_only:
+            source_matrix = np.empty(0, dtype=ITYPE)
+        _dijkstra_breadth_first(csgraph, csgraphT, directed, indices,
+                                dist_matrix.reshape(-1),
+                                predecessor_matrix.reshape(-1),
+                                source_matrix, limitf, nthreads)
+    elif (nthreads > 1 and (min_only or len(indices) == 1)
+            and N + csgraph.nnz >= DELTA_STEPPING_MIN_SIZE
+            and not np.any(csr_data < 0)):
+        delta, nbuckets = _delta_stepping_width(csr_data)
+        if csgraphT is None:
+            # no transpose: the search follows the edges one way
+            csgraphT_args = (np.empty(0), np.empty(0, dtype=ITYPE),
+                             np.empty(0, dtype=ITYPE))
+        else:
+            csgraphT_args = (csrT_data, csgraphT.indices, csgraphT.indptr)
+        if not min_only:
+            source_matrix = np.empty(0, dtype=ITYPE)
+        _dijkstra_delta_stepping(indices,
+                                 csr_data, csgraph.indices, csgraph.indptr,
+                                 *csgraphT_args,
+                                 dist_matrix.reshape(-1),
+                                 predecessor_matrix.reshape(-1),
+                                 source_matrix, limitf, delta, nbuckets,
+                                 nthreads)
+    elif directed:
         if min_only:
             _dijkstra_directed_multi(indices,
                                      csr_data, csgraph.indices,
@@ -577,13 +799,9 @@ def dijkstra(csgraph, directed=True, indices=None,
         else:
             _dijkstra_directed(indices,
                                csr_data, csgraph.indices, csgraph.indptr,
-                               dist_matrix, predecessor_matrix, limitf)
+                               dist_matrix, predecessor_matrix, limitf,
+                               nthreads)
     else:
-        csgraphT = csgraph.T.tocsr()
-        if unweighted:
-            csrT_data = csr_data
-        else:
-            csrT_data = csgraphT.data
         if min_only:
             _dijkstra_undirected_multi(indices,
                                        csr_data, csgraph.indices,
@@ -596,7 +814,8 @@ def dijkstra(csgraph, directed=True, indices=None,
             _dijkstra_undirected(indices,
                                  csr_data, csgraph.indices, csgraph.indptr,
                                  csrT_data, csgraphT.indices, csgraphT.indptr,
-                                 dist_matrix, predecessor_matrix, limitf)
+                                 dist_matrix, predecessor_matrix, limitf,
+                                 nthreads)
 
     if return_predecessors:
         if min_only:
@@ -609,292 +828,757 @@ def dijkstra(csgraph, directed=True, indices=None,
     else:
         return dist_matrix.reshape(return_shape)
 
-@cython.boundscheck(False)
-cdef _dijkstra_setup_heap_multi(FibonacciHeap *heap,
-                                FibonacciNode* nodes,
-                                const int[:] source_indices,
-                                int[:] sources,
-                                double[:] dist_matrix,
-                                int return_pred):
-    cdef:
-        unsigned int Nind = source_indices.shape[0]
-        unsigned int N = dist_matrix.shape[0]
-        unsigned int i, k, j_source
-        FibonacciNode *current_node
-
-    for k in range(N):
-        initialize_node(&nodes[k], k)
-
-    heap.min_node = NULL
-    for i in range(Nind):
-        j_source = source_indices[i]
-        dist_matrix[j_source] = 0
-        if return_pred:
-            sources[j_source] = j_source
-        current_node = &nodes[j_source]
-        current_node.state = SCANNED
-        current_node.source = j_source
-        insert_node(heap, &nodes[j_source])
-
-@cython.boundscheck(False)
-cdef _dijkstra_scan_heap_multi(FibonacciHeap *heap,
-                               FibonacciNode *v,
-                               FibonacciNode* nodes,
-                               const double[:] csr_weights,
-                               const int[:] csr_indices,
-                               const int[:] csr_indptr,
-                               int[:] pred,
-                               int[:] sources,
-                               int return_pred,
-                               DTYPE_t limit):
-    cdef:
-        unsigned int i, k, j_source, j_current
-        ITYPE_t j
-        DTYPE_t next_val
-        FibonacciNode *current_node
-
-    for j in range(csr_indptr[v.index], csr_indptr[v.index + 1]):
-        j_current = csr_indices[j]
-        current_node = &nodes[j_current]
-        if current_node.state != SCANNED:
-            next_val = v.val + csr_weights[j]
-            if next_val <= limit:
-                if current_node.state == NOT_IN_HEAP:
-                    current_node.state = IN_HEAP
-                    current_node.val = next_val
-                    current_node.source = v.source
-                    insert_node(heap, current_node)
-                    if return_pred:
-                        pred[j_current] = v.index
-                        sources[j_current] = v.source
-                elif current_node.val > next_val:
-                    current_node.source = v.source
-                    decrease_val(heap, current_node,
-                                 next_val)
-                    if return_pred:
-                        pred[j_current] = v.index
-                        sources[j_current] = v.source
-
-@cython.boundscheck(False)
-cdef _dijkstra_scan_heap(FibonacciHeap *heap,
-                         FibonacciNode *v,
-                         FibonacciNode* nodes,
-                         const double[:] csr_weights,
-                         const int[:] csr_indices,
-                         const int[:] csr_indptr,
-                         int[:, :] pred,
-                         int return_pred,
-                         DTYPE_t limit,
-                         int i):
-    cdef:
-        unsigned int k, j_source, j_current
-        ITYPE_t j
-        DTYPE_t next_val
-        FibonacciNode *current_node
-
-    for j in range(csr_indptr[v.index], csr_indptr[v.index + 1]):
-        j_current = csr_indices[j]
-        current_node = &nodes[j_current]
-        if current_node.state != SCANNED:
-            next_val = v.val + csr_weights[j]
-            if next_val <= limit:
-                if current_node.state == NOT_IN_HEAP:
-                    current_node.state = IN_HEAP
-                    current_node.val = next_val
-                    insert_node(heap, current_node)
-                    if return_pred:
-                        pred[i, j_current] = v.index
-                elif current_node.val > next_val:
-                    decrease_val(heap, current_node,
-                                 next_val)
-                    if return_pred:
-                        pred[i, j_current] = v.index
 
-@cython.boundscheck(False)
-cdef _dijkstra_directed(
-            const int[:] source_indices,
-            const double[:] csr_weights,
-            const int[:] csr_indices,
-            const int[:] csr_indptr,
-            double[:, :] dist_matrix,
-            int[:, :] pred,
-            DTYPE_t limit):
-    cdef:
-        unsigned int Nind = dist_matrix.shape[0]
-        unsigned int N = dist_matrix.shape[1]
-        unsigned int i, k, j_source, j_current
-        ITYPE_t j
-        DTYPE_t next_val
-        int return_pred = (pred.size > 0)
-        FibonacciHeap heap
-        FibonacciNode *v
-        FibonacciNode* nodes = <FibonacciNode*> malloc(N *
-                                                       sizeof(FibonacciNode))
-
-    for i in range(Nind):
-        j_source = source_indices[i]
+######################################################################
+# Dijkstra searches
+#  The searches use the array-based BinaryHeap defined at the end of
+#  this file. Searches from several sources are independent, so they run
+#  on several threads, each with its own heap; every thread claims the
+#  next source from a shared counter.
+
+cdef struct csr_graph:
+    # The edges of a search: those of csr, and for undirected graphs also
+    # those of csrT (otherwise T_indptr is NULL)
+    const DTYPE_t *weights
+    const ITYPE_t *indices
+    const ITYPE_t *indptr
+    const DTYPE_t *T_weights
+    const ITYPE_t *T_indices
+    const ITYPE_t *T_indptr
+    ITYPE_t N
+
+
+cdef struct dijkstra_work:
+    # The shared state of the threads searching from several sources.
+    # Row i of dist and pred (if not NULL) are the results of source i.
+    csr_graph *graph
+    const ITYPE_t *source_indices
+    Py_ssize_t nind
+    DTYPE_t *dist
+    ITYPE_t *pred
+    DTYPE_t limit
+    # the next source to claim, and whether a thread ran out of memory
+    Py_ssize_t next
+    bint nomem
+    zeros_mutex lock
+
+
+cdef inline const DTYPE_t *_weights_ptr(const double[::1] a):
+    # Empty graphs have no edges to point at
+    return &a[0] if a.shape[0] > 0 else NULL
+
+
+cdef inline const ITYPE_t *_indices_ptr(const int[::1] a):
+    return &a[0] if a.shape[0] > 0 else NULL
+
+
+cdef csr_graph _make_graph(const double[::1] csr_weights,
+                           const int[::1] csr_indices,
+                           const int[::1] csr_indptr):
+    cdef csr_graph graph
+    graph.weights = _weights_ptr(csr_weights)
+    graph.indices = _indices_ptr(csr_indices)
+    graph.indptr = &csr_indptr[0]
+    graph.T_weights = NULL
+    graph.T_indices = NULL
+    graph.T_indptr = NULL
+    graph.N = csr_indptr.shape[0] - 1
+    return graph
+
+
+cdef void _dijkstra_scan(BinaryHeap *heap, ITYPE_t v, DTYPE_t v_val,
+                         const DTYPE_t *weights, const ITYPE_t *indices,
+                         const ITYPE_t *indptr, ITYPE_t *pred,
+                         ITYPE_t *sources, DTYPE_t limit) nogil:
+    # Relaxes the edges from v, which has just been scanned at v_val
+    cdef ITYPE_t j, k, state
+    cdef DTYPE_t next_val
+
+    for j in range(indptr[v], indptr[v + 1]):
+        k = indices[j]
+        state = heap.pos[k]
+        if state == SCANNED:
+            continue
+        next_val = v_val + weights[j]
+        if next_val > limit:
+            continue
+        if state == NOT_IN_HEAP:
+            heap_push(heap, k, next_val)
+        elif heap.entries[state].val > next_val:
+            heap_decrease(heap, k, next_val)
+        else:
+            continue
+        if pred != NULL:
+            pred[k] = v
+        if sources != NULL:
+            sources[k] = sources[v]
 
-        for k in range(N):
-            initialize_node(&nodes[k], k)
 
-        dist_matrix[i, j_source] = 0
-        heap.min_node = NULL
-        insert_node(&heap, &nodes[j_source])
+cdef void _dijkstra_search(BinaryHeap *heap, const csr_graph *graph,
+                           const ITYPE_t *starts, Py_ssize_t nstarts,
+                           DTYPE_t *dist, ITYPE_t *pred, ITYPE_t *sources,
+                           DTYPE_t limit) nogil:
+    """
+    Finds the distances from the nearest of the starting nodes into dist.
 
-        while heap.min_node:
-            v = remove_min(&heap)
-            v.state = SCANNED
+    dist must be infinite at the nodes which are not reached; pred and
+    sources, if not NULL, receive the predecessors and the nearest
+    starting nodes of the nodes reached. The heap is left empty, with
+    all the nodes NOT_IN_HEAP, for the next search.
+    """
+    cdef Py_ssize_t i, nscanned = 0
+    cdef ITYPE_t v
+    cdef DTYPE_t v_val
+
+    for i in range(nstarts):
+        v = starts[i]
+        if heap.pos[v] == NOT_IN_HEAP:
+            heap_push(heap, v, 0)
+            if sources != NULL:
+                sources[v] = v
+
+    while heap.size > 0:
+        v = heap_pop(heap, &v_val)
+        heap.scanned[nscanned] = v
+        nscanned += 1
+        dist[v] = v_val
+
+        _dijkstra_scan(heap, v, v_val, graph.weights, graph.indices,
+                       graph.indptr, pred, sources, limit)
+        if graph.T_indptr != NULL:
+            _dijkstra_scan(heap, v, v_val, graph.T_weights, graph.T_indices,
+                           graph.T_indptr, pred, sources, limit)
+
+    # only the scanned nodes need to be reset
+    for i in range(nscanned):
+        heap.pos[heap.scanned[i]] = NOT_IN_HEAP
+
+
+cdef void _dijkstra_thread(void *arg) nogil:
+    cdef dijkstra_work *w = <dijkstra_work *>arg
+    cdef Py_ssize_t i, N = w.graph.N
+    cdef BinaryHeap heap
+
+    if heap_init(&heap, w.graph.N) < 0:
+        zeros_mutex_lock(&w.lock)
+        w.nomem = True
+        zeros_mutex_unlock(&w.lock)
+        return
+
+    while True:
+        zeros_mutex_lock(&w.lock)
+        i = w.next
+        w.next += 1
+        if w.nomem:
+            i = w.nind
+        zeros_mutex_unlock(&w.lock)
+        if i >= w.nind:
+            break
+        _dijkstra_search(&heap, w.graph, w.source_indices + i, 1,
+                         w.dist + i * N,
+                         w.pred + i * N if w.pred != NULL else NULL,
+                         NULL, w.limit)
+
+    heap_free(&heap)
+
+
+cdef int _dijkstra_run(csr_graph *graph, const int[::1] source_indices,
+                       double[:, ::1] dist_matrix, int[:, ::1] pred,
+                       DTYPE_t limit, int nthreads) except -1:
+    """
+    Searches from each of source_indices on up to nthreads threads.
+    """
+    cdef dijkstra_work w
+    cdef Py_ssize_t N = graph.N
+
+    w.graph = graph
+    w.nind = dist_matrix.shape[0]
+    if w.nind == 0 or N == 0:
+        return 0
+    w.source_indices = &source_indices[0]
+    w.dist = &dist_matrix[0, 0]
+    w.pred = &pred[0, 0] if pred.shape[0] > 0 else NULL
+    w.limit = limit
+    w.next = 0
+    w.nomem = False
+
+    # searches are only worth a thread if they are large enough
+    nthreads = min(nthreads, w.nind,
+                   max(1, w.nind * (N + graph.indptr[N]) // DIJKSTRA_MIN_WORK))
+
+    zeros_mutex_init(&w.lock)
+    with nogil:
+        zeros_run_threads(nthreads, _dijkstra_thread, &w)
+    zeros_mutex_destroy(&w.lock)
+    if w.nomem:
+        raise MemoryError()
+    return 0
+
+
+cdef int _dijkstra_run_multi(csr_graph *graph, const int[::1] source_indices,
+                             double[::1] dist_matrix, int[::1] pred,
+                             int[::1] sources, DTYPE_t limit) except -1:
+    """
+    A single search from the nearest of source_indices.
+    """
+    cdef BinaryHeap heap
+    cdef ITYPE_t *pred_ptr = NULL
+    cdef ITYPE_t *sources_ptr = NULL
+
+    if graph.N == 0 or source_indices.shape[0] == 0:
+        return 0
+    if pred.shape[0] > 0:
+        pred_ptr = &pred[0]
+        sources_ptr = &sources[0]
+    if heap_init(&heap, graph.N) < 0:
+        raise MemoryError()
+    with nogil:
+        _dijkstra_search(&heap, graph, &source_indices[0],
+                         source_indices.shape[0], &dist_matrix[0],
+                         pred_ptr, sources_ptr, limit)
+    heap_free(&heap)
+    return 0
 
-            _dijkstra_scan_heap(&heap, v, nodes,
-                                csr_weights, csr_indices, csr_indptr,
-                                pred, return_pred, limit, i)
 
-            # v has now been scanned: add the distance to the results
-            dist_matrix[i, v.index] = v.val
+cdef _dijkstra_directed(
+            const int[::1] source_indices,
+            const double[::1] csr_weights,
+            const int[::1] csr_indices,
+            const int[::1] csr_indptr,
+            double[:, ::1] dist_matrix,
+            int[:, ::1] pred,
+            DTYPE_t limit,
+            int nthreads=1):
+    cdef csr_graph graph = _make_graph(csr_weights, csr_indices, csr_indptr)
+    _dijkstra_run(&graph, source_indices, dist_matrix, pred, limit, nthreads)
 
-    free(nodes)
 
-@cython.boundscheck(False)
 cdef _dijkstra_directed_multi(
-            const int[:] source_indices,
-            const double[:] csr_weights,
-            const int[:] csr_indices,
-            const int[:] csr_indptr,
-            double[:] dist_matrix,
-            int[:] pred,
-            int[:] sources,
+            const int[::1] source_indices,
+            const double[::1] csr_weights,
+            const int[::1] csr_indices,
+            const int[::1] csr_indptr,
+            double[::1] dist_matrix,
+            int[::1] pred,
+            int[::1] sources,
             DTYPE_t limit):
-    cdef:
-        unsigned int Nind = source_indices.shape[0]
-        unsigned int N = dist_matrix.shape[0]
-        unsigned int i, k, j_source, j_current
-        ITYPE_t j
+    cdef csr_graph graph = _make_graph(csr_weights, csr_indices, csr_indptr)
+    # the search starts from every node of source_indices at once;
+    # pred will lead back to one of them
+    _dijkstra_run_multi(&graph, source_indices, dist_matrix, pred, sources,
+                        limit)
 
-        DTYPE_t next_val
 
-        int return_pred = (pred.size > 0)
-
-        FibonacciHeap heap
-        FibonacciNode *v
-        FibonacciNode* nodes = <FibonacciNode*> malloc(N *
-                                                       sizeof(FibonacciNode))
-
-    # initialize the heap with each of the starting
-    # nodes on the heap and in a scanned state with 0 values
-    # and their entry of the distance matrix = 0
-    # pred will lead back to one of the starting indices
-    _dijkstra_setup_heap_multi(&heap, nodes, source_indices,
-                               sources, dist_matrix, return_pred)
-
-    while heap.min_node:
-        v = remove_min(&heap)
-        v.state = SCANNED
-
-        _dijkstra_scan_heap_multi(&heap, v, nodes,
-                                  csr_weights, csr_indices, csr_indptr,
-                                  pred, sources, return_pred, limit)
-
-        # v has now been scanned: add the distance to the results
-        dist_matrix[v.index] = v.val
-
-    free(nodes)
-
-@cython.boundscheck(False)
 cdef _dijkstra_undirected(
-            int[:] source_indices,
-            double[:] csr_weights,
-            int[:] csr_indices,
-            int[:] csr_indptr,
-            double[:] csrT_weights,
-            int[:] csrT_indices,
-            int[:] csrT_indptr,
-            double[:, :] dist_matrix,
-            int[:, :] pred,
-            DTYPE_t limit):
-    cdef:
-        unsigned int Nind = dist_matrix.shape[0]
-        unsigned int N = dist_matrix.shape[1]
-        unsigned int i, k, j_source, j_current
-        ITYPE_t j
-        DTYPE_t next_val
-        int return_pred = (pred.size > 0)
-        FibonacciHeap heap
-        FibonacciNode *v
-        FibonacciNode* nodes = <FibonacciNode*> malloc(N *
-                                                       sizeof(FibonacciNode))
-
-    for i in range(Nind):
-        j_source = source_indices[i]
-
-        for k in range(N):
-            initialize_node(&nodes[k], k)
+            const int[::1] source_indices,
+            const double[::1] csr_weights,
+            const int[::1] csr_indices,
+            const int[::1] csr_indptr,
+            const double[::1] csrT_weights,
+            const int[::1] csrT_indices,
+            const int[::1] csrT_indptr,
+            double[:, ::1] dist_matrix,
+            int[:, ::1] pred,
+            DTYPE_t limit,
+            int nthreads=1):
+    cdef csr_graph graph = _make_graph(csr_weights, csr_indices, csr_indptr)
+    graph.T_weights = _weights_ptr(csrT_weights)
+    graph.T_indices = _indices_ptr(csrT_indices)
+    graph.T_indptr = &csrT_indptr[0]
+    _dijkstra_run(&graph, source_indices, dist_matrix, pred, limit, nthreads)
 
-        dist_matrix[i, j_source] = 0
-        heap.min_node = NULL
-        insert_node(&heap, &nodes[j_source])
 
-        while heap.min_node:
-            v = remove_min(&heap)
-            v.state = SCANNED
+cdef _dijkstra_undirected_multi(
+            const int[::1] source_indices,
+            const double[::1] csr_weights,
+            const int[::1] csr_indices,
+            const int[::1] csr_indptr,
+            const double[::1] csrT_weights,
+            const int[::1] csrT_indices,
+            const int[::1] csrT_indptr,
+            double[::1] dist_matrix,
+            int[::1] pred,
+            int[::1] sources,
+            DTYPE_t limit):
+    cdef csr_graph graph = _make_graph(csr_weights, csr_indices, csr_indptr)
+    graph.T_weights = _weights_ptr(csrT_weights)
+    graph.T_indices = _indices_ptr(csrT_indices)
+    graph.T_indptr = &csrT_indptr[0]
+    _dijkstra_run_multi(&graph, source_indices, dist_matrix, pred, sources,
+                        limit)
 
-            _dijkstra_scan_heap(&heap, v, nodes,
-                                csr_weights, csr_indices, csr_indptr,
-                                pred, return_pred, limit, i)
 
-            _dijkstra_scan_heap(&heap, v, nodes,
-                                csrT_weights, csrT_indices, csrT_indptr,
-                                pred, return_pred, limit, i)
+######################################################################
+# Delta-stepping
+#  A single search on several threads [Meyer & Sanders 2003]. Nodes are
+#  kept in buckets of width delta of their tentative distances, and all
+#  the nodes of the lowest non-empty bucket are expanded at once. Each
+#  round has three phases, each run on the threads:
+#
+#  - gather: the nodes of the current bucket become the frontier,
+#  - relax: the edges from the frontier produce relaxation requests,
+#  - apply: the requests lower the distances and refill the buckets.
+#
+#  The nodes are split into nparts contiguous partitions. Only the phase
+#  that owns a partition writes the distances, buckets and frontier of
+#  its nodes, and the relax phase only reads them, so no atomic
+#  operations are needed. Requests are sorted by the partition of their
+#  target as they are made. Pending nodes are always within nbuckets of
+#  the current bucket, so the buckets are used cyclically.
+#
+#  Ties are broken towards the lower predecessor while a node has not
+#  been expanded yet, and the phases process sets of nodes, so the
+#  result does not depend on the number of threads. The nearest starting
+#  nodes are found from the predecessors at the end: a node may be
+#  expanded again at a distance lower by a rounding error, which leaves
+#  the distances of its successors, and so their predecessors, as they
+#  are.
 
-            # v has now been scanned: add the distance to the results
-            dist_matrix[i, v.index] = v.val
+cdef struct node_list:
+    ITYPE_t *items
+    Py_ssize_t size, capacity
 
-    free(nodes)
 
-@cython.boundscheck(False)
-cdef _dijkstra_undirected_multi(
-            int[:] source_indices,
-            double[:] csr_weights,
-            int[:] csr_indices,
-            int[:] csr_indptr,
-            double[:] csrT_weights,
-            int[:] csrT_indices,
-            int[:] csrT_indptr,
-            double[:] dist_matrix,
-            int[:] pred,
-            int[:] sources,
-            DTYPE_t limit):
-    cdef:
-        unsigned int Nind = source_indices.shape[0]
-        unsigned int N = dist_matrix.shape[0]
-        unsigned int i, k, j_source, j_current
-        ITYPE_t j
-        DTYPE_t next_val
-        int return_pred = (pred.size > 0)
-        FibonacciHeap heap
-        FibonacciNode *v
-        FibonacciNode *current_node
-        FibonacciNode* nodes = <FibonacciNode*> malloc(N *
-                                                       sizeof(FibonacciNode))
+cdef struct relax_request:
+    DTYPE_t val
+    ITYPE_t node, pred
+
+
+cdef struct request_list:
+    relax_request *items
+    Py_ssize_t size, capacity
+
+
+cdef struct delta_work:
+    const csr_graph *graph
+    DTYPE_t *dist
+    ITYPE_t *pred
+    ITYPE_t *sources
+    # the distance at which each node was last expanded
+    DTYPE_t *expanded
+    DTYPE_t limit, delta
+    int nparts
+    ITYPE_t part_size
+    # the current bucket, and the cyclic buckets of each partition,
+    # bins[p * nbuckets + b % nbuckets]
+    Py_ssize_t cur, nbuckets
+    node_list *bins
+    # the frontier of each partition, and where it starts in the
+    # concatenated frontier
+    node_list *frontier
+    Py_ssize_t *frontier_start
+    # requests[s * nparts + p] are those of relax slot s to partition p
+    request_list *requests
+    # blocks of work, the next one to claim, the next relax slot, and
+    # whether a thread ran out of memory
+    Py_ssize_t nblocks, next
+    int nslots
+    bint nomem
+    zeros_mutex lock
+
+
+cdef int _grow(void **items, Py_ssize_t *capacity, size_t itemsize,
+               Py_ssize_t size) nogil:
+    # Makes room for one more item after size; returns -1 if out of memory
+    cdef Py_ssize_t n
+    cdef void *p
+    if size < capacity[0]:
+        return 0
+    n = max(2 * capacity[0], 16)
+    p = realloc(items[0], n * itemsize)
+    if p == NULL:
+        return -1
+    items[0] = p
+    capacity[0] = n
+    return 0
+
+
+cdef inline bint _bin_push(node_list *l, ITYPE_t v) nogil:
+    if _grow(<void **>&l.items, &l.capacity, sizeof(ITYPE_t), l.size) < 0:
+        return False
+    l.items[l.size] = v
+    l.size += 1
+    return True
+
+
+cdef inline Py_ssize_t _bucket(const delta_work *w, DTYPE_t d) nogil:
+    # distances are at most N * max weight, and delta is large enough
+    # that their buckets fit
+    return <Py_ssize_t>(d / w.delta)
+
+
+cdef void _delta_fail(delta_work *w) nogil:
+    zeros_mutex_lock(&w.lock)
+    w.nomem = True
+    zeros_mutex_unlock(&w.lock)
+
+
+cdef Py_ssize_t _delta_claim(delta_work *w) nogil:
+    # Returns the next block of work of a phase, or -1
+    cdef Py_ssize_t b
+    zeros_mutex_lock(&w.lock)
+    b = w.next
+    w.next += 1
+    if w.nomem or b >= w.nblocks:
+        b = -1
+    zeros_mutex_unlock(&w.lock)
+    return b
+
+
+cdef void _delta_gather(void *arg) nogil:
+    # Moves the nodes of the current bucket of claimed partitions to
+    # their frontiers, skipping those which have moved to a lower bucket
+    # or have already been expanded at their distance
+    cdef delta_work *w = <delta_work *>arg
+    cdef Py_ssize_t p, i
+    cdef ITYPE_t v
+    cdef DTYPE_t d
+    cdef node_list *b
+    cdef node_list *f
+
+    p = _delta_claim(w)
+    while p >= 0:
+        b = &w.bins[p * w.nbuckets + w.cur % w.nbuckets]
+        f = &w.frontier[p]
+        f.size = 0
+        for i in range(b.size):
+            v = b.items[i]
+            d = w.dist[v]
+            if d < w.expanded[v] and _bucket(w, d) == w.cur:
+                w.expanded[v] = d
+                f.items[f.size] = v
+                f.size += 1
+        b.size = 0
+        p = _delta_claim(w)
+
+
+cdef bint _delta_relax_edges(delta_work *w, request_list *requests,
+                             ITYPE_t u, const DTYPE_t *weights,
+                             const ITYPE_t *indices,
+                             const ITYPE_t *indptr) nogil:
+    cdef ITYPE_t j, v
+    cdef DTYPE_t val, d = w.dist[u]
+    cdef request_list *r
+
+    for j in range(indptr[u], indptr[u + 1]):
+        v = indices[j]
+        val = d + weights[j]
+        if val > w.limit or val > w.dist[v]:
+            continue
+        if val == w.dist[v] and (w.pred == NULL or u >= w.pred[v]):
+            continue
+        r = &requests[v // w.part_size]
+        if _grow(<void **>&r.items, &r.capacity, sizeof(relax_request),
+                 r.size) < 0:
+            return False
+        r.items[r.size].val = val
+        r.items[r.size].node = v
+        r.items[r.size].pred = u
+        r.size += 1
+    return True
+
+
+cdef void _delta_relax(void *arg) nogil:
+    # Makes the requests of claimed blocks of the frontier
+    cdef delta_work *w = <delta_work *>arg
+    cdef const csr_graph *g = w.graph
+    cdef Py_ssize_t b, i, end, p = 0
+    cdef int slot
+    cdef ITYPE_t u
+    cdef bint ok = True
+    cdef request_list *requests
+
+    zeros_mutex_lock(&w.lock)
+    slot = w.nslots
+    w.nslots += 1
+    zeros_mutex_unlock(&w.lock)
+    requests = w.requests + slot * w.nparts
+
+    b = _delta_claim(w)
+    while b >= 0 and ok:
+        end = min((b + 1) * DELTA_BLOCK, w.frontier_start[w.nparts])
+        for i in range(b * DELTA_BLOCK, end):
+            while i >= w.frontier_start[p + 1]:
+                p += 1
+            while i < w.frontier_start[p]:
+                p -= 1
+            u = w.frontier[p].items[i - w.frontier_start[p]]
+            ok = _delta_relax_edges(w, requests, u, g.weights, g.indices,
+                                    g.indptr)
+            if ok and g.T_indptr != NULL:
+                ok = _delta_relax_edges(w, requests, u, g.T_weights,
+                                        g.T_indices, g.T_indptr)
+            if not ok:
+                _delta_fail(w)
+                break
+        b = _delta_claim(w)
+
+
+cdef void _delta_apply(void *arg) nogil:
+    # Applies the requests to the nodes of claimed partitions
+    cdef delta_work *w = <delta_work *>arg
+    cdef Py_ssize_t p, s, i
+    cdef ITYPE_t v
+    cdef relax_request *r
+    cdef request_list *l
+
+    p = _delta_claim(w)
+    while p >= 0:
+        for s in range(w.nparts):
+            l = &w.requests[s * w.nparts + p]
+            for i in range(l.size):
+                r = &l.items[i]
+                v = r.node
+                if r.val < w.dist[v]:
+                    w.dist[v] = r.val
+                    if not _bin_push(&w.bins[p * w.nbuckets
+                                             + _bucket(w, r.val)
+                                             % w.nbuckets], v):
+                        _delta_fail(w)
+                        return
+                elif not (r.val == w.dist[v] and r.val < w.expanded[v]
+                          and w.pred != NULL and r.pred < w.pred[v]):
+                    continue
+                if w.pred != NULL:
+                    w.pred[v] = r.pred
+            l.size = 0
+        p = _delta_claim(w)
+
+
+cdef void _delta_phase(delta_work *w, void (*func)(void *) nogil,
+                       Py_ssize_t nblocks, Py_ssize_t work,
+                       int nthreads) nogil:
+    # Runs a phase on threads if there is enough work
+    w.nblocks = nblocks
+    w.next = 0
+    w.nslots = 0
+    if work < DELTA_PARALLEL_MIN:
+        nthreads = 1
+    zeros_run_threads(max(1, min(nthreads, nblocks)), func, w)
+
+
+cdef void _delta_stepping_search(delta_work *w, const ITYPE_t *starts,
+                                 Py_ssize_t nstarts, int nthreads) nogil:
+    cdef Py_ssize_t i, p, k, total
+    cdef ITYPE_t v
+    cdef int nparts = w.nparts
+
+    for i in range(nstarts):
+        v = starts[i]
+        w.dist[v] = 0
+        if w.sources != NULL:
+            w.sources[v] = v
+        if not _bin_push(&w.bins[(v // w.part_size) * w.nbuckets], v):
+            w.nomem = True
+            return
+    w.cur = 0
+
+    while not w.nomem:
+        # the lowest non-empty bucket
+        total = 0
+        for k in range(w.nbuckets):
+            for p in range(nparts):
+                total += w.bins[p * w.nbuckets
+                                + (w.cur + k) % w.nbuckets].size
+            if total > 0:
+                w.cur += k
+                break
+        if total == 0:
+            break
+
+        _delta_phase(w, _delta_gather, nparts, total, nthreads)
+
+        w.frontier_start[0] = 0
+        for p in range(nparts):
+            w.frontier_start[p + 1] = w.frontier_start[p] + w.frontier[p].size
+        total = w.frontier_start[nparts]
+        if total == 0:
+            continue
+
+        _delta_phase(w, _delta_relax, (total + DELTA_BLOCK - 1) // DELTA_BLOCK,
+                     total, nthreads)
+        if w.nomem:
+            break
+
+        total = 0
+        for k in range(nparts * nparts):
+            total += w.requests[k].size
+        _delta_phase(w, _delta_apply, nparts, total, nthreads)
+
+    if w.sources != NULL and not w.nomem:
+        _delta_sources(w)
+
+
+cdef void _delta_sources(delta_work *w) nogil:
+    # Sets the sources of the nodes reached from those of their
+    # predecessors, following each chain of predecessors once
+    cdef ITYPE_t v, u, s, next_u
+
+    for v in range(w.graph.N):
+        u = v
+        while w.sources[u] == NULL_IDX and w.pred[u] != NULL_IDX:
+            u = w.pred[u]
+        s = w.sources[u]
+        u = v
+        while w.sources[u] == NULL_IDX and w.pred[u] != NULL_IDX:
+            next_u = w.pred[u]
+            w.sources[u] = s
+            u = next_u
+
+
+cdef _dijkstra_delta_stepping(
+            const int[::1] source_indices,
+            const double[::1] csr_weights,
+            const int[::1] csr_indices,
+            const int[::1] csr_indptr,
+            const double[::1] csrT_weights,
+            const int[::1] csrT_indices,
+            const int[::1] csrT_indptr,
+            double[::1] dist_matrix,
+            int[::1] pred,
+            int[::1] sources,
+            DTYPE_t limit,
+            DTYPE_t delta,
+            Py_ssize_t nbuckets,
+            int nthreads):
+    """
+    A search from the nearest of source_indices, with delta-stepping.
 
-    _dijkstra_setup_heap_multi(&heap, nodes, source_indices,
-                               sources, dist_matrix, return_pred)
+    dist_matrix must be infinite, and pred and sources NULL_IDX or
+    empty; sources are only found along with pred. The graph is
+    undirected if csrT_indptr is not empty. All the weights must be
+    non-negative, and no larger than (nbuckets - 2) * delta.
+    """
+    cdef csr_graph graph = _make_graph(csr_weights, csr_indices, csr_indptr)
+    cdef delta_work w
+    cdef int nparts = nthreads
+    cdef Py_ssize_t N = graph.N
+    cdef bint return_pred = pred.shape[0] > 0
+    cdef const ITYPE_t *starts
+    cdef Py_ssize_t p, nstarts = source_indices.shape[0]
+
+    if csrT_indptr.shape[0] > 0:
+        graph.T_weights = _weights_ptr(csrT_weights)
+        graph.T_indices = _indices_ptr(csrT_indices)
+        graph.T_indptr = &csrT_indptr[0]
+    if N == 0 or nstarts == 0:
+        return
+
+    starts = &source_indices[0]
+    w.graph = &graph
+    w.dist = &dist_matrix[0]
+    w.pred = &pred[0] if return_pred else NULL
+    w.sources = &sources[0] if return_pred and sources.shape[0] > 0 else NULL
+    w.limit = limit
+    w.delta = delta
+    w.nparts = nparts
+    w.part_size = (N + nparts - 1) // nparts
+    w.nbuckets = nbuckets
+    w.nomem = False
+
+    w.expanded = <DTYPE_t *>malloc(N * sizeof(DTYPE_t))
+    w.bins = <node_list *>calloc(nparts * nbuckets, sizeof(node_list))
+    w.frontier = <node_list *>calloc(nparts, sizeof(node_list))
+    w.frontier_start = <Py_ssize_t *>malloc((nparts + 1) * sizeof(Py_ssize_t))
+    w.requests = <request_list *>calloc(nparts * nparts, sizeof(request_list))
+    try:
+        if (w.expanded == NULL or w.bins == NULL or w.frontier == NULL
+                or w.frontier_start == NULL or w.requests == NULL):
+            raise MemoryError()
+        for p in range(N):
+            w.expanded[p] = INFINITY
+        for p in range(nparts):
+            w.frontier[p].items = <ITYPE_t *>malloc(
+                w.part_size * sizeof(ITYPE_t))
+            if w.frontier[p].items == NULL:
+                raise MemoryError()
+
+        zeros_mutex_init(&w.lock)
+        with nogil:
+            _delta_stepping_search(&w, starts, nstarts, nthreads)
+        zeros_mutex_destroy(&w.lock)
+        if w.nomem:
+            raise MemoryError()
+    finally:
+        if w.bins != NULL:
+            for p in range(nparts * nbuckets):
+                free(w.bins[p].items)
+        if w.frontier != NULL:
+            for p in range(nparts):
+                free(w.frontier[p].items)
+        if w.requests != NULL:
+            for p in range(nparts * nparts):
+                free(w.requests[p].items)
+        free(w.expanded)
+        free(w.bins)
+        free(w.frontier)
+        free(w.frontier_start)
+        free(w.requests)
+
+
+def _dijkstra_breadth_first(csgraph, csgraphT, directed, indices,
+                            dist_matrix, pred, sources, DTYPE_t limit,
+                            int nthreads):
+    """
+    An unweighted search from the nearest of indices, on several threads.
 
-    while heap.min_node:
-        v = remove_min(&heap)
-        v.state = SCANNED
+    The distances are the levels of a breadth-first search from all of
+    indices at once, which stops at limit. dist_matrix, pred and sources
+    are as in _dijkstra_delta_stepping; csgraphT is None if directed.
+    """
+    cdef Py_ssize_t N = dist_matrix.shape[0]
+    if N == 0:
+        return
+    if csgraphT is None:
+        csgraphT = csgraph.T.tocsr()
 
-        _dijkstra_scan_heap_multi(&heap, v, nodes,
-                                  csr_weights, csr_indices, csr_indptr,
-                                  pred, sources, return_pred, limit)
+    node_list = np.empty(N, dtype=ITYPE)
+    level = np.empty(N, dtype=ITYPE)
+    if pred.shape[0] == 0:
+        pred = np.empty(N, dtype=ITYPE)
+    # levels are below N, so a larger limit does not stop the search
+    max_level = int(limit) if limit < N else -1
+
+    length = cs_graph_bfs_parallel(N, csgraph.indptr, csgraph.indices,
+                                   csgraphT.indptr, csgraphT.indices,
+                                   int(directed), len(indices), indices,
+                                   max_level, node_list, pred, level,
+                                   nthreads)
+    reached = level >= 0
+    dist_matrix[reached] = level[reached]
+    if sources.shape[0] > 0:
+        _breadth_first_sources(node_list[:length], pred, sources)
+
+
+cdef void _breadth_first_sources(const ITYPE_t[::1] node_list,
+                                 const ITYPE_t[::1] pred,
+                                 ITYPE_t[::1] sources) nogil:
+    # node_list has the predecessor of each node before the node itself,
+    # so the sources are passed down it
+    cdef Py_ssize_t k
+    cdef ITYPE_t v
+    for k in range(node_list.shape[0]):
+        v = node_list[k]
+        if pred[v] == NULL_IDX:
+            sources[v] = v
+        else:
+            sources[v] = sources[pred[v]]
 
-        _dijkstra_scan_heap_multi(&heap, v, nodes,
-                                  csrT_weights, csrT_indices, csrT_indptr,
-                                  pred, sources, return_pred, limit)
 
-        #v has now been scanned: add the distance to the results
-        dist_matrix[v.index] = v.val
+def _delta_stepping_width(weights):
+    """
+    Bucket width and number of buckets of delta-stepping for weights.
 
-    free(nodes)
+    The width is the mean positive weight, so that a node is expected to
+    be relaxed from about one bucket, unless that needs too many buckets.
+    """
+    max_weight = weights.max() if weights.size else 0
+    positive = weights[weights > 0]
+    delta = positive.mean() if positive.size else 1.0
+    if max_weight / delta > DELTA_MAX_BUCKETS - 3:
+        delta = max_weight / (DELTA_MAX_BUCKETS - 3)
+    # one bucket more than max_weight / delta guards against rounding
+    return delta, int(max_weight / delta) + 3
 
 
 def bellman_ford(csgraph, directed=True, indices=None,
@@ -1284,7 +1968,8 @@ def johnson(csgraph, directed=True, indices=None,
     if directed:
         _dijkstra_directed(indices,
                            csr_data, csgraph.indices, csgraph.indptr,
-                           dist_matrix, predecessor_matrix, np.inf)
+                           dist_matrix, predecessor_matrix, np.inf,
+                           _workers(None))
     else:
         csgraphT = csr_matrix((csr_data, csgraph.indices, csgraph.indptr),
                                csgraph.shape).T.tocsr()
@@ -1293,7 +1978,8 @@ def johnson(csgraph, directed=True, indices=None,
         _dijkstra_undirected(indices,
                              csr_data, csgraph.indices, csgraph.indptr,
                              csgraphT.data, csgraphT.indices, csgraphT.indptr,
-                             dist_matrix, predecessor_matrix, np.inf)
+                             dist_matrix, predecessor_matrix, np.inf,
+                             _workers(None))
 
     # ------------------------------
     # correct the distance matrix for the bellman-ford weights
@@ -1397,244 +2083,107 @@ cdef int _johnson_undirected(
 
 
 ######################################################################
-# FibonacciNode structure
-#  This structure and the operations on it are the nodes of the
-#  Fibonacci heap.
+# BinaryHeap structure
+#  An array-based min-heap of the nodes of a graph, keyed by their
+#  tentative distances. Each entry keeps its key next to its node, so
+#  that sifting only touches the heap array. pos[k] is the position of
+#  node k in the heap, or NOT_IN_HEAP or SCANNED, so that the key of a
+#  node can be decreased in place. scanned is a work array of the
+#  searches, for the nodes which have been popped.
 #
-cdef enum FibonacciState:
-    SCANNED
-    NOT_IN_HEAP
-    IN_HEAP
-
 
-cdef struct FibonacciNode:
-    unsigned int index
-    unsigned int rank
-    unsigned int source
-    FibonacciState state
+cdef struct HeapEntry:
     DTYPE_t val
-    FibonacciNode* parent
-    FibonacciNode* left_sibling
-    FibonacciNode* right_sibling
-    FibonacciNode* children
-
-
-cdef void initialize_node(FibonacciNode* node,
-                          unsigned int index,
-                          DTYPE_t val=0):
-    # Assumptions: - node is a valid pointer
-    #              - node is not currently part of a heap
-    node.index = index
-    node.source = -9999
-    node.val = val
-    node.rank = 0
-    node.state = NOT_IN_HEAP
-
-    node.parent = NULL
-    node.left_sibling = NULL
-    node.right_sibling = NULL
-    node.children = NULL
-
-
-cdef FibonacciNode* rightmost_sibling(FibonacciNode* node):
-    # Assumptions: - node is a valid pointer
-    cdef FibonacciNode* temp = node
-    while(temp.right_sibling):
-        temp = temp.right_sibling
-    return temp
-
-
-cdef FibonacciNode* leftmost_sibling(FibonacciNode* node):
-    # Assumptions: - node is a valid pointer
-    cdef FibonacciNode* temp = node
-    while(temp.left_sibling):
-        temp = temp.left_sibling
-    return temp
-
-
-cdef void add_child(FibonacciNode* node, FibonacciNode* new_child):
-    # Assumptions: - node is a valid pointer
-    #              - new_child is a valid pointer
-    #              - new_child is not the sibling or child of another node
-    new_child.parent = node
-
-    if node.children:
-        add_sibling(node.children, new_child)
-    else:
-
-        node.children = new_child
-        new_child.right_sibling = NULL
-        new_child.left_sibling = NULL
-        node.rank = 1
-
-
-cdef void add_sibling(FibonacciNode* node, FibonacciNode* new_sibling):
-    # Assumptions: - node is a valid pointer
-    #              - new_sibling is a valid pointer
-    #              - new_sibling is not the child or sibling of another node
-    cdef FibonacciNode* temp = rightmost_sibling(node)
-    temp.right_sibling = new_sibling
-    new_sibling.left_sibling = temp
-    new_sibling.right_sibling = NULL
-    new_sibling.parent = node.parent
-    if new_sibling.parent:
-        new_sibling.parent.rank += 1
-
-
-cdef void remove(FibonacciNode* node):
-    # Assumptions: - node is a valid pointer
-    if node.parent:
-        node.parent.rank -= 1
-        if node.left_sibling:
-            node.parent.children = node.left_sibling
-        elif node.right_sibling:
-            node.parent.children = node.right_sibling
-        else:
-            node.parent.children = NULL
-
-    if node.left_sibling:
-        node.left_sibling.right_sibling = node.right_sibling
-    if node.right_sibling:
-        node.right_sibling.left_sibling = node.left_sibling
-
-    node.left_sibling = NULL
-    node.right_sibling = NULL
-    node.parent = NULL
-
-
-######################################################################
-# FibonacciHeap structure
-#  This structure and operations on it use the FibonacciNode
-#  routines to implement a Fibonacci heap
-
-ctypedef FibonacciNode* pFibonacciNode
-
-
-cdef struct FibonacciHeap:
-    FibonacciNode* min_node
-    pFibonacciNode[100] roots_by_rank  # maximum number of nodes is ~2^100.
-
-
-cdef void insert_node(FibonacciHeap* heap,
-                      FibonacciNode* node):
-    # Assumptions: - heap is a valid pointer
-    #              - node is a valid pointer
-    #              - node is not the child or sibling of another node
-    if heap.min_node:
-        add_sibling(heap.min_node, node)
-        if node.val < heap.min_node.val:
-            heap.min_node = node
-    else:
-        heap.min_node = node
-
-
-cdef void decrease_val(FibonacciHeap* heap,
-                       FibonacciNode* node,
-                       DTYPE_t newval):
-    # Assumptions: - heap is a valid pointer
-    #              - newval <= node.val
-    #              - node is a valid pointer
-    #              - node is not the child or sibling of another node
-    #              - node is in the heap
-    node.val = newval
-    if node.parent and (node.parent.val >= newval):
-        remove(node)
-        insert_node(heap, node)
-    elif heap.min_node.val > node.val:
-        heap.min_node = node
-
-
-cdef void link(FibonacciHeap* heap, FibonacciNode* node):
-    # Assumptions: - heap is a valid pointer
-    #              - node is a valid pointer
-    #              - node is already within heap
-
-    cdef FibonacciNode *linknode
-    cdef FibonacciNode *parent
-    cdef FibonacciNode *child
-
-    if heap.roots_by_rank[node.rank] == NULL:
-        heap.roots_by_rank[node.rank] = node
-    else:
-        linknode = heap.roots_by_rank[node.rank]
-        heap.roots_by_rank[node.rank] = NULL
-
-        if node.val < linknode.val or node == heap.min_node:
-            remove(linknode)
-            add_child(node, linknode)
-            link(heap, node)
-        else:
-            remove(node)
-            add_child(linknode, node)
-            link(heap, linknode)
-
-
-cdef FibonacciNode* remove_min(FibonacciHeap* heap):
-    # Assumptions: - heap is a valid pointer
-    #              - heap.min_node is a valid pointer
-    cdef:
-        FibonacciNode *temp
-        FibonacciNode *temp_right
-        FibonacciNode *out
-        unsigned int i
-
-    # make all min_node children into root nodes
-    if heap.min_node.children:
-        temp = leftmost_sibling(heap.min_node.children)
-        temp_right = NULL
-
-        while temp:
-            temp_right = temp.right_sibling
-            remove(temp)
-            add_sibling(heap.min_node, temp)
-            temp = temp_right
-
-        heap.min_node.children = NULL
-
-    # choose a root node other than min_node
-    temp = leftmost_sibling(heap.min_node)
-    if temp == heap.min_node:
-        if heap.min_node.right_sibling:
-            temp = heap.min_node.right_sibling
-        else:
-            out = heap.min_node
-            heap.min_node = NULL
-            return out
-
-    # remove min_node, and point heap to the new min
-    out = heap.min_node
-    remove(heap.min_node)
-    heap.min_node = temp
-
-    # re-link the heap
-    for i in range(100):
-        heap.roots_by_rank[i] = NULL
-
-    while temp:
-        if temp.val < heap.min_node.val:
-            heap.min_node = temp
-        temp_right = temp.right_sibling
-        link(heap, temp)
-        temp = temp_right
-
-    return out
-
-
-######################################################################
-# Debugging: Functions for printing the Fibonacci heap
-#
-#cdef void print_node(FibonacciNode* node, int level=0):
-#    print '%s(%i,%i) %i' % (level*'   ', node.index, node.val, node.rank)
-#    if node.children:
-#        print_node(leftmost_sibling(node.children), level+1)
-#    if node.right_sibling:
-#        print_node(node.right_sibling, level)
-#
-#
-#cdef void print_heap(FibonacciHeap* heap):
-#    print "---------------------------------"
-#    print "min node: (%i, %i)" % (heap.min_node.index, heap.min_node.val)
-#    if heap.min_node:
-#        print_node(leftmost_sibling(heap.min_node))
-#    else:
-#        print "[empty heap]"
+    ITYPE_t node
+
+
+cdef struct BinaryHeap:
+    HeapEntry *entries
+    ITYPE_t *pos
+    ITYPE_t *scanned
+    ITYPE_t size
+
+
+cdef int heap_init(BinaryHeap *heap, ITYPE_t N) nogil:
+    # Returns -1 if out of memory; all the nodes are NOT_IN_HEAP
+    cdef ITYPE_t k
+    heap.entries = <HeapEntry *>malloc((N + 1) * sizeof(HeapEntry))
+    heap.pos = <ITYPE_t *>malloc((N + 1) * sizeof(ITYPE_t))
+    heap.scanned = <ITYPE_t *>malloc((N + 1) * sizeof(ITYPE_t))
+    heap.size = 0
+    if heap.entries == NULL or heap.pos == NULL or heap.scanned == NULL:
+        heap_free(heap)
+        return -1
+    for k in range(N):
+        heap.pos[k] = NOT_IN_HEAP
+    return 0
+
+
+cdef void heap_free(BinaryHeap *heap) nogil:
+    free(heap.entries)
+    free(heap.pos)
+    free(heap.scanned)
+    heap.entries = NULL
+    heap.pos = NULL
+    heap.scanned = NULL
+
+
+cdef inline void heap_sift_up(BinaryHeap *heap, ITYPE_t i,
+                              ITYPE_t node, DTYPE_t val) nogil:
+    # Places node with key val at position i or above
+    cdef ITYPE_t parent
+    while i > 0:
+        parent = (i - 1) >> 1
+        if heap.entries[parent].val <= val:
+            break
+        heap.entries[i] = heap.entries[parent]
+        heap.pos[heap.entries[i].node] = i
+        i = parent
+    heap.entries[i].val = val
+    heap.entries[i].node = node
+    heap.pos[node] = i
+
+
+cdef inline void heap_push(BinaryHeap *heap, ITYPE_t node,
+                           DTYPE_t val) nogil:
+    # Assumptions: - node is NOT_IN_HEAP
+    heap.size += 1
+    heap_sift_up(heap, heap.size - 1, node, val)
+
+
+cdef inline void heap_decrease(BinaryHeap *heap, ITYPE_t node,
+                               DTYPE_t val) nogil:
+    # Assumptions: - node is in the heap, with a key >= val
+    heap_sift_up(heap, heap.pos[node], node, val)
+
+
+cdef inline ITYPE_t heap_pop(BinaryHeap *heap, DTYPE_t *val) nogil:
+    # Removes the node with the lowest key, marks it SCANNED, and
+    # returns it with its key in val
+    # Assumptions: - the heap is not empty
+    cdef ITYPE_t i = 0, child, node = heap.entries[0].node
+    cdef HeapEntry last
+
+    val[0] = heap.entries[0].val
+    heap.pos[node] = SCANNED
+    heap.size -= 1
+    if heap.size == 0:
+        return node
+
+    # sift the last entry down from the root
+    last = heap.entries[heap.size]
+    while True:
+        child = 2 * i + 1
+        if child >= heap.size:
+            break
+        if (child + 1 < heap.size
+                and heap.entries[child + 1].val < heap.entries[child].val):
+            child += 1
+        if heap.entries[child].val >= last.val:
+            break
+        heap.entries[i] = heap.entries[child]
+        heap.pos[heap.entries[i].node] = i
+        i = child
+    heap.entries[i] = last
+    heap.pos[last.node] = i
+    return node
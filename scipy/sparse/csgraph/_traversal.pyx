@@ -13,6 +13,9 @@ cimport numpy as np
 from scipy.sparse import csr_matrix, isspmatrix, isspmatrix_csr, isspmatrix_csc
 from scipy.sparse.csgraph._validation import validate_graph
 from scipy.sparse.csgraph._tools import reconstruct_path
+from scipy.sparse._sparsetools import (cs_graph_components_parallel,
+                                      cs_graph_bfs_parallel)
+from scipy.sparse._workers import _workers
 
 cimport cython
 from libc cimport stdlib
@@ -58,10 +61,19 @@ def connected_components(csgraph, directed=True, connection='weak',
     labels: ndarray
         The length-N array of labels of the connected components.
 
+    Notes
+    -----
+    If `scipy.sparse.set_workers` allows more than one thread, weak and
+    undirected components are found with a parallel union-find [2]_
+    instead of a depth-first search. The labels are the same either way:
+    components are numbered in the order of their lowest node.
+
     References
     ----------
     .. [1] D. J. Pearce, "An Improved Algorithm for Finding the Strongly
            Connected Components of a Directed Graph", Technical Report, 2005
+    .. [2] M. Sutton, T. Ben-Nun, A. Barak, "Optimizing Parallel Graph
+           Connectivity Computation via Subgraph Sampling", IPDPS 2018
 
     Examples
     --------
@@ -107,6 +119,12 @@ def connected_components(csgraph, directed=True, connection='weak',
         n_components = _connected_components_directed(csgraph.indices,
                                                       csgraph.indptr,
                                                       labels)
+    elif _workers(None) > 1:
+        # union-find over the edges of csgraph covers both directions
+        n_components = cs_graph_components_parallel(labels.shape[0],
+                                                    csgraph.indptr,
+                                                    csgraph.indices,
+                                                    labels, _workers(None))
     else:
         csgraph_T = csgraph.T.tocsr()
         n_components = _connected_components_undirected(csgraph.indices,
@@ -127,7 +145,8 @@ def breadth_first_tree(csgraph, i_start, directed=True):
 
     Return the tree generated by a breadth-first search
 
-    Note that a breadth-first tree from a specified node is unique.
+    Note that a breadth-first tree from a specified node is not unique:
+    see `breadth_first_order`.
 
     .. versionadded:: 0.11.0
 
@@ -184,7 +203,7 @@ def breadth_first_tree(csgraph, i_start, directed=True):
            [0, 0, 0, 0]])
 
     Note that the resulting graph is a Directed Acyclic Graph which spans
-    the graph.  A breadth-first tree from a given node is unique.
+    the graph.
     """
     node_list, predecessors = breadth_first_order(csgraph, i_start,
                                                   directed, True)
@@ -272,8 +291,8 @@ cpdef breadth_first_order(csgraph, i_start,
 
     Return a breadth-first ordering starting with specified node.
 
-    Note that a breadth-first order is not unique, but the tree which it
-    generates is unique.
+    Note that a breadth-first order is not unique, and neither is the tree
+    which it generates.
 
     .. versionadded:: 0.11.0
 
@@ -306,6 +325,21 @@ cpdef breadth_first_order(csgraph, i_start,
         predecessors[i]. If node i is not in the tree (and for the parent
         node) then predecessors[i] = -9999.
 
+    Notes
+    -----
+    If `scipy.sparse.set_workers` allows more than one thread, the search
+    runs one level at a time on several threads, and switches between
+    expanding the edges out of the current level and looking for an edge
+    into each unvisited node, whichever touches fewer edges [1]_. Each
+    level is then listed in ascending order, and the predecessors may
+    describe a different breadth-first tree; both are the same for any
+    number of threads.
+
+    References
+    ----------
+    .. [1] S. Beamer, K. Asanovic, D. Patterson, "Direction-Optimizing
+           Breadth-First Search", SC 2012
+
     Examples
     --------
     >>> from scipy.sparse import csr_matrix
@@ -337,7 +371,18 @@ cpdef breadth_first_order(csgraph, i_start,
     node_list.fill(NULL_IDX)
     predecessors.fill(NULL_IDX)
 
-    if directed:
+    if _workers(None) > 1:
+        if not 0 <= i_start < N:
+            raise ValueError("i_start out of range 0...N")
+        csgraph_T = csgraph.T.tocsr()
+        length = cs_graph_bfs_parallel(N, csgraph.indptr, csgraph.indices,
+                                       csgraph_T.indptr, csgraph_T.indices,
+                                       int(directed), 1,
+                                       np.array([i_start], dtype=ITYPE), -1,
+                                       node_list, predecessors,
+                                       np.empty(N, dtype=ITYPE),
+                                       _workers(None))
+    elif directed:
         length = _breadth_first_directed(i_start,
                                 csgraph.indices, csgraph.indptr,
                                 node_list, predecessors)
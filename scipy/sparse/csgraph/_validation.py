@@ -13,7 +13,11 @@ def validate_graph(csgraph, directed, dtype=DTYPE,
                    copy_if_dense=False, copy_if_sparse=False,
                    null_value_in=0, null_value_out=np.inf,
                    infinity_null=True, nan_null=True):
-    """Routine for validation and conversion of csgraph inputs"""
+    """Routine for validation and conversion of csgraph inputs
+
+    Dense outputs have the given floating-point dtype; csr outputs are
+    always of DTYPE.
+    """
     if not (csr_output or dense_output):
         raise ValueError("Internal: dense or csr output must be true")
 
@@ -27,10 +31,11 @@ def validate_graph(csgraph, directed, dtype=DTYPE,
             csgraph = csr_matrix(csgraph, dtype=DTYPE, copy=copy_if_sparse)
         else:
             csgraph = csgraph_to_dense(csgraph, null_value=null_value_out)
+            csgraph = csgraph.astype(dtype, copy=False)
     elif np.ma.isMaskedArray(csgraph):
         if dense_output:
             mask = csgraph.mask
-            csgraph = np.array(csgraph.data, dtype=DTYPE, copy=copy_if_dense)
+            csgraph = np.array(csgraph.data, dtype=dtype, copy=copy_if_dense)
             csgraph[mask] = null_value_out
         else:
             csgraph = csgraph_from_masked(csgraph)
@@ -42,7 +47,7 @@ def validate_graph(csgraph, directed, dtype=DTYPE,
                                                 nan_null=nan_null,
                                                 infinity_null=infinity_null)
             mask = csgraph.mask
-            csgraph = np.asarray(csgraph.data, dtype=DTYPE)
+            csgraph = np.asarray(csgraph.data, dtype=dtype)
             csgraph[mask] = null_value_out
         else:
             csgraph = csgraph_from_dense(csgraph, null_value=null_value_in,
@@ -2,6 +2,7 @@ from __future__ import division, print_function, absolute_import
 
 
 def configuration(parent_package='', top_path=None):
+    from os.path import join
     import numpy
     from numpy.distutils.misc_util import Configuration
 
@@ -9,9 +10,11 @@ def configuration(parent_package='', top_path=None):
 
     config.add_data_dir('tests')
 
+    zeros_dir = join('..', '..', 'optimize', 'Zeros')
     config.add_extension('_shortest_path',
          sources=['_shortest_path.c'],
-         include_dirs=[numpy.get_include()])
+         include_dirs=[numpy.get_include(), zeros_dir],
+         depends=['_floyd_warshall.h', join(zeros_dir, 'zeros_threads.h')])
 
     config.add_extension('_traversal',
          sources=['_traversal.c'],
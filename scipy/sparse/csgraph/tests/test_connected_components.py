@@ -2,6 +2,7 @@ from __future__ import division, print_function, absolute_import
 
 import numpy as np
 from numpy.testing import assert_equal, assert_array_almost_equal
+import scipy.sparse
 from scipy.sparse import csgraph
 
 
@@ -99,3 +100,18 @@ def test_fully_connected_graph():
     g = np.ones((4, 4))
     n_components, labels = csgraph.connected_components(g)
     assert_equal(n_components, 1)
+
+
+def test_parallel_weak_components():
+    # the union-find used with several workers gives the same labels as
+    # the serial search
+    np.random.seed(1234)
+    n = 100000
+    A = scipy.sparse.random(n, n, density=1.0 / n, format='csr')
+    n0, labels0 = csgraph.connected_components(A, connection='weak')
+    for directed in [True, False]:
+        with scipy.sparse.set_workers(3):
+            n1, labels1 = csgraph.connected_components(A, directed=directed,
+                                                       connection='weak')
+        assert_equal(n1, n0)
+        assert_equal(labels1, labels0)
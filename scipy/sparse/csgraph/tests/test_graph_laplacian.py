@@ -4,7 +4,8 @@
 from __future__ import division, print_function, absolute_import
 
 import numpy as np
-from numpy.testing import assert_allclose, assert_array_almost_equal
+from numpy.testing import (assert_allclose, assert_array_almost_equal,
+                           assert_equal)
 from pytest import raises as assert_raises
 from scipy import sparse
 
@@ -134,3 +135,31 @@ def test_sparse_formats():
         for normed in True, False:
             _check_symmetric_graph_laplacian(mat, normed)
 
+
+
+def test_compressed_laplacian():
+    # CSR and CSC graphs give a Laplacian of the same format, equal to the
+    # dense one, whatever the number of threads
+    np.random.seed(1234)
+    A = np.random.rand(300, 300) * (np.random.rand(300, 300) < 0.05)
+    A += np.eye(300)
+    A[5] = 0
+    A[:, 7] = 0
+    A = sparse.csr_matrix(A)
+    for fmt in ('csr', 'csc'):
+        mat = A.asformat(fmt)
+        for normed in True, False:
+            for use_out_degree in True, False:
+                L0, d0 = csgraph.laplacian(mat.toarray(), normed=normed,
+                                           return_diag=True,
+                                           use_out_degree=use_out_degree)
+                for workers in 1, 4:
+                    with sparse.set_workers(workers):
+                        L, d = csgraph.laplacian(
+                            mat, normed=normed, return_diag=True,
+                            use_out_degree=use_out_degree)
+                    assert_equal(L.format, fmt)
+                    # the diagonal of A is replaced, rows 5 and 7 get one
+                    assert_equal(L.nnz, A.nnz + 2)
+                    assert_allclose(L.toarray(), L0, atol=1e-12)
+                    assert_allclose(d, d0, atol=1e-12)
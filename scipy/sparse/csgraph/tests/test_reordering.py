@@ -1,7 +1,9 @@
 from __future__ import division, print_function, absolute_import
 
 import numpy as np
-from numpy.testing import assert_equal
+from numpy.testing import assert_, assert_equal
+from pytest import raises as assert_raises
+import scipy.sparse
 from scipy.sparse.csgraph import (reverse_cuthill_mckee,
         maximum_bipartite_matching, structural_rank)
 from scipy.sparse import diags, csc_matrix, csr_matrix, coo_matrix
@@ -49,6 +51,40 @@ def test_graph_reverse_cuthill_mckee_ordering():
     assert_equal(perm, correct_perm)
 
 
+def test_graph_reverse_cuthill_mckee_pseudo_peripheral():
+    # scrambled copies of a grid with a leaf at its center, which has the
+    # lowest degree
+    m = 30
+    T = diags([1, 1, 1], [-1, 0, 1], (m, m))
+    I = scipy.sparse.identity(m)
+    grid = (scipy.sparse.kron(I, T) + scipy.sparse.kron(T, I)).tolil()
+    grid.resize((m * m + 1, m * m + 1))
+    center = (m // 2) * m + m // 2
+    grid[m * m, m * m] = grid[m * m, center] = grid[center, m * m] = 1
+    graph = scipy.sparse.block_diag([grid] * 5, format='csr')
+    np.random.seed(1234)
+    p = np.random.permutation(graph.shape[0])
+    graph = graph[p][:, p].tocsr()
+
+    def bandwidth(perm):
+        coo = graph[perm][:, perm].tocoo()
+        return np.abs(coo.row - coo.col).max()
+
+    perm0 = reverse_cuthill_mckee(graph, True)
+    perm1 = reverse_cuthill_mckee(graph, True, start='pseudo_peripheral')
+    assert_equal(np.sort(perm1), np.arange(graph.shape[0]))
+    assert_(bandwidth(perm1) < bandwidth(perm0))
+    assert_(bandwidth(perm1) <= m + 1)
+
+    for start in ('min_degree', 'pseudo_peripheral'):
+        perm = reverse_cuthill_mckee(graph, True, start=start)
+        with scipy.sparse.set_workers(3):
+            assert_equal(reverse_cuthill_mckee(graph, True, start=start),
+                         perm)
+
+    assert_raises(ValueError, reverse_cuthill_mckee, graph, start='center')
+
+
 def test_graph_maximum_bipartite_matching():
     A = diags(np.ones(25), offsets=0, format='csc')
     rand_perm = np.random.permutation(25)
@@ -98,6 +134,40 @@ def test_graph_maximum_bipartite_matching():
     assert_equal(any(C3.diagonal() == 0), False)
 
 
+def test_graph_maximum_bipartite_matching_warm_start():
+    np.random.seed(1234)
+    n = 2000
+    cols = np.arange(n)
+
+    def permutation_matrix():
+        return csc_matrix((np.ones(n), (np.random.permutation(n), cols)),
+                          shape=(n, n))
+
+    def assert_perfect(graph, perm):
+        assert_equal(np.sort(perm), cols)
+        assert_(np.all(np.asarray(graph[perm, cols]).ravel() != 0))
+
+    A = (permutation_matrix()
+         + scipy.sparse.random(n, n, density=2.0 / n, format='csc')).tocsc()
+    perm = maximum_bipartite_matching(A)
+    assert_perfect(A, perm)
+
+    # drop part of the matching, and start over from what is left
+    B = A.tolil()
+    B[perm[:200], cols[:200]] = 0
+    B = (B.tocsc() + permutation_matrix()).tocsc()
+    B.eliminate_zeros()
+    perm2 = maximum_bipartite_matching(B, initial_matching=perm)
+    assert_perfect(B, perm2)
+    with scipy.sparse.set_workers(3):
+        perm3 = maximum_bipartite_matching(B, initial_matching=perm)
+    assert_equal(perm3, perm2)
+    assert_equal(structural_rank(B), n)
+
+    assert_raises(ValueError, maximum_bipartite_matching, B,
+                  initial_matching=perm[:-1])
+
+
 def test_graph_structural_rank():
     # Test square matrix #1
     A = csc_matrix([[1, 1, 0], 
@@ -1,11 +1,12 @@
 from __future__ import division, print_function, absolute_import
 
 import numpy as np
-from numpy.testing import assert_array_almost_equal, assert_array_equal
+from numpy.testing import (assert_array_almost_equal, assert_array_equal,
+                           assert_, assert_allclose, assert_equal)
 from pytest import raises as assert_raises
 from scipy.sparse.csgraph import (shortest_path, dijkstra, johnson,
-                                  bellman_ford, construct_dist_matrix,
-                                  NegativeCycleError)
+                                  bellman_ford, floyd_warshall,
+                                  construct_dist_matrix, NegativeCycleError)
 import scipy.sparse
 import pytest
 
@@ -264,3 +265,115 @@ def test_buffer(method):
     G = scipy.sparse.csr_matrix([[1.]])
     G.data.flags['WRITEABLE'] = False
     shortest_path(G, method=method)
+
+
+@pytest.mark.parametrize('directed', [True, False])
+def test_floyd_warshall_blocked(directed):
+    # several tiles, the last one partial; continuous weights make the
+    # shortest paths unique
+    np.random.seed(1234)
+    n = 300
+    G = scipy.sparse.random(n, n, density=0.02, format='csr')
+    SP0, pred0 = dijkstra(G, directed=directed, return_predecessors=True)
+    SP1, pred1 = floyd_warshall(G, directed=directed,
+                                return_predecessors=True)
+    assert_allclose(SP1, SP0)
+    assert_array_equal(pred1, pred0)
+
+    with scipy.sparse.set_workers(3):
+        SP2, pred2 = floyd_warshall(G, directed=directed,
+                                    return_predecessors=True)
+    assert_array_equal(SP2, SP1)
+    assert_array_equal(pred2, pred1)
+
+    SP3 = floyd_warshall(G, directed=directed, dtype=np.float32)
+    assert_equal(SP3.dtype, np.float32)
+    assert_allclose(SP3, SP0, rtol=1e-5)
+
+
+def test_floyd_warshall_dtype():
+    SP = floyd_warshall(directed_G.astype(np.float32), dtype=np.float32)
+    assert_equal(SP.dtype, np.float32)
+    assert_array_almost_equal(SP, directed_SP)
+    assert_raises(ValueError, floyd_warshall, directed_G, dtype=np.int32)
+
+
+@pytest.mark.parametrize('directed', [True, False])
+def test_dijkstra_workers(directed):
+    # searches from several sources run on threads, and single searches
+    # on a large graph use delta-stepping; integer weights make many ties
+    np.random.seed(1234)
+    n = 20000
+    G = scipy.sparse.random(n, n, density=4.0 / n, format='csr')
+    G.data = np.ceil(G.data * 10)
+    GT = G.T.tocsr()
+    indices = np.random.randint(n, size=3)
+
+    SP0, pred0 = dijkstra(G, directed=directed, indices=indices,
+                          return_predecessors=True)
+    with scipy.sparse.set_workers(3):
+        SP1, pred1 = dijkstra(G, directed=directed, indices=indices,
+                              return_predecessors=True)
+        SP2, pred2 = dijkstra(G, directed=directed, indices=indices[0],
+                              return_predecessors=True)
+        SP3, pred3, sources = dijkstra(G, directed=directed,
+                                       indices=indices, min_only=True,
+                                       return_predecessors=True)
+    assert_array_equal(SP1, SP0)
+    assert_array_equal(pred1, pred0)
+    assert_array_equal(SP2, SP0[0])
+    assert_array_equal(SP3, SP0.min(axis=0))
+
+    # the predecessors lie on shortest paths, from the nearest source
+    for SP, pred in [(SP2, pred2), (SP3, pred3)]:
+        v = np.nonzero(pred != -9999)[0]
+        p = pred[v]
+        step = SP[v] - SP[p]
+        on_path = np.asarray(G[p, v]).ravel() == step
+        if not directed:
+            on_path |= np.asarray(GT[p, v]).ravel() == step
+        assert_(np.all(on_path))
+    reached = np.isfinite(SP3)
+    row = {s: i for i, s in enumerate(indices)}
+    rows = np.array([row[s] for s in sources[reached]])
+    assert_array_equal(SP0[rows, np.nonzero(reached)[0]], SP3[reached])
+    assert_array_equal(sources[pred3 != -9999],
+                       sources[pred3[pred3 != -9999]])
+
+
+@pytest.mark.parametrize('directed', [True, False])
+def test_dijkstra_unweighted_workers(directed):
+    # single unweighted searches on a large graph are breadth-first
+    # searches on threads
+    np.random.seed(1234)
+    n = 20000
+    G = scipy.sparse.random(n, n, density=3.0 / n, format='csr')
+    GT = G.T.tocsr()
+    indices = np.random.randint(n, size=3)
+
+    SP0 = dijkstra(G, directed=directed, indices=indices, unweighted=True)
+    with scipy.sparse.set_workers(3):
+        SP1, pred1 = dijkstra(G, directed=directed, indices=indices[0],
+                              unweighted=True, return_predecessors=True)
+        SP2, pred2, sources = dijkstra(G, directed=directed,
+                                       indices=indices, unweighted=True,
+                                       min_only=True,
+                                       return_predecessors=True)
+        SP3 = dijkstra(G, directed=directed, indices=indices[0],
+                       unweighted=True, limit=3.5)
+    assert_array_equal(SP1, SP0[0])
+    assert_array_equal(SP2, SP0.min(axis=0))
+    assert_array_equal(SP3, np.where(SP0[0] <= 3.5, SP0[0], np.inf))
+
+    for SP, pred in [(SP1, pred1), (SP2, pred2)]:
+        v = np.nonzero(pred != -9999)[0]
+        p = pred[v]
+        assert_array_equal(SP[p], SP[v] - 1)
+        edge = np.asarray(G[p, v]).ravel() != 0
+        if not directed:
+            edge |= np.asarray(GT[p, v]).ravel() != 0
+        assert_(np.all(edge))
+    reached = np.isfinite(SP2)
+    row = {s: i for i, s in enumerate(indices)}
+    rows = np.array([row[s] for s in sources[reached]])
+    assert_array_equal(SP0[rows, np.nonzero(reached)[0]], SP2[reached])
@@ -4,8 +4,10 @@ from __future__ import division, print_function, absolute_import
 import numpy as np
 from numpy.testing import assert_
 import numpy.testing as npt
+from pytest import raises as assert_raises
+import scipy.sparse
 from scipy.sparse import csr_matrix
-from scipy.sparse.csgraph import minimum_spanning_tree
+from scipy.sparse.csgraph import minimum_spanning_tree, connected_components
 
 
 def test_minimum_spanning_tree():
@@ -65,3 +67,33 @@ def test_minimum_spanning_tree():
 
         npt.assert_array_equal(mintree.todense(), expected,
             'Incorrect spanning tree found.')
+
+
+def test_minimum_spanning_tree_boruvka():
+    np.random.seed(1234)
+    N = 3000
+    graph = scipy.sparse.random(N, N, density=3.0 / N, format='csr')
+    n_components = connected_components(graph, directed=False,
+                                        return_labels=False)
+
+    # distinct weights: the tree is unique
+    expected = minimum_spanning_tree(graph)
+    for workers in (1, 3):
+        with scipy.sparse.set_workers(workers):
+            mintree = minimum_spanning_tree(graph, method='boruvka')
+        npt.assert_array_equal(mintree.toarray(), expected.toarray())
+        npt.assert_equal(mintree.nnz, N - n_components)
+
+    # equal weights: trees of the same weight
+    graph.data = np.ceil(graph.data * 4)
+    expected = minimum_spanning_tree(graph)
+    for workers in (1, 3):
+        with scipy.sparse.set_workers(workers):
+            mintree = minimum_spanning_tree(graph, method='boruvka')
+        npt.assert_equal(mintree.nnz, expected.nnz)
+        npt.assert_equal(mintree.sum(), expected.sum())
+        npt.assert_equal(connected_components(mintree, directed=False,
+                                              return_labels=False),
+                         n_components)
+
+    assert_raises(ValueError, minimum_spanning_tree, graph, method='prim')
@@ -1,9 +1,11 @@
 from __future__ import division, print_function, absolute_import
 
 import numpy as np
-from numpy.testing import assert_array_almost_equal
+from numpy.testing import (assert_, assert_array_almost_equal,
+                           assert_array_equal)
+import scipy.sparse
 from scipy.sparse.csgraph import (breadth_first_tree, depth_first_tree,
-    csgraph_to_dense, csgraph_from_dense)
+    breadth_first_order, shortest_path, csgraph_to_dense, csgraph_from_dense)
 
 
 def test_graph_breadth_first():
@@ -68,3 +70,36 @@ def test_graph_depth_first_trivial_graph():
         bfirst_test = depth_first_tree(csgraph, 0, directed)
         assert_array_almost_equal(csgraph_to_dense(bfirst_test),
                                   bfirst)
+
+
+def test_breadth_first_order_workers():
+    # the parallel search lists each level in ascending order, with a
+    # predecessor from the level before
+    np.random.seed(1234)
+    n = 20000
+    G = scipy.sparse.random(n, n, density=3.0 / n, format='csr')
+    GT = G.T.tocsr()
+
+    for directed in [True, False]:
+        order0 = breadth_first_order(G, 0, directed, False)
+        dist = shortest_path(G, directed=directed, unweighted=True,
+                             indices=0)
+        with scipy.sparse.set_workers(2):
+            order1, pred1 = breadth_first_order(G, 0, directed)
+        with scipy.sparse.set_workers(4):
+            order2, pred2 = breadth_first_order(G, 0, directed)
+        assert_array_equal(order2, order1)
+        assert_array_equal(pred2, pred1)
+
+        assert_array_equal(np.sort(order1), np.sort(order0))
+        assert_(np.all(np.diff(dist[order1]) >= 0))
+        same_level = dist[order1[1:]] == dist[order1[:-1]]
+        assert_(np.all(order1[1:][same_level] > order1[:-1][same_level]))
+
+        v = order1[1:]
+        p = pred1[v]
+        assert_array_equal(dist[p], dist[v] - 1)
+        edge = np.asarray(G[p, v]).ravel() != 0
+        if not directed:
+            edge |= np.asarray(GT[p, v]).ravel() != 0
+        assert_(np.all(edge))
@@ -6,13 +6,18 @@ __docformat__ = "restructuredtext en"
 
 __all__ = ['csr_matrix', 'isspmatrix_csr']
 
+import operator
+
 import numpy as np
 from scipy._lib.six import xrange
 
 from .base import spmatrix
-from ._sparsetools import (csr_tocsc, csr_tobsr, csr_count_blocks,
-                           get_csr_submatrix)
-from .sputils import upcast, get_index_dtype
+from ._sparsetools import (csr_tocsc, csr_tocsc_threaded,
+                           csr_tobsr_pass1_threaded, csr_tobsr_pass2_threaded,
+                           get_csr_submatrix,
+                           csr_matvec_dot, csr_matvec_axpby)
+from ._workers import _workers
+from .sputils import upcast, upcast_char, get_index_dtype
 
 from .compressed import _cs_matrix
 
@@ -172,13 +177,19 @@ class csr_matrix(_cs_matrix):
         indices = np.empty(self.nnz, dtype=idx_dtype)
         data = np.empty(self.nnz, dtype=upcast(self.dtype))
 
-        csr_tocsc(self.shape[0], self.shape[1],
-                  self.indptr.astype(idx_dtype),
-                  self.indices.astype(idx_dtype),
-                  self.data,
-                  indptr,
-                  indices,
-                  data)
+        args = (self.shape[0], self.shape[1],
+                self.indptr.astype(idx_dtype),
+                self.indices.astype(idx_dtype),
+                self.data,
+                indptr,
+                indices,
+                data)
+
+        workers = _workers(None)
+        if workers > 1:
+            csr_tocsc_threaded(*(args + (workers,)))
+        else:
+            csr_tocsc(*args)
 
         from .csc import csc_matrix
         A = csc_matrix((data, indices, indptr), shape=self.shape)
@@ -205,24 +216,112 @@ class csr_matrix(_cs_matrix):
             if R < 1 or C < 1 or M % R != 0 or N % C != 0:
                 raise ValueError('invalid blocksize %s' % blocksize)
 
-            blks = csr_count_blocks(M,N,R,C,self.indptr,self.indices)
-
+            # there are no more blocks than nonzeros
             idx_dtype = get_index_dtype((self.indptr, self.indices),
-                                        maxval=max(N//C, blks))
+                                        maxval=max(N//C, self.nnz))
+            Ap = self.indptr.astype(idx_dtype, copy=False)
+            Aj = self.indices.astype(idx_dtype, copy=False)
+            workers = _workers(None)
+
             indptr = np.empty(M//R+1, dtype=idx_dtype)
+            csr_tobsr_pass1_threaded(M, N, R, C, Ap, Aj, indptr, workers)
+            blks = indptr[-1]
             indices = np.empty(blks, dtype=idx_dtype)
             data = np.zeros((blks,R,C), dtype=self.dtype)
 
-            csr_tobsr(M, N, R, C,
-                      self.indptr.astype(idx_dtype),
-                      self.indices.astype(idx_dtype),
-                      self.data,
-                      indptr, indices, data.ravel())
+            csr_tobsr_pass2_threaded(M, N, R, C, Ap, Aj, self.data, indptr,
+                                     indices, data.ravel(), workers)
 
             return bsr_matrix((data,indices,indptr), shape=self.shape)
 
     tobsr.__doc__ = spmatrix.tobsr.__doc__
 
+    # fused kernels for iterative solvers
+    def _matvec_dot(self, x):
+        """Compute ``y = A @ x`` and ``np.vdot(x, y)`` in a single pass.
+
+        The matrix must be square. Returns ``(y, vdot(x, y))``.
+        """
+        M, N = self.shape
+        if M != N:
+            raise ValueError('matrix must be square')
+        x = np.asarray(x)
+        if x.shape != (N,):
+            raise ValueError('dimension mismatch')
+
+        dtype = upcast_char(self.dtype.char, x.dtype.char)
+        y = np.empty(M, dtype=dtype)
+        d = np.empty(1, dtype=dtype)
+        csr_matvec_dot(M, N, self.indptr, self.indices,
+                       self.data.astype(dtype, copy=False),
+                       x.astype(dtype, copy=False), y, d, _workers(None))
+        return y, d[0]
+
+    def _matvec_axpby(self, x, alpha, beta, z, out=None):
+        """Compute ``alpha * (A @ x) + beta * z`` in a single pass.
+
+        `out` may be `z` itself, if it has the result dtype.
+        """
+        M, N = self.shape
+        x = np.asarray(x)
+        z = np.asarray(z)
+        if x.shape != (N,) or z.shape != (M,):
+            raise ValueError('dimension mismatch')
+
+        dtype = upcast(self.dtype, x.dtype, z.dtype,
+                       np.asarray(alpha).dtype, np.asarray(beta).dtype)
+        if out is None:
+            out = np.empty(M, dtype=dtype)
+        elif out.shape != (M,) or out.dtype != dtype:
+            raise ValueError('out array has wrong shape or dtype')
+        csr_matvec_axpby(M, N, self.indptr, self.indices,
+                         self.data.astype(dtype, copy=False),
+                         x.astype(dtype, copy=False),
+                         np.array([alpha], dtype=dtype),
+                         np.array([beta], dtype=dtype),
+                         z.astype(dtype, copy=False), out, _workers(None))
+        return out
+
+    def _iter_row_blocks(self, block_size, rows=None, workers=None):
+        """Iterate over rows of the matrix in blocks of `block_size` rows.
+
+        Each block is a CSR matrix equal to ``A[rows[k:k+block_size]]``,
+        but only one block is gathered at a time, so that e.g. mini-batches
+        can be streamed out of a large matrix without building ``A[rows]``.
+
+        Parameters
+        ----------
+        block_size : int
+            Number of rows per block; the last block may be shorter.
+        rows : array_like of int, optional
+            1-D array of the rows to gather, in order. Negative indices
+            count from the end. Defaults to all rows.
+        workers : int, optional
+            Maximum number of threads to use for each block. Defaults to
+            the `scipy.sparse.set_workers` setting.
+
+        """
+        block_size = operator.index(block_size)
+        if block_size < 1:
+            raise ValueError("block_size must be positive")
+        M = self.shape[0]
+        if rows is not None:
+            rows = np.asarray(rows)
+            if rows.ndim != 1:
+                raise IndexError('rows must be 1-D')
+        n_rows = M if rows is None else len(rows)
+        workers = _workers(workers)
+
+        idx_dtype = self.indices.dtype
+        for start in xrange(0, n_rows, block_size):
+            stop = min(start + block_size, n_rows)
+            if rows is None:
+                idx = np.arange(start, stop, dtype=idx_dtype)
+            else:
+                idx = self._asindices(rows[start:stop], M)
+                idx = np.asarray(idx, dtype=idx_dtype)
+            yield self._gather_major(idx, workers)
+
     # these functions are used by the parent class (_cs_matrix)
     # to remove redudancy between csc_matrix and csr_matrix
     def _swap(self, x):
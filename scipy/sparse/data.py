@@ -12,6 +12,8 @@ import numpy as np
 
 from .base import spmatrix, _ufuncs_with_fixed_point_at_zero
 from .sputils import isscalarlike, validateaxis, matrix
+from . import _sparsetools
+from ._workers import _workers
 
 __all__ = []
 
@@ -156,28 +158,50 @@ def _find_missing_index(ind, n):
         return -1
 
 
+# Codes of the csr_*_minmax and csr_*_argminmax sparsetools routines; these
+# must match BINOP_MAXIMUM and BINOP_MINIMUM in sparsetools/csr.h
+_minmax_codes = {np.maximum: 4, np.minimum: 5, np.argmax: 4, np.argmin: 5}
+
+
 class _minmax_mixin(object):
     """Mixin for min and max methods.
 
     These are not implemented for dia_matrix, hence the separate class.
     """
 
+    def _reduce_axis_kernel(self, axis, name):
+        """The CSR or CSC matrix to reduce along `axis`, with its duplicates
+        summed, and the sparsetools routine csr_row_<name> or
+        csr_column_<name> that reduces it.
+        """
+        if self.format in ('csr', 'csc'):
+            mat = self
+        else:
+            mat = self.tocsc() if axis == 0 else self.tocsr()
+        mat.sum_duplicates()
+
+        # axis 1 of a CSR matrix, or axis 0 of a CSC one, is the minor axis
+        # and reduces each row of the CSR arrays
+        if axis == mat._swap((1, 0))[0]:
+            fn = getattr(_sparsetools, 'csr_row_' + name)
+        else:
+            fn = getattr(_sparsetools, 'csr_column_' + name)
+        return mat, fn
+
     def _min_or_max_axis(self, axis, min_or_max):
         N = self.shape[axis]
         if N == 0:
             raise ValueError("zero-size array to reduction operation")
         M = self.shape[1 - axis]
 
-        mat = self.tocsc() if axis == 0 else self.tocsr()
-        mat.sum_duplicates()
-
-        major_index, value = mat._minor_reduce(min_or_max)
-        not_full = np.diff(mat.indptr)[major_index] < N
-        value[not_full] = min_or_max(value[not_full], 0)
+        mat, fn = self._reduce_axis_kernel(axis, 'minmax')
+        value = np.empty(M, dtype=mat.dtype)
+        fn(*(mat._swap(mat.shape) +
+             (mat.indptr, mat.indices, mat.data, _minmax_codes[min_or_max],
+              value, _workers(None))))
 
-        mask = value != 0
-        major_index = np.compress(mask, major_index)
-        value = np.compress(mask, value)
+        major_index = np.flatnonzero(value)
+        value = value[major_index]
 
         from . import coo_matrix
         if axis == 0:
@@ -222,29 +246,12 @@ class _minmax_mixin(object):
         if axis < 0:
             axis += 2
 
-        zero = self.dtype.type(0)
-
-        mat = self.tocsc() if axis == 0 else self.tocsr()
-        mat.sum_duplicates()
-
-        ret_size, line_size = mat._swap(mat.shape)
-        ret = np.zeros(ret_size, dtype=int)
-
-        nz_lines, = np.nonzero(np.diff(mat.indptr))
-        for i in nz_lines:
-            p, q = mat.indptr[i:i + 2]
-            data = mat.data[p:q]
-            indices = mat.indices[p:q]
-            am = op(data)
-            m = data[am]
-            if compare(m, zero) or q - p == line_size:
-                ret[i] = indices[am]
-            else:
-                zero_ind = _find_missing_index(indices, line_size)
-                if m == zero:
-                    ret[i] = min(am, zero_ind)
-                else:
-                    ret[i] = zero_ind
+        mat, fn = self._reduce_axis_kernel(axis, 'argminmax')
+        ret = np.empty(self.shape[1 - axis], dtype=mat.indices.dtype)
+        fn(*(mat._swap(mat.shape) +
+             (mat.indptr, mat.indices, mat.data, _minmax_codes[op], ret,
+              _workers(None))))
+        ret = ret.astype(int)
 
         if axis == 1:
             ret = ret.reshape(-1, 1)
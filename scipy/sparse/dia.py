@@ -12,7 +12,8 @@ from .base import isspmatrix, _formats, spmatrix
 from .data import _data_matrix
 from .sputils import (isshape, upcast_char, getdtype, get_index_dtype,
                       get_sum_dtype, validateaxis, check_shape, matrix)
-from ._sparsetools import dia_matvec
+from ._sparsetools import dia_matvec, dia_matvec_threaded
+from ._workers import _workers
 
 
 class dia_matrix(_data_matrix):
@@ -236,7 +237,8 @@ class dia_matrix(_data_matrix):
 
         M,N = self.shape
 
-        dia_matvec(M,N, len(self.offsets), L, self.offsets, self.data, x.ravel(), y.ravel())
+        dia_matvec_threaded(M, N, len(self.offsets), L, self.offsets,
+                            self.data, x.ravel(), y.ravel(), _workers(None))
 
         return y
 
@@ -14,6 +14,8 @@ Type codes used:
     '*':  indicates that the next argument is an output argument
     'v':  void
     'l':  64-bit integer scalar
+    'P':  64-bit integer array
+    'U':  accumulator array, of the type listed for <data> in ACC_TYPES
 
 See sparsetools.cxx for more details.
 
@@ -35,6 +37,7 @@ bsr_tocsr           v iiiiIIT*I*I*T
 bsr_scale_rows      v iiiiII*TT
 bsr_scale_columns   v iiiiII*TT
 bsr_sort_indices    v iiii*I*I*T
+bsr_sort_indices_threaded v iiii*I*I*Ti
 bsr_transpose       v iiiiIIT*I*I*T
 bsr_matmat_pass2    v iiiiiIITIIT*I*I*T
 bsr_matvec          v iiiiIITT*T
@@ -46,6 +49,8 @@ bsr_minus_bsr       v iiiiIITIIT*I*I*T
 bsr_maximum_bsr     v iiiiIITIIT*I*I*T
 bsr_minimum_bsr     v iiiiIITIIT*I*I*T
 bsr_ne_bsr          v iiiiIITIIT*I*I*B
+bsr_binop_bsr_threaded v iiiiIITIIT*I*I*Tii
+bsr_cmpop_bsr_threaded v iiiiIITIIT*I*I*Bii
 bsr_lt_bsr          v iiiiIITIIT*I*I*B
 bsr_gt_bsr          v iiiiIITIIT*I*I*B
 bsr_le_bsr          v iiiiIITIIT*I*I*B
@@ -56,10 +61,15 @@ bsr_ge_bsr          v iiiiIITIIT*I*I*B
 CSC_ROUTINES = """
 csc_diagonal        v iiiIIT*T
 csc_tocsr           v iiIIT*I*I*T
+csc_tocsr_threaded  v iiIIT*I*I*Ti
 csc_matmat_pass1    v iiIIII*I
 csc_matmat_pass2    v iiIITIIT*I*I*T
+csc_matmat_pass1_threaded v iiIIII*Ii
+csc_matmat_pass2_threaded v iiIITIIT*I*I*Ti
 csc_matvec          v iiIITT*T
 csc_matvecs         v iiiIITT*T
+csc_matvec_threaded  v iiIITT*Ti
+csc_matvecs_threaded v iiiIITT*Ti
 csc_elmul_csc       v iiIITIIT*I*I*T
 csc_eldiv_csc       v iiIITIIT*I*I*T
 csc_plus_csc        v iiIITIIT*I*I*T
@@ -67,6 +77,8 @@ csc_minus_csc       v iiIITIIT*I*I*T
 csc_maximum_csc     v iiIITIIT*I*I*T
 csc_minimum_csc     v iiIITIIT*I*I*T
 csc_ne_csc          v iiIITIIT*I*I*B
+csc_binop_csc_threaded v iiIITIIT*I*I*Tii
+csc_cmpop_csc_threaded v iiIITIIT*I*I*Bii
 csc_lt_csc          v iiIITIIT*I*I*B
 csc_gt_csc          v iiIITIIT*I*I*B
 csc_le_csc          v iiIITIIT*I*I*B
@@ -77,12 +89,28 @@ csc_ge_csc          v iiIITIIT*I*I*B
 CSR_ROUTINES = """
 csr_matmat_pass1    v iiIIII*I
 csr_matmat_pass2    v iiIITIIT*I*I*T
+csr_matmat_pass1_threaded v iiIIII*Ii
+csr_matmat_pass2_threaded v iiIITIIT*I*I*Ti
+csr_matmat_masked   v iiIITIITII*Ti
 csr_diagonal        v iiiIIT*T
 csr_tocsc           v iiIIT*I*I*T
+csr_tocsc_threaded  v iiIIT*I*I*Ti
 csr_tobsr           v iiiiIIT*I*I*T
+csr_tobsr_pass1_threaded v iiiiII*Ii
+csr_tobsr_pass2_threaded v iiiiIITI*I*Ti
 csr_todense         v iiIIT*T
 csr_matvec          v iiIITT*T
 csr_matvecs         v iiiIITT*T
+csr_matvec_threaded  v iiIITT*Ti
+csr_matvecs_threaded v iiiIITT*Ti
+csr_matvec_dot      v iiIITT*T*Ti
+csr_matvec_axpby    v iiIITTTTT*Ti
+csr_matvec_batch    v iIIIITT*Ti
+csr_matvec_mixed    v iiPITU*Ui
+csr_matvecs_mixed   v iiiPITU*Ui
+csr_matvecs_tiled   v iiiIITiT*Ti
+csr_symmetric_matvec v iIITT*T
+csr_symmetric_matvec_threaded v iIITT*Ti
 csr_elmul_csr       v iiIITIIT*I*I*T
 csr_eldiv_csr       v iiIITIIT*I*I*T
 csr_plus_csr        v iiIITIIT*I*I*T
@@ -90,23 +118,43 @@ csr_minus_csr       v iiIITIIT*I*I*T
 csr_maximum_csr     v iiIITIIT*I*I*T
 csr_minimum_csr     v iiIITIIT*I*I*T
 csr_ne_csr          v iiIITIIT*I*I*B
+csr_binop_csr_threaded v iiIITIIT*I*I*Tii
+csr_cmpop_csr_threaded v iiIITIIT*I*I*Bii
 csr_lt_csr          v iiIITIIT*I*I*B
 csr_gt_csr          v iiIITIIT*I*I*B
 csr_le_csr          v iiIITIIT*I*I*B
 csr_ge_csr          v iiIITIIT*I*I*B
 csr_scale_rows      v iiII*TT
 csr_scale_columns   v iiII*TT
+csr_laplacian_degrees v iIITi*Ti
+csr_laplacian       v iIITTiT*I*I*Ti
 csr_sort_indices    v iI*I*T
+csr_sort_indices_threaded v iI*I*Ti
 csr_eliminate_zeros v ii*I*I*T
 csr_sum_duplicates  v ii*I*I*T
+csr_row_sums        v iiIIT*Ti
+csr_column_sums     v iiIIT*Ti
+csr_column_nnz      v iiII*Ii
+csr_row_minmax      v iiIITi*Ti
+csr_column_minmax   v iiIITi*Ti
+csr_row_argminmax   v iiIITi*Ii
+csr_column_argminmax v iiIITi*Ii
+csr_append_block    v iiIIT*I*I*Ti
+csr_kron            v iiIITiiIIT*I*I*Ti
+csr_kron_bsr        v iITiiT*Ti
 get_csr_submatrix   v iiIITiiii*V*V*W
 csr_row_index       v iIIIT*I*T
+csr_row_index_threaded v iIIITI*I*Ti
 csr_row_slice       v iiiIIT*I*T
 csr_column_index1   v iIiiII*I*I
 csr_column_index2   v IIiIT*I*T
 csr_sample_values   v iiIITiII*T
+csr_sample_values_threaded v iiIITiII*Ti
 csr_count_blocks    i iiiiII
+csr_sample_block_counts v iiIIiIIi*P*Pi
+csr_random_indices  v iiIl*Ii
 csr_sample_offsets  i iiIIiII*I
+csr_sample_offsets_threaded i iiIIiII*Ii
 expandptr           v iI*I
 test_throw_error    i
 csr_has_sorted_indices    i iII
@@ -116,10 +164,22 @@ csr_has_canonical_format  i iII
 # coo.h, dia.h, csgraph.h
 OTHER_ROUTINES = """
 coo_tocsr           v iiiIIT*I*I*T
+coo_tocsr_canonical v iiiIIT*I*I*Ti
 coo_todense         v iilIIT*Ti
 coo_matvec          v lIITT*T
+coo_hash_add        i lPTl*P*T
+coo_hash_extract    v lPTi*I*I*T
 dia_matvec          v iiiiITT*T
+dia_matvec_threaded v iiiiITT*Ti
 cs_graph_components i iII*I
+cs_graph_components_parallel i iII*Ii
+cs_graph_bfs_parallel i iIIIIiiIi*I*I*Ii
+cs_graph_mst_boruvka i iIIT*Bi
+cs_graph_bipartite_matching i iiII*Ii
+cs_graph_rcm        v iIIIIi*Ii
+csr_tosell_pass1    v iIii*I*I
+csr_tosell_pass2    v iIITiII*I*T
+sell_matvec         v iiIIITT*Ti
 """
 
 # List of compilation units
@@ -161,6 +221,16 @@ T_TYPES = [
     ('NPY_CLONGDOUBLE', 'npy_clongdouble_wrapper'),
 ]
 
+#
+# Accumulator types of the data types that are summed in higher
+# precision by the 'U' routines; other data types accumulate in
+# themselves. Must agree with accumulator_typenum in sparsetools.cxx.
+#
+ACC_TYPES = {
+    'npy_float': 'npy_double',
+    'npy_cfloat_wrapper': 'npy_cdouble_wrapper',
+}
+
 #
 # Code templates
 #
@@ -280,6 +350,11 @@ def parse_routine(name, args, types):
                 args.append("(%s*)a[%d]" % (const + T_type, j))
             elif t == 'B':
                 args.append("(npy_bool_wrapper*)a[%d]" % (j,))
+            elif t == 'U':
+                U_type = ACC_TYPES.get(T_type, T_type)
+                args.append("(%s*)a[%d]" % (const + U_type, j))
+            elif t == 'P':
+                args.append("(%snpy_int64*)a[%d]" % (const, j))
             elif t == 'V':
                 if const:
                     raise ValueError("'V' argument must be an output arg")
@@ -307,6 +382,8 @@ def parse_routine(name, args, types):
             dispatch = "%s,%s" % (I_type, T_type)
         if 'B' in arg_spec:
             dispatch += ",npy_bool_wrapper"
+        if 'U' in arg_spec:
+            dispatch += ",%s" % (ACC_TYPES.get(T_type, T_type),)
 
         piece = """
         case %(j)s:"""
@@ -8,6 +8,8 @@ import numpy as np
 import scipy.linalg
 import scipy.sparse.linalg
 from scipy.sparse.linalg import aslinearoperator
+from scipy.sparse._workers import _workers
+from . import _expm_multiply_core
 
 __all__ = ['expm_multiply']
 
@@ -36,6 +38,21 @@ def _trace(A):
         return np.trace(A)
 
 
+def _compiled_operator(A, B):
+    """
+    The CSR arrays of A, of the result type of A and B, and that type, if
+    the Taylor loops can run in _expm_multiply_core; otherwise None.
+    """
+    if not scipy.sparse.isspmatrix(A) or B.ndim not in (1, 2):
+        return None
+    dtype = np.result_type(A.dtype, B.dtype)
+    if dtype not in (np.float64, np.complex128):
+        return None
+    A = scipy.sparse.csr_matrix(A, dtype=dtype)
+    return (np.ascontiguousarray(A.indptr), np.ascontiguousarray(A.indices),
+            np.ascontiguousarray(A.data)), dtype
+
+
 def _ident_like(A):
     # A compatibility function which should eventually disappear.
     if scipy.sparse.isspmatrix(A):
@@ -77,6 +94,12 @@ def expm_multiply(A, B, start=None, stop=None, num=None, endpoint=None):
     The optional arguments defining the sequence of evenly spaced time points
     are compatible with the arguments of `numpy.linspace`.
 
+    For a sparse `A` of type float64 or complex128 (after promotion with
+    the type of `B`), the truncated Taylor series are summed in compiled
+    code: every term is a single pass over the rows of `A`, which computes
+    the product with `A`, adds it to the sum and updates the norms of the
+    stopping test, on up to ``scipy.sparse.get_workers()`` threads.
+
     The output ndarray shape is somewhat complicated so I explain it here.
     The ndim of the output could be either 1, 2, or 3.
     It would be 1 if you are computing the expm action on a single vector
@@ -196,6 +219,17 @@ def _expm_multiply_simple_core(A, B, t, mu, m_star, s, tol=None, balance=False):
     if tol is None:
         u_d = 2 ** -53
         tol = u_d
+    compiled = _compiled_operator(A, B)
+    if compiled is not None:
+        (indptr, indices, data), dtype = compiled
+        B = np.array(B, dtype=dtype, order='C')
+        F = np.empty_like(B)
+        shape = (B.shape[0], -1)
+        eta = complex(np.exp(t*mu / float(s)))
+        _expm_multiply_core.simple(indptr, indices, data, B.reshape(shape),
+                                   F.reshape(shape), t, eta, m_star, s, tol,
+                                   _workers(None))
+        return F
     F = B
     eta = np.exp(t*mu / float(s))
     for i in range(s):
@@ -638,11 +672,30 @@ def _expm_multiply_interval_core_0(A, X, h, mu, q, norm_info, tol, ell, n0):
     return X, 0
 
 
+def _expm_multiply_interval_compiled(A, X, h, mu, m_star, d, j, r, tol):
+    """
+    A helper function, running the loops of the interval cores 1 and 2 in
+    _expm_multiply_core if possible. Returns whether it did.
+    """
+    compiled = _compiled_operator(A, X[0])
+    if compiled is None or compiled[1] != X.dtype:
+        return False
+    (indptr, indices, data), dtype = compiled
+    eta = np.exp(np.arange(d + 1) * h * mu).astype(dtype)
+    _expm_multiply_core.interval(indptr, indices, data,
+                                 X.reshape(X.shape[:2] + (-1,)), h, eta,
+                                 m_star, d, j, r, tol, _workers(None))
+    return True
+
+
 def _expm_multiply_interval_core_1(A, X, h, mu, m_star, s, q, tol):
     """
     A helper function, for the case q > s and q % s == 0.
     """
     d = q // s
+    # the loops of core 2 with j = s, r = 0
+    if _expm_multiply_interval_compiled(A, X, h, mu, m_star, d, s, 0, tol):
+        return X, 1
     input_shape = X.shape[1:]
     K_shape = (m_star + 1, ) + input_shape
     K = np.empty(K_shape, dtype=X.dtype)
@@ -674,6 +727,8 @@ def _expm_multiply_interval_core_2(A, X, h, mu, m_star, s, q, tol):
     d = q // s
     j = q // d
     r = q - d * j
+    if _expm_multiply_interval_compiled(A, X, h, mu, m_star, d, j, r, tol):
+        return X, 2
     input_shape = X.shape[1:]
     K_shape = (m_star + 1, ) + input_shape
     K = np.empty(K_shape, dtype=X.dtype)
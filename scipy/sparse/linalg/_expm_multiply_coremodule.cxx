@@ -0,0 +1,509 @@
+/*
+ * _expm_multiply_core module
+ *
+ * Compiled Taylor loops of expm_multiply for a CSR matrix A, as run by
+ * _expm_multiply_simple_core and the interval cores in _expm_multiply.py.
+ * A step of a loop is a single pass over the rows, split between threads
+ * by the number of nonzeros: the sparse product, its scaling, the update
+ * of the partial sum and the infinity norms of both are fused, and all
+ * blocks of vectors live in buffers allocated once per call.
+ */
+
+#include <Python.h>
+
+#include <string.h>
+#include <complex>
+#include <new>
+#include <vector>
+#include <algorithm>
+
+#define PY_ARRAY_UNIQUE_SYMBOL _scipy_sparse_linalg_expm_multiply_ARRAY_API
+#include "numpy/arrayobject.h"
+
+#include "parallel.h"
+
+template <class I, class T>
+struct csr_t {
+    npy_intp n;
+    const I *Ap;
+    const I *Aj;
+    const T *Ax;
+    npy_intp n_chunks;
+    std::vector<I> bounds;      /* rows of the threads of a sparse pass */
+};
+
+/* largest of two norms; NaN wins, as in numpy's max */
+static inline double max_norm(double a, double b)
+{
+    return (b > a || b != b) ? b : a;
+}
+
+/* Infinity norm (largest row sum of magnitudes) of rows of n0 entries,
+   merged into *norm */
+template <class T>
+static inline void row_norm(const T *x, int n0, double *norm)
+{
+    double sum = 0;
+
+    for (int k = 0; k < n0; ++k) {
+        sum += std::abs(x[k]);
+    }
+    *norm = max_norm(*norm, sum);
+}
+
+/*
+ * Y = (mul*(A*X))/div and, if F is not NULL, F += c*Y, for blocks of n0
+ * vectors in C order. Returns the infinity norms of Y and F.
+ */
+template <class I, class T>
+static void step(const csr_t<I, T> &A, int n0, const T *X, T *Y, T mul,
+                 T div, T *F, T c, double *y_norm, double *f_norm)
+{
+    std::vector<double> norms(2 * A.n_chunks, 0.0);
+
+    parallel_for_chunks(A.n_chunks, [&](npy_intp ch) {
+        std::vector<T> sum(n0);
+        double *yn = &norms[2 * ch], *fn = yn + 1;
+
+        for (I i = A.bounds[ch]; i < A.bounds[ch + 1]; ++i) {
+            std::fill(sum.begin(), sum.end(), T(0));
+            for (I jj = A.Ap[i]; jj < A.Ap[i + 1]; ++jj) {
+                const T a = A.Ax[jj];
+                const T *x = X + (npy_intp)n0 * A.Aj[jj];
+                for (int k = 0; k < n0; ++k) {
+                    sum[k] += a * x[k];
+                }
+            }
+            T *y = Y + (npy_intp)n0 * i;
+            for (int k = 0; k < n0; ++k) {
+                y[k] = (mul * sum[k]) / div;
+            }
+            row_norm(y, n0, yn);
+            if (F != NULL) {
+                T *f = F + (npy_intp)n0 * i;
+                for (int k = 0; k < n0; ++k) {
+                    f[k] += c * y[k];
+                }
+                row_norm(f, n0, fn);
+            }
+        }
+    });
+
+    *y_norm = *f_norm = 0;
+    for (npy_intp ch = 0; ch < A.n_chunks; ++ch) {
+        *y_norm = max_norm(*y_norm, norms[2 * ch]);
+        *f_norm = max_norm(*f_norm, norms[2 * ch + 1]);
+    }
+}
+
+/*
+ * Y = a*X + b*Y, with Y = a*X if b is zero, for blocks of n rows of n0
+ * entries. Returns the infinity norm of Y.
+ */
+template <class T>
+static double axpby(npy_intp n, int n0, T a, const T *X, T b, T *Y,
+                    int workers)
+{
+    const npy_intp n_chunks = parallel_num_chunks(workers, n * n0);
+    std::vector<double> norms(n_chunks, 0.0);
+    double norm = 0;
+
+    parallel_for_chunks(n_chunks, [&](npy_intp ch) {
+        for (npy_intp i = n * ch / n_chunks; i < n * (ch + 1) / n_chunks;
+             ++i) {
+            const T *x = X + n0 * i;
+            T *y = Y + n0 * i;
+            for (int k = 0; k < n0; ++k) {
+                y[k] = b == T(0) ? a * x[k] : y[k] + a * x[k];
+            }
+            row_norm(y, n0, &norms[ch]);
+        }
+    });
+    for (npy_intp ch = 0; ch < n_chunks; ++ch) {
+        norm = max_norm(norm, norms[ch]);
+    }
+    return norm;
+}
+
+/*
+ * _expm_multiply_simple_core: F = e^(tA) B, for A shifted by mu, with
+ * eta = exp(t*mu/s). B and F are n by n0.
+ */
+template <class I, class T>
+static void simple(const csr_t<I, T> &A, int n0, const T *B, T *F, double t,
+                   T eta, int m_star, int s, double tol, int workers)
+{
+    const npy_intp len = A.n * n0;
+    std::vector<T> buf(2 * len);
+    T *Bc = &buf[0], *Bn = Bc + len;
+    double c1, c2, f_norm;
+
+    memcpy(F, B, len * sizeof(T));
+    c1 = axpby(A.n, n0, T(1), B, T(0), Bc, workers);
+    for (int i = 0; i < s; ++i) {
+        for (int j = 0; j < m_star; ++j) {
+            const double coeff = t / (double)(s * (j + 1));
+            step(A, n0, Bc, Bn, T(coeff), T(1), F, T(1), &c2, &f_norm);
+            std::swap(Bc, Bn);
+            if (c1 + c2 <= tol * f_norm) {
+                break;
+            }
+            c1 = c2;
+        }
+        /* F = eta*F, B = F */
+        c1 = axpby(A.n, n0, eta, F, T(0), F, workers);
+        memcpy(Bc, F, len * sizeof(T));
+    }
+}
+
+/*
+ * _expm_multiply_interval_core_1 and _2: fills X[1:] from X[0], with the
+ * time points in steps of h. The q time points after the first are done
+ * in j + 1 intervals of d points, the last of which has r points (so
+ * j = s, r = 0 in case 1). eta[k] = exp(k*h*mu) for k = 0, ..., d.
+ */
+template <class I, class T>
+static void interval(const csr_t<I, T> &A, int n0, T *X, double h,
+                     const T *eta, int m_star, int d, int j, int r,
+                     double tol, int workers)
+{
+    const npy_intp len = A.n * n0;
+    std::vector<T> K((m_star + 1) * len), F(len);
+    std::vector<double> K_norm(m_star + 1);
+    double c1, c2, f_norm, unused;
+
+    for (int i = 0; i <= j; ++i) {
+        const int effective_d = i < j ? d : r;
+        int high_p = 0;
+
+        memcpy(&K[0], X + (npy_intp)i * d * len, len * sizeof(T));
+        for (int k = 1; k <= effective_d; ++k) {
+            c1 = axpby(A.n, n0, T(1), &K[0], T(0), &F[0], workers);
+            f_norm = c1;
+            for (int p = 1; p <= m_star; ++p) {
+                T *Kp = &K[p * len];
+                if (p == high_p + 1) {
+                    step(A, n0, Kp - len, Kp, T(h), T(p), (T *)NULL, T(0),
+                         &K_norm[p], &unused);
+                    high_p = p;
+                }
+                double coeff = 1;
+                for (int e = 0; e < p; ++e) {
+                    coeff *= k;
+                }
+                f_norm = axpby(A.n, n0, T(coeff), Kp, T(1), &F[0], workers);
+                c2 = coeff * K_norm[p];
+                if (c1 + c2 <= tol * f_norm) {
+                    break;
+                }
+                c1 = c2;
+            }
+            axpby(A.n, n0, eta[k], &F[0], T(0),
+                  X + (npy_intp)(k + i * d) * len, workers);
+        }
+    }
+}
+
+
+/*
+ * Python interface
+ */
+
+/* Checks the CSR matrix, which is not checked elsewhere before the loops
+   read it */
+template <class I>
+static int check_csr(npy_intp n, PyArrayObject *indptr,
+                     PyArrayObject *indices, PyArrayObject *data)
+{
+    const I *Ap = (const I *)PyArray_DATA(indptr);
+    const I *Aj = (const I *)PyArray_DATA(indices);
+    npy_intp k, nnz = Ap[n];
+
+    if (Ap[0] != 0 || nnz > PyArray_DIM(indices, 0) ||
+        nnz > PyArray_DIM(data, 0)) {
+        return -1;
+    }
+    for (k = 0; k < n; ++k) {
+        if (Ap[k + 1] < Ap[k]) {
+            return -1;
+        }
+    }
+    for (k = 0; k < nnz; ++k) {
+        if (Aj[k] < 0 || Aj[k] >= n) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+template <class I, class T>
+static void init_csr(csr_t<I, T> *A, npy_intp n, int n0,
+                     PyArrayObject *indptr, PyArrayObject *indices,
+                     PyArrayObject *data, int workers)
+{
+    A->n = n;
+    A->Ap = (const I *)PyArray_DATA(indptr);
+    A->Aj = (const I *)PyArray_DATA(indices);
+    A->Ax = (const T *)PyArray_DATA(data);
+    A->n_chunks = parallel_num_chunks(workers,
+                                      ((npy_intp)A->Ap[n] + n) * n0);
+    A->bounds.resize(A->n_chunks + 1);
+    partition_rows_by_nnz((I)n, A->Ap, (I)A->n_chunks, &A->bounds[0]);
+}
+
+/* The arguments shared by simple and interval */
+typedef struct {
+    PyArrayObject *indptr, *indices, *data;
+    npy_intp n;
+    int index_type, typenum;
+} csr_args;
+
+static int check_args(csr_args *a, PyArrayObject *X, int ndim)
+{
+    a->typenum = PyArray_TYPE(a->data);
+    a->index_type = PyArray_TYPE(a->indptr);
+    if (a->typenum != NPY_DOUBLE && a->typenum != NPY_CDOUBLE) {
+        PyErr_SetString(PyExc_ValueError, "unsupported data type");
+        return -1;
+    }
+    if (PyArray_NDIM(X) != ndim || PyArray_TYPE(X) != a->typenum ||
+        !PyArray_IS_C_CONTIGUOUS(X) || !PyArray_ISWRITEABLE(X) ||
+        PyArray_DIM(X, ndim - 1) < 1 ||
+        PyArray_DIM(X, ndim - 1) > NPY_MAX_INT) {
+        PyErr_SetString(PyExc_ValueError,
+                        "invalid array of vectors for the matrix");
+        return -1;
+    }
+    a->n = PyArray_DIM(X, ndim - 2);
+    if ((a->index_type != NPY_INT32 && a->index_type != NPY_INT64) ||
+        PyArray_NDIM(a->indptr) != 1 ||
+        !PyArray_IS_C_CONTIGUOUS(a->indptr) ||
+        PyArray_DIM(a->indptr, 0) != a->n + 1 ||
+        PyArray_NDIM(a->indices) != 1 ||
+        !PyArray_IS_C_CONTIGUOUS(a->indices) ||
+        PyArray_TYPE(a->indices) != a->index_type ||
+        PyArray_NDIM(a->data) != 1 || !PyArray_IS_C_CONTIGUOUS(a->data) ||
+        (a->index_type == NPY_INT32
+         ? check_csr<npy_int32>(a->n, a->indptr, a->indices, a->data)
+         : check_csr<npy_int64>(a->n, a->indptr, a->indices, a->data))) {
+        PyErr_SetString(PyExc_ValueError, "invalid CSR matrix");
+        return -1;
+    }
+    return 0;
+}
+
+template <class I, class T>
+static void run_simple(const csr_args *a, PyArrayObject *B, PyArrayObject *F,
+                       double t, T eta, int m_star, int s, double tol,
+                       int workers)
+{
+    const int n0 = (int)PyArray_DIM(B, 1);
+    csr_t<I, T> A;
+
+    init_csr(&A, a->n, n0, a->indptr, a->indices, a->data, workers);
+    simple(A, n0, (const T *)PyArray_DATA(B), (T *)PyArray_DATA(F), t, eta,
+           m_star, s, tol, workers);
+}
+
+template <class I, class T>
+static void run_interval(const csr_args *a, PyArrayObject *X, double h,
+                         PyArrayObject *eta, int m_star, int d, int j,
+                         int r, double tol, int workers)
+{
+    const int n0 = (int)PyArray_DIM(X, 2);
+    csr_t<I, T> A;
+
+    init_csr(&A, a->n, n0, a->indptr, a->indices, a->data, workers);
+    interval(A, n0, (T *)PyArray_DATA(X), h, (const T *)PyArray_DATA(eta),
+             m_star, d, j, r, tol, workers);
+}
+
+static char simple_doc[] =
+"simple(indptr, indices, data, B, F, t, eta, m_star, s, tol, workers)\n\
+\n\
+Computes F = e^(tA) B as _expm_multiply_simple_core, for A given by the\n\
+CSR arrays (shifted by mu) and eta = exp(t*mu/s), on up to workers\n\
+threads. B and F are n by n0 arrays in C order, float64 or complex128\n\
+as data.";
+
+static PyObject *Py_simple(PyObject *self, PyObject *args)
+{
+    csr_args a;
+    PyArrayObject *B, *F;
+    double t, tol;
+    Py_complex eta;
+    int m_star, s, workers, no_memory = 0;
+    PyThreadState *save;
+
+    if (!PyArg_ParseTuple(args, "O!O!O!O!O!dDiidi", &PyArray_Type,
+                          &a.indptr, &PyArray_Type, &a.indices,
+                          &PyArray_Type, &a.data, &PyArray_Type, &B,
+                          &PyArray_Type, &F, &t, &eta, &m_star, &s, &tol,
+                          &workers)) {
+        return NULL;
+    }
+    if (check_args(&a, F, 2)) {
+        return NULL;
+    }
+    if (PyArray_NDIM(B) != 2 || PyArray_TYPE(B) != a.typenum ||
+        !PyArray_IS_C_CONTIGUOUS(B) || PyArray_DIM(B, 0) != a.n ||
+        PyArray_DIM(B, 1) != PyArray_DIM(F, 1)) {
+        PyErr_SetString(PyExc_ValueError, "B and F must be alike");
+        return NULL;
+    }
+    if (m_star < 0 || s < 1) {
+        PyErr_SetString(PyExc_ValueError, "invalid m_star or s");
+        return NULL;
+    }
+    workers = workers > 1 ? workers : 1;
+
+    save = PyEval_SaveThread();
+    try {
+        if (a.typenum == NPY_DOUBLE) {
+            if (a.index_type == NPY_INT32) {
+                run_simple<npy_int32, double>(&a, B, F, t, eta.real, m_star,
+                                              s, tol, workers);
+            }
+            else {
+                run_simple<npy_int64, double>(&a, B, F, t, eta.real, m_star,
+                                              s, tol, workers);
+            }
+        }
+        else {
+            std::complex<double> eta_c(eta.real, eta.imag);
+            if (a.index_type == NPY_INT32) {
+                run_simple<npy_int32, std::complex<double> >(
+                    &a, B, F, t, eta_c, m_star, s, tol, workers);
+            }
+            else {
+                run_simple<npy_int64, std::complex<double> >(
+                    &a, B, F, t, eta_c, m_star, s, tol, workers);
+            }
+        }
+    }
+    catch (const std::bad_alloc &) {
+        no_memory = 1;
+    }
+    PyEval_RestoreThread(save);
+
+    if (no_memory) {
+        return PyErr_NoMemory();
+    }
+    Py_RETURN_NONE;
+}
+
+static char interval_doc[] =
+"interval(indptr, indices, data, X, h, eta, m_star, d, j, r, tol, workers)\n\
+\n\
+Fills X[1:] from X[0] as _expm_multiply_interval_core_1 and _2, for A\n\
+given by the CSR arrays (shifted by mu), in j intervals of d time\n\
+points and a last one of r, with eta[k] = exp(k*h*mu) for k = 0, ..., d,\n\
+on up to workers threads. X is nsamples by n by n0 in C order.";
+
+static PyObject *Py_interval(PyObject *self, PyObject *args)
+{
+    csr_args a;
+    PyArrayObject *X, *eta;
+    double h, tol;
+    int m_star, d, j, r, workers, no_memory = 0;
+    PyThreadState *save;
+
+    if (!PyArg_ParseTuple(args, "O!O!O!O!dO!iiiidi", &PyArray_Type,
+                          &a.indptr, &PyArray_Type, &a.indices,
+                          &PyArray_Type, &a.data, &PyArray_Type, &X, &h,
+                          &PyArray_Type, &eta, &m_star, &d, &j, &r, &tol,
+                          &workers)) {
+        return NULL;
+    }
+    if (check_args(&a, X, 3)) {
+        return NULL;
+    }
+    if (m_star < 0 || d < 1 || j < 0 || r < 0 || r > d ||
+        (npy_intp)j * d + r >= PyArray_DIM(X, 0)) {
+        PyErr_SetString(PyExc_ValueError, "invalid interval parameters");
+        return NULL;
+    }
+    if (PyArray_NDIM(eta) != 1 || PyArray_TYPE(eta) != a.typenum ||
+        !PyArray_IS_C_CONTIGUOUS(eta) || PyArray_DIM(eta, 0) < d + 1) {
+        PyErr_SetString(PyExc_ValueError,
+                        "eta must be a vector of d + 1 entries");
+        return NULL;
+    }
+    workers = workers > 1 ? workers : 1;
+
+    save = PyEval_SaveThread();
+    try {
+        if (a.typenum == NPY_DOUBLE) {
+            if (a.index_type == NPY_INT32) {
+                run_interval<npy_int32, double>(&a, X, h, eta, m_star, d, j,
+                                                r, tol, workers);
+            }
+            else {
+                run_interval<npy_int64, double>(&a, X, h, eta, m_star, d, j,
+                                                r, tol, workers);
+            }
+        }
+        else {
+            if (a.index_type == NPY_INT32) {
+                run_interval<npy_int32, std::complex<double> >(
+                    &a, X, h, eta, m_star, d, j, r, tol, workers);
+            }
+            else {
+                run_interval<npy_int64, std::complex<double> >(
+                    &a, X, h, eta, m_star, d, j, r, tol, workers);
+            }
+        }
+    }
+    catch (const std::bad_alloc &) {
+        no_memory = 1;
+    }
+    PyEval_RestoreThread(save);
+
+    if (no_memory) {
+        return PyErr_NoMemory();
+    }
+    Py_RETURN_NONE;
+}
+
+
+/*
+ * Main _expm_multiply_core module
+ */
+
+static PyMethodDef core_methods[] = {
+    {"simple", (PyCFunction) Py_simple, METH_VARARGS, simple_doc},
+    {"interval", (PyCFunction) Py_interval, METH_VARARGS, interval_doc},
+    {NULL, NULL}
+};
+
+#if PY_VERSION_HEX >= 0x03000000
+
+static struct PyModuleDef moduledef = {
+    PyModuleDef_HEAD_INIT,
+    "_expm_multiply_core",
+    NULL,
+    -1,
+    core_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+PyMODINIT_FUNC PyInit__expm_multiply_core(void)
+{
+    import_array();
+
+    return PyModule_Create(&moduledef);
+}
+
+#else
+
+PyMODINIT_FUNC init_expm_multiply_core(void)
+{
+    import_array();
+
+    Py_InitModule("_expm_multiply_core", core_methods);
+}
+
+#endif
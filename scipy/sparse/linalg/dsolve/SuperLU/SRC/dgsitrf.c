@@ -206,6 +206,7 @@ dgsitrf(superlu_options_t *options, SuperMatrix *A, int relax, int panel_size,
     int       *panel_lsub; /* dense[]/panel_lsub[] pair forms a w-wide SPA */
     int       *marker, *marker_relax;
     double    *dense, *tempv;
+    double    *mt_work = NULL; /* scratch of the threaded panel updates */
     int       *relax_end, *relax_fsupc;
     double    *a;
     int       *asub;
@@ -237,6 +238,7 @@ dgsitrf(superlu_options_t *options, SuperMatrix *A, int relax, int panel_size,
     int       m, n, min_mn, jsupno, fsupc, nextlu, nextu;
     int       w_def;	/* upper bound on panel width */
     int       usepr, iperm_r_allocated = 0;
+    int       nthreads;
     int       nnzL, nnzU;
     int       *panel_histo = stat->panel_histo;
     flops_t   *ops = stat->ops;
@@ -309,6 +311,10 @@ dgsitrf(superlu_options_t *options, SuperMatrix *A, int relax, int panel_size,
     else
 	ilu_relax_snode(n, etree, relax, marker, relax_end, relax_fsupc);
 
+    /* Threaded panel updates (scipy) */
+    nthreads = SUPERLU_MIN(options->nthreads, panel_size);
+    if ( nthreads > 1 ) mt_work = doubleCalloc(nthreads * m);
+
     ifill (perm_r, m, EMPTY);
     ifill (marker, m * NO_MARKER, EMPTY);
     supno[0] = -1;
@@ -450,8 +456,12 @@ dgsitrf(superlu_options_t *options, SuperMatrix *A, int relax, int panel_size,
                           marker, parent, xplore, Glu);
 
 	    /* numeric sup-panel updates in topological order */
-	    dpanel_bmod(m, panel_size, jcol, nseg1, dense,
-			tempv, segrep, repfnz, Glu, stat);
+	    if ( mt_work )
+		dpanel_bmod_mt(nthreads, m, panel_size, jcol, nseg1, dense,
+			       tempv, mt_work, segrep, repfnz, Glu, stat);
+	    else
+		dpanel_bmod(m, panel_size, jcol, nseg1, dense,
+			    tempv, segrep, repfnz, Glu, stat);
 
 	    /* Sparse LU within the panel, and below panel diagonal */
 	    for (jj = jcol; jj < jcol + panel_size; jj++) {
@@ -654,6 +664,7 @@ dgsitrf(superlu_options_t *options, SuperMatrix *A, int relax, int panel_size,
     if ( iperm_r_allocated ) SUPERLU_FREE (iperm_r);
     SUPERLU_FREE (iperm_c);
     SUPERLU_FREE (relax_end);
+    if ( mt_work ) SUPERLU_FREE (mt_work);
     SUPERLU_FREE (swap);
     SUPERLU_FREE (iswap);
     SUPERLU_FREE (relax_fsupc);
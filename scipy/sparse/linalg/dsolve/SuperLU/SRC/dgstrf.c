@@ -215,6 +215,7 @@ dgstrf (superlu_options_t *options, SuperMatrix *A,
     int	      *xprune;
     int	      *marker;
     double    *dense, *tempv;
+    double    *mt_work = NULL; /* scratch of the threaded panel updates */
     int       *relax_end;
     double    *a;
     int       *asub;
@@ -237,6 +238,7 @@ dgstrf (superlu_options_t *options, SuperMatrix *A,
     int       m, n, min_mn, jsupno, fsupc, nextlu, nextu;
     int       w_def;	/* upper bound on panel width */
     int       usepr, iperm_r_allocated = 0;
+    int       nthreads;
     int       nnzL, nnzU;
     int       *panel_histo = stat->panel_histo;
     flops_t   *ops = stat->ops;
@@ -284,6 +286,10 @@ dgstrf (superlu_options_t *options, SuperMatrix *A,
         relax_snode(n, etree, relax, marker, relax_end); 
     }
     
+    /* Threaded panel updates (scipy) */
+    nthreads = SUPERLU_MIN(options->nthreads, panel_size);
+    if ( nthreads > 1 ) mt_work = doubleCalloc(nthreads * m);
+
     ifill (perm_r, m, EMPTY);
     ifill (marker, m * NO_MARKER, EMPTY);
     supno[0] = -1;
@@ -362,8 +368,12 @@ dgstrf (superlu_options_t *options, SuperMatrix *A,
 		      marker, parent, xplore, Glu);
 	    
 	    /* numeric sup-panel updates in topological order */
-	    dpanel_bmod(m, panel_size, jcol, nseg1, dense,
-		        tempv, segrep, repfnz, Glu, stat);
+	    if ( mt_work )
+		dpanel_bmod_mt(nthreads, m, panel_size, jcol, nseg1, dense,
+			       tempv, mt_work, segrep, repfnz, Glu, stat);
+	    else
+		dpanel_bmod(m, panel_size, jcol, nseg1, dense,
+			    tempv, segrep, repfnz, Glu, stat);
 	    
 	    /* Sparse LU within the panel, and below panel diagonal */
     	    for ( jj = jcol; jj < jcol + panel_size; jj++) {
@@ -455,5 +465,6 @@ dgstrf (superlu_options_t *options, SuperMatrix *A,
     if ( iperm_r_allocated ) SUPERLU_FREE (iperm_r);
     SUPERLU_FREE (iperm_c);
     SUPERLU_FREE (relax_end);
+    if ( mt_work ) SUPERLU_FREE (mt_work);
 
 }
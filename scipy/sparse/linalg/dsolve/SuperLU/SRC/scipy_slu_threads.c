@@ -0,0 +1,167 @@
+/*
+ * Worker pool for the parallel panel updates (scipy addition).
+ *
+ * The pool is started lazily and grows up to the largest number of threads
+ * asked for. It runs one job at a time; a job is a number of parts that
+ * the pool threads and the calling thread claim one by one, so a job
+ * completes even if no pool thread ever wakes up (or none could be
+ * started, or the process forked).
+ */
+
+#include "scipy_slu_threads.h"
+
+#if defined(_WIN32)
+
+#include <windows.h>
+#include <process.h>
+
+typedef SRWLOCK slu_mutex_t;
+typedef CONDITION_VARIABLE slu_cond_t;
+#define SLU_MUTEX_INIT SRWLOCK_INIT
+#define SLU_COND_INIT CONDITION_VARIABLE_INIT
+#define slu_mutex_lock(m) AcquireSRWLockExclusive(m)
+#define slu_mutex_unlock(m) ReleaseSRWLockExclusive(m)
+#define slu_cond_wait(c, m) SleepConditionVariableSRW(c, m, INFINITE, 0)
+#define slu_cond_signal(c) WakeConditionVariable(c)
+#define slu_cond_broadcast(c) WakeAllConditionVariable(c)
+
+#else
+
+#include <pthread.h>
+
+typedef pthread_mutex_t slu_mutex_t;
+typedef pthread_cond_t slu_cond_t;
+#define SLU_MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
+#define SLU_COND_INIT PTHREAD_COND_INITIALIZER
+#define slu_mutex_lock(m) pthread_mutex_lock(m)
+#define slu_mutex_unlock(m) pthread_mutex_unlock(m)
+#define slu_cond_wait(c, m) pthread_cond_wait(c, m)
+#define slu_cond_signal(c) pthread_cond_signal(c)
+#define slu_cond_broadcast(c) pthread_cond_broadcast(c)
+
+#endif
+
+static slu_mutex_t pool_lock = SLU_MUTEX_INIT;
+static slu_cond_t pool_work = SLU_COND_INIT;  /* a part can be claimed */
+static slu_cond_t pool_done = SLU_COND_INIT;  /* the last part finished */
+
+/* All of the following are protected by pool_lock */
+static int pool_size = 0;    /* pool threads started */
+static int pool_busy = 0;    /* a job is running */
+static scipy_slu_part_fn *job_fn;
+static void *job_arg;
+static int job_nparts = 0;
+static int job_next = 0;     /* next unclaimed part */
+static int job_done = 0;     /* parts finished */
+
+static void pool_worker(void)
+{
+    scipy_slu_part_fn *fn;
+    void *arg;
+    int part;
+
+    slu_mutex_lock(&pool_lock);
+    for (;;) {
+        while (job_next >= job_nparts) {
+            slu_cond_wait(&pool_work, &pool_lock);
+        }
+        part = job_next++;
+        fn = job_fn;
+        arg = job_arg;
+        slu_mutex_unlock(&pool_lock);
+
+        fn(arg, part);
+
+        slu_mutex_lock(&pool_lock);
+        if (++job_done == job_nparts) {
+            slu_cond_signal(&pool_done);
+        }
+    }
+}
+
+#if defined(_WIN32)
+
+static unsigned __stdcall pool_main(void *unused)
+{
+    pool_worker();
+    return 0;
+}
+
+static int pool_start(void)
+{
+    HANDLE h = (HANDLE)_beginthreadex(NULL, 0, pool_main, NULL, 0, NULL);
+
+    if (h == 0) {
+        return -1;
+    }
+    CloseHandle(h);
+    return 0;
+}
+
+#else
+
+static void *pool_main(void *unused)
+{
+    pool_worker();
+    return NULL;
+}
+
+static int pool_start(void)
+{
+    pthread_t thread;
+    pthread_attr_t attr;
+    int err;
+
+    if (pthread_attr_init(&attr) != 0) {
+        return -1;
+    }
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    err = pthread_create(&thread, &attr, pool_main, NULL);
+    pthread_attr_destroy(&attr);
+    return err == 0 ? 0 : -1;
+}
+
+#endif
+
+void scipy_slu_run_parts(scipy_slu_part_fn *fn, void *arg, int nparts)
+{
+    int part;
+
+    slu_mutex_lock(&pool_lock);
+    if (pool_busy || nparts <= 1) {
+        slu_mutex_unlock(&pool_lock);
+        for (part = 0; part < nparts; part++) {
+            fn(arg, part);
+        }
+        return;
+    }
+    pool_busy = 1;
+
+    while (pool_size < nparts - 1 && pool_size < SCIPY_SLU_MAX_THREADS - 1
+           && pool_start() == 0) {
+        pool_size++;
+    }
+
+    job_fn = fn;
+    job_arg = arg;
+    job_nparts = nparts;
+    job_next = 0;
+    job_done = 0;
+    slu_cond_broadcast(&pool_work);
+
+    while (job_next < nparts) {
+        part = job_next++;
+        slu_mutex_unlock(&pool_lock);
+        fn(arg, part);
+        slu_mutex_lock(&pool_lock);
+        ++job_done;
+    }
+    while (job_done < nparts) {
+        slu_cond_wait(&pool_done, &pool_lock);
+    }
+
+    job_nparts = 0;
+    job_next = 0;
+    pool_busy = 0;
+    slu_mutex_unlock(&pool_lock);
+}
@@ -0,0 +1,26 @@
+#ifndef SCIPY_SLU_THREADS_H
+#define SCIPY_SLU_THREADS_H
+
+/*
+ * A small pool of worker threads for the parallel panel updates in
+ * [sdcz]panel_bmod_mt (scipy addition, not part of SuperLU).
+ */
+
+/* The pool has at most SCIPY_SLU_MAX_THREADS - 1 threads */
+#define SCIPY_SLU_MAX_THREADS 64
+
+/* Panel updates are shared out in parts of at least this many flops */
+#define SCIPY_SLU_MIN_PART_WORK 50000
+
+typedef void scipy_slu_part_fn(void *arg, int part);
+
+/*
+ * Calls fn(arg, part) for part = 0, ..., nparts-1 and returns when all
+ * calls have finished. The calling thread takes part in the work, and the
+ * parts run one after another on it if no pool thread can be had, e.g.
+ * while another factorization holds the pool. fn must not allocate
+ * through SUPERLU_MALLOC or ABORT.
+ */
+void scipy_slu_run_parts(scipy_slu_part_fn *fn, void *arg, int nparts);
+
+#endif
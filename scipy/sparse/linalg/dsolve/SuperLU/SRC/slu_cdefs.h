@@ -167,6 +167,10 @@ extern void    cpanel_dfs (const int, const int, const int, SuperMatrix *,
 extern void    cpanel_bmod (const int, const int, const int, const int,
                            complex *, complex *, int *, int *,
 			   GlobalLU_t *, SuperLUStat_t*);
+extern void    cpanel_bmod_mt (const int, const int, const int, const int,
+                           const int, complex *, complex *, complex *,
+                           int *, int *,
+                           GlobalLU_t *, SuperLUStat_t*);
 extern int     ccolumn_dfs (const int, const int, int *, int *, int *, int *,
 			   int *, int *, int *, int *, int *, GlobalLU_t *);
 extern int     ccolumn_bmod (const int, const int, complex *,
@@ -166,6 +166,10 @@ extern void    dpanel_dfs (const int, const int, const int, SuperMatrix *,
 extern void    dpanel_bmod (const int, const int, const int, const int,
                            double *, double *, int *, int *,
 			   GlobalLU_t *, SuperLUStat_t*);
+extern void    dpanel_bmod_mt (const int, const int, const int, const int,
+                           const int, double *, double *, double *,
+                           int *, int *,
+                           GlobalLU_t *, SuperLUStat_t*);
 extern int     dcolumn_dfs (const int, const int, int *, int *, int *, int *,
 			   int *, int *, int *, int *, int *, GlobalLU_t *);
 extern int     dcolumn_bmod (const int, const int, double *,
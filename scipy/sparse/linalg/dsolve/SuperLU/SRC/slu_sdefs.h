@@ -166,6 +166,10 @@ extern void    spanel_dfs (const int, const int, const int, SuperMatrix *,
 extern void    spanel_bmod (const int, const int, const int, const int,
                            float *, float *, int *, int *,
 			   GlobalLU_t *, SuperLUStat_t*);
+extern void    spanel_bmod_mt (const int, const int, const int, const int,
+                           const int, float *, float *, float *,
+                           int *, int *,
+                           GlobalLU_t *, SuperLUStat_t*);
 extern int     scolumn_dfs (const int, const int, int *, int *, int *, int *,
 			   int *, int *, int *, int *, int *, GlobalLU_t *);
 extern int     scolumn_bmod (const int, const int, float *,
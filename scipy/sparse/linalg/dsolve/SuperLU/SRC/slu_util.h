@@ -305,6 +305,8 @@ typedef struct {
     yes_no_t      lookahead_etree; /* use etree computed from the
 				      serial symbolic factorization */
     yes_no_t      SymPattern;      /* symmetric factorization          */
+    int           nthreads;        /* threads for the panel updates in
+				      [sdcz]gstrf and [sdcz]gsitrf (scipy) */
 } superlu_options_t;
 
 /*! \brief Headers for 4 types of dynamatically managed memory */
@@ -167,6 +167,10 @@ extern void    zpanel_dfs (const int, const int, const int, SuperMatrix *,
 extern void    zpanel_bmod (const int, const int, const int, const int,
                            doublecomplex *, doublecomplex *, int *, int *,
 			   GlobalLU_t *, SuperLUStat_t*);
+extern void    zpanel_bmod_mt (const int, const int, const int, const int,
+                           const int, doublecomplex *, doublecomplex *, doublecomplex *,
+                           int *, int *,
+                           GlobalLU_t *, SuperLUStat_t*);
 extern int     zcolumn_dfs (const int, const int, int *, int *, int *, int *,
 			   int *, int *, int *, int *, int *, GlobalLU_t *);
 extern int     zcolumn_bmod (const int, const int, doublecomplex *,
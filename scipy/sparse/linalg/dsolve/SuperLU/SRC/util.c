@@ -57,6 +57,7 @@ void set_default_options(superlu_options_t *options)
     options->PivotGrowth = NO;
     options->ConditionNumber = NO;
     options->PrintStat = YES;
+    options->nthreads = 1;
 }
 
 /*! \brief Set the default values for the options argument for ILU.
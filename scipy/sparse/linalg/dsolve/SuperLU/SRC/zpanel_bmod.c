@@ -37,6 +37,7 @@ at the top-level directory.
 #include <stdio.h>
 #include <stdlib.h>
 #include "slu_zdefs.h"
+#include "scipy_slu_threads.h"
 
 /* 
  * Function prototypes 
@@ -61,21 +62,25 @@ extern void zcheck_tempv();
  *    Updated/Output parameters-
  *    dense[0:m-1,w]: L[*,j:j+w-1] and U[*,j:j+w-1] are returned 
  *    collectively in the m-by-w vector dense[*]. 
+ *
+ *    (scipy) The 1-D updates work in tempv1d[], which may be tempv[].
+ *    Returns 0, or -1 if the matrix cannot be factorized.
  * </pre>
  */
 
-void
-zpanel_bmod (
+static int
+zpanel_bmod_cols (
 	    const int  m,          /* in - number of rows in the matrix */
 	    const int  w,          /* in */
 	    const int  jcol,       /* in */
 	    const int  nseg,       /* in */
 	    doublecomplex     *dense,     /* out, of size n by w */
 	    doublecomplex     *tempv,     /* working array */
+	    doublecomplex *tempv1d,   /* working array of the 1-D updates */
 	    int        *segrep,    /* in */
 	    int        *repfnz,    /* in, of size n by w */
 	    GlobalLU_t *Glu,       /* modified */
-	    SuperLUStat_t *stat    /* output */
+	    flops_t    *ops        /* output */
 	    )
 {
 
@@ -115,7 +120,6 @@ zpanel_bmod (
     register int ldaTmp;
     register int r_ind, r_hi;
     int  maxsuper, rowblk, colblk;
-    flops_t  *ops = stat->ops;
     
     xsup    = Glu->xsup;
     supno   = Glu->supno;
@@ -423,7 +427,7 @@ zpanel_bmod (
 		    isub = lptr + no_zeros;
 		    for (i = 0; i < segsze; ++i) {
 			irow = lsub[isub];
-			tempv[i] = dense_col[irow]; /* Gather */
+			tempv1d[i] = dense_col[irow]; /* Gather */
 			++isub;
 		    }
 		    
@@ -433,35 +437,35 @@ zpanel_bmod (
 #ifdef USE_VENDOR_BLAS
 #ifdef _CRAY
 		    CTRSV( ftcs1, ftcs2, ftcs3, &segsze, &lusup[luptr], 
-			   &nsupr, tempv, &incx );
+			   &nsupr, tempv1d, &incx );
 #else
 #if SCIPY_FIX
 		    if (nsupr < segsze) {
 			/* Fail early rather than passing in invalid parameters to TRSV. */
-			ABORT("failed to factorize matrix");
+			return -1;
 		    }
 #endif
 		    ztrsv_( "L", "N", "U", &segsze, &lusup[luptr], 
-			   &nsupr, tempv, &incx );
+			   &nsupr, tempv1d, &incx );
 #endif
 		    
 		    luptr += segsze;	/* Dense matrix-vector */
-		    tempv1 = &tempv[segsze];
+		    tempv1 = &tempv1d[segsze];
                     alpha = one;
                     beta = zero;
 #ifdef _CRAY
 		    CGEMV( ftcs2, &nrow, &segsze, &alpha, &lusup[luptr], 
-			   &nsupr, tempv, &incx, &beta, tempv1, &incy );
+			   &nsupr, tempv1d, &incx, &beta, tempv1, &incy );
 #else
 		    zgemv_( "N", &nrow, &segsze, &alpha, &lusup[luptr], 
-			   &nsupr, tempv, &incx, &beta, tempv1, &incy );
+			   &nsupr, tempv1d, &incx, &beta, tempv1, &incy );
 #endif
 #else
-		    zlsolve ( nsupr, segsze, &lusup[luptr], tempv );
+		    zlsolve ( nsupr, segsze, &lusup[luptr], tempv1d );
 		    
 		    luptr += segsze;        /* Dense matrix-vector */
-		    tempv1 = &tempv[segsze];
-		    zmatvec (nsupr, nrow, segsze, &lusup[luptr], tempv, tempv1);
+		    tempv1 = &tempv1d[segsze];
+		    zmatvec (nsupr, nrow, segsze, &lusup[luptr], tempv1d, tempv1);
 #endif
 		    
 		    /* Scatter tempv[*] into SPA dense[*] temporarily, such
@@ -472,8 +476,8 @@ zpanel_bmod (
 		    isub = lptr + no_zeros;
 		    for (i = 0; i < segsze; i++) {
 			irow = lsub[isub];
-			dense_col[irow] = tempv[i];
-			tempv[i] = zero;
+			dense_col[irow] = tempv1d[i];
+			tempv1d[i] = zero;
 			isub++;
 		    }
 		    
@@ -494,7 +498,130 @@ zpanel_bmod (
 
     } /* for each updating supernode ... */
 
+    return 0;
+}
+
+void
+zpanel_bmod (
+	    const int  m,          /* in - number of rows in the matrix */
+	    const int  w,          /* in */
+	    const int  jcol,       /* in */
+	    const int  nseg,       /* in */
+	    doublecomplex     *dense,     /* out, of size n by w */
+	    doublecomplex     *tempv,     /* working array */
+	    int        *segrep,    /* in */
+	    int        *repfnz,    /* in, of size n by w */
+	    GlobalLU_t *Glu,       /* modified */
+	    SuperLUStat_t *stat    /* output */
+	    )
+{
+    if ( zpanel_bmod_cols(m, w, jcol, nseg, dense, tempv, tempv, segrep,
+			  repfnz, Glu, stat->ops) != 0 )
+	ABORT("failed to factorize matrix");
 }
 
 
+/* Columns jcol+c0:jcol+c1-1 of the panel are part p of nparts, with
+ * c0 = w*p/nparts and c1 = w*(p+1)/nparts. */
+typedef struct {
+    int        m, w, jcol, nseg, nparts, ldaTmp;
+    doublecomplex     *dense, *tempv, *work;
+    int        *segrep, *repfnz;
+    GlobalLU_t *Glu;
+    int        info[SCIPY_SLU_MAX_THREADS];
+    flops_t    ops[SCIPY_SLU_MAX_THREADS][NPHASES];
+} zpanel_bmod_job;
 
+static void
+zpanel_bmod_part(void *arg, int part)
+{
+    zpanel_bmod_job *job = (zpanel_bmod_job *) arg;
+    int c0 = job->w * part / job->nparts;
+    int c1 = job->w * (part + 1) / job->nparts;
+    int i;
+
+    for (i = 0; i < NPHASES; ++i) job->ops[part][i] = 0;
+
+    job->info[part] = zpanel_bmod_cols(job->m, c1 - c0, job->jcol + c0,
+				       job->nseg, &job->dense[c0 * job->m],
+				       &job->tempv[c0 * job->ldaTmp],
+				       &job->work[part * job->m], job->segrep,
+				       &job->repfnz[c0 * job->m], job->Glu,
+				       job->ops[part]);
+}
+
+/*! \brief Threaded version of zpanel_bmod (scipy)
+ *
+ * <pre>
+ *    The columns of the panel are updated independently of each other,
+ *    so they are split into at most nthreads groups that are updated on
+ *    the threads of scipy_slu_run_parts(). Each group uses the slots of
+ *    tempv[] of its columns for the 2-D updates, and m entries of work[]
+ *    for the 1-D updates. work[] has nthreads*m entries, zero on entry
+ *    and on return. Panels with too little work to share are updated
+ *    by zpanel_bmod.
+ * </pre>
+ */
+
+void
+zpanel_bmod_mt (
+	    const int  nthreads,   /* in - number of threads to use */
+	    const int  m,          /* in - number of rows in the matrix */
+	    const int  w,          /* in */
+	    const int  jcol,       /* in */
+	    const int  nseg,       /* in */
+	    doublecomplex     *dense,     /* out, of size n by w */
+	    doublecomplex     *tempv,     /* working array */
+	    doublecomplex     *work,      /* working array, of size nthreads by m */
+	    int        *segrep,    /* in */
+	    int        *repfnz,    /* in, of size n by w */
+	    GlobalLU_t *Glu,       /* modified */
+	    SuperLUStat_t *stat    /* output */
+	    )
+{
+    zpanel_bmod_job job;
+    int    *xsup = Glu->xsup, *supno = Glu->supno, *xlsub = Glu->xlsub;
+    int    k, krep, fsupc, nparts, part, i;
+    double flops;
+
+    /* An upper bound on the work per column: the size of the updating
+       parts of the supernodes */
+    flops = 0;
+    for (k = 0; k < nseg; ++k) {
+	krep = segrep[k];
+	fsupc = xsup[supno[krep]];
+	flops += (double) (krep - fsupc + 1) * (xlsub[fsupc+1] - xlsub[fsupc]);
+    }
+
+    nparts = SUPERLU_MIN(nthreads, w);
+    nparts = SUPERLU_MIN(nparts, SCIPY_SLU_MAX_THREADS);
+    if ( flops * w < (double) nparts * SCIPY_SLU_MIN_PART_WORK )
+	nparts = (int) (flops * w / SCIPY_SLU_MIN_PART_WORK);
+
+    if ( nparts <= 1 ) {
+	zpanel_bmod(m, w, jcol, nseg, dense, tempv, segrep, repfnz, Glu, stat);
+	return;
+    }
+
+    job.m = m;
+    job.w = w;
+    job.jcol = jcol;
+    job.nseg = nseg;
+    job.nparts = nparts;
+    job.ldaTmp = SUPERLU_MAX( sp_ienv(3), sp_ienv(7) ) + sp_ienv(4);
+    job.dense = dense;
+    job.tempv = tempv;
+    job.work = work;
+    job.segrep = segrep;
+    job.repfnz = repfnz;
+    job.Glu = Glu;
+
+    scipy_slu_run_parts(zpanel_bmod_part, &job, nparts);
+
+    for (part = 0; part < nparts; ++part) {
+	for (i = 0; i < NPHASES; ++i) stat->ops[i] += job.ops[part][i];
+    }
+    for (part = 0; part < nparts; ++part) {
+	if ( job.info[part] != 0 ) ABORT("failed to factorize matrix");
+    }
+}
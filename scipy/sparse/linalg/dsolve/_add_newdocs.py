@@ -23,6 +23,10 @@ add_newdoc('scipy.sparse.linalg.dsolve._superlu', 'SuperLU',
     Methods
     -------
     solve
+    refactor
+    astype
+    solve_triangular
+    supernodes
 
     Notes
     -----
@@ -83,7 +87,7 @@ add_newdoc('scipy.sparse.linalg.dsolve._superlu', 'SuperLU',
 
 add_newdoc('scipy.sparse.linalg.dsolve._superlu', 'SuperLU', ('solve',
     """
-    solve(rhs[, trans])
+    solve(rhs[, trans, workers])
 
     Solves linear system of equations with one or several right-hand sides.
 
@@ -99,11 +103,181 @@ add_newdoc('scipy.sparse.linalg.dsolve._superlu', 'SuperLU', ('solve',
             'H':   A^H * x == rhs
 
         i.e., normal, transposed, and hermitian conjugate.
+    workers : int, optional
+        Number of threads to solve on, each taking a panel of the
+        right-hand sides. If negative, the value wraps around from the
+        number of CPUs. Default is 1. With fewer than 16 right-hand
+        sides, the threads instead share the rows of each triangular
+        solve that do not depend on each other (level scheduling).
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
     x : ndarray, shape ``rhs.shape``
         Solution vector(s)
+
+    Notes
+    -----
+    The triangular solves use the BLAS for the supernodes, which may be
+    threaded itself; with ``workers > 1`` it is best limited to a single
+    thread.
+
+    Level scheduling suits sparse factors, like those of `spilu`, best.
+    It solves with copies of the factors stored by rows, made on first
+    use and kept until the next `refactor`.
+    """))
+
+add_newdoc('scipy.sparse.linalg.dsolve._superlu', 'SuperLU', ('astype',
+    """
+    astype(dtype)
+
+    Copy of the factorization with the values in another precision.
+
+    Parameters
+    ----------
+    dtype : dtype
+        Floating point type of the copy. It must be real if the
+        factorization is real, and complex if it is complex.
+
+    Returns
+    -------
+    lu : SuperLU
+        The factorization in the precision `dtype`.
+
+    Notes
+    -----
+    Solving with a single precision copy of a double precision
+    factorization halves the memory traffic, which suits the
+    correction steps of iterative refinement.
+
+    .. versionadded:: 1.4.0
+
+    Examples
+    --------
+    >>> from scipy.sparse import csc_matrix
+    >>> from scipy.sparse.linalg import splu
+    >>> A = csc_matrix([[4., 1., 0.], [1., 4., 1.], [0., 1., 4.]])
+    >>> b = np.array([5., 6., 5.])
+    >>> lu = splu(A)
+    >>> lu32 = lu.astype(np.float32)
+    >>> x = lu32.solve(b.astype(np.float32)).astype(np.float64)
+    >>> x += lu32.solve((b - A.dot(x)).astype(np.float32))
+    >>> np.allclose(x, 1)
+    True
+    """))
+
+add_newdoc('scipy.sparse.linalg.dsolve._superlu', 'SuperLU', ('solve_triangular',
+    """
+    solve_triangular(rhs[, lower, trans])
+
+    Solves with one of the triangular factors, without permutations.
+
+    The factors are used in their supernodal storage, so unlike
+    ``spsolve_triangular(lu.L, rhs)`` this needs no conversion of `L`
+    and `U` to CSC format.
+
+    Parameters
+    ----------
+    rhs : ndarray, shape (n,) or (n, k)
+        Right hand side(s) of equation
+    lower : bool, optional
+        Whether to solve with `L` (default) or with `U`.
+    trans : {'N', 'T', 'H'}, optional
+        Whether to solve with the factor, its transpose or its conjugate
+        transpose.
+
+    Returns
+    -------
+    x : ndarray, shape ``rhs.shape``
+        Solution vector(s)
+
+    Notes
+    -----
+    ``lu.solve(rhs)`` is ``x[perm_c]`` with
+    ``x = lu.solve_triangular(lu.solve_triangular(rhs[perm_r_inv]),
+    lower=False)``, where ``perm_r_inv = np.argsort(lu.perm_r)``.
+
+    .. versionadded:: 1.4.0
+    """))
+
+add_newdoc('scipy.sparse.linalg.dsolve._superlu', 'SuperLU', ('supernodes',
+    """
+    supernodes()
+
+    Read-only views of the factors in the storage of SuperLU.
+
+    Columns of `L` with the same structure are grouped into supernodes.
+    The rows of each supernode are stored once, and its values as a dense
+    column-major block that holds the diagonal block of `U` above the
+    unit diagonal of `L`. The rest of `U` is stored by columns.
+
+    Returns
+    -------
+    storage : dict of ndarrays
+        ``sup_to_col``
+            First column of each supernode, and ``n`` at the end.
+        ``col_to_sup``
+            Supernode of each column.
+        ``L_rowind``, ``L_rowind_colptr``
+            Row indices of the supernodes; those of the supernode starting
+            at column ``j`` are
+            ``L_rowind[L_rowind_colptr[j]:L_rowind_colptr[j+1]]``.
+        ``L_nzval``, ``L_nzval_colptr``
+            Values of the supernodes; those of column ``j`` are
+            ``L_nzval[L_nzval_colptr[j]:L_nzval_colptr[j+1]]``, one per row
+            index of its supernode.
+        ``U_nzval``, ``U_rowind``, ``U_colptr``
+            The entries of `U` outside of the supernodes in CSC format.
+
+    Notes
+    -----
+    The arrays share the memory of the factorization, which they keep
+    alive. `refactor` raises a `BufferError` as long as any of them
+    exists.
+
+    The row indices are those of ``Pr * A``, as for `L` and `U`.
+
+    .. versionadded:: 1.4.0
+    """))
+
+add_newdoc('scipy.sparse.linalg.dsolve._superlu', 'SuperLU', ('refactor',
+    """
+    refactor(data[, fact])
+
+    Factorizes a new matrix with the same sparsity pattern.
+
+    The column permutation and the elimination tree of the original
+    factorization are reused, so only the numerical factorization is
+    repeated.
+
+    Parameters
+    ----------
+    data : ndarray, shape (nnz,)
+        Nonzero values of the new matrix, in the order of the ``data``
+        attribute of the CSC matrix that was factorized, after sorting
+        its indices and summing its duplicates.
+    fact : {'SamePattern', 'SamePattern_SameRowPerm'}, optional
+        With 'SamePattern' (default), the rows are pivoted anew. With
+        'SamePattern_SameRowPerm', the previous row permutation is kept
+        as long as the pivots stay large enough, and the storage of the
+        factors is reused. If that refactorization fails, the
+        factorization is lost.
+
+    Notes
+    -----
+
+    .. versionadded:: 1.4.0
+
+    Examples
+    --------
+    >>> from scipy.sparse import csc_matrix
+    >>> from scipy.sparse.linalg import splu
+    >>> A = csc_matrix([[4., 1., 0.], [1., 4., 1.], [0., 1., 4.]])
+    >>> lu = splu(A)
+    >>> lu.refactor(2*A.data)
+    >>> lu.solve(np.array([10., 12., 10.]))
+    array([ 1.,  1.,  1.])
     """))
 
 add_newdoc('scipy.sparse.linalg.dsolve._superlu', 'SuperLU', ('L',
@@ -111,6 +285,9 @@ add_newdoc('scipy.sparse.linalg.dsolve._superlu', 'SuperLU', ('L',
     Lower triangular factor with unit diagonal as a
     `scipy.sparse.csc_matrix`.
 
+    It is a copy, made on first access; `supernodes` gives the factors
+    without copying.
+
     .. versionadded:: 0.14.0
     """))
 
@@ -0,0 +1,29 @@
+/*
+ * C interface of the _superlu module for other extension modules.
+ *
+ * The module exports a superlu_capi_t through the capsule _superlu._C_API,
+ * so that e.g. the compiled loops of scipy.sparse.linalg.isolve and of the
+ * ARPACK wrappers can apply a factorization without calling SuperLU.solve
+ * from Python:
+ *
+ *     superlu_capi_t *api = PyCapsule_Import(SUPERLU_CAPI_NAME, 0);
+ */
+
+#ifndef __SUPERLU_CAPI
+#define __SUPERLU_CAPI
+
+#include <Python.h>
+
+#define SUPERLU_CAPI_NAME "scipy.sparse.linalg.dsolve._superlu._C_API"
+
+typedef struct {
+    /* 1 if lu is a SuperLU object holding the factors of an n-by-n matrix
+       of the NumPy type typenum, 0 if not */
+    int (*usable)(PyObject *lu, int typenum, int n);
+
+    /* Solves in place for the vector x, contiguous and of the type of the
+       factors; returns 0, or -1 with an exception set */
+    int (*solve)(PyObject *lu, void *x);
+} superlu_capi_t;
+
+#endif
@@ -0,0 +1,335 @@
+/*
+ * Level-scheduled triangular solves with the factors of a SuperLU object.
+ *
+ * A triangular matrix is stored by rows, without its diagonal. Row i
+ * belongs to level 1 + the largest level of the rows it refers to, so the
+ * rows of one level depend only on those of earlier levels and can be
+ * solved in parallel. The rows are stored in level order, which keeps the
+ * rows solved together next to each other in memory.
+ */
+
+#include <Python.h>
+
+#define NO_IMPORT_ARRAY
+#define PY_ARRAY_UNIQUE_SYMBOL _scipy_sparse_superlu_ARRAY_API
+
+#include "_superluobject.h"
+#include "SuperLU/SRC/scipy_slu_threads.h"
+
+/* Multiply-adds per thread in a level, at least */
+#define SLU_LEVEL_MIN_WORK 4096
+
+static size_t levels_elsize(int type)
+{
+    switch (type) {
+    case NPY_FLOAT:   return sizeof(float);
+    case NPY_DOUBLE:  return sizeof(double);
+    case NPY_CFLOAT:  return sizeof(complex);
+    case NPY_CDOUBLE: return sizeof(doublecomplex);
+    default:          return 0;
+    }
+}
+
+void slu_levels_free(slu_levels *lv)
+{
+    if (lv == NULL) {
+        return;
+    }
+    free(lv->level_ptr);
+    free(lv->rows);
+    free(lv->indptr);
+    free(lv->indices);
+    free(lv->data);
+    free(lv->diag);
+    free(lv);
+}
+
+/*
+ * Builds the schedule for the triangular matrix T given in CSC format,
+ * with its diagonal, or for its transpose if transpose is set; lower
+ * tells whether T is lower triangular. The diagonal is taken as one if
+ * unit is set. Returns NULL on running out of memory.
+ */
+slu_levels *slu_levels_new(int n, const int *indptr, const int *indices,
+                           const void *data, int type, int lower,
+                           int transpose, int unit)
+{
+    slu_levels *lv;
+    size_t elsize = levels_elsize(type);
+    const int *rptr, *rind;
+    const char *rdata;
+    int *tptr = NULL, *tind = NULL, *level = NULL, *count = NULL;
+    char *tdata = NULL;
+    int i, j, k, p, q, nnz = indptr[n], nlev;
+
+    lv = calloc(1, sizeof(slu_levels));
+    if (lv == NULL) {
+        return NULL;
+    }
+    lv->n = n;
+    lv->type = type;
+
+    /* Rows of the matrix solved with: those of T^T are the columns of T,
+       those of T come from a transpose of its CSC arrays */
+    if (transpose) {
+        rptr = indptr;
+        rind = indices;
+        rdata = data;
+    }
+    else {
+        tptr = calloc(n + 1, sizeof(int));
+        tind = malloc((nnz > 0 ? nnz : 1) * sizeof(int));
+        tdata = malloc((nnz > 0 ? nnz : 1) * elsize);
+        if (tptr == NULL || tind == NULL || tdata == NULL) {
+            goto fail;
+        }
+        for (k = 0; k < nnz; ++k) {
+            tptr[indices[k] + 1]++;
+        }
+        for (i = 0; i < n; ++i) {
+            tptr[i + 1] += tptr[i];
+        }
+        for (j = 0; j < n; ++j) {
+            for (k = indptr[j]; k < indptr[j + 1]; ++k) {
+                p = tptr[indices[k]]++;
+                tind[p] = j;
+                memcpy(tdata + p * elsize, (const char *)data + k * elsize,
+                       elsize);
+            }
+        }
+        for (i = n; i > 0; --i) {
+            tptr[i] = tptr[i - 1];
+        }
+        tptr[0] = 0;
+        rptr = tptr;
+        rind = tind;
+        rdata = tdata;
+    }
+    if (transpose) {
+        lower = !lower;
+    }
+
+    /* Levels, in the order the rows can be solved */
+    level = malloc((n > 0 ? n : 1) * sizeof(int));
+    if (level == NULL) {
+        goto fail;
+    }
+    nlev = 0;
+    for (q = 0; q < n; ++q) {
+        i = lower ? q : n - 1 - q;
+        level[i] = 0;
+        for (k = rptr[i]; k < rptr[i + 1]; ++k) {
+            j = rind[k];
+            if (j != i && level[j] + 1 > level[i]) {
+                level[i] = level[j] + 1;
+            }
+        }
+        if (level[i] + 1 > nlev) {
+            nlev = level[i] + 1;
+        }
+    }
+
+    lv->nlevels = nlev;
+    lv->level_ptr = calloc(nlev + 1, sizeof(int));
+    lv->rows = malloc((n > 0 ? n : 1) * sizeof(int));
+    lv->indptr = malloc((n + 1) * sizeof(int));
+    lv->indices = malloc((nnz > 0 ? nnz : 1) * sizeof(int));
+    lv->data = malloc((nnz > 0 ? nnz : 1) * elsize);
+    if (!unit) {
+        lv->diag = calloc(n > 0 ? n : 1, elsize);
+    }
+    if (lv->level_ptr == NULL || lv->rows == NULL || lv->indptr == NULL ||
+        lv->indices == NULL || lv->data == NULL ||
+        (!unit && lv->diag == NULL)) {
+        goto fail;
+    }
+
+    /* Sort the rows by level, keeping their order within a level */
+    for (i = 0; i < n; ++i) {
+        lv->level_ptr[level[i] + 1]++;
+    }
+    for (k = 0; k < nlev; ++k) {
+        lv->level_ptr[k + 1] += lv->level_ptr[k];
+    }
+    count = malloc((nlev > 0 ? nlev : 1) * sizeof(int));
+    if (count == NULL) {
+        goto fail;
+    }
+    memcpy(count, lv->level_ptr, nlev * sizeof(int));
+    for (q = 0; q < n; ++q) {
+        i = lower ? q : n - 1 - q;
+        lv->rows[count[level[i]]++] = i;
+    }
+
+    /* Pack the off-diagonal entries in that order */
+    lv->indptr[0] = 0;
+    for (p = 0; p < n; ++p) {
+        i = lv->rows[p];
+        q = lv->indptr[p];
+        for (k = rptr[i]; k < rptr[i + 1]; ++k) {
+            if (rind[k] == i) {
+                if (!unit) {
+                    memcpy(lv->diag + p * elsize, rdata + k * elsize, elsize);
+                }
+                continue;
+            }
+            lv->indices[q] = rind[k];
+            memcpy(lv->data + q * elsize, rdata + k * elsize, elsize);
+            ++q;
+        }
+        lv->indptr[p + 1] = q;
+    }
+
+    free(tptr);
+    free(tind);
+    free(tdata);
+    free(level);
+    free(count);
+    return lv;
+
+  fail:
+    free(tptr);
+    free(tind);
+    free(tdata);
+    free(level);
+    free(count);
+    slu_levels_free(lv);
+    return NULL;
+}
+
+
+/*
+ * Solves for the rows in positions p0:p1 of the schedule, in place in x.
+ */
+
+#define LEVEL_ROWS_REAL(name, T)                                        \
+    static void name(const slu_levels *lv, T *x, int conj,              \
+                     int p0, int p1)                                    \
+    {                                                                   \
+        const T *data = (const T *)lv->data;                            \
+        const T *diag = (const T *)lv->diag;                            \
+        int p, k, i;                                                    \
+        T s;                                                            \
+                                                                        \
+        for (p = p0; p < p1; ++p) {                                     \
+            i = lv->rows[p];                                            \
+            s = x[i];                                                   \
+            for (k = lv->indptr[p]; k < lv->indptr[p + 1]; ++k) {       \
+                s -= data[k] * x[lv->indices[k]];                       \
+            }                                                           \
+            x[i] = diag ? s / diag[p] : s;                              \
+        }                                                               \
+    }
+
+#define LEVEL_ROWS_COMPLEX(name, T, R)                                  \
+    static void name(const slu_levels *lv, T *x, int conj,              \
+                     int p0, int p1)                                    \
+    {                                                                   \
+        const T *data = (const T *)lv->data;                            \
+        const T *diag = (const T *)lv->diag;                            \
+        R sign = conj ? -1 : 1;                                         \
+        R sr, si, ar, ai, xr, xi, dr, di, ratio, den;                   \
+        int p, k, i;                                                    \
+                                                                        \
+        for (p = p0; p < p1; ++p) {                                     \
+            i = lv->rows[p];                                            \
+            sr = x[i].r;                                                \
+            si = x[i].i;                                                \
+            for (k = lv->indptr[p]; k < lv->indptr[p + 1]; ++k) {       \
+                ar = data[k].r;                                         \
+                ai = sign * data[k].i;                                  \
+                xr = x[lv->indices[k]].r;                               \
+                xi = x[lv->indices[k]].i;                               \
+                sr -= ar * xr - ai * xi;                                \
+                si -= ar * xi + ai * xr;                                \
+            }                                                           \
+            if (diag) {                                                 \
+                /* Smith's division */                                  \
+                dr = diag[p].r;                                         \
+                di = sign * diag[p].i;                                  \
+                if ((dr < 0 ? -dr : dr) >= (di < 0 ? -di : di)) {       \
+                    ratio = di / dr;                                    \
+                    den = dr + di * ratio;                              \
+                    xr = (sr + si * ratio) / den;                       \
+                    xi = (si - sr * ratio) / den;                       \
+                }                                                       \
+                else {                                                  \
+                    ratio = dr / di;                                    \
+                    den = di + dr * ratio;                              \
+                    xr = (sr * ratio + si) / den;                       \
+                    xi = (si * ratio - sr) / den;                       \
+                }                                                       \
+                sr = xr;                                                \
+                si = xi;                                                \
+            }                                                           \
+            x[i].r = sr;                                                \
+            x[i].i = si;                                                \
+        }                                                               \
+    }
+
+LEVEL_ROWS_REAL(levels_rows_s, float)
+LEVEL_ROWS_REAL(levels_rows_d, double)
+LEVEL_ROWS_COMPLEX(levels_rows_c, complex, float)
+LEVEL_ROWS_COMPLEX(levels_rows_z, doublecomplex, double)
+
+static void levels_rows(const slu_levels *lv, void *x, int conj,
+                        int p0, int p1)
+{
+    switch (lv->type) {
+    case NPY_FLOAT:   levels_rows_s(lv, x, conj, p0, p1); break;
+    case NPY_DOUBLE:  levels_rows_d(lv, x, conj, p0, p1); break;
+    case NPY_CFLOAT:  levels_rows_c(lv, x, conj, p0, p1); break;
+    case NPY_CDOUBLE: levels_rows_z(lv, x, conj, p0, p1); break;
+    }
+}
+
+typedef struct {
+    const slu_levels *lv;
+    void *x;
+    int conj;
+    int p0, p1, nparts;
+} levels_job;
+
+static void levels_part(void *arg, int part)
+{
+    levels_job *job = (levels_job *)arg;
+    npy_intp len = job->p1 - job->p0;
+
+    levels_rows(job->lv, job->x, job->conj,
+                job->p0 + (int)(len * part / job->nparts),
+                job->p0 + (int)(len * (part + 1) / job->nparts));
+}
+
+/*
+ * Solves in place for x, using the conjugate of the matrix if conj is
+ * set. Levels with enough work are split among nthreads threads. Does not
+ * touch Python, so it can run with the GIL released.
+ */
+void slu_levels_solve(const slu_levels *lv, void *x, int conj, int nthreads)
+{
+    levels_job job;
+    int k, work;
+
+    job.lv = lv;
+    job.x = x;
+    job.conj = conj;
+
+    for (k = 0; k < lv->nlevels; ++k) {
+        job.p0 = lv->level_ptr[k];
+        job.p1 = lv->level_ptr[k + 1];
+        work = lv->indptr[job.p1] - lv->indptr[job.p0] + (job.p1 - job.p0);
+        job.nparts = work / SLU_LEVEL_MIN_WORK;
+        if (job.nparts > nthreads) {
+            job.nparts = nthreads;
+        }
+        if (job.nparts > job.p1 - job.p0) {
+            job.nparts = job.p1 - job.p0;
+        }
+        if (job.nparts > 1) {
+            scipy_slu_run_parts(levels_part, &job, job.nparts);
+        }
+        else {
+            levels_rows(lv, x, conj, job.p0, job.p1);
+        }
+    }
+}
@@ -23,9 +23,6 @@ static SuperLUGlobalObject superlu_py_global = {0};
 static SuperLUGlobalObject *get_tls_global(void)
 {
 #ifndef WITH_THREAD
-    if (superlu_py_global.memory_dict == NULL) {
-        superlu_py_global.memory_dict = PyDict_New();
-    }
     return &superlu_py_global;
 #else
     PyObject *thread_dict;
@@ -48,8 +45,12 @@ static SuperLUGlobalObject *get_tls_global(void)
     if (obj == NULL) {
         return (SuperLUGlobalObject*)PyErr_NoMemory();
     }
-    obj->memory_dict = PyDict_New();
+    obj->memory.slots = NULL;
+    obj->memory.size = 0;
+    obj->memory.count = 0;
     obj->jmpbuf_valid = 0;
+    obj->worker = 0;
+    obj->abort_msg = NULL;
 
     PyDict_SetItemString(thread_dict, key, (PyObject *)obj);
 
@@ -57,11 +58,209 @@ static SuperLUGlobalObject *get_tls_global(void)
 #endif
 }
 
-jmp_buf *superlu_python_jmpbuf(void)
+
+/*
+ * The global object of the thread is also kept in a C thread-local
+ * variable, so that SuperLU can allocate and free memory while the GIL
+ * is released, without going back to Python.
+ */
+
+#if !defined(WITH_THREAD)
+#define SLU_TLS_GLOBAL
+#elif defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && (__GNUC_MINOR__ >= 4)))
+#define SLU_TLS_GLOBAL __thread
+#elif defined(_MSC_VER)
+#define SLU_TLS_GLOBAL __declspec(thread)
+#endif
+
+#ifdef SLU_TLS_GLOBAL
+static SLU_TLS_GLOBAL SuperLUGlobalObject *superlu_tls_global = NULL;
+#endif
+
+static SuperLUGlobalObject *get_global(void)
 {
     SuperLUGlobalObject *g;
+    NPY_ALLOW_C_API_DEF;
+
+#ifdef SLU_TLS_GLOBAL
+    g = superlu_tls_global;
+    if (g != NULL) {
+        return g;
+    }
+#endif
 
+    /* First use in this thread, or no C thread-local storage */
+    NPY_ALLOW_C_API;
     g = get_tls_global();
+    NPY_DISABLE_C_API;
+#ifdef SLU_TLS_GLOBAL
+    superlu_tls_global = g;
+#endif
+    return g;
+}
+
+
+/*
+ * Memory tracking
+ *
+ * Blocks are hashed on their address and located by linear probing.
+ * Removal shifts the following entries of the run back, so that no
+ * tombstones are needed. Pointers are only compared, never dereferenced,
+ * so freeing memory that was never allocated is safe.
+ */
+
+static size_t memory_set_hash(void *ptr, size_t mask)
+{
+    npy_uintp h = (npy_uintp)ptr >> 4;
+
+    h *= (npy_uintp)0x9E3779B97F4A7C15ULL;
+    h ^= h >> (sizeof(npy_uintp) * 4);
+    return (size_t)h & mask;
+}
+
+static int memory_set_grow(SuperLUMemorySet *set)
+{
+    size_t size = set->size ? 2 * set->size : 256;
+    size_t mask = size - 1;
+    void **slots;
+    size_t i, j;
+
+    slots = calloc(size, sizeof(void *));
+    if (slots == NULL) {
+        return -1;
+    }
+    for (i = 0; i < set->size; i++) {
+        if (set->slots[i] != NULL) {
+            j = memory_set_hash(set->slots[i], mask);
+            while (slots[j] != NULL) {
+                j = (j + 1) & mask;
+            }
+            slots[j] = set->slots[i];
+        }
+    }
+    free(set->slots);
+    set->slots = slots;
+    set->size = size;
+    return 0;
+}
+
+static int memory_set_add(SuperLUMemorySet *set, void *ptr)
+{
+    size_t mask, i;
+
+    /* Keep the load factor below 1/2 */
+    if (2 * (set->count + 1) > set->size && memory_set_grow(set)) {
+        return -1;
+    }
+    mask = set->size - 1;
+    i = memory_set_hash(ptr, mask);
+    while (set->slots[i] != NULL) {
+        i = (i + 1) & mask;
+    }
+    set->slots[i] = ptr;
+    set->count++;
+    return 0;
+}
+
+static int memory_set_remove(SuperLUMemorySet *set, void *ptr)
+{
+    size_t mask, i, j, k;
+
+    if (set->count == 0) {
+        return 0;
+    }
+    mask = set->size - 1;
+    i = memory_set_hash(ptr, mask);
+    while (set->slots[i] != ptr) {
+        if (set->slots[i] == NULL) {
+            return 0;
+        }
+        i = (i + 1) & mask;
+    }
+
+    /* Move back the entries that would not be found past the hole */
+    j = i;
+    for (;;) {
+        set->slots[i] = NULL;
+        for (;;) {
+            j = (j + 1) & mask;
+            if (set->slots[j] == NULL) {
+                set->count--;
+                return 1;
+            }
+            k = memory_set_hash(set->slots[j], mask);
+            if (i <= j ? (i < k && k <= j) : (i < k || k <= j)) {
+                continue;
+            }
+            break;
+        }
+        set->slots[i] = set->slots[j];
+        i = j;
+    }
+}
+
+static void memory_set_clear(SuperLUMemorySet *set)
+{
+    size_t i;
+
+    for (i = 0; i < set->size; i++) {
+        free(set->slots[i]);
+    }
+    free(set->slots);
+    set->slots = NULL;
+    set->size = 0;
+    set->count = 0;
+}
+
+
+/*
+ * Threads started by the module itself have no Python thread state.
+ * They use a global object that lives on their stack instead, and
+ * aborts only record the message there for the starting thread to
+ * raise.
+ */
+
+int superlu_python_thread_available(void)
+{
+#if defined(WITH_THREAD) && defined(SLU_TLS_GLOBAL)
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+int superlu_python_thread_begin(SuperLUGlobalObject *g)
+{
+#if defined(WITH_THREAD) && defined(SLU_TLS_GLOBAL)
+    g->jmpbuf_valid = 0;
+    g->memory.slots = NULL;
+    g->memory.size = 0;
+    g->memory.count = 0;
+    g->worker = 1;
+    g->abort_msg = NULL;
+    superlu_tls_global = g;
+    return 0;
+#else
+    /* Allocating would need the thread dictionary */
+    return -1;
+#endif
+}
+
+void superlu_python_thread_end(SuperLUGlobalObject *g)
+{
+    /* Frees what an abort left behind */
+    memory_set_clear(&g->memory);
+#ifdef SLU_TLS_GLOBAL
+    superlu_tls_global = NULL;
+#endif
+}
+
+
+jmp_buf *superlu_python_jmpbuf(void)
+{
+    SuperLUGlobalObject *g;
+
+    g = get_global();
     if (g == NULL) {
         abort();
     }
@@ -74,8 +273,7 @@ void superlu_python_module_abort(char *msg)
     SuperLUGlobalObject *g;
     NPY_ALLOW_C_API_DEF;
 
-    NPY_ALLOW_C_API;
-    g = get_tls_global();
+    g = get_global();
     if (g == NULL) {
         /* We have to longjmp (or SEGV results), but the
            destination is not known --- no choice but abort.
@@ -83,14 +281,20 @@ void superlu_python_module_abort(char *msg)
         */
         abort();
     }
-    PyErr_SetString(PyExc_RuntimeError, msg);
+    if (g->worker) {
+        g->abort_msg = msg;
+    }
+    else {
+        NPY_ALLOW_C_API;
+        PyErr_SetString(PyExc_RuntimeError, msg);
+        NPY_DISABLE_C_API;
+    }
 
     if (!g->jmpbuf_valid) {
         abort();
     }
 
     g->jmpbuf_valid = 0;
-    NPY_DISABLE_C_API;
 
     longjmp(g->jmpbuf, -1);
 }
@@ -98,84 +302,56 @@ void superlu_python_module_abort(char *msg)
 void *superlu_python_module_malloc(size_t size)
 {
     SuperLUGlobalObject *g;
-    PyObject *key = NULL;
     void *mem_ptr;
-    NPY_ALLOW_C_API_DEF;
 
-    NPY_ALLOW_C_API;
-    g = get_tls_global();
+    g = get_global();
     if (g == NULL) {
         return NULL;
     }
     mem_ptr = malloc(size);
     if (mem_ptr == NULL) {
-        NPY_DISABLE_C_API;
 	return NULL;
     }
-    key = PyLong_FromVoidPtr(mem_ptr);
-    if (key == NULL)
-	goto fail;
-    if (PyDict_SetItem(g->memory_dict, key, Py_None))
-	goto fail;
-    Py_DECREF(key);
-    NPY_DISABLE_C_API;
+    if (memory_set_add(&g->memory, mem_ptr)) {
+        free(mem_ptr);
+        superlu_python_module_abort
+            ("superlu_malloc: Cannot track allocated memory in malloc.");
+        return NULL;
+    }
 
     return mem_ptr;
-
-  fail:
-    Py_XDECREF(key);
-    NPY_DISABLE_C_API;
-    free(mem_ptr);
-    superlu_python_module_abort
-	("superlu_malloc: Cannot set dictionary key value in malloc.");
-    return NULL;
-
 }
 
 void superlu_python_module_free(void *ptr)
 {
     SuperLUGlobalObject *g;
-    PyObject *key;
-    PyObject *ptype, *pvalue, *ptraceback;
-    NPY_ALLOW_C_API_DEF;
 
     if (ptr == NULL)
 	return;
 
-    NPY_ALLOW_C_API;
-    g = get_tls_global();
+    g = get_global();
     if (g == NULL) {
         abort();
     }
-    PyErr_Fetch(&ptype, &pvalue, &ptraceback);
-    key = PyLong_FromVoidPtr(ptr);
-    /* This will only free the pointer if it could find it in the dictionary
+    /* This will only free the pointer if it could find it in the set
      * of already allocated pointers --- thus after abort, the module can free all
      * the memory that "might" have been allocated to avoid memory leaks on abort
      * calls.
      */
-    if (!PyDict_DelItem(g->memory_dict, key)) {
+    if (memory_set_remove(&g->memory, ptr)) {
 	free(ptr);
     }
-    Py_DECREF(key);
-    PyErr_Restore(ptype, pvalue, ptraceback);
-    NPY_DISABLE_C_API;
-    return;
 }
 
 
 static void SuperLUGlobal_dealloc(SuperLUGlobalObject *self)
 {
-    PyObject *key, *value;
-    Py_ssize_t pos = 0;
-
-    while (PyDict_Next(self->memory_dict, &pos, &key, &value)) {
-        void *ptr;
-        ptr = PyLong_AsVoidPtr(value);
-        free(ptr);
+#ifdef SLU_TLS_GLOBAL
+    if (superlu_tls_global == self) {
+        superlu_tls_global = NULL;
     }
-
-    Py_XDECREF(self->memory_dict);
+#endif
+    memory_set_clear(&self->memory);
     PyObject_Del(self);
 }
 
@@ -252,6 +252,17 @@ static PyObject *Py_gstrf(PyObject * self, PyObject * args,
 	goto fail;
     }
 
+    /* the sparsity pattern is needed for refactoring */
+    ((SuperLUObject *)result)->rowind =
+        (PyArrayObject *)PyArray_NewCopy(rowind, NPY_CORDER);
+    ((SuperLUObject *)result)->colptr =
+        (PyArrayObject *)PyArray_NewCopy(colptr, NPY_CORDER);
+    if (((SuperLUObject *)result)->rowind == NULL ||
+        ((SuperLUObject *)result)->colptr == NULL) {
+        Py_DECREF(result);
+        goto fail;
+    }
+
     /* arrays of input matrix will not be freed */
     Destroy_SuperMatrix_Store(&A);
     return result;
@@ -322,7 +333,7 @@ static struct PyModuleDef moduledef = {
 
 PyObject *PyInit__superlu(void)
 {
-    PyObject *m, *d;
+    PyObject *m, *d, *capi;
 
     import_array();
 
@@ -341,6 +352,12 @@ PyObject *PyInit__superlu(void)
     PyDict_SetItemString(d, "SuperLU",
 			 (PyObject *) &SuperLUType);
 
+    capi = PyCapsule_New(&superlu_capi, SUPERLU_CAPI_NAME, NULL);
+    if (capi != NULL) {
+        PyDict_SetItemString(d, "_C_API", capi);
+        Py_DECREF(capi);
+    }
+
     if (PyErr_Occurred())
 	Py_FatalError("can't initialize module _superlu");
 
@@ -351,7 +368,7 @@ PyObject *PyInit__superlu(void)
 
 PyMODINIT_FUNC init_superlu(void)
 {
-    PyObject *m, *d;
+    PyObject *m, *d, *capi;
 
     import_array();
 
@@ -371,6 +388,12 @@ PyMODINIT_FUNC init_superlu(void)
     Py_INCREF(&PyArrayFlags_Type);
     PyDict_SetItemString(d, "SuperLU",
 			 (PyObject *) & SuperLUType);
+
+    capi = PyCapsule_New(&superlu_capi, SUPERLU_CAPI_NAME, NULL);
+    if (capi != NULL) {
+        PyDict_SetItemString(d, "_C_API", capi);
+        Py_DECREF(capi);
+    }
 }
 
 #endif
@@ -13,6 +13,338 @@
 #include "_superluobject.h"
 #include "numpy/npy_3kcompat.h"
 #include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+
+#include <windows.h>
+#include <process.h>
+
+typedef HANDLE slu_thread_handle;
+#define SLU_THREAD_RETURN unsigned __stdcall
+
+#else
+
+#include <pthread.h>
+#include <unistd.h>
+
+typedef pthread_t slu_thread_handle;
+#define SLU_THREAD_RETURN void *
+
+#endif
+
+
+static int fact_cvt(PyObject * input, fact_t * value);
+static int LU_to_csc(SuperMatrix *L, SuperMatrix *U,
+                     int *U_indices, int *U_indptr, char *U_data,
+                     int *L_indices, int *L_indptr, char *L_data,
+                     Dtype_t dtype);
+
+
+/***********************************************************************
+ * Solving on several threads
+ *
+ * The right-hand sides are split into panels of columns and each panel
+ * is solved by gstrs on its own thread; the factors are only read.
+ */
+
+/* Right-hand sides per thread, at least */
+#define SLU_SOLVE_MIN_PANEL 8
+
+typedef struct {
+    SuperLUObject *lu;
+    trans_t trans;
+    char *data;
+    int ncol;
+    int info;
+    int aborted;
+    char *abort_msg;
+    slu_thread_handle handle;
+    int started;
+} solve_task;
+
+static void solve_task_run(solve_task *task)
+{
+    volatile SuperMatrix B = { 0 };
+    volatile SuperLUStat_t stat = { 0 };
+    volatile jmp_buf *jmpbuf_ptr;
+    SuperLUObject *lu = task->lu;
+
+    jmpbuf_ptr = (volatile jmp_buf *)superlu_python_jmpbuf();
+    if (setjmp(*(jmp_buf*)jmpbuf_ptr)) {
+        task->aborted = 1;
+    }
+    else {
+        Create_Dense_Matrix(lu->type, (SuperMatrix*)&B, lu->n, task->ncol,
+                            task->data, lu->n, SLU_DN,
+                            NPY_TYPECODE_TO_SLU(lu->type), SLU_GE);
+        StatInit((SuperLUStat_t *)&stat);
+        gstrs(lu->type, task->trans, &lu->L, &lu->U, lu->perm_c, lu->perm_r,
+              (SuperMatrix *)&B, (SuperLUStat_t *)&stat, &task->info);
+    }
+    XDestroy_SuperMatrix_Store((SuperMatrix *)&B);
+    XStatFree((SuperLUStat_t *)&stat);
+}
+
+static SLU_THREAD_RETURN solve_task_main(void *arg)
+{
+    solve_task *task = (solve_task *)arg;
+    SuperLUGlobalObject g;
+
+    superlu_python_thread_begin(&g);
+    solve_task_run(task);
+    task->abort_msg = g.abort_msg;
+    superlu_python_thread_end(&g);
+    return 0;
+}
+
+static int solve_task_start(solve_task *task)
+{
+#ifdef _WIN32
+    task->handle = (HANDLE)_beginthreadex(NULL, 0, solve_task_main, task,
+                                          0, NULL);
+    return task->handle != 0;
+#else
+    return pthread_create(&task->handle, NULL, solve_task_main,
+                          task) == 0;
+#endif
+}
+
+static void solve_task_join(solve_task *task)
+{
+#ifdef _WIN32
+    WaitForSingleObject(task->handle, INFINITE);
+    CloseHandle(task->handle);
+#else
+    pthread_join(task->handle, NULL);
+#endif
+}
+
+static int superlu_cpu_count(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return n > 0 ? (int)n : 1;
+#else
+    return 1;
+#endif
+}
+
+/*
+ * Solves in place for the F-contiguous right-hand sides x on nthreads
+ * threads, with the GIL released. Returns -1 with an exception set on
+ * failure.
+ */
+static int solve_threaded(SuperLUObject *self, trans_t trans,
+                          PyArrayObject *x, int nrhs, int nthreads)
+{
+    solve_task *tasks;
+    npy_intp colsize = self->n * PyArray_ITEMSIZE(x);
+    int k, start, end, info = 0;
+    char *abort_msg = NULL;
+    PyThreadState *save;
+
+    tasks = calloc(nthreads, sizeof(solve_task));
+    if (tasks == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    for (k = 0; k < nthreads; ++k) {
+        start = (int)((npy_intp)nrhs * k / nthreads);
+        end = (int)((npy_intp)nrhs * (k + 1) / nthreads);
+        tasks[k].lu = self;
+        tasks[k].trans = trans;
+        tasks[k].data = PyArray_BYTES(x) + start * colsize;
+        tasks[k].ncol = end - start;
+    }
+
+    save = PyEval_SaveThread();
+    for (k = 1; k < nthreads; ++k) {
+        if (superlu_python_thread_available()) {
+            tasks[k].started = solve_task_start(tasks + k);
+        }
+    }
+    solve_task_run(tasks);
+    for (k = 1; k < nthreads; ++k) {
+        if (tasks[k].started) {
+            solve_task_join(tasks + k);
+        }
+        else {
+            solve_task_run(tasks + k);
+        }
+    }
+    PyEval_RestoreThread(save);
+
+    for (k = 0; k < nthreads; ++k) {
+        if (tasks[k].aborted && abort_msg == NULL) {
+            abort_msg = tasks[k].abort_msg ? tasks[k].abort_msg : "";
+        }
+        if (tasks[k].info) {
+            info = tasks[k].info;
+        }
+    }
+    free(tasks);
+
+    if (abort_msg != NULL) {
+        /* Aborts on the calling thread have set the exception already */
+        if (!PyErr_Occurred()) {
+            PyErr_SetString(PyExc_RuntimeError, abort_msg);
+        }
+        return -1;
+    }
+    if (info) {
+	PyErr_SetString(PyExc_SystemError,
+			"gstrs was called with invalid arguments");
+        return -1;
+    }
+    return 0;
+}
+
+
+
+/***********************************************************************
+ * Level-scheduled solving
+ *
+ * With too few right-hand sides to share out, each one is solved with
+ * copies of the factors by rows, whose rows of the same level are
+ * solved in parallel (see _superlu_levels.c). The schedules are made on
+ * first use.
+ */
+
+static void levels_clear(SuperLUObject *self)
+{
+    int k;
+
+    for (k = 0; k < 4; ++k) {
+        slu_levels_free(self->levels[k]);
+        self->levels[k] = NULL;
+    }
+}
+
+/*
+ * Makes the schedules of L and U, or of L^T and U^T if transposed is
+ * set. Returns -1 with an exception set on failure.
+ */
+static int levels_build(SuperLUObject *self, int transposed)
+{
+    SCformat *Lstore = (SCformat *)self->L.Store;
+    NCformat *Ustore = (NCformat *)self->U.Store;
+    int n = self->n;
+    size_t elsize;
+    int *L_indices, *L_indptr, *U_indices, *U_indptr;
+    char *L_data, *U_data;
+    int ok = -1;
+
+    elsize = (self->type == NPY_FLOAT ? sizeof(float) :
+              self->type == NPY_DOUBLE || self->type == NPY_CFLOAT ?
+              sizeof(double) : 2 * sizeof(double));
+
+    L_indices = malloc((Lstore->nnz + 1) * sizeof(int));
+    L_indptr = malloc((n + 1) * sizeof(int));
+    L_data = malloc((Lstore->nnz + 1) * elsize);
+    U_indices = malloc((Ustore->nnz + 1) * sizeof(int));
+    U_indptr = malloc((n + 1) * sizeof(int));
+    U_data = malloc((Ustore->nnz + 1) * elsize);
+    if (L_indices == NULL || L_indptr == NULL || L_data == NULL ||
+        U_indices == NULL || U_indptr == NULL || U_data == NULL) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    if (LU_to_csc(&self->L, &self->U, L_indices, L_indptr, L_data,
+                  U_indices, U_indptr, U_data, self->L.Dtype) != 0) {
+        goto done;
+    }
+
+    self->levels[2 * transposed] = slu_levels_new(
+        n, L_indptr, L_indices, L_data, self->type, 1, transposed, 1);
+    self->levels[2 * transposed + 1] = slu_levels_new(
+        n, U_indptr, U_indices, U_data, self->type, 0, transposed, 0);
+    if (self->levels[2 * transposed] == NULL ||
+        self->levels[2 * transposed + 1] == NULL) {
+        levels_clear(self);
+        PyErr_NoMemory();
+        goto done;
+    }
+    ok = 0;
+
+  done:
+    free(L_indices);
+    free(L_indptr);
+    free(L_data);
+    free(U_indices);
+    free(U_indptr);
+    free(U_data);
+    return ok;
+}
+
+/*
+ * Solves in place for the F-contiguous right-hand sides x with the level
+ * schedules on nthreads threads, with the GIL released. Returns -1 with
+ * an exception set on failure.
+ */
+static int solve_levels(SuperLUObject *self, trans_t trans,
+                        PyArrayObject *x, int nrhs, int nthreads)
+{
+    int transposed = (trans != NOTRANS);
+    npy_intp elsize = PyArray_ITEMSIZE(x);
+    npy_intp colsize = self->n * elsize;
+    slu_levels *first, *second;
+    int *perm_in, *perm_out;
+    char *work, *col;
+    int i, j;
+    PyThreadState *save;
+
+    if (self->levels[2 * transposed] == NULL &&
+        levels_build(self, transposed)) {
+        return -1;
+    }
+
+    /* Pr A Pc = L U, so A x = b is solved by L U y = Pr b, x = Pc y, and
+       A^T x = b by U^T L^T y = Pc^T b, x = Pr^T y */
+    if (transposed) {
+        first = self->levels[3];
+        second = self->levels[2];
+        perm_in = self->perm_c;
+        perm_out = self->perm_r;
+    }
+    else {
+        first = self->levels[0];
+        second = self->levels[1];
+        perm_in = self->perm_r;
+        perm_out = self->perm_c;
+    }
+
+    work = malloc(colsize > 0 ? colsize : 1);
+    if (work == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    save = PyEval_SaveThread();
+    for (j = 0; j < nrhs; ++j) {
+        col = PyArray_BYTES(x) + j * colsize;
+        for (i = 0; i < self->n; ++i) {
+            memcpy(work + perm_in[i] * elsize, col + i * elsize, elsize);
+        }
+        slu_levels_solve(first, work, trans == CONJ, nthreads);
+        slu_levels_solve(second, work, trans == CONJ, nthreads);
+        for (i = 0; i < self->n; ++i) {
+            memcpy(col + i * elsize, work + perm_out[i] * elsize, elsize);
+        }
+    }
+    PyEval_RestoreThread(save);
+
+    free(work);
+    return 0;
+}
 
 
 /*********************************************************************** 
@@ -32,7 +364,8 @@ static PyObject *SuperLU_solve(SuperLUObject * self, PyObject * args,
     volatile int info;
     volatile trans_t trans;
     volatile SuperLUStat_t stat = { 0 };
-    static char *kwlist[] = { "rhs", "trans", NULL };
+    int workers = 1, nrhs;
+    static char *kwlist[] = { "rhs", "trans", "workers", NULL };
     volatile jmp_buf *jmpbuf_ptr;
     SLU_BEGIN_THREADS_DEF;
 
@@ -41,15 +374,30 @@ static PyObject *SuperLU_solve(SuperLUObject * self, PyObject * args,
         return NULL;
     }
 
+    if (self->L.Store == NULL) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "factorization was lost in a failed refactor");
+        return NULL;
+    }
+
 #ifndef NPY_PY3K
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!|c", kwlist,
-                                     &PyArray_Type, &b, &itrans))
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!|ci", kwlist,
+                                     &PyArray_Type, &b, &itrans, &workers))
 #else
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!|C", kwlist,
-                                     &PyArray_Type, &b, &itrans))
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!|Ci", kwlist,
+                                     &PyArray_Type, &b, &itrans, &workers))
 #endif
         return NULL;
 
+    if (workers < 0) {
+        /* Wraps around from the number of CPUs */
+        workers += superlu_cpu_count() + 1;
+    }
+    if (workers <= 0) {
+        PyErr_SetString(PyExc_ValueError, "workers must not be zero");
+        return NULL;
+    }
+
     /* solve transposed system: matrix was passed row-wise instead of
      * column-wise */
     if (itrans == 'n' || itrans == 'N')
@@ -75,6 +423,24 @@ static PyObject *SuperLU_solve(SuperLUObject * self, PyObject * args,
         goto fail;
     }
 
+    nrhs = (PyArray_NDIM((PyArrayObject*)x) == 2 ?
+            (int)PyArray_DIM((PyArrayObject*)x, 1) : 1);
+    if (workers > 1 && nrhs < 2 * SLU_SOLVE_MIN_PANEL) {
+        if (solve_levels(self, trans, (PyArrayObject*)x, nrhs, workers)) {
+            goto fail;
+        }
+        return (PyObject *) x;
+    }
+    if (workers > nrhs / SLU_SOLVE_MIN_PANEL) {
+        workers = nrhs / SLU_SOLVE_MIN_PANEL;
+    }
+    if (workers > 1) {
+        if (solve_threaded(self, trans, (PyArrayObject*)x, nrhs, workers)) {
+            goto fail;
+        }
+        return (PyObject *) x;
+    }
+
     if (DenseSuper_from_Numeric((SuperMatrix*)&B, (PyObject *)x))
         goto fail;
 
@@ -115,10 +481,623 @@ static PyObject *SuperLU_solve(SuperLUObject * self, PyObject * args,
     return NULL;
 }
 
+/*
+ * C interface for other extension modules (_superlu_capi.h)
+ */
+
+static int SuperLU_capi_usable(PyObject *lu, int typenum, int n)
+{
+    SuperLUObject *self = (SuperLUObject *)lu;
+
+    return (PyObject_TypeCheck(lu, &SuperLUType) && self->type == typenum
+            && self->n == n && self->L.Store != NULL);
+}
+
+static int SuperLU_capi_solve(PyObject *lu, void *x)
+{
+    SuperLUObject *self = (SuperLUObject *)lu;
+    volatile SuperMatrix B = { 0 };
+    volatile SuperLUStat_t stat = { 0 };
+    volatile int info;
+    volatile jmp_buf *jmpbuf_ptr;
+    SLU_BEGIN_THREADS_DEF;
+
+    if (!PyObject_TypeCheck(lu, &SuperLUType)) {
+        PyErr_SetString(PyExc_TypeError, "expected a SuperLU object");
+        return -1;
+    }
+    if (self->L.Store == NULL) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "factorization was lost in a failed refactor");
+        return -1;
+    }
+
+    jmpbuf_ptr = (volatile jmp_buf *)superlu_python_jmpbuf();
+    if (setjmp(*(jmp_buf*)jmpbuf_ptr)) {
+        goto fail;
+    }
+    Create_Dense_Matrix(self->type, (SuperMatrix *)&B, self->n, 1, x,
+                        self->n, SLU_DN, NPY_TYPECODE_TO_SLU(self->type),
+                        SLU_GE);
+    StatInit((SuperLUStat_t *)&stat);
+
+    jmpbuf_ptr = (volatile jmp_buf *)superlu_python_jmpbuf();
+    SLU_BEGIN_THREADS;
+    if (setjmp(*(jmp_buf*)jmpbuf_ptr)) {
+        SLU_END_THREADS;
+        goto fail;
+    }
+    gstrs(self->type,
+          NOTRANS, &self->L, &self->U, self->perm_c, self->perm_r,
+          (SuperMatrix *)&B, (SuperLUStat_t *)&stat, (int *)&info);
+    SLU_END_THREADS;
+
+    if (info) {
+        PyErr_SetString(PyExc_SystemError,
+                        "gstrs was called with invalid arguments");
+        goto fail;
+    }
+
+    Destroy_SuperMatrix_Store((SuperMatrix *)&B);
+    StatFree((SuperLUStat_t *)&stat);
+    return 0;
+
+  fail:
+    XDestroy_SuperMatrix_Store((SuperMatrix *)&B);
+    XStatFree((SuperLUStat_t *)&stat);
+    return -1;
+}
+
+superlu_capi_t superlu_capi = {
+    SuperLU_capi_usable,
+    SuperLU_capi_solve
+};
+
+static PyObject *SuperLU_refactor(SuperLUObject * self, PyObject * args,
+				  PyObject * kwds)
+{
+    PyObject *data;
+    volatile PyArrayObject *nzvals = NULL;
+    volatile SuperMatrix A = { 0 };
+    volatile SuperMatrix AC = { 0 };
+    volatile SuperMatrix L = { 0 };
+    volatile SuperMatrix U = { 0 };
+    volatile int *perm_r = NULL;
+    volatile int info;
+    volatile int stage = 0;
+    volatile fact_t fact = SamePattern;
+    volatile superlu_options_t options;
+    volatile SuperLUStat_t stat = { 0 };
+    volatile GlobalLU_t Glu;
+    static char *kwlist[] = { "data", "fact", NULL };
+    volatile jmp_buf *jmpbuf_ptr;
+    SLU_BEGIN_THREADS_DEF;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O&", kwlist,
+                                     &data, fact_cvt, &fact))
+        return NULL;
+
+    if (fact != SamePattern && fact != SamePattern_SameRowPerm) {
+        PyErr_SetString(PyExc_ValueError,
+                        "fact must be SamePattern or SamePattern_SameRowPerm");
+        return NULL;
+    }
+
+    if (self->rowind == NULL || self->colptr == NULL) {
+        PyErr_SetString(PyExc_ValueError,
+                        "sparsity pattern of the factorization is not known");
+        return NULL;
+    }
+
+    if (self->exports > 0) {
+        PyErr_SetString(PyExc_BufferError,
+                        "cannot refactor while views of the factors from "
+                        "supernodes() exist");
+        return NULL;
+    }
+
+    if (fact == SamePattern_SameRowPerm && self->L.Store == NULL) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "factorization was lost in a failed refactor");
+        return NULL;
+    }
+
+    nzvals = (PyArrayObject*)PyArray_FROMANY(data, self->type, 1, 1,
+                                             NPY_ARRAY_IN_ARRAY);
+    if (nzvals == NULL) {
+        return NULL;
+    }
+
+    if (PyArray_DIM((PyArrayObject*)nzvals, 0) != self->nnz) {
+        PyErr_SetString(PyExc_ValueError, "data is of incompatible size");
+        goto fail;
+    }
+
+    if (NCFormat_from_spMatrix((SuperMatrix*)&A, self->m, self->n, self->nnz,
+                               (PyArrayObject*)nzvals, self->rowind,
+                               self->colptr, self->type))
+        goto fail;
+
+    options = self->options;
+    options.Fact = fact;
+
+    jmpbuf_ptr = (volatile jmp_buf *)superlu_python_jmpbuf();
+    if (setjmp(*(jmp_buf*)jmpbuf_ptr)) {
+	goto fail;
+    }
+
+    StatInit((SuperLUStat_t *)&stat);
+
+    /* Only permutes the columns: the ordering and etree are reused */
+    sp_preorder((superlu_options_t*)&options, (SuperMatrix*)&A, self->perm_c,
+                self->etree, (SuperMatrix*)&AC);
+
+    if (fact == SamePattern) {
+        /* New factors, the old ones are kept until this succeeds */
+        perm_r = intMalloc(self->n);
+    }
+    else {
+        /* The storage of the old factors is reused */
+        perm_r = self->perm_r;
+        L = self->L;
+        U = self->U;
+        Glu = self->Glu;
+    }
+
+    jmpbuf_ptr = (volatile jmp_buf *)superlu_python_jmpbuf();
+    SLU_BEGIN_THREADS;
+    if (setjmp(*(jmp_buf*)jmpbuf_ptr)) {
+        SLU_END_THREADS;
+        goto fail;
+    }
+
+    stage = 1;
+    if (self->ilu) {
+        gsitrf(self->type, (superlu_options_t*)&options, (SuperMatrix*)&AC,
+               self->relax, self->panel_size, self->etree, NULL, 0,
+               self->perm_c, (int*)perm_r, (SuperMatrix*)&L, (SuperMatrix*)&U,
+               (GlobalLU_t*)&Glu, (SuperLUStat_t*)&stat, (int*)&info);
+    }
+    else {
+        gstrf(self->type, (superlu_options_t*)&options, (SuperMatrix*)&AC,
+              self->relax, self->panel_size, self->etree, NULL, 0,
+              self->perm_c, (int*)perm_r, (SuperMatrix*)&L, (SuperMatrix*)&U,
+              (GlobalLU_t*)&Glu, (SuperLUStat_t*)&stat, (int*)&info);
+    }
+    stage = 2;
+
+    SLU_END_THREADS;
+
+    if (info) {
+	if (info < 0)
+	    PyErr_SetString(PyExc_SystemError,
+			    "gstrf was called with invalid arguments");
+	else {
+	    if (info <= self->n)
+		PyErr_SetString(PyExc_RuntimeError,
+				"Factor is exactly singular");
+	    else
+		PyErr_NoMemory();
+	}
+	goto fail;
+    }
+
+    if (fact == SamePattern) {
+        XDestroy_SuperNode_Matrix(&self->L);
+        XDestroy_CompCol_Matrix(&self->U);
+        SUPERLU_FREE(self->perm_r);
+        self->perm_r = (int*)perm_r;
+    }
+    self->L = *(SuperMatrix*)&L;
+    self->U = *(SuperMatrix*)&U;
+    self->Glu = *(GlobalLU_t*)&Glu;
+    Py_CLEAR(self->cached_L);
+    Py_CLEAR(self->cached_U);
+    levels_clear(self);
+
+    /* free memory */
+    Destroy_CompCol_Permuted((SuperMatrix*)&AC);
+    Destroy_SuperMatrix_Store((SuperMatrix*)&A);
+    StatFree((SuperLUStat_t*)&stat);
+    Py_DECREF(nzvals);
+    Py_RETURN_NONE;
+
+  fail:
+    if (fact == SamePattern) {
+        XDestroy_SuperNode_Matrix((SuperMatrix*)&L);
+        XDestroy_CompCol_Matrix((SuperMatrix*)&U);
+        SUPERLU_FREE((void*)perm_r);
+    }
+    else if (stage == 1) {
+        /* Aborted halfway: the factors may refer to released memory */
+        self->L.Store = NULL;
+        self->U.Store = NULL;
+        Py_CLEAR(self->cached_L);
+        Py_CLEAR(self->cached_U);
+        levels_clear(self);
+    }
+    else if (stage == 2) {
+        self->L = *(SuperMatrix*)&L;
+        self->U = *(SuperMatrix*)&U;
+        XDestroy_SuperNode_Matrix(&self->L);
+        XDestroy_CompCol_Matrix(&self->U);
+        Py_CLEAR(self->cached_L);
+        Py_CLEAR(self->cached_U);
+        levels_clear(self);
+    }
+    XDestroy_CompCol_Permuted((SuperMatrix*)&AC);
+    XDestroy_SuperMatrix_Store((SuperMatrix*)&A);
+    XStatFree((SuperLUStat_t*)&stat);
+    Py_XDECREF(nzvals);
+    return NULL;
+}
+
+/*
+ * Copies n values between the real or complex floating point types of
+ * SuperLU, both real or both complex.
+ */
+static void convert_values(void *dst, int dsttype, const void *src,
+                           int srctype, npy_intp n)
+{
+    npy_intp i;
+
+    if (PyTypeNum_ISCOMPLEX(srctype)) {
+        n *= 2;
+    }
+    if (dsttype == srctype) {
+        memcpy(dst, src, n * (dsttype == NPY_FLOAT || dsttype == NPY_CFLOAT ?
+                              sizeof(float) : sizeof(double)));
+    }
+    else if (dsttype == NPY_FLOAT || dsttype == NPY_CFLOAT) {
+        for (i = 0; i < n; ++i) {
+            ((float *)dst)[i] = (float)((const double *)src)[i];
+        }
+    }
+    else {
+        for (i = 0; i < n; ++i) {
+            ((double *)dst)[i] = ((const float *)src)[i];
+        }
+    }
+}
+
+static void *copy_ints(const int *src, int n)
+{
+    int *dst = intMalloc(n);
+
+    memcpy(dst, src, n * sizeof(int));
+    return dst;
+}
+
+static PyObject *SuperLU_astype(SuperLUObject * self, PyObject * args)
+{
+    PyArray_Descr *descr = NULL;
+    SuperLUObject *volatile lu = NULL;
+    SCformat *volatile Lstore;
+    NCformat *volatile Ustore;
+    void *volatile nzval;
+    volatile int type, nsize, n, nnzL, nnzU, nrowind;
+    volatile jmp_buf *jmpbuf_ptr;
+
+    if (!PyArg_ParseTuple(args, "O&", PyArray_DescrConverter, &descr))
+        return NULL;
+    type = descr->type_num;
+    Py_DECREF(descr);
+
+    if (!CHECK_SLU_TYPE(type) ||
+        PyTypeNum_ISCOMPLEX(type) != PyTypeNum_ISCOMPLEX(self->type)) {
+        PyErr_SetString(PyExc_ValueError,
+                        "dtype must be a floating point type of the same "
+                        "kind, real or complex, as the factorization");
+        return NULL;
+    }
+
+    if (self->L.Store == NULL) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "factorization was lost in a failed refactor");
+        return NULL;
+    }
+
+    lu = PyObject_New(SuperLUObject, &SuperLUType);
+    if (lu == NULL)
+	return PyErr_NoMemory();
+    n = self->n;
+    lu->m = self->m;
+    lu->n = n;
+    lu->perm_r = NULL;
+    lu->perm_c = NULL;
+    lu->L.Store = NULL;
+    lu->U.Store = NULL;
+    lu->cached_U = NULL;
+    lu->cached_L = NULL;
+    lu->type = type;
+    lu->ilu = self->ilu;
+    lu->nnz = self->nnz;
+    lu->etree = NULL;
+    lu->exports = 0;
+    lu->levels[0] = lu->levels[1] = NULL;
+    lu->levels[2] = lu->levels[3] = NULL;
+    lu->rowind = self->rowind;
+    lu->colptr = self->colptr;
+    Py_XINCREF(lu->rowind);
+    Py_XINCREF(lu->colptr);
+    lu->options = self->options;
+    lu->panel_size = self->panel_size;
+    lu->relax = self->relax;
+
+    nsize = (type == NPY_FLOAT ? sizeof(float) :
+             type == NPY_DOUBLE || type == NPY_CFLOAT ? sizeof(double) :
+             2 * sizeof(double));
+    Lstore = (SCformat *) self->L.Store;
+    Ustore = (NCformat *) self->U.Store;
+    nnzL = Lstore->nzval_colptr[n];
+    nrowind = Lstore->rowind_colptr[n];
+    nnzU = Ustore->colptr[n];
+
+    jmpbuf_ptr = (volatile jmp_buf *)superlu_python_jmpbuf();
+    if (setjmp(*(jmp_buf*)jmpbuf_ptr)) {
+	goto fail;
+    }
+
+    lu->perm_r = copy_ints(self->perm_r, n);
+    lu->perm_c = copy_ints(self->perm_c, n);
+    lu->etree = copy_ints(self->etree, n);
+
+    nzval = SUPERLU_MALLOC(nnzL * nsize);
+    if (nzval == NULL)
+        ABORT("SUPERLU_MALLOC fails for nzval");
+    convert_values(nzval, type, Lstore->nzval, self->type, nnzL);
+    Create_SuperNode_Matrix(type, &lu->L, self->L.nrow, self->L.ncol,
+                            Lstore->nnz, nzval,
+                            copy_ints(Lstore->nzval_colptr, n + 1),
+                            copy_ints(Lstore->rowind, nrowind),
+                            copy_ints(Lstore->rowind_colptr, n + 1),
+                            copy_ints(Lstore->col_to_sup, n + 1),
+                            copy_ints(Lstore->sup_to_col, n + 1),
+                            SLU_SC, NPY_TYPECODE_TO_SLU(type), SLU_TRLU);
+    ((SCformat *) lu->L.Store)->nsuper = Lstore->nsuper;
+
+    nzval = SUPERLU_MALLOC(nnzU * nsize);
+    if (nzval == NULL)
+        ABORT("SUPERLU_MALLOC fails for nzval");
+    convert_values(nzval, type, Ustore->nzval, self->type, nnzU);
+    Create_CompCol_Matrix(type, &lu->U, self->U.nrow, self->U.ncol,
+                          Ustore->nnz,
+                          nzval, copy_ints(Ustore->rowind, nnzU),
+                          copy_ints(Ustore->colptr, n + 1),
+                          SLU_NC, NPY_TYPECODE_TO_SLU(type), SLU_TRU);
+
+    /* Sizes of the storage, for refactoring in place */
+    lu->Glu = self->Glu;
+    lu->Glu.nzlmax = nrowind;
+    lu->Glu.nzumax = nnzU;
+    lu->Glu.nzlumax = nnzL;
+
+    return (PyObject *) lu;
+
+  fail:
+    Py_DECREF(lu);
+    return NULL;
+}
+
+static PyObject *SuperLU_solve_triangular(SuperLUObject * self,
+					  PyObject * args, PyObject * kwds)
+{
+    PyObject *b, *lower = Py_True;
+    volatile PyArrayObject *x = NULL;
+#ifndef NPY_PY3K
+    char itrans = 'N';
+#else
+    int itrans = 'N';
+#endif
+    char *uplo, *diag, *trans;
+    volatile int info = 0;
+    volatile SuperLUStat_t stat = { 0 };
+    npy_intp j, nrhs, colsize;
+    static char *kwlist[] = { "rhs", "lower", "trans", NULL };
+    volatile jmp_buf *jmpbuf_ptr;
+    SLU_BEGIN_THREADS_DEF;
+
+    if (!CHECK_SLU_TYPE(self->type)) {
+        PyErr_SetString(PyExc_ValueError, "unsupported data type");
+        return NULL;
+    }
+
+    if (self->L.Store == NULL) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "factorization was lost in a failed refactor");
+        return NULL;
+    }
+
+#ifndef NPY_PY3K
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|Oc", kwlist,
+                                     &b, &lower, &itrans))
+#else
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OC", kwlist,
+                                     &b, &lower, &itrans))
+#endif
+        return NULL;
+
+    switch (PyObject_IsTrue(lower)) {
+    case 1:
+        /* L has a unit diagonal */
+        uplo = "L";
+        diag = "U";
+        break;
+    case 0:
+        uplo = "U";
+        diag = "N";
+        break;
+    default:
+        return NULL;
+    }
+
+    if (itrans == 'n' || itrans == 'N')
+        trans = "N";
+    else if (itrans == 't' || itrans == 'T')
+        trans = "T";
+    else if (itrans == 'h' || itrans == 'H')
+        trans = "C";
+    else {
+        PyErr_SetString(PyExc_ValueError, "trans must be N, T, or H");
+        return NULL;
+    }
+
+    x = (PyArrayObject*)PyArray_FROMANY(
+        b, self->type, 1, 2,
+        NPY_ARRAY_F_CONTIGUOUS | NPY_ARRAY_ENSURECOPY);
+    if (x == NULL) {
+        return NULL;
+    }
+
+    if (PyArray_DIM((PyArrayObject*)x, 0) != self->n) {
+        PyErr_SetString(PyExc_ValueError, "b is of incompatible size");
+        goto fail;
+    }
+
+    nrhs = (PyArray_NDIM((PyArrayObject*)x) == 2 ?
+            PyArray_DIM((PyArrayObject*)x, 1) : 1);
+    colsize = self->n * PyArray_ITEMSIZE((PyArrayObject*)x);
+
+    jmpbuf_ptr = (volatile jmp_buf *)superlu_python_jmpbuf();
+    if (setjmp(*(jmp_buf*)jmpbuf_ptr)) {
+	goto fail;
+    }
+
+    StatInit((SuperLUStat_t *)&stat);
+
+    /* Solve column by column, overwriting x */
+    jmpbuf_ptr = (volatile jmp_buf *)superlu_python_jmpbuf();
+    SLU_BEGIN_THREADS;
+    if (setjmp(*(jmp_buf*)jmpbuf_ptr)) {
+        SLU_END_THREADS;
+	goto fail;
+    }
+    for (j = 0; j < nrhs && info == 0; ++j) {
+        sp_trsv(self->type, uplo, trans, diag, &self->L, &self->U,
+                PyArray_BYTES((PyArrayObject*)x) + j * colsize,
+                (SuperLUStat_t *)&stat, (int *)&info);
+    }
+    SLU_END_THREADS;
+
+    if (info) {
+	PyErr_SetString(PyExc_SystemError,
+			"sp_trsv was called with invalid arguments");
+	goto fail;
+    }
+
+    StatFree((SuperLUStat_t *)&stat);
+    return (PyObject *) x;
+
+  fail:
+    XStatFree((SuperLUStat_t *)&stat);
+    Py_XDECREF(x);
+    return NULL;
+}
+
+/*
+ * Views from supernodes() share a capsule as their base, which holds a
+ * reference to the factorization and counts as one export until the last
+ * view is gone.
+ */
+static void supernodes_release(PyObject *capsule)
+{
+    SuperLUObject *self = (SuperLUObject *)PyCapsule_GetPointer(
+        capsule, "SuperLU.supernodes");
+
+    self->exports--;
+    Py_DECREF(self);
+}
+
+static int add_view(PyObject *dict, const char *key, PyObject *base,
+                    void *data, npy_intp size, int type)
+{
+    PyObject *view;
+    int ret;
+
+    view = PyArray_SimpleNewFromData(1, &size, type, data);
+    if (view == NULL) {
+        return -1;
+    }
+    PyArray_CLEARFLAGS((PyArrayObject*)view, NPY_ARRAY_WRITEABLE);
+    Py_INCREF(base);
+    if (PyArray_SetBaseObject((PyArrayObject*)view, base) < 0) {
+        Py_DECREF(view);
+        return -1;
+    }
+    ret = PyDict_SetItemString(dict, key, view);
+    Py_DECREF(view);
+    return ret;
+}
+
+static PyObject *SuperLU_supernodes(SuperLUObject * self, PyObject * args)
+{
+    SCformat *Lstore;
+    NCformat *Ustore;
+    PyObject *capsule, *dict;
+    npy_intp n = self->n;
+    int nsup;
+
+    if (self->L.Store == NULL) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "factorization was lost in a failed refactor");
+        return NULL;
+    }
+
+    Lstore = (SCformat *) self->L.Store;
+    Ustore = (NCformat *) self->U.Store;
+    nsup = Lstore->nsuper + 1;
+
+    dict = PyDict_New();
+    if (dict == NULL) {
+        return NULL;
+    }
+
+    capsule = PyCapsule_New((void *)self, "SuperLU.supernodes",
+                            supernodes_release);
+    if (capsule == NULL) {
+        Py_DECREF(dict);
+        return NULL;
+    }
+    Py_INCREF(self);
+    self->exports++;
+
+    if (add_view(dict, "sup_to_col", capsule, Lstore->sup_to_col,
+                 nsup + 1, NPY_INT) ||
+        add_view(dict, "col_to_sup", capsule, Lstore->col_to_sup,
+                 n, NPY_INT) ||
+        add_view(dict, "L_rowind_colptr", capsule, Lstore->rowind_colptr,
+                 n + 1, NPY_INT) ||
+        add_view(dict, "L_rowind", capsule, Lstore->rowind,
+                 Lstore->rowind_colptr[n], NPY_INT) ||
+        add_view(dict, "L_nzval_colptr", capsule, Lstore->nzval_colptr,
+                 n + 1, NPY_INT) ||
+        add_view(dict, "L_nzval", capsule, Lstore->nzval,
+                 Lstore->nzval_colptr[n], self->type) ||
+        add_view(dict, "U_colptr", capsule, Ustore->colptr,
+                 n + 1, NPY_INT) ||
+        add_view(dict, "U_rowind", capsule, Ustore->rowind,
+                 Ustore->colptr[n], NPY_INT) ||
+        add_view(dict, "U_nzval", capsule, Ustore->nzval,
+                 Ustore->colptr[n], self->type)) {
+        Py_DECREF(dict);
+        Py_DECREF(capsule);
+        return NULL;
+    }
+
+    Py_DECREF(capsule);
+    return dict;
+}
+
 /** table of object methods
  */
 PyMethodDef SuperLU_methods[] = {
     {"solve", (PyCFunction) SuperLU_solve, METH_VARARGS | METH_KEYWORDS, NULL},
+    {"refactor", (PyCFunction) SuperLU_refactor, METH_VARARGS | METH_KEYWORDS,
+     NULL},
+    {"astype", (PyCFunction) SuperLU_astype, METH_VARARGS, NULL},
+    {"solve_triangular", (PyCFunction) SuperLU_solve_triangular,
+     METH_VARARGS | METH_KEYWORDS, NULL},
+    {"supernodes", (PyCFunction) SuperLU_supernodes, METH_NOARGS, NULL},
     {NULL, NULL}		/* sentinel */
 };
 
@@ -133,10 +1112,17 @@ static void SuperLU_dealloc(SuperLUObject * self)
     Py_XDECREF(self->cached_L);
     self->cached_U = NULL;
     self->cached_L = NULL;
+    Py_XDECREF(self->rowind);
+    Py_XDECREF(self->colptr);
+    self->rowind = NULL;
+    self->colptr = NULL;
     SUPERLU_FREE(self->perm_r);
     SUPERLU_FREE(self->perm_c);
+    SUPERLU_FREE(self->etree);
+    levels_clear(self);
     self->perm_r = NULL;
     self->perm_c = NULL;
+    self->etree = NULL;
     XDestroy_SuperNode_Matrix(&self->L);
     XDestroy_CompCol_Matrix(&self->U);
     PyObject_Del(self);
@@ -150,6 +1136,11 @@ static PyObject *SuperLU_getter(PyObject *selfp, void *data)
     if (strcmp(name, "shape") == 0) {
 	return Py_BuildValue("(i,i)", self->m, self->n);
     }
+    else if (self->L.Store == NULL) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "factorization was lost in a failed refactor");
+        return NULL;
+    }
     else if (strcmp(name, "nnz") == 0)
 	return Py_BuildValue("i",
 			     ((SCformat *) self->L.Store)->nnz +
@@ -728,6 +1719,14 @@ PyObject *newSuperLUObject(SuperMatrix * A, PyObject * option_dict,
     self->cached_U = NULL;
     self->cached_L = NULL;
     self->type = intype;
+    self->ilu = ilu;
+    self->nnz = ((NCformat *) A->Store)->nnz;
+    self->etree = NULL;
+    self->rowind = NULL;
+    self->colptr = NULL;
+    self->exports = 0;
+    self->levels[0] = self->levels[1] = NULL;
+    self->levels[2] = self->levels[3] = NULL;
 
     jmpbuf_ptr = (volatile jmp_buf *)superlu_python_jmpbuf();
     if (setjmp(*(jmp_buf*)jmpbuf_ptr)) {
@@ -798,8 +1797,14 @@ PyObject *newSuperLUObject(SuperMatrix * A, PyObject * option_dict,
 	goto fail;
     }
 
+    /* keep the symbolic analysis for refactoring */
+    self->etree = (int *)etree;
+    self->options = *(superlu_options_t *)&options;
+    self->panel_size = panel_size;
+    self->relax = relax;
+    self->Glu = *(GlobalLU_t *)Glu_ptr;
+
     /* free memory */
-    SUPERLU_FREE((void*)etree);
     Destroy_CompCol_Permuted((SuperMatrix*)&AC);
     StatFree((SuperLUStat_t*)&stat);
 
@@ -1102,7 +2107,7 @@ int set_superlu_options_from_dict(superlu_options_t * options,
 	"RowPerm", "SymmetricMode", "PrintStat", "ReplaceTinyPivot",
 	"SolveInitialized", "RefineInitialized", "ILU_Norm",
 	"ILU_MILU", "ILU_DropTol", "ILU_FillTol", "ILU_FillFactor",
-	"ILU_DropRule", "PanelSize", "Relax", NULL
+	"ILU_DropRule", "PanelSize", "Relax", "Threads", NULL
     };
 
     if (ilu) {
@@ -1122,7 +2127,7 @@ int set_superlu_options_from_dict(superlu_options_t * options,
     else {
         args = PyTuple_New(0);
         ret = PyArg_ParseTupleAndKeywords(args, option_dict,
-                                          "|O&O&O&O&O&O&O&O&O&O&O&O&O&O&O&O&O&O&O&O&O&O&",
+                                          "|O&O&O&O&O&O&O&O&O&O&O&O&O&O&O&O&O&O&O&O&O&O&O&",
                                           kwlist, fact_cvt, &options->Fact,
                                           yes_no_cvt, &options->Equil,
                                           colperm_cvt, &options->ColPerm,
@@ -1149,10 +2154,19 @@ int set_superlu_options_from_dict(superlu_options_t * options,
                                           double_cvt, &options->ILU_FillFactor,
                                           droprule_cvt, &options->ILU_DropRule,
                                           int_cvt, &_panel_size, int_cvt,
-                                          &_relax);
+                                          &_relax, int_cvt,
+                                          &options->nthreads);
         Py_DECREF(args);
     }
 
+    if (ret && options->nthreads < 0) {
+        options->nthreads += superlu_cpu_count() + 1;
+    }
+    if (ret && options->nthreads <= 0) {
+        PyErr_SetString(PyExc_ValueError, "Threads must not be zero");
+        ret = 0;
+    }
+
     if (panel_size != NULL) {
 	*panel_size = _panel_size;
     }
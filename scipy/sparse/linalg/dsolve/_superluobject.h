@@ -21,10 +21,26 @@
 #include "SuperLU/SRC/slu_util.h"
 #include "SuperLU/SRC/slu_dcomplex.h"
 #include "SuperLU/SRC/slu_scomplex.h"
+#include "_superlu_capi.h"
 
 
 #define _CHECK_INTEGER(x) (PyArray_ISINTEGER((PyArrayObject*)x) && PyArray_ITEMSIZE((PyArrayObject*)x) == sizeof(int))
 
+/*
+ * Schedule of a level-scheduled triangular solve (_superlu_levels.c):
+ * the matrix by rows without its diagonal, the rows sorted by level.
+ */
+typedef struct {
+    int n, type, nlevels;
+    int *level_ptr;             /* level k is at positions
+                                   level_ptr[k]:level_ptr[k+1] */
+    int *rows;                  /* row at each position */
+    int *indptr, *indices;      /* off-diagonal entries at each position */
+    char *data;
+    char *diag;                 /* diagonal at each position, or NULL
+                                   for a unit diagonal */
+} slu_levels;
+
 /*
  * SuperLUObject definition
  */
@@ -38,17 +54,42 @@ typedef struct {
     PyObject *cached_U;
     PyObject *cached_L;
     int type;
+    /* State kept for refactoring */
+    int ilu;
+    int nnz;
+    int *etree;
+    PyArrayObject *rowind;
+    PyArrayObject *colptr;
+    superlu_options_t options;
+    int panel_size, relax;
+    GlobalLU_t Glu;
+    int exports;                /* live views from supernodes() */
+    slu_levels *levels[4];      /* schedules of L, U, L^T and U^T */
 } SuperLUObject;
 
+/*
+ * Set of the blocks SuperLU has allocated in a thread, kept as an
+ * open-addressing hash table of the pointers.
+ */
+typedef struct {
+    void **slots;
+    size_t size;
+    size_t count;
+} SuperLUMemorySet;
+
 typedef struct {
     PyObject_HEAD
     int jmpbuf_valid;
     jmp_buf jmpbuf;
-    PyObject *memory_dict;
+    SuperLUMemorySet memory;
+    /* Set for worker threads, which cannot raise Python exceptions */
+    int worker;
+    char *abort_msg;
 } SuperLUGlobalObject;
 
 extern PyTypeObject SuperLUType;
 extern PyTypeObject SuperLUGlobalType;
+extern superlu_capi_t superlu_capi;
 
 int DenseSuper_from_Numeric(SuperMatrix *, PyObject *);
 int NRFormat_from_spMatrix(SuperMatrix *, int, int, int, PyArrayObject *,
@@ -69,7 +110,16 @@ void XDestroy_CompCol_Matrix(SuperMatrix *);
 void XDestroy_CompCol_Permuted(SuperMatrix *);
 void XStatFree(SuperLUStat_t *);
 
+slu_levels *slu_levels_new(int n, const int *indptr, const int *indices,
+                           const void *data, int type, int lower,
+                           int transpose, int unit);
+void slu_levels_free(slu_levels *);
+void slu_levels_solve(const slu_levels *, void *x, int conj, int nthreads);
+
 jmp_buf *superlu_python_jmpbuf(void);
+int superlu_python_thread_available(void);
+int superlu_python_thread_begin(SuperLUGlobalObject *);
+void superlu_python_thread_end(SuperLUGlobalObject *);
 
 
 /* Custom thread begin/end statements: Numpy versions < 1.9 are not safe
@@ -151,6 +201,12 @@ jmp_buf *superlu_python_jmpbuf(void);
 #define Create_CompCol_Matrix_ARGS Create_CompRow_Matrix_ARGS
 #define Create_CompCol_Matrix_ARGS_REF Create_CompRow_Matrix_ARGS_REF
 
+#define Create_SuperNode_Matrix_ARGS                            \
+    SuperMatrix *a, int b, int c, int d, void *e,               \
+    int *f, int *g, int *h, int *i, int *j,                     \
+    Stype_t k, Dtype_t l, Mtype_t m
+#define Create_SuperNode_Matrix_ARGS_REF a,b,c,d,e,f,g,h,i,j,k,l,m
+
 TYPE_GENERIC_FUNC(gstrf, void);
 TYPE_GENERIC_FUNC(gsitrf, void);
 TYPE_GENERIC_FUNC(gstrs, void);
@@ -158,5 +214,26 @@ TYPE_GENERIC_FUNC(gssv, void);
 TYPE_GENERIC_FUNC(Create_Dense_Matrix, void);
 TYPE_GENERIC_FUNC(Create_CompRow_Matrix, void);
 TYPE_GENERIC_FUNC(Create_CompCol_Matrix, void);
+TYPE_GENERIC_FUNC(Create_SuperNode_Matrix, void);
+
+/* sp_[sdcz]trsv are not named like the functions above */
+#define sp_trsv_ARGS                                            \
+    char *a, char *b, char *c, SuperMatrix *d, SuperMatrix *e,  \
+    void *f, SuperLUStat_t *g, int *h
+#define sp_trsv_ARGS_REF a,b,c,d,e,f,g,h
+
+int sp_strsv(sp_trsv_ARGS);
+int sp_dtrsv(sp_trsv_ARGS);
+int sp_ctrsv(sp_trsv_ARGS);
+static void sp_trsv(int type, sp_trsv_ARGS)
+{
+    switch(type) {
+    case NPY_FLOAT:   sp_strsv(sp_trsv_ARGS_REF); break;
+    case NPY_DOUBLE:  sp_dtrsv(sp_trsv_ARGS_REF); break;
+    case NPY_CFLOAT:  sp_ctrsv(sp_trsv_ARGS_REF); break;
+    case NPY_CDOUBLE: sp_ztrsv(sp_trsv_ARGS_REF); break;
+    default: return;
+    }
+}
 
 #endif				/* __SUPERLU_OBJECT */
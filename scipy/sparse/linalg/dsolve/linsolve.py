@@ -258,6 +258,10 @@ def splu(A, permc_spec=None, diag_pivot_thresh=None,
         for more details. For example, you can specify
         ``options=dict(Equil=False, IterRefine='SINGLE'))``
         to turn equilibration off and perform a single iterative refinement.
+        The scipy specific option ``Threads`` sets the number of threads
+        that update the columns of each panel in parallel (default 1, and
+        negative values count back from the number of CPUs). Larger
+        `panel_size` values give the threads more work to share.
 
     Returns
     -------
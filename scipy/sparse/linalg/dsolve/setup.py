@@ -35,12 +35,14 @@ def configuration(parent_package='',top_path=None):
     # Extension
     ext_sources = ['_superlumodule.c',
                    '_superlu_utils.c',
-                   '_superluobject.c']
+                   '_superluobject.c',
+                   '_superlu_levels.c']
 
     config.add_extension('_superlu',
                          sources=ext_sources,
                          libraries=['superlu_src'],
-                         depends=(sources + headers),
+                         depends=(sources + headers +
+                                  ['_superlu_capi.h']),
                          extra_info=lapack_opt,
                          **numpy_nodepr_api
                          )
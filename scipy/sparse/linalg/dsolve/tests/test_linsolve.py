@@ -547,6 +547,220 @@ class TestSplu(object):
         lu = splu(a_)
         assert_array_equal(lu.perm_r, lu.perm_c)
 
+    def test_splu_refactor(self):
+        n = 40
+        rng = random.RandomState(1234)
+        a = rng.rand(n, n)
+        a[a < 0.9] = 0
+        a += 4*eye(n)
+        a_ = csc_matrix(a)
+
+        for dtype in [np.float32, np.float64, np.complex64, np.complex128]:
+            rtol = 1e-4 if dtype in (np.float32, np.complex64) else 1e-12
+            lu = splu(a_.astype(dtype))
+            perm_c = lu.perm_c.copy()
+            b = ones(n, dtype=dtype)
+            for fact in [None, 'SamePattern', 'SamePattern_SameRowPerm']:
+                data = (a_.data * (0.5 + rng.rand(a_.nnz))).astype(dtype)
+                a2 = csc_matrix((data, a_.indices, a_.indptr), shape=(n, n))
+                if fact is None:
+                    lu.refactor(data)
+                else:
+                    lu.refactor(data, fact=fact)
+                x = lu.solve(b)
+                assert_allclose(a2.dot(x), b, rtol=rtol, atol=rtol)
+                assert_array_equal(lu.perm_c, perm_c)
+                # Pr * A * Pc = L * U
+                pa = a2.A[np.argsort(lu.perm_r)][:, np.argsort(lu.perm_c)]
+                assert_allclose((lu.L * lu.U).A, pa, rtol=rtol, atol=rtol)
+
+    def test_splu_refactor_errors(self):
+        n = 10
+        a = csc_matrix(4*eye(n) + np.diag(ones(n - 1), 1))
+        lu = splu(a)
+        b = ones(n)
+        x = lu.solve(b)
+
+        assert_raises(ValueError, lu.refactor, a.data[:-1])
+        assert_raises(ValueError, lu.refactor, a.data, fact='DOFACT')
+
+        # A failed refactor keeps the previous factors
+        data = a.data.copy()
+        data[a.indptr[3]:a.indptr[4]] = 0
+        assert_raises(RuntimeError, lu.refactor, data)
+        assert_allclose(lu.solve(b), x)
+
+    def test_supernodes(self):
+        n = 40
+        rng = random.RandomState(1234)
+        a = rng.rand(n, n)
+        a[a < 0.9] = 0
+        a += 4*eye(n)
+
+        for dtype in [np.float32, np.float64, np.complex64, np.complex128]:
+            lu = splu(csc_matrix(a.astype(dtype)))
+            s = lu.supernodes()
+            L = np.eye(n, dtype=dtype)
+            U = np.zeros((n, n), dtype=dtype)
+            sup_to_col = s['sup_to_col']
+            for k in range(len(sup_to_col) - 1):
+                f = sup_to_col[k]
+                rows = s['L_rowind'][s['L_rowind_colptr'][f]:
+                                     s['L_rowind_colptr'][f + 1]]
+                for j in range(f, sup_to_col[k + 1]):
+                    assert_array_equal(s['col_to_sup'][j], k)
+                    vals = s['L_nzval'][s['L_nzval_colptr'][j]:
+                                        s['L_nzval_colptr'][j + 1]]
+                    assert_array_equal(len(vals), len(rows))
+                    for r, v in zip(rows, vals):
+                        if r > j:
+                            L[r, j] = v
+                        else:
+                            U[r, j] = v
+            for j in range(n):
+                sl = slice(s['U_colptr'][j], s['U_colptr'][j + 1])
+                U[s['U_rowind'][sl], j] = s['U_nzval'][sl]
+            assert_array_equal(L, lu.L.A)
+            assert_array_equal(U, lu.U.A)
+
+            assert_raises(ValueError, s['L_nzval'].__setitem__, 0, 1)
+            assert_raises(BufferError, lu.refactor, csc_matrix(a).data)
+            del s, vals, rows, sup_to_col
+            lu.refactor(csc_matrix(a.astype(dtype)).data)
+
+    def test_solve_triangular(self):
+        n = 40
+        rng = random.RandomState(1234)
+        a = rng.rand(n, n)
+        a[a < 0.9] = 0
+        a += 4*eye(n)
+
+        for dtype in [np.float32, np.float64, np.complex64, np.complex128]:
+            rtol = 1e-4 if dtype in (np.float32, np.complex64) else 1e-12
+            lu = splu(csc_matrix(a.astype(dtype)))
+            b = rng.rand(n, 3).astype(dtype)
+            L, U = lu.L.A, lu.U.A
+            for lower, t in [(True, L), (False, U)]:
+                for trans, tt in [('N', t), ('T', t.T), ('H', t.conj().T)]:
+                    x = lu.solve_triangular(b, lower=lower, trans=trans)
+                    assert_allclose(tt.dot(x), b, rtol=rtol, atol=rtol)
+                    assert_allclose(lu.solve_triangular(b[:, 0], lower,
+                                                        trans),
+                                    x[:, 0], rtol=rtol, atol=rtol)
+
+            y = lu.solve_triangular(b[np.argsort(lu.perm_r)])
+            x = lu.solve_triangular(y, lower=False)[lu.perm_c]
+            assert_allclose(x, lu.solve(b), rtol=rtol, atol=rtol)
+
+        assert_raises(ValueError, lu.solve_triangular, b[1:])
+        assert_raises(ValueError, lu.solve_triangular, b, trans='X')
+
+    def test_splu_threads(self):
+        n = 200
+        rng = random.RandomState(1234)
+        a = rng.rand(n, n)
+        a[a < 0.9] = 0
+        a += 4*eye(n)
+
+        for dtype in [np.float32, np.float64, np.complex64, np.complex128]:
+            a_ = csc_matrix(a.astype(dtype))
+            for factor in [splu, spilu]:
+                lu = factor(a_, panel_size=16)
+                for threads in [2, 4, -1]:
+                    lu2 = factor(a_, panel_size=16,
+                                 options=dict(Threads=threads))
+                    assert_array_equal(lu2.perm_r, lu.perm_r)
+                    assert_array_equal(lu2.perm_c, lu.perm_c)
+                    assert_array_equal(lu2.L.A, lu.L.A)
+                    assert_array_equal(lu2.U.A, lu.U.A)
+
+        assert_raises(ValueError, splu, a_, options=dict(Threads=0))
+
+    def test_solve_workers(self):
+        n = 50
+        rng = random.RandomState(1234)
+        a = rng.rand(n, n)
+        a[a < 0.9] = 0
+        a += 4*eye(n)
+
+        for dtype in [np.float32, np.float64, np.complex64, np.complex128]:
+            rtol = 1e-5 if dtype in (np.float32, np.complex64) else 1e-13
+            lu = splu(csc_matrix(a.astype(dtype)))
+            b = rng.rand(n, 100).astype(dtype)
+            for trans in ['N', 'T', 'H']:
+                x = lu.solve(b, trans)
+                for workers in [2, 3, -1]:
+                    assert_allclose(lu.solve(b, trans, workers=workers), x,
+                                    rtol=rtol, atol=rtol)
+                assert_allclose(lu.solve(b[:, :5], trans, workers=4),
+                                x[:, :5], rtol=rtol, atol=rtol)
+
+        assert_raises(ValueError, lu.solve, b, workers=0)
+
+    def test_solve_workers_levels(self):
+        n = 300
+        rng = random.RandomState(1234)
+        a = rng.rand(n, n)
+        a[a < 0.98] = 0
+        a += 4*eye(n)
+
+        for dtype in [np.float32, np.float64, np.complex64, np.complex128]:
+            rtol = 1e-4 if dtype in (np.float32, np.complex64) else 1e-12
+            a_ = csc_matrix(a.astype(dtype))
+            if np.iscomplexobj(a_):
+                a_ = a_ + 1j*a_
+            for lu in [splu(a_), spilu(a_, drop_tol=1e-2)]:
+                b = rng.rand(n, 3).astype(dtype)
+                for trans in ['N', 'T', 'H']:
+                    x = lu.solve(b, trans)
+                    assert_allclose(lu.solve(b, trans, workers=4), x,
+                                    rtol=rtol, atol=rtol)
+                    assert_allclose(lu.solve(b[:, 0], trans, workers=-1),
+                                    x[:, 0], rtol=rtol, atol=rtol)
+
+            # The schedules follow a refactorization
+            lu = splu(a_)
+            lu.solve(b, workers=2)
+            lu.refactor(2*a_.data)
+            assert_allclose(lu.solve(b, workers=2), lu.solve(b),
+                            rtol=rtol, atol=rtol)
+
+    def test_astype(self):
+        n = 40
+        rng = random.RandomState(1234)
+        a = rng.rand(n, n)
+        a[a < 0.9] = 0
+        a += 4*eye(n)
+
+        for dtype, dtype32 in [(np.float64, np.float32),
+                               (np.complex128, np.complex64)]:
+            a_ = csc_matrix(a.astype(dtype))
+            lu = splu(a_)
+            b = rng.rand(n).astype(dtype)
+            x = lu.solve(b)
+
+            lu32 = lu.astype(dtype32)
+            assert_equal(lu32.solve(b.astype(dtype32)).dtype, dtype32)
+            assert_allclose(lu32.solve(b.astype(dtype32)), x, rtol=1e-5)
+            assert_array_equal(lu32.perm_r, lu.perm_r)
+            assert_array_equal(lu32.perm_c, lu.perm_c)
+            assert_allclose(lu32.L.A, lu.L.A, rtol=1e-6, atol=1e-7)
+            assert_allclose(lu32.U.A, lu.U.A, rtol=1e-6, atol=1e-7)
+
+            # Back to full precision, and the same type
+            assert_allclose(lu32.astype(dtype).solve(b), x, rtol=1e-5)
+            assert_array_equal(lu.astype(dtype).solve(b), x)
+
+            # The copy can be refactored
+            lu32.refactor(2*a_.data.astype(dtype32))
+            assert_allclose(lu32.solve(b.astype(dtype32)), x/2, rtol=1e-5)
+            lu32.refactor(a_.data.astype(dtype32),
+                          fact='SamePattern_SameRowPerm')
+            assert_allclose(lu32.solve(b.astype(dtype32)), x, rtol=1e-5)
+
+        assert_raises(ValueError, lu.astype, np.float64)
+        assert_raises(ValueError, lu.astype, np.int32)
+
     @pytest.mark.skipif(not hasattr(sys, 'getrefcount'), reason="no sys.getrefcount")
     def test_lu_refcount(self):
         # Test that we are keeping track of the reference count with splu.
@@ -659,6 +873,23 @@ class TestSplu(object):
 
         assert_equal(len(oks), 20)
 
+    def test_factor_in_thread(self):
+        # The factors stay valid after the thread that computed them exits
+        n = 30
+        rng = random.RandomState(1234)
+        a = rng.rand(n, n)
+        a[a < 0.9] = 0
+        a += 4*eye(n)
+        lus = []
+
+        t = threading.Thread(target=lambda: lus.append(splu(csc_matrix(a))))
+        t.start()
+        t.join()
+
+        b = ones(n)
+        assert_almost_equal(dot(a, lus[0].solve(b)), b)
+        del lus[:]
+
 
 class TestSpsolveTriangular(object):
     def setup_method(self):
@@ -0,0 +1,82 @@
+c     Wrappers of the ARPACK reverse-communication routines for the
+c     compiled driver loop of _drivermodule.cxx. They take the index
+c     IWHICH (1-based) into the list of WHICH values below instead of
+c     WHICH itself, and solve standard problems (BMAT = 'I'), so that
+c     no character arguments need to be passed from C. All [sdcz]naupdw
+c     take RWORK, which only the complex routines use.
+
+      subroutine ssaupdw(ido, n, iwhich, nev, tol, resid, ncv, v, ldv,
+     &                   iparam, ipntr, workd, workl, lworkl, info)
+      integer ido, n, iwhich, nev, ncv, ldv, iparam(11), ipntr(11),
+     &        lworkl, info
+      real tol
+      real resid(*), v(*), workd(*), workl(*)
+      character*2 which(9)
+      data which /'LM', 'SM', 'LA', 'SA', 'BE', 'LR', 'SR', 'LI', 'SI'/
+      call ssaupd(ido, 'I', n, which(iwhich), nev, tol, resid, ncv, v,
+     &            ldv, iparam, ipntr, workd, workl, lworkl, info)
+      end
+
+      subroutine dsaupdw(ido, n, iwhich, nev, tol, resid, ncv, v, ldv,
+     &                   iparam, ipntr, workd, workl, lworkl, info)
+      integer ido, n, iwhich, nev, ncv, ldv, iparam(11), ipntr(11),
+     &        lworkl, info
+      double precision tol
+      double precision resid(*), v(*), workd(*), workl(*)
+      character*2 which(9)
+      data which /'LM', 'SM', 'LA', 'SA', 'BE', 'LR', 'SR', 'LI', 'SI'/
+      call dsaupd(ido, 'I', n, which(iwhich), nev, tol, resid, ncv, v,
+     &            ldv, iparam, ipntr, workd, workl, lworkl, info)
+      end
+
+      subroutine snaupdw(ido, n, iwhich, nev, tol, resid, ncv, v, ldv,
+     &                   iparam, ipntr, workd, workl, lworkl, rwork,
+     &                   info)
+      integer ido, n, iwhich, nev, ncv, ldv, iparam(11), ipntr(14),
+     &        lworkl, info
+      real tol, rwork(*)
+      real resid(*), v(*), workd(*), workl(*)
+      character*2 which(9)
+      data which /'LM', 'SM', 'LA', 'SA', 'BE', 'LR', 'SR', 'LI', 'SI'/
+      call snaupd(ido, 'I', n, which(iwhich), nev, tol, resid, ncv, v,
+     &            ldv, iparam, ipntr, workd, workl, lworkl, info)
+      end
+
+      subroutine dnaupdw(ido, n, iwhich, nev, tol, resid, ncv, v, ldv,
+     &                   iparam, ipntr, workd, workl, lworkl, rwork,
+     &                   info)
+      integer ido, n, iwhich, nev, ncv, ldv, iparam(11), ipntr(14),
+     &        lworkl, info
+      double precision tol, rwork(*)
+      double precision resid(*), v(*), workd(*), workl(*)
+      character*2 which(9)
+      data which /'LM', 'SM', 'LA', 'SA', 'BE', 'LR', 'SR', 'LI', 'SI'/
+      call dnaupd(ido, 'I', n, which(iwhich), nev, tol, resid, ncv, v,
+     &            ldv, iparam, ipntr, workd, workl, lworkl, info)
+      end
+
+      subroutine cnaupdw(ido, n, iwhich, nev, tol, resid, ncv, v, ldv,
+     &                   iparam, ipntr, workd, workl, lworkl, rwork,
+     &                   info)
+      integer ido, n, iwhich, nev, ncv, ldv, iparam(11), ipntr(14),
+     &        lworkl, info
+      real tol, rwork(*)
+      complex resid(*), v(*), workd(*), workl(*)
+      character*2 which(9)
+      data which /'LM', 'SM', 'LA', 'SA', 'BE', 'LR', 'SR', 'LI', 'SI'/
+      call cnaupd(ido, 'I', n, which(iwhich), nev, tol, resid, ncv, v,
+     &            ldv, iparam, ipntr, workd, workl, lworkl, rwork, info)
+      end
+
+      subroutine znaupdw(ido, n, iwhich, nev, tol, resid, ncv, v, ldv,
+     &                   iparam, ipntr, workd, workl, lworkl, rwork,
+     &                   info)
+      integer ido, n, iwhich, nev, ncv, ldv, iparam(11), ipntr(14),
+     &        lworkl, info
+      double precision tol, rwork(*)
+      complex*16 resid(*), v(*), workd(*), workl(*)
+      character*2 which(9)
+      data which /'LM', 'SM', 'LA', 'SA', 'BE', 'LR', 'SR', 'LI', 'SI'/
+      call znaupd(ido, 'I', n, which(iwhich), nev, tol, resid, ncv, v,
+     &            ldv, iparam, ipntr, workd, workl, lworkl, rwork, info)
+      end
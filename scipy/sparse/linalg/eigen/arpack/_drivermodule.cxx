@@ -0,0 +1,471 @@
+/*
+ * _driver module
+ *
+ * Compiled driver loop for the ARPACK reverse-communication routines, as
+ * run by iterate() in arpack.py for standard eigenvalue problems. The
+ * operator is either a CSR matrix, multiplied with the threaded kernels of
+ * sparsetools, or the inverse of a shifted matrix held by a SuperLU object,
+ * applied through the C interface of the _superlu module; either way no
+ * Python code runs in an iteration.
+ */
+
+#include <Python.h>
+
+#include <string.h>
+#include <new>
+#include <algorithm>
+
+#define PY_ARRAY_UNIQUE_SYMBOL _scipy_sparse_arpack_driver_ARRAY_API
+#include "numpy/arrayobject.h"
+#include "numpy/npy_3kcompat.h"
+
+#include "complex_ops.h"
+#include "csr.h"
+
+#include "_superlu_capi.h"
+
+#if defined(NO_APPEND_FORTRAN)
+#if defined(UPPERCASE_FORTRAN)
+#define F_FUNC(f,F) F
+#else
+#define F_FUNC(f,F) f
+#endif
+#else
+#if defined(UPPERCASE_FORTRAN)
+#define F_FUNC(f,F) F##_
+#else
+#define F_FUNC(f,F) f##_
+#endif
+#endif
+
+/* The wrappers of _aupd_wrap.f; tol and rwork are of the real type, the
+   other arrays of the type of the problem */
+extern "C" {
+
+typedef void saupd_t(int *ido, int *n, int *iwhich, int *nev, void *tol,
+                     void *resid, int *ncv, void *v, int *ldv, int *iparam,
+                     int *ipntr, void *workd, void *workl, int *lworkl,
+                     int *info);
+typedef void naupd_t(int *ido, int *n, int *iwhich, int *nev, void *tol,
+                     void *resid, int *ncv, void *v, int *ldv, int *iparam,
+                     int *ipntr, void *workd, void *workl, int *lworkl,
+                     void *rwork, int *info);
+
+extern saupd_t F_FUNC(ssaupdw,SSAUPDW), F_FUNC(dsaupdw,DSAUPDW);
+extern naupd_t F_FUNC(snaupdw,SNAUPDW), F_FUNC(dnaupdw,DNAUPDW),
+    F_FUNC(cnaupdw,CNAUPDW), F_FUNC(znaupdw,ZNAUPDW);
+
+}
+
+typedef struct {
+    int n;
+    const void *indptr;
+    const void *indices;
+    const void *data;
+} csr_t;
+
+typedef void matvec_t(const csr_t *A, const void *x, void *y, int workers);
+
+/* y = A*x */
+template <class I, class T>
+static void matvec(const csr_t *A, const void *x, void *y, int workers)
+{
+    T *Yx = (T *)y;
+
+    std::fill(Yx, Yx + A->n, T(0));
+    csr_matvec_threaded<I, T>((I)A->n, (I)A->n, (const I *)A->indptr,
+                              (const I *)A->indices, (const T *)A->data,
+                              (const T *)x, Yx, (I)workers);
+}
+
+typedef struct {
+    int typenum;
+    int realtype;               /* type of tol and rwork */
+    size_t elsize;
+    saupd_t *saupd;             /* NULL for complex types */
+    naupd_t *naupd;
+    matvec_t *matvec32, *matvec64;
+} driver_type;
+
+static const driver_type driver_types[] = {
+    {NPY_FLOAT, NPY_FLOAT, sizeof(float),
+     F_FUNC(ssaupdw,SSAUPDW), F_FUNC(snaupdw,SNAUPDW),
+     matvec<npy_int32, float>, matvec<npy_int64, float>},
+    {NPY_DOUBLE, NPY_DOUBLE, sizeof(double),
+     F_FUNC(dsaupdw,DSAUPDW), F_FUNC(dnaupdw,DNAUPDW),
+     matvec<npy_int32, double>, matvec<npy_int64, double>},
+    {NPY_CFLOAT, NPY_FLOAT, sizeof(npy_cfloat),
+     NULL, F_FUNC(cnaupdw,CNAUPDW),
+     matvec<npy_int32, npy_cfloat_wrapper>,
+     matvec<npy_int64, npy_cfloat_wrapper>},
+    {NPY_CDOUBLE, NPY_DOUBLE, sizeof(npy_cdouble),
+     NULL, F_FUNC(znaupdw,ZNAUPDW),
+     matvec<npy_int32, npy_cdouble_wrapper>,
+     matvec<npy_int64, npy_cdouble_wrapper>},
+};
+
+/* The operator of the iteration: A, or inv(A - sigma*I) if lu is set */
+typedef struct {
+    csr_t A;
+    matvec_t *matvec;
+    PyObject *lu;
+    int workers;
+} op_t;
+
+/* The arguments of [sd]saupd and [sdcz]naupd that the loop passes on */
+typedef struct {
+    int symmetric, n, iwhich, nev, ncv, lworkl;
+    void *tol, *resid, *v, *workd, *workl, *rwork;
+    int *iparam, *ipntr, *info;
+} aupd_args;
+
+static superlu_capi_t *superlu_api = NULL;
+
+enum {
+    DRIVE_OK,
+    DRIVE_ERROR,                /* exception set by the SuperLU object */
+    DRIVE_NO_MEMORY,
+    DRIVE_SHIFTS                /* ARPACK asked for user shifts */
+};
+
+/*
+ * The loop of iterate(). Only a SuperLU operator touches Python, so that
+ * the GIL can be released otherwise.
+ */
+static int drive(const driver_type *t, const op_t *op, aupd_args *a)
+{
+    int ido = 0, ldv = a->n;
+    char *workd = (char *)a->workd, *x, *y, *src;
+
+    for (;;) {
+        if (a->symmetric) {
+            t->saupd(&ido, &a->n, &a->iwhich, &a->nev, a->tol, a->resid,
+                     &a->ncv, a->v, &ldv, a->iparam, a->ipntr, a->workd,
+                     a->workl, &a->lworkl, a->info);
+        }
+        else {
+            t->naupd(&ido, &a->n, &a->iwhich, &a->nev, a->tol, a->resid,
+                     &a->ncv, a->v, &ldv, a->iparam, a->ipntr, a->workd,
+                     a->workl, &a->lworkl, a->rwork, a->info);
+        }
+        x = workd + (a->ipntr[0] - 1) * t->elsize;
+        y = workd + (a->ipntr[1] - 1) * t->elsize;
+
+        if (ido == -1 || ido == 1) {
+            if (op->lu != NULL) {
+                /* on ido == 1 the shift-invert modes take B*x, which is
+                   a copy of x for standard problems */
+                src = ido == 1 ? workd + (a->ipntr[2] - 1) * t->elsize : x;
+                memmove(y, src, a->n * t->elsize);
+                if (superlu_api->solve(op->lu, y)) {
+                    return DRIVE_ERROR;
+                }
+            }
+            else {
+                try {
+                    op->matvec(&op->A, x, y, op->workers);
+                }
+                catch (const std::bad_alloc &) {
+                    return DRIVE_NO_MEMORY;
+                }
+            }
+        }
+        else if (ido == 2) {
+            memmove(y, x, a->n * t->elsize);
+        }
+        else if (ido == 3) {
+            return DRIVE_SHIFTS;
+        }
+        else {
+            return DRIVE_OK;
+        }
+    }
+}
+
+
+/*
+ * Python interface
+ */
+
+static int check_array(PyArrayObject *a, int typenum, int ndim,
+                       npy_intp len, const char *name)
+{
+    if (PyArray_NDIM(a) != ndim || PyArray_TYPE(a) != typenum ||
+        !PyArray_IS_F_CONTIGUOUS(a) || !PyArray_ISWRITEABLE(a) ||
+        PyArray_DIM(a, 0) < len) {
+        PyErr_Format(PyExc_ValueError,
+                     "%s must be a writeable contiguous array of the "
+                     "expected type and size", name);
+        return -1;
+    }
+    return 0;
+}
+
+/* Checks the CSR matrix, which is not checked elsewhere before the loop
+   reads it */
+template <class I>
+static int check_csr(int n, PyArrayObject *indptr, PyArrayObject *indices,
+                     PyArrayObject *data)
+{
+    const I *Ap = (const I *)PyArray_DATA(indptr);
+    const I *Aj = (const I *)PyArray_DATA(indices);
+    npy_intp k, nnz = Ap[n];
+
+    if (Ap[0] != 0 || nnz > PyArray_DIM(indices, 0) ||
+        nnz > PyArray_DIM(data, 0)) {
+        return -1;
+    }
+    for (k = 0; k < n; ++k) {
+        if (Ap[k + 1] < Ap[k]) {
+            return -1;
+        }
+    }
+    for (k = 0; k < nnz; ++k) {
+        if (Aj[k] < 0 || Aj[k] >= n) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int get_csr(PyObject *obj, const driver_type *t, int n, op_t *op)
+{
+    PyArrayObject *indptr, *indices, *data;
+    int index_type, status;
+
+    if (!PyArg_ParseTuple(obj, "O!O!O!;op must be (indptr, indices, data) "
+                          "or a SuperLU object", &PyArray_Type, &indptr,
+                          &PyArray_Type, &indices, &PyArray_Type, &data)) {
+        return -1;
+    }
+    index_type = PyArray_TYPE(indptr);
+    if (index_type != NPY_INT32 && index_type != NPY_INT64) {
+        PyErr_SetString(PyExc_ValueError, "unsupported index type");
+        return -1;
+    }
+    if (PyArray_NDIM(indptr) != 1 || !PyArray_IS_C_CONTIGUOUS(indptr) ||
+        PyArray_DIM(indptr, 0) < n + 1 ||
+        PyArray_NDIM(indices) != 1 || !PyArray_IS_C_CONTIGUOUS(indices) ||
+        PyArray_TYPE(indices) != index_type ||
+        PyArray_NDIM(data) != 1 || !PyArray_IS_C_CONTIGUOUS(data) ||
+        PyArray_TYPE(data) != t->typenum) {
+        PyErr_SetString(PyExc_ValueError, "invalid CSR matrix");
+        return -1;
+    }
+    if (index_type == NPY_INT32) {
+        status = check_csr<npy_int32>(n, indptr, indices, data);
+        op->matvec = t->matvec32;
+    }
+    else {
+        status = check_csr<npy_int64>(n, indptr, indices, data);
+        op->matvec = t->matvec64;
+    }
+    if (status) {
+        PyErr_SetString(PyExc_ValueError, "invalid CSR matrix");
+        return -1;
+    }
+    op->A.n = n;
+    op->A.indptr = PyArray_DATA(indptr);
+    op->A.indices = PyArray_DATA(indices);
+    op->A.data = PyArray_DATA(data);
+    return 0;
+}
+
+static char aupd_doc[] =
+"aupd(symmetric, which, nev, tol, resid, v, iparam, ipntr, workd, workl,\n\
+     rwork, info, op, workers)\n\
+\n\
+Runs [sd]saupd (symmetric) or [sdcz]naupd until it has converged or\n\
+failed, for the standard eigenvalue problem of op, which is either the\n\
+CSR matrix (indptr, indices, data), multiplied on up to workers threads,\n\
+or a SuperLU object with the factors of A - sigma*I, for the shift-invert\n\
+mode. which is the index of the which argument in 'LM', 'SM', 'LA',\n\
+'SA', 'BE', 'LR', 'SR', 'LI', 'SI'. resid, v (Fortran order), iparam and\n\
+ipntr (of C ints) are updated in place as by the routines.\n\
+\n\
+Returns (tol, info).";
+
+static PyObject *Py_aupd(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    static const char *kwlist[] = { "symmetric", "which", "nev", "tol",
+                                    "resid", "v", "iparam", "ipntr",
+                                    "workd", "workl", "rwork", "info", "op",
+                                    "workers", NULL };
+    int symmetric, which, nev, info, workers, typenum, k, status;
+    double tol;
+    PyArrayObject *resid, *v, *iparam, *ipntr, *workd, *workl;
+    PyObject *rwork, *op_obj;
+    const driver_type *t = NULL;
+    op_t op = { { 0, NULL, NULL, NULL }, NULL, NULL, 1 };
+    aupd_args a;
+    union {
+        float f;
+        double d;
+    } tol_value;
+    PyThreadState *save = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "iiidO!O!O!O!O!O!OiOi",
+                                     (char **)kwlist, &symmetric, &which,
+                                     &nev, &tol, &PyArray_Type, &resid,
+                                     &PyArray_Type, &v, &PyArray_Type,
+                                     &iparam, &PyArray_Type, &ipntr,
+                                     &PyArray_Type, &workd, &PyArray_Type,
+                                     &workl, &rwork, &info, &op_obj,
+                                     &workers)) {
+        return NULL;
+    }
+
+    typenum = PyArray_TYPE(resid);
+    for (k = 0; k < 4; ++k) {
+        if (driver_types[k].typenum == typenum) {
+            t = &driver_types[k];
+        }
+    }
+    if (t == NULL || (symmetric && t->saupd == NULL)) {
+        PyErr_SetString(PyExc_ValueError, "unsupported data type");
+        return NULL;
+    }
+    if (which < 0 || which >= 9) {
+        PyErr_SetString(PyExc_ValueError, "which out of range");
+        return NULL;
+    }
+    if (PyArray_NDIM(resid) != 1 || PyArray_DIM(resid, 0) < 1 ||
+        PyArray_DIM(resid, 0) > NPY_MAX_INT / 3) {
+        PyErr_SetString(PyExc_ValueError, "resid must be a vector");
+        return NULL;
+    }
+
+    a.symmetric = symmetric;
+    a.n = (int)PyArray_DIM(resid, 0);
+    a.iwhich = which + 1;
+    a.nev = nev;
+    a.ncv = PyArray_NDIM(v) == 2 ? (int)PyArray_DIM(v, 1) : 0;
+    a.lworkl = (int)PyArray_DIM(workl, 0);
+    if (check_array(resid, typenum, 1, a.n, "resid") ||
+        check_array(v, typenum, 2, a.n, "v") ||
+        check_array(iparam, NPY_INT, 1, 11, "iparam") ||
+        check_array(ipntr, NPY_INT, 1, symmetric ? 11 : 14, "ipntr") ||
+        check_array(workd, typenum, 1, 3 * (npy_intp)a.n, "workd") ||
+        check_array(workl, typenum, 1, 0, "workl")) {
+        return NULL;
+    }
+    if (PyArray_DIM(v, 0) != a.n || a.ncv < 1 || a.ncv > a.n) {
+        PyErr_SetString(PyExc_ValueError, "v must be n by ncv");
+        return NULL;
+    }
+    if (t->realtype != typenum) {
+        if (!PyArray_Check(rwork) ||
+            check_array((PyArrayObject *)rwork, t->realtype, 1, a.ncv,
+                        "rwork")) {
+            PyErr_SetString(PyExc_ValueError,
+                            "rwork must be a real vector of length ncv");
+            return NULL;
+        }
+        a.rwork = PyArray_DATA((PyArrayObject *)rwork);
+    }
+    else {
+        a.rwork = NULL;
+    }
+    a.resid = PyArray_DATA(resid);
+    a.v = PyArray_DATA(v);
+    a.iparam = (int *)PyArray_DATA(iparam);
+    a.ipntr = (int *)PyArray_DATA(ipntr);
+    a.workd = PyArray_DATA(workd);
+    a.workl = PyArray_DATA(workl);
+    a.info = &info;
+    if (t->realtype == NPY_FLOAT) {
+        tol_value.f = (float)tol;
+    }
+    else {
+        tol_value.d = tol;
+    }
+    a.tol = &tol_value;
+
+    if (PyTuple_Check(op_obj)) {
+        if (get_csr(op_obj, t, a.n, &op)) {
+            return NULL;
+        }
+    }
+    else {
+        if (superlu_api == NULL) {
+            superlu_api = (superlu_capi_t *)PyCapsule_Import(SUPERLU_CAPI_NAME,
+                                                            0);
+            if (superlu_api == NULL) {
+                return NULL;
+            }
+        }
+        if (!superlu_api->usable(op_obj, typenum, a.n)) {
+            PyErr_SetString(PyExc_ValueError,
+                            "op must be (indptr, indices, data) or a "
+                            "SuperLU object of the type and size of resid");
+            return NULL;
+        }
+        op.lu = op_obj;
+    }
+    op.workers = workers > 1 ? workers : 1;
+
+    /* SuperLU objects are applied with the GIL held */
+    if (op.lu == NULL) {
+        save = PyEval_SaveThread();
+    }
+    status = drive(t, &op, &a);
+    if (save != NULL) {
+        PyEval_RestoreThread(save);
+    }
+
+    switch (status) {
+    case DRIVE_ERROR:
+        return NULL;
+    case DRIVE_NO_MEMORY:
+        return PyErr_NoMemory();
+    case DRIVE_SHIFTS:
+        PyErr_SetString(PyExc_ValueError,
+                        "ARPACK requested user shifts.  Assure ISHIFT==0");
+        return NULL;
+    }
+
+    tol = t->realtype == NPY_FLOAT ? tol_value.f : tol_value.d;
+    return Py_BuildValue("di", tol, info);
+}
+
+
+/*
+ * Main _driver module
+ */
+
+static PyMethodDef driver_methods[] = {
+    {"aupd", (PyCFunction) Py_aupd, METH_VARARGS | METH_KEYWORDS, aupd_doc},
+    {NULL, NULL}
+};
+
+#if PY_VERSION_HEX >= 0x03000000
+
+static struct PyModuleDef moduledef = {
+    PyModuleDef_HEAD_INIT,
+    "_driver",
+    NULL,
+    -1,
+    driver_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+PyMODINIT_FUNC PyInit__driver(void)
+{
+    import_array();
+
+    return PyModule_Create(&moduledef);
+}
+
+#else
+
+PyMODINIT_FUNC init_driver(void)
+{
+    import_array();
+
+    Py_InitModule("_driver", driver_methods);
+}
+
+#endif
@@ -42,11 +42,16 @@ __docformat__ = "restructuredtext en"
 
 __all__ = ['eigs', 'eigsh', 'svds', 'ArpackError', 'ArpackNoConvergence']
 
-from . import _arpack
+from . import _arpack, _driver
 import numpy as np
 import warnings
-from scipy.sparse.linalg.interface import aslinearoperator, LinearOperator
-from scipy.sparse import eye, issparse, isspmatrix, isspmatrix_csr
+import threading
+import weakref
+from scipy.sparse.linalg.interface import (aslinearoperator, LinearOperator,
+                                          MatrixLinearOperator)
+from scipy.sparse import (eye, issparse, isspmatrix, isspmatrix_csr,
+                          isspmatrix_csc)
+from scipy.sparse._workers import _workers
 from scipy.linalg import eig, eigh, lu_factor, lu_solve
 from scipy.sparse.sputils import isdense
 from scipy.sparse.linalg import gmres, splu
@@ -270,6 +275,9 @@ _SEUPD_WHICH = ['LM', 'SM', 'LA', 'SA', 'BE']
 # accepted values of parameter WHICH in _NAUPD
 _NEUPD_WHICH = ['LM', 'SM', 'LR', 'SR', 'LI', 'SI']
 
+# values of WHICH, in the order of the index taken by _driver.aupd
+_DRIVER_WHICH = ['LM', 'SM', 'LA', 'SA', 'BE', 'LR', 'SR', 'LI', 'SI']
+
 
 class ArpackError(RuntimeError):
     """
@@ -375,8 +383,65 @@ class _ArpackParams(object):
             k_ok = 0
         raise ArpackNoConvergence(msg % (num_iter, k_ok, self.k), ev, vec)
 
+    def _driver_operator(self):
+        # The operator of a standard problem in the form taken by
+        # _driver.aupd: the arrays of a CSR matrix in mode 1, or the
+        # SuperLU object of [A - sigma*I]^-1 in mode 3. None if the
+        # iteration has to run in Python.
+        if self.bmat != 'I':
+            return None
+        if self.mode == 1:
+            op = getattr(self.OP, '__self__', None)
+            if (isinstance(op, MatrixLinearOperator) and
+                    isspmatrix_csr(op.A) and op.A.dtype.char == self.tp):
+                return (op.A.indptr, op.A.indices, op.A.data)
+        elif self.mode == 3:
+            op = getattr(self.Minv_matvec, '__self__', None)
+            if isinstance(op, SpLuInv) and op.dtype.char == self.tp:
+                return op.M_lu
+        return None
+
+    def run(self):
+        """Iterate until convergence
+
+        Standard problems given by a CSR matrix, or by the sparse LU
+        factorization of the shift-invert mode, are iterated in compiled
+        code by _driver.aupd, with the matrix products on up to
+        ``scipy.sparse.get_workers()`` threads. Everything else goes
+        through iterate().
+        """
+        op = self._driver_operator()
+        if (op is None or self.ido != 0 or
+                not np.can_cast(self.resid.dtype, self.tp, 'same_kind')):
+            while not self.converged:
+                self.iterate()
+            return
+
+        self.resid = np.ascontiguousarray(self.resid, dtype=self.tp)
+        self.v = np.asfortranarray(self.v)
+        self.iparam = self.iparam.astype(np.intc)
+        self.ipntr = self.ipntr.astype(np.intc)
+        self.tol, self.info = _driver.aupd(self._symmetric,
+                                           _DRIVER_WHICH.index(self.which),
+                                           self.k, self.tol, self.resid,
+                                           self.v, self.iparam, self.ipntr,
+                                           self.workd, self.workl,
+                                           getattr(self, 'rwork', None),
+                                           self.info, op, _workers(None))
+        self.ido = 99
+        self.converged = True
+
+        if self.info == 0:
+            pass
+        elif self.info == 1:
+            self._raise_no_convergence()
+        else:
+            raise ArpackError(self.info, infodict=self.iterate_infodict)
+
 
 class _SymmetricArpackParams(_ArpackParams):
+    _symmetric = True
+
     def __init__(self, n, k, tp, matvec, mode=1, M_matvec=None,
                  Minv_matvec=None, sigma=None,
                  ncv=None, v0=None, maxiter=None, which="LM", tol=0):
@@ -461,6 +526,7 @@ class _SymmetricArpackParams(_ArpackParams):
             if Minv_matvec is None:
                 raise ValueError("Minv_matvec must be specified for mode=3")
 
+            self.Minv_matvec = Minv_matvec
             if M_matvec is None:
                 self.OP = Minv_matvec
                 self.OPa = Minv_matvec
@@ -595,6 +661,8 @@ class _SymmetricArpackParams(_ArpackParams):
 
 
 class _UnsymmetricArpackParams(_ArpackParams):
+    _symmetric = False
+
     def __init__(self, n, k, tp, matvec, mode=1, M_matvec=None,
                  Minv_matvec=None, sigma=None,
                  ncv=None, v0=None, maxiter=None, which="LM", tol=0):
@@ -665,6 +733,7 @@ class _UnsymmetricArpackParams(_ArpackParams):
                                  "for mode in (3,4)")
 
             self.matvec = matvec
+            self.Minv_matvec = Minv_matvec
             if tp in 'DF':  # complex type
                 if mode == 3:
                     self.OPa = Minv_matvec
@@ -898,6 +967,85 @@ def _aslinearoperator_with_dtype(m):
     return m
 
 
+# Sparse LU factorizations of recent SpLuInv objects, most recently used
+# last, for reuse by shift-invert calls with the same shifted matrix
+_SPLU_CACHE = []
+_SPLU_CACHE_SIZE = 4
+_SPLU_CACHE_LOCK = threading.Lock()
+
+
+class _SpLuCacheEntry(object):
+    def __init__(self, M, lu):
+        self.shape = M.shape
+        self.dtype = M.dtype
+        self.indptr = M.indptr.copy()
+        self.indices = M.indices.copy()
+        self.data = M.data.copy()
+        self.lu = lu
+        # SpLuInv objects using lu, which may not be refactored under them
+        self.users = weakref.WeakSet()
+
+    def same_pattern(self, M):
+        return (self.shape == M.shape and self.dtype == M.dtype and
+                np.array_equal(self.indptr, M.indptr) and
+                np.array_equal(self.indices, M.indices))
+
+
+def _cached_splu(M, user):
+    """
+    splu(M) for the SpLuInv object user, reusing recent factorizations
+
+    A factorization of the same CSC matrix is shared. One of a matrix with
+    the same sparsity pattern that no SpLuInv uses any more is refactored
+    with the values of M (SuperLU.refactor), which keeps its column
+    ordering and symbolic analysis, so that repeated eigs and eigsh calls
+    with the same sigma, or with a matrix whose values changed, do not
+    factor from scratch.
+    """
+    if not isspmatrix_csc(M):
+        return splu(M)
+    if not M.has_canonical_format:
+        M = M.copy()
+        M.sum_duplicates()
+
+    reuse = None
+    with _SPLU_CACHE_LOCK:
+        for entry in _SPLU_CACHE[::-1]:
+            if not entry.same_pattern(M):
+                continue
+            if np.array_equal(entry.data, M.data):
+                # most recently used last
+                _SPLU_CACHE.remove(entry)
+                _SPLU_CACHE.append(entry)
+                entry.users.add(user)
+                return entry.lu
+            if reuse is None and len(entry.users) == 0:
+                reuse = entry
+
+        # taken out of the cache while it is refactored
+        if reuse is not None:
+            _SPLU_CACHE.remove(reuse)
+
+    entry = None
+    if reuse is not None:
+        try:
+            reuse.lu.refactor(M.data)
+        except (RuntimeError, ValueError):
+            # e.g. a singular matrix; splu below raises the error
+            pass
+        else:
+            entry = reuse
+            entry.data = M.data.copy()
+    if entry is None:
+        entry = _SpLuCacheEntry(M, splu(M))
+
+    with _SPLU_CACHE_LOCK:
+        _SPLU_CACHE.append(entry)
+        del _SPLU_CACHE[:-_SPLU_CACHE_SIZE]
+        entry.users.add(user)
+    return entry.lu
+
+
 class SpLuInv(LinearOperator):
     """
     SpLuInv:
@@ -905,7 +1053,7 @@ class SpLuInv(LinearOperator):
        using a sparse LU-decopposition of M
     """
     def __init__(self, M):
-        self.M_lu = splu(M)
+        self.M_lu = _cached_splu(M, self)
         self.shape = M.shape
         self.dtype = M.dtype
         self.isreal = not np.issubdtype(self.dtype, np.complexfloating)
@@ -1213,6 +1361,15 @@ def eigs(A, k=6, M=None, sigma=None, which='LM', v0=None,
     ZNEUPD, functions which use the Implicitly Restarted Arnoldi Method to
     find the eigenvalues and eigenvectors [2]_.
 
+    Standard problems (``M=None``) run their iteration in compiled code when
+    `A` is a CSR matrix of the type of the problem and `sigma` is None, in
+    which case the products with `A` use up to
+    `scipy.sparse.get_workers` threads, or when `sigma` is given for a
+    sparse `A` with neither `OPinv` nor a complex shift of a real `A`. The
+    sparse LU factorization of the shift-invert mode is kept for reuse: a
+    later call with the same shifted matrix uses it as is, and one with the
+    same sparsity pattern only redoes its numerical factorization.
+
     References
     ----------
     .. [1] ARPACK Software, http://www.caam.rice.edu/software/ARPACK/
@@ -1328,8 +1485,7 @@ def eigs(A, k=6, M=None, sigma=None, which='LM', v0=None,
                                       ncv, v0, maxiter, which, tol)
 
     with _ARPACK_LOCK:
-        while not params.converged:
-            params.iterate()
+        params.run()
 
         return params.extract(return_eigenvectors)
 
@@ -1512,6 +1668,15 @@ def eigsh(A, k=6, M=None, sigma=None, which='LM', v0=None,
     functions which use the Implicitly Restarted Lanczos Method to
     find the eigenvalues and eigenvectors [2]_.
 
+    Standard problems (``M=None``) run their iteration in compiled code when
+    `A` is a CSR matrix of the type of the problem and `sigma` is None, in
+    which case the products with `A` use up to
+    `scipy.sparse.get_workers` threads, or when `sigma` is given for a
+    sparse `A` in the normal mode without `OPinv`. The sparse LU
+    factorization of the shift-invert mode is kept for reuse: a later call
+    with the same shifted matrix uses it as is, and one with the same
+    sparsity pattern only redoes its numerical factorization.
+
     References
     ----------
     .. [1] ARPACK Software, http://www.caam.rice.edu/software/ARPACK/
@@ -1663,8 +1828,7 @@ def eigsh(A, k=6, M=None, sigma=None, which='LM', v0=None,
                                     ncv, v0, maxiter, which, tol)
 
     with _ARPACK_LOCK:
-        while not params.converged:
-            params.iterate()
+        params.run()
 
         return params.extract(return_eigenvectors)
 
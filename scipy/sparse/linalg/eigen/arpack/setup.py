@@ -7,6 +7,7 @@ def configuration(parent_package='',top_path=None):
     from scipy._build_utils.system_info import get_info, NotFoundError
     from numpy.distutils.misc_util import Configuration
     from scipy._build_utils import get_g77_abi_wrappers
+    from scipy._build_utils.compiler_helper import set_cxx_threads_flags_hook
 
     lapack_opt = get_info('lapack_opt')
 
@@ -16,6 +17,7 @@ def configuration(parent_package='',top_path=None):
     arpack_sources.extend([join('ARPACK','UTIL', '*.f')])
 
     arpack_sources += get_g77_abi_wrappers(lapack_opt)
+    arpack_sources += ['_aupd_wrap.f']
 
     config.add_library('arpack_scipy', sources=arpack_sources,
                        include_dirs=[join('ARPACK', 'SRC')])
@@ -28,6 +30,22 @@ def configuration(parent_package='',top_path=None):
                          depends=arpack_sources,
                          )
 
+    # compiled driver loop, multiplying with the sparsetools kernels and
+    # applying SuperLU objects through the C interface of the _superlu
+    # module
+    sparsetools_dir = join('..', '..', '..', 'sparsetools')
+    dsolve_dir = join('..', '..', 'dsolve')
+    ext = config.add_extension('_driver',
+                               sources=['_drivermodule.cxx'],
+                               libraries=['arpack_scipy'],
+                               include_dirs=[sparsetools_dir, dsolve_dir],
+                               extra_info=lapack_opt,
+                               depends=(arpack_sources +
+                                        [join(sparsetools_dir, 'csr.h'),
+                                         join(sparsetools_dir, 'parallel.h'),
+                                         join(dsolve_dir, '_superlu_capi.h')]))
+    ext._pre_build_hook = set_cxx_threads_flags_hook
+
     config.add_data_dir('tests')
 
     # Add license files
@@ -11,7 +11,7 @@ import threading
 import numpy as np
 
 from numpy.testing import (assert_allclose, assert_array_almost_equal_nulp,
-                           assert_equal, assert_array_equal)
+                           assert_equal, assert_array_equal, assert_)
 from pytest import raises as assert_raises
 import pytest
 
@@ -963,3 +963,88 @@ def test_eigsh_for_k_greater():
         # Test 'A' for different types
         assert_raises(TypeError, eigsh, aslinearoperator(A), k=4)
         assert_raises(TypeError, eigsh, A_sparse, M=M_dense, k=4)
+
+
+def _driver_test_matrix(n, dtype, symmetric, rng):
+    A = rng.rand(n, n)
+    A[A < 0.95] = 0
+    if dtype in 'FD':
+        A = A + 1j * A.T
+    if symmetric:
+        A = A + A.T.conj()
+    A = A + np.diag(np.arange(1, n + 1))
+    return csr_matrix(A.astype(dtype))
+
+
+@pytest.mark.parametrize('symmetric, dtype',
+                         [(True, 'f'), (True, 'd'),
+                          (False, 'f'), (False, 'd'), (False, 'F'),
+                          (False, 'D')])
+@pytest.mark.parametrize('sigma', [None, 10.5])
+def test_driver_loop(symmetric, dtype, sigma, monkeypatch):
+    # Standard problems with a CSR matrix, or with the sparse LU
+    # factorization of the shift-invert mode, run in the compiled loop of
+    # _driver and give the results of the Python loop, which runs for a
+    # LinearOperator
+    from scipy.sparse import set_workers
+    from scipy.sparse.linalg import splu
+
+    rng = np.random.RandomState(1234)
+    n = 100
+    A = _driver_test_matrix(n, dtype, symmetric, rng)
+    v0 = rng.rand(n).astype(dtype)
+    rtol = 1e-4 if dtype in 'fF' else 1e-10
+    solver = eigsh if symmetric else eigs
+
+    calls = []
+    aupd = arpack._driver.aupd
+
+    def counting_aupd(*args):
+        calls.append(args)
+        return aupd(*args)
+
+    monkeypatch.setattr(arpack._driver, 'aupd', counting_aupd)
+
+    if sigma is None:
+        A_op = LinearOperator(A.shape, matvec=A.dot, dtype=A.dtype)
+        expected = solver(A_op, k=4, v0=v0, return_eigenvectors=False)
+        with set_workers(4):
+            w, v = solver(A, k=4, v0=v0)
+        assert_allclose(A.dot(v), v * w, rtol=0, atol=rtol * n)
+    else:
+        lu = splu(csc_matrix(A - sigma * np.eye(n, dtype=dtype)))
+        OPinv = LinearOperator(A.shape, matvec=lu.solve, dtype=A.dtype)
+        expected = solver(A, k=4, sigma=sigma, v0=v0, OPinv=OPinv,
+                          return_eigenvectors=False)
+        w = solver(A, k=4, sigma=sigma, v0=v0, return_eigenvectors=False)
+    assert_equal(len(calls), 1)
+    assert_allclose(np.sort_complex(w), np.sort_complex(expected),
+                    rtol=rtol)
+
+
+def test_shift_invert_factorization_reuse():
+    rng = np.random.RandomState(1234)
+    n = 100
+    A = _driver_test_matrix(n, 'd', True, rng)
+
+    w1 = eigsh(A, k=4, sigma=10.5, return_eigenvectors=False)
+    lu = arpack._SPLU_CACHE[-1].lu
+
+    # the same shifted matrix reuses the factorization
+    w2 = eigsh(A, k=4, sigma=10.5, return_eigenvectors=False)
+    assert_(arpack._SPLU_CACHE[-1].lu is lu)
+    assert_allclose(w2, w1, rtol=1e-10)
+
+    # one with the same pattern refactors it
+    w3 = eigsh(2 * A, k=4, sigma=21, return_eigenvectors=False)
+    assert_(arpack._SPLU_CACHE[-1].lu is lu)
+    assert_allclose(w3, 2 * w1, rtol=1e-10)
+
+    # a factorization in use is not refactored under its user
+    OPinv = arpack.SpLuInv(csc_matrix(A - 10.5 * np.eye(n)))
+    w4 = eigsh(3 * A, k=4, sigma=31.5, return_eigenvectors=False)
+    assert_(OPinv.M_lu is not arpack._SPLU_CACHE[-1].lu)
+    assert_allclose(w4, 3 * w1, rtol=1e-10)
+    x = rng.rand(n)
+    y = OPinv.matvec(x)
+    assert_allclose(A.dot(y) - 10.5 * y, x, rtol=1e-10)
@@ -0,0 +1,86 @@
+c     Wrappers of the BLAS and LAPACK routines called by the compiled
+c     iteration of _coremodule.cxx, which keeps its blocks of vectors
+c     in row-major order. They fix the character arguments, so that
+c     none need to be passed from C. ITRA and ITRB of [sd]gemmw are 0
+c     for 'N' and 1 for 'T'.
+
+      subroutine sgemmw(itra, itrb, m, n, k, alpha, a, lda, b, ldb,
+     &                  beta, c, ldc)
+      integer itra, itrb, m, n, k, lda, ldb, ldc
+      real alpha, beta
+      real a(*), b(*), c(*)
+      character tr(2)
+      data tr /'N', 'T'/
+      call sgemm(tr(itra + 1), tr(itrb + 1), m, n, k, alpha, a, lda,
+     &           b, ldb, beta, c, ldc)
+      end
+
+      subroutine dgemmw(itra, itrb, m, n, k, alpha, a, lda, b, ldb,
+     &                  beta, c, ldc)
+      integer itra, itrb, m, n, k, lda, ldb, ldc
+      double precision alpha, beta
+      double precision a(*), b(*), c(*)
+      character tr(2)
+      data tr /'N', 'T'/
+      call dgemm(tr(itra + 1), tr(itrb + 1), m, n, k, alpha, a, lda,
+     &           b, ldb, beta, c, ldc)
+      end
+
+c     Cholesky-QR of the M by N matrix V (the transpose of a block of N
+c     vectors of length M): computes the factor U of V*V**T = U**T*U in
+c     the upper triangle of G (LDG = M) and overwrites V with
+c     U**(-T)*V. INFO is that of [sd]potrf.
+
+      subroutine scholqrw(m, n, v, g, info)
+      integer m, n, info
+      real v(m, *), g(m, *)
+      call ssyrk('U', 'N', m, n, 1.0, v, m, 0.0, g, m)
+      call spotrf('U', m, g, m, info)
+      if (info .eq. 0) then
+         call strsm('L', 'U', 'T', 'N', m, n, 1.0, g, m, v, m)
+      end if
+      end
+
+      subroutine dcholqrw(m, n, v, g, info)
+      integer m, n, info
+      double precision v(m, *), g(m, *)
+      call dsyrk('U', 'N', m, n, 1.0d0, v, m, 0.0d0, g, m)
+      call dpotrf('U', m, g, m, info)
+      if (info .eq. 0) then
+         call dtrsm('L', 'U', 'T', 'N', m, n, 1.0d0, g, m, v, m)
+      end if
+      end
+
+c     Overwrites the M by N matrix V with U**(-T)*V, U as left in G by
+c     [sd]cholqrw.
+
+      subroutine strsmw(m, n, g, v)
+      integer m, n
+      real g(m, *), v(m, *)
+      call strsm('L', 'U', 'T', 'N', m, n, 1.0, g, m, v, m)
+      end
+
+      subroutine dtrsmw(m, n, g, v)
+      integer m, n
+      double precision g(m, *), v(m, *)
+      call dtrsm('L', 'U', 'T', 'N', m, n, 1.0d0, g, m, v, m)
+      end
+
+c     All eigenvalues and eigenvectors of the symmetric-definite pencil
+c     (A, B) of order N, from the lower triangles, as by eigh(A, B).
+
+      subroutine ssygvdw(n, a, b, w, work, lwork, iwork, liwork, info)
+      integer n, lwork, liwork, info
+      integer iwork(*)
+      real a(n, *), b(n, *), w(*), work(*)
+      call ssygvd(1, 'V', 'L', n, a, n, b, n, w, work, lwork, iwork,
+     &            liwork, info)
+      end
+
+      subroutine dsygvdw(n, a, b, w, work, lwork, iwork, liwork, info)
+      integer n, lwork, liwork, info
+      integer iwork(*)
+      double precision a(n, *), b(n, *), w(*), work(*)
+      call dsygvd(1, 'V', 'L', n, a, n, b, n, w, work, lwork, iwork,
+     &            liwork, info)
+      end
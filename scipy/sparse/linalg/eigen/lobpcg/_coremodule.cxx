@@ -0,0 +1,693 @@
+/*
+ * _core module
+ *
+ * Compiled iteration of lobpcg() for standard eigenvalue problems of a CSR
+ * matrix A, optionally preconditioned by a CSR matrix M. The blocks of
+ * vectors are kept in row-major workspaces allocated once for the whole
+ * run; the sparse products go through the tiled, threaded block kernel of
+ * sparsetools, and everything else through BLAS-3 and LAPACK: Cholesky-QR
+ * (syrk, potrf, trsm) for the orthonormalization and sygvd for the
+ * Rayleigh-Ritz step. No Python code runs in an iteration.
+ */
+
+#include <Python.h>
+
+#include <string.h>
+#include <math.h>
+#include <new>
+#include <vector>
+#include <algorithm>
+
+#define PY_ARRAY_UNIQUE_SYMBOL _scipy_sparse_lobpcg_core_ARRAY_API
+#include "numpy/arrayobject.h"
+#include "numpy/npy_3kcompat.h"
+
+#include "complex_ops.h"
+#include "csr.h"
+
+#if defined(NO_APPEND_FORTRAN)
+#if defined(UPPERCASE_FORTRAN)
+#define F_FUNC(f,F) F
+#else
+#define F_FUNC(f,F) f
+#endif
+#else
+#if defined(UPPERCASE_FORTRAN)
+#define F_FUNC(f,F) F##_
+#else
+#define F_FUNC(f,F) f##_
+#endif
+#endif
+
+/* The wrappers of _core_wrap.f */
+extern "C" {
+
+void F_FUNC(sgemmw,SGEMMW)(int *itra, int *itrb, int *m, int *n, int *k,
+                           float *alpha, const float *a, int *lda,
+                           const float *b, int *ldb, float *beta, float *c,
+                           int *ldc);
+void F_FUNC(dgemmw,DGEMMW)(int *itra, int *itrb, int *m, int *n, int *k,
+                           double *alpha, const double *a, int *lda,
+                           const double *b, int *ldb, double *beta,
+                           double *c, int *ldc);
+void F_FUNC(scholqrw,SCHOLQRW)(int *m, int *n, float *v, float *g,
+                               int *info);
+void F_FUNC(dcholqrw,DCHOLQRW)(int *m, int *n, double *v, double *g,
+                               int *info);
+void F_FUNC(strsmw,STRSMW)(int *m, int *n, const float *g, float *v);
+void F_FUNC(dtrsmw,DTRSMW)(int *m, int *n, const double *g, double *v);
+void F_FUNC(ssygvdw,SSYGVDW)(int *n, float *a, float *b, float *w,
+                             float *work, int *lwork, int *iwork,
+                             int *liwork, int *info);
+void F_FUNC(dsygvdw,DSYGVDW)(int *n, double *a, double *b, double *w,
+                             double *work, int *lwork, int *iwork,
+                             int *liwork, int *info);
+
+}
+
+template <class T> struct lapack;
+
+template <> struct lapack<float> {
+    static void gemm(int ta, int tb, int m, int n, int k, float alpha,
+                     const float *a, int lda, const float *b, int ldb,
+                     float beta, float *c, int ldc)
+    {
+        F_FUNC(sgemmw,SGEMMW)(&ta, &tb, &m, &n, &k, &alpha, a, &lda, b,
+                              &ldb, &beta, c, &ldc);
+    }
+    static void cholqr(int m, int n, float *v, float *g, int *info)
+    {
+        F_FUNC(scholqrw,SCHOLQRW)(&m, &n, v, g, info);
+    }
+    static void trsm(int m, int n, const float *g, float *v)
+    {
+        F_FUNC(strsmw,STRSMW)(&m, &n, g, v);
+    }
+    static void sygvd(int n, float *a, float *b, float *w, float *work,
+                      int lwork, int *iwork, int liwork, int *info)
+    {
+        F_FUNC(ssygvdw,SSYGVDW)(&n, a, b, w, work, &lwork, iwork, &liwork,
+                                info);
+    }
+};
+
+template <> struct lapack<double> {
+    static void gemm(int ta, int tb, int m, int n, int k, double alpha,
+                     const double *a, int lda, const double *b, int ldb,
+                     double beta, double *c, int ldc)
+    {
+        F_FUNC(dgemmw,DGEMMW)(&ta, &tb, &m, &n, &k, &alpha, a, &lda, b,
+                              &ldb, &beta, c, &ldc);
+    }
+    static void cholqr(int m, int n, double *v, double *g, int *info)
+    {
+        F_FUNC(dcholqrw,DCHOLQRW)(&m, &n, v, g, info);
+    }
+    static void trsm(int m, int n, const double *g, double *v)
+    {
+        F_FUNC(dtrsmw,DTRSMW)(&m, &n, g, v);
+    }
+    static void sygvd(int n, double *a, double *b, double *w, double *work,
+                      int lwork, int *iwork, int liwork, int *info)
+    {
+        F_FUNC(dsygvdw,DSYGVDW)(&n, a, b, w, work, &lwork, iwork, &liwork,
+                                info);
+    }
+};
+
+/*
+ * C = op(A)*op(B) + beta*C for row-major matrices, with op(A) of M rows
+ * and op(B) of N columns, computed as the column-major product
+ * C**T = op(B)**T*op(A)**T.
+ */
+template <class T>
+static void gemm_rm(int ta, int tb, int m, int n, int k, const T *a,
+                    int lda, const T *b, int ldb, T beta, T *c, int ldc)
+{
+    if (m == 0 || n == 0) {
+        return;
+    }
+    lapack<T>::gemm(tb, ta, n, m, k, T(1), b, ldb, a, lda, beta, c, ldc);
+}
+
+typedef struct {
+    npy_intp n;
+    int index_type;             /* NPY_INT32 or NPY_INT64 */
+    const void *indptr;
+    const void *indices;
+    const void *data;
+} csr_t;
+
+/* Y = A*X for row-major blocks of k vectors */
+template <class I, class T>
+static void spmm(const csr_t *A, int k, const T *x, T *y, int workers)
+{
+    std::fill(y, y + A->n * k, T(0));
+    csr_matvecs_tiled<I, T>((I)A->n, (I)A->n, (I)k, (const I *)A->indptr,
+                            (const I *)A->indices, (const T *)A->data,
+                            (I)0, x, y, (I)workers);
+}
+
+template <class T>
+static void spmm(const csr_t *A, int k, const T *x, T *y, int workers)
+{
+    if (A->index_type == NPY_INT32) {
+        spmm<npy_int32, T>(A, k, x, y, workers);
+    }
+    else {
+        spmm<npy_int64, T>(A, k, x, y, workers);
+    }
+}
+
+/* Calls f(r0, r1) on ranges of the n rows of blocks of k vectors */
+template <class F>
+static void for_rows(npy_intp n, int k, int workers, const F &f)
+{
+    const npy_intp n_chunks = parallel_num_chunks(workers, n * k);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        f(n * c / n_chunks, n * (c + 1) / n_chunks);
+    });
+}
+
+/* Copies the columns of the n by k block src marked in active to the
+   n by m block dst */
+template <class T>
+static void pack(npy_intp n, int k, int m, const char *active, const T *src,
+                 T *dst, int workers)
+{
+    for_rows(n, k, workers, [&](npy_intp r0, npy_intp r1) {
+        for (npy_intp i = r0; i < r1; ++i) {
+            const T *s = src + i * k;
+            T *d = dst + i * m;
+            for (int j = 0; j < k; ++j) {
+                if (active[j]) {
+                    *d++ = s[j];
+                }
+            }
+        }
+    });
+}
+
+typedef struct {
+    const csr_t *A, *M;         /* M is NULL without preconditioning */
+    npy_intp n;
+    int k, maxiter, largest, workers;
+    double tol;
+} problem_t;
+
+enum {
+    CORE_OK,
+    CORE_NOT_PD_R,              /* Cholesky-QR of the residuals failed */
+    CORE_NOT_PD_P,              /* Cholesky-QR of the directions failed */
+    CORE_NOT_CONVERGED,         /* sygvd did not converge */
+    CORE_NOT_PD_GRAM_B          /* the Gram matrix of B is not definite */
+};
+
+/*
+ * The main loop of lobpcg() for B = None and Y = None. X, AX and lambda
+ * hold the initial Ritz pairs on entry and the final ones on exit. Row j
+ * of lambda_hist and resid_hist gets the j-th entry of the lambda and
+ * residual norm histories of the loop; their numbers of rows are returned
+ * in *n_lambda and *n_resid. On failure *info is the LAPACK info, or the
+ * order of the leading minor of the Gram matrix of B that is not positive
+ * definite.
+ */
+template <class T>
+static int iterate(const problem_t *pb, T *X_out, T *AX_out, T *lambda,
+                   T *lambda_hist, T *resid_hist, int *n_lambda,
+                   int *n_resid, int *info)
+{
+    const npy_intp n = pb->n;
+    const int k = pb->k, s_max = 3 * k;
+    const npy_intp nk = n * k;
+    const int lwork = 1 + 6 * s_max + 2 * s_max * s_max;
+    const int liwork = 3 + 5 * s_max;
+
+    /* workspaces, each of n by k entries, reused across iterations;
+       the active blocks are packed with m <= k columns */
+    std::vector<T> buf(9 * nk);
+    T *X = &buf[0], *AX = X + nk, *R = AX + nk, *W = R + nk;
+    T *AW = W + nk, *P = AW + nk, *AP = P + nk, *Pa = AP + nk;
+    T *APa = Pa + nk;
+
+    std::vector<T> gram_a(s_max * s_max), gram_b(s_max * s_max);
+    std::vector<T> gram(8 * k * k), chol(k * k), w(s_max), E(s_max * k);
+    std::vector<T> work(lwork);
+    std::vector<int> iwork(liwork);
+    std::vector<char> active(k, 1);
+    std::vector<double> norms(k);
+    std::vector<double> partial;
+
+    memcpy(X, X_out, nk * sizeof(T));
+    memcpy(AX, AX_out, nk * sizeof(T));
+    *n_lambda = 0;
+    *n_resid = 0;
+
+    for (int iter = 0; iter <= pb->maxiter; ++iter) {
+        /* residuals R = AX - X*diag(lambda) and their norms */
+        const npy_intp n_chunks = parallel_num_chunks(pb->workers, nk);
+        partial.assign(n_chunks * k, 0.0);
+        parallel_for_chunks(n_chunks, [&](npy_intp c) {
+            double *sum = &partial[c * k];
+            for (npy_intp i = n * c / n_chunks; i < n * (c + 1) / n_chunks;
+                 ++i) {
+                for (int j = 0; j < k; ++j) {
+                    const T r = AX[i * k + j] - X[i * k + j] * lambda[j];
+                    R[i * k + j] = r;
+                    sum[j] += (double)r * r;
+                }
+            }
+        });
+        std::fill(norms.begin(), norms.end(), 0.0);
+        for (npy_intp c = 0; c < n_chunks; ++c) {
+            for (int j = 0; j < k; ++j) {
+                norms[j] += partial[c * k + j];
+            }
+        }
+
+        int m = 0;
+        for (int j = 0; j < k; ++j) {
+            const T norm = (T)sqrt(norms[j]);
+            resid_hist[iter * k + j] = norm;
+            active[j] = active[j] && norm > pb->tol;
+            m += active[j];
+        }
+        ++*n_resid;
+        if (m == 0) {
+            break;
+        }
+
+        /* preconditioned, orthonormalized active residuals W and A*W */
+        pack(n, k, m, &active[0], R, W, pb->workers);
+        if (pb->M != NULL) {
+            spmm(pb->M, m, W, AW, pb->workers);
+            std::swap(W, AW);
+        }
+        lapack<T>::cholqr(m, (int)n, W, &chol[0], info);
+        if (*info != 0) {
+            return CORE_NOT_PD_R;
+        }
+        spmm(pb->A, m, W, AW, pb->workers);
+
+        /* active search directions, orthonormalized, and A times them */
+        if (iter > 0) {
+            pack(n, k, m, &active[0], P, Pa, pb->workers);
+            pack(n, k, m, &active[0], AP, APa, pb->workers);
+            lapack<T>::cholqr(m, (int)n, Pa, &chol[0], info);
+            if (*info != 0) {
+                return CORE_NOT_PD_P;
+            }
+            lapack<T>::trsm(m, (int)n, &chol[0], APa);
+        }
+
+        /* Gram matrices of the Rayleigh-Ritz step */
+        T *xaw = &gram[0], *waw = xaw + k * m, *xbw = waw + m * m;
+        T *xap = xbw + k * m, *wap = xap + k * m, *pap = wap + m * m;
+        T *xbp = pap + m * m, *wbp = xbp + k * m;
+        const int s = iter > 0 ? k + 2 * m : k + m;
+
+        gemm_rm(1, 0, k, m, (int)n, X, k, AW, m, T(0), xaw, m);
+        gemm_rm(1, 0, m, m, (int)n, W, m, AW, m, T(0), waw, m);
+        gemm_rm(1, 0, k, m, (int)n, X, k, W, m, T(0), xbw, m);
+        if (iter > 0) {
+            gemm_rm(1, 0, k, m, (int)n, X, k, APa, m, T(0), xap, m);
+            gemm_rm(1, 0, m, m, (int)n, W, m, APa, m, T(0), wap, m);
+            gemm_rm(1, 0, m, m, (int)n, Pa, m, APa, m, T(0), pap, m);
+            gemm_rm(1, 0, k, m, (int)n, X, k, Pa, m, T(0), xbp, m);
+            gemm_rm(1, 0, m, m, (int)n, W, m, Pa, m, T(0), wbp, m);
+        }
+
+        /* assembled in column-major order, each block (i, j) below the
+           diagonal the transpose of block (j, i) as in lobpcg() */
+        T *ga = &gram_a[0], *gb = &gram_b[0];
+        std::fill(ga, ga + s * s, T(0));
+        std::fill(gb, gb + s * s, T(0));
+        for (int i = 0; i < k; ++i) {
+            ga[i + i * s] = lambda[i];
+            gb[i + i * s] = T(1);
+        }
+        for (int i = 0; i < m; ++i) {
+            gb[(k + i) + (k + i) * s] = T(1);
+            for (int j = 0; j < m; ++j) {
+                ga[(k + i) + (k + j) * s] = waw[i * m + j];
+            }
+        }
+        for (int i = 0; i < k; ++i) {
+            for (int j = 0; j < m; ++j) {
+                ga[i + (k + j) * s] = ga[(k + j) + i * s] = xaw[i * m + j];
+                gb[i + (k + j) * s] = gb[(k + j) + i * s] = xbw[i * m + j];
+            }
+        }
+        if (iter > 0) {
+            const int p0 = k + m;
+            for (int i = 0; i < m; ++i) {
+                gb[(p0 + i) + (p0 + i) * s] = T(1);
+                for (int j = 0; j < m; ++j) {
+                    ga[(p0 + i) + (p0 + j) * s] = pap[i * m + j];
+                    ga[(k + i) + (p0 + j) * s] = ga[(p0 + j) + (k + i) * s]
+                        = wap[i * m + j];
+                    gb[(k + i) + (p0 + j) * s] = gb[(p0 + j) + (k + i) * s]
+                        = wbp[i * m + j];
+                }
+            }
+            for (int i = 0; i < k; ++i) {
+                for (int j = 0; j < m; ++j) {
+                    ga[i + (p0 + j) * s] = ga[(p0 + j) + i * s]
+                        = xap[i * m + j];
+                    gb[i + (p0 + j) * s] = gb[(p0 + j) + i * s]
+                        = xbp[i * m + j];
+                }
+            }
+        }
+
+        lapack<T>::sygvd(s, ga, gb, &w[0], &work[0], lwork, &iwork[0],
+                         liwork, info);
+        if (*info > s) {
+            *info -= s;
+            return CORE_NOT_PD_GRAM_B;
+        }
+        else if (*info != 0) {
+            return CORE_NOT_CONVERGED;
+        }
+
+        /* the k wanted Ritz pairs, eigenvalues ascending from sygvd;
+           E is row-major, s by k */
+        for (int j = 0; j < k; ++j) {
+            const int c = pb->largest ? s - 1 - j : j;
+            lambda[j] = w[c];
+            lambda_hist[*n_lambda * k + j] = w[c];
+            for (int i = 0; i < s; ++i) {
+                E[i * k + j] = ga[i + c * s];
+            }
+        }
+        ++*n_lambda;
+
+        /* new directions P = W*E_w + P*E_p, AP likewise, and Ritz
+           vectors X = X*E_x + P, AX = AX*E_x + AP */
+        const T *Ex = &E[0], *Ew = Ex + k * k, *Ep = Ew + m * k;
+        gemm_rm(0, 0, (int)n, k, m, W, m, Ew, k, T(0), P, k);
+        gemm_rm(0, 0, (int)n, k, m, AW, m, Ew, k, T(0), AP, k);
+        if (iter > 0) {
+            gemm_rm(0, 0, (int)n, k, m, Pa, m, Ep, k, T(1), P, k);
+            gemm_rm(0, 0, (int)n, k, m, APa, m, Ep, k, T(1), AP, k);
+        }
+        memcpy(R, P, nk * sizeof(T));
+        gemm_rm(0, 0, (int)n, k, k, X, k, Ex, k, T(1), R, k);
+        std::swap(X, R);
+        memcpy(W, AP, nk * sizeof(T));
+        gemm_rm(0, 0, (int)n, k, k, AX, k, Ex, k, T(1), W, k);
+        std::swap(AX, W);
+    }
+
+    memcpy(X_out, X, nk * sizeof(T));
+    memcpy(AX_out, AX, nk * sizeof(T));
+    return CORE_OK;
+}
+
+
+/*
+ * Python interface
+ */
+
+/* Checks the CSR matrix, which is not checked elsewhere before the loop
+   reads it */
+template <class I>
+static int check_csr(npy_intp n, PyArrayObject *indptr,
+                     PyArrayObject *indices, PyArrayObject *data)
+{
+    const I *Ap = (const I *)PyArray_DATA(indptr);
+    const I *Aj = (const I *)PyArray_DATA(indices);
+    npy_intp k, nnz = Ap[n];
+
+    if (Ap[0] != 0 || nnz > PyArray_DIM(indices, 0) ||
+        nnz > PyArray_DIM(data, 0)) {
+        return -1;
+    }
+    for (k = 0; k < n; ++k) {
+        if (Ap[k + 1] < Ap[k]) {
+            return -1;
+        }
+    }
+    for (k = 0; k < nnz; ++k) {
+        if (Aj[k] < 0 || Aj[k] >= n) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int get_csr(PyObject *obj, int typenum, npy_intp n, csr_t *A,
+                   const char *name)
+{
+    PyArrayObject *indptr, *indices, *data;
+    int index_type, status;
+
+    if (!PyTuple_Check(obj) ||
+        !PyArg_ParseTuple(obj, "O!O!O!", &PyArray_Type, &indptr,
+                          &PyArray_Type, &indices, &PyArray_Type, &data)) {
+        PyErr_Clear();
+        PyErr_Format(PyExc_ValueError,
+                     "%s must be (indptr, indices, data)", name);
+        return -1;
+    }
+    index_type = PyArray_TYPE(indptr);
+    if ((index_type != NPY_INT32 && index_type != NPY_INT64) ||
+        PyArray_NDIM(indptr) != 1 || !PyArray_IS_C_CONTIGUOUS(indptr) ||
+        PyArray_DIM(indptr, 0) != n + 1 ||
+        PyArray_NDIM(indices) != 1 || !PyArray_IS_C_CONTIGUOUS(indices) ||
+        PyArray_TYPE(indices) != index_type ||
+        PyArray_NDIM(data) != 1 || !PyArray_IS_C_CONTIGUOUS(data) ||
+        PyArray_TYPE(data) != typenum) {
+        PyErr_Format(PyExc_ValueError, "invalid CSR matrix %s", name);
+        return -1;
+    }
+    if (index_type == NPY_INT32) {
+        status = check_csr<npy_int32>(n, indptr, indices, data);
+    }
+    else {
+        status = check_csr<npy_int64>(n, indptr, indices, data);
+    }
+    if (status) {
+        PyErr_Format(PyExc_ValueError, "invalid CSR matrix %s", name);
+        return -1;
+    }
+
+    A->n = n;
+    A->index_type = index_type;
+    A->indptr = PyArray_DATA(indptr);
+    A->indices = PyArray_DATA(indices);
+    A->data = PyArray_DATA(data);
+    return 0;
+}
+
+static int check_block(PyArrayObject *a, int typenum, npy_intp rows,
+                       npy_intp cols, const char *name)
+{
+    if (PyArray_NDIM(a) != 2 || PyArray_TYPE(a) != typenum ||
+        !PyArray_IS_C_CONTIGUOUS(a) || !PyArray_ISWRITEABLE(a) ||
+        PyArray_DIM(a, 0) != rows || PyArray_DIM(a, 1) != cols) {
+        PyErr_Format(PyExc_ValueError,
+                     "%s must be a writeable C-contiguous array of the "
+                     "expected type and shape", name);
+        return -1;
+    }
+    return 0;
+}
+
+static void set_linalg_error(const char *format, int value)
+{
+    PyObject *mod, *exc;
+
+    mod = PyImport_ImportModule("numpy.linalg");
+    if (mod == NULL) {
+        return;
+    }
+    exc = PyObject_GetAttrString(mod, "LinAlgError");
+    Py_DECREF(mod);
+    if (exc == NULL) {
+        return;
+    }
+    PyErr_Format(exc, format, value);
+    Py_DECREF(exc);
+}
+
+static char iterate_doc[] =
+"iterate(A, M, X, AX, lambda_, lambda_hist, resid_hist, tol, largest,\n\
+        workers)\n\
+\n\
+Runs the main loop of lobpcg() for the standard eigenvalue problem of the\n\
+CSR matrix A = (indptr, indices, data), preconditioned by the CSR matrix\n\
+M unless it is None, with the sparse products on up to workers threads.\n\
+X, AX (n by k, C order) and lambda_ hold the initial Ritz pairs and are\n\
+overwritten with the final ones. The lambda and residual norm histories\n\
+of the loop go to the rows of lambda_hist and resid_hist, each of\n\
+maxiter + 1 rows for at most maxiter + 1 iterations. Real types only.\n\
+\n\
+Returns the numbers of rows filled in lambda_hist and resid_hist.";
+
+static PyObject *Py_iterate(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    static const char *kwlist[] = { "A", "M", "X", "AX", "lambda_",
+                                    "lambda_hist", "resid_hist", "tol",
+                                    "largest", "workers", NULL };
+    PyObject *A_obj, *M_obj;
+    PyArrayObject *X, *AX, *lambda, *lambda_hist, *resid_hist;
+    double tol;
+    int largest, workers, typenum, status = CORE_OK, info = 0;
+    int n_lambda = 0, n_resid = 0, no_memory = 0;
+    csr_t A, M;
+    problem_t pb;
+    PyThreadState *save;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOO!O!O!O!O!dii",
+                                     (char **)kwlist, &A_obj, &M_obj,
+                                     &PyArray_Type, &X, &PyArray_Type, &AX,
+                                     &PyArray_Type, &lambda, &PyArray_Type,
+                                     &lambda_hist, &PyArray_Type,
+                                     &resid_hist, &tol, &largest,
+                                     &workers)) {
+        return NULL;
+    }
+
+    typenum = PyArray_TYPE(X);
+    if (typenum != NPY_FLOAT && typenum != NPY_DOUBLE) {
+        PyErr_SetString(PyExc_ValueError, "unsupported data type");
+        return NULL;
+    }
+    if (PyArray_NDIM(X) != 2 || PyArray_DIM(X, 1) < 1 ||
+        PyArray_DIM(X, 0) < 3 * PyArray_DIM(X, 1) ||
+        PyArray_DIM(X, 0) > NPY_MAX_INT) {
+        PyErr_SetString(PyExc_ValueError, "X must be n by k, 3*k <= n");
+        return NULL;
+    }
+    pb.n = PyArray_DIM(X, 0);
+    pb.k = (int)PyArray_DIM(X, 1);
+    pb.maxiter = (int)PyArray_DIM(lambda_hist, 0) - 1;
+    if (check_block(X, typenum, pb.n, pb.k, "X") ||
+        check_block(AX, typenum, pb.n, pb.k, "AX") ||
+        check_block(lambda_hist, typenum, pb.maxiter + 1, pb.k,
+                    "lambda_hist") ||
+        check_block(resid_hist, typenum, pb.maxiter + 1, pb.k,
+                    "resid_hist")) {
+        return NULL;
+    }
+    if (pb.maxiter < 0) {
+        PyErr_SetString(PyExc_ValueError, "empty histories");
+        return NULL;
+    }
+    if (PyArray_NDIM(lambda) != 1 || PyArray_TYPE(lambda) != typenum ||
+        !PyArray_IS_C_CONTIGUOUS(lambda) || !PyArray_ISWRITEABLE(lambda) ||
+        PyArray_DIM(lambda, 0) != pb.k) {
+        PyErr_SetString(PyExc_ValueError,
+                        "lambda_ must be a writeable vector of length k");
+        return NULL;
+    }
+    if (get_csr(A_obj, typenum, pb.n, &A, "A")) {
+        return NULL;
+    }
+    pb.A = &A;
+    pb.M = NULL;
+    if (M_obj != Py_None) {
+        if (get_csr(M_obj, typenum, pb.n, &M, "M")) {
+            return NULL;
+        }
+        pb.M = &M;
+    }
+    pb.largest = largest;
+    pb.workers = workers > 1 ? workers : 1;
+    pb.tol = tol;
+
+    save = PyEval_SaveThread();
+    try {
+        if (typenum == NPY_FLOAT) {
+            status = iterate<float>(
+                &pb, (float *)PyArray_DATA(X), (float *)PyArray_DATA(AX),
+                (float *)PyArray_DATA(lambda),
+                (float *)PyArray_DATA(lambda_hist),
+                (float *)PyArray_DATA(resid_hist), &n_lambda, &n_resid,
+                &info);
+        }
+        else {
+            status = iterate<double>(
+                &pb, (double *)PyArray_DATA(X), (double *)PyArray_DATA(AX),
+                (double *)PyArray_DATA(lambda),
+                (double *)PyArray_DATA(lambda_hist),
+                (double *)PyArray_DATA(resid_hist), &n_lambda, &n_resid,
+                &info);
+        }
+    }
+    catch (const std::bad_alloc &) {
+        no_memory = 1;
+    }
+    PyEval_RestoreThread(save);
+
+    if (no_memory) {
+        return PyErr_NoMemory();
+    }
+    switch (status) {
+    case CORE_NOT_PD_R:
+    case CORE_NOT_PD_P:
+        /* as raised by scipy.linalg.cholesky */
+        set_linalg_error("%d-th leading minor of the array is not "
+                         "positive definite", info);
+        return NULL;
+    case CORE_NOT_CONVERGED:
+        /* as raised by scipy.linalg.eigh */
+        set_linalg_error("internal fortran routine failed to converge: %i "
+                         "off-diagonal elements of an intermediate "
+                         "tridiagonal form did not converge to zero.", info);
+        return NULL;
+    case CORE_NOT_PD_GRAM_B:
+        set_linalg_error("the leading minor of order %i of 'b' is not "
+                         "positive definite. The factorization of 'b' could "
+                         "not be completed and no eigenvalues or "
+                         "eigenvectors were computed.", info);
+        return NULL;
+    }
+
+    return Py_BuildValue("ii", n_lambda, n_resid);
+}
+
+
+/*
+ * Main _core module
+ */
+
+static PyMethodDef core_methods[] = {
+    {"iterate", (PyCFunction) Py_iterate, METH_VARARGS | METH_KEYWORDS,
+     iterate_doc},
+    {NULL, NULL}
+};
+
+#if PY_VERSION_HEX >= 0x03000000
+
+static struct PyModuleDef moduledef = {
+    PyModuleDef_HEAD_INIT,
+    "_core",
+    NULL,
+    -1,
+    core_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+PyMODINIT_FUNC PyInit__core(void)
+{
+    import_array();
+
+    return PyModule_Create(&moduledef);
+}
+
+#else
+
+PyMODINIT_FUNC init_core(void)
+{
+    import_array();
+
+    Py_InitModule("_core", core_methods);
+}
+
+#endif
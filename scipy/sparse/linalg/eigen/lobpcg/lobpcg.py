@@ -21,8 +21,11 @@ from __future__ import division, print_function, absolute_import
 import numpy as np
 from scipy.linalg import (inv, eigh, cho_factor, cho_solve, cholesky,
                           LinAlgError)
+from scipy.sparse import isspmatrix, csr_matrix
 from scipy.sparse.linalg import aslinearoperator
 from scipy.sparse.sputils import bmat
+from scipy.sparse._workers import _workers
+from . import _core
 
 __all__ = ['lobpcg']
 
@@ -105,6 +108,51 @@ def _b_orthonormalize(B, blockVectorV, blockVectorBV=None, retInvR=False):
         return blockVectorV, blockVectorBV
 
 
+def _core_operators(A, B, M, blockVectorY, dtype, verbosityLevel):
+    """The arguments A and M of `_core.iterate`, or None if the main loop
+    has to run in Python."""
+    if (B is not None or blockVectorY is not None or verbosityLevel or
+            dtype not in (np.float32, np.float64)):
+        return None
+
+    operators = []
+    for op in (A, M):
+        if op is None:
+            operators.append(None)
+        elif isspmatrix(op) and np.can_cast(op.dtype, dtype):
+            op = csr_matrix(op, dtype=dtype)
+            operators.append((np.ascontiguousarray(op.indptr),
+                              np.ascontiguousarray(op.indices),
+                              np.ascontiguousarray(op.data)))
+        else:
+            return None
+    return operators
+
+
+def _iterate_core(operators, blockVectorX, blockVectorAX, _lambda,
+                  residualTolerance, maxIterations, largest,
+                  lambdaHistory, residualNormsHistory):
+    """Run the main loop of `lobpcg` in compiled code, appending to the
+    histories, and return the final `_lambda`, X and AX."""
+    A, M = operators
+    dtype = np.result_type(blockVectorX, blockVectorAX)
+    blockVectorX = np.array(blockVectorX, dtype=dtype, order='C')
+    blockVectorAX = np.array(blockVectorAX, dtype=dtype, order='C')
+    _lambda = np.array(_lambda, dtype=dtype)
+
+    shape = (maxIterations + 1, blockVectorX.shape[1])
+    lambdas = np.empty(shape, dtype=dtype)
+    residualNorms = np.empty(shape, dtype=dtype)
+    nLambdas, nResidualNorms = _core.iterate(A, M, blockVectorX,
+                                             blockVectorAX, _lambda,
+                                             lambdas, residualNorms,
+                                             residualTolerance, largest,
+                                             _workers(None))
+    lambdaHistory.extend(lambdas[:nLambdas])
+    residualNormsHistory.extend(residualNorms[:nResidualNorms])
+    return _lambda, blockVectorX, blockVectorAX
+
+
 def _get_indx(_lambda, num, largest):
     """Get `num` indices into `_lambda` depending on `largest` option."""
     ii = np.argsort(_lambda)
@@ -234,6 +282,13 @@ def lobpcg(A, X,
     it will most likely break internally, so the code tries to call
     the standard function instead.
 
+    Standard eigenproblems (no `B`, no `Y`) of a real sparse matrix `A`,
+    with no preconditioner or a sparse one, are iterated in compiled code
+    when `verbosityLevel` is 0: the blocks of vectors live in workspaces
+    allocated once, the products with `A` and `M` are computed a block at
+    a time on up to ``scipy.sparse.get_workers()`` threads, and the
+    orthonormalization is a Cholesky-QR done with level-3 BLAS.
+
     It is not that n should be large for the LOBPCG to work, but rather the
     ratio ``n``/``m`` should be large. It you call LOBPCG with ``m``=1
     and ``n``=10, it works though ``n`` is small. The method is intended
@@ -310,6 +365,7 @@ def lobpcg(A, X,
                 aux += "%d constraint\n\n" % sizeY
         print(aux)
 
+    A_input, M_input = A, M
     A = _makeOperator(A, (n, n))
     B = _makeOperator(B, (n, n))
     M = _makeOperator(M, (n, n))
@@ -401,6 +457,19 @@ def lobpcg(A, X,
     blockVectorBP = None
 
     iterationNumber = -1
+
+    core = None
+    if maxIterations >= 0:
+        core = _core_operators(A_input, B, M_input, blockVectorY,
+                               np.result_type(blockVectorX, blockVectorAX),
+                               verbosityLevel)
+    if core is not None:
+        _lambda, blockVectorX, blockVectorAX = _iterate_core(
+            core, blockVectorX, blockVectorAX, _lambda, residualTolerance,
+            maxIterations, largest, lambdaHistory, residualNormsHistory)
+        # skip the loop below
+        iterationNumber = maxIterations
+
     while iterationNumber < maxIterations:
         iterationNumber += 1
         if verbosityLevel > 0:
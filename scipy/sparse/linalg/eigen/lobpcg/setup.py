@@ -1,10 +1,30 @@
 from __future__ import division, print_function, absolute_import
 
+from os.path import join
+
 
 def configuration(parent_package='',top_path=None):
+    from scipy._build_utils.system_info import get_info
     from numpy.distutils.misc_util import Configuration
+    from scipy._build_utils.compiler_helper import set_cxx_threads_flags_hook
+
+    lapack_opt = get_info('lapack_opt')
 
     config = Configuration('lobpcg',parent_package,top_path)
+
+    # compiled main loop, multiplying with the sparsetools kernels
+    config.add_library('lobpcg_core_wrap', sources=['_core_wrap.f'])
+    sparsetools_dir = join('..', '..', '..', 'sparsetools')
+    ext = config.add_extension('_core',
+                               sources=['_coremodule.cxx'],
+                               libraries=['lobpcg_core_wrap'],
+                               include_dirs=[sparsetools_dir],
+                               extra_info=lapack_opt,
+                               depends=['_core_wrap.f',
+                                        join(sparsetools_dir, 'csr.h'),
+                                        join(sparsetools_dir, 'parallel.h')])
+    ext._pre_build_hook = set_cxx_threads_flags_hook
+
     config.add_data_dir('tests')
 
     return config
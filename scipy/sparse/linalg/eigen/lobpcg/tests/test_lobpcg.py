@@ -12,7 +12,7 @@ from scipy import ones, rand, r_, diag, linalg, eye
 from scipy.linalg import eig, eigh, toeplitz
 import scipy.sparse
 from scipy.sparse.linalg.eigen.lobpcg import lobpcg
-from scipy.sparse.linalg import eigs
+from scipy.sparse.linalg import eigs, aslinearoperator
 from scipy.sparse import spdiags
 
 import pytest
@@ -245,6 +245,55 @@ def test_eigs_consistency(n, atol):
     _check_eigen(A, lvals, lvecs, atol=atol, rtol=0)
     assert_allclose(np.sort(vals), np.sort(lvals), atol=1e-14)
 
+@pytest.mark.parametrize('largest', [True, False])
+@pytest.mark.parametrize('precond', [False, True])
+@pytest.mark.parametrize('workers', [1, 4])
+def test_compiled_loop(largest, precond, workers):
+    # Sparse standard problems run the main loop in compiled code, which
+    # must follow the Python loop (used for a LinearOperator A) closely.
+    n, m = 400, 4
+    vals = 1 + np.arange(n) ** 2 / float(n)
+    A = scipy.sparse.diags([vals, -np.ones(n-1), -np.ones(n-1)],
+                           [0, -1, 1], format='csr')
+    M = scipy.sparse.diags([1 / vals], [0]) if precond else None
+    np.random.seed(1234)
+    X = np.random.rand(n, m)
+
+    with scipy.sparse.set_workers(workers):
+        w, v, lh, rh = lobpcg(A, X.copy(), M=M, tol=1e-6, maxiter=15,
+                              largest=largest, retLambdaHistory=True,
+                              retResidualNormsHistory=True)
+    w0, v0, lh0, rh0 = lobpcg(aslinearoperator(A), X.copy(),
+                              M=None if M is None else aslinearoperator(M),
+                              tol=1e-6, maxiter=15, largest=largest,
+                              retLambdaHistory=True,
+                              retResidualNormsHistory=True)
+
+    assert_equal(len(lh), len(lh0))
+    assert_equal(len(rh), len(rh0))
+    assert_allclose(lh, lh0, rtol=1e-8)
+    assert_allclose(w, w0, rtol=1e-8)
+    assert_allclose(abs((v * v0).sum(axis=0)), 1, rtol=1e-6)
+    assert_allclose(rh, rh0, rtol=1e-3, atol=1e-10)
+
+
+def test_compiled_loop_float32():
+    # The first iterations in single precision follow those in double
+    n, m = 300, 3
+    vals = np.arange(1, n+1, dtype=np.float32)
+    A = scipy.sparse.diags([vals], [0], format='csr', dtype=np.float32)
+    np.random.seed(1234)
+    X = np.random.rand(n, m)
+
+    w, v, lh = lobpcg(A, X.astype(np.float32), maxiter=5,
+                      retLambdaHistory=True)
+    w0, v0, lh0 = lobpcg(A.astype(np.float64), X, maxiter=5,
+                         retLambdaHistory=True)
+    assert_equal(w.dtype, np.float32)
+    assert_equal(v.dtype, np.float32)
+    assert_allclose(lh, lh0, rtol=1e-4)
+
+
 def test_verbosity():
     """Check that nonzero verbosity level code runs.
     """
@@ -7,9 +7,12 @@ __all__ = ['bicg','bicgstab','cg','cgs','gmres','qmr']
 import warnings
 import numpy as np
 
-from . import _iterative
+from . import _iterative, _driver
 
-from scipy.sparse.linalg.interface import LinearOperator
+from scipy.sparse import isspmatrix, isspmatrix_csr
+from scipy.sparse.linalg.interface import (LinearOperator, IdentityOperator,
+                                           MatrixLinearOperator)
+from scipy.sparse.linalg.dsolve import SuperLU
 from .utils import make_system
 from scipy._lib._util import _aligned_zeros
 from scipy._lib._threadsafety import non_reentrant
@@ -54,11 +57,14 @@ tol, atol : float, optional
 maxiter : integer
     Maximum number of iterations.  Iteration will stop after maxiter
     steps even if the specified tolerance has not been achieved.
-M : {sparse matrix, dense matrix, LinearOperator}
+M : {sparse matrix, dense matrix, LinearOperator, SuperLU}
     Preconditioner for A.  The preconditioner should approximate the
     inverse of A.  Effective preconditioning dramatically improves the
     rate of convergence, which implies that fewer iterations are needed
-    to reach a given error tolerance.
+    to reach a given error tolerance.  A `SuperLU` object, e.g. from
+    `spilu`, is applied through its ``solve`` method.  If A is a CSR
+    matrix, M is None, a diagonal sparse matrix or a `SuperLU` object and
+    there is no callback, the whole iteration runs in compiled code.
 callback : function
     User-supplied function to call after each iteration.  It is called
     as callback(xk), where xk is the current solution vector.
@@ -118,6 +124,65 @@ def _get_atol(tol, atol, bnrm2, get_residual, routine_name):
         return max(float(atol), tol * float(bnrm2))
 
 
+def _driver_preconditioner(M, dtype):
+    """
+    The preconditioner `M` as taken by the compiled driver loops: None for
+    the identity, the diagonal of a diagonal sparse matrix, or a SuperLU
+    object, given as such or as ``LinearOperator(shape, lu.solve)``.
+    Returns False for any other preconditioner.
+    """
+    if isinstance(M, IdentityOperator):
+        return None
+
+    if isinstance(M, MatrixLinearOperator) and isspmatrix(M.A):
+        D = M.A.tocsr()
+        if not np.can_cast(D.dtype, dtype):
+            return False
+        rows = np.repeat(np.arange(D.shape[0]), np.diff(D.indptr))
+        if not np.array_equal(D.indices, rows):
+            return False
+        return np.ascontiguousarray(D.diagonal(), dtype=dtype)
+
+    solve = getattr(M, '_CustomLinearOperator__matvec_impl', None)
+    lu = getattr(solve, '__self__', None)
+    if isinstance(lu, SuperLU) and solve.__name__ == 'solve':
+        return lu
+
+    return False
+
+
+def _driver_solve(method, A, M, x, b, maxiter, atol, callback, restrt=0,
+                  ptol=0.0):
+    """
+    Run the whole iteration of `method` in compiled code, which avoids
+    calling back into Python in every step, if `A` is a CSR matrix, `M`
+    is the identity, diagonal or a SuperLU object and there is no
+    `callback`.
+
+    Returns ``(iter_, resid, info)`` as left by the Python loop, with `x`
+    updated in place, or None if the Python loop has to be used.
+    """
+    if callback is not None or len(x) == 0:
+        return None
+    if not (isinstance(A, MatrixLinearOperator) and isspmatrix_csr(A.A)):
+        return None
+
+    precond = _driver_preconditioner(M, x.dtype)
+    if precond is False:
+        return None
+
+    A = A.A
+    if max(A.shape[0], A.nnz, maxiter) > np.iinfo(np.intc).max:
+        return None
+    indptr = np.ascontiguousarray(A.indptr, dtype=np.intc)
+    indices = np.ascontiguousarray(A.indices, dtype=np.intc)
+    data = np.ascontiguousarray(A.data, dtype=x.dtype)
+    b = np.ascontiguousarray(b)
+
+    return _driver.solve(method, x, b, indptr, indices, data, precond,
+                         int(maxiter), atol, restrt, ptol)
+
+
 def set_docstring(header, Ainfo, footer='', atol_default='0'):
     def combine(fn):
         fn.__doc__ = '\n'.join((header, common_doc1,
@@ -231,32 +296,36 @@ def bicgstab(A, b, x0=None, tol=1e-5, maxiter=None, M=None, callback=None, atol=
     info = 0
     ftflag = True
     iter_ = maxiter
-    while True:
-        olditer = iter_
-        x, iter_, resid, info, ndx1, ndx2, sclr1, sclr2, ijob = \
-           revcom(b, x, work, iter_, resid, info, ndx1, ndx2, ijob)
-        if callback is not None and iter_ > olditer:
-            callback(x)
-        slice1 = slice(ndx1-1, ndx1-1+n)
-        slice2 = slice(ndx2-1, ndx2-1+n)
-        if (ijob == -1):
-            if callback is not None:
+    result = _driver_solve('bicgstab', A, M, x, b, maxiter, atol, callback)
+    if result is not None:
+        iter_, resid, info = result
+    else:
+        while True:
+            olditer = iter_
+            x, iter_, resid, info, ndx1, ndx2, sclr1, sclr2, ijob = \
+               revcom(b, x, work, iter_, resid, info, ndx1, ndx2, ijob)
+            if callback is not None and iter_ > olditer:
                 callback(x)
-            break
-        elif (ijob == 1):
-            work[slice2] *= sclr2
-            work[slice2] += sclr1*matvec(work[slice1])
-        elif (ijob == 2):
-            work[slice1] = psolve(work[slice2])
-        elif (ijob == 3):
-            work[slice2] *= sclr2
-            work[slice2] += sclr1*matvec(x)
-        elif (ijob == 4):
-            if ftflag:
-                info = -1
-                ftflag = False
-            resid, info = _stoptest(work[slice1], atol)
-        ijob = 2
+            slice1 = slice(ndx1-1, ndx1-1+n)
+            slice2 = slice(ndx2-1, ndx2-1+n)
+            if (ijob == -1):
+                if callback is not None:
+                    callback(x)
+                break
+            elif (ijob == 1):
+                work[slice2] *= sclr2
+                work[slice2] += sclr1*matvec(work[slice1])
+            elif (ijob == 2):
+                work[slice1] = psolve(work[slice2])
+            elif (ijob == 3):
+                work[slice2] *= sclr2
+                work[slice2] += sclr1*matvec(x)
+            elif (ijob == 4):
+                if ftflag:
+                    info = -1
+                    ftflag = False
+                resid, info = _stoptest(work[slice1], atol)
+            ijob = 2
 
     if info > 0 and iter_ == maxiter and not (resid <= atol):
         # info isn't set appropriately otherwise
@@ -298,37 +367,41 @@ def cg(A, b, x0=None, tol=1e-5, maxiter=None, M=None, callback=None, atol=None):
     info = 0
     ftflag = True
     iter_ = maxiter
-    while True:
-        olditer = iter_
-        x, iter_, resid, info, ndx1, ndx2, sclr1, sclr2, ijob = \
-           revcom(b, x, work, iter_, resid, info, ndx1, ndx2, ijob)
-        if callback is not None and iter_ > olditer:
-            callback(x)
-        slice1 = slice(ndx1-1, ndx1-1+n)
-        slice2 = slice(ndx2-1, ndx2-1+n)
-        if (ijob == -1):
-            if callback is not None:
+    result = _driver_solve('cg', A, M, x, b, maxiter, atol, callback)
+    if result is not None:
+        iter_, resid, info = result
+    else:
+        while True:
+            olditer = iter_
+            x, iter_, resid, info, ndx1, ndx2, sclr1, sclr2, ijob = \
+               revcom(b, x, work, iter_, resid, info, ndx1, ndx2, ijob)
+            if callback is not None and iter_ > olditer:
                 callback(x)
-            break
-        elif (ijob == 1):
-            work[slice2] *= sclr2
-            work[slice2] += sclr1*matvec(work[slice1])
-        elif (ijob == 2):
-            work[slice1] = psolve(work[slice2])
-        elif (ijob == 3):
-            work[slice2] *= sclr2
-            work[slice2] += sclr1*matvec(x)
-        elif (ijob == 4):
-            if ftflag:
-                info = -1
-                ftflag = False
-            resid, info = _stoptest(work[slice1], atol)
-            if info == 1 and iter_ > 1:
-                # recompute residual and recheck, to avoid
-                # accumulating rounding error
-                work[slice1] = b - matvec(x)
+            slice1 = slice(ndx1-1, ndx1-1+n)
+            slice2 = slice(ndx2-1, ndx2-1+n)
+            if (ijob == -1):
+                if callback is not None:
+                    callback(x)
+                break
+            elif (ijob == 1):
+                work[slice2] *= sclr2
+                work[slice2] += sclr1*matvec(work[slice1])
+            elif (ijob == 2):
+                work[slice1] = psolve(work[slice2])
+            elif (ijob == 3):
+                work[slice2] *= sclr2
+                work[slice2] += sclr1*matvec(x)
+            elif (ijob == 4):
+                if ftflag:
+                    info = -1
+                    ftflag = False
                 resid, info = _stoptest(work[slice1], atol)
-        ijob = 2
+                if info == 1 and iter_ > 1:
+                    # recompute residual and recheck, to avoid
+                    # accumulating rounding error
+                    work[slice1] = b - matvec(x)
+                    resid, info = _stoptest(work[slice1], atol)
+            ijob = 2
 
     if info > 0 and iter_ == maxiter and not (resid <= atol):
         # info isn't set appropriately otherwise
@@ -369,37 +442,41 @@ def cgs(A, b, x0=None, tol=1e-5, maxiter=None, M=None, callback=None, atol=None)
     info = 0
     ftflag = True
     iter_ = maxiter
-    while True:
-        olditer = iter_
-        x, iter_, resid, info, ndx1, ndx2, sclr1, sclr2, ijob = \
-           revcom(b, x, work, iter_, resid, info, ndx1, ndx2, ijob)
-        if callback is not None and iter_ > olditer:
-            callback(x)
-        slice1 = slice(ndx1-1, ndx1-1+n)
-        slice2 = slice(ndx2-1, ndx2-1+n)
-        if (ijob == -1):
-            if callback is not None:
+    result = _driver_solve('cgs', A, M, x, b, maxiter, atol, callback)
+    if result is not None:
+        iter_, resid, info = result
+    else:
+        while True:
+            olditer = iter_
+            x, iter_, resid, info, ndx1, ndx2, sclr1, sclr2, ijob = \
+               revcom(b, x, work, iter_, resid, info, ndx1, ndx2, ijob)
+            if callback is not None and iter_ > olditer:
                 callback(x)
-            break
-        elif (ijob == 1):
-            work[slice2] *= sclr2
-            work[slice2] += sclr1*matvec(work[slice1])
-        elif (ijob == 2):
-            work[slice1] = psolve(work[slice2])
-        elif (ijob == 3):
-            work[slice2] *= sclr2
-            work[slice2] += sclr1*matvec(x)
-        elif (ijob == 4):
-            if ftflag:
-                info = -1
-                ftflag = False
-            resid, info = _stoptest(work[slice1], atol)
-            if info == 1 and iter_ > 1:
-                # recompute residual and recheck, to avoid
-                # accumulating rounding error
-                work[slice1] = b - matvec(x)
+            slice1 = slice(ndx1-1, ndx1-1+n)
+            slice2 = slice(ndx2-1, ndx2-1+n)
+            if (ijob == -1):
+                if callback is not None:
+                    callback(x)
+                break
+            elif (ijob == 1):
+                work[slice2] *= sclr2
+                work[slice2] += sclr1*matvec(work[slice1])
+            elif (ijob == 2):
+                work[slice1] = psolve(work[slice2])
+            elif (ijob == 3):
+                work[slice2] *= sclr2
+                work[slice2] += sclr1*matvec(x)
+            elif (ijob == 4):
+                if ftflag:
+                    info = -1
+                    ftflag = False
                 resid, info = _stoptest(work[slice1], atol)
-        ijob = 2
+                if info == 1 and iter_ > 1:
+                    # recompute residual and recheck, to avoid
+                    # accumulating rounding error
+                    work[slice1] = b - matvec(x)
+                    resid, info = _stoptest(work[slice1], atol)
+            ijob = 2
 
     if info == -10:
         # termination due to breakdown: check for convergence
@@ -461,12 +538,16 @@ def gmres(A, b, x0=None, tol=1e-5, restart=None, maxiter=None, M=None, callback=
         Maximum number of iterations (restart cycles).  Iteration will stop
         after maxiter steps even if the specified tolerance has not been
         achieved.
-    M : {sparse matrix, dense matrix, LinearOperator}
+    M : {sparse matrix, dense matrix, LinearOperator, SuperLU}
         Inverse of the preconditioner of A.  M should approximate the
         inverse of A and be easy to solve for (see Notes).  Effective
         preconditioning dramatically improves the rate of convergence,
         which implies that fewer iterations are needed to reach a given
         error tolerance.  By default, no preconditioner is used.
+        A `SuperLU` object, e.g. from `spilu`, is applied through its
+        ``solve`` method.  If A is a CSR matrix, M is None, a diagonal
+        sparse matrix or a `SuperLU` object and there is no callback,
+        the whole iteration runs in compiled code.
     callback : function
         User-supplied function to call after each iteration.  It is called
         as callback(rk), where rk is the current residual vector.
@@ -553,57 +634,62 @@ def gmres(A, b, x0=None, tol=1e-5, restart=None, maxiter=None, M=None, callback=
     first_pass = True
     resid_ready = False
     iter_num = 1
-    while True:
-        x, iter_, presid, info, ndx1, ndx2, sclr1, sclr2, ijob = \
-           revcom(b, x, restrt, work, work2, iter_, presid, info, ndx1, ndx2, ijob, ptol)
-        slice1 = slice(ndx1-1, ndx1-1+n)
-        slice2 = slice(ndx2-1, ndx2-1+n)
-        if (ijob == -1):  # gmres success, update last residual
-            if resid_ready and callback is not None:
-                callback(presid / bnrm2)
-                resid_ready = False
-            break
-        elif (ijob == 1):
-            work[slice2] *= sclr2
-            work[slice2] += sclr1*matvec(x)
-        elif (ijob == 2):
-            work[slice1] = psolve(work[slice2])
-            if not first_pass and old_ijob == 3:
-                resid_ready = True
-
-            first_pass = False
-        elif (ijob == 3):
-            work[slice2] *= sclr2
-            work[slice2] += sclr1*matvec(work[slice1])
-            if resid_ready and callback is not None:
-                callback(presid / bnrm2)
-                resid_ready = False
-                iter_num = iter_num+1
-
-        elif (ijob == 4):
-            if ftflag:
-                info = -1
-                ftflag = False
-            resid, info = _stoptest(work[slice1], atol)
+    result = _driver_solve('gmres', A, M, x, b, maxiter, atol, callback,
+                           restrt, ptol)
+    if result is not None:
+        iter_, resid, info = result
+    else:
+        while True:
+            x, iter_, presid, info, ndx1, ndx2, sclr1, sclr2, ijob = \
+               revcom(b, x, restrt, work, work2, iter_, presid, info, ndx1, ndx2, ijob, ptol)
+            slice1 = slice(ndx1-1, ndx1-1+n)
+            slice2 = slice(ndx2-1, ndx2-1+n)
+            if (ijob == -1):  # gmres success, update last residual
+                if resid_ready and callback is not None:
+                    callback(presid / bnrm2)
+                    resid_ready = False
+                break
+            elif (ijob == 1):
+                work[slice2] *= sclr2
+                work[slice2] += sclr1*matvec(x)
+            elif (ijob == 2):
+                work[slice1] = psolve(work[slice2])
+                if not first_pass and old_ijob == 3:
+                    resid_ready = True
+
+                first_pass = False
+            elif (ijob == 3):
+                work[slice2] *= sclr2
+                work[slice2] += sclr1*matvec(work[slice1])
+                if resid_ready and callback is not None:
+                    callback(presid / bnrm2)
+                    resid_ready = False
+                    iter_num = iter_num+1
+
+            elif (ijob == 4):
+                if ftflag:
+                    info = -1
+                    ftflag = False
+                resid, info = _stoptest(work[slice1], atol)
 
-            # Inner loop tolerance control
-            if info or presid > ptol:
-                ptol_max_factor = min(1.0, 1.5 * ptol_max_factor)
-            else:
-                # Inner loop tolerance OK, but outer loop not.
-                ptol_max_factor = max(1e-16, 0.25 * ptol_max_factor)
+                # Inner loop tolerance control
+                if info or presid > ptol:
+                    ptol_max_factor = min(1.0, 1.5 * ptol_max_factor)
+                else:
+                    # Inner loop tolerance OK, but outer loop not.
+                    ptol_max_factor = max(1e-16, 0.25 * ptol_max_factor)
 
-            if resid != 0:
-                ptol = presid * min(ptol_max_factor, atol / resid)
-            else:
-                ptol = presid * ptol_max_factor
+                if resid != 0:
+                    ptol = presid * min(ptol_max_factor, atol / resid)
+                else:
+                    ptol = presid * ptol_max_factor
 
-        old_ijob = ijob
-        ijob = 2
+            old_ijob = ijob
+            ijob = 2
 
-        if iter_num > maxiter:
-            info = maxiter
-            break
+            if iter_num > maxiter:
+                info = maxiter
+                break
 
     if info >= 0 and not (resid <= atol):
         # info isn't set appropriately otherwise
@@ -0,0 +1,685 @@
+/*
+ * _driver module
+ *
+ * Compiled driver loops for the reverse-communication routines used by
+ * iterative.py. They do what the Python loops of cg, cgs, bicgstab and
+ * gmres do, for a matrix in CSR format and a preconditioner that is the
+ * identity, a diagonal or a SuperLU object, so that no Python code runs
+ * in an iteration.
+ */
+
+#include <Python.h>
+
+#include <math.h>
+#include <string.h>
+
+#define PY_ARRAY_UNIQUE_SYMBOL _scipy_sparse_isolve_driver_ARRAY_API
+#include "numpy/arrayobject.h"
+#include "numpy/npy_3kcompat.h"
+
+#include "_superlu_capi.h"
+
+#if defined(NO_APPEND_FORTRAN)
+#if defined(UPPERCASE_FORTRAN)
+#define F_FUNC(f,F) F
+#else
+#define F_FUNC(f,F) f
+#endif
+#else
+#if defined(UPPERCASE_FORTRAN)
+#define F_FUNC(f,F) F##_
+#else
+#define F_FUNC(f,F) f##_
+#endif
+#endif
+
+/* The reverse-communication routines (*REVCOM.f.src); resid and tol
+   are of the real type, sclr1 and sclr2 of the type of the system */
+typedef void revcom_t(int *n, void *b, void *x, void *work, int *ldw,
+                      int *iter, void *resid, int *info, int *ndx1,
+                      int *ndx2, void *sclr1, void *sclr2, int *ijob);
+typedef void gmres_revcom_t(int *n, void *b, void *x, int *restrt,
+                            void *work, int *ldw, void *work2, int *ldw2,
+                            int *iter, void *resid, int *info, int *ndx1,
+                            int *ndx2, void *sclr1, void *sclr2, int *ijob,
+                            void *tol);
+
+extern revcom_t F_FUNC(scgrevcom,SCGREVCOM), F_FUNC(dcgrevcom,DCGREVCOM),
+    F_FUNC(ccgrevcom,CCGREVCOM), F_FUNC(zcgrevcom,ZCGREVCOM);
+extern revcom_t F_FUNC(scgsrevcom,SCGSREVCOM), F_FUNC(dcgsrevcom,DCGSREVCOM),
+    F_FUNC(ccgsrevcom,CCGSREVCOM), F_FUNC(zcgsrevcom,ZCGSREVCOM);
+extern revcom_t F_FUNC(sbicgstabrevcom,SBICGSTABREVCOM),
+    F_FUNC(dbicgstabrevcom,DBICGSTABREVCOM),
+    F_FUNC(cbicgstabrevcom,CBICGSTABREVCOM),
+    F_FUNC(zbicgstabrevcom,ZBICGSTABREVCOM);
+extern gmres_revcom_t F_FUNC(sgmresrevcom,SGMRESREVCOM),
+    F_FUNC(dgmresrevcom,DGMRESREVCOM), F_FUNC(cgmresrevcom,CGMRESREVCOM),
+    F_FUNC(zgmresrevcom,ZGMRESREVCOM);
+
+typedef struct {
+    int n;
+    const int *indptr;
+    const int *indices;
+    const void *data;
+} csr_t;
+
+
+/*
+ * Kernels, for each type
+ */
+
+/* y = sclr2*y + sclr1*A*v, as in the Python loops */
+#define MATVEC_REAL(name, T)                                            \
+    static void name(const csr_t *A, const void *v_, void *y_,          \
+                     const void *sclr1, const void *sclr2)              \
+    {                                                                   \
+        const T *data = (const T *)A->data, *v = (const T *)v_;         \
+        T *y = (T *)y_, a = *(const T *)sclr1, c = *(const T *)sclr2;   \
+        T s;                                                            \
+        int i, k;                                                       \
+                                                                        \
+        for (i = 0; i < A->n; ++i) {                                    \
+            s = 0;                                                      \
+            for (k = A->indptr[i]; k < A->indptr[i + 1]; ++k) {         \
+                s += data[k] * v[A->indices[k]];                        \
+            }                                                           \
+            y[i] = y[i] * c + a * s;                                    \
+        }                                                               \
+    }
+
+#define MATVEC_COMPLEX(name, T, R)                                      \
+    static void name(const csr_t *A, const void *v_, void *y_,          \
+                     const void *sclr1, const void *sclr2)              \
+    {                                                                   \
+        const T *data = (const T *)A->data, *v = (const T *)v_;         \
+        T *y = (T *)y_, a = *(const T *)sclr1, c = *(const T *)sclr2;   \
+        R sr, si, yr, yi;                                               \
+        int i, j, k;                                                    \
+                                                                        \
+        for (i = 0; i < A->n; ++i) {                                    \
+            sr = si = 0;                                                \
+            for (k = A->indptr[i]; k < A->indptr[i + 1]; ++k) {         \
+                j = A->indices[k];                                      \
+                sr += data[k].real * v[j].real - data[k].imag * v[j].imag; \
+                si += data[k].real * v[j].imag + data[k].imag * v[j].real; \
+            }                                                           \
+            yr = y[i].real * c.real - y[i].imag * c.imag;               \
+            yi = y[i].real * c.imag + y[i].imag * c.real;               \
+            y[i].real = yr + (a.real * sr - a.imag * si);               \
+            y[i].imag = yi + (a.real * si + a.imag * sr);               \
+        }                                                               \
+    }
+
+/* y = b - A*x */
+#define RESIDUAL_REAL(name, T)                                          \
+    static void name(const csr_t *A, const void *b_, const void *x_,    \
+                     void *y_)                                          \
+    {                                                                   \
+        const T *data = (const T *)A->data, *b = (const T *)b_;         \
+        const T *x = (const T *)x_;                                     \
+        T *y = (T *)y_, s;                                              \
+        int i, k;                                                       \
+                                                                        \
+        for (i = 0; i < A->n; ++i) {                                    \
+            s = 0;                                                      \
+            for (k = A->indptr[i]; k < A->indptr[i + 1]; ++k) {         \
+                s += data[k] * x[A->indices[k]];                        \
+            }                                                           \
+            y[i] = b[i] - s;                                            \
+        }                                                               \
+    }
+
+#define RESIDUAL_COMPLEX(name, T, R)                                    \
+    static void name(const csr_t *A, const void *b_, const void *x_,    \
+                     void *y_)                                          \
+    {                                                                   \
+        const T *data = (const T *)A->data, *b = (const T *)b_;         \
+        const T *x = (const T *)x_;                                     \
+        T *y = (T *)y_;                                                 \
+        R sr, si;                                                       \
+        int i, j, k;                                                    \
+                                                                        \
+        for (i = 0; i < A->n; ++i) {                                    \
+            sr = si = 0;                                                \
+            for (k = A->indptr[i]; k < A->indptr[i + 1]; ++k) {         \
+                j = A->indices[k];                                      \
+                sr += data[k].real * x[j].real - data[k].imag * x[j].imag; \
+                si += data[k].real * x[j].imag + data[k].imag * x[j].real; \
+            }                                                           \
+            y[i].real = b[i].real - sr;                                 \
+            y[i].imag = b[i].imag - si;                                 \
+        }                                                               \
+    }
+
+/* dst = d * src, elementwise */
+#define SCALE_REAL(name, T)                                             \
+    static void name(int n, const void *d_, const void *src_,           \
+                     void *dst_)                                        \
+    {                                                                   \
+        const T *d = (const T *)d_, *src = (const T *)src_;             \
+        T *dst = (T *)dst_;                                             \
+        int i;                                                          \
+                                                                        \
+        for (i = 0; i < n; ++i) {                                       \
+            dst[i] = d[i] * src[i];                                     \
+        }                                                               \
+    }
+
+#define SCALE_COMPLEX(name, T, R)                                       \
+    static void name(int n, const void *d_, const void *src_,           \
+                     void *dst_)                                        \
+    {                                                                   \
+        const T *d = (const T *)d_, *src = (const T *)src_;             \
+        T *dst = (T *)dst_;                                             \
+        R re, im;                                                       \
+        int i;                                                          \
+                                                                        \
+        for (i = 0; i < n; ++i) {                                       \
+            re = d[i].real * src[i].real - d[i].imag * src[i].imag;     \
+            im = d[i].real * src[i].imag + d[i].imag * src[i].real;     \
+            dst[i].real = re;                                           \
+            dst[i].imag = im;                                           \
+        }                                                               \
+    }
+
+#define NRM2_REAL(name, T)                                              \
+    static double name(int n, const void *v_)                           \
+    {                                                                   \
+        const T *v = (const T *)v_;                                     \
+        double s = 0;                                                   \
+        int i;                                                          \
+                                                                        \
+        for (i = 0; i < n; ++i) {                                       \
+            s += (double)v[i] * v[i];                                   \
+        }                                                               \
+        return sqrt(s);                                                 \
+    }
+
+#define NRM2_COMPLEX(name, T)                                           \
+    static double name(int n, const void *v_)                           \
+    {                                                                   \
+        const T *v = (const T *)v_;                                     \
+        double s = 0;                                                   \
+        int i;                                                          \
+                                                                        \
+        for (i = 0; i < n; ++i) {                                       \
+            s += (double)v[i].real * v[i].real                          \
+                 + (double)v[i].imag * v[i].imag;                       \
+        }                                                               \
+        return sqrt(s);                                                 \
+    }
+
+MATVEC_REAL(matvec_s, float)
+MATVEC_REAL(matvec_d, double)
+MATVEC_COMPLEX(matvec_c, npy_cfloat, float)
+MATVEC_COMPLEX(matvec_z, npy_cdouble, double)
+RESIDUAL_REAL(residual_s, float)
+RESIDUAL_REAL(residual_d, double)
+RESIDUAL_COMPLEX(residual_c, npy_cfloat, float)
+RESIDUAL_COMPLEX(residual_z, npy_cdouble, double)
+SCALE_REAL(scale_s, float)
+SCALE_REAL(scale_d, double)
+SCALE_COMPLEX(scale_c, npy_cfloat, float)
+SCALE_COMPLEX(scale_z, npy_cdouble, double)
+NRM2_REAL(nrm2_s, float)
+NRM2_REAL(nrm2_d, double)
+NRM2_COMPLEX(nrm2_c, npy_cfloat)
+NRM2_COMPLEX(nrm2_z, npy_cdouble)
+
+typedef struct {
+    int typenum;
+    size_t elsize;
+    int single;                 /* resid and tol are floats */
+    void (*matvec)(const csr_t *, const void *, void *, const void *,
+                   const void *);
+    void (*residual)(const csr_t *, const void *, const void *, void *);
+    void (*scale)(int, const void *, const void *, void *);
+    double (*nrm2)(int, const void *);
+    revcom_t *cg, *cgs, *bicgstab;
+    gmres_revcom_t *gmres;
+} driver_type;
+
+static const driver_type driver_types[] = {
+    {NPY_FLOAT, sizeof(float), 1,
+     matvec_s, residual_s, scale_s, nrm2_s,
+     F_FUNC(scgrevcom,SCGREVCOM), F_FUNC(scgsrevcom,SCGSREVCOM),
+     F_FUNC(sbicgstabrevcom,SBICGSTABREVCOM),
+     F_FUNC(sgmresrevcom,SGMRESREVCOM)},
+    {NPY_DOUBLE, sizeof(double), 0,
+     matvec_d, residual_d, scale_d, nrm2_d,
+     F_FUNC(dcgrevcom,DCGREVCOM), F_FUNC(dcgsrevcom,DCGSREVCOM),
+     F_FUNC(dbicgstabrevcom,DBICGSTABREVCOM),
+     F_FUNC(dgmresrevcom,DGMRESREVCOM)},
+    {NPY_CFLOAT, sizeof(npy_cfloat), 1,
+     matvec_c, residual_c, scale_c, nrm2_c,
+     F_FUNC(ccgrevcom,CCGREVCOM), F_FUNC(ccgsrevcom,CCGSREVCOM),
+     F_FUNC(cbicgstabrevcom,CBICGSTABREVCOM),
+     F_FUNC(cgmresrevcom,CGMRESREVCOM)},
+    {NPY_CDOUBLE, sizeof(npy_cdouble), 0,
+     matvec_z, residual_z, scale_z, nrm2_z,
+     F_FUNC(zcgrevcom,ZCGREVCOM), F_FUNC(zcgsrevcom,ZCGSREVCOM),
+     F_FUNC(zbicgstabrevcom,ZBICGSTABREVCOM),
+     F_FUNC(zgmresrevcom,ZGMRESREVCOM)},
+};
+
+/* resid and tol of the Fortran routines */
+typedef union {
+    float f;
+    double d;
+} real_t;
+
+static void real_set(const driver_type *t, real_t *r, double value)
+{
+    if (t->single) {
+        r->f = (float)value;
+    }
+    else {
+        r->d = value;
+    }
+}
+
+static double real_get(const driver_type *t, const real_t *r)
+{
+    return t->single ? r->f : r->d;
+}
+
+
+/*
+ * Preconditioners
+ */
+
+enum {
+    PRECOND_NONE,
+    PRECOND_DIAG,
+    PRECOND_SUPERLU
+};
+
+typedef struct {
+    int kind;
+    const void *diag;
+    PyObject *lu;
+} precond_t;
+
+static superlu_capi_t *superlu_api = NULL;
+
+/* dst = M*src; only a SuperLU object can fail, and needs the GIL */
+static int precond_apply(const precond_t *M, const driver_type *t, int n,
+                         const void *src, void *dst)
+{
+    switch (M->kind) {
+    case PRECOND_DIAG:
+        t->scale(n, M->diag, src, dst);
+        return 0;
+    case PRECOND_SUPERLU:
+        memmove(dst, src, n * t->elsize);
+        return superlu_api->solve(M->lu, dst);
+    default:
+        memmove(dst, src, n * t->elsize);
+        return 0;
+    }
+}
+
+
+/*
+ * Driver loops. Both return 0, or -1 with an exception set if the
+ * preconditioner failed or memory ran out.
+ */
+
+/* cg, cgs and bicgstab, whose routines need ncols columns of work; with
+   recheck, convergence is confirmed with the true residual */
+static int drive(const driver_type *t, revcom_t *revcom, int ncols,
+                 int recheck, const csr_t *A, const precond_t *M,
+                 void *b, void *x, int maxiter, double atol,
+                 int *iter_out, double *resid_out, int *info_out)
+{
+    int n = A->n, ldw = n, iter = maxiter, info = 0, ijob = 1;
+    int ndx1 = 1, ndx2 = -1;
+    npy_cdouble sclr1, sclr2;
+    real_t resid;
+    char *work, *slice1, *slice2;
+
+    work = calloc((size_t)ncols * n, t->elsize);
+    if (work == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    real_set(t, &resid, atol);
+
+    for (;;) {
+        revcom(&n, b, x, work, &ldw, &iter, &resid, &info, &ndx1, &ndx2,
+               &sclr1, &sclr2, &ijob);
+        slice1 = work + (ndx1 - 1) * t->elsize;
+        slice2 = work + (ndx2 - 1) * t->elsize;
+        if (ijob == -1) {
+            break;
+        }
+        else if (ijob == 1) {
+            t->matvec(A, slice1, slice2, &sclr1, &sclr2);
+        }
+        else if (ijob == 2) {
+            if (precond_apply(M, t, n, slice2, slice1)) {
+                free(work);
+                return -1;
+            }
+        }
+        else if (ijob == 3) {
+            t->matvec(A, x, slice2, &sclr1, &sclr2);
+        }
+        else if (ijob == 4) {
+            real_set(t, &resid, t->nrm2(n, slice1));
+            info = real_get(t, &resid) <= atol;
+            if (recheck && info == 1 && iter > 1) {
+                /* recompute residual and recheck, to avoid
+                   accumulating rounding error */
+                t->residual(A, b, x, slice1);
+                real_set(t, &resid, t->nrm2(n, slice1));
+                info = real_get(t, &resid) <= atol;
+            }
+        }
+        ijob = 2;
+    }
+
+    free(work);
+    *iter_out = iter;
+    *resid_out = real_get(t, &resid);
+    *info_out = info;
+    return 0;
+}
+
+/* gmres, starting from the inner tolerance ptol */
+static int drive_gmres(const driver_type *t, int restrt, const csr_t *A,
+                       const precond_t *M, void *b, void *x, int maxiter,
+                       double atol, double ptol, int *iter_out,
+                       double *resid_out, int *info_out)
+{
+    int n = A->n, ldw = n, ldw2 = restrt + 1 > 2 ? restrt + 1 : 2;
+    int iter = maxiter, info = 0, ijob = 1, ndx1 = 1, ndx2 = -1;
+    npy_cdouble sclr1, sclr2;
+    real_t presid, tol, rnorm;
+    double resid = Py_NAN, ptol_max_factor = 1.0;
+    char *work, *work2, *slice1, *slice2;
+
+    work = calloc((size_t)(6 + restrt) * n, t->elsize);
+    work2 = calloc((size_t)ldw2 * (2 * restrt + 2), t->elsize);
+    if (work == NULL || work2 == NULL) {
+        free(work);
+        free(work2);
+        PyErr_NoMemory();
+        return -1;
+    }
+    real_set(t, &presid, Py_NAN);
+
+    for (;;) {
+        real_set(t, &tol, ptol);
+        t->gmres(&n, b, x, &restrt, work, &ldw, work2, &ldw2, &iter,
+                 &presid, &info, &ndx1, &ndx2, &sclr1, &sclr2, &ijob, &tol);
+        slice1 = work + (ndx1 - 1) * t->elsize;
+        slice2 = work + (ndx2 - 1) * t->elsize;
+        if (ijob == -1) {
+            break;
+        }
+        else if (ijob == 1) {
+            t->matvec(A, x, slice2, &sclr1, &sclr2);
+        }
+        else if (ijob == 2) {
+            if (precond_apply(M, t, n, slice2, slice1)) {
+                free(work);
+                free(work2);
+                return -1;
+            }
+        }
+        else if (ijob == 3) {
+            t->matvec(A, slice1, slice2, &sclr1, &sclr2);
+        }
+        else if (ijob == 4) {
+            real_set(t, &rnorm, t->nrm2(n, slice1));
+            resid = real_get(t, &rnorm);
+            info = resid <= atol;
+
+            /* Inner loop tolerance control */
+            if (info || real_get(t, &presid) > ptol) {
+                ptol_max_factor = 1.5 * ptol_max_factor;
+                if (ptol_max_factor > 1.0) {
+                    ptol_max_factor = 1.0;
+                }
+            }
+            else {
+                /* Inner loop tolerance OK, but outer loop not. */
+                ptol_max_factor = 0.25 * ptol_max_factor;
+                if (ptol_max_factor < 1e-16) {
+                    ptol_max_factor = 1e-16;
+                }
+            }
+
+            if (resid != 0) {
+                ptol = real_get(t, &presid) * (ptol_max_factor < atol / resid
+                                               ? ptol_max_factor
+                                               : atol / resid);
+            }
+            else {
+                ptol = real_get(t, &presid) * ptol_max_factor;
+            }
+        }
+        ijob = 2;
+    }
+
+    free(work);
+    free(work2);
+    *iter_out = iter;
+    *resid_out = resid;
+    *info_out = info;
+    return 0;
+}
+
+
+/*
+ * Python interface
+ */
+
+static int check_vector(PyArrayObject *a, int typenum, npy_intp n,
+                        const char *name)
+{
+    if (PyArray_NDIM(a) != 1 || PyArray_TYPE(a) != typenum ||
+        !PyArray_IS_C_CONTIGUOUS(a) || PyArray_DIM(a, 0) < n) {
+        PyErr_Format(PyExc_ValueError,
+                     "%s must be a contiguous vector of the system type",
+                     name);
+        return -1;
+    }
+    return 0;
+}
+
+static char solve_doc[] =
+"solve(method, x, b, indptr, indices, data, precond, maxiter, atol,\n\
+      restrt=0, ptol=0.0)\n\
+\n\
+Runs the iteration of method ('cg', 'cgs', 'bicgstab' or 'gmres') for\n\
+the CSR matrix (indptr, indices, data), updating x in place. precond is\n\
+None, the diagonal of a diagonal preconditioner or a SuperLU object.\n\
+gmres takes the restart length and the starting inner tolerance.\n\
+\n\
+Returns (iter, resid, info) as left by the Python loops of iterative.py,\n\
+or None if precond cannot be applied here, e.g. a SuperLU object of\n\
+another data type.";
+
+static PyObject *Py_solve(PyObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = { "method", "x", "b", "indptr", "indices",
+                              "data", "precond", "maxiter", "atol",
+                              "restrt", "ptol", NULL };
+    const char *method;
+    PyArrayObject *x, *b, *indptr, *indices, *data;
+    PyObject *precond;
+    int maxiter, restrt = 0, typenum, nnz, n, k, iter, info, status;
+    double atol, ptol = 0.0, resid;
+    const driver_type *t = NULL;
+    precond_t M = { PRECOND_NONE, NULL, NULL };
+    csr_t A;
+    PyThreadState *save = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "sO!O!O!O!O!Oid|id", kwlist,
+                                     &method, &PyArray_Type, &x,
+                                     &PyArray_Type, &b,
+                                     &PyArray_Type, &indptr,
+                                     &PyArray_Type, &indices,
+                                     &PyArray_Type, &data, &precond,
+                                     &maxiter, &atol, &restrt, &ptol)) {
+        return NULL;
+    }
+
+    typenum = PyArray_TYPE(x);
+    for (k = 0; k < 4; ++k) {
+        if (driver_types[k].typenum == typenum) {
+            t = &driver_types[k];
+        }
+    }
+    if (t == NULL) {
+        PyErr_SetString(PyExc_ValueError, "unsupported data type");
+        return NULL;
+    }
+    if (PyArray_DIM(x, 0) < 1 || PyArray_DIM(x, 0) > NPY_MAX_INT ||
+        !PyArray_ISWRITEABLE(x)) {
+        PyErr_SetString(PyExc_ValueError, "x must be a writeable vector");
+        return NULL;
+    }
+    n = (int)PyArray_DIM(x, 0);
+    if (check_vector(x, typenum, n, "x") ||
+        check_vector(b, typenum, n, "b") ||
+        check_vector(indptr, NPY_INT, n + 1, "indptr") ||
+        check_vector(indices, NPY_INT, 0, "indices") ||
+        check_vector(data, typenum, 0, "data")) {
+        return NULL;
+    }
+
+    /* The matrix is not checked elsewhere before the loop reads it */
+    A.n = n;
+    A.indptr = (const int *)PyArray_DATA(indptr);
+    A.indices = (const int *)PyArray_DATA(indices);
+    A.data = PyArray_DATA(data);
+    nnz = A.indptr[n];
+    if (A.indptr[0] != 0 || nnz > PyArray_DIM(indices, 0) ||
+        nnz > PyArray_DIM(data, 0)) {
+        PyErr_SetString(PyExc_ValueError, "invalid CSR matrix");
+        return NULL;
+    }
+    for (k = 0; k < n; ++k) {
+        if (A.indptr[k + 1] < A.indptr[k]) {
+            PyErr_SetString(PyExc_ValueError, "invalid CSR matrix");
+            return NULL;
+        }
+    }
+    for (k = 0; k < nnz; ++k) {
+        if (A.indices[k] < 0 || A.indices[k] >= n) {
+            PyErr_SetString(PyExc_ValueError, "invalid CSR matrix");
+            return NULL;
+        }
+    }
+
+    if (PyArray_Check(precond)) {
+        if (check_vector((PyArrayObject *)precond, typenum, n, "precond")) {
+            return NULL;
+        }
+        M.kind = PRECOND_DIAG;
+        M.diag = PyArray_DATA((PyArrayObject *)precond);
+    }
+    else if (precond != Py_None) {
+        if (superlu_api == NULL) {
+            superlu_api = (superlu_capi_t *)PyCapsule_Import(SUPERLU_CAPI_NAME,
+                                                            0);
+            if (superlu_api == NULL) {
+                PyErr_Clear();
+                Py_RETURN_NONE;
+            }
+        }
+        if (!superlu_api->usable(precond, typenum, n)) {
+            Py_RETURN_NONE;
+        }
+        M.kind = PRECOND_SUPERLU;
+        M.lu = precond;
+    }
+
+    if (strcmp(method, "gmres") == 0) {
+        if (restrt < 1 || restrt > n) {
+            PyErr_SetString(PyExc_ValueError, "restrt must be in 1..n");
+            return NULL;
+        }
+    }
+    else if (strcmp(method, "cg") != 0 && strcmp(method, "cgs") != 0 &&
+             strcmp(method, "bicgstab") != 0) {
+        PyErr_Format(PyExc_ValueError, "unknown method %s", method);
+        return NULL;
+    }
+
+    /* SuperLU objects are applied with the GIL held */
+    if (M.kind != PRECOND_SUPERLU) {
+        save = PyEval_SaveThread();
+    }
+    if (strcmp(method, "gmres") == 0) {
+        status = drive_gmres(t, restrt, &A, &M, PyArray_DATA(b),
+                             PyArray_DATA(x), maxiter, atol, ptol,
+                             &iter, &resid, &info);
+    }
+    else if (strcmp(method, "cg") == 0) {
+        status = drive(t, t->cg, 4, 1, &A, &M, PyArray_DATA(b),
+                       PyArray_DATA(x), maxiter, atol, &iter, &resid, &info);
+    }
+    else if (strcmp(method, "cgs") == 0) {
+        status = drive(t, t->cgs, 7, 1, &A, &M, PyArray_DATA(b),
+                       PyArray_DATA(x), maxiter, atol, &iter, &resid, &info);
+    }
+    else {
+        status = drive(t, t->bicgstab, 7, 0, &A, &M, PyArray_DATA(b),
+                       PyArray_DATA(x), maxiter, atol, &iter, &resid, &info);
+    }
+    if (save != NULL) {
+        PyEval_RestoreThread(save);
+    }
+    if (status) {
+        return NULL;
+    }
+
+    return Py_BuildValue("idi", iter, resid, info);
+}
+
+
+/*
+ * Main _driver module
+ */
+
+static PyMethodDef driver_methods[] = {
+    {"solve", (PyCFunction) Py_solve, METH_VARARGS | METH_KEYWORDS,
+     solve_doc},
+    {NULL, NULL}
+};
+
+#if PY_VERSION_HEX >= 0x03000000
+
+static struct PyModuleDef moduledef = {
+    PyModuleDef_HEAD_INIT,
+    "_driver",
+    NULL,
+    -1,
+    driver_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+PyObject *PyInit__driver(void)
+{
+    import_array();
+
+    return PyModule_Create(&moduledef);
+}
+
+#else
+
+PyMODINIT_FUNC init_driver(void)
+{
+    import_array();
+
+    Py_InitModule("_driver", driver_methods);
+}
+
+#endif
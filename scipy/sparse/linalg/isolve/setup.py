@@ -25,13 +25,27 @@ def configuration(parent_package='',top_path=None):
                ]
 
     Util = ['getbreak.f.src']
-    sources = Util + methods + ['_iterative.pyf.src']
+    sources = Util + methods
     sources = [join('iterative', x) for x in sources]
     sources += get_g77_abi_wrappers(lapack_opt)
 
+    config.add_library('iterative_scipy', sources=sources)
+
     config.add_extension('_iterative',
-                         sources=sources,
-                         extra_info=lapack_opt)
+                         sources=[join('iterative', '_iterative.pyf.src')],
+                         libraries=['iterative_scipy'],
+                         extra_info=lapack_opt,
+                         depends=sources)
+
+    # compiled driver loops, applying SuperLU objects through the C
+    # interface of the _superlu module
+    config.add_extension('_driver',
+                         sources=[join('iterative', '_drivermodule.c')],
+                         libraries=['iterative_scipy'],
+                         include_dirs=[join('..', 'dsolve')],
+                         extra_info=lapack_opt,
+                         depends=(sources +
+                                  [join('..', 'dsolve', '_superlu_capi.h')]))
 
     config.add_data_dir('tests')
 
@@ -16,7 +16,7 @@ from numpy import zeros, arange, array, ones, eye, iscomplexobj
 from scipy.linalg import norm
 from scipy.sparse import spdiags, csr_matrix, SparseEfficiencyWarning
 
-from scipy.sparse.linalg import LinearOperator, aslinearoperator
+from scipy.sparse.linalg import LinearOperator, aslinearoperator, splu, spilu
 from scipy.sparse.linalg.isolve import cg, cgs, bicg, bicgstab, gmres, qmr, minres, lgmres, gcrotmk
 
 # TODO check that method preserve shape and type
@@ -448,6 +448,52 @@ def test_zero_rhs(solver):
                 assert_allclose(x, 0, atol=1e-300)
 
 
+@pytest.mark.parametrize("solver", [cg, cgs, bicgstab, gmres])
+@pytest.mark.parametrize("dtype", [np.float64, np.complex128])
+def test_driver_loop(solver, dtype):
+    # The compiled loop, used for CSR matrices with the preconditioners
+    # below, has to give what the Python loop gives
+    np.random.seed(1234)
+    n = 40
+    A = 4 * eye(n) + np.random.rand(n, n) * (np.random.rand(n, n) < 0.1)
+    if dtype == np.complex128:
+        A = A + 0.2j * np.diag(np.random.rand(n))
+    A = A.dot(A.conj().T) if solver is cg else A
+    A = csr_matrix(A.astype(dtype))
+    b = np.random.rand(n).astype(dtype)
+    x0 = np.random.rand(n).astype(dtype)
+
+    lu = splu(A.tocsc())
+    ilu = spilu(A.tocsc(), drop_tol=0.1)
+    Ms = [None,
+          spdiags(1 / A.diagonal(), 0, n, n),
+          lu,
+          ilu,
+          LinearOperator(A.shape, ilu.solve)]
+    for M in Ms:
+        x, info = solver(A, b, x0=x0, tol=1e-10, atol=0, M=M)
+        assert_equal(info, 0)
+        assert_normclose(A.dot(x), b, tol=1e-9)
+
+        # the same system through a LinearOperator takes the Python loop
+        A_op = LinearOperator(A.shape, A.dot, dtype=A.dtype)
+        if M is lu or M is ilu:
+            M = LinearOperator(A.shape, M.solve, dtype=A.dtype)
+        else:
+            M = aslinearoperator(M) if M is not None else None
+            if M is not None:
+                M = LinearOperator(A.shape, M.matvec, dtype=A.dtype)
+        y, info = solver(A_op, b, x0=x0, tol=1e-10, atol=0, M=M)
+        assert_equal(info, 0)
+        assert_allclose(x, y, rtol=1e-8, atol=1e-12)
+
+    # a factorization of another data type cannot be used in compiled code
+    single = np.float32 if dtype == np.float64 else np.complex64
+    lu = splu(A.tocsc().astype(single))
+    x, info = solver(A, b, tol=1e-4, atol=0, M=lu)
+    assert_equal(info, 0)
+
+
 @pytest.mark.parametrize("solver", [
     gmres, qmr, lgmres,
     pytest.param(cgs, marks=pytest.mark.xfail),
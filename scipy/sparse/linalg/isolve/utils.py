@@ -7,6 +7,7 @@ __all__ = []
 
 from numpy import asanyarray, asarray, array, matrix, zeros
 from scipy.sparse.sputils import asmatrix
+from scipy.sparse.linalg.dsolve import SuperLU
 
 from scipy.sparse.linalg.interface import aslinearoperator, LinearOperator, \
      IdentityOperator
@@ -40,7 +41,8 @@ def make_system(A, M, x0, b):
         sparse or dense matrix (or any valid input to aslinearoperator)
     M : {LinearOperator, Nones}
         preconditioner
-        sparse or dense matrix (or any valid input to aslinearoperator)
+        sparse or dense matrix (or any valid input to aslinearoperator),
+        or a SuperLU object, applied through its solve method
     x0 : {array_like, None}
         initial guess to iterative method
     b : array_like
@@ -115,6 +117,12 @@ def make_system(A, M, x0, b):
         else:
             M = LinearOperator(A.shape, matvec=psolve, rmatvec=rpsolve,
                                dtype=A.dtype)
+    elif isinstance(M, SuperLU):
+        lu = M
+        M = LinearOperator(lu.shape, matvec=lu.solve,
+                           rmatvec=lambda x: lu.solve(x, 'H'))
+        if A.shape != M.shape:
+            raise ValueError('matrix and preconditioner have different shapes')
     else:
         M = aslinearoperator(M)
         if A.shape != M.shape:
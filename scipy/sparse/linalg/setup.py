@@ -1,8 +1,11 @@
 from __future__ import division, print_function, absolute_import
 
+from os.path import join
+
 
 def configuration(parent_package='',top_path=None):
     from numpy.distutils.misc_util import Configuration
+    from scipy._build_utils.compiler_helper import set_cxx_threads_flags_hook
 
     config = Configuration('linalg',parent_package,top_path)
 
@@ -10,6 +13,14 @@ def configuration(parent_package='',top_path=None):
     config.add_subpackage(('dsolve'))
     config.add_subpackage(('eigen'))
 
+    # compiled Taylor loops of expm_multiply
+    sparsetools_dir = join('..', 'sparsetools')
+    ext = config.add_extension('_expm_multiply_core',
+                               sources=['_expm_multiply_coremodule.cxx'],
+                               include_dirs=[sparsetools_dir],
+                               depends=[join(sparsetools_dir, 'parallel.h')])
+    ext._pre_build_hook = set_cxx_threads_flags_hook
+
     config.add_data_dir('tests')
 
     return config
@@ -122,6 +122,26 @@ class TestExpmActionSimple(object):
                 expected = scipy.linalg.expm(A).dot(B)
             assert_allclose(observed, expected)
 
+    def test_sparse_threaded(self):
+        # The compiled loop used for sparse A agrees with the Python loop
+        # used for dense A, for any number of threads
+        np.random.seed(1234)
+        n = 300
+        for dtype in (np.float64, np.complex128):
+            A = scipy.sparse.rand(n, n, density=0.02, format='csr')
+            A = (A - scipy.sparse.diags(np.ravel(A.sum(axis=0)))).astype(dtype)
+            if dtype == np.complex128:
+                A = A + 1j * scipy.sparse.eye(n)
+            for B in (np.random.rand(n), np.random.rand(n, 3)):
+                expected = _expm_multiply_simple(A.toarray(), B, t=2.0)
+                for workers in (1, 3):
+                    with scipy.sparse.set_workers(workers):
+                        observed = _expm_multiply_simple(A, B, t=2.0)
+                    assert_equal(observed.shape, expected.shape)
+                    assert_equal(observed.dtype, expected.dtype)
+                    assert_allclose(observed, expected, rtol=1e-12,
+                                    atol=1e-14)
+
     def test_complex(self):
         A = np.array([
             [1j, 1j],
@@ -213,6 +233,27 @@ class TestExpmActionInterval(object):
         Aexpm = scipy.sparse.diags(np.exp(np.arange(5)),format='csr')
         assert_allclose(expm_multiply(A,B,0,1)[-1], Aexpm.dot(B))
 
+    def test_sparse_interval_threaded(self):
+        # The compiled loops of the interval cores agree with the Python
+        # loops used for dense A
+        np.random.seed(1234)
+        n = 200
+        A = scipy.sparse.rand(n, n, density=0.03, format='csr')
+        A = A - scipy.sparse.diags(np.ravel(A.sum(axis=0)))
+        for B in (np.random.rand(n), np.random.rand(n, 2)):
+            for num in (2, 16, 21, 50):
+                # same norm estimates in both
+                np.random.seed(0)
+                X0, status0 = _expm_multiply_interval(A.toarray(), B, 0.1,
+                                                      10.0, num)
+                for workers in (1, 4):
+                    np.random.seed(0)
+                    with scipy.sparse.set_workers(workers):
+                        X, status = _expm_multiply_interval(A, B, 0.1, 10.0,
+                                                            num)
+                    assert_equal(status, status0)
+                    assert_allclose(X, X0, rtol=1e-12, atol=1e-14)
+
     def test_expm_multiply_interval_status_0(self):
         self._help_test_specific_expm_interval_status(0)
 
@@ -7,6 +7,7 @@ import subprocess
 
 def configuration(parent_package='',top_path=None):
     from numpy.distutils.misc_util import Configuration
+    from scipy._build_utils.compiler_helper import set_cxx_threads_flags_hook
 
     config = Configuration('sparse',parent_package,top_path)
 
@@ -40,21 +41,25 @@ def configuration(parent_package='',top_path=None):
                'csr.h',
                'dense.h',
                'dia.h',
+               'parallel.h',
                'py3k.h',
+               'sell.h',
+               'sort.h',
                'sparsetools.h',
                'util.h']
     depends = [os.path.join('sparsetools', hdr) for hdr in depends],
-    config.add_extension('_sparsetools',
-                         define_macros=[('__STDC_FORMAT_MACROS', 1)],
-                         depends=depends,
-                         include_dirs=['sparsetools'],
-                         sources=[os.path.join('sparsetools', 'sparsetools.cxx'),
-                                  os.path.join('sparsetools', 'csr.cxx'),
-                                  os.path.join('sparsetools', 'csc.cxx'),
-                                  os.path.join('sparsetools', 'bsr.cxx'),
-                                  os.path.join('sparsetools', 'other.cxx'),
-                                  get_sparsetools_sources]
-                         )
+    ext = config.add_extension('_sparsetools',
+                               define_macros=[('__STDC_FORMAT_MACROS', 1)],
+                               depends=depends,
+                               include_dirs=['sparsetools'],
+                               sources=[os.path.join('sparsetools', 'sparsetools.cxx'),
+                                        os.path.join('sparsetools', 'csr.cxx'),
+                                        os.path.join('sparsetools', 'csc.cxx'),
+                                        os.path.join('sparsetools', 'bsr.cxx'),
+                                        os.path.join('sparsetools', 'other.cxx'),
+                                        get_sparsetools_sources]
+                               )
+    ext._pre_build_hook = set_cxx_threads_flags_hook
 
     return config
 
@@ -130,6 +130,60 @@ void bsr_scale_columns(const I n_brow,
 
 
 
+/*
+ * Sort the column block indices of block rows [brow_start, brow_end) of
+ * BSR matrix A inplace. Rows that are already sorted are left untouched.
+ */
+template <class I, class T>
+void bsr_sort_indices_rows(const I brow_start,
+                           const I brow_end,
+                           const I R,
+                           const I C,
+                           const I Ap[],
+                                 I Aj[],
+                                 T Ax[])
+{
+    const npy_intp RC = (npy_intp)R*C;
+
+    std::vector<I> perm, tmp_j, tmp_perm;
+    std::vector<T> blocks;
+
+    for(I i = brow_start; i < brow_end; i++){
+        const I start = Ap[i];
+        const I end   = Ap[i+1];
+        if (end - start < 2) {
+            continue;
+        }
+
+        bool sorted = true;
+        I lo = Aj[start], hi = Aj[start];
+        for(I jj = start + 1; jj < end; jj++){
+            sorted = sorted && Aj[jj-1] <= Aj[jj];
+            lo = std::min(lo, Aj[jj]);
+            hi = std::max(hi, Aj[jj]);
+        }
+        if (sorted) {
+            continue;
+        }
+
+        //compute permutation of the blocks in this row
+        const I len = end - start;
+        perm.resize(len);
+        for(I k = 0; k < len; k++){
+            perm[k] = start + k;
+        }
+        sort_by_index(len, lo, hi, Aj + start, &perm[0], tmp_j, tmp_perm);
+
+        blocks.resize(RC * len);
+        for(I k = 0; k < len; k++){
+            const T * input = Ax + RC * perm[k];
+            std::copy(input, input + RC, &blocks[RC * k]);
+        }
+        std::copy(blocks.begin(), blocks.end(), Ax + RC * start);
+    }
+}
+
+
 /*
  * Sort the column block indices of a BSR matrix inplace
  *
@@ -157,27 +211,42 @@ void bsr_sort_indices(const I n_brow,
         return;
     }
 
+    bsr_sort_indices_rows((I)0, n_brow, R, C, Ap, Aj, Ax);
+}
 
-    const I nblks = Ap[n_brow];
-    const npy_intp RC    = (npy_intp)R*C;
-    const npy_intp nnz   = (npy_intp)RC*nblks;
-
-    //compute permutation of blocks using CSR
-    std::vector<I> perm(nblks);
-
-    for(I i = 0; i < nblks; i++)
-        perm[i] = i;
 
-    csr_sort_indices(n_brow, Ap, Aj, &perm[0]);
+/*
+ * Threaded version of bsr_sort_indices
+ *
+ * Input Arguments:
+ *   I  workers       - maximum number of threads to use
+ *
+ * The remaining arguments are as for bsr_sort_indices.
+ *
+ */
+template <class I, class T>
+void bsr_sort_indices_threaded(const I n_brow,
+                               const I n_bcol,
+                               const I R,
+                               const I C,
+                                     I Ap[],
+                                     I Aj[],
+                                     T Ax[],
+                               const I workers)
+{
+    if( R == 1 && C == 1 ){
+        csr_sort_indices_threaded(n_brow, Ap, Aj, Ax, workers);
+        return;
+    }
 
-    std::vector<T> Ax_copy(nnz);
-    std::copy(Ax, Ax + nnz, Ax_copy.begin());
+    const npy_intp RC = (npy_intp)R*C;
+    const I n_chunks = parallel_num_chunks(workers, RC * Ap[n_brow] + n_brow);
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_brow, Ap, n_chunks, &bounds[0]);
 
-    for(I i = 0; i < nblks; i++){
-        const T * input = &Ax_copy[RC * perm[i]];
-              T * output = Ax + RC*i;
-        std::copy(input, input + RC, output);
-    }
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        bsr_sort_indices_rows(bounds[c], bounds[c+1], R, C, Ap, Aj, Ax);
+    });
 }
 
 
@@ -245,21 +314,78 @@ void bsr_transpose(const I n_brow,
 
 
 
+/*
+ * Block kernels used by bsr_matvec, bsr_matvecs and bsr_matmat_pass2.
+ *
+ * The *_generic kernels handle any block size. For square blocks of the
+ * common sizes listed in BSR_FIXED_BLOCKSIZE_CASES, the *_fixed kernels
+ * have the block dimensions as template parameters, so that the loops over
+ * a block are unrolled and vectorized by the compiler. Both produce
+ * identical results.
+ */
 template <class I, class T>
-void bsr_matmat_pass2(const I n_brow,  const I n_bcol,
-                      const I R,       const I C,       const I N,
-                      const I Ap[],    const I Aj[],    const T Ax[],
-                      const I Bp[],    const I Bj[],    const T Bx[],
-                            I Cp[],          I Cj[],          T Cx[])
-{
-    assert(R > 0 && C > 0 && N > 0);
+struct bsr_gemv_generic {
+    bsr_gemv_generic(const I R, const I C) : R(R), C(C) {}
+    void operator()(const T * A, const T * x, T * y) const {
+        gemv(R, C, A, x, y);
+    }
+    const I R, C;
+};
 
-    if( R == 1 && N == 1 && C == 1 ){
-        // Use CSR for 1x1 blocksize
-        csr_matmat_pass2(n_brow, n_bcol, Ap, Aj, Ax, Bp, Bj, Bx, Cp, Cj, Cx);
-        return;
+template <int S, class T>
+struct bsr_gemv_fixed {
+    void operator()(const T * A, const T * x, T * y) const {
+        gemv_fixed<S, S>(A, x, y);
+    }
+};
+
+template <class I, class T>
+struct bsr_gemm_vecs_generic {
+    bsr_gemm_vecs_generic(const I R, const I C, const I n_vecs)
+        : R(R), C(C), n_vecs(n_vecs) {}
+    void operator()(const T * A, const T * x, T * y) const {
+        gemm(R, n_vecs, C, A, x, y);
+    }
+    const I R, C, n_vecs;
+};
+
+template <int S, class I, class T>
+struct bsr_gemm_vecs_fixed {
+    explicit bsr_gemm_vecs_fixed(const I n_vecs) : n_vecs(n_vecs) {}
+    void operator()(const T * A, const T * x, T * y) const {
+        gemm_fixed_mk<S, S>(n_vecs, A, x, y);
     }
+    const I n_vecs;
+};
 
+template <class I, class T>
+struct bsr_gemm_generic {
+    bsr_gemm_generic(const I R, const I C, const I N) : R(R), C(C), N(N) {}
+    void operator()(const T * A, const T * B, T * Y) const {
+        gemm(R, C, N, A, B, Y);
+    }
+    const I R, C, N;
+};
+
+template <int S, class T>
+struct bsr_gemm_fixed {
+    void operator()(const T * A, const T * B, T * Y) const {
+        gemm_fixed<S, S, S>(A, B, Y);
+    }
+};
+
+// Square block sizes with specialized kernels
+#define BSR_FIXED_BLOCKSIZE_CASES(CASE) CASE(2) CASE(3) CASE(4) CASE(6) CASE(8)
+
+
+template <class I, class T, class block_gemm>
+void bsr_matmat_pass2_impl(const I n_brow,  const I n_bcol,
+                           const I R,       const I C,       const I N,
+                           const I Ap[],    const I Aj[],    const T Ax[],
+                           const I Bp[],    const I Bj[],    const T Bx[],
+                                 I Cp[],          I Cj[],          T Cx[],
+                           const block_gemm& gemm_op)
+{
     const npy_intp RC = (npy_intp)R*C;
     const npy_intp RN = (npy_intp)R*N;
     const npy_intp NC = (npy_intp)N*C;
@@ -298,7 +424,7 @@ void bsr_matmat_pass2(const I n_brow,  const I n_bcol,
                 const T * A = Ax + jj*RN;
                 const T * B = Bx + kk*NC;
 
-                gemm(R, C, N, A, B, mats[k]);
+                gemm_op(A, B, mats[k]);
             }
         }
 
@@ -312,6 +438,40 @@ void bsr_matmat_pass2(const I n_brow,  const I n_bcol,
 }
 
 
+template <class I, class T>
+void bsr_matmat_pass2(const I n_brow,  const I n_bcol,
+                      const I R,       const I C,       const I N,
+                      const I Ap[],    const I Aj[],    const T Ax[],
+                      const I Bp[],    const I Bj[],    const T Bx[],
+                            I Cp[],          I Cj[],          T Cx[])
+{
+    assert(R > 0 && C > 0 && N > 0);
+
+    if( R == 1 && N == 1 && C == 1 ){
+        // Use CSR for 1x1 blocksize
+        csr_matmat_pass2(n_brow, n_bcol, Ap, Aj, Ax, Bp, Bj, Bx, Cp, Cj, Cx);
+        return;
+    }
+
+    if( R == C && R == N ){
+        switch(R){
+#define CASE(S)                                                              \
+        case S:                                                              \
+            bsr_matmat_pass2_impl(n_brow, n_bcol, R, C, N, Ap, Aj, Ax,       \
+                                  Bp, Bj, Bx, Cp, Cj, Cx,                    \
+                                  bsr_gemm_fixed<S, T>());                   \
+            return;
+        BSR_FIXED_BLOCKSIZE_CASES(CASE)
+#undef CASE
+        }
+    }
+
+    bsr_matmat_pass2_impl(n_brow, n_bcol, R, C, N, Ap, Aj, Ax,
+                          Bp, Bj, Bx, Cp, Cj, Cx,
+                          bsr_gemm_generic<I, T>(R, C, N));
+}
+
+
 
 
 template <class I, class T>
@@ -588,6 +748,94 @@ void bsr_binop_bsr(const I n_brow, const I n_bcol,
     }
 }
 
+template <class I, class T, class T2, class bin_op>
+void bsr_binop_bsr_parallel(const I n_brow, const I n_bcol,
+                            const I R,      const I C,
+                            const I Ap[],   const I Aj[],   const T Ax[],
+                            const I Bp[],   const I Bj[],   const T Bx[],
+                                  I Cp[],         I Cj[],        T2 Cx[],
+                            const bin_op& op,
+                            const I workers)
+{
+    binop_parallel_rows(n_brow, (npy_intp)R*C, Ap, Bp, Cp, Cj, Cx, workers,
+        [&](I r0, I r1, I Cp_local[], I Cj_out[], T2 Cx_out[]) {
+            bsr_binop_bsr(r1 - r0, n_bcol, R, C, Ap + r0, Aj, Ax, Bp + r0, Bj, Bx,
+                          Cp_local, Cj_out, Cx_out, op);
+        });
+}
+
+
+/*
+ * Threaded versions of the elementwise operations on BSR matrices
+ *
+ * Input Arguments:
+ *   I    op          - one of the BINOP_* (resp. CMPOP_*) codes
+ *   I    workers     - maximum number of threads to use
+ *
+ * The remaining arguments are as for bsr_binop_bsr.
+ *
+ */
+template <class I, class T>
+void bsr_binop_bsr_threaded(const I n_brow, const I n_bcol, const I R, const I C,
+                            const I Ap[], const I Aj[], const T Ax[],
+                            const I Bp[], const I Bj[], const T Bx[],
+                                  I Cp[],       I Cj[],       T Cx[],
+                            const I op,
+                            const I workers)
+{
+    switch (op) {
+    case BINOP_PLUS:
+        bsr_binop_bsr_parallel(n_brow,n_bcol,R,C,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,std::plus<T>(),workers);
+        break;
+    case BINOP_MINUS:
+        bsr_binop_bsr_parallel(n_brow,n_bcol,R,C,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,std::minus<T>(),workers);
+        break;
+    case BINOP_ELMUL:
+        bsr_binop_bsr_parallel(n_brow,n_bcol,R,C,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,std::multiplies<T>(),workers);
+        break;
+    case BINOP_ELDIV:
+        bsr_binop_bsr_parallel(n_brow,n_bcol,R,C,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,std::divides<T>(),workers);
+        break;
+    case BINOP_MAXIMUM:
+        bsr_binop_bsr_parallel(n_brow,n_bcol,R,C,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,maximum<T>(),workers);
+        break;
+    case BINOP_MINIMUM:
+        bsr_binop_bsr_parallel(n_brow,n_bcol,R,C,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,minimum<T>(),workers);
+        break;
+    default:
+        throw std::domain_error("unknown binary operation");
+    }
+}
+
+template <class I, class T, class T2>
+void bsr_cmpop_bsr_threaded(const I n_brow, const I n_bcol, const I R, const I C,
+                            const I Ap[], const I Aj[], const T Ax[],
+                            const I Bp[], const I Bj[], const T Bx[],
+                                  I Cp[],       I Cj[],      T2 Cx[],
+                            const I op,
+                            const I workers)
+{
+    switch (op) {
+    case CMPOP_NE:
+        bsr_binop_bsr_parallel(n_brow,n_bcol,R,C,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,std::not_equal_to<T>(),workers);
+        break;
+    case CMPOP_LT:
+        bsr_binop_bsr_parallel(n_brow,n_bcol,R,C,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,std::less<T>(),workers);
+        break;
+    case CMPOP_GT:
+        bsr_binop_bsr_parallel(n_brow,n_bcol,R,C,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,std::greater<T>(),workers);
+        break;
+    case CMPOP_LE:
+        bsr_binop_bsr_parallel(n_brow,n_bcol,R,C,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,std::less_equal<T>(),workers);
+        break;
+    case CMPOP_GE:
+        bsr_binop_bsr_parallel(n_brow,n_bcol,R,C,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,std::greater_equal<T>(),workers);
+        break;
+    default:
+        throw std::domain_error("unknown comparison operation");
+    }
+}
+
 /* element-wise binary operations */
 template <class I, class T, class T2>
 void bsr_ne_bsr(const I n_row, const I n_col, const I R, const I C,
@@ -768,6 +1016,30 @@ void bsr_tocsr(const I n_brow, const I n_bcol, const I R, const I C,
 }
 
 
+template <class I, class T, class block_gemv>
+void bsr_matvec_impl(const I n_brow,
+                     const I R,
+                     const I C,
+                     const I Ap[],
+                     const I Aj[],
+                     const T Ax[],
+                     const T Xx[],
+                           T Yx[],
+                     const block_gemv& gemv_op)
+{
+    const npy_intp RC = (npy_intp)R*C;
+    for(I i = 0; i < n_brow; i++){
+        T * y = Yx + (npy_intp)R * i;
+        for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+            const I j = Aj[jj];
+            const T * A = Ax + RC * jj;
+            const T * x = Xx + (npy_intp)C * j;
+            gemv_op(A, x, y); // y += A*x
+        }
+    }
+}
+
+
 template <class I, class T>
 void bsr_matvec(const I n_brow,
                 const I n_bcol,
@@ -787,16 +1059,20 @@ void bsr_matvec(const I n_brow,
         return;
     }
 
-    const npy_intp RC = (npy_intp)R*C;
-    for(I i = 0; i < n_brow; i++){
-        T * y = Yx + (npy_intp)R * i;
-        for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
-            const I j = Aj[jj];
-            const T * A = Ax + RC * jj;
-            const T * x = Xx + (npy_intp)C * j;
-            gemv(R, C, A, x, y); // y += A*x
+    if( R == C ){
+        switch(R){
+#define CASE(S)                                                              \
+        case S:                                                              \
+            bsr_matvec_impl(n_brow, R, C, Ap, Aj, Ax, Xx, Yx,                \
+                            bsr_gemv_fixed<S, T>());                         \
+            return;
+        BSR_FIXED_BLOCKSIZE_CASES(CASE)
+#undef CASE
         }
     }
+
+    bsr_matvec_impl(n_brow, R, C, Ap, Aj, Ax, Xx, Yx,
+                    bsr_gemv_generic<I, T>(R, C));
 }
 
 
@@ -819,6 +1095,34 @@ void bsr_matvec(const I n_brow,
  *   T  Yx[R*n_brow,n_vecs] - output vector
  *
  */
+template <class I, class T, class block_gemm>
+void bsr_matvecs_impl(const I n_brow,
+                      const I n_vecs,
+                      const I R,
+                      const I C,
+                      const I Ap[],
+                      const I Aj[],
+                      const T Ax[],
+                      const T Xx[],
+                            T Yx[],
+                      const block_gemm& gemm_op)
+{
+    const npy_intp A_bs = (npy_intp)R*C;      //Ax blocksize
+    const npy_intp Y_bs = (npy_intp)n_vecs*R; //Yx blocksize
+    const npy_intp X_bs = (npy_intp)C*n_vecs; //Xx blocksize
+
+    for(I i = 0; i < n_brow; i++){
+        T * y = Yx + Y_bs * i;
+        for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+            const I j = Aj[jj];
+            const T * A = Ax + A_bs * jj;
+            const T * x = Xx + X_bs * j;
+            gemm_op(A, x, y); // y += A*x
+        }
+    }
+}
+
+
 template <class I, class T>
 void bsr_matvecs(const I n_brow,
                  const I n_bcol,
@@ -839,19 +1143,20 @@ void bsr_matvecs(const I n_brow,
         return;
     }
 
-    const npy_intp A_bs = (npy_intp)R*C;      //Ax blocksize
-    const npy_intp Y_bs = (npy_intp)n_vecs*R; //Yx blocksize
-    const npy_intp X_bs = (npy_intp)C*n_vecs; //Xx blocksize
-
-    for(I i = 0; i < n_brow; i++){
-        T * y = Yx + Y_bs * i;
-        for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
-            const I j = Aj[jj];
-            const T * A = Ax + A_bs * jj;
-            const T * x = Xx + X_bs * j;
-            gemm(R, n_vecs, C, A, x, y); // y += A*x
+    if( R == C ){
+        switch(R){
+#define CASE(S)                                                              \
+        case S:                                                              \
+            bsr_matvecs_impl(n_brow, n_vecs, R, C, Ap, Aj, Ax, Xx, Yx,       \
+                             bsr_gemm_vecs_fixed<S, I, T>(n_vecs));          \
+            return;
+        BSR_FIXED_BLOCKSIZE_CASES(CASE)
+#undef CASE
         }
     }
+
+    bsr_matvecs_impl(n_brow, n_vecs, R, C, Ap, Aj, Ax, Xx, Yx,
+                     bsr_gemm_vecs_generic<I, T>(R, C, n_vecs));
 }
 
 
@@ -16,6 +16,12 @@ class complex_wrapper : public npy_type {
             npy_type::real = r;
             npy_type::imag = i;
         }
+        /* Conversion from other precisions */
+        template <class c_type2, class npy_type2>
+        explicit complex_wrapper( const complex_wrapper<c_type2, npy_type2>& B ){
+            npy_type::real = B.real;
+            npy_type::imag = B.imag;
+        }
         /* Conversion */
         operator bool() const {
             if (npy_type::real == 0 && npy_type::imag == 0) {
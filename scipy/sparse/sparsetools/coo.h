@@ -2,6 +2,10 @@
 #define __COO_H__
 
 #include <algorithm>
+#include <vector>
+
+#include "parallel.h"
+#include "sort.h"
 
 /*
  * Compute B = A for COO matrix A, CSR matrix B
@@ -76,6 +80,164 @@ void coo_tocsr(const I n_row,
     //now Bp,Bj,Bx form a CSR representation (with possible duplicates)
 }
 
+
+/*
+ * Compute B = A for COO matrix A, CSR matrix B, summing duplicates
+ *
+ * This is equivalent to coo_tocsr followed by csr_sort_indices and
+ * csr_sum_duplicates, but fused and optionally threaded: entries are
+ * bucketed by row using per-chunk row histograms, each row is then sorted
+ * by column (stable radix sort) and its duplicates summed, and finally the
+ * rows are compacted.
+ *
+ * Input Arguments:
+ *   I  n_row      - number of rows in A
+ *   I  n_col      - number of columns in A
+ *   I  nnz        - number of nonzeros in A
+ *   I  Ai[nnz(A)] - row indices
+ *   I  Aj[nnz(A)] - column indices
+ *   T  Ax[nnz(A)] - nonzeros
+ *   I  workers    - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   I Bp[n_row+1] - row pointer
+ *   I Bj[nnz(A)]  - column indices
+ *   T Bx[nnz(A)]  - nonzeros
+ *
+ * Note:
+ *   Output arrays Bp, Bj, and Bx must be preallocated
+ *
+ * Note:
+ *   Input:  row and column indices *are not* assumed to be ordered
+ *   Output: B is in canonical format, with Bp[n_row] entries; Bj and Bx
+ *           are not shrunk
+ *
+ *   Duplicates are summed in the order they appear in A. Explicit zeros,
+ *   including duplicates that sum to zero, are kept.
+ *
+ *   Complexity: Linear.  Specifically O(nnz(A) + n_row), times the number
+ *   of 8-bit digits in n_col for rows longer than SPTOOLS_INSERTION_SORT_MAX
+ *
+ */
+template <class I, class T>
+void coo_tocsr_canonical(const I n_row,
+                         const I n_col,
+                         const I nnz,
+                         const I Ai[],
+                         const I Aj[],
+                         const T Ax[],
+                               I Bp[],
+                               I Bj[],
+                               T Bx[],
+                         const I workers)
+{
+    // bucket entries by row; chunks of entries keep per-chunk row counts,
+    // limited so that the counts are no larger than A itself
+    npy_intp n_chunks = parallel_num_chunks(workers, (npy_intp)nnz + n_row);
+    if (n_row > 0) {
+        n_chunks = std::max((npy_intp)1,
+                            std::min(n_chunks, (npy_intp)nnz / n_row));
+    }
+
+    if (n_chunks == 1) {
+        coo_tocsr(n_row, n_col, nnz, Ai, Aj, Ax, Bp, Bj, Bx);
+    }
+    else {
+        std::vector<I> offsets((npy_intp)n_chunks * n_row, 0);
+
+        parallel_for_chunks(n_chunks, [&](npy_intp c) {
+            I *count = &offsets[c * n_row];
+            const I n_end = (npy_intp)nnz * (c + 1) / n_chunks;
+            for(I n = (npy_intp)nnz * c / n_chunks; n < n_end; n++){
+                count[Ai[n]]++;
+            }
+        });
+
+        parallel_for_chunks(n_chunks, [&](npy_intp c) {
+            const I i_start = (npy_intp)n_row * c / n_chunks;
+            const I i_end = (npy_intp)n_row * (c + 1) / n_chunks;
+            for(I i = i_start; i < i_end; i++){
+                I cumsum = 0;
+                for(npy_intp k = 0; k < n_chunks; k++){
+                    I temp = offsets[k * n_row + i];
+                    offsets[k * n_row + i] = cumsum;
+                    cumsum += temp;
+                }
+                Bp[i] = cumsum;
+            }
+        });
+
+        for(I i = 0, cumsum = 0; i < n_row; i++){
+            I temp = Bp[i];
+            Bp[i] = cumsum;
+            cumsum += temp;
+        }
+        Bp[n_row] = nnz;
+
+        parallel_for_chunks(n_chunks, [&](npy_intp c) {
+            I *next = &offsets[c * n_row];
+            const I n_end = (npy_intp)nnz * (c + 1) / n_chunks;
+            for(I n = (npy_intp)nnz * c / n_chunks; n < n_end; n++){
+                I row  = Ai[n];
+                I dest = Bp[row] + next[row];
+
+                Bj[dest] = Aj[n];
+                Bx[dest] = Ax[n];
+
+                next[row]++;
+            }
+        });
+    }
+
+    // sort each row and sum its duplicates in place
+    std::vector<I> row_nnz(n_row);
+
+    const npy_intp n_row_chunks = parallel_num_chunks(workers, (npy_intp)nnz + n_row);
+    std::vector<I> bounds(n_row_chunks + 1);
+    partition_rows_by_nnz(n_row, Bp, (I)n_row_chunks, &bounds[0]);
+
+    parallel_for_chunks(n_row_chunks, [&](npy_intp c) {
+        std::vector<I> tmp_j;
+        std::vector<T> tmp_x;
+
+        for(I i = bounds[c]; i < bounds[c+1]; i++){
+            const I start = Bp[i];
+            const I len = Bp[i+1] - start;
+            I *row_j = Bj + start;
+            T *row_x = Bx + start;
+
+            sort_by_index(len, (I)0, (I)(n_col - 1), row_j, row_x, tmp_j, tmp_x);
+
+            I m = 0;
+            for(I k = 0; k < len; m++){
+                const I j = row_j[k];
+                T x = row_x[k];
+                k++;
+                while(k < len && row_j[k] == j){
+                    x += row_x[k];
+                    k++;
+                }
+                row_j[m] = j;
+                row_x[m] = x;
+            }
+            row_nnz[i] = m;
+        }
+    });
+
+    // compact the rows
+    I dest = 0;
+    for(I i = 0; i < n_row; i++){
+        const I start = Bp[i];
+        Bp[i] = dest;
+        if (start != dest) {
+            std::copy(Bj + start, Bj + start + row_nnz[i], Bj + dest);
+            std::copy(Bx + start, Bx + start + row_nnz[i], Bx + dest);
+        }
+        dest += row_nnz[i];
+    }
+    Bp[n_row] = dest;
+}
+
 /*
  * Compute B += A for COO matrix A, dense matrix B
  *
@@ -145,4 +307,122 @@ void coo_matvec(const npy_int64 nnz,
     }
 }
 
+
+/*
+ * Slot of a key in an open-addressing hash table of capacity `mask + 1`,
+ * a power of two; the bits of the key are mixed as in splitmix64, so that
+ * the keys of neighbouring entries spread over the table.
+ */
+inline npy_int64 coo_hash_slot(const npy_int64 key, const npy_int64 mask)
+{
+    npy_uint64 h = (npy_uint64)key;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    h = h ^ (h >> 31);
+    return (npy_int64)(h & (npy_uint64)mask);
+}
+
+
+/*
+ * Add values to the entries of a hash table of (key, value) pairs
+ *
+ * The table holds the entries of a sparse matrix under assembly, keyed by
+ * row * n_col + col, with linear probing; empty slots have the key -1.
+ * The value of a key that is already in the table is added to its entry,
+ * and a new key takes the first empty slot from its hash on.
+ *
+ * Keys that are negative are skipped, so that the slots of another table
+ * can be added as they are, to rehash or merge it.
+ *
+ * Input Arguments:
+ *   npy_int64  n                     - number of entries to add
+ *   npy_int64  keys[n]               - keys of the entries
+ *   T          vals[n]               - values of the entries
+ *   npy_int64  capacity              - number of slots, a power of two
+ *
+ * Input/Output Arguments:
+ *   npy_int64  table_keys[capacity]  - keys of the slots, or -1
+ *   T          table_vals[capacity]  - values of the slots
+ *
+ * Return value:
+ *   The number of keys that were not in the table before.
+ *
+ * Note:
+ *   The table must have an empty slot left after the new keys are added;
+ *   the caller keeps it at most half full.
+ *
+ */
+template <class I, class T>
+npy_int64 coo_hash_add(const npy_int64 n,
+                       const npy_int64 keys[],
+                       const T vals[],
+                       const npy_int64 capacity,
+                             npy_int64 table_keys[],
+                             T table_vals[])
+{
+    const npy_int64 mask = capacity - 1;
+    npy_int64 added = 0;
+
+    for(npy_int64 k = 0; k < n; k++){
+        const npy_int64 key = keys[k];
+        if (key < 0) {
+            continue;
+        }
+        npy_int64 slot = coo_hash_slot(key, mask);
+        while (table_keys[slot] != key && table_keys[slot] >= 0) {
+            slot = (slot + 1) & mask;
+        }
+        if (table_keys[slot] == key) {
+            table_vals[slot] += vals[k];
+        } else {
+            table_keys[slot] = key;
+            table_vals[slot] = vals[k];
+            added++;
+        }
+    }
+    return added;
+}
+
+
+/*
+ * Extract the entries of a hash table built by coo_hash_add in COO format
+ *
+ * Input Arguments:
+ *   npy_int64  capacity              - number of slots
+ *   npy_int64  table_keys[capacity]  - keys of the slots, or -1
+ *   T          table_vals[capacity]  - values of the slots
+ *   I          n_col                 - number of columns of the matrix
+ *
+ * Output Arguments:
+ *   I  Ai[nnz]    - row indices
+ *   I  Aj[nnz]    - column indices
+ *   T  Ax[nnz]    - values
+ *
+ * Note:
+ *   Output arrays Ai, Aj and Ax must be preallocated, with nnz the number
+ *   of keys in the table. The entries come in the order of the slots, and
+ *   have no duplicates.
+ *
+ */
+template <class I, class T>
+void coo_hash_extract(const npy_int64 capacity,
+                      const npy_int64 table_keys[],
+                      const T table_vals[],
+                      const I n_col,
+                            I Ai[],
+                            I Aj[],
+                            T Ax[])
+{
+    npy_int64 n = 0;
+    for(npy_int64 slot = 0; slot < capacity; slot++){
+        const npy_int64 key = table_keys[slot];
+        if (key >= 0) {
+            Ai[n] = (I)(key / n_col);
+            Aj[n] = (I)(key % n_col);
+            Ax[n] = table_vals[slot];
+            n++;
+        }
+    }
+}
+
 #endif
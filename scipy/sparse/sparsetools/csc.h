@@ -85,6 +85,102 @@ void csc_matvecs(const I n_row,
 
 
 
+/*
+ * Threaded version of csc_matvecs
+ *
+ * The columns of A are split into chunks balanced by nnz. Since the chunks
+ * scatter into overlapping rows of Y, every chunk but the first adds into
+ * a private copy of Y, and the copies are summed into Y afterwards.
+ *
+ * With A the CSC view of the transpose of a CSR matrix, this computes
+ * A^T X for that CSR matrix without converting it.
+ *
+ * Input Arguments:
+ *   I  workers          - maximum number of threads to use
+ *
+ * The remaining arguments are as for csc_matvecs.
+ *
+ * Note:
+ *   The private copies take n_row*n_vecs entries per chunk, so the number
+ *   of chunks is limited to keep them no larger than A times n_vecs.
+ *
+ */
+template <class I, class T>
+void csc_matvecs_threaded(const I n_row,
+                          const I n_col,
+                          const I n_vecs,
+                          const I Ap[],
+                          const I Ai[],
+                          const T Ax[],
+                          const T Xx[],
+                                T Yx[],
+                          const I workers)
+{
+    const npy_intp nnz = Ap[n_col];
+    const npy_intp y_size = (npy_intp)n_row * n_vecs;
+
+    npy_intp n_chunks = parallel_num_chunks(workers, (nnz + n_col) * n_vecs);
+    if (y_size > 0) {
+        n_chunks = std::min(n_chunks, 1 + nnz * n_vecs / y_size);
+    }
+    if (n_chunks <= 1) {
+        if (n_vecs == 1) {
+            csc_matvec(n_row, n_col, Ap, Ai, Ax, Xx, Yx);
+        } else {
+            csc_matvecs(n_row, n_col, n_vecs, Ap, Ai, Ax, Xx, Yx);
+        }
+        return;
+    }
+
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_col, Ap, (I)n_chunks, &bounds[0]);
+
+    std::vector<T> buffers((n_chunks - 1) * y_size, 0);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        const I col_start = bounds[c];
+        const I col_end   = bounds[c+1];
+        T *y = (c == 0) ? Yx : &buffers[(c - 1) * y_size];
+        if (n_vecs == 1) {
+            csc_matvec(n_row, col_end - col_start, Ap + col_start, Ai, Ax,
+                       Xx + col_start, y);
+        } else {
+            csc_matvecs(n_row, col_end - col_start, n_vecs, Ap + col_start,
+                        Ai, Ax, Xx + (npy_intp)n_vecs * col_start, y);
+        }
+    });
+
+    // sum the private copies into Y
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        const npy_intp start = y_size * c / n_chunks;
+        const npy_intp end   = y_size * (c + 1) / n_chunks;
+        for(npy_intp k = 0; k < n_chunks - 1; k++){
+            const T *y = &buffers[k * y_size];
+            for(npy_intp i = start; i < end; i++){
+                Yx[i] += y[i];
+            }
+        }
+    });
+}
+
+
+/*
+ * Threaded version of csc_matvec, see csc_matvecs_threaded
+ */
+template <class I, class T>
+void csc_matvec_threaded(const I n_row,
+                         const I n_col,
+                         const I Ap[],
+                         const I Ai[],
+                         const T Ax[],
+                         const T Xx[],
+                               T Yx[],
+                         const I workers)
+{
+    csc_matvecs_threaded(n_row, n_col, (I)1, Ap, Ai, Ax, Xx, Yx, workers);
+}
+
+
 
 /*
  * Derived methods
@@ -112,6 +208,19 @@ void csc_tocsr(const I n_row,
 { csr_tocsc<I,T>(n_col, n_row, Ap, Ai, Ax, Bp, Bj, Bx); }
 
 
+template <class I, class T>
+void csc_tocsr_threaded(const I n_row,
+                        const I n_col,
+                        const I Ap[],
+                        const I Ai[],
+                        const T Ax[],
+                              I Bp[],
+                              I Bj[],
+                              T Bx[],
+                        const I workers)
+{ csr_tocsc_threaded<I,T>(n_col, n_row, Ap, Ai, Ax, Bp, Bj, Bx, workers); }
+
+
 template <class I>
 void csc_matmat_pass1(const I n_row,
                       const I n_col,
@@ -136,6 +245,54 @@ void csc_matmat_pass2(const I n_row,
                             T Cx[])
 { csr_matmat_pass2(n_col, n_row, Bp, Bi, Bx, Ap, Ai, Ax, Cp, Ci, Cx); }
 
+template <class I>
+void csc_matmat_pass1_threaded(const I n_row,
+                               const I n_col,
+                               const I Ap[],
+                               const I Ai[],
+                               const I Bp[],
+                               const I Bi[],
+                                     I Cp[],
+                               const I workers)
+{ csr_matmat_pass1_threaded(n_col, n_row, Bp, Bi, Ap, Ai, Cp, workers); }
+
+template <class I, class T>
+void csc_matmat_pass2_threaded(const I n_row,
+                               const I n_col,
+                               const I Ap[],
+                               const I Ai[],
+                               const T Ax[],
+                               const I Bp[],
+                               const I Bi[],
+                               const T Bx[],
+                                     I Cp[],
+                                     I Ci[],
+                                     T Cx[],
+                               const I workers)
+{ csr_matmat_pass2_threaded(n_col, n_row, Bp, Bi, Bx, Ap, Ai, Ax, Cp, Ci, Cx, workers); }
+
+template <class I, class T>
+void csc_binop_csc_threaded(const I n_row, const I n_col,
+                            const I Ap[], const I Ai[], const T Ax[],
+                            const I Bp[], const I Bi[], const T Bx[],
+                                  I Cp[],       I Ci[],       T Cx[],
+                            const I op,
+                            const I workers)
+{
+    csr_binop_csr_threaded(n_col, n_row, Ap, Ai, Ax, Bp, Bi, Bx, Cp, Ci, Cx, op, workers);
+}
+
+template <class I, class T, class T2>
+void csc_cmpop_csc_threaded(const I n_row, const I n_col,
+                            const I Ap[], const I Ai[], const T Ax[],
+                            const I Bp[], const I Bi[], const T Bx[],
+                                  I Cp[],       I Ci[],      T2 Cx[],
+                            const I op,
+                            const I workers)
+{
+    csr_cmpop_csr_threaded(n_col, n_row, Ap, Ai, Ax, Bp, Bi, Bx, Cp, Ci, Cx, op, workers);
+}
+
 template <class I, class T, class T2>
 void csc_ne_csc(const I n_row, const I n_col,
                 const I Ap[], const I Ai[], const T Ax[],
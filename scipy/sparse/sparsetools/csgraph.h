@@ -2,6 +2,10 @@
 #define __CSGRAPH_H__
 
 #include <vector>
+#include <atomic>
+#include <algorithm>
+
+#include "parallel.h"
 
 /*
  * Determine connected compoments of a compressed sparse graph.
@@ -73,4 +77,1244 @@ I cs_graph_components(const I n_nod,
   return n_comp;
 }
 
+
+/*
+ * Merge the union-find trees of nodes u and v
+ *
+ * Roots are only ever linked to smaller roots, with a compare-and-swap,
+ * so concurrent calls are safe and the root of a tree is always its
+ * smallest node.
+ */
+template <class I>
+void cs_graph_uf_link(I u, I v, std::atomic<I> parent[])
+{
+  I p1 = parent[u].load(std::memory_order_relaxed);
+  I p2 = parent[v].load(std::memory_order_relaxed);
+  while (p1 != p2) {
+    const I high = std::max(p1, p2);
+    const I low = std::min(p1, p2);
+    I p_high = parent[high].load(std::memory_order_relaxed);
+    if (p_high == low) {
+      break;
+    }
+    if (p_high == high &&
+        parent[high].compare_exchange_strong(p_high, low)) {
+      break;
+    }
+    p1 = parent[parent[high].load(std::memory_order_relaxed)].load(
+        std::memory_order_relaxed);
+    p2 = parent[low].load(std::memory_order_relaxed);
+  }
+}
+
+
+/*
+ * Determine the connected components of an undirected compressed sparse
+ * graph, using several threads
+ *
+ * Each stored edge (i, Aj[jj]) joins its two nodes, either way, so A
+ * does not need to be symmetric: the components are those of A + A^T.
+ *
+ * The edges are split into chunks of rows, and each thread merges the
+ * union-find trees of the endpoints of its edges with lock-free
+ * linking, as in the Shiloach-Vishkin and Afforest algorithms. The
+ * trees are then flattened, and the components numbered in the order
+ * of their smallest node. This is the same labeling as a serial
+ * search started from each unlabeled node in turn.
+ *
+ * Input Arguments:
+ *   I  n_nod         - number of nodes
+ *   I  Ap[n_nod+1]   - row pointer
+ *   I  Aj[nnz(A)]    - column indices
+ *   I  workers       - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   I  flag[n_nod]   - component label of each node
+ *
+ * Return value:
+ *   The number of components.
+ *
+ * Note:
+ *   Output array flag must be preallocated
+ *
+ * Reference:
+ *   M. Sutton, T. Ben-Nun, A. Barak, "Optimizing Parallel Graph
+ *   Connectivity Computation via Subgraph Sampling", IPDPS 2018.
+ *
+ */
+template <class I>
+I cs_graph_components_parallel(const I n_nod,
+                               const I Ap[],
+                               const I Aj[],
+                                     I flag[],
+                               const I workers)
+{
+  std::vector<std::atomic<I> > parent(n_nod);
+
+  const I n_chunks = parallel_num_chunks(workers, (npy_intp)Ap[n_nod] + n_nod);
+  std::vector<I> bounds(n_chunks + 1);
+  partition_rows_by_nnz(n_nod, Ap, n_chunks, &bounds[0]);
+
+  parallel_for_chunks(n_chunks, [&](npy_intp c) {
+    for (I i = bounds[c]; i < bounds[c+1]; i++) {
+      parent[i].store(i, std::memory_order_relaxed);
+    }
+  });
+
+  parallel_for_chunks(n_chunks, [&](npy_intp c) {
+    for (I i = bounds[c]; i < bounds[c+1]; i++) {
+      for (I jj = Ap[i]; jj < Ap[i+1]; jj++) {
+        cs_graph_uf_link(i, Aj[jj], &parent[0]);
+      }
+    }
+  });
+
+  // point every node directly at its root
+  parallel_for_chunks(n_chunks, [&](npy_intp c) {
+    for (I i = bounds[c]; i < bounds[c+1]; i++) {
+      I p = parent[i].load(std::memory_order_relaxed);
+      I pp = parent[p].load(std::memory_order_relaxed);
+      while (p != pp) {
+        p = pp;
+        pp = parent[p].load(std::memory_order_relaxed);
+      }
+      parent[i].store(p, std::memory_order_relaxed);
+    }
+  });
+
+  // roots are the smallest nodes of their trees, so they are numbered
+  // before any other node of their component
+  I n_comp = 0;
+  for (I i = 0; i < n_nod; i++) {
+    const I root = parent[i].load(std::memory_order_relaxed);
+    flag[i] = (root == i) ? n_comp++ : flag[root];
+  }
+
+  return n_comp;
+}
+
+
+/*
+ * Number of frontier nodes (top-down) or of nodes (bottom-up) in a block
+ * of work claimed by a thread of cs_graph_bfs_parallel
+ */
+#define CS_GRAPH_BFS_TD_BLOCK 64
+#define CS_GRAPH_BFS_BU_BLOCK 4096
+
+/*
+ * Direction switching thresholds of cs_graph_bfs_parallel, as tuned by
+ * Beamer et al.
+ */
+#define CS_GRAPH_BFS_ALPHA 14
+#define CS_GRAPH_BFS_BETA 24
+
+
+/*
+ * Number of edges of node v in the adjacency Ap, plus those in Tp if both
+ */
+template <class I>
+inline npy_intp cs_graph_bfs_degree(const I v, const I Ap[], const I Tp[],
+                                    const bool both)
+{
+  npy_intp d = (npy_intp)Ap[v+1] - Ap[v];
+  if (both) {
+    d += (npy_intp)Tp[v+1] - Tp[v];
+  }
+  return d;
+}
+
+
+/*
+ * One top-down step of cs_graph_bfs_parallel
+ *
+ * The threads claim blocks of the frontier and scan the edges out of its
+ * nodes. Each unvisited node reached keeps the lowest frontier node that
+ * reaches it in cand, updated with compare-and-swap; the thread which
+ * first claims it lists it, and marks it in bits.
+ *
+ * The new nodes are then written to next in ascending order: by sorting
+ * them if they are few, otherwise by reading them off bits, which is
+ * cleared as it goes.
+ *
+ * Returns the number of new nodes; their number of edges is added to
+ * *m_next.
+ */
+template <class I>
+I cs_graph_bfs_top_down(const I n_nod,
+                        const I Ap[], const I Aj[],
+                        const I Tp[], const I Tj[], const bool both,
+                        const I frontier[], const I n_f, const npy_intp m_f,
+                        const I depth, const I workers,
+                        I next[], I pred[], I level[],
+                        std::atomic<I> cand[],
+                        std::atomic<npy_uint64> bits[],
+                        npy_intp *m_next)
+{
+  const npy_intp n_words = ((npy_intp)n_nod + 63) / 64;
+  const npy_intp n_blocks = ((npy_intp)n_f + CS_GRAPH_BFS_TD_BLOCK - 1)
+                            / CS_GRAPH_BFS_TD_BLOCK;
+  const npy_intp n_chunks = std::min(
+      parallel_num_chunks(workers, m_f + n_f), n_blocks);
+  std::atomic<npy_intp> next_block(0);
+  std::vector<std::vector<I> > found(n_chunks);
+
+  parallel_for_chunks(n_chunks, [&](npy_intp c) {
+    std::vector<I>& mine = found[c];
+    auto visit = [&](const I u, const I Xp[], const I Xj[]) {
+      for (I jj = Xp[u]; jj < Xp[u+1]; jj++) {
+        const I v = Xj[jj];
+        if (level[v] != -1) {
+          continue;
+        }
+        I old = cand[v].load(std::memory_order_relaxed);
+        while (u < old) {
+          if (cand[v].compare_exchange_weak(old, u,
+                                            std::memory_order_relaxed)) {
+            if (old == n_nod) {
+              mine.push_back(v);
+              bits[v / 64].fetch_or((npy_uint64)1 << (v % 64),
+                                    std::memory_order_relaxed);
+            }
+            break;
+          }
+        }
+      }
+    };
+
+    npy_intp b;
+    while ((b = next_block.fetch_add(1, std::memory_order_relaxed))
+           < n_blocks) {
+      const npy_intp end = std::min((npy_intp)n_f,
+                                    (b + 1) * CS_GRAPH_BFS_TD_BLOCK);
+      for (npy_intp k = b * CS_GRAPH_BFS_TD_BLOCK; k < end; k++) {
+        visit(frontier[k], Ap, Aj);
+        if (both) {
+          visit(frontier[k], Tp, Tj);
+        }
+      }
+    }
+  });
+
+  npy_intp n_new = 0;
+  for (npy_intp c = 0; c < n_chunks; c++) {
+    n_new += found[c].size();
+  }
+
+  if (n_new <= n_words) {
+    I *p = next;
+    for (npy_intp c = 0; c < n_chunks; c++) {
+      p = std::copy(found[c].begin(), found[c].end(), p);
+    }
+    std::sort(next, next + n_new);
+    for (npy_intp k = 0; k < n_new; k++) {
+      bits[next[k] / 64].store(0, std::memory_order_relaxed);
+    }
+  }
+  else {
+    // each chunk of words counts its nodes, then writes them out
+    const npy_intp n_wchunks = parallel_num_chunks(workers, n_words);
+    std::vector<npy_intp> offset(n_wchunks + 1, 0);
+    auto words = [&](npy_intp c, npy_intp *lo, npy_intp *hi) {
+      *lo = n_words * c / n_wchunks;
+      *hi = n_words * (c + 1) / n_wchunks;
+    };
+    parallel_for_chunks(n_wchunks, [&](npy_intp c) {
+      npy_intp lo, hi, count = 0;
+      words(c, &lo, &hi);
+      for (npy_intp w = lo; w < hi; w++) {
+        for (npy_uint64 x = bits[w].load(std::memory_order_relaxed); x != 0;
+             x &= x - 1) {
+          count++;
+        }
+      }
+      offset[c + 1] = count;
+    });
+    for (npy_intp c = 0; c < n_wchunks; c++) {
+      offset[c + 1] += offset[c];
+    }
+    parallel_for_chunks(n_wchunks, [&](npy_intp c) {
+      npy_intp lo, hi, k = offset[c];
+      words(c, &lo, &hi);
+      for (npy_intp w = lo; w < hi; w++) {
+        const npy_uint64 x = bits[w].load(std::memory_order_relaxed);
+        if (x == 0) {
+          continue;
+        }
+        for (int i = 0; i < 64; i++) {
+          if ((x >> i) & 1) {
+            next[k++] = (I)(w * 64 + i);
+          }
+        }
+        bits[w].store(0, std::memory_order_relaxed);
+      }
+    });
+  }
+
+  const npy_intp n_nchunks = parallel_num_chunks(workers, n_new);
+  std::vector<npy_intp> m_chunk(n_nchunks, 0);
+  parallel_for_chunks(n_nchunks, [&](npy_intp c) {
+    npy_intp m = 0;
+    for (npy_intp k = n_new * c / n_nchunks; k < n_new * (c + 1) / n_nchunks;
+         k++) {
+      const I v = next[k];
+      level[v] = depth + 1;
+      pred[v] = cand[v].load(std::memory_order_relaxed);
+      m += cs_graph_bfs_degree(v, Ap, Tp, both);
+    }
+    m_chunk[c] = m;
+  });
+  for (npy_intp c = 0; c < n_nchunks; c++) {
+    *m_next += m_chunk[c];
+  }
+
+  return (I)n_new;
+}
+
+
+/*
+ * One bottom-up step of cs_graph_bfs_parallel
+ *
+ * The frontier is marked in bits, and the threads claim blocks of nodes.
+ * Each unvisited node scans its incoming edges, those of the transpose
+ * Tp and Tj (or those of both Ap and Tp if both), and takes the first one
+ * from the frontier as its predecessor. Only the thread of its block writes to a node, so no
+ * atomics are needed besides bits. The new nodes of each block are
+ * counted, and then written to next in ascending order.
+ *
+ * Returns the number of new nodes; their number of edges is added to
+ * *m_next.
+ */
+template <class I>
+I cs_graph_bfs_bottom_up(const I n_nod,
+                         const I Ap[], const I Aj[],
+                         const I Tp[], const I Tj[], const bool both,
+                         const I frontier[], const I n_f, const npy_intp m_u,
+                         const I depth, const I workers,
+                         I next[], I pred[], I level[],
+                         std::atomic<npy_uint64> bits[],
+                         I counts[],
+                         npy_intp *m_next)
+{
+  const npy_intp n_blocks = ((npy_intp)n_nod + CS_GRAPH_BFS_BU_BLOCK - 1)
+                            / CS_GRAPH_BFS_BU_BLOCK;
+  const npy_intp n_chunks = std::min(
+      parallel_num_chunks(workers, (npy_intp)n_nod + m_u), n_blocks);
+  std::vector<npy_intp> m_chunk(n_chunks, 0);
+  std::atomic<npy_intp> next_block(0);
+
+  // mark the frontier
+  const npy_intp n_fchunks = parallel_num_chunks(workers, n_f);
+  parallel_for_chunks(n_fchunks, [&](npy_intp c) {
+    for (npy_intp k = n_f * c / n_fchunks; k < n_f * (c + 1) / n_fchunks;
+         k++) {
+      const I u = frontier[k];
+      bits[u / 64].fetch_or((npy_uint64)1 << (u % 64),
+                            std::memory_order_relaxed);
+    }
+  });
+
+  // in-edges: those of the transpose, or all of them if undirected
+  const I *Bp = both ? Ap : Tp;
+  const I *Bj = both ? Aj : Tj;
+
+  parallel_for_chunks(n_chunks, [&](npy_intp c) {
+    auto find = [&](const I v, const I Xp[], const I Xj[]) {
+      for (I jj = Xp[v]; jj < Xp[v+1]; jj++) {
+        const I u = Xj[jj];
+        if ((bits[u / 64].load(std::memory_order_relaxed) >> (u % 64)) & 1) {
+          pred[v] = u;
+          return true;
+        }
+      }
+      return false;
+    };
+
+    npy_intp b, m = 0;
+    while ((b = next_block.fetch_add(1, std::memory_order_relaxed))
+           < n_blocks) {
+      const I start = (I)(b * CS_GRAPH_BFS_BU_BLOCK);
+      const I end = (I)std::min((npy_intp)n_nod,
+                                (b + 1) * CS_GRAPH_BFS_BU_BLOCK);
+      I count = 0;
+      for (I v = start; v < end; v++) {
+        if (level[v] != -1) {
+          continue;
+        }
+        if (find(v, Bp, Bj) || (both && find(v, Tp, Tj))) {
+          level[v] = depth + 1;
+          m += cs_graph_bfs_degree(v, Ap, Tp, both);
+          count++;
+        }
+      }
+      counts[b] = count;
+    }
+    m_chunk[c] = m;
+  });
+
+  npy_intp n_new = 0;
+  for (npy_intp b = 0; b < n_blocks; b++) {
+    const I count = counts[b];
+    counts[b] = (I)n_new;
+    n_new += count;
+  }
+  for (npy_intp c = 0; c < n_chunks; c++) {
+    *m_next += m_chunk[c];
+  }
+
+  next_block.store(0);
+  parallel_for_chunks(n_chunks, [&](npy_intp c) {
+    npy_intp b;
+    while ((b = next_block.fetch_add(1, std::memory_order_relaxed))
+           < n_blocks) {
+      const I start = (I)(b * CS_GRAPH_BFS_BU_BLOCK);
+      const I end = (I)std::min((npy_intp)n_nod,
+                                (b + 1) * CS_GRAPH_BFS_BU_BLOCK);
+      I k = counts[b];
+      for (I v = start; v < end; v++) {
+        if (level[v] == depth + 1) {
+          next[k++] = v;
+        }
+      }
+    }
+  });
+
+  parallel_for_chunks(n_fchunks, [&](npy_intp c) {
+    for (npy_intp k = n_f * c / n_fchunks; k < n_f * (c + 1) / n_fchunks;
+         k++) {
+      bits[frontier[k] / 64].store(0, std::memory_order_relaxed);
+    }
+  });
+
+  return (I)n_new;
+}
+
+
+/*
+ * Breadth-first search of a compressed sparse graph, using several
+ * threads
+ *
+ * The search is level-synchronous: the nodes at distance d + 1 from the
+ * start nodes are all found from those at distance d, the frontier,
+ * before going on. Each level is found either top-down, from the edges
+ * out of the frontier, or bottom-up, by looking for an edge from the
+ * frontier into each unvisited node, which can stop at the first one.
+ * The search switches to bottom-up when the frontier has more than
+ * 1/ALPHA of the edges of the unvisited nodes, and back once the frontier
+ * shrinks below 1/BETA of the nodes, as in the direction-optimizing
+ * search of Beamer et al.
+ *
+ * Nodes are listed level by level, each level in ascending order. The
+ * predecessor of a node found top-down is the lowest node of the
+ * frontier with an edge to it; bottom-up, it is the first node of the
+ * frontier among its incoming edges, in storage order. The result thus
+ * does not depend on the number of threads.
+ *
+ * Input Arguments:
+ *   I  n_nod             - number of nodes
+ *   I  Ap[n_nod+1]       - row pointer
+ *   I  Aj[nnz(A)]        - column indices
+ *   I  Tp[n_nod+1]       - row pointer of the transpose of A
+ *   I  Tj[nnz(A)]        - column indices of the transpose of A
+ *   I  directed          - if 0, edges are followed both ways
+ *   I  n_start           - number of start nodes
+ *   I  start[n_start]    - start nodes, at level 0
+ *   I  max_level         - the search stops at this level, if >= 0
+ *   I  workers           - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   I  node_list[n_nod]  - nodes reached, in breadth-first order
+ *   I  pred[n_nod]       - predecessors of the nodes reached, other than
+ *                          the start nodes; other entries are unchanged
+ *   I  level[n_nod]      - distance from the start nodes, or -1
+ *
+ * Return value:
+ *   The number of nodes reached.
+ *
+ * Note:
+ *   Output arrays must be preallocated
+ *
+ * Reference:
+ *   S. Beamer, K. Asanovic, D. Patterson, "Direction-Optimizing
+ *   Breadth-First Search", SC 2012.
+ *
+ */
+template <class I>
+I cs_graph_bfs_parallel(const I n_nod,
+                        const I Ap[],
+                        const I Aj[],
+                        const I Tp[],
+                        const I Tj[],
+                        const I directed,
+                        const I n_start,
+                        const I start[],
+                        const I max_level,
+                              I node_list[],
+                              I pred[],
+                              I level[],
+                        const I workers)
+{
+  const bool both = !directed;
+  const npy_intp n_words = ((npy_intp)n_nod + 63) / 64;
+  const npy_intp n_blocks = ((npy_intp)n_nod + CS_GRAPH_BFS_BU_BLOCK - 1)
+                            / CS_GRAPH_BFS_BU_BLOCK;
+  std::vector<std::atomic<I> > cand(n_nod);
+  std::vector<std::atomic<npy_uint64> > bits(n_words);
+  std::vector<I> counts(n_blocks);
+
+  const npy_intp n_chunks = parallel_num_chunks(workers, n_nod);
+  parallel_for_chunks(n_chunks, [&](npy_intp c) {
+    for (npy_intp i = n_nod * c / n_chunks; i < n_nod * (c + 1) / n_chunks;
+         i++) {
+      level[i] = -1;
+      cand[i].store(n_nod, std::memory_order_relaxed);
+    }
+    for (npy_intp w = n_words * c / n_chunks; w < n_words * (c + 1) / n_chunks;
+         w++) {
+      bits[w].store(0, std::memory_order_relaxed);
+    }
+  });
+
+  I length = 0;
+  npy_intp m_f = 0;
+  for (I k = 0; k < n_start; k++) {
+    const I s = start[k];
+    if (level[s] == -1) {
+      level[s] = 0;
+      node_list[length++] = s;
+      m_f += cs_graph_bfs_degree(s, Ap, Tp, both);
+    }
+  }
+
+  // edges of the unvisited nodes
+  npy_intp m_u = (npy_intp)Ap[n_nod] + (both ? (npy_intp)Tp[n_nod] : 0) - m_f;
+  I lo = 0, n_prev = 0, depth = 0;
+  bool bottom_up = false;
+
+  while (lo < length && depth != max_level) {
+    const I n_f = length - lo;
+    if (!bottom_up) {
+      bottom_up = m_f > m_u / CS_GRAPH_BFS_ALPHA;
+    }
+    else if (n_f < n_prev && n_f < n_nod / CS_GRAPH_BFS_BETA) {
+      bottom_up = false;
+    }
+
+    npy_intp m_next = 0;
+    I n_new;
+    if (bottom_up) {
+      n_new = cs_graph_bfs_bottom_up(n_nod, Ap, Aj, Tp, Tj, both,
+                                     node_list + lo, n_f, m_u, depth, workers,
+                                     node_list + length, pred, level,
+                                     &bits[0], &counts[0], &m_next);
+    }
+    else {
+      n_new = cs_graph_bfs_top_down(n_nod, Ap, Aj, Tp, Tj, both,
+                                    node_list + lo, n_f, m_f, depth, workers,
+                                    node_list + length, pred, level,
+                                    &cand[0], &bits[0], &m_next);
+    }
+
+    lo = length;
+    length += n_new;
+    n_prev = n_f;
+    m_f = m_next;
+    m_u -= m_next;
+    depth++;
+  }
+
+  return length;
+}
+
+
+/*
+ * An edge of cs_graph_mst_boruvka: entry e of the matrix, between the
+ * components u and v
+ */
+template <class I>
+struct cs_graph_mst_edge {
+  I u, v, e;
+};
+
+
+/*
+ * Keep the edges of E[0, n_edges) for which keep(edge) is true, in
+ * order, rewritten by update(edge), in F; returns their number
+ */
+template <class I, class Keep, class Update>
+npy_intp cs_graph_mst_filter(const cs_graph_mst_edge<I> E[],
+                             const npy_intp n_edges,
+                             cs_graph_mst_edge<I> F[],
+                             const I workers,
+                             const Keep& keep,
+                             const Update& update)
+{
+  const npy_intp n_chunks = parallel_num_chunks(workers, n_edges);
+  std::vector<npy_intp> offset(n_chunks + 1, 0);
+
+  parallel_for_chunks(n_chunks, [&](npy_intp c) {
+    npy_intp count = 0;
+    for (npy_intp k = n_edges * c / n_chunks;
+         k < n_edges * (c + 1) / n_chunks; k++) {
+      count += keep(E[k]);
+    }
+    offset[c + 1] = count;
+  });
+  for (npy_intp c = 0; c < n_chunks; c++) {
+    offset[c + 1] += offset[c];
+  }
+  parallel_for_chunks(n_chunks, [&](npy_intp c) {
+    npy_intp j = offset[c];
+    for (npy_intp k = n_edges * c / n_chunks;
+         k < n_edges * (c + 1) / n_chunks; k++) {
+      if (keep(E[k])) {
+        F[j++] = update(E[k]);
+      }
+    }
+  });
+
+  return offset[n_chunks];
+}
+
+
+/*
+ * Minimum spanning forest of an undirected compressed sparse graph, by
+ * Boruvka's algorithm on several threads
+ *
+ * Each stored entry (i, Aj[jj]) with i != Aj[jj] is an edge of weight
+ * Ax[jj], either way. Edges are ordered by weight, and then by jj, so
+ * that the minimum spanning forest is unique.
+ *
+ * The algorithm goes in rounds. Each component of the forest found so
+ * far picks its lightest edge to another component, with a lock-free
+ * compare-and-swap on the edge kept by the component. These edges are
+ * all in the minimum spanning forest: they are added to it, and their
+ * components merged with the lock-free union-find of
+ * cs_graph_components_parallel. The edges within a component are then
+ * dropped, and the others contracted onto the new components, so that
+ * each round only sees the edges left. There are at most log2(n_nod)
+ * rounds, and no sorting.
+ *
+ * Input Arguments:
+ *   I  n_nod         - number of nodes
+ *   I  Ap[n_nod+1]   - row pointer
+ *   I  Aj[nnz(A)]    - column indices
+ *   T  Ax[nnz(A)]    - weights
+ *   I  workers       - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   B  keep[nnz(A)]  - whether each entry is an edge of the forest
+ *
+ * Return value:
+ *   The number of edges of the forest.
+ *
+ * Note:
+ *   Output array keep must be preallocated and false
+ *
+ * Reference:
+ *   D. A. Bader, G. Cong, "Fast shared-memory algorithms for computing
+ *   the minimum spanning forest of sparse graphs", JPDC 66, 2006.
+ *
+ */
+template <class I, class T, class B>
+I cs_graph_mst_boruvka(const I n_nod,
+                       const I Ap[],
+                       const I Aj[],
+                       const T Ax[],
+                             B keep[],
+                       const I workers)
+{
+  typedef cs_graph_mst_edge<I> edge;
+
+  const npy_intp nnz = Ap[n_nod];
+  std::vector<std::atomic<I> > parent(n_nod);
+  std::vector<std::atomic<npy_intp> > best(n_nod);
+  std::vector<I> comp(n_nod);
+  std::vector<edge> E(nnz), F(nnz);
+
+  const npy_intp n_chunks = parallel_num_chunks(workers, nnz + n_nod);
+  std::vector<I> bounds(n_chunks + 1);
+  partition_rows_by_nnz(n_nod, Ap, (I)n_chunks, &bounds[0]);
+
+  // the edges between distinct nodes, in order
+  std::vector<npy_intp> offset(n_chunks + 1, 0);
+  parallel_for_chunks(n_chunks, [&](npy_intp c) {
+    npy_intp count = 0;
+    for (I i = bounds[c]; i < bounds[c+1]; i++) {
+      parent[i].store(i, std::memory_order_relaxed);
+      best[i].store(-1, std::memory_order_relaxed);
+      comp[i] = i;
+      for (I jj = Ap[i]; jj < Ap[i+1]; jj++) {
+        count += (Aj[jj] != i);
+      }
+    }
+    offset[c + 1] = count;
+  });
+  for (npy_intp c = 0; c < n_chunks; c++) {
+    offset[c + 1] += offset[c];
+  }
+  parallel_for_chunks(n_chunks, [&](npy_intp c) {
+    npy_intp k = offset[c];
+    for (I i = bounds[c]; i < bounds[c+1]; i++) {
+      for (I jj = Ap[i]; jj < Ap[i+1]; jj++) {
+        if (Aj[jj] != i) {
+          E[k].u = i;
+          E[k].v = Aj[jj];
+          E[k].e = jj;
+          k++;
+        }
+      }
+    }
+  });
+  npy_intp n_edges = offset[n_chunks];
+
+  // whether E[k] comes before E[best], in the order of the edges
+  auto lighter = [&](npy_intp k, npy_intp b) {
+    const I e = E[k].e, f = E[b].e;
+    return Ax[e] < Ax[f] || (!(Ax[f] < Ax[e]) && e < f);
+  };
+  auto offer = [&](I r, npy_intp k) {
+    npy_intp b = best[r].load(std::memory_order_relaxed);
+    while (b == -1 || lighter(k, b)) {
+      if (best[r].compare_exchange_weak(b, k, std::memory_order_relaxed)) {
+        break;
+      }
+    }
+  };
+
+  I n_tree = 0;
+  while (n_edges > 0) {
+    const npy_intp n_echunks = parallel_num_chunks(workers, n_edges);
+    const npy_intp n_nchunks = parallel_num_chunks(workers, n_nod);
+
+    // lightest edge out of each component
+    parallel_for_chunks(n_echunks, [&](npy_intp c) {
+      for (npy_intp k = n_edges * c / n_echunks;
+           k < n_edges * (c + 1) / n_echunks; k++) {
+        offer(E[k].u, k);
+        offer(E[k].v, k);
+      }
+    });
+
+    // add them to the forest; an edge picked by both of its components
+    // is added by the lower one
+    std::vector<I> added(n_nchunks, 0);
+    parallel_for_chunks(n_nchunks, [&](npy_intp c) {
+      for (npy_intp r = n_nod * c / n_nchunks; r < n_nod * (c + 1) / n_nchunks;
+           r++) {
+        const npy_intp k = best[r].load(std::memory_order_relaxed);
+        if (k == -1) {
+          continue;
+        }
+        const I other = (E[k].u == r) ? E[k].v : E[k].u;
+        if (other < r && best[other].load(std::memory_order_relaxed) == k) {
+          continue;
+        }
+        keep[E[k].e] = true;
+        added[c]++;
+        cs_graph_uf_link((I)r, other, &parent[0]);
+      }
+    });
+    for (npy_intp c = 0; c < n_nchunks; c++) {
+      n_tree += added[c];
+    }
+
+    parallel_for_chunks(n_nchunks, [&](npy_intp c) {
+      for (npy_intp i = n_nod * c / n_nchunks; i < n_nod * (c + 1) / n_nchunks;
+           i++) {
+        I p = parent[i].load(std::memory_order_relaxed);
+        I pp = parent[p].load(std::memory_order_relaxed);
+        while (p != pp) {
+          p = pp;
+          pp = parent[p].load(std::memory_order_relaxed);
+        }
+        comp[i] = p;
+        best[i].store(-1, std::memory_order_relaxed);
+      }
+    });
+    parallel_for_chunks(n_nchunks, [&](npy_intp c) {
+      for (npy_intp i = n_nod * c / n_nchunks; i < n_nod * (c + 1) / n_nchunks;
+           i++) {
+        parent[i].store(comp[i], std::memory_order_relaxed);
+      }
+    });
+
+    // contract the edges left onto the new components
+    n_edges = cs_graph_mst_filter(&E[0], n_edges, &F[0], workers,
+        [&](const edge& x) { return comp[x.u] != comp[x.v]; },
+        [&](const edge& x) {
+          edge y = {comp[x.u], comp[x.v], x.e};
+          return y;
+        });
+    E.swap(F);
+  }
+
+  return n_tree;
+}
+
+
+/*
+ * Maximum matching of the rows and columns of a bipartite graph, by the
+ * algorithm of Hopcroft and Karp, using several threads
+ *
+ * The graph is given in CSC format: column j is adjacent to the rows
+ * Ai[Ap[j]:Ap[j+1]]. On entry, match may hold a previous matching as a
+ * warm start; its pairs which are no longer edges, or which repeat a
+ * row, are dropped. The unmatched columns are then matched greedily,
+ * those of lower degree first, so that the columns with few choices get
+ * one.
+ *
+ * Each phase of Hopcroft-Karp then finds the distance of the columns
+ * from the unmatched columns, along alternating paths, with a
+ * level-synchronous breadth-first search on several threads, up to the
+ * first level from which an unmatched row is reached. A depth-first
+ * search from each unmatched column along these levels then augments
+ * the matching along shortest augmenting paths, until none are left.
+ * The searches only claim levels with compare-and-swap, so the matching
+ * found does not depend on the number of threads.
+ *
+ * Input Arguments:
+ *   I  n_row         - number of rows
+ *   I  n_col         - number of columns
+ *   I  Ap[n_col+1]   - column pointer
+ *   I  Ai[nnz(A)]    - row indices
+ *   I  workers       - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   I  match[n_col]  - the row matched to each column, or -1; on
+ *                      entry, a matching to start from, or -1
+ *
+ * Return value:
+ *   The number of matched columns.
+ *
+ * Reference:
+ *   J. E. Hopcroft, R. M. Karp, "An n^{5/2} algorithm for maximum
+ *   matchings in bipartite graphs", SIAM J. Comput. 2, 1973.
+ *   A. Azad, A. Buluc, A. Pothen, "Computing maximum cardinality
+ *   matchings in parallel on bipartite graphs via tree-grafting", IEEE
+ *   TPDS 28, 2017.
+ *
+ */
+template <class I>
+I cs_graph_bipartite_matching(const I n_row,
+                              const I n_col,
+                              const I Ap[],
+                              const I Ai[],
+                                    I match[],
+                              const I workers)
+{
+  std::vector<I> row_match(n_row, -1);
+  I size = 0;
+
+  // warm start
+  for (I j = 0; j < n_col; j++) {
+    const I r = match[j];
+    match[j] = -1;
+    if (r < 0 || r >= n_row || row_match[r] != -1) {
+      continue;
+    }
+    for (I jj = Ap[j]; jj < Ap[j+1]; jj++) {
+      if (Ai[jj] == r) {
+        match[j] = r;
+        row_match[r] = j;
+        size++;
+        break;
+      }
+    }
+  }
+
+  // greedy matching of the columns left, by increasing degree
+  {
+    I max_degree = 0;
+    for (I j = 0; j < n_col; j++) {
+      max_degree = std::max(max_degree, Ap[j+1] - Ap[j]);
+    }
+    std::vector<I> start((npy_intp)max_degree + 2, 0);
+    for (I j = 0; j < n_col; j++) {
+      start[Ap[j+1] - Ap[j] + 1]++;
+    }
+    for (I d = 0; d <= max_degree; d++) {
+      start[d + 1] += start[d];
+    }
+    std::vector<I> order(n_col);
+    for (I j = 0; j < n_col; j++) {
+      order[start[Ap[j+1] - Ap[j]]++] = j;
+    }
+    for (I k = 0; k < n_col; k++) {
+      const I j = order[k];
+      if (match[j] != -1) {
+        continue;
+      }
+      for (I jj = Ap[j]; jj < Ap[j+1]; jj++) {
+        const I r = Ai[jj];
+        if (row_match[r] == -1) {
+          match[j] = r;
+          row_match[r] = j;
+          size++;
+          break;
+        }
+      }
+    }
+  }
+
+  // level of each column in a phase, or -1 if not reached, or -2 once
+  // no augmenting path goes through it
+  std::vector<std::atomic<I> > level(n_col);
+  std::vector<I> frontier, next, stack, edge(n_col);
+  frontier.reserve(n_col);
+  next.reserve(n_col);
+  stack.reserve(n_col);
+
+  while (size < std::min(n_row, n_col)) {
+    frontier.clear();
+    for (I j = 0; j < n_col; j++) {
+      level[j].store(match[j] == -1 ? 0 : -1, std::memory_order_relaxed);
+      if (match[j] == -1 && Ap[j+1] > Ap[j]) {
+        frontier.push_back(j);
+      }
+    }
+
+    // breadth-first search, up to the level of the shortest paths
+    I depth = 0;
+    std::atomic<bool> found(false);
+    while (!frontier.empty()) {
+      const npy_intp n_f = frontier.size();
+      npy_intp work = 0;
+      for (npy_intp k = 0; k < n_f; k++) {
+        work += Ap[frontier[k] + 1] - Ap[frontier[k]];
+      }
+      const npy_intp n_blocks = (n_f + CS_GRAPH_BFS_TD_BLOCK - 1)
+                                / CS_GRAPH_BFS_TD_BLOCK;
+      const npy_intp n_chunks = std::min(
+          parallel_num_chunks(workers, work + n_f), n_blocks);
+      std::vector<std::vector<I> > found_cols(n_chunks);
+      std::atomic<npy_intp> next_block(0);
+
+      parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        std::vector<I>& mine = found_cols[c];
+        bool free_row = false;
+        npy_intp b;
+        while ((b = next_block.fetch_add(1, std::memory_order_relaxed))
+               < n_blocks) {
+          const npy_intp end = std::min(n_f,
+                                        (b + 1) * CS_GRAPH_BFS_TD_BLOCK);
+          for (npy_intp k = b * CS_GRAPH_BFS_TD_BLOCK; k < end; k++) {
+            const I j = frontier[k];
+            for (I jj = Ap[j]; jj < Ap[j+1]; jj++) {
+              const I j2 = row_match[Ai[jj]];
+              if (j2 == -1) {
+                free_row = true;
+                continue;
+              }
+              I unseen = -1;
+              if (level[j2].compare_exchange_strong(
+                      unseen, depth + 1, std::memory_order_relaxed)) {
+                mine.push_back(j2);
+              }
+            }
+          }
+        }
+        if (free_row) {
+          found.store(true, std::memory_order_relaxed);
+        }
+      });
+
+      if (found.load()) {
+        break;
+      }
+      next.clear();
+      for (npy_intp c = 0; c < n_chunks; c++) {
+        next.insert(next.end(), found_cols[c].begin(), found_cols[c].end());
+      }
+      frontier.swap(next);
+      depth++;
+    }
+    if (!found.load()) {
+      break;
+    }
+
+    // depth-first search for augmenting paths from each unmatched
+    // column; edge[j] is the next edge of column j to follow
+    for (I j = 0; j < n_col; j++) {
+      edge[j] = Ap[j];
+    }
+    for (I j0 = 0; j0 < n_col; j0++) {
+      if (match[j0] != -1) {
+        continue;
+      }
+      stack.clear();
+      stack.push_back(j0);
+      while (!stack.empty()) {
+        const I j = stack.back();
+        const I lj = level[j].load(std::memory_order_relaxed);
+        if (edge[j] == Ap[j+1]) {
+          level[j].store(-2, std::memory_order_relaxed);
+          stack.pop_back();
+          continue;
+        }
+        const I r = Ai[edge[j]++];
+        const I j2 = row_match[r];
+        if (j2 == -1) {
+          if (lj != depth) {
+            continue;
+          }
+          // flip the path: each column takes the row it was reached
+          // through, and the last one r
+          I row = r;
+          for (npy_intp k = stack.size() - 1; k >= 0; k--) {
+            const I col = stack[k];
+            const I prev = match[col];
+            match[col] = row;
+            row_match[row] = col;
+            row = prev;
+          }
+          size++;
+          break;
+        }
+        if (lj < depth && level[j2].load(std::memory_order_relaxed) == lj + 1) {
+          stack.push_back(j2);
+        }
+      }
+    }
+  }
+
+  return size;
+}
+
+
+/*
+ * Stable sort of nodes[0, k) by degree: by insertion for few nodes,
+ * otherwise by counting over the range of their degrees if it is narrow,
+ * as it is in meshes, and by merging if not. work is scratch space.
+ */
+template <class I>
+void cs_graph_rcm_sort(I nodes[], const I k, const I degree[],
+                       std::vector<I>& work)
+{
+  if (k <= 16) {
+    for (I i = 1; i < k; i++) {
+      const I v = nodes[i];
+      I l = i;
+      while (l > 0 && degree[v] < degree[nodes[l-1]]) {
+        nodes[l] = nodes[l-1];
+        l--;
+      }
+      nodes[l] = v;
+    }
+    return;
+  }
+
+  I lo = degree[nodes[0]], hi = lo;
+  for (I i = 1; i < k; i++) {
+    lo = std::min(lo, degree[nodes[i]]);
+    hi = std::max(hi, degree[nodes[i]]);
+  }
+  if ((npy_intp)hi - lo > 4 * (npy_intp)k) {
+    std::stable_sort(nodes, nodes + k, [&](I a, I b) {
+      return degree[a] < degree[b];
+    });
+    return;
+  }
+
+  const I range = hi - lo + 1;
+  work.assign((npy_intp)range + 1 + k, 0);
+  I *count = &work[0], *sorted = &work[range + 1];
+  for (I i = 0; i < k; i++) {
+    count[degree[nodes[i]] - lo + 1]++;
+  }
+  for (I d = 0; d < range; d++) {
+    count[d + 1] += count[d];
+  }
+  for (I i = 0; i < k; i++) {
+    sorted[count[degree[nodes[i]] - lo]++] = nodes[i];
+  }
+  std::copy(sorted, sorted + k, nodes);
+}
+
+
+/*
+ * Breadth-first search from root for cs_graph_rcm, appending the nodes
+ * reached to queue from position n, and marking them in visited. With
+ * sort, the children of each node are sorted by degree, as in the
+ * Cuthill-McKee ordering. The start of the last level is returned in
+ * *last, and the number of levels in *depth.
+ */
+template <class I>
+I cs_graph_rcm_bfs(const I root, const I Ap[], const I Aj[],
+                   const I degree[], const bool sort,
+                   I queue[], I n, unsigned char visited[],
+                   std::vector<I>& work, I *last, I *depth)
+{
+  I level_start = n;
+  queue[n++] = root;
+  visited[root] = 1;
+  *depth = 0;
+  while (true) {
+    const I level_end = n;
+    *last = level_start;
+    (*depth)++;
+    for (I k = level_start; k < level_end; k++) {
+      const I i = queue[k];
+      const I n_old = n;
+      for (I jj = Ap[i]; jj < Ap[i+1]; jj++) {
+        const I j = Aj[jj];
+        if (!visited[j]) {
+          visited[j] = 1;
+          queue[n++] = j;
+        }
+      }
+      if (sort) {
+        cs_graph_rcm_sort(queue + n_old, n - n_old, degree, work);
+      }
+    }
+    if (n == level_end) {
+      return n;
+    }
+    level_start = level_end;
+  }
+}
+
+
+/*
+ * Cuthill-McKee ordering of a compressed sparse graph with a symmetric
+ * structure, with its connected components ordered on several threads
+ *
+ * Nodes are ranked by inds, usually by increasing degree. Components
+ * are ordered in the order of their first node in inds, which is where
+ * the search of each starts. Each level of a search lists the children
+ * of the nodes of the level before, in order, each sorted by degree.
+ * This is the ordering of a serial search which starts from each node
+ * not yet reached, in the order of inds.
+ *
+ * With pseudo_peripheral set, each search instead starts from a node
+ * near the periphery of the component, found as by George and Liu:
+ * starting from the first node, a search goes on from the node of
+ * lowest degree of the last level as long as it makes more levels.
+ *
+ * Only the nodes of a component are touched by its searches, so the
+ * components can be searched concurrently; each one is placed in the
+ * output after the components which come before it.
+ *
+ * Input Arguments:
+ *   I  n_nod              - number of nodes
+ *   I  Ap[n_nod+1]        - row pointer
+ *   I  Aj[nnz(A)]         - column indices
+ *   I  degree[n_nod]      - degrees, which the children are sorted by
+ *   I  inds[n_nod]        - all the nodes, in the order of their rank
+ *   I  pseudo_peripheral  - whether to start from pseudo-peripheral nodes
+ *   I  workers            - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   I  order[n_nod]       - the nodes in Cuthill-McKee order
+ *
+ * References:
+ *   E. Cuthill, J. McKee, "Reducing the bandwidth of sparse symmetric
+ *   matrices", ACM '69, 1969.
+ *   A. George, J. W. H. Liu, "An implementation of a pseudoperipheral
+ *   node finder", ACM Trans. Math. Softw. 5, 1979.
+ *
+ */
+template <class I>
+void cs_graph_rcm(const I n_nod,
+                  const I Ap[],
+                  const I Aj[],
+                  const I degree[],
+                  const I inds[],
+                  const I pseudo_peripheral,
+                        I order[],
+                  const I workers)
+{
+  std::vector<I> label(n_nod);
+  const I n_comp = cs_graph_components_parallel(n_nod, Ap, Aj, &label[0],
+                                                workers);
+
+  // components by first node in inds, and their nodes in that order
+  std::vector<I> comps, offset(n_comp + 1, 0), members(n_nod);
+  comps.reserve(n_comp);
+  std::vector<I> size(n_comp, 0);
+  for (I p = 0; p < n_nod; p++) {
+    const I c = label[inds[p]];
+    if (size[c]++ == 0) {
+      comps.push_back(c);
+    }
+  }
+  std::vector<I> start(n_comp);
+  I pos = 0;
+  for (I k = 0; k < n_comp; k++) {
+    start[comps[k]] = pos;
+    pos += size[comps[k]];
+  }
+  {
+    std::vector<I> fill(start);
+    for (I p = 0; p < n_nod; p++) {
+      members[fill[label[inds[p]]]++] = inds[p];
+    }
+  }
+
+  std::vector<unsigned char> visited(n_nod, 0);
+  const npy_intp n_chunks = parallel_num_chunks(
+      workers, (npy_intp)Ap[n_nod] + n_nod);
+  const npy_intp n_blocks = ((npy_intp)n_comp + 63) / 64;
+  std::atomic<npy_intp> next_block(0);
+
+  parallel_for_chunks(std::min(n_chunks, std::max(n_blocks, (npy_intp)1)),
+                      [&](npy_intp) {
+    std::vector<I> work;
+    npy_intp b;
+    while ((b = next_block.fetch_add(1, std::memory_order_relaxed))
+           < n_blocks) {
+      const I k_end = (I)std::min((npy_intp)n_comp, (b + 1) * 64);
+      for (I k = (I)(b * 64); k < k_end; k++) {
+        const I c = comps[k];
+        const I first = start[c], n_c = size[c];
+        I *out = order + first;
+        I root = members[first], last, depth;
+
+        if (n_c == 1) {
+          out[0] = root;
+          continue;
+        }
+
+        if (pseudo_peripheral) {
+          // the output is scratch space until the last search
+          I n = cs_graph_rcm_bfs(root, Ap, Aj, degree, false, out, (I)0,
+                                 &visited[0], work, &last, &depth);
+          while (true) {
+            I x = out[last];
+            for (I i = last + 1; i < n; i++) {
+              if (degree[out[i]] < degree[x]) {
+                x = out[i];
+              }
+            }
+            for (I i = 0; i < n; i++) {
+              visited[out[i]] = 0;
+            }
+            I depth_x;
+            n = cs_graph_rcm_bfs(x, Ap, Aj, degree, false, out, (I)0,
+                                 &visited[0], work, &last, &depth_x);
+            if (depth_x <= depth) {
+              for (I i = 0; i < n; i++) {
+                visited[out[i]] = 0;
+              }
+              break;
+            }
+            root = x;
+            depth = depth_x;
+          }
+        }
+
+        // the search from root, and from the next nodes of the
+        // component left, if its structure is not symmetric
+        I n = cs_graph_rcm_bfs(root, Ap, Aj, degree, true, out, (I)0,
+                               &visited[0], work, &last, &depth);
+        for (I i = 0; n < n_c; i++) {
+          if (!visited[members[first + i]]) {
+            n = cs_graph_rcm_bfs(members[first + i], Ap, Aj, degree, true,
+                                 out, n, &visited[0], work, &last, &depth);
+          }
+        }
+      }
+    }
+  });
+}
+
 #endif
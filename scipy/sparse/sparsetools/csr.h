@@ -5,9 +5,12 @@
 #include <vector>
 #include <algorithm>
 #include <functional>
+#include <stdexcept>
 
 #include "util.h"
 #include "dense.h"
+#include "parallel.h"
+#include "sort.h"
 
 /*
  * Extract k-th diagonal of CSR matrix A
@@ -136,6 +139,195 @@ void csr_scale_columns(const I n_row,
 }
 
 
+/*
+ * Compute the weighted degrees of the vertices of a graph for its
+ * Laplacian
+ *
+ * Input Arguments:
+ *   I  n                 - number of vertices (rows and columns in A)
+ *   I  Ap[n+1]           - row pointer
+ *   I  Aj[nnz(A)]        - column indices
+ *   T  Ax[nnz(A)]        - edge weights
+ *   I  out_degree        - sum the rows of A if nonzero, else its columns
+ *   I  workers           - maximum number of threads
+ *
+ * Output Arguments:
+ *   T  W[n]              - sums of the off-diagonal entries of each row
+ *                          or column of A
+ *
+ * Note:
+ *   The column sums are accumulated per chunk of rows, with the number
+ *   of chunks limited so that the partial sums are no larger than A.
+ *
+ */
+template <class I, class T>
+void csr_laplacian_degrees(const I n,
+                           const I Ap[],
+                           const I Aj[],
+                           const T Ax[],
+                           const I out_degree,
+                                 T W[],
+                           const I workers)
+{
+    npy_intp n_chunks = parallel_num_chunks(workers, (npy_intp)Ap[n] + n);
+    if (!out_degree && n > 0) {
+        n_chunks = std::max((npy_intp)1,
+                            std::min(n_chunks, (npy_intp)Ap[n] / n));
+    }
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n, Ap, (I)n_chunks, &bounds[0]);
+
+    if (out_degree) {
+        parallel_for_chunks(n_chunks, [&](npy_intp c) {
+            for(I i = bounds[c]; i < bounds[c+1]; i++){
+                T sum = 0;
+                for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+                    if(Aj[jj] != i){
+                        sum += Ax[jj];
+                    }
+                }
+                W[i] = sum;
+            }
+        });
+        return;
+    }
+
+    std::fill(W, W + n, T(0));
+    if (n_chunks == 1) {
+        for(I i = 0; i < n; i++){
+            for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+                if(Aj[jj] != i){
+                    W[Aj[jj]] += Ax[jj];
+                }
+            }
+        }
+        return;
+    }
+
+    std::vector<T> partial((npy_intp)(n_chunks - 1) * n, T(0));
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        T *w = (c == 0) ? W : &partial[(c - 1) * n];
+        for(I i = bounds[c]; i < bounds[c+1]; i++){
+            for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+                if(Aj[jj] != i){
+                    w[Aj[jj]] += Ax[jj];
+                }
+            }
+        }
+    });
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        const I j_end = (npy_intp)n * (c + 1) / n_chunks;
+        for(I j = (npy_intp)n * c / n_chunks; j < j_end; j++){
+            for(npy_intp k = 0; k < n_chunks - 1; k++){
+                W[j] += partial[k * n + j];
+            }
+        }
+    });
+}
+
+
+/*
+ * Build the Laplacian of a graph in one pass over its adjacency matrix
+ *
+ *   B[i,j] = -A[i,j]                  for i != j
+ *   B[i,i] = D[i]
+ *
+ * or, if normed is nonzero,
+ *
+ *   B[i,j] = -A[i,j] / S[i] / S[j]    for i != j
+ *   B[i,i] = D[i]
+ *
+ * The diagonal entries of A are dropped, and every row of B gets one
+ * diagonal entry, placed so that sorted rows of A give sorted rows of B.
+ * Bj and Bx must have room for nnz(A) + n entries.
+ *
+ * Input Arguments:
+ *   I  n                 - number of vertices (rows and columns in A)
+ *   I  Ap[n+1]           - row pointer
+ *   I  Aj[nnz(A)]        - column indices
+ *   T  Ax[nnz(A)]        - edge weights
+ *   T  D[n]              - diagonal of B
+ *   I  normed            - whether to scale the off-diagonal entries by S
+ *   T  S[n]              - scale factors, used if normed is nonzero
+ *   I  workers           - maximum number of threads
+ *
+ * Output Arguments:
+ *   I  Bp[n+1]           - row pointer
+ *   I  Bj[nnz(B)]        - column indices
+ *   T  Bx[nnz(B)]        - values
+ *
+ * Note:
+ *   This fuses the negation, the diagonal insertion and the scaling of
+ *   rows and columns that csr_scale_rows and csr_scale_columns would do
+ *   as separate passes.
+ *
+ */
+template <class I, class T>
+void csr_laplacian(const I n,
+                   const I Ap[],
+                   const I Aj[],
+                   const T Ax[],
+                   const T D[],
+                   const I normed,
+                   const T S[],
+                         I Bp[],
+                         I Bj[],
+                         T Bx[],
+                   const I workers)
+{
+    const npy_intp n_chunks = parallel_num_chunks(workers, (npy_intp)Ap[n] + n);
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n, Ap, (I)n_chunks, &bounds[0]);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        for(I i = bounds[c]; i < bounds[c+1]; i++){
+            I row_nnz = 1;
+            for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+                if(Aj[jj] != i){
+                    row_nnz++;
+                }
+            }
+            Bp[i+1] = row_nnz;
+        }
+    });
+
+    Bp[0] = 0;
+    for(I i = 0; i < n; i++){
+        Bp[i+1] += Bp[i];
+    }
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        for(I i = bounds[c]; i < bounds[c+1]; i++){
+            I pos = Bp[i];
+            bool diag_done = false;
+            for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+                const I j = Aj[jj];
+                if(j == i){
+                    continue;
+                }
+                if(!diag_done && j > i){
+                    Bj[pos] = i;
+                    Bx[pos] = D[i];
+                    pos++;
+                    diag_done = true;
+                }
+                Bj[pos] = j;
+                if(normed){
+                    Bx[pos] = -(Ax[jj] / S[i] / S[j]);
+                } else {
+                    Bx[pos] = -Ax[jj];
+                }
+                pos++;
+            }
+            if(!diag_done){
+                Bj[pos] = i;
+                Bx[pos] = D[i];
+            }
+        }
+    });
+}
+
+
 /*
  * Compute the number of occupied RxC blocks in a matrix
  *
@@ -253,6 +445,267 @@ void csr_tobsr(const I n_row,
 }
 
 
+/*
+ * Split the block rows of a CSR matrix into chunks of roughly equal cost,
+ * for the threaded BSR conversion passes below
+ */
+template <class I>
+npy_intp csr_block_row_chunks(const I n_brow,
+                              const I R,
+                              const I n_bcol,
+                              const I Ap[],
+                              const I workers,
+                              std::vector<I>& bounds)
+{
+    const I nnz = Ap[R * n_brow];
+
+    // each chunk marks the block columns it has seen in its own buffer
+    npy_intp n_chunks = parallel_num_chunks(workers, (npy_intp)nnz + n_brow);
+    n_chunks = std::max((npy_intp)1,
+                        std::min(n_chunks, (npy_intp)nnz / (n_bcol + 1)));
+
+    std::vector<I> block_ptr(n_brow + 1);
+    for(I bi = 0; bi <= n_brow; bi++){
+        block_ptr[bi] = Ap[R * bi];
+    }
+    bounds.resize(n_chunks + 1);
+    partition_rows_by_nnz(n_brow, &block_ptr[0], (I)n_chunks, &bounds[0]);
+    return n_chunks;
+}
+
+
+/*
+ * Compute the block row pointer of the BSR form of a CSR matrix, using
+ * multiple threads
+ *
+ * Input Arguments:
+ *   I  n_row           - number of rows in A
+ *   I  n_col           - number of columns in A
+ *   I  R               - row blocksize
+ *   I  C               - column blocksize
+ *   I  Ap[n_row+1]     - row pointer
+ *   I  Aj[nnz(A)]      - column indices
+ *   I  workers         - maximum number of threads
+ *
+ * Output Arguments:
+ *   I  Bp[n_row/R + 1] - block row pointer
+ *
+ * Note:
+ *   Bp[n_row/R] is the number of blocks, with which the output arrays of
+ *   csr_tobsr_pass2_threaded are allocated.
+ *
+ */
+template <class I>
+void csr_tobsr_pass1_threaded(const I n_row,
+                              const I n_col,
+                              const I R,
+                              const I C,
+                              const I Ap[],
+                              const I Aj[],
+                                    I Bp[],
+                              const I workers)
+{
+    const I n_brow = n_row / R;
+    const I n_bcol = n_col / C;
+
+    std::vector<I> bounds;
+    const npy_intp n_chunks = csr_block_row_chunks(n_brow, R, n_bcol, Ap,
+                                                   workers, bounds);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        std::vector<I> mask(n_bcol + 1, -1);
+        for(I bi = bounds[c]; bi < bounds[c+1]; bi++){
+            I n_blks = 0;
+            for(I jj = Ap[R*bi]; jj < Ap[R*(bi+1)]; jj++){
+                const I bj = Aj[jj] / C;
+                if(mask[bj] != bi){
+                    mask[bj] = bi;
+                    n_blks++;
+                }
+            }
+            Bp[bi+1] = n_blks;
+        }
+    });
+
+    Bp[0] = 0;
+    for(I bi = 0; bi < n_brow; bi++){
+        Bp[bi+1] += Bp[bi];
+    }
+}
+
+
+/*
+ * Convert a CSR matrix to BSR format, given the block row pointer from
+ * csr_tobsr_pass1_threaded, using multiple threads
+ *
+ * Input Arguments:
+ *   I  n_row           - number of rows in A
+ *   I  n_col           - number of columns in A
+ *   I  R               - row blocksize
+ *   I  C               - column blocksize
+ *   I  Ap[n_row+1]     - row pointer
+ *   I  Aj[nnz(A)]      - column indices
+ *   T  Ax[nnz(A)]      - nonzero values
+ *   I  Bp[n_row/R + 1] - block row pointer
+ *   I  workers         - maximum number of threads
+ *
+ * Output Arguments:
+ *   I  Bj[nnz(B)]      - column indices
+ *   T  Bx[nnz(B)]      - nonzero blocks
+ *
+ * Note:
+ *   Output arrays must be preallocated (with Bx initialized to zero).
+ *   The result is the same as that of csr_tobsr.
+ *
+ */
+template <class I, class T>
+void csr_tobsr_pass2_threaded(const I n_row,
+                              const I n_col,
+                              const I R,
+                              const I C,
+                              const I Ap[],
+                              const I Aj[],
+                              const T Ax[],
+                              const I Bp[],
+                                    I Bj[],
+                                    T Bx[],
+                              const I workers)
+{
+    const I n_brow = n_row / R;
+    const I n_bcol = n_col / C;
+    const npy_intp RC = (npy_intp)R * C;
+
+    std::vector<I> bounds;
+    const npy_intp n_chunks = csr_block_row_chunks(n_brow, R, n_bcol, Ap,
+                                                   workers, bounds);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        // slot[bj] is the index of block column bj in the current block
+        // row; indices left over from earlier block rows are below Bp[bi]
+        std::vector<I> slot(n_bcol + 1, -1);
+        for(I bi = bounds[c]; bi < bounds[c+1]; bi++){
+            I n_blks = Bp[bi];
+            for(I r = 0; r < R; r++){
+                const I i = R*bi + r;
+                for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+                    const I bj = Aj[jj] / C;
+                    if(slot[bj] < Bp[bi]){
+                        slot[bj] = n_blks;
+                        Bj[n_blks] = bj;
+                        n_blks++;
+                    }
+                    Bx[RC*slot[bj] + (npy_intp)C*r + Aj[jj] % C] += Ax[jj];
+                }
+            }
+        }
+    });
+}
+
+
+/*
+ * Estimate how well a CSR matrix fits into blocks of several sizes, by
+ * counting its nonzeros and occupied blocks in a sample of its block rows
+ *
+ * For each candidate blocksize R[k] x C[k], about sample_rows rows are
+ * taken, in block rows spread evenly over the matrix. The fill ratio
+ * nnz[k] / (blocks[k] * R[k] * C[k]) then estimates the fraction of the
+ * stored BSR values that are nonzeros of A. All block rows are counted
+ * when there are at most sample_rows rows.
+ *
+ * Input Arguments:
+ *   I  n_row             - number of rows in A
+ *   I  n_col             - number of columns in A
+ *   I  Ap[n_row+1]       - row pointer
+ *   I  Aj[nnz(A)]        - column indices
+ *   I  n_cand            - number of candidate blocksizes
+ *   I  Rs[n_cand]        - row blocksizes, dividing n_row
+ *   I  Cs[n_cand]        - column blocksizes, dividing n_col
+ *   I  sample_rows       - number of rows to sample per candidate
+ *   I  workers           - maximum number of threads
+ *
+ * Output Arguments:
+ *   P  nnz[n_cand]       - nonzeros in the sampled rows
+ *   P  blocks[n_cand]    - occupied blocks in the sampled rows
+ *
+ * Note:
+ *   The block columns of a block row are found by sorting, so that the
+ *   cost does not depend on n_col.
+ *
+ */
+template <class I>
+void csr_sample_block_counts(const I n_row,
+                             const I n_col,
+                             const I Ap[],
+                             const I Aj[],
+                             const I n_cand,
+                             const I Rs[],
+                             const I Cs[],
+                             const I sample_rows,
+                                   npy_int64 nnz[],
+                                   npy_int64 blocks[],
+                             const I workers)
+{
+    (void)n_col;
+
+    // the sampled block rows of all candidates, numbered consecutively
+    std::vector<npy_intp> first_unit(n_cand + 1, 0);
+    std::vector<npy_intp> n_sample(n_cand);
+    for(I k = 0; k < n_cand; k++){
+        const npy_intp n_brow = n_row / Rs[k];
+        n_sample[k] = std::min(n_brow, std::max((npy_intp)1,
+                                                (npy_intp)sample_rows / Rs[k]));
+        first_unit[k+1] = first_unit[k] + n_sample[k];
+    }
+    const npy_intp n_units = first_unit[n_cand];
+
+    const npy_intp avg_row = n_row > 0 ? (npy_intp)Ap[n_row] / n_row + 1 : 1;
+    npy_intp n_chunks = parallel_num_chunks(
+        workers, (npy_intp)sample_rows * n_cand * avg_row);
+    n_chunks = std::max((npy_intp)1, std::min(n_chunks, n_units));
+
+    // per-chunk counts, summed at the end
+    std::vector<npy_int64> counts(2 * n_chunks * (npy_intp)n_cand, 0);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        npy_int64 *chunk_nnz = &counts[2 * c * n_cand];
+        npy_int64 *chunk_blocks = chunk_nnz + n_cand;
+        std::vector<I> cols;
+
+        const npy_intp u_start = n_units * c / n_chunks;
+        const npy_intp u_end = n_units * (c + 1) / n_chunks;
+        I k = (I)(std::upper_bound(first_unit.begin(), first_unit.end(),
+                                   u_start) - first_unit.begin()) - 1;
+        for(npy_intp u = u_start; u < u_end; u++){
+            while(u >= first_unit[k+1]){
+                k++;
+            }
+            const I R = Rs[k];
+            const I C = Cs[k];
+            const npy_intp s = u - first_unit[k];
+            const I bi = (I)(s * (n_row / R) / n_sample[k]);
+
+            cols.clear();
+            for(I jj = Ap[R*bi]; jj < Ap[R*(bi+1)]; jj++){
+                cols.push_back(Aj[jj] / C);
+            }
+            std::sort(cols.begin(), cols.end());
+            chunk_nnz[k] += cols.size();
+            chunk_blocks[k] += std::unique(cols.begin(), cols.end())
+                               - cols.begin();
+        }
+    });
+
+    for(I k = 0; k < n_cand; k++){
+        nnz[k] = 0;
+        blocks[k] = 0;
+        for(npy_intp c = 0; c < n_chunks; c++){
+            nnz[k] += counts[2 * c * n_cand + k];
+            blocks[k] += counts[(2 * c + 1) * n_cand + k];
+        }
+    }
+}
+
+
 /*
  * Compute B += A for CSR matrix A, C-contiguous dense matrix B
  *
@@ -339,9 +792,40 @@ bool csr_has_canonical_format(const I n_row,
 }
 
 
-template< class T1, class T2 >
-bool kv_pair_less(const std::pair<T1,T2>& x, const std::pair<T1,T2>& y){
-    return x.first < y.first;
+/*
+ * Sort the column indices of rows [row_start, row_end) of CSR matrix A
+ * inplace. Rows that are already sorted are left untouched.
+ */
+template<class I, class T>
+void csr_sort_indices_rows(const I row_start,
+                           const I row_end,
+                           const I Ap[],
+                                 I Aj[],
+                                 T Ax[])
+{
+    std::vector<I> tmp_j;
+    std::vector<T> tmp_x;
+
+    for(I i = row_start; i < row_end; i++){
+        const I start = Ap[i];
+        const I end   = Ap[i+1];
+        if (end - start < 2) {
+            continue;
+        }
+
+        bool sorted = true;
+        I lo = Aj[start], hi = Aj[start];
+        for(I jj = start + 1; jj < end; jj++){
+            sorted = sorted && Aj[jj-1] <= Aj[jj];
+            lo = std::min(lo, Aj[jj]);
+            hi = std::max(hi, Aj[jj]);
+        }
+
+        if (!sorted) {
+            sort_by_index(end - start, lo, hi, Aj + start, Ax + start,
+                          tmp_j, tmp_x);
+        }
+    }
 }
 
 /*
@@ -353,6 +837,9 @@ bool kv_pair_less(const std::pair<T1,T2>& x, const std::pair<T1,T2>& y){
  *   I  Aj[nnz(A)]      - column indices
  *   T  Ax[nnz(A)]      - nonzeros
  *
+ * Note:
+ *   The sort is stable. Long rows are radix sorted, see sort_by_index.
+ *
  */
 template<class I, class T>
 void csr_sort_indices(const I n_row,
@@ -360,30 +847,36 @@ void csr_sort_indices(const I n_row,
                             I Aj[],
                             T Ax[])
 {
-    std::vector< std::pair<I,T> > temp;
-
-    for(I i = 0; i < n_row; i++){
-        I row_start = Ap[i];
-        I row_end   = Ap[i+1];
-
-        temp.resize(row_end - row_start);
-        for (I jj = row_start, n = 0; jj < row_end; jj++, n++){
-            temp[n].first  = Aj[jj];
-            temp[n].second = Ax[jj];
-        }
+    csr_sort_indices_rows((I)0, n_row, Ap, Aj, Ax);
+}
 
-        std::sort(temp.begin(),temp.end(),kv_pair_less<I,T>);
+/*
+ * Threaded version of csr_sort_indices
+ *
+ * Input Arguments:
+ *   I  workers         - maximum number of threads to use
+ *
+ * The remaining arguments are as for csr_sort_indices.
+ *
+ */
+template<class I, class T>
+void csr_sort_indices_threaded(const I n_row,
+                               const I Ap[],
+                                     I Aj[],
+                                     T Ax[],
+                               const I workers)
+{
+    const I n_chunks = parallel_num_chunks(workers, (npy_intp)Ap[n_row] + n_row);
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row, Ap, n_chunks, &bounds[0]);
 
-        for(I jj = row_start, n = 0; jj < row_end; jj++, n++){
-            Aj[jj] = temp[n].first;
-            Ax[jj] = temp[n].second;
-        }
-    }
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        csr_sort_indices_rows(bounds[c], bounds[c+1], Ap, Aj, Ax);
+    });
 }
 
 
 
-
 /*
  * Compute B = A for CSR matrix A, CSC matrix B
  *
@@ -461,6 +954,101 @@ void csr_tocsc(const I n_row,
 }
 
 
+/*
+ * Threaded version of csr_tocsc
+ *
+ * The rows of A are split into chunks, and each chunk counts its entries
+ * per column into a histogram of its own. The histograms are merged into
+ * Bp and into the starting offset of each chunk in each column, after which
+ * the chunks scatter their entries into disjoint slots. Chunks cover
+ * increasing row ranges, so the output is identical to that of csr_tocsc.
+ *
+ * Input Arguments:
+ *   I  workers       - maximum number of threads to use
+ *
+ * The remaining arguments are as for csr_tocsc.
+ *
+ * Note:
+ *   The histograms take n_col entries per chunk, so the number of chunks
+ *   is limited to keep them no larger than A itself.
+ *
+ */
+template <class I, class T>
+void csr_tocsc_threaded(const I n_row,
+                        const I n_col,
+                        const I Ap[],
+                        const I Aj[],
+                        const T Ax[],
+                              I Bp[],
+                              I Bi[],
+                              T Bx[],
+                        const I workers)
+{
+    const I nnz = Ap[n_row];
+
+    npy_intp n_chunks = parallel_num_chunks(workers, (npy_intp)nnz + n_col);
+    if (n_col > 0) {
+        n_chunks = std::max((npy_intp)1,
+                            std::min(n_chunks, (npy_intp)nnz / n_col));
+    }
+    if (n_chunks == 1) {
+        csr_tocsc(n_row, n_col, Ap, Aj, Ax, Bp, Bi, Bx);
+        return;
+    }
+
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row, Ap, (I)n_chunks, &bounds[0]);
+
+    // offsets[c*n_col + col] is the number of entries in column col of
+    // chunk c, and later the next free slot of chunk c in that column
+    std::vector<I> offsets((npy_intp)n_chunks * n_col, 0);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        I *count = &offsets[c * n_col];
+        for(I jj = Ap[bounds[c]]; jj < Ap[bounds[c+1]]; jj++){
+            count[Aj[jj]]++;
+        }
+    });
+
+    // column totals, and within-column offsets of each chunk
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        const I col_start = (npy_intp)n_col * c / n_chunks;
+        const I col_end = (npy_intp)n_col * (c + 1) / n_chunks;
+        for(I col = col_start; col < col_end; col++){
+            I cumsum = 0;
+            for(npy_intp k = 0; k < n_chunks; k++){
+                I temp = offsets[k * n_col + col];
+                offsets[k * n_col + col] = cumsum;
+                cumsum += temp;
+            }
+            Bp[col] = cumsum;
+        }
+    });
+
+    for(I col = 0, cumsum = 0; col < n_col; col++){
+        I temp  = Bp[col];
+        Bp[col] = cumsum;
+        cumsum += temp;
+    }
+    Bp[n_col] = nnz;
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        I *next = &offsets[c * n_col];
+        for(I row = bounds[c]; row < bounds[c+1]; row++){
+            for(I jj = Ap[row]; jj < Ap[row+1]; jj++){
+                I col  = Aj[jj];
+                I dest = Bp[col] + next[col];
+
+                Bi[dest] = row;
+                Bx[dest] = Ax[jj];
+
+                next[col]++;
+            }
+        }
+    });
+}
+
+
 
 /*
  * Compute B = A for CSR matrix A, ELL matrix B
@@ -555,54 +1143,307 @@ void csr_toell(const I n_row,
 
 
 /*
- * Pass 1 computes CSR row pointer for the matrix product C = A * B
+ * Row accumulators for the matrix product C = A*B
+ *
+ * Each row of C is accumulated either in dense scratch arrays of length
+ * n_col (the SMMP linked list), or in a small open-addressing hash table
+ * sized for the row. The hash table is used when n_col is large and the
+ * row has few multiply-adds compared to n_col, so that hypersparse
+ * products never allocate or touch O(n_col) scratch memory. The dense
+ * arrays are only allocated once a row needs them.
+ *
+ * Both accumulators emit the entries of a row in the same order, so the
+ * result does not depend on which one was used.
  *
  */
-template <class I>
-void csr_matmat_pass1(const I n_row,
-                      const I n_col,
-                      const I Ap[],
-                      const I Aj[],
-                      const I Bp[],
-                      const I Bj[],
-                            I Cp[])
-{
-    // method that uses O(n) temp storage
-    std::vector<I> mask(n_col, -1);
-    Cp[0] = 0;
+#define SPGEMM_HASH_MIN_NCOL 65536
+#define SPGEMM_HASH_FILL_RATIO 16
+#define SPGEMM_HASH_EMPTY -1
 
-    I nnz = 0;
-    for(I i = 0; i < n_row; i++){
-        npy_intp row_nnz = 0;
+template <class I, class T>
+struct spgemm_workspace {
+    explicit spgemm_workspace(const I n_col) : n_col(n_col) {}
 
-        for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
-            I j = Aj[jj];
-            for(I kk = Bp[j]; kk < Bp[j+1]; kk++){
-                I k = Bj[kk];
-                if(mask[k] != i){
-                    mask[k] = i;
-                    row_nnz++;
-                }
-            }
-        }
+    const I n_col;
 
-        npy_intp next_nnz = nnz + row_nnz;
+    // dense accumulator
+    std::vector<I> mask;
+    std::vector<I> next;
+    std::vector<T> sums;
 
-        if (row_nnz > NPY_MAX_INTP - nnz || next_nnz != (I)next_nnz) {
-            /*
-             * Index overflowed. Note that row_nnz <= n_col and cannot overflow
-             */
-            throw std::overflow_error("nnz of the result is too large");
-        }
+    // hash accumulator; slots lists the used slots in insertion order
+    std::vector<I> keys;
+    std::vector<T> vals;
+    std::vector<npy_intp> slots;
+    int hash_bits;
+};
 
-        nnz = next_nnz;
-        Cp[i+1] = nnz;
-    }
-}
 
 /*
- * Pass 2 computes CSR entries for matrix C = A*B using the
- * row pointer Cp[] computed in Pass 1.
+ * Number of multiply-adds needed for row i of C = A*B, or -1 if the
+ * dense accumulator is going to be used for any row in any case.
+ */
+template <class I>
+npy_intp csr_matmat_row_flops(const I i,
+                              const I n_col,
+                              const I Ap[],
+                              const I Aj[],
+                              const I Bp[])
+{
+    if (n_col < SPGEMM_HASH_MIN_NCOL) {
+        return -1;
+    }
+
+    npy_intp row_flops = 0;
+    for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+        const I j = Aj[jj];
+        row_flops += Bp[j+1] - Bp[j];
+    }
+    return row_flops;
+}
+
+
+/*
+ * Prepare the hash accumulator for a row with at most row_flops entries.
+ * Returns false if the dense accumulator should be used instead.
+ */
+template <class I, class T>
+bool spgemm_hash_begin_row(spgemm_workspace<I,T>& ws,
+                           const npy_intp row_flops,
+                           const bool with_values)
+{
+    if (row_flops < 0 ||
+            row_flops >= ws.n_col / SPGEMM_HASH_FILL_RATIO) {
+        return false;
+    }
+
+    // table at most half full
+    int bits = 4;
+    while (((npy_intp)1 << bits) < 2 * row_flops) {
+        bits++;
+    }
+    const npy_intp size = (npy_intp)1 << bits;
+
+    if ((npy_intp)ws.keys.size() < size) {
+        ws.keys.resize(size, SPGEMM_HASH_EMPTY);
+    }
+    if (with_values && (npy_intp)ws.vals.size() < size) {
+        ws.vals.resize(size, 0);
+    }
+    ws.hash_bits = bits;
+    ws.slots.clear();
+    return true;
+}
+
+
+/*
+ * Find the slot of column k in the hash accumulator, inserting it if
+ * it is not present yet.
+ */
+template <class I, class T>
+npy_intp spgemm_hash_insert(spgemm_workspace<I,T>& ws, const I k)
+{
+    // Fibonacci hashing: take the top bits of the product
+    const npy_intp mask = ((npy_intp)1 << ws.hash_bits) - 1;
+    npy_intp slot = (npy_intp)(((npy_uint64)k * 11400714819323198485ULL)
+                               >> (64 - ws.hash_bits));
+
+    while (ws.keys[slot] != k) {
+        if (ws.keys[slot] == SPGEMM_HASH_EMPTY) {
+            ws.keys[slot] = k;
+            ws.slots.push_back(slot);
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+
+/*
+ * Compute the number of nonzeros in row i of C = A*B
+ */
+template <class I, class T>
+I csr_matmat_row_nnz(const I i,
+                     const I Ap[],
+                     const I Aj[],
+                     const I Bp[],
+                     const I Bj[],
+                     spgemm_workspace<I,T>& ws)
+{
+    const npy_intp row_flops = csr_matmat_row_flops(i, ws.n_col, Ap, Aj, Bp);
+
+    if (spgemm_hash_begin_row(ws, row_flops, false)) {
+        for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+            I j = Aj[jj];
+            for(I kk = Bp[j]; kk < Bp[j+1]; kk++){
+                spgemm_hash_insert(ws, Bj[kk]);
+            }
+        }
+
+        const I row_nnz = ws.slots.size();
+        for(size_t n = 0; n < ws.slots.size(); n++){
+            ws.keys[ws.slots[n]] = SPGEMM_HASH_EMPTY;
+        }
+        return row_nnz;
+    }
+
+    if (ws.mask.empty()) {
+        ws.mask.assign(ws.n_col, -1);
+    }
+
+    I row_nnz = 0;
+    for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+        I j = Aj[jj];
+        for(I kk = Bp[j]; kk < Bp[j+1]; kk++){
+            I k = Bj[kk];
+            if(ws.mask[k] != i){
+                ws.mask[k] = i;
+                row_nnz++;
+            }
+        }
+    }
+    return row_nnz;
+}
+
+
+/*
+ * Compute row i of C = A*B, writing its nonzero entries to Cj, Cx.
+ * Returns the number of entries written.
+ */
+template <class I, class T>
+I csr_matmat_row(const I i,
+                 const I Ap[],
+                 const I Aj[],
+                 const T Ax[],
+                 const I Bp[],
+                 const I Bj[],
+                 const T Bx[],
+                       I Cj[],
+                       T Cx[],
+                 spgemm_workspace<I,T>& ws)
+{
+    const npy_intp row_flops = csr_matmat_row_flops(i, ws.n_col, Ap, Aj, Bp);
+    I nnz = 0;
+
+    if (spgemm_hash_begin_row(ws, row_flops, true)) {
+        for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+            I j = Aj[jj];
+            T v = Ax[jj];
+            for(I kk = Bp[j]; kk < Bp[j+1]; kk++){
+                const npy_intp slot = spgemm_hash_insert(ws, Bj[kk]);
+                ws.vals[slot] += v*Bx[kk];
+            }
+        }
+
+        // most recently inserted first, as in the dense accumulator
+        for(size_t n = ws.slots.size(); n > 0; n--){
+            const npy_intp slot = ws.slots[n-1];
+            if(ws.vals[slot] != 0){
+                Cj[nnz] = ws.keys[slot];
+                Cx[nnz] = ws.vals[slot];
+                nnz++;
+            }
+            ws.keys[slot] = SPGEMM_HASH_EMPTY;
+            ws.vals[slot] = 0;
+        }
+        return nnz;
+    }
+
+    if (ws.next.empty()) {
+        ws.next.assign(ws.n_col, -1);
+        ws.sums.assign(ws.n_col, 0);
+    }
+    std::vector<I>& next = ws.next;
+    std::vector<T>& sums = ws.sums;
+
+    I head   = -2;
+    I length =  0;
+
+    I jj_start = Ap[i];
+    I jj_end   = Ap[i+1];
+    for(I jj = jj_start; jj < jj_end; jj++){
+        I j = Aj[jj];
+        T v = Ax[jj];
+
+        I kk_start = Bp[j];
+        I kk_end   = Bp[j+1];
+        for(I kk = kk_start; kk < kk_end; kk++){
+            I k = Bj[kk];
+
+            sums[k] += v*Bx[kk];
+
+            if(next[k] == -1){
+                next[k] = head;
+                head  = k;
+                length++;
+            }
+        }
+    }
+
+    for(I jj = 0; jj < length; jj++){
+
+        if(sums[head] != 0){
+            Cj[nnz] = head;
+            Cx[nnz] = sums[head];
+            nnz++;
+        }
+
+        I temp = head;
+        head = next[head];
+
+        next[temp] = -1; //clear arrays
+        sums[temp] =  0;
+    }
+    return nnz;
+}
+
+
+/*
+ * Append row_nnz to the row pointer, checking for index overflow
+ */
+template <class I>
+I csr_matmat_add_row_nnz(const I nnz, const npy_intp row_nnz)
+{
+    npy_intp next_nnz = nnz + row_nnz;
+
+    if (row_nnz > NPY_MAX_INTP - nnz || next_nnz != (I)next_nnz) {
+        /*
+         * Index overflowed. Note that row_nnz <= n_col and cannot overflow
+         */
+        throw std::overflow_error("nnz of the result is too large");
+    }
+    return next_nnz;
+}
+
+
+/*
+ * Pass 1 computes CSR row pointer for the matrix product C = A * B
+ *
+ */
+template <class I>
+void csr_matmat_pass1(const I n_row,
+                      const I n_col,
+                      const I Ap[],
+                      const I Aj[],
+                      const I Bp[],
+                      const I Bj[],
+                            I Cp[])
+{
+    // method that uses O(n) temp storage
+    spgemm_workspace<I,char> ws(n_col);
+    Cp[0] = 0;
+
+    I nnz = 0;
+    for(I i = 0; i < n_row; i++){
+        nnz = csr_matmat_add_row_nnz(nnz, csr_matmat_row_nnz(i, Ap, Aj, Bp, Bj, ws));
+        Cp[i+1] = nnz;
+    }
+}
+
+/*
+ * Pass 2 computes CSR entries for matrix C = A*B using the
+ * row pointer Cp[] computed in Pass 1.
  *
  */
 template <class I, class T>
@@ -618,58 +1459,273 @@ void csr_matmat_pass2(const I n_row,
                             I Cj[],
                             T Cx[])
 {
-    std::vector<I> next(n_col,-1);
-    std::vector<T> sums(n_col, 0);
+    spgemm_workspace<I,T> ws(n_col);
 
     I nnz = 0;
 
     Cp[0] = 0;
 
     for(I i = 0; i < n_row; i++){
-        I head   = -2;
-        I length =  0;
+        nnz += csr_matmat_row(i, Ap, Aj, Ax, Bp, Bj, Bx, Cj + nnz, Cx + nnz, ws);
+        Cp[i+1] = nnz;
+    }
+}
 
-        I jj_start = Ap[i];
-        I jj_end   = Ap[i+1];
-        for(I jj = jj_start; jj < jj_end; jj++){
-            I j = Aj[jj];
-            T v = Ax[jj];
 
-            I kk_start = Bp[j];
-            I kk_end   = Bp[j+1];
-            for(I kk = kk_start; kk < kk_end; kk++){
-                I k = Bj[kk];
+/*
+ * Compute the number of multiply-adds for each row of C = A*B
+ *
+ * Output Arguments:
+ *   npy_intp  flops[n_row+1] - flops[i+1] - flops[i] is the work for
+ *                              row i; flops[0] == 0
+ *
+ */
+template <class I>
+void csr_matmat_flops(const I n_row,
+                      const I Ap[],
+                      const I Aj[],
+                      const I Bp[],
+                      npy_intp flops[])
+{
+    flops[0] = 0;
+    for(I i = 0; i < n_row; i++){
+        npy_intp row_flops = 0;
+        for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+            const I j = Aj[jj];
+            row_flops += Bp[j+1] - Bp[j];
+        }
+        flops[i+1] = flops[i] + row_flops;
+    }
+}
 
-                sums[k] += v*Bx[kk];
 
-                if(next[k] == -1){
-                    next[k] = head;
-                    head  = k;
-                    length++;
-                }
-            }
+/*
+ * Multithreaded version of csr_matmat_pass1
+ *
+ * Rows of A are split into chunks with roughly the same number of
+ * multiply-adds. Each thread counts the nnz of its rows of C with its own
+ * accumulator, and the row pointer is then formed by a serial prefix sum.
+ *
+ * Input Arguments:
+ *   See csr_matmat_pass1, plus
+ *   I  workers     - maximum number of threads to use
+ *
+ * Note:
+ *   Each thread may allocate O(n_col) temporary storage.
+ *
+ */
+template <class I>
+void csr_matmat_pass1_threaded(const I n_row,
+                               const I n_col,
+                               const I Ap[],
+                               const I Aj[],
+                               const I Bp[],
+                               const I Bj[],
+                                     I Cp[],
+                               const I workers)
+{
+    std::vector<npy_intp> flops(n_row + 1);
+    csr_matmat_flops(n_row, Ap, Aj, Bp, &flops[0]);
+
+    const I n_chunks = parallel_num_chunks(workers, flops[n_row] + n_row);
+    if (n_chunks <= 1) {
+        csr_matmat_pass1(n_row, n_col, Ap, Aj, Bp, Bj, Cp);
+        return;
+    }
+
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row, &flops[0], n_chunks, &bounds[0]);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        spgemm_workspace<I,char> ws(n_col);
+        for(I i = bounds[c]; i < bounds[c+1]; i++){
+            Cp[i+1] = csr_matmat_row_nnz(i, Ap, Aj, Bp, Bj, ws);
         }
+    });
 
-        for(I jj = 0; jj < length; jj++){
+    Cp[0] = 0;
 
-            if(sums[head] != 0){
-                Cj[nnz] = head;
-                Cx[nnz] = sums[head];
-                nnz++;
-            }
+    I nnz = 0;
+    for(I i = 0; i < n_row; i++){
+        nnz = csr_matmat_add_row_nnz(nnz, Cp[i+1]);
+        Cp[i+1] = nnz;
+    }
+}
 
-            I temp = head;
-            head = next[head];
+/*
+ * Multithreaded version of csr_matmat_pass2
+ *
+ * The rows of C are split as in csr_matmat_pass1_threaded. Each thread
+ * owns its own accumulator and fills the disjoint range of Cj and Cx
+ * reserved for its rows by pass 1. Entries that cancel to zero leave
+ * gaps, which are closed by a final serial compaction that only moves
+ * data when such cancellations occurred.
+ *
+ * Input Arguments:
+ *   See csr_matmat_pass2, plus
+ *   I  workers     - maximum number of threads to use
+ *
+ * Note:
+ *   Cp must contain the row pointer computed by pass 1 on input, and
+ *   holds the row pointer of C on output.
+ *
+ *   Each thread may allocate O(n_col) temporary storage.
+ *
+ */
+template <class I, class T>
+void csr_matmat_pass2_threaded(const I n_row,
+                               const I n_col,
+                               const I Ap[],
+                               const I Aj[],
+                               const T Ax[],
+                               const I Bp[],
+                               const I Bj[],
+                               const T Bx[],
+                                     I Cp[],
+                                     I Cj[],
+                                     T Cx[],
+                               const I workers)
+{
+    std::vector<npy_intp> flops(n_row + 1);
+    csr_matmat_flops(n_row, Ap, Aj, Bp, &flops[0]);
+
+    const I n_chunks = parallel_num_chunks(workers, flops[n_row] + n_row);
+    if (n_chunks <= 1) {
+        csr_matmat_pass2(n_row, n_col, Ap, Aj, Ax, Bp, Bj, Bx, Cp, Cj, Cx);
+        return;
+    }
+
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row, &flops[0], n_chunks, &bounds[0]);
+
+    // Offsets of each chunk into Cj/Cx, as reserved by pass 1
+    std::vector<I> chunk_start(n_chunks);
+    for(I c = 0; c < n_chunks; c++){
+        chunk_start[c] = Cp[bounds[c]];
+    }
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        spgemm_workspace<I,T> ws(n_col);
+        I nnz = chunk_start[c];
+
+        for(I i = bounds[c]; i < bounds[c+1]; i++){
+            nnz += csr_matmat_row(i, Ap, Aj, Ax, Bp, Bj, Bx, Cj + nnz, Cx + nnz, ws);
 
-            next[temp] = -1; //clear arrays
-            sums[temp] =  0;
+            // row end, relative to the start of the chunk for now
+            Cp[i+1] = nnz - chunk_start[c];
         }
+    });
 
-        Cp[i+1] = nnz;
+    // Close the gaps left by cancelled entries, chunk by chunk. Chunks only
+    // move towards the front, so the moves can be done in order.
+    I nnz = 0;
+    Cp[0] = 0;
+    for(I c = 0; c < n_chunks; c++){
+        const I row_start = bounds[c];
+        const I row_end = bounds[c+1];
+        const I chunk_nnz = (row_end > row_start) ? Cp[row_end] : 0;
+
+        if (nnz != chunk_start[c]) {
+            std::copy(Cj + chunk_start[c], Cj + chunk_start[c] + chunk_nnz,
+                      Cj + nnz);
+            std::copy(Cx + chunk_start[c], Cx + chunk_start[c] + chunk_nnz,
+                      Cx + nnz);
+        }
+        for(I i = row_start; i < row_end; i++){
+            Cp[i+1] += nnz;
+        }
+        nnz += chunk_nnz;
     }
 }
 
 
+/*
+ * Compute C = (A*B) .* M for CSR matrices A, B and the sparsity pattern
+ * of a CSR matrix M
+ *
+ * Only the entries of the product that lie inside the pattern of M are
+ * computed, so the full product is never materialized. The result has
+ * the sparsity structure of M (Mp, Mj), and its values are written to Cx.
+ *
+ * Input Arguments:
+ *   I  n_row       - number of rows in A
+ *   I  n_col       - number of columns in B (hence C is n_row by n_col)
+ *   I  Ap[n_row+1] - row pointer
+ *   I  Aj[nnz(A)]  - column indices
+ *   T  Ax[nnz(A)]  - nonzeros
+ *   I  Bp[?]       - row pointer
+ *   I  Bj[nnz(B)]  - column indices
+ *   T  Bx[nnz(B)]  - nonzeros
+ *   I  Mp[n_row+1] - row pointer of the mask
+ *   I  Mj[nnz(M)]  - column indices of the mask
+ *   I  workers     - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   T  Cx[nnz(M)]  - entries of A*B at the positions of the mask
+ *
+ * Note:
+ *   Output array Cx must be preallocated
+ *
+ *   The mask must not contain duplicate entries; its column indices do
+ *   not need to be sorted. Entries of the mask where the product is zero
+ *   are set to zero explicitly.
+ *
+ *   Each thread allocates O(n_col) temporary storage.
+ *
+ *   Complexity: O(nnz(M) + flops(A*B)), where only the multiply-adds
+ *   landing inside the mask write to memory.
+ *
+ */
+template <class I, class T>
+void csr_matmat_masked(const I n_row,
+                       const I n_col,
+                       const I Ap[],
+                       const I Aj[],
+                       const T Ax[],
+                       const I Bp[],
+                       const I Bj[],
+                       const T Bx[],
+                       const I Mp[],
+                       const I Mj[],
+                             T Cx[],
+                       const I workers)
+{
+    std::vector<npy_intp> flops(n_row + 1);
+    csr_matmat_flops(n_row, Ap, Aj, Bp, &flops[0]);
+
+    const I n_chunks = parallel_num_chunks(workers, flops[n_row] + n_row);
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row, &flops[0], n_chunks, &bounds[0]);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        // position of column k in the current row of the mask, or -1
+        std::vector<I> pos(n_col, -1);
+
+        for(I i = bounds[c]; i < bounds[c+1]; i++){
+            for(I jj = Mp[i]; jj < Mp[i+1]; jj++){
+                pos[Mj[jj]] = jj;
+                Cx[jj] = 0;
+            }
+
+            for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+                const I j = Aj[jj];
+                const T v = Ax[jj];
+                for(I kk = Bp[j]; kk < Bp[j+1]; kk++){
+                    const I dest = pos[Bj[kk]];
+                    if(dest != -1){
+                        Cx[dest] += v*Bx[kk];
+                    }
+                }
+            }
+
+            for(I jj = Mp[i]; jj < Mp[i+1]; jj++){
+                pos[Mj[jj]] = -1;
+            }
+        }
+    });
+}
+
+
 /*
  * Compute C = A (binary_op) B for CSR matrices that are not
  * necessarily canonical CSR format.  Specifically, this method
@@ -907,14 +1963,221 @@ void csr_binop_csr(const I n_row,
         csr_binop_csr_general(n_row, n_col, Ap, Aj, Ax, Bp, Bj, Bx, Cp, Cj, Cx, op);
 }
 
-/* element-wise binary operations*/
-template <class I, class T, class T2>
-void csr_ne_csr(const I n_row, const I n_col,
-                const I Ap[], const I Aj[], const T Ax[],
-                const I Bp[], const I Bj[], const T Bx[],
-                      I Cp[],       I Cj[],      T2 Cx[])
-{
-    csr_binop_csr(n_row,n_col,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,std::not_equal_to<T>());
+/*
+ * Run a row-wise elementwise kernel C = A (op) B on several threads
+ *
+ * The rows are split into chunks balanced by nnz(A) + nnz(B). Since a row
+ * of C has at most as many entries as the rows of A and B together, chunk
+ * c can write its output directly at offset Ap[r0] + Bp[r0] of Cj and Cx,
+ * where r0 is its first row. A serial pass then closes the gaps between
+ * the chunks and fills in Cp.
+ *
+ * Input Arguments:
+ *   I    n_row       - number of rows in A (and B)
+ *   npy_intp RC      - number of values per entry (block size for BSR)
+ *   I    Ap[n_row+1] - row pointer of A
+ *   I    Bp[n_row+1] - row pointer of B
+ *   I    workers     - maximum number of threads to use
+ *   F    kernel      - kernel(r0, r1, Cp_local, Cj_out, Cx_out) computes
+ *                      rows [r0, r1) of C into Cj_out and Cx_out, with row
+ *                      pointer Cp_local[0..r1-r0] starting at zero
+ *
+ * Output Arguments:
+ *   I    Cp[n_row+1] - row pointer
+ *   I    Cj[nnz(C)]  - column indices
+ *   T2   Cx[nnz(C)]  - nonzeros
+ *
+ * Note:
+ *   Cj and Cx must have room for nnz(A) + nnz(B) entries
+ *
+ */
+template <class I, class T2, class F>
+void binop_parallel_rows(const I n_row,
+                         const npy_intp RC,
+                         const I Ap[],
+                         const I Bp[],
+                               I Cp[],
+                               I Cj[],
+                              T2 Cx[],
+                         const I workers,
+                         const F& kernel)
+{
+    const npy_intp max_nnz = (npy_intp)Ap[n_row] + Bp[n_row];
+    const I n_chunks = parallel_num_chunks(workers, RC * max_nnz + n_row);
+    if (n_chunks <= 1) {
+        kernel((I)0, n_row, Cp, Cj, Cx);
+        return;
+    }
+
+    std::vector<npy_intp> bound(n_row + 1);
+    for(I i = 0; i <= n_row; i++){
+        bound[i] = (npy_intp)Ap[i] + Bp[i];
+    }
+
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row, &bound[0], n_chunks, &bounds[0]);
+
+    std::vector<std::vector<I> > chunk_Cp(n_chunks);
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        const I r0 = bounds[c];
+        const I r1 = bounds[c+1];
+        const npy_intp base = bound[r0] - bound[0];
+        chunk_Cp[c].resize(r1 - r0 + 1);
+        kernel(r0, r1, &chunk_Cp[c][0], Cj + base, Cx + RC * base);
+    });
+
+    npy_intp nnz = 0;
+    Cp[0] = 0;
+    for(I c = 0; c < n_chunks; c++){
+        const I r0 = bounds[c];
+        const I r1 = bounds[c+1];
+        const npy_intp base = bound[r0] - bound[0];
+        const npy_intp len = chunk_Cp[c][r1 - r0];
+        if (base != nnz) {
+            std::copy(Cj + base, Cj + base + len, Cj + nnz);
+            std::copy(Cx + RC * base, Cx + RC * (base + len), Cx + RC * nnz);
+        }
+        for(I i = r0; i < r1; i++){
+            Cp[i+1] = nnz + chunk_Cp[c][i - r0 + 1];
+        }
+        nnz += len;
+    }
+}
+
+
+/*
+ * Codes for the operators of csr_binop_csr_threaded, csr_cmpop_csr_threaded
+ * and their BSR and CSC counterparts. These must match _binop_codes in
+ * compressed.py.
+ */
+enum {
+    BINOP_PLUS = 0,
+    BINOP_MINUS = 1,
+    BINOP_ELMUL = 2,
+    BINOP_ELDIV = 3,
+    BINOP_MAXIMUM = 4,
+    BINOP_MINIMUM = 5
+};
+
+enum {
+    CMPOP_NE = 0,
+    CMPOP_LT = 1,
+    CMPOP_GT = 2,
+    CMPOP_LE = 3,
+    CMPOP_GE = 4
+};
+
+
+template <class I, class T, class T2, class binary_op>
+void csr_binop_csr_parallel(const I n_row, const I n_col,
+                            const I Ap[], const I Aj[], const T Ax[],
+                            const I Bp[], const I Bj[], const T Bx[],
+                                  I Cp[],       I Cj[],       T2 Cx[],
+                            const binary_op& op,
+                            const I workers)
+{
+    binop_parallel_rows(n_row, 1, Ap, Bp, Cp, Cj, Cx, workers,
+        [&](I r0, I r1, I Cp_local[], I Cj_out[], T2 Cx_out[]) {
+            csr_binop_csr(r1 - r0, n_col, Ap + r0, Aj, Ax, Bp + r0, Bj, Bx,
+                          Cp_local, Cj_out, Cx_out, op);
+        });
+}
+
+
+/*
+ * Threaded version of the arithmetic elementwise operations
+ * csr_plus_csr, csr_minus_csr, csr_elmul_csr, csr_eldiv_csr,
+ * csr_maximum_csr and csr_minimum_csr
+ *
+ * Input Arguments:
+ *   I    op          - one of the BINOP_* codes
+ *   I    workers     - maximum number of threads to use
+ *
+ * The remaining arguments are as for csr_binop_csr. Whether the canonical
+ * or the general method is used is decided for each chunk of rows.
+ *
+ */
+template <class I, class T>
+void csr_binop_csr_threaded(const I n_row, const I n_col,
+                            const I Ap[], const I Aj[], const T Ax[],
+                            const I Bp[], const I Bj[], const T Bx[],
+                                  I Cp[],       I Cj[],       T Cx[],
+                            const I op,
+                            const I workers)
+{
+    switch (op) {
+    case BINOP_PLUS:
+        csr_binop_csr_parallel(n_row,n_col,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,std::plus<T>(),workers);
+        break;
+    case BINOP_MINUS:
+        csr_binop_csr_parallel(n_row,n_col,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,std::minus<T>(),workers);
+        break;
+    case BINOP_ELMUL:
+        csr_binop_csr_parallel(n_row,n_col,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,std::multiplies<T>(),workers);
+        break;
+    case BINOP_ELDIV:
+        csr_binop_csr_parallel(n_row,n_col,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,safe_divides<T>(),workers);
+        break;
+    case BINOP_MAXIMUM:
+        csr_binop_csr_parallel(n_row,n_col,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,maximum<T>(),workers);
+        break;
+    case BINOP_MINIMUM:
+        csr_binop_csr_parallel(n_row,n_col,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,minimum<T>(),workers);
+        break;
+    default:
+        throw std::domain_error("unknown binary operation");
+    }
+}
+
+
+/*
+ * Threaded version of the elementwise comparisons csr_ne_csr, csr_lt_csr,
+ * csr_gt_csr, csr_le_csr and csr_ge_csr
+ *
+ * Input Arguments:
+ *   I    op          - one of the CMPOP_* codes
+ *   I    workers     - maximum number of threads to use
+ *
+ * The remaining arguments are as for csr_binop_csr.
+ *
+ */
+template <class I, class T, class T2>
+void csr_cmpop_csr_threaded(const I n_row, const I n_col,
+                            const I Ap[], const I Aj[], const T Ax[],
+                            const I Bp[], const I Bj[], const T Bx[],
+                                  I Cp[],       I Cj[],      T2 Cx[],
+                            const I op,
+                            const I workers)
+{
+    switch (op) {
+    case CMPOP_NE:
+        csr_binop_csr_parallel(n_row,n_col,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,std::not_equal_to<T>(),workers);
+        break;
+    case CMPOP_LT:
+        csr_binop_csr_parallel(n_row,n_col,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,std::less<T>(),workers);
+        break;
+    case CMPOP_GT:
+        csr_binop_csr_parallel(n_row,n_col,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,std::greater<T>(),workers);
+        break;
+    case CMPOP_LE:
+        csr_binop_csr_parallel(n_row,n_col,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,std::less_equal<T>(),workers);
+        break;
+    case CMPOP_GE:
+        csr_binop_csr_parallel(n_row,n_col,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,std::greater_equal<T>(),workers);
+        break;
+    default:
+        throw std::domain_error("unknown comparison operation");
+    }
+}
+
+/* element-wise binary operations*/
+template <class I, class T, class T2>
+void csr_ne_csr(const I n_row, const I n_col,
+                const I Ap[], const I Aj[], const T Ax[],
+                const I Bp[], const I Bj[], const T Bx[],
+                      I Cp[],       I Cj[],      T2 Cx[])
+{
+    csr_binop_csr(n_row,n_col,Ap,Aj,Ax,Bp,Bj,Bx,Cp,Cj,Cx,std::not_equal_to<T>());
 }
 
 template <class I, class T, class T2>
@@ -1176,454 +2439,2149 @@ void csr_matvecs(const I n_row,
 }
 
 
-
-
-template<class I, class T>
-void get_csr_submatrix(const I n_row,
-                       const I n_col,
-                       const I Ap[],
-                       const I Aj[],
-                       const T Ax[],
-                       const I ir0,
-                       const I ir1,
-                       const I ic0,
-                       const I ic1,
-                       std::vector<I>* Bp,
-                       std::vector<I>* Bj,
-                       std::vector<T>* Bx)
+/*
+ * Compute Y += A*X for CSR matrix A and dense vectors X,Y using
+ * several threads
+ *
+ * The rows of A are split into contiguous chunks with roughly the same
+ * number of nonzeros, and each chunk is handled by csr_matvec on its own
+ * thread. Each thread writes a disjoint range of Y, so the result is
+ * bitwise identical to csr_matvec.
+ *
+ * Input Arguments:
+ *   I  n_row         - number of rows in A
+ *   I  n_col         - number of columns in A
+ *   I  Ap[n_row+1]   - row pointer
+ *   I  Aj[nnz(A)]    - column indices
+ *   T  Ax[nnz(A)]    - nonzeros
+ *   T  Xx[n_col]     - input vector
+ *   I  workers       - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   T  Yx[n_row]     - output vector
+ *
+ * Note:
+ *   Output array Yx must be preallocated
+ *
+ *   Small problems are run serially, see parallel_num_chunks.
+ *
+ */
+template <class I, class T>
+void csr_matvec_threaded(const I n_row,
+                         const I n_col,
+                         const I Ap[],
+                         const I Aj[],
+                         const T Ax[],
+                         const T Xx[],
+                               T Yx[],
+                         const I workers)
 {
-    I new_n_row = ir1 - ir0;
-    //I new_n_col = ic1 - ic0;  //currently unused
-    I new_nnz = 0;
-    I kk = 0;
-
-    // Count nonzeros total/per row.
-    for(I i = 0; i < new_n_row; i++){
-        I row_start = Ap[ir0+i];
-        I row_end   = Ap[ir0+i+1];
-
-        for(I jj = row_start; jj < row_end; jj++){
-            if ((Aj[jj] >= ic0) && (Aj[jj] < ic1)) {
-                new_nnz++;
-            }
-        }
+    const I n_chunks = parallel_num_chunks(workers, (npy_intp)Ap[n_row] + n_row);
+    if (n_chunks <= 1) {
+        csr_matvec(n_row, n_col, Ap, Aj, Ax, Xx, Yx);
+        return;
     }
 
-    // Allocate.
-    Bp->resize(new_n_row+1);
-    Bj->resize(new_nnz);
-    Bx->resize(new_nnz);
-
-    // Assign.
-    (*Bp)[0] = 0;
-    for(I i = 0; i < new_n_row; i++){
-        I row_start = Ap[ir0+i];
-        I row_end   = Ap[ir0+i+1];
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row, Ap, n_chunks, &bounds[0]);
 
-        for(I jj = row_start; jj < row_end; jj++){
-            if ((Aj[jj] >= ic0) && (Aj[jj] < ic1)) {
-                (*Bj)[kk] = Aj[jj] - ic0;
-                (*Bx)[kk] = Ax[jj];
-                kk++;
-            }
-        }
-        (*Bp)[i+1] = kk;
-    }
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        const I row_start = bounds[c];
+        const I row_end   = bounds[c+1];
+        csr_matvec(row_end - row_start, n_col, Ap + row_start, Aj, Ax,
+                   Xx, Yx + row_start);
+    });
 }
 
 
 /*
- * Slice rows given as an array of indices.
+ * Compute Y += A*X for CSR matrix A and dense block vectors X,Y using
+ * several threads
+ *
+ * See csr_matvec_threaded for the partitioning strategy.
  *
  * Input Arguments:
- *   I  n_row_idx       - number of row indices
- *   I  rows[n_row_idx] - row indices for indexing
- *   I  Ap[n_row+1]     - row pointer
- *   I  Aj[nnz(A)]      - column indices
- *   T  Ax[nnz(A)]      - data
+ *   I  n_row            - number of rows in A
+ *   I  n_col            - number of columns in A
+ *   I  n_vecs           - number of column vectors in X and Y
+ *   I  Ap[n_row+1]      - row pointer
+ *   I  Aj[nnz(A)]       - column indices
+ *   T  Ax[nnz(A)]       - nonzeros
+ *   T  Xx[n_col,n_vecs] - input vector
+ *   I  workers          - maximum number of threads to use
  *
  * Output Arguments:
- *   I  Bj - new column indices
- *   T  Bx - new data
+ *   T  Yx[n_row,n_vecs] - output vector
  *
  */
-template<class I, class T>
-void csr_row_index(const I n_row_idx,
-                   const I rows[],
-                   const I Ap[],
-                   const I Aj[],
-                   const T Ax[],
-                   I Bj[],
-                   T Bx[])
+template <class I, class T>
+void csr_matvecs_threaded(const I n_row,
+                          const I n_col,
+                          const I n_vecs,
+                          const I Ap[],
+                          const I Aj[],
+                          const T Ax[],
+                          const T Xx[],
+                                T Yx[],
+                          const I workers)
 {
-    for(I i = 0; i < n_row_idx; i++){
-        const I row = rows[i];
-        const I row_start = Ap[row];
-        const I row_end   = Ap[row+1];
-        Bj = std::copy(Aj + row_start, Aj + row_end, Bj);
-        Bx = std::copy(Ax + row_start, Ax + row_end, Bx);
+    const I n_chunks = parallel_num_chunks(
+        workers, ((npy_intp)Ap[n_row] + n_row) * n_vecs);
+    if (n_chunks <= 1) {
+        csr_matvecs(n_row, n_col, n_vecs, Ap, Aj, Ax, Xx, Yx);
+        return;
     }
+
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row, Ap, n_chunks, &bounds[0]);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        const I row_start = bounds[c];
+        const I row_end   = bounds[c+1];
+        csr_matvecs(row_end - row_start, n_col, n_vecs, Ap + row_start, Aj, Ax,
+                    Xx, Yx + (npy_intp)n_vecs * row_start);
+    });
 }
 
 
 /*
- * Slice rows given as a (start, stop, step) tuple.
+ * Compute Y += A*X for CSR matrix A and dense vectors X,Y, with the sums
+ * done in a wider type than the nonzeros of A
+ *
+ * This lets A be stored in single precision, which halves the memory
+ * traffic of a matvec, while X, Y and the sums are in double precision.
+ * Each nonzero is converted exactly, so the result is bitwise identical
+ * to csr_matvec on a double precision copy of A. The row pointer is
+ * 64-bit regardless of I, so that matrices with more than 2^31 nonzeros
+ * can still use 32-bit column indices.
  *
  * Input Arguments:
- *   I  start
- *   I  stop
- *   I  step
- *   I  Ap[N+1]    - row pointer
- *   I  Aj[nnz(A)] - column indices
- *   T  Ax[nnz(A)] - data
+ *   I  n_row         - number of rows in A
+ *   I  n_col         - number of columns in A
+ *   P  Ap[n_row+1]   - row pointer, 64-bit
+ *   I  Aj[nnz(A)]    - column indices
+ *   T  Ax[nnz(A)]    - nonzeros
+ *   U  Xx[n_col]     - input vector
+ *   I  workers       - maximum number of threads to use
  *
  * Output Arguments:
- *   I  Bj - new column indices
- *   T  Bx - new data
+ *   U  Yx[n_row]     - output vector
+ *
+ * Note:
+ *   Output array Yx must be preallocated
+ *
+ *   U is the accumulator type of T, see ACC_TYPES in
+ *   generate_sparsetools.py.
  *
  */
-template<class I, class T>
-void csr_row_slice(const I start,
-                   const I stop,
-                   const I step,
-                   const I Ap[],
-                   const I Aj[],
-                   const T Ax[],
-                   I Bj[],
-                   T Bx[])
+template <class I, class T, class U>
+void csr_matvec_mixed(const I n_row,
+                      const I n_col,
+                      const npy_int64 Ap[],
+                      const I Aj[],
+                      const T Ax[],
+                      const U Xx[],
+                            U Yx[],
+                      const I workers)
 {
-    if (step > 0) {
-        for(I row = start; row < stop; row += step){
-            const I row_start = Ap[row];
-            const I row_end   = Ap[row+1];
-            Bj = std::copy(Aj + row_start, Aj + row_end, Bj);
-            Bx = std::copy(Ax + row_start, Ax + row_end, Bx);
-        }
-    } else {
-        for(I row = start; row > stop; row += step){
-            const I row_start = Ap[row];
-            const I row_end   = Ap[row+1];
-            Bj = std::copy(Aj + row_start, Aj + row_end, Bj);
-            Bx = std::copy(Ax + row_start, Ax + row_end, Bx);
+    const I n_chunks = parallel_num_chunks(workers, (npy_intp)Ap[n_row] + n_row);
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row, Ap, n_chunks, &bounds[0]);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        for(I i = bounds[c]; i < bounds[c+1]; i++){
+            U sum = Yx[i];
+            for(npy_int64 jj = Ap[i]; jj < Ap[i+1]; jj++){
+                sum += U(Ax[jj]) * Xx[Aj[jj]];
+            }
+            Yx[i] = sum;
         }
-    }
+    });
 }
 
 
 /*
- * Slice columns given as an array of indices (pass 1).
- * This pass counts idx entries and computes a new indptr.
+ * Compute Y += A*X for CSR matrix A and dense block vectors X,Y, with the
+ * sums done in a wider type than the nonzeros of A
+ *
+ * See csr_matvec_mixed. The result is bitwise identical to csr_matvecs on
+ * a copy of A converted to U.
  *
  * Input Arguments:
- *   I  n_idx           - number of indices to slice
- *   I  col_idxs[n_idx] - indices to slice
- *   I  n_row           - major axis dimension
- *   I  n_col           - minor axis dimension
- *   I  Ap[n_row+1]     - indptr
- *   I  Aj[nnz(A)]      - indices
+ *   I  n_row            - number of rows in A
+ *   I  n_col            - number of columns in A
+ *   I  n_vecs           - number of column vectors in X and Y
+ *   P  Ap[n_row+1]      - row pointer, 64-bit
+ *   I  Aj[nnz(A)]       - column indices
+ *   T  Ax[nnz(A)]       - nonzeros
+ *   U  Xx[n_col,n_vecs] - input vector
+ *   I  workers          - maximum number of threads to use
  *
  * Output Arguments:
- *   I  col_offsets[n_col] - cumsum of index repeats
- *   I  Bp[n_row+1]        - new indptr
+ *   U  Yx[n_row,n_vecs] - output vector
  *
  */
-template<class I>
-void csr_column_index1(const I n_idx,
-                       const I col_idxs[],
-                       const I n_row,
+template <class I, class T, class U>
+void csr_matvecs_mixed(const I n_row,
                        const I n_col,
-                       const I Ap[],
+                       const I n_vecs,
+                       const npy_int64 Ap[],
                        const I Aj[],
-                       I col_offsets[],
-                       I Bp[])
+                       const T Ax[],
+                       const U Xx[],
+                             U Yx[],
+                       const I workers)
 {
-    // bincount(col_idxs)
-    for(I jj = 0; jj < n_idx; jj++){
-        const I j = col_idxs[jj];
-        col_offsets[j]++;
-    }
-
-    // Compute new indptr
-    I new_nnz = 0;
-    Bp[0] = 0;
-    for(I i = 0; i < n_row; i++){
-        for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
-            new_nnz += col_offsets[Aj[jj]];
+    const I n_chunks = parallel_num_chunks(
+        workers, ((npy_intp)Ap[n_row] + n_row) * n_vecs);
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row, Ap, n_chunks, &bounds[0]);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        for(I i = bounds[c]; i < bounds[c+1]; i++){
+            U * y = Yx + (npy_intp)n_vecs * i;
+            for(npy_int64 jj = Ap[i]; jj < Ap[i+1]; jj++){
+                const U a = U(Ax[jj]);
+                const U * x = Xx + (npy_intp)n_vecs * Aj[jj];
+                axpy(n_vecs, a, x, y);
+            }
         }
-        Bp[i+1] = new_nnz;
-    }
+    });
+}
 
-    // cumsum in-place
-    for(I j = 1; j < n_col; j++){
-        col_offsets[j] += col_offsets[j - 1];
+
+/*
+ * Compute Y += A*X for rows [row_start, row_end) of CSR matrix A and
+ * columns [k0, k0 + w) of dense block vectors X,Y, w <= SPMM_PANEL_WIDTH
+ *
+ * X is C-ordered if x_fortran is zero, otherwise Fortran-ordered. Y is
+ * C-ordered. If W is nonzero, w must equal W, which lets the compiler
+ * unroll the loops over the panel and keep it in registers.
+ */
+#define SPMM_PANEL_WIDTH 32
+
+template <int W, class I, class T>
+void csr_matvecs_panel(const I row_start,
+                       const I row_end,
+                       const I n_col,
+                       const I n_vecs,
+                       const I k0,
+                       const I w,
+                       const I Ap[],
+                       const I Aj[],
+                       const T Ax[],
+                       const I x_fortran,
+                       const T Xx[],
+                             T Yx[])
+{
+    const I width = (W > 0) ? W : w;
+    T acc[SPMM_PANEL_WIDTH];
+
+    for(I i = row_start; i < row_end; i++){
+        T * y = Yx + (npy_intp)n_vecs * i + k0;
+        for(I k = 0; k < width; k++){
+            acc[k] = y[k];
+        }
+
+        if (!x_fortran) {
+            // contiguous panel of each row of X: unit stride over k
+            for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+                const T a = Ax[jj];
+                const T * x = Xx + (npy_intp)n_vecs * Aj[jj] + k0;
+                for(I k = 0; k < width; k++){
+                    acc[k] += a * x[k];
+                }
+            }
+        } else {
+            // one sparse dot product per contiguous column of X
+            for(I k = 0; k < width; k++){
+                const T * x = Xx + (npy_intp)n_col * (k0 + k);
+                T sum = acc[k];
+                for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+                    sum += Ax[jj] * x[Aj[jj]];
+                }
+                acc[k] = sum;
+            }
+        }
+
+        for(I k = 0; k < width; k++){
+            y[k] = acc[k];
+        }
     }
 }
 
 
 /*
- * Slice columns given as an array of indices (pass 2).
- * This pass populates indices/data entries for selected columns.
+ * Compute Y += A*X for CSR matrix A and dense block vectors X,Y, one
+ * panel of columns at a time
+ *
+ * csr_matvecs updates a whole row of Y, through memory, for every
+ * nonzero. With many vectors that row does not stay in registers, and
+ * the rows of X it reads overflow L1. Here the columns are processed in
+ * panels of SPMM_PANEL_WIDTH, whose partial sums stay in a small local
+ * buffer while a row of A is applied. The rows are split between
+ * threads as in csr_matvecs_threaded, and each thread sweeps its rows
+ * once per panel.
+ *
+ * X may be Fortran-ordered, e.g. the transpose of a C-ordered array, in
+ * which case each column of a panel is a sparse dot product with a
+ * contiguous column of X and no copy is needed.
+ *
+ * Every entry of Y adds the same products in the same order as in
+ * csr_matvecs, so the result is bitwise identical.
  *
  * Input Arguments:
- *   I  col_order[n_idx]   - order of col indices
- *   I  col_offsets[n_col] - cumsum of col index counts
- *   I  nnz                - nnz(A)
- *   I  Aj[nnz(A)]         - column indices
- *   T  Ax[nnz(A)]         - data
+ *   I  n_row            - number of rows in A
+ *   I  n_col            - number of columns in A
+ *   I  n_vecs           - number of column vectors in X and Y
+ *   I  Ap[n_row+1]      - row pointer
+ *   I  Aj[nnz(A)]       - column indices
+ *   T  Ax[nnz(A)]       - nonzeros
+ *   I  x_fortran        - nonzero if X is Fortran-ordered
+ *   T  Xx[n_col,n_vecs] - input vector
+ *   I  workers          - maximum number of threads to use
  *
  * Output Arguments:
- *   I  Bj[nnz(B)] - new column indices
- *   T  Bx[nnz(B)] - new data
+ *   T  Yx[n_row,n_vecs] - output vector, C-ordered
  *
  */
-template<class I, class T>
-void csr_column_index2(const I col_order[],
-                       const I col_offsets[],
-                       const I nnz,
+template <class I, class T>
+void csr_matvecs_tiled(const I n_row,
+                       const I n_col,
+                       const I n_vecs,
+                       const I Ap[],
                        const I Aj[],
                        const T Ax[],
-                       I Bj[],
-                       T Bx[])
+                       const I x_fortran,
+                       const T Xx[],
+                             T Yx[],
+                       const I workers)
 {
-    I n = 0;
-    for(I jj = 0; jj < nnz; jj++){
-        const I j = Aj[jj];
-        const I offset = col_offsets[j];
-        const I prev_offset = j == 0 ? 0 : col_offsets[j-1];
-        if (offset != prev_offset) {
-            const T v = Ax[jj];
-            for(I k = prev_offset; k < offset; k++){
-                Bj[n] = col_order[k];
-                Bx[n] = v;
-                n++;
+    const I n_chunks = parallel_num_chunks(
+        workers, ((npy_intp)Ap[n_row] + n_row) * n_vecs);
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row, Ap, n_chunks, &bounds[0]);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        for(I k0 = 0; k0 < n_vecs; k0 += SPMM_PANEL_WIDTH){
+            const I w = std::min<I>(SPMM_PANEL_WIDTH, n_vecs - k0);
+            if (w == SPMM_PANEL_WIDTH) {
+                csr_matvecs_panel<SPMM_PANEL_WIDTH>(
+                    bounds[c], bounds[c+1], n_col, n_vecs, k0, w,
+                    Ap, Aj, Ax, x_fortran, Xx, Yx);
+            } else {
+                csr_matvecs_panel<0>(
+                    bounds[c], bounds[c+1], n_col, n_vecs, k0, w,
+                    Ap, Aj, Ax, x_fortran, Xx, Yx);
             }
         }
-    }
+    });
 }
 
 
 /*
- * Count the number of occupied diagonals in CSR matrix A
+ * Compute Y += A*X for symmetric matrix A stored as one triangle in CSR
+ * format, and dense vectors X,Y
+ *
+ * Every stored off-diagonal entry a at (i, j) stands for both A(i,j) and
+ * A(j,i), so it is read once and updates Y[i] and Y[j]. Storing just the
+ * upper (or lower) triangle thus halves the memory footprint and the
+ * traffic of a matvec.
  *
  * Input Arguments:
- *   I  nnz             - number of nonzeros in A
- *   I  Ai[nnz(A)]      - row indices
- *   I  Aj[nnz(A)]      - column indices
+ *   I  n_row         - number of rows in A
+ *   I  Ap[n_row+1]   - row pointer
+ *   I  Aj[nnz(A)]    - column indices
+ *   T  Ax[nnz(A)]    - nonzeros
+ *   T  Xx[n_row]     - input vector
+ *
+ * Output Arguments:
+ *   T  Yx[n_row]     - output vector
+ *
+ * Note:
+ *   Output array Yx must be preallocated
+ *
+ *   A must not store both (i, j) and (j, i), or they are counted twice.
+ *   No complex conjugate is taken, so a Hermitian matrix needs all of
+ *   its entries.
  *
  */
-template <class I>
-I csr_count_diagonals(const I n_row,
-                      const I Ap[],
-                      const I Aj[])
+template <class I, class T>
+void csr_symmetric_matvec(const I n_row,
+                          const I Ap[],
+                          const I Aj[],
+                          const T Ax[],
+                          const T Xx[],
+                                T Yx[])
 {
-    std::set<I> diagonals;
-
     for(I i = 0; i < n_row; i++){
+        const T xi = Xx[i];
+        T sum = 0;
         for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
-            diagonals.insert(Aj[jj] - i);
+            const I j = Aj[jj];
+            const T a = Ax[jj];
+            sum += a * Xx[j];
+            if (j != i) {
+                Yx[j] += a * xi;
+            }
         }
+        Yx[i] += sum;
     }
-    return diagonals.size();
 }
 
 
 /*
- * Sample the matrix at specific locations
+ * Threaded version of csr_symmetric_matvec
  *
- * Determine the matrix value for each row,col pair
- *    Bx[n] = A(Bi[n],Bj[n])
+ * The rows of A are split into chunks balanced by nnz. The mirrored
+ * updates of a chunk land in rows of other chunks, so every chunk but the
+ * first adds into a private copy of Y, and the copies are summed into Y
+ * afterwards in a fixed order.
  *
  * Input Arguments:
- *   I  n_row         - number of rows in A
- *   I  n_col         - number of columns in A
- *   I  Ap[n_row+1]   - row pointer
- *   I  Aj[nnz(A)]    - column indices
- *   T  Ax[nnz(A)]    - nonzeros
- *   I  n_samples     - number of samples
- *   I  Bi[N]         - sample rows
- *   I  Bj[N]         - sample columns
+ *   I  workers       - maximum number of threads to use
  *
- * Output Arguments:
- *   T  Bx[N]         - sample values
+ * The remaining arguments are as for csr_symmetric_matvec.
  *
  * Note:
- *   Output array Bx must be preallocated
- *
- *   Complexity: varies
- *
- *   TODO handle other cases with asymptotically optimal method
+ *   The private copies take n_row entries per chunk, so the number of
+ *   chunks is limited to keep them no larger than A.
  *
  */
 template <class I, class T>
-void csr_sample_values(const I n_row,
-                       const I n_col,
-                       const I Ap[],
-                       const I Aj[],
-                       const T Ax[],
-                       const I n_samples,
-                       const I Bi[],
-                       const I Bj[],
-                             T Bx[])
+void csr_symmetric_matvec_threaded(const I n_row,
+                                   const I Ap[],
+                                   const I Aj[],
+                                   const T Ax[],
+                                   const T Xx[],
+                                         T Yx[],
+                                   const I workers)
 {
-    // ideally we'd do the following
-    // Case 1: A is canonical and B is sorted by row and column
-    //   -> special purpose csr_binop_csr() (optimized form)
-    // Case 2: A is canonical and B is unsorted and max(log(Ap[i+1] - Ap[i])) > log(num_samples)
-    //   -> do binary searches for each sample
-    // Case 3: A is canonical and B is unsorted and max(log(Ap[i+1] - Ap[i])) < log(num_samples)
-    //   -> sort B by row and column and use Case 1
-    // Case 4: A is not canonical and num_samples ~ nnz
-    //   -> special purpose csr_binop_csr() (general form)
-    // Case 5: A is not canonical and num_samples << nnz
-    //   -> do linear searches for each sample
-
-    const I nnz = Ap[n_row];
-
-    const I threshold = nnz / 10; // constant is arbitrary
+    const npy_intp nnz = Ap[n_row];
 
-    if (n_samples > threshold && csr_has_canonical_format(n_row, Ap, Aj))
-    {
-        for(I n = 0; n < n_samples; n++)
-        {
-            const I i = Bi[n] < 0 ? Bi[n] + n_row : Bi[n]; // sample row
-            const I j = Bj[n] < 0 ? Bj[n] + n_col : Bj[n]; // sample column
+    npy_intp n_chunks = parallel_num_chunks(workers, 2 * nnz + n_row);
+    if (n_row > 0) {
+        n_chunks = std::min(n_chunks, 1 + nnz / n_row);
+    }
+    if (n_chunks <= 1) {
+        csr_symmetric_matvec(n_row, Ap, Aj, Ax, Xx, Yx);
+        return;
+    }
 
-            const I row_start = Ap[i];
-            const I row_end   = Ap[i+1];
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row, Ap, (I)n_chunks, &bounds[0]);
 
-            if (row_start < row_end)
-            {
-                const I offset = std::lower_bound(Aj + row_start, Aj + row_end, j) - Aj;
+    std::vector<T> buffers((n_chunks - 1) * (npy_intp)n_row, 0);
 
-                if (offset < row_end && Aj[offset] == j)
-                    Bx[n] = Ax[offset];
-                else
-                    Bx[n] = 0;
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        T *y = (c == 0) ? Yx : &buffers[(c - 1) * (npy_intp)n_row];
+        for(I i = bounds[c]; i < bounds[c+1]; i++){
+            const T xi = Xx[i];
+            T sum = 0;
+            for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+                const I j = Aj[jj];
+                const T a = Ax[jj];
+                sum += a * Xx[j];
+                if (j != i) {
+                    y[j] += a * xi;
+                }
             }
-            else
-            {
-                Bx[n] = 0;
+            y[i] += sum;
+        }
+    });
+
+    // sum the private copies into Y
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        const npy_intp start = (npy_intp)n_row * c / n_chunks;
+        const npy_intp end   = (npy_intp)n_row * (c + 1) / n_chunks;
+        for(npy_intp k = 0; k < n_chunks - 1; k++){
+            const T *y = &buffers[k * (npy_intp)n_row];
+            for(npy_intp i = start; i < end; i++){
+                Yx[i] += y[i];
             }
-
         }
-    }
-    else
-    {
-        for(I n = 0; n < n_samples; n++)
-        {
-            const I i = Bi[n] < 0 ? Bi[n] + n_row : Bi[n]; // sample row
-            const I j = Bj[n] < 0 ? Bj[n] + n_col : Bj[n]; // sample column
-
-            const I row_start = Ap[i];
-            const I row_end   = Ap[i+1];
+    });
+}
 
-            T x = 0;
 
-            for(I jj = row_start; jj < row_end; jj++)
-            {
-                if (Aj[jj] == j)
-                    x += Ax[jj];
+/*
+ * Compute Y = A*X and the dot product conj(X).Y in a single pass, for
+ * square CSR matrix A and dense vectors X,Y
+ *
+ * This is the matvec plus reduction of a CG-type iteration (p^H A p),
+ * without a second pass over X and Y.
+ *
+ * Input Arguments:
+ *   I  n_row         - number of rows in A
+ *   I  n_col         - number of columns in A
+ *   I  Ap[n_row+1]   - row pointer
+ *   I  Aj[nnz(A)]    - column indices
+ *   T  Ax[nnz(A)]    - nonzeros
+ *   T  Xx[n_col]     - input vector
+ *   I  workers       - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   T  Yx[n_row]     - output vector, overwritten
+ *   T  Dx[1]         - sum_i conj(Xx[i]) * Yx[i]
+ *
+ * Note:
+ *   Output arrays Yx and Dx must be preallocated
+ *   A must be square, n_row == n_col
+ *
+ *   The partial sums of the threads are added in a fixed order, so the
+ *   result does not depend on timing.
+ *
+ */
+template <class I, class T>
+void csr_matvec_dot(const I n_row,
+                    const I n_col,
+                    const I Ap[],
+                    const I Aj[],
+                    const T Ax[],
+                    const T Xx[],
+                          T Yx[],
+                          T Dx[],
+                    const I workers)
+{
+    const I n_chunks = parallel_num_chunks(workers, (npy_intp)Ap[n_row] + n_row);
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row, Ap, n_chunks, &bounds[0]);
+
+    std::vector<T> partial(n_chunks, 0);
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        T dp = 0;
+        for(I i = bounds[c]; i < bounds[c+1]; i++){
+            T sum = 0;
+            for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+                sum += Ax[jj] * Xx[Aj[jj]];
             }
-
-            Bx[n] = x;
+            Yx[i] = sum;
+            dp += conjugate(Xx[i]) * sum;
         }
+        partial[c] = dp;
+    });
 
+    T dp = 0;
+    for(I c = 0; c < n_chunks; c++){
+        dp += partial[c];
     }
+    Dx[0] = dp;
 }
 
+
 /*
- * Determine the data offset at specific locations
+ * Compute Y = alpha*A*X + beta*Z for CSR matrix A and dense vectors X,Y,Z
+ * in a single pass
  *
  * Input Arguments:
  *   I  n_row         - number of rows in A
  *   I  n_col         - number of columns in A
  *   I  Ap[n_row+1]   - row pointer
  *   I  Aj[nnz(A)]    - column indices
- *   I  n_samples     - number of samples
- *   I  Bi[N]         - sample rows
- *   I  Bj[N]         - sample columns
+ *   T  Ax[nnz(A)]    - nonzeros
+ *   T  Xx[n_col]     - input vector
+ *   T  alpha[1]      - scale factor of A*X
+ *   T  beta[1]       - scale factor of Z
+ *   T  Zx[n_row]     - input vector
+ *   I  workers       - maximum number of threads to use
  *
  * Output Arguments:
- *   I  Bp[N]         - offsets into Aj; -1 if non-existent
- *
- * Return value:
- *   1 if any sought entries are duplicated, in which case the
- *   function has exited early; 0 otherwise.
+ *   T  Yx[n_row]     - output vector, overwritten; may be the same as Zx
  *
  * Note:
- *   Output array Bp must be preallocated
- *
- *   Complexity: varies. See csr_sample_values
+ *   Output array Yx must be preallocated
  *
  */
-template <class I>
-int csr_sample_offsets(const I n_row,
-                       const I n_col,
-                       const I Ap[],
-                       const I Aj[],
-                       const I n_samples,
-                       const I Bi[],
-                       const I Bj[],
-                             I Bp[])
+template <class I, class T>
+void csr_matvec_axpby(const I n_row,
+                      const I n_col,
+                      const I Ap[],
+                      const I Aj[],
+                      const T Ax[],
+                      const T Xx[],
+                      const T alpha[],
+                      const T beta[],
+                      const T Zx[],
+                            T Yx[],
+                      const I workers)
 {
-    const I nnz = Ap[n_row];
-    const I threshold = nnz / 10; // constant is arbitrary
-
-    if (n_samples > threshold && csr_has_canonical_format(n_row, Ap, Aj))
-    {
-        for(I n = 0; n < n_samples; n++)
-        {
-            const I i = Bi[n] < 0 ? Bi[n] + n_row : Bi[n]; // sample row
-            const I j = Bj[n] < 0 ? Bj[n] + n_col : Bj[n]; // sample column
-
-            const I row_start = Ap[i];
-            const I row_end   = Ap[i+1];
+    const T a = alpha[0];
+    const T b = beta[0];
 
-            if (row_start < row_end)
-            {
-                const I offset = std::lower_bound(Aj + row_start, Aj + row_end, j) - Aj;
+    const I n_chunks = parallel_num_chunks(workers, (npy_intp)Ap[n_row] + n_row);
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row, Ap, n_chunks, &bounds[0]);
 
-                if (offset < row_end && Aj[offset] == j)
-                    Bp[n] = offset;
-                else
-                    Bp[n] = -1;
-            }
-            else
-            {
-                Bp[n] = -1;
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        for(I i = bounds[c]; i < bounds[c+1]; i++){
+            T sum = 0;
+            for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+                sum += Ax[jj] * Xx[Aj[jj]];
             }
+            Yx[i] = a * sum + b * Zx[i];
         }
-    }
-    else
-    {
-        for(I n = 0; n < n_samples; n++)
-        {
-            const I i = Bi[n] < 0 ? Bi[n] + n_row : Bi[n]; // sample row
-            const I j = Bj[n] < 0 ? Bj[n] + n_col : Bj[n]; // sample column
+    });
+}
+
 
-            const I row_start = Ap[i];
-            const I row_end   = Ap[i+1];
+/*
+ * Compute Y_b += A_b*X_b for a batch of CSR matrices A_b and dense
+ * vectors X_b, Y_b, b < n_batch
+ *
+ * The matrices are stored stacked on top of each other: their rows are
+ * concatenated into one row pointer, while the column indices stay local
+ * to each matrix. The vectors are concatenated likewise. A whole batch of
+ * small products then costs a single call.
+ *
+ * Input Arguments:
+ *   I  n_batch            - number of matrices
+ *   I  Rp[n_batch+1]      - rows of A_b are [Rp[b], Rp[b+1]) in Ap, Yx
+ *   I  Cp[n_batch+1]      - entries of X_b are [Cp[b], Cp[b+1]) in Xx
+ *   I  Ap[Rp[n_batch]+1]  - stacked row pointer
+ *   I  Aj[nnz]            - column indices, local to each matrix
+ *   T  Ax[nnz]            - nonzeros
+ *   T  Xx[Cp[n_batch]]    - stacked input vectors
+ *   I  workers            - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   T  Yx[Rp[n_batch]]    - stacked output vectors
+ *
+ * Note:
+ *   Output array Yx must be preallocated
+ *
+ *   Matrices are distributed over the threads whole, balanced by their
+ *   numbers of nonzeros.
+ *
+ */
+template <class I, class T>
+void csr_matvec_batch(const I n_batch,
+                      const I Rp[],
+                      const I Cp[],
+                      const I Ap[],
+                      const I Aj[],
+                      const T Ax[],
+                      const T Xx[],
+                            T Yx[],
+                      const I workers)
+{
+    const I n_chunks = parallel_num_chunks(
+        workers, (npy_intp)Ap[Rp[n_batch]] + Rp[n_batch]);
 
-            I offset = -1;
+    std::vector<npy_intp> cost(n_batch + 1);
+    for(I b = 0; b <= n_batch; b++){
+        cost[b] = (npy_intp)Ap[Rp[b]] + Rp[b];
+    }
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_batch, &cost[0], n_chunks, &bounds[0]);
 
-            for(I jj = row_start; jj < row_end; jj++)
-            {
-                if (Aj[jj] == j) {
-                    offset = jj;
-                    for (jj++; jj < row_end; jj++) {
-                        if (Aj[jj] == j) {
-                            offset = -2;
-                            return 1;
-                        }
-                    }
-                }
-            }
-            Bp[n] = offset;
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        for(I b = bounds[c]; b < bounds[c+1]; b++){
+            csr_matvec(Rp[b+1] - Rp[b], Cp[b+1] - Cp[b], Ap + Rp[b], Aj, Ax,
+                       Xx + Cp[b], Yx + Rp[b]);
         }
-    }
-    return 0;
+    });
 }
 
+
+
+
+template<class I, class T>
+void get_csr_submatrix(const I n_row,
+                       const I n_col,
+                       const I Ap[],
+                       const I Aj[],
+                       const T Ax[],
+                       const I ir0,
+                       const I ir1,
+                       const I ic0,
+                       const I ic1,
+                       std::vector<I>* Bp,
+                       std::vector<I>* Bj,
+                       std::vector<T>* Bx)
+{
+    I new_n_row = ir1 - ir0;
+    //I new_n_col = ic1 - ic0;  //currently unused
+    I new_nnz = 0;
+    I kk = 0;
+
+    // Count nonzeros total/per row.
+    for(I i = 0; i < new_n_row; i++){
+        I row_start = Ap[ir0+i];
+        I row_end   = Ap[ir0+i+1];
+
+        for(I jj = row_start; jj < row_end; jj++){
+            if ((Aj[jj] >= ic0) && (Aj[jj] < ic1)) {
+                new_nnz++;
+            }
+        }
+    }
+
+    // Allocate.
+    Bp->resize(new_n_row+1);
+    Bj->resize(new_nnz);
+    Bx->resize(new_nnz);
+
+    // Assign.
+    (*Bp)[0] = 0;
+    for(I i = 0; i < new_n_row; i++){
+        I row_start = Ap[ir0+i];
+        I row_end   = Ap[ir0+i+1];
+
+        for(I jj = row_start; jj < row_end; jj++){
+            if ((Aj[jj] >= ic0) && (Aj[jj] < ic1)) {
+                (*Bj)[kk] = Aj[jj] - ic0;
+                (*Bx)[kk] = Ax[jj];
+                kk++;
+            }
+        }
+        (*Bp)[i+1] = kk;
+    }
+}
+
+
+/*
+ * Slice rows given as an array of indices.
+ *
+ * Input Arguments:
+ *   I  n_row_idx       - number of row indices
+ *   I  rows[n_row_idx] - row indices for indexing
+ *   I  Ap[n_row+1]     - row pointer
+ *   I  Aj[nnz(A)]      - column indices
+ *   T  Ax[nnz(A)]      - data
+ *
+ * Output Arguments:
+ *   I  Bj - new column indices
+ *   T  Bx - new data
+ *
+ */
+template<class I, class T>
+void csr_row_index(const I n_row_idx,
+                   const I rows[],
+                   const I Ap[],
+                   const I Aj[],
+                   const T Ax[],
+                   I Bj[],
+                   T Bx[])
+{
+    for(I i = 0; i < n_row_idx; i++){
+        const I row = rows[i];
+        const I row_start = Ap[row];
+        const I row_end   = Ap[row+1];
+        Bj = std::copy(Aj + row_start, Aj + row_end, Bj);
+        Bx = std::copy(Ax + row_start, Ax + row_end, Bx);
+    }
+}
+
+
+/*
+ * Slice rows given as an array of indices, using several threads
+ *
+ * Same as csr_row_index, but the row pointer of the result must be known
+ * up front, so that the rows of B can be split into chunks with roughly
+ * equal nnz, each gathered by its own thread. Gathering a long list of
+ * rows in blocks, each Bp computed from Ap[rows+1] - Ap[rows], needs no
+ * temporary the size of the whole result.
+ *
+ * Input Arguments:
+ *   I  n_row_idx       - number of row indices
+ *   I  rows[n_row_idx] - row indices for indexing
+ *   I  Ap[n_row+1]     - row pointer
+ *   I  Aj[nnz(A)]      - column indices
+ *   T  Ax[nnz(A)]      - data
+ *   I  Bp[n_row_idx+1] - row pointer of the result
+ *   I  workers         - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   I  Bj[Bp[n_row_idx]-Bp[0]] - new column indices
+ *   T  Bx[Bp[n_row_idx]-Bp[0]] - new data
+ *
+ */
+template<class I, class T>
+void csr_row_index_threaded(const I n_row_idx,
+                            const I rows[],
+                            const I Ap[],
+                            const I Aj[],
+                            const T Ax[],
+                            const I Bp[],
+                            I Bj[],
+                            T Bx[],
+                            const I workers)
+{
+    const I n_chunks = parallel_num_chunks(
+        workers, (npy_intp)Bp[n_row_idx] - Bp[0] + n_row_idx);
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row_idx, Bp, n_chunks, &bounds[0]);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        const I r0 = bounds[c];
+        const npy_intp offset = (npy_intp)Bp[r0] - Bp[0];
+        csr_row_index(bounds[c+1] - r0, rows + r0, Ap, Aj, Ax,
+                      Bj + offset, Bx + offset);
+    });
+}
+
+/*
+ * Slice rows given as a (start, stop, step) tuple.
+ *
+ * Input Arguments:
+ *   I  start
+ *   I  stop
+ *   I  step
+ *   I  Ap[N+1]    - row pointer
+ *   I  Aj[nnz(A)] - column indices
+ *   T  Ax[nnz(A)] - data
+ *
+ * Output Arguments:
+ *   I  Bj - new column indices
+ *   T  Bx - new data
+ *
+ */
+template<class I, class T>
+void csr_row_slice(const I start,
+                   const I stop,
+                   const I step,
+                   const I Ap[],
+                   const I Aj[],
+                   const T Ax[],
+                   I Bj[],
+                   T Bx[])
+{
+    if (step > 0) {
+        for(I row = start; row < stop; row += step){
+            const I row_start = Ap[row];
+            const I row_end   = Ap[row+1];
+            Bj = std::copy(Aj + row_start, Aj + row_end, Bj);
+            Bx = std::copy(Ax + row_start, Ax + row_end, Bx);
+        }
+    } else {
+        for(I row = start; row > stop; row += step){
+            const I row_start = Ap[row];
+            const I row_end   = Ap[row+1];
+            Bj = std::copy(Aj + row_start, Aj + row_end, Bj);
+            Bx = std::copy(Ax + row_start, Ax + row_end, Bx);
+        }
+    }
+}
+
+
+/*
+ * Slice columns given as an array of indices (pass 1).
+ * This pass counts idx entries and computes a new indptr.
+ *
+ * Input Arguments:
+ *   I  n_idx           - number of indices to slice
+ *   I  col_idxs[n_idx] - indices to slice
+ *   I  n_row           - major axis dimension
+ *   I  n_col           - minor axis dimension
+ *   I  Ap[n_row+1]     - indptr
+ *   I  Aj[nnz(A)]      - indices
+ *
+ * Output Arguments:
+ *   I  col_offsets[n_col] - cumsum of index repeats
+ *   I  Bp[n_row+1]        - new indptr
+ *
+ */
+template<class I>
+void csr_column_index1(const I n_idx,
+                       const I col_idxs[],
+                       const I n_row,
+                       const I n_col,
+                       const I Ap[],
+                       const I Aj[],
+                       I col_offsets[],
+                       I Bp[])
+{
+    // bincount(col_idxs)
+    for(I jj = 0; jj < n_idx; jj++){
+        const I j = col_idxs[jj];
+        col_offsets[j]++;
+    }
+
+    // Compute new indptr
+    I new_nnz = 0;
+    Bp[0] = 0;
+    for(I i = 0; i < n_row; i++){
+        for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+            new_nnz += col_offsets[Aj[jj]];
+        }
+        Bp[i+1] = new_nnz;
+    }
+
+    // cumsum in-place
+    for(I j = 1; j < n_col; j++){
+        col_offsets[j] += col_offsets[j - 1];
+    }
+}
+
+
+/*
+ * Slice columns given as an array of indices (pass 2).
+ * This pass populates indices/data entries for selected columns.
+ *
+ * Input Arguments:
+ *   I  col_order[n_idx]   - order of col indices
+ *   I  col_offsets[n_col] - cumsum of col index counts
+ *   I  nnz                - nnz(A)
+ *   I  Aj[nnz(A)]         - column indices
+ *   T  Ax[nnz(A)]         - data
+ *
+ * Output Arguments:
+ *   I  Bj[nnz(B)] - new column indices
+ *   T  Bx[nnz(B)] - new data
+ *
+ */
+template<class I, class T>
+void csr_column_index2(const I col_order[],
+                       const I col_offsets[],
+                       const I nnz,
+                       const I Aj[],
+                       const T Ax[],
+                       I Bj[],
+                       T Bx[])
+{
+    I n = 0;
+    for(I jj = 0; jj < nnz; jj++){
+        const I j = Aj[jj];
+        const I offset = col_offsets[j];
+        const I prev_offset = j == 0 ? 0 : col_offsets[j-1];
+        if (offset != prev_offset) {
+            const T v = Ax[jj];
+            for(I k = prev_offset; k < offset; k++){
+                Bj[n] = col_order[k];
+                Bx[n] = v;
+                n++;
+            }
+        }
+    }
+}
+
+
+/*
+ * Count the number of occupied diagonals in CSR matrix A
+ *
+ * Input Arguments:
+ *   I  nnz             - number of nonzeros in A
+ *   I  Ai[nnz(A)]      - row indices
+ *   I  Aj[nnz(A)]      - column indices
+ *
+ */
+template <class I>
+I csr_count_diagonals(const I n_row,
+                      const I Ap[],
+                      const I Aj[])
+{
+    std::set<I> diagonals;
+
+    for(I i = 0; i < n_row; i++){
+        for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+            diagonals.insert(Aj[jj] - i);
+        }
+    }
+    return diagonals.size();
+}
+
+
+/*
+ * Look up samples (Bi[n], Bj[n]), n < n_samples, in CSR matrix A with
+ * canonical format, calling found(n, offset) with the offset of each
+ * sample into Aj, or -1 if it is not stored
+ *
+ * Each lookup is a binary search of the sample's row, except that a
+ * sample in the same row as the previous one, at the same or a larger
+ * column, gallops forward from the previous offset. Samples sorted by
+ * row and column are thus found in a single merge-like sweep of each
+ * row instead of repeated searches.
+ */
+template <class I, class F>
+void csr_sample_search(const I n_row,
+                       const I n_col,
+                       const I Ap[],
+                       const I Aj[],
+                       const I n_samples,
+                       const I Bi[],
+                       const I Bj[],
+                       const F& found)
+{
+    I prev_i = -1;
+    I prev_j = 0;
+    I prev_offset = 0;
+
+    for(I n = 0; n < n_samples; n++)
+    {
+        const I i = Bi[n] < 0 ? Bi[n] + n_row : Bi[n]; // sample row
+        const I j = Bj[n] < 0 ? Bj[n] + n_col : Bj[n]; // sample column
+
+        const I row_end = Ap[i+1];
+
+        I first = Ap[i];
+        I last  = row_end;
+        if (i == prev_i && j >= prev_j)
+        {
+            // all entries before prev_offset have columns < prev_j
+            first = prev_offset;
+            last = first;
+            npy_intp step = 1;
+            while (last < row_end && Aj[last] < j)
+            {
+                first = last + 1;
+                last = (row_end - first > step) ? first + step : row_end;
+                step *= 2;
+            }
+        }
+
+        const I offset = std::lower_bound(Aj + first, Aj + last, j) - Aj;
+
+        if (offset < row_end && Aj[offset] == j)
+            found(n, offset);
+        else
+            found(n, (I)-1);
+
+        prev_i = i;
+        prev_j = j;
+        prev_offset = offset;
+    }
+}
+
+
+/*
+ * Sample the matrix at specific locations by linear scans of the rows
+ *
+ * Duplicates in A are summed. See csr_sample_values.
+ */
+template <class I, class T>
+void csr_sample_values_scan(const I n_row,
+                            const I n_col,
+                            const I Ap[],
+                            const I Aj[],
+                            const T Ax[],
+                            const I n_samples,
+                            const I Bi[],
+                            const I Bj[],
+                                  T Bx[])
+{
+    for(I n = 0; n < n_samples; n++)
+    {
+        const I i = Bi[n] < 0 ? Bi[n] + n_row : Bi[n]; // sample row
+        const I j = Bj[n] < 0 ? Bj[n] + n_col : Bj[n]; // sample column
+
+        const I row_start = Ap[i];
+        const I row_end   = Ap[i+1];
+
+        T x = 0;
+
+        for(I jj = row_start; jj < row_end; jj++)
+        {
+            if (Aj[jj] == j)
+                x += Ax[jj];
+        }
+
+        Bx[n] = x;
+    }
+}
+
+
+/*
+ * Sample the matrix at specific locations
+ *
+ * Determine the matrix value for each row,col pair
+ *    Bx[n] = A(Bi[n],Bj[n])
+ *
+ * Input Arguments:
+ *   I  n_row         - number of rows in A
+ *   I  n_col         - number of columns in A
+ *   I  Ap[n_row+1]   - row pointer
+ *   I  Aj[nnz(A)]    - column indices
+ *   T  Ax[nnz(A)]    - nonzeros
+ *   I  n_samples     - number of samples
+ *   I  Bi[N]         - sample rows
+ *   I  Bj[N]         - sample columns
+ *
+ * Output Arguments:
+ *   T  Bx[N]         - sample values
+ *
+ * Note:
+ *   Output array Bx must be preallocated
+ *
+ *   Complexity: varies
+ *
+ *   If there are many samples and A has canonical format, each sample is
+ *   found by binary search of its row, which is cheaper still for runs of
+ *   samples sorted by column within a row (see csr_sample_search).
+ *   Otherwise each sample scans its row.
+ *
+ *   TODO handle other cases with asymptotically optimal method
+ *
+ */
+template <class I, class T>
+void csr_sample_values(const I n_row,
+                       const I n_col,
+                       const I Ap[],
+                       const I Aj[],
+                       const T Ax[],
+                       const I n_samples,
+                       const I Bi[],
+                       const I Bj[],
+                             T Bx[])
+{
+    // ideally we'd do the following
+    // Case 1: A is canonical and B is sorted by row and column
+    //   -> special purpose csr_binop_csr() (optimized form)
+    // Case 2: A is canonical and B is unsorted and max(log(Ap[i+1] - Ap[i])) > log(num_samples)
+    //   -> do binary searches for each sample
+    // Case 3: A is canonical and B is unsorted and max(log(Ap[i+1] - Ap[i])) < log(num_samples)
+    //   -> sort B by row and column and use Case 1
+    // Case 4: A is not canonical and num_samples ~ nnz
+    //   -> special purpose csr_binop_csr() (general form)
+    // Case 5: A is not canonical and num_samples << nnz
+    //   -> do linear searches for each sample
+
+    const I nnz = Ap[n_row];
+
+    const I threshold = nnz / 10; // constant is arbitrary
+
+    if (n_samples > threshold && csr_has_canonical_format(n_row, Ap, Aj))
+    {
+        csr_sample_search(n_row, n_col, Ap, Aj, n_samples, Bi, Bj,
+                          [&](I n, I offset) {
+                              Bx[n] = (offset >= 0) ? Ax[offset] : T(0);
+                          });
+    }
+    else
+    {
+        csr_sample_values_scan(n_row, n_col, Ap, Aj, Ax, n_samples, Bi, Bj, Bx);
+    }
+}
+
+
+/*
+ * Sample the matrix at specific locations using several threads
+ *
+ * Same as csr_sample_values, with the samples split into contiguous
+ * chunks of equal size, one per thread.
+ *
+ * Input Arguments:
+ *   I  n_row         - number of rows in A
+ *   I  n_col         - number of columns in A
+ *   I  Ap[n_row+1]   - row pointer
+ *   I  Aj[nnz(A)]    - column indices
+ *   T  Ax[nnz(A)]    - nonzeros
+ *   I  n_samples     - number of samples
+ *   I  Bi[N]         - sample rows
+ *   I  Bj[N]         - sample columns
+ *   I  workers       - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   T  Bx[N]         - sample values
+ *
+ */
+template <class I, class T>
+void csr_sample_values_threaded(const I n_row,
+                                const I n_col,
+                                const I Ap[],
+                                const I Aj[],
+                                const T Ax[],
+                                const I n_samples,
+                                const I Bi[],
+                                const I Bj[],
+                                      T Bx[],
+                                const I workers)
+{
+    const I n_chunks = parallel_num_chunks(workers, n_samples);
+    if (n_chunks <= 1) {
+        csr_sample_values(n_row, n_col, Ap, Aj, Ax, n_samples, Bi, Bj, Bx);
+        return;
+    }
+
+    const I threshold = Ap[n_row] / 10;
+    const bool search = (n_samples > threshold &&
+                         csr_has_canonical_format(n_row, Ap, Aj));
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        const I start = (npy_intp)n_samples * c / n_chunks;
+        const I count = (npy_intp)n_samples * (c + 1) / n_chunks - start;
+        if (search) {
+            T * bx = Bx + start;
+            csr_sample_search(n_row, n_col, Ap, Aj, count, Bi + start, Bj + start,
+                              [&](I n, I offset) {
+                                  bx[n] = (offset >= 0) ? Ax[offset] : T(0);
+                              });
+        } else {
+            csr_sample_values_scan(n_row, n_col, Ap, Aj, Ax, count,
+                                   Bi + start, Bj + start, Bx + start);
+        }
+    });
+}
+
+
+/*
+ * Determine the data offset at specific locations by linear scans of the
+ * rows
+ *
+ * Returns 1, and exits early, if a sought entry is duplicated; 0
+ * otherwise. See csr_sample_offsets.
+ */
+template <class I>
+int csr_sample_offsets_scan(const I n_row,
+                            const I n_col,
+                            const I Ap[],
+                            const I Aj[],
+                            const I n_samples,
+                            const I Bi[],
+                            const I Bj[],
+                                  I Bp[])
+{
+    for(I n = 0; n < n_samples; n++)
+    {
+        const I i = Bi[n] < 0 ? Bi[n] + n_row : Bi[n]; // sample row
+        const I j = Bj[n] < 0 ? Bj[n] + n_col : Bj[n]; // sample column
+
+        const I row_start = Ap[i];
+        const I row_end   = Ap[i+1];
+
+        I offset = -1;
+
+        for(I jj = row_start; jj < row_end; jj++)
+        {
+            if (Aj[jj] == j) {
+                offset = jj;
+                for (jj++; jj < row_end; jj++) {
+                    if (Aj[jj] == j) {
+                        offset = -2;
+                        return 1;
+                    }
+                }
+            }
+        }
+        Bp[n] = offset;
+    }
+    return 0;
+}
+
+
+/*
+ * Determine the data offset at specific locations
+ *
+ * Input Arguments:
+ *   I  n_row         - number of rows in A
+ *   I  n_col         - number of columns in A
+ *   I  Ap[n_row+1]   - row pointer
+ *   I  Aj[nnz(A)]    - column indices
+ *   I  n_samples     - number of samples
+ *   I  Bi[N]         - sample rows
+ *   I  Bj[N]         - sample columns
+ *
+ * Output Arguments:
+ *   I  Bp[N]         - offsets into Aj; -1 if non-existent
+ *
+ * Return value:
+ *   1 if any sought entries are duplicated, in which case the
+ *   function has exited early; 0 otherwise.
+ *
+ * Note:
+ *   Output array Bp must be preallocated
+ *
+ *   Complexity: varies. See csr_sample_values
+ *
+ */
+template <class I>
+int csr_sample_offsets(const I n_row,
+                       const I n_col,
+                       const I Ap[],
+                       const I Aj[],
+                       const I n_samples,
+                       const I Bi[],
+                       const I Bj[],
+                             I Bp[])
+{
+    const I nnz = Ap[n_row];
+    const I threshold = nnz / 10; // constant is arbitrary
+
+    if (n_samples > threshold && csr_has_canonical_format(n_row, Ap, Aj))
+    {
+        csr_sample_search(n_row, n_col, Ap, Aj, n_samples, Bi, Bj,
+                          [&](I n, I offset) { Bp[n] = offset; });
+        return 0;
+    }
+    return csr_sample_offsets_scan(n_row, n_col, Ap, Aj, n_samples, Bi, Bj, Bp);
+}
+
+
+/*
+ * Determine the data offset at specific locations using several threads
+ *
+ * Same as csr_sample_offsets, with the samples split into contiguous
+ * chunks of equal size, one per thread. If a sought entry is duplicated,
+ * 1 is returned once all chunks have finished or exited early.
+ *
+ * Input Arguments:
+ *   I  n_row         - number of rows in A
+ *   I  n_col         - number of columns in A
+ *   I  Ap[n_row+1]   - row pointer
+ *   I  Aj[nnz(A)]    - column indices
+ *   I  n_samples     - number of samples
+ *   I  Bi[N]         - sample rows
+ *   I  Bj[N]         - sample columns
+ *   I  workers       - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   I  Bp[N]         - offsets into Aj; -1 if non-existent
+ *
+ * Return value:
+ *   1 if any sought entries are duplicated; 0 otherwise.
+ *
+ */
+template <class I>
+int csr_sample_offsets_threaded(const I n_row,
+                                const I n_col,
+                                const I Ap[],
+                                const I Aj[],
+                                const I n_samples,
+                                const I Bi[],
+                                const I Bj[],
+                                      I Bp[],
+                                const I workers)
+{
+    const I n_chunks = parallel_num_chunks(workers, n_samples);
+    if (n_chunks <= 1) {
+        return csr_sample_offsets(n_row, n_col, Ap, Aj, n_samples, Bi, Bj, Bp);
+    }
+
+    const I threshold = Ap[n_row] / 10;
+    const bool search = (n_samples > threshold &&
+                         csr_has_canonical_format(n_row, Ap, Aj));
+
+    std::vector<int> duplicated(n_chunks, 0);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        const I start = (npy_intp)n_samples * c / n_chunks;
+        const I count = (npy_intp)n_samples * (c + 1) / n_chunks - start;
+        if (search) {
+            I * bp = Bp + start;
+            csr_sample_search(n_row, n_col, Ap, Aj, count, Bi + start, Bj + start,
+                              [&](I n, I offset) { bp[n] = offset; });
+        } else {
+            duplicated[c] = csr_sample_offsets_scan(n_row, n_col, Ap, Aj, count,
+                                                    Bi + start, Bj + start,
+                                                    Bp + start);
+        }
+    });
+
+    for(I c = 0; c < n_chunks; c++){
+        if (duplicated[c]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Reductions along the rows and columns of a CSR matrix
+ *
+ * The row ("major axis") reductions split the rows into chunks as
+ * csr_matvec_threaded does, and write a disjoint range of the output from
+ * each thread. The column ("minor axis") reductions give each thread a
+ * contiguous chunk of rows and a private partial result for every column;
+ * the partial results are then merged in chunk order, again on several
+ * threads. A CSC matrix is reduced along its columns and rows by passing
+ * its shape swapped.
+ */
+
+/*
+ * Whether x is better than y for the min/max reductions: larger for
+ * BINOP_MAXIMUM, smaller for BINOP_MINIMUM. A NaN is better than any
+ * number, and the first of several NaNs is kept, as by np.maximum,
+ * np.minimum, np.argmax and np.argmin.
+ */
+template <class T>
+inline bool csr_reduce_isnan(const T& x)
+{
+    return x != x;
+}
+
+template <class T>
+struct csr_reduce_better {
+    const bool is_max;
+
+    explicit csr_reduce_better(const int op) : is_max(op == BINOP_MAXIMUM) {
+        if (op != BINOP_MAXIMUM && op != BINOP_MINIMUM) {
+            throw std::domain_error("invalid min/max reduction code");
+        }
+    }
+
+    bool operator()(const T& x, const T& y) const {
+        if (csr_reduce_isnan(x)) {
+            return !csr_reduce_isnan(y);
+        }
+        return is_max ? (x > y) : (x < y);
+    }
+};
+
+
+/*
+ * Index of the minimum or maximum of a line of length n, from the extremum
+ * `value` of its `count` stored entries, the index `index` of the first
+ * entry holding it and the index `gap` of the first entry that is not
+ * stored (if count < n).
+ */
+template <class I, class T>
+inline I csr_argminmax_finish(const I n, const I count, const T& value,
+                              const I index, const I gap,
+                              const csr_reduce_better<T>& better)
+{
+    const T zero = T(0);
+    if (count == 0) {
+        return 0;
+    }
+    if (count == n || better(value, zero)) {
+        return index;
+    }
+    if (better(zero, value)) {
+        return gap;
+    }
+    // an explicit zero competes with the first implicit one
+    return std::min(index, gap);
+}
+
+
+/*
+ * Call f(row_start, row_end) for chunks of the rows of a CSR matrix with
+ * roughly the same number of nonzeros, on up to `workers` threads.
+ */
+template <class I, class F>
+void csr_for_row_chunks(const I n_row, const I Ap[], const I workers,
+                        const F& f)
+{
+    const I n_chunks = parallel_num_chunks(workers, (npy_intp)Ap[n_row] + n_row);
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row, Ap, n_chunks, &bounds[0]);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        f(bounds[c], bounds[c+1]);
+    });
+}
+
+
+/*
+ * Reduce the columns of a CSR matrix on up to `workers` threads
+ *
+ * Each chunk of rows is reduced into its own n_col partial results, all
+ * initialized to `init`, by scan(row_start, row_end, S partial[]). The
+ * partial results of column j are then combined in chunk order with
+ * merge(S& acc, const S& partial), and the total handed to
+ * finish(j, S& acc).
+ *
+ * The number of chunks is also limited so that the partial results take no
+ * more memory than the nonzeros of the matrix.
+ */
+template <class I, class S, class Scan, class Merge, class Finish>
+void csr_column_reduce(const I n_row,
+                       const I n_col,
+                       const I Ap[],
+                       const I workers,
+                       const S& init,
+                       const Scan& scan,
+                       const Merge& merge,
+                       const Finish& finish)
+{
+    const npy_intp nnz = Ap[n_row];
+    npy_intp n_chunks = parallel_num_chunks(workers, nnz + n_row);
+    n_chunks = std::max((npy_intp)1,
+                        std::min(n_chunks, nnz / std::max((npy_intp)n_col, (npy_intp)1)));
+
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row, Ap, (I)n_chunks, &bounds[0]);
+
+    std::vector<S> partial((size_t)n_chunks * n_col, init);
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        scan(bounds[c], bounds[c+1], &partial[(size_t)c * n_col]);
+    });
+
+    const npy_intp n_merge = parallel_num_chunks(workers, (npy_intp)n_col * n_chunks);
+    parallel_for_chunks(n_merge, [&](npy_intp m) {
+        const I j_start = (npy_intp)n_col * m / n_merge;
+        const I j_end   = (npy_intp)n_col * (m + 1) / n_merge;
+        for(I j = j_start; j < j_end; j++){
+            S acc = partial[j];
+            for(npy_intp c = 1; c < n_chunks; c++){
+                merge(acc, partial[(size_t)c * n_col + j]);
+            }
+            finish(j, acc);
+        }
+    });
+}
+
+
+/*
+ * Sum the rows of a CSR matrix
+ *
+ * Input Arguments:
+ *   I  n_row         - number of rows in A
+ *   I  n_col         - number of columns in A
+ *   I  Ap[n_row+1]   - row pointer
+ *   I  Aj[nnz(A)]    - column indices
+ *   T  Ax[nnz(A)]    - nonzeros
+ *   I  workers       - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   T  Yx[n_row]     - sum of each row
+ *
+ * Note:
+ *   Output array Yx must be preallocated. Duplicate entries are summed.
+ *
+ */
+template <class I, class T>
+void csr_row_sums(const I n_row,
+                  const I n_col,
+                  const I Ap[],
+                  const I Aj[],
+                  const T Ax[],
+                        T Yx[],
+                  const I workers)
+{
+    csr_for_row_chunks(n_row, Ap, workers, [&](I row_start, I row_end) {
+        for(I i = row_start; i < row_end; i++){
+            T sum = 0;
+            for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+                sum += Ax[jj];
+            }
+            Yx[i] = sum;
+        }
+    });
+}
+
+
+/*
+ * Sum the columns of a CSR matrix
+ *
+ * Input Arguments:
+ *   I  n_row         - number of rows in A
+ *   I  n_col         - number of columns in A
+ *   I  Ap[n_row+1]   - row pointer
+ *   I  Aj[nnz(A)]    - column indices
+ *   T  Ax[nnz(A)]    - nonzeros
+ *   I  workers       - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   T  Yx[n_col]     - sum of each column
+ *
+ * Note:
+ *   Output array Yx must be preallocated. Duplicate entries are summed.
+ *
+ *   The partial sums of the threads are added in row order, so that the
+ *   result only depends on the number of threads, not on their timing.
+ *
+ */
+template <class I, class T>
+void csr_column_sums(const I n_row,
+                     const I n_col,
+                     const I Ap[],
+                     const I Aj[],
+                     const T Ax[],
+                           T Yx[],
+                     const I workers)
+{
+    csr_column_reduce(n_row, n_col, Ap, workers, T(0),
+        [&](I row_start, I row_end, T sums[]) {
+            for(I jj = Ap[row_start]; jj < Ap[row_end]; jj++){
+                sums[Aj[jj]] += Ax[jj];
+            }
+        },
+        [](T& acc, const T& sum) { acc += sum; },
+        [&](I j, T& acc) { Yx[j] = acc; });
+}
+
+
+/*
+ * Count the stored entries in each column of a CSR matrix
+ *
+ * Input Arguments:
+ *   I  n_row         - number of rows in A
+ *   I  n_col         - number of columns in A
+ *   I  Ap[n_row+1]   - row pointer
+ *   I  Aj[nnz(A)]    - column indices
+ *   I  workers       - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   I  Yx[n_col]     - number of entries in each column
+ *
+ * Note:
+ *   Output array Yx must be preallocated. Duplicate entries and explicit
+ *   zeros are counted, as by getnnz.
+ *
+ */
+template <class I>
+void csr_column_nnz(const I n_row,
+                    const I n_col,
+                    const I Ap[],
+                    const I Aj[],
+                          I Yx[],
+                    const I workers)
+{
+    csr_column_reduce(n_row, n_col, Ap, workers, (I)0,
+        [&](I row_start, I row_end, I counts[]) {
+            for(I jj = Ap[row_start]; jj < Ap[row_end]; jj++){
+                counts[Aj[jj]]++;
+            }
+        },
+        [](I& acc, const I& count) { acc += count; },
+        [&](I j, I& acc) { Yx[j] = acc; });
+}
+
+
+/*
+ * Compute the minimum or maximum of each row of a CSR matrix
+ *
+ * The implicit zeros of a row that is not full are taken into account.
+ *
+ * Input Arguments:
+ *   I  n_row         - number of rows in A
+ *   I  n_col         - number of columns in A
+ *   I  Ap[n_row+1]   - row pointer
+ *   I  Aj[nnz(A)]    - column indices
+ *   T  Ax[nnz(A)]    - nonzeros
+ *   I  op            - BINOP_MAXIMUM or BINOP_MINIMUM
+ *   I  workers       - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   T  Yx[n_row]     - minimum or maximum of each row
+ *
+ * Note:
+ *   Output array Yx must be preallocated
+ *
+ *   A must not have duplicate entries (see csr_sum_duplicates)
+ *
+ */
+template <class I, class T>
+void csr_row_minmax(const I n_row,
+                    const I n_col,
+                    const I Ap[],
+                    const I Aj[],
+                    const T Ax[],
+                    const I op,
+                          T Yx[],
+                    const I workers)
+{
+    const csr_reduce_better<T> better(op);
+
+    csr_for_row_chunks(n_row, Ap, workers, [&](I row_start, I row_end) {
+        for(I i = row_start; i < row_end; i++){
+            T value = 0;
+            if (Ap[i] < Ap[i+1]) {
+                value = Ax[Ap[i]];
+                for(I jj = Ap[i] + 1; jj < Ap[i+1]; jj++){
+                    if (better(Ax[jj], value)) {
+                        value = Ax[jj];
+                    }
+                }
+                if (Ap[i+1] - Ap[i] < n_col && better(T(0), value)) {
+                    value = 0;
+                }
+            }
+            Yx[i] = value;
+        }
+    });
+}
+
+
+/*
+ * Compute the minimum or maximum of each column of a CSR matrix
+ *
+ * The arguments are as for csr_row_minmax, except that
+ *
+ * Output Arguments:
+ *   T  Yx[n_col]     - minimum or maximum of each column
+ *
+ */
+template <class I, class T>
+void csr_column_minmax(const I n_row,
+                       const I n_col,
+                       const I Ap[],
+                       const I Aj[],
+                       const T Ax[],
+                       const I op,
+                             T Yx[],
+                       const I workers)
+{
+    const csr_reduce_better<T> better(op);
+
+    // (extremum, number of entries) of each column
+    typedef std::pair<T, I> state;
+
+    csr_column_reduce(n_row, n_col, Ap, workers, state(T(0), 0),
+        [&](I row_start, I row_end, state states[]) {
+            for(I jj = Ap[row_start]; jj < Ap[row_end]; jj++){
+                state& s = states[Aj[jj]];
+                if (s.second == 0 || better(Ax[jj], s.first)) {
+                    s.first = Ax[jj];
+                }
+                s.second++;
+            }
+        },
+        [&](state& acc, const state& s) {
+            if (s.second > 0 && (acc.second == 0 || better(s.first, acc.first))) {
+                acc.first = s.first;
+            }
+            acc.second += s.second;
+        },
+        [&](I j, state& acc) {
+            if (acc.second < n_row && better(T(0), acc.first)) {
+                acc.first = 0;
+            }
+            Yx[j] = acc.first;
+        });
+}
+
+
+/*
+ * Compute the column index of the minimum or maximum of each row of a
+ * CSR matrix
+ *
+ * The first index is returned if the extremum occurs several times, and
+ * implicit zeros are taken into account.
+ *
+ * Input Arguments:
+ *   I  n_row         - number of rows in A
+ *   I  n_col         - number of columns in A
+ *   I  Ap[n_row+1]   - row pointer
+ *   I  Aj[nnz(A)]    - column indices
+ *   T  Ax[nnz(A)]    - nonzeros
+ *   I  op            - BINOP_MAXIMUM or BINOP_MINIMUM
+ *   I  workers       - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   I  Yx[n_row]     - column of the minimum or maximum of each row
+ *
+ * Note:
+ *   Output array Yx must be preallocated
+ *
+ *   A must be in canonical format (see csr_has_canonical_format)
+ *
+ */
+template <class I, class T>
+void csr_row_argminmax(const I n_row,
+                       const I n_col,
+                       const I Ap[],
+                       const I Aj[],
+                       const T Ax[],
+                       const I op,
+                             I Yx[],
+                       const I workers)
+{
+    const csr_reduce_better<T> better(op);
+
+    csr_for_row_chunks(n_row, Ap, workers, [&](I row_start, I row_end) {
+        for(I i = row_start; i < row_end; i++){
+            const I start = Ap[i];
+            const I count = Ap[i+1] - start;
+            if (count == 0) {
+                Yx[i] = 0;
+                continue;
+            }
+
+            I best = start;
+            for(I jj = start + 1; jj < Ap[i+1]; jj++){
+                if (better(Ax[jj], Ax[best])) {
+                    best = jj;
+                }
+            }
+
+            // the first column without an entry
+            I gap = count;
+            for(I k = 0; k < count; k++){
+                if (Aj[start + k] != k) {
+                    gap = k;
+                    break;
+                }
+            }
+
+            Yx[i] = csr_argminmax_finish(n_col, count, Ax[best], Aj[best],
+                                         gap, better);
+        }
+    });
+}
+
+
+/*
+ * Compute the row index of the minimum or maximum of each column of a
+ * CSR matrix
+ *
+ * The arguments are as for csr_row_argminmax, except that
+ *
+ * Output Arguments:
+ *   I  Yx[n_col]     - row of the minimum or maximum of each column
+ *
+ * Note:
+ *   A must not have duplicate entries (see csr_sum_duplicates)
+ *
+ */
+template <class I, class T>
+void csr_column_argminmax(const I n_row,
+                          const I n_col,
+                          const I Ap[],
+                          const I Aj[],
+                          const T Ax[],
+                          const I op,
+                                I Yx[],
+                          const I workers)
+{
+    const csr_reduce_better<T> better(op);
+
+    struct state {
+        T value;    // extremum of the entries seen
+        I index;    // row of the first entry holding it
+        I count;    // number of entries seen
+        I gap;      // first row without an entry, or -1
+        I last;     // row of the last entry seen, or -1
+    };
+    const state init = {T(0), 0, 0, -1, -1};
+
+    csr_column_reduce(n_row, n_col, Ap, workers, init,
+        [&](I row_start, I row_end, state states[]) {
+            for(I i = row_start; i < row_end; i++){
+                for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+                    state& s = states[Aj[jj]];
+                    if (s.count == 0 || better(Ax[jj], s.value)) {
+                        s.value = Ax[jj];
+                        s.index = i;
+                    }
+                    const I expected = (s.last < 0) ? row_start : s.last + 1;
+                    if (s.gap < 0 && i > expected) {
+                        s.gap = expected;
+                    }
+                    s.last = i;
+                    s.count++;
+                }
+            }
+            if (row_start == row_end) {
+                return;
+            }
+            // columns whose entries stop before the end of the chunk
+            for(I j = 0; j < n_col; j++){
+                state& s = states[j];
+                const I expected = (s.last < 0) ? row_start : s.last + 1;
+                if (s.gap < 0 && expected < row_end) {
+                    s.gap = expected;
+                }
+            }
+        },
+        [&](state& acc, const state& s) {
+            if (s.count > 0 && (acc.count == 0 || better(s.value, acc.value))) {
+                acc.value = s.value;
+                acc.index = s.index;
+            }
+            if (acc.gap < 0) {
+                acc.gap = s.gap;
+            }
+            acc.count += s.count;
+        },
+        [&](I j, state& acc) {
+            Yx[j] = csr_argminmax_finish(n_row, acc.count, acc.value,
+                                         acc.index, acc.gap, better);
+        });
+}
+
+
+/*
+ * Append the rows of a CSR matrix A to the rows of a CSR matrix B under
+ * assembly
+ *
+ * bmat calls this for the blocks of each block row of B, from left to
+ * right, after counting the entries of each row of B. Bp_next[i] is the
+ * position in Bj and Bx of the next entry of row i of the block row, and
+ * is advanced past the entries of row i of A.
+ *
+ * Input Arguments:
+ *   I  n_row           - number of rows in A
+ *   I  col_offset      - column of B at which A starts
+ *   I  Ap[n_row+1]     - row pointer
+ *   I  Aj[nnz(A)]      - column indices
+ *   T  Ax[nnz(A)]      - nonzeros
+ *   I  workers         - maximum number of threads to use
+ *
+ * Input/Output Arguments:
+ *   I  Bp_next[n_row]  - next position in each row of B
+ *
+ * Output Arguments:
+ *   I  Bj[nnz(B)]      - column indices
+ *   T  Bx[nnz(B)]      - nonzeros
+ *
+ * Note:
+ *   If the blocks have sorted indices, so has B.
+ *
+ */
+template <class I, class T>
+void csr_append_block(const I n_row,
+                      const I col_offset,
+                      const I Ap[],
+                      const I Aj[],
+                      const T Ax[],
+                            I Bp_next[],
+                            I Bj[],
+                            T Bx[],
+                      const I workers)
+{
+    csr_for_row_chunks(n_row, Ap, workers, [&](I row_start, I row_end) {
+        for(I i = row_start; i < row_end; i++){
+            I pos = Bp_next[i];
+            for(I jj = Ap[i]; jj < Ap[i+1]; jj++){
+                Bj[pos] = Aj[jj] + col_offset;
+                Bx[pos] = Ax[jj];
+                pos++;
+            }
+            Bp_next[i] = pos;
+        }
+    });
+}
+
+
+/*
+ * Compute the Kronecker product C = kron(A, B) of CSR matrices A and B
+ *
+ * Row ia*n_row_B + ib of C holds the products of the entries of row ia
+ * of A with those of row ib of B, in that order, so that the row pointer
+ * of C follows from those of A and B. The rows of A are split into chunks
+ * with roughly the same number of nonzeros, and each thread writes the
+ * rows of C of its chunk, including their row pointers.
+ *
+ * Input Arguments:
+ *   I  n_row_A         - number of rows in A
+ *   I  n_col_A         - number of columns in A
+ *   I  Ap[n_row_A+1]   - row pointer
+ *   I  Aj[nnz(A)]      - column indices
+ *   T  Ax[nnz(A)]      - nonzeros
+ *   I  n_row_B         - number of rows in B
+ *   I  n_col_B         - number of columns in B
+ *   I  Bp[n_row_B+1]   - row pointer
+ *   I  Bj[nnz(B)]      - column indices
+ *   T  Bx[nnz(B)]      - nonzeros
+ *   I  workers         - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   I  Cp[n_row_A*n_row_B+1] - row pointer
+ *   I  Cj[nnz(A)*nnz(B)]     - column indices
+ *   T  Cx[nnz(A)*nnz(B)]     - nonzeros
+ *
+ * Note:
+ *   Output arrays Cp, Cj and Cx must be preallocated, and I must be able
+ *   to hold the shape and the number of nonzeros of C.
+ *
+ *   If A and B have sorted indices, so has C.
+ *
+ */
+template <class I, class T>
+void csr_kron(const I n_row_A,
+              const I n_col_A,
+              const I Ap[],
+              const I Aj[],
+              const T Ax[],
+              const I n_row_B,
+              const I n_col_B,
+              const I Bp[],
+              const I Bj[],
+              const T Bx[],
+                    I Cp[],
+                    I Cj[],
+                    T Cx[],
+              const I workers)
+{
+    const I nnz_B = Bp[n_row_B] - Bp[0];
+
+    const I n_chunks = parallel_num_chunks(
+        workers, ((npy_intp)Ap[n_row_A] + n_row_A) * std::max(nnz_B, (I)1));
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row_A, Ap, n_chunks, &bounds[0]);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        for(I ia = bounds[c]; ia < bounds[c+1]; ia++){
+            const I len_A = Ap[ia+1] - Ap[ia];
+            for(I ib = 0; ib < n_row_B; ib++){
+                I pos = (Ap[ia] - Ap[0]) * nnz_B + len_A * (Bp[ib] - Bp[0]);
+                Cp[ia * n_row_B + ib] = pos;
+                for(I jja = Ap[ia]; jja < Ap[ia+1]; jja++){
+                    const I col = Aj[jja] * n_col_B;
+                    const T a = Ax[jja];
+                    for(I jjb = Bp[ib]; jjb < Bp[ib+1]; jjb++){
+                        Cj[pos] = col + Bj[jjb];
+                        Cx[pos] = a * Bx[jjb];
+                        pos++;
+                    }
+                }
+            }
+        }
+    });
+    Cp[(npy_intp)n_row_A * n_row_B] = (Ap[n_row_A] - Ap[0]) * nnz_B;
+}
+
+
+/*
+ * Compute the blocks of the Kronecker product kron(A, B) of a CSR matrix
+ * A and a dense matrix B, as a BSR matrix with the sparsity structure of A
+ *
+ * Input Arguments:
+ *   I  n_row           - number of rows in A
+ *   I  Ap[n_row+1]     - row pointer
+ *   T  Ax[nnz(A)]      - nonzeros
+ *   I  R               - number of rows in B
+ *   I  C               - number of columns in B
+ *   T  Bx[R*C]         - B, in C order
+ *   I  workers         - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   T  Yx[nnz(A)*R*C]  - the blocks Ax[k]*B, one after the other
+ *
+ * Note:
+ *   Output array Yx must be preallocated
+ *
+ */
+template <class I, class T>
+void csr_kron_bsr(const I n_row,
+                  const I Ap[],
+                  const T Ax[],
+                  const I R,
+                  const I C,
+                  const T Bx[],
+                        T Yx[],
+                  const I workers)
+{
+    const npy_intp RC = (npy_intp)R * C;
+
+    const I n_chunks = parallel_num_chunks(
+        workers, ((npy_intp)Ap[n_row] + n_row) * std::max(RC, (npy_intp)1));
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row, Ap, n_chunks, &bounds[0]);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        for(I jj = Ap[bounds[c]]; jj < Ap[bounds[c+1]]; jj++){
+            const T a = Ax[jj];
+            T * y = Yx + (npy_intp)(jj - Ap[0]) * RC;
+            for(npy_intp k = 0; k < RC; k++){
+                y[k] = a * Bx[k];
+            }
+        }
+    });
+}
+
+
+/*
+ * splitmix64 generator, used as an independent stream per row by
+ * csr_random_indices: the state of row i is seeded by hashing i with the
+ * seed, so that the result does not depend on the number of threads.
+ */
+class splitmix64 {
+public:
+    explicit splitmix64(const npy_uint64 seed) : state(seed) {}
+
+    npy_uint64 next()
+    {
+        npy_uint64 z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // uniform in [0, n), by rejecting the biased low values
+    npy_uint64 below(const npy_uint64 n)
+    {
+        const npy_uint64 threshold = (0 - n) % n;
+        npy_uint64 r;
+        do {
+            r = next();
+        } while (r < threshold);
+        return r % n;
+    }
+
+private:
+    npy_uint64 state;
+};
+
+
+/*
+ * Draw the column indices of a random CSR matrix with a given number of
+ * nonzeros per row
+ *
+ * Row i gets Ap[i+1] - Ap[i] distinct columns, chosen uniformly at random
+ * and stored in increasing order, so that the result is in canonical
+ * format. Columns are drawn with replacement and the duplicates redrawn
+ * until there are enough of them; when a row is more than half full, its
+ * missing columns are drawn instead.
+ *
+ * Input Arguments:
+ *   I  n_row             - number of rows in A
+ *   I  n_col             - number of columns in A
+ *   I  Ap[n_row+1]       - row pointer, with Ap[i+1] - Ap[i] <= n_col
+ *   l  seed              - seed of the random streams
+ *   I  workers           - maximum number of threads
+ *
+ * Output Arguments:
+ *   I  Aj[nnz(A)]        - column indices
+ *
+ * Note:
+ *   The rows are drawn on separate streams, so that the result only
+ *   depends on seed and not on the number of threads.
+ *
+ */
+template <class I>
+void csr_random_indices(const I n_row,
+                        const I n_col,
+                        const I Ap[],
+                        const npy_int64 seed,
+                              I Aj[],
+                        const I workers)
+{
+    const npy_intp n_chunks = parallel_num_chunks(workers,
+                                                  (npy_intp)Ap[n_row] + n_row);
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_row, Ap, (I)n_chunks, &bounds[0]);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        std::vector<I> drawn;
+
+        for(I i = bounds[c]; i < bounds[c+1]; i++){
+            const I count = Ap[i+1] - Ap[i];
+            I * const row = Aj + Ap[i];
+            if(count == 0){
+                continue;
+            }
+            if(count == n_col){
+                for(I j = 0; j < n_col; j++){
+                    row[j] = j;
+                }
+                continue;
+            }
+
+            splitmix64 mix((npy_uint64)seed ^ (npy_uint64)i);
+            splitmix64 rng(mix.next());
+
+            const bool complement = count > n_col / 2;
+            const I n_draw = complement ? n_col - count : count;
+            drawn.clear();
+            while((I)drawn.size() < n_draw){
+                for(I k = (I)drawn.size(); k < n_draw; k++){
+                    drawn.push_back((I)rng.below((npy_uint64)n_col));
+                }
+                std::sort(drawn.begin(), drawn.end());
+                drawn.erase(std::unique(drawn.begin(), drawn.end()),
+                            drawn.end());
+            }
+
+            if(!complement){
+                std::copy(drawn.begin(), drawn.end(), row);
+                continue;
+            }
+            I pos = 0;
+            typename std::vector<I>::const_iterator skip = drawn.begin();
+            for(I j = 0; j < n_col; j++){
+                if(skip != drawn.end() && *skip == j){
+                    ++skip;
+                } else {
+                    row[pos++] = j;
+                }
+            }
+        }
+    });
+}
+
+
 /*
  * A test function checking the error handling
  */
@@ -26,7 +26,7 @@ void scal(const I n, const T a, T * x){
 
 // dot product
 template <class I, class T>
-void dot(const I n, const T * x, const T * y){
+T dot(const I n, const T * x, const T * y){
     T dp = 0;
     for(I i = 0; i < n; i++){
         dp += x[i] * y[i];
@@ -34,6 +34,17 @@ void dot(const I n, const T * x, const T * y){
     return dp;
 }
 
+// complex conjugate, which is the identity for real types
+template <class T>
+inline T conjugate(const T& x){
+    return x;
+}
+
+template <class c_type, class npy_type>
+inline complex_wrapper<c_type, npy_type> conjugate(const complex_wrapper<c_type, npy_type>& x){
+    return complex_wrapper<c_type, npy_type>(x.real, -x.imag);
+}
+
 
 // vectorize a binary operation
 template<class I, class T, class binary_operator>
@@ -80,4 +91,66 @@ void gemm(const I m, const I n, const I k, const T * A, const T * B, T * C){
 }
 
 
+/*
+ * Versions of gemv and gemm with block dimensions fixed at compile time.
+ *
+ * With constant trip counts the compiler can fully unroll the loops over
+ * the block and keep the accumulators in registers, which matters for the
+ * small blocks typical of BSR matrices. Each entry of the output receives
+ * its contributions in the same order as in gemv/gemm above, so results
+ * do not depend on which version is used.
+ */
+
+// y += A*x for an M x N matrix A
+template <int M, int N, class T>
+void gemv_fixed(const T * A, const T * x, T * y){
+    T dot[M];
+    for(int i = 0; i < M; i++){
+        dot[i] = y[i];
+    }
+    for(int i = 0; i < M; i++){
+        for(int j = 0; j < N; j++){
+            dot[i] += A[N * i + j] * x[j];
+        }
+    }
+    for(int i = 0; i < M; i++){
+        y[i] = dot[i];
+    }
+}
+
+// C += A*B for an M x K matrix A and K x N matrices B, C
+template <int M, int K, class I, class T>
+void gemm_fixed_mk(const I n, const T * A, const T * B, T * C){
+    for(int i = 0; i < M; i++){
+        T * C_row = C + (npy_intp)n * i;
+        for(int _d = 0; _d < K; _d++){
+            const T a = A[K * i + _d];
+            const T * B_row = B + (npy_intp)n * _d;
+            for(I j = 0; j < n; j++){
+                C_row[j] += a * B_row[j];
+            }
+        }
+    }
+}
+
+// C += A*B for an M x K matrix A and K x N matrix B
+template <int M, int N, int K, class T>
+void gemm_fixed(const T * A, const T * B, T * C){
+    T dot[M * N];
+    for(int i = 0; i < M * N; i++){
+        dot[i] = C[i];
+    }
+    for(int i = 0; i < M; i++){
+        for(int _d = 0; _d < K; _d++){
+            const T a = A[K * i + _d];
+            for(int j = 0; j < N; j++){
+                dot[N * i + j] += a * B[N * _d + j];
+            }
+        }
+    }
+    for(int i = 0; i < M * N; i++){
+        C[i] = dot[i];
+    }
+}
+
 #endif
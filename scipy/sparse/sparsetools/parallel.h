@@ -0,0 +1,160 @@
+#ifndef __SPTOOLS_PARALLEL_H__
+#define __SPTOOLS_PARALLEL_H__
+
+/*
+ * Helpers for running sparsetools kernels on several threads.
+ *
+ * A threaded kernel splits its outer loop into independent chunks and hands
+ * them to parallel_for_chunks, which runs each chunk on its own std::thread.
+ * call_thunk has already released the GIL at that point, so the chunks must
+ * not touch any Python objects.
+ */
+
+#include <vector>
+#include <thread>
+#include <exception>
+#include <system_error>
+#include <algorithm>
+
+/*
+ * Minimum amount of work (roughly, nonzeros touched) that justifies
+ * starting an additional thread.
+ */
+#define SPTOOLS_MIN_WORK_PER_THREAD 32768
+
+
+/*
+ * Determine how many chunks a kernel should be split into
+ *
+ * Input Arguments:
+ *   npy_intp  workers - maximum number of threads requested by the caller
+ *   npy_intp  work    - estimate of the total amount of work
+ *
+ * Returns:
+ *   A number of chunks in [1, workers], chosen so that each chunk has at
+ *   least SPTOOLS_MIN_WORK_PER_THREAD work units.
+ *
+ */
+inline npy_intp parallel_num_chunks(const npy_intp workers,
+                                    const npy_intp work)
+{
+    if (workers <= 1) {
+        return 1;
+    }
+    const npy_intp max_chunks = work / SPTOOLS_MIN_WORK_PER_THREAD;
+    return std::max((npy_intp)1, std::min(workers, max_chunks));
+}
+
+
+/*
+ * Split the rows of a CSR matrix into chunks of roughly equal cost
+ *
+ * The cost of row i is taken to be (Ap[i+1] - Ap[i]) + 1, so that both
+ * long rows and long runs of empty rows are balanced. Since the cumulative
+ * cost Ap[i] - Ap[0] + i is monotonic, chunk boundaries are found by
+ * bisection.
+ *
+ * Ap does not need to be an actual row pointer: any nondecreasing prefix
+ * sum of per-row work can be passed, e.g. the number of flops per row of
+ * a matrix product.
+ *
+ * Input Arguments:
+ *   I  n_row             - number of rows
+ *   P  Ap[n_row+1]       - row pointer
+ *   I  n_chunks          - number of chunks
+ *
+ * Output Arguments:
+ *   I  bounds[n_chunks+1] - chunk c covers rows [bounds[c], bounds[c+1])
+ *
+ */
+template <class I, class P>
+void partition_rows_by_nnz(const I n_row,
+                           const P Ap[],
+                           const I n_chunks,
+                                 I bounds[])
+{
+    const npy_intp total = (npy_intp)Ap[n_row] - Ap[0] + n_row;
+
+    bounds[0] = 0;
+    for(I c = 1; c < n_chunks; c++){
+        const npy_intp target = total * c / n_chunks;
+
+        // first row whose cumulative cost reaches target
+        I lo = bounds[c-1];
+        I hi = n_row;
+        while(lo < hi){
+            const I mid = lo + (hi - lo) / 2;
+            if((npy_intp)Ap[mid] - Ap[0] + mid < target){
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        bounds[c] = lo;
+    }
+    bounds[n_chunks] = n_row;
+}
+
+
+/*
+ * Call f(c) for each chunk c in [0, n_chunks), concurrently
+ *
+ * Chunk 0 runs on the calling thread. If a chunk throws, the remaining
+ * chunks still run to completion and the first exception is rethrown on
+ * the calling thread. If a thread cannot be started, its chunk runs on
+ * the calling thread instead.
+ *
+ */
+template <class F>
+void parallel_for_chunks(const npy_intp n_chunks, const F& f)
+{
+    if (n_chunks <= 1) {
+        if (n_chunks == 1) {
+            f(0);
+        }
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(n_chunks);
+    std::vector<std::thread> threads;
+    std::vector<npy_intp> inline_chunks;
+
+    // reserve up front, so that nothing below can throw while threads run
+    threads.reserve(n_chunks - 1);
+    inline_chunks.reserve(n_chunks);
+    inline_chunks.push_back(0);
+    for(npy_intp c = 1; c < n_chunks; c++){
+        try {
+            threads.push_back(std::thread([&f, &errors, c]() {
+                try {
+                    f(c);
+                } catch (...) {
+                    errors[c] = std::current_exception();
+                }
+            }));
+        } catch (const std::system_error&) {
+            inline_chunks.push_back(c);
+        }
+    }
+
+    for(size_t k = 0; k < inline_chunks.size(); k++){
+        const npy_intp c = inline_chunks[k];
+        try {
+            f(c);
+        } catch (...) {
+            errors[c] = std::current_exception();
+        }
+    }
+
+    for(size_t k = 0; k < threads.size(); k++){
+        threads[k].join();
+    }
+
+    for(npy_intp c = 0; c < n_chunks; c++){
+        if (errors[c]) {
+            std::rethrow_exception(errors[c]);
+        }
+    }
+}
+
+#endif
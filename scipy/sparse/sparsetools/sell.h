@@ -0,0 +1,299 @@
+#ifndef __SELL_H__
+#define __SELL_H__
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "parallel.h"
+
+/*
+ * Sliced ELLPACK (SELL-C-sigma) storage
+ *
+ * The rows of the matrix are grouped into slices of C consecutive rows.
+ * Each slice is stored like a small ELL matrix: its rows are padded to the
+ * length of the longest row in the slice, and the entries are laid out
+ * column-major, so that entry k of the C rows of a slice are contiguous.
+ * A matvec then processes C rows at a time with unit-stride, branch-free
+ * inner loops that the compiler can vectorize.
+ *
+ * To reduce the padding, rows are first sorted by decreasing length within
+ * windows of sigma rows. The row permutation is stored in perm.
+ *
+ * Storage:
+ *   I  perm[n_row]        - row of A stored at position r, for r < n_row
+ *   I  Sp[n_slices+1]     - offset of each slice into Sj, Sx
+ *   I  Sj[Sp[n_slices]]   - column indices; padding entries use column 0
+ *   T  Sx[Sp[n_slices]]   - nonzeros; padding entries are zero
+ *
+ *   where n_slices = ceil(n_row / C), and entry k of row r in slice s is
+ *   stored at Sp[s] + k*C + (r - s*C).
+ *
+ * Reference:
+ *   M. Kreutzer, G. Hager, G. Wellein, H. Fehske, A. R. Bishop,
+ *   "A unified sparse matrix data format for efficient general sparse
+ *   matrix-vector multiplication on modern processors with wide SIMD
+ *   units", SIAM J. Sci. Comput. 36(5), C401-C423 (2014).
+ *
+ */
+
+
+/*
+ * Compute the row permutation and slice pointer of the SELL-C-sigma
+ * representation of CSR matrix A
+ *
+ * Input Arguments:
+ *   I  n_row         - number of rows in A
+ *   I  Ap[n_row+1]   - row pointer
+ *   I  C             - number of rows per slice
+ *   I  sigma         - size of the windows in which rows are sorted by
+ *                      length; 1 disables sorting
+ *
+ * Output Arguments:
+ *   I  perm[n_row]        - row permutation
+ *   I  Sp[n_slices+1]     - slice pointer
+ *
+ * Note:
+ *   Output arrays must be preallocated
+ *
+ */
+template <class I>
+void csr_tosell_pass1(const I n_row,
+                      const I Ap[],
+                      const I C,
+                      const I sigma,
+                            I perm[],
+                            I Sp[])
+{
+    for(I i = 0; i < n_row; i++){
+        perm[i] = i;
+    }
+
+    if (sigma > 1) {
+        for(I start = 0; start < n_row; start += sigma){
+            const I end = std::min<npy_intp>((npy_intp)start + sigma, n_row);
+            std::stable_sort(perm + start, perm + end, [Ap](I a, I b) {
+                return Ap[a+1] - Ap[a] > Ap[b+1] - Ap[b];
+            });
+        }
+    }
+
+    const I n_slices = n_row / C + (n_row % C != 0);
+
+    npy_intp nnz = 0;
+    Sp[0] = 0;
+    for(I s = 0; s < n_slices; s++){
+        I width = 0;
+        const I r_end = std::min<npy_intp>((npy_intp)(s + 1) * C, n_row);
+        for(I r = s * C; r < r_end; r++){
+            width = std::max(width, Ap[perm[r]+1] - Ap[perm[r]]);
+        }
+
+        nnz += (npy_intp)width * C;
+        if (nnz != (I)nnz) {
+            throw std::overflow_error("nnz of the result is too large");
+        }
+        Sp[s+1] = nnz;
+    }
+}
+
+
+/*
+ * Fill in the entries of the SELL-C-sigma representation of CSR matrix A
+ *
+ * Input Arguments:
+ *   I  n_row          - number of rows in A
+ *   I  Ap[n_row+1]    - row pointer
+ *   I  Aj[nnz(A)]     - column indices
+ *   T  Ax[nnz(A)]     - nonzeros
+ *   I  C              - number of rows per slice
+ *   I  perm[n_row]    - row permutation, from csr_tosell_pass1
+ *   I  Sp[n_slices+1] - slice pointer, from csr_tosell_pass1
+ *
+ * Output Arguments:
+ *   I  Sj[Sp[n_slices]] - column indices
+ *   T  Sx[Sp[n_slices]] - nonzeros
+ *
+ * Note:
+ *   Output arrays must be preallocated
+ *   Duplicate entries in A are not merged.
+ *   Explicit zeros in A are carried over.
+ *
+ */
+template <class I, class T>
+void csr_tosell_pass2(const I n_row,
+                      const I Ap[],
+                      const I Aj[],
+                      const T Ax[],
+                      const I C,
+                      const I perm[],
+                      const I Sp[],
+                            I Sj[],
+                            T Sx[])
+{
+    const I n_slices = n_row / C + (n_row % C != 0);
+
+    std::fill(Sj, Sj + Sp[n_slices], 0);
+    std::fill(Sx, Sx + Sp[n_slices], 0);
+
+    for(I s = 0; s < n_slices; s++){
+        const I r_end = std::min<npy_intp>((npy_intp)(s + 1) * C, n_row);
+        for(I r = s * C; r < r_end; r++){
+            const I row = perm[r];
+            npy_intp dest = Sp[s] + (r - s * C);
+            for(I jj = Ap[row]; jj < Ap[row+1]; jj++){
+                Sj[dest] = Aj[jj];
+                Sx[dest] = Ax[jj];
+                dest += C;
+            }
+        }
+    }
+}
+
+
+/*
+ * Compute Y += A*X for slices [s_start, s_end) of SELL-C-sigma matrix A,
+ * with the slice height C fixed at compile time
+ */
+template <int C, class I, class T>
+void sell_matvec_slices(const I n_row,
+                        const I s_start,
+                        const I s_end,
+                        const I perm[],
+                        const I Sp[],
+                        const I Sj[],
+                        const T Sx[],
+                        const T Xx[],
+                              T Yx[])
+{
+    for(I s = s_start; s < s_end; s++){
+        T sum[C];
+        for(int lane = 0; lane < C; lane++){
+            sum[lane] = 0;
+        }
+
+        const I * j = Sj + Sp[s];
+        const T * x = Sx + Sp[s];
+        const npy_intp width = (Sp[s+1] - Sp[s]) / C;
+        for(npy_intp k = 0; k < width; k++){
+            for(int lane = 0; lane < C; lane++){
+                sum[lane] += x[lane] * Xx[j[lane]];
+            }
+            j += C;
+            x += C;
+        }
+
+        const I r_start = s * C;
+        const int n_lanes = std::min<npy_intp>(C, (npy_intp)n_row - r_start);
+        for(int lane = 0; lane < n_lanes; lane++){
+            Yx[perm[r_start + lane]] += sum[lane];
+        }
+    }
+}
+
+
+/*
+ * Version of sell_matvec_slices for any slice height
+ */
+template <class I, class T>
+void sell_matvec_slices(const I n_row,
+                        const I C,
+                        const I s_start,
+                        const I s_end,
+                        const I perm[],
+                        const I Sp[],
+                        const I Sj[],
+                        const T Sx[],
+                        const T Xx[],
+                              T Yx[])
+{
+    std::vector<T> sum(C);
+
+    for(I s = s_start; s < s_end; s++){
+        std::fill(sum.begin(), sum.end(), 0);
+
+        const I * j = Sj + Sp[s];
+        const T * x = Sx + Sp[s];
+        const npy_intp width = (Sp[s+1] - Sp[s]) / C;
+        for(npy_intp k = 0; k < width; k++){
+            for(I lane = 0; lane < C; lane++){
+                sum[lane] += x[lane] * Xx[j[lane]];
+            }
+            j += C;
+            x += C;
+        }
+
+        const I r_start = s * C;
+        const I n_lanes = std::min<npy_intp>(C, (npy_intp)n_row - r_start);
+        for(I lane = 0; lane < n_lanes; lane++){
+            Yx[perm[r_start + lane]] += sum[lane];
+        }
+    }
+}
+
+
+/*
+ * Compute Y += A*X for SELL-C-sigma matrix A and dense vectors X,Y
+ *
+ * Input Arguments:
+ *   I  n_row            - number of rows in A
+ *   I  C                - number of rows per slice
+ *   I  perm[n_row]      - row permutation
+ *   I  Sp[n_slices+1]   - slice pointer
+ *   I  Sj[Sp[n_slices]] - column indices
+ *   T  Sx[Sp[n_slices]] - nonzeros
+ *   T  Xx[n_col]        - input vector
+ *   I  workers          - maximum number of threads to use
+ *
+ * Output Arguments:
+ *   T  Yx[n_row]        - output vector
+ *
+ * Note:
+ *   Output array Yx must be preallocated
+ *
+ *   Padding entries multiply zero by Xx[0], so non-finite values in Xx[0]
+ *   can turn into NaN in rows that have padding.
+ *
+ *   Slice heights 4, 8, 16 and 32 use unrolled kernels.
+ *
+ */
+template <class I, class T>
+void sell_matvec(const I n_row,
+                 const I C,
+                 const I perm[],
+                 const I Sp[],
+                 const I Sj[],
+                 const T Sx[],
+                 const T Xx[],
+                       T Yx[],
+                 const I workers)
+{
+    const I n_slices = n_row / C + (n_row % C != 0);
+
+    const I n_chunks = parallel_num_chunks(workers, (npy_intp)Sp[n_slices]);
+    std::vector<I> bounds(n_chunks + 1);
+    partition_rows_by_nnz(n_slices, Sp, n_chunks, &bounds[0]);
+
+    parallel_for_chunks(n_chunks, [&](npy_intp c) {
+        const I s_start = bounds[c];
+        const I s_end = bounds[c+1];
+        switch (C) {
+        case 4:
+            sell_matvec_slices<4>(n_row, s_start, s_end, perm, Sp, Sj, Sx, Xx, Yx);
+            break;
+        case 8:
+            sell_matvec_slices<8>(n_row, s_start, s_end, perm, Sp, Sj, Sx, Xx, Yx);
+            break;
+        case 16:
+            sell_matvec_slices<16>(n_row, s_start, s_end, perm, Sp, Sj, Sx, Xx, Yx);
+            break;
+        case 32:
+            sell_matvec_slices<32>(n_row, s_start, s_end, perm, Sp, Sj, Sx, Xx, Yx);
+            break;
+        default:
+            sell_matvec_slices(n_row, C, s_start, s_end, perm, Sp, Sj, Sx, Xx, Yx);
+        }
+    });
+}
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef __SPTOOLS_SORT_H__
+#define __SPTOOLS_SORT_H__
+
+#include <vector>
+#include <algorithm>
+
+/*
+ * Runs of at most this many entries are sorted by insertion sort in
+ * sort_by_index, longer ones by radix sort
+ */
+#define SPTOOLS_INSERTION_SORT_MAX 32
+#define SPTOOLS_RADIX_BITS 8
+
+
+/*
+ * Stable sort of the entries (Aj[k], Ax[k]), k < n, by index Aj[k]
+ *
+ * Short runs use insertion sort. Longer ones use an LSD radix sort on
+ * Aj[k] - min_index with 8-bit digits, with only as many passes as
+ * max_index - min_index needs, moving Ax alongside.
+ *
+ * Input Arguments:
+ *   I  n                 - number of entries
+ *   I  min_index         - lower bound on the indices
+ *   I  max_index         - upper bound on the indices
+ *
+ * Input/Output Arguments:
+ *   I  Aj[n]             - indices
+ *   T  Ax[n]             - values
+ *   std::vector<I> tmp_j - scratch space, grown as needed
+ *   std::vector<T> tmp_x - scratch space, grown as needed
+ *
+ */
+template <class I, class T>
+void sort_by_index(const I n,
+                   const I min_index,
+                   const I max_index,
+                         I Aj[],
+                         T Ax[],
+                         std::vector<I>& tmp_j,
+                         std::vector<T>& tmp_x)
+{
+    if (n <= SPTOOLS_INSERTION_SORT_MAX) {
+        for(I k = 1; k < n; k++){
+            const I j = Aj[k];
+            const T x = Ax[k];
+            I m = k;
+            while(m > 0 && Aj[m-1] > j){
+                Aj[m] = Aj[m-1];
+                Ax[m] = Ax[m-1];
+                m--;
+            }
+            Aj[m] = j;
+            Ax[m] = x;
+        }
+        return;
+    }
+
+    if ((I)tmp_j.size() < n) {
+        tmp_j.resize(n);
+        tmp_x.resize(n);
+    }
+
+    const npy_intp n_buckets = (npy_intp)1 << SPTOOLS_RADIX_BITS;
+    const npy_uint64 span = (npy_uint64)max_index - (npy_uint64)min_index;
+    npy_intp count[n_buckets + 1];
+
+    I *src_j = Aj, *dst_j = &tmp_j[0];
+    T *src_x = Ax, *dst_x = &tmp_x[0];
+
+    for(int shift = 0;
+        shift == 0 || (shift < 64 && (span >> shift) != 0);
+        shift += SPTOOLS_RADIX_BITS){
+        std::fill(count, count + n_buckets + 1, 0);
+        for(I k = 0; k < n; k++){
+            const npy_uint64 key = (npy_uint64)src_j[k] - (npy_uint64)min_index;
+            count[((key >> shift) & (n_buckets - 1)) + 1]++;
+        }
+        for(npy_intp b = 0; b < n_buckets; b++){
+            count[b+1] += count[b];
+        }
+        for(I k = 0; k < n; k++){
+            const npy_uint64 key = (npy_uint64)src_j[k] - (npy_uint64)min_index;
+            const npy_intp dest = count[(key >> shift) & (n_buckets - 1)]++;
+            dst_j[dest] = src_j[k];
+            dst_x[dest] = src_x[k];
+        }
+        std::swap(src_j, dst_j);
+        std::swap(src_x, dst_x);
+    }
+
+    if (src_j != Aj) {
+        std::copy(src_j, src_j + n, Aj);
+        std::copy(src_x, src_x + n, Ax);
+    }
+}
+
+#endif
@@ -54,6 +54,7 @@ static const int supported_T_typenums[] = {NPY_BOOL,
                                            NPY_CFLOAT, NPY_CDOUBLE, NPY_CLONGDOUBLE};
 static const int n_supported_T_typenums = sizeof(supported_T_typenums) / sizeof(int);
 
+static int accumulator_typenum(int typenum);
 static PyObject *array_from_std_vector_and_free(int typenum, void *p);
 static void *allocate_std_vector_typenum(int typenum);
 static void free_std_vector_typenum(int typenum, void *p);
@@ -80,6 +81,8 @@ static PyObject *c_array_from_object(PyObject *obj, int typenum, int is_output);
  *     'V': std::vector<integer>
  *     'W': std::vector<data>
  *     'B': npy_bool array
+ *     'P': npy_int64 array
+ *     'U': <data> accumulator array; see accumulator_typenum
  *     '*': indicates that the next argument is an output argument
  * thunk : PY_LONG_LONG thunk(int I_typenum, int T_typenum, void **)
  *     Thunk function to call. It is passed a void** array of pointers to
@@ -187,6 +190,18 @@ call_thunk(char ret_spec, const char *spec, thunk_t *thunk, PyObject *args)
                 goto fail;
             }
             continue;
+        case 'P':
+        case 'U':
+            /* Fixed-type and accumulator arrays, cast below */
+            arg = PyTuple_GetItem(args, arg_j);
+            if (arg == NULL) {
+                goto fail;
+            }
+            arg_arrays[j] = c_array_from_object(arg, -1, is_output[j]);
+            if (arg_arrays[j] == NULL) {
+                goto fail;
+            }
+            continue;
         case 'V':
             /* std::vector integer output array */
             I_in_arglist = 1;
@@ -315,7 +330,15 @@ call_thunk(char ret_spec, const char *spec, thunk_t *thunk, PyObject *args)
             continue;
         }
         else {
-            cur_typenum = (*p == 'I' || *p == 'i') ? I_typenum : T_typenum;
+            if (*p == 'P') {
+                cur_typenum = NPY_INT64;
+            }
+            else if (*p == 'U') {
+                cur_typenum = accumulator_typenum(T_typenum);
+            }
+            else {
+                cur_typenum = (*p == 'I' || *p == 'i') ? I_typenum : T_typenum;
+            }
 
             /* Cast if necessary */
             arg = arg_arrays[j];
@@ -465,6 +488,24 @@ fail:
 }
 
 
+/*
+ * Type in which routines with 'U' arguments accumulate sums of <data> values.
+ *
+ * Single precision is summed in double precision, everything else in
+ * itself. Must agree with ACC_TYPES in generate_sparsetools.py.
+ */
+static int accumulator_typenum(int typenum)
+{
+    if (PyArray_EquivTypenums(typenum, NPY_FLOAT)) {
+        return NPY_DOUBLE;
+    }
+    else if (PyArray_EquivTypenums(typenum, NPY_CFLOAT)) {
+        return NPY_CDOUBLE;
+    }
+    return typenum;
+}
+
+
 /*
  * Helper functions for dealing with std::vector templated instantiation.
  */
@@ -5,9 +5,17 @@ from __future__ import division, print_function, absolute_import
 
 __all__ = ['count_blocks','estimate_blocksize']
 
+import numpy as np
+
 from .csr import isspmatrix_csr, csr_matrix
 from .csc import isspmatrix_csc
-from ._sparsetools import csr_count_blocks
+from ._sparsetools import csr_count_blocks, csr_sample_block_counts
+from ._workers import _workers
+
+# Largest block dimension tried by estimate_blocksize, and the number of
+# rows it samples for each blocksize
+_MAX_BLOCKSIZE = 8
+_SAMPLE_ROWS = 4096
 
 
 def extract_diagonal(A):
@@ -37,8 +45,16 @@ def estimate_blocksize(A,efficiency=0.7):
 
     Returns a blocksize=(r,c) such that
         - A.nnz / A.tobsr( (r,c) ).nnz > efficiency
+
+    The blocksizes up to 8x8 that divide the shape of A are tried. Their
+    fill ratios are estimated in compiled code from a sample of rows, and
+    of the blocksizes with a fill ratio above efficiency, the one with the
+    most nonzeros per block is chosen.
     """
-    if not (isspmatrix_csr(A) or isspmatrix_csc(A)):
+    if isspmatrix_csc(A):
+        r, c = estimate_blocksize(A.T, efficiency)
+        return (c, r)
+    if not isspmatrix_csr(A):
         A = csr_matrix(A)
 
     if A.nnz == 0:
@@ -47,40 +63,27 @@ def estimate_blocksize(A,efficiency=0.7):
     if not 0 < efficiency < 1.0:
         raise ValueError('efficiency must satisfy 0.0 < efficiency < 1.0')
 
-    high_efficiency = (1.0 + efficiency) / 2.0
-    nnz = float(A.nnz)
     M,N = A.shape
 
-    if M % 2 == 0 and N % 2 == 0:
-        e22 = nnz / (4 * count_blocks(A,(2,2)))
-    else:
-        e22 = 0.0
-
-    if M % 3 == 0 and N % 3 == 0:
-        e33 = nnz / (9 * count_blocks(A,(3,3)))
-    else:
-        e33 = 0.0
-
-    if e22 > high_efficiency and e33 > high_efficiency:
-        e66 = nnz / (36 * count_blocks(A,(6,6)))
-        if e66 > efficiency:
-            return (6,6)
-        else:
-            return (3,3)
-    else:
-        if M % 4 == 0 and N % 4 == 0:
-            e44 = nnz / (16 * count_blocks(A,(4,4)))
-        else:
-            e44 = 0.0
-
-        if e44 > efficiency:
-            return (4,4)
-        elif e33 > efficiency:
-            return (3,3)
-        elif e22 > efficiency:
-            return (2,2)
-        else:
-            return (1,1)
+    sizes = [(r, c) for r in range(1, _MAX_BLOCKSIZE + 1) if M % r == 0
+             for c in range(1, _MAX_BLOCKSIZE + 1) if N % c == 0]
+    R = np.array([r for r, c in sizes], dtype=A.indices.dtype)
+    C = np.array([c for r, c in sizes], dtype=A.indices.dtype)
+    nnz = np.empty(len(sizes), dtype=np.int64)
+    blocks = np.empty(len(sizes), dtype=np.int64)
+    csr_sample_block_counts(M, N, A.indptr, A.indices, len(sizes), R, C,
+                            _SAMPLE_ROWS, nnz, blocks, _workers(None))
+
+    blocks = np.maximum(blocks, 1)
+    per_block = nnz / blocks.astype(float)
+    fill = per_block / (R * C)
+
+    # ties go to the fullest, then the most square blocks
+    ranked = [((per_block[k], fill[k], -abs(r - c), r), (r, c))
+              for k, (r, c) in enumerate(sizes) if fill[k] > efficiency]
+    if not ranked:
+        return (1,1)
+    return max(ranked)[1]
 
 
 def count_blocks(A,blocksize):
@@ -0,0 +1,91 @@
+from __future__ import division, print_function, absolute_import
+
+import threading
+
+import numpy as np
+from numpy.testing import assert_, assert_equal, assert_allclose
+from pytest import raises as assert_raises
+
+from scipy.sparse import SparseBuilder
+
+
+class TestSparseBuilder(object):
+    def test_add(self):
+        np.random.seed(1234)
+        M, N = 30, 40
+        rows = np.random.randint(M, size=5000)
+        cols = np.random.randint(N, size=5000)
+        vals = np.random.rand(5000)
+        expected = np.zeros((M, N))
+        np.add.at(expected, (rows, cols), vals)
+
+        # several batches, growing the table from its initial size
+        B = SparseBuilder((M, N))
+        for k in range(0, 5000, 700):
+            B.add(rows[k:k+700], cols[k:k+700], vals[k:k+700])
+        assert_equal(B.nnz, np.count_nonzero(expected))
+
+        A = B.tocsr()
+        assert_(A.has_canonical_format)
+        assert_allclose(A.toarray(), expected)
+        assert_allclose(B.tocoo().toarray(), expected)
+
+        # adding keeps the entries built so far
+        B.add(0, np.arange(N), 1.0)
+        expected[0] += 1
+        assert_allclose(B.tocsr().toarray(), expected)
+
+    def test_dtype(self):
+        B = SparseBuilder((3, 3), dtype=np.complex128, capacity=100)
+        B.add([0, 0, 2], [1, 1, 2], [1j, 2, 3])
+        assert_equal(B.tocsr().dtype, np.complex128)
+        assert_equal(B.tocsr().toarray(),
+                     [[0, 2 + 1j, 0], [0, 0, 0], [0, 0, 3]])
+
+        B = SparseBuilder((3, 3), dtype=np.int64)
+        B.add([1, 1], [0, 0], [1, -1])
+        A = B.tocsr()
+        assert_equal(A.dtype, np.int64)
+        assert_equal(A.nnz, 1)
+        assert_equal(A.toarray(), np.zeros((3, 3)))
+
+    def test_empty(self):
+        B = SparseBuilder((4, 5))
+        B.add([], [], [])
+        assert_equal(B.tocsr().shape, (4, 5))
+        assert_equal(B.tocsr().nnz, 0)
+
+    def test_errors(self):
+        B = SparseBuilder((3, 4))
+        assert_raises(IndexError, B.add, [3], [0], [1.])
+        assert_raises(IndexError, B.add, [0], [-1], [1.])
+        assert_raises(TypeError, B.add, [0.5], [0], [1.])
+        assert_raises(ValueError, B.add, [0, 1], [0, 1, 2], [1.])
+        assert_raises(ValueError, B.merge, SparseBuilder((4, 3)))
+        assert_raises(TypeError, B.merge, np.zeros((3, 4)))
+
+    def test_merge_threads(self):
+        np.random.seed(1234)
+        M, N = 200, 300
+        rows = np.random.randint(M, size=(4, 20000))
+        cols = np.random.randint(N, size=(4, 20000))
+        vals = np.random.rand(4, 20000)
+        expected = np.zeros((M, N))
+        np.add.at(expected, (rows.ravel(), cols.ravel()), vals.ravel())
+
+        builders = [SparseBuilder((M, N)) for k in range(4)]
+
+        def worker(k):
+            builders[k].add(rows[k], cols[k], vals[k])
+
+        threads = [threading.Thread(target=worker, args=(k,))
+                   for k in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+        B = SparseBuilder((M, N))
+        for other in builders:
+            B.merge(other)
+        assert_allclose(B.tocsr().toarray(), expected)
@@ -10,6 +10,7 @@ import pytest
 from pytest import raises as assert_raises
 from scipy._lib._testutils import check_free_memory
 
+import scipy.sparse
 from scipy.sparse import csr_matrix, coo_matrix, construct
 from scipy.sparse.construct import rand as sprand
 from scipy.sparse.sputils import matrix
@@ -282,6 +283,32 @@ class TestConstructUtils(object):
                 expected = np.kron(a,b)
                 assert_array_equal(result,expected)
 
+    def test_kron_formats(self):
+        np.random.seed(1234)
+        A = sprand(200, 30, density=0.1, format='csr')
+        A.data[::5] = 0
+        B = sprand(40, 50, density=0.05, format='csc')
+        Bdense = np.random.rand(3, 2)
+        expected = np.kron(A.toarray(), B.toarray())
+
+        for workers in [1, 3]:
+            with scipy.sparse.set_workers(workers):
+                for fmt in [None, 'csr', 'csc', 'coo']:
+                    C = construct.kron(A, B, format=fmt)
+                    assert_equal(C.format, fmt or 'csr')
+                    assert_equal(C.toarray(), expected)
+                    if fmt != 'coo':
+                        assert_(C.has_sorted_indices)
+                for fmt in [None, 'bsr']:
+                    C = construct.kron(A, Bdense, format=fmt)
+                    assert_equal(C.format, 'bsr')
+                    assert_equal(C.toarray(), np.kron(A.toarray(), Bdense))
+
+        C = construct.kron(A.astype(np.float32), B.astype(np.int64))
+        assert_equal(C.dtype, np.float64)
+        assert_equal(construct.kron(A, csr_matrix((2, 3)), format='csc').shape,
+                     (400, 90))
+
     def test_kronsum(self):
         cases = []
 
@@ -373,6 +400,42 @@ class TestConstructUtils(object):
             construct.bmat([[A, C]])
         excinfo.match(r'Got blocks\[0,1\]\.shape\[0\] == 1, expected 2')
 
+    def test_bmat_compressed(self):
+        # CSR and CSC results are assembled directly from the blocks
+        np.random.seed(1234)
+        blocks = [[sprand(50, 40, density=0.1, format='csr'), None,
+                   sprand(50, 7, density=0.5, format='csc')],
+                  [coo_matrix(np.arange(40).reshape(1, 40)),
+                   sprand(1, 3, density=1, format='lil'),
+                   None],
+                  [None, None, sprand(60, 7, density=0.2, format='coo')]]
+        dense = np.zeros((111, 50))
+        dense[:50, :40] = blocks[0][0].toarray()
+        dense[:50, 43:] = blocks[0][2].toarray()
+        dense[50, :40] = np.arange(40)
+        dense[50, 40:43] = blocks[1][1].toarray()
+        dense[51:, 43:] = blocks[2][2].toarray()
+
+        for fmt in ['csr', 'csc']:
+            for workers in [1, 3]:
+                with scipy.sparse.set_workers(workers):
+                    A = construct.bmat(blocks, format=fmt)
+                assert_equal(A.format, fmt)
+                assert_equal(A.toarray(), dense)
+                assert_(A.has_sorted_indices)
+            A = construct.bmat(blocks, format=fmt, dtype=np.float32)
+            assert_equal(A.dtype, np.float32)
+            assert_equal(A.indices.dtype, np.int32)
+
+        # the format of the blocks is kept if they share it
+        A = construct.bmat([[blocks[0][0], None], [None, blocks[0][0]]])
+        assert_equal(A.format, 'csr')
+        A = construct.hstack([blocks[0][2].tocsc(), blocks[0][2].tocsc()])
+        assert_equal(A.format, 'csc')
+        assert_equal(A.toarray(), np.hstack([blocks[0][2].toarray()] * 2))
+        assert_equal(construct.bmat([[None, None]], format='csr').shape,
+                     (0, 0))
+
     @pytest.mark.slow
     def test_concatenate_int32_overflow(self):
         """ test for indptr overflow when concatenating matrices """
@@ -419,6 +482,28 @@ class TestConstructUtils(object):
         assert_equal(construct.block_diag([1]).todense(),
                      matrix([[1]]))
 
+    def test_block_diag_formats(self):
+        np.random.seed(1234)
+        mats = [sprand(30, 20, density=0.2, format=fmt)
+                for fmt in ['csr', 'csc', 'coo', 'lil']]
+        mats.append(np.arange(6).reshape(2, 3))
+        expected = np.zeros((122, 83))
+        row = col = 0
+        for a in mats:
+            a = coo_matrix(a).toarray()
+            expected[row:row + a.shape[0], col:col + a.shape[1]] = a
+            row += a.shape[0]
+            col += a.shape[1]
+
+        for workers in [1, 3]:
+            with scipy.sparse.set_workers(workers):
+                for fmt in [None, 'csr', 'csc', 'bsr']:
+                    A = construct.block_diag(mats, format=fmt)
+                    assert_equal(A.format, fmt or 'coo')
+                    assert_equal(A.toarray(), expected)
+        assert_equal(construct.block_diag(mats, dtype=np.float32).dtype,
+                     np.float32)
+
     def test_random_sampling(self):
         # Simple sanity checks for sparse random sampling.
         for f in sprand, _sprandn:
@@ -468,6 +553,39 @@ class TestConstructUtils(object):
             assert_(np.any(np.less(x.data, 0)))
             assert_(np.any(np.less(1, x.data)))
 
+    def test_random_structure(self):
+        # The positions are drawn straight into canonical CSR format, and
+        # do not depend on the number of threads
+        for m, n, density in [(1, 50, 0.3), (50, 1, 0.3), (300, 200, 0.02),
+                              (40, 30, 0.7), (20, 10, 1.0), (0, 5, 0.5)]:
+            x = construct.random(m, n, density=density, format='csr',
+                                 random_state=1234)
+            assert_equal(x.nnz, int(density * m * n))
+            assert_(x.has_canonical_format)
+            assert_(np.all(np.diff(x.indptr) <= n))
+            x.has_sorted_indices = False
+            x.sum_duplicates()
+            assert_equal(x.nnz, int(density * m * n))
+
+            with scipy.sparse.set_workers(4):
+                y = construct.random(m, n, density=density, format='csr',
+                                     random_state=1234)
+            assert_array_equal(x.indptr, y.indptr)
+            assert_array_equal(x.indices, y.indices)
+            assert_array_equal(x.data, y.data)
+
+    def test_random_uniform(self):
+        # Every position is equally likely to hold a nonzero
+        rs = np.random.RandomState(1234)
+        counts = np.zeros((20, 30))
+        for _ in range(400):
+            counts += construct.random(20, 30, density=0.1,
+                                       random_state=rs).toarray() != 0
+        # each count is about binomial(400, 0.1): 40 +- 6, and each row
+        # total 1200 +- 32
+        assert_(np.all(np.abs(counts - 40) < 30))
+        assert_(np.all(np.abs(counts.sum(axis=1) - 1200) < 160))
+
     def test_random_accept_str_dtype(self):
         # anything that np.dtype can convert to a dtype should be accepted
         # for the dtype
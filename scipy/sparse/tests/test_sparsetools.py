@@ -6,6 +6,7 @@ import gc
 import threading
 
 import numpy as np
+import scipy.sparse
 from numpy.testing import assert_equal, assert_, assert_allclose
 from scipy.sparse import (_sparsetools, coo_matrix, csr_matrix, csc_matrix,
                           bsr_matrix, dia_matrix)
@@ -326,3 +327,506 @@ def test_endianness():
 
     assert_allclose(a.dot(v), [1, 3, 6, 5])
     assert_allclose(b.dot(v), [1, 3, 6, 5])
+
+
+@pytest.mark.parametrize('workers', [1, 2, 7])
+def test_csr_matvec_threaded(workers):
+    # Large enough that the kernels actually split the rows
+    np.random.seed(1234)
+    # A few very long rows and many empty ones exercise the nnz balancing
+    a = scipy.sparse.vstack([
+        scipy.sparse.random(20000, 3000, density=0.01),
+        scipy.sparse.random(20, 3000, density=0.5),
+        csr_matrix((500, 3000))], format='csr')
+    M, N = a.shape
+
+    x = np.random.rand(N)
+    y0 = np.zeros(M)
+    _sparsetools.csr_matvec(M, N, a.indptr, a.indices, a.data, x, y0)
+    y = np.zeros(M)
+    _sparsetools.csr_matvec_threaded(M, N, a.indptr, a.indices, a.data,
+                                     x, y, workers)
+    assert_equal(y, y0)
+
+    X = np.random.rand(N, 3)
+    Y0 = np.zeros((M, 3))
+    _sparsetools.csr_matvecs(M, N, 3, a.indptr, a.indices, a.data,
+                             X.ravel(), Y0.ravel())
+    Y = np.zeros((M, 3))
+    _sparsetools.csr_matvecs_threaded(M, N, 3, a.indptr, a.indices, a.data,
+                                      X.ravel(), Y.ravel(), workers)
+    assert_equal(Y, Y0)
+
+    with scipy.sparse.set_workers(workers):
+        assert_equal(scipy.sparse.get_workers(), workers)
+        assert_equal(a.dot(x), y0)
+        assert_equal(a.dot(X), Y0)
+
+
+
+@pytest.mark.parametrize('workers', [2, 7])
+@pytest.mark.parametrize('fmt', ['csr', 'csc'])
+def test_matmat_threaded(workers, fmt):
+    np.random.seed(1234)
+    a = scipy.sparse.random(4000, 500, density=0.02, format=fmt)
+    b = scipy.sparse.random(500, 3000, density=0.02, format=fmt)
+    # integer entries that frequently cancel to zero
+    a.data = np.random.randint(-1, 2, size=a.nnz).astype(float)
+    b.data = np.random.randint(-1, 2, size=b.nnz).astype(float)
+
+    expected = a.dot(b)
+    with scipy.sparse.set_workers(workers):
+        result = a.dot(b)
+
+    assert_equal(result.indptr, expected.indptr)
+    assert_equal(result.indices, expected.indices)
+    assert_equal(result.data, expected.data)
+    assert_equal(result.toarray(), a.toarray().dot(b.toarray()))
+
+
+@pytest.mark.parametrize('workers', [1, 4])
+def test_matmat_hypersparse(workers):
+    # With many columns and few products per row, the rows are accumulated
+    # in hash tables; the transposed product uses the dense accumulator.
+    np.random.seed(1234)
+    n = 2**21
+    # a few dense rows at the end
+    a = scipy.sparse.vstack([
+        scipy.sparse.random(3000, 2000, density=0.002),
+        scipy.sparse.random(3, 2000, density=0.5)], format='csr')
+    b = scipy.sparse.random(2000, n, density=2e-5, format='csr')
+    b.data = np.random.randint(-1, 2, size=b.nnz).astype(float)
+
+    with scipy.sparse.set_workers(workers):
+        c = a.dot(b)
+    expected = b.T.tocsr().dot(a.T.tocsr()).T.tocsr()
+
+    assert_equal(c.nnz, expected.nnz)
+    c.sort_indices()
+    expected.sort_indices()
+    assert_equal(c.indptr, expected.indptr)
+    assert_equal(c.indices, expected.indices)
+    assert_allclose(c.data, expected.data)
+
+
+@pytest.mark.parametrize('workers', [1, 3])
+def test_csr_matmat_masked(workers):
+    np.random.seed(1234)
+    a = scipy.sparse.random(3000, 400, density=0.05, format='csr')
+    b = scipy.sparse.random(400, 2000, density=0.05, format='csr')
+    mask = scipy.sparse.random(3000, 2000, density=0.01, format='csr')
+    M, N = mask.shape
+
+    data = np.empty(mask.nnz)
+    _sparsetools.csr_matmat_masked(M, N, a.indptr, a.indices, a.data,
+                                   b.indptr, b.indices, b.data,
+                                   mask.indptr, mask.indices, data, workers)
+    c = csr_matrix((data, mask.indices, mask.indptr), shape=(M, N))
+
+    expected = a.dot(b).toarray() * (mask.toarray() != 0)
+    assert_allclose(c.toarray(), expected)
+
+
+@pytest.mark.parametrize('blocksize', [2, 3, 4, 5, 6, 8])
+def test_bsr_fixed_blocksize_kernels(blocksize):
+    # Square blocks of common sizes use specialized kernels
+    np.random.seed(1234)
+    n = 40 * blocksize
+    a = scipy.sparse.random(n, n, density=0.05).toarray()
+    b = scipy.sparse.random(n, n, density=0.05).toarray()
+    a_bsr = bsr_matrix(a, blocksize=(blocksize, blocksize))
+    b_bsr = bsr_matrix(b, blocksize=(blocksize, blocksize))
+    x = np.random.rand(n)
+    X = np.random.rand(n, 3)
+
+    assert_allclose(a_bsr.dot(x), a.dot(x))
+    assert_allclose(a_bsr.dot(X), a.dot(X))
+    assert_allclose((a_bsr * b_bsr).toarray(), a.dot(b))
+
+@pytest.mark.parametrize('C, sigma', [(1, 1), (3, 6), (4, None), (8, 1),
+                                      (16, None), (32, 64)])
+def test_sell_matvec(C, sigma):
+    from scipy.sparse._sell import _sell_matrix
+
+    np.random.seed(1234)
+    A = scipy.sparse.random(300, 200, density=0.05, format='csr')
+    # uneven rows and some empty ones
+    A = scipy.sparse.vstack([A, csr_matrix((7, 200)),
+                             scipy.sparse.random(20, 200, density=0.5)])
+    x = np.random.rand(200)
+    S = _sell_matrix(A, C=C, sigma=sigma)
+    assert_equal(S.shape, A.shape)
+    assert_allclose(S.matvec(x), A.dot(x), rtol=1e-12)
+    assert_allclose(S.dot(x[:, None]), A.dot(x[:, None]), rtol=1e-12)
+    assert_allclose(S.matvec(x, workers=3), A.dot(x), rtol=1e-12)
+
+    # complex vector with real matrix upcasts
+    xc = x + 1j
+    assert_allclose(S.matvec(xc), A.dot(xc), rtol=1e-12)
+
+    assert_raises(ValueError, S.matvec, np.ones(199))
+
+
+@pytest.mark.parametrize('workers', [2, 7])
+def test_tocsc_tocsr_threaded(workers):
+    np.random.seed(1234)
+    # many more entries than columns, so that the threaded path is taken
+    A = scipy.sparse.random(20000, 300, density=0.05, format='csr')
+    B0 = A.tocsc()
+    C0 = B0.tocsr()
+    with scipy.sparse.set_workers(workers):
+        B = A.tocsc()
+        C = B.tocsr()
+
+    for X, X0 in [(B, B0), (C, C0)]:
+        assert_equal(X.indptr, X0.indptr)
+        assert_equal(X.indices, X0.indices)
+        assert_equal(X.data, X0.data)
+        assert_(X.has_sorted_indices)
+
+
+@pytest.mark.parametrize('workers', [1, 3])
+@pytest.mark.parametrize('shape', [(50, 100000), (3000, 40)])
+def test_coo_tocsr_canonical(workers, shape):
+    np.random.seed(1234)
+    M, N = shape
+    nnz = 200000
+    row = np.random.randint(0, M, size=nnz)
+    col = np.random.randint(0, N, size=nnz)
+    data = np.random.randint(-3, 4, size=nnz).astype(float)
+    A = coo_matrix((data, (row, col)), shape=shape)
+
+    # reference: sum duplicates in a canonical COO first
+    B = coo_matrix((data, (row, col)), shape=shape)
+    B.sum_duplicates()
+
+    with scipy.sparse.set_workers(workers):
+        for X, X0 in [(A.tocsr(), B.tocsr()), (A.tocsc(), B.tocsc())]:
+            assert_(X.has_canonical_format)
+            X0.sort_indices()
+            assert_equal(X.indptr, X0.indptr)
+            assert_equal(X.indices, X0.indices)
+            assert_equal(X.data, X0.data)
+            assert_equal(len(X.data), X.nnz)
+
+
+@pytest.mark.parametrize('workers', [1, 3])
+def test_sort_indices_radix(workers):
+    np.random.seed(1234)
+    # long rows take the radix sort path, short ones insertion sort
+    A = scipy.sparse.random(200, 5000, density=0.2, format='csr')
+    A = scipy.sparse.vstack([A, scipy.sparse.random(2000, 5000,
+                                                    density=0.002)]).tocsr()
+    perm = [np.random.permutation(A.indptr[i+1] - A.indptr[i])
+            for i in range(A.shape[0])]
+    indices = np.concatenate([A.indices[A.indptr[i]:A.indptr[i+1]][p]
+                              for i, p in enumerate(perm)])
+    data = np.concatenate([A.data[A.indptr[i]:A.indptr[i+1]][p]
+                           for i, p in enumerate(perm)])
+    B = csr_matrix((data, indices, A.indptr), shape=A.shape)
+    assert_(not B.has_sorted_indices)
+
+    with scipy.sparse.set_workers(workers):
+        B.sort_indices()
+    assert_equal(B.indices, A.indices)
+    assert_equal(B.data, A.data)
+
+    blocks = np.random.rand(len(data), 2, 3)
+    Ab = bsr_matrix((blocks, indices, A.indptr),
+                    shape=(2 * A.shape[0], 3 * A.shape[1]))
+    expected = Ab.toarray()
+    Ab.has_sorted_indices = False
+    with scipy.sparse.set_workers(workers):
+        Ab.sort_indices()
+    assert_equal(Ab.indices, A.indices)
+    assert_equal(Ab.toarray(), expected)
+
+
+def test_csr_matvec_batch():
+    from scipy.sparse._batch import _csr_batch
+
+    np.random.seed(1234)
+    shapes = [(np.random.randint(1, 20), np.random.randint(1, 20))
+              for j in range(200)]
+    mats = [scipy.sparse.random(m, n, density=0.3, format='csr')
+            for m, n in shapes]
+    batch = _csr_batch(mats)
+    assert_equal(len(batch), len(mats))
+
+    xs = [np.random.rand(n) for m, n in shapes]
+    for workers in [1, 4]:
+        ys = batch.matvec(xs, workers=workers)
+        for A, x, y in zip(mats, xs, ys):
+            assert_allclose(y, A.dot(x), rtol=1e-13)
+
+    y = batch.matvec(np.concatenate(xs))
+    assert_allclose(y, np.concatenate([A.dot(x) for A, x in zip(mats, xs)]),
+                    rtol=1e-13)
+    assert_raises(ValueError, batch.matvec, xs[:-1])
+
+    # uniform shapes give stacked 2-D results
+    mats = [scipy.sparse.random(10, 7, density=0.3) for j in range(50)]
+    X = np.random.rand(50, 7) + 1j
+    Y = _csr_batch(mats).matvec(X)
+    assert_equal(Y.shape, (50, 10))
+    assert_allclose(Y, [A.dot(x) for A, x in zip(mats, X)], rtol=1e-13)
+
+
+@pytest.mark.parametrize('fmt', ['csr', 'csc', 'bsr'])
+def test_binop_threaded(fmt):
+    np.random.seed(1234)
+    A = scipy.sparse.random(4000, 300, density=0.05, format=fmt)
+    B = scipy.sparse.random(4000, 300, density=0.05, format=fmt)
+    if fmt == 'bsr':
+        A = A.tobsr(blocksize=(2, 3))
+        B = B.tobsr(blocksize=(2, 3))
+    B = B + A * 0.5
+
+    ops = [lambda x, y: x + y,
+           lambda x, y: x - y,
+           lambda x, y: x.multiply(y),
+           lambda x, y: x.maximum(y),
+           lambda x, y: x.minimum(y),
+           lambda x, y: x != y,
+           lambda x, y: x < y,
+           lambda x, y: x >= y]
+    for op in ops:
+        expected = op(A, B)
+        with scipy.sparse.set_workers(3):
+            result = op(A, B)
+        assert_equal(result.format, expected.format)
+        assert_equal(result.nnz, expected.nnz)
+        assert_equal(result.toarray(), expected.toarray())
+
+    # unsorted indices take the general path
+    order = np.concatenate([np.arange(A.indptr[i], A.indptr[i+1])[::-1]
+                            for i in range(len(A.indptr) - 1)])
+    A.indices = A.indices[order]
+    A.data = A.data[order]
+    A.has_sorted_indices = False
+    with scipy.sparse.set_workers(3):
+        assert_equal((A + B).toarray(), A.toarray() + B.toarray())
+
+
+def test_csc_matvec_threaded():
+    # also covers A.T @ x for CSR A, which uses the CSC view
+    np.random.seed(1234)
+    A = scipy.sparse.random(500, 20000, density=0.01, format='csr')
+    x = np.random.rand(500)
+    X = np.random.rand(500, 3)
+    y0 = A.T.dot(x)
+    Y0 = A.T.dot(X)
+    for workers in [2, 5]:
+        with scipy.sparse.set_workers(workers):
+            assert_allclose(A.T.dot(x), y0, rtol=1e-13)
+            assert_allclose(A.T.dot(X), Y0, rtol=1e-13)
+
+
+@pytest.mark.parametrize('dtype', [np.float64, np.complex128])
+def test_csr_fused_matvec(dtype):
+    np.random.seed(1234)
+    n = 5000
+    A = scipy.sparse.random(n, n, density=1e-3, format='csr').astype(dtype)
+    if dtype == np.complex128:
+        A = A + 1j * A
+    x = np.random.rand(n).astype(dtype)
+    z = np.random.rand(n).astype(dtype)
+    if dtype == np.complex128:
+        x += 1j * np.random.rand(n)
+    y0 = A.dot(x)
+
+    for workers in [1, 3]:
+        with scipy.sparse.set_workers(workers):
+            y, d = A._matvec_dot(x)
+            assert_allclose(y, y0, rtol=1e-13)
+            assert_allclose(d, np.vdot(x, y0), rtol=1e-12)
+
+            w = A._matvec_axpby(x, 2.0, -0.5, z)
+            assert_allclose(w, 2.0 * y0 - 0.5 * z, rtol=1e-13)
+            out = z.copy()
+            A._matvec_axpby(x, 2.0, -0.5, out, out=out)
+            assert_allclose(out, w, rtol=1e-13)
+
+    assert_raises(ValueError, A[:10]._matvec_dot, x)
+
+
+@pytest.mark.parametrize('dtype', [np.float32, np.complex64])
+def test_csr_matvec_mixed(dtype):
+    # single precision data is summed in double precision, which gives
+    # exactly the product with a double precision copy
+    np.random.seed(1234)
+    n = 5000
+    A = scipy.sparse.random(n, n, density=1e-3, format='csr').astype(dtype)
+    if dtype == np.complex64:
+        A = A - 1j * A
+    B = A.astype(np.result_type(dtype, np.float64))
+    x = np.random.rand(n)
+    X = np.random.rand(n, 3)
+
+    for workers in [1, 3]:
+        with scipy.sparse.set_workers(workers):
+            assert_equal(A.dot(x), B.dot(x))
+            assert_equal(A.dot(X), B.dot(X))
+
+    # 64-bit row pointer with 32-bit column indices
+    y0 = B.dot(x)
+    y = np.zeros(n, dtype=y0.dtype)
+    _sparsetools.csr_matvec_mixed(n, n, A.indptr.astype(np.int64),
+                                  A.indices.astype(np.int32), A.data, x, y,
+                                  1)
+    assert_equal(y, y0)
+
+
+@pytest.mark.parametrize('fmt', ['csr', 'csc'])
+def test_sample_threaded(fmt):
+    np.random.seed(1234)
+    n = 2000
+    A = scipy.sparse.random(n, n, density=1e-2, format=fmt)
+    D = A.toarray()
+    rows = np.random.randint(-n, n, size=100000)
+    cols = np.random.randint(-n, n, size=100000)
+    order = np.lexsort((cols % n, rows % n))
+
+    for workers in [1, 3]:
+        with scipy.sparse.set_workers(workers):
+            assert_equal(A[rows, cols], np.asmatrix(D[rows, cols]))
+            # sorted samples take the merging search
+            r, c = rows[order], cols[order]
+            assert_equal(A[r, c], np.asmatrix(D[r, c]))
+
+            # assignment to existing entries only
+            r, c = A.nonzero()
+            B = A.copy()
+            B[r, c] = 5
+            assert_equal(B.toarray(), np.where(D != 0, 5, 0))
+
+
+def test_csr_row_blocks():
+    np.random.seed(1234)
+    A = scipy.sparse.random(30000, 500, density=0.02, format='csr')
+    rows = np.random.randint(-30000, 30000, size=70000)
+
+    for workers in [1, 3]:
+        blocks = list(A._iter_row_blocks(32768, rows, workers=workers))
+        assert_equal([B.shape for B in blocks],
+                     [(32768, 500), (32768, 500), (4464, 500)])
+        B = scipy.sparse.vstack(blocks)
+        assert_equal(B.toarray(), A[rows].toarray())
+
+        with scipy.sparse.set_workers(workers):
+            assert_equal(A[rows].toarray(), A.toarray()[rows])
+
+    blocks = list(A._iter_row_blocks(10000))
+    assert_equal(len(blocks), 3)
+    assert_equal(scipy.sparse.vstack(blocks).toarray(), A.toarray())
+    assert_equal(list(A._iter_row_blocks(10, [])), [])
+    assert_raises(IndexError, next, A._iter_row_blocks(10, [30000]))
+
+
+def test_dia_matvec_threaded():
+    # 7-point stencil; tiling and threads don't change the result
+    n = 100000
+    offsets = [-2000, -50, -1, 0, 1, 50, 2000]
+    np.random.seed(1234)
+    data = np.random.rand(len(offsets), n)
+    A = dia_matrix((data, offsets), shape=(n, n - 10))
+    x = np.random.rand(n - 10)
+
+    y0 = np.zeros(n)
+    _sparsetools.dia_matvec(n, n - 10, len(offsets), n, A.offsets, A.data,
+                            x, y0)
+    for workers in [1, 3]:
+        with scipy.sparse.set_workers(workers):
+            assert_equal(A.dot(x), y0)
+    assert_allclose(y0, A.tocsr().dot(x), rtol=1e-13)
+
+
+@pytest.mark.parametrize('n_vecs', [5, 32, 70])
+def test_csr_matvecs_tiled(n_vecs):
+    np.random.seed(1234)
+    A = scipy.sparse.random(3000, 2000, density=0.01, format='csr')
+    X = np.random.rand(2000, n_vecs)
+    Y0 = np.zeros((3000, n_vecs))
+    _sparsetools.csr_matvecs(3000, 2000, n_vecs, A.indptr, A.indices, A.data,
+                             X.ravel(), Y0.ravel())
+
+    for workers in [1, 3]:
+        with scipy.sparse.set_workers(workers):
+            assert_equal(A.dot(X), Y0)
+            assert_equal(A.dot(np.asfortranarray(X)), Y0)
+            assert_equal(A.dot(X.T.copy().T), Y0)
+
+
+def test_symmetric_csr_matvec():
+    from scipy.sparse._symmetric import _symmetric_csr
+
+    np.random.seed(1234)
+    n = 20000
+    B = scipy.sparse.random(n, n, density=5e-4, format='csr')
+    A = (B + B.T + scipy.sparse.eye(n)).tocsr()
+    S = _symmetric_csr(A)
+    assert_(S.data.size < A.nnz)
+    x = np.random.rand(n)
+
+    for workers in [1, 3]:
+        assert_allclose(S.matvec(x, workers=workers), A.dot(x), rtol=1e-13)
+    assert_equal(S.dot(x[:, None]).shape, (n, 1))
+    assert_raises(ValueError, _symmetric_csr, B)
+
+
+
+@pytest.mark.parametrize('fmt', ['csr', 'csc'])
+def test_axis_reductions(fmt):
+    # explicit zeros, and full and empty lines along both axes
+    np.random.seed(1234)
+    A = scipy.sparse.random(20000, 300, density=0.03, format='csr',
+                            data_rvs=lambda n: np.random.randint(-3, 4, n))
+    A = scipy.sparse.vstack([A, np.arange(-150, 150).reshape(1, 300)])
+    A = scipy.sparse.hstack([A, -np.ones((20001, 1))], format=fmt)
+    A.data[::7] = 0
+    D = A.toarray()
+    P = A.copy()
+    P.data[:] = 1
+    P = P.toarray()
+
+    for workers in [1, 3]:
+        with scipy.sparse.set_workers(workers):
+            for axis in [0, 1]:
+                assert_equal(A.sum(axis=axis), D.sum(axis=axis, keepdims=True))
+                assert_equal(A.max(axis=axis).toarray(),
+                             D.max(axis=axis, keepdims=True))
+                assert_equal(A.min(axis=axis).toarray(),
+                             D.min(axis=axis, keepdims=True))
+                assert_equal(np.asarray(A.argmax(axis=axis)).ravel(),
+                             D.argmax(axis=axis))
+                assert_equal(np.asarray(A.argmin(axis=axis)).ravel(),
+                             D.argmin(axis=axis))
+                assert_equal(A.getnnz(axis=axis), P.sum(axis=axis))
+
+    # NaNs win, and the first one is picked
+    B = csr_matrix([[0, np.nan, 1, np.nan], [0, 0, -1, 0]]).asformat(fmt)
+    for axis in [0, 1]:
+        D = B.toarray()
+        assert_equal(B.max(axis=axis).toarray(),
+                     np.max(D, axis=axis, keepdims=True))
+        assert_equal(np.asarray(B.argmax(axis=axis)).ravel(),
+                     np.argmax(D, axis=axis))
+        assert_equal(np.asarray(B.argmin(axis=axis)).ravel(),
+                     np.argmin(D, axis=axis))
+
+
+def test_set_workers():
+    assert_equal(scipy.sparse.get_workers(), 1)
+    with scipy.sparse.set_workers(-1):
+        assert_equal(scipy.sparse.get_workers(), os.cpu_count() or 1)
+        with scipy.sparse.set_workers(3):
+            assert_equal(scipy.sparse.get_workers(), 3)
+        assert_equal(scipy.sparse.get_workers(), os.cpu_count() or 1)
+    assert_equal(scipy.sparse.get_workers(), 1)
+
+    with assert_raises(ValueError):
+        with scipy.sparse.set_workers(0):
+            pass
+    with assert_raises(ValueError):
+        with scipy.sparse.set_workers(-(os.cpu_count() or 1) - 1):
+            pass
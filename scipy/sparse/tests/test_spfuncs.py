@@ -1,8 +1,10 @@
 from __future__ import division, print_function, absolute_import
 
+import numpy as np
 from numpy import array, kron, diag
 from numpy.testing import assert_, assert_equal
 
+from scipy import sparse
 from scipy.sparse import spfuncs
 from scipy.sparse import csr_matrix, csc_matrix, bsr_matrix
 from scipy.sparse._sparsetools import (csr_scale_rows, csr_scale_columns,
@@ -71,6 +73,36 @@ class TestSparseFunctions(object):
                 assert_(r >= B.shape[0])
                 assert_(c >= B.shape[1])
 
+    def test_estimate_blocksize_fem(self):
+        # a pattern of 3x3 blocks, as from 3 unknowns per node, and the
+        # same with a few stray nonzeros
+        P = sparse.random(400, 400, density=0.02, format='csr',
+                          random_state=np.random.RandomState(1234))
+        X = sparse.kron(P, np.ones((3, 3)), format='csr')
+        assert_equal(spfuncs.estimate_blocksize(X), (3, 3))
+        assert_equal(spfuncs.estimate_blocksize(X.tocsc()), (3, 3))
+        assert_equal(X.tobsr().blocksize, (3, 3))
+
+        Y = X + sparse.eye(1200, format='csr')
+        assert_equal(spfuncs.estimate_blocksize(Y), (3, 3))
+
+        Z = sparse.random(1200, 1200, density=0.01, format='csr',
+                          random_state=np.random.RandomState(1234))
+        assert_equal(spfuncs.estimate_blocksize(Z), (1, 1))
+
+    def test_tobsr_threaded(self):
+        A = sparse.random(3000, 2400, density=0.02, format='csr',
+                          random_state=np.random.RandomState(1234))
+        for blocksize in [(1, 1), (2, 3), (4, 4), (3, 8)]:
+            B = A.tobsr(blocksize)
+            with sparse.set_workers(4):
+                Bt = A.tobsr(blocksize)
+            assert_equal(Bt.blocksize, blocksize)
+            assert_equal(Bt.indptr, B.indptr)
+            assert_equal(Bt.indices, B.indices)
+            assert_equal(Bt.data, B.data)
+            assert_equal(Bt.toarray(), A.toarray())
+
     def test_count_blocks(self):
         def gold(A,bs):
             R,C = bs
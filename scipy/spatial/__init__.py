@@ -17,6 +17,7 @@ Nearest-neighbor Queries
 
    KDTree      -- class for efficient nearest-neighbor queries
    cKDTree     -- class for efficient nearest-neighbor queries (faster impl.)
+   DynamicKDTree -- kd-tree with insertion and deletion of points
    Rectangle
 
 Distance metrics are contained in the :mod:`scipy.spatial.distance` submodule.
@@ -96,6 +97,7 @@ from __future__ import division, print_function, absolute_import
 
 from .kdtree import *
 from .ckdtree import *
+from ._dynamic_kdtree import DynamicKDTree
 from .qhull import *
 from ._spherical_voronoi import SphericalVoronoi
 from ._plotutils import *
@@ -0,0 +1,369 @@
+"""
+A kd-tree with insertion and deletion of points, built from static
+cKDTrees.
+"""
+
+from __future__ import division, print_function, absolute_import
+
+import numpy as np
+
+from .ckdtree import cKDTree
+
+
+__all__ = ['DynamicKDTree']
+
+
+# a block is rebuilt without its removed points once they are more than
+# this fraction of it
+_MAX_DEAD_FRACTION = 0.25
+
+
+class _Block(object):
+    """A static cKDTree over some of the points, with removed points marked
+    as dead. ``ids`` is sorted."""
+
+    def __init__(self, ids, data, tree_kwargs):
+        self.ids = ids
+        self.data = data
+        self.tree = cKDTree(data, **tree_kwargs)
+        self.alive = np.ones(len(ids), dtype=bool)
+        self.n_dead = 0
+
+    @property
+    def n_alive(self):
+        return len(self.ids) - self.n_dead
+
+    def query(self, x, k, eps, p, distance_upper_bound, n_jobs):
+        """The k nearest live points of each row of x, as distances and ids,
+        padded with inf and -1."""
+        n_total = len(self.ids)
+        nx = x.shape[0]
+        dd = np.full((nx, k), np.inf)
+        ii = np.full((nx, k), -1, dtype=np.intp)
+
+        # Dead points are skipped by asking for more neighbors; rows that
+        # still come up short are queried again with twice as many.
+        todo = np.arange(nx)
+        kq = min(n_total, k if self.n_dead == 0 else 2 * k + 1)
+        while todo.size:
+            d, i = self.tree.query(x[todo], k=np.arange(1, kq + 1), eps=eps,
+                                   p=p,
+                                   distance_upper_bound=distance_upper_bound,
+                                   n_jobs=n_jobs)
+            found = i < n_total
+            alive = found.copy()
+            alive[found] = self.alive[i[found]]
+            done = ((alive.sum(axis=1) >= k) | ~found[:, -1] |
+                    (kq == n_total))
+
+            # the first k live neighbors of the finished rows, in order; a
+            # block of fewer than k points leaves the padding in place
+            rows = np.arange(done.sum())[:, np.newaxis]
+            order = np.argsort(~alive[done], axis=1, kind='mergesort')[:, :k]
+            d = np.where(alive, d, np.inf)[done][rows, order]
+            i = np.where(alive, i, 0)[done][rows, order]
+            dd[todo[done], :d.shape[1]] = d
+            ii[todo[done], :d.shape[1]] = np.where(np.isinf(d), -1,
+                                                   self.ids[i])
+
+            todo = todo[~done]
+            kq = min(n_total, 2 * kq)
+        return dd, ii
+
+    def query_ball_point(self, x, r, p, eps):
+        """The ids of the live points within r of the single point x"""
+        rows = np.asarray(self.tree.query_ball_point(x, r, p=p, eps=eps),
+                          dtype=np.intp)
+        return self.ids[rows[self.alive[rows]]]
+
+    def compacted(self, tree_kwargs):
+        """A new block over the live points"""
+        return _Block(self.ids[self.alive], self.data[self.alive],
+                      tree_kwargs)
+
+
+def _merge(block1, block2, tree_kwargs):
+    """A new block over the live points of block1 and then block2"""
+    return _Block(np.concatenate((block1.ids[block1.alive],
+                                  block2.ids[block2.alive])),
+                  np.concatenate((block1.data[block1.alive],
+                                  block2.data[block2.alive])),
+                  tree_kwargs)
+
+
+class DynamicKDTree(object):
+    """
+    DynamicKDTree(data, leafsize=16, compact_nodes=True, balanced_tree=True,
+                  boxsize=None)
+
+    kd-tree for nearest-neighbor lookup in a changing set of points
+
+    Points can be inserted and removed at any time. Each point is known by
+    an integer id, which is returned when it is inserted and never reused.
+
+    Parameters
+    ----------
+    data : array_like, shape (n,m)
+        The initial points, which get the ids ``0, ..., n-1``. May be empty,
+        but must be 2-D, to give the dimension m.
+    leafsize, compact_nodes, balanced_tree, boxsize : optional
+        Passed on to the `cKDTree` instances that hold the points.
+
+    Attributes
+    ----------
+    n : int
+        The number of points.
+    m : int
+        The dimension of a single point.
+
+    See Also
+    --------
+    cKDTree : Static kd-tree
+
+    Notes
+    -----
+    The points are held in a few static `cKDTree` instances of
+    geometrically decreasing sizes ([1]_). New points go into a new tree,
+    which is merged with the trees of about its size, so that a point is
+    rebuilt into a new tree only O(log(n)) times. Removed points are marked
+    as dead and skipped by the queries. A tree is rebuilt without them once
+    they make up a quarter of it.
+
+    Queries ask each tree for enough neighbors to make up for its dead
+    points, and merge the results, so they give the same distances as a
+    `cKDTree` over the current points. With many small trees, or when most
+    points are in one tree anyway, a `cKDTree` rebuilt from scratch may be
+    as fast.
+
+    .. versionadded:: 1.4.0
+
+    References
+    ----------
+    .. [1] J. L. Bentley and J. B. Saxe, "Decomposable searching problems
+           I. Static-to-dynamic transformation", Journal of Algorithms 1,
+           pp. 301-358, 1980.
+
+    Examples
+    --------
+    >>> from scipy.spatial import DynamicKDTree
+    >>> tree = DynamicKDTree([[0., 0.], [1., 0.], [2., 0.]])
+    >>> tree.query([1.9, 0.])
+    (0.1..., 2)
+    >>> ids = tree.insert([[1.9, 0.1]])
+    >>> tree.remove([2])
+    >>> tree.query([1.9, 0.])
+    (0.1..., 3)
+
+    """
+
+    def __init__(self, data, leafsize=16, compact_nodes=True,
+                 balanced_tree=True, boxsize=None):
+        data = np.array(data, dtype=np.float64)
+        if data.ndim != 2:
+            raise ValueError("data must be 2 dimensions")
+
+        self.m = data.shape[1]
+        self._tree_kwargs = dict(leafsize=leafsize,
+                                 compact_nodes=compact_nodes,
+                                 balanced_tree=balanced_tree,
+                                 boxsize=boxsize)
+        self._blocks = []
+        self._next_id = 0
+        self.insert(data)
+
+    @property
+    def n(self):
+        return sum(block.n_alive for block in self._blocks)
+
+    def insert(self, points):
+        """
+        insert(self, points)
+
+        Add points to the tree
+
+        Parameters
+        ----------
+        points : array_like, shape (n_new,m) or (m,)
+            The points to add.
+
+        Returns
+        -------
+        ids : ndarray of ints, shape (n_new,)
+            The ids of the new points.
+
+        """
+        points = np.array(points, dtype=np.float64, ndmin=2)
+        if points.ndim != 2 or points.shape[1] != self.m:
+            raise ValueError("points must have shape (n, %d)" % self.m)
+
+        ids = np.arange(self._next_id, self._next_id + points.shape[0],
+                        dtype=np.intp)
+        self._next_id += points.shape[0]
+        if points.shape[0] > 0:
+            self._blocks.append(_Block(ids, points, self._tree_kwargs))
+            self._merge_blocks()
+        return ids
+
+    def remove(self, ids):
+        """
+        remove(self, ids)
+
+        Remove points from the tree
+
+        Parameters
+        ----------
+        ids : array_like of ints
+            The ids of the points to remove.
+
+        Raises
+        ------
+        ValueError
+            If a point is not in the tree; no point is removed then.
+
+        """
+        ids = np.unique(np.asarray(ids, dtype=np.intp))
+        if ids.size == 0:
+            return
+
+        # the blocks hold consecutive ranges of ids, in order
+        first_ids = np.array([block.ids[0] for block in self._blocks],
+                             dtype=np.intp)
+        which = np.searchsorted(first_ids, ids, side='right') - 1
+        found = []
+        for b in np.unique(which):
+            block_ids = ids[which == b]
+            if b < 0:
+                raise ValueError("id %d is not in the tree" % block_ids[0])
+            block = self._blocks[b]
+            rows = np.searchsorted(block.ids, block_ids)
+            rows_ok = rows < len(block.ids)
+            rows_ok[rows_ok] = block.ids[rows[rows_ok]] == block_ids[rows_ok]
+            rows_ok[rows_ok] = block.alive[rows[rows_ok]]
+            if not rows_ok.all():
+                raise ValueError("id %d is not in the tree"
+                                 % block_ids[~rows_ok][0])
+            found.append((block, rows))
+
+        for block, rows in found:
+            block.alive[rows] = False
+            block.n_dead += len(rows)
+
+        blocks = []
+        for block in self._blocks:
+            if block.n_alive == 0:
+                continue
+            if block.n_dead > _MAX_DEAD_FRACTION * len(block.ids):
+                block = block.compacted(self._tree_kwargs)
+            blocks.append(block)
+        self._blocks = blocks
+        self._merge_blocks()
+
+    def _merge_blocks(self):
+        # merge neighboring blocks until each is more than twice the size
+        # of the next one
+        blocks = self._blocks
+        i = len(blocks) - 1
+        while i > 0:
+            if blocks[i - 1].n_alive <= 2 * blocks[i].n_alive:
+                blocks[i - 1:i + 1] = [_merge(blocks[i - 1], blocks[i],
+                                              self._tree_kwargs)]
+            i -= 1
+
+    def query(self, x, k=1, eps=0, p=2, distance_upper_bound=np.inf,
+              n_jobs=1):
+        """
+        query(self, x, k=1, eps=0, p=2, distance_upper_bound=np.inf, n_jobs=1)
+
+        Query the tree for nearest neighbors
+
+        The parameters are those of `cKDTree.query`.
+
+        Returns
+        -------
+        d : array of floats
+            The distances to the nearest neighbors, with the shape of the
+            result of `cKDTree.query`. Missing neighbors are indicated with
+            infinite distances.
+        i : ndarray of ints
+            The ids of the neighbors. Missing neighbors are indicated with
+            -1.
+
+        """
+        x = np.asarray(x, dtype=np.float64)
+        if x.ndim == 0 or x.shape[-1] != self.m:
+            raise ValueError("x must consist of vectors of length %d but "
+                             "has shape %s" % (self.m, np.shape(x)))
+
+        nearest = False
+        if np.isscalar(k):
+            nearest = k == 1
+            k = np.arange(1, k + 1)
+        k = np.asarray(k, dtype=np.intp)
+        kmax = np.max(k)
+
+        retshape = x.shape[:-1]
+        xx = x.reshape(-1, self.m)
+
+        dd = []
+        ii = []
+        for block in self._blocks:
+            d, i = block.query(xx, kmax, eps, p, distance_upper_bound,
+                               n_jobs)
+            dd.append(d)
+            ii.append(i)
+        # padding for an empty tree
+        dd.append(np.full((xx.shape[0], kmax), np.inf))
+        ii.append(np.full((xx.shape[0], kmax), -1, dtype=np.intp))
+        dd = np.hstack(dd)
+        ii = np.hstack(ii)
+
+        # the kmax nearest over all blocks, older points first on ties
+        rows = np.arange(xx.shape[0])[:, np.newaxis]
+        order = np.argsort(dd, axis=1, kind='mergesort')[:, k - 1]
+        dd = dd[rows, order].reshape(retshape + (len(k),))
+        ii = ii[rows, order].reshape(retshape + (len(k),))
+
+        if nearest:
+            dd = dd[..., 0]
+            ii = ii[..., 0]
+            if x.ndim == 1:
+                dd = float(dd)
+                ii = int(ii)
+        return dd, ii
+
+    def query_ball_point(self, x, r, p=2., eps=0):
+        """
+        query_ball_point(self, x, r, p=2., eps=0)
+
+        Find all points within distance r of point(s) x
+
+        The parameters are those of `cKDTree.query_ball_point`, except that
+        r is a single distance.
+
+        Returns
+        -------
+        results : list or array of lists
+            If `x` is a single point, returns a sorted list of the ids of
+            the neighbors of `x`. If `x` is an array of points, returns an
+            object array of shape tuple containing lists of neighbors.
+
+        """
+        x = np.asarray(x, dtype=np.float64)
+        if x.ndim == 0 or x.shape[-1] != self.m:
+            raise ValueError("x must consist of vectors of length %d but "
+                             "has shape %s" % (self.m, np.shape(x)))
+
+        def neighbors(point):
+            found = [block.query_ball_point(point, r, p, eps)
+                     for block in self._blocks]
+            return sorted(np.concatenate(found + [[]]).astype(np.intp)
+                          .tolist())
+
+        if x.ndim == 1:
+            return neighbors(x)
+
+        retshape = x.shape[:-1]
+        result = np.empty(retshape, dtype=object)
+        for c in np.ndindex(retshape):
+            result[c] = neighbors(x[c])
+        return result
@@ -1,3 +1,4 @@
+# distutils: language = c++
 """
 Directed Hausdorff Code
 
@@ -17,55 +18,71 @@ cimport numpy as np
 cimport cython
 from libc.math cimport sqrt
 
+from scipy.spatial.ckdtree import cKDTree
+
 __all__ = ['directed_hausdorff']
 
+cdef extern from "hausdorff.h":
+    void directed_hausdorff_kernel(const double *u, const np.intp_t *u_index,
+                                   const np.intp_t *start, np.intp_t n_u,
+                                   const double *v, const np.intp_t *v_index,
+                                   np.intp_t n_v, np.intp_t dims, int workers,
+                                   double *cmax, np.intp_t *i,
+                                   np.intp_t *j) nogil except +
+
+# Below this many points in ar2, a linear scan is as quick as building
+# the tree
+DEF TREE_MIN_POINTS = 64
+
+
 @cython.boundscheck(False)
-def directed_hausdorff(double[:,::1] ar1, double[:,::1] ar2, seed=0):
-
-    cdef double cmax, cmin, d
-    cdef bint no_break_occurred
-    cdef int N1 = ar1.shape[0]
-    cdef int N2 = ar2.shape[0]
-    cdef int data_dims = ar1.shape[1]
-    cdef unsigned int i, j, k
-    cdef unsigned int i_store = 0, j_store = 0, i_ret = 0, j_ret = 0
-    cdef long[:] resort1, resort2
-
-    # shuffling the points in each array generally increases the likelihood of
+def directed_hausdorff(double[:,::1] ar1, double[:,::1] ar2, seed=0,
+                       int workers=1):
+
+    cdef double cmax
+    cdef np.intp_t N1 = ar1.shape[0]
+    cdef np.intp_t N2 = ar2.shape[0]
+    cdef np.intp_t data_dims = ar1.shape[1]
+    cdef np.intp_t i_ret, j_ret
+    cdef np.intp_t[::1] resort1, resort2, start
+    cdef double[:, ::1] u, v
+
+    if N1 == 0 or N2 == 0:
+        raise ValueError('u and v must contain at least one point each')
+
+    # shuffling the outer points generally increases the likelihood of
     # an advantageous break in the inner search loop and never decreases the
     # performance of the algorithm
     rng = np.random.RandomState(seed)
-    resort1 = np.arange(N1)
-    resort2 = np.arange(N2)
+    resort1 = np.arange(N1, dtype=np.intp)
     rng.shuffle(resort1)
-    rng.shuffle(resort2)
-    ar1 = np.asarray(ar1)[resort1]
-    ar2 = np.asarray(ar2)[resort2]
-
-    cmax = 0
-    for i in range(N1):
-        no_break_occurred = True
-        cmin = np.inf
-        for j in range(N2):
-            d = 0
-	    # faster performance with square of distance
-	    # avoid sqrt until very end
-            for k in range(data_dims):
-                d += (ar1[i, k] - ar2[j, k])**2
-            if d < cmax: # break out of `for j` loop
-                no_break_occurred = False
-                break
-
-            if d < cmin: # always true on first iteration of for-j loop
-                cmin = d
-                i_store = i
-                j_store = j
-
-        # always true on first iteration of for-j loop, after that only
-        # if d >= cmax
-        if cmin != np.inf and cmin > cmax and no_break_occurred == True:
-            cmax = cmin
-            i_ret = i_store
-            j_ret = j_store
-
-    return (sqrt(cmax), resort1[i_ret], resort2[j_ret])
+    u_arr = np.asarray(ar1)[resort1]
+    v_arr = np.asarray(ar2)
+
+    # the inner points go in the leaf order of a kd-tree, and the scan for
+    # each outer point starts at its approximate nearest neighbour, which
+    # typically breaks the scan at once
+    if (N2 >= TREE_MIN_POINTS and data_dims > 0
+            and np.isfinite(u_arr).all() and np.isfinite(v_arr).all()):
+        tree = cKDTree(v_arr)
+        resort2 = tree.indices.astype(np.intp)
+        position = np.empty(N2, dtype=np.intp)
+        position[resort2] = np.arange(N2, dtype=np.intp)
+        start = position[tree.query(u_arr, eps=1., n_jobs=workers)[1]]
+    else:
+        resort2 = np.arange(N2, dtype=np.intp)
+        start = np.zeros(N1, dtype=np.intp)
+
+    u = u_arr
+    v = v_arr[resort2]
+
+    with nogil:
+        directed_hausdorff_kernel(&u[0, 0], &resort1[0], &start[0], N1,
+                                  &v[0, 0], &resort2[0], N2, data_dims,
+                                  workers, &cmax, &i_ret, &j_ret)
+
+    # only NaN or infinite distances
+    if i_ret < 0:
+        i_ret = j_ret = 0
+
+    return (sqrt(cmax), i_ret, j_ret)
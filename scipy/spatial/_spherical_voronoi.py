@@ -13,9 +13,8 @@ Spherical Voronoi Code
 
 import numpy as np
 import scipy
-import itertools
 from . import _voronoi
-from scipy.spatial.distance import pdist
+from scipy.spatial.distance import pdist, _workers
 
 __all__ = ['SphericalVoronoi']
 
@@ -124,6 +123,13 @@ class SphericalVoronoi:
     regions : list of list of integers of shape (npoints, _ )
         the n-th entry is a list consisting of the indices
         of the vertices belonging to the n-th point in points
+    region_indptr : ndarray of ints, shape (npoints + 1,)
+    region_indices : ndarray of ints
+        The regions in compressed sparse row form: the vertices of the n-th
+        region are ``region_indices[region_indptr[n]:region_indptr[n+1]]``.
+        For large diagrams this avoids building the lists of `regions`.
+
+        .. versionadded:: 1.4.0
 
     Raises
     ------
@@ -145,13 +151,13 @@ class SphericalVoronoi:
     approach is substantially less sensitive to floating point issues than
     angle-based methods of Voronoi region vertex sorting.
 
-    The surface area of spherical polygons is calculated by decomposing them
-    into triangles and using L'Huilier's Theorem to calculate the spherical
-    excess of each triangle [Weisstein]_. The sum of the spherical excesses is
+    The surface area of a region is calculated by decomposing it into the
+    triangles formed by its generator and each of its edges, and summing
+    the spherical excesses of the triangles, which are computed with the
+    formula of Van Oosterom and Strackee [VanOosterom]_. The sum is
     multiplied by the square of the sphere radius to obtain the surface area
-    of the spherical polygon. For nearly-degenerate spherical polygons an area
-    of approximately 0 is returned by default, rather than attempting the
-    unstable calculation.
+    of the spherical polygon. The regions are sorted and their areas
+    computed in compiled code, split over `workers` threads.
 
     Empirical assessment of spherical Voronoi algorithm performance suggests
     quadratic time complexity (loglinear is optimal, but algorithms are more
@@ -163,8 +169,9 @@ class SphericalVoronoi:
     ----------
     .. [Caroli] Caroli et al. Robust and Efficient Delaunay triangulations of
                 points on or close to a sphere. Research Report RR-7004, 2009.
-    .. [Weisstein] "L'Huilier's Theorem." From MathWorld -- A Wolfram Web
-                Resource. http://mathworld.wolfram.com/LHuiliersTheorem.html
+    .. [VanOosterom] Van Oosterom, A. and Strackee, J. The solid angle of a
+                plane triangle. IEEE Transactions on Biomedical Engineering,
+                BME-30 (2): 125-126, 1983.
 
     See Also
     --------
@@ -237,7 +244,10 @@ class SphericalVoronoi:
         if max_discrepancy >= threshold * self.radius:
             raise ValueError("Radius inconsistent with generators.")
         self.vertices = None
-        self.regions = None
+        self.region_indptr = None
+        self.region_indices = None
+        self._regions = None
+        self._areas = None
         self._tri = None
         self._calc_vertices_regions()
 
@@ -278,33 +288,45 @@ class SphericalVoronoi:
             self.radius
         )
 
-        # calculate regions from triangulation
-        # simplex_indices will have shape: (2N-4,)
-        simplex_indices = np.arange(self._tri.simplices.shape[0])
-        # tri_indices will have shape: (6N-12,)
-        tri_indices = np.column_stack([simplex_indices, simplex_indices,
-            simplex_indices]).ravel()
-        # point_indices will have shape: (6N-12,)
-        point_indices = self._tri.simplices.ravel()
-
-        # array_associations will have shape: (6N-12, 2)
-        array_associations = np.dstack((point_indices, tri_indices))[0]
-        array_associations = array_associations[np.lexsort((
-                                                array_associations[...,1],
-                                                array_associations[...,0]))]
-        array_associations = array_associations.astype(np.intp)
-
-        # group by generator indices to produce
-        # unsorted regions in nested list
-        groups = [list(list(zip(*list(g)))[1])
-                  for k, g in itertools.groupby(array_associations,
-                                                lambda t: t[0])]
-
-        self.regions = groups
-
-    def sort_vertices_of_regions(self):
+        # calculate regions from triangulation: the n-th region consists of
+        # the simplices (= Voronoi vertices) that contain the n-th point
+        self.region_indptr, self.region_indices = \
+            _voronoi.regions_from_simplices(self._tri.simplices,
+                                            self.points.shape[0])
+        self._regions = None
+
+    @property
+    def regions(self):
+        if self._regions is None:
+            self._regions = self._regions_list()
+        return self._regions
+
+    def _regions_list(self):
+        indptr = self.region_indptr.tolist()
+        indices = self.region_indices.tolist()
+        return [indices[indptr[n]:indptr[n+1]]
+                for n in range(len(indptr) - 1)]
+
+    def _sort_regions(self, indices, areas, workers):
+        # the regions in `indices` are sorted in place
+        _voronoi.sort_vertices_of_regions(
+            self._tri.simplices, self.region_indptr, indices,
+            np.ascontiguousarray(self.points, dtype=np.double),
+            np.ascontiguousarray(self.vertices, dtype=np.double),
+            np.ascontiguousarray(self.center, dtype=np.double),
+            float(self.radius), areas, _workers(workers))
+
+    def sort_vertices_of_regions(self, workers=None):
         """Sort indices of the vertices to be (counter-)clockwise ordered.
 
+        Parameters
+        ----------
+        workers : int, optional
+            Number of threads to sort the regions on. Negative values wrap
+            around from ``os.cpu_count()``. Default is 1.
+
+            .. versionadded:: 1.4.0
+
         Notes
         -----
         For each region in regions, it sorts the indices of the Voronoi
@@ -325,6 +347,41 @@ class SphericalVoronoi:
         through all the triangles (=Voronoi vertices) belonging to the
         generator in points and obtain a sorted version of the vertices
         of its surrounding region.
+
+        The areas of the regions are computed in the same pass, and kept
+        for `calculate_areas`. A list of `regions` that was already built
+        is updated in place.
         """
+        areas = np.empty(self.points.shape[0], dtype=np.double)
+        self._sort_regions(self.region_indices, areas, workers)
+        self._areas = areas
+        if self._regions is not None:
+            self._regions[:] = self._regions_list()
+
+    def calculate_areas(self, workers=None):
+        """Calculate the areas of the Voronoi regions.
+
+        Parameters
+        ----------
+        workers : int, optional
+            Number of threads to compute the areas on. Negative values wrap
+            around from ``os.cpu_count()``. Default is 1.
+
+        Returns
+        -------
+        areas : ndarray of floats, shape (npoints,)
+            The area of the region of each generator, on the sphere of
+            `radius`. They add up to the surface area of the sphere.
 
-        _voronoi.sort_vertices_of_regions(self._tri.simplices, self.regions)
+        Notes
+        -----
+        The regions do not need to be sorted; if they have not been, they
+        are sorted in a copy, which does not change `regions`.
+
+        .. versionadded:: 1.4.0
+        """
+        if self._areas is None:
+            areas = np.empty(self.points.shape[0], dtype=np.double)
+            self._sort_regions(self.region_indices.copy(), areas, workers)
+            self._areas = areas
+        return self._areas.copy()
@@ -1,3 +1,4 @@
+# distutils: language = c++
 """
 Spherical Voronoi Cython Code
 
@@ -16,65 +17,75 @@ import numpy as np
 cimport numpy as np
 cimport cython
 
-__all__ = ['sort_vertices_of_regions']
+__all__ = ['regions_from_simplices', 'sort_vertices_of_regions']
+
+cdef extern from "spherical_voronoi.h":
+    void spherical_voronoi_regions(const int *simplices,
+                                   np.npy_intp n_simplices,
+                                   np.npy_intp n_points, np.npy_intp *indptr,
+                                   np.npy_intp *indices) nogil
+    void spherical_voronoi_sort(const int *simplices,
+                                const np.npy_intp *indptr,
+                                np.npy_intp *indices, np.npy_intp n_points,
+                                const double *points, const double *vertices,
+                                const double *center, double radius,
+                                double *areas, int workers) nogil except +
 
-# array-filling placeholder that can never occur
-DEF ARRAY_FILLER = -2
 
 @cython.boundscheck(False)
-cdef void remaining_filter(np.npy_intp[:] remaining,
-                           np.npy_intp current_simplex):
-    cdef np.npy_intp i
-    for i in range(remaining.shape[0]):
-        if remaining[i] == current_simplex:
-            remaining[i] = ARRAY_FILLER
+def regions_from_simplices(int[:,::1] simplices, np.npy_intp n_points):
+    """
+    The regions of the generators of the hull triangles `simplices`, as
+    CSR arrays ``(indptr, indices)``: region n holds the Voronoi vertices
+    ``indices[indptr[n]:indptr[n+1]]``, in increasing order.
+    """
+    cdef np.npy_intp n_simplices = simplices.shape[0]
+    cdef np.npy_intp[::1] indptr = np.empty(n_points + 1, dtype=np.intp)
+    cdef np.npy_intp[::1] indices = np.empty(3 * n_simplices, dtype=np.intp)
+
+    if n_simplices > 0 and (np.min(simplices) < 0
+                            or np.max(simplices) >= n_points):
+        raise ValueError("simplices refer to points out of range")
+
+    with nogil:
+        spherical_voronoi_regions(&simplices[0, 0] if n_simplices else NULL,
+                                  n_simplices, n_points, &indptr[0],
+                                  &indices[0] if n_simplices else NULL)
+    return np.asarray(indptr), np.asarray(indices)
 
 
 @cython.boundscheck(False)
-def sort_vertices_of_regions(int[:,::1] simplices, regions):
-    cdef np.npy_intp n, k, s, i
-    cdef np.npy_intp num_regions = len(regions)
-    cdef np.npy_intp current_simplex, current_vertex, remaining_count
-    cdef np.npy_intp cs_identified, remaining_size
-    cdef np.npy_intp[:] remaining
-    cdef np.npy_intp[:] sorted_vertices = np.zeros(max([len(region) for region
-                                                   in regions]),
-                                                   dtype=np.intp)
+def sort_vertices_of_regions(int[:,::1] simplices, np.npy_intp[::1] indptr,
+                             np.npy_intp[::1] indices, double[:,::1] points,
+                             double[:,::1] vertices, double[::1] center,
+                             double radius, double[::1] areas=None,
+                             int workers=1):
+    """
+    Sort the vertices of the CSR regions ``(indptr, indices)`` in place,
+    on up to `workers` threads, and store the areas of the regions in
+    `areas` if it is given.
+    """
+    cdef np.npy_intp n_points = indptr.shape[0] - 1
+    cdef double *areas_ptr = NULL
+
+    if points.shape[0] != n_points or points.shape[1] != 3:
+        raise ValueError("points must have shape (%d, 3)" % n_points)
+    if vertices.shape[0] != simplices.shape[0] or vertices.shape[1] != 3:
+        raise ValueError("there must be one vertex per simplex")
+    if center.shape[0] != 3:
+        raise ValueError("center must have 3 coordinates")
+    if areas is not None:
+        if areas.shape[0] != n_points:
+            raise ValueError("areas must have one entry per region")
+        if n_points > 0:
+            areas_ptr = &areas[0]
+    if n_points == 0:
+        return
 
-    for n in range(num_regions):
-        remaining_count = 0
-        remaining = np.asarray(regions[n][:])
-        remaining_size = remaining.shape[0]
-        sorted_vertices[:] = ARRAY_FILLER
-        current_simplex = remaining[0]
-        for i in range(3):
-            k = simplices[current_simplex, i]
-            if k != n:
-                current_vertex = k
-                break
-        sorted_vertices[remaining_count] = current_simplex
-        remaining_count += 1
-        remaining_filter(remaining, current_simplex)
-        while remaining_size > remaining_count:
-            cs_identified = 0
-            for i in range(remaining_size):
-                if remaining[i] == ARRAY_FILLER:
-                    continue
-                s = remaining[i]
-                for j in range(3):
-                    if current_vertex == simplices[s, j]:
-                        current_simplex = remaining[i]
-                        cs_identified += 1
-                        break
-                if cs_identified > 0:
-                    break
-            for i in range(3):
-                s = simplices[current_simplex, i]
-                if s != n and s != current_vertex:
-                    current_vertex = s
-                    break
-            sorted_vertices[remaining_count] = current_simplex
-            remaining_count += 1
-            remaining_filter(remaining, current_simplex)
-        regions_arr = np.asarray(sorted_vertices)
-        regions[n] = regions_arr[regions_arr > ARRAY_FILLER].tolist()
+    with nogil:
+        spherical_voronoi_sort(&simplices[0, 0] if simplices.shape[0] else NULL,
+                               &indptr[0],
+                               &indices[0] if indices.shape[0] else NULL,
+                               n_points, &points[0, 0],
+                               &vertices[0, 0] if vertices.shape[0] else NULL,
+                               &center[0], radius, areas_ptr, workers)
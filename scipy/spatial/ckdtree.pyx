@@ -22,7 +22,6 @@ from libcpp.algorithm cimport sort
 cimport cython
 
 from multiprocessing import cpu_count
-import threading
 
 cdef extern from "<limits.h>":
     long LONG_MAX
@@ -53,9 +52,21 @@ cdef extern from "ckdtree_decl.h":
         np.intp_t _less
         np.intp_t _greater
 
+    struct ckdtreehotnode:
+        pass
+
+    struct ckdtree_stats:
+        np.intp_t nodes_visited
+        np.intp_t leaves_scanned
+        np.intp_t distance_evaluations
+        np.intp_t pruned_subtrees
+        np.intp_t heap_pushes
+        np.intp_t max_stack_depth
+
     struct ckdtree:
         vector[ckdtreenode]  *tree_buffer
         ckdtreenode   *ctree
+        vector[ckdtreehotnode]  *hot_buffer
         np.float64_t   *raw_data
         np.intp_t      n
         np.intp_t      m
@@ -65,6 +76,10 @@ cdef extern from "ckdtree_decl.h":
         np.intp_t      *raw_indices
         np.float64_t   *raw_boxsize_data
         np.intp_t size
+        np.float64_t   *raw_tree_data
+        np.float32_t   *raw_data_f32
+        np.float32_t   *raw_tree_data_f32
+        ckdtree_stats  *stats
 
     # External build and query methods in C++. Cython will
     # release the GIL to avoid locking up the interpreter.
@@ -75,12 +90,15 @@ cdef extern from "ckdtree_decl.h":
                          np.float64_t *maxes,
                          np.float64_t *mins,
                          int _median,
-                         int _compact) nogil except +
+                         int _compact,
+                         int n_jobs) nogil except +
 
     int build_weights(ckdtree *self,
                          np.float64_t *node_weights,
                          np.float64_t *weights) nogil except +
 
+    int build_hot_nodes(ckdtree *self) nogil except +
+
     int query_knn(const ckdtree *self,
                      np.float64_t *dd,
                      np.intp_t    *ii,
@@ -91,13 +109,30 @@ cdef extern from "ckdtree_decl.h":
                      const np.intp_t    kmax,
                      const np.float64_t eps,
                      const np.float64_t p,
-                     const np.float64_t distance_upper_bound) nogil except +
+                     const np.float64_t distance_upper_bound,
+                     const np.intp_t max_leaves,
+                     np.intp_t *n_capped,
+                     const int reorder_queries,
+                     const int n_jobs) nogil except +
 
     int query_pairs(const ckdtree *self,
                        const np.float64_t r,
                        const np.float64_t p,
                        const np.float64_t eps,
-                       vector[ordered_pair] *results) nogil except +
+                       vector[ordered_pair] *results,
+                       const int n_jobs) nogil except +
+
+    ctypedef int (*ckdtree_batch_func)(void *context, const void *entries,
+                                       np.intp_t n)
+
+    int query_pairs_batched(const ckdtree *self,
+                       const np.float64_t r,
+                       const np.float64_t p,
+                       const np.float64_t eps,
+                       const np.intp_t batch_size,
+                       ckdtree_batch_func flush,
+                       void *context,
+                       const int n_jobs) nogil except +
 
     int count_neighbors_unweighted(const ckdtree *self,
                            const ckdtree *other,
@@ -105,7 +140,8 @@ cdef extern from "ckdtree_decl.h":
                            np.float64_t  *real_r,
                            np.intp_t     *results,
                            const np.float64_t p,
-                           int cumulative) nogil except +
+                           int cumulative,
+                           const int n_jobs) nogil except +
 
     int count_neighbors_weighted(const ckdtree *self,
                            const ckdtree *other,
@@ -117,7 +153,8 @@ cdef extern from "ckdtree_decl.h":
                            np.float64_t  *real_r,
                            np.float64_t     *results,
                            const np.float64_t p,
-                           int cumulative) nogil except +
+                           int cumulative,
+                           const int n_jobs) nogil except +
 
     int query_ball_point(const ckdtree *self,
                             const np.float64_t *x,
@@ -126,20 +163,52 @@ cdef extern from "ckdtree_decl.h":
                             const np.float64_t eps,
                             const np.intp_t n_queries,
                             vector[np.intp_t] **results,
-                            const int return_length) nogil except +
+                            const int return_length,
+                            const int n_jobs) nogil except +
+
+    int query_ball_point_csr(const ckdtree *self,
+                            const np.float64_t *x,
+                            const np.float64_t *r,
+                            const np.float64_t p,
+                            const np.float64_t eps,
+                            const np.intp_t n_queries,
+                            const int sort_rows,
+                            vector[np.intp_t] *indices,
+                            np.intp_t *indptr,
+                            const int n_jobs) nogil except +
 
     int query_ball_tree(const ckdtree *self,
                            const ckdtree *other,
                            const np.float64_t r,
                            const np.float64_t p,
                            const np.float64_t eps,
-                           vector[np.intp_t] **results) nogil except +
+                           vector[np.intp_t] **results,
+                           const int n_jobs) nogil except +
+
+    int query_ball_tree_csr(const ckdtree *self,
+                           const ckdtree *other,
+                           const np.float64_t r,
+                           const np.float64_t p,
+                           const np.float64_t eps,
+                           vector[np.intp_t] *indices,
+                           np.intp_t *indptr,
+                           const int n_jobs) nogil except +
 
     int sparse_distance_matrix(const ckdtree *self,
                                   const ckdtree *other,
                                   const np.float64_t p,
                                   const np.float64_t max_distance,
-                                  vector[coo_entry] *results) nogil except +
+                                  vector[coo_entry] *results,
+                                  const int n_jobs) nogil except +
+
+    int sparse_distance_matrix_batched(const ckdtree *self,
+                                  const ckdtree *other,
+                                  const np.float64_t p,
+                                  const np.float64_t max_distance,
+                                  const np.intp_t batch_size,
+                                  ckdtree_batch_func flush,
+                                  void *context,
+                                  const int n_jobs) nogil except +
 
 
 # C++ helper functions
@@ -300,6 +369,85 @@ cdef class ordered_pairs:
         return results
 
 
+# index vector wrapper
+# ====================
+
+cdef class intp_vector:
+
+    cdef:
+        readonly object __array_interface__
+        vector[np.intp_t] *buf
+
+    def __cinit__(intp_vector self):
+        self.buf = NULL
+
+    def __init__(intp_vector self):
+        self.buf = new vector[np.intp_t]()
+
+    def __dealloc__(intp_vector self):
+        if self.buf != NULL:
+            del self.buf
+
+    # The method ndarray must only be called after the buffer is filled.
+    # The array shares the memory of the buffer and keeps it alive.
+
+    def ndarray(intp_vector self):
+        cdef:
+            np.uintp_t uintptr
+            np.intp_t n
+        n = <np.intp_t> self.buf.size()
+        if NPY_LIKELY(n > 0):
+            uintptr = <np.uintp_t> (<void*> &self.buf.front())
+            dtype = np.dtype(np.intp)
+            self.__array_interface__ = dict(
+                data = (uintptr, False),
+                descr = dtype.descr,
+                shape = (n,),
+                strides = (dtype.itemsize,),
+                typestr = dtype.str,
+                version = 3,
+            )
+            return np.asarray(self)
+        else:
+            return np.empty(shape=(0,), dtype=np.intp)
+
+
+# batched output
+# ==============
+
+cdef class batch_callback:
+    # Hands the batches of query_pairs_batched and
+    # sparse_distance_matrix_batched to a Python callable, as arrays of
+    # the given dtype and shape per entry. The first exception raised by
+    # the callable is kept in error, and stops the query.
+
+    cdef:
+        object callback
+        object dtype
+        tuple shape
+        readonly object error
+
+    def __init__(batch_callback self, callback, dtype, tuple shape):
+        self.callback = callback
+        self.dtype = dtype
+        self.shape = shape
+        self.error = None
+
+
+cdef int flush_batch(void *context, const void *entries,
+                     np.intp_t n) with gil:
+    cdef:
+        batch_callback self = <batch_callback> context
+        np.ndarray batch
+    try:
+        batch = np.empty((n,) + self.shape, dtype=self.dtype)
+        memcpy(np.PyArray_DATA(batch), entries, batch.nbytes)
+        self.callback(batch)
+    except BaseException as e:
+        self.error = e
+        return -1
+    return 0
+
 
 # Tree structure exposed to Python
 # ================================
@@ -396,13 +544,39 @@ cdef class cKDTreeNode:
                 return n
 
 
+# On-disk tree format
+# ===================
+#
+# cKDTree.save writes a flat file that cKDTree.load can memory map:
+#
+#   8 bytes   _FILE_MAGIC
+#   int64s    _FILE_VERSION, _FILE_BYTE_ORDER, sizeof(np.intp_t),
+#             sizeof(ckdtreenode), n, m, leafsize, number of nodes,
+#             itemsize of the data, then (offset, nbytes) of each of
+#             _FILE_SECTIONS
+#
+# in native byte order, followed by the sections, each aligned to
+# _FILE_ALIGN bytes. The nodes refer to their children by the _less and
+# _greater offsets; their less and greater pointers are written as NULL.
+# Missing sections (no boxsize, no tree_data) have nbytes 0.
+
+_FILE_MAGIC = b'cKDTree\0'
+_FILE_VERSION = 1
+_FILE_BYTE_ORDER = 0x0102030405060708
+_FILE_SECTIONS = ('nodes', 'data', 'indices', 'maxes', 'mins',
+                  'boxsize_data', 'tree_data')
+_FILE_NFIELDS = 9 + 2 * len(_FILE_SECTIONS)
+_FILE_ALIGN = 4096
+
+
 # Main cKDTree class
 # ==================
 
 cdef class cKDTree:
     """
     cKDTree(data, leafsize=16, compact_nodes=True, copy_data=False,
-            balanced_tree=True, boxsize=None)
+            balanced_tree=True, boxsize=None, n_jobs=1, reorder_data=False,
+            dtype=None)
 
     kd-tree for quick nearest-neighbor lookup
 
@@ -458,13 +632,34 @@ cdef class cKDTree:
         is the boxsize along i-th dimension. The input data shall be wrapped
         into :math:`[0, L_i)`. A ValueError is raised if any of the data is
         outside of this bound.
+    n_jobs : int, optional
+        Number of threads to build the tree with. Subtrees over many points
+        are built in parallel; the resulting tree is the same as with a
+        single thread. If -1 is given all processors are used. Default: 1.
+
+        .. versionadded:: 1.4.0
+    reorder_data : bool, optional
+        If True, a second copy of the data is stored with the points in
+        tree order, so that the points of each leaf are contiguous in
+        memory. This speeds up `query` and `query_ball_point`, mostly for
+        large low-dimensional data sets, at the cost of the extra copy.
+        Default: False.
+
+        .. versionadded:: 1.4.0
+    dtype : {None, float64, float32}, optional
+        Data type in which the points are stored. With float32, the data
+        take half the memory, and are rounded to single precision if
+        given in double precision. Distances are always computed in double
+        precision. Default: float64.
+
+        .. versionadded:: 1.4.0
 
     Attributes
     ----------
     data : ndarray, shape (n,m)
         The n data points of dimension m to be indexed. This array is
         not copied unless this is necessary to produce a contiguous
-        array of doubles. The data are also copied if the kd-tree is built
+        array of `dtype`. The data are also copied if the kd-tree is built
         with `copy_data=True`.
     leafsize : positive int
         The number of points at which the algorithm switches over to
@@ -481,6 +676,16 @@ cdef class cKDTree:
         This class exposes a Python view of the root node in the cKDTree object.
     size : int
         The number of nodes in the tree.
+    collect_stats : bool
+        If True, `query`, `query_ball_point` and `count_neighbors` add up
+        the work of their traversals in `stats`. Default: False.
+
+        .. versionadded:: 1.4.0
+    stats : dict or None
+        The counters of the traversals since `collect_stats` was set or
+        `reset_stats` was called, or None if they are not collected.
+
+        .. versionadded:: 1.4.0
 
     See Also
     --------
@@ -496,6 +701,8 @@ cdef class cKDTree:
         readonly np.ndarray      indices
         readonly object          boxsize
         np.ndarray               boxsize_data
+        np.ndarray               tree_data
+        ckdtree_stats            _stats
 
     property n:
         def __get__(self): return self.cself.n
@@ -506,16 +713,42 @@ cdef class cKDTree:
     property size:
         def __get__(self): return self.cself.size
 
+    property collect_stats:
+        def __get__(self): return self.cself.stats != NULL
+        def __set__(self, value):
+            if value:
+                if self.cself.stats == NULL:
+                    self.reset_stats()
+                self.cself.stats = &self._stats
+            else:
+                self.cself.stats = NULL
+
+    property stats:
+        def __get__(self):
+            if self.cself.stats == NULL:
+                return None
+            return dict(self._stats)
+
     def __cinit__(cKDTree self):
         self.cself = <ckdtree * > PyMem_Malloc(sizeof(ckdtree))
         self.cself.tree_buffer = NULL
+        self.cself.hot_buffer = NULL
+        self.cself.raw_tree_data = NULL
+        self.cself.raw_data_f32 = NULL
+        self.cself.raw_tree_data_f32 = NULL
+        self.cself.stats = NULL
 
     def __init__(cKDTree self, data, np.intp_t leafsize=16, compact_nodes=True,
-            copy_data=False, balanced_tree=True, boxsize=None):
+            copy_data=False, balanced_tree=True, boxsize=None,
+            np.intp_t n_jobs=1, reorder_data=False, dtype=None):
         cdef np.float64_t [::1] tmpmaxes, tmpmins
         cdef ckdtree * cself = self.cself
 
-        data = np.array(data, order='C', copy=copy_data, dtype=np.float64)
+        dtype = np.dtype(np.float64 if dtype is None else dtype)
+        if dtype != np.float64 and dtype != np.float32:
+            raise ValueError("dtype must be float64 or float32")
+
+        data = np.array(data, order='C', copy=copy_data, dtype=dtype)
 
         if data.ndim != 2:
             raise ValueError("data must be 2 dimensions")
@@ -558,7 +791,15 @@ cdef class cKDTree:
         tmpmaxes = np.copy(self.maxes)
         tmpmins = np.copy(self.mins)
 
-        build_ckdtree(cself, 0, cself.n, &tmpmaxes[0], &tmpmins[0], median, compact)
+        if n_jobs == -1:
+            n_jobs = number_of_processors
+
+        build_ckdtree(cself, 0, cself.n, &tmpmaxes[0], &tmpmins[0], median,
+                      compact, n_jobs)
+
+        if reorder_data:
+            self.tree_data = np.ascontiguousarray(self.data[self.indices])
+            self._pre_init()
 
         # set up the tree structure pointers
         self._post_init()
@@ -568,7 +809,13 @@ cdef class cKDTree:
 
         # finalize the pointers from array attributes
 
-        cself.raw_data = <np.float64_t*> np.PyArray_DATA(self.data)
+        # single precision data go through the _f32 pointers
+        if self.data.dtype == np.float32:
+            cself.raw_data = NULL
+            cself.raw_data_f32 = <np.float32_t*> np.PyArray_DATA(self.data)
+        else:
+            cself.raw_data = <np.float64_t*> np.PyArray_DATA(self.data)
+            cself.raw_data_f32 = NULL
         cself.raw_maxes = <np.float64_t*> np.PyArray_DATA(self.maxes)
         cself.raw_mins = <np.float64_t*> np.PyArray_DATA(self.mins)
         cself.raw_indices = <np.intp_t*> np.PyArray_DATA(self.indices)
@@ -578,6 +825,14 @@ cdef class cKDTree:
         else:
             cself.raw_boxsize_data = NULL
 
+        cself.raw_tree_data = NULL
+        cself.raw_tree_data_f32 = NULL
+        if self.tree_data is not None:
+            if self.tree_data.dtype == np.float32:
+                cself.raw_tree_data_f32 = <np.float32_t*>np.PyArray_DATA(self.tree_data)
+            else:
+                cself.raw_tree_data = <np.float64_t*>np.PyArray_DATA(self.tree_data)
+
     cdef _post_init(cKDTree self):
         cself = self.cself
         # finalize the tree points, this calls _post_init_traverse
@@ -589,6 +844,11 @@ cdef class cKDTree:
 
         self._post_init_traverse(cself.ctree)
 
+        # the compact breadth-first copy of the nodes used by query
+        if cself.hot_buffer == NULL:
+            cself.hot_buffer = new vector[ckdtreehotnode]()
+        build_hot_nodes(cself)
+
         # make the tree viewable from Python
         self.tree = cKDTreeNode()
         self.tree._node = cself.ctree
@@ -615,8 +875,49 @@ cdef class cKDTree:
         cself = self.cself
         if cself.tree_buffer != NULL:
             del cself.tree_buffer
+        if cself.hot_buffer != NULL:
+            del cself.hot_buffer
         PyMem_Free(cself)
 
+    def reset_stats(cKDTree self):
+        """
+        reset_stats(self)
+
+        Set the counters in `stats` to zero
+
+        The counters are collected if `collect_stats` is True:
+
+        nodes_visited
+            Nodes, or pairs of nodes in `count_neighbors`, that the
+            traversals went through.
+        leaves_scanned
+            Leaves, or pairs of leaves, whose points were compared with
+            the query.
+        distance_evaluations
+            Distances computed between points in those leaves.
+        pruned_subtrees
+            Subtrees, or pairs of them, that the traversals left out by
+            their distance bounds.
+        heap_pushes
+            Cells pushed onto the priority queue of `query`.
+        max_stack_depth
+            The deepest stack of the rectangle distance tracker of
+            `query_ball_point` and `count_neighbors`.
+
+        Comparing them between trees built with other `leafsize`,
+        `compact_nodes` or `balanced_tree` shows where a query workload
+        spends its time.
+
+        .. versionadded:: 1.4.0
+
+        """
+        self._stats.nodes_visited = 0
+        self._stats.leaves_scanned = 0
+        self._stats.distance_evaluations = 0
+        self._stats.pruned_subtrees = 0
+        self._stats.heap_pushes = 0
+        self._stats.max_stack_depth = 0
+
     # -----
     # query
     # -----
@@ -624,9 +925,11 @@ cdef class cKDTree:
     @cython.boundscheck(False)
     def query(cKDTree self, object x, object k=1, np.float64_t eps=0,
               np.float64_t p=2, np.float64_t distance_upper_bound=INFINITY,
-              np.intp_t n_jobs=1):
+              np.intp_t n_jobs=1, reorder_queries=False, max_leaves=None,
+              return_n_capped=False):
         """
-        query(self, x, k=1, eps=0, p=2, distance_upper_bound=np.inf, n_jobs=1)
+        query(self, x, k=1, eps=0, p=2, distance_upper_bound=np.inf, n_jobs=1,
+              reorder_queries=False, max_leaves=None, return_n_capped=False)
 
         Query the kd-tree for nearest neighbors
 
@@ -654,8 +957,33 @@ cdef class cKDTree:
             queries, it may help to supply the distance to the nearest neighbor
             of the most recent point.
         n_jobs : int, optional
-            Number of jobs to schedule for parallel processing. If -1 is given
-            all processors are used. Default: 1.
+            Number of threads to use for parallel processing. If -1 is given
+            all processors are used. Default: 1. The threads are kept
+            between calls, so that many small queries do not pay for
+            starting them each time.
+        reorder_queries : bool, optional
+            If True, the points are queried grouped by the leaf of the tree
+            that contains them, so that consecutive queries share the nodes
+            and data in cache. The results are the same and in the order of
+            ``x``. This speeds up large queries whose points are in random
+            order, at the cost of sorting them first. Default: False.
+
+            .. versionadded:: 1.4.0
+        max_leaves : positive int, optional
+            Stop the search for a point after this many leaves of the tree
+            have been scanned, and return the nearest neighbors found so
+            far. This bounds the work per query to about
+            ``max_leaves * leafsize`` distance evaluations, but the
+            neighbors may then be neither the nearest nor within the
+            tolerance given by `eps`. The leaves nearest to the point are
+            scanned first. Default: None, no limit.
+
+            .. versionadded:: 1.4.0
+        return_n_capped : bool, optional
+            If True, also return the number of points whose search was
+            stopped by `max_leaves` before it was finished. Default: False.
+
+            .. versionadded:: 1.4.0
 
         Returns
         -------
@@ -669,6 +997,9 @@ cdef class cKDTree:
             If ``x`` has shape ``tuple+(self.m,)``, then ``i`` has shape ``tuple+(k,)``.
             When k == 1, the last dimension of the output is squeezed.
             Missing neighbors are indicated with ``self.n``.
+        n_capped : int
+            The number of points whose search hit `max_leaves`. Only
+            returned if `return_n_capped` is True.
 
         Notes
         -----
@@ -730,6 +1061,9 @@ cdef class cKDTree:
         cdef:
             np.intp_t n, i, j
             int overflown
+            int c_reorder_queries = 1 if reorder_queries else 0
+            np.intp_t c_max_leaves = 0
+            np.intp_t n_capped = 0
 
         x_arr = np.asarray(x, dtype=np.float64)
         if x_arr.ndim == 0 or x_arr.shape[x_arr.ndim - 1] != self.m:
@@ -737,6 +1071,10 @@ cdef class cKDTree:
                              "has shape %s" % (int(self.m), np.shape(x)))
         if p < 1:
             raise ValueError("Only p-norms with 1<=p<=infinity permitted")
+        if max_leaves is not None:
+            if max_leaves < 1:
+                raise ValueError("max_leaves must be positive")
+            c_max_leaves = max_leaves
         if x_arr.ndim == 1:
             single = True
             x_arr = x_arr[np.newaxis,:]
@@ -762,16 +1100,17 @@ cdef class cKDTree:
 
         cdef np.intp_t kmax = np.max(k)
 
-        # Do the query in an external C++ function.
-        # The GIL will be released in the external query function.
-        def _thread_func(np.intp_t start, np.intp_t stop):
-            query_knn(self.cself, &dd[start,0], &ii[start,0],
-                &xx[start,0], stop-start, &kk[0], kk.shape[0], kmax, eps, p, distance_upper_bound)
-
         if (n_jobs == -1):
             n_jobs = number_of_processors
 
-        _run_threads(_thread_func, n, n_jobs)
+        # Do the query in an external C++ function, which spreads the
+        # points over n_jobs threads.
+        if n > 0:
+            with nogil:
+                query_knn(self.cself, &dd[0,0], &ii[0,0],
+                    &xx[0,0], n, &kk[0], kk.shape[0], kmax, eps, p,
+                    distance_upper_bound, c_max_leaves, &n_capped,
+                    c_reorder_queries, n_jobs)
 
         # massage the output in conformabity to the documented behavior
 
@@ -807,6 +1146,8 @@ cdef class cKDTree:
                 ddret = float(ddret)
                 iiret = int(iiret)
 
+        if return_n_capped:
+            return ddret, iiret, int(n_capped)
         return ddret, iiret
 
     # ----------------
@@ -816,9 +1157,10 @@ cdef class cKDTree:
     def query_ball_point(cKDTree self, object x, object r,
                          np.float64_t p=2., np.float64_t eps=0, n_jobs=1,
                          return_sorted=None,
-                         return_length=False):
+                         return_length=False, output_type='list'):
         """
-        query_ball_point(self, x, r, p=2., eps=0)
+        query_ball_point(self, x, r, p=2., eps=0, n_jobs=1, return_sorted=None,
+                         return_length=False, output_type='list')
 
         Find all points within distance r of point(s) x.
 
@@ -837,8 +1179,10 @@ cdef class cKDTree:
             added in bulk if their furthest points are nearer than
             ``r * (1 + eps)``.
         n_jobs : int, optional
-            Number of jobs to schedule for parallel processing. If -1 is given
-            all processors are used. Default: 1.
+            Number of threads to use for parallel processing. If -1 is given
+            all processors are used. Default: 1. The threads are kept
+            between calls, so that many small queries do not pay for
+            starting them each time.
         return_sorted : bool, optional
             Sorts returned indicies if True and does not sort them if False. If
             None, does not sort single point queries, but does sort
@@ -850,6 +1194,13 @@ cdef class cKDTree:
             Return the number of points inside the radius instead of a list
             of the indices.
             .. versionadded:: 1.3.0
+        output_type : string, optional
+            Choose the output container, 'list' or 'csr'. Default: 'list'.
+            With 'csr', the neighbors of all points are returned in two
+            arrays, without a Python list per point. This does not go with
+            `return_length`.
+
+            .. versionadded:: 1.4.0
 
         Returns
         -------
@@ -857,6 +1208,11 @@ cdef class cKDTree:
             If `x` is a single point, returns a list of the indices of the
             neighbors of `x`. If `x` is an array of points, returns an object
             array of shape tuple containing lists of neighbors.
+        indices, indptr : ndarrays of ints
+            With ``output_type='csr'``, the neighbors of the point
+            ``x.reshape(-1, self.m)[i]`` are ``indices[indptr[i]:indptr[i+1]]``,
+            as in the rows of a `scipy.sparse.csr_matrix`. The neighbors of
+            each point are sorted as set by `return_sorted`.
 
         Notes
         -----
@@ -873,6 +1229,17 @@ cdef class cKDTree:
         >>> tree.query_ball_point([2, 0], 1)
         [4, 8, 9, 12]
 
+        The neighbors of many points can be stored in a sparse matrix,
+        without making a list for each point:
+
+        >>> from scipy.sparse import csr_matrix
+        >>> indices, indptr = tree.query_ball_point(points, 1,
+        ...                                         output_type='csr')
+        >>> graph = csr_matrix((np.ones(len(indices)), indices, indptr),
+        ...                    shape=(len(points), tree.n))
+        >>> graph.getrow(8).indices.tolist()
+        [4, 8, 9, 12]
+
         """
 
         cdef:
@@ -883,6 +1250,17 @@ cdef class cKDTree:
             list tmp
             np.intp_t i, j, n, m
             np.intp_t xndim
+            vector[np.intp_t] **vvres = NULL
+            np.intp_t *cur
+            int c_n_jobs, c_return_length, c_sort_rows
+            intp_vector indices
+            np.intp_t[::1] vindptr
+
+        if output_type not in ('list', 'csr'):
+            raise ValueError('Invalid output type')
+        if output_type == 'csr' and return_length:
+            raise ValueError("return_length does not go with "
+                             "output_type='csr'")
 
         x = np.asarray(x, dtype=np.float64)
         if x.shape[-1] != self.m:
@@ -900,6 +1278,26 @@ cdef class cKDTree:
         # allocate an array of std::vector<npy_intp>
         n = np.prod(retshape)
 
+        vxx = np.reshape(x, (-1, x.shape[-1]))
+        vrr = np.reshape(r, (-1))
+
+        if n_jobs == -1:
+            n_jobs = number_of_processors
+        c_n_jobs = n_jobs
+
+        if output_type == 'csr':
+            c_sort_rows = return_sorted or (return_sorted is None and
+                                            xndim > 1)
+            indices = intp_vector()
+            indptr = np.zeros(n + 1, dtype=np.intp)
+            vindptr = indptr
+            if n > 0:
+                with nogil:
+                    query_ball_point_csr(self.cself, &vxx[0, 0], &vrr[0],
+                                         p, eps, n, c_sort_rows, indices.buf,
+                                         &vindptr[0], c_n_jobs)
+            return indices.ndarray(), indptr
+
         if return_length:
             result = np.empty(retshape, dtype=np.intp)
             vlen = result.reshape(-1)
@@ -907,58 +1305,50 @@ cdef class cKDTree:
             result = np.empty(retshape, dtype=object)
             vout = result.reshape(-1)
 
-        vxx = np.reshape(x, (-1, x.shape[-1]))
-        vrr = np.reshape(r, (-1))
-
-        def _thread_func(np.intp_t start, np.intp_t stop):
-            cdef vector[np.intp_t] **vvres
-            cdef np.intp_t i
-            cdef np.intp_t *cur
-            try:
-                vvres = (<vector[np.intp_t] **>
-                    PyMem_Malloc((stop-start) * sizeof(void*)))
-                if vvres == NULL:
-                    raise MemoryError()
+        c_return_length = return_length
 
-                memset(<void*> vvres, 0, (stop-start) * sizeof(void*))
+        try:
+            vvres = (<vector[np.intp_t] **>
+                PyMem_Malloc(n * sizeof(void*)))
+            if vvres == NULL:
+                raise MemoryError()
 
-                for i in range(stop - start):
-                    vvres[i] = new vector[np.intp_t]()
+            memset(<void*> vvres, 0, n * sizeof(void*))
 
-                query_ball_point(self.cself, &vxx[start, 0],
-                    &vrr[start + 0], p, eps, stop - start, vvres, return_length)
+            for i in range(n):
+                vvres[i] = new vector[np.intp_t]()
 
-                for i in range(stop - start):
-                    if return_length:
-                        vlen[start + i] = vvres[i].front()
-                        continue
+            # the C++ function spreads the points over n_jobs threads
+            if n > 0:
+                with nogil:
+                    query_ball_point(self.cself, &vxx[0, 0], &vrr[0], p, eps,
+                                     n, vvres, c_return_length, c_n_jobs)
 
-                    if return_sorted:
-                        sort(vvres[i].begin(), vvres[i].end())
-                    elif return_sorted is None and xndim > 1:
-                        # compatibility with the old bug not sorting scalar queries.
-                        sort(vvres[i].begin(), vvres[i].end())
+            for i in range(n):
+                if return_length:
+                    vlen[i] = vvres[i].front()
+                    continue
 
-                    m = <np.intp_t> (vvres[i].size())
-                    tmp = m * [None]
+                if return_sorted:
+                    sort(vvres[i].begin(), vvres[i].end())
+                elif return_sorted is None and xndim > 1:
+                    # compatibility with the old bug not sorting scalar queries.
+                    sort(vvres[i].begin(), vvres[i].end())
 
-                    cur = &vvres[i].front()
-                    for j in range(m):
-                        tmp[j] = cur[0]
-                        cur += 1
-                    vout[start + i] = tmp
-            finally:
-                if vvres != NULL:
-                    for i in range(stop-start):
-                        if vvres[i] != NULL:
-                            del vvres[i]
-                    PyMem_Free(vvres)
-
-        # multithreading logic is similar to cKDTree.query
-        if n_jobs == -1:
-            n_jobs = number_of_processors
+                m = <np.intp_t> (vvres[i].size())
+                tmp = m * [None]
 
-        _run_threads(_thread_func, n, n_jobs)
+                cur = &vvres[i].front()
+                for j in range(m):
+                    tmp[j] = cur[0]
+                    cur += 1
+                vout[i] = tmp
+        finally:
+            if vvres != NULL:
+                for i in range(n):
+                    if vvres[i] != NULL:
+                        del vvres[i]
+                PyMem_Free(vvres)
 
         if xndim == 1: # scalar query, unpack result.
             result = result[()]
@@ -969,9 +1359,11 @@ cdef class cKDTree:
     # ---------------
 
     def query_ball_tree(cKDTree self, cKDTree other,
-                        np.float64_t r, np.float64_t p=2., np.float64_t eps=0):
+                        np.float64_t r, np.float64_t p=2., np.float64_t eps=0,
+                        int n_jobs=1, output_type='list'):
         """
-        query_ball_tree(self, other, r, p=2., eps=0)
+        query_ball_tree(self, other, r, p=2., eps=0, n_jobs=1,
+                        output_type='list')
 
         Find all pairs of points whose distance is at most r
 
@@ -990,12 +1382,28 @@ cdef class cKDTree:
             if their nearest points are further than ``r/(1+eps)``, and
             branches are added in bulk if their furthest points are nearer
             than ``r * (1+eps)``.  `eps` has to be non-negative.
+        n_jobs : int, optional
+            Number of threads to use. The node pairs at the top of the tree
+            traversal are distributed over the threads. If -1 is given all
+            processors are used. Default: 1.
+
+            .. versionadded:: 1.4.0
+        output_type : string, optional
+            Choose the output container, 'list' or 'csr'. Default: 'list'.
+            With 'csr', the neighbors of all points are returned in two
+            arrays, without a Python list per point.
+
+            .. versionadded:: 1.4.0
 
         Returns
         -------
         results : list of lists
             For each element ``self.data[i]`` of this tree, ``results[i]`` is a
             list of the indices of its neighbors in ``other.data``.
+        indices, indptr : ndarrays of ints
+            With ``output_type='csr'``, the sorted indices of the neighbors of
+            ``self.data[i]`` are ``indices[indptr[i]:indptr[i+1]]``, as in the
+            rows of a `scipy.sparse.csr_matrix`.
 
         """
 
@@ -1005,13 +1413,28 @@ cdef class cKDTree:
             np.intp_t *cur
             list results
             list tmp
+            intp_vector indices
+            np.intp_t[::1] vindptr
 
         # Make sure trees are compatible
         if self.m != other.m:
             raise ValueError("Trees passed to query_ball_tree have different "
                              "dimensionality")
+        if output_type not in ('list', 'csr'):
+            raise ValueError('Invalid output type')
 
         n = self.n
+        if n_jobs == -1:
+            n_jobs = number_of_processors
+
+        if output_type == 'csr':
+            indices = intp_vector()
+            indptr = np.zeros(n + 1, dtype=np.intp)
+            vindptr = indptr
+            with nogil:
+                query_ball_tree_csr(self.cself, other.cself, r, p, eps,
+                                    indices.buf, &vindptr[0], n_jobs)
+            return indices.ndarray(), indptr
 
         try:
 
@@ -1027,8 +1450,9 @@ cdef class cKDTree:
                 vvres[i] = new vector[np.intp_t]()
 
             # query in C++
-            # the GIL will be released in the C++ code
-            query_ball_tree(self.cself, other.cself, r, p, eps, vvres)
+            with nogil:
+                query_ball_tree(self.cself, other.cself, r, p, eps, vvres,
+                                n_jobs)
 
             # store the results in a list of lists
             results = n * [None]
@@ -1059,9 +1483,11 @@ cdef class cKDTree:
     # -----------
 
     def query_pairs(cKDTree self, np.float64_t r, np.float64_t p=2.,
-                    np.float64_t eps=0, output_type='set'):
+                    np.float64_t eps=0, output_type='set', int n_jobs=1,
+                    callback=None, np.intp_t batch_size=65536):
         """
-        query_pairs(self, r, p=2., eps=0)
+        query_pairs(self, r, p=2., eps=0, output_type='set', n_jobs=1,
+                    callback=None, batch_size=65536)
 
         Find all pairs of points whose distance is at most r.
 
@@ -1080,20 +1506,58 @@ cdef class cKDTree:
             than ``r * (1+eps)``.  `eps` has to be non-negative.
         output_type : string, optional
             Choose the output container, 'set' or 'ndarray'. Default: 'set'
+        n_jobs : int, optional
+            Number of threads to use. The node pairs at the top of the tree
+            traversal are distributed over the threads. If -1 is given all
+            processors are used. Default: 1.
+
+            .. versionadded:: 1.4.0
+        callback : callable, optional
+            If given, the pairs are not returned but passed to
+            ``callback(pairs)`` in batches, as arrays of shape ``(n, 2)``, so
+            that only a batch at a time is held in memory. With
+            ``n_jobs > 1`` the batches come in no particular order. An
+            exception raised by `callback` stops the search and is raised
+            again. `output_type` is then ignored.
+
+            .. versionadded:: 1.4.0
+        batch_size : int, optional
+            The number of pairs passed to `callback` at a time; only the
+            last batch may have fewer. Default: 65536.
+
+            .. versionadded:: 1.4.0
 
         Returns
         -------
         results : set or ndarray
             Set of pairs ``(i,j)``, with ``i < j``, for which the corresponding
             positions are close. If output_type is 'ndarray', an ndarry is
-            returned instead of a set.
+            returned instead of a set. None if `callback` is given.
 
         """
 
         cdef ordered_pairs results
+        cdef batch_callback batches
+        cdef int ret
+
+        if n_jobs == -1:
+            n_jobs = number_of_processors
+
+        if callback is not None:
+            if batch_size < 1:
+                raise ValueError("batch_size must be positive")
+            batches = batch_callback(callback, np.intp, (2,))
+            with nogil:
+                ret = query_pairs_batched(self.cself, r, p, eps, batch_size,
+                                          flush_batch, <void*> batches,
+                                          n_jobs)
+            if ret != 0:
+                raise batches.error
+            return None
 
         results = ordered_pairs()
-        query_pairs(self.cself, r, p, eps, results.buf)
+        with nogil:
+            query_pairs(self.cself, r, p, eps, results.buf, n_jobs)
 
         if output_type == 'set':
             return results.set()
@@ -1145,9 +1609,9 @@ cdef class cKDTree:
 
     @cython.boundscheck(False)
     def count_neighbors(cKDTree self, cKDTree other, object r, np.float64_t p=2.,
-                        object weights=None, int cumulative=True):
+                        object weights=None, int cumulative=True, int n_jobs=1):
         """
-        count_neighbors(self, other, r, p=2., weights=None, cumulative=True)
+        count_neighbors(self, other, r, p=2., weights=None, cumulative=True, n_jobs=1)
 
         Count how many nearby pairs can be formed. (pair-counting)
 
@@ -1189,6 +1653,12 @@ cdef class cKDTree:
             the algorithm is optimized to work with a large number of bins (>10) specified
             by ``r``. When ``cumulative`` is set to True, the algorithm is optimized to work
             with a small number of ``r``. Default: True
+        n_jobs : int, optional
+            Number of threads to use. The node pairs at the top of the tree
+            traversal are distributed over the threads. If -1 is given all
+            processors are used. Default: 1.
+
+            .. versionadded:: 1.4.0
 
         Returns
         -------
@@ -1305,6 +1775,9 @@ cdef class cKDTree:
                 if not ckdtree_isinf(real_r[i]):
                     real_r[i] = real_r[i] ** p
 
+        if n_jobs == -1:
+            n_jobs = number_of_processors
+
         if weights is None:
             self_weights = other_weights = None
         elif isinstance(weights, tuple):
@@ -1320,8 +1793,10 @@ cdef class cKDTree:
             results = np.zeros(n_queries + 1, dtype=np.intp)
 
             iresults = results
-            count_neighbors_unweighted(self.cself, other.cself, n_queries,
-                            &real_r[0], &iresults[0], p, cumulative)
+            with nogil:
+                count_neighbors_unweighted(self.cself, other.cself, n_queries,
+                                &real_r[0], &iresults[0], p, cumulative,
+                                n_jobs)
 
         else:
             int_result = False
@@ -1340,10 +1815,12 @@ cdef class cKDTree:
 
             results = np.zeros(n_queries + 1, dtype=np.float64)
             fresults = results
-            count_neighbors_weighted(self.cself, other.cself,
-                                    w1p, w2p, w1np, w2np,
-                                    n_queries,
-                                    &real_r[0], &fresults[0], p, cumulative)
+            with nogil:
+                count_neighbors_weighted(self.cself, other.cself,
+                                        w1p, w2p, w1np, w2np,
+                                        n_queries,
+                                        &real_r[0], &fresults[0], p, cumulative,
+                                        n_jobs)
 
         results2 = np.zeros(inverse.shape, results.dtype)
         if cumulative:
@@ -1370,9 +1847,10 @@ cdef class cKDTree:
     def sparse_distance_matrix(cKDTree self, cKDTree other,
                                np.float64_t max_distance,
                                np.float64_t p=2.,
-                               output_type='dok_matrix'):
+                               output_type='dok_matrix', int n_jobs=1,
+                               callback=None, np.intp_t batch_size=65536):
         """
-        sparse_distance_matrix(self, other, max_distance, p=2.)
+        sparse_distance_matrix(self, other, max_distance, p=2., output_type='dok_matrix', n_jobs=1, callback=None, batch_size=65536)
 
         Compute a sparse distance matrix
 
@@ -1392,6 +1870,26 @@ cdef class cKDTree:
         output_type : string, optional
             Which container to use for output data. Options: 'dok_matrix',
             'coo_matrix', 'dict', or 'ndarray'. Default: 'dok_matrix'.
+        n_jobs : int, optional
+            Number of threads to use. The node pairs at the top of the tree
+            traversal are distributed over the threads. If -1 is given all
+            processors are used. Default: 1.
+
+            .. versionadded:: 1.4.0
+        callback : callable, optional
+            If given, the entries are not returned but passed to
+            ``callback(entries)`` in batches, as record arrays like those of
+            ``output_type='ndarray'``, so that only a batch at a time is held
+            in memory. With ``n_jobs > 1`` the batches come in no particular
+            order. An exception raised by `callback` stops the search and is
+            raised again. `output_type` is then ignored.
+
+            .. versionadded:: 1.4.0
+        batch_size : int, optional
+            The number of entries passed to `callback` at a time; only the
+            last batch may have fewer. Default: 65536.
+
+            .. versionadded:: 1.4.0
 
         Returns
         -------
@@ -1399,19 +1897,38 @@ cdef class cKDTree:
             Sparse matrix representing the results in "dictionary of keys"
             format. If a dict is returned the keys are (i,j) tuples of indices.
             If output_type is 'ndarray' a record array with fields 'i', 'j',
-            and 'v' is returned,
+            and 'v' is returned. None if `callback` is given.
         """
 
         cdef coo_entries res
+        cdef batch_callback batches
+        cdef int ret
 
         # Make sure trees are compatible
         if self.m != other.m:
             raise ValueError("Trees passed to sparse_distance_matrix have "
                              "different dimensionality")
         # do the query
+        if n_jobs == -1:
+            n_jobs = number_of_processors
+
+        if callback is not None:
+            if batch_size < 1:
+                raise ValueError("batch_size must be positive")
+            _dtype = [('i',np.intp),('j',np.intp),('v',np.float64)]
+            batches = batch_callback(callback, np.dtype(_dtype, align=True), ())
+            with nogil:
+                ret = sparse_distance_matrix_batched(
+                        self.cself, other.cself, p, max_distance, batch_size,
+                        flush_batch, <void*> batches, n_jobs)
+            if ret != 0:
+                raise batches.error
+            return None
+
         res = coo_entries()
-        sparse_distance_matrix(
-                self.cself, other.cself, p, max_distance, res.buf)
+        with nogil:
+            sparse_distance_matrix(
+                    self.cself, other.cself, p, max_distance, res.buf, n_jobs)
 
         if output_type == 'dict':
             return res.dict()
@@ -1439,7 +1956,7 @@ cdef class cKDTree:
 
         state = (tree.copy(), self.data.copy(), self.n, self.m, self.leafsize,
                       self.maxes, self.mins, self.indices.copy(),
-                      self.boxsize, self.boxsize_data)
+                      self.boxsize, self.boxsize_data, self.tree_data)
         return state
 
     def __setstate__(cKDTree self, state):
@@ -1449,7 +1966,10 @@ cdef class cKDTree:
 
         # unpack the state
         (tree, self.data, self.cself.n, self.cself.m, self.cself.leafsize,
-            self.maxes, self.mins, self.indices, self.boxsize, self.boxsize_data) = state
+            self.maxes, self.mins, self.indices, self.boxsize,
+            self.boxsize_data) = state[:10]
+        # the tree order copy of the data, from version 1.4.0 on
+        self.tree_data = state[10] if len(state) > 10 else None
 
         cself.tree_buffer = new vector[ckdtreenode]()
         cself.tree_buffer.resize(tree.size // sizeof(ckdtreenode))
@@ -1466,19 +1986,179 @@ cdef class cKDTree:
         # set up the tree structure pointers
         self._post_init()
 
-def _run_threads(_thread_func, n, n_jobs):
-    if n_jobs > 1:
-        ranges = [(j * n // n_jobs, (j + 1) * n // n_jobs)
-                        for j in range(n_jobs)]
-
-        threads = [threading.Thread(target=_thread_func,
-                   args=(start, end))
-                   for start, end in ranges]
-        for t in threads:
-            t.daemon = True
-            t.start()
-        for t in threads:
-            t.join()
-
-    else:
-        _thread_func(0, n)
+    # ----------------------
+    # memory-mapped files
+    # ----------------------
+
+    def save(cKDTree self, filename):
+        """
+        save(self, filename)
+
+        Write the tree to a file that `cKDTree.load` can memory map
+
+        Parameters
+        ----------
+        filename : str
+            The name of the file.
+
+        Notes
+        -----
+        The file holds the node array and the data of the tree as flat
+        binary sections, in the byte order and word size of the machine
+        that wrote it. The format is versioned; files written by a later
+        version that this one does not know are refused by `load`.
+
+        .. versionadded:: 1.4.0
+
+        """
+        cdef:
+            vector[ckdtreenode] nodes
+            np.intp_t i, nbytes, offset
+
+        # the pointers are set up again on load
+        nodes = self.cself.tree_buffer[0]
+        for i in range(<np.intp_t> nodes.size()):
+            nodes[i].less = NULL
+            nodes[i].greater = NULL
+        nbytes = nodes.size() * sizeof(ckdtreenode)
+
+        arrays = [np.asarray(<char[:nbytes]> <char*> &nodes.front()),
+                  self.data, self.indices, self.maxes, self.mins,
+                  self.boxsize_data, self.tree_data]
+        arrays = [np.empty(0, dtype=np.uint8) if a is None else
+                  np.ascontiguousarray(a) for a in arrays]
+
+        fields = [_FILE_VERSION, _FILE_BYTE_ORDER, sizeof(np.intp_t),
+                  sizeof(ckdtreenode), self.n, self.m, self.leafsize,
+                  nodes.size(), self.data.itemsize]
+        offset = len(_FILE_MAGIC) + 8 * _FILE_NFIELDS
+        for a in arrays:
+            offset = -(-offset // _FILE_ALIGN) * _FILE_ALIGN
+            fields += [offset, a.nbytes]
+            offset += a.nbytes
+
+        with open(filename, 'wb') as f:
+            f.write(_FILE_MAGIC)
+            f.write(np.array(fields, dtype=np.int64).tobytes())
+            for a, offset in zip(arrays, fields[9::2]):
+                if a.nbytes > 0:
+                    f.seek(offset)
+                    a.tofile(f)
+            f.truncate(fields[-2] + fields[-1])
+
+    @classmethod
+    def load(cls, filename, mmap_mode='r'):
+        """
+        load(filename, mmap_mode='r')
+
+        Open a tree written by `cKDTree.save`
+
+        Parameters
+        ----------
+        filename : str
+            The name of the file.
+        mmap_mode : {'r', 'c', None}, optional
+            With 'r' or 'c', the data and indices of the tree are memory
+            mapped from the file, read-only or copy-on-write, as in
+            `numpy.memmap`. Processes that open the same file then share
+            them, and opening the tree does not read them. With None, they
+            are read into memory. Default: 'r'.
+
+        Returns
+        -------
+        tree : cKDTree
+            The tree.
+
+        Notes
+        -----
+        The node array is always read into memory, since the traversals
+        need the pointers between the nodes. It is small next to the data
+        unless the leaves are very small.
+
+        .. versionadded:: 1.4.0
+
+        """
+        cdef:
+            cKDTree self
+            ckdtree *cself
+            np.ndarray mytree
+            np.intp_t n, m, n_nodes
+
+        if mmap_mode not in ('r', 'c', None):
+            raise ValueError("mmap_mode must be 'r', 'c' or None")
+
+        with open(filename, 'rb') as f:
+            head = f.read(len(_FILE_MAGIC) + 8 * _FILE_NFIELDS)
+            if (len(head) < len(_FILE_MAGIC) + 8 * _FILE_NFIELDS or
+                    head[:len(_FILE_MAGIC)] != _FILE_MAGIC):
+                raise ValueError("%s is not a cKDTree file" % (filename,))
+            fields = np.frombuffer(head, dtype=np.int64,
+                                   offset=len(_FILE_MAGIC)).tolist()
+            if fields[0] != _FILE_VERSION:
+                raise ValueError("cKDTree file version %d is not supported"
+                                 % fields[0])
+            if (fields[1] != _FILE_BYTE_ORDER or
+                    fields[2] != sizeof(np.intp_t) or
+                    fields[3] != sizeof(ckdtreenode)):
+                raise ValueError("cKDTree file was written on a machine of "
+                                 "another byte order or word size")
+            n, m, leafsize, n_nodes, itemsize = fields[4:9]
+            sections = dict(zip(_FILE_SECTIONS,
+                                zip(fields[9::2], fields[10::2])))
+            if itemsize == 4:
+                dtype = np.float32
+            elif itemsize == 8:
+                dtype = np.float64
+            else:
+                raise ValueError("invalid data type in cKDTree file")
+
+            def section(name, dtype, shape):
+                offset, nbytes = sections[name]
+                if nbytes == 0:
+                    return None
+                if nbytes != np.dtype(dtype).itemsize * np.prod(shape):
+                    raise ValueError("cKDTree file is corrupt")
+                if mmap_mode is None:
+                    f.seek(offset)
+                    a = np.fromfile(f, dtype=dtype, count=np.prod(shape))
+                    if a.nbytes != nbytes:
+                        raise ValueError("cKDTree file is truncated")
+                    return a.reshape(shape)
+                return np.memmap(filename, dtype=dtype, mode=mmap_mode,
+                                 offset=offset, shape=shape)
+
+            self = cls.__new__(cls)
+            cself = self.cself
+            self.data = section('data', dtype, (n, m))
+            self.indices = section('indices', np.intp, (n,))
+            maxes = section('maxes', np.float64, (m,))
+            mins = section('mins', np.float64, (m,))
+            if (self.data is None or self.indices is None or maxes is None
+                    or mins is None or n_nodes < 1):
+                raise ValueError("cKDTree file is corrupt")
+            self.maxes = np.array(maxes)
+            self.mins = np.array(mins)
+            self.boxsize_data = section('boxsize_data', np.float64, (2 * m,))
+            if self.boxsize_data is not None:
+                self.boxsize_data = np.array(self.boxsize_data)
+                self.boxsize = self.boxsize_data[:m].copy()
+            else:
+                self.boxsize = None
+            self.tree_data = section('tree_data', dtype, (n, m))
+            cself.n = n
+            cself.m = m
+            cself.leafsize = leafsize
+
+            offset, nbytes = sections['nodes']
+            if nbytes != n_nodes * sizeof(ckdtreenode):
+                raise ValueError("cKDTree file is corrupt")
+            cself.tree_buffer = new vector[ckdtreenode]()
+            cself.tree_buffer.resize(n_nodes)
+            mytree = np.asarray(<char[:nbytes]> <char*> &cself.tree_buffer.front())
+            f.seek(offset)
+            if f.readinto(mytree) != nbytes:
+                raise ValueError("cKDTree file is truncated")
+
+        self._pre_init()
+        self._post_init()
+        return self
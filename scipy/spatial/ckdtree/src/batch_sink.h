@@ -0,0 +1,79 @@
+#ifndef CKDTREE_BATCH_SINK
+#define CKDTREE_BATCH_SINK
+
+#include <mutex>
+#include <vector>
+
+#include "ckdtree_decl.h"
+
+/*
+ * Batched output
+ * ==============
+ *
+ * query_pairs and sparse_distance_matrix can hand their results to a
+ * flush function in batches of batch_size entries instead of collecting
+ * all of them, so that memory stays bounded by one batch per thread.
+ *
+ * All batches but the last are full. The flush function is never called
+ * concurrently, but with n_jobs > 1 it may be called from any of the
+ * threads, and the batches come in no particular order. A nonzero return
+ * value stops the traversal; the query then returns -1 without calling
+ * flush again.
+ */
+
+struct batch_output {
+    const ckdtree_intp_t batch_size;
+    const ckdtree_batch_func flush;
+    void *const context;
+    std::mutex lock;
+    bool stopped;
+
+    batch_output(const ckdtree_intp_t batch_size, const ckdtree_batch_func flush,
+                 void *context)
+        : batch_size(batch_size), flush(flush), context(context),
+          stopped(false) {}
+};
+
+/* thrown out of the traversal once flush has asked to stop */
+struct batch_stopped {};
+
+/*
+ * Collects the entries of one thread, with the push_back of a vector, so
+ * that the traversals can write to either
+ */
+template <typename Entry>
+struct batch_sink {
+    batch_output *output;
+    std::vector<Entry> buffer;
+
+    batch_sink() : output(NULL) {}
+    explicit batch_sink(batch_output *output) : output(output) {}
+
+    inline void push_back(const Entry &e) {
+        buffer.push_back(e);
+        if (CKDTREE_UNLIKELY((ckdtree_intp_t)buffer.size() >= output->batch_size))
+            emit();
+    }
+
+    /* add the entries left in another sink */
+    void append(const batch_sink &other) {
+        for (typename std::vector<Entry>::const_iterator it = other.buffer.begin();
+             it != other.buffer.end(); ++it)
+            push_back(*it);
+    }
+
+    /* hand the buffered entries to flush */
+    void emit() {
+        if (buffer.empty())
+            return;
+        std::lock_guard<std::mutex> guard(output->lock);
+        if (output->stopped ||
+                output->flush(output->context, &buffer[0], buffer.size())) {
+            output->stopped = true;
+            throw batch_stopped();
+        }
+        buffer.clear();
+    }
+};
+
+#endif
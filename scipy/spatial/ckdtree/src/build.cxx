@@ -3,6 +3,9 @@
 #include <cstring>
 
 #include <vector>
+#include <thread>
+#include <exception>
+#include <system_error>
 #include <string>
 #include <sstream>
 #include <new>
@@ -16,14 +19,36 @@
 
 #define tree_buffer_root(buf) (&(buf)[0][0])
 
+/*
+ * Subtrees over fewer points than this are always built on the current
+ * thread; starting a thread costs more than building them.
+ */
+#define CKDTREE_BUILD_TASK_MIN_POINTS 65536
+
+/*
+ * Build the subtree over indices[start_idx:end_idx] into tree_buffer, in
+ * preorder: the node itself, then its less subtree, then its greater
+ * subtree. Returns the index of the new node in tree_buffer.
+ *
+ * While spawn_depth > 0, the greater subtree of a large node is built on
+ * a new thread into a buffer of its own, which is appended once the less
+ * subtree is done. The two subtrees cover disjoint ranges of indices,
+ * and the appended nodes have their child indices shifted, so the layout
+ * is exactly that of a serial build.
+ *
+ * data is self->raw_data or self->raw_data_f32. scratch is the working
+ * memory of partition_node_indices on the current thread.
+ */
+template <typename T>
 static ckdtree_intp_t
-build(ckdtree *self, ckdtree_intp_t start_idx, intptr_t end_idx,
+build(ckdtree *self, const T *data, std::vector<ckdtreenode> *tree_buffer,
+      ckdtree_intp_t start_idx, intptr_t end_idx,
       double *maxes, double *mins,
-      const int _median, const int _compact)
+      const int _median, const int _compact, const int spawn_depth,
+      partition_scratch<T> *scratch)
 {
 
     const ckdtree_intp_t m = self->m;
-    const double *data = self->raw_data;
     ckdtree_intp_t *indices = (intptr_t *)(self->raw_indices);
 
     ckdtreenode new_node, *n, *root;
@@ -32,9 +57,9 @@ build(ckdtree *self, ckdtree_intp_t start_idx, intptr_t end_idx,
     double size, split, minval, maxval;
 
     /* put a new node into the node stack */
-    self->tree_buffer->push_back(new_node);
-    node_index = self->tree_buffer->size() - 1;
-    root = tree_buffer_root(self->tree_buffer);
+    tree_buffer->push_back(new_node);
+    node_index = tree_buffer->size() - 1;
+    root = tree_buffer_root(tree_buffer);
     n = root + node_index;
     memset(n, 0, sizeof(n[0]));
 
@@ -55,7 +80,7 @@ build(ckdtree *self, ckdtree_intp_t start_idx, intptr_t end_idx,
              * time. However, construction time is usually dwarfed by the
              * query time by orders of magnitude.
              */
-            const double *tmp_data_point;
+            const T *tmp_data_point;
             tmp_data_point = data + indices[start_idx] * m;
             for(i=0; i<m; ++i) {
                 maxes[i] = tmp_data_point[i];
@@ -97,29 +122,27 @@ build(ckdtree *self, ckdtree_intp_t start_idx, intptr_t end_idx,
              * adopted from scikit-learn
              */
             i = (end_idx - start_idx) / 2;
-            partition_node_indices(data, indices + start_idx, d, i, m,
-                end_idx - start_idx);
-            p = start_idx + i;
-            split = data[indices[p]*m+d];
+            p = start_idx + partition_node_indices(data, indices + start_idx,
+                d, i, m, end_idx - start_idx, scratch, &split);
         }
         else {
             /* split with the sliding midpoint rule */
             split = (maxval + minval) / 2;
-        }
 
-        p = start_idx;
-        q = end_idx - 1;
-        while (p <= q) {
-            if (data[indices[p] * m + d] < split)
-                ++p;
-            else if (data[indices[q] * m + d] >= split)
-                --q;
-            else {
-                ckdtree_intp_t t = indices[p];
-                indices[p] = indices[q];
-                indices[q] = t;
-                ++p;
-                --q;
+            p = start_idx;
+            q = end_idx - 1;
+            while (p <= q) {
+                if (data[indices[p] * m + d] < split)
+                    ++p;
+                else if (data[indices[q] * m + d] >= split)
+                    --q;
+                else {
+                    ckdtree_intp_t t = indices[p];
+                    indices[p] = indices[q];
+                    indices[q] = t;
+                    ++p;
+                    --q;
+                }
             }
         }
         /* slide midpoint if necessary */
@@ -156,9 +179,84 @@ build(ckdtree *self, ckdtree_intp_t start_idx, intptr_t end_idx,
             q = end_idx - 2;
         }
 
-        if (CKDTREE_LIKELY(_compact)) {
-            _less = build(self, start_idx, p, maxes, mins, _median, _compact);
-            _greater = build(self, p, end_idx, maxes, mins, _median, _compact);
+        if (spawn_depth > 0 && end_idx - p >= CKDTREE_BUILD_TASK_MIN_POINTS
+                && p - start_idx >= CKDTREE_BUILD_TASK_MIN_POINTS) {
+            /* the greater subtree gets its own buffer and bounds */
+            std::vector<ckdtreenode> greater_buffer;
+            std::vector<double> greater_bounds(2 * m);
+            double *gmaxes = &greater_bounds[0];
+            double *gmins = &greater_bounds[m];
+            std::vector<double> tmp(m);
+            double *mids = &tmp[0];
+            for (i=0; i<m; ++i) {
+                gmaxes[i] = maxes[i];
+                gmins[i] = mins[i];
+                mids[i] = maxes[i];
+            }
+            if (!_compact) {
+                gmins[d] = split;
+                mids[d] = split;
+            }
+            double *lmaxes = _compact ? maxes : mids;
+
+            std::exception_ptr greater_error;
+            std::thread greater_task;
+            bool spawned = true;
+            try {
+                greater_task = std::thread([&]() {
+                    try {
+                        partition_scratch<T> greater_scratch;
+                        build(self, data, &greater_buffer, p, end_idx, gmaxes, gmins,
+                              _median, _compact, spawn_depth - 1,
+                              &greater_scratch);
+                    }
+                    catch (...) {
+                        greater_error = std::current_exception();
+                    }
+                });
+            }
+            catch (const std::system_error &) {
+                spawned = false;
+            }
+
+            try {
+                _less = build(self, data, tree_buffer, start_idx, p, lmaxes, mins,
+                              _median, _compact, spawn_depth - 1, scratch);
+                if (!spawned) {
+                    build(self, data, &greater_buffer, p, end_idx, gmaxes, gmins,
+                          _median, _compact, spawn_depth - 1, scratch);
+                }
+            }
+            catch (...) {
+                if (spawned) {
+                    greater_task.join();
+                }
+                throw;
+            }
+            if (spawned) {
+                greater_task.join();
+            }
+            if (greater_error) {
+                std::rethrow_exception(greater_error);
+            }
+
+            /* append the greater subtree after the less one */
+            _greater = tree_buffer->size();
+            tree_buffer->reserve(_greater + greater_buffer.size());
+            for (std::vector<ckdtreenode>::iterator it = greater_buffer.begin();
+                 it != greater_buffer.end(); ++it) {
+                if (it->split_dim != -1) {
+                    it->_less += _greater;
+                    it->_greater += _greater;
+                }
+                tree_buffer->push_back(*it);
+            }
+        }
+        else if (CKDTREE_LIKELY(_compact)) {
+            _less = build(self, data, tree_buffer, start_idx, p, maxes, mins,
+                          _median, _compact, spawn_depth, scratch);
+            _greater = build(self, data, tree_buffer, p, end_idx, maxes, mins,
+                             _median, _compact, spawn_depth, scratch);
         }
         else
         {
@@ -167,17 +265,19 @@ build(ckdtree *self, ckdtree_intp_t start_idx, intptr_t end_idx,
 
             for (i=0; i<m; ++i) mids[i] = maxes[i];
             mids[d] = split;
-            _less = build(self, start_idx, p, mids, mins, _median, _compact);
+            _less = build(self, data, tree_buffer, start_idx, p, mids, mins,
+                          _median, _compact, spawn_depth, scratch);
 
             for (i=0; i<m; ++i) mids[i] = mins[i];
             mids[d] = split;
-            _greater = build(self, p, end_idx, maxes, mids, _median, _compact);
+            _greater = build(self, data, tree_buffer, p, end_idx, maxes, mids,
+                             _median, _compact, spawn_depth, scratch);
         }
 
         /* recompute n because std::vector can
          * reallocate its internal buffer
          */
-        root = tree_buffer_root(self->tree_buffer);
+        root = tree_buffer_root(tree_buffer);
         n = root + node_index;
         /* fill in entries */
         n->_less = _less;
@@ -194,10 +294,62 @@ build(ckdtree *self, ckdtree_intp_t start_idx, intptr_t end_idx,
 
 
 int build_ckdtree(ckdtree *self, ckdtree_intp_t start_idx, intptr_t end_idx,
-              double *maxes, double *mins, int _median, int _compact)
+              double *maxes, double *mins, int _median, int _compact,
+              int n_jobs)
 
 {
-    build(self, start_idx, end_idx, maxes, mins, _median, _compact);
+    /* enough levels of spawning to give every job a subtree */
+    int spawn_depth = 0;
+    while (spawn_depth < 30 && (1 << spawn_depth) < n_jobs) {
+        ++spawn_depth;
+    }
+    if (self->raw_data_f32 != NULL) {
+        partition_scratch<float> scratch;
+        build(self, (const float *)self->raw_data_f32, self->tree_buffer,
+              start_idx, end_idx, maxes, mins, _median, _compact, spawn_depth,
+              &scratch);
+    }
+    else {
+        partition_scratch<double> scratch;
+        build(self, (const double *)self->raw_data, self->tree_buffer,
+              start_idx, end_idx, maxes, mins, _median, _compact, spawn_depth,
+              &scratch);
+    }
+    return 0;
+}
+
+/*
+ * Fill self->hot_buffer from self->tree_buffer. A node's place in the
+ * breadth-first order is the number of nodes queued before it, and its
+ * children get the next two free slots.
+ */
+int
+build_hot_nodes(ckdtree *self)
+{
+    const ckdtreenode *root = tree_buffer_root(self->tree_buffer);
+    std::vector<ckdtreehotnode> &hot = *self->hot_buffer;
+    std::vector<const ckdtreenode*> order;
+    ckdtree_intp_t i;
+
+    hot.resize(self->tree_buffer->size());
+    order.reserve(self->tree_buffer->size());
+    order.push_back(root);
+
+    for (i = 0; i < (ckdtree_intp_t)order.size(); ++i) {
+        const ckdtreenode *n = order[i];
+        ckdtreehotnode &h = hot[i];
+        h.split_dim = n->split_dim;
+        if (n->split_dim == -1) {
+            h.start_idx = n->start_idx;
+            h.end_idx = n->end_idx;
+        }
+        else {
+            h.split = n->split;
+            h.less = order.size();
+            order.push_back(root + n->_less);
+            order.push_back(root + n->_greater);
+        }
+    }
     return 0;
 }
 
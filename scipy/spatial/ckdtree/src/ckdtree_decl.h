@@ -33,10 +33,41 @@ struct ckdtreenode {
     ckdtree_intp_t      _greater;
 };
 
+/*
+ * Compact copy of a node, for the hot loop of query_knn
+ *
+ * The hot nodes are stored in breadth-first order with the two children
+ * of a node next to each other, so a 24 byte node is all that a descent
+ * touches. The bounds of a leaf reuse the fields of an inner node.
+ */
+struct ckdtreehotnode {
+    ckdtree_intp_t      split_dim;  /* -1 for leaves */
+    union {
+        double          split;      /* inner nodes */
+        ckdtree_intp_t  start_idx;  /* leaves */
+    };
+    union {
+        ckdtree_intp_t  less;       /* inner nodes: index of the less child,
+                                       the greater child follows it */
+        ckdtree_intp_t  end_idx;    /* leaves */
+    };
+};
+
+/* Counters of the work done by the queries, see traversal_stats.h */
+struct ckdtree_stats {
+    ckdtree_intp_t      nodes_visited;
+    ckdtree_intp_t      leaves_scanned;
+    ckdtree_intp_t      distance_evaluations;
+    ckdtree_intp_t      pruned_subtrees;
+    ckdtree_intp_t      heap_pushes;
+    ckdtree_intp_t      max_stack_depth;
+};
+
 struct ckdtree {
     // tree structure
     std::vector<ckdtreenode>  *tree_buffer;
     ckdtreenode   *ctree;
+    std::vector<ckdtreehotnode>  *hot_buffer;
     // meta data
     double   *raw_data;
     ckdtree_intp_t      n;
@@ -47,17 +78,30 @@ struct ckdtree {
     ckdtree_intp_t      *raw_indices;
     double   *raw_boxsize_data;
     ckdtree_intp_t size;
+    // optional copy of raw_data in tree order, raw_data[raw_indices[i]]
+    // is raw_tree_data[i]; NULL if not stored
+    double   *raw_tree_data;
+    // the same in single precision, for trees built on float32 data; the
+    // double precision pointers are NULL then and these are used instead
+    float    *raw_data_f32;
+    float    *raw_tree_data_f32;
+    // the counters that queries add to; NULL if not collected
+    ckdtree_stats *stats;
 };
 
 /* Build methods in C++ for better speed and GIL release */
 
 int
 build_ckdtree(ckdtree *self, ckdtree_intp_t start_idx, intptr_t end_idx,
-              double *maxes, double *mins, int _median, int _compact);
+              double *maxes, double *mins, int _median, int _compact,
+              int n_jobs);
 
 int
 build_weights (ckdtree *self, double *node_weights, double *weights);
 
+int
+build_hot_nodes(ckdtree *self);
+
 /* Query methods in C++ for better speed and GIL release */
 
 int
@@ -71,14 +115,36 @@ query_knn(const ckdtree     *self,
           const ckdtree_intp_t     kmax,
           const double  eps,
           const double  p,
-          const double  distance_upper_bound);
+          const double  distance_upper_bound,
+          const ckdtree_intp_t max_leaves,
+          ckdtree_intp_t *n_capped,
+          const int reorder_queries,
+          const int n_jobs);
 
 int
 query_pairs(const ckdtree *self,
             const double r,
             const double p,
             const double eps,
-            std::vector<ordered_pair> *results);
+            std::vector<ordered_pair> *results,
+            const int n_jobs);
+
+/*
+ * Receives n ordered_pair or coo_entry results of the batched queries,
+ * see batch_sink.h; returns nonzero to stop the query
+ */
+typedef int (*ckdtree_batch_func)(void *context, const void *entries,
+                                  const ckdtree_intp_t n);
+
+int
+query_pairs_batched(const ckdtree *self,
+                    const double r,
+                    const double p,
+                    const double eps,
+                    const ckdtree_intp_t batch_size,
+                    ckdtree_batch_func flush,
+                    void *context,
+                    const int n_jobs);
 
 int
 count_neighbors_unweighted(const ckdtree *self,
@@ -87,7 +153,8 @@ count_neighbors_unweighted(const ckdtree *self,
                 double *real_r,
                 ckdtree_intp_t *results,
                 const double p,
-                int cumulative);
+                int cumulative,
+                const int n_jobs);
 
 int
 count_neighbors_weighted(const ckdtree *self,
@@ -100,7 +167,8 @@ count_neighbors_weighted(const ckdtree *self,
                 double *real_r,
                 double *results,
                 const double p,
-                int cumulative);
+                int cumulative,
+                const int n_jobs);
 
 int
 query_ball_point(const ckdtree *self,
@@ -110,7 +178,20 @@ query_ball_point(const ckdtree *self,
                  const double eps,
                  const ckdtree_intp_t n_queries,
                  std::vector<ckdtree_intp_t> **results,
-                 const int return_length);
+                 const int return_length,
+                 const int n_jobs);
+
+int
+query_ball_point_csr(const ckdtree *self,
+                     const double *x,
+                     const double *r,
+                     const double p,
+                     const double eps,
+                     const ckdtree_intp_t n_queries,
+                     const int sort_rows,
+                     std::vector<ckdtree_intp_t> *indices,
+                     ckdtree_intp_t *indptr,
+                     const int n_jobs);
 
 int
 query_ball_tree(const ckdtree *self,
@@ -118,15 +199,37 @@ query_ball_tree(const ckdtree *self,
                 const double r,
                 const double p,
                 const double eps,
-                std::vector<ckdtree_intp_t> **results
+                std::vector<ckdtree_intp_t> **results,
+                const int n_jobs
                 );
 
+int
+query_ball_tree_csr(const ckdtree *self,
+                    const ckdtree *other,
+                    const double r,
+                    const double p,
+                    const double eps,
+                    std::vector<ckdtree_intp_t> *indices,
+                    ckdtree_intp_t *indptr,
+                    const int n_jobs);
+
 int
 sparse_distance_matrix(const ckdtree *self,
                        const ckdtree *other,
                        const double p,
                        const double max_distance,
-                       std::vector<coo_entry> *results);
+                       std::vector<coo_entry> *results,
+                       const int n_jobs);
+
+int
+sparse_distance_matrix_batched(const ckdtree *self,
+                               const ckdtree *other,
+                               const double p,
+                               const double max_distance,
+                               const ckdtree_intp_t batch_size,
+                               ckdtree_batch_func flush,
+                               void *context,
+                               const int n_jobs);
 
 
 #endif
@@ -13,6 +13,8 @@
 
 #include "ckdtree_decl.h"
 #include "rectangle.h"
+#include "leaf_scan.h"
+#include "parallel_traverse.h"
 
 struct WeightedTree {
     const ckdtree *tree;
@@ -28,6 +30,49 @@ struct CNBParams
     int cumulative;
 };
 
+/*
+ * Bins
+ * ====
+ *
+ * The bins are searched for every node pair and every pair of points in
+ * the leaves. bin_lower_bound is std::lower_bound with a fixed number of
+ * halvings for the number of bins, whose comparisons compile to
+ * conditional moves instead of mispredicted branches.
+ *
+ * With cumulative counting, a pair adds to all the bins from the first
+ * one that holds its distance to the end of the range. The traversal
+ * then writes the results as a difference array, one addition at the
+ * first bin and one subtraction at the end, which add_cumulative turns
+ * into the counts; the work per pair no longer grows with the number of
+ * bins.
+ */
+
+static inline double *
+bin_lower_bound(double *first, double *last, const double d)
+{
+    ckdtree_intp_t n = last - first;
+    if (n == 0)
+        return first;
+    while (n > 1) {
+        const ckdtree_intp_t half = n / 2;
+        first = (first[half - 1] < d) ? first + half : first;
+        n -= half;
+    }
+    return first + (*first < d);
+}
+
+/* add the prefix sums of the difference array diff to results */
+template <typename ResultType> static void
+add_cumulative(ResultType *results, const ResultType *diff,
+               const ckdtree_intp_t n)
+{
+    ResultType sum = 0;
+    for (ckdtree_intp_t i = 0; i < n; ++i) {
+        sum += diff[i];
+        results[i] += sum;
+    }
+}
+
 template <typename MinMaxDist, typename WeightType, typename ResultType> static void
 traverse(
     RectRectDistanceTracker<MinMaxDist> *tracker,
@@ -44,25 +89,26 @@ traverse(
 
     ResultType *results = (ResultType*) params->results;
 
+    ++tracker->stats.nodes_visited;
+
     /*
      * Speed through pairs of nodes all of whose children are close
      * and see if any work remains to be done
      */
 
-    double * new_start = std::lower_bound(start, end, tracker->min_distance);
-    double * new_end = std::lower_bound(start, end, tracker->max_distance);
+    double * new_start = bin_lower_bound(start, end, tracker->min_distance);
+    double * new_end = bin_lower_bound(start, end, tracker->max_distance);
 
 
     /* since max_distance >= min_distance, end < start never happens */
     if (params->cumulative) {
-        double * i;
         if (new_end != end) {
             ResultType nn = WeightType::get_weight(&params->self, node1)
                           * WeightType::get_weight(&params->other, node2);
 
-            for (i = new_end; i < end; ++i) {
-                results[i - params->r] += nn;
-            }
+            /* the bins new_end to end, in the difference array */
+            results[new_end - params->r] += nn;
+            results[end - params->r] -= nn;
         }
         /* any bins larger than end have been correctly counted, thus
          * thus we can truncate the queries in future of this branch of the traversal*/
@@ -81,71 +127,36 @@ traverse(
 
     if (end == start) {
         /* this pair falls into exactly one bin, no need to probe deeper. */
+        ++tracker->stats.pruned_subtrees;
         return;
     }
 
     /* OK, need to probe a bit deeper */
     if (node1->split_dim == -1) {  /* 1 is leaf node */
         if (node2->split_dim == -1) {  /* 1 & 2 are leaves */
-            ckdtree_intp_t i, j;
-            const double p = tracker->p;
-            const double tmd = tracker->max_distance;
-            const double *sdata = params->self.tree->raw_data;
             const ckdtree_intp_t *sindices = params->self.tree->raw_indices;
-            const double *odata = params->other.tree->raw_data;
             const ckdtree_intp_t *oindices = params->other.tree->raw_indices;
-            const ckdtree_intp_t m = params->self.tree->m;
-            const ckdtree_intp_t start1 = node1->start_idx;
-            const ckdtree_intp_t start2 = node2->start_idx;
-            const ckdtree_intp_t end1 = node1->end_idx;
-            const ckdtree_intp_t end2 = node2->end_idx;
-
-            CKDTREE_PREFETCH(sdata + sindices[start1] * m, 0, m);
-
-            if (start1 < end1 - 1)
-                CKDTREE_PREFETCH(sdata + sindices[start1+1] * m, 0, m);
 
             /* brute-force */
-            for (i = start1; i < end1; ++i) {
-
-                if (i < end1 - 2)
-                    CKDTREE_PREFETCH(sdata + sindices[i+2] * m, 0, m);
-
-                CKDTREE_PREFETCH(odata + oindices[start2] * m, 0, m);
-
-                if (start2 < end2 - 1)
-                    CKDTREE_PREFETCH(odata + oindices[start2+1] * m, 0, m);
-
-                for (j = start2; j < end2; ++j) {
-
-                    if (j < end2 - 2)
-                        CKDTREE_PREFETCH(odata + oindices[j+2] * m, 0, m);
-
-                    double d = MinMaxDist::point_point_p(params->self.tree,
-                            sdata + sindices[i] * m,
-                            odata + oindices[j] * m,
-                            p, m, tmd);
-
-                    if (params->cumulative) {
-                        /*
-                         * I think it's usually cheaper to test d against all
-                         * r's than to generate a distance array, sort it, then
-                         * search for all r's via binary search
-                         */
-                        double * l;
-                        for (l = start; l < end; ++l) {
-                            if (d <= *l) {
-                                results[l - params->r] += WeightType::get_weight(&params->self, sindices[i])
-                                                        * WeightType::get_weight(&params->other, sindices[j]);
-                            }
-                        }
-                    } else {
-                        const double *l = std::lower_bound(start, end, d);
-                        results[l - params->r] += WeightType::get_weight(&params->self, sindices[i])
-                                                * WeightType::get_weight(&params->other, sindices[j]);
-                    }
-                }
-            }
+            ++tracker->stats.leaves_scanned;
+            tracker->stats.distance_evaluations +=
+                (node1->end_idx - node1->start_idx)
+              * (node2->end_idx - node2->start_idx);
+            scan_leaf_pair<MinMaxDist>(params->self.tree, params->other.tree,
+                                       node1, node2, tracker->p,
+                                       tracker->max_distance, false,
+                    [&](const ckdtree_intp_t i, const ckdtree_intp_t j,
+                        const double d) {
+                double * l = bin_lower_bound(start, end, d);
+                if (params->cumulative && l == end)
+                    return;
+                const ResultType w =
+                    WeightType::get_weight(&params->self, sindices[i])
+                  * WeightType::get_weight(&params->other, oindices[j]);
+                results[l - params->r] += w;
+                if (params->cumulative)
+                    results[end - params->r] -= w;
+            });
         }
         else {  /* 1 is a leaf node, 2 is inner node */
             tracker->push_less_of(2, node2);
@@ -192,9 +203,46 @@ traverse(
     }
 }
 
+/*
+ * Count on n_jobs threads, with one set of bins per chunk of node pairs;
+ * the bins are added up in chunk order
+ */
+template <typename MinMaxDist, typename WeightType, typename ResultType> static void
+traverse_parallel(const CNBParams *params, const ckdtree_intp_t n_queries,
+                  const Rectangle &r1, const Rectangle &r2, const double p,
+                  const int n_jobs)
+{
+    const ckdtree *self = params->self.tree;
+    const ckdtree *other = params->other.tree;
+    std::vector<NodePair> pairs = split_node_pairs(self, other, r1, r2,
+                                                   SPLIT_BOTH, n_jobs);
+
+    std::vector<std::vector<ResultType> > chunk_results =
+        traverse_node_pairs<MinMaxDist, std::vector<ResultType> >(
+            self, pairs, p, 0.0, 0.0, n_jobs,
+            [&](RectRectDistanceTracker<MinMaxDist> *tracker,
+                const NodePair &pair, std::vector<ResultType> &results) {
+        if (results.empty())
+            results.resize(n_queries + 1);
+        CNBParams local = *params;
+        local.results = (void*) &results[0];
+        traverse<MinMaxDist, WeightType, ResultType>(tracker, &local,
+            params->r, params->r + n_queries, pair.node1, pair.node2);
+        tracker->stats.commit(self);
+    });
+
+    /* the bins of the chunks, or with cumulative counting their difference arrays */
+    ResultType *results = (ResultType*) params->results;
+    for (ckdtree_intp_t c = 0; c < (ckdtree_intp_t)chunk_results.size(); ++c) {
+        const std::vector<ResultType> &bins = chunk_results[c];
+        for (ckdtree_intp_t i = 0; i < (ckdtree_intp_t)bins.size(); ++i)
+            results[i] += bins[i];
+    }
+}
+
 template <typename WeightType, typename ResultType> void
 count_neighbors(struct CNBParams *params,
-                ckdtree_intp_t n_queries, const double p)
+                ckdtree_intp_t n_queries, const double p, const int n_jobs)
 {
 
     const ckdtree *self = params->self.tree;
@@ -202,20 +250,40 @@ count_neighbors(struct CNBParams *params,
 
 #define HANDLE(cond, kls) \
     if (cond) { \
-        RectRectDistanceTracker<kls> tracker(self, r1, r2, p, 0.0, 0.0);\
-        traverse<kls, WeightType, ResultType>(&tracker, params, params->r, params->r+n_queries, \
-                 self->ctree, other->ctree); \
+        if (n_jobs > 1) { \
+            traverse_parallel<kls, WeightType, ResultType>(&local, n_queries, \
+                 r1, r2, p, n_jobs); \
+        } else { \
+            RectRectDistanceTracker<kls> tracker(self, r1, r2, p, 0.0, 0.0);\
+            traverse<kls, WeightType, ResultType>(&tracker, &local, params->r, params->r+n_queries, \
+                     self->ctree, other->ctree); \
+            tracker.stats.commit(self); \
+        } \
     } else
 
     Rectangle r1(self->m, self->raw_mins, self->raw_maxes);
     Rectangle r2(other->m, other->raw_mins, other->raw_maxes);
 
+    /* cumulative counts are collected as a difference array */
+    CNBParams local = *params;
+    std::vector<ResultType> diff;
+    if (params->cumulative) {
+        diff.resize(n_queries + 1);
+        local.results = (void*) &diff[0];
+    }
+
     if (CKDTREE_LIKELY(self->raw_boxsize_data == NULL)) {
         HANDLE(CKDTREE_LIKELY(p == 2), MinkowskiDistP2)
         HANDLE(p == 1, MinkowskiDistP1)
         HANDLE(ckdtree_isinf(p), MinkowskiDistPinf)
         HANDLE(1, MinkowskiDistPp)
         {}
+    } else if (ckdtree_all_periodic(self)) {
+        HANDLE(CKDTREE_LIKELY(p == 2), PeriodicMinkowskiDistP2)
+        HANDLE(p == 1, PeriodicMinkowskiDistP1)
+        HANDLE(ckdtree_isinf(p), PeriodicMinkowskiDistPinf)
+        HANDLE(1, PeriodicMinkowskiDistPp)
+        {}
     } else {
         HANDLE(CKDTREE_LIKELY(p == 2), BoxMinkowskiDistP2)
         HANDLE(p == 1, BoxMinkowskiDistP1)
@@ -223,6 +291,10 @@ count_neighbors(struct CNBParams *params,
         HANDLE(1, BoxMinkowskiDistPp)
         {}
     }
+#undef HANDLE
+
+    if (params->cumulative)
+        add_cumulative((ResultType*) params->results, &diff[0], n_queries);
 }
 
 struct Unweighted {
@@ -243,7 +315,7 @@ struct Unweighted {
 int
 count_neighbors_unweighted(const ckdtree *self, const ckdtree *other,
                 ckdtree_intp_t n_queries, double *real_r, intptr_t *results,
-                const double p, int cumulative) {
+                const double p, int cumulative, const int n_jobs) {
 
     CNBParams params = {0};
 
@@ -253,7 +325,7 @@ count_neighbors_unweighted(const ckdtree *self, const ckdtree *other,
     params.other.tree = other;
     params.cumulative = cumulative;
 
-    count_neighbors<Unweighted, ckdtree_intp_t>(&params, n_queries, p);
+    count_neighbors<Unweighted, ckdtree_intp_t>(&params, n_queries, p, n_jobs);
 
     return 0;
 }
@@ -279,7 +351,7 @@ count_neighbors_weighted(const ckdtree *self, const ckdtree *other,
                 double *self_weights, double *other_weights,
                 double *self_node_weights, double *other_node_weights,
                 ckdtree_intp_t n_queries, double *real_r, double *results,
-                const double p, int cumulative)
+                const double p, int cumulative, const int n_jobs)
 {
 
     CNBParams params = {0};
@@ -299,7 +371,7 @@ count_neighbors_weighted(const ckdtree *self, const ckdtree *other,
         params.other.node_weights = other_node_weights;
     }
 
-    count_neighbors<Weighted, double>(&params, n_queries, p);
+    count_neighbors<Weighted, double>(&params, n_queries, p, n_jobs);
 
     return 0;
 }
@@ -35,11 +35,20 @@ struct PlainDist1D {
                               rect2.maxes()[k] - rect1.mins()[k]);
     }
 
+    template <typename T1, typename T2>
     static inline double
     point_point(const ckdtree * tree,
-               const double *x, const double *y,
+               const T1 *x, const T2 *y,
                  const ckdtree_intp_t k) {
-        return ckdtree_fabs(x[k] - y[k]);
+        return ckdtree_fabs((double)x[k] - (double)y[k]);
+    }
+
+    template <typename T1, typename T2>
+    static inline double
+    point_point_block(const ckdtree * tree,
+               const T1 *x, const T2 *y,
+               const ckdtree_intp_t k) {
+        return point_point(tree, x, y, k);
     }
 };
 
@@ -51,17 +60,23 @@ typedef BaseMinkowskiDistP2<PlainDist1D> NonOptimizedMinkowskiDistP2;
 /*
  * Measuring distances
  * ===================
+ *
+ * The points may be stored in single precision; the distances are always
+ * computed in double precision.
  */
+template <typename T1, typename T2>
 inline double
-sqeuclidean_distance_double(const double *u, const double *v, ckdtree_intp_t n)
+sqeuclidean_distance_double(const T1 *u, const T2 *v, ckdtree_intp_t n)
 {
     double s;
     ckdtree_intp_t i;
     // manually unrolled loop, might be vectorized
     double acc[4] = {0., 0., 0., 0.};
     for (i = 0; i < n/4; i += 4) {
-        double _u[4] = {u[i], u[i + 1], u[i + 2], u[i + 3]};
-        double _v[4] = {v[i], v[i + 1], v[i + 2], v[i + 3]};
+        double _u[4] = {(double)u[i], (double)u[i + 1],
+                        (double)u[i + 2], (double)u[i + 3]};
+        double _v[4] = {(double)v[i], (double)v[i + 1],
+                        (double)v[i + 2], (double)v[i + 3]};
         double diff[4] = {_u[0] - _v[0],
                                _u[1] - _v[1],
                                _u[2] - _v[2],
@@ -74,7 +89,7 @@ sqeuclidean_distance_double(const double *u, const double *v, ckdtree_intp_t n)
     s = acc[0] + acc[1] + acc[2] + acc[3];
     if (i < n) {
         for(; i<n; ++i) {
-            double d = u[i] - v[i];
+            double d = (double)u[i] - (double)v[i];
             s += d * d;
         }
     }
@@ -83,17 +98,99 @@ sqeuclidean_distance_double(const double *u, const double *v, ckdtree_intp_t n)
 
 
 struct MinkowskiDistP2: NonOptimizedMinkowskiDistP2 {
+    template <typename T1, typename T2>
     static inline double
     point_point_p(const ckdtree * tree,
-               const double *x, const double *y,
+               const T1 *x, const T2 *y,
                const double p, const ckdtree_intp_t k,
                const double upperbound)
     {
         return sqeuclidean_distance_double(x, y, k);
     }
+
+    /*
+     * Block version of sqeuclidean_distance_double, four rows at a time.
+     * The partial sums are formed in the same order as there: four
+     * accumulators over the first `head` coordinates, then the rest one
+     * by one.
+     */
+    template <typename T>
+    static inline void
+    point_block_p(const ckdtree * tree,
+                  const double *x, const T *block,
+                  const ckdtree_intp_t n, const double p,
+                  const ckdtree_intp_t k, const double upperbound,
+                  double *out)
+    {
+        const ckdtree_intp_t head = 4 * ((k / 4 + 3) / 4);
+        ckdtree_intp_t i, j;
+        int c, l;
+
+        for (j = 0; j + CKDTREE_BLOCK_LANES <= n; j += CKDTREE_BLOCK_LANES) {
+            const T *y = block + j * k;
+            double acc[4][CKDTREE_BLOCK_LANES];
+            double s[CKDTREE_BLOCK_LANES];
+
+            for (c = 0; c < 4; ++c)
+                for (l = 0; l < CKDTREE_BLOCK_LANES; ++l)
+                    acc[c][l] = 0;
+
+            for (i = 0; i < head; i += 4) {
+                for (c = 0; c < 4; ++c) {
+                    for (l = 0; l < CKDTREE_BLOCK_LANES; ++l) {
+                        const double d = (double)y[l * k + i + c] - x[i + c];
+                        acc[c][l] += d * d;
+                    }
+                }
+            }
+            for (l = 0; l < CKDTREE_BLOCK_LANES; ++l)
+                s[l] = acc[0][l] + acc[1][l] + acc[2][l] + acc[3][l];
+            for (i = head; i < k; ++i) {
+                for (l = 0; l < CKDTREE_BLOCK_LANES; ++l) {
+                    const double d = (double)y[l * k + i] - x[i];
+                    s[l] += d * d;
+                }
+            }
+
+            for (l = 0; l < CKDTREE_BLOCK_LANES; ++l)
+                out[j + l] = s[l];
+        }
+
+        for (; j < n; ++j)
+            out[j] = sqeuclidean_distance_double(block + j * k, x, k);
+    }
 };
 
-struct BoxDist1D {
+/*
+ * Periodic distances
+ * ==================
+ *
+ * PeriodicDist1D is for a dimension with a positive box size. The
+ * distances are computed from the nonperiodic ones with selections
+ * instead of branches, so that the loops over the dimensions and over a
+ * block of points can be vectorized. Only point_point, for one point at a
+ * time, keeps a branch. The points are in the box, where the distances
+ * are the same as those of the branchy code these replace.
+ *
+ * BoxDist1D also allows non periodic dimensions (box size 0) and uses
+ * PeriodicDist1D for the others. Trees where every dimension is periodic
+ * are queried with PeriodicDist1D directly, see ckdtree_all_periodic.
+ */
+
+/* min and max that compile to a single instruction, unlike fmin and fmax */
+static inline double
+periodic_min(const double a, const double b)
+{
+    return b < a ? b : a;
+}
+
+static inline double
+periodic_max(const double a, const double b)
+{
+    return a < b ? b : a;
+}
+
+struct PeriodicDist1D {
     static inline void _interval_interval_1d (
         double min, double max,
         double *realmin, double *realmax,
@@ -103,19 +200,111 @@ struct BoxDist1D {
         /* Minimum and maximum distance of two intervals in a periodic box
          *
          * min and max is the nonperiodic distance between the near
-         * and far edges.
-         *
-         * full and half are the box size and 0.5 * box size.
-         *
-         * value is returned in realmin and realmax;
-         *
-         * This function is copied from kdcount, and the convention
-         * of is that
+         * and far edges, with the convention of kdcount,
          *
          * min = rect1.min - rect2.max
          * max = rect1.max - rect2.min = - (rect2.min - rect1.max)
          *
-         * We will fix the convention later.
+         * full and half are the box size and 0.5 * box size. A
+         * displacement d is at the distance min(|d|, full - |d|); the
+         * displacements between the intervals are those in [min, max].
+         */
+        const double a = ckdtree_fabs(min);
+        const double b = ckdtree_fabs(max);
+        const double near = periodic_min(a, b);
+        const double far = periodic_max(a, b);
+        /* do the intervals overlap, i.e. does [min, max] pass through 0 */
+        const bool overlap = (min < 0) & (max > 0);
+
+        *realmin = overlap ? 0. : periodic_min(near, full - far);
+        *realmax = periodic_min(periodic_min(far, half),
+                                full - (overlap ? 0. : near));
+    }
+
+    static inline void
+    interval_interval(const ckdtree * tree,
+                        const Rectangle& rect1, const Rectangle& rect2,
+                        const ckdtree_intp_t k,
+                        double *min, double *max)
+    {
+        /* Compute the minimum/maximum distance along dimension k between points in
+         * two hyperrectangles.
+         */
+        _interval_interval_1d(rect1.mins()[k] - rect2.maxes()[k],
+                    rect1.maxes()[k] - rect2.mins()[k], min, max,
+                    tree->raw_boxsize_data[k], tree->raw_boxsize_data[k + rect1.m]);
+    }
+
+    template <typename T1, typename T2>
+    static inline double
+    point_point(const ckdtree * tree,
+               const T1 *x, const T2 *y,
+               const ckdtree_intp_t k)
+    {
+        /*
+         * The points are in the box, so |x - y| < box size. The branch is
+         * rarely taken and cheaper than the selection in point_point_block
+         * for a single point.
+         */
+        const double r = ckdtree_fabs((double)x[k] - (double)y[k]);
+        if (CKDTREE_UNLIKELY(r > tree->raw_boxsize_data[k + tree->m]))
+            return tree->raw_boxsize_data[k] - r;
+        return r;
+    }
+
+    template <typename T1, typename T2>
+    static inline double
+    point_point_block(const ckdtree * tree,
+               const T1 *x, const T2 *y,
+               const ckdtree_intp_t k)
+    {
+        /* as point_point, for the vectorized loops of point_block_p */
+        const double r = ckdtree_fabs((double)x[k] - (double)y[k]);
+        return periodic_min(r, tree->raw_boxsize_data[k] - r);
+    }
+
+    static inline const double side_distance_from_min_max(
+        const ckdtree * tree, const double x,
+        const double min,
+        const double max,
+        const ckdtree_intp_t k
+        )
+    {
+        const double fb = tree->raw_boxsize_data[k];
+        const double tmax = x - max;
+        const double tmin = x - min;
+        const double a = ckdtree_fabs(tmax);
+        const double b = ckdtree_fabs(tmin);
+        /* is the test point in this range */
+        const bool inside = (tmax < 0) & (tmin > 0);
+
+        /* the closer edge, or the further one wrapped */
+        return inside ? 0. : periodic_min(periodic_min(a, b),
+                                          fb - periodic_max(a, b));
+    }
+};
+
+/* true if every dimension of the box of tree is periodic */
+static inline bool
+ckdtree_all_periodic(const ckdtree * tree)
+{
+    for (ckdtree_intp_t k = 0; k < tree->m; ++k)
+        if (!(tree->raw_boxsize_data[k] > 0))
+            return false;
+    return true;
+}
+
+struct BoxDist1D {
+    static inline void _interval_interval_1d (
+        double min, double max,
+        double *realmin, double *realmax,
+        const double full, const double half
+    )
+    {
+        /* Minimum and maximum distance of two intervals in a periodic box
+         *
+         * As PeriodicDist1D::_interval_interval_1d, for a box that may
+         * have non periodic dimensions.
          * */
         if (CKDTREE_UNLIKELY(full <= 0)) {
             /* A non-periodic dimension */
@@ -140,36 +329,8 @@ struct BoxDist1D {
             /* done with non-periodic dimension */
             return;
         }
-        if(max <= 0 || min >= 0) {
-            /* do not pass through 0 */
-            min = ckdtree_fabs(min);
-            max = ckdtree_fabs(max);
-            if(min > max) {
-                double t = min;
-                min = max;
-                max = t;
-            }
-            if(max < half) {
-                /* all below half*/
-                *realmin = min;
-                *realmax = max;
-            } else if(min > half) {
-                /* all above half */
-                *realmax = full - min;
-                *realmin = full - max;
-            } else {
-                /* min below, max above */
-                *realmax = half;
-                *realmin = ckdtree_fmin(min, full - max);
-            }
-        } else {
-            /* pass though 0 */
-            min = -min;
-            if(min > max) max = min;
-            if(max > half) max = half;
-            *realmax = max;
-            *realmin = 0;
-        }
+        PeriodicDist1D::_interval_interval_1d(min, max, realmin, realmax,
+                                              full, half);
     }
     static inline void
     interval_interval(const ckdtree * tree,
@@ -185,15 +346,25 @@ struct BoxDist1D {
                     tree->raw_boxsize_data[k], tree->raw_boxsize_data[k + rect1.m]);
     }
 
+    template <typename T1, typename T2>
     static inline double
     point_point(const ckdtree * tree,
-               const double *x, const double *y,
+               const T1 *x, const T2 *y,
+               const ckdtree_intp_t k)
+    {
+        const double fb = tree->raw_boxsize_data[k];
+        if (CKDTREE_UNLIKELY(fb <= 0))
+            return PlainDist1D::point_point(tree, x, y, k);
+        return PeriodicDist1D::point_point(tree, x, y, k);
+    }
+
+    template <typename T1, typename T2>
+    static inline double
+    point_point_block(const ckdtree * tree,
+               const T1 *x, const T2 *y,
                const ckdtree_intp_t k)
     {
-        double r1;
-        r1 = wrap_distance(x[k] - y[k], tree->raw_boxsize_data[k + tree->m], tree->raw_boxsize_data[k]);
-        r1 = ckdtree_fabs(r1);
-        return r1;
+        return point_point(tree, x, y, k);
     }
 
     static inline const double
@@ -215,63 +386,12 @@ struct BoxDist1D {
         const ckdtree_intp_t k
         )
     {
-        double s, t, tmin, tmax;
-        double fb = tree->raw_boxsize_data[k];
-        double hb = tree->raw_boxsize_data[k + tree->m];
-
-        if (fb <= 0) {
+        if (tree->raw_boxsize_data[k] <= 0) {
             /* non-periodic dimension */
-            s = PlainDist1D::side_distance_from_min_max(tree, x, min, max, k);
-            return s;
+            return PlainDist1D::side_distance_from_min_max(tree, x, min, max, k);
         }
-
-        /* periodic */
-        s = 0;
-        tmax = x - max;
-        tmin = x - min;
-        /* is the test point in this range */
-        if(CKDTREE_LIKELY(tmax < 0 && tmin > 0)) {
-            /* yes. min distance is 0 */
-            return 0;
-        }
-
-        /* no */
-        tmax = ckdtree_fabs(tmax);
-        tmin = ckdtree_fabs(tmin);
-
-        /* make tmin the closer edge */
-        if(tmin > tmax) { t = tmin; tmin = tmax; tmax = t; }
-
-        /* both edges are less than half a box. */
-        /* no wrapping, use the closer edge */
-        if(tmax < hb) return tmin;
-
-        /* both edge are more than half a box. */
-        /* wrapping on both edge, use the
-         * wrapped further edge */
-        if(tmin > hb) return fb - tmax;
-
-        /* the further side is wrapped */
-        tmax = fb - tmax;
-        if(tmin > tmax) return tmax;
-        return tmin;
+        return PeriodicDist1D::side_distance_from_min_max(tree, x, min, max, k);
     }
-
-    private:
-    static inline double
-    wrap_distance(const double x, const double hb, const double fb)
-    {
-        double x1;
-        if (CKDTREE_UNLIKELY(x < -hb)) x1 = fb + x;
-        else if (CKDTREE_UNLIKELY(x > hb)) x1 = x - fb;
-        else x1 = x;
-    #if 0
-        printf("ckdtree_fabs_b x : %g x1 %g\n", x, x1);
-    #endif
-        return x1;
-    }
-
-
 };
 
 
@@ -280,3 +400,7 @@ typedef BaseMinkowskiDistPinf<BoxDist1D> BoxMinkowskiDistPinf;
 typedef BaseMinkowskiDistP1<BoxDist1D> BoxMinkowskiDistP1;
 typedef BaseMinkowskiDistP2<BoxDist1D> BoxMinkowskiDistP2;
 
+typedef BaseMinkowskiDistPp<PeriodicDist1D> PeriodicMinkowskiDistPp;
+typedef BaseMinkowskiDistPinf<PeriodicDist1D> PeriodicMinkowskiDistPinf;
+typedef BaseMinkowskiDistP1<PeriodicDist1D> PeriodicMinkowskiDistP1;
+typedef BaseMinkowskiDistP2<PeriodicDist1D> PeriodicMinkowskiDistP2;
@@ -1,5 +1,74 @@
+/*
+ * Distances from a point to a block of points
+ * ===========================================
+ *
+ * point_block_p computes the distances**p from x to the n rows of a
+ * contiguous block of points, such as a leaf of a tree with a tree order
+ * copy of its data. Four rows are processed at a time with independent
+ * accumulators, which the compiler can map to SIMD lanes. Each row sees
+ * the same order of operations as point_point_p, so the distances are
+ * the same.
+ *
+ * Like point_point_p, a group of rows may stop early once all of their
+ * distances exceed upperbound; the values stored are then only known to
+ * be larger than upperbound.
+ */
+
+#define CKDTREE_BLOCK_LANES 4
+
+/* rows per call from the leaf scans, sized for a buffer on the stack */
+#define CKDTREE_BLOCK_ROWS 64
+
+template <typename T, typename Accumulate>
+static inline void
+point_block_lanes(const double *x, const T *block,
+                  const ckdtree_intp_t n, const ckdtree_intp_t k,
+                  const double upperbound, double *out,
+                  const Accumulate &accumulate)
+{
+    ckdtree_intp_t i, j;
+    int l;
+
+    for (j = 0; j + CKDTREE_BLOCK_LANES <= n; j += CKDTREE_BLOCK_LANES) {
+        const T *y = block + j * k;
+        double r[CKDTREE_BLOCK_LANES];
+        for (l = 0; l < CKDTREE_BLOCK_LANES; ++l)
+            r[l] = 0;
+
+        for (i = 0; i < k; ++i) {
+            for (l = 0; l < CKDTREE_BLOCK_LANES; ++l)
+                r[l] = accumulate(r[l], y + l * k, x, i);
+
+            if ((i & 3) == 3) {
+                bool done = true;
+                for (l = 0; l < CKDTREE_BLOCK_LANES; ++l)
+                    done = done && r[l] > upperbound;
+                if (done)
+                    break;
+            }
+        }
+
+        for (l = 0; l < CKDTREE_BLOCK_LANES; ++l)
+            out[j + l] = r[l];
+    }
+
+    for (; j < n; ++j) {
+        const T *y = block + j * k;
+        double r = 0;
+        for (i = 0; i < k; ++i) {
+            r = accumulate(r, y, x, i);
+            if (r > upperbound)
+                break;
+        }
+        out[j] = r;
+    }
+}
+
 template <typename Dist1D>
 struct BaseMinkowskiDistPp {
+    /* the distances along one dimension */
+    typedef Dist1D dist_1d;
+
     /* 1-d pieces
      * These should only be used if p != infinity
      */
@@ -36,9 +105,10 @@ struct BaseMinkowskiDistPp {
         }
     }
 
+    template <typename T1, typename T2>
     static inline double
     point_point_p(const ckdtree * tree,
-               const double *x, const double *y,
+               const T1 *x, const T2 *y,
                const double p, const ckdtree_intp_t k,
                const double upperbound)
     {
@@ -62,6 +132,21 @@ struct BaseMinkowskiDistPp {
         return r;
     }
 
+    template <typename T>
+    static inline void
+    point_block_p(const ckdtree * tree,
+                  const double *x, const T *block,
+                  const ckdtree_intp_t n, const double p,
+                  const ckdtree_intp_t k, const double upperbound,
+                  double *out)
+    {
+        point_block_lanes(x, block, n, k, upperbound, out,
+            [tree, p](double r, const T *y, const double *x,
+                      ckdtree_intp_t i) {
+                return r + std::pow(Dist1D::point_point_block(tree, y, x, i), p);
+            });
+    }
+
     static inline double
     distance_p(const double s, const double p)
     {
@@ -102,9 +187,10 @@ struct BaseMinkowskiDistP1 : public BaseMinkowskiDistPp<Dist1D> {
         }
     }
 
+    template <typename T1, typename T2>
     static inline double
     point_point_p(const ckdtree * tree,
-               const double *x, const double *y,
+               const T1 *x, const T2 *y,
                const double p, const ckdtree_intp_t k,
                const double upperbound)
     {
@@ -119,6 +205,21 @@ struct BaseMinkowskiDistP1 : public BaseMinkowskiDistPp<Dist1D> {
         return r;
     }
 
+    template <typename T>
+    static inline void
+    point_block_p(const ckdtree * tree,
+                  const double *x, const T *block,
+                  const ckdtree_intp_t n, const double p,
+                  const ckdtree_intp_t k, const double upperbound,
+                  double *out)
+    {
+        point_block_lanes(x, block, n, k, upperbound, out,
+            [tree](double r, const T *y, const double *x,
+                   ckdtree_intp_t i) {
+                return r + Dist1D::point_point_block(tree, y, x, i);
+            });
+    }
+
     static inline double
     distance_p(const double s, const double p)
     {
@@ -155,9 +256,10 @@ struct BaseMinkowskiDistPinf : public BaseMinkowskiDistPp<Dist1D> {
         }
     }
 
+    template <typename T1, typename T2>
     static inline double
     point_point_p(const ckdtree * tree,
-               const double *x, const double *y,
+               const T1 *x, const T2 *y,
                const double p, const ckdtree_intp_t k,
                const double upperbound)
     {
@@ -171,6 +273,21 @@ struct BaseMinkowskiDistPinf : public BaseMinkowskiDistPp<Dist1D> {
         }
         return r;
     }
+
+    template <typename T>
+    static inline void
+    point_block_p(const ckdtree * tree,
+                  const double *x, const T *block,
+                  const ckdtree_intp_t n, const double p,
+                  const ckdtree_intp_t k, const double upperbound,
+                  double *out)
+    {
+        point_block_lanes(x, block, n, k, upperbound, out,
+            [tree](double r, const T *y, const double *x,
+                   ckdtree_intp_t i) {
+                return ckdtree_fmax(r, Dist1D::point_point_block(tree, y, x, i));
+            });
+    }
     static inline double
     distance_p(const double s, const double p)
     {
@@ -213,10 +330,10 @@ struct BaseMinkowskiDistP2 : public BaseMinkowskiDistPp<Dist1D> {
             *max += max_;
         }
     }
+    template <typename T1, typename T2>
     static inline double
-
     point_point_p(const ckdtree * tree,
-               const double *x, const double *y,
+               const T1 *x, const T2 *y,
                const double p, const ckdtree_intp_t k,
                const double upperbound)
     {
@@ -231,6 +348,22 @@ struct BaseMinkowskiDistP2 : public BaseMinkowskiDistPp<Dist1D> {
         }
         return r;
     }
+
+    template <typename T>
+    static inline void
+    point_block_p(const ckdtree * tree,
+                  const double *x, const T *block,
+                  const ckdtree_intp_t n, const double p,
+                  const ckdtree_intp_t k, const double upperbound,
+                  double *out)
+    {
+        point_block_lanes(x, block, n, k, upperbound, out,
+            [tree](double r, const T *y, const double *x,
+                   ckdtree_intp_t i) {
+                const double r1 = Dist1D::point_point_block(tree, y, x, i);
+                return r + r1 * r1;
+            });
+    }
     static inline double
     distance_p(const double s, const double p)
     {
@@ -0,0 +1,171 @@
+#ifndef CKDTREE_LEAF_SCAN
+#define CKDTREE_LEAF_SCAN
+
+#include <algorithm>
+
+#include "ckdtree_decl.h"
+#include "rectangle.h"
+
+/*
+ * Brute-force distances in the leaves
+ * ===================================
+ *
+ * The points of a tree are stored in double or in single precision, in
+ * raw_data or raw_data_f32, optionally with a copy in tree order. These
+ * helpers pick the right storage, so that the traversals do not have to.
+ * They call visit(i, d), or visit(i, j, d) for pairs, with i and j the
+ * positions in raw_indices and d the distance**p.
+ *
+ * As with point_point_p, a distance**p larger than upperbound is only known
+ * to be larger than upperbound. upperbound is read again for every point or
+ * block of points, so visit may lower it.
+ */
+
+template <typename MinMaxDist, typename T, typename Visit>
+static inline void
+scan_leaf_block(const ckdtree *self, const T *tree_data, const double *x,
+                const ckdtree_intp_t start, const ckdtree_intp_t end,
+                const double p, const double &upperbound, const Visit &visit)
+{
+    const ckdtree_intp_t m = self->m;
+    double dist[CKDTREE_BLOCK_ROWS];
+
+    /* the leaf is a contiguous block */
+    for (ckdtree_intp_t i = start; i < end; i += CKDTREE_BLOCK_ROWS) {
+        const ckdtree_intp_t nb = std::min<ckdtree_intp_t>(
+            CKDTREE_BLOCK_ROWS, end - i);
+        MinMaxDist::point_block_p(self, x, tree_data + i * m, nb, p, m,
+                                  upperbound, dist);
+        for (ckdtree_intp_t j = 0; j < nb; ++j)
+            visit(i + j, dist[j]);
+    }
+}
+
+template <typename MinMaxDist, typename T, typename Visit>
+static inline void
+scan_leaf_indexed(const ckdtree *self, const T *data, const double *x,
+                  const ckdtree_intp_t start, const ckdtree_intp_t end,
+                  const double p, const double &upperbound, const Visit &visit)
+{
+    const ckdtree_intp_t *indices = self->raw_indices;
+    const ckdtree_intp_t m = self->m;
+
+    CKDTREE_PREFETCH(data + indices[start] * m, 0, m);
+    if (start < end - 1)
+        CKDTREE_PREFETCH(data + indices[start+1] * m, 0, m);
+
+    for (ckdtree_intp_t i = start; i < end; ++i) {
+
+        if (i < end - 2)
+            CKDTREE_PREFETCH(data + indices[i+2] * m, 0, m);
+
+        visit(i, MinMaxDist::point_point_p(self, data + indices[i] * m, x,
+                                           p, m, upperbound));
+    }
+}
+
+/* distances from x to the points indices[start:end] of self */
+template <typename MinMaxDist, typename Visit>
+static inline void
+scan_leaf(const ckdtree *self, const double *x,
+          const ckdtree_intp_t start, const ckdtree_intp_t end,
+          const double p, const double &upperbound, const Visit &visit)
+{
+    if (self->raw_tree_data_f32 != NULL)
+        scan_leaf_block<MinMaxDist>(self, (const float *)self->raw_tree_data_f32,
+                                    x, start, end, p, upperbound, visit);
+    else if (self->raw_tree_data != NULL)
+        scan_leaf_block<MinMaxDist>(self, (const double *)self->raw_tree_data,
+                                    x, start, end, p, upperbound, visit);
+    else if (self->raw_data_f32 != NULL)
+        scan_leaf_indexed<MinMaxDist>(self, (const float *)self->raw_data_f32,
+                                      x, start, end, p, upperbound, visit);
+    else
+        scan_leaf_indexed<MinMaxDist>(self, (const double *)self->raw_data,
+                                      x, start, end, p, upperbound, visit);
+}
+
+template <typename MinMaxDist, typename T1, typename T2, typename Visit>
+static inline void
+scan_leaf_pair_typed(const ckdtree *self, const T1 *sdata,
+                     const ckdtree *other, const T2 *odata,
+                     const ckdtreenode *node1, const ckdtreenode *node2,
+                     const double p, const double upperbound,
+                     const bool symmetric, const Visit &visit)
+{
+    const ckdtree_intp_t *sindices = self->raw_indices;
+    const ckdtree_intp_t *oindices = other->raw_indices;
+    const ckdtree_intp_t m = self->m;
+    const ckdtree_intp_t start1 = node1->start_idx;
+    const ckdtree_intp_t start2 = node2->start_idx;
+    const ckdtree_intp_t end1 = node1->end_idx;
+    const ckdtree_intp_t end2 = node2->end_idx;
+
+    CKDTREE_PREFETCH(sdata + sindices[start1] * m, 0, m);
+    if (start1 < end1 - 1)
+        CKDTREE_PREFETCH(sdata + sindices[start1+1] * m, 0, m);
+
+    for (ckdtree_intp_t i = start1; i < end1; ++i) {
+
+        if (i < end1 - 2)
+            CKDTREE_PREFETCH(sdata + sindices[i+2] * m, 0, m);
+
+        /* Special care here to avoid duplicate pairs */
+        const ckdtree_intp_t min_j = (symmetric && node1 == node2) ? i + 1 : start2;
+
+        if (min_j < end2)
+            CKDTREE_PREFETCH(odata + oindices[min_j] * m, 0, m);
+        if (min_j < end2 - 1)
+            CKDTREE_PREFETCH(odata + oindices[min_j+1] * m, 0, m);
+
+        for (ckdtree_intp_t j = min_j; j < end2; ++j) {
+
+            if (j < end2 - 2)
+                CKDTREE_PREFETCH(odata + oindices[j+2] * m, 0, m);
+
+            visit(i, j, MinMaxDist::point_point_p(self,
+                                                  sdata + sindices[i] * m,
+                                                  odata + oindices[j] * m,
+                                                  p, m, upperbound));
+        }
+    }
+}
+
+/*
+ * distances between the points of the leaves node1 of self and node2 of
+ * other; if symmetric is true and node1 is node2, only pairs with i < j
+ */
+template <typename MinMaxDist, typename Visit>
+static inline void
+scan_leaf_pair(const ckdtree *self, const ckdtree *other,
+               const ckdtreenode *node1, const ckdtreenode *node2,
+               const double p, const double upperbound,
+               const bool symmetric, const Visit &visit)
+{
+    if (self->raw_data_f32 != NULL) {
+        if (other->raw_data_f32 != NULL)
+            scan_leaf_pair_typed<MinMaxDist>(
+                self, (const float *)self->raw_data_f32,
+                other, (const float *)other->raw_data_f32,
+                node1, node2, p, upperbound, symmetric, visit);
+        else
+            scan_leaf_pair_typed<MinMaxDist>(
+                self, (const float *)self->raw_data_f32,
+                other, (const double *)other->raw_data,
+                node1, node2, p, upperbound, symmetric, visit);
+    }
+    else {
+        if (other->raw_data_f32 != NULL)
+            scan_leaf_pair_typed<MinMaxDist>(
+                self, (const double *)self->raw_data,
+                other, (const float *)other->raw_data_f32,
+                node1, node2, p, upperbound, symmetric, visit);
+        else
+            scan_leaf_pair_typed<MinMaxDist>(
+                self, (const double *)self->raw_data,
+                other, (const double *)other->raw_data,
+                node1, node2, p, upperbound, symmetric, visit);
+    }
+}
+
+#endif
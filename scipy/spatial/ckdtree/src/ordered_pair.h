@@ -7,8 +7,8 @@ struct ordered_pair {
     ckdtree_intp_t j;
 };
 
-inline void
-add_ordered_pair(std::vector<ordered_pair> *results,
+template <typename Results> inline void
+add_ordered_pair(Results *results,
                        const ckdtree_intp_t i, const intptr_t j)
 {
     if (i > j) {
@@ -0,0 +1,150 @@
+#ifndef CKDTREE_PARALLEL_TRAVERSE
+#define CKDTREE_PARALLEL_TRAVERSE
+
+#include <vector>
+
+#include "ckdtree_decl.h"
+#include "rectangle.h"
+#include "thread_pool.h"
+
+/*
+ * Parallel dual-tree traversal
+ * ============================
+ *
+ * count_neighbors, query_pairs, query_ball_tree and sparse_distance_matrix
+ * recurse over pairs of nodes, one from each tree. To run them on several
+ * threads, the node pairs at the top of that recursion are split up front,
+ * in the order in which the serial traversal would visit them, until there
+ * are enough of them to keep n_jobs threads busy. Pairs that the serial
+ * traversal would prune are kept; their traversal returns right away.
+ *
+ * Each pair is then traversed with a distance tracker of its own, built
+ * from the boxes of its two nodes. The results of each chunk of pairs go
+ * into a container of their own, which the caller merges in chunk order.
+ */
+
+#define CKDTREE_TASKS_PER_THREAD 64
+
+struct NodePair {
+    const ckdtreenode *node1;
+    const ckdtreenode *node2;
+    Rectangle rect1;
+    Rectangle rect2;
+
+    NodePair(const ckdtreenode *_node1, const ckdtreenode *_node2,
+             const Rectangle &_rect1, const Rectangle &_rect2)
+        : node1(_node1), node2(_node2), rect1(_rect1), rect2(_rect2) {};
+};
+
+/* which nodes split_node_pairs may split */
+const int SPLIT_BOTH = 0;       /* nodes of both trees */
+const int SPLIT_SYMMETRIC = 1;  /* both, self-pairs as in query_pairs */
+const int SPLIT_FIRST = 2;      /* only nodes of the first tree */
+
+static inline Rectangle
+split_rect(const Rectangle &rect, const ckdtreenode *node,
+           const ckdtree_intp_t direction)
+{
+    Rectangle child(rect);
+    if (direction == LESS)
+        child.maxes()[node->split_dim] = node->split;
+    else
+        child.mins()[node->split_dim] = node->split;
+    return child;
+}
+
+/*
+ * Split the pair of root nodes of self and other, whose boxes are rect1
+ * and rect2, into at least n_jobs * CKDTREE_TASKS_PER_THREAD pairs, or
+ * as many as the trees allow. With SPLIT_SYMMETRIC, other must be self
+ * and a node is never paired with its greater child before its less one.
+ * With SPLIT_FIRST, all pairs share the root node of other, so that no
+ * two pairs cover the same points of self.
+ */
+static inline std::vector<NodePair>
+split_node_pairs(const ckdtree *self, const ckdtree *other,
+                 const Rectangle &rect1, const Rectangle &rect2,
+                 const int mode, const int n_jobs)
+{
+    std::vector<NodePair> pairs, next;
+    pairs.push_back(NodePair(self->ctree, other->ctree, rect1, rect2));
+
+    const ckdtree_intp_t target =
+        (ckdtree_intp_t)n_jobs * CKDTREE_TASKS_PER_THREAD;
+
+    while ((ckdtree_intp_t)pairs.size() < target) {
+        bool any_split = false;
+        next.clear();
+
+        for (std::vector<NodePair>::const_iterator it = pairs.begin();
+             it != pairs.end(); ++it) {
+            const ckdtreenode *node1 = it->node1;
+            const ckdtreenode *node2 = it->node2;
+            const bool inner1 = node1->split_dim != -1;
+            const bool inner2 = node2->split_dim != -1 && mode != SPLIT_FIRST;
+
+            if (inner1 && inner2) {
+                const Rectangle less1 = split_rect(it->rect1, node1, LESS);
+                const Rectangle greater1 = split_rect(it->rect1, node1, GREATER);
+                const Rectangle less2 = split_rect(it->rect2, node2, LESS);
+                const Rectangle greater2 = split_rect(it->rect2, node2, GREATER);
+                next.push_back(NodePair(node1->less, node2->less, less1, less2));
+                next.push_back(NodePair(node1->less, node2->greater, less1, greater2));
+                if (!(mode == SPLIT_SYMMETRIC && node1 == node2))
+                    next.push_back(NodePair(node1->greater, node2->less, greater1, less2));
+                next.push_back(NodePair(node1->greater, node2->greater, greater1, greater2));
+            }
+            else if (inner1) {
+                next.push_back(NodePair(node1->less, node2,
+                    split_rect(it->rect1, node1, LESS), it->rect2));
+                next.push_back(NodePair(node1->greater, node2,
+                    split_rect(it->rect1, node1, GREATER), it->rect2));
+            }
+            else if (inner2) {
+                next.push_back(NodePair(node1, node2->less,
+                    it->rect1, split_rect(it->rect2, node2, LESS)));
+                next.push_back(NodePair(node1, node2->greater,
+                    it->rect1, split_rect(it->rect2, node2, GREATER)));
+            }
+            else {
+                next.push_back(*it);
+                continue;
+            }
+            any_split = true;
+        }
+
+        if (!any_split)
+            break;
+        pairs.swap(next);
+    }
+    return pairs;
+}
+
+/*
+ * Call visit(&tracker, pair, results) for all pairs on up to n_jobs
+ * threads. The returned vector holds one Results per pair; only the
+ * first pair of each chunk gets a results container that is used, all
+ * others are left default constructed.
+ */
+template <typename MinMaxDist, typename Results, typename Visit>
+static std::vector<Results>
+traverse_node_pairs(const ckdtree *self, const std::vector<NodePair> &pairs,
+                    const double p, const double eps,
+                    const double upper_bound, const int n_jobs,
+                    const Visit &visit)
+{
+    std::vector<Results> chunk_results(pairs.size());
+
+    ckdtree_parallel_for(pairs.size(), 1, n_jobs,
+                         [&](ckdtree_intp_t start, ckdtree_intp_t stop) {
+        Results &results = chunk_results[start];
+        for (ckdtree_intp_t i = start; i < stop; ++i) {
+            RectRectDistanceTracker<MinMaxDist> tracker(
+                self, pairs[i].rect1, pairs[i].rect2, p, eps, upper_bound);
+            visit(&tracker, pairs[i], results);
+        }
+    });
+    return chunk_results;
+}
+
+#endif
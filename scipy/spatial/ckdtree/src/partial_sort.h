@@ -1,47 +1,63 @@
-
 #ifndef CKDTREE_PARTIAL_SORT
 #define CKDTREE_PARTIAL_SORT
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 /* Splitting routines for a balanced kd-tree
  * Code originally written by Jake Vanderplas for scikit-learn
  *
  */
 
-inline void
-index_swap(ckdtree_intp_t *arr, intptr_t i1, intptr_t i2)
+/*
+ * The coordinates of the points of a node along the split dimension, with
+ * their indices, so that the selection does not go through node_indices
+ * into the data on every comparison. Each build thread has its own.
+ */
+template <typename T>
+struct partition_scratch {
+    std::vector<std::pair<T, ckdtree_intp_t> > items;
+};
+
+template <typename T>
+static inline bool
+partition_key_less(const std::pair<T, ckdtree_intp_t> &a,
+                   const std::pair<T, ckdtree_intp_t> &b)
 {
-    /* swap the values at index i1 and i2 of arr */
-    ckdtree_intp_t tmp = arr[i1];
-    arr[i1] = arr[i2];
-    arr[i2] = tmp;
+    return a.first < b.first;
 }
 
-static void
-partition_node_indices(const double *data,
+template <typename T>
+static ckdtree_intp_t
+partition_node_indices(const T *data,
                        ckdtree_intp_t *node_indices,
                        ckdtree_intp_t split_dim,
                        ckdtree_intp_t split_index,
                        ckdtree_intp_t n_features,
-                       ckdtree_intp_t n_points)
+                       ckdtree_intp_t n_points,
+                       partition_scratch<T> *scratch,
+                       double *split)
 {
-    /* Partition points in the node into two equal-sized groups
-     * Upon return, the values in node_indices will be rearranged such that
-     * (assuming numpy-style indexing):
+    /* Partition points in the node around the value at split_index
+     * Upon return, *split is the value v that would be at split_index if
+     * the points were sorted along split_dim, and the values in
+     * node_indices are rearranged such that (assuming numpy-style
+     * indexing):
      *
-     *   data[node_indices[0:split_index], split_dim]
-     *     <= data[node_indices[split_index], split_dim]
+     *   data[node_indices[0:n_less], split_dim] < v
      *
      * and
      *
-     *   data[node_indices[split_index], split_dim]
-     *     <= data[node_indices[split_index:n_points], split_dim]
+     *   v <= data[node_indices[n_less:n_points], split_dim]
      *
-     * The algorithm is essentially a partial in-place quicksort around a
-     * set pivot.
+     * The median is selected with std::nth_element, an introselect that
+     * stays O(n log n) on inputs that make a plain quickselect quadratic,
+     * on a contiguous copy of the coordinates.
      *
      * Parameters
      * ----------
-     * data : double pointer
+     * data : double or float pointer
      *    Pointer to a 2D array of the training data, of shape [N, n_features].
      *    N must be greater than any of the values in node_indices.
      * node_indices : int pointer
@@ -52,37 +68,40 @@ partition_node_indices(const double *data,
      *    the dimension on which to split.  This will usually be computed via
      *    the routine ``find_node_split_dim``
      * split_index : int
-     *    the index within node_indices around which to split the points.
+     *    the index within node_indices of the value to split at.
+     * scratch : partition_scratch pointer
+     *    working memory, reused between the nodes.
      *
      * Returns
      * -------
-     * status : int
-     *    integer exit status.  On return, the contents of node_indices are
-     *    modified as noted above.
+     * n_less : int
+     *    the number of points less than *split.
      */
 
-    ckdtree_intp_t left, right, midindex, i;
-    double d1, d2;
-    left = 0;
-    right = n_points - 1;
-    for(;;) {
-        midindex = left;
-        for (i=left; i<right; ++i) {
-            d1 = data[node_indices[i] * n_features + split_dim];
-            d2 = data[node_indices[right] * n_features + split_dim];
-            if (d1 < d2) {
-                index_swap(node_indices, i, midindex);
-                ++midindex;
-            }
-        }
-        index_swap(node_indices, midindex, right);
-        if (midindex == split_index)
-            break;
-        else if (midindex < split_index)
-            left = midindex + 1;
-        else
-            right = midindex - 1;
+    typedef std::pair<T, ckdtree_intp_t> item;
+    std::vector<item> &items = scratch->items;
+    ckdtree_intp_t i;
+
+    items.resize(n_points);
+    for (i = 0; i < n_points; ++i) {
+        const ckdtree_intp_t index = node_indices[i];
+        items[i] = item(data[index * n_features + split_dim], index);
     }
+
+    std::nth_element(items.begin(), items.begin() + split_index, items.end(),
+                     partition_key_less<T>);
+    const T v = items[split_index].first;
+
+    /* the points before split_index are <= v; move those equal to v last */
+    const ckdtree_intp_t n_less = std::partition(
+        items.begin(), items.begin() + split_index,
+        [v](const item &a) { return a.first < v; }) - items.begin();
+
+    for (i = 0; i < n_points; ++i)
+        node_indices[i] = items[i].second;
+
+    *split = v;
+    return n_less;
 }
 
 #endif
@@ -1,3 +1,4 @@
+#include <atomic>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
@@ -13,6 +14,8 @@
 #include "ckdtree_decl.h"
 #include "ordered_pair.h"
 #include "rectangle.h"
+#include "leaf_scan.h"
+#include "thread_pool.h"
 
 /*
  * Priority queue
@@ -95,6 +98,80 @@ struct heap {
         remove();
         return it;
     }
+
+    inline void clear() {n = 0;}
+};
+
+
+/*
+ * Nearest neighbors found so far
+ * ==============================
+ *
+ * Up to kmax neighbors, with quick access to the furthest one. For small
+ * kmax, a sorted array with insertion is cheaper than a heap.
+ */
+
+#define CKDTREE_SORTED_KMAX 16
+
+struct nearest_neighbors {
+
+    ckdtree_intp_t kmax;
+    ckdtree_intp_t n;
+    bool use_heap;
+    heap max_heap;              /* priority -d, the furthest on top */
+    std::vector<heapitem> list; /* priority d, in increasing order */
+
+    nearest_neighbors(ckdtree_intp_t kmax)
+        : kmax(kmax), n(0), use_heap(kmax > CKDTREE_SORTED_KMAX),
+          max_heap(use_heap ? kmax : 0), list(use_heap ? 0 : kmax) {}
+
+    inline void clear() {
+        n = 0;
+        max_heap.clear();
+    }
+
+    /* distance**p of the furthest neighbor, n must be positive */
+    inline double furthest() {
+        return use_heap ? -max_heap.peek().priority : list[n-1].priority;
+    }
+
+    /* add a neighbor at distance**p d, dropping the furthest one if full */
+    inline void push(const double d, const ckdtree_intp_t index) {
+        heapitem item;
+        item.contents.intdata = index;
+        if (use_heap) {
+            if (n == kmax)
+                max_heap.remove();
+            else
+                ++n;
+            item.priority = -d;
+            max_heap.push(item);
+        }
+        else {
+            ckdtree_intp_t i = (n == kmax) ? n - 1 : n++;
+            while (i > 0 && list[i-1].priority > d) {
+                list[i] = list[i-1];
+                --i;
+            }
+            item.priority = d;
+            list[i] = item;
+        }
+    }
+
+    /*
+     * the neighbors by increasing distance, with priority d; empties the
+     * heap, which uses buffer for the result
+     */
+    inline const heapitem *sorted(std::vector<heapitem> &buffer) {
+        if (!use_heap)
+            return list.data();
+        buffer.resize(kmax);
+        for (ckdtree_intp_t i = n - 1; i >= 0; --i) {
+            buffer[i] = max_heap.pop();
+            buffer[i].priority = -buffer[i].priority;
+        }
+        return buffer.data();
+    }
 };
 
 
@@ -104,7 +181,7 @@ struct heap {
  */
 
 struct nodeinfo {
-    const ckdtreenode  *node;
+    const ckdtreehotnode  *node;
     ckdtree_intp_t     m;
     double  min_distance; /* full min distance */
     double        buf[1]; // the good old struct hack
@@ -154,6 +231,7 @@ struct nodeinfo_pool {
     ckdtree_intp_t alloc_size;
     ckdtree_intp_t arena_size;
     ckdtree_intp_t m;
+    ckdtree_intp_t current;  /* index of arena in pool */
     char *arena;
     char *arena_ptr;
 
@@ -164,6 +242,7 @@ struct nodeinfo_pool {
         arena = new char[arena_size];
         arena_ptr = arena;
         pool.push_back(arena);
+        current = 0;
         this->m = m;
     }
 
@@ -172,14 +251,22 @@ struct nodeinfo_pool {
             delete [] pool[i];
     }
 
+    /* reclaim all nodeinfo structs, keeping the arenas for reuse */
+    inline void clear() {
+        current = 0;
+        arena = pool[0];
+        arena_ptr = arena;
+    }
+
     inline nodeinfo *allocate() {
         nodeinfo *ni1;
         ckdtree_intp_t m1 = (ckdtree_intp_t)arena_ptr;
         ckdtree_intp_t m0 = (ckdtree_intp_t)arena;
         if ((arena_size-(ckdtree_intp_t)(m1-m0))<alloc_size) {
-            arena = new char[arena_size];
+            if (current + 1 == (ckdtree_intp_t)pool.size())
+                pool.push_back(new char[arena_size]);
+            arena = pool[++current];
             arena_ptr = arena;
-            pool.push_back(arena);
         }
         ni1 = (nodeinfo*)arena_ptr;
         ni1->m = m;
@@ -188,9 +275,45 @@ struct nodeinfo_pool {
     }
 };
 
-/* k-nearest neighbor search for a single point x */
+/*
+ * Working memory of query_single_point, allocated once for a batch of
+ * queries and reused for each point
+ */
+struct query_scratch {
+
+    /* memory pool to allocate and automatically reclaim nodeinfo structs */
+    nodeinfo_pool nipool;
+
+    /*
+     * priority queue for chasing nodes
+     * entries are:
+     *  - minimum distance between the cell and the target
+     *  - distances between the nearest side of the cell and the target
+     *    the head node of the cell
+     */
+    heap q;
+
+    /* the k nearest neighbors */
+    nearest_neighbors neighbors;
+
+    std::vector<heapitem> sorted_buffer;
+
+    /* counters of the queries of this batch */
+    traversal_stats stats;
+
+    query_scratch(ckdtree_intp_t m, ckdtree_intp_t kmax)
+        : nipool(m), q(12), neighbors(kmax) {}
+};
+
+/*
+ * k-nearest neighbor search for a single point x
+ *
+ * At most max_leaves leaves are scanned, if max_leaves > 0. Returns 1 if
+ * the search stopped there with cells left that could hold closer points,
+ * 0 if the result is exact (to within eps).
+ */
 template <typename MinMaxDist>
-static void
+static int
 query_single_point(const ckdtree *self,
                    double   *result_distances,
                    ckdtree_intp_t      *result_indices,
@@ -200,44 +323,35 @@ query_single_point(const ckdtree *self,
                    const ckdtree_intp_t     kmax,
                    const double  eps,
                    const double  p,
-                   double  distance_upper_bound)
+                   double  distance_upper_bound,
+                   const ckdtree_intp_t max_leaves,
+                   query_scratch &scratch)
 {
     static double inf = strtod("INF", NULL);
 
-    /* memory pool to allocate and automatically reclaim nodeinfo structs */
-    nodeinfo_pool nipool(self->m);
-
-    /*
-     * priority queue for chasing nodes
-     * entries are:
-     *  - minimum distance between the cell and the target
-     *  - distances between the nearest side of the cell and the target
-     *    the head node of the cell
-     */
-    heap q(12);
-
-    /*
-     *  priority queue for chasing nodes
-     *  entries are:
-     *   - minimum distance between the cell and the target
-     *   - distances between the nearest side of the cell and the target
-     *     the head node of the cell
-     */
-    heap neighbors(kmax);
+    nodeinfo_pool &nipool = scratch.nipool;
+    heap &q = scratch.q;
+    nearest_neighbors &neighbors = scratch.neighbors;
+    traversal_stats &stats = scratch.stats;
+    nipool.clear();
+    q.clear();
+    neighbors.clear();
 
     ckdtree_intp_t      i;
     const ckdtree_intp_t m = self->m;
     nodeinfo      *ni1;
     nodeinfo      *ni2;
-    double   d;
     double   epsfac;
-    heapitem      it, it2, neighbor;
-    const ckdtreenode   *node;
-    const ckdtreenode   *inode;
+    heapitem      it, it2;
+    const ckdtreehotnode   *hot = &self->hot_buffer->front();
+    const ckdtreehotnode   *node;
+    const ckdtreehotnode   *inode;
+    ckdtree_intp_t n_leaves = 0;
+    int capped = 0;
 
     /* set up first nodeifo */
     ni1 = nipool.allocate();
-    ni1->node = self->ctree;
+    ni1->node = hot;
 
     /* initialize first node, update min_distance */
     ni1->min_distance = 0;
@@ -284,43 +398,37 @@ query_single_point(const ckdtree *self,
         if (ni1->node->split_dim == -1) {
 
             node = ni1->node;
+            ++stats.nodes_visited;
+            ++stats.leaves_scanned;
+            stats.distance_evaluations += node->end_idx - node->start_idx;
 
             /* brute-force */
             {
-                const ckdtree_intp_t start_idx = node->start_idx;
-                const ckdtree_intp_t end_idx = node->end_idx;
-                const double *data = self->raw_data;
                 const ckdtree_intp_t *indices = self->raw_indices;
 
-                CKDTREE_PREFETCH(data+indices[start_idx]*m, 0, m);
-                if (start_idx < end_idx - 1)
-                    CKDTREE_PREFETCH(data+indices[start_idx+1]*m, 0, m);
-
-                for (i=start_idx; i<end_idx; ++i) {
-
-                    if (i < end_idx - 2)
-                        CKDTREE_PREFETCH(data+indices[i+2]*m, 0, m);
-
-                    d = MinMaxDist::point_point_p(self, data+indices[i]*m, x, p, m, distance_upper_bound);
+                /* replace furthest neighbor if row i is closer */
+                scan_leaf<MinMaxDist>(self, x, node->start_idx, node->end_idx,
+                                      p, distance_upper_bound,
+                                      [&](const ckdtree_intp_t i, const double d) {
                     if (d < distance_upper_bound) {
-                        /* replace furthest neighbor */
-                        if (neighbors.n == kmax)
-                              neighbors.remove();
-                        neighbor.priority = -d;
-                        neighbor.contents.intdata = indices[i];
-                        neighbors.push(neighbor);
+                        neighbors.push(d, indices[i]);
 
                         /* adjust upper bound for efficiency */
                         if (neighbors.n == kmax)
-                            distance_upper_bound = -neighbors.peek().priority;
+                            distance_upper_bound = neighbors.furthest();
                     }
-                }
+                });
             }
             /* done with this node, get another */
             if (q.n == 0) {
                 /* no more nodes to visit */
                 break;
             }
+            else if (CKDTREE_UNLIKELY(++n_leaves == max_leaves)) {
+                /* out of budget, unless the search would end here anyway */
+                capped = q.peek().priority <= distance_upper_bound*epsfac;
+                break;
+            }
             else {
                 it = q.pop();
                 ni1 = (nodeinfo*)(it.contents.ptrdata);
@@ -339,8 +447,10 @@ query_single_point(const ckdtree *self,
              */
             if (ni1->min_distance > distance_upper_bound*epsfac) {
                 /* since this is the nearest cell, we're done, bail out */
+                stats.pruned_subtrees += q.n + 1;
                 break;
             }
+            ++stats.nodes_visited;
             // set up children for searching
             // ni2 will be pushed to the queue
 
@@ -362,12 +472,12 @@ query_single_point(const ckdtree *self,
                 double side_distance;
 
                 if (x[split_dim] < split) {
-                    ni1->node = inode->less;
-                    ni2->node = inode->greater;
+                    ni1->node = hot + inode->less;
+                    ni2->node = hot + inode->less + 1;
                     side_distance = split - x[split_dim];
                 } else {
-                    ni1->node = inode->greater;
-                    ni2->node = inode->less;
+                    ni1->node = hot + inode->less + 1;
+                    ni2->node = hot + inode->less;
                     side_distance = x[split_dim] - split;
                 }
 
@@ -386,9 +496,9 @@ query_single_point(const ckdtree *self,
                 double side_distance;
 
                 ni1->maxes()[split_dim] = split;
-                ni1->node = inode->less;
+                ni1->node = hot + inode->less;
 
-                side_distance = BoxDist1D::side_distance_from_min_max(
+                side_distance = MinMaxDist::dist_1d::side_distance_from_min_max(
                         self,
                         x[split_dim],
                         ni1->mins()[split_dim],
@@ -398,9 +508,9 @@ query_single_point(const ckdtree *self,
                 ni1->update_side_distance(split_dim, side_distance, p);
 
                 ni2->mins()[split_dim] = split;
-                ni2->node = inode->greater;
+                ni2->node = hot + inode->less + 1;
 
-                side_distance = BoxDist1D::side_distance_from_min_max(
+                side_distance = MinMaxDist::dist_1d::side_distance_from_min_max(
                         self,
                         x[split_dim],
                         ni2->mins()[split_dim],
@@ -435,34 +545,85 @@ query_single_point(const ckdtree *self,
                 it2.priority = ni2->min_distance;
                 it2.contents.ptrdata = (void*) ni2;
                 q.push(it2);
+                ++stats.heap_pushes;
+            }
+            else {
+                ++stats.pruned_subtrees;
             }
 
         }
     }
 
-    /* heapsort */
-    std::vector<heapitem> sorted_neighbors(kmax);
-    ckdtree_intp_t nnb = neighbors.n;
-    for(i = neighbors.n - 1; i >=0; --i) {
-        sorted_neighbors[i] = neighbors.pop();
-    }
-
     /* fill output arrays with sorted neighbors */
+    ckdtree_intp_t nnb = neighbors.n;
+    const heapitem *sorted_neighbors = neighbors.sorted(scratch.sorted_buffer);
     for (i = 0; i < nk; ++i) {
         if(CKDTREE_UNLIKELY(k[i] - 1 >= nnb)) {
             result_indices[i] = self->n;
             result_distances[i] = inf;
         } else {
-            neighbor = sorted_neighbors[k[i] - 1];
+            const heapitem &neighbor = sorted_neighbors[k[i] - 1];
             result_indices[i] = neighbor.contents.intdata;
             if (CKDTREE_LIKELY(p == 2.0))
-                result_distances[i] = std::sqrt(-neighbor.priority);
+                result_distances[i] = std::sqrt(neighbor.priority);
             else if ((p == 1.) || (ckdtree_isinf(p)))
-                result_distances[i] = -neighbor.priority;
+                result_distances[i] = neighbor.priority;
             else
-                result_distances[i] = std::pow((-neighbor.priority),(1./p));
+                result_distances[i] = std::pow(neighbor.priority,(1./p));
         }
     }
+    return capped;
+}
+
+/*
+ * Queries are handed to the worker threads in chunks of at least this
+ * many points
+ */
+#define CKDTREE_QUERY_GRAIN 16
+
+/*
+ * Order of the queries for reorder_queries: grouped by the leaf that
+ * contains the query point, with the leaves in breadth-first order.
+ * Consecutive queries then take the same way down the tree and start
+ * from the same leaf, which is still in cache.
+ */
+static void
+leaf_order(const ckdtree *self, const double *xx, const ckdtree_intp_t n,
+           const int n_jobs, std::vector<ckdtree_intp_t> &order)
+{
+    const ckdtreehotnode *hot = &self->hot_buffer->front();
+    const ckdtree_intp_t n_nodes = self->hot_buffer->size();
+    const ckdtree_intp_t m = self->m;
+    std::vector<ckdtree_intp_t> leaf(n);
+    std::vector<ckdtree_intp_t> start(n_nodes + 1, 0);
+    ckdtree_intp_t i;
+
+    ckdtree_parallel_for(n, CKDTREE_QUERY_GRAIN, n_jobs,
+                         [&](ckdtree_intp_t begin, ckdtree_intp_t end) {
+        std::vector<double> row(m);
+        for (ckdtree_intp_t j = begin; j < end; ++j) {
+            const double *x = xx + j * m;
+            if (self->raw_boxsize_data != NULL) {
+                for (ckdtree_intp_t d = 0; d < m; ++d)
+                    row[d] = BoxDist1D::wrap_position(
+                        x[d], self->raw_boxsize_data[d]);
+                x = &row[0];
+            }
+            const ckdtreehotnode *node = hot;
+            while (node->split_dim != -1)
+                node = hot + node->less + (x[node->split_dim] < node->split ? 0 : 1);
+            leaf[j] = node - hot;
+        }
+    });
+
+    /* counting sort, stable within a leaf */
+    for (i = 0; i < n; ++i)
+        ++start[leaf[i] + 1];
+    for (i = 0; i < n_nodes; ++i)
+        start[i + 1] += start[i];
+    order.resize(n);
+    for (i = 0; i < n; ++i)
+        order[start[leaf[i]]++] = i;
 }
 
 /* Query n points for their k nearest neighbors */
@@ -478,45 +639,76 @@ query_knn(const ckdtree      *self,
           const ckdtree_intp_t     kmax,
           const double  eps,
           const double  p,
-          const double  distance_upper_bound)
+          const double  distance_upper_bound,
+          const ckdtree_intp_t max_leaves,
+          ckdtree_intp_t *n_capped,
+          const int reorder_queries,
+          const int n_jobs)
 {
 #define HANDLE(cond, kls) \
     if(cond) { \
-        query_single_point<kls>(self, dd_row, ii_row, xx_row, k, nk, kmax, eps, p, distance_upper_bound); \
+        capped += query_single_point<kls>(self, dd_row, ii_row, xx_row, k, nk, kmax, eps, p, distance_upper_bound, max_leaves, scratch); \
     } else
 
     ckdtree_intp_t m = self->m;
-    ckdtree_intp_t i;
 
-    if(CKDTREE_LIKELY(!self->raw_boxsize_data)) {
-        for (i=0; i<n; ++i) {
-            double *dd_row = dd + (i*nk);
-            ckdtree_intp_t *ii_row = ii + (i*nk);
-            const double *xx_row = xx + (i*m);
-            HANDLE(CKDTREE_LIKELY(p == 2), MinkowskiDistP2)
-            HANDLE(p == 1, MinkowskiDistP1)
-            HANDLE(ckdtree_isinf(p), MinkowskiDistPinf)
-            HANDLE(1, MinkowskiDistPp)
-            {}
-        }
-    } else {
-        std::vector<double> row(m);
-        double * xx_row = &row[0];
-        int j;
-        for (i=0; i<n; ++i) {
-            double *dd_row = dd + (i*nk);
-            ckdtree_intp_t *ii_row = ii + (i*nk);
-            const double *old_xx_row = xx + (i*m);
-            for(j=0; j<m; ++j) {
-                xx_row[j] = BoxDist1D::wrap_position(old_xx_row[j], self->raw_boxsize_data[j]);
+    /* the queries in the order to run them; NULL for in order */
+    std::vector<ckdtree_intp_t> order_buffer;
+    const ckdtree_intp_t *order = NULL;
+    if (reorder_queries && n > 1) {
+        leaf_order(self, xx, n, n_jobs, order_buffer);
+        order = &order_buffer[0];
+    }
+
+    std::atomic<ckdtree_intp_t> total_capped(0);
+
+    ckdtree_parallel_for(n, CKDTREE_QUERY_GRAIN, n_jobs,
+                         [&](ckdtree_intp_t start, ckdtree_intp_t stop) {
+        ckdtree_intp_t i, pos;
+        ckdtree_intp_t capped = 0;
+        query_scratch scratch(m, kmax);
+        if(CKDTREE_LIKELY(!self->raw_boxsize_data)) {
+            for (pos=start; pos<stop; ++pos) {
+                i = order ? order[pos] : pos;
+                double *dd_row = dd + (i*nk);
+                ckdtree_intp_t *ii_row = ii + (i*nk);
+                const double *xx_row = xx + (i*m);
+                HANDLE(CKDTREE_LIKELY(p == 2), MinkowskiDistP2)
+                HANDLE(p == 1, MinkowskiDistP1)
+                HANDLE(ckdtree_isinf(p), MinkowskiDistPinf)
+                HANDLE(1, MinkowskiDistPp)
+                {}
+            }
+        } else {
+            std::vector<double> row(m);
+            double * xx_row = &row[0];
+            const bool all_periodic = ckdtree_all_periodic(self);
+            int j;
+            for (pos=start; pos<stop; ++pos) {
+                i = order ? order[pos] : pos;
+                double *dd_row = dd + (i*nk);
+                ckdtree_intp_t *ii_row = ii + (i*nk);
+                const double *old_xx_row = xx + (i*m);
+                for(j=0; j<m; ++j) {
+                    xx_row[j] = BoxDist1D::wrap_position(old_xx_row[j], self->raw_boxsize_data[j]);
+                }
+                if (all_periodic) {
+                    HANDLE(CKDTREE_LIKELY(p == 2), PeriodicMinkowskiDistP2)
+                    HANDLE(p == 1, PeriodicMinkowskiDistP1)
+                    HANDLE(ckdtree_isinf(p), PeriodicMinkowskiDistPinf)
+                    HANDLE(1, PeriodicMinkowskiDistPp) {}
+                } else {
+                    HANDLE(CKDTREE_LIKELY(p == 2), BoxMinkowskiDistP2)
+                    HANDLE(p == 1, BoxMinkowskiDistP1)
+                    HANDLE(ckdtree_isinf(p), BoxMinkowskiDistPinf)
+                    HANDLE(1, BoxMinkowskiDistPp) {}
+                }
             }
-            HANDLE(CKDTREE_LIKELY(p == 2), BoxMinkowskiDistP2)
-            HANDLE(p == 1, BoxMinkowskiDistP1)
-            HANDLE(ckdtree_isinf(p), BoxMinkowskiDistPinf)
-            HANDLE(1, BoxMinkowskiDistPp) {}
         }
-
-    }
+        total_capped += capped;
+        scratch.stats.commit(self);
+    });
+    if (n_capped != NULL)
+        *n_capped = total_capped;
     return 0;
 }
-
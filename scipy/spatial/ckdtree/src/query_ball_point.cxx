@@ -9,21 +9,28 @@
 #include <typeinfo>
 #include <stdexcept>
 #include <ios>
+#include <algorithm>
+#include <mutex>
+#include <utility>
 
 #include "ckdtree_decl.h"
 #include "rectangle.h"
+#include "leaf_scan.h"
+#include "thread_pool.h"
 
 
 static void
 traverse_no_checking(const ckdtree *self,
                      const int return_length,
                      std::vector<ckdtree_intp_t> *results,
-                     const ckdtreenode *node)
+                     const ckdtreenode *node,
+                     traversal_stats &stats)
 {
     const ckdtree_intp_t *indices = self->raw_indices;
     const ckdtreenode *lnode;
     ckdtree_intp_t i;
 
+    ++stats.nodes_visited;
     if (node->split_dim == -1) {  /* leaf node */
         lnode = node;
         const ckdtree_intp_t start = lnode->start_idx;
@@ -37,8 +44,8 @@ traverse_no_checking(const ckdtree *self,
         }
     }
     else {
-        traverse_no_checking(self, return_length, results, node->less);
-        traverse_no_checking(self, return_length, results, node->greater);
+        traverse_no_checking(self, return_length, results, node->less, stats);
+        traverse_no_checking(self, return_length, results, node->greater, stats);
     }
 }
 
@@ -51,40 +58,26 @@ traverse_checking(const ckdtree *self,
                   RectRectDistanceTracker<MinMaxDist> *tracker
 )
 {
-    const ckdtreenode *lnode;
-    double d;
-    ckdtree_intp_t i;
-
     if (tracker->min_distance > tracker->upper_bound * tracker->epsfac) {
+        ++tracker->stats.pruned_subtrees;
         return;
     }
     else if (tracker->max_distance < tracker->upper_bound / tracker->epsfac) {
-        traverse_no_checking(self, return_length, results, node);
+        traverse_no_checking(self, return_length, results, node,
+                             tracker->stats);
     }
     else if (node->split_dim == -1)  { /* leaf node */
 
         /* brute-force */
-        lnode = node;
-        const double p = tracker->p;
+        ++tracker->stats.nodes_visited;
+        ++tracker->stats.leaves_scanned;
+        tracker->stats.distance_evaluations += node->end_idx - node->start_idx;
         const double tub = tracker->upper_bound;
-        const double *tpt = tracker->rect1.mins();
-        const double *data = self->raw_data;
         const ckdtree_intp_t *indices = self->raw_indices;
-        const ckdtree_intp_t m = self->m;
-        const ckdtree_intp_t start = lnode->start_idx;
-        const ckdtree_intp_t end = lnode->end_idx;
-
-        CKDTREE_PREFETCH(data + indices[start] * m, 0, m);
-        if (start < end - 1)
-            CKDTREE_PREFETCH(data + indices[start+1] * m, 0, m);
-
-        for (i = start; i < end; ++i) {
-
-            if (i < end -2 )
-                CKDTREE_PREFETCH(data + indices[i+2] * m, 0, m);
-
-            d = MinMaxDist::point_point_p(self, data + indices[i] * m, tpt, p, m, tub);
 
+        scan_leaf<MinMaxDist>(self, tracker->rect1.mins(), node->start_idx,
+                              node->end_idx, tracker->p, tub,
+                              [&](const ckdtree_intp_t i, const double d) {
             if (d <= tub) {
                 if(return_length) {
                     (*results)[0] ++;
@@ -92,9 +85,10 @@ traverse_checking(const ckdtree *self,
                     results->push_back((ckdtree_intp_t) indices[i]);
                 }
             }
-        }
+        });
     }
     else {
+        ++tracker->stats.nodes_visited;
         tracker->push_less_of(2, node);
         traverse_checking(self, return_length, results, node->less, tracker);
         tracker->pop();
@@ -105,35 +99,51 @@ traverse_checking(const ckdtree *self,
     }
 }
 
-int
-query_ball_point(const ckdtree *self, const double *x,
-                 const double *r, const double p, const double eps,
-                 const ckdtree_intp_t n_queries,
-                 std::vector<ckdtree_intp_t> **results, const int return_length)
+/*
+ * Queries are handed to the worker threads in chunks of at least this
+ * many points
+ */
+#define CKDTREE_QUERY_GRAIN 16
+
+/*
+ * append the neighbors of the point x, or their number, to results, and
+ * the counters of the traversal to stats
+ */
+static void
+query_single_ball(const ckdtree *self, const double *x, const double r,
+                  const double p, const double eps, const int return_length,
+                  std::vector<ckdtree_intp_t> *results, traversal_stats &stats)
 {
 #define HANDLE(cond, kls) \
     if(cond) { \
-        if(return_length) results[i]->push_back(0); \
-        RectRectDistanceTracker<kls> tracker(self, point, rect, p, eps, r[i]); \
-        traverse_checking(self, return_length, results[i], self->ctree, &tracker); \
+        if(return_length) results->push_back(0); \
+        RectRectDistanceTracker<kls> tracker(self, point, rect, p, eps, r); \
+        traverse_checking(self, return_length, results, self->ctree, &tracker); \
+        stats.add(tracker.stats); \
     } else
 
-    for (ckdtree_intp_t i=0; i < n_queries; ++i) {
-        const ckdtree_intp_t m = self->m;
-        Rectangle rect(m, self->raw_mins, self->raw_maxes);
-        if (CKDTREE_LIKELY(self->raw_boxsize_data == NULL)) {
-            Rectangle point(m, x + i * m, x + i * m);
-            HANDLE(CKDTREE_LIKELY(p == 2), MinkowskiDistP2)
-            HANDLE(p == 1, MinkowskiDistP1)
-            HANDLE(ckdtree_isinf(p), MinkowskiDistPinf)
-            HANDLE(1, MinkowskiDistPp)
+    const ckdtree_intp_t m = self->m;
+    Rectangle rect(m, self->raw_mins, self->raw_maxes);
+    if (CKDTREE_LIKELY(self->raw_boxsize_data == NULL)) {
+        Rectangle point(m, x, x);
+        HANDLE(CKDTREE_LIKELY(p == 2), MinkowskiDistP2)
+        HANDLE(p == 1, MinkowskiDistP1)
+        HANDLE(ckdtree_isinf(p), MinkowskiDistPinf)
+        HANDLE(1, MinkowskiDistPp)
+        {}
+    } else {
+        Rectangle point(m, x, x);
+        int j;
+        for(j=0; j<m; ++j) {
+            point.maxes()[j] = point.mins()[j] = BoxDist1D::wrap_position(point.mins()[j], self->raw_boxsize_data[j]);
+        }
+        if (ckdtree_all_periodic(self)) {
+            HANDLE(CKDTREE_LIKELY(p == 2), PeriodicMinkowskiDistP2)
+            HANDLE(p == 1, PeriodicMinkowskiDistP1)
+            HANDLE(ckdtree_isinf(p), PeriodicMinkowskiDistPinf)
+            HANDLE(1, PeriodicMinkowskiDistPp)
             {}
         } else {
-            Rectangle point(m, x + i * m, x + i * m);
-            int j;
-            for(j=0; j<m; ++j) {
-                point.maxes()[j] = point.mins()[j] = BoxDist1D::wrap_position(point.mins()[j], self->raw_boxsize_data[j]);
-            }
             HANDLE(CKDTREE_LIKELY(p == 2), BoxMinkowskiDistP2)
             HANDLE(p == 1, BoxMinkowskiDistP1)
             HANDLE(ckdtree_isinf(p), BoxMinkowskiDistPinf)
@@ -141,5 +151,79 @@ query_ball_point(const ckdtree *self, const double *x,
             {}
         }
     }
+#undef HANDLE
+}
+
+int
+query_ball_point(const ckdtree *self, const double *x,
+                 const double *r, const double p, const double eps,
+                 const ckdtree_intp_t n_queries,
+                 std::vector<ckdtree_intp_t> **results, const int return_length,
+                 const int n_jobs)
+{
+    ckdtree_parallel_for(n_queries, CKDTREE_QUERY_GRAIN, n_jobs,
+                         [&](ckdtree_intp_t start, ckdtree_intp_t stop) {
+        traversal_stats stats;
+        for (ckdtree_intp_t i=start; i < stop; ++i)
+            query_single_ball(self, x + i * self->m, r[i], p, eps,
+                              return_length, results[i], stats);
+        stats.commit(self);
+    });
+    return 0;
+}
+
+/*
+ * The neighbors of the points x as a CSR graph: the neighbors of x[i] are
+ * indices[indptr[i]:indptr[i+1]]. indptr has n_queries + 1 entries. Each
+ * chunk of queries fills a buffer of its own, and the buffers are joined
+ * in order at the end.
+ */
+int
+query_ball_point_csr(const ckdtree *self, const double *x,
+                     const double *r, const double p, const double eps,
+                     const ckdtree_intp_t n_queries, const int sort_rows,
+                     std::vector<ckdtree_intp_t> *indices,
+                     ckdtree_intp_t *indptr, const int n_jobs)
+{
+    typedef std::pair<ckdtree_intp_t, std::vector<ckdtree_intp_t> > chunk;
+    std::vector<chunk> chunks;
+    std::mutex chunks_lock;
+
+    ckdtree_parallel_for(n_queries, CKDTREE_QUERY_GRAIN, n_jobs,
+                         [&](ckdtree_intp_t start, ckdtree_intp_t stop) {
+        std::vector<ckdtree_intp_t> buffer;
+        traversal_stats stats;
+        for (ckdtree_intp_t i=start; i < stop; ++i) {
+            const ckdtree_intp_t row = buffer.size();
+            query_single_ball(self, x + i * self->m, r[i], p, eps, 0,
+                              &buffer, stats);
+            if (sort_rows)
+                std::sort(buffer.begin() + row, buffer.end());
+            indptr[i + 1] = buffer.size() - row;
+        }
+        stats.commit(self);
+        std::lock_guard<std::mutex> guard(chunks_lock);
+        chunks.push_back(chunk(start, std::vector<ckdtree_intp_t>()));
+        chunks.back().second.swap(buffer);
+    });
+
+    indptr[0] = 0;
+    for (ckdtree_intp_t i = 0; i < n_queries; ++i)
+        indptr[i + 1] += indptr[i];
+
+    std::sort(chunks.begin(), chunks.end(),
+              [](const chunk &a, const chunk &b) { return a.first < b.first; });
+    indices->clear();
+    if (chunks.size() == 1) {
+        indices->swap(chunks[0].second);
+    }
+    else {
+        indices->reserve(indptr[n_queries]);
+        for (std::vector<chunk>::iterator it = chunks.begin();
+             it != chunks.end(); ++it) {
+            indices->insert(indices->end(), it->second.begin(), it->second.end());
+            std::vector<ckdtree_intp_t>().swap(it->second);
+        }
+    }
     return 0;
 }
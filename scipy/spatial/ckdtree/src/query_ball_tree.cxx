@@ -9,21 +9,47 @@
 #include <typeinfo>
 #include <stdexcept>
 #include <ios>
+#include <algorithm>
 
 #include "ckdtree_decl.h"
 #include "rectangle.h"
+#include "leaf_scan.h"
+#include "parallel_traverse.h"
+#include "thread_pool.h"
+#include "ordered_pair.h"
+
+
+/*
+ * The traversals hand each pair of neighbors (i, j), by their indices in
+ * self and other, to a sink: either the vectors of lists of neighbors, or
+ * a buffer of pairs that query_ball_tree_csr packs into a CSR graph.
+ */
+struct list_sink {
+    std::vector<ckdtree_intp_t> **results;
+
+    inline void add(const ckdtree_intp_t i, const ckdtree_intp_t j) const {
+        results[i]->push_back(j);
+    }
+};
+
+struct pair_sink {
+    std::vector<ordered_pair> *pairs;
 
+    inline void add(const ckdtree_intp_t i, const ckdtree_intp_t j) const {
+        ordered_pair pair = {i, j};
+        pairs->push_back(pair);
+    }
+};
 
-static void
+template <typename Sink> static void
 traverse_no_checking(const ckdtree *self, const ckdtree *other,
-                     std::vector<ckdtree_intp_t> **results,
+                     const Sink &results,
                      const ckdtreenode *node1, const ckdtreenode *node2)
 {
     const ckdtreenode *lnode1;
     const ckdtreenode *lnode2;
     const ckdtree_intp_t *sindices = self->raw_indices;
     const ckdtree_intp_t *oindices = other->raw_indices;
-    std::vector<ckdtree_intp_t> *results_i;
     ckdtree_intp_t i, j;
 
     if (node1->split_dim == -1) {   /* leaf node */
@@ -38,9 +64,9 @@ traverse_no_checking(const ckdtree *self, const ckdtree *other,
             const ckdtree_intp_t end2 = lnode2->end_idx;
 
             for (i = start1; i < end1; ++i) {
-                results_i = results[sindices[i]];
+                const ckdtree_intp_t si = sindices[i];
                 for (j = start2; j < end2; ++j)
-                    results_i->push_back(oindices[j]);
+                    results.add(si, oindices[j]);
             }
         }
         else {
@@ -55,75 +81,32 @@ traverse_no_checking(const ckdtree *self, const ckdtree *other,
 }
 
 
-template <typename MinMaxDist> static void
+template <typename MinMaxDist, typename Sink> static void
 traverse_checking(const ckdtree *self, const ckdtree *other,
-                  std::vector<ckdtree_intp_t> **results,
+                  const Sink &results,
                   const ckdtreenode *node1, const ckdtreenode *node2,
                   RectRectDistanceTracker<MinMaxDist> *tracker)
 {
-    const ckdtreenode *lnode1;
-    const ckdtreenode *lnode2;
-    std::vector<ckdtree_intp_t> *results_i;
-    double d;
-    ckdtree_intp_t i, j;
-
     if (tracker->min_distance > tracker->upper_bound * tracker->epsfac)
         return;
     else if (tracker->max_distance < tracker->upper_bound / tracker->epsfac)
         traverse_no_checking(self, other, results, node1, node2);
     else if (node1->split_dim == -1) { /* 1 is leaf node */
-        lnode1 = node1;
 
         if (node2->split_dim == -1) {  /* 1 & 2 are leaves */
 
             /* brute-force */
-            lnode2 = node2;
-            const double p = tracker->p;
             const double tub = tracker->upper_bound;
-            const double tmd = tracker->max_distance;
-            const double *sdata = self->raw_data;
             const ckdtree_intp_t *sindices = self->raw_indices;
-            const double *odata = other->raw_data;
             const ckdtree_intp_t *oindices = other->raw_indices;
-            const ckdtree_intp_t m = self->m;
-            const ckdtree_intp_t start1 = lnode1->start_idx;
-            const ckdtree_intp_t start2 = lnode2->start_idx;
-            const ckdtree_intp_t end1 = lnode1->end_idx;
-            const ckdtree_intp_t end2 = lnode2->end_idx;
-
-            CKDTREE_PREFETCH(sdata + sindices[start1] * m, 0, m);
-
-            if (start1 < end1 - 1)
-                CKDTREE_PREFETCH(sdata + sindices[start1+1] * m, 0, m);
-
-            for (i = start1; i < end1; ++i) {
-
-                if (i < end1 - 2)
-                    CKDTREE_PREFETCH(sdata + sindices[i+2] * m, 0, m);
-
-                CKDTREE_PREFETCH(odata + oindices[start2] * m, 0, m);
-
-                if (start2 < end2 - 1)
-                    CKDTREE_PREFETCH(odata + oindices[start2+1] * m, 0, m);
-
-                results_i = results[sindices[i]];
-
-                for (j = start2; j < end2; ++j) {
-
-                    if (j < end2 - 2)
-                        CKDTREE_PREFETCH(odata + oindices[j+2] * m, 0, m);
-
-                    d = MinMaxDist::point_point_p(
-                            self,
-                            sdata + sindices[i] * m,
-                            odata + oindices[j] * m,
-                            p, m, tmd);
-
-                    if (d <= tub)
-                        results_i->push_back(other->raw_indices[j]);
-                }
-            }
 
+            scan_leaf_pair<MinMaxDist>(self, other, node1, node2, tracker->p,
+                                       tracker->max_distance, false,
+                    [&](const ckdtree_intp_t i, const ckdtree_intp_t j,
+                        const double d) {
+                if (d <= tub)
+                    results.add(sindices[i], oindices[j]);
+            });
         }
         else { /* 1 is a leaf node, 2 is inner node */
 
@@ -180,21 +163,71 @@ traverse_checking(const ckdtree *self, const ckdtree *other,
     }
 }
 
+/*
+ * Find the neighbors on n_jobs threads. Only the nodes of self are split,
+ * so each point of self, and its results vector, belongs to one node pair.
+ */
+template <typename MinMaxDist> static void
+traverse_parallel(const ckdtree *self, const ckdtree *other,
+                  std::vector<ckdtree_intp_t> **results,
+                  const Rectangle &r1, const Rectangle &r2,
+                  const double r, const double p, const double eps,
+                  const int n_jobs)
+{
+    std::vector<NodePair> pairs = split_node_pairs(self, other, r1, r2,
+                                                   SPLIT_FIRST, n_jobs);
+    const list_sink sink = {results};
+
+    traverse_node_pairs<MinMaxDist, char>(
+        self, pairs, p, eps, r, n_jobs,
+        [&](RectRectDistanceTracker<MinMaxDist> *tracker,
+            const NodePair &pair, char &) {
+        traverse_checking(self, other, sink, pair.node1, pair.node2,
+                          tracker);
+    });
+}
+
+/* As traverse_parallel, with the pairs of neighbors of each chunk */
+template <typename MinMaxDist> static std::vector<std::vector<ordered_pair> >
+traverse_parallel_pairs(const ckdtree *self, const ckdtree *other,
+                        const Rectangle &r1, const Rectangle &r2,
+                        const double r, const double p, const double eps,
+                        const int n_jobs)
+{
+    std::vector<NodePair> pairs = split_node_pairs(self, other, r1, r2,
+                                                   SPLIT_FIRST, n_jobs);
+
+    return traverse_node_pairs<MinMaxDist, std::vector<ordered_pair> >(
+        self, pairs, p, eps, r, n_jobs,
+        [&](RectRectDistanceTracker<MinMaxDist> *tracker,
+            const NodePair &pair, std::vector<ordered_pair> &buffer) {
+        const pair_sink sink = {&buffer};
+        traverse_checking(self, other, sink, pair.node1, pair.node2,
+                          tracker);
+    });
+}
+
 int
 query_ball_tree(const ckdtree *self, const ckdtree *other,
                 const double r, const double p, const double eps,
-                std::vector<ckdtree_intp_t> **results)
+                std::vector<ckdtree_intp_t> **results, const int n_jobs)
 {
 
 #define HANDLE(cond, kls) \
     if(cond) { \
-        RectRectDistanceTracker<kls> tracker(self, r1, r2, p, eps, r); \
-        traverse_checking(self, other, results, self->ctree, other->ctree, \
-            &tracker); \
+        if (n_jobs > 1) { \
+            traverse_parallel<kls>(self, other, results, r1, r2, r, p, eps, \
+                n_jobs); \
+        } else { \
+            RectRectDistanceTracker<kls> tracker(self, r1, r2, p, eps, r); \
+            traverse_checking(self, other, sink, self->ctree, other->ctree, \
+                &tracker); \
+        } \
     } else
 
     Rectangle r1(self->m, self->raw_mins, self->raw_maxes);
     Rectangle r2(other->m, other->raw_mins, other->raw_maxes);
+    const list_sink sink = {results};
 
     if(CKDTREE_LIKELY(self->raw_boxsize_data == NULL)) {
         HANDLE(CKDTREE_LIKELY(p == 2), MinkowskiDistP2)
@@ -202,6 +235,12 @@ query_ball_tree(const ckdtree *self, const ckdtree *other,
         HANDLE(ckdtree_isinf(p), MinkowskiDistPinf)
         HANDLE(1, MinkowskiDistPp)
         {}
+    } else if (ckdtree_all_periodic(self)) {
+        HANDLE(CKDTREE_LIKELY(p == 2), PeriodicMinkowskiDistP2)
+        HANDLE(p == 1, PeriodicMinkowskiDistP1)
+        HANDLE(ckdtree_isinf(p), PeriodicMinkowskiDistPinf)
+        HANDLE(1, PeriodicMinkowskiDistPp)
+        {}
     } else {
         HANDLE(CKDTREE_LIKELY(p == 2), BoxMinkowskiDistP2)
         HANDLE(p == 1, BoxMinkowskiDistP1)
@@ -209,5 +248,93 @@ query_ball_tree(const ckdtree *self, const ckdtree *other,
         HANDLE(1, BoxMinkowskiDistPp)
         {}
     }
+#undef HANDLE
+    return 0;
+}
+
+/* rows of the CSR graph sorted per chunk */
+#define CKDTREE_SORT_GRAIN 1024
+
+/*
+ * The neighbors as a CSR graph: the neighbors in other of the point i of
+ * self are indices[indptr[i]:indptr[i+1]], sorted. indptr has self->n + 1
+ * entries. The pairs of neighbors found by each chunk of node pairs are
+ * buffered, then counted and scattered into the rows.
+ */
+int
+query_ball_tree_csr(const ckdtree *self, const ckdtree *other,
+                    const double r, const double p, const double eps,
+                    std::vector<ckdtree_intp_t> *indices,
+                    ckdtree_intp_t *indptr, const int n_jobs)
+{
+    std::vector<std::vector<ordered_pair> > buffers;
+
+#define HANDLE(cond, kls) \
+    if(cond) { \
+        if (n_jobs > 1) { \
+            buffers = traverse_parallel_pairs<kls>(self, other, r1, r2, r, \
+                p, eps, n_jobs); \
+        } else { \
+            buffers.resize(1); \
+            const pair_sink sink = {&buffers[0]}; \
+            RectRectDistanceTracker<kls> tracker(self, r1, r2, p, eps, r); \
+            traverse_checking(self, other, sink, self->ctree, other->ctree, \
+                &tracker); \
+        } \
+    } else
+
+    Rectangle r1(self->m, self->raw_mins, self->raw_maxes);
+    Rectangle r2(other->m, other->raw_mins, other->raw_maxes);
+
+    if(CKDTREE_LIKELY(self->raw_boxsize_data == NULL)) {
+        HANDLE(CKDTREE_LIKELY(p == 2), MinkowskiDistP2)
+        HANDLE(p == 1, MinkowskiDistP1)
+        HANDLE(ckdtree_isinf(p), MinkowskiDistPinf)
+        HANDLE(1, MinkowskiDistPp)
+        {}
+    } else if (ckdtree_all_periodic(self)) {
+        HANDLE(CKDTREE_LIKELY(p == 2), PeriodicMinkowskiDistP2)
+        HANDLE(p == 1, PeriodicMinkowskiDistP1)
+        HANDLE(ckdtree_isinf(p), PeriodicMinkowskiDistPinf)
+        HANDLE(1, PeriodicMinkowskiDistPp)
+        {}
+    } else {
+        HANDLE(CKDTREE_LIKELY(p == 2), BoxMinkowskiDistP2)
+        HANDLE(p == 1, BoxMinkowskiDistP1)
+        HANDLE(ckdtree_isinf(p), BoxMinkowskiDistPinf)
+        HANDLE(1, BoxMinkowskiDistPp)
+        {}
+    }
+#undef HANDLE
+
+    const ckdtree_intp_t n = self->n;
+    std::fill(indptr, indptr + n + 1, 0);
+    for (std::vector<std::vector<ordered_pair> >::const_iterator
+             b = buffers.begin(); b != buffers.end(); ++b)
+        for (std::vector<ordered_pair>::const_iterator
+                 it = b->begin(); it != b->end(); ++it)
+            ++indptr[it->i + 1];
+    for (ckdtree_intp_t i = 0; i < n; ++i)
+        indptr[i + 1] += indptr[i];
+
+    /* scatter the pairs, using indptr[i] as the next free slot of row i */
+    indices->resize(indptr[n]);
+    for (std::vector<std::vector<ordered_pair> >::iterator
+             b = buffers.begin(); b != buffers.end(); ++b) {
+        for (std::vector<ordered_pair>::const_iterator
+                 it = b->begin(); it != b->end(); ++it)
+            (*indices)[indptr[it->i]++] = it->j;
+        std::vector<ordered_pair>().swap(*b);
+    }
+    for (ckdtree_intp_t i = n; i > 0; --i)
+        indptr[i] = indptr[i - 1];
+    indptr[0] = 0;
+
+    ckdtree_intp_t *rows = indices->empty() ? NULL : &(*indices)[0];
+    ckdtree_parallel_for(n, CKDTREE_SORT_GRAIN, n_jobs,
+                         [&](ckdtree_intp_t start, ckdtree_intp_t stop) {
+        for (ckdtree_intp_t i = start; i < stop; ++i)
+            std::sort(rows + indptr[i], rows + indptr[i + 1]);
+    });
     return 0;
 }
@@ -13,11 +13,14 @@
 #include "ckdtree_decl.h"
 #include "ordered_pair.h"
 #include "rectangle.h"
+#include "leaf_scan.h"
+#include "parallel_traverse.h"
+#include "batch_sink.h"
 
 
-static void
+template <typename Results> static void
 traverse_no_checking(const ckdtree *self,
-                     std::vector<ordered_pair> *results,
+                     Results *results,
                      const ckdtreenode *node1, const ckdtreenode *node2)
 {
     const ckdtreenode *lnode1;
@@ -73,73 +76,30 @@ traverse_no_checking(const ckdtree *self,
 }
 
 
-template <typename MinMaxDist> static void
+template <typename MinMaxDist, typename Results> static void
 traverse_checking(const ckdtree *self,
-                  std::vector<ordered_pair> *results,
+                  Results *results,
                   const ckdtreenode *node1, const ckdtreenode *node2,
                   RectRectDistanceTracker<MinMaxDist> *tracker)
 {
-    const ckdtreenode *lnode1;
-    const ckdtreenode *lnode2;
-    double d;
-    ckdtree_intp_t i, j, min_j;
-
     if (tracker->min_distance > tracker->upper_bound * tracker->epsfac)
         return;
     else if (tracker->max_distance < tracker->upper_bound / tracker->epsfac)
         traverse_no_checking(self, results, node1, node2);
     else if (node1->split_dim == -1) { /* 1 is leaf node */
-        lnode1 = node1;
 
         if (node2->split_dim == -1) {  /* 1 & 2 are leaves */
-            lnode2 = node2;
-
             /* brute-force */
-            const double p = tracker->p;
             const double tub = tracker->upper_bound;
-            const double *data = self->raw_data;
             const ckdtree_intp_t *indices = self->raw_indices;
-            const ckdtree_intp_t m = self->m;
-            const ckdtree_intp_t start1 = lnode1->start_idx;
-            const ckdtree_intp_t start2 = lnode2->start_idx;
-            const ckdtree_intp_t end1 = lnode1->end_idx;
-            const ckdtree_intp_t end2 = lnode2->end_idx;
-
-            CKDTREE_PREFETCH(data+indices[start1]*m, 0, m);
-            if (start1 < end1 - 1)
-               CKDTREE_PREFETCH(data+indices[start1+1]*m, 0, m);
 
-            for(i = start1; i < end1; ++i) {
-
-                if (i < end1 - 2)
-                     CKDTREE_PREFETCH(data+indices[i+2]*m, 0, m);
-
-                /* Special care here to avoid duplicate pairs */
-                if (node1 == node2)
-                    min_j = i + 1;
-                else
-                    min_j = start2;
-
-                if (min_j < end2)
-                    CKDTREE_PREFETCH(data+indices[min_j]*m, 0, m);
-                if (min_j < end2 - 1)
-                    CKDTREE_PREFETCH(data+indices[min_j+1]*m, 0, m);
-
-                for (j = min_j; j < end2; ++j) {
-
-                    if (j < end2 - 2)
-                        CKDTREE_PREFETCH(data+indices[j+2]*m, 0, m);
-
-                    d = MinMaxDist::point_point_p(
-                            self,
-                            data + indices[i] * m,
-                            data + indices[j] * m,
-                            p, m, tub);
-
-                    if (d <= tub)
-                        add_ordered_pair(results, indices[i], indices[j]);
-                }
-            }
+            scan_leaf_pair<MinMaxDist>(self, self, node1, node2, tracker->p,
+                                       tub, true,
+                    [&](const ckdtree_intp_t i, const ckdtree_intp_t j,
+                        const double d) {
+                if (d <= tub)
+                    add_ordered_pair(results, indices[i], indices[j]);
+            });
         }
         else {  /* 1 is a leaf node, 2 is inner node */
             tracker->push_less_of(2, node2);
@@ -196,19 +156,79 @@ traverse_checking(const ckdtree *self,
 }
 
 
-#include <iostream>
+/*
+ * Find the pairs on n_jobs threads, with one list of pairs per chunk of
+ * node pairs; the lists are appended in chunk order
+ */
+template <typename MinMaxDist> static void
+traverse_parallel(const ckdtree *self, std::vector<ordered_pair> *results,
+                  const Rectangle &r1, const Rectangle &r2,
+                  const double r, const double p, const double eps,
+                  const int n_jobs)
+{
+    std::vector<NodePair> pairs = split_node_pairs(self, self, r1, r2,
+                                                   SPLIT_SYMMETRIC, n_jobs);
+
+    std::vector<std::vector<ordered_pair> > chunk_results =
+        traverse_node_pairs<MinMaxDist, std::vector<ordered_pair> >(
+            self, pairs, p, eps, r, n_jobs,
+            [&](RectRectDistanceTracker<MinMaxDist> *tracker,
+                const NodePair &pair, std::vector<ordered_pair> &chunk) {
+        traverse_checking(self, &chunk, pair.node1, pair.node2, tracker);
+    });
+
+    std::size_t n_results = results->size();
+    for (std::size_t c = 0; c < chunk_results.size(); ++c)
+        n_results += chunk_results[c].size();
+    results->reserve(n_results);
+    for (std::size_t c = 0; c < chunk_results.size(); ++c) {
+        results->insert(results->end(), chunk_results[c].begin(),
+                        chunk_results[c].end());
+        std::vector<ordered_pair>().swap(chunk_results[c]);
+    }
+}
+
+/* As traverse_parallel, with a batch_sink per chunk of node pairs */
+template <typename MinMaxDist> static void
+traverse_parallel_batched(const ckdtree *self, batch_output *output,
+                          const Rectangle &r1, const Rectangle &r2,
+                          const double r, const double p, const double eps,
+                          const int n_jobs)
+{
+    std::vector<NodePair> pairs = split_node_pairs(self, self, r1, r2,
+                                                   SPLIT_SYMMETRIC, n_jobs);
+
+    std::vector<batch_sink<ordered_pair> > chunk_results =
+        traverse_node_pairs<MinMaxDist, batch_sink<ordered_pair> >(
+            self, pairs, p, eps, r, n_jobs,
+            [&](RectRectDistanceTracker<MinMaxDist> *tracker,
+                const NodePair &pair, batch_sink<ordered_pair> &chunk) {
+        chunk.output = output;
+        traverse_checking(self, &chunk, pair.node1, pair.node2, tracker);
+    });
+
+    /* the entries left over by the chunks go out in full batches */
+    batch_sink<ordered_pair> rest(output);
+    for (std::size_t c = 0; c < chunk_results.size(); ++c)
+        rest.append(chunk_results[c]);
+    rest.emit();
+}
 
 int
 query_pairs(const ckdtree *self,
             const double r, const double p, const double eps,
-            std::vector<ordered_pair> *results)
+            std::vector<ordered_pair> *results, const int n_jobs)
 {
 
 #define HANDLE(cond, kls) \
     if(cond) { \
-        RectRectDistanceTracker<kls> tracker(self, r1, r2, p, eps, r);\
-        traverse_checking(self, results, self->ctree, self->ctree, \
-            &tracker); \
+        if (n_jobs > 1) { \
+            traverse_parallel<kls>(self, results, r1, r2, r, p, eps, n_jobs); \
+        } else { \
+            RectRectDistanceTracker<kls> tracker(self, r1, r2, p, eps, r);\
+            traverse_checking(self, results, self->ctree, self->ctree, \
+                &tracker); \
+        } \
     } else
 
     Rectangle r1(self->m, self->raw_mins, self->raw_maxes);
@@ -220,6 +240,12 @@ query_pairs(const ckdtree *self,
         HANDLE(ckdtree_isinf(p), MinkowskiDistPinf)
         HANDLE(1, MinkowskiDistPp)
         {}
+    } else if (ckdtree_all_periodic(self)) {
+        HANDLE(CKDTREE_LIKELY(p == 2), PeriodicMinkowskiDistP2)
+        HANDLE(p == 1, PeriodicMinkowskiDistP1)
+        HANDLE(ckdtree_isinf(p), PeriodicMinkowskiDistPinf)
+        HANDLE(1, PeriodicMinkowskiDistPp)
+        {}
     } else {
         HANDLE(CKDTREE_LIKELY(p == 2), BoxMinkowskiDistP2)
         HANDLE(p == 1, BoxMinkowskiDistP1)
@@ -227,6 +253,61 @@ query_pairs(const ckdtree *self,
         HANDLE(1, BoxMinkowskiDistPp)
         {}
     }
+#undef HANDLE
+
+    return 0;
+}
+
+int
+query_pairs_batched(const ckdtree *self,
+                    const double r, const double p, const double eps,
+                    const ckdtree_intp_t batch_size, ckdtree_batch_func flush,
+                    void *context, const int n_jobs)
+{
+
+#define HANDLE(cond, kls) \
+    if(cond) { \
+        if (n_jobs > 1) { \
+            traverse_parallel_batched<kls>(self, &output, r1, r2, r, p, eps, \
+                n_jobs); \
+        } else { \
+            batch_sink<ordered_pair> sink(&output); \
+            RectRectDistanceTracker<kls> tracker(self, r1, r2, p, eps, r);\
+            traverse_checking(self, &sink, self->ctree, self->ctree, \
+                &tracker); \
+            sink.emit(); \
+        } \
+    } else
+
+    Rectangle r1(self->m, self->raw_mins, self->raw_maxes);
+    Rectangle r2(self->m, self->raw_mins, self->raw_maxes);
+    batch_output output(batch_size, flush, context);
+
+    try {
+        if(CKDTREE_LIKELY(self->raw_boxsize_data == NULL)) {
+            HANDLE(CKDTREE_LIKELY(p == 2), MinkowskiDistP2)
+            HANDLE(p == 1, MinkowskiDistP1)
+            HANDLE(ckdtree_isinf(p), MinkowskiDistPinf)
+            HANDLE(1, MinkowskiDistPp)
+            {}
+        } else if (ckdtree_all_periodic(self)) {
+            HANDLE(CKDTREE_LIKELY(p == 2), PeriodicMinkowskiDistP2)
+            HANDLE(p == 1, PeriodicMinkowskiDistP1)
+            HANDLE(ckdtree_isinf(p), PeriodicMinkowskiDistPinf)
+            HANDLE(1, PeriodicMinkowskiDistPp)
+            {}
+        } else {
+            HANDLE(CKDTREE_LIKELY(p == 2), BoxMinkowskiDistP2)
+            HANDLE(p == 1, BoxMinkowskiDistP1)
+            HANDLE(ckdtree_isinf(p), BoxMinkowskiDistPinf)
+            HANDLE(1, BoxMinkowskiDistPp)
+            {}
+        }
+    }
+    catch (const batch_stopped &) {
+        return -1;
+    }
+#undef HANDLE
 
     return 0;
 }
@@ -9,6 +9,7 @@
 #include <cmath>
 #include <cstring>
 
+#include "traversal_stats.h"
 
 /* Interval arithmetic
  * ===================
@@ -104,6 +105,9 @@ template<typename MinMaxDist>
     std::vector<RR_stack_item> stack_arr;
     RR_stack_item *stack;
 
+    /* counters of the traversals that use this tracker */
+    traversal_stats stats;
+
     /* if min/max distance / adjustment is less than this,
      * we believe the incremental tracking is inaccurate */
     double inaccurate_distance_limit;
@@ -186,6 +190,7 @@ template<typename MinMaxDist>
 
         RR_stack_item *item = &stack[stack_size];
         ++stack_size;
+        stats.note_depth(stack_size);
         item->which = which;
         item->split_dim = split_dim;
         item->min_distance = min_distance;
@@ -12,11 +12,14 @@
 
 #include "ckdtree_decl.h"
 #include "rectangle.h"
+#include "leaf_scan.h"
+#include "parallel_traverse.h"
 #include "coo_entries.h"
+#include "batch_sink.h"
 
-template <typename MinMaxDist> static void
+template <typename MinMaxDist, typename Results> static void
 traverse(const ckdtree *self, const ckdtree *other,
-         std::vector<coo_entry> *results,
+         Results *results,
          const ckdtreenode *node1, const ckdtreenode *node2,
          RectRectDistanceTracker<MinMaxDist> *tracker)
 {
@@ -29,51 +32,22 @@ traverse(const ckdtree *self, const ckdtree *other,
             /* brute-force */
             const double p = tracker->p;
             const double tub = tracker->upper_bound;
-            const double *sdata = self->raw_data;
             const ckdtree_intp_t *sindices = self->raw_indices;
-            const double *odata = other->raw_data;
             const ckdtree_intp_t *oindices = other->raw_indices;
-            const ckdtree_intp_t m = self->m;
-            const ckdtree_intp_t start1 = node1->start_idx;
-            const ckdtree_intp_t start2 = node2->start_idx;
-            const ckdtree_intp_t end1 = node1->end_idx;
-            const ckdtree_intp_t end2 = node2->end_idx;
-
-            CKDTREE_PREFETCH(sdata + sindices[start1] * m, 0, m);
-            if (start1 < end1 - 1)
-               CKDTREE_PREFETCH(sdata + sindices[start1+1] * m, 0, m);
-
-            for (ckdtree_intp_t i = start1; i < end1; ++i) {
-
-                if (i < end1 - 2)
-                     CKDTREE_PREFETCH(sdata + sindices[i+2] * m, 0, m);
-
-                CKDTREE_PREFETCH(odata + oindices[start2] * m, 0, m);
-                if (start2 < end2 - 1)
-                    CKDTREE_PREFETCH(sdata + oindices[start2+1] * m, 0, m);
 
-                for (ckdtree_intp_t j = start2; j < end2; ++j) {
+            scan_leaf_pair<MinMaxDist>(self, other, node1, node2, p, tub, false,
+                    [&](const ckdtree_intp_t i, const ckdtree_intp_t j,
+                        double d) {
+                if (d <= tub) {
+                    if (CKDTREE_LIKELY(p == 2.0))
+                        d = std::sqrt(d);
+                    else if ((p != 1) && (!ckdtree_isinf(p)))
+                        d = std::pow(d, 1. / p);
 
-                    if (j < end2 - 2)
-                        CKDTREE_PREFETCH(odata + oindices[j+2] * m, 0, m);
-
-                    double d = MinMaxDist::point_point_p(
-                            self,
-                            sdata + sindices[i] * m,
-                            odata + oindices[j] * m,
-                            p, m, tub);
-
-                    if (d <= tub) {
-                        if (CKDTREE_LIKELY(p == 2.0))
-                            d = std::sqrt(d);
-                        else if ((p != 1) && (!ckdtree_isinf(p)))
-                            d = std::pow(d, 1. / p);
-
-                        coo_entry e = {sindices[i], oindices[j], d};
-                        results->push_back(e);
-                    }
+                    coo_entry e = {sindices[i], oindices[j], d};
+                    results->push_back(e);
                 }
-            }
+            });
         }
         else {  /* 1 is a leaf node, 2 is inner node */
             tracker->push_less_of(2, node2);
@@ -122,16 +96,83 @@ traverse(const ckdtree *self, const ckdtree *other,
 }
 
 
+/*
+ * Compute the distances on n_jobs threads, with one list of entries per
+ * chunk of node pairs; the lists are appended in chunk order
+ */
+template <typename MinMaxDist> static void
+traverse_parallel(const ckdtree *self, const ckdtree *other,
+                  std::vector<coo_entry> *results,
+                  const Rectangle &r1, const Rectangle &r2,
+                  const double p, const double max_distance,
+                  const int n_jobs)
+{
+    std::vector<NodePair> pairs = split_node_pairs(self, other, r1, r2,
+                                                   SPLIT_BOTH, n_jobs);
+
+    std::vector<std::vector<coo_entry> > chunk_results =
+        traverse_node_pairs<MinMaxDist, std::vector<coo_entry> >(
+            self, pairs, p, 0, max_distance, n_jobs,
+            [&](RectRectDistanceTracker<MinMaxDist> *tracker,
+                const NodePair &pair, std::vector<coo_entry> &chunk) {
+        traverse(self, other, &chunk, pair.node1, pair.node2, tracker);
+    });
+
+    std::size_t n_results = results->size();
+    for (std::size_t c = 0; c < chunk_results.size(); ++c)
+        n_results += chunk_results[c].size();
+    results->reserve(n_results);
+    for (std::size_t c = 0; c < chunk_results.size(); ++c) {
+        results->insert(results->end(), chunk_results[c].begin(),
+                        chunk_results[c].end());
+        std::vector<coo_entry>().swap(chunk_results[c]);
+    }
+}
+
+/* As traverse_parallel, with a batch_sink per chunk of node pairs */
+template <typename MinMaxDist> static void
+traverse_parallel_batched(const ckdtree *self, const ckdtree *other,
+                          batch_output *output,
+                          const Rectangle &r1, const Rectangle &r2,
+                          const double p, const double max_distance,
+                          const int n_jobs)
+{
+    std::vector<NodePair> pairs = split_node_pairs(self, other, r1, r2,
+                                                   SPLIT_BOTH, n_jobs);
+
+    std::vector<batch_sink<coo_entry> > chunk_results =
+        traverse_node_pairs<MinMaxDist, batch_sink<coo_entry> >(
+            self, pairs, p, 0, max_distance, n_jobs,
+            [&](RectRectDistanceTracker<MinMaxDist> *tracker,
+                const NodePair &pair, batch_sink<coo_entry> &chunk) {
+        chunk.output = output;
+        traverse(self, other, &chunk, pair.node1, pair.node2, tracker);
+    });
+
+    /* the entries left over by the chunks go out in full batches */
+    batch_sink<coo_entry> rest(output);
+    for (std::size_t c = 0; c < chunk_results.size(); ++c)
+        rest.append(chunk_results[c]);
+    rest.emit();
+}
+
+
 int
 sparse_distance_matrix(const ckdtree *self, const ckdtree *other,
                        const double p,
                        const double max_distance,
-                       std::vector<coo_entry> *results)
+                       std::vector<coo_entry> *results,
+                       const int n_jobs)
 {
 #define HANDLE(cond, kls) \
     if(cond) { \
-        RectRectDistanceTracker<kls> tracker(self, r1, r2, p, 0, max_distance);\
-        traverse(self, other, results, self->ctree, other->ctree, &tracker); \
+        if (n_jobs > 1) { \
+            traverse_parallel<kls>(self, other, results, r1, r2, p, \
+                max_distance, n_jobs); \
+        } else { \
+            RectRectDistanceTracker<kls> tracker(self, r1, r2, p, 0, max_distance);\
+            traverse(self, other, results, self->ctree, other->ctree, &tracker); \
+        } \
     } else
 
     Rectangle r1(self->m, self->raw_mins, self->raw_maxes);
@@ -142,6 +183,12 @@ sparse_distance_matrix(const ckdtree *self, const ckdtree *other,
         HANDLE(ckdtree_isinf(p), MinkowskiDistPinf)
         HANDLE(1, MinkowskiDistPp)
         {}
+    } else if (ckdtree_all_periodic(self)) {
+        HANDLE(CKDTREE_LIKELY(p == 2), PeriodicMinkowskiDistP2)
+        HANDLE(p == 1, PeriodicMinkowskiDistP1)
+        HANDLE(ckdtree_isinf(p), PeriodicMinkowskiDistPinf)
+        HANDLE(1, PeriodicMinkowskiDistPp)
+        {}
     } else {
         HANDLE(CKDTREE_LIKELY(p == 2), BoxMinkowskiDistP2)
         HANDLE(p == 1, BoxMinkowskiDistP1)
@@ -149,6 +196,61 @@ sparse_distance_matrix(const ckdtree *self, const ckdtree *other,
         HANDLE(1, BoxMinkowskiDistPp)
         {}
     }
+#undef HANDLE
+
+    return 0;
+}
+
+int
+sparse_distance_matrix_batched(const ckdtree *self, const ckdtree *other,
+                               const double p,
+                               const double max_distance,
+                               const ckdtree_intp_t batch_size,
+                               ckdtree_batch_func flush, void *context,
+                               const int n_jobs)
+{
+#define HANDLE(cond, kls) \
+    if(cond) { \
+        if (n_jobs > 1) { \
+            traverse_parallel_batched<kls>(self, other, &output, r1, r2, p, \
+                max_distance, n_jobs); \
+        } else { \
+            batch_sink<coo_entry> sink(&output); \
+            RectRectDistanceTracker<kls> tracker(self, r1, r2, p, 0, max_distance);\
+            traverse(self, other, &sink, self->ctree, other->ctree, &tracker); \
+            sink.emit(); \
+        } \
+    } else
+
+    Rectangle r1(self->m, self->raw_mins, self->raw_maxes);
+    Rectangle r2(other->m, other->raw_mins, other->raw_maxes);
+    batch_output output(batch_size, flush, context);
+
+    try {
+        if(CKDTREE_LIKELY(self->raw_boxsize_data == NULL)) {
+            HANDLE(CKDTREE_LIKELY(p == 2), MinkowskiDistP2)
+            HANDLE(p == 1, MinkowskiDistP1)
+            HANDLE(ckdtree_isinf(p), MinkowskiDistPinf)
+            HANDLE(1, MinkowskiDistPp)
+            {}
+        } else if (ckdtree_all_periodic(self)) {
+            HANDLE(CKDTREE_LIKELY(p == 2), PeriodicMinkowskiDistP2)
+            HANDLE(p == 1, PeriodicMinkowskiDistP1)
+            HANDLE(ckdtree_isinf(p), PeriodicMinkowskiDistPinf)
+            HANDLE(1, PeriodicMinkowskiDistPp)
+            {}
+        } else {
+            HANDLE(CKDTREE_LIKELY(p == 2), BoxMinkowskiDistP2)
+            HANDLE(p == 1, BoxMinkowskiDistP1)
+            HANDLE(ckdtree_isinf(p), BoxMinkowskiDistPinf)
+            HANDLE(1, BoxMinkowskiDistPp)
+            {}
+        }
+    }
+    catch (const batch_stopped &) {
+        return -1;
+    }
+#undef HANDLE
 
     return 0;
 }
@@ -0,0 +1,181 @@
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <exception>
+#include <system_error>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "ckdtree_decl.h"
+#include "thread_pool.h"
+
+/*
+ * Number of chunks handed out per thread, so that uneven queries still
+ * balance out at the end of a job
+ */
+#define CKDTREE_CHUNKS_PER_THREAD 8
+
+namespace {
+
+/* true on the pool's own threads, to run nested jobs serially */
+thread_local bool ckdtree_in_pool = false;
+
+struct pool_job {
+
+    const ckdtree_chunk_func *body;
+    ckdtree_intp_t n;
+    ckdtree_intp_t chunk;
+    std::atomic<ckdtree_intp_t> next;
+    std::mutex error_lock;
+    std::exception_ptr error;
+
+    pool_job(const ckdtree_chunk_func *body, ckdtree_intp_t n,
+             ckdtree_intp_t chunk) : body(body), n(n), chunk(chunk), next(0) {}
+
+    void run() {
+        for (;;) {
+            const ckdtree_intp_t start = next.fetch_add(chunk);
+            if (start >= n)
+                return;
+            try {
+                (*body)(start, std::min(n, start + chunk));
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> guard(error_lock);
+                if (!error)
+                    error = std::current_exception();
+                next.store(n);
+            }
+        }
+    }
+};
+
+struct thread_pool {
+
+    std::mutex submit_lock;  /* held by the thread running a job */
+    std::mutex lock;         /* protects the fields below */
+    std::condition_variable wake;
+    std::condition_variable finished;
+    int n_threads;
+    pool_job *job;
+    unsigned long generation;
+    int wanted;              /* helpers that may still join the job */
+    int busy;                /* helpers working on the job */
+
+    thread_pool() : n_threads(0), job(NULL), generation(0), wanted(0),
+                    busy(0) {}
+
+    void worker_loop() {
+        ckdtree_in_pool = true;
+        unsigned long seen = 0;
+        std::unique_lock<std::mutex> guard(lock);
+        for (;;) {
+            wake.wait(guard, [&]() {
+                return generation != seen && wanted > 0;
+            });
+            seen = generation;
+            --wanted;
+            ++busy;
+            pool_job *current = job;
+            guard.unlock();
+            current->run();
+            guard.lock();
+            if (--busy == 0)
+                finished.notify_all();
+        }
+    }
+
+    /* make sure that count helper threads exist, as far as possible */
+    void grow(int count) {
+        while (n_threads < count) {
+            try {
+                std::thread(&thread_pool::worker_loop, this).detach();
+            }
+            catch (const std::system_error &) {
+                break;
+            }
+            ++n_threads;
+        }
+    }
+
+    void run(pool_job &current, int helpers) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            grow(helpers);
+            job = &current;
+            wanted = std::min(helpers, n_threads);
+            ++generation;
+        }
+        wake.notify_all();
+
+        current.run();
+
+        std::unique_lock<std::mutex> guard(lock);
+        /* helpers that have not woken up yet would find nothing to do */
+        wanted = 0;
+        finished.wait(guard, [&]() { return busy == 0; });
+        job = NULL;
+    }
+};
+
+/*
+ * The pool is never destroyed: its threads are detached and simply sleep
+ * until the process exits. A forked child does not inherit the threads,
+ * so it starts a pool of its own.
+ */
+thread_pool *
+get_pool()
+{
+    static std::mutex pool_lock;
+    static thread_pool *pool = NULL;
+#ifndef _WIN32
+    static pid_t pool_pid = 0;
+#endif
+
+    std::lock_guard<std::mutex> guard(pool_lock);
+#ifndef _WIN32
+    if (pool != NULL && pool_pid != getpid())
+        pool = NULL;
+    pool_pid = getpid();
+#endif
+    if (pool == NULL)
+        pool = new thread_pool();
+    return pool;
+}
+
+} // namespace
+
+
+void
+ckdtree_parallel_for(const ckdtree_intp_t n, const ckdtree_intp_t grain,
+                     const int n_jobs, const ckdtree_chunk_func &body)
+{
+    if (n <= 0)
+        return;
+
+    const ckdtree_intp_t workers = std::min<ckdtree_intp_t>(
+        n_jobs, (n + grain - 1) / grain);
+    if (workers <= 1 || ckdtree_in_pool) {
+        body(0, n);
+        return;
+    }
+
+    const ckdtree_intp_t n_chunks = workers * CKDTREE_CHUNKS_PER_THREAD;
+    const ckdtree_intp_t chunk = std::max(grain, (n + n_chunks - 1) / n_chunks);
+    pool_job job(&body, n, chunk);
+
+    thread_pool *pool = get_pool();
+    std::unique_lock<std::mutex> submit(pool->submit_lock, std::try_to_lock);
+    if (submit.owns_lock())
+        pool->run(job, workers - 1);
+    else
+        job.run();
+
+    if (job.error)
+        std::rethrow_exception(job.error);
+}
@@ -0,0 +1,34 @@
+#ifndef CKDTREE_THREAD_POOL
+#define CKDTREE_THREAD_POOL
+
+#include <functional>
+
+#include "ckdtree_decl.h"
+
+/*
+ * Persistent worker threads for the query methods
+ * ===============================================
+ *
+ * The threads are started on first use and then kept, so that a query
+ * on n_jobs threads does not pay for starting them every time. The
+ * calling thread always takes part in the work.
+ *
+ * ckdtree_parallel_for runs body(start, stop) over consecutive chunks of
+ * [0, n). Chunks are claimed one at a time from a shared counter, so
+ * threads that get cheap queries simply take more chunks. Each chunk has
+ * at least `grain` items. The first exception thrown by body is rethrown
+ * on the calling thread once all chunks have finished; the remaining
+ * chunks are then skipped.
+ *
+ * Calls from inside body, or while another thread is using the pool,
+ * run serially on the calling thread. body must not touch any Python
+ * objects, since the GIL is released.
+ */
+
+typedef std::function<void(ckdtree_intp_t, ckdtree_intp_t)> ckdtree_chunk_func;
+
+void
+ckdtree_parallel_for(const ckdtree_intp_t n, const ckdtree_intp_t grain,
+                     const int n_jobs, const ckdtree_chunk_func &body);
+
+#endif
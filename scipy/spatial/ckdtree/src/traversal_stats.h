@@ -0,0 +1,67 @@
+#ifndef CKDTREE_TRAVERSAL_STATS
+#define CKDTREE_TRAVERSAL_STATS
+
+#include <mutex>
+
+#include "ckdtree_decl.h"
+
+/*
+ * Traversal counters
+ * ==================
+ *
+ * query, query_ball_point and count_neighbors count their work in plain
+ * counters of each thread, and add them to ckdtree.stats at the end of a
+ * chunk of queries or node pairs if that is not NULL. Collecting them thus
+ * costs a few increments in the traversal and nothing else when disabled.
+ *
+ *  nodes_visited         nodes, or pairs of nodes, that the traversal entered
+ *  leaves_scanned        leaves, or pairs of leaves, whose points were checked
+ *  distance_evaluations  distances between points computed in those leaves
+ *  pruned_subtrees       subtrees, or pairs, dropped by their distance bounds
+ *  heap_pushes           cells pushed onto the priority queue of query
+ *  max_stack_depth       deepest stack of the distance tracker
+ */
+
+struct traversal_stats : ckdtree_stats {
+
+    traversal_stats() {
+        nodes_visited = 0;
+        leaves_scanned = 0;
+        distance_evaluations = 0;
+        pruned_subtrees = 0;
+        heap_pushes = 0;
+        max_stack_depth = 0;
+    }
+
+    inline void note_depth(const ckdtree_intp_t depth) {
+        if (depth > max_stack_depth)
+            max_stack_depth = depth;
+    }
+
+    inline void add(const ckdtree_stats &other) {
+        nodes_visited += other.nodes_visited;
+        leaves_scanned += other.leaves_scanned;
+        distance_evaluations += other.distance_evaluations;
+        pruned_subtrees += other.pruned_subtrees;
+        heap_pushes += other.heap_pushes;
+        note_depth(other.max_stack_depth);
+    }
+
+    /* add the counters to those of tree, if it collects them */
+    inline void commit(const ckdtree *tree) const {
+        if (CKDTREE_LIKELY(tree->stats == NULL))
+            return;
+        static std::mutex lock;
+        std::lock_guard<std::mutex> guard(lock);
+        ckdtree_stats *total = tree->stats;
+        total->nodes_visited += nodes_visited;
+        total->leaves_scanned += leaves_scanned;
+        total->distance_evaluations += distance_evaluations;
+        total->pruned_subtrees += pruned_subtrees;
+        total->heap_pushes += heap_pushes;
+        if (max_stack_depth > total->max_stack_depth)
+            total->max_stack_depth = max_stack_depth;
+    }
+};
+
+#endif
@@ -15,7 +15,10 @@ stored in a rectangular array.
 
    pdist   -- pairwise distances between observation vectors.
    cdist   -- distances between two collections of observation vectors
+   cdist_knn -- nearest neighbours between two collections of vectors
+   cdist_radius -- pairs of vectors within a given distance
    squareform -- convert distance matrix to a condensed one and vice versa
+   CondensedDistanceMatrix -- square-form lookups on a condensed matrix
    directed_hausdorff -- directed Hausdorff distance between arrays
 
 Predicates for checking the validity of distance matrices, both
@@ -79,8 +82,11 @@ __all__ = [
     'braycurtis',
     'canberra',
     'cdist',
+    'cdist_knn',
+    'cdist_radius',
     'chebyshev',
     'cityblock',
+    'CondensedDistanceMatrix',
     'correlation',
     'cosine',
     'dice',
@@ -110,6 +116,8 @@ __all__ = [
 ]
 
 
+import os
+import operator
 import warnings
 import numpy as np
 
@@ -165,11 +173,164 @@ def _args_to_kwargs_xdist(args, kwargs, metric, func_name):
     return kwargs
 
 
-def _copy_array_if_base_present(a):
-    """Copy the array if its base points to a parent array."""
-    if a.base is not None:
-        return a.copy()
-    return a
+def _workers(workers):
+    """Normalize a ``workers`` argument to a positive thread count.
+
+    ``None`` means a single thread, and negative values wrap around from
+    ``os.cpu_count()``, so that ``-1`` means all CPUs.
+    """
+    if workers is None:
+        return 1
+
+    workers = operator.index(workers)
+    if workers < 0:
+        cpu_count = os.cpu_count() or 1
+        if workers >= -cpu_count:
+            workers += 1 + cpu_count
+        else:
+            raise ValueError("workers value out of range; got {}, must not be"
+                             " less than {}".format(workers, -cpu_count))
+    elif workers == 0:
+        raise ValueError("workers must not be zero")
+    return workers
+
+
+# Number of columns from which the metrics in _GEMM_METRICS are computed
+# through a matrix product, unless the caller asks for exact=True
+_GEMM_MIN_DIM = 32
+_GEMM_METRICS = ('sqeuclidean', 'euclidean', 'cosine', 'correlation')
+
+# Approximate number of doubles of the Gram matrix block used by pdist
+_GEMM_PDIST_BLOCK = 1 << 22
+
+
+def _use_gemm(metric_name, n, exact, kwargs):
+    # Metric kwargs are left to the C wrappers, which reject them
+    return (not exact and not kwargs and n >= _GEMM_MIN_DIM and
+            metric_name in _GEMM_METRICS)
+
+
+def _gemm_prepare(metric_name, X):
+    """Rows and squared row norms of `X` for `_gemm_finish`"""
+    if metric_name == 'correlation':
+        X = X - X.mean(axis=1, keepdims=True)
+    return X, np.einsum('ij,ij->i', X, X)
+
+
+def _gemm_finish(metric_name, dm, sqA, sqB):
+    """Turn the products ``x.y`` in `dm` into distances, in place.
+
+    The squared Euclidean distance is ``|x|**2 + |y|**2 - 2 x.y``, clamped
+    at zero since it can round to small negative values, and the cosine
+    distance is ``1 - x.y / (|x| |y|)``. `sqA` and `sqB` are the squared
+    norms of the rows and columns of `dm`.
+    """
+    if metric_name in ('cosine', 'correlation'):
+        with np.errstate(divide='ignore', invalid='ignore'):
+            dm /= np.sqrt(sqA)[:, np.newaxis]
+            dm /= np.sqrt(sqB)[np.newaxis, :]
+        # Clip to correct rounding error.
+        np.clip(dm, -1., 1., out=dm)
+        np.subtract(1., dm, out=dm)
+    else:
+        dm *= -2.
+        dm += sqA[:, np.newaxis]
+        dm += sqB[np.newaxis, :]
+        np.maximum(dm, 0., out=dm)
+        if metric_name == 'euclidean':
+            np.sqrt(dm, out=dm)
+
+
+def _gemm_cdist(metric_name, XA, XB, dm):
+    """Distances between the rows of `XA` and `XB` from ``XA @ XB.T``"""
+    XA, sqA = _gemm_prepare(metric_name, XA)
+    XB, sqB = _gemm_prepare(metric_name, XB)
+    if dm.dtype == XA.dtype:
+        np.dot(XA, XB.T, out=dm)
+        _gemm_finish(metric_name, dm, sqA, sqB)
+    else:
+        G = np.dot(XA, XB.T)
+        _gemm_finish(metric_name, G, sqA, sqB)
+        dm[...] = G
+
+
+def _gemm_pdist(metric_name, X, dm):
+    """Condensed distances of the rows of `X` from ``X @ X.T``.
+
+    The product is computed in blocks of rows, so that only about
+    _GEMM_PDIST_BLOCK entries of it are held at once.
+    """
+    X, sq = _gemm_prepare(metric_name, X)
+    m = X.shape[0]
+    block = max(16, _GEMM_PDIST_BLOCK // max(m, 1))
+    for i0 in xrange(0, m - 1, block):
+        i1 = min(i0 + block, m - 1)
+        G = np.dot(X[i0:i1], X[i0:].T)
+        _gemm_finish(metric_name, G, sq[i0:i1], sq[i0:])
+        # The entries above the diagonal come out in condensed order
+        upper = (np.arange(m - i0)[np.newaxis, :] >
+                 np.arange(i1 - i0)[:, np.newaxis])
+        k0 = i0 * m - i0 * (i0 + 1) // 2
+        k1 = i1 * m - i1 * (i1 + 1) // 2
+        dm[k0:k1] = G[upper]
+
+
+# Metrics that can be computed on bit-packed boolean rows, see nbits
+_PACKED_METRICS = ('dice', 'hamming', 'jaccard', 'kulsinski',
+                   'rogerstanimoto', 'russellrao', 'sokalmichener',
+                   'sokalsneath', 'yule')
+
+
+def _validate_packed_input(X, nbits, metric_name, kwargs):
+    """Check the bit-packed rows `X` holding `nbits` features each."""
+    if metric_name not in _PACKED_METRICS:
+        raise ValueError("nbits is only supported for the unweighted "
+                         "metrics {}".format(", ".join(_PACKED_METRICS)))
+    if kwargs:
+        raise TypeError("got unexpected keyword arguments {} for bit-packed "
+                        "input".format(", ".join(sorted(kwargs))))
+    if X.dtype != np.uint64:
+        raise ValueError("bit-packed input must have dtype uint64, "
+                         "got {}".format(X.dtype))
+    nbits = operator.index(nbits)
+    if nbits < 1 or X.shape[1] != (nbits + 63) // 64:
+        raise ValueError("bit-packed input with {} features must have {} "
+                         "columns, got {}".format(nbits, (nbits + 63) // 64,
+                                                   X.shape[1]))
+    if nbits % 64 and (X[:, -1] >> np.uint64(nbits % 64)).any():
+        raise ValueError("the bits past the last feature must be zero")
+    return np.ascontiguousarray(X), nbits
+
+
+# Metrics with float32 kernels, see _use_float32
+_FLOAT32_METRICS = ('sqeuclidean', 'euclidean', 'minkowski', 'cosine',
+                    'correlation')
+
+
+def _acc64(acc_dtype):
+    """Whether float32 distances are summed in float64, see acc_dtype"""
+    if acc_dtype is None:
+        return True
+    acc_dtype = np.dtype(acc_dtype)
+    if acc_dtype not in (np.float32, np.float64):
+        raise ValueError("acc_dtype must be float32 or float64, got "
+                         "{}".format(acc_dtype))
+    return acc_dtype == np.float64
+
+
+def _use_float32(metric_name, arrays, kwargs):
+    # Other metric kwargs are left to the float64 path, which rejects them
+    allowed = ('p',) if metric_name == 'minkowski' else ()
+    return (metric_name in _FLOAT32_METRICS and
+            all(X.dtype == np.float32 for X in arrays) and
+            all(k in allowed for k in kwargs))
+
+
+def _check_double_output(dm):
+    if dm.dtype != np.double:
+        raise ValueError("Output array must be double type, float32 is only "
+                         "supported for float32 input and the metrics "
+                         "{}.".format(", ".join(_FLOAT32_METRICS)))
 
 
 def _correlation_cdist_wrap(XA, XB, dm, **kwargs):
@@ -183,6 +344,33 @@ def _correlation_pdist_wrap(X, dm, **kwargs):
     _distance_wrap.pdist_cosine_double_wrap(X2, dm, **kwargs)
 
 
+# With float64 sums the float32 rows are centered in float64 as well, which
+# keeps the results of float64 input
+def _correlation_cdist_float_wrap(XA, XB, dm, acc64=True, **kwargs):
+    if acc64:
+        XA = XA - XA.mean(axis=1, keepdims=True, dtype=np.double)
+        XB = XB - XB.mean(axis=1, keepdims=True, dtype=np.double)
+        out = dm if dm.dtype == np.double else np.empty(dm.shape)
+        _distance_wrap.cdist_cosine_double_wrap(XA, XB, out, **kwargs)
+        dm[...] = out
+    else:
+        XA = XA - XA.mean(axis=1, keepdims=True)
+        XB = XB - XB.mean(axis=1, keepdims=True)
+        _distance_wrap.cdist_cosine_float_wrap(XA, XB, dm, acc64=False,
+                                               **kwargs)
+
+
+def _correlation_pdist_float_wrap(X, dm, acc64=True, **kwargs):
+    if acc64:
+        X2 = X - X.mean(axis=1, keepdims=True, dtype=np.double)
+        out = dm if dm.dtype == np.double else np.empty(dm.shape)
+        _distance_wrap.pdist_cosine_double_wrap(X2, out, **kwargs)
+        dm[...] = out
+    else:
+        X2 = X - X.mean(axis=1, keepdims=True)
+        _distance_wrap.pdist_cosine_float_wrap(X2, dm, acc64=False, **kwargs)
+
+
 def _convert_to_type(X, out_type):
     return np.ascontiguousarray(X, dtype=out_type)
 
@@ -357,7 +545,7 @@ def _validate_wminkowski_kwargs(X, m, n, **kwargs):
     return kwargs
 
 
-def directed_hausdorff(u, v, seed=0):
+def directed_hausdorff(u, v, seed=0, workers=None):
     """
     Compute the directed Hausdorff distance between two N-D arrays.
 
@@ -371,7 +559,14 @@ def directed_hausdorff(u, v, seed=0):
         Input array.
     seed : int or None
         Local `numpy.random.RandomState` seed. Default is 0, a random
-        shuffling of u and v that guarantees reproducibility.
+        shuffling of u that guarantees reproducibility. The result does
+        not depend on it.
+    workers : int, optional
+        Number of threads to use. Negative values wrap around from the
+        number of CPUs, so ``-1`` uses all of them. The default (None)
+        computes on the calling thread.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -384,11 +579,14 @@ def directed_hausdorff(u, v, seed=0):
     index_2 : int
         index of point contributing to Hausdorff pair in `v`
 
+    If several pairs qualify, the one with the smallest ``index_1``, and
+    then the smallest ``index_2``, is returned.
+
     Raises
     ------
     ValueError
         An exception is thrown if `u` and `v` do not have
-        the same number of columns.
+        the same number of columns, or if either has no rows.
 
     Notes
     -----
@@ -402,6 +600,11 @@ def directed_hausdorff(u, v, seed=0):
     cmax and leads to an early break as often as possible. The authors
     have formally shown that the average runtime is closer to O(m).
 
+    To find such a distance quickly, the points of `v` are scanned in the
+    order of a `scipy.spatial.cKDTree` built on them, starting at an
+    approximate nearest neighbour of each point of `u`. The scans over the
+    points of `u` are spread over `workers` threads that share cmax.
+
     .. versionadded:: 0.19.0
 
     References
@@ -453,7 +656,7 @@ def directed_hausdorff(u, v, seed=0):
     if u.shape[1] != v.shape[1]:
         raise ValueError('u and v need to have the same '
                          'number of columns')
-    result = _hausdorff.directed_hausdorff(u, v, seed)
+    result = _hausdorff.directed_hausdorff(u, v, seed, _workers(workers))
     return result
 
 
@@ -1644,6 +1847,8 @@ _convert_to_bool = partial(_convert_to_type, out_type=bool)
 # adding python-only wrappers to _distance_wrap module
 _distance_wrap.pdist_correlation_double_wrap = _correlation_pdist_wrap
 _distance_wrap.cdist_correlation_double_wrap = _correlation_cdist_wrap
+_distance_wrap.pdist_correlation_float_wrap = _correlation_pdist_float_wrap
+_distance_wrap.cdist_correlation_float_wrap = _correlation_cdist_float_wrap
 
 # Registry of implemented metrics:
 # Dictionary with the following structure:
@@ -1777,9 +1982,42 @@ def pdist(X, metric='euclidean', *args, **kwargs):
         out : ndarray.
         The output array
         If not None, condensed distance matrix Y is stored in this array.
+        It must have type double, or float32 for float32 observations, see
+        Notes.
         Note: metric independent, it will become a regular keyword arg in a
         future scipy version
 
+        workers : int
+        Number of threads used to compute the distances of the metrics
+        implemented in C, i.e. when `metric` is given as a string. If
+        negative, the value wraps around from ``os.cpu_count()``.
+        Default: 1
+
+        .. versionadded:: 1.4.0
+
+        exact : bool
+        If False, the 'sqeuclidean', 'euclidean', 'cosine' and
+        'correlation' distances of data with at least 32 columns are
+        computed through a matrix product, see Notes. If True, they are
+        always computed pair by pair.
+        Default: False
+
+        .. versionadded:: 1.4.0
+
+        nbits : int
+        If given, `X` holds bit-packed boolean observations with `nbits`
+        features each, see Notes. Only the unweighted boolean metrics
+        support this.
+
+        .. versionadded:: 1.4.0
+
+        acc_dtype : dtype
+        The type in which the distances of float32 observations are summed,
+        ``np.float64`` or ``np.float32``, see Notes.
+        Default: ``np.float64``
+
+        .. versionadded:: 1.4.0
+
     Returns
     -------
     Y : ndarray
@@ -1799,6 +2037,31 @@ def pdist(X, metric='euclidean', *args, **kwargs):
     this entry or to convert the condensed distance matrix to a
     redundant square matrix.
 
+    For data with at least 32 columns, the 'sqeuclidean', 'euclidean',
+    'cosine' and 'correlation' distances are computed from the matrix
+    product of the observations, ``|u|**2 + |v|**2 - 2 u.v`` and
+    ``1 - u.v / (|u| |v|)``, which is much faster. The squared Euclidean
+    distance then loses precision for points that are very close to each
+    other compared to their norms; pass ``exact=True`` to compute every
+    distance pair by pair instead.
+
+    Bit-packed boolean observations are rows of 64-bit words, ``uint64``,
+    where feature ``j`` is bit ``j % 64`` of word ``j // 64``, and the
+    bits past the last feature are zero. On little-endian machines
+    ``np.packbits(X, axis=1, bitorder='little')``, padded with zero bytes
+    to a multiple of 8 columns and viewed as ``np.uint64``, gives this
+    layout. The boolean metrics are computed from popcounts of whole
+    words, which is much faster than one byte per feature.
+
+    If `X` is float32, the 'sqeuclidean', 'euclidean', 'minkowski',
+    'cosine' and 'correlation' distances are computed from the float32
+    values without converting them to float64 first. They are summed in
+    float64 by default, which matches float64 input up to rounding, or in
+    float32 with ``acc_dtype=np.float32``, which is about twice as fast but
+    only accurate to about ``1e-6`` relative to the norms; the matrix
+    products above are then computed in float32 as well. Pass a float32
+    array as `out` to get float32 distances.
+
     The following are common calling conventions.
 
     1. ``Y = pdist(X, 'euclidean')``
@@ -2000,6 +2263,10 @@ def pdist(X, metric='euclidean', *args, **kwargs):
 
     m, n = s
     out = kwargs.pop("out", None)
+    workers = _workers(kwargs.pop("workers", None))
+    exact = kwargs.pop("exact", False)
+    nbits = kwargs.pop("nbits", None)
+    acc64 = _acc64(kwargs.pop("acc_dtype", None))
     if out is None:
         dm = np.empty((m * (m - 1)) // 2, dtype=np.double)
     else:
@@ -2007,7 +2274,7 @@ def pdist(X, metric='euclidean', *args, **kwargs):
             raise ValueError("output array has incorrect shape.")
         if not out.flags.c_contiguous:
             raise ValueError("Output array must be C-contiguous.")
-        if out.dtype != np.double:
+        if out.dtype not in (np.double, np.float32):
             raise ValueError("Output array must be double type.")
         dm = out
 
@@ -2036,6 +2303,10 @@ def pdist(X, metric='euclidean', *args, **kwargs):
     _filter_deprecated_kwargs(kwargs, kwargs_blacklist)
 
     if callable(metric):
+        if nbits is not None:
+            raise ValueError("nbits is only supported for metrics given as "
+                             "strings")
+        _check_double_output(dm)
         mstr = getattr(metric, '__name__', 'UnknownCustomMetric')
         metric_name = _METRIC_ALIAS.get(mstr, None)
 
@@ -2056,14 +2327,39 @@ def pdist(X, metric='euclidean', *args, **kwargs):
 
         metric_name = _METRIC_ALIAS.get(mstr, None)
 
+        if nbits is not None:
+            _check_double_output(dm)
+            X, nbits = _validate_packed_input(X, nbits, metric_name, kwargs)
+            pdist_fn = getattr(_distance_wrap,
+                               "pdist_%s_bits64_wrap" % metric_name)
+            pdist_fn(X, dm, nbits, workers=workers)
+            return dm
+
+        if _use_float32(metric_name, (X,), kwargs):
+            if _use_gemm(metric_name, n, exact, kwargs):
+                _gemm_pdist(metric_name,
+                            X.astype(np.double) if acc64 else X, dm)
+                return dm
+            if metric_name == 'minkowski':
+                kwargs = _validate_minkowski_kwargs(X, m, n, **kwargs)
+            pdist_fn = getattr(_distance_wrap,
+                               "pdist_%s_float_wrap" % metric_name)
+            pdist_fn(X, dm, acc64=acc64, workers=workers, **kwargs)
+            return dm
+
+        _check_double_output(dm)
         if metric_name is not None:
             X, typ, kwargs = _validate_pdist_input(X, m, n,
                                                    metric_name, **kwargs)
 
+            if _use_gemm(metric_name, n, exact, kwargs):
+                _gemm_pdist(metric_name, X, dm)
+                return dm
+
             # get pdist wrapper
             pdist_fn = getattr(_distance_wrap,
                                "pdist_%s_%s_wrap" % (metric_name, typ))
-            pdist_fn(X, dm, **kwargs)
+            pdist_fn(X, dm, workers=workers, **kwargs)
             return dm
 
         elif mstr in ['old_cosine', 'old_cos']:
@@ -2094,7 +2390,7 @@ def pdist(X, metric='euclidean', *args, **kwargs):
     return dm
 
 
-def squareform(X, force="no", checks=True):
+def squareform(X, force="no", checks=True, workers=None):
     """
     Convert a vector-form distance vector to a square-form distance
     matrix, and vice-versa.
@@ -2113,6 +2409,12 @@ def squareform(X, force="no", checks=True):
         ``X - X.T1`` is small and ``diag(X)`` is close to zero.
         These values are ignored any way so they do not disrupt the
         squareform transformation.
+    workers : int, optional
+        Number of threads used for the conversion. Negative values wrap
+        around from the number of CPUs, so ``-1`` uses all of them. The
+        default (None) converts on the calling thread.
+
+        .. versionadded:: 1.4.0
 
     Returns
     -------
@@ -2144,7 +2446,12 @@ def squareform(X, force="no", checks=True):
     In SciPy 0.19.0, ``squareform`` stopped casting all input types to
     float64, and started returning arrays of the same dtype as the input.
 
+    A `CondensedDistanceMatrix` is accepted wherever a condensed vector is.
+    To look up rows or nearest neighbours of a `pdist` result, wrap it in
+    one instead of expanding it, which needs twice the memory.
+
     """
+    workers = _workers(workers)
 
     X = np.ascontiguousarray(X)
 
@@ -2174,15 +2481,12 @@ def squareform(X, force="no", checks=True):
             raise ValueError('Incompatible vector size. It must be a binomial '
                              'coefficient n choose 2 for some integer n >= 2.')
 
-        # Allocate memory for the distance matrix.
+        # Allocate memory for the distance matrix. The C code leaves the
+        # diagonal alone, so it stays zero.
         M = np.zeros((d, d), dtype=X.dtype)
 
-        # Since the C code does not support striding using strides.
-        # The dimensions are used instead.
-        X = _copy_array_if_base_present(X)
-
         # Fill in the values of the distance matrix.
-        _distance_wrap.to_squareform_from_vector_wrap(M, X)
+        _distance_wrap.to_squareform_from_vector_wrap(M, X, workers)
 
         # Return the distance matrix.
         return M
@@ -2198,15 +2502,11 @@ def squareform(X, force="no", checks=True):
         if d <= 1:
             return np.array([], dtype=X.dtype)
 
-        # Create a vector.
-        v = np.zeros((d * (d - 1)) // 2, dtype=X.dtype)
-
-        # Since the C code does not support striding using strides.
-        # The dimensions are used instead.
-        X = _copy_array_if_base_present(X)
+        # Create a vector. Every entry is written by the C code.
+        v = np.empty((d * (d - 1)) // 2, dtype=X.dtype)
 
         # Convert the vector to squareform.
-        _distance_wrap.to_vector_from_squareform_wrap(X, v)
+        _distance_wrap.to_vector_from_squareform_wrap(X, v, workers)
         return v
     else:
         raise ValueError(('The first argument must be one or two dimensional '
@@ -2214,6 +2514,170 @@ def squareform(X, force="no", checks=True):
                           'permitted') % len(s))
 
 
+class CondensedDistanceMatrix(object):
+    """
+    Square-form view of a condensed distance matrix.
+
+    Wraps the output of `pdist` so that single entries, whole rows and
+    nearest neighbours can be looked up without building the ``n x n``
+    matrix that `squareform` would return.
+
+    .. versionadded:: 1.4.0
+
+    Parameters
+    ----------
+    y : array_like
+        A condensed distance matrix, as returned by `pdist`. It is not
+        copied if it is already a contiguous array.
+
+    Attributes
+    ----------
+    y : ndarray
+        The condensed distance matrix.
+    n : int
+        The number of observations, i.e. the size of the square form.
+
+    Notes
+    -----
+    ``np.asarray`` of the object gives back `y`, so it can be passed to
+    `squareform` and to `scipy.cluster.hierarchy.linkage` directly.
+    All lookups treat the diagonal as zero, except `argmin` and `min`
+    along an axis, which skip it.
+
+    Examples
+    --------
+    >>> from scipy.spatial.distance import pdist, CondensedDistanceMatrix
+    >>> D = CondensedDistanceMatrix(pdist([[0, 0], [0, 1], [3, 0]]))
+    >>> D[0, 2]
+    3.0
+    >>> D.rows(1)
+    array([1.        , 0.        , 3.16227766])
+    >>> D.argmin(axis=1)
+    array([1, 0, 0])
+
+    """
+
+    def __init__(self, y):
+        y = np.ascontiguousarray(y)
+        if y.ndim != 1:
+            raise ValueError('A condensed distance matrix must be one '
+                             'dimensional.')
+        self.y = y
+        self.n = 1 if y.shape[0] == 0 else num_obs_y(y)
+
+    def __array__(self, dtype=None):
+        if dtype is None:
+            return self.y
+        return self.y.astype(dtype, copy=False)
+
+    def _index(self, i, j):
+        """Positions of entries (i, j) in `y`, and a mask of i == j."""
+        n = self.n
+        i, j = np.broadcast_arrays(self._check_index(i), self._check_index(j))
+        lo = np.minimum(i, j)
+        hi = np.maximum(i, j)
+        diagonal = np.asarray(lo == hi)
+        k = np.where(diagonal, 0, n * lo - (lo * (lo + 1)) // 2 + hi - lo - 1)
+        return k, diagonal
+
+    def _check_index(self, i):
+        i = np.asarray(i, dtype=np.intp)
+        if np.any(i >= self.n) or np.any(i < -self.n):
+            raise IndexError('index out of bounds for {0} observations'
+                             .format(self.n))
+        return np.where(i < 0, i + self.n, i)
+
+    def _gather(self, i, j):
+        k, diagonal = self._index(i, j)
+        if self.y.shape[0] == 0:
+            return np.zeros(k.shape, dtype=self.y.dtype)
+        out = self.y[k.ravel()].reshape(k.shape)
+        out[diagonal] = 0
+        return out
+
+    def __getitem__(self, key):
+        if isinstance(key, tuple):
+            if len(key) != 2:
+                raise IndexError('too many indices for a distance matrix')
+            return self._gather(key[0], key[1])[()]
+        return self.rows(key)
+
+    def rows(self, i):
+        """
+        Rows of the square form.
+
+        Parameters
+        ----------
+        i : int or array_like of ints
+            Observation(s) whose rows are gathered.
+
+        Returns
+        -------
+        D : ndarray
+            ``squareform(y)[i]``, with shape ``(n,)`` for a single index
+            and ``(len(i), n)`` otherwise.
+        """
+        i = np.asarray(i)
+        return self._gather(i[..., np.newaxis], np.arange(self.n))
+
+    def argmin(self, axis=None):
+        """
+        Indices of the smallest distances.
+
+        Parameters
+        ----------
+        axis : {None, 0, 1}, optional
+            With None, the pair ``(i, j)``, ``i < j``, of the closest two
+            observations is returned. Otherwise, for each observation, the
+            index of its nearest neighbour; the matrix is symmetric, so both
+            axes give the same result. Ties go to the smaller index, NaN
+            distances win over all others as in `numpy.argmin`, and ``-1``
+            is returned if there is only one observation.
+
+        Returns
+        -------
+        index : tuple of int or ndarray of intp
+        """
+        if axis is None:
+            if self.n < 2:
+                raise ValueError('argmin of an empty distance matrix')
+            k = np.argmin(self.y)
+            starts = np.arange(self.n)
+            starts = self.n * starts - (starts * (starts + 1)) // 2
+            i = np.searchsorted(starts, k, side='right') - 1
+            return int(i), int(k - starts[i] + i + 1)
+        return self._reduce(axis)[1]
+
+    def min(self, axis=None):
+        """
+        Smallest distances, overall or for each observation.
+
+        Parameters
+        ----------
+        axis : {None, 0, 1}, optional
+            See `argmin`. Along an axis, the diagonal is skipped, and an
+            observation without neighbours gets ``inf``.
+
+        Returns
+        -------
+        m : scalar or ndarray of doubles
+        """
+        if axis is None:
+            if self.n < 2:
+                raise ValueError('min of an empty distance matrix')
+            return self.y.min()
+        return self._reduce(axis)[0]
+
+    def _reduce(self, axis):
+        if axis not in (0, 1, -1, -2):
+            raise ValueError('axis must be None, 0 or 1')
+        y = _convert_to_double(self.y)
+        mins = np.empty(self.n, dtype=np.double)
+        args = np.empty(self.n, dtype=np.intp)
+        _distance_wrap.condensed_argmin_wrap(y, mins, args)
+        return mins, args
+
+
 def is_valid_dm(D, tol=0.0, throw=False, name="D", warning=False):
     """
     Return True if input array is a valid distance matrix.
@@ -2458,9 +2922,42 @@ def cdist(XA, XB, metric='euclidean', *args, **kwargs):
         out : ndarray
         The output array
         If not None, the distance matrix Y is stored in this array.
+        It must have type double, or float32 for float32 observations, see
+        Notes.
         Note: metric independent, it will become a regular keyword arg in a
         future scipy version
 
+        workers : int
+        Number of threads used to compute the distances of the metrics
+        implemented in C, i.e. when `metric` is given as a string. If
+        negative, the value wraps around from ``os.cpu_count()``.
+        Default: 1
+
+        .. versionadded:: 1.4.0
+
+        exact : bool
+        If False, the 'sqeuclidean', 'euclidean', 'cosine' and
+        'correlation' distances of data with at least 32 columns are
+        computed through a matrix product, see Notes. If True, they are
+        always computed pair by pair.
+        Default: False
+
+        .. versionadded:: 1.4.0
+
+        nbits : int
+        If given, `XA` and `XB` hold bit-packed boolean observations with
+        `nbits` features each, see Notes. Only the unweighted boolean
+        metrics support this.
+
+        .. versionadded:: 1.4.0
+
+        acc_dtype : dtype
+        The type in which the distances of float32 observations are summed,
+        ``np.float64`` or ``np.float32``, see Notes.
+        Default: ``np.float64``
+
+        .. versionadded:: 1.4.0
+
     Returns
     -------
     Y : ndarray
@@ -2477,6 +2974,30 @@ def cdist(XA, XB, metric='euclidean', *args, **kwargs):
 
     Notes
     -----
+    For data with at least 32 columns, the 'sqeuclidean', 'euclidean',
+    'cosine' and 'correlation' distances are computed from the matrix
+    product ``XA @ XB.T``, which is much faster. The squared Euclidean
+    distance then loses precision for points that are very close to each
+    other compared to their norms; pass ``exact=True`` to compute every
+    distance pair by pair instead.
+
+    Bit-packed boolean observations are rows of 64-bit words, ``uint64``,
+    where feature ``j`` is bit ``j % 64`` of word ``j // 64``, and the
+    bits past the last feature are zero. On little-endian machines
+    ``np.packbits(X, axis=1, bitorder='little')``, padded with zero bytes
+    to a multiple of 8 columns and viewed as ``np.uint64``, gives this
+    layout. The boolean metrics are computed from popcounts of whole
+    words, which is much faster than one byte per feature.
+
+    If both `XA` and `XB` are float32, the 'sqeuclidean', 'euclidean', 'minkowski',
+    'cosine' and 'correlation' distances are computed from the float32
+    values without converting them to float64 first. They are summed in
+    float64 by default, which matches float64 input up to rounding, or in
+    float32 with ``acc_dtype=np.float32``, which is about twice as fast but
+    only accurate to about ``1e-6`` relative to the norms; the matrix
+    products above are then computed in float32 as well. Pass a float32
+    array as `out` to get float32 distances.
+
     The following are common calling conventions:
 
     1. ``Y = cdist(XA, XB, 'euclidean')``
@@ -2725,6 +3246,10 @@ def cdist(XA, XB, metric='euclidean', *args, **kwargs):
     mB = sB[0]
     n = s[1]
     out = kwargs.pop("out", None)
+    workers = _workers(kwargs.pop("workers", None))
+    exact = kwargs.pop("exact", False)
+    nbits = kwargs.pop("nbits", None)
+    acc64 = _acc64(kwargs.pop("acc_dtype", None))
     if out is None:
         dm = np.empty((mA, mB), dtype=np.double)
     else:
@@ -2732,7 +3257,7 @@ def cdist(XA, XB, metric='euclidean', *args, **kwargs):
             raise ValueError("Output array has incorrect shape.")
         if not out.flags.c_contiguous:
             raise ValueError("Output array must be C-contiguous.")
-        if out.dtype != np.double:
+        if out.dtype not in (np.double, np.float32):
             raise ValueError("Output array must be double type.")
         dm = out
 
@@ -2754,6 +3279,10 @@ def cdist(XA, XB, metric='euclidean', *args, **kwargs):
     _filter_deprecated_kwargs(kwargs, kwargs_blacklist)
 
     if callable(metric):
+        if nbits is not None:
+            raise ValueError("nbits is only supported for metrics given as "
+                             "strings")
+        _check_double_output(dm)
 
         mstr = getattr(metric, '__name__', 'Unknown')
         metric_name = _METRIC_ALIAS.get(mstr, None)
@@ -2771,13 +3300,40 @@ def cdist(XA, XB, metric='euclidean', *args, **kwargs):
         mstr, kwargs = _select_weighted_metric(mstr, kwargs, out)
 
         metric_name = _METRIC_ALIAS.get(mstr, None)
+        if nbits is not None:
+            _check_double_output(dm)
+            XA, nbits = _validate_packed_input(XA, nbits, metric_name, kwargs)
+            XB, nbits = _validate_packed_input(XB, nbits, metric_name, kwargs)
+            cdist_fn = getattr(_distance_wrap,
+                               "cdist_%s_bits64_wrap" % metric_name)
+            cdist_fn(XA, XB, dm, nbits, workers=workers)
+            return dm
+
+        if _use_float32(metric_name, (XA, XB), kwargs):
+            if _use_gemm(metric_name, n, exact, kwargs):
+                if acc64:
+                    XA, XB = XA.astype(np.double), XB.astype(np.double)
+                _gemm_cdist(metric_name, XA, XB, dm)
+                return dm
+            if metric_name == 'minkowski':
+                kwargs = _validate_minkowski_kwargs(XA, mA, n, **kwargs)
+            cdist_fn = getattr(_distance_wrap,
+                               "cdist_%s_float_wrap" % metric_name)
+            cdist_fn(XA, XB, dm, acc64=acc64, workers=workers, **kwargs)
+            return dm
+
+        _check_double_output(dm)
         if metric_name is not None:
             XA, XB, typ, kwargs = _validate_cdist_input(XA, XB, mA, mB, n,
                                                         metric_name, **kwargs)
+            if _use_gemm(metric_name, n, exact, kwargs):
+                _gemm_cdist(metric_name, XA, XB, dm)
+                return dm
+
             # get cdist wrapper
             cdist_fn = getattr(_distance_wrap,
                                "cdist_%s_%s_wrap" % (metric_name, typ))
-            cdist_fn(XA, XB, dm, **kwargs)
+            cdist_fn(XA, XB, dm, workers=workers, **kwargs)
             return dm
 
         elif mstr.startswith("test_"):
@@ -2791,3 +3347,219 @@ def cdist(XA, XB, metric='euclidean', *args, **kwargs):
         raise TypeError('2nd argument metric must be a string identifier '
                         'or a function.')
     return dm
+
+
+# Metrics of cdist_knn and cdist_radius, with their keyword arguments
+_SELECT_METRICS = {
+    'braycurtis': (), 'canberra': (), 'chebyshev': (), 'cityblock': (),
+    'correlation': (), 'cosine': (), 'euclidean': (), 'jensenshannon': (),
+    'mahalanobis': ('VI',), 'minkowski': ('p',), 'seuclidean': ('V',),
+    'sqeuclidean': (),
+}
+
+
+def _select_input(XA, XB, metric, kwargs, func_name):
+    """Validate the input of `cdist_knn` and `cdist_radius`.
+
+    Returns `XA`, `XB`, the metric name and the keyword arguments of the C
+    wrapper. The metric name is that of the C wrapper too, which computes
+    'correlation' as 'cosine' of the centered rows.
+    """
+    XA = np.asarray(XA, order='c')
+    XB = np.asarray(XB, order='c')
+    if XA.ndim != 2:
+        raise ValueError('XA must be a 2-dimensional array.')
+    if XB.ndim != 2:
+        raise ValueError('XB must be a 2-dimensional array.')
+    if XA.shape[1] != XB.shape[1]:
+        raise ValueError('XA and XB must have the same number of columns '
+                         '(i.e. feature dimension.)')
+    mA, n = XA.shape
+    mB = XB.shape[0]
+
+    acc64 = _acc64(kwargs.pop('acc_dtype', None))
+    wrap_kwargs = {'workers': _workers(kwargs.pop('workers', None)),
+                   'acc64': acc64}
+    if not isinstance(metric, string_types):
+        raise TypeError('metric must be a string identifier, '
+                        'got {!r}'.format(metric))
+    metric_name = _METRIC_ALIAS.get(metric.lower(), None)
+    if metric_name not in _SELECT_METRICS:
+        raise ValueError('{} does not support the metric '
+                         '{}'.format(func_name, metric))
+    unknown = set(kwargs) - set(_SELECT_METRICS[metric_name])
+    if unknown:
+        raise TypeError('got unexpected keyword arguments {} for metric '
+                        '{}'.format(", ".join(sorted(unknown)), metric_name))
+
+    if _use_float32(metric_name, (XA, XB), kwargs):
+        if metric_name == 'minkowski':
+            kwargs = _validate_minkowski_kwargs(XA, mA, n, **kwargs)
+    else:
+        XA, XB, _, kwargs = _validate_cdist_input(XA, XB, mA, mB, n,
+                                                  metric_name, **kwargs)
+
+    if metric_name == 'correlation':
+        # as in cdist, float32 rows summed in float64 are centered in
+        # float64 too
+        dtype = np.double if acc64 else None
+        XA = XA - XA.mean(axis=1, keepdims=True, dtype=dtype)
+        XB = XB - XB.mean(axis=1, keepdims=True, dtype=dtype)
+        metric_name = 'cosine'
+    if 'p' in kwargs:
+        wrap_kwargs['p'] = kwargs['p']
+    if 'V' in kwargs:
+        wrap_kwargs['w'] = kwargs['V']
+    if 'VI' in kwargs:
+        wrap_kwargs['w'] = kwargs['VI']
+    return XA, XB, metric_name, wrap_kwargs
+
+
+def cdist_knn(XA, XB, k, metric='euclidean', **kwargs):
+    """
+    Nearest neighbours in `XB` of each observation in `XA`.
+
+    Finds, for each row of `XA`, the `k` rows of `XB` at the smallest
+    distance from it. This gives the same result as sorting each row of
+    ``cdist(XA, XB, metric)``, but the distances are computed block by block
+    and only the `k` smallest of each row are kept, so the full
+    :math:`m_A` by :math:`m_B` distance matrix is never stored.
+
+    .. versionadded:: 1.4.0
+
+    Parameters
+    ----------
+    XA : ndarray
+        An :math:`m_A` by :math:`n` array of :math:`m_A` original
+        observations in an :math:`n`-dimensional space.
+    XB : ndarray
+        An :math:`m_B` by :math:`n` array of :math:`m_B` original
+        observations in an :math:`n`-dimensional space.
+    k : int
+        The number of neighbours, ``1 <= k <= m_B``.
+    metric : str, optional
+        The distance metric to use, one of 'braycurtis', 'canberra',
+        'chebyshev', 'cityblock', 'correlation', 'cosine', 'euclidean',
+        'jensenshannon', 'mahalanobis', 'minkowski', 'seuclidean' and
+        'sqeuclidean', or one of their aliases accepted by `cdist`.
+    **kwargs : dict, optional
+        The metric parameters ``p``, ``V`` and ``VI`` of `cdist`, and its
+        ``workers`` and ``acc_dtype`` arguments.
+
+    Returns
+    -------
+    dist : ndarray
+        An :math:`m_A` by :math:`k` array, where ``dist[i]`` holds the
+        distances from ``XA[i]`` to its neighbours in increasing order.
+    index : ndarray
+        An :math:`m_A` by :math:`k` array of integers, where ``index[i]``
+        holds the rows of `XB` that are the neighbours of ``XA[i]``.
+
+    See Also
+    --------
+    cdist_radius : all pairs within a given distance.
+    scipy.spatial.cKDTree.query : neighbours of low-dimensional data.
+
+    Notes
+    -----
+    Equal distances are ordered by their index in `XB`, and NaN distances
+    come after all others, as with a stable sort of ``cdist(XA, XB)``.
+
+    Examples
+    --------
+    >>> from scipy.spatial.distance import cdist_knn
+    >>> XA = [[0, 0], [0, 1]]
+    >>> XB = [[1, 0], [2, 0], [0, 0.5]]
+    >>> dist, index = cdist_knn(XA, XB, 2)
+    >>> dist
+    array([[0.5       , 1.        ],
+           [0.5       , 1.41421356]])
+    >>> index
+    array([[2, 0],
+           [2, 0]])
+
+    """
+    XA, XB, metric_name, wrap_kwargs = _select_input(XA, XB, metric, kwargs,
+                                                     "cdist_knn")
+    k = operator.index(k)
+    if not 1 <= k <= XB.shape[0]:
+        raise ValueError("k must be between 1 and the number of rows of XB "
+                         "({}), got {}".format(XB.shape[0], k))
+    dist = np.empty((XA.shape[0], k), dtype=np.double)
+    index = np.empty((XA.shape[0], k), dtype=np.intp)
+    _distance_wrap.cdist_knn_wrap(XA, XB, metric_name, dist, index,
+                                  **wrap_kwargs)
+    return dist, index
+
+
+def cdist_radius(XA, XB, r, metric='euclidean', output_type='csr_matrix',
+                 **kwargs):
+    """
+    Pairs of observations in `XA` and `XB` within a given distance.
+
+    Finds all pairs ``(i, j)`` with ``cdist(XA, XB, metric)[i, j] <= r``.
+    The distances are computed block by block and only those pairs are
+    kept, so the full :math:`m_A` by :math:`m_B` distance matrix is never
+    stored.
+
+    .. versionadded:: 1.4.0
+
+    Parameters
+    ----------
+    XA : ndarray
+        An :math:`m_A` by :math:`n` array of :math:`m_A` original
+        observations in an :math:`n`-dimensional space.
+    XB : ndarray
+        An :math:`m_B` by :math:`n` array of :math:`m_B` original
+        observations in an :math:`n`-dimensional space.
+    r : float
+        The largest distance kept.
+    metric : str, optional
+        The distance metric to use, see `cdist_knn`.
+    output_type : {'csr_matrix', 'coo_matrix'}, optional
+        The type of the returned sparse matrix. Default: 'csr_matrix'.
+    **kwargs : dict, optional
+        The metric parameters ``p``, ``V`` and ``VI`` of `cdist`, and its
+        ``workers`` and ``acc_dtype`` arguments.
+
+    Returns
+    -------
+    result : csr_matrix or coo_matrix
+        An :math:`m_A` by :math:`m_B` sparse matrix holding the distances
+        of the pairs found. Within each row, the column indices are sorted.
+
+    See Also
+    --------
+    cdist_knn : a given number of nearest neighbours.
+    scipy.spatial.cKDTree.sparse_distance_matrix : pairs within a distance
+        of low-dimensional data.
+
+    Notes
+    -----
+    Pairs at a distance of zero are stored as explicit zeros, which some
+    sparse matrix operations drop.
+
+    Examples
+    --------
+    >>> from scipy.spatial.distance import cdist_radius
+    >>> XA = [[0, 0], [0, 1]]
+    >>> XB = [[1, 0], [2, 0], [0, 0.5]]
+    >>> cdist_radius(XA, XB, 1.2).toarray()
+    array([[1. , 0. , 0.5],
+           [0. , 0. , 0.5]])
+
+    """
+    from scipy.sparse import csr_matrix
+
+    if output_type not in ('csr_matrix', 'coo_matrix'):
+        raise ValueError("output_type must be 'csr_matrix' or 'coo_matrix', "
+                         "got {!r}".format(output_type))
+    XA, XB, metric_name, wrap_kwargs = _select_input(XA, XB, metric, kwargs,
+                                                     "cdist_radius")
+    indptr, indices, data = _distance_wrap.cdist_radius_wrap(
+        XA, XB, metric_name, float(r), **wrap_kwargs)
+    result = csr_matrix((data, indices, indptr),
+                        shape=(XA.shape[0], XB.shape[0]))
+    if output_type == 'coo_matrix':
+        result = result.tocoo()
+    return result
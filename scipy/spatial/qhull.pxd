@@ -9,6 +9,8 @@ Qhull shared definitions, for use by other Cython modules
 # Distributed under the same BSD license as Scipy.
 #
 
+cimport numpy as np
+
 cdef extern from "numpy/ndarrayobject.h":
     cdef enum:
         NPY_MAXDIMS
@@ -70,3 +72,8 @@ cdef int _find_simplex_directed(DelaunayInfo_t *d, double *c, double *x,
 
 cdef int _find_simplex(DelaunayInfo_t *d, double *c, double *x, int *start,
                        double eps, double eps_broad) nogil
+
+cdef void _find_simplices(DelaunayInfo_t *d, double *x, np.npy_intp n,
+                          int *isimplices, double *c, double eps,
+                          double eps_broad, int bruteforce,
+                          int workers) nogil
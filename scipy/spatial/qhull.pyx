@@ -22,6 +22,7 @@ from libc cimport stdlib
 from scipy._lib.messagestream cimport MessageStream
 
 from numpy.compat import asbytes
+from scipy.spatial.distance import _workers
 import os
 import sys
 import tempfile
@@ -248,9 +249,11 @@ cdef class _Qhull:
     cdef int numpoints, _is_delaunay, _is_halfspaces
     cdef np.ndarray _ridge_points
 
-    cdef list _ridge_vertices
+    cdef np.ndarray _ridge_indptr
+    cdef np.ndarray _ridge_indices
     cdef object _ridge_error
     cdef int _nridges
+    cdef int _nridge_indices
 
     cdef np.ndarray _ridge_equations
 
@@ -263,8 +266,6 @@ cdef class _Qhull:
                  furthest_site=False,
                  incremental=False,
                  np.ndarray[np.double_t, ndim=1] interior_point=None):
-        cdef int exitcode
-
         self._qh = NULL
         self._messages = MessageStream()
 
@@ -327,20 +328,31 @@ cdef class _Qhull:
         self.mode_option = mode_option
         self.furthest_site = furthest_site
 
-        options = b"qhull "  + mode_option +  b" " + self.options
-
-        options_c = <char*>options
-
         self._messages.clear()
 
-        cdef coordT* coord
-        cdef int i
         with nogil:
             self._qh = <qhT*>stdlib.malloc(sizeof(qhT))
             if self._qh == NULL:
                 with gil:
                     raise MemoryError("memory allocation failed")
             qh_zero(self._qh, self._messages.handle)
+
+        self._new_qhull(points, interior_point)
+
+    cdef int _new_qhull(self, np.ndarray points,
+                        np.ndarray interior_point) except -1:
+        """
+        Run Qhull on `points` with the options of this instance
+        """
+        cdef int exitcode
+        cdef coordT* coord
+        cdef char *options_c
+
+        options = b"qhull "  + self.mode_option +  b" " + self.options
+
+        options_c = <char*>options
+
+        with nogil:
             if interior_point is not None:
                 coord = <coordT*>interior_point.data
             else:
@@ -353,6 +365,43 @@ cdef class _Qhull:
             msg = self._messages.get()
             self.close()
             raise QhullError(msg)
+        return 0
+
+    @cython.final
+    def rebuild(self, points, interior_point=None):
+        """
+        Replace all points and run Qhull again from scratch.
+
+        The qhT struct and the memory pools of Qhull are reused, rather
+        than set up again: all facets, vertices and ridges of the previous
+        hull are returned to the free lists of ``qh_memalloc``, which the
+        new hull then draws from. If Qhull fails, the instance is closed.
+        """
+        cdef np.ndarray arr
+
+        self.check_active()
+
+        # Qhull keeps pointers into the points, so we own the copy
+        arr = np.array(points, dtype=np.double, order="C", copy=True)
+        if arr.ndim != 2 or arr.shape[1] != self._point_arrays[0].shape[1]:
+            raise ValueError("invalid size for new points array")
+        if arr.shape[0] <= 0:
+            raise ValueError("No points given")
+        if np.isnan(arr).any():
+            raise ValueError("Points cannot contain NaN")
+        if interior_point is not None:
+            interior_point = np.ascontiguousarray(interior_point,
+                                                  dtype=np.double)
+
+        # qh_ALL frees the short memory into the free lists, and the pools
+        # stay allocated until qh_memfreeshort in close()
+        qh_freeqhull(self._qh, qh_ALL)
+
+        self._point_arrays = [arr]
+        self._dual_point_arrays = []
+        self.numpoints = arr.shape[0]
+        self._messages.clear()
+        self._new_qhull(arr, interior_point)
 
     def check_active(self):
         if self._qh == NULL:
@@ -781,10 +830,16 @@ cdef class _Qhull:
     @cython.final
     @cython.boundscheck(False)
     @cython.cdivision(True)
-    def get_voronoi_diagram(_Qhull self):
+    def get_voronoi_diagram(_Qhull self, compact=False):
         """
         Return the voronoi diagram currently in Qhull.
 
+        Parameters
+        ----------
+        compact : bool, optional
+            Whether to return `ridge_vertices` and `regions` as CSR
+            tuples of arrays instead of lists of lists.
+
         Returns
         -------
         voronoi_vertices : array of double, shape (nvoronoi_vertices, ndim)
@@ -797,15 +852,19 @@ cdef class _Qhull:
             Voronoi vertices for each Voronoi ridge, as indices to
             the Voronoi vertices array.
             Infinity is indicated by index ``-1``.
+            If `compact`, a tuple ``(indptr, indices)`` of int arrays: the
+            vertices of ridge `k` are ``indices[indptr[k]:indptr[k+1]]``.
 
         regions : list of lists, shape (nregion, *)
             Voronoi vertices of all regions.
+            If `compact`, a tuple ``(indptr, indices)`` as for
+            `ridge_vertices`.
 
         point_region : array of int, shape (npoint,)
             Index of the Voronoi region for each input point.
 
         """
-        cdef int i, j, k
+        cdef int i, j, k, n
         cdef vertexT *vertex
         cdef facetT *neighbor
         cdef facetT *facet
@@ -820,21 +879,27 @@ cdef class _Qhull:
         cdef double dist
         cdef int inf_seen
 
-        cdef list regions
-        cdef list cur_region
+        cdef np.ndarray[np.npy_int, ndim=1] region_indptr, region_indices
+        cdef int nregions, nregion_indices, start
 
         self.check_active()
 
         # -- Grab Voronoi ridges
         self._nridges = 0
+        self._nridge_indices = 0
         self._ridge_error = None
         self._ridge_points = np.empty((10, 2), np.intc)
-        self._ridge_vertices = []
+        self._ridge_indptr = np.zeros(11, np.intc)
+        self._ridge_indices = np.empty(10 * self.ndim, np.intc)
 
         qh_eachvoronoi_all(self._qh, <void*>self, &_visit_voronoi, self._qh[0].UPPERdelaunay,
                            qh_RIDGEall, 1)
 
         self._ridge_points = self._ridge_points[:self._nridges]
+        ridge_vertices = (self._ridge_indptr[:self._nridges+1],
+                          self._ridge_indices[:self._nridge_indices])
+        self._ridge_indptr = None
+        self._ridge_indices = None
 
         if self._ridge_error is not None:
             raise self._ridge_error
@@ -842,24 +907,36 @@ cdef class _Qhull:
         # Now, qh_eachvoronoi_all has initialized the visitids of facets
         # to correspond do the Voronoi vertex indices.
 
-        # -- Grab Voronoi regions
-        regions = []
+        # -- Grab Voronoi regions, in CSR form: the vertex neighbors give
+        # the sizes of the arrays up front
+        nregions = 0
+        nregion_indices = 0
+        vertex = self._qh[0].vertex_list
+        while vertex and vertex.next:
+            qh_order_vertexneighbors_nd(self._qh, self.ndim+1, vertex)
+            nregions += 1
+            nregion_indices += qh_setsize(self._qh, vertex.neighbors)
+            vertex = vertex.next
+
+        region_indptr = np.empty(nregions + 1, np.intc)
+        region_indices = np.empty(nregion_indices, np.intc)
 
         point_region = np.empty(self.numpoints, np.intp)
         for i in range(self.numpoints):
             point_region[i] = -1
 
+        n = 0
+        nregion_indices = 0
+        region_indptr[0] = 0
         vertex = self._qh[0].vertex_list
         while vertex and vertex.next:
-            qh_order_vertexneighbors_nd(self._qh, self.ndim+1, vertex)
-
             i = qh_pointid(self._qh, vertex.point)
             if i < self.numpoints:
                 # Qz results to one extra point
-                point_region[i] = len(regions)
+                point_region[i] = n
 
             inf_seen = 0
-            cur_region = []
+            start = nregion_indices
             for k in xrange(qh_setsize(self._qh, vertex.neighbors)):
                 neighbor = <facetT*>vertex.neighbors.e[k].p
                 i = neighbor.visitid - 1
@@ -868,14 +945,19 @@ cdef class _Qhull:
                         inf_seen = 1
                     else:
                         continue
-                cur_region.append(int(i))
-            if len(cur_region) == 1 and cur_region[0] == -1:
+                region_indices[nregion_indices] = i
+                nregion_indices += 1
+            if (nregion_indices == start + 1
+                    and region_indices[start] == -1):
                 # report similarly as qvoronoi o
-                cur_region = []
-            regions.append(cur_region)
+                nregion_indices = start
+            n += 1
+            region_indptr[n] = nregion_indices
 
             vertex = vertex.next
 
+        regions = (region_indptr, region_indices[:nregion_indices])
+
         # -- Grab Voronoi vertices and point-to-region map
         nvoronoi_vertices = 0
         voronoi_vertices = np.empty((10, self.ndim), np.double)
@@ -916,7 +998,11 @@ cdef class _Qhull:
 
         voronoi_vertices = voronoi_vertices[:nvoronoi_vertices]
 
-        return voronoi_vertices, self._ridge_points, self._ridge_vertices, \
+        if not compact:
+            ridge_vertices = _csr_to_lists(*ridge_vertices)
+            regions = _csr_to_lists(*regions)
+
+        return voronoi_vertices, self._ridge_points, ridge_vertices, \
                regions, point_region
 
     @cython.final
@@ -993,22 +1079,38 @@ cdef class _Qhull:
         return extremes_arr
 
 
+def _csr_to_lists(indptr, indices):
+    """
+    The lists ``indices[indptr[k]:indptr[k+1]]`` of a CSR tuple, as lists
+    of Python ints.
+    """
+    cdef Py_ssize_t k
+    cdef list items = indices.tolist()
+    cdef list bounds = indptr.tolist()
+    return [items[bounds[k]:bounds[k+1]] for k in range(len(bounds) - 1)]
+
+
 cdef void _visit_voronoi(qhT *_qh, void *ptr, vertexT *vertex, vertexT *vertexA,
                          setT *centers, boolT unbounded):
     cdef _Qhull qh = <_Qhull>ptr
-    cdef int point_1, point_2, ix
-    cdef list cur_vertices
+    cdef int point_1, point_2, ix, nvertices
 
     if qh._ridge_error is not None:
         return
 
-    if qh._nridges >= qh._ridge_points.shape[0]:
-        try:
-            # The array is guaranteed to be safe to resize
+    nvertices = qh_setsize(_qh, centers)
+
+    try:
+        # The arrays are guaranteed to be safe to resize
+        if qh._nridges >= qh._ridge_points.shape[0]:
             qh._ridge_points.resize(2*qh._nridges + 1, 2, refcheck=False)
-        except Exception, e:
-            qh._ridge_error = e
-            return
+            qh._ridge_indptr.resize(2*qh._nridges + 2, refcheck=False)
+        if qh._nridge_indices + nvertices > qh._ridge_indices.shape[0]:
+            qh._ridge_indices.resize(2*qh._nridge_indices + nvertices,
+                                     refcheck=False)
+    except Exception, e:
+        qh._ridge_error = e
+        return
 
     # Record which points the ridge is between
     point_1 = qh_pointid(_qh, vertex.point)
@@ -1019,13 +1121,15 @@ cdef void _visit_voronoi(qhT *_qh, void *ptr, vertexT *vertex, vertexT *vertexA,
     p[2*qh._nridges + 1] = point_2
 
     # Record which voronoi vertices constitute the ridge
-    cur_vertices = []
-    for i in xrange(qh_setsize(_qh, centers)):
+    p = <int*>qh._ridge_indices.data
+    for i in xrange(nvertices):
         ix = (<facetT*>centers.e[i].p).visitid - 1
-        cur_vertices.append(ix)
-    qh._ridge_vertices.append(cur_vertices)
+        p[qh._nridge_indices] = ix
+        qh._nridge_indices += 1
 
     qh._nridges += 1
+    p = <int*>qh._ridge_indptr.data
+    p[qh._nridges] = qh._nridge_indices
 
     return
 
@@ -1537,6 +1641,169 @@ cdef int _find_simplex(DelaunayInfo_t *d, double *c,
     return _find_simplex_directed(d, c, x, start, eps, eps_broad)
 
 
+#------------------------------------------------------------------------------
+# Finding simplices in bulk
+#------------------------------------------------------------------------------
+
+cdef extern from "src/distance_threads.h":
+    ctypedef struct dist_mutex:
+        pass
+    void dist_mutex_init(dist_mutex *m) nogil
+    void dist_mutex_destroy(dist_mutex *m) nogil
+    void dist_mutex_lock(dist_mutex *m) nogil
+    void dist_mutex_unlock(dist_mutex *m) nogil
+    void dist_run_threads(int nthreads, void (*func)(void *) nogil,
+                          void **args) nogil
+
+# Points claimed at a time by one thread. Within a chunk, the points are
+# visited in Morton order, so that each walk starts from the simplex found
+# for a nearby point.
+DEF FIND_SIMPLEX_CHUNK = 4096
+
+ctypedef struct _MortonKey:
+    np.npy_uint64 code
+    np.npy_intp index
+
+ctypedef struct _FindSimplicesJob:
+    DelaunayInfo_t *d
+    double *x
+    np.npy_intp n
+    int *isimplices
+    double *c
+    double eps
+    double eps_broad
+    int bruteforce
+    np.npy_intp next_chunk
+    dist_mutex lock
+
+cdef int _morton_compare(const void *a, const void *b) nogil:
+    cdef _MortonKey *ka = <_MortonKey*>a
+    cdef _MortonKey *kb = <_MortonKey*>b
+    if ka.code != kb.code:
+        return -1 if ka.code < kb.code else 1
+    return (ka.index > kb.index) - (ka.index < kb.index)
+
+@cython.cdivision(True)
+cdef np.npy_uint64 _morton_code(DelaunayInfo_t *d, double *x) nogil:
+    """
+    Interleaved bits of the coordinates of `x` in the bounding box of the
+    triangulation. Points outside the box are clamped onto it.
+
+    """
+    cdef int i, k, bits
+    cdef np.npy_uint64 code = 0
+    cdef np.npy_uint64 q[NPY_MAXDIMS]
+    cdef double t, span
+
+    bits = min(32, 64 // d.ndim)
+    for k in xrange(d.ndim):
+        span = d.max_bound[k] - d.min_bound[k]
+        t = (x[k] - d.min_bound[k]) / span if span > 0 else 0
+        if not t >= 0:
+            # also NaN
+            t = 0
+        elif t > 1:
+            t = 1
+        q[k] = <np.npy_uint64>(t * <double>(((<np.npy_uint64>1) << bits) - 1))
+    for i in xrange(bits - 1, -1, -1):
+        for k in xrange(d.ndim):
+            code = (code << 1) | ((q[k] >> i) & 1)
+    return code
+
+cdef void _find_simplices_chunk(_FindSimplicesJob *job, np.npy_intp k0,
+                                np.npy_intp k1, _MortonKey *keys) nogil:
+    cdef DelaunayInfo_t *d = job.d
+    cdef double c[NPY_MAXDIMS+1]
+    cdef double *x
+    cdef np.npy_intp m, k
+    cdef int j, isimplex
+    cdef int start = 0
+
+    if job.bruteforce:
+        keys = NULL
+    if keys != NULL:
+        for m in xrange(k1 - k0):
+            keys[m].code = _morton_code(d, job.x + d.ndim*(k0 + m))
+            keys[m].index = k0 + m
+        qsort(keys, k1 - k0, sizeof(_MortonKey), _morton_compare)
+
+    for m in xrange(k1 - k0):
+        k = keys[m].index if keys != NULL else k0 + m
+        x = job.x + d.ndim*k
+        if job.bruteforce:
+            isimplex = _find_simplex_bruteforce(d, c, x, job.eps,
+                                                job.eps_broad)
+        else:
+            isimplex = _find_simplex(d, c, x, &start, job.eps, job.eps_broad)
+        job.isimplices[k] = isimplex
+        if job.c != NULL:
+            for j in xrange(d.ndim + 1):
+                job.c[(d.ndim + 1)*k + j] = c[j] if isimplex != -1 else nan
+
+cdef void _find_simplices_worker(void *arg) nogil:
+    cdef _FindSimplicesJob *job = <_FindSimplicesJob*>arg
+    cdef _MortonKey *keys
+    cdef np.npy_intp k0
+
+    # without memory for the keys, the points go in their input order
+    keys = <_MortonKey*>stdlib.malloc(FIND_SIMPLEX_CHUNK * sizeof(_MortonKey))
+    while True:
+        dist_mutex_lock(&job.lock)
+        k0 = job.next_chunk
+        job.next_chunk += FIND_SIMPLEX_CHUNK
+        dist_mutex_unlock(&job.lock)
+        if k0 >= job.n:
+            break
+        _find_simplices_chunk(job, k0, min(job.n, k0 + FIND_SIMPLEX_CHUNK),
+                              keys)
+    stdlib.free(keys)
+
+cdef void _find_simplices(DelaunayInfo_t *d, double *x, np.npy_intp n,
+                          int *isimplices, double *c, double eps,
+                          double eps_broad, int bruteforce,
+                          int workers) nogil:
+    """
+    Find the simplices containing the `n` points `x`, on up to `workers`
+    threads.
+
+    `isimplices` receives the simplex of each point, or -1 if it is
+    outside the triangulation, and `c`, unless it is NULL, the ``ndim+1``
+    barycentric coordinates of each point, or NaN if it is outside.
+    The chunks of points and hence the results do not depend on `workers`.
+
+    """
+    cdef _FindSimplicesJob job
+    cdef np.npy_intp nchunks
+    cdef void **args = NULL
+    cdef int k
+
+    job.d = d
+    job.x = x
+    job.n = n
+    job.isimplices = isimplices
+    job.c = c
+    job.eps = eps
+    job.eps_broad = eps_broad
+    job.bruteforce = bruteforce
+    job.next_chunk = 0
+    dist_mutex_init(&job.lock)
+
+    nchunks = (n + FIND_SIMPLEX_CHUNK - 1) // FIND_SIMPLEX_CHUNK
+    if workers > nchunks:
+        workers = <int>nchunks
+    if workers > 1:
+        args = <void**>stdlib.malloc(workers * sizeof(void*))
+    if args == NULL:
+        # serial, also if memory ran out
+        _find_simplices_worker(&job)
+    else:
+        for k in xrange(workers):
+            args[k] = &job
+        dist_run_threads(workers, _find_simplices_worker, args)
+        stdlib.free(args)
+    dist_mutex_destroy(&job.lock)
+
+
 #------------------------------------------------------------------------------
 # Delaunay triangulation interface, for Python
 #------------------------------------------------------------------------------
@@ -1620,21 +1887,60 @@ class _QhullUser(object):
 
         if restart:
             points = np.concatenate([self._points, points], axis=0)
-            qhull = _Qhull(self._qhull.mode_option, points,
-                           options=self._qhull.options,
-                           furthest_site=self._qhull.furthest_site,
-                           incremental=True, interior_point=interior_point)
-            try:
-                self._update(qhull)
-                self._qhull = qhull
-            finally:
-                if qhull is not self._qhull:
-                    qhull.close()
+            self._set_points(points, interior_point)
             return
 
         self._qhull.add_points(points, interior_point)
         self._update(self._qhull)
 
+    def _set_points(self, points, interior_point=None):
+        """
+        set_points(points)
+
+        Replace all points and recompute from scratch, reusing the Qhull
+        context of this object.
+
+        This is meant for repeated computations on point sets of the same
+        dimension, such as a point cloud that moves a little at every step
+        of a simulation: Qhull is not set up again, and keeps the memory
+        it allocated for the previous result.
+
+        .. versionadded:: 1.4.0
+
+        Parameters
+        ----------
+        points : ndarray
+            The new points. The dimensionality should match that of the
+            initial points, but their number may change.
+
+        Raises
+        ------
+        QhullError
+            Raised when Qhull encounters an error condition, such as
+            geometrical degeneracy when options to resolve are not enabled.
+            The object is then closed, but keeps its previous result.
+
+        See Also
+        --------
+        add_points, close
+
+        Notes
+        -----
+        You need to specify ``incremental=True`` when constructing the
+        object to be able to replace its points.
+
+        """
+        if self._qhull is None:
+            raise RuntimeError("incremental mode not enabled or already closed")
+
+        qhull = self._qhull
+        try:
+            qhull.rebuild(points, interior_point)
+            self._update(qhull)
+        except QhullError:
+            self._qhull = None
+            raise
+
 class Delaunay(_QhullUser):
     """
     Delaunay(points, furthest_site=False, incremental=False, qhull_options=None)
@@ -1867,6 +2173,9 @@ class Delaunay(_QhullUser):
     def add_points(self, points, restart=False):
         self._add_points(points, restart)
 
+    def set_points(self, points):
+        self._set_points(points)
+
     @property
     def points(self):
         return self._points
@@ -2031,9 +2340,11 @@ class Delaunay(_QhullUser):
         return out
 
     @cython.boundscheck(False)
-    def find_simplex(self, xi, bruteforce=False, tol=None):
+    def find_simplex(self, xi, bruteforce=False, tol=None, workers=None,
+                     return_barycentric=False):
         """
-        find_simplex(self, xi, bruteforce=False, tol=None)
+        find_simplex(self, xi, bruteforce=False, tol=None, workers=None,
+                     return_barycentric=False)
 
         Find the simplices containing the given points.
 
@@ -2048,12 +2359,27 @@ class Delaunay(_QhullUser):
         tol : float, optional
             Tolerance allowed in the inside-triangle check.
             Default is ``100*eps``.
+        workers : int, optional
+            Number of threads to use. Negative values wrap around from the
+            number of CPUs, so ``-1`` uses all of them. The default (None)
+            searches on the calling thread.
+
+            .. versionadded:: 1.4.0
+        return_barycentric : bool, optional
+            Whether to also return the barycentric coordinates of the
+            points in their simplices.
+
+            .. versionadded:: 1.4.0
 
         Returns
         -------
         i : ndarray of int, same shape as `xi`
             Indices of simplices containing each point.
             Points outside the triangulation get the value -1.
+        c : ndarray of double, shape ``xi.shape[:-1] + (ndim+1,)``
+            Barycentric coordinates of each point in simplex ``i``, NaN for
+            points outside the triangulation. Only returned if
+            `return_barycentric` is True.
 
         Notes
         -----
@@ -2063,16 +2389,22 @@ class Delaunay(_QhullUser):
         the point in N+1 dimensions, the algorithm falls back to
         directed search in N dimensions.
 
+        The points are searched in chunks. Within a chunk, they are sorted
+        along a Morton (Z-order) curve, and the search for each point
+        starts from the simplex found for the previous one, which is
+        usually close by.
+
         """
         cdef DelaunayInfo_t info
-        cdef int isimplex
-        cdef double c[NPY_MAXDIMS]
         cdef double eps, eps_broad
-        cdef int start
-        cdef int k
+        cdef int nworkers
         cdef np.ndarray[np.double_t, ndim=2] x
         cdef np.ndarray[np.npy_int, ndim=1] out_
+        cdef np.ndarray[np.double_t, ndim=2] c_
+        cdef double *c_ptr = NULL
+        cdef int brute = bool(bruteforce)
 
+        nworkers = _workers(workers)
         xi = np.asanyarray(xi)
 
         if xi.shape[-1] != self.ndim:
@@ -2082,8 +2414,6 @@ class Delaunay(_QhullUser):
         xi = xi.reshape(-1, xi.shape[-1])
         x = np.ascontiguousarray(xi.astype(np.double))
 
-        start = 0
-
         if tol is None:
             eps = 100 * np.finfo(np.double).eps
         else:
@@ -2091,24 +2421,20 @@ class Delaunay(_QhullUser):
         eps_broad = sqrt(eps)
         out = np.zeros((xi.shape[0],), dtype=np.intc)
         out_ = out
+        if return_barycentric:
+            c = np.empty((xi.shape[0], self.ndim + 1), dtype=np.double)
+            c_ = c
+            c_ptr = <double*>c_.data
         _get_delaunay_info(&info, self, 1, 0, 0)
 
-        if bruteforce:
-            with nogil:
-                for k in xrange(x.shape[0]):
-                    isimplex = _find_simplex_bruteforce(
-                        &info, c,
-                        <double*>x.data + info.ndim*k,
-                        eps, eps_broad)
-                    out_[k] = isimplex
-        else:
-            with nogil:
-                for k in xrange(x.shape[0]):
-                    isimplex = _find_simplex(&info, c,
-                                             <double*>x.data + info.ndim*k,
-                                             &start, eps, eps_broad)
-                    out_[k] = isimplex
+        with nogil:
+            _find_simplices(&info, <double*>x.data, x.shape[0],
+                            <int*>out_.data, c_ptr, eps, eps_broad, brute,
+                            nworkers)
 
+        if return_barycentric:
+            return (out.reshape(xi_shape[:-1]),
+                    c.reshape(xi_shape[:-1] + (self.ndim + 1,)))
         return out.reshape(xi_shape[:-1])
 
     @cython.boundscheck(False)
@@ -2208,6 +2534,7 @@ def _copy_docstr(dst, src):
 
 
 _copy_docstr(Delaunay.add_points, _QhullUser._add_points)
+_copy_docstr(Delaunay.set_points, _QhullUser._set_points)
 
 #------------------------------------------------------------------------------
 # Delaunay triangulation interface, for low-level C
@@ -2468,6 +2795,9 @@ class ConvexHull(_QhullUser):
     def add_points(self, points, restart=False):
         self._add_points(points, restart)
 
+    def set_points(self, points):
+        self._set_points(points)
+
     @property
     def points(self):
         return self._points
@@ -2479,6 +2809,7 @@ class ConvexHull(_QhullUser):
         return self._vertices
 
 _copy_docstr(ConvexHull.add_points, _QhullUser._add_points)
+_copy_docstr(ConvexHull.set_points, _QhullUser._set_points)
 
 #------------------------------------------------------------------------------
 # Voronoi diagrams
@@ -2516,9 +2847,19 @@ class Voronoi(_QhullUser):
         Indices of the points between which each Voronoi ridge lies.
     ridge_vertices : list of list of ints, shape ``(nridges, *)``
         Indices of the Voronoi vertices forming each Voronoi ridge.
+    ridge_indptr, ridge_indices : ndarray of ints
+        `ridge_vertices` in CSR form: the vertices of ridge `k` are
+        ``ridge_indices[ridge_indptr[k]:ridge_indptr[k+1]]``.
+
+        .. versionadded:: 1.4.0
     regions : list of list of ints, shape ``(nregions, *)``
         Indices of the Voronoi vertices forming each Voronoi region.
         -1 indicates vertex outside the Voronoi diagram.
+    region_indptr, region_indices : ndarray of ints
+        `regions` in CSR form: the vertices of region `k` are
+        ``region_indices[region_indptr[k]:region_indptr[k+1]]``.
+
+        .. versionadded:: 1.4.0
     point_region : list of ints, shape (npoints)
         Index of the Voronoi region for each input point.
         If qhull option "Qc" was not specified, the list will contain -1
@@ -2541,6 +2882,11 @@ class Voronoi(_QhullUser):
     The Voronoi diagram is computed using the
     `Qhull library <http://www.qhull.org/>`__.
 
+    The ridges and regions are read from Qhull into the flat CSR arrays.
+    The lists `ridge_vertices` and `regions` are only built from them when
+    first accessed, which for large diagrams takes much more time and
+    memory than the arrays themselves.
+
     Examples
     --------
     Voronoi diagram for a set of point:
@@ -2614,10 +2960,13 @@ class Voronoi(_QhullUser):
         self.furthest_site = furthest_site
 
     def _update(self, qhull):
-        self.vertices, self.ridge_points, self.ridge_vertices, \
-                       self.regions, self.point_region = \
-                       qhull.get_voronoi_diagram()
+        self.vertices, self.ridge_points, \
+            (self.ridge_indptr, self.ridge_indices), \
+            (self.region_indptr, self.region_indices), \
+            self.point_region = qhull.get_voronoi_diagram(compact=True)
 
+        self._ridge_vertices = None
+        self._regions = None
         self._ridge_dict = None
 
         _QhullUser._update(self, qhull)
@@ -2625,10 +2974,27 @@ class Voronoi(_QhullUser):
     def add_points(self, points, restart=False):
         self._add_points(points, restart)
 
+    def set_points(self, points):
+        self._set_points(points)
+
     @property
     def points(self):
         return self._points
 
+    @property
+    def ridge_vertices(self):
+        if self._ridge_vertices is None:
+            self._ridge_vertices = _csr_to_lists(self.ridge_indptr,
+                                                 self.ridge_indices)
+        return self._ridge_vertices
+
+    @property
+    def regions(self):
+        if self._regions is None:
+            self._regions = _csr_to_lists(self.region_indptr,
+                                          self.region_indices)
+        return self._regions
+
     @property
     def ridge_dict(self):
         if self._ridge_dict is None:
@@ -2638,6 +3004,7 @@ class Voronoi(_QhullUser):
 
 
 _copy_docstr(Voronoi.add_points, _QhullUser._add_points)
+_copy_docstr(Voronoi.set_points, _QhullUser._set_points)
 
 #------------------------------------------------------------------------------
 # Halfspace Intersection
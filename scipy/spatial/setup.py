@@ -9,6 +9,8 @@ def configuration(parent_package='', top_path=None):
     from numpy.distutils.misc_util import get_info as get_misc_info
     from scipy._build_utils.system_info import get_info as get_sys_info
     from distutils.sysconfig import get_python_inc
+    from scipy._build_utils.compiler_helper import (
+        set_c_threads_flags_hook, set_cxx_threads_flags_hook)
 
     config = Configuration('spatial', parent_package, top_path)
 
@@ -29,9 +31,11 @@ def configuration(parent_package='', top_path=None):
 
     cfg = dict(get_sys_info('lapack_opt'))
     cfg.setdefault('include_dirs', []).extend(inc_dirs)
-    config.add_extension('qhull',
-                         sources=['qhull.c', 'qhull_misc.c'] + qhull_src,
-                         **cfg)
+    ext = config.add_extension('qhull',
+                               sources=['qhull.c', 'qhull_misc.c'] + qhull_src,
+                               depends=[join('src', 'distance_threads.h')],
+                               **cfg)
+    ext._pre_build_hook = set_c_threads_flags_hook
 
     # cKDTree
     ckdtree_src = ['query.cxx',
@@ -40,17 +44,23 @@ def configuration(parent_package='', top_path=None):
                    'count_neighbors.cxx',
                    'query_ball_point.cxx',
                    'query_ball_tree.cxx',
-                   'sparse_distances.cxx']
+                   'sparse_distances.cxx',
+                   'thread_pool.cxx']
 
     ckdtree_src = [join('ckdtree', 'src', x) for x in ckdtree_src]
 
-    ckdtree_headers = ['ckdtree_decl.h',
+    ckdtree_headers = ['batch_sink.h',
+                       'ckdtree_decl.h',
                        'coo_entries.h',
                        'distance_base.h',
                        'distance.h',
+                       'leaf_scan.h',
                        'ordered_pair.h',
+                       'parallel_traverse.h',
                        'partial_sort.h',
-                       'rectangle.h']
+                       'rectangle.h',
+                       'thread_pool.h',
+                       'traversal_stats.h']
 
     ckdtree_headers = [join('ckdtree', 'src', x) for x in ckdtree_headers]
 
@@ -60,17 +70,27 @@ def configuration(parent_package='', top_path=None):
                          depends=ckdtree_dep,
                          include_dirs=inc_dirs + [join('ckdtree', 'src')])
     # _distance_wrap
-    config.add_extension('_distance_wrap',
-                         sources=[join('src', 'distance_wrap.c')],
-                         depends=[join('src', 'distance_impl.h')],
-                         include_dirs=[get_numpy_include_dirs()],
-                         extra_info=get_misc_info("npymath"))
-
-    config.add_extension('_voronoi',
-                         sources=['_voronoi.c'])
-
-    config.add_extension('_hausdorff',
-                         sources=['_hausdorff.c'])
+    ext = config.add_extension('_distance_wrap',
+                               sources=[join('src', 'distance_wrap.c')],
+                               depends=[join('src', 'distance_impl.h'),
+                                        join('src', 'distance_threads.h')],
+                               include_dirs=[get_numpy_include_dirs()],
+                               extra_info=get_misc_info("npymath"))
+    ext._pre_build_hook = set_c_threads_flags_hook
+
+    ext = config.add_extension('_voronoi',
+                               sources=['_voronoi.cxx'],
+                               depends=[join('src', 'spherical_voronoi.h')],
+                               include_dirs=[get_numpy_include_dirs(),
+                                             'src'])
+    ext._pre_build_hook = set_cxx_threads_flags_hook
+
+    ext = config.add_extension('_hausdorff',
+                               sources=['_hausdorff.cxx'],
+                               depends=[join('src', 'hausdorff.h')],
+                               include_dirs=[get_numpy_include_dirs(),
+                                             'src'])
+    ext._pre_build_hook = set_cxx_threads_flags_hook
 
     # Add license files
     config.add_data_files('qhull_src/COPYING.txt')
@@ -318,6 +318,140 @@ jaccard_distance_char(const char *u, const char *v, const npy_intp n)
     return denom == 0.0 ? 0.0 : (double)num / denom;
 }
 
+/*
+ * Bit-packed boolean rows
+ * =======================
+ *
+ * A bits64 row holds the features of a boolean observation as the bits of
+ * consecutive 64-bit words, feature j being bit j % 64 of word j / 64.
+ * The bits past the last feature must be zero. The boolean metrics are
+ * then computed from popcounts of whole words, 64 features at a time.
+ *
+ * On x86, the counts are computed with the popcnt instruction if the CPU
+ * has it, which the baseline compiler flags do not assume.
+ */
+typedef npy_uint64 bits64;
+
+typedef struct {
+    npy_intp ntt;   /* both true */
+    npy_intp ntf;   /* true in u only */
+    npy_intp ndiff; /* true in exactly one */
+} bits64_counts;
+
+typedef void bits64_count_func(const bits64 *u, const bits64 *v,
+                               const npy_intp nwords, bits64_counts *c);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DIST_POPCNT_DISPATCH
+#endif
+
+#if defined(__GNUC__)
+#define DIST_POPCOUNT64(x) __builtin_popcountll(x)
+#else
+static NPY_INLINE npy_intp
+dist_popcount64(npy_uint64 x)
+{
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (npy_intp)((x * 0x0101010101010101ULL) >> 56);
+}
+#define DIST_POPCOUNT64(x) dist_popcount64(x)
+#endif
+
+#define DEFINE_BITS64_COUNT(suffix, attr)                                  \
+    attr static void                                                       \
+    bits64_count_ ## suffix(const bits64 *u, const bits64 *v,             \
+                            const npy_intp nwords, bits64_counts *c)       \
+    {                                                                      \
+        npy_intp i, ntt = 0, ntf = 0, ndiff = 0;                           \
+        for (i = 0; i < nwords; ++i) {                                     \
+            ntt += DIST_POPCOUNT64(u[i] & v[i]);                           \
+            ntf += DIST_POPCOUNT64(u[i] & ~v[i]);                          \
+            ndiff += DIST_POPCOUNT64(u[i] ^ v[i]);                         \
+        }                                                                  \
+        c->ntt = ntt;                                                      \
+        c->ntf = ntf;                                                      \
+        c->ndiff = ndiff;                                                  \
+    }
+
+DEFINE_BITS64_COUNT(generic, )
+#ifdef DIST_POPCNT_DISPATCH
+DEFINE_BITS64_COUNT(popcnt, __attribute__((target("popcnt"))))
+#endif
+
+static bits64_count_func *
+bits64_count_select(void)
+{
+#ifdef DIST_POPCNT_DISPATCH
+    if (__builtin_cpu_supports("popcnt")) {
+        return bits64_count_popcnt;
+    }
+#endif
+    return bits64_count_generic;
+}
+
+/*
+ * The distances below mirror the *_distance_char kernels, with n the
+ * number of features; nff is n - ntt - ntf - nft.
+ */
+static NPY_INLINE double
+yule_distance_bits64(const bits64_counts *c, const npy_intp n)
+{
+    const npy_intp nft = c->ndiff - c->ntf;
+    const npy_intp nff = n - c->ntt - c->ndiff;
+    return (2. * c->ntf * nft) / ((double)c->ntt * nff + (double)c->ntf * nft);
+}
+
+static NPY_INLINE double
+dice_distance_bits64(const bits64_counts *c, const npy_intp n)
+{
+    return c->ndiff / (2. * c->ntt + c->ndiff);
+}
+
+static NPY_INLINE double
+rogerstanimoto_distance_bits64(const bits64_counts *c, const npy_intp n)
+{
+    return (2. * c->ndiff) / ((double)n + c->ndiff);
+}
+
+static NPY_INLINE double
+russellrao_distance_bits64(const bits64_counts *c, const npy_intp n)
+{
+    return (double)(n - c->ntt) / n;
+}
+
+static NPY_INLINE double
+kulsinski_distance_bits64(const bits64_counts *c, const npy_intp n)
+{
+    return ((double)c->ndiff - c->ntt + n) / ((double)c->ndiff + n);
+}
+
+static NPY_INLINE double
+sokalsneath_distance_bits64(const bits64_counts *c, const npy_intp n)
+{
+    return (2. * c->ndiff) / (2. * c->ndiff + c->ntt);
+}
+
+static NPY_INLINE double
+sokalmichener_distance_bits64(const bits64_counts *c, const npy_intp n)
+{
+    return (2. * c->ndiff) / ((double)c->ndiff + n);
+}
+
+static NPY_INLINE double
+jaccard_distance_bits64(const bits64_counts *c, const npy_intp n)
+{
+    const npy_intp denom = c->ntt + c->ndiff;
+    return denom == 0 ? 0.0 : (double)c->ndiff / denom;
+}
+
+static NPY_INLINE double
+hamming_distance_bits64(const bits64_counts *c, const npy_intp n)
+{
+    return (double)c->ndiff / n;
+}
+
 
 static NPY_INLINE double
 jensenshannon_distance_double(const double *p, const double *q, const npy_intp n)
@@ -403,6 +537,64 @@ weighted_minkowski_distance(const double *u, const double *v, const npy_intp n,
     return pow(s, 1.0 / p);
 }
 
+/*
+ * Kernels for float32 observations. DEFINE_FLOAT_KERNELS(acc) defines the
+ * variants that sum in type `acc`: float sums keep the loops at full
+ * float SIMD width, double sums give the same accuracy as upcasting the
+ * input to float64 first.
+ */
+#define DEFINE_FLOAT_KERNELS(acc)                                           \
+    static NPY_INLINE double                                                \
+    sqeuclidean_distance_float_ ## acc(const float *u, const float *v,      \
+                                       const npy_intp n)                    \
+    {                                                                       \
+        acc s = 0;                                                          \
+        npy_intp i;                                                         \
+        for (i = 0; i < n; ++i) {                                           \
+            const acc d = (acc)u[i] - (acc)v[i];                            \
+            s += d * d;                                                     \
+        }                                                                   \
+        return s;                                                           \
+    }                                                                       \
+                                                                            \
+    static NPY_INLINE double                                                \
+    dot_product_float_ ## acc(const float *u, const float *v,               \
+                              const npy_intp n)                             \
+    {                                                                       \
+        acc s = 0;                                                          \
+        npy_intp i;                                                         \
+        for (i = 0; i < n; ++i) {                                           \
+            s += (acc)u[i] * (acc)v[i];                                     \
+        }                                                                   \
+        return s;                                                           \
+    }                                                                       \
+                                                                            \
+    static NPY_INLINE double                                                \
+    minkowski_distance_float_ ## acc(const float *u, const float *v,        \
+                                     const npy_intp n, const double p)      \
+    {                                                                       \
+        acc s = 0;                                                          \
+        npy_intp i;                                                         \
+        for (i = 0; i < n; ++i) {                                           \
+            const double d = fabs((double)u[i] - (double)v[i]);             \
+            s += (acc)pow(d, p);                                            \
+        }                                                                   \
+        return pow(s, 1.0 / p);                                             \
+    }                                                                       \
+                                                                            \
+    static NPY_INLINE void                                                  \
+    _row_norms_float_ ## acc(const float *X, const npy_intp num_rows,       \
+                             const npy_intp num_cols, double *norms_buff)   \
+    {                                                                       \
+        npy_intp i;                                                         \
+        for (i = 0; i < num_rows; ++i, X += num_cols) {                     \
+            norms_buff[i] = sqrt(dot_product_float_ ## acc(X, X, num_cols));\
+        }                                                                   \
+    }
+
+DEFINE_FLOAT_KERNELS(float)
+DEFINE_FLOAT_KERNELS(double)
+
 #if 0   /* XXX unused */
 static void
 compute_mean_vector(double *res, const double *X, npy_intp num_rows, const npy_intp n)
@@ -425,188 +617,806 @@ compute_mean_vector(double *res, const double *X, npy_intp num_rows, const npy_i
 }
 #endif
 
-static NPY_INLINE int
-pdist_mahalanobis(const double *X, double *dm, const npy_intp num_rows,
-                  const npy_intp num_cols, const double *covinv)
+/*
+ * Blocked pairwise engine
+ * =======================
+ *
+ * All cdist and pdist routines below run through dist_run_tiles. The rows
+ * of XA and XB are grouped into blocks of dist_block_rows() rows, sized so
+ * that one block of each stays in cache, and a tile is the set of pairs
+ * between one block of XA and one block of XB. pdist only visits the tiles
+ * on and above the diagonal, and within a diagonal tile only the pairs
+ * with j > i.
+ *
+ * Tiles are claimed one at a time from a shared counter by up to
+ * `workers` threads, which balances the triangular pdist tiles without any
+ * up-front partitioning. Problems with less than DIST_MIN_WORK_PER_THREAD
+ * work per thread use fewer threads, down to just the calling one.
+ *
+ * A metric is described by a row function, which computes the distances
+ * from row i of XA to rows [j0, j1) of XB and stores them in
+ * out[0:j1-j0]. A row function may use `scratch_size` doubles of scratch
+ * space, private to the thread calling it.
+ *
+ * Distances are always computed in double. If `dmf` is set, they are
+ * rounded to float32 and stored there instead of in `dm`.
+ *
+ * If `sink` is set, a cdist problem stores nothing at all: each row
+ * segment is passed to sink->emit instead, which keeps what it needs (see
+ * cdist_knn and cdist_radius below). A task then covers one block of rows
+ * of XA against all of XB, so that the state the sink keeps for a row of
+ * XA is only ever touched by one thread.
+ */
+
+/* Bytes of each of the two row blocks of a tile */
+#define DIST_BLOCK_BYTES 32768
+#define DIST_MIN_BLOCK_ROWS 4
+#define DIST_MAX_BLOCK_ROWS 256
+
+/* Minimum number of (pair, column) evaluations worth an extra thread */
+#define DIST_MIN_WORK_PER_THREAD 262144
+
+typedef struct dist_problem dist_problem;
+typedef struct dist_sink dist_sink;
+
+/*
+ * Take the distances d[0:j1-j0] from row i, in block bi of XA, to rows
+ * [j0, j1) of XB. Returns 0, or -1 if memory ran out.
+ */
+typedef int dist_emit_func(dist_sink *sink, npy_intp bi, npy_intp i,
+                           npy_intp j0, npy_intp j1, const double *d);
+
+struct dist_sink {
+    dist_emit_func *emit;
+};
+
+typedef void dist_row_func(const dist_problem *pb, npy_intp i, npy_intp j0,
+                           npy_intp j1, double *out, double *scratch);
+
+struct dist_problem {
+    const char *XA;
+    const char *XB;
+    double *dm;
+    float *dmf;             /* float32 output, replaces dm if set */
+    npy_intp num_rowsA;
+    npy_intp num_rowsB;
+    npy_intp num_cols;
+    npy_intp row_bytes;
+    /* pdist: XB is XA, and only pairs with j > i are computed */
+    int symmetric;
+    dist_row_func *row;
+    npy_intp scratch_size;
+    dist_sink *sink;        /* cdist only, replaces dm if set */
+
+    /* metric parameters */
+    const double *w;        /* weights, variances or inverse covariance */
+    double p;
+    const double *normsA;
+    const double *normsB;
+    npy_intp num_bits;      /* number of features of bits64 rows */
+    bits64_count_func *count;
+};
+
+typedef struct {
+    const dist_problem *pb;
+    npy_intp block_rows;
+    npy_intp num_blocksA;
+    npy_intp num_blocksB;
+    npy_intp num_tiles;
+    npy_intp next_tile;
+    int status;
+    dist_mutex lock;
+} dist_schedule;
+
+typedef struct {
+    dist_schedule *sched;
+    double *scratch;
+} dist_worker;
+
+static NPY_INLINE void
+dist_init_cdist(dist_problem *pb, const void *XA, const void *XB, double *dm,
+                const npy_intp num_rowsA, const npy_intp num_rowsB,
+                const npy_intp num_cols, const size_t itemsize,
+                dist_row_func *row)
 {
-    npy_intp i, j;
-    double *dimbuf1 = calloc(2 * num_cols, sizeof(double));
-    double *dimbuf2;
-    if (!dimbuf1) {
-        return -1;
+    memset(pb, 0, sizeof(*pb));
+    pb->XA = (const char *)XA;
+    pb->XB = (const char *)XB;
+    pb->dm = dm;
+    pb->num_rowsA = num_rowsA;
+    pb->num_rowsB = num_rowsB;
+    pb->num_cols = num_cols;
+    pb->row_bytes = num_cols * (npy_intp)itemsize;
+    pb->row = row;
+}
+
+static NPY_INLINE void
+dist_init_pdist(dist_problem *pb, const void *X, double *dm,
+                const npy_intp num_rows, const npy_intp num_cols,
+                const size_t itemsize, dist_row_func *row)
+{
+    dist_init_cdist(pb, X, X, dm, num_rows, num_rows, num_cols, itemsize,
+                    row);
+    pb->symmetric = 1;
+}
+
+static NPY_INLINE npy_intp
+dist_block_rows(const npy_intp row_bytes)
+{
+    npy_intp rows = DIST_BLOCK_BYTES / (row_bytes > 0 ? row_bytes : 1);
+    if (rows < DIST_MIN_BLOCK_ROWS) {
+        rows = DIST_MIN_BLOCK_ROWS;
+    }
+    if (rows > DIST_MAX_BLOCK_ROWS) {
+        rows = DIST_MAX_BLOCK_ROWS;
     }
+    return rows;
+}
 
-    dimbuf2 = dimbuf1 + num_cols;
+/*
+ * Block coordinates of pdist tile t. Block row b holds the nb - b tiles
+ * (b, b), ..., (b, nb - 1) and starts at tile b * nb - b * (b - 1) / 2.
+ */
+static NPY_INLINE void
+dist_triangular_tile(const npy_intp t, const npy_intp nb, npy_intp *bi,
+                     npy_intp *bj)
+{
+    const double c = 2.0 * nb + 1.0;
+    npy_intp b = (npy_intp)((c - sqrt(c * c - 8.0 * t)) / 2.0);
 
-    for (i = 0; i < num_rows; ++i) {
-        const double *u = X + (num_cols * i);
-        for (j = i + 1; j < num_rows; ++j, ++dm) {
-            const double *v = X + (num_cols * j);
-            *dm = mahalanobis_distance(u, v, covinv, dimbuf1, dimbuf2, num_cols);
+    if (b < 0) {
+        b = 0;
+    }
+    if (b > nb - 1) {
+        b = nb - 1;
+    }
+    while (b > 0 && b * nb - b * (b - 1) / 2 > t) {
+        --b;
+    }
+    while (b + 1 < nb && (b + 1) * nb - (b + 1) * b / 2 <= t) {
+        ++b;
+    }
+    *bi = b;
+    *bj = b + (t - (b * nb - b * (b - 1) / 2));
+}
+
+/*
+ * Compute row i against rows [j0, j1) and store the distances at offset
+ * `index` of the output. float32 output goes through the block_rows
+ * doubles past the row function's scratch space.
+ */
+static NPY_INLINE void
+dist_run_row(const dist_problem *pb, const npy_intp i, const npy_intp j0,
+             const npy_intp j1, const npy_intp index, double *scratch)
+{
+    if (pb->dmf) {
+        double *out = scratch + pb->scratch_size;
+        npy_intp k;
+        pb->row(pb, i, j0, j1, out, scratch);
+        for (k = 0; k < j1 - j0; ++k) {
+            pb->dmf[index + k] = (float)out[k];
+        }
+    }
+    else {
+        pb->row(pb, i, j0, j1, pb->dm + index, scratch);
+    }
+}
+
+/* Task bi of a problem with a sink: block bi of XA against all of XB */
+static int
+dist_run_row_block(const dist_schedule *sched, const npy_intp bi,
+                   double *scratch)
+{
+    const dist_problem *pb = sched->pb;
+    const npy_intp T = sched->block_rows;
+    const npy_intp m = pb->num_rowsA;
+    const npy_intp i1 = (bi + 1) * T < m ? (bi + 1) * T : m;
+    double *out = scratch + pb->scratch_size;
+    npy_intp bj, i, j0, j1;
+
+    for (bj = 0; bj < sched->num_blocksB; ++bj) {
+        j0 = bj * T;
+        j1 = j0 + T < pb->num_rowsB ? j0 + T : pb->num_rowsB;
+        for (i = bi * T; i < i1; ++i) {
+            pb->row(pb, i, j0, j1, out, scratch);
+            if (pb->sink->emit(pb->sink, bi, i, j0, j1, out) < 0) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+static int
+dist_run_tile(const dist_schedule *sched, const npy_intp t, double *scratch)
+{
+    const dist_problem *pb = sched->pb;
+    const npy_intp T = sched->block_rows;
+    const npy_intp m = pb->num_rowsA;
+    npy_intp bi, bj, i, i1, j0, j1;
+
+    if (pb->sink) {
+        return dist_run_row_block(sched, t, scratch);
+    }
+    if (pb->symmetric) {
+        dist_triangular_tile(t, sched->num_blocksA, &bi, &bj);
+    }
+    else {
+        bi = t / sched->num_blocksB;
+        bj = t % sched->num_blocksB;
+    }
+    i1 = (bi + 1) * T < m ? (bi + 1) * T : m;
+    j0 = bj * T;
+    j1 = j0 + T < pb->num_rowsB ? j0 + T : pb->num_rowsB;
+
+    for (i = bi * T; i < i1; ++i) {
+        if (pb->symmetric) {
+            /* condensed index of the pair (i, j), j > i */
+            const npy_intp j = j0 > i + 1 ? j0 : i + 1;
+            if (j < j1) {
+                dist_run_row(pb, i, j, j1, m * i - i * (i + 1) / 2 + j - i - 1,
+                             scratch);
+            }
+        }
+        else {
+            dist_run_row(pb, i, j0, j1, pb->num_rowsB * i + j0, scratch);
         }
     }
-    free(dimbuf1);
     return 0;
 }
 
+static void
+dist_worker_main(void *arg)
+{
+    dist_worker *worker = (dist_worker *)arg;
+    dist_schedule *sched = worker->sched;
+
+    for (;;) {
+        npy_intp t;
+        dist_mutex_lock(&sched->lock);
+        t = sched->status < 0 ? sched->num_tiles : sched->next_tile++;
+        dist_mutex_unlock(&sched->lock);
+        if (t >= sched->num_tiles) {
+            break;
+        }
+        if (dist_run_tile(sched, t, worker->scratch) < 0) {
+            dist_mutex_lock(&sched->lock);
+            sched->status = -1;
+            dist_mutex_unlock(&sched->lock);
+        }
+    }
+}
+
+/*
+ * Compute all distances of `pb` on up to `workers` threads. Returns 0, or
+ * -1 if the scratch space could not be allocated or the sink ran out of
+ * memory.
+ */
+static int
+dist_run_tiles(const dist_problem *pb, npy_intp workers)
+{
+    dist_schedule sched;
+    dist_worker *worker = NULL;
+    void **args = NULL;
+    double *scratch = NULL;
+    double work;
+    npy_intp k, nthreads, scratch_size;
+    int status = 0;
+
+    sched.pb = pb;
+    sched.block_rows = dist_block_rows(pb->row_bytes);
+    sched.num_blocksA = (pb->num_rowsA + sched.block_rows - 1)
+                        / sched.block_rows;
+    sched.num_blocksB = (pb->num_rowsB + sched.block_rows - 1)
+                        / sched.block_rows;
+    if (pb->sink) {
+        sched.num_tiles = pb->num_rowsB > 0 ? sched.num_blocksA : 0;
+        work = (double)pb->num_rowsA * pb->num_rowsB;
+    }
+    else if (pb->symmetric) {
+        sched.num_tiles = sched.num_blocksA * (sched.num_blocksA + 1) / 2;
+        work = 0.5 * pb->num_rowsA * pb->num_rowsA;
+    }
+    else {
+        sched.num_tiles = sched.num_blocksA * sched.num_blocksB;
+        work = (double)pb->num_rowsA * pb->num_rowsB;
+    }
+    sched.next_tile = 0;
+    sched.status = 0;
+    if (sched.num_tiles == 0) {
+        return 0;
+    }
+
+    work *= pb->num_cols > 0 ? pb->num_cols : 1;
+    nthreads = workers < sched.num_tiles ? workers : sched.num_tiles;
+    if (work / DIST_MIN_WORK_PER_THREAD < nthreads) {
+        nthreads = (npy_intp)(work / DIST_MIN_WORK_PER_THREAD);
+    }
+    if (nthreads < 1) {
+        nthreads = 1;
+    }
+
+    scratch_size = pb->scratch_size
+                   + (pb->dmf || pb->sink ? sched.block_rows : 0);
+    if (scratch_size > 0) {
+        scratch = calloc(nthreads * scratch_size, sizeof(double));
+        if (!scratch) {
+            return -1;
+        }
+    }
+
+    if (nthreads == 1) {
+        for (k = 0; k < sched.num_tiles && status == 0; ++k) {
+            status = dist_run_tile(&sched, k, scratch);
+        }
+        free(scratch);
+        return status;
+    }
+
+    worker = calloc(nthreads, sizeof(dist_worker));
+    args = calloc(nthreads, sizeof(void *));
+    if (!worker || !args) {
+        status = -1;
+        goto done;
+    }
+    for (k = 0; k < nthreads; ++k) {
+        worker[k].sched = &sched;
+        worker[k].scratch = scratch ? scratch + k * scratch_size : NULL;
+        args[k] = worker + k;
+    }
+    dist_mutex_init(&sched.lock);
+    dist_run_threads((int)nthreads, dist_worker_main, args);
+    dist_mutex_destroy(&sched.lock);
+    status = sched.status;
+
+done:
+    free(args);
+    free(worker);
+    free(scratch);
+    return status;
+}
+
+/*
+ * DEFINE_DIST_ROW(name, type, expr) defines the row function
+ * name_type_row, which sets each distance to `expr`. `expr` may use the
+ * rows u and v, the number of columns n, the problem pb and the scratch
+ * space.
+ */
+#define DEFINE_DIST_ROW(name, type, expr)                                  \
+    static void name ## _ ## type ## _row(const dist_problem *pb,          \
+                                         npy_intp i, npy_intp j0,          \
+                                         npy_intp j1, double *out,         \
+                                         double *scratch)                  \
+    {                                                                      \
+        const npy_intp n = pb->num_cols;                                   \
+        const type *u = (const type *)pb->XA + n * i;                      \
+        const type *v = (const type *)pb->XB + n * j0;                     \
+        npy_intp j;                                                        \
+        (void)scratch;                                                     \
+        for (j = j0; j < j1; ++j, v += n, ++out) {                         \
+            *out = (expr);                                                 \
+        }                                                                  \
+    }
+
+#define DIST_PLAIN_ROW(name, type) \
+    DEFINE_DIST_ROW(name, type, name ## _distance_ ## type(u, v, n))
+
+DIST_PLAIN_ROW(bray_curtis, double)
+DIST_PLAIN_ROW(canberra, double)
+DIST_PLAIN_ROW(chebyshev, double)
+DIST_PLAIN_ROW(city_block, double)
+DIST_PLAIN_ROW(euclidean, double)
+DIST_PLAIN_ROW(jaccard, double)
+DIST_PLAIN_ROW(jensenshannon, double)
+DIST_PLAIN_ROW(sqeuclidean, double)
+
+DIST_PLAIN_ROW(dice, char)
+DIST_PLAIN_ROW(jaccard, char)
+DIST_PLAIN_ROW(kulsinski, char)
+DIST_PLAIN_ROW(rogerstanimoto, char)
+DIST_PLAIN_ROW(russellrao, char)
+DIST_PLAIN_ROW(sokalmichener, char)
+DIST_PLAIN_ROW(sokalsneath, char)
+DIST_PLAIN_ROW(yule, char)
+
+#define DIST_BITS64_ROW(name)                                              \
+    static void name ## _bits64_row(const dist_problem *pb, npy_intp i,    \
+                                    npy_intp j0, npy_intp j1, double *out, \
+                                    double *scratch)                       \
+    {                                                                      \
+        const npy_intp n = pb->num_cols;                                   \
+        const bits64 *u = (const bits64 *)pb->XA + n * i;                  \
+        const bits64 *v = (const bits64 *)pb->XB + n * j0;                 \
+        bits64_counts c;                                                   \
+        npy_intp j;                                                        \
+        (void)scratch;                                                     \
+        for (j = j0; j < j1; ++j, v += n, ++out) {                         \
+            pb->count(u, v, n, &c);                                        \
+            *out = name ## _distance_bits64(&c, pb->num_bits);             \
+        }                                                                  \
+    }
+
+DIST_BITS64_ROW(dice)
+DIST_BITS64_ROW(hamming)
+DIST_BITS64_ROW(jaccard)
+DIST_BITS64_ROW(kulsinski)
+DIST_BITS64_ROW(rogerstanimoto)
+DIST_BITS64_ROW(russellrao)
+DIST_BITS64_ROW(sokalmichener)
+DIST_BITS64_ROW(sokalsneath)
+DIST_BITS64_ROW(yule)
+
+DEFINE_DIST_ROW(hamming, double, hamming_distance_double(u, v, n, pb->w))
+DEFINE_DIST_ROW(hamming, char, hamming_distance_char(u, v, n, pb->w))
+DEFINE_DIST_ROW(minkowski, double, minkowski_distance(u, v, n, pb->p))
+DEFINE_DIST_ROW(weighted_minkowski, double,
+                weighted_minkowski_distance(u, v, n, pb->p, pb->w))
+DEFINE_DIST_ROW(seuclidean, double, seuclidean_distance(pb->w, u, v, n))
+DEFINE_DIST_ROW(mahalanobis, double,
+                mahalanobis_distance(u, v, pb->w, scratch, scratch + n, n))
+
+static NPY_INLINE double
+cosine_distance_from_dot(const double dot, const double norm_u,
+                         const double norm_v)
+{
+    double cosine = dot / (norm_u * norm_v);
+    if (fabs(cosine) > 1.) {
+        /* Clip to correct rounding error. */
+        cosine = npy_copysign(1, cosine);
+    }
+    return 1. - cosine;
+}
+
+DEFINE_DIST_ROW(cosine, double,
+                cosine_distance_from_dot(dot_product(u, v, n), pb->normsA[i],
+                                         pb->normsB[j]))
+
+/* float32 rows; the _acc64 variants sum in double */
+DEFINE_DIST_ROW(sqeuclidean, float,
+                sqeuclidean_distance_float_float(u, v, n))
+DEFINE_DIST_ROW(sqeuclidean_acc64, float,
+                sqeuclidean_distance_float_double(u, v, n))
+DEFINE_DIST_ROW(euclidean, float,
+                sqrt(sqeuclidean_distance_float_float(u, v, n)))
+DEFINE_DIST_ROW(euclidean_acc64, float,
+                sqrt(sqeuclidean_distance_float_double(u, v, n)))
+DEFINE_DIST_ROW(minkowski, float,
+                minkowski_distance_float_float(u, v, n, pb->p))
+DEFINE_DIST_ROW(minkowski_acc64, float,
+                minkowski_distance_float_double(u, v, n, pb->p))
+DEFINE_DIST_ROW(cosine, float,
+                cosine_distance_from_dot(dot_product_float_float(u, v, n),
+                                         pb->normsA[i], pb->normsB[j]))
+DEFINE_DIST_ROW(cosine_acc64, float,
+                cosine_distance_from_dot(dot_product_float_double(u, v, n),
+                                         pb->normsA[i], pb->normsB[j]))
+
+
+/** pdist */
 static NPY_INLINE int
-pdist_cosine(const double *X, double *dm, const npy_intp num_rows,
-             const npy_intp num_cols)
+pdist_mahalanobis(const double *X, double *dm, const npy_intp num_rows,
+                  const npy_intp num_cols, const double *covinv,
+                  const npy_intp workers)
 {
-    double cosine;
-    npy_intp i, j;
+    dist_problem pb;
+    dist_init_pdist(&pb, X, dm, num_rows, num_cols, sizeof(double),
+                    mahalanobis_double_row);
+    pb.w = covinv;
+    pb.scratch_size = 2 * num_cols;
+    return dist_run_tiles(&pb, workers);
+}
 
-    double * norms_buff = calloc(num_rows, sizeof(double));
+static NPY_INLINE int
+pdist_cosine(const double *X, double *dm, const npy_intp num_rows,
+             const npy_intp num_cols, const npy_intp workers)
+{
+    dist_problem pb;
+    int status;
+    double *norms_buff = calloc(num_rows, sizeof(double));
     if (!norms_buff)
         return -1;
 
     _row_norms(X, num_rows, num_cols, norms_buff);
 
-    for (i = 0; i < num_rows; ++i) {
-        const double *u = X + (num_cols * i);
-        for (j = i + 1; j < num_rows; ++j, ++dm) {
-            const double *v = X + (num_cols * j);
-            cosine = dot_product(u, v, num_cols) / (norms_buff[i] * norms_buff[j]);
-            if (fabs(cosine) > 1.) {
-                /* Clip to correct rounding error. */
-                cosine = npy_copysign(1, cosine);
-            }
-            *dm = 1. - cosine;
-        }
-    }
+    dist_init_pdist(&pb, X, dm, num_rows, num_cols, sizeof(double),
+                    cosine_double_row);
+    pb.normsA = norms_buff;
+    pb.normsB = norms_buff;
+    status = dist_run_tiles(&pb, workers);
     free(norms_buff);
-    return 0;
+    return status;
 }
 
 static NPY_INLINE int
 pdist_seuclidean(const double *X, const double *var, double *dm,
-                 const npy_intp num_rows, const npy_intp num_cols)
+                 const npy_intp num_rows, const npy_intp num_cols,
+                 const npy_intp workers)
 {
-    npy_intp i, j;
-
-    for (i = 0; i < num_rows; ++i) {
-        const double *u = X + (num_cols * i);
-        for (j = i + 1; j < num_rows; ++j, ++dm) {
-            const double *v = X + (num_cols * j);
-            *dm = seuclidean_distance(var, u, v, num_cols);
-        }
-    }
-    return 0;
+    dist_problem pb;
+    dist_init_pdist(&pb, X, dm, num_rows, num_cols, sizeof(double),
+                    seuclidean_double_row);
+    pb.w = var;
+    return dist_run_tiles(&pb, workers);
 }
 
 static NPY_INLINE int
 pdist_minkowski(const double *X, double *dm, npy_intp num_rows,
-                const npy_intp num_cols, const double p)
+                const npy_intp num_cols, const double p,
+                const npy_intp workers)
 {
-    npy_intp i, j;
-
-    for (i = 0; i < num_rows; ++i) {
-        const double *u = X + (num_cols * i);
-        for (j = i + 1; j < num_rows; ++j, ++dm) {
-            const double *v = X + (num_cols * j);
-            *dm = minkowski_distance(u, v, num_cols, p);
-        }
-    }
-    return 0;
+    dist_problem pb;
+    dist_init_pdist(&pb, X, dm, num_rows, num_cols, sizeof(double),
+                    minkowski_double_row);
+    pb.p = p;
+    return dist_run_tiles(&pb, workers);
 }
 
 static NPY_INLINE int
 pdist_weighted_minkowski(const double *X, double *dm, npy_intp num_rows,
-                         const npy_intp num_cols, const double p, const double *w)
+                         const npy_intp num_cols, const double p,
+                         const double *w, const npy_intp workers)
 {
-    npy_intp i, j;
-
-    for (i = 0; i < num_rows; ++i) {
-        const double *u = X + (num_cols * i);
-        for (j = i + 1; j < num_rows; ++j, ++dm) {
-            const double *v = X + (num_cols * j);
-            *dm = weighted_minkowski_distance(u, v, num_cols, p, w);
-        }
-    }
-    return 0;
+    dist_problem pb;
+    dist_init_pdist(&pb, X, dm, num_rows, num_cols, sizeof(double),
+                    weighted_minkowski_double_row);
+    pb.p = p;
+    pb.w = w;
+    return dist_run_tiles(&pb, workers);
 }
 
 static NPY_INLINE int
 pdist_hamming_double(const double *X, double *dm, npy_intp num_rows,
-                         const npy_intp num_cols, const double *w)
+                     const npy_intp num_cols, const double *w,
+                     const npy_intp workers)
 {
-    npy_intp i, j;
-
-    for (i = 0; i < num_rows; ++i) {
-        const double *u = X + (num_cols * i);
-        for (j = i + 1; j < num_rows; ++j, ++dm) {
-            const double *v = X + (num_cols * j);
-            *dm = hamming_distance_double(u, v, num_cols, w);
-        }
-    }
-    return 0;
+    dist_problem pb;
+    dist_init_pdist(&pb, X, dm, num_rows, num_cols, sizeof(double),
+                    hamming_double_row);
+    pb.w = w;
+    return dist_run_tiles(&pb, workers);
 }
 
 static NPY_INLINE int
 pdist_hamming_char(const char *X, double *dm, npy_intp num_rows,
-                         const npy_intp num_cols, const double *w)
+                   const npy_intp num_cols, const double *w,
+                   const npy_intp workers)
 {
-    npy_intp i, j;
+    dist_problem pb;
+    dist_init_pdist(&pb, X, dm, num_rows, num_cols, sizeof(char),
+                    hamming_char_row);
+    pb.w = w;
+    return dist_run_tiles(&pb, workers);
+}
 
-    for (i = 0; i < num_rows; ++i) {
-        const char *u = X + (num_cols * i);
-        for (j = i + 1; j < num_rows; ++j, ++dm) {
-            const char *v = X + (num_cols * j);
-            *dm = hamming_distance_char(u, v, num_cols, w);
+/*
+ * Conversion between condensed and square distance matrices
+ * =========================================================
+ *
+ * Both directions copy the entries bit by bit in elements of s bytes, on
+ * up to `workers` threads claiming tasks from a shared counter. The square
+ * form is filled in tiles of DIST_SQUARE_TILE x DIST_SQUARE_TILE entries:
+ * tile (bi, bj), bi <= bj, copies its part of the upper triangle from v
+ * and mirrors it into tile (bj, bi), so that the column-wise writes of the
+ * mirror stay within a few cache lines. The condensed form is copied row
+ * by row, DIST_SQUARE_TILE rows per task. The diagonal is left untouched.
+ */
+#define DIST_SQUARE_TILE 64
+
+typedef struct {
+    char *M;
+    char *v;
+    npy_intp n;
+    npy_intp s;
+    int to_square;
+    npy_intp num_blocks;
+    npy_intp num_tasks;
+    npy_intp next_task;
+    dist_mutex lock;
+} dist_squareform_job;
+
+#define DEFINE_SQUAREFORM_TILE(type)                                        \
+    static void                                                             \
+    dist_squareform_tile_ ## type(type *M, const type *v, const npy_intp n, \
+                                  const npy_intp i0, const npy_intp i1,     \
+                                  const npy_intp j0, const npy_intp j1)     \
+    {                                                                       \
+        npy_intp i, j;                                                      \
+        for (i = i0; i < i1; ++i) {                                         \
+            /* v[k + j] is entry (i, j) */                                  \
+            const npy_intp k = n * i - i * (i + 1) / 2 - i - 1;             \
+            for (j = j0 > i + 1 ? j0 : i + 1; j < j1; ++j) {                \
+                M[n * i + j] = v[k + j];                                    \
+            }                                                               \
+        }                                                                   \
+        /* mirror column by column so the stores stay contiguous */         \
+        for (j = j0; j < j1; ++j) {                                         \
+            const npy_intp i_end = j < i1 ? j : i1;                         \
+            for (i = i0; i < i_end; ++i) {                                  \
+                M[n * j + i] = M[n * i + j];                                \
+            }                                                               \
+        }                                                                   \
+    }
+
+DEFINE_SQUAREFORM_TILE(npy_uint8)
+DEFINE_SQUAREFORM_TILE(npy_uint16)
+DEFINE_SQUAREFORM_TILE(npy_uint32)
+DEFINE_SQUAREFORM_TILE(npy_uint64)
+
+static void
+dist_squareform_tile_generic(char *M, const char *v, const npy_intp n,
+                             const npy_intp s, const npy_intp i0,
+                             const npy_intp i1, const npy_intp j0,
+                             const npy_intp j1)
+{
+    npy_intp i, j;
+    for (i = i0; i < i1; ++i) {
+        const npy_intp k = n * i - i * (i + 1) / 2 - i - 1;
+        for (j = j0 > i + 1 ? j0 : i + 1; j < j1; ++j) {
+            memcpy(M + (n * i + j) * s, v + (k + j) * s, s);
+            memcpy(M + (n * j + i) * s, v + (k + j) * s, s);
         }
     }
-    return 0;
 }
 
-static NPY_INLINE void
-dist_to_squareform_from_vector_generic(char *M, const char *v, const npy_intp n,
-                                       npy_intp s)
+static void
+dist_squareform_task(const dist_squareform_job *job, const npy_intp t)
 {
-    char *it1 = M + s;
-    char *it2;
-    npy_intp i, j;
+    const npy_intp n = job->n, s = job->s, T = DIST_SQUARE_TILE;
+    npy_intp bi, bj, i0, i1, j0, j1, i;
+
+    if (!job->to_square) {
+        /* rows [i0, i1) of the upper triangle */
+        i0 = t * T;
+        i1 = i0 + T < n ? i0 + T : n;
+        for (i = i0; i < i1; ++i) {
+            const npy_intp k = n * i - i * (i + 1) / 2;
+            memcpy(job->v + k * s, job->M + (n * i + i + 1) * s,
+                   (n - i - 1) * s);
+        }
+        return;
+    }
 
-    for (i = 1; i < n; ++i) {
-        memcpy(it1, v, (n - i) * s);
-        it1 += (n + 1) * s;
+    dist_triangular_tile(t, job->num_blocks, &bi, &bj);
+    i0 = bi * T;
+    i1 = i0 + T < n ? i0 + T : n;
+    j0 = bj * T;
+    j1 = j0 + T < n ? j0 + T : n;
+    switch (s) {
+    case 1:
+        dist_squareform_tile_npy_uint8((npy_uint8 *)job->M,
+                                       (const npy_uint8 *)job->v, n,
+                                       i0, i1, j0, j1);
+        break;
+    case 2:
+        dist_squareform_tile_npy_uint16((npy_uint16 *)job->M,
+                                        (const npy_uint16 *)job->v, n,
+                                        i0, i1, j0, j1);
+        break;
+    case 4:
+        dist_squareform_tile_npy_uint32((npy_uint32 *)job->M,
+                                        (const npy_uint32 *)job->v, n,
+                                        i0, i1, j0, j1);
+        break;
+    case 8:
+        dist_squareform_tile_npy_uint64((npy_uint64 *)job->M,
+                                        (const npy_uint64 *)job->v, n,
+                                        i0, i1, j0, j1);
+        break;
+    default:
+        dist_squareform_tile_generic(job->M, job->v, n, s, i0, i1, j0, j1);
+    }
+}
 
-        it2 = M + i * (n + 1) * s - s;
-        for (j = i; j < n; ++j) {
-            memcpy(it2, v, s);
-            v += s;
-            it2 += n*s;
+static void
+dist_squareform_worker(void *arg)
+{
+    dist_squareform_job *job = (dist_squareform_job *)arg;
+
+    for (;;) {
+        npy_intp t;
+        dist_mutex_lock(&job->lock);
+        t = job->next_task++;
+        dist_mutex_unlock(&job->lock);
+        if (t >= job->num_tasks) {
+            break;
         }
+        dist_squareform_task(job, t);
     }
 }
 
 static NPY_INLINE void
-dist_to_squareform_from_vector_double(double *M, const double *v, const npy_intp n)
+dist_run_squareform(dist_squareform_job *job, npy_intp workers)
 {
-    double *it1 = M + 1;
-    double *it2;
-    npy_intp i, j;
-
-    for (i = 1; i < n; ++i, it1 += n+1) {
-        memcpy(it1, v, (n - i) * sizeof(double));
+    const double work = 0.5 * job->n * job->n;
+    void **args;
+    npy_intp k;
+
+    job->num_blocks = (job->n + DIST_SQUARE_TILE - 1) / DIST_SQUARE_TILE;
+    job->num_tasks = job->to_square
+                     ? job->num_blocks * (job->num_blocks + 1) / 2
+                     : job->num_blocks;
+    job->next_task = 0;
+    if (work / DIST_MIN_WORK_PER_THREAD < workers) {
+        workers = (npy_intp)(work / DIST_MIN_WORK_PER_THREAD);
+    }
+    if (workers > job->num_tasks) {
+        workers = job->num_tasks;
+    }
 
-        it2 = M + i * (n + 1) - 1;
-        for (j = i; j < n; ++j, ++v, it2 += n) {
-            *it2 = *v;
+    args = workers > 1 ? calloc(workers, sizeof(void *)) : NULL;
+    if (!args) {
+        /* serial, also if memory ran out */
+        for (k = 0; k < job->num_tasks; ++k) {
+            dist_squareform_task(job, k);
         }
+        return;
     }
+    for (k = 0; k < workers; ++k) {
+        args[k] = job;
+    }
+    dist_mutex_init(&job->lock);
+    dist_run_threads((int)workers, dist_squareform_worker, args);
+    dist_mutex_destroy(&job->lock);
+    free(args);
 }
 
+/* Fill the off-diagonal entries of the n x n matrix M from v */
 static NPY_INLINE void
-dist_to_vector_from_squareform(const char *M, char *v, const npy_intp n, npy_intp s)
+dist_to_squareform_from_vector(char *M, const char *v, const npy_intp n,
+                               const npy_intp s, const npy_intp workers)
 {
-    const char *cit = M + s;
-    npy_intp i;
+    dist_squareform_job job;
+    job.M = M;
+    job.v = (char *)v;
+    job.n = n;
+    job.s = s;
+    job.to_square = 1;
+    dist_run_squareform(&job, workers);
+}
 
-    for (i = 1; i < n; ++i) {
-        const npy_intp len = (n - i) * s;
-        memcpy(v, cit, len);
-        v += len;
-        cit += (n + 1) * s;
+static NPY_INLINE void
+dist_to_vector_from_squareform(const char *M, char *v, const npy_intp n,
+                               const npy_intp s, const npy_intp workers)
+{
+    dist_squareform_job job;
+    job.M = (char *)M;
+    job.v = v;
+    job.n = n;
+    job.s = s;
+    job.to_square = 0;
+    dist_run_squareform(&job, workers);
+}
+
+/*
+ * The smallest off-diagonal entry of each row of the square form of the
+ * condensed matrix y and its column, in one pass over y. The first NaN
+ * wins, as with np.argmin, and otherwise the first smallest entry.
+ */
+static NPY_INLINE void
+dist_condensed_argmin(const double *y, const npy_intp n, double *mins,
+                      npy_intp *args)
+{
+    npy_intp i, j;
+
+    for (i = 0; i < n; ++i) {
+        args[i] = -1;
+        mins[i] = HUGE_VAL;
+    }
+    for (i = 0; i < n; ++i) {
+        for (j = i + 1; j < n; ++j, ++y) {
+            const double d = *y;
+            /* j is visited in increasing order for both rows */
+            if (args[i] < 0 || d < mins[i]
+                    || (npy_isnan(d) && !npy_isnan(mins[i]))) {
+                mins[i] = d;
+                args[i] = j;
+            }
+            if (args[j] < 0 || d < mins[j]
+                    || (npy_isnan(d) && !npy_isnan(mins[j]))) {
+                mins[j] = d;
+                args[j] = i;
+            }
+        }
     }
 }
 
@@ -614,11 +1424,11 @@ dist_to_vector_from_squareform(const char *M, char *v, const npy_intp n, npy_int
 /** cdist */
 static NPY_INLINE int
 cdist_cosine(const double *XA, const double *XB, double *dm, const npy_intp num_rowsA,
-             const npy_intp num_rowsB, const npy_intp num_cols)
+             const npy_intp num_rowsB, const npy_intp num_cols,
+             const npy_intp workers)
 {
-    double cosine;
-    npy_intp i, j;
-
+    dist_problem pb;
+    int status;
     double * norms_buffA = calloc(num_rowsA + num_rowsB, sizeof(double));
     double * norms_buffB;
     if (!norms_buffA)
@@ -629,133 +1439,92 @@ cdist_cosine(const double *XA, const double *XB, double *dm, const npy_intp num_
     _row_norms(XA, num_rowsA, num_cols, norms_buffA);
     _row_norms(XB, num_rowsB, num_cols, norms_buffB);
 
-    for (i = 0; i < num_rowsA; ++i) {
-        const double *u = XA + (num_cols * i);
-        for (j = 0; j < num_rowsB; ++j, ++dm) {
-            const double *v = XB + (num_cols * j);
-            cosine = dot_product(u, v, num_cols) / (norms_buffA[i] * norms_buffB[j]);
-            if (fabs(cosine) > 1.) {
-                /* Clip to correct rounding error. */
-                cosine = npy_copysign(1, cosine);
-            }
-            *dm = 1. - cosine;
-        }
-    }
+    dist_init_cdist(&pb, XA, XB, dm, num_rowsA, num_rowsB, num_cols,
+                    sizeof(double), cosine_double_row);
+    pb.normsA = norms_buffA;
+    pb.normsB = norms_buffB;
+    status = dist_run_tiles(&pb, workers);
     free(norms_buffA);
-    return 0;
+    return status;
 }
 
 static NPY_INLINE int
 cdist_mahalanobis(const double *XA, const double *XB, double *dm,
                   const npy_intp num_rowsA, const npy_intp num_rowsB,
-                  const npy_intp num_cols, const double *covinv)
+                  const npy_intp num_cols, const double *covinv,
+                  const npy_intp workers)
 {
-    npy_intp i, j;
-
-    double *dimbuf1 = calloc(2 * num_cols, sizeof(double));
-    double *dimbuf2;
-    if (!dimbuf1) {
-        return -1;
-    }
-    dimbuf2 = dimbuf1 + num_cols;
-
-    for (i = 0; i < num_rowsA; ++i) {
-        const double *u = XA + (num_cols * i);
-        for (j = 0; j < num_rowsB; ++j, ++dm) {
-            const double *v = XB + (num_cols * j);
-            *dm = mahalanobis_distance(u, v, covinv, dimbuf1, dimbuf2, num_cols);
-        }
-    }
-    free(dimbuf1);
-    return 0;
+    dist_problem pb;
+    dist_init_cdist(&pb, XA, XB, dm, num_rowsA, num_rowsB, num_cols,
+                    sizeof(double), mahalanobis_double_row);
+    pb.w = covinv;
+    pb.scratch_size = 2 * num_cols;
+    return dist_run_tiles(&pb, workers);
 }
 
 static NPY_INLINE int
 cdist_seuclidean(const double *XA, const double *XB, const double *var,
                  double *dm, const npy_intp num_rowsA, const npy_intp num_rowsB,
-                 const npy_intp num_cols)
+                 const npy_intp num_cols, const npy_intp workers)
 {
-    npy_intp i, j;
-
-    for (i = 0; i < num_rowsA; ++i) {
-        const double *u = XA + (num_cols * i);
-        for (j = 0; j < num_rowsB; ++j, ++dm) {
-            const double *v = XB + (num_cols * j);
-            *dm = seuclidean_distance(var, u, v, num_cols);
-        }
-    }
-    return 0;
+    dist_problem pb;
+    dist_init_cdist(&pb, XA, XB, dm, num_rowsA, num_rowsB, num_cols,
+                    sizeof(double), seuclidean_double_row);
+    pb.w = var;
+    return dist_run_tiles(&pb, workers);
 }
 
 static NPY_INLINE int
 cdist_minkowski(const double *XA, const double *XB, double *dm,
                 const npy_intp num_rowsA, const npy_intp num_rowsB,
-                const npy_intp num_cols, const double p)
+                const npy_intp num_cols, const double p,
+                const npy_intp workers)
 {
-    npy_intp i, j;
-
-    for (i = 0; i < num_rowsA; ++i) {
-        const double *u = XA + (num_cols * i);
-        for (j = 0; j < num_rowsB; ++j, ++dm) {
-            const double *v = XB + (num_cols * j);
-            *dm = minkowski_distance(u, v, num_cols, p);
-        }
-    }
-    return 0;
+    dist_problem pb;
+    dist_init_cdist(&pb, XA, XB, dm, num_rowsA, num_rowsB, num_cols,
+                    sizeof(double), minkowski_double_row);
+    pb.p = p;
+    return dist_run_tiles(&pb, workers);
 }
 
 static NPY_INLINE int
 cdist_weighted_minkowski(const double *XA, const double *XB, double *dm,
                          const npy_intp num_rowsA, const npy_intp num_rowsB,
                          const npy_intp num_cols, const double p,
-                         const double *w)
+                         const double *w, const npy_intp workers)
 {
-    npy_intp i, j;
-
-    for (i = 0; i < num_rowsA; ++i) {
-        const double *u = XA + (num_cols * i);
-        for (j = 0; j < num_rowsB; ++j, ++dm) {
-            const double *v = XB + (num_cols * j);
-            *dm = weighted_minkowski_distance(u, v, num_cols, p, w);
-        }
-    }
-    return 0;
+    dist_problem pb;
+    dist_init_cdist(&pb, XA, XB, dm, num_rowsA, num_rowsB, num_cols,
+                    sizeof(double), weighted_minkowski_double_row);
+    pb.p = p;
+    pb.w = w;
+    return dist_run_tiles(&pb, workers);
 }
 
 static NPY_INLINE int
 cdist_hamming_double(const double *XA, const double *XB, double *dm,
-                         const npy_intp num_rowsA, const npy_intp num_rowsB,
-                         const npy_intp num_cols,
-                         const double *w)
+                     const npy_intp num_rowsA, const npy_intp num_rowsB,
+                     const npy_intp num_cols, const double *w,
+                     const npy_intp workers)
 {
-    npy_intp i, j;
-
-    for (i = 0; i < num_rowsA; ++i) {
-        const double *u = XA + (num_cols * i);
-        for (j = 0; j < num_rowsB; ++j, ++dm) {
-            const double *v = XB + (num_cols * j);
-            *dm = hamming_distance_double(u, v, num_cols, w);
-        }
-    }
-    return 0;
+    dist_problem pb;
+    dist_init_cdist(&pb, XA, XB, dm, num_rowsA, num_rowsB, num_cols,
+                    sizeof(double), hamming_double_row);
+    pb.w = w;
+    return dist_run_tiles(&pb, workers);
 }
 
 static NPY_INLINE int
 cdist_hamming_char(const char *XA, const char *XB, double *dm,
-                         const npy_intp num_rowsA, const npy_intp num_rowsB,
-                         const npy_intp num_cols,
-                         const double *w)
+                   const npy_intp num_rowsA, const npy_intp num_rowsB,
+                   const npy_intp num_cols, const double *w,
+                   const npy_intp workers)
 {
-    npy_intp i, j;
-
-    for (i = 0; i < num_rowsA; ++i) {
-        const char *u = XA + (num_cols * i);
-        for (j = 0; j < num_rowsB; ++j, ++dm) {
-            const char *v = XB + (num_cols * j);
-            *dm = hamming_distance_char(u, v, num_cols, w);
-        }
-    }
-    return 0;
+    dist_problem pb;
+    dist_init_cdist(&pb, XA, XB, dm, num_rowsA, num_rowsB, num_cols,
+                    sizeof(char), hamming_char_row);
+    pb.w = w;
+    return dist_run_tiles(&pb, workers);
 }
 
 #define DEFINE_CDIST(name, type) \
@@ -763,17 +1532,13 @@ cdist_hamming_char(const char *XA, const char *XB, double *dm,
                                            double *dm,                     \
                                            const npy_intp num_rowsA,       \
                                            const npy_intp num_rowsB,       \
-                                           const npy_intp num_cols)        \
+                                           const npy_intp num_cols,        \
+                                           const npy_intp workers)         \
     {                                                                      \
-        Py_ssize_t i, j;                                                   \
-        for (i = 0; i < num_rowsA; ++i) {                                  \
-            const type *u = XA + num_cols * i;                             \
-            for (j = 0; j < num_rowsB; ++j, ++dm) {                        \
-                const type *v = XB + num_cols * j;                         \
-                *dm = name ## _distance_ ## type(u, v, num_cols);          \
-            }                                                              \
-        }                                                                  \
-        return 0;\
+        dist_problem pb;                                                   \
+        dist_init_cdist(&pb, XA, XB, dm, num_rowsA, num_rowsB, num_cols,   \
+                        sizeof(type), name ## _ ## type ## _row);          \
+        return dist_run_tiles(&pb, workers);                               \
     }
 
 DEFINE_CDIST(bray_curtis, double)
@@ -798,18 +1563,13 @@ DEFINE_CDIST(yule, char)
 #define DEFINE_PDIST(name, type) \
     static int pdist_ ## name ## _ ## type(const type *X, double *dm,       \
                                            const npy_intp num_rows,         \
-                                           const npy_intp num_cols)         \
+                                           const npy_intp num_cols,         \
+                                           const npy_intp workers)          \
     {                                                                       \
-        Py_ssize_t i, j;                                                    \
-        double *it = dm;                                                    \
-        for (i = 0; i < num_rows; ++i) {                                    \
-            const type *u = X + num_cols * i;                               \
-            for (j = i + 1; j < num_rows; ++j, it++) {                      \
-                const type *v = X + num_cols * j;                           \
-                *it = name ## _distance_ ## type(u, v, num_cols);           \
-            }                                                               \
-        }                                                                   \
-        return 0; \
+        dist_problem pb;                                                    \
+        dist_init_pdist(&pb, X, dm, num_rows, num_cols, sizeof(type),       \
+                        name ## _ ## type ## _row);                         \
+        return dist_run_tiles(&pb, workers);                                \
     }
 
 DEFINE_PDIST(bray_curtis, double)
@@ -829,3 +1589,484 @@ DEFINE_PDIST(russellrao, char)
 DEFINE_PDIST(sokalmichener, char)
 DEFINE_PDIST(sokalsneath, char)
 DEFINE_PDIST(yule, char)
+
+
+/*
+ * cdist and pdist of bits64 rows with num_words words and num_bits
+ * features each.
+ */
+#define DEFINE_XDIST_BITS64(name)                                          \
+    static int cdist_ ## name ## _bits64(const bits64 *XA,                 \
+                                         const bits64 *XB, double *dm,     \
+                                         const npy_intp num_rowsA,         \
+                                         const npy_intp num_rowsB,         \
+                                         const npy_intp num_words,         \
+                                         const npy_intp num_bits,          \
+                                         const npy_intp workers)           \
+    {                                                                      \
+        dist_problem pb;                                                   \
+        dist_init_cdist(&pb, XA, XB, dm, num_rowsA, num_rowsB, num_words,  \
+                        sizeof(bits64), name ## _bits64_row);              \
+        pb.num_bits = num_bits;                                            \
+        pb.count = bits64_count_select();                                  \
+        return dist_run_tiles(&pb, workers);                               \
+    }                                                                      \
+                                                                           \
+    static int pdist_ ## name ## _bits64(const bits64 *X, double *dm,     \
+                                         const npy_intp num_rows,          \
+                                         const npy_intp num_words,         \
+                                         const npy_intp num_bits,          \
+                                         const npy_intp workers)           \
+    {                                                                      \
+        dist_problem pb;                                                   \
+        dist_init_pdist(&pb, X, dm, num_rows, num_words, sizeof(bits64),   \
+                        name ## _bits64_row);                              \
+        pb.num_bits = num_bits;                                            \
+        pb.count = bits64_count_select();                                  \
+        return dist_run_tiles(&pb, workers);                               \
+    }
+
+DEFINE_XDIST_BITS64(dice)
+DEFINE_XDIST_BITS64(hamming)
+DEFINE_XDIST_BITS64(jaccard)
+DEFINE_XDIST_BITS64(kulsinski)
+DEFINE_XDIST_BITS64(rogerstanimoto)
+DEFINE_XDIST_BITS64(russellrao)
+DEFINE_XDIST_BITS64(sokalmichener)
+DEFINE_XDIST_BITS64(sokalsneath)
+DEFINE_XDIST_BITS64(yule)
+
+
+/*
+ * cdist and pdist of float32 rows. The distances are summed in double if
+ * acc64 is nonzero, and stored as float32 in dmf if it is not NULL, else
+ * in dm.
+ */
+#define DEFINE_XDIST_FLOAT(name)                                           \
+    static int cdist_ ## name ## _float(const float *XA, const float *XB,  \
+                                        double *dm, float *dmf,            \
+                                        const npy_intp num_rowsA,          \
+                                        const npy_intp num_rowsB,          \
+                                        const npy_intp num_cols,           \
+                                        const int acc64,                   \
+                                        const npy_intp workers)            \
+    {                                                                      \
+        dist_problem pb;                                                   \
+        dist_init_cdist(&pb, XA, XB, dm, num_rowsA, num_rowsB, num_cols,   \
+                        sizeof(float), acc64 ? name ## _acc64_float_row    \
+                                             : name ## _float_row);        \
+        pb.dmf = dmf;                                                      \
+        return dist_run_tiles(&pb, workers);                               \
+    }                                                                      \
+                                                                           \
+    static int pdist_ ## name ## _float(const float *X, double *dm,       \
+                                        float *dmf,                        \
+                                        const npy_intp num_rows,           \
+                                        const npy_intp num_cols,           \
+                                        const int acc64,                   \
+                                        const npy_intp workers)            \
+    {                                                                      \
+        dist_problem pb;                                                   \
+        dist_init_pdist(&pb, X, dm, num_rows, num_cols, sizeof(float),     \
+                        acc64 ? name ## _acc64_float_row                   \
+                              : name ## _float_row);                       \
+        pb.dmf = dmf;                                                      \
+        return dist_run_tiles(&pb, workers);                               \
+    }
+
+DEFINE_XDIST_FLOAT(euclidean)
+DEFINE_XDIST_FLOAT(sqeuclidean)
+
+static NPY_INLINE int
+cdist_minkowski_float(const float *XA, const float *XB, double *dm,
+                      float *dmf, const npy_intp num_rowsA,
+                      const npy_intp num_rowsB, const npy_intp num_cols,
+                      const double p, const int acc64,
+                      const npy_intp workers)
+{
+    dist_problem pb;
+    dist_init_cdist(&pb, XA, XB, dm, num_rowsA, num_rowsB, num_cols,
+                    sizeof(float), acc64 ? minkowski_acc64_float_row
+                                         : minkowski_float_row);
+    pb.dmf = dmf;
+    pb.p = p;
+    return dist_run_tiles(&pb, workers);
+}
+
+static NPY_INLINE int
+pdist_minkowski_float(const float *X, double *dm, float *dmf,
+                      const npy_intp num_rows, const npy_intp num_cols,
+                      const double p, const int acc64,
+                      const npy_intp workers)
+{
+    dist_problem pb;
+    dist_init_pdist(&pb, X, dm, num_rows, num_cols, sizeof(float),
+                    acc64 ? minkowski_acc64_float_row : minkowski_float_row);
+    pb.dmf = dmf;
+    pb.p = p;
+    return dist_run_tiles(&pb, workers);
+}
+
+static NPY_INLINE int
+cdist_cosine_float(const float *XA, const float *XB, double *dm, float *dmf,
+                   const npy_intp num_rowsA, const npy_intp num_rowsB,
+                   const npy_intp num_cols, const int acc64,
+                   const npy_intp workers)
+{
+    dist_problem pb;
+    int status;
+    double *norms_buffA = calloc(num_rowsA + num_rowsB, sizeof(double));
+    double *norms_buffB;
+    if (!norms_buffA)
+        return -1;
+
+    norms_buffB = norms_buffA + num_rowsA;
+    if (acc64) {
+        _row_norms_float_double(XA, num_rowsA, num_cols, norms_buffA);
+        _row_norms_float_double(XB, num_rowsB, num_cols, norms_buffB);
+    }
+    else {
+        _row_norms_float_float(XA, num_rowsA, num_cols, norms_buffA);
+        _row_norms_float_float(XB, num_rowsB, num_cols, norms_buffB);
+    }
+
+    dist_init_cdist(&pb, XA, XB, dm, num_rowsA, num_rowsB, num_cols,
+                    sizeof(float), acc64 ? cosine_acc64_float_row
+                                         : cosine_float_row);
+    pb.dmf = dmf;
+    pb.normsA = norms_buffA;
+    pb.normsB = norms_buffB;
+    status = dist_run_tiles(&pb, workers);
+    free(norms_buffA);
+    return status;
+}
+
+static NPY_INLINE int
+pdist_cosine_float(const float *X, double *dm, float *dmf,
+                   const npy_intp num_rows, const npy_intp num_cols,
+                   const int acc64, const npy_intp workers)
+{
+    dist_problem pb;
+    int status;
+    double *norms_buff = calloc(num_rows, sizeof(double));
+    if (!norms_buff)
+        return -1;
+
+    if (acc64) {
+        _row_norms_float_double(X, num_rows, num_cols, norms_buff);
+    }
+    else {
+        _row_norms_float_float(X, num_rows, num_cols, norms_buff);
+    }
+
+    dist_init_pdist(&pb, X, dm, num_rows, num_cols, sizeof(float),
+                    acc64 ? cosine_acc64_float_row : cosine_float_row);
+    pb.dmf = dmf;
+    pb.normsA = norms_buff;
+    pb.normsB = norms_buff;
+    status = dist_run_tiles(&pb, workers);
+    free(norms_buff);
+    return status;
+}
+
+
+/*
+ * k nearest neighbours
+ * ====================
+ *
+ * cdist_knn keeps the k smallest distances of each row of XA in a max-heap
+ * and, at the end, sorts them into dist[i*k:(i+1)*k] with the matching
+ * rows of XB in index[i*k:(i+1)*k]. Ties go to the smaller index and NaN
+ * distances come last, as with a stable argsort of the full row.
+ */
+typedef struct {
+    dist_sink base;
+    npy_intp k;
+    double *dist;
+    npy_intp *index;
+    npy_intp *count;        /* heap size of each row */
+} dist_knn_sink;
+
+/* Whether (d1, j1) sorts before (d2, j2) */
+static NPY_INLINE int
+dist_knn_before(const double d1, const npy_intp j1, const double d2,
+                const npy_intp j2)
+{
+    if (d1 < d2) {
+        return 1;
+    }
+    if (d1 > d2) {
+        return 0;
+    }
+    if (d1 == d2 || (npy_isnan(d1) && npy_isnan(d2))) {
+        return j1 < j2;
+    }
+    return npy_isnan(d2);
+}
+
+static NPY_INLINE void
+dist_knn_sift_down(double *hd, npy_intp *hj, const npy_intp size,
+                   npy_intp pos)
+{
+    const double d = hd[pos];
+    const npy_intp j = hj[pos];
+
+    for (;;) {
+        npy_intp child = 2 * pos + 1;
+        if (child >= size) {
+            break;
+        }
+        if (child + 1 < size && dist_knn_before(hd[child], hj[child],
+                                                hd[child + 1],
+                                                hj[child + 1])) {
+            ++child;
+        }
+        if (!dist_knn_before(d, j, hd[child], hj[child])) {
+            break;
+        }
+        hd[pos] = hd[child];
+        hj[pos] = hj[child];
+        pos = child;
+    }
+    hd[pos] = d;
+    hj[pos] = j;
+}
+
+static int
+dist_knn_emit(dist_sink *sink, npy_intp bi, npy_intp i, npy_intp j0,
+              npy_intp j1, const double *d)
+{
+    dist_knn_sink *knn = (dist_knn_sink *)sink;
+    const npy_intp k = knn->k;
+    double *hd = knn->dist + k * i;
+    npy_intp *hj = knn->index + k * i;
+    npy_intp size = knn->count[i];
+    npy_intp j;
+    (void)bi;
+
+    for (j = j0; j < j1; ++j, ++d) {
+        if (size < k) {
+            /* sift up */
+            npy_intp pos = size++;
+            while (pos > 0) {
+                const npy_intp parent = (pos - 1) / 2;
+                if (!dist_knn_before(hd[parent], hj[parent], *d, j)) {
+                    break;
+                }
+                hd[pos] = hd[parent];
+                hj[pos] = hj[parent];
+                pos = parent;
+            }
+            hd[pos] = *d;
+            hj[pos] = j;
+        }
+        else if (dist_knn_before(*d, j, hd[0], hj[0])) {
+            hd[0] = *d;
+            hj[0] = j;
+            dist_knn_sift_down(hd, hj, k, 0);
+        }
+    }
+    knn->count[i] = size;
+    return 0;
+}
+
+/*
+ * The k nearest rows of XB of each row of XA under the metric set up in
+ * `pb`, 1 <= k <= pb->num_rowsB. Returns 0, or -1 if memory ran out.
+ */
+static NPY_INLINE int
+cdist_knn(dist_problem *pb, const npy_intp k, double *dist, npy_intp *index,
+          const npy_intp workers)
+{
+    dist_knn_sink knn;
+    npy_intp i, size;
+    int status;
+
+    knn.base.emit = dist_knn_emit;
+    knn.k = k;
+    knn.dist = dist;
+    knn.index = index;
+    knn.count = calloc(pb->num_rowsA + 1, sizeof(npy_intp));
+    if (!knn.count) {
+        return -1;
+    }
+    pb->sink = &knn.base;
+    status = dist_run_tiles(pb, workers);
+    pb->sink = NULL;
+
+    /* heapsort each row */
+    for (i = 0; i < pb->num_rowsA && status == 0; ++i) {
+        double *hd = dist + k * i;
+        npy_intp *hj = index + k * i;
+        for (size = knn.count[i]; size > 1; --size) {
+            const double d = hd[size - 1];
+            const npy_intp j = hj[size - 1];
+            hd[size - 1] = hd[0];
+            hj[size - 1] = hj[0];
+            hd[0] = d;
+            hj[0] = j;
+            dist_knn_sift_down(hd, hj, size - 1, 0);
+        }
+    }
+    free(knn.count);
+    return status;
+}
+
+
+/*
+ * Radius selection
+ * ================
+ *
+ * cdist_radius keeps the pairs with a distance of at most r. Each block of
+ * rows of XA appends its pairs to its own buffer, in the order they are
+ * computed, and dist_radius_collect then sorts them into CSR form.
+ */
+typedef struct {
+    npy_intp *rows;
+    npy_intp *index;
+    double *dist;
+    npy_intp size;
+    npy_intp capacity;
+} dist_radius_block;
+
+typedef struct {
+    dist_sink base;
+    double r;
+    npy_intp num_rows;
+    npy_intp num_blocks;
+    npy_intp *count;        /* number of pairs of each row */
+    dist_radius_block *blocks;
+} dist_radius_sink;
+
+static NPY_INLINE int
+dist_radius_grow(dist_radius_block *b)
+{
+    const npy_intp capacity = b->capacity ? 2 * b->capacity : 256;
+    npy_intp *rows, *index;
+    double *dist;
+
+    rows = realloc(b->rows, capacity * sizeof(npy_intp));
+    if (!rows) {
+        return -1;
+    }
+    b->rows = rows;
+    index = realloc(b->index, capacity * sizeof(npy_intp));
+    if (!index) {
+        return -1;
+    }
+    b->index = index;
+    dist = realloc(b->dist, capacity * sizeof(double));
+    if (!dist) {
+        return -1;
+    }
+    b->dist = dist;
+    b->capacity = capacity;
+    return 0;
+}
+
+static int
+dist_radius_emit(dist_sink *sink, npy_intp bi, npy_intp i, npy_intp j0,
+                 npy_intp j1, const double *d)
+{
+    dist_radius_sink *rs = (dist_radius_sink *)sink;
+    dist_radius_block *b = rs->blocks + bi;
+    const double r = rs->r;
+    npy_intp j;
+
+    for (j = j0; j < j1; ++j, ++d) {
+        if (*d <= r) {
+            if (b->size == b->capacity && dist_radius_grow(b) < 0) {
+                return -1;
+            }
+            b->rows[b->size] = i;
+            b->index[b->size] = j;
+            b->dist[b->size] = *d;
+            ++b->size;
+            ++rs->count[i];
+        }
+    }
+    return 0;
+}
+
+static NPY_INLINE void
+dist_radius_free(dist_radius_sink *rs)
+{
+    npy_intp b;
+    if (rs->blocks) {
+        for (b = 0; b < rs->num_blocks; ++b) {
+            free(rs->blocks[b].rows);
+            free(rs->blocks[b].index);
+            free(rs->blocks[b].dist);
+        }
+    }
+    free(rs->blocks);
+    free(rs->count);
+    rs->blocks = NULL;
+    rs->count = NULL;
+}
+
+/*
+ * Find the pairs of rows of XA and XB under the metric set up in `pb` with
+ * a distance of at most r. On success, returns the number of pairs, which
+ * dist_radius_collect then stores, and rs must be freed with
+ * dist_radius_free either way. Returns -1 if memory ran out.
+ */
+static NPY_INLINE npy_intp
+cdist_radius(dist_problem *pb, dist_radius_sink *rs, const double r,
+             const npy_intp workers)
+{
+    npy_intp i, total = 0;
+    int status;
+
+    memset(rs, 0, sizeof(*rs));
+    rs->base.emit = dist_radius_emit;
+    rs->r = r;
+    rs->num_rows = pb->num_rowsA;
+    rs->num_blocks = (pb->num_rowsA + dist_block_rows(pb->row_bytes) - 1)
+                     / dist_block_rows(pb->row_bytes);
+    rs->count = calloc(pb->num_rowsA + 1, sizeof(npy_intp));
+    rs->blocks = calloc(rs->num_blocks + 1, sizeof(dist_radius_block));
+    if (!rs->count || !rs->blocks) {
+        return -1;
+    }
+    pb->sink = &rs->base;
+    status = dist_run_tiles(pb, workers);
+    pb->sink = NULL;
+    if (status < 0) {
+        return -1;
+    }
+    for (i = 0; i < pb->num_rowsA; ++i) {
+        total += rs->count[i];
+    }
+    return total;
+}
+
+/*
+ * Store the pairs found by cdist_radius as a CSR matrix: indptr has
+ * num_rows + 1 entries, and indices and data one per pair. Within each row
+ * the indices are increasing.
+ */
+static NPY_INLINE void
+dist_radius_collect(const dist_radius_sink *rs, npy_intp *indptr,
+                    npy_intp *indices, double *data)
+{
+    npy_intp i, b, e;
+
+    indptr[0] = 0;
+    for (i = 0; i < rs->num_rows; ++i) {
+        indptr[i + 1] = indptr[i] + rs->count[i];
+    }
+    /* indptr[i] walks through row i while it is filled, then is restored */
+    for (b = 0; b < rs->num_blocks; ++b) {
+        const dist_radius_block *blk = rs->blocks + b;
+        for (e = 0; e < blk->size; ++e) {
+            const npy_intp pos = indptr[blk->rows[e]]++;
+            indices[pos] = blk->index[e];
+            data[pos] = blk->dist[e];
+        }
+    }
+    for (i = rs->num_rows; i > 0; --i) {
+        indptr[i] = indptr[i - 1];
+    }
+    indptr[0] = 0;
+}
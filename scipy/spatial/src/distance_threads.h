@@ -0,0 +1,117 @@
+/*
+ * Minimal portable threads for the pairwise distance engine.
+ *
+ * dist_run_threads runs func(args[k]) for k = 0..nthreads-1, each on its
+ * own thread, and returns when all of them have finished. args[0] always
+ * runs on the calling thread. If a thread cannot be started, its call is
+ * simply dropped, so func must be written such that any one call can do
+ * all of the work (e.g. by claiming tasks from a shared counter).
+ *
+ * The GIL is released while the threads run, so func must not touch any
+ * Python objects.
+ */
+#ifndef DISTANCE_THREADS_H
+#define DISTANCE_THREADS_H
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+
+#include <windows.h>
+#include <process.h>
+
+typedef CRITICAL_SECTION dist_mutex;
+
+#define dist_mutex_init(m) InitializeCriticalSection(m)
+#define dist_mutex_destroy(m) DeleteCriticalSection(m)
+#define dist_mutex_lock(m) EnterCriticalSection(m)
+#define dist_mutex_unlock(m) LeaveCriticalSection(m)
+
+typedef HANDLE dist_thread_handle;
+#define DIST_THREAD_RETURN unsigned __stdcall
+
+#else
+
+#include <pthread.h>
+
+typedef pthread_mutex_t dist_mutex;
+
+#define dist_mutex_init(m) pthread_mutex_init(m, NULL)
+#define dist_mutex_destroy(m) pthread_mutex_destroy(m)
+#define dist_mutex_lock(m) pthread_mutex_lock(m)
+#define dist_mutex_unlock(m) pthread_mutex_unlock(m)
+
+typedef pthread_t dist_thread_handle;
+#define DIST_THREAD_RETURN void *
+
+#endif
+
+typedef void dist_thread_func(void *arg);
+
+typedef struct {
+    dist_thread_func *func;
+    void *arg;
+    dist_thread_handle handle;
+    int started;
+} dist_thread;
+
+static DIST_THREAD_RETURN
+dist_thread_main(void *arg)
+{
+    dist_thread *th = (dist_thread *)arg;
+    th->func(th->arg);
+    return 0;
+}
+
+static NPY_INLINE int
+dist_thread_start(dist_thread *th)
+{
+#ifdef _WIN32
+    th->handle = (HANDLE)_beginthreadex(NULL, 0, dist_thread_main, th, 0,
+                                        NULL);
+    return th->handle != 0;
+#else
+    return pthread_create(&th->handle, NULL, dist_thread_main, th) == 0;
+#endif
+}
+
+static NPY_INLINE void
+dist_thread_join(dist_thread *th)
+{
+#ifdef _WIN32
+    WaitForSingleObject(th->handle, INFINITE);
+    CloseHandle(th->handle);
+#else
+    pthread_join(th->handle, NULL);
+#endif
+}
+
+static NPY_INLINE void
+dist_run_threads(int nthreads, dist_thread_func *func, void **args)
+{
+    dist_thread *threads = NULL;
+    int k;
+
+    if (nthreads > 1) {
+        threads = calloc(nthreads - 1, sizeof(dist_thread));
+    }
+    if (threads) {
+        for (k = 1; k < nthreads; ++k) {
+            dist_thread *th = threads + (k - 1);
+            th->func = func;
+            th->arg = args[k];
+            th->started = dist_thread_start(th);
+        }
+    }
+    func(args[0]);
+    if (threads) {
+        for (k = 1; k < nthreads; ++k) {
+            if (threads[k - 1].started) {
+                dist_thread_join(threads + (k - 1));
+            }
+        }
+        free(threads);
+    }
+}
+
+#endif
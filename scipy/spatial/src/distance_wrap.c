@@ -49,19 +49,24 @@
 #include <numpy/arrayobject.h>
 #include <numpy/npy_math.h>
 
+#include "distance_threads.h"
 #include "distance_impl.h"
 
 #define DEFINE_WRAP_CDIST(name, type)                                   \
     static PyObject *                                                   \
-    cdist_ ## name ## _ ## type ## _wrap(PyObject *self, PyObject *args)\
+    cdist_ ## name ## _ ## type ## _wrap(PyObject *self, PyObject *args,\
+                                         PyObject *kwargs)              \
     {                                                                   \
         PyArrayObject *XA_, *XB_, *dm_;                                 \
-        Py_ssize_t mA, mB, n;                                           \
+        Py_ssize_t mA, mB, n, workers = 1;                              \
         double *dm;                                                     \
         const type *XA, *XB;                                            \
-        if (!PyArg_ParseTuple(args, "O!O!O!",                           \
+        int status;                                                     \
+        static char *kwlist[] = {"XA", "XB", "dm", "workers", NULL};    \
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O!O!|n",      \
+                              kwlist,                                   \
                               &PyArray_Type, &XA_, &PyArray_Type, &XB_, \
-                              &PyArray_Type, &dm_)) {                   \
+                              &PyArray_Type, &dm_, &workers)) {         \
             return NULL;                                                \
         }                                                               \
         else {                                                          \
@@ -72,8 +77,12 @@
             mA = XA_->dimensions[0];                                    \
             mB = XB_->dimensions[0];                                    \
             n = XA_->dimensions[1];                                     \
-            cdist_ ## name ## _ ## type(XA, XB, dm, mA, mB, n);         \
+            status = cdist_ ## name ## _ ## type(XA, XB, dm, mA, mB, n, \
+                                                 workers);              \
             NPY_END_ALLOW_THREADS;                                      \
+            if (status < 0) {                                           \
+                return PyErr_NoMemory();                                \
+            }                                                           \
         }                                                               \
         return Py_BuildValue("d", 0.);                                  \
     }
@@ -100,15 +109,16 @@ static PyObject *cdist_hamming_double_wrap(
                             PyObject *self, PyObject *args, PyObject *kwargs) 
 {
   PyArrayObject *XA_, *XB_, *dm_, *w_;
-  int mA, mB, n;
+  int mA, mB, n, status;
+  Py_ssize_t workers = 1;
   double *dm;
   const double *XA, *XB, *w;
-  static char *kwlist[] = {"XA", "XB", "dm", "w", NULL};
+  static char *kwlist[] = {"XA", "XB", "dm", "w", "workers", NULL};
   if (!PyArg_ParseTupleAndKeywords(args, kwargs, 
-            "O!O!O!O!:cdist_hamming_double_wrap", kwlist,
+            "O!O!O!O!|n:cdist_hamming_double_wrap", kwlist,
             &PyArray_Type, &XA_, &PyArray_Type, &XB_, 
             &PyArray_Type, &dm_,
-            &PyArray_Type, &w_)) {
+            &PyArray_Type, &w_, &workers)) {
     return 0;
   }
   else {
@@ -120,8 +130,10 @@ static PyObject *cdist_hamming_double_wrap(
     mA = XA_->dimensions[0];
     mB = XB_->dimensions[0];
     n = XA_->dimensions[1];
-    cdist_hamming_double(XA, XB, dm, mA, mB, n, w);
+    status = cdist_hamming_double(XA, XB, dm, mA, mB, n, w, workers);
     NPY_END_ALLOW_THREADS;
+    if (status < 0)
+        return PyErr_NoMemory();
   }
   return Py_BuildValue("d", 0.0);
 }
@@ -130,16 +142,17 @@ static PyObject *cdist_hamming_char_wrap(
                             PyObject *self, PyObject *args, PyObject *kwargs) 
 {
   PyArrayObject *XA_, *XB_, *dm_, *w_;
-  int mA, mB, n;
+  int mA, mB, n, status;
+  Py_ssize_t workers = 1;
   double *dm;
   const char *XA, *XB;
   const double *w;
-  static char *kwlist[] = {"XA", "XB", "dm", "w", NULL};
+  static char *kwlist[] = {"XA", "XB", "dm", "w", "workers", NULL};
   if (!PyArg_ParseTupleAndKeywords(args, kwargs, 
-            "O!O!O!O!:cdist_hamming_char_wrap", kwlist,
+            "O!O!O!O!|n:cdist_hamming_char_wrap", kwlist,
             &PyArray_Type, &XA_, &PyArray_Type, &XB_, 
             &PyArray_Type, &dm_,
-            &PyArray_Type, &w_)) {
+            &PyArray_Type, &w_, &workers)) {
     return 0;
   }
   else {
@@ -151,8 +164,10 @@ static PyObject *cdist_hamming_char_wrap(
     mA = XA_->dimensions[0];
     mB = XB_->dimensions[0];
     n = XA_->dimensions[1];
-    cdist_hamming_char(XA, XB, dm, mA, mB, n, w);
+    status = cdist_hamming_char(XA, XB, dm, mA, mB, n, w, workers);
     NPY_END_ALLOW_THREADS;
+    if (status < 0)
+        return PyErr_NoMemory();
   }
   return Py_BuildValue("d", 0.0);
 }
@@ -161,13 +176,14 @@ static PyObject *cdist_cosine_double_wrap(PyObject *self, PyObject *args,
                                                PyObject *kwargs) {
   PyArrayObject *XA_, *XB_, *dm_;
   int mA, mB, n, status;
+  Py_ssize_t workers = 1;
   double *dm;
   const double *XA, *XB;
-  static char *kwlist[] = {"XA", "XB", "dm", NULL};
+  static char *kwlist[] = {"XA", "XB", "dm", "workers", NULL};
   if (!PyArg_ParseTupleAndKeywords(args, kwargs, 
-            "O!O!O!:cdist_cosine_double_wrap", kwlist,
+            "O!O!O!|n:cdist_cosine_double_wrap", kwlist,
             &PyArray_Type, &XA_, &PyArray_Type, &XB_, 
-            &PyArray_Type, &dm_)) 
+            &PyArray_Type, &dm_, &workers))
   {
     return 0;
   }
@@ -181,7 +197,7 @@ static PyObject *cdist_cosine_double_wrap(PyObject *self, PyObject *args,
     mB = XB_->dimensions[0];
     n = XA_->dimensions[1];
 
-    status = cdist_cosine(XA, XB, dm, mA, mB, n);
+    status = cdist_cosine(XA, XB, dm, mA, mB, n, workers);
     NPY_END_THREADS;
     if(status < 0)
         return PyErr_NoMemory();
@@ -193,14 +209,15 @@ static PyObject *cdist_mahalanobis_double_wrap(PyObject *self, PyObject *args,
                                                PyObject *kwargs) {
   PyArrayObject *XA_, *XB_, *covinv_, *dm_;
   int mA, mB, n, status;
+  Py_ssize_t workers = 1;
   double *dm;
   const double *XA, *XB;
   const double *covinv;
-  static char *kwlist[] = {"XA", "XB", "dm", "VI", NULL};
+  static char *kwlist[] = {"XA", "XB", "dm", "VI", "workers", NULL};
   if (!PyArg_ParseTupleAndKeywords(args, kwargs, 
-            "O!O!O!O!:cdist_mahalanobis_double_wrap", kwlist,
+            "O!O!O!O!|n:cdist_mahalanobis_double_wrap", kwlist,
             &PyArray_Type, &XA_, &PyArray_Type, &XB_, 
-            &PyArray_Type, &dm_, &PyArray_Type, &covinv_)) 
+            &PyArray_Type, &dm_, &PyArray_Type, &covinv_, &workers))
   {
     return 0;
   }
@@ -215,7 +232,7 @@ static PyObject *cdist_mahalanobis_double_wrap(PyObject *self, PyObject *args,
     mB = XB_->dimensions[0];
     n = XA_->dimensions[1];
 
-    status = cdist_mahalanobis(XA, XB, dm, mA, mB, n, covinv);
+    status = cdist_mahalanobis(XA, XB, dm, mA, mB, n, covinv, workers);
     NPY_END_THREADS;
     if(status < 0)
         return PyErr_NoMemory();
@@ -227,16 +244,17 @@ static PyObject *cdist_minkowski_double_wrap(PyObject *self, PyObject *args,
                                              PyObject *kwargs) 
 {
   PyArrayObject *XA_, *XB_, *dm_;
-  int mA, mB, n;
+  int mA, mB, n, status;
+  Py_ssize_t workers = 1;
   double *dm;
   const double *XA, *XB;
   double p;
-  static char *kwlist[] = {"XA", "XB", "dm", "p", NULL};
+  static char *kwlist[] = {"XA", "XB", "dm", "p", "workers", NULL};
   if (!PyArg_ParseTupleAndKeywords(args, kwargs, 
-            "O!O!O!d:cdist_minkowski_double_wrap", kwlist,
+            "O!O!O!d|n:cdist_minkowski_double_wrap", kwlist,
             &PyArray_Type, &XA_, &PyArray_Type, &XB_, 
             &PyArray_Type, &dm_,
-            &p)) {
+            &p, &workers)) {
     return 0;
   }
   else {
@@ -247,8 +265,10 @@ static PyObject *cdist_minkowski_double_wrap(PyObject *self, PyObject *args,
     mA = XA_->dimensions[0];
     mB = XB_->dimensions[0];
     n = XA_->dimensions[1];
-    cdist_minkowski(XA, XB, dm, mA, mB, n, p);
+    status = cdist_minkowski(XA, XB, dm, mA, mB, n, p, workers);
     NPY_END_ALLOW_THREADS;
+    if (status < 0)
+        return PyErr_NoMemory();
   }
   return Py_BuildValue("d", 0.0);
 }
@@ -257,14 +277,15 @@ static PyObject *cdist_seuclidean_double_wrap(PyObject *self, PyObject *args,
                                               PyObject *kwargs) 
 {
   PyArrayObject *XA_, *XB_, *dm_, *var_;
-  int mA, mB, n;
+  int mA, mB, n, status;
+  Py_ssize_t workers = 1;
   double *dm;
   const double *XA, *XB, *var;
-  static char *kwlist[] = {"XA", "XB", "dm", "V", NULL};
+  static char *kwlist[] = {"XA", "XB", "dm", "V", "workers", NULL};
   if (!PyArg_ParseTupleAndKeywords(args, kwargs, 
-            "O!O!O!O!:cdist_seuclidean_double_wrap", kwlist,
+            "O!O!O!O!|n:cdist_seuclidean_double_wrap", kwlist,
             &PyArray_Type, &XA_, &PyArray_Type, &XB_, 
-            &PyArray_Type, &dm_, &PyArray_Type, &var_)) {
+            &PyArray_Type, &dm_, &PyArray_Type, &var_, &workers)) {
     return 0;
   }
   else {
@@ -277,8 +298,10 @@ static PyObject *cdist_seuclidean_double_wrap(PyObject *self, PyObject *args,
     mB = XB_->dimensions[0];
     n = XA_->dimensions[1];
 
-    cdist_seuclidean(XA, XB, var, dm, mA, mB, n);
+    status = cdist_seuclidean(XA, XB, var, dm, mA, mB, n, workers);
     NPY_END_ALLOW_THREADS;
+    if (status < 0)
+        return PyErr_NoMemory();
   }
   return Py_BuildValue("d", 0.0);
 }
@@ -287,17 +310,18 @@ static PyObject *cdist_weighted_minkowski_double_wrap(
                             PyObject *self, PyObject *args, PyObject *kwargs) 
 {
   PyArrayObject *XA_, *XB_, *dm_, *w_;
-  int mA, mB, n;
+  int mA, mB, n, status;
+  Py_ssize_t workers = 1;
   double *dm;
   const double *XA, *XB, *w;
   double p;
-  static char *kwlist[] = {"XA", "XB", "dm", "p", "w", NULL};
+  static char *kwlist[] = {"XA", "XB", "dm", "p", "w", "workers", NULL};
   if (!PyArg_ParseTupleAndKeywords(args, kwargs, 
-            "O!O!O!dO!:cdist_weighted_minkowski_double_wrap", kwlist,
+            "O!O!O!dO!|n:cdist_weighted_minkowski_double_wrap", kwlist,
             &PyArray_Type, &XA_, &PyArray_Type, &XB_, 
             &PyArray_Type, &dm_,
             &p,
-            &PyArray_Type, &w_)) {
+            &PyArray_Type, &w_, &workers)) {
     return 0;
   }
   else {
@@ -309,8 +333,239 @@ static PyObject *cdist_weighted_minkowski_double_wrap(
     mA = XA_->dimensions[0];
     mB = XB_->dimensions[0];
     n = XA_->dimensions[1];
-    cdist_weighted_minkowski(XA, XB, dm, mA, mB, n, p, w);
+    status = cdist_weighted_minkowski(XA, XB, dm, mA, mB, n, p, w, workers);
     NPY_END_ALLOW_THREADS;
+    if (status < 0)
+        return PyErr_NoMemory();
+  }
+  return Py_BuildValue("d", 0.0);
+}
+
+#define DEFINE_WRAP_XDIST_BITS64(name)                                  \
+    static PyObject *                                                   \
+    cdist_ ## name ## _bits64_wrap(PyObject *self, PyObject *args,      \
+                                   PyObject *kwargs)                    \
+    {                                                                   \
+        PyArrayObject *XA_, *XB_, *dm_;                                 \
+        Py_ssize_t mA, mB, n, nbits, workers = 1;                       \
+        double *dm;                                                     \
+        const bits64 *XA, *XB;                                          \
+        int status;                                                     \
+        static char *kwlist[] = {"XA", "XB", "dm", "nbits", "workers",  \
+                                 NULL};                                 \
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O!O!n|n",     \
+                              kwlist,                                   \
+                              &PyArray_Type, &XA_, &PyArray_Type, &XB_, \
+                              &PyArray_Type, &dm_, &nbits, &workers)) { \
+            return NULL;                                                \
+        }                                                               \
+        else {                                                          \
+            NPY_BEGIN_ALLOW_THREADS;                                    \
+            XA = (const bits64 *)XA_->data;                             \
+            XB = (const bits64 *)XB_->data;                             \
+            dm = (double *)dm_->data;                                   \
+            mA = XA_->dimensions[0];                                    \
+            mB = XB_->dimensions[0];                                    \
+            n = XA_->dimensions[1];                                     \
+            status = cdist_ ## name ## _bits64(XA, XB, dm, mA, mB, n,   \
+                                               nbits, workers);         \
+            NPY_END_ALLOW_THREADS;                                      \
+            if (status < 0) {                                           \
+                return PyErr_NoMemory();                                \
+            }                                                           \
+        }                                                               \
+        return Py_BuildValue("d", 0.);                                  \
+    }                                                                   \
+                                                                        \
+    static PyObject *                                                   \
+    pdist_ ## name ## _bits64_wrap(PyObject *self, PyObject *args,      \
+                                   PyObject *kwargs)                    \
+    {                                                                   \
+        PyArrayObject *X_, *dm_;                                        \
+        Py_ssize_t m, n, nbits, workers = 1;                            \
+        double *dm;                                                     \
+        const bits64 *X;                                                \
+        int status;                                                     \
+        static char *kwlist[] = {"X", "dm", "nbits", "workers", NULL};  \
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O!n|n",       \
+                                         kwlist,                        \
+                                         &PyArray_Type, &X_,            \
+                                         &PyArray_Type, &dm_,           \
+                                         &nbits, &workers)) {           \
+            return NULL;                                                \
+        }                                                               \
+        else {                                                          \
+            NPY_BEGIN_ALLOW_THREADS;                                    \
+            X = (const bits64 *)X_->data;                               \
+            dm = (double *)dm_->data;                                   \
+            m = X_->dimensions[0];                                      \
+            n = X_->dimensions[1];                                      \
+            status = pdist_ ## name ## _bits64(X, dm, m, n, nbits,      \
+                                               workers);                \
+            NPY_END_ALLOW_THREADS;                                      \
+            if (status < 0) {                                           \
+                return PyErr_NoMemory();                                \
+            }                                                           \
+        }                                                               \
+        return Py_BuildValue("d", 0.);                                  \
+    }
+
+DEFINE_WRAP_XDIST_BITS64(dice)
+DEFINE_WRAP_XDIST_BITS64(hamming)
+DEFINE_WRAP_XDIST_BITS64(jaccard)
+DEFINE_WRAP_XDIST_BITS64(kulsinski)
+DEFINE_WRAP_XDIST_BITS64(rogerstanimoto)
+DEFINE_WRAP_XDIST_BITS64(russellrao)
+DEFINE_WRAP_XDIST_BITS64(sokalmichener)
+DEFINE_WRAP_XDIST_BITS64(sokalsneath)
+DEFINE_WRAP_XDIST_BITS64(yule)
+
+/*
+ * float32 observations. dm may be float64 or float32, and the distances
+ * are summed in double if acc64 is nonzero.
+ */
+#define DEFINE_WRAP_XDIST_FLOAT(name)                                   \
+    static PyObject *                                                   \
+    cdist_ ## name ## _float_wrap(PyObject *self, PyObject *args,       \
+                                  PyObject *kwargs)                     \
+    {                                                                   \
+        PyArrayObject *XA_, *XB_, *dm_;                                 \
+        Py_ssize_t mA, mB, n, workers = 1;                              \
+        double *dm;                                                     \
+        float *dmf;                                                     \
+        const float *XA, *XB;                                           \
+        int acc64 = 1, status;                                          \
+        static char *kwlist[] = {"XA", "XB", "dm", "acc64", "workers",  \
+                                 NULL};                                 \
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O!O!|in",     \
+                              kwlist,                                   \
+                              &PyArray_Type, &XA_, &PyArray_Type, &XB_, \
+                              &PyArray_Type, &dm_, &acc64, &workers)) { \
+            return NULL;                                                \
+        }                                                               \
+        else {                                                          \
+            NPY_BEGIN_ALLOW_THREADS;                                    \
+            XA = (const float *)XA_->data;                              \
+            XB = (const float *)XB_->data;                              \
+            dmf = PyArray_TYPE(dm_) == NPY_FLOAT ? (float *)dm_->data   \
+                                                 : NULL;                \
+            dm = dmf ? NULL : (double *)dm_->data;                      \
+            mA = XA_->dimensions[0];                                    \
+            mB = XB_->dimensions[0];                                    \
+            n = XA_->dimensions[1];                                     \
+            status = cdist_ ## name ## _float(XA, XB, dm, dmf, mA, mB,  \
+                                              n, acc64, workers);       \
+            NPY_END_ALLOW_THREADS;                                      \
+            if (status < 0) {                                           \
+                return PyErr_NoMemory();                                \
+            }                                                           \
+        }                                                               \
+        return Py_BuildValue("d", 0.);                                  \
+    }                                                                   \
+                                                                        \
+    static PyObject *                                                   \
+    pdist_ ## name ## _float_wrap(PyObject *self, PyObject *args,       \
+                                  PyObject *kwargs)                     \
+    {                                                                   \
+        PyArrayObject *X_, *dm_;                                        \
+        Py_ssize_t m, n, workers = 1;                                   \
+        double *dm;                                                     \
+        float *dmf;                                                     \
+        const float *X;                                                 \
+        int acc64 = 1, status;                                          \
+        static char *kwlist[] = {"X", "dm", "acc64", "workers", NULL};  \
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O!|in",       \
+                                         kwlist,                        \
+                                         &PyArray_Type, &X_,            \
+                                         &PyArray_Type, &dm_,           \
+                                         &acc64, &workers)) {           \
+            return NULL;                                                \
+        }                                                               \
+        else {                                                          \
+            NPY_BEGIN_ALLOW_THREADS;                                    \
+            X = (const float *)X_->data;                                \
+            dmf = PyArray_TYPE(dm_) == NPY_FLOAT ? (float *)dm_->data   \
+                                                 : NULL;                \
+            dm = dmf ? NULL : (double *)dm_->data;                      \
+            m = X_->dimensions[0];                                      \
+            n = X_->dimensions[1];                                      \
+            status = pdist_ ## name ## _float(X, dm, dmf, m, n, acc64,  \
+                                              workers);                 \
+            NPY_END_ALLOW_THREADS;                                      \
+            if (status < 0) {                                           \
+                return PyErr_NoMemory();                                \
+            }                                                           \
+        }                                                               \
+        return Py_BuildValue("d", 0.);                                  \
+    }
+
+DEFINE_WRAP_XDIST_FLOAT(cosine)
+DEFINE_WRAP_XDIST_FLOAT(euclidean)
+DEFINE_WRAP_XDIST_FLOAT(sqeuclidean)
+
+static PyObject *cdist_minkowski_float_wrap(PyObject *self, PyObject *args,
+                                            PyObject *kwargs)
+{
+  PyArrayObject *XA_, *XB_, *dm_;
+  Py_ssize_t mA, mB, n, workers = 1;
+  double *dm;
+  float *dmf;
+  const float *XA, *XB;
+  double p;
+  int acc64 = 1, status;
+  static char *kwlist[] = {"XA", "XB", "dm", "p", "acc64", "workers", NULL};
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs,
+            "O!O!O!d|in:cdist_minkowski_float_wrap", kwlist,
+            &PyArray_Type, &XA_, &PyArray_Type, &XB_,
+            &PyArray_Type, &dm_, &p, &acc64, &workers)) {
+    return 0;
+  }
+  else {
+    NPY_BEGIN_ALLOW_THREADS;
+    XA = (const float*)XA_->data;
+    XB = (const float*)XB_->data;
+    dmf = PyArray_TYPE(dm_) == NPY_FLOAT ? (float*)dm_->data : NULL;
+    dm = dmf ? NULL : (double*)dm_->data;
+    mA = XA_->dimensions[0];
+    mB = XB_->dimensions[0];
+    n = XA_->dimensions[1];
+    status = cdist_minkowski_float(XA, XB, dm, dmf, mA, mB, n, p, acc64,
+                                   workers);
+    NPY_END_ALLOW_THREADS;
+    if (status < 0)
+        return PyErr_NoMemory();
+  }
+  return Py_BuildValue("d", 0.0);
+}
+
+static PyObject *pdist_minkowski_float_wrap(PyObject *self, PyObject *args,
+                                            PyObject *kwargs)
+{
+  PyArrayObject *X_, *dm_;
+  Py_ssize_t m, n, workers = 1;
+  double *dm;
+  float *dmf;
+  const float *X;
+  double p;
+  int acc64 = 1, status;
+  static char *kwlist[] = {"X", "dm", "p", "acc64", "workers", NULL};
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs,
+            "O!O!d|in:pdist_minkowski_float_wrap", kwlist,
+            &PyArray_Type, &X_,
+            &PyArray_Type, &dm_, &p, &acc64, &workers)) {
+    return 0;
+  }
+  else {
+    NPY_BEGIN_ALLOW_THREADS;
+    X = (const float*)X_->data;
+    dmf = PyArray_TYPE(dm_) == NPY_FLOAT ? (float*)dm_->data : NULL;
+    dm = dmf ? NULL : (double*)dm_->data;
+    m = X_->dimensions[0];
+    n = X_->dimensions[1];
+    status = pdist_minkowski_float(X, dm, dmf, m, n, p, acc64, workers);
+    NPY_END_ALLOW_THREADS;
+    if (status < 0)
+        return PyErr_NoMemory();
   }
   return Py_BuildValue("d", 0.0);
 }
@@ -319,14 +574,19 @@ static PyObject *cdist_weighted_minkowski_double_wrap(
 
 #define DEFINE_WRAP_PDIST(name, type)                                   \
     static PyObject *                                                   \
-    pdist_ ## name ## _ ## type ## _wrap(PyObject *self, PyObject *args)\
+    pdist_ ## name ## _ ## type ## _wrap(PyObject *self, PyObject *args,\
+                                         PyObject *kwargs)              \
     {                                                                   \
         PyArrayObject *X_, *dm_;                                        \
-        Py_ssize_t m, n;                                                \
+        Py_ssize_t m, n, workers = 1;                                   \
         double *dm;                                                     \
         const type *X;                                                  \
-        if (!PyArg_ParseTuple(args, "O!O!", &PyArray_Type, &X_,         \
-                                            &PyArray_Type, &dm_)) {     \
+        int status;                                                     \
+        static char *kwlist[] = {"X", "dm", "workers", NULL};           \
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O!|n", kwlist,\
+                                         &PyArray_Type, &X_,            \
+                                         &PyArray_Type, &dm_,           \
+                                         &workers)) {                   \
             return NULL;                                                \
         }                                                               \
         else {                                                          \
@@ -335,8 +595,11 @@ static PyObject *cdist_weighted_minkowski_double_wrap(
             dm = (double *)dm_->data;                                   \
             m = X_->dimensions[0];                                      \
             n = X_->dimensions[1];                                      \
-            pdist_ ## name ## _ ## type(X, dm, m, n);                   \
+            status = pdist_ ## name ## _ ## type(X, dm, m, n, workers); \
             NPY_END_ALLOW_THREADS;                                      \
+            if (status < 0) {                                           \
+                return PyErr_NoMemory();                                \
+            }                                                           \
         }                                                               \
         return Py_BuildValue("d", 0.);                                  \
     }
@@ -363,15 +626,16 @@ static PyObject *pdist_hamming_double_wrap(
                             PyObject *self, PyObject *args, PyObject *kwargs) 
 {
   PyArrayObject *X_, *dm_, *w_;
-  int m, n;
+  int m, n, status;
+  Py_ssize_t workers = 1;
   double *dm;
   const double *X, *w;
-  static char *kwlist[] = {"X", "dm", "w", NULL};
+  static char *kwlist[] = {"X", "dm", "w", "workers", NULL};
   if (!PyArg_ParseTupleAndKeywords(args, kwargs, 
-            "O!O!O!:pdist_hamming_double_wrap", kwlist,
+            "O!O!O!|n:pdist_hamming_double_wrap", kwlist,
             &PyArray_Type, &X_,
             &PyArray_Type, &dm_,
-            &PyArray_Type, &w_)) {
+            &PyArray_Type, &w_, &workers)) {
     return 0;
   }
   else {
@@ -382,8 +646,10 @@ static PyObject *pdist_hamming_double_wrap(
     m = X_->dimensions[0];
     n = X_->dimensions[1];
 
-    pdist_hamming_double(X, dm, m, n, w);
+    status = pdist_hamming_double(X, dm, m, n, w, workers);
     NPY_END_ALLOW_THREADS;
+    if (status < 0)
+        return PyErr_NoMemory();
   }
   return Py_BuildValue("d", 0.0);
 }
@@ -392,16 +658,17 @@ static PyObject *pdist_hamming_char_wrap(
                             PyObject *self, PyObject *args, PyObject *kwargs) 
 {
   PyArrayObject *X_, *dm_, *w_;
-  int m, n;
+  int m, n, status;
+  Py_ssize_t workers = 1;
   const char *X;
   const double *w;
   double *dm;
-  static char *kwlist[] = {"X", "dm", "w", NULL};
+  static char *kwlist[] = {"X", "dm", "w", "workers", NULL};
   if (!PyArg_ParseTupleAndKeywords(args, kwargs, 
-            "O!O!O!:pdist_hamming_char_wrap", kwlist,
+            "O!O!O!|n:pdist_hamming_char_wrap", kwlist,
             &PyArray_Type, &X_,
             &PyArray_Type, &dm_,
-            &PyArray_Type, &w_)) {
+            &PyArray_Type, &w_, &workers)) {
     return 0;
   }
   else {
@@ -412,8 +679,10 @@ static PyObject *pdist_hamming_char_wrap(
     m = X_->dimensions[0];
     n = X_->dimensions[1];
 
-    pdist_hamming_char(X, dm, m, n, w);
+    status = pdist_hamming_char(X, dm, m, n, w, workers);
     NPY_END_ALLOW_THREADS;
+    if (status < 0)
+        return PyErr_NoMemory();
   }
   return Py_BuildValue("d", 0.0);
 }
@@ -423,13 +692,14 @@ static PyObject *pdist_cosine_double_wrap(PyObject *self, PyObject *args,
 {
   PyArrayObject *X_, *dm_;
   int m, n, status;
+  Py_ssize_t workers = 1;
   double *dm;
   const double *X;
-  static char *kwlist[] = {"X", "dm", NULL};
+  static char *kwlist[] = {"X", "dm", "workers", NULL};
   if (!PyArg_ParseTupleAndKeywords(args, kwargs, 
-            "O!O!:pdist_cosine_double_wrap", kwlist,
+            "O!O!|n:pdist_cosine_double_wrap", kwlist,
             &PyArray_Type, &X_,
-            &PyArray_Type, &dm_)) {
+            &PyArray_Type, &dm_, &workers)) {
     return 0;
   }
   else {
@@ -440,7 +710,7 @@ static PyObject *pdist_cosine_double_wrap(PyObject *self, PyObject *args,
     m = X_->dimensions[0];
     n = X_->dimensions[1];
     
-    status = pdist_cosine(X, dm, m, n);
+    status = pdist_cosine(X, dm, m, n, workers);
     NPY_END_THREADS;
     if(status < 0)
         return PyErr_NoMemory();
@@ -452,15 +722,16 @@ static PyObject *pdist_mahalanobis_double_wrap(PyObject *self, PyObject *args,
                                                PyObject *kwargs) {
   PyArrayObject *X_, *covinv_, *dm_;
   int m, n, status;
+  Py_ssize_t workers = 1;
   double *dm;
   const double *X;
   const double *covinv;
-  static char *kwlist[] = {"X", "dm", "VI", NULL};
+  static char *kwlist[] = {"X", "dm", "VI", "workers", NULL};
   if (!PyArg_ParseTupleAndKeywords(args, kwargs, 
-            "O!O!O!:pdist_mahalanobis_double_wrap", kwlist,
+            "O!O!O!|n:pdist_mahalanobis_double_wrap", kwlist,
             &PyArray_Type, &X_,
             &PyArray_Type, &dm_, 
-            &PyArray_Type, &covinv_)) {
+            &PyArray_Type, &covinv_, &workers)) {
     return 0;
   }
   else {
@@ -472,7 +743,7 @@ static PyObject *pdist_mahalanobis_double_wrap(PyObject *self, PyObject *args,
     m = X_->dimensions[0];
     n = X_->dimensions[1];
 
-    status = pdist_mahalanobis(X, dm, m, n, covinv);
+    status = pdist_mahalanobis(X, dm, m, n, covinv, workers);
     NPY_END_THREADS;
     if(status < 0)
         return PyErr_NoMemory();
@@ -484,15 +755,16 @@ static PyObject *pdist_minkowski_double_wrap(PyObject *self, PyObject *args,
                                              PyObject *kwargs) 
 {
   PyArrayObject *X_, *dm_;
-  int m, n;
+  int m, n, status;
+  Py_ssize_t workers = 1;
   double *dm, *X;
   double p;
-  static char *kwlist[] = {"X", "dm", "p", NULL};
+  static char *kwlist[] = {"X", "dm", "p", "workers", NULL};
   if (!PyArg_ParseTupleAndKeywords(args, kwargs, 
-            "O!O!d:pdist_minkowski_double_wrap", kwlist,
+            "O!O!d|n:pdist_minkowski_double_wrap", kwlist,
             &PyArray_Type, &X_,
             &PyArray_Type, &dm_,
-            &p)) {
+            &p, &workers)) {
     return 0;
   }
   else {
@@ -502,8 +774,10 @@ static PyObject *pdist_minkowski_double_wrap(PyObject *self, PyObject *args,
     m = X_->dimensions[0];
     n = X_->dimensions[1];
 
-    pdist_minkowski(X, dm, m, n, p);
+    status = pdist_minkowski(X, dm, m, n, p, workers);
     NPY_END_ALLOW_THREADS;
+    if (status < 0)
+        return PyErr_NoMemory();
   }
   return Py_BuildValue("d", 0.0);
 }
@@ -512,15 +786,16 @@ static PyObject *pdist_seuclidean_double_wrap(PyObject *self, PyObject *args,
                                               PyObject *kwargs) 
 {
   PyArrayObject *X_, *dm_, *var_;
-  int m, n;
+  int m, n, status;
+  Py_ssize_t workers = 1;
   double *dm;
   const double *X, *var;
-  static char *kwlist[] = {"X", "dm", "V", NULL};
+  static char *kwlist[] = {"X", "dm", "V", "workers", NULL};
   if (!PyArg_ParseTupleAndKeywords(args, kwargs, 
-            "O!O!O!:pdist_seuclidean_double_wrap", kwlist,
+            "O!O!O!|n:pdist_seuclidean_double_wrap", kwlist,
             &PyArray_Type, &X_,
             &PyArray_Type, &dm_,
-            &PyArray_Type, &var_)) {
+            &PyArray_Type, &var_, &workers)) {
     return 0;
   }
   else {
@@ -531,8 +806,10 @@ static PyObject *pdist_seuclidean_double_wrap(PyObject *self, PyObject *args,
     m = X_->dimensions[0];
     n = X_->dimensions[1];
 
-    pdist_seuclidean(X, var, dm, m, n);
+    status = pdist_seuclidean(X, var, dm, m, n, workers);
     NPY_END_ALLOW_THREADS;
+    if (status < 0)
+        return PyErr_NoMemory();
   }
   return Py_BuildValue("d", 0.0);
 }
@@ -541,16 +818,17 @@ static PyObject *pdist_weighted_minkowski_double_wrap(
                             PyObject *self, PyObject *args, PyObject *kwargs) 
 {
   PyArrayObject *X_, *dm_, *w_;
-  int m, n;
+  int m, n, status;
+  Py_ssize_t workers = 1;
   double *dm, *X, *w;
   double p;
-  static char *kwlist[] = {"X", "dm", "p", "w", NULL};
+  static char *kwlist[] = {"X", "dm", "p", "w", "workers", NULL};
   if (!PyArg_ParseTupleAndKeywords(args, kwargs, 
-            "O!O!dO!:pdist_weighted_minkowski_double_wrap", kwlist,
+            "O!O!dO!|n:pdist_weighted_minkowski_double_wrap", kwlist,
             &PyArray_Type, &X_,
             &PyArray_Type, &dm_,
             &p,
-            &PyArray_Type, &w_)) {
+            &PyArray_Type, &w_, &workers)) {
     return 0;
   }
   else {
@@ -561,45 +839,272 @@ static PyObject *pdist_weighted_minkowski_double_wrap(
     m = X_->dimensions[0];
     n = X_->dimensions[1];
 
-    pdist_weighted_minkowski(X, dm, m, n, p, w);
+    status = pdist_weighted_minkowski(X, dm, m, n, p, w, workers);
     NPY_END_ALLOW_THREADS;
+    if (status < 0)
+        return PyErr_NoMemory();
   }
   return Py_BuildValue("d", 0.0);
 }
 
 
-static PyObject *to_squareform_from_vector_wrap(PyObject *self, PyObject *args) 
+/*
+ * cdist_knn_wrap and cdist_radius_wrap take the metric by name and look it
+ * up in this table. Correlation is cosine of centered rows and is left to
+ * the caller.
+ */
+enum {
+    DIST_PARAM_NONE,
+    DIST_PARAM_P,       /* minkowski exponent p */
+    DIST_PARAM_V,       /* variances of seuclidean in w */
+    DIST_PARAM_VI,      /* inverse covariance of mahalanobis in w */
+    DIST_PARAM_NORMS    /* row norms of cosine */
+};
+
+typedef struct {
+    const char *name;
+    int type_num;
+    dist_row_func *row;
+    dist_row_func *row_acc64;   /* float32 rows summed in double */
+    int param;
+} dist_metric;
+
+static const dist_metric dist_metrics[] = {
+  {"braycurtis", NPY_DOUBLE, bray_curtis_double_row, NULL, DIST_PARAM_NONE},
+  {"canberra", NPY_DOUBLE, canberra_double_row, NULL, DIST_PARAM_NONE},
+  {"chebyshev", NPY_DOUBLE, chebyshev_double_row, NULL, DIST_PARAM_NONE},
+  {"cityblock", NPY_DOUBLE, city_block_double_row, NULL, DIST_PARAM_NONE},
+  {"cosine", NPY_DOUBLE, cosine_double_row, NULL, DIST_PARAM_NORMS},
+  {"euclidean", NPY_DOUBLE, euclidean_double_row, NULL, DIST_PARAM_NONE},
+  {"jensenshannon", NPY_DOUBLE, jensenshannon_double_row, NULL,
+   DIST_PARAM_NONE},
+  {"mahalanobis", NPY_DOUBLE, mahalanobis_double_row, NULL, DIST_PARAM_VI},
+  {"minkowski", NPY_DOUBLE, minkowski_double_row, NULL, DIST_PARAM_P},
+  {"seuclidean", NPY_DOUBLE, seuclidean_double_row, NULL, DIST_PARAM_V},
+  {"sqeuclidean", NPY_DOUBLE, sqeuclidean_double_row, NULL, DIST_PARAM_NONE},
+  {"cosine", NPY_FLOAT, cosine_float_row, cosine_acc64_float_row,
+   DIST_PARAM_NORMS},
+  {"euclidean", NPY_FLOAT, euclidean_float_row, euclidean_acc64_float_row,
+   DIST_PARAM_NONE},
+  {"minkowski", NPY_FLOAT, minkowski_float_row, minkowski_acc64_float_row,
+   DIST_PARAM_P},
+  {"sqeuclidean", NPY_FLOAT, sqeuclidean_float_row,
+   sqeuclidean_acc64_float_row, DIST_PARAM_NONE},
+  {NULL, 0, NULL, NULL, DIST_PARAM_NONE}
+};
+
+/*
+ * Set up pb for the distances between the rows of XA_ and XB_ under the
+ * metric `name`. Returns the metric, or NULL with an exception set.
+ */
+static const dist_metric *
+dist_setup_metric(dist_problem *pb, const char *name, PyArrayObject *XA_,
+                  PyArrayObject *XB_, const double p, PyArrayObject *w_,
+                  const int acc64)
+{
+    const dist_metric *info;
+    const npy_intp n = XA_->dimensions[1];
+
+    for (info = dist_metrics; info->name; ++info) {
+        if (strcmp(info->name, name) == 0 &&
+                info->type_num == PyArray_TYPE(XA_)) {
+            break;
+        }
+    }
+    if (!info->name) {
+        PyErr_Format(PyExc_ValueError,
+                     "metric %s is not supported for this input", name);
+        return NULL;
+    }
+    dist_init_cdist(pb, XA_->data, XB_->data, NULL, XA_->dimensions[0],
+                    XB_->dimensions[0], n, PyArray_ITEMSIZE(XA_),
+                    acc64 && info->row_acc64 ? info->row_acc64 : info->row);
+    switch (info->param) {
+    case DIST_PARAM_P:
+        pb->p = p;
+        break;
+    case DIST_PARAM_VI:
+        pb->scratch_size = 2 * n;
+        /* fall through */
+    case DIST_PARAM_V:
+        if (!w_) {
+            PyErr_Format(PyExc_ValueError, "metric %s needs w", name);
+            return NULL;
+        }
+        pb->w = (const double *)w_->data;
+        break;
+    }
+    return info;
+}
+
+/*
+ * Compute the row norms of a cosine problem into *norms, which the caller
+ * frees. Returns 0, or -1 if memory ran out.
+ */
+static int
+dist_setup_norms(dist_problem *pb, const dist_metric *info, const int acc64,
+                 double **norms)
+{
+    const npy_intp mA = pb->num_rowsA, mB = pb->num_rowsB;
+    const npy_intp n = pb->num_cols;
+
+    *norms = NULL;
+    if (info->param != DIST_PARAM_NORMS) {
+        return 0;
+    }
+    *norms = calloc(mA + mB + 1, sizeof(double));
+    if (!*norms) {
+        return -1;
+    }
+    if (info->type_num == NPY_DOUBLE) {
+        _row_norms((const double *)pb->XA, mA, n, *norms);
+        _row_norms((const double *)pb->XB, mB, n, *norms + mA);
+    }
+    else if (acc64) {
+        _row_norms_float_double((const float *)pb->XA, mA, n, *norms);
+        _row_norms_float_double((const float *)pb->XB, mB, n, *norms + mA);
+    }
+    else {
+        _row_norms_float_float((const float *)pb->XA, mA, n, *norms);
+        _row_norms_float_float((const float *)pb->XB, mB, n, *norms + mA);
+    }
+    pb->normsA = *norms;
+    pb->normsB = *norms + mA;
+    return 0;
+}
+
+static PyObject *cdist_knn_wrap(PyObject *self, PyObject *args,
+                                PyObject *kwargs)
+{
+  PyArrayObject *XA_, *XB_, *dist_, *index_, *w_ = NULL;
+  const char *metric;
+  const dist_metric *info;
+  dist_problem pb;
+  double p = 2., *norms;
+  int acc64 = 1, status;
+  Py_ssize_t workers = 1;
+  static char *kwlist[] = {"XA", "XB", "metric", "dist", "index", "p", "w",
+                           "acc64", "workers", NULL};
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs,
+            "O!O!sO!O!|dO!in:cdist_knn_wrap", kwlist,
+            &PyArray_Type, &XA_, &PyArray_Type, &XB_, &metric,
+            &PyArray_Type, &dist_, &PyArray_Type, &index_, &p,
+            &PyArray_Type, &w_, &acc64, &workers)) {
+    return 0;
+  }
+  info = dist_setup_metric(&pb, metric, XA_, XB_, p, w_, acc64);
+  if (!info) {
+    return 0;
+  }
+  else {
+    NPY_BEGIN_THREADS_DEF;
+    NPY_BEGIN_THREADS;
+    status = dist_setup_norms(&pb, info, acc64, &norms);
+    if (status == 0) {
+      status = cdist_knn(&pb, dist_->dimensions[1], (double*)dist_->data,
+                         (npy_intp*)index_->data, workers);
+    }
+    free(norms);
+    NPY_END_THREADS;
+    if (status < 0)
+        return PyErr_NoMemory();
+  }
+  return Py_BuildValue("d", 0.0);
+}
+
+static PyObject *cdist_radius_wrap(PyObject *self, PyObject *args,
+                                   PyObject *kwargs)
+{
+  PyArrayObject *XA_, *XB_, *w_ = NULL;
+  PyArrayObject *indptr_ = NULL, *indices_ = NULL, *data_ = NULL;
+  const char *metric;
+  const dist_metric *info;
+  dist_problem pb;
+  dist_radius_sink rs;
+  double r, p = 2., *norms;
+  int acc64 = 1;
+  npy_intp total, size;
+  Py_ssize_t workers = 1;
+  static char *kwlist[] = {"XA", "XB", "metric", "r", "p", "w", "acc64",
+                           "workers", NULL};
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs,
+            "O!O!sd|dO!in:cdist_radius_wrap", kwlist,
+            &PyArray_Type, &XA_, &PyArray_Type, &XB_, &metric, &r, &p,
+            &PyArray_Type, &w_, &acc64, &workers)) {
+    return 0;
+  }
+  info = dist_setup_metric(&pb, metric, XA_, XB_, p, w_, acc64);
+  if (!info) {
+    return 0;
+  }
+  else {
+    NPY_BEGIN_THREADS_DEF;
+    NPY_BEGIN_THREADS;
+    total = -1;
+    memset(&rs, 0, sizeof(rs));
+    if (dist_setup_norms(&pb, info, acc64, &norms) == 0) {
+      total = cdist_radius(&pb, &rs, r, workers);
+    }
+    free(norms);
+    NPY_END_THREADS;
+    if (total < 0) {
+      dist_radius_free(&rs);
+      return PyErr_NoMemory();
+    }
+
+    size = pb.num_rowsA + 1;
+    indptr_ = (PyArrayObject *)PyArray_SimpleNew(1, &size, NPY_INTP);
+    indices_ = (PyArrayObject *)PyArray_SimpleNew(1, &total, NPY_INTP);
+    data_ = (PyArrayObject *)PyArray_SimpleNew(1, &total, NPY_DOUBLE);
+    if (!indptr_ || !indices_ || !data_) {
+      dist_radius_free(&rs);
+      Py_XDECREF(indptr_);
+      Py_XDECREF(indices_);
+      Py_XDECREF(data_);
+      return 0;
+    }
+    NPY_BEGIN_THREADS;
+    dist_radius_collect(&rs, (npy_intp*)indptr_->data,
+                        (npy_intp*)indices_->data, (double*)data_->data);
+    dist_radius_free(&rs);
+    NPY_END_THREADS;
+  }
+  return Py_BuildValue("NNN", indptr_, indices_, data_);
+}
+
+static PyObject *to_squareform_from_vector_wrap(PyObject *self, PyObject *args,
+                                                PyObject *kwargs)
 {
   PyArrayObject *M_, *v_;
-  int n, elsize;
-  if (!PyArg_ParseTuple(args, "O!O!",
+  Py_ssize_t n, elsize, workers = 1;
+  static char *kwlist[] = {"M", "v", "workers", NULL};
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs,
+            "O!O!|n:to_squareform_from_vector_wrap", kwlist,
             &PyArray_Type, &M_,
-            &PyArray_Type, &v_)) {
+            &PyArray_Type, &v_, &workers)) {
     return 0;
   }
   NPY_BEGIN_ALLOW_THREADS;
   n = M_->dimensions[0];
   elsize = M_->descr->elsize;
-  if (elsize == 8) {
-    dist_to_squareform_from_vector_double(
-        (double*)M_->data, (const double*)v_->data, n);
-  } else {
-    dist_to_squareform_from_vector_generic(
-        (char*)M_->data, (const char*)v_->data, n, elsize);
-  }
+  dist_to_squareform_from_vector((char*)M_->data, (const char*)v_->data, n,
+                                 elsize, workers);
   NPY_END_ALLOW_THREADS;
   return Py_BuildValue("");
 }
 
-static PyObject *to_vector_from_squareform_wrap(PyObject *self, PyObject *args) 
+static PyObject *to_vector_from_squareform_wrap(PyObject *self, PyObject *args,
+                                                PyObject *kwargs)
 {
   PyArrayObject *M_, *v_;
-  int n, s;
+  Py_ssize_t n, s, workers = 1;
   char *v;
   const char *M;
-  if (!PyArg_ParseTuple(args, "O!O!",
+  static char *kwlist[] = {"M", "v", "workers", NULL};
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs,
+            "O!O!|n:to_vector_from_squareform_wrap", kwlist,
             &PyArray_Type, &M_,
-            &PyArray_Type, &v_)) {
+            &PyArray_Type, &v_, &workers)) {
     return 0;
   }
   else {
@@ -608,38 +1113,54 @@ static PyObject *to_vector_from_squareform_wrap(PyObject *self, PyObject *args)
     v = (char*)v_->data;
     n = M_->dimensions[0];
     s = M_->descr->elsize;
-    dist_to_vector_from_squareform(M, v, n, s);
+    dist_to_vector_from_squareform(M, v, n, s, workers);
     NPY_END_ALLOW_THREADS;
   }
   return Py_BuildValue("");
 }
 
+static PyObject *condensed_argmin_wrap(PyObject *self, PyObject *args)
+{
+  PyArrayObject *y_, *mins_, *args_;
+  if (!PyArg_ParseTuple(args, "O!O!O!",
+            &PyArray_Type, &y_,
+            &PyArray_Type, &mins_,
+            &PyArray_Type, &args_)) {
+    return 0;
+  }
+  NPY_BEGIN_ALLOW_THREADS;
+  dist_condensed_argmin((const double*)y_->data, mins_->dimensions[0],
+                        (double*)mins_->data, (npy_intp*)args_->data);
+  NPY_END_ALLOW_THREADS;
+  return Py_BuildValue("");
+}
+
 
 static PyMethodDef _distanceWrapMethods[] = {
   {"cdist_braycurtis_double_wrap",
-   cdist_bray_curtis_double_wrap,
-   METH_VARARGS},
+   (PyCFunction) cdist_bray_curtis_double_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"cdist_canberra_double_wrap",
-   cdist_canberra_double_wrap,
-   METH_VARARGS},
+   (PyCFunction) cdist_canberra_double_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"cdist_chebyshev_double_wrap",
-   cdist_chebyshev_double_wrap,
-   METH_VARARGS},
+   (PyCFunction) cdist_chebyshev_double_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"cdist_cityblock_double_wrap",
-   cdist_city_block_double_wrap,
-   METH_VARARGS},
+   (PyCFunction) cdist_city_block_double_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"cdist_cosine_double_wrap",
    (PyCFunction) cdist_cosine_double_wrap,
    METH_VARARGS | METH_KEYWORDS},
   {"cdist_dice_bool_wrap",
-   cdist_dice_char_wrap,
-   METH_VARARGS},
+   (PyCFunction) cdist_dice_char_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"cdist_euclidean_double_wrap",
-   cdist_euclidean_double_wrap,
-   METH_VARARGS},
+   (PyCFunction) cdist_euclidean_double_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"cdist_sqeuclidean_double_wrap",
-   cdist_sqeuclidean_double_wrap,
-   METH_VARARGS},
+   (PyCFunction) cdist_sqeuclidean_double_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"cdist_hamming_double_wrap",
    (PyCFunction) cdist_hamming_double_wrap,
    METH_VARARGS | METH_KEYWORDS},
@@ -647,17 +1168,17 @@ static PyMethodDef _distanceWrapMethods[] = {
    (PyCFunction) cdist_hamming_char_wrap,
    METH_VARARGS | METH_KEYWORDS},
   {"cdist_jaccard_double_wrap",
-   cdist_jaccard_double_wrap,
-   METH_VARARGS},
+   (PyCFunction) cdist_jaccard_double_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"cdist_jaccard_bool_wrap",
-   cdist_jaccard_char_wrap,
-   METH_VARARGS},
+   (PyCFunction) cdist_jaccard_char_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"cdist_jensenshannon_double_wrap",
-   cdist_jensenshannon_double_wrap,
-   METH_VARARGS},
+   (PyCFunction) cdist_jensenshannon_double_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"cdist_kulsinski_bool_wrap",
-   cdist_kulsinski_char_wrap,
-   METH_VARARGS},
+   (PyCFunction) cdist_kulsinski_char_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"cdist_mahalanobis_double_wrap",
    (PyCFunction) cdist_mahalanobis_double_wrap,
    METH_VARARGS | METH_KEYWORDS},
@@ -668,47 +1189,47 @@ static PyMethodDef _distanceWrapMethods[] = {
    (PyCFunction) cdist_weighted_minkowski_double_wrap,
    METH_VARARGS | METH_KEYWORDS},
   {"cdist_rogerstanimoto_bool_wrap",
-   cdist_rogerstanimoto_char_wrap,
-   METH_VARARGS},
+   (PyCFunction) cdist_rogerstanimoto_char_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"cdist_russellrao_bool_wrap",
-   cdist_russellrao_char_wrap,
-   METH_VARARGS},
+   (PyCFunction) cdist_russellrao_char_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"cdist_seuclidean_double_wrap",
    (PyCFunction) cdist_seuclidean_double_wrap,
    METH_VARARGS | METH_KEYWORDS},
   {"cdist_sokalmichener_bool_wrap",
-   cdist_sokalmichener_char_wrap,
-   METH_VARARGS},
+   (PyCFunction) cdist_sokalmichener_char_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"cdist_sokalsneath_bool_wrap",
-   cdist_sokalsneath_char_wrap,
-   METH_VARARGS},
+   (PyCFunction) cdist_sokalsneath_char_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"cdist_yule_bool_wrap",
-   cdist_yule_char_wrap,
-   METH_VARARGS},
+   (PyCFunction) cdist_yule_char_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"pdist_braycurtis_double_wrap",
-   pdist_bray_curtis_double_wrap,
-   METH_VARARGS},
+   (PyCFunction) pdist_bray_curtis_double_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"pdist_canberra_double_wrap",
-   pdist_canberra_double_wrap,
-   METH_VARARGS},
+   (PyCFunction) pdist_canberra_double_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"pdist_chebyshev_double_wrap",
-   pdist_chebyshev_double_wrap,
-   METH_VARARGS},
+   (PyCFunction) pdist_chebyshev_double_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"pdist_cityblock_double_wrap",
-   pdist_city_block_double_wrap,
-   METH_VARARGS},
+   (PyCFunction) pdist_city_block_double_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"pdist_cosine_double_wrap",
    (PyCFunction) pdist_cosine_double_wrap,
    METH_VARARGS | METH_KEYWORDS},
   {"pdist_dice_bool_wrap",
-   pdist_dice_char_wrap,
-   METH_VARARGS},
+   (PyCFunction) pdist_dice_char_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"pdist_euclidean_double_wrap",
-   pdist_euclidean_double_wrap,
-   METH_VARARGS},
+   (PyCFunction) pdist_euclidean_double_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"pdist_sqeuclidean_double_wrap",
-   pdist_sqeuclidean_double_wrap,
-   METH_VARARGS},
+   (PyCFunction) pdist_sqeuclidean_double_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"pdist_hamming_double_wrap",
    (PyCFunction) pdist_hamming_double_wrap,
    METH_VARARGS | METH_KEYWORDS},
@@ -716,17 +1237,17 @@ static PyMethodDef _distanceWrapMethods[] = {
    (PyCFunction) pdist_hamming_char_wrap,
    METH_VARARGS | METH_KEYWORDS},
   {"pdist_jaccard_double_wrap",
-   pdist_jaccard_double_wrap,
-   METH_VARARGS},
+   (PyCFunction) pdist_jaccard_double_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"pdist_jaccard_bool_wrap",
-   pdist_jaccard_char_wrap,
-   METH_VARARGS},
+   (PyCFunction) pdist_jaccard_char_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"pdist_jensenshannon_double_wrap",
-   pdist_jensenshannon_double_wrap,
-   METH_VARARGS},
+   (PyCFunction) pdist_jensenshannon_double_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"pdist_kulsinski_bool_wrap",
-   pdist_kulsinski_char_wrap,
-   METH_VARARGS},
+   (PyCFunction) pdist_kulsinski_char_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"pdist_mahalanobis_double_wrap",
    (PyCFunction) pdist_mahalanobis_double_wrap,
    METH_VARARGS | METH_KEYWORDS},
@@ -737,28 +1258,115 @@ static PyMethodDef _distanceWrapMethods[] = {
    (PyCFunction) pdist_weighted_minkowski_double_wrap,
    METH_VARARGS | METH_KEYWORDS},
   {"pdist_rogerstanimoto_bool_wrap",
-   pdist_rogerstanimoto_char_wrap,
-   METH_VARARGS},
+   (PyCFunction) pdist_rogerstanimoto_char_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"pdist_russellrao_bool_wrap",
-   pdist_russellrao_char_wrap,
-   METH_VARARGS},
+   (PyCFunction) pdist_russellrao_char_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"pdist_seuclidean_double_wrap",
    (PyCFunction) pdist_seuclidean_double_wrap,
    METH_VARARGS | METH_KEYWORDS},
   {"pdist_sokalmichener_bool_wrap",
-   pdist_sokalmichener_char_wrap,
-   METH_VARARGS},
+   (PyCFunction) pdist_sokalmichener_char_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"pdist_sokalsneath_bool_wrap",
-   pdist_sokalsneath_char_wrap,
-   METH_VARARGS},
+   (PyCFunction) pdist_sokalsneath_char_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"pdist_yule_bool_wrap",
-   pdist_yule_char_wrap,
-   METH_VARARGS},
+   (PyCFunction) pdist_yule_char_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"cdist_dice_bits64_wrap",
+   (PyCFunction) cdist_dice_bits64_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"cdist_hamming_bits64_wrap",
+   (PyCFunction) cdist_hamming_bits64_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"cdist_jaccard_bits64_wrap",
+   (PyCFunction) cdist_jaccard_bits64_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"cdist_kulsinski_bits64_wrap",
+   (PyCFunction) cdist_kulsinski_bits64_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"cdist_rogerstanimoto_bits64_wrap",
+   (PyCFunction) cdist_rogerstanimoto_bits64_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"cdist_russellrao_bits64_wrap",
+   (PyCFunction) cdist_russellrao_bits64_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"cdist_sokalmichener_bits64_wrap",
+   (PyCFunction) cdist_sokalmichener_bits64_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"cdist_sokalsneath_bits64_wrap",
+   (PyCFunction) cdist_sokalsneath_bits64_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"cdist_yule_bits64_wrap",
+   (PyCFunction) cdist_yule_bits64_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"pdist_dice_bits64_wrap",
+   (PyCFunction) pdist_dice_bits64_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"pdist_hamming_bits64_wrap",
+   (PyCFunction) pdist_hamming_bits64_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"pdist_jaccard_bits64_wrap",
+   (PyCFunction) pdist_jaccard_bits64_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"pdist_kulsinski_bits64_wrap",
+   (PyCFunction) pdist_kulsinski_bits64_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"pdist_rogerstanimoto_bits64_wrap",
+   (PyCFunction) pdist_rogerstanimoto_bits64_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"pdist_russellrao_bits64_wrap",
+   (PyCFunction) pdist_russellrao_bits64_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"pdist_sokalmichener_bits64_wrap",
+   (PyCFunction) pdist_sokalmichener_bits64_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"pdist_sokalsneath_bits64_wrap",
+   (PyCFunction) pdist_sokalsneath_bits64_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"pdist_yule_bits64_wrap",
+   (PyCFunction) pdist_yule_bits64_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"cdist_cosine_float_wrap",
+   (PyCFunction) cdist_cosine_float_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"cdist_euclidean_float_wrap",
+   (PyCFunction) cdist_euclidean_float_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"cdist_minkowski_float_wrap",
+   (PyCFunction) cdist_minkowski_float_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"cdist_sqeuclidean_float_wrap",
+   (PyCFunction) cdist_sqeuclidean_float_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"pdist_cosine_float_wrap",
+   (PyCFunction) pdist_cosine_float_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"pdist_euclidean_float_wrap",
+   (PyCFunction) pdist_euclidean_float_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"pdist_minkowski_float_wrap",
+   (PyCFunction) pdist_minkowski_float_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"pdist_sqeuclidean_float_wrap",
+   (PyCFunction) pdist_sqeuclidean_float_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"cdist_knn_wrap",
+   (PyCFunction) cdist_knn_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"cdist_radius_wrap",
+   (PyCFunction) cdist_radius_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"to_squareform_from_vector_wrap",
-   to_squareform_from_vector_wrap,
-   METH_VARARGS},
+   (PyCFunction) to_squareform_from_vector_wrap,
+   METH_VARARGS | METH_KEYWORDS},
   {"to_vector_from_squareform_wrap",
-   to_vector_from_squareform_wrap,
+   (PyCFunction) to_vector_from_squareform_wrap,
+   METH_VARARGS | METH_KEYWORDS},
+  {"condensed_argmin_wrap",
+   condensed_argmin_wrap,
    METH_VARARGS},
   {NULL, NULL}     /* Sentinel - marks the end of this structure */
 };
@@ -0,0 +1,203 @@
+#ifndef HAUSDORFF_H
+#define HAUSDORFF_H
+
+/*
+ * Directed Hausdorff distance
+ * ===========================
+ *
+ * The early break algorithm of Taha and Hanbury: the outer points u are
+ * visited in random order, and the scan over the inner points v for one
+ * outer point stops as soon as it finds one closer than cmax, the largest
+ * nearest-neighbour distance found so far, since that outer point can no
+ * longer raise cmax.
+ *
+ * The inner points are expected in the leaf order of a cKDTree, so that
+ * points close in space are close in memory, and each outer point starts
+ * its scan at `start`, the leaf position of an approximate nearest
+ * neighbour, working outwards block by block from there. Most scans then
+ * break in their first block. A block holds HAUSDORFF_BLOCK inner points
+ * with their coordinates transposed, so that the distances to all of
+ * them are computed in one vectorizable loop.
+ *
+ * The outer points are split over threads, which share cmax through an
+ * atomic. Ties are broken towards the smallest original indices, so the
+ * result does not depend on the number of threads or on the visiting
+ * order. Distances are squared throughout.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "numpy/npy_common.h"
+
+#define HAUSDORFF_BLOCK 8
+
+/* outer points claimed at a time by one thread */
+#define HAUSDORFF_CHUNK 64
+
+namespace {
+
+struct hausdorff_state {
+
+    const double *u;          /* outer points, in visiting order */
+    const npy_intp *u_index;  /* their original indices */
+    const npy_intp *start;    /* their first inner point to compare */
+    npy_intp n_u;
+    std::vector<double> blocks;  /* inner points in leaf order */
+    const npy_intp *v_index;  /* their original indices */
+    npy_intp n_blocks;
+    npy_intp dims;
+
+    std::atomic<npy_intp> next;
+    std::atomic<double> cmax;
+    std::mutex lock;          /* protects best_i and best_j */
+    npy_intp best_i;
+    npy_intp best_j;
+
+    hausdorff_state(const double *u, const npy_intp *u_index,
+                    const npy_intp *start, npy_intp n_u, const double *v,
+                    const npy_intp *v_index, npy_intp n_v, npy_intp dims)
+        : u(u), u_index(u_index), start(start), n_u(n_u),
+          v_index(v_index), dims(dims), next(0), cmax(0), best_i(-1),
+          best_j(-1)
+    {
+        n_blocks = (n_v + HAUSDORFF_BLOCK - 1) / HAUSDORFF_BLOCK;
+        /* padding lanes are infinitely far away from everything */
+        blocks.assign(n_blocks * dims * HAUSDORFF_BLOCK,
+                      std::numeric_limits<double>::infinity());
+        for (npy_intp j = 0; j < n_v; ++j) {
+            double *block = blocks.data()
+                            + (j / HAUSDORFF_BLOCK) * dims * HAUSDORFF_BLOCK;
+            for (npy_intp k = 0; k < dims; ++k) {
+                block[k * HAUSDORFF_BLOCK + j % HAUSDORFF_BLOCK]
+                    = v[j * dims + k];
+            }
+        }
+    }
+
+    /* minimum over one block, ties towards the smaller original index */
+    inline void
+    scan_block(const double *x, const npy_intp b, double &cmin,
+               npy_intp &jmin) const
+    {
+        const double *block = blocks.data() + b * dims * HAUSDORFF_BLOCK;
+        double d[HAUSDORFF_BLOCK];
+        for (int l = 0; l < HAUSDORFF_BLOCK; ++l) {
+            d[l] = 0;
+        }
+        for (npy_intp k = 0; k < dims; ++k) {
+            const double xk = x[k];
+            const double *column = block + k * HAUSDORFF_BLOCK;
+            for (int l = 0; l < HAUSDORFF_BLOCK; ++l) {
+                const double diff = xk - column[l];
+                d[l] += diff * diff;
+            }
+        }
+        for (int l = 0; l < HAUSDORFF_BLOCK; ++l) {
+            const npy_intp j = b * HAUSDORFF_BLOCK + l;
+            /* cmin is finite once jmin is set, so padding never ties */
+            if (d[l] < cmin || (d[l] == cmin && jmin >= 0
+                                && v_index[j] < v_index[jmin])) {
+                cmin = d[l];
+                jmin = j;
+            }
+        }
+    }
+
+    void
+    visit(const npy_intp t)
+    {
+        const double *x = u + t * dims;
+        const npy_intp first = start[t] / HAUSDORFF_BLOCK;
+        double cmin = std::numeric_limits<double>::infinity();
+        npy_intp jmin = -1;
+
+        /* blocks first, first + 1, first - 1, first + 2, ... */
+        for (npy_intp step = 0; step < 2 * n_blocks; ++step) {
+            const npy_intp offset = (step + 1) / 2;
+            const npy_intp b = step % 2 ? first + offset : first - offset;
+            if (b < 0 || b >= n_blocks) {
+                continue;
+            }
+            scan_block(x, b, cmin, jmin);
+            if (cmin < cmax.load(std::memory_order_relaxed)) {
+                return;
+            }
+        }
+        /* nothing comparable, e.g. only NaN distances */
+        if (jmin < 0) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> guard(lock);
+        const double c = cmax.load(std::memory_order_relaxed);
+        if (cmin > c || (cmin == c && (best_i < 0 || u_index[t] < best_i))) {
+            cmax.store(cmin, std::memory_order_relaxed);
+            best_i = u_index[t];
+            best_j = v_index[jmin];
+        }
+    }
+
+    void
+    run()
+    {
+        for (;;) {
+            const npy_intp t0 = next.fetch_add(HAUSDORFF_CHUNK);
+            if (t0 >= n_u) {
+                return;
+            }
+            const npy_intp t1 = std::min(n_u, t0 + HAUSDORFF_CHUNK);
+            for (npy_intp t = t0; t < t1; ++t) {
+                visit(t);
+            }
+        }
+    }
+};
+
+}  /* namespace */
+
+/*
+ * Squared directed Hausdorff distance from u (n_u x dims) to v (n_v x dims)
+ * on up to `workers` threads. u_index and v_index hold the original
+ * indices of the rows of u and v, and start[t] the row of v to look at
+ * first for row t of u. The Hausdorff pair is returned by its original
+ * indices, or as (-1, -1) if no distance compares below infinity.
+ */
+inline void
+directed_hausdorff_kernel(const double *u, const npy_intp *u_index,
+                          const npy_intp *start, const npy_intp n_u,
+                          const double *v, const npy_intp *v_index,
+                          const npy_intp n_v, const npy_intp dims,
+                          int workers, double *cmax, npy_intp *i,
+                          npy_intp *j)
+{
+    hausdorff_state state(u, u_index, start, n_u, v, v_index, n_v, dims);
+    std::vector<std::thread> threads;
+
+    workers = (int)std::min<npy_intp>(
+        workers, (n_u + HAUSDORFF_CHUNK - 1) / HAUSDORFF_CHUNK);
+    for (int k = 1; k < workers; ++k) {
+        try {
+            threads.emplace_back(&hausdorff_state::run, &state);
+        }
+        catch (const std::system_error &) {
+            /* the threads that did start take over the remaining work */
+            break;
+        }
+    }
+    state.run();
+    for (std::thread &th : threads) {
+        th.join();
+    }
+
+    *cmax = state.cmax.load();
+    *i = state.best_i;
+    *j = state.best_j;
+}
+
+#endif
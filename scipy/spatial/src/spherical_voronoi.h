@@ -0,0 +1,255 @@
+#ifndef SPHERICAL_VORONOI_H
+#define SPHERICAL_VORONOI_H
+
+/*
+ * Spherical Voronoi regions
+ * =========================
+ *
+ * The Voronoi vertices of a spherical Voronoi diagram are the triangles of
+ * the convex hull of the generators, so the region of a generator is the
+ * set of hull triangles that contain it. The regions are kept in CSR form:
+ * region n holds the triangles indices[indptr[n]:indptr[n+1]].
+ *
+ * Sorting a region walks around the generator from triangle to triangle
+ * over the hull edges, which only needs the few triangles of the region.
+ * The regions are independent, so they are split over threads, and the
+ * area of each region is computed in the same pass as the sum of the
+ * signed spherical excesses of the triangles (generator, v_i, v_{i+1}),
+ * by the formula of Van Oosterom and Strackee.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "numpy/npy_common.h"
+
+/* regions claimed at a time by one thread */
+#define SPHERICAL_VORONOI_CHUNK 1024
+
+namespace {
+
+struct spherical_voronoi_state {
+
+    const int *simplices;
+    const npy_intp *indptr;
+    npy_intp *indices;
+    npy_intp n_points;
+    const double *points;
+    const double *vertices;
+    const double *center;
+    double radius;
+    double *areas;
+
+    std::atomic<npy_intp> next;
+
+    spherical_voronoi_state(const int *simplices, const npy_intp *indptr,
+                            npy_intp *indices, npy_intp n_points,
+                            const double *points, const double *vertices,
+                            const double *center, double radius,
+                            double *areas)
+        : simplices(simplices), indptr(indptr), indices(indices),
+          n_points(n_points), points(points), vertices(vertices),
+          center(center), radius(radius), areas(areas), next(0)
+    {}
+
+    /* the unit vector from the center towards x */
+    inline void
+    direction(const double *x, double *u) const
+    {
+        double norm = 0;
+        for (int k = 0; k < 3; ++k) {
+            u[k] = x[k] - center[k];
+            norm += u[k] * u[k];
+        }
+        norm = std::sqrt(norm);
+        for (int k = 0; k < 3; ++k) {
+            u[k] /= norm;
+        }
+    }
+
+    /* the vertex of triangle s other than n and v, or -1 */
+    inline npy_intp
+    other_vertex(const npy_intp s, const npy_intp n, const npy_intp v) const
+    {
+        for (int i = 0; i < 3; ++i) {
+            const npy_intp k = simplices[3 * s + i];
+            if (k != n && k != v) {
+                return k;
+            }
+        }
+        return -1;
+    }
+
+    inline bool
+    has_vertex(const npy_intp s, const npy_intp v) const
+    {
+        return (simplices[3 * s] == v || simplices[3 * s + 1] == v
+                || simplices[3 * s + 2] == v);
+    }
+
+    /*
+     * Sort region n, starting from its first triangle and always moving on
+     * to the first remaining triangle that shares the current edge.
+     */
+    void
+    sort_region(const npy_intp n, std::vector<npy_intp> &region,
+                std::vector<char> &used) const
+    {
+        npy_intp *out = indices + indptr[n];
+        const npy_intp d = indptr[n + 1] - indptr[n];
+
+        region.assign(out, out + d);
+        used.assign(d, 0);
+
+        npy_intp current = region[0];
+        npy_intp vertex = other_vertex(current, n, -1);
+        used[0] = 1;
+        out[0] = current;
+        for (npy_intp c = 1; c < d; ++c) {
+            npy_intp found = -1;
+            for (npy_intp i = 0; i < d; ++i) {
+                if (!used[i] && has_vertex(region[i], vertex)) {
+                    found = i;
+                    break;
+                }
+            }
+            if (found < 0) {
+                /* not a closed fan of triangles; keep the rest in order */
+                for (npy_intp i = 0; i < d; ++i) {
+                    if (!used[i]) {
+                        out[c++] = region[i];
+                    }
+                }
+                return;
+            }
+            used[found] = 1;
+            current = region[found];
+            vertex = other_vertex(current, n, vertex);
+            out[c] = current;
+        }
+    }
+
+    double
+    region_area(const npy_intp n) const
+    {
+        const npy_intp *region = indices + indptr[n];
+        const npy_intp d = indptr[n + 1] - indptr[n];
+        if (d < 3) {
+            return 0;
+        }
+
+        double a[3], b[3], c[3];
+        direction(points + 3 * n, a);
+        direction(vertices + 3 * region[d - 1], b);
+        double excess = 0;
+        for (npy_intp i = 0; i < d; ++i) {
+            direction(vertices + 3 * region[i], c);
+            const double triple = (a[0] * (b[1] * c[2] - b[2] * c[1])
+                                   + a[1] * (b[2] * c[0] - b[0] * c[2])
+                                   + a[2] * (b[0] * c[1] - b[1] * c[0]));
+            const double ab = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+            const double bc = b[0] * c[0] + b[1] * c[1] + b[2] * c[2];
+            const double ca = c[0] * a[0] + c[1] * a[1] + c[2] * a[2];
+            excess += 2 * std::atan2(triple, 1 + ab + bc + ca);
+            std::copy(c, c + 3, b);
+        }
+        return std::fabs(excess) * radius * radius;
+    }
+
+    void
+    run()
+    {
+        std::vector<npy_intp> region;
+        std::vector<char> used;
+        for (;;) {
+            const npy_intp n0 = next.fetch_add(SPHERICAL_VORONOI_CHUNK);
+            if (n0 >= n_points) {
+                return;
+            }
+            const npy_intp n1 = std::min(n_points,
+                                         n0 + SPHERICAL_VORONOI_CHUNK);
+            for (npy_intp n = n0; n < n1; ++n) {
+                if (indptr[n + 1] > indptr[n]) {
+                    sort_region(n, region, used);
+                }
+                if (areas) {
+                    areas[n] = region_area(n);
+                }
+            }
+        }
+    }
+};
+
+}  /* namespace */
+
+/*
+ * The regions of the generators 0, ..., n_points - 1 of the hull triangles
+ * simplices (n_simplices x 3), in CSR form. indices must have room for
+ * 3 * n_simplices entries; each region lists its triangles in increasing
+ * order.
+ */
+inline void
+spherical_voronoi_regions(const int *simplices, const npy_intp n_simplices,
+                          const npy_intp n_points, npy_intp *indptr,
+                          npy_intp *indices)
+{
+    std::fill(indptr, indptr + n_points + 1, 0);
+    for (npy_intp j = 0; j < 3 * n_simplices; ++j) {
+        ++indptr[simplices[j] + 1];
+    }
+    for (npy_intp n = 0; n < n_points; ++n) {
+        indptr[n + 1] += indptr[n];
+    }
+
+    /* indptr[n] is the next free slot of region n while filling */
+    for (npy_intp s = 0; s < n_simplices; ++s) {
+        for (int i = 0; i < 3; ++i) {
+            indices[indptr[simplices[3 * s + i]]++] = s;
+        }
+    }
+    for (npy_intp n = n_points; n > 0; --n) {
+        indptr[n] = indptr[n - 1];
+    }
+    indptr[0] = 0;
+}
+
+/*
+ * Sort the vertices of each region of the CSR regions (indptr, indices)
+ * around its generator, in place, on up to `workers` threads. If areas is
+ * not NULL, the area of each region on the sphere of the given center and
+ * radius is stored in it.
+ */
+inline void
+spherical_voronoi_sort(const int *simplices, const npy_intp *indptr,
+                       npy_intp *indices, const npy_intp n_points,
+                       const double *points, const double *vertices,
+                       const double *center, const double radius,
+                       double *areas, int workers)
+{
+    spherical_voronoi_state state(simplices, indptr, indices, n_points,
+                                  points, vertices, center, radius, areas);
+    std::vector<std::thread> threads;
+
+    workers = (int)std::min<npy_intp>(
+        workers,
+        (n_points + SPHERICAL_VORONOI_CHUNK - 1) / SPHERICAL_VORONOI_CHUNK);
+    for (int k = 1; k < workers; ++k) {
+        try {
+            threads.emplace_back(&spherical_voronoi_state::run, &state);
+        }
+        catch (const std::system_error &) {
+            /* the threads that did start take over the remaining work */
+            break;
+        }
+    }
+    state.run();
+    for (std::thread &th : threads) {
+        th.join();
+    }
+}
+
+#endif
@@ -51,7 +51,9 @@ from pytest import raises as assert_raises
 from scipy._lib._numpy_compat import suppress_warnings
 from scipy.spatial.distance import (squareform, pdist, cdist, num_obs_y,
                                     num_obs_dm, is_valid_dm, is_valid_y,
-                                    _validate_vector, _METRICS_NAMES)
+                                    CondensedDistanceMatrix,
+                                    _validate_vector, _METRICS_NAMES,
+                                    _METRICS)
 
 # these were missing: chebyshev cityblock kulsinski
 from scipy.spatial.distance import (braycurtis, canberra, chebyshev, cityblock,
@@ -62,6 +64,7 @@ from scipy.spatial.distance import (braycurtis, canberra, chebyshev, cityblock,
                                     seuclidean, sokalmichener, sokalsneath,
                                     sqeuclidean, yule)
 from scipy.spatial.distance import wminkowski as old_wminkowski
+from scipy.spatial import distance
 
 _filenames = [
               "cdist-X1.txt",
@@ -224,6 +227,15 @@ def _assert_within_tol(a, b, atol=0, rtol=0, verbose_=False):
     assert_allclose(a, b, rtol=rtol, atol=atol)
 
 
+def _pack_bits64(X):
+    # Bit-packed rows with feature j at bit j % 64 of word j // 64
+    m, n = X.shape
+    padded = np.zeros((m, -(-n // 64) * 64), dtype=np.uint64)
+    padded[:, :n] = X
+    bits = padded.reshape(m, -1, 64) << np.arange(64, dtype=np.uint64)
+    return np.bitwise_or.reduce(bits, axis=2)
+
+
 def _rand_split(arrays, weights, axis, split_per, seed=None):
     # inverse operation for stats.collapse_weights
     weights = np.array(weights, dtype=np.float64)  # modified inplace; need a copy
@@ -622,8 +634,7 @@ class TestCdist(object):
             assert_raises(ValueError, cdist, X1, X2, metric, out=out5, **kwargs)
 
     def test_striding(self):
-        # test that striding is handled correct with calls to
-        # _copy_array_if_base_present
+        # test that strided input is handled correctly
         eps = 1e-07
         X1 = eo['cdist-X1'][::2, ::2]
         X2 = eo['cdist-X2'][::2, ::2]
@@ -650,6 +661,152 @@ class TestCdist(object):
             # test that output is numerically equivalent
             _assert_within_tol(Y1, Y2, eps, verbose > 2)
 
+    def test_cdist_workers(self):
+        # Large enough for the tiles to be split over several threads
+        rng = np.random.RandomState(1234)
+        X1 = rng.rand(150, 24)
+        X2 = rng.rand(170, 24)
+        for metric in _METRICS_NAMES:
+            kwargs = dict()
+            if metric in ['minkowski', 'wminkowski']:
+                kwargs['p'] = 1.23
+            if metric == 'wminkowski':
+                kwargs['w'] = 1.0 / X1.std(axis=0)
+            XA, XB = X1, X2
+            if 'bool' in _METRICS[metric].types:
+                XA, XB = X1 > 0.5, X2 > 0.5
+            Y1 = cdist(XA, XB, metric, **kwargs)
+            for workers in [2, 5, -1]:
+                # each distance is computed by the same kernel
+                assert_equal(cdist(XA, XB, metric, workers=workers,
+                                   **kwargs), Y1)
+        assert_raises(ValueError, cdist, X1, X2, workers=0)
+
+    @pytest.mark.parametrize('metric', distance._PACKED_METRICS)
+    @pytest.mark.parametrize('nbits', [1, 63, 64, 65, 2048])
+    def test_cdist_packed(self, metric, nbits):
+        rng = np.random.RandomState(1234)
+        X1 = rng.rand(20, nbits) < 0.3
+        X2 = rng.rand(30, nbits) < 0.6
+        with np.errstate(divide='ignore', invalid='ignore'):
+            expected = cdist(X1, X2, metric)
+            Y = cdist(_pack_bits64(X1), _pack_bits64(X2), metric, nbits=nbits)
+        assert_allclose(Y, expected, rtol=1e-15, atol=0, equal_nan=True)
+
+    def test_cdist_packed_invalid(self):
+        P = _pack_bits64(np.ones((3, 70), dtype=bool))
+        assert_raises(ValueError, cdist, P, P, 'euclidean', nbits=70)
+        assert_raises(ValueError, cdist, P, P, 'jaccard', nbits=64)
+        assert_raises(ValueError, cdist, P, P, 'jaccard', nbits=69)
+        assert_raises(ValueError, cdist, P.astype(np.int64), P, 'jaccard',
+                      nbits=70)
+        assert_raises(ValueError, cdist, P, P, jaccard, nbits=70)
+        assert_raises(TypeError, cdist, P, P, 'hamming', nbits=70,
+                      w=np.arange(70))
+
+    @pytest.mark.parametrize('metric', ['sqeuclidean', 'euclidean',
+                                        'minkowski', 'cosine', 'correlation'])
+    @pytest.mark.parametrize('n', [5, 100])
+    def test_cdist_float32(self, metric, n):
+        # float32 rows are used without converting them to float64
+        rng = np.random.RandomState(1234)
+        X1 = rng.randn(40, n).astype(np.float32)
+        X2 = rng.randn(50, n).astype(np.float32)
+        kwargs = {'p': 3.} if metric == 'minkowski' else {}
+        Y = cdist(np.double(X1), np.double(X2), metric, **kwargs)
+        assert_allclose(cdist(X1, X2, metric, workers=2, **kwargs), Y,
+                        rtol=1e-12)
+        assert_allclose(cdist(X1, X2, metric, acc_dtype=np.float32,
+                              **kwargs), Y, rtol=1e-4, atol=1e-5)
+        out = np.empty((40, 50), dtype=np.float32)
+        assert_(cdist(X1, X2, metric, out=out, **kwargs) is out)
+        assert_allclose(out, Y, rtol=1e-6, atol=1e-7)
+
+    def test_cdist_float32_invalid(self):
+        X = np.ones((3, 4), dtype=np.float32)
+        out = np.empty((3, 3), dtype=np.float32)
+        assert_raises(ValueError, cdist, X, X, 'cityblock', out=out)
+        assert_raises(ValueError, cdist, np.double(X), X, 'euclidean',
+                      out=out)
+        assert_raises(ValueError, cdist, X, X, euclidean, out=out)
+        assert_raises(ValueError, cdist, X, X, 'euclidean',
+                      acc_dtype=np.int64)
+
+    @pytest.mark.parametrize('metric', sorted(distance._SELECT_METRICS))
+    @pytest.mark.parametrize('dtype', [np.double, np.float32])
+    def test_cdist_knn(self, metric, dtype):
+        rng = np.random.RandomState(1234)
+        X1 = rng.rand(30, 5).astype(dtype)
+        X2 = rng.rand(300, 5).astype(dtype)
+        X2[7] = X2[3]
+        kwargs = {'p': 3.} if metric == 'minkowski' else {}
+        Y = cdist(X1, X2, metric, **kwargs)
+        expected = np.argsort(Y, axis=1, kind='mergesort')
+        for k in [1, 4, 300]:
+            dist, index = distance.cdist_knn(X1, X2, k, metric, workers=2,
+                                             **kwargs)
+            assert_equal(index, expected[:, :k])
+            assert_equal(dist, np.sort(Y, axis=1)[:, :k])
+
+    def test_cdist_knn_ties_nan(self):
+        X1 = np.array([[0.], [1.], [np.nan]])
+        X2 = np.array([[1.], [np.nan], [-1.], [0.], [1.]])
+        Y = cdist(X1, X2)
+        dist, index = distance.cdist_knn(X1, X2, 5)
+        assert_equal(index, np.argsort(Y, axis=1, kind='mergesort'))
+        assert_equal(dist, np.sort(Y, axis=1))
+        assert_raises(ValueError, distance.cdist_knn, X1, X2, 0)
+        assert_raises(ValueError, distance.cdist_knn, X1, X2, 6)
+
+    @pytest.mark.parametrize('metric', sorted(distance._SELECT_METRICS))
+    def test_cdist_radius(self, metric):
+        rng = np.random.RandomState(1234)
+        X1 = rng.rand(300, 3)
+        X2 = rng.rand(280, 3)
+        X2[:5] = X1[:5]
+        Y = cdist(X1, X2, metric)
+        r = np.median(Y)
+        result = distance.cdist_radius(X1, X2, r, metric, workers=2)
+        assert_(result.format == 'csr')
+        assert_(result.has_sorted_indices)
+        row, col = np.nonzero(Y <= r)
+        assert_equal(result.indptr, np.searchsorted(row, np.arange(301)))
+        assert_equal(result.indices, col)
+        assert_equal(result.data, Y[row, col])
+        coo = distance.cdist_radius(X1, X2, r, metric,
+                                    output_type='coo_matrix')
+        assert_(coo.format == 'coo')
+        assert_equal(coo.toarray(), result.toarray())
+        assert_equal(distance.cdist_radius(X1, X2, -1., metric).nnz, 0)
+
+    def test_cdist_select_invalid(self):
+        X = np.ones((3, 2))
+        assert_raises(ValueError, distance.cdist_knn, X, X, 1, 'dice')
+        assert_raises(TypeError, distance.cdist_knn, X, X, 1, euclidean)
+        assert_raises(TypeError, distance.cdist_knn, X, X, 1, 'euclidean',
+                      p=2.)
+        assert_raises(ValueError, distance.cdist_knn, X, np.ones((3, 3)), 1)
+        assert_raises(ValueError, distance.cdist_radius, X, X, 1.,
+                      output_type='dok_matrix')
+
+    @pytest.mark.parametrize('metric', ['sqeuclidean', 'euclidean', 'cosine',
+                                        'correlation'])
+    def test_cdist_gemm(self, metric):
+        # High-dimensional data goes through the matrix product path
+        rng = np.random.RandomState(1234)
+        X1 = rng.randn(40, 100)
+        X2 = rng.randn(50, 100)
+        Y = cdist(X1, X2, metric)
+        assert_allclose(Y, cdist(X1, X2, metric, exact=True), rtol=1e-12)
+        out = np.empty((40, 50))
+        assert_(cdist(X1, X2, metric, out=out) is out)
+        assert_allclose(out, Y, rtol=1e-15)
+        # rounding must not give negative distances for equal points
+        Y = cdist(X1, X1, metric)
+        assert_(np.all(Y >= 0))
+        assert_allclose(np.diag(Y), 0, atol=1e-7)
+        assert_equal(np.diag(cdist(X1, X1, metric, exact=True)), 0)
+
 class TestPdist(object):
 
     def setup_method(self):
@@ -1479,8 +1636,7 @@ class TestPdist(object):
             assert_raises(ValueError, pdist, X, metric, out=out5, **kwargs)
 
     def test_striding(self):
-        # test that striding is handled correct with calls to
-        # _copy_array_if_base_present
+        # test that strided input is handled correctly
         eps = 1e-07
         X = eo['random-float32-data'][::5, ::2]
         X_copy = X.copy()
@@ -1500,6 +1656,66 @@ class TestPdist(object):
             # test that output is numerically equivalent
             _assert_within_tol(Y1, Y2, eps, verbose > 2)
 
+    @pytest.mark.parametrize('m', [1, 2, 257, 301])
+    def test_pdist_workers(self, m):
+        # The triangular tiles must cover every pair exactly once
+        rng = np.random.RandomState(1234)
+        X = rng.rand(m, 24)
+        for metric in _METRICS_NAMES:
+            kwargs = dict()
+            if metric in ['minkowski', 'wminkowski']:
+                kwargs['p'] = 1.23
+            if metric == 'wminkowski':
+                kwargs['w'] = 1.0 / X.std(axis=0)
+            if metric in ['seuclidean', 'mahalanobis'] and m < 30:
+                continue
+            XX = X > 0.5 if 'bool' in _METRICS[metric].types else X
+            Y1 = pdist(XX, metric, **kwargs)
+            for workers in [2, 5, -1]:
+                assert_equal(pdist(XX, metric, workers=workers, **kwargs),
+                             Y1)
+        assert_raises(ValueError, pdist, X, workers=0)
+
+    @pytest.mark.parametrize('metric', distance._PACKED_METRICS)
+    @pytest.mark.parametrize('nbits', [1, 65, 2048])
+    def test_pdist_packed(self, metric, nbits):
+        X = np.random.RandomState(1234).rand(40, nbits) < 0.4
+        with np.errstate(divide='ignore', invalid='ignore'):
+            expected = pdist(X, metric)
+            Y = pdist(_pack_bits64(X), metric, nbits=nbits, workers=3)
+        assert_allclose(Y, expected, rtol=1e-15, atol=0, equal_nan=True)
+
+    @pytest.mark.parametrize('metric', ['sqeuclidean', 'euclidean',
+                                        'minkowski', 'cosine', 'correlation'])
+    @pytest.mark.parametrize('n', [5, 100])
+    @pytest.mark.parametrize('m', [1, 2, 301])
+    def test_pdist_float32(self, metric, n, m):
+        rng = np.random.RandomState(1234)
+        X = rng.randn(m, n).astype(np.float32)
+        kwargs = {'p': 3.} if metric == 'minkowski' else {}
+        Y = pdist(np.double(X), metric, **kwargs)
+        assert_allclose(pdist(X, metric, workers=2, **kwargs), Y,
+                        rtol=1e-12)
+        assert_allclose(pdist(X, metric, acc_dtype=np.float32, **kwargs), Y,
+                        rtol=1e-4, atol=1e-5)
+        out = np.empty(m * (m - 1) // 2, dtype=np.float32)
+        assert_(pdist(X, metric, out=out, **kwargs) is out)
+        assert_allclose(out, Y, rtol=1e-6, atol=1e-7)
+
+    @pytest.mark.parametrize('metric', ['sqeuclidean', 'euclidean', 'cosine',
+                                        'correlation'])
+    @pytest.mark.parametrize('m', [1, 2, 3, 40])
+    def test_pdist_gemm(self, metric, m, monkeypatch):
+        rng = np.random.RandomState(1234)
+        X = rng.randn(m, 100)
+        Y_exact = pdist(X, metric, exact=True)
+        assert_allclose(pdist(X, metric), Y_exact, rtol=1e-12)
+        # the product is computed in blocks of rows
+        monkeypatch.setattr(distance, '_GEMM_PDIST_BLOCK', 1)
+        assert_allclose(pdist(X, metric), Y_exact, rtol=1e-12)
+        X[-1] = X[0]
+        assert_(np.all(pdist(X, metric) >= 0))
+
 class TestSomeDistanceFunctions(object):
 
     def setup_method(self):
@@ -1646,6 +1862,94 @@ class TestSquareForm(object):
                 else:
                     assert_equal(A[i, j], 0)
 
+    @pytest.mark.parametrize('n', [1, 2, 63, 65, 200])
+    def test_squareform_workers(self, n):
+        # Tiles of the square form must cover each pair exactly once
+        rng = np.random.RandomState(1234)
+        for dtype in self.checked_dtypes + [np.complex128]:
+            Y = (rng.rand(n * (n - 1) // 2) * 100).astype(dtype)
+            A = squareform(Y)
+            assert_equal(np.diag(A), 0)
+            assert_array_equal(A, A.T)
+            for workers in [2, 5, -1]:
+                assert_array_equal(squareform(Y, workers=workers), A)
+                assert_array_equal(squareform(A, workers=workers), Y)
+        assert_raises(ValueError, squareform, Y, workers=0)
+
+    def test_squareform_views(self):
+        # Contiguous views of a larger array are converted in place
+        base = np.arange(50.)
+        v = base[10:20]
+        assert_array_equal(squareform(v), squareform(v.copy()))
+        M = np.zeros((3, 5, 5))
+        M[1] = squareform(np.arange(1., 11.))
+        assert_array_equal(squareform(M[1]), np.arange(1., 11.))
+
+
+class TestCondensedDistanceMatrix(object):
+
+    @pytest.mark.parametrize('n', [1, 2, 3, 40])
+    def test_rows(self, n):
+        Y = pdist(np.random.RandomState(1234).rand(n, 3))
+        D = CondensedDistanceMatrix(Y)
+        A = squareform(Y)
+        assert_equal(D.n, n)
+        assert_(np.asarray(D) is D.y)
+        assert_array_equal(D.rows(np.arange(n)), A)
+        assert_array_equal(D.rows(n - 1), A[-1])
+        assert_array_equal(D.rows(-1), A[-1])
+        assert_array_equal(D[[0, n - 1]], A[[0, n - 1]])
+        for i in range(n):
+            for j in range(n):
+                assert_equal(D[i, j], A[i, j])
+        assert_array_equal(D[np.arange(n), n - 1], A[:, -1])
+        assert_raises(IndexError, D.rows, n)
+        assert_raises(IndexError, D.__getitem__, (0, -n - 1))
+
+    @pytest.mark.parametrize('dtype', [np.float64, np.float32, np.int32])
+    def test_argmin(self, dtype):
+        rng = np.random.RandomState(1234)
+        Y = rng.randint(0, 5, size=45).astype(dtype)
+        D = CondensedDistanceMatrix(Y)
+        A = squareform(Y).astype(np.double)
+        A[np.diag_indices(10)] = np.inf
+        assert_array_equal(D.argmin(axis=1), np.argmin(A, axis=1))
+        assert_array_equal(D.argmin(axis=0), np.argmin(A, axis=0))
+        assert_array_equal(D.min(axis=1), np.min(A, axis=1))
+        i, j = D.argmin()
+        assert_(i < j)
+        assert_equal(D[i, j], Y.min())
+        # the first minimum of Y
+        assert_equal(10 * i - i * (i + 1) // 2 + j - i - 1, np.argmin(Y))
+        assert_equal(D.min(), Y.min())
+
+        if dtype != np.int32:
+            Y[20] = np.nan
+            A = squareform(Y).astype(np.double)
+            A[np.diag_indices(10)] = np.inf
+            assert_array_equal(D.argmin(axis=1), np.argmin(A, axis=1))
+
+    def test_argmin_single(self):
+        D = CondensedDistanceMatrix([])
+        assert_equal(D.n, 1)
+        assert_array_equal(D.argmin(axis=1), [-1])
+        assert_array_equal(D.min(axis=1), [np.inf])
+        assert_array_equal(D.rows(0), [0])
+        assert_raises(ValueError, D.argmin)
+        assert_raises(ValueError, D.argmin, axis=2)
+
+    def test_invalid(self):
+        assert_raises(ValueError, CondensedDistanceMatrix, np.zeros(4))
+        assert_raises(ValueError, CondensedDistanceMatrix, np.zeros((3, 3)))
+
+    def test_linkage(self):
+        from scipy.cluster.hierarchy import linkage
+        Y = pdist(np.random.RandomState(1234).rand(30, 4))
+        D = CondensedDistanceMatrix(Y)
+        assert_array_equal(squareform(D), squareform(Y))
+        for method in ['single', 'average', 'ward']:
+            assert_array_equal(linkage(D, method), linkage(Y, method))
+
 
 class TestNumObsY(object):
 
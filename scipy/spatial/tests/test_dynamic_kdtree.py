@@ -0,0 +1,114 @@
+from __future__ import division, print_function, absolute_import
+
+from numpy.testing import assert_equal, assert_allclose
+from pytest import raises as assert_raises
+import pytest
+import numpy as np
+
+from scipy.spatial import DynamicKDTree, cKDTree
+
+
+def brute_distances(a, b, boxsize=None):
+    diff = np.abs(a - b)
+    if boxsize is not None:
+        diff = np.minimum(diff, boxsize - diff)
+    return np.sqrt((diff**2).sum(axis=-1))
+
+
+@pytest.mark.parametrize("boxsize", [None, 1.0])
+def test_insert_remove(boxsize):
+    np.random.seed(1234)
+    m = 3
+    data = np.random.rand(50, m)
+    tree = DynamicKDTree(data, leafsize=4, boxsize=boxsize)
+    points = dict(enumerate(data))
+    x = np.random.rand(20, m)
+
+    for step in range(30):
+        new = np.random.rand(np.random.randint(10, 40), m)
+        points.update(zip(tree.insert(new), new))
+        gone = np.random.choice(sorted(points),
+                                np.random.randint(0, len(points) // 3),
+                                replace=False)
+        tree.remove(gone)
+        for i in gone:
+            del points[i]
+
+        ids = np.array(sorted(points), dtype=np.intp)
+        data = np.array([points[i] for i in ids])
+        assert_equal(tree.n, len(ids))
+
+        k = 12
+        d, i = tree.query(x, k=k)
+        expected = np.sort(brute_distances(data[np.newaxis, :, :],
+                                           x[:, np.newaxis, :], boxsize),
+                           axis=1)[:, :k]
+        assert_allclose(d, expected)
+        # the ids are those of distinct points at these distances
+        assert_equal([len(set(row)) for row in i], k)
+        found = np.array([[points[j] for j in row] for row in i])
+        assert_allclose(brute_distances(found, x[:, np.newaxis, :], boxsize),
+                        d)
+
+        r = 0.2
+        expected = cKDTree(data, boxsize=boxsize).query_ball_point(x, r)
+        found = tree.query_ball_point(x, r)
+        for e, f in zip(expected, found):
+            assert_equal(f, sorted(ids[e]))
+
+
+def test_query_like_ckdtree():
+    np.random.seed(3)
+    data = np.random.rand(40, 3)
+    tree = DynamicKDTree(data)
+    ctree = cKDTree(data)
+    x = np.random.rand(3, 4, 3)
+    for k in [1, 2, [1], [2, 4]]:
+        d, i = tree.query(x, k=k)
+        cd, ci = ctree.query(x, k=k)
+        assert_equal(np.shape(d), np.shape(cd))
+        assert_allclose(d, cd)
+        assert_equal(i, ci)
+    d, i = tree.query(x[0, 0])
+    cd, ci = ctree.query(x[0, 0])
+    assert_allclose(d, cd)
+    assert_equal(i, ci)
+
+
+def test_too_few_points():
+    tree = DynamicKDTree(np.zeros((0, 2)))
+    assert_equal(tree.n, 0)
+    d, i = tree.query([[0.5, 0.5]], k=2)
+    assert_equal(d, [[np.inf, np.inf]])
+    assert_equal(i, [[-1, -1]])
+    assert_equal(tree.query_ball_point([0.5, 0.5], 1.), [])
+
+    tree.insert([[0., 0.], [1., 1.]])
+    tree.remove([0])
+    d, i = tree.query([[0.5, 0.5]], k=3)
+    assert_allclose(d, [[np.sqrt(0.5), np.inf, np.inf]])
+    assert_equal(i, [[1, -1, -1]])
+
+    d, i = tree.query([[0.5, 0.5]], k=1, distance_upper_bound=0.1)
+    assert_equal(d, [np.inf])
+    assert_equal(i, [-1])
+
+
+def test_remove_invalid():
+    np.random.seed(4)
+    tree = DynamicKDTree(np.random.rand(10, 2))
+    assert_raises(ValueError, tree.remove, [10])
+    assert_raises(ValueError, tree.remove, [-1])
+    tree.remove([3])
+    assert_raises(ValueError, tree.remove, [2, 3])
+    # nothing is removed by a failing call
+    assert_equal(tree.n, 9)
+    assert_equal(tree.query_ball_point([0.5, 0.5], 2.),
+                 [0, 1, 2, 4, 5, 6, 7, 8, 9])
+
+
+def test_insert_invalid():
+    np.random.seed(5)
+    tree = DynamicKDTree(np.random.rand(10, 2))
+    assert_raises(ValueError, tree.insert, np.random.rand(3, 3))
+    assert_raises(ValueError, DynamicKDTree, np.random.rand(10))
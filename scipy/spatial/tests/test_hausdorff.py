@@ -123,3 +123,35 @@ class TestHausdorff(object):
         B = np.random.rand(4, 5)
         with pytest.raises(ValueError):
             directed_hausdorff(A, B)
+
+    @pytest.mark.parametrize('shape', [(10, 20), (500, 400), (300, 1000)])
+    def test_workers_seed(self, shape):
+        # The kd-tree ordering, the seed and the threads must not change
+        # the result
+        rng = np.random.RandomState(1234)
+        u = rng.rand(shape[0], 3)
+        v = rng.rand(shape[1], 3)
+        d = distance.cdist(u, v).min(axis=1)
+        expected = (d.max(), np.argmax(d),
+                    np.argmin(distance.cdist(u[np.argmax(d)][None], v)))
+        for seed in [0, None, 27870671]:
+            for workers in [1, 2, -1]:
+                actual = directed_hausdorff(u, v, seed, workers=workers)
+                assert_almost_equal(actual[0], expected[0], decimal=12)
+                assert_equal(actual[1:], expected[1:])
+
+    def test_ties(self):
+        # Ties go to the smallest indices
+        u = np.array([[0, 0], [5, 5], [0, 5], [5, 0], [1, 1]] * 20, float)
+        v = np.array([[2, 0], [0, 2], [3, 5], [5, 3]] * 30, float)
+        for workers in [1, 3]:
+            actual = directed_hausdorff(u, v, workers=workers)
+            # u[2] is 3 away from both v[1] and v[2]
+            assert_almost_equal(actual[0], 3., decimal=12)
+            assert_equal(actual[1:], (2, 1))
+
+    def test_empty(self):
+        with pytest.raises(ValueError):
+            directed_hausdorff(np.zeros((0, 2)), self.path_1[:, :2])
+        with pytest.raises(ValueError):
+            directed_hausdorff(self.path_1, np.zeros((0, 3)))
@@ -4,7 +4,8 @@
 from __future__ import division, print_function, absolute_import
 
 from numpy.testing import (assert_equal, assert_array_equal, assert_,
-                           assert_almost_equal, assert_array_almost_equal)
+                           assert_almost_equal, assert_array_almost_equal,
+                           assert_allclose)
 from pytest import raises as assert_raises
 import pytest
 from platform import python_implementation
@@ -933,6 +934,125 @@ def test_ckdtree_build_modes():
     assert_array_equal(T1, T3)
     assert_array_equal(T1, T4)
 
+def test_ckdtree_parallel_build():
+    # check if building the tree on several threads gives
+    # the same tree as a serial build
+    np.random.seed(0)
+    n = 300000
+    k = 3
+    points = np.random.randn(n, k)
+    q = np.random.randn(100, k)
+    for balanced in (True, False):
+        for compact in (True, False):
+            T1 = cKDTree(points, balanced_tree=balanced,
+                         compact_nodes=compact)
+            T2 = cKDTree(points, balanced_tree=balanced,
+                         compact_nodes=compact, n_jobs=4)
+            assert_equal(T1.size, T2.size)
+            assert_array_equal(T1.indices, T2.indices)
+            assert_array_equal(T1.query(q, k=5)[-1], T2.query(q, k=5)[-1])
+    T3 = cKDTree(points, n_jobs=-1)
+    assert_array_equal(T1.query(q, k=5)[-1], T3.query(q, k=5)[-1])
+
+def test_ckdtree_balanced_build_sorted_and_tied():
+    # sorted input made the median selection quadratic; many ties make
+    # the split slide
+    np.random.seed(0)
+    n = 20000
+    sorted_points = np.c_[np.linspace(0, 1, n), np.linspace(0, 1, n)[::-1],
+                          np.random.uniform(size=n)]
+    tied_points = np.floor(np.random.uniform(size=(n, 3)) * 5) / 5
+    q = np.random.uniform(size=(50, 3))
+    for points in (sorted_points, tied_points):
+        T = cKDTree(points, balanced_tree=True, leafsize=4)
+        d, i = T.query(q, k=5)
+        d_brute = np.sort(distance_matrix(q, points), axis=1)[:, :5]
+        assert_allclose(d, d_brute)
+        assert_allclose(np.linalg.norm(points[i] - q[:, None, :], axis=-1), d)
+
+def test_ckdtree_reorder_data():
+    # queries on a tree with a tree order copy of the data
+    # give the same results, also after pickling
+    import pickle
+    np.random.seed(0)
+    points = np.random.randn(5000, 3)
+    q = np.random.randn(200, 3)
+    T1 = cKDTree(points)
+    T2 = cKDTree(points, reorder_data=True)
+    T3 = pickle.loads(pickle.dumps(T2))
+    for T in (T2, T3):
+        assert_array_equal(T1.query(q, k=5)[0], T.query(q, k=5)[0])
+        assert_array_equal(T1.query(q, k=5)[1], T.query(q, k=5)[1])
+        assert_equal(list(T1.query_ball_point(q, 0.3)),
+                     list(T.query_ball_point(q, 0.3)))
+
+def test_ckdtree_float32():
+    # a float32 tree gives the same results as a float64 tree
+    # over the same, rounded points
+    import pickle
+    np.random.seed(0)
+    points = np.random.randn(5000, 3).astype(np.float32)
+    q = np.random.randn(200, 3)
+    T1 = cKDTree(points.astype(np.float64))
+    T2 = cKDTree(points, dtype=np.float32)
+    T3 = cKDTree(points, dtype=np.float32, reorder_data=True)
+    T4 = pickle.loads(pickle.dumps(T3))
+    assert_equal(T2.data.dtype, np.float32)
+    for T in (T2, T3, T4):
+        assert_array_equal(T1.query(q, k=5)[0], T.query(q, k=5)[0])
+        assert_array_equal(T1.query(q, k=5)[1], T.query(q, k=5)[1])
+        assert_equal(list(T1.query_ball_point(q, 0.3)),
+                     list(T.query_ball_point(q, 0.3)))
+        assert_equal(T1.query_pairs(0.1), T.query_pairs(0.1))
+        assert_equal(T1.query_ball_tree(T1, 0.2), T.query_ball_tree(T, 0.2))
+        # trees of different dtypes
+        assert_equal(T1.count_neighbors(T1, 0.2), T.count_neighbors(T1, 0.2))
+        assert_equal(T1.sparse_distance_matrix(T1, 0.2, output_type='dict'),
+                     T.sparse_distance_matrix(T1, 0.2, output_type='dict'))
+    assert_raises(ValueError, cKDTree, points, dtype=np.int32)
+
+def test_ckdtree_reorder_queries():
+    # queries grouped by leaf give the same results in the same order
+    np.random.seed(0)
+    points = np.random.rand(5000, 3)
+    q = np.random.rand(2000, 3)
+    for boxsize in (None, 1.0):
+        T = cKDTree(points, leafsize=8, boxsize=boxsize)
+        d1, i1 = T.query(q, k=[1, 3, 20])
+        for n_jobs in (1, 4):
+            d2, i2 = T.query(q, k=[1, 3, 20], n_jobs=n_jobs,
+                             reorder_queries=True)
+            assert_array_equal(d1, d2)
+            assert_array_equal(i1, i2)
+
+def test_ckdtree_query_max_leaves():
+    np.random.seed(0)
+    points = np.random.rand(5000, 6)
+    q = np.random.rand(500, 6)
+    for boxsize in (None, 1.0):
+        T = cKDTree(points, leafsize=8, boxsize=boxsize)
+        d1, i1 = T.query(q, k=5)
+        # a budget the searches never reach gives the exact result
+        d2, i2, n_capped = T.query(q, k=5, max_leaves=T.n,
+                                   return_n_capped=True)
+        assert_array_equal(d1, d2)
+        assert_array_equal(i1, i2)
+        assert_equal(n_capped, 0)
+        for n_jobs in (1, 4):
+            d3, i3, n_capped = T.query(q, k=5, max_leaves=2, n_jobs=n_jobs,
+                                       return_n_capped=True)
+            assert_(0 < n_capped <= len(q))
+            # no better than exact, but real neighbors at their distances
+            assert_(np.all(d3 >= d1 - 1e-15))
+            found = i3 < T.n
+            assert_(found[:, 0].all())
+            dist = np.abs(points[i3[found]] - np.repeat(q, 5, axis=0)[
+                found.ravel()])
+            if boxsize is not None:
+                dist = np.minimum(dist, boxsize - dist)
+            assert_allclose(np.sqrt((dist**2).sum(axis=-1)), d3[found])
+    assert_raises(ValueError, T.query, q, max_leaves=0)
+
 def test_ckdtree_pickle():
     # test if it is possible to pickle
     # a cKDTree
@@ -969,6 +1089,40 @@ def test_ckdtree_pickle_boxsize():
     T2 = T2.query(points, k=5)[-1]
     assert_array_equal(T1, T2)
 
+@pytest.mark.parametrize("mmap_mode", ['r', 'c', None])
+@pytest.mark.parametrize("kwargs", [dict(), dict(boxsize=1.0),
+                                    dict(dtype=np.float32, reorder_data=True)])
+def test_ckdtree_save_load(tmpdir, mmap_mode, kwargs):
+    np.random.seed(0)
+    points = np.random.uniform(size=(500, 3))
+    T1 = cKDTree(points, leafsize=4, **kwargs)
+    filename = str(tmpdir.join('tree.ckd'))
+    T1.save(filename)
+    T2 = cKDTree.load(filename, mmap_mode=mmap_mode)
+    assert_equal(T2.n, T1.n)
+    assert_equal(T2.size, T1.size)
+    assert_equal(T2.data.dtype, T1.data.dtype)
+    assert_array_equal(T2.data, T1.data)
+    assert_array_equal(T2.indices, T1.indices)
+    assert_equal(T2.boxsize, T1.boxsize)
+    q = np.random.uniform(size=(100, 3))
+    assert_array_equal(T2.query(q, k=5)[1], T1.query(q, k=5)[1])
+    assert_equal(T2.query_pairs(0.05), T1.query_pairs(0.05))
+    del T2
+
+def test_ckdtree_load_invalid(tmpdir):
+    filename = str(tmpdir.join('tree.ckd'))
+    with open(filename, 'wb') as f:
+        f.write(b'not a tree')
+    assert_raises(ValueError, cKDTree.load, filename)
+
+    cKDTree(np.random.uniform(size=(50, 2))).save(filename)
+    with open(filename, 'r+b') as f:
+        f.seek(8)
+        f.write(np.array([99], dtype=np.int64).tobytes())
+    assert_raises(ValueError, cKDTree.load, filename)
+    assert_raises(ValueError, cKDTree.load, filename, mmap_mode='w+')
+
 def test_ckdtree_copy_data():
     # check if copy_data=True makes the kd-tree
     # impervious to data corruption by modification of
@@ -998,6 +1152,105 @@ def test_ckdtree_parallel():
     assert_array_equal(T1, T2)
     assert_array_equal(T1, T3)
 
+def test_ckdtree_parallel_small_queries():
+    # many small queries reuse the same worker threads, also when
+    # several Python threads query at the same time
+    import threading
+    np.random.seed(0)
+    points = np.random.randn(5000, 3)
+    T = cKDTree(points)
+    q = np.random.randn(1000, 3)
+    d0, i0 = T.query(q, k=3)
+    l0 = T.query_ball_point(q, 0.2)
+    errors = []
+
+    def run():
+        try:
+            for start in range(0, len(q), 20):
+                d, i = T.query(q[start:start + 20], k=3, n_jobs=4)
+                assert_array_equal(i, i0[start:start + 20])
+                assert_array_equal(d, d0[start:start + 20])
+                l = T.query_ball_point(q[start:start + 20], 0.2, n_jobs=4)
+                assert_equal(list(l), list(l0[start:start + 20]))
+        except Exception as e:
+            errors.append(e)
+
+    threads = [threading.Thread(target=run) for _ in range(3)]
+    for t in threads:
+        t.start()
+    run()
+    for t in threads:
+        t.join()
+    assert_equal(errors, [])
+
+    assert_equal(T.query(np.empty((0, 3)), k=2, n_jobs=4)[0].shape, (0, 2))
+    assert_equal(T.query_ball_point(np.empty((0, 3)), 0.2, n_jobs=4).shape,
+                 (0,))
+
+def test_ckdtree_parallel_dual_tree():
+    # the dual-tree methods give the same results on several threads
+    np.random.seed(1234)
+    x = np.random.uniform(size=(3000, 3))
+    y = np.random.uniform(size=(3000, 3))
+    w = np.random.uniform(size=3000)
+    for boxsize in (None, 1.0):
+        T1 = cKDTree(x, boxsize=boxsize, leafsize=4)
+        T2 = cKDTree(y, boxsize=boxsize, leafsize=4)
+        r = np.linspace(0.01, 0.2, 10)
+        for cumulative in (True, False):
+            assert_array_equal(
+                T1.count_neighbors(T2, r, cumulative=cumulative),
+                T1.count_neighbors(T2, r, cumulative=cumulative, n_jobs=4))
+            assert_allclose(
+                T1.count_neighbors(T1, r, weights=w, cumulative=cumulative),
+                T1.count_neighbors(T1, r, weights=w, cumulative=cumulative,
+                                   n_jobs=-1))
+        assert_equal(T1.query_pairs(0.05),
+                     T1.query_pairs(0.05, n_jobs=4))
+        assert_equal(T1.query_ball_tree(T2, 0.05),
+                     T1.query_ball_tree(T2, 0.05, n_jobs=4))
+        M1 = T1.sparse_distance_matrix(T2, 0.05, output_type='coo_matrix')
+        M2 = T1.sparse_distance_matrix(T2, 0.05, output_type='coo_matrix',
+                                       n_jobs=4)
+        assert_array_equal(M1.toarray(), M2.toarray())
+
+@pytest.mark.parametrize("n_jobs", [1, 4])
+def test_ckdtree_batched_output(n_jobs):
+    # the batches passed to callback make up the full results
+    np.random.seed(1234)
+    x = np.random.uniform(size=(2000, 3))
+    y = np.random.uniform(size=(1500, 3))
+    T1 = cKDTree(x, leafsize=4)
+    T2 = cKDTree(y, leafsize=4)
+    r = 0.06
+
+    batches = []
+    assert_(T1.query_pairs(r, n_jobs=n_jobs, callback=batches.append,
+                           batch_size=100) is None)
+    assert_(all(len(b) == 100 for b in batches[:-1]))
+    assert_(0 < len(batches[-1]) <= 100)
+    assert_equal(set(map(tuple, np.concatenate(batches))), T1.query_pairs(r))
+
+    batches = []
+    T1.sparse_distance_matrix(T2, r, n_jobs=n_jobs, callback=batches.append,
+                              batch_size=100)
+    assert_(all(len(b) == 100 for b in batches[:-1]))
+    entries = np.concatenate(batches)
+    expected = T1.sparse_distance_matrix(T2, r, output_type='dict')
+    assert_equal(len(entries), len(expected))
+    assert_equal(dict(((i, j), v) for i, j, v in entries), expected)
+
+    # an exception in callback stops the search
+    calls = []
+    def stop(batch):
+        calls.append(len(batch))
+        if len(calls) == 3:
+            raise KeyError("stop")
+    assert_raises(KeyError, T1.query_pairs, r, n_jobs=n_jobs, callback=stop,
+                  batch_size=10)
+    assert_equal(calls, [10, 10, 10])
+    assert_raises(ValueError, T1.query_pairs, r, callback=stop, batch_size=0)
+
 def test_ckdtree_view():
     # Check that the nodes can be correctly viewed from Python.
     # This test also sanity checks each node in the cKDTree, and
@@ -1124,6 +1377,25 @@ def test_ckdtree_box_lower_bounds():
     data = np.linspace(-1, 1, 10)
     assert_raises(ValueError, cKDTree, data, leafsize=1, boxsize=1.0)
 
+@pytest.mark.parametrize("boxsize", [[1.0, 2.0, 1.5], [1.0, 0.0, 1.5]])
+def test_ckdtree_box_brute_force(boxsize):
+    # boxes periodic in every dimension and in some of them
+    np.random.seed(1234)
+    boxsize = np.array(boxsize)
+    scale = np.where(boxsize > 0, boxsize, 1.0)
+    x = np.random.uniform(size=(300, 3)) * scale
+    y = np.random.uniform(size=(200, 3)) * scale
+    T1 = cKDTree(x, leafsize=4, boxsize=boxsize)
+    T2 = cKDTree(y, leafsize=4, boxsize=boxsize)
+    for p in [1, 2, 3.0, np.inf]:
+        d = distance_box(x[:, np.newaxis, :], y[np.newaxis, :, :], p, boxsize)
+        r = 0.3
+        assert_equal(T1.count_neighbors(T2, r, p=p), (d <= r).sum())
+        M = T1.sparse_distance_matrix(T2, r, p=p).toarray()
+        assert_allclose(M, np.where(d <= r, d, 0))
+        dd, ii = T2.query(x, k=3, p=p)
+        assert_allclose(dd, np.sort(d, axis=1)[:, :3])
+
 def simulate_periodic_box(kdtree, data, k, boxsize, p):
     dd = []
     ii = []
@@ -1257,6 +1529,39 @@ def test_ckdtree_count_neighbous_multiple_r():
         n = kdtree.count_neighbors(kdtree, r)
         assert_array_equal(n, n0[list(i)])
 
+@pytest.mark.parametrize("n_jobs", [1, 4])
+def test_ckdtree_count_neighbors_many_bins(n_jobs):
+    # many bins, weighted trees of different sizes, against brute force
+    np.random.seed(1234)
+    x = np.random.uniform(size=(400, 3))
+    y = np.random.uniform(size=(300, 3))
+    wx = np.random.uniform(size=len(x))
+    wy = np.random.uniform(size=len(y))
+    T1 = cKDTree(x, leafsize=4)
+    T2 = cKDTree(y, leafsize=4)
+    r = np.linspace(0, 0.8, 100)
+    d = minkowski_distance(x[:, np.newaxis, :], y[np.newaxis, :, :])
+    w = wx[:, np.newaxis] * wy[np.newaxis, :]
+    bins = np.searchsorted(r, d)
+
+    counts = np.bincount(bins.ravel(), minlength=len(r) + 1)[:len(r)]
+    weighted = np.bincount(bins.ravel(), w.ravel(),
+                           minlength=len(r) + 1)[:len(r)]
+    assert_array_equal(T1.count_neighbors(T2, r, n_jobs=n_jobs),
+                       counts.cumsum())
+    assert_array_equal(T1.count_neighbors(T2, r, cumulative=False,
+                                          n_jobs=n_jobs), counts)
+    assert_allclose(T1.count_neighbors(T2, r, weights=(wx, wy),
+                                       n_jobs=n_jobs), weighted.cumsum())
+    assert_allclose(T1.count_neighbors(T2, r, weights=(wx, wy),
+                                       cumulative=False, n_jobs=n_jobs),
+                    weighted)
+    assert_allclose(T1.count_neighbors(T2, r, weights=(None, wy),
+                                       n_jobs=n_jobs),
+                    np.bincount(bins.ravel(), np.broadcast_to(wy, d.shape)
+                                .ravel(), minlength=len(r) + 1)[:len(r)]
+                    .cumsum())
+
 def test_len0_arrays():
     # make sure len-0 arrays are handled correctly
     # in range queries (gh-5639)
@@ -1389,6 +1694,96 @@ def test_query_ball_point_length():
     assert_array_equal(length, length3)
     assert_array_equal(length, length4)
 
+@pytest.mark.parametrize("n_jobs", [1, 4])
+@pytest.mark.parametrize("boxsize", [None, 1.0])
+def test_query_ball_csr(n_jobs, boxsize):
+    np.random.seed(1234)
+    data = np.random.uniform(size=(300, 3))
+    query = np.random.uniform(size=(5, 40, 3))
+    tree = cKDTree(data, leafsize=4, boxsize=boxsize)
+    r = 0.15
+
+    expected = tree.query_ball_point(query, r).ravel()
+    indices, indptr = tree.query_ball_point(query, r, n_jobs=n_jobs,
+                                            output_type='csr')
+    assert_equal(indptr.shape, (201,))
+    assert_equal(indptr[0], 0)
+    assert_equal(indptr[-1], len(indices))
+    for i, e in enumerate(expected):
+        assert_array_equal(indices[indptr[i]:indptr[i+1]], e)
+
+    indices, indptr = tree.query_ball_point(query[0, 0], r,
+                                            output_type='csr')
+    assert_array_equal(indices, tree.query_ball_point(query[0, 0], r))
+
+    other = cKDTree(query.reshape(-1, 3), boxsize=boxsize)
+    expected = other.query_ball_tree(tree, r)
+    indices, indptr = other.query_ball_tree(tree, r, n_jobs=n_jobs,
+                                            output_type='csr')
+    assert_equal(indptr.shape, (201,))
+    for i, e in enumerate(expected):
+        assert_array_equal(indices[indptr[i]:indptr[i+1]], e)
+
+    assert_raises(ValueError, tree.query_ball_point, query, r,
+                  return_length=True, output_type='csr')
+    assert_raises(ValueError, tree.query_ball_point, query, r,
+                  output_type='dict')
+    assert_raises(ValueError, other.query_ball_tree, tree, r,
+                  output_type='dict')
+
+def test_ckdtree_stats():
+    np.random.seed(1234)
+    x = np.random.uniform(size=(500, 3))
+    q = np.random.uniform(size=(50, 3))
+    T = cKDTree(x, leafsize=8)
+    assert_(not T.collect_stats)
+    assert_(T.stats is None)
+
+    T.collect_stats = True
+    zero = dict(nodes_visited=0, leaves_scanned=0, distance_evaluations=0,
+                pruned_subtrees=0, heap_pushes=0, max_stack_depth=0)
+    assert_equal(T.stats, zero)
+
+    T.query(q, k=3)
+    s = T.stats
+    assert_(s['leaves_scanned'] >= len(q))
+    assert_(s['distance_evaluations'] >= s['leaves_scanned'])
+    assert_(s['nodes_visited'] > s['leaves_scanned'])
+    assert_(s['heap_pushes'] > 0)
+    assert_equal(s['max_stack_depth'], 0)
+
+    # the counts of independent queries do not depend on the threads
+    T.reset_stats()
+    T.query(q, k=3, n_jobs=4)
+    assert_equal(T.stats, s)
+
+    T.reset_stats()
+    T.query_ball_point(q, 0.2)
+    s = T.stats
+    assert_(s['leaves_scanned'] > 0)
+    assert_(s['pruned_subtrees'] > 0)
+    assert_(s['max_stack_depth'] > 0)
+    T.reset_stats()
+    T.query_ball_point(q, 0.2, n_jobs=4)
+    assert_equal(T.stats, s)
+
+    # everything is in range, no distances needed
+    T.reset_stats()
+    T.query_ball_point(q, 10.)
+    assert_equal(T.stats['distance_evaluations'], 0)
+    assert_equal(T.stats['nodes_visited'], len(q) * T.size)
+
+    T.reset_stats()
+    T.count_neighbors(cKDTree(q), [0.1, 0.2])
+    assert_(T.stats['nodes_visited'] > 0)
+    assert_(T.stats['distance_evaluations'] > 0)
+
+    T.collect_stats = False
+    assert_(T.stats is None)
+    T.query(q)
+    T.collect_stats = True
+    assert_equal(T.stats, zero)
+
 class Test_sorted_query_ball_point(object):
 
     def setup_method(self):
@@ -200,6 +200,35 @@ class TestUtilities(object):
             j = qhull.tsearch(tri, p[:2])
             assert_equal(i, j)
 
+    @pytest.mark.parametrize('ndim', [2, 3])
+    def test_find_simplex_bulk(self, ndim):
+        # Morton-ordered chunks on several threads must still locate all
+        # points, whatever the order of the queries
+        rng = np.random.RandomState(1234)
+        tri = qhull.Delaunay(rng.rand(200, ndim))
+        xi = rng.rand(10000, ndim) * 1.2 - 0.1
+
+        i, c = tri.find_simplex(xi, return_barycentric=True)
+        assert_equal(c.shape, (10000, ndim + 1))
+        ib = tri.find_simplex(xi, bruteforce=True, workers=3)
+        assert_equal(i == -1, ib == -1)
+
+        inside = i != -1
+        T = tri.transform[i[inside]]
+        expected = np.einsum('ijk,ik->ij', T[:, :ndim],
+                             xi[inside] - T[:, ndim])
+        assert_allclose(c[inside, :ndim], expected, atol=1e-12)
+        assert_allclose(c[inside].sum(axis=1), 1, atol=1e-12)
+        assert_((c[inside] >= -1e-12).all())
+        assert_(np.isnan(c[~inside]).all())
+
+        for workers in [2, 5, -1]:
+            assert_equal(tri.find_simplex(xi, workers=workers), i)
+        assert_equal(tri.find_simplex(xi[::-1]), i[::-1])
+        assert_equal(tri.find_simplex(xi.reshape(100, 100, ndim)),
+                     i.reshape(100, 100))
+        assert_raises(ValueError, tri.find_simplex, xi, workers=0)
+
     def test_plane_distance(self):
         # Compare plane distance from hyperplane equations obtained from Qhull
         # to manually computed plane equations
@@ -288,6 +317,53 @@ class TestUtilities(object):
             assert_allclose(hull.area, inc_hull.area, rtol=1e-7)
             assert_allclose(hull.area, inc_restart_hull.area, rtol=1e-7)
 
+    @pytest.mark.parametrize("cls", [qhull.Delaunay, qhull.ConvexHull,
+                                     qhull.Voronoi])
+    def test_set_points(self, cls):
+        # moving the points a little at each step, and changing their
+        # number, gives the same result as building from scratch with
+        # the same options
+        np.random.seed(1234)
+        points = np.random.rand(30, 3)
+        obj = cls(points, incremental=True)
+        for step in range(5):
+            points = points + 0.01 * np.random.randn(*points.shape)
+            if step == 3:
+                points = np.concatenate([points, np.random.rand(10, 3)])
+            obj.set_points(points)
+            ref = cls(points, incremental=True)
+            assert_equal(obj.points, ref.points)
+            assert_equal(obj.npoints, points.shape[0])
+            if cls is qhull.Voronoi:
+                assert_equal(obj.vertices, ref.vertices)
+                assert_equal(obj.ridge_points, ref.ridge_points)
+            else:
+                assert_equal(obj.simplices, ref.simplices)
+                assert_equal(obj.neighbors, ref.neighbors)
+        obj.close()
+
+    def test_set_points_errors(self):
+        points = np.random.rand(10, 2)
+        tri = qhull.Delaunay(points)
+        assert_raises(RuntimeError, tri.set_points, points)
+
+        tri = qhull.Delaunay(points, incremental=True)
+        assert_raises(ValueError, tri.set_points, np.random.rand(10, 3))
+        assert_raises(ValueError, tri.set_points, np.zeros((0, 2)))
+        bad = points.copy()
+        bad[3, 1] = np.nan
+        assert_raises(ValueError, tri.set_points, bad)
+
+        # the context stays usable after rejected input
+        tri.set_points(points[::-1])
+        assert_equal(tri.points, points[::-1])
+
+        # and is closed after Qhull fails, keeping the previous result
+        simplices = tri.simplices
+        assert_raises(qhull.QhullError, tri.set_points, np.zeros((4, 2)))
+        assert_equal(tri.simplices, simplices)
+        assert_raises(RuntimeError, tri.set_points, points)
+
     def _check_barycentric_transforms(self, tri, err_msg="",
                                       unit_cube=False,
                                       unit_cube_tol=0):
@@ -841,6 +917,34 @@ class TestVoronoi:
         """
         self._compare_qvoronoi(points, output)
 
+    def test_csr(self):
+        # The CSR arrays hold the same ridges and regions as the lists
+        np.random.seed(1234)
+        points = np.random.rand(200, 3)
+        vor = qhull.Voronoi(points)
+
+        for indptr, indices, lists in [
+                (vor.ridge_indptr, vor.ridge_indices, vor.ridge_vertices),
+                (vor.region_indptr, vor.region_indices, vor.regions)]:
+            assert_equal(indptr[0], 0)
+            assert_equal(indptr[-1], len(indices))
+            assert_equal(len(indptr), len(lists) + 1)
+            for k, item in enumerate(lists):
+                assert_equal(indices[indptr[k]:indptr[k+1]].tolist(), item)
+
+        assert_equal(len(vor.ridge_indptr), len(vor.ridge_points) + 1)
+        assert_(vor.point_region.max() < len(vor.region_indptr) - 1)
+
+        x = qhull._Qhull(b'v', points, b'Qbb Qc Qz')
+        try:
+            d = x.get_voronoi_diagram(compact=True)
+        finally:
+            x.close()
+        assert_equal(d[2][0], vor.ridge_indptr)
+        assert_equal(d[2][1], vor.ridge_indices)
+        assert_equal(d[3][0], vor.region_indptr)
+        assert_equal(d[3][1], vor.region_indices)
+
     def _compare_qvoronoi(self, points, output, **kw):
         """Compare to output from 'qvoronoi o Fv < data' to Voronoi()"""
 
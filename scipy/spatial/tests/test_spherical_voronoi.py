@@ -1,7 +1,8 @@
 from __future__ import print_function
 import numpy as np
 import itertools
-from numpy.testing import (assert_equal,
+from numpy.testing import (assert_,
+                           assert_equal,
                            assert_almost_equal,
                            assert_array_equal,
                            assert_array_almost_equal)
@@ -125,6 +126,62 @@ class TestSphericalVoronoi(object):
         actual = list(itertools.chain(*sorted(sv.regions)))
         assert_array_equal(actual, expected)
 
+    def test_region_csr(self):
+        sv = SphericalVoronoi(self.points)
+        indptr, indices = sv.region_indptr, sv.region_indices
+        assert_equal(len(indptr), len(self.points) + 1)
+        regions = [indices[indptr[n]:indptr[n+1]].tolist()
+                   for n in range(len(self.points))]
+        assert_equal(regions, sv.regions)
+        # the triangles of the hull that contain each point, in order
+        for n, region in enumerate(regions):
+            expected = np.nonzero((sv._tri.simplices == n).any(axis=1))[0]
+            assert_equal(region, expected)
+
+        sv.sort_vertices_of_regions()
+        assert_equal(sv.regions,
+                     [indices[indptr[n]:indptr[n+1]].tolist()
+                      for n in range(len(self.points))])
+
+    def test_calculate_areas(self):
+        np.random.seed(1234)
+        points = np.random.randn(2000, 3)
+        points /= np.linalg.norm(points, axis=1)[:, np.newaxis]
+        center = np.array([1., -2., 0.5])
+        radius = 3.
+        sv = SphericalVoronoi(points * radius + center, radius, center)
+
+        unsorted = sv.region_indices.copy()
+        areas = sv.calculate_areas()
+        # computing the areas does not sort the regions
+        assert_equal(sv.region_indices, unsorted)
+        assert_equal(areas.shape, (2000,))
+        assert_(np.all(areas > 0))
+        assert_almost_equal(areas.sum(), 4 * np.pi * radius**2)
+
+        sv2 = SphericalVoronoi(points * radius + center, radius, center)
+        sv2.sort_vertices_of_regions(workers=4)
+        assert_array_almost_equal(sv2.calculate_areas(), areas)
+
+        sv.sort_vertices_of_regions()
+        assert_equal(sv.region_indices, sv2.region_indices)
+
+        # consecutive vertices of a sorted region share a hull edge with
+        # its generator
+        simplices = sv._tri.simplices
+        for n, region in enumerate(sv.regions[:100]):
+            for a, b in zip(region, region[1:] + region[:1]):
+                shared = set(simplices[a]) & set(simplices[b])
+                assert_(n in shared and len(shared) == 2)
+
+    def test_calculate_areas_cube(self):
+        # the regions of the vertices of a cube are equal
+        points = np.array([[x, y, z] for x in (-1, 1) for y in (-1, 1)
+                           for z in (-1, 1)]) / np.sqrt(3)
+        sv = SphericalVoronoi(points)
+        assert_array_almost_equal(sv.calculate_areas(),
+                                  np.full(8, 4 * np.pi / 8))
+
     def test_num_vertices(self):
         # for any n >= 3, a spherical Voronoi diagram has 2n - 4
         # vertices; this is a direct consequence of Euler's formula
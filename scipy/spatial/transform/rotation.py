@@ -5,6 +5,9 @@ import warnings
 import numpy as np
 import scipy.linalg
 from scipy._lib._util import check_random_state
+from ._rotation_kernels import (compose_quat, quat_to_dcm, dcm_to_quat,
+                                apply_quat, rotvec_to_quat, quat_to_rotvec,
+                                normalize_quat)
 
 
 _AXIS_TO_IND = {'x': 0, 'y': 1, 'z': 2}
@@ -150,10 +153,9 @@ def _make_elementary_quat(axis, angles):
 
 
 def _compose_quat(p, q):
-    product = np.empty((max(p.shape[0], q.shape[0]), 4))
-    product[:, 3] = p[:, 3] * q[:, 3] - np.sum(p[:, :3] * q[:, :3], axis=1)
-    product[:, :3] = (p[:, None, 3] * q[:, :3] + q[:, None, 3] * p[:, :3] +
-                      np.cross(p[:, :3], q[:, :3]))
+    n = q.shape[0] if p.shape[0] == 1 else p.shape[0]
+    product = np.empty((n, 4))
+    compose_quat(p, q, product)
     return product
 
 
@@ -378,16 +380,13 @@ class Rotation(object):
         if normalized:
             self._quat = quat.copy() if copy else quat
         else:
-            self._quat = quat.copy()
-            norms = scipy.linalg.norm(quat, axis=1)
+            if not np.isfinite(quat).all():
+                raise ValueError("array must not contain infs or NaNs")
 
-            zero_norms = norms == 0
-            if zero_norms.any():
+            self._quat = np.empty_like(quat)
+            if normalize_quat(quat, self._quat) >= 0:
                 raise ValueError("Found zero norm quaternions in `quat`.")
 
-            # Ensure norm is broadcasted along each column.
-            self._quat[~zero_norms] /= norms[~zero_norms][:, None]
-
     def __len__(self):
         """Number of rotations contained in this object.
 
@@ -577,30 +576,8 @@ class Rotation(object):
 
         num_rotations = dcm.shape[0]
 
-        decision_matrix = np.empty((num_rotations, 4))
-        decision_matrix[:, :3] = dcm.diagonal(axis1=1, axis2=2)
-        decision_matrix[:, -1] = decision_matrix[:, :3].sum(axis=1)
-        choices = decision_matrix.argmax(axis=1)
-
         quat = np.empty((num_rotations, 4))
-
-        ind = np.nonzero(choices != 3)[0]
-        i = choices[ind]
-        j = (i + 1) % 3
-        k = (j + 1) % 3
-
-        quat[ind, i] = 1 - decision_matrix[ind, -1] + 2 * dcm[ind, i, i]
-        quat[ind, j] = dcm[ind, j, i] + dcm[ind, i, j]
-        quat[ind, k] = dcm[ind, k, i] + dcm[ind, i, k]
-        quat[ind, 3] = dcm[ind, k, j] - dcm[ind, j, k]
-
-        ind = np.nonzero(choices == 3)[0]
-        quat[ind, 0] = dcm[ind, 2, 1] - dcm[ind, 1, 2]
-        quat[ind, 1] = dcm[ind, 0, 2] - dcm[ind, 2, 0]
-        quat[ind, 2] = dcm[ind, 1, 0] - dcm[ind, 0, 1]
-        quat[ind, 3] = 1 + decision_matrix[ind, -1]
-
-        quat /= np.linalg.norm(quat, axis=1)[:, None]
+        dcm_to_quat(dcm, quat)
 
         if is_single:
             return cls(quat[0], normalized=True, copy=False)
@@ -677,19 +654,8 @@ class Rotation(object):
 
         num_rotations = rotvec.shape[0]
 
-        norms = np.linalg.norm(rotvec, axis=1)
-        small_angle = (norms <= 1e-3)
-        large_angle = ~small_angle
-
-        scale = np.empty(num_rotations)
-        scale[small_angle] = (0.5 - norms[small_angle] ** 2 / 48 +
-                              norms[small_angle] ** 4 / 3840)
-        scale[large_angle] = (np.sin(norms[large_angle] / 2) /
-                              norms[large_angle])
-
         quat = np.empty((num_rotations, 4))
-        quat[:, :3] = scale[:, None] * rotvec
-        quat[:, 3] = np.cos(norms / 2)
+        rotvec_to_quat(rotvec, quat)
 
         if is_single:
             return cls(quat[0], normalized=True, copy=False)
@@ -953,37 +919,9 @@ class Rotation(object):
         (2, 3, 3)
 
         """
-        x = self._quat[:, 0]
-        y = self._quat[:, 1]
-        z = self._quat[:, 2]
-        w = self._quat[:, 3]
-
-        x2 = x * x
-        y2 = y * y
-        z2 = z * z
-        w2 = w * w
-
-        xy = x * y
-        zw = z * w
-        xz = x * z
-        yw = y * w
-        yz = y * z
-        xw = x * w
-
         num_rotations = len(self)
         dcm = np.empty((num_rotations, 3, 3))
-
-        dcm[:, 0, 0] = x2 - y2 - z2 + w2
-        dcm[:, 1, 0] = 2 * (xy + zw)
-        dcm[:, 2, 0] = 2 * (xz - yw)
-
-        dcm[:, 0, 1] = 2 * (xy - zw)
-        dcm[:, 1, 1] = - x2 + y2 - z2 + w2
-        dcm[:, 2, 1] = 2 * (yz + xw)
-
-        dcm[:, 0, 2] = 2 * (xz + yw)
-        dcm[:, 1, 2] = 2 * (yz - xw)
-        dcm[:, 2, 2] = - x2 - y2 + z2 + w2
+        quat_to_dcm(self._quat, dcm)
 
         if self._single:
             return dcm[0]
@@ -1036,23 +974,9 @@ class Rotation(object):
         (2, 3)
 
         """
-        quat = self._quat.copy()
-        # w > 0 to ensure 0 <= angle <= pi
-        quat[quat[:, 3] < 0] *= -1
-
-        angle = 2 * np.arctan2(np.linalg.norm(quat[:, :3], axis=1), quat[:, 3])
-
-        small_angle = (angle <= 1e-3)
-        large_angle = ~small_angle
-
         num_rotations = len(self)
-        scale = np.empty(num_rotations)
-        scale[small_angle] = (2 + angle[small_angle] ** 2 / 12 +
-                              7 * angle[small_angle] ** 4 / 2880)
-        scale[large_angle] = (angle[large_angle] /
-                              np.sin(angle[large_angle] / 2))
-
-        rotvec = scale[:, None] * quat[:, :3]
+        rotvec = np.empty((num_rotations, 3))
+        quat_to_rotvec(self._quat, rotvec)
 
         if self._single:
             return rotvec[0]
@@ -1282,7 +1206,7 @@ class Rotation(object):
                [ 1.09533535, -0.8365163 ,  0.3169873 ]])
 
         """
-        vectors = np.asarray(vectors)
+        vectors = np.asarray(vectors, dtype=float)
         if vectors.ndim > 2 or vectors.shape[-1] != 3:
             raise ValueError("Expected input of shape (3,) or (P, 3), "
                              "got {}.".format(vectors.shape))
@@ -1292,10 +1216,6 @@ class Rotation(object):
             single_vector = True
             vectors = vectors[None, :]
 
-        dcm = self.as_dcm()
-        if self._single:
-            dcm = dcm[None, :, :]
-
         n_vectors = vectors.shape[0]
         n_rotations = len(self)
 
@@ -1305,10 +1225,9 @@ class Rotation(object):
                              "{} rotations and {} vectors.".format(
                                 n_rotations, n_vectors))
 
-        if inverse:
-            result = np.einsum('ikj,ik->ij', dcm, vectors)
-        else:
-            result = np.einsum('ijk,ik->ij', dcm, vectors)
+        n = n_vectors if n_rotations == 1 else n_rotations
+        result = np.empty((n, 3))
+        apply_quat(self._quat, vectors, result, inverse)
 
         if self._single and single_vector:
             return result[0]
@@ -6,6 +6,9 @@ def configuration(parent_package='', top_path=None):
 
     config = Configuration('transform', parent_package, top_path)
 
+    config.add_extension('_rotation_kernels',
+                         sources=['_rotation_kernels.c'])
+
     config.add_data_dir('tests')
 
     return config
@@ -720,6 +720,65 @@ def test_apply_multiple_rotations_multiple_points():
     assert_allclose(r.apply(v, inverse=True), v_inverse)
 
 
+def test_apply_empty():
+    r = Rotation.from_quat([0, 0, 1, 1])
+    assert_equal(r.apply(np.zeros((0, 3))).shape, (0, 3))
+
+
+def test_kernels_reference():
+    # the compiled kernels against the numpy expressions they replaced
+    rnd = np.random.RandomState(0)
+    p = Rotation.random(100, random_state=rnd).as_quat()
+    q = Rotation.random(100, random_state=rnd).as_quat()
+    v = rnd.randn(100, 3)
+
+    product = np.empty((100, 4))
+    product[:, 3] = p[:, 3] * q[:, 3] - np.sum(p[:, :3] * q[:, :3], axis=1)
+    product[:, :3] = (p[:, None, 3] * q[:, :3] + q[:, None, 3] * p[:, :3] +
+                      np.cross(p[:, :3], q[:, :3]))
+    assert_allclose((Rotation.from_quat(p) * Rotation.from_quat(q)).as_quat(),
+                    product, atol=1e-15)
+
+    dcm = Rotation.from_quat(p).as_dcm()
+    assert_allclose(np.einsum('ijk,ik->ij', dcm, v),
+                    Rotation.from_quat(p).apply(v), atol=1e-14)
+    assert_allclose(np.einsum('ikj,ik->ij', dcm, v),
+                    Rotation.from_quat(p).apply(v, inverse=True), atol=1e-14)
+    assert_allclose(np.einsum('jk,ik->ij', dcm[0], v),
+                    Rotation.from_quat(p[0]).apply(v), atol=1e-14)
+
+
+def test_kernels_strided_in_place():
+    from scipy.spatial.transform import _rotation_kernels as kernels
+
+    rnd = np.random.RandomState(0)
+    p = Rotation.random(50, random_state=rnd).as_quat()
+    q = Rotation.random(50, random_state=rnd).as_quat()
+    expected = (Rotation.from_quat(p) * Rotation.from_quat(q)).as_quat()
+
+    # structure of arrays, passed as transposed views
+    p_soa = np.ascontiguousarray(p.T)
+    q_soa = np.ascontiguousarray(q.T)
+    out_soa = np.empty((4, 50))
+    kernels.compose_quat(p_soa.T, q_soa.T, out_soa.T)
+    assert_allclose(out_soa.T, expected, atol=1e-15)
+
+    # in place over the first operand
+    kernels.compose_quat(p, q, p)
+    assert_allclose(p, expected, atol=1e-15)
+
+    v = rnd.randn(50, 3)
+    expected = Rotation.from_quat(q).apply(v)
+    kernels.apply_quat(q, v, v)
+    assert_allclose(v, expected, atol=1e-15)
+
+    # read-only input
+    q.flags.writeable = False
+    out = np.empty((50, 3))
+    kernels.quat_to_rotvec(q, out)
+    assert_allclose(out, Rotation.from_quat(q).as_rotvec(), atol=1e-15)
+
+
 def test_getitem():
     dcm = np.empty((2, 3, 3))
     dcm[0] = np.array([
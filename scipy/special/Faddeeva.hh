@@ -28,6 +28,7 @@
 #define FADDEEVA_HH 1
 
 #include <complex>
+#include <cstddef>
 
 namespace Faddeeva {
 
@@ -57,6 +58,13 @@ extern double erfc(double x); // special case for real x
 extern std::complex<double> Dawson(std::complex<double> z, double relerr=0);
 extern double Dawson(double x); // special case for real x
 
+// Array versions of w, w_im and erfcx, evaluating out[i] = f(z[i]) for
+// i < n; out must not overlap the arguments
+extern void w(const std::complex<double> *z, std::complex<double> *out,
+              std::size_t n, double relerr=0);
+extern void w_im(const double *x, double *out, std::size_t n);
+extern void erfcx(const double *x, double *out, std::size_t n);
+
 }; // namespace Faddeeva
 
 #endif // FADDEEVA_HH
@@ -28,6 +28,8 @@ functions are provided.
    geterr                 -- Get the current way of handling special-function errors.
    seterr                 -- Set how special-function errors are handled.
    errstate               -- Context manager for special-function error handling.
+   set_workers            -- Context manager for the number of threads used.
+   get_workers            -- Get the number of threads used.
    SpecialFunctionWarning -- Warning that can be emitted by special functions.
    SpecialFunctionError   -- Exception that can be raised by special functions.
 
@@ -81,12 +83,15 @@ Bessel Functions
    hankel2  -- Hankel function of the second kind
    hankel2e -- Exponentially scaled Hankel function of the second kind
 
-The following is not an universal function:
+The following are not universal functions:
 
 .. autosummary::
    :toctree: generated/
 
    lmbda -- Jahnke-Emden Lambda function, Lambdav(x).
+   jv_seq -- Bessel functions of the first kind of a sequence of orders.
+   iv_seq -- Modified Bessel functions of the first kind of a sequence of orders.
+   kv_seq -- Modified Bessel functions of the second kind of a sequence of orders.
 
 Zeros of Bessel Functions
 ^^^^^^^^^^^^^^^^^^^^^^^^^
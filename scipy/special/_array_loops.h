@@ -0,0 +1,112 @@
+/*
+ * Helpers for the kernel functions that evaluate whole ufunc loop lines
+ * (LOOP_KERNELS in _generate_pyx.py) with an array version of a unary
+ * function.
+ *
+ * The array versions take contiguous, non-overlapping blocks of at most
+ * ARRAY_LOOP_BLOCK elements, which is small enough for their temporaries
+ * to live on the stack and in the cache. Strided and in-place lines are
+ * copied through a buffer.
+ */
+#ifndef ARRAY_LOOPS_H
+#define ARRAY_LOOPS_H
+
+#include <numpy/npy_common.h>
+
+#define ARRAY_LOOP_BLOCK 256
+
+/*
+ * The array versions are written as short passes over the block, plain
+ * arithmetic or a select storing its result, which compilers vectorize
+ * even without -ffast-math. GCC does so only from -O3 on, which is
+ * asked for here for the functions concerned.
+ */
+#if defined(__GNUC__) && !defined(__clang__) && !defined(__INTEL_COMPILER)
+#define ARRAY_LOOP_OPT __attribute__((optimize("O3")))
+#else
+#define ARRAY_LOOP_OPT
+#endif
+
+typedef void array_func_d(const double *x, double *y, int n);
+typedef void array_func_f(const float *x, float *y, int n);
+
+/* A double function on a double line */
+static NPY_INLINE void array_loop_d(char **args, npy_intp *dims,
+                                    npy_intp *steps, array_func_d *func)
+{
+    char *ip = args[0], *op = args[1];
+    npy_intp is = steps[0], os = steps[1], k = dims[0];
+    double x[ARRAY_LOOP_BLOCK], y[ARRAY_LOOP_BLOCK];
+    int i, n;
+
+    for (; k > 0; k -= n) {
+        n = k < ARRAY_LOOP_BLOCK ? (int)k : ARRAY_LOOP_BLOCK;
+        if (is == sizeof(double) && os == sizeof(double) && ip != op) {
+            func((const double *)ip, (double *)op, n);
+        }
+        else {
+            for (i = 0; i < n; i++) {
+                x[i] = *(double *)(ip + i * is);
+            }
+            func(x, y, n);
+            for (i = 0; i < n; i++) {
+                *(double *)(op + i * os) = y[i];
+            }
+        }
+        ip += n * is;
+        op += n * os;
+    }
+}
+
+/* A double function on a float line, as the casting loops do */
+static NPY_INLINE void array_loop_fd(char **args, npy_intp *dims,
+                                     npy_intp *steps, array_func_d *func)
+{
+    char *ip = args[0], *op = args[1];
+    npy_intp is = steps[0], os = steps[1], k = dims[0];
+    double x[ARRAY_LOOP_BLOCK], y[ARRAY_LOOP_BLOCK];
+    int i, n;
+
+    for (; k > 0; k -= n) {
+        n = k < ARRAY_LOOP_BLOCK ? (int)k : ARRAY_LOOP_BLOCK;
+        for (i = 0; i < n; i++) {
+            x[i] = *(float *)(ip + i * is);
+        }
+        func(x, y, n);
+        for (i = 0; i < n; i++) {
+            *(float *)(op + i * os) = (float)y[i];
+        }
+        ip += n * is;
+        op += n * os;
+    }
+}
+
+/* A float function on a float line */
+static NPY_INLINE void array_loop_f(char **args, npy_intp *dims,
+                                    npy_intp *steps, array_func_f *func)
+{
+    char *ip = args[0], *op = args[1];
+    npy_intp is = steps[0], os = steps[1], k = dims[0];
+    float x[ARRAY_LOOP_BLOCK], y[ARRAY_LOOP_BLOCK];
+    int i, n;
+
+    for (; k > 0; k -= n) {
+        n = k < ARRAY_LOOP_BLOCK ? (int)k : ARRAY_LOOP_BLOCK;
+        if (is == sizeof(float) && os == sizeof(float) && ip != op) {
+            func((const float *)ip, (float *)op, n);
+        }
+        else {
+            for (i = 0; i < n; i++) {
+                x[i] = *(float *)(ip + i * is);
+            }
+            func(x, y, n);
+            for (i = 0; i < n; i++) {
+                *(float *)(op + i * os) = y[i];
+            }
+        }
+        ip += n * is;
+        op += n * os;
+    }
+}
+
+#endif
@@ -3,6 +3,10 @@ from __future__ import absolute_import
 cdef extern from "limits.h":
     unsigned long ULONG_MAX
 
+cdef extern from "cephes/factorial.h":
+    int BINOM_TABLE_MAX
+    const unsigned long long *binom_table
+
 
 def _comb_int(N, k):
     # Fast path with machine integers
@@ -42,6 +46,9 @@ cdef unsigned long _comb_int_long(unsigned long N, unsigned long k):
     if k > N or N == ULONG_MAX:
         return 0
 
+    if N <= BINOM_TABLE_MAX and binom_table[N*(N + 1)//2 + k] <= ULONG_MAX:
+        return <unsigned long>binom_table[N*(N + 1)//2 + k]
+
     M = N + 1
     nterms = min(k, N - k)
 
@@ -1,11 +1,81 @@
 #include <complex>
+#include <algorithm>
+#include <cstring>
 
 #include "_faddeeva.h"
 
 using namespace std;
 
+/*
+ * Ufunc inner loops over the array versions of the Faddeeva functions.
+ * Contiguous lines are evaluated in place, others are copied through
+ * blocks on the stack; the blocks also cover out == in, which numpy
+ * allows for elementwise loops.
+ */
+
+#define FADDEEVA_LOOP_BLOCK 256
+
+template <typename T>
+static void faddeeva_loop(char **args, npy_intp *dims, npy_intp *steps,
+                          void (*kernel)(const T *, T *, size_t))
+{
+    char *ip = args[0], *op = args[1];
+    npy_intp n = dims[0], i0, i, m;
+    T in[FADDEEVA_LOOP_BLOCK], out[FADDEEVA_LOOP_BLOCK];
+
+    if (steps[0] == sizeof(T) && steps[1] == sizeof(T) && ip != op) {
+        kernel((const T *)ip, (T *)op, n);
+        return;
+    }
+    for (i0 = 0; i0 < n; i0 += FADDEEVA_LOOP_BLOCK) {
+        m = min(n - i0, (npy_intp)FADDEEVA_LOOP_BLOCK);
+        for (i = 0; i < m; ++i, ip += steps[0]) {
+            memcpy(&in[i], ip, sizeof(T));
+        }
+        kernel(in, out, m);
+        for (i = 0; i < m; ++i, op += steps[1]) {
+            memcpy(op, &out[i], sizeof(T));
+        }
+    }
+}
+
+static void w_line(const complex<double> *z, complex<double> *w, size_t n)
+{
+    Faddeeva::w(z, w, n);
+}
+
+static void erfcx_line(const double *x, double *y, size_t n)
+{
+    Faddeeva::erfcx(x, y, n);
+}
+
+static void dawsn_line(const double *x, double *y, size_t n)
+{
+    const double spi2 = 0.8862269254527580136490837416705725913990; // sqrt(pi)/2
+
+    Faddeeva::w_im(x, y, n);
+    for (size_t i = 0; i < n; ++i) {
+        y[i] *= spi2;
+    }
+}
+
 EXTERN_C_START
 
+void faddeeva_w_loop(char **args, npy_intp *dims, npy_intp *steps)
+{
+    faddeeva_loop(args, dims, steps, w_line);
+}
+
+void faddeeva_erfcx_loop(char **args, npy_intp *dims, npy_intp *steps)
+{
+    faddeeva_loop(args, dims, steps, erfcx_line);
+}
+
+void faddeeva_dawsn_loop(char **args, npy_intp *dims, npy_intp *steps)
+{
+    faddeeva_loop(args, dims, steps, dawsn_line);
+}
+
 npy_cdouble faddeeva_w(npy_cdouble zp)
 {
     complex<double> z(zp.real, zp.imag);
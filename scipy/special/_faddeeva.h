@@ -34,6 +34,10 @@ npy_cdouble faddeeva_dawsn_complex(npy_cdouble zp);
 npy_cdouble faddeeva_ndtr(npy_cdouble zp);
 npy_cdouble faddeeva_log_ndtr(npy_cdouble zp);
 
+void faddeeva_w_loop(char **args, npy_intp *dims, npy_intp *steps);
+void faddeeva_erfcx_loop(char **args, npy_intp *dims, npy_intp *steps);
+void faddeeva_dawsn_loop(char **args, npy_intp *dims, npy_intp *steps);
+
 EXTERN_C_END
 
 #endif
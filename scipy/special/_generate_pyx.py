@@ -39,6 +39,19 @@ ufunc input types, so functions listed earlier take precedence.
 In addition, versions with casted variables, such as d->f,D->F and
 i->d are automatically generated.
 
+Kernel functions listed in LOOP_KERNELS below also have versions that
+evaluate a whole line of the ufunc loop at once, with the prototype
+
+    void loop_kernel(char **args, npy_intp *dims, npy_intp *steps);
+
+declared in the same header. They are listed by the signature of the
+ufunc loop they replace, which may be one of the casted versions, such
+as f->f for a d->d kernel function; the other loops keep calling the
+kernel function for each element.
+
+The loops of the kernel functions listed in THREADED_KERNELS below run
+on several threads when `scipy.special.set_workers` asks for them.
+
 There should be either a single header that contains all of the kernel
 functions listed, or there should be one header for each kernel
 function. Cython pxd files are allowed in addition to .h files.
@@ -204,6 +217,52 @@ CYTHON_SPECIAL_BENCHFUNCS = {
 }
 
 
+# Kernel functions with a version evaluating whole ufunc loop lines,
+# see the module docstring
+LOOP_KERNELS = {
+    'erf': {'d->d': 'erf_loop'},
+    'expit': {'d->d': 'expit_loop'},
+    'expitf': {'f->f': 'expitf_loop'},
+    'faddeeva_dawsn': {'d->d': 'faddeeva_dawsn_loop'},
+    'faddeeva_erfcx': {'d->d': 'faddeeva_erfcx_loop'},
+    'faddeeva_w': {'D->D': 'faddeeva_w_loop'},
+    'log_ndtr': {'d->d': 'log_ndtr_loop', 'f->f': 'log_ndtr_loop_f'},
+    'logit': {'d->d': 'logit_loop'},
+    'logitf': {'f->f': 'logitf_loop'},
+    'ndtr': {'d->d': 'ndtr_loop'},
+    'ndtri': {'d->d': 'ndtri_loop', 'f->f': 'ndtri_loop_f'},
+}
+
+
+# Kernel functions whose loops may run on several threads, see
+# sf_threads.c. They are expensive enough per element for that to pay
+# off, and keep no state between calls: this rules out the Fortran
+# cdflib and specfun routines, which SAVE theirs, and the kernels with
+# legacy casting checks, which warn with the GIL. The C++ kernels of
+# _ufuncs_cxx report to another copy of sf_error and are not threaded.
+THREADED_KERNELS = set([
+    # AMOS
+    'cbesh_wrap1', 'cbesh_wrap1_e', 'cbesh_wrap2', 'cbesh_wrap2_e',
+    'cbesi_wrap', 'cbesi_wrap_e', 'cbesi_wrap_e_real',
+    'cbesj_wrap', 'cbesj_wrap_e', 'cbesj_wrap_e_real', 'cbesj_wrap_real',
+    'cbesk_wrap', 'cbesk_wrap_e', 'cbesk_wrap_e_real', 'cbesk_wrap_real',
+    'cbesy_wrap', 'cbesy_wrap_e', 'cbesy_wrap_e_real', 'cbesy_wrap_real',
+    # cephes and misc
+    'ellie', 'ellik', 'hyp2f1', 'igamci', 'igami', 'iv', 'kolmogi',
+    'kolmogorov', 'owens_t', 'smirnov', 'smirnovi', 'struve_h', 'struve_l',
+    # Cython
+    'lambertw_scalar',
+])
+
+
+# Kernel functions used for the ufunc loops only. A float version of a
+# function with a complex but no real double one would otherwise send
+# real arguments in cython_special to single precision.
+UFUNC_ONLY_KERNELS = set([
+    'wrightomegaf',
+])
+
+
 def underscore(arg):
     return arg.replace(" ", "_")
 
@@ -289,6 +348,8 @@ def generate_loop(func_inputs, func_outputs, func_retval,
     body += "    cdef np.npy_intp i, n = dims[0]\n"
     body += "    cdef void *func = (<void**>data)[0]\n"
     body += "    cdef char *func_name = <char*>(<void**>data)[1]\n"
+    body += "    cdef sf_error.sf_error_log err_log\n"
+    body += "    cdef int begun = sf_error.log_begin(&err_log)\n"
 
     for j in range(len(ufunc_inputs)):
         body += "    cdef char *ip%d = args[%d]\n" % (j, j)
@@ -365,10 +426,57 @@ def generate_loop(func_inputs, func_outputs, func_retval,
         body += "        op%d += steps[%d]\n" % (j, j + len(ufunc_inputs))
 
     body += "    sf_error.check_fpe(func_name)\n"
+    body += "    sf_error.log_end(&err_log, begun)\n"
 
     return name, body
 
 
+def generate_threaded_loop(loop_name, nargs):
+    """
+    Generate a UFunc loop function that runs the loop function
+    `loop_name`, taking `nargs` arguments, on the threads of
+    sf_threads.c.
+
+    Returns
+    -------
+    loop_name
+        Name of the generated loop function.
+    loop_body
+        Generated C code for the loop.
+
+    """
+    name = loop_name + "_threaded"
+    body = "cdef void %s(char **args, np.npy_intp *dims, np.npy_intp *steps, void *data) nogil:\n" % name
+    body += "    sf_threads.run_loop(%s, %d, args, dims, steps, data)\n" % (loop_name, nargs)
+    return name, body
+
+
+def generate_kernel_loop():
+    """
+    Generate a UFunc loop function that passes the whole loop to a
+    function given as its data parameter, which has the prototype of
+    the LOOP_KERNELS entries.
+
+    Returns
+    -------
+    loop_name
+        Name of the generated loop function.
+    loop_body
+        Generated C code for the loop.
+
+    """
+    name = "loop_kernel"
+    body = "cdef void %s(char **args, np.npy_intp *dims, np.npy_intp *steps, void *data) nogil:\n" % name
+    body += "    cdef void *func = (<void**>data)[0]\n"
+    body += "    cdef char *func_name = <char*>(<void**>data)[1]\n"
+    body += "    cdef sf_error.sf_error_log err_log\n"
+    body += "    cdef int begun = sf_error.log_begin(&err_log)\n"
+    body += "    (<void(*)(char **, np.npy_intp *, np.npy_intp *) nogil>func)(args, dims, steps)\n"
+    body += "    sf_error.check_fpe(func_name)\n"
+    body += "    sf_error.log_end(&err_log, begun)\n"
+    return name, body
+
+
 def generate_fused_type(codes):
     """
     Generate name of and cython code for a fused type.
@@ -620,7 +728,12 @@ class Ufunc(Func):
                     self.name, sig,
                     inarg_num, outarg_num))
 
-            loop_name, loop = generate_loop(inarg, outarg, ret, inp, outp)
+            kernels = LOOP_KERNELS.get(func_name, {})
+            if inp + '->' + outp in kernels:
+                loop_name, loop = generate_kernel_loop()
+                func_name = kernels[inp + '->' + outp]
+            else:
+                loop_name, loop = generate_loop(inarg, outarg, ret, inp, outp)
             all_loops[loop_name] = loop
             variants.append((func_name, loop_name, inp, outp))
 
@@ -663,6 +776,10 @@ class Ufunc(Func):
                 types.append(TYPE_NAMES[x])
             for x in outputs:
                 types.append(TYPE_NAMES[x])
+            if func_name in THREADED_KERNELS:
+                loop_name, loop = generate_threaded_loop(
+                    loop_name, len(inputs) + len(outputs))
+                all_loops[loop_name] = loop
             loops.append(loop_name)
             funcs.append(func_name)
 
@@ -705,6 +822,8 @@ class FusedFunc(Func):
     """
     def __init__(self, name, signatures):
         super(FusedFunc, self).__init__(name, signatures)
+        self.signatures = [sig for sig in self.signatures
+                           if sig[0] not in UFUNC_ONLY_KERNELS]
         self.doc = "See the documentation for scipy.special." + self.name
         # "codes" are the keys for CY_TYPES
         self.incodes, self.outcodes = self._get_codes()
@@ -1151,6 +1270,24 @@ def get_declaration(ufunc, c_name, c_proto, cy_proto, header, proto_h_filename):
     return defs, defs_h, var_name
 
 
+def get_loop_kernel_declaration(ufunc, c_name, header, proto_h_filename):
+    """
+    Construct Cython declarations of the LOOP_KERNELS functions of the
+    kernel function `c_name`, coming from a header file.
+    """
+    if header.endswith('.pxd'):
+        raise ValueError("%s: loop kernels must come from a header" % c_name)
+
+    kernels = sorted(LOOP_KERNELS[c_name].values())
+    defs = ["cdef extern from \"%s\":" % proto_h_filename]
+    defs_h = ["#include \"%s\"" % header]
+    for kernel in kernels:
+        new_name = "%s \"%s\"" % (ufunc.cython_func_name(kernel), kernel)
+        defs.append("    cdef void %s(char **, np.npy_intp *, np.npy_intp *) nogil" % new_name)
+        defs_h.append("void %s(char **, npy_intp *, npy_intp *);" % kernel)
+    return defs, defs_h, kernels
+
+
 def generate_ufuncs(fn_prefix, cxx_fn_prefix, ufuncs):
     filename = fn_prefix + ".pyx"
     proto_h_filename = fn_prefix + '_defs.h'
@@ -1195,6 +1332,18 @@ def generate_ufuncs(fn_prefix, cxx_fn_prefix, ufuncs):
 
                 # let cython grab the function pointer from the c++ shared library
                 ufunc.function_name_overrides[c_name] = "scipy.special._ufuncs_cxx._export_" + var_name
+
+                if c_name in LOOP_KERNELS:
+                    item_defs, item_defs_h, kernels = get_loop_kernel_declaration(
+                        ufunc, c_name, header, cxx_proto_h_filename)
+                    cxx_defs.extend(item_defs)
+                    cxx_defs_h.extend(item_defs_h)
+
+                    for var_name in kernels:
+                        cxx_defs.append("cdef void *_export_%s = <void*>%s" % (
+                            var_name, ufunc.cython_func_name(var_name, override=False)))
+                        cxx_pxd_defs.append("cdef void *_export_%s" % (var_name,))
+                        ufunc.function_name_overrides[var_name] = "scipy.special._ufuncs_cxx._export_" + var_name
             else:
                 # usual case
                 item_defs, item_defs_h, _ = get_declaration(ufunc, c_name, c_proto, cy_proto, header,
@@ -1202,6 +1351,12 @@ def generate_ufuncs(fn_prefix, cxx_fn_prefix, ufuncs):
                 defs.extend(item_defs)
                 defs_h.extend(item_defs_h)
 
+                if c_name in LOOP_KERNELS:
+                    item_defs, item_defs_h, _ = get_loop_kernel_declaration(
+                        ufunc, c_name, header, proto_h_filename)
+                    defs.extend(item_defs)
+                    defs_h.extend(item_defs_h)
+
         # ufunc creation code snippet
         t = ufunc.generate(all_loops)
         toplevel += t + "\n"
@@ -11,4 +11,9 @@ npy_float expitf(npy_float x);
 npy_double expit(npy_double x);
 npy_longdouble expitl(npy_longdouble x);
 
+void logitf_loop(char **args, npy_intp *dims, npy_intp *steps);
+void logit_loop(char **args, npy_intp *dims, npy_intp *steps);
+void expitf_loop(char **args, npy_intp *dims, npy_intp *steps);
+void expit_loop(char **args, npy_intp *dims, npy_intp *steps);
+
 #endif
@@ -0,0 +1,66 @@
+"""Precompute tables of factorials, their logarithms and binomial
+coefficients for the integer fast paths of Gamma, lgam, binom and comb.
+
+The factorials and their logarithms are correctly rounded. The binomial
+coefficients are those fitting in 64-bit unsigned integers, for which
+n is at most 67.
+
+"""
+from __future__ import division, print_function, absolute_import
+
+import os
+import math
+from decimal import Decimal, getcontext
+
+
+FACTORIAL_MAX = 170
+BINOM_TABLE_MAX = 67
+
+WARNING = """\
+/* This file was automatically generated by _precompute/factorial_tables.py.
+ * Do not edit it manually!
+ */
+"""
+
+
+def format_table(decl, values, per_line=3):
+    lines = []
+    for j in range(0, len(values), per_line):
+        lines.append("    " + ", ".join(values[j:j + per_line]))
+    return "{} = {{\n{}\n}};\n".format(decl, ",\n".join(lines))
+
+
+def main():
+    print(__doc__)
+    fn = os.path.join('..', 'cephes', 'factorial.h')
+
+    getcontext().prec = 50
+    fac = [math.factorial(k) for k in range(FACTORIAL_MAX + 1)]
+    lnfac = [Decimal(f).ln() for f in fac]
+    binom = []
+    for n in range(BINOM_TABLE_MAX + 1):
+        for k in range(n + 1):
+            c = fac[n] // (fac[k] * fac[n - k])
+            assert c < 2**64
+            binom.append(c)
+
+    with open(fn + '.new', 'w') as f:
+        f.write(WARNING)
+        f.write("#ifndef CEPHES_FACTORIAL_H\n#define CEPHES_FACTORIAL_H\n\n")
+        f.write("#define FACTORIAL_MAX {}\n".format(FACTORIAL_MAX))
+        f.write("#define BINOM_TABLE_MAX {}\n\n".format(BINOM_TABLE_MAX))
+        f.write("/* k! for k = 0, ..., FACTORIAL_MAX */\n")
+        f.write(format_table("static const double factorial_table[]",
+                             [repr(float(x)) for x in fac]))
+        f.write("\n/* log(k!) for k = 0, ..., FACTORIAL_MAX */\n")
+        f.write(format_table("static const double lnfactorial_table[]",
+                             [repr(float(x)) for x in lnfac]))
+        f.write("\n/* binom(n, k) for 0 <= k <= n <= BINOM_TABLE_MAX, at n*(n + 1)/2 + k */\n")
+        f.write(format_table("static const unsigned long long binom_table[]",
+                             ["{}ULL".format(x) for x in binom], per_line=4))
+        f.write("\n#endif\n")
+    os.rename(fn + '.new', fn)
+
+
+if __name__ == "__main__":
+    main()
@@ -1,4 +1,9 @@
 cimport scipy.special._ufuncs_cxx
+from . cimport sf_threads
+from libc.limits cimport INT_MAX
+import os
+import operator
+import contextlib
 import numpy as np
 
 
@@ -218,3 +223,300 @@ class errstate(object):
 
     def __exit__(self, exc_type, exc_value, traceback):
         seterr(**self.oldstate)
+
+
+def _workers(workers):
+    """Normalize a ``workers`` argument to a positive thread count."""
+    cpu_count = os.cpu_count() or 1
+    workers = operator.index(workers)
+    if workers < 0:
+        if workers >= -cpu_count:
+            workers += 1 + cpu_count
+        else:
+            raise ValueError("workers value out of range; got {}, must not be"
+                             " less than {}".format(workers, -cpu_count))
+    elif workers == 0:
+        raise ValueError("workers must not be zero")
+    return workers
+
+
+@contextlib.contextmanager
+def set_workers(workers):
+    """Context manager for the number of threads used by special functions.
+
+    .. versionadded:: 1.4.0
+
+    Parameters
+    ----------
+    workers : int
+        The number of threads to use. If negative, the value wraps around
+        from ``os.cpu_count()``.
+
+    See Also
+    --------
+    get_workers : get the current number of threads
+    errstate : context manager for special-function error handling
+
+    Notes
+    -----
+    Only functions that are expensive to evaluate and safe to call from
+    several threads at once are run on multiple threads; currently these
+    are the Bessel functions `jv`, `jve`, `yv`, `yve`, `iv`, `ive`, `kv`,
+    `kve`, `hankel1`, `hankel1e`, `hankel2` and `hankel2e`, `hyp2f1`,
+    `ellipkinc`, `ellipeinc`, `gammaincinv`, `gammainccinv`,
+    `kolmogorov`, `kolmogi`, `smirnov`, `smirnovi`, `owens_t`, `struve`,
+    `modstruve` and `lambertw`. Small arrays are always evaluated on a
+    single thread.
+
+    Like `errstate`, the setting applies to the whole process, not only to
+    the calling thread. Errors raised on the worker threads are handled
+    according to `seterr` once the evaluation finishes, so the results do
+    not depend on the number of threads.
+
+    Examples
+    --------
+    >>> import numpy as np
+    >>> import scipy.special as sc
+    >>> x = np.linspace(0, 100, 100000)
+    >>> with sc.set_workers(4):
+    ...     y = sc.jv(2.5, x)
+    >>> np.array_equal(y, sc.jv(2.5, x))
+    True
+
+    """
+    old_workers = get_workers()
+    sf_threads.set_workers(_workers(workers))
+    try:
+        yield
+    finally:
+        sf_threads.set_workers(old_workers)
+
+
+def get_workers():
+    """Returns the number of threads used by special functions.
+
+    .. versionadded:: 1.4.0
+
+    See Also
+    --------
+    set_workers : context manager for the number of threads
+
+    Examples
+    --------
+    >>> import scipy.special as sc
+    >>> sc.get_workers()
+    1
+    >>> with sc.set_workers(4):
+    ...     sc.get_workers()
+    4
+
+    """
+    return sf_threads.get_workers()
+
+
+cdef extern from "amos_wrappers.h":
+    void cbesj_wrap_seq(double v, int n, np.npy_cdouble z,
+                        np.npy_cdouble *cy, double *work) except *
+    void cbesi_wrap_seq(double v, int n, np.npy_cdouble z,
+                        np.npy_cdouble *cy, double *work) except *
+    void cbesk_wrap_seq(double v, int n, np.npy_cdouble z,
+                        np.npy_cdouble *cy, double *work) except *
+    void cbesj_wrap_real_seq(double v, int n, double x, double *y,
+                             double *work) except *
+    void cbesi_wrap_real_seq(double v, int n, double x, double *y,
+                             double *work) except *
+    void cbesk_wrap_real_seq(double v, int n, double x, double *y,
+                             double *work) except *
+
+
+cdef object _bessel_seq(char kind, double v, n, z):
+    """Evaluate orders v, ..., v + n - 1 of the Bessel function `kind`
+    at each element of z, along a new last axis."""
+    cdef np.ndarray zz, out, work
+    cdef np.npy_intp i, size
+    cdef np.npy_cdouble cz
+    cdef double *zp
+    cdef double *op
+    cdef double *wp
+    cdef int cn
+    cdef bint is_complex
+
+    n = operator.index(n)
+    if n < 0 or n > INT_MAX // 8:
+        raise ValueError("n out of range; got {}".format(n))
+    cn = n
+
+    z = np.asarray(z)
+    is_complex = np.iscomplexobj(z)
+    if is_complex:
+        zz = np.ascontiguousarray(z, dtype=np.complex128)
+    else:
+        zz = np.ascontiguousarray(z, dtype=np.float64)
+    out = np.empty(np.shape(zz) + (cn,), dtype=zz.dtype)
+    if cn == 0:
+        return out
+    work = np.empty(8*cn, dtype=np.float64)
+
+    zp = <double *>np.PyArray_DATA(zz)
+    op = <double *>np.PyArray_DATA(out)
+    wp = <double *>np.PyArray_DATA(work)
+    size = np.PyArray_SIZE(zz)
+    if is_complex:
+        for i in range(size):
+            cz.real = zp[2*i]
+            cz.imag = zp[2*i + 1]
+            if kind == b'j':
+                cbesj_wrap_seq(v, cn, cz, <np.npy_cdouble *>op + i*cn, wp)
+            elif kind == b'i':
+                cbesi_wrap_seq(v, cn, cz, <np.npy_cdouble *>op + i*cn, wp)
+            else:
+                cbesk_wrap_seq(v, cn, cz, <np.npy_cdouble *>op + i*cn, wp)
+    else:
+        for i in range(size):
+            if kind == b'j':
+                cbesj_wrap_real_seq(v, cn, zp[i], op + i*cn, wp)
+            elif kind == b'i':
+                cbesi_wrap_real_seq(v, cn, zp[i], op + i*cn, wp)
+            else:
+                cbesk_wrap_real_seq(v, cn, zp[i], op + i*cn, wp)
+    return out
+
+
+def jv_seq(v, n, z):
+    """Bessel functions of the first kind of orders v, v + 1, ..., v + n - 1.
+
+    .. versionadded:: 1.4.0
+
+    Parameters
+    ----------
+    v : float
+        Lowest order.
+    n : int
+        Number of orders.
+    z : array_like
+        Argument (float or complex).
+
+    Returns
+    -------
+    J : ndarray
+        Array of shape ``z.shape + (n,)`` whose last axis holds the
+        values of `jv` at the orders ``v + k`` for ``k = 0, ..., n - 1``.
+
+    See Also
+    --------
+    jv : Bessel function of the first kind
+    iv_seq, kv_seq
+
+    Notes
+    -----
+    The orders at each argument are evaluated together by AMOS [1]_,
+    which computes the highest ones and recurs down to the others, for
+    little more than the cost of one call to `jv`. Negative orders come
+    from a second sequence through the reflection formula, as in `jv`.
+    The results agree with those of `jv` up to rounding.
+
+    References
+    ----------
+    .. [1] Donald E. Amos, "AMOS, A Portable Package for Bessel Functions
+           of a Complex Argument and Nonnegative Order",
+           http://netlib.org/amos/
+
+    Examples
+    --------
+    >>> import numpy as np
+    >>> import scipy.special as sc
+    >>> x = np.linspace(0, 20, 5)
+    >>> J = sc.jv_seq(-1.5, 30, x)
+    >>> J.shape
+    (5, 30)
+    >>> np.allclose(J, sc.jv(-1.5 + np.arange(30), x[:, np.newaxis]))
+    True
+
+    """
+    return _bessel_seq(b'j', v, n, z)
+
+
+def iv_seq(v, n, z):
+    """Modified Bessel functions of the first kind of orders v, ..., v + n - 1.
+
+    .. versionadded:: 1.4.0
+
+    Parameters
+    ----------
+    v : float
+        Lowest order.
+    n : int
+        Number of orders.
+    z : array_like
+        Argument (float or complex).
+
+    Returns
+    -------
+    I : ndarray
+        Array of shape ``z.shape + (n,)`` whose last axis holds the
+        values of `iv` at the orders ``v + k`` for ``k = 0, ..., n - 1``.
+
+    See Also
+    --------
+    iv : modified Bessel function of the first kind
+    jv_seq, kv_seq
+
+    Notes
+    -----
+    The orders are evaluated together by AMOS, see `jv_seq`. For real
+    arguments `iv` uses the Cephes routine instead, so that the results
+    of the two differ by rounding.
+
+    Examples
+    --------
+    >>> import numpy as np
+    >>> import scipy.special as sc
+    >>> x = np.linspace(0, 20, 5)
+    >>> I = sc.iv_seq(0, 10, x)
+    >>> np.allclose(I, sc.iv(np.arange(10), x[:, np.newaxis]))
+    True
+
+    """
+    return _bessel_seq(b'i', v, n, z)
+
+
+def kv_seq(v, n, z):
+    """Modified Bessel functions of the second kind of orders v, ..., v + n - 1.
+
+    .. versionadded:: 1.4.0
+
+    Parameters
+    ----------
+    v : float
+        Lowest order.
+    n : int
+        Number of orders.
+    z : array_like
+        Argument (float or complex).
+
+    Returns
+    -------
+    K : ndarray
+        Array of shape ``z.shape + (n,)`` whose last axis holds the
+        values of `kv` at the orders ``v + k`` for ``k = 0, ..., n - 1``.
+
+    See Also
+    --------
+    kv : modified Bessel function of the second kind
+    jv_seq, iv_seq
+
+    Notes
+    -----
+    The orders are evaluated together by AMOS, see `jv_seq`.
+
+    Examples
+    --------
+    >>> import numpy as np
+    >>> import scipy.special as sc
+    >>> x = np.linspace(0.5, 20, 5)
+    >>> K = sc.kv_seq(0.5, 10, x)
+    >>> np.allclose(K, sc.kv(0.5 + np.arange(10), x[:, np.newaxis]))
+    True
+
+    """
+    return _bessel_seq(b'k', v, n, z)
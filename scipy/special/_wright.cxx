@@ -13,4 +13,9 @@ npy_cdouble wrightomega(npy_cdouble zp)
     return npy_cpack(real(w), imag(w));
 }
 
+npy_float wrightomegaf(npy_float x)
+{
+    return wright::wrightomegaf(x);
+}
+
 EXTERN_C_END
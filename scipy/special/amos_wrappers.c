@@ -804,3 +804,240 @@ npy_cdouble cbesh_wrap2_e( double v, npy_cdouble z) {
   }
   return cy;
 }
+
+
+/*
+ * Sequences of orders v, v + 1, ..., v + n - 1 at one argument, for
+ * jv_seq, iv_seq and kv_seq. AMOS evaluates a whole sequence in one
+ * call, by recurrence from the orders it computes directly, for little
+ * more than the cost of a single order. Negative orders are reflected
+ * with a second sequence. Where AMOS reports underflow or an error, the
+ * orders are evaluated one by one with the wrappers above, which deal
+ * with those cases.
+ *
+ * The work arrays hold 8 n doubles.
+ */
+
+static int
+amos_seq(char kind, double v, int n, npy_cdouble z,
+         double *cyr, double *cyi, double *cwrkr, double *cwrki)
+{
+  int kode = 1;
+  int nz = 0, ierr = 0;
+
+  if (n == 0) {
+    return 0;
+  }
+  if (npy_isnan(v) || npy_isnan(z.real) || npy_isnan(z.imag)) {
+    return -1;
+  }
+  switch (kind) {
+  case 'j':
+    F_FUNC(zbesj,ZBESJ)(CADDR(z), &v, &kode, &n, cyr, cyi, &nz, &ierr);
+    break;
+  case 'y':
+    F_FUNC(zbesy,ZBESY)(CADDR(z), &v, &kode, &n, cyr, cyi, &nz, cwrkr, cwrki, &ierr);
+    break;
+  case 'i':
+    F_FUNC(zbesi,ZBESI)(CADDR(z), &v, &kode, &n, cyr, cyi, &nz, &ierr);
+    break;
+  case 'k':
+    F_FUNC(zbesk,ZBESK)(CADDR(z), &v, &kode, &n, cyr, cyi, &nz, &ierr);
+    break;
+  }
+  return (nz == 0 && ierr == 0) ? 0 : -1;
+}
+
+/* Number of negative orders in the sequence */
+static int
+seq_negative(double v, int n)
+{
+  double m;
+
+  if (!(v < 0)) {
+    return 0;
+  }
+  m = ceil(-v);
+  return m < n ? (int)m : n;
+}
+
+void cbesj_wrap_seq(double v, int n, npy_cdouble z, npy_cdouble *cy, double *work)
+{
+  int k, i, m = seq_negative(v, n);
+  double u = -(v + m - 1);
+  double *jr = work, *ji = work + n, *yr = work + 2*n, *yi = work + 3*n;
+  npy_cdouble j, y;
+
+  if (amos_seq('j', v + m, n - m, z, jr, ji, NULL, NULL) == 0) {
+    for (k = m; k < n; k++) {
+      cy[k].real = jr[k - m];
+      cy[k].imag = ji[k - m];
+    }
+  }
+  else {
+    for (k = m; k < n; k++) {
+      cy[k] = cbesj_wrap(v + k, z);
+    }
+  }
+
+  /* J_{-u} from J_u and Y_u for u = -(v + m - 1), ..., -v */
+  if (m > 0 && amos_seq('j', u, m, z, jr, ji, NULL, NULL) == 0 &&
+      (v == floor(v) ||
+       amos_seq('y', u, m, z, yr, yi, work + 4*n, work + 5*n) == 0)) {
+    for (k = 0; k < m; k++) {
+      i = m - 1 - k;
+      j.real = jr[i];
+      j.imag = ji[i];
+      if (!reflect_jy(&j, -(v + k))) {
+        y.real = yr[i];
+        y.imag = yi[i];
+        j = rotate_jy(j, y, -(v + k));
+      }
+      cy[k] = j;
+    }
+  }
+  else {
+    for (k = 0; k < m; k++) {
+      cy[k] = cbesj_wrap(v + k, z);
+    }
+  }
+}
+
+void cbesi_wrap_seq(double v, int n, npy_cdouble z, npy_cdouble *cy, double *work)
+{
+  int k, i, m = seq_negative(v, n);
+  double u = -(v + m - 1);
+  double *ir = work, *ii = work + n, *kr = work + 2*n, *ki = work + 3*n;
+  npy_cdouble c, ck;
+
+  if (amos_seq('i', v + m, n - m, z, ir, ii, NULL, NULL) == 0) {
+    for (k = m; k < n; k++) {
+      cy[k].real = ir[k - m];
+      cy[k].imag = ii[k - m];
+    }
+  }
+  else {
+    for (k = m; k < n; k++) {
+      cy[k] = cbesi_wrap(v + k, z);
+    }
+  }
+
+  /* I_{-u} from I_u and K_u for u = -(v + m - 1), ..., -v */
+  if (m > 0 && amos_seq('i', u, m, z, ir, ii, NULL, NULL) == 0 &&
+      (v == floor(v) || amos_seq('k', u, m, z, kr, ki, NULL, NULL) == 0)) {
+    for (k = 0; k < m; k++) {
+      i = m - 1 - k;
+      c.real = ir[i];
+      c.imag = ii[i];
+      if (!reflect_i(&c, -(v + k))) {
+        ck.real = kr[i];
+        ck.imag = ki[i];
+        c = rotate_i(c, ck, -(v + k));
+      }
+      cy[k] = c;
+    }
+  }
+  else {
+    for (k = 0; k < m; k++) {
+      cy[k] = cbesi_wrap(v + k, z);
+    }
+  }
+}
+
+void cbesk_wrap_seq(double v, int n, npy_cdouble z, npy_cdouble *cy, double *work)
+{
+  int k, m = seq_negative(v, n);
+  double u = -(v + m - 1);
+  double *kr = work, *ki = work + n;
+
+  if (amos_seq('k', v + m, n - m, z, kr, ki, NULL, NULL) == 0) {
+    for (k = m; k < n; k++) {
+      cy[k].real = kr[k - m];
+      cy[k].imag = ki[k - m];
+    }
+  }
+  else {
+    for (k = m; k < n; k++) {
+      cy[k] = cbesk_wrap(v + k, z);
+    }
+  }
+
+  /* K_{-u} == K_u for u = -(v + m - 1), ..., -v */
+  if (m > 0 && amos_seq('k', u, m, z, kr, ki, NULL, NULL) == 0) {
+    for (k = 0; k < m; k++) {
+      cy[k].real = kr[m - 1 - k];
+      cy[k].imag = ki[m - 1 - k];
+    }
+  }
+  else {
+    for (k = 0; k < m; k++) {
+      cy[k] = cbesk_wrap(v + k, z);
+    }
+  }
+}
+
+void cbesj_wrap_real_seq(double v, int n, double x, double *y, double *work)
+{
+  int k;
+  npy_cdouble z, *cy = (npy_cdouble *)(work + 6*n);
+
+  if (npy_isnan(v) || npy_isnan(x) || (x < 0 && v != floor(v))) {
+    for (k = 0; k < n; k++) {
+      y[k] = cbesj_wrap_real(v + k, x);
+    }
+    return;
+  }
+  z.real = x;
+  z.imag = 0;
+  cbesj_wrap_seq(v, n, z, cy, work);
+  for (k = 0; k < n; k++) {
+    y[k] = cy[k].real;
+    if (y[k] != y[k]) {
+      /* AMOS returned NaN, possibly due to overflow */
+      y[k] = cephes_jv(v + k, x);
+    }
+  }
+}
+
+double cephes_iv(double v, double x);
+
+void cbesi_wrap_real_seq(double v, int n, double x, double *y, double *work)
+{
+  int k;
+  npy_cdouble z, *cy = (npy_cdouble *)(work + 6*n);
+
+  if (npy_isnan(v) || npy_isnan(x) || (x < 0 && v != floor(v))) {
+    for (k = 0; k < n; k++) {
+      y[k] = cephes_iv(v + k, x);
+    }
+    return;
+  }
+  z.real = x;
+  z.imag = 0;
+  cbesi_wrap_seq(v, n, z, cy, work);
+  for (k = 0; k < n; k++) {
+    y[k] = cy[k].real;
+    if (y[k] != y[k]) {
+      y[k] = cephes_iv(v + k, x);
+    }
+  }
+}
+
+void cbesk_wrap_real_seq(double v, int n, double x, double *y, double *work)
+{
+  int k;
+  npy_cdouble z, *cy = (npy_cdouble *)(work + 6*n);
+
+  if (npy_isnan(v) || !(x > 0 && x <= 710)) {
+    for (k = 0; k < n; k++) {
+      y[k] = cbesk_wrap_real(v + k, x);
+    }
+    return;
+  }
+  z.real = x;
+  z.imag = 0;
+  cbesk_wrap_seq(v, n, z, cy, work);
+  for (k = 0; k < n; k++) {
+    y[k] = cy[k].real;
+  }
+}
@@ -47,6 +47,12 @@ npy_cdouble cbesh_wrap1_e( double v, npy_cdouble z);
 npy_cdouble cbesh_wrap2( double v, npy_cdouble z);
 npy_cdouble cbesh_wrap2_e( double v, npy_cdouble z);
 double sin_pi(double x);
+void cbesj_wrap_seq(double v, int n, npy_cdouble z, npy_cdouble *cy, double *work);
+void cbesi_wrap_seq(double v, int n, npy_cdouble z, npy_cdouble *cy, double *work);
+void cbesk_wrap_seq(double v, int n, npy_cdouble z, npy_cdouble *cy, double *work);
+void cbesj_wrap_real_seq(double v, int n, double x, double *y, double *work);
+void cbesi_wrap_real_seq(double v, int n, double x, double *y, double *work);
+void cbesk_wrap_real_seq(double v, int n, double x, double *y, double *work);
 /* 
 int cairy_(double *, int *, int *, doublecomplex *, int *, int *);
 int cbiry_(doublecomplex *, int *, int *, doublecomplex *, int *, int *);
@@ -1,6 +1,8 @@
 #ifndef CEPHES_H
 #define CEPHES_H
 
+#include <numpy/npy_common.h>
+
 #include "cephes/cephes_names.h"
 
 #ifdef __cplusplus
@@ -45,6 +47,7 @@ extern int fresnl(double xxa, double *ssa, double *cca);
 extern double Gamma(double x);
 extern double lgam(double x);
 extern double lgam_sgn(double x, int *sign);
+extern float lgamf(float x);
 
 extern double gdtr(double a, double b, double x);
 extern double gdtrc(double a, double b, double x);
@@ -56,8 +59,10 @@ extern double threef0(double a, double b, double c, double x, double *err);
 
 extern double i0(double x);
 extern double i0e(double x);
+extern float i0ef(float x);
 extern double i1(double x);
 extern double i1e(double x);
+extern float i1ef(float x);
 extern double igamc(double a, double x);
 extern double igam(double a, double x);
 extern double igam_fac(double a, double x);
@@ -89,8 +94,19 @@ extern double ndtr(double a);
 extern double log_ndtr(double a);
 extern double erfc(double a);
 extern double erf(double x);
+extern float ndtrf(float a);
+extern float erfcf(float a);
+extern float erff(float x);
 extern double ndtri(double y0);
 
+/* Versions for whole ufunc loop lines, see _generate_pyx.py */
+extern void ndtr_loop(char **args, npy_intp *dims, npy_intp *steps);
+extern void log_ndtr_loop(char **args, npy_intp *dims, npy_intp *steps);
+extern void log_ndtr_loop_f(char **args, npy_intp *dims, npy_intp *steps);
+extern void erf_loop(char **args, npy_intp *dims, npy_intp *steps);
+extern void ndtri_loop(char **args, npy_intp *dims, npy_intp *steps);
+extern void ndtri_loop_f(char **args, npy_intp *dims, npy_intp *steps);
+
 extern double pdtrc(int k, double m);
 extern double pdtr(int k, double m);
 extern double pdtri(int k, double y);
@@ -30,6 +30,7 @@
 #define Gamma cephes_Gamma
 #define lgam cephes_lgam
 #define lgam_sgn cephes_lgam_sgn
+#define lgamf cephes_lgamf
 #define gdtr cephes_gdtr
 #define gdtrc cephes_gdtrc
 #define gdtri cephes_gdtri
@@ -37,8 +38,10 @@
 #define hyperg cephes_hyperg
 #define i0 cephes_i0
 #define i0e cephes_i0e
+#define i0ef cephes_i0ef
 #define i1 cephes_i1
 #define i1e cephes_i1e
+#define i1ef cephes_i1ef
 #define igamc cephes_igamc
 #define igam cephes_igam
 #define igami cephes_igami
@@ -62,6 +65,9 @@
 #define ndtr cephes_ndtr
 #define erfc cephes_erfc
 #define erf cephes_erf
+#define ndtrf cephes_ndtrf
+#define erfcf cephes_erfcf
+#define erff cephes_erff
 #define ndtri cephes_ndtri
 #define pdtrc cephes_pdtrc
 #define pdtr cephes_pdtr
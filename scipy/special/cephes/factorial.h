@@ -0,0 +1,723 @@
+/* This file was automatically generated by _precompute/factorial_tables.py.
+ * Do not edit it manually!
+ */
+#ifndef CEPHES_FACTORIAL_H
+#define CEPHES_FACTORIAL_H
+
+#define FACTORIAL_MAX 170
+#define BINOM_TABLE_MAX 67
+
+/* k! for k = 0, ..., FACTORIAL_MAX */
+static const double factorial_table[] = {
+    1.0, 1.0, 2.0,
+    6.0, 24.0, 120.0,
+    720.0, 5040.0, 40320.0,
+    362880.0, 3628800.0, 39916800.0,
+    479001600.0, 6227020800.0, 87178291200.0,
+    1307674368000.0, 20922789888000.0, 355687428096000.0,
+    6402373705728000.0, 1.21645100408832e+17, 2.43290200817664e+18,
+    5.109094217170944e+19, 1.1240007277776077e+21, 2.585201673888498e+22,
+    6.204484017332394e+23, 1.5511210043330986e+25, 4.0329146112660565e+26,
+    1.0888869450418352e+28, 3.0488834461171387e+29, 8.841761993739702e+30,
+    2.6525285981219107e+32, 8.222838654177922e+33, 2.631308369336935e+35,
+    8.683317618811886e+36, 2.9523279903960416e+38, 1.0333147966386145e+40,
+    3.7199332678990125e+41, 1.3763753091226346e+43, 5.230226174666011e+44,
+    2.0397882081197444e+46, 8.159152832478977e+47, 3.345252661316381e+49,
+    1.40500611775288e+51, 6.041526306337383e+52, 2.658271574788449e+54,
+    1.1962222086548019e+56, 5.502622159812089e+57, 2.5862324151116818e+59,
+    1.2413915592536073e+61, 6.082818640342675e+62, 3.0414093201713376e+64,
+    1.5511187532873822e+66, 8.065817517094388e+67, 4.2748832840600255e+69,
+    2.308436973392414e+71, 1.2696403353658276e+73, 7.109985878048635e+74,
+    4.0526919504877214e+76, 2.3505613312828785e+78, 1.3868311854568984e+80,
+    8.32098711274139e+81, 5.075802138772248e+83, 3.146997326038794e+85,
+    1.98260831540444e+87, 1.2688693218588417e+89, 8.247650592082472e+90,
+    5.443449390774431e+92, 3.647111091818868e+94, 2.4800355424368305e+96,
+    1.711224524281413e+98, 1.1978571669969892e+100, 8.504785885678623e+101,
+    6.1234458376886085e+103, 4.4701154615126844e+105, 3.307885441519386e+107,
+    2.48091408113954e+109, 1.8854947016660504e+111, 1.4518309202828587e+113,
+    1.1324281178206297e+115, 8.946182130782976e+116, 7.156945704626381e+118,
+    5.797126020747368e+120, 4.753643337012842e+122, 3.945523969720659e+124,
+    3.314240134565353e+126, 2.81710411438055e+128, 2.4227095383672734e+130,
+    2.107757298379528e+132, 1.8548264225739844e+134, 1.650795516090846e+136,
+    1.4857159644817615e+138, 1.352001527678403e+140, 1.2438414054641308e+142,
+    1.1567725070816416e+144, 1.087366156656743e+146, 1.032997848823906e+148,
+    9.916779348709496e+149, 9.619275968248212e+151, 9.426890448883248e+153,
+    9.332621544394415e+155, 9.332621544394415e+157, 9.42594775983836e+159,
+    9.614466715035127e+161, 9.90290071648618e+163, 1.0299016745145628e+166,
+    1.081396758240291e+168, 1.1462805637347084e+170, 1.226520203196138e+172,
+    1.324641819451829e+174, 1.4438595832024937e+176, 1.588245541522743e+178,
+    1.7629525510902446e+180, 1.974506857221074e+182, 2.2311927486598138e+184,
+    2.5435597334721877e+186, 2.925093693493016e+188, 3.393108684451898e+190,
+    3.969937160808721e+192, 4.684525849754291e+194, 5.574585761207606e+196,
+    6.689502913449127e+198, 8.094298525273444e+200, 9.875044200833601e+202,
+    1.214630436702533e+205, 1.506141741511141e+207, 1.882677176888926e+209,
+    2.372173242880047e+211, 3.0126600184576594e+213, 3.856204823625804e+215,
+    4.974504222477287e+217, 6.466855489220474e+219, 8.47158069087882e+221,
+    1.1182486511960043e+224, 1.4872707060906857e+226, 1.9929427461615188e+228,
+    2.6904727073180504e+230, 3.659042881952549e+232, 5.012888748274992e+234,
+    6.917786472619489e+236, 9.615723196941089e+238, 1.3462012475717526e+241,
+    1.898143759076171e+243, 2.695364137888163e+245, 3.854370717180073e+247,
+    5.5502938327393044e+249, 8.047926057471992e+251, 1.1749972043909107e+254,
+    1.727245890454639e+256, 2.5563239178728654e+258, 3.80892263763057e+260,
+    5.713383956445855e+262, 8.62720977423324e+264, 1.3113358856834524e+267,
+    2.0063439050956823e+269, 3.0897696138473508e+271, 4.789142901463394e+273,
+    7.471062926282894e+275, 1.1729568794264145e+278, 1.853271869493735e+280,
+    2.9467022724950384e+282, 4.7147236359920616e+284, 7.590705053947219e+286,
+    1.2296942187394494e+289, 2.0044015765453026e+291, 3.287218585534296e+293,
+    5.423910666131589e+295, 9.003691705778438e+297, 1.503616514864999e+300,
+    2.5260757449731984e+302, 4.269068009004705e+304, 7.257415615307999e+306
+};
+
+/* log(k!) for k = 0, ..., FACTORIAL_MAX */
+static const double lnfactorial_table[] = {
+    0.0, 0.0, 0.6931471805599453,
+    1.791759469228055, 3.1780538303479458, 4.787491742782046,
+    6.579251212010101, 8.525161361065415, 10.60460290274525,
+    12.801827480081469, 15.104412573075516, 17.502307845873887,
+    19.987214495661885, 22.552163853123425, 25.19122118273868,
+    27.89927138384089, 30.671860106080672, 33.50507345013689,
+    36.39544520803305, 39.339884187199495, 42.335616460753485,
+    45.38013889847691, 48.47118135183523, 51.60667556776438,
+    54.78472939811232, 58.00360522298052, 61.261701761002,
+    64.55753862700634, 67.88974313718154, 71.25703896716801,
+    74.65823634883016, 78.0922235533153, 81.55795945611504,
+    85.05446701758152, 88.58082754219768, 92.1361756036871,
+    95.7196945421432, 99.33061245478743, 102.96819861451381,
+    106.63176026064346, 110.32063971475739, 114.0342117814617,
+    117.77188139974507, 121.53308151543864, 125.3172711493569,
+    129.12393363912722, 132.95257503561632, 136.80272263732635,
+    140.67392364823425, 144.5657439463449, 148.47776695177302,
+    152.40959258449735, 156.3608363030788, 160.3311282166309,
+    164.32011226319517, 168.32744544842765, 172.3527971391628,
+    176.39584840699735, 180.45629141754378, 184.53382886144948,
+    188.6281734236716, 192.7390472878449, 196.86618167289,
+    201.00931639928152, 205.1681994826412, 209.34258675253685,
+    213.53224149456327, 217.73693411395422, 221.95644181913033,
+    226.1905483237276, 230.43904356577696, 234.70172344281826,
+    238.97838956183432, 243.2688490029827, 247.57291409618688,
+    251.8904022097232, 256.22113555000954, 260.5649409718632,
+    264.9216497985528, 269.2910976510198, 273.6731242856937,
+    278.0675734403661, 282.4742926876304, 286.893133295427,
+    291.3239500942703, 295.76660135076065, 300.22094864701415,
+    304.6868567656687, 309.1641935801469, 313.65282994987905,
+    318.1526396202093, 322.66349912672615, 327.1852877037752,
+    331.7178871969285, 336.26118197919845, 340.815058870799,
+    345.37940706226686, 349.95411804077025, 354.5390855194408,
+    359.1342053695754, 363.73937555556347, 368.35449607240474,
+    372.979468885689, 377.61419787391867, 382.25858877306,
+    386.91254912321756, 391.5759882173296, 396.24881705179155,
+    400.93094827891576, 405.6222961611449, 410.32277652693733,
+    415.03230672824964, 419.7508055995447, 424.4781934182571,
+    429.21439186665157, 433.9593239950148, 438.71291418612117,
+    443.47508812091894, 448.2457727453846, 453.0248962384961,
+    457.81238798127816, 462.6081785268749, 467.4121995716082,
+    472.2243839269806, 477.04466549258564, 481.87297922988796,
+    486.7092611368394, 491.553448223298, 496.40547848721764,
+    501.2652908915793, 506.1328253420349, 511.008022665236,
+    515.8908245878224, 520.7811737160441, 525.679013515995,
+    530.5842882944335, 535.4969431801695, 540.4169241059976,
+    545.3441777911548, 550.2786517242855, 555.2202941468948,
+    560.169054037273, 565.1248810948744, 570.0877257251342,
+    575.0575390247102, 580.0342727671308, 585.0178793888391,
+    590.0083119756179, 595.005524249382, 600.0094705553274,
+    605.0201058494237, 610.0373856862386, 615.0612662070849,
+    620.0917041284773, 625.128656730891, 630.1720818478102,
+    635.2219378550598, 640.278183660408, 645.340778693435,
+    650.4096828956552, 655.4848567108891, 660.5662610758735,
+    665.653857411106, 670.7476076119127, 675.8474740397369,
+    680.9534195136374, 686.065407301994, 691.1834011144108,
+    696.307365093814, 701.437263808737, 706.5730622457874
+};
+
+/* binom(n, k) for 0 <= k <= n <= BINOM_TABLE_MAX, at n*(n + 1)/2 + k */
+static const unsigned long long binom_table[] = {
+    1ULL, 1ULL, 1ULL, 1ULL,
+    2ULL, 1ULL, 1ULL, 3ULL,
+    3ULL, 1ULL, 1ULL, 4ULL,
+    6ULL, 4ULL, 1ULL, 1ULL,
+    5ULL, 10ULL, 10ULL, 5ULL,
+    1ULL, 1ULL, 6ULL, 15ULL,
+    20ULL, 15ULL, 6ULL, 1ULL,
+    1ULL, 7ULL, 21ULL, 35ULL,
+    35ULL, 21ULL, 7ULL, 1ULL,
+    1ULL, 8ULL, 28ULL, 56ULL,
+    70ULL, 56ULL, 28ULL, 8ULL,
+    1ULL, 1ULL, 9ULL, 36ULL,
+    84ULL, 126ULL, 126ULL, 84ULL,
+    36ULL, 9ULL, 1ULL, 1ULL,
+    10ULL, 45ULL, 120ULL, 210ULL,
+    252ULL, 210ULL, 120ULL, 45ULL,
+    10ULL, 1ULL, 1ULL, 11ULL,
+    55ULL, 165ULL, 330ULL, 462ULL,
+    462ULL, 330ULL, 165ULL, 55ULL,
+    11ULL, 1ULL, 1ULL, 12ULL,
+    66ULL, 220ULL, 495ULL, 792ULL,
+    924ULL, 792ULL, 495ULL, 220ULL,
+    66ULL, 12ULL, 1ULL, 1ULL,
+    13ULL, 78ULL, 286ULL, 715ULL,
+    1287ULL, 1716ULL, 1716ULL, 1287ULL,
+    715ULL, 286ULL, 78ULL, 13ULL,
+    1ULL, 1ULL, 14ULL, 91ULL,
+    364ULL, 1001ULL, 2002ULL, 3003ULL,
+    3432ULL, 3003ULL, 2002ULL, 1001ULL,
+    364ULL, 91ULL, 14ULL, 1ULL,
+    1ULL, 15ULL, 105ULL, 455ULL,
+    1365ULL, 3003ULL, 5005ULL, 6435ULL,
+    6435ULL, 5005ULL, 3003ULL, 1365ULL,
+    455ULL, 105ULL, 15ULL, 1ULL,
+    1ULL, 16ULL, 120ULL, 560ULL,
+    1820ULL, 4368ULL, 8008ULL, 11440ULL,
+    12870ULL, 11440ULL, 8008ULL, 4368ULL,
+    1820ULL, 560ULL, 120ULL, 16ULL,
+    1ULL, 1ULL, 17ULL, 136ULL,
+    680ULL, 2380ULL, 6188ULL, 12376ULL,
+    19448ULL, 24310ULL, 24310ULL, 19448ULL,
+    12376ULL, 6188ULL, 2380ULL, 680ULL,
+    136ULL, 17ULL, 1ULL, 1ULL,
+    18ULL, 153ULL, 816ULL, 3060ULL,
+    8568ULL, 18564ULL, 31824ULL, 43758ULL,
+    48620ULL, 43758ULL, 31824ULL, 18564ULL,
+    8568ULL, 3060ULL, 816ULL, 153ULL,
+    18ULL, 1ULL, 1ULL, 19ULL,
+    171ULL, 969ULL, 3876ULL, 11628ULL,
+    27132ULL, 50388ULL, 75582ULL, 92378ULL,
+    92378ULL, 75582ULL, 50388ULL, 27132ULL,
+    11628ULL, 3876ULL, 969ULL, 171ULL,
+    19ULL, 1ULL, 1ULL, 20ULL,
+    190ULL, 1140ULL, 4845ULL, 15504ULL,
+    38760ULL, 77520ULL, 125970ULL, 167960ULL,
+    184756ULL, 167960ULL, 125970ULL, 77520ULL,
+    38760ULL, 15504ULL, 4845ULL, 1140ULL,
+    190ULL, 20ULL, 1ULL, 1ULL,
+    21ULL, 210ULL, 1330ULL, 5985ULL,
+    20349ULL, 54264ULL, 116280ULL, 203490ULL,
+    293930ULL, 352716ULL, 352716ULL, 293930ULL,
+    203490ULL, 116280ULL, 54264ULL, 20349ULL,
+    5985ULL, 1330ULL, 210ULL, 21ULL,
+    1ULL, 1ULL, 22ULL, 231ULL,
+    1540ULL, 7315ULL, 26334ULL, 74613ULL,
+    170544ULL, 319770ULL, 497420ULL, 646646ULL,
+    705432ULL, 646646ULL, 497420ULL, 319770ULL,
+    170544ULL, 74613ULL, 26334ULL, 7315ULL,
+    1540ULL, 231ULL, 22ULL, 1ULL,
+    1ULL, 23ULL, 253ULL, 1771ULL,
+    8855ULL, 33649ULL, 100947ULL, 245157ULL,
+    490314ULL, 817190ULL, 1144066ULL, 1352078ULL,
+    1352078ULL, 1144066ULL, 817190ULL, 490314ULL,
+    245157ULL, 100947ULL, 33649ULL, 8855ULL,
+    1771ULL, 253ULL, 23ULL, 1ULL,
+    1ULL, 24ULL, 276ULL, 2024ULL,
+    10626ULL, 42504ULL, 134596ULL, 346104ULL,
+    735471ULL, 1307504ULL, 1961256ULL, 2496144ULL,
+    2704156ULL, 2496144ULL, 1961256ULL, 1307504ULL,
+    735471ULL, 346104ULL, 134596ULL, 42504ULL,
+    10626ULL, 2024ULL, 276ULL, 24ULL,
+    1ULL, 1ULL, 25ULL, 300ULL,
+    2300ULL, 12650ULL, 53130ULL, 177100ULL,
+    480700ULL, 1081575ULL, 2042975ULL, 3268760ULL,
+    4457400ULL, 5200300ULL, 5200300ULL, 4457400ULL,
+    3268760ULL, 2042975ULL, 1081575ULL, 480700ULL,
+    177100ULL, 53130ULL, 12650ULL, 2300ULL,
+    300ULL, 25ULL, 1ULL, 1ULL,
+    26ULL, 325ULL, 2600ULL, 14950ULL,
+    65780ULL, 230230ULL, 657800ULL, 1562275ULL,
+    3124550ULL, 5311735ULL, 7726160ULL, 9657700ULL,
+    10400600ULL, 9657700ULL, 7726160ULL, 5311735ULL,
+    3124550ULL, 1562275ULL, 657800ULL, 230230ULL,
+    65780ULL, 14950ULL, 2600ULL, 325ULL,
+    26ULL, 1ULL, 1ULL, 27ULL,
+    351ULL, 2925ULL, 17550ULL, 80730ULL,
+    296010ULL, 888030ULL, 2220075ULL, 4686825ULL,
+    8436285ULL, 13037895ULL, 17383860ULL, 20058300ULL,
+    20058300ULL, 17383860ULL, 13037895ULL, 8436285ULL,
+    4686825ULL, 2220075ULL, 888030ULL, 296010ULL,
+    80730ULL, 17550ULL, 2925ULL, 351ULL,
+    27ULL, 1ULL, 1ULL, 28ULL,
+    378ULL, 3276ULL, 20475ULL, 98280ULL,
+    376740ULL, 1184040ULL, 3108105ULL, 6906900ULL,
+    13123110ULL, 21474180ULL, 30421755ULL, 37442160ULL,
+    40116600ULL, 37442160ULL, 30421755ULL, 21474180ULL,
+    13123110ULL, 6906900ULL, 3108105ULL, 1184040ULL,
+    376740ULL, 98280ULL, 20475ULL, 3276ULL,
+    378ULL, 28ULL, 1ULL, 1ULL,
+    29ULL, 406ULL, 3654ULL, 23751ULL,
+    118755ULL, 475020ULL, 1560780ULL, 4292145ULL,
+    10015005ULL, 20030010ULL, 34597290ULL, 51895935ULL,
+    67863915ULL, 77558760ULL, 77558760ULL, 67863915ULL,
+    51895935ULL, 34597290ULL, 20030010ULL, 10015005ULL,
+    4292145ULL, 1560780ULL, 475020ULL, 118755ULL,
+    23751ULL, 3654ULL, 406ULL, 29ULL,
+    1ULL, 1ULL, 30ULL, 435ULL,
+    4060ULL, 27405ULL, 142506ULL, 593775ULL,
+    2035800ULL, 5852925ULL, 14307150ULL, 30045015ULL,
+    54627300ULL, 86493225ULL, 119759850ULL, 145422675ULL,
+    155117520ULL, 145422675ULL, 119759850ULL, 86493225ULL,
+    54627300ULL, 30045015ULL, 14307150ULL, 5852925ULL,
+    2035800ULL, 593775ULL, 142506ULL, 27405ULL,
+    4060ULL, 435ULL, 30ULL, 1ULL,
+    1ULL, 31ULL, 465ULL, 4495ULL,
+    31465ULL, 169911ULL, 736281ULL, 2629575ULL,
+    7888725ULL, 20160075ULL, 44352165ULL, 84672315ULL,
+    141120525ULL, 206253075ULL, 265182525ULL, 300540195ULL,
+    300540195ULL, 265182525ULL, 206253075ULL, 141120525ULL,
+    84672315ULL, 44352165ULL, 20160075ULL, 7888725ULL,
+    2629575ULL, 736281ULL, 169911ULL, 31465ULL,
+    4495ULL, 465ULL, 31ULL, 1ULL,
+    1ULL, 32ULL, 496ULL, 4960ULL,
+    35960ULL, 201376ULL, 906192ULL, 3365856ULL,
+    10518300ULL, 28048800ULL, 64512240ULL, 129024480ULL,
+    225792840ULL, 347373600ULL, 471435600ULL, 565722720ULL,
+    601080390ULL, 565722720ULL, 471435600ULL, 347373600ULL,
+    225792840ULL, 129024480ULL, 64512240ULL, 28048800ULL,
+    10518300ULL, 3365856ULL, 906192ULL, 201376ULL,
+    35960ULL, 4960ULL, 496ULL, 32ULL,
+    1ULL, 1ULL, 33ULL, 528ULL,
+    5456ULL, 40920ULL, 237336ULL, 1107568ULL,
+    4272048ULL, 13884156ULL, 38567100ULL, 92561040ULL,
+    193536720ULL, 354817320ULL, 573166440ULL, 818809200ULL,
+    1037158320ULL, 1166803110ULL, 1166803110ULL, 1037158320ULL,
+    818809200ULL, 573166440ULL, 354817320ULL, 193536720ULL,
+    92561040ULL, 38567100ULL, 13884156ULL, 4272048ULL,
+    1107568ULL, 237336ULL, 40920ULL, 5456ULL,
+    528ULL, 33ULL, 1ULL, 1ULL,
+    34ULL, 561ULL, 5984ULL, 46376ULL,
+    278256ULL, 1344904ULL, 5379616ULL, 18156204ULL,
+    52451256ULL, 131128140ULL, 286097760ULL, 548354040ULL,
+    927983760ULL, 1391975640ULL, 1855967520ULL, 2203961430ULL,
+    2333606220ULL, 2203961430ULL, 1855967520ULL, 1391975640ULL,
+    927983760ULL, 548354040ULL, 286097760ULL, 131128140ULL,
+    52451256ULL, 18156204ULL, 5379616ULL, 1344904ULL,
+    278256ULL, 46376ULL, 5984ULL, 561ULL,
+    34ULL, 1ULL, 1ULL, 35ULL,
+    595ULL, 6545ULL, 52360ULL, 324632ULL,
+    1623160ULL, 6724520ULL, 23535820ULL, 70607460ULL,
+    183579396ULL, 417225900ULL, 834451800ULL, 1476337800ULL,
+    2319959400ULL, 3247943160ULL, 4059928950ULL, 4537567650ULL,
+    4537567650ULL, 4059928950ULL, 3247943160ULL, 2319959400ULL,
+    1476337800ULL, 834451800ULL, 417225900ULL, 183579396ULL,
+    70607460ULL, 23535820ULL, 6724520ULL, 1623160ULL,
+    324632ULL, 52360ULL, 6545ULL, 595ULL,
+    35ULL, 1ULL, 1ULL, 36ULL,
+    630ULL, 7140ULL, 58905ULL, 376992ULL,
+    1947792ULL, 8347680ULL, 30260340ULL, 94143280ULL,
+    254186856ULL, 600805296ULL, 1251677700ULL, 2310789600ULL,
+    3796297200ULL, 5567902560ULL, 7307872110ULL, 8597496600ULL,
+    9075135300ULL, 8597496600ULL, 7307872110ULL, 5567902560ULL,
+    3796297200ULL, 2310789600ULL, 1251677700ULL, 600805296ULL,
+    254186856ULL, 94143280ULL, 30260340ULL, 8347680ULL,
+    1947792ULL, 376992ULL, 58905ULL, 7140ULL,
+    630ULL, 36ULL, 1ULL, 1ULL,
+    37ULL, 666ULL, 7770ULL, 66045ULL,
+    435897ULL, 2324784ULL, 10295472ULL, 38608020ULL,
+    124403620ULL, 348330136ULL, 854992152ULL, 1852482996ULL,
+    3562467300ULL, 6107086800ULL, 9364199760ULL, 12875774670ULL,
+    15905368710ULL, 17672631900ULL, 17672631900ULL, 15905368710ULL,
+    12875774670ULL, 9364199760ULL, 6107086800ULL, 3562467300ULL,
+    1852482996ULL, 854992152ULL, 348330136ULL, 124403620ULL,
+    38608020ULL, 10295472ULL, 2324784ULL, 435897ULL,
+    66045ULL, 7770ULL, 666ULL, 37ULL,
+    1ULL, 1ULL, 38ULL, 703ULL,
+    8436ULL, 73815ULL, 501942ULL, 2760681ULL,
+    12620256ULL, 48903492ULL, 163011640ULL, 472733756ULL,
+    1203322288ULL, 2707475148ULL, 5414950296ULL, 9669554100ULL,
+    15471286560ULL, 22239974430ULL, 28781143380ULL, 33578000610ULL,
+    35345263800ULL, 33578000610ULL, 28781143380ULL, 22239974430ULL,
+    15471286560ULL, 9669554100ULL, 5414950296ULL, 2707475148ULL,
+    1203322288ULL, 472733756ULL, 163011640ULL, 48903492ULL,
+    12620256ULL, 2760681ULL, 501942ULL, 73815ULL,
+    8436ULL, 703ULL, 38ULL, 1ULL,
+    1ULL, 39ULL, 741ULL, 9139ULL,
+    82251ULL, 575757ULL, 3262623ULL, 15380937ULL,
+    61523748ULL, 211915132ULL, 635745396ULL, 1676056044ULL,
+    3910797436ULL, 8122425444ULL, 15084504396ULL, 25140840660ULL,
+    37711260990ULL, 51021117810ULL, 62359143990ULL, 68923264410ULL,
+    68923264410ULL, 62359143990ULL, 51021117810ULL, 37711260990ULL,
+    25140840660ULL, 15084504396ULL, 8122425444ULL, 3910797436ULL,
+    1676056044ULL, 635745396ULL, 211915132ULL, 61523748ULL,
+    15380937ULL, 3262623ULL, 575757ULL, 82251ULL,
+    9139ULL, 741ULL, 39ULL, 1ULL,
+    1ULL, 40ULL, 780ULL, 9880ULL,
+    91390ULL, 658008ULL, 3838380ULL, 18643560ULL,
+    76904685ULL, 273438880ULL, 847660528ULL, 2311801440ULL,
+    5586853480ULL, 12033222880ULL, 23206929840ULL, 40225345056ULL,
+    62852101650ULL, 88732378800ULL, 113380261800ULL, 131282408400ULL,
+    137846528820ULL, 131282408400ULL, 113380261800ULL, 88732378800ULL,
+    62852101650ULL, 40225345056ULL, 23206929840ULL, 12033222880ULL,
+    5586853480ULL, 2311801440ULL, 847660528ULL, 273438880ULL,
+    76904685ULL, 18643560ULL, 3838380ULL, 658008ULL,
+    91390ULL, 9880ULL, 780ULL, 40ULL,
+    1ULL, 1ULL, 41ULL, 820ULL,
+    10660ULL, 101270ULL, 749398ULL, 4496388ULL,
+    22481940ULL, 95548245ULL, 350343565ULL, 1121099408ULL,
+    3159461968ULL, 7898654920ULL, 17620076360ULL, 35240152720ULL,
+    63432274896ULL, 103077446706ULL, 151584480450ULL, 202112640600ULL,
+    244662670200ULL, 269128937220ULL, 269128937220ULL, 244662670200ULL,
+    202112640600ULL, 151584480450ULL, 103077446706ULL, 63432274896ULL,
+    35240152720ULL, 17620076360ULL, 7898654920ULL, 3159461968ULL,
+    1121099408ULL, 350343565ULL, 95548245ULL, 22481940ULL,
+    4496388ULL, 749398ULL, 101270ULL, 10660ULL,
+    820ULL, 41ULL, 1ULL, 1ULL,
+    42ULL, 861ULL, 11480ULL, 111930ULL,
+    850668ULL, 5245786ULL, 26978328ULL, 118030185ULL,
+    445891810ULL, 1471442973ULL, 4280561376ULL, 11058116888ULL,
+    25518731280ULL, 52860229080ULL, 98672427616ULL, 166509721602ULL,
+    254661927156ULL, 353697121050ULL, 446775310800ULL, 513791607420ULL,
+    538257874440ULL, 513791607420ULL, 446775310800ULL, 353697121050ULL,
+    254661927156ULL, 166509721602ULL, 98672427616ULL, 52860229080ULL,
+    25518731280ULL, 11058116888ULL, 4280561376ULL, 1471442973ULL,
+    445891810ULL, 118030185ULL, 26978328ULL, 5245786ULL,
+    850668ULL, 111930ULL, 11480ULL, 861ULL,
+    42ULL, 1ULL, 1ULL, 43ULL,
+    903ULL, 12341ULL, 123410ULL, 962598ULL,
+    6096454ULL, 32224114ULL, 145008513ULL, 563921995ULL,
+    1917334783ULL, 5752004349ULL, 15338678264ULL, 36576848168ULL,
+    78378960360ULL, 151532656696ULL, 265182149218ULL, 421171648758ULL,
+    608359048206ULL, 800472431850ULL, 960566918220ULL, 1052049481860ULL,
+    1052049481860ULL, 960566918220ULL, 800472431850ULL, 608359048206ULL,
+    421171648758ULL, 265182149218ULL, 151532656696ULL, 78378960360ULL,
+    36576848168ULL, 15338678264ULL, 5752004349ULL, 1917334783ULL,
+    563921995ULL, 145008513ULL, 32224114ULL, 6096454ULL,
+    962598ULL, 123410ULL, 12341ULL, 903ULL,
+    43ULL, 1ULL, 1ULL, 44ULL,
+    946ULL, 13244ULL, 135751ULL, 1086008ULL,
+    7059052ULL, 38320568ULL, 177232627ULL, 708930508ULL,
+    2481256778ULL, 7669339132ULL, 21090682613ULL, 51915526432ULL,
+    114955808528ULL, 229911617056ULL, 416714805914ULL, 686353797976ULL,
+    1029530696964ULL, 1408831480056ULL, 1761039350070ULL, 2012616400080ULL,
+    2104098963720ULL, 2012616400080ULL, 1761039350070ULL, 1408831480056ULL,
+    1029530696964ULL, 686353797976ULL, 416714805914ULL, 229911617056ULL,
+    114955808528ULL, 51915526432ULL, 21090682613ULL, 7669339132ULL,
+    2481256778ULL, 708930508ULL, 177232627ULL, 38320568ULL,
+    7059052ULL, 1086008ULL, 135751ULL, 13244ULL,
+    946ULL, 44ULL, 1ULL, 1ULL,
+    45ULL, 990ULL, 14190ULL, 148995ULL,
+    1221759ULL, 8145060ULL, 45379620ULL, 215553195ULL,
+    886163135ULL, 3190187286ULL, 10150595910ULL, 28760021745ULL,
+    73006209045ULL, 166871334960ULL, 344867425584ULL, 646626422970ULL,
+    1103068603890ULL, 1715884494940ULL, 2438362177020ULL, 3169870830126ULL,
+    3773655750150ULL, 4116715363800ULL, 4116715363800ULL, 3773655750150ULL,
+    3169870830126ULL, 2438362177020ULL, 1715884494940ULL, 1103068603890ULL,
+    646626422970ULL, 344867425584ULL, 166871334960ULL, 73006209045ULL,
+    28760021745ULL, 10150595910ULL, 3190187286ULL, 886163135ULL,
+    215553195ULL, 45379620ULL, 8145060ULL, 1221759ULL,
+    148995ULL, 14190ULL, 990ULL, 45ULL,
+    1ULL, 1ULL, 46ULL, 1035ULL,
+    15180ULL, 163185ULL, 1370754ULL, 9366819ULL,
+    53524680ULL, 260932815ULL, 1101716330ULL, 4076350421ULL,
+    13340783196ULL, 38910617655ULL, 101766230790ULL, 239877544005ULL,
+    511738760544ULL, 991493848554ULL, 1749695026860ULL, 2818953098830ULL,
+    4154246671960ULL, 5608233007146ULL, 6943526580276ULL, 7890371113950ULL,
+    8233430727600ULL, 7890371113950ULL, 6943526580276ULL, 5608233007146ULL,
+    4154246671960ULL, 2818953098830ULL, 1749695026860ULL, 991493848554ULL,
+    511738760544ULL, 239877544005ULL, 101766230790ULL, 38910617655ULL,
+    13340783196ULL, 4076350421ULL, 1101716330ULL, 260932815ULL,
+    53524680ULL, 9366819ULL, 1370754ULL, 163185ULL,
+    15180ULL, 1035ULL, 46ULL, 1ULL,
+    1ULL, 47ULL, 1081ULL, 16215ULL,
+    178365ULL, 1533939ULL, 10737573ULL, 62891499ULL,
+    314457495ULL, 1362649145ULL, 5178066751ULL, 17417133617ULL,
+    52251400851ULL, 140676848445ULL, 341643774795ULL, 751616304549ULL,
+    1503232609098ULL, 2741188875414ULL, 4568648125690ULL, 6973199770790ULL,
+    9762479679106ULL, 12551759587422ULL, 14833897694226ULL, 16123801841550ULL,
+    16123801841550ULL, 14833897694226ULL, 12551759587422ULL, 9762479679106ULL,
+    6973199770790ULL, 4568648125690ULL, 2741188875414ULL, 1503232609098ULL,
+    751616304549ULL, 341643774795ULL, 140676848445ULL, 52251400851ULL,
+    17417133617ULL, 5178066751ULL, 1362649145ULL, 314457495ULL,
+    62891499ULL, 10737573ULL, 1533939ULL, 178365ULL,
+    16215ULL, 1081ULL, 47ULL, 1ULL,
+    1ULL, 48ULL, 1128ULL, 17296ULL,
+    194580ULL, 1712304ULL, 12271512ULL, 73629072ULL,
+    377348994ULL, 1677106640ULL, 6540715896ULL, 22595200368ULL,
+    69668534468ULL, 192928249296ULL, 482320623240ULL, 1093260079344ULL,
+    2254848913647ULL, 4244421484512ULL, 7309837001104ULL, 11541847896480ULL,
+    16735679449896ULL, 22314239266528ULL, 27385657281648ULL, 30957699535776ULL,
+    32247603683100ULL, 30957699535776ULL, 27385657281648ULL, 22314239266528ULL,
+    16735679449896ULL, 11541847896480ULL, 7309837001104ULL, 4244421484512ULL,
+    2254848913647ULL, 1093260079344ULL, 482320623240ULL, 192928249296ULL,
+    69668534468ULL, 22595200368ULL, 6540715896ULL, 1677106640ULL,
+    377348994ULL, 73629072ULL, 12271512ULL, 1712304ULL,
+    194580ULL, 17296ULL, 1128ULL, 48ULL,
+    1ULL, 1ULL, 49ULL, 1176ULL,
+    18424ULL, 211876ULL, 1906884ULL, 13983816ULL,
+    85900584ULL, 450978066ULL, 2054455634ULL, 8217822536ULL,
+    29135916264ULL, 92263734836ULL, 262596783764ULL, 675248872536ULL,
+    1575580702584ULL, 3348108992991ULL, 6499270398159ULL, 11554258485616ULL,
+    18851684897584ULL, 28277527346376ULL, 39049918716424ULL, 49699896548176ULL,
+    58343356817424ULL, 63205303218876ULL, 63205303218876ULL, 58343356817424ULL,
+    49699896548176ULL, 39049918716424ULL, 28277527346376ULL, 18851684897584ULL,
+    11554258485616ULL, 6499270398159ULL, 3348108992991ULL, 1575580702584ULL,
+    675248872536ULL, 262596783764ULL, 92263734836ULL, 29135916264ULL,
+    8217822536ULL, 2054455634ULL, 450978066ULL, 85900584ULL,
+    13983816ULL, 1906884ULL, 211876ULL, 18424ULL,
+    1176ULL, 49ULL, 1ULL, 1ULL,
+    50ULL, 1225ULL, 19600ULL, 230300ULL,
+    2118760ULL, 15890700ULL, 99884400ULL, 536878650ULL,
+    2505433700ULL, 10272278170ULL, 37353738800ULL, 121399651100ULL,
+    354860518600ULL, 937845656300ULL, 2250829575120ULL, 4923689695575ULL,
+    9847379391150ULL, 18053528883775ULL, 30405943383200ULL, 47129212243960ULL,
+    67327446062800ULL, 88749815264600ULL, 108043253365600ULL, 121548660036300ULL,
+    126410606437752ULL, 121548660036300ULL, 108043253365600ULL, 88749815264600ULL,
+    67327446062800ULL, 47129212243960ULL, 30405943383200ULL, 18053528883775ULL,
+    9847379391150ULL, 4923689695575ULL, 2250829575120ULL, 937845656300ULL,
+    354860518600ULL, 121399651100ULL, 37353738800ULL, 10272278170ULL,
+    2505433700ULL, 536878650ULL, 99884400ULL, 15890700ULL,
+    2118760ULL, 230300ULL, 19600ULL, 1225ULL,
+    50ULL, 1ULL, 1ULL, 51ULL,
+    1275ULL, 20825ULL, 249900ULL, 2349060ULL,
+    18009460ULL, 115775100ULL, 636763050ULL, 3042312350ULL,
+    12777711870ULL, 47626016970ULL, 158753389900ULL, 476260169700ULL,
+    1292706174900ULL, 3188675231420ULL, 7174519270695ULL, 14771069086725ULL,
+    27900908274925ULL, 48459472266975ULL, 77535155627160ULL, 114456658306760ULL,
+    156077261327400ULL, 196793068630200ULL, 229591913401900ULL, 247959266474052ULL,
+    247959266474052ULL, 229591913401900ULL, 196793068630200ULL, 156077261327400ULL,
+    114456658306760ULL, 77535155627160ULL, 48459472266975ULL, 27900908274925ULL,
+    14771069086725ULL, 7174519270695ULL, 3188675231420ULL, 1292706174900ULL,
+    476260169700ULL, 158753389900ULL, 47626016970ULL, 12777711870ULL,
+    3042312350ULL, 636763050ULL, 115775100ULL, 18009460ULL,
+    2349060ULL, 249900ULL, 20825ULL, 1275ULL,
+    51ULL, 1ULL, 1ULL, 52ULL,
+    1326ULL, 22100ULL, 270725ULL, 2598960ULL,
+    20358520ULL, 133784560ULL, 752538150ULL, 3679075400ULL,
+    15820024220ULL, 60403728840ULL, 206379406870ULL, 635013559600ULL,
+    1768966344600ULL, 4481381406320ULL, 10363194502115ULL, 21945588357420ULL,
+    42671977361650ULL, 76360380541900ULL, 125994627894135ULL, 191991813933920ULL,
+    270533919634160ULL, 352870329957600ULL, 426384982032100ULL, 477551179875952ULL,
+    495918532948104ULL, 477551179875952ULL, 426384982032100ULL, 352870329957600ULL,
+    270533919634160ULL, 191991813933920ULL, 125994627894135ULL, 76360380541900ULL,
+    42671977361650ULL, 21945588357420ULL, 10363194502115ULL, 4481381406320ULL,
+    1768966344600ULL, 635013559600ULL, 206379406870ULL, 60403728840ULL,
+    15820024220ULL, 3679075400ULL, 752538150ULL, 133784560ULL,
+    20358520ULL, 2598960ULL, 270725ULL, 22100ULL,
+    1326ULL, 52ULL, 1ULL, 1ULL,
+    53ULL, 1378ULL, 23426ULL, 292825ULL,
+    2869685ULL, 22957480ULL, 154143080ULL, 886322710ULL,
+    4431613550ULL, 19499099620ULL, 76223753060ULL, 266783135710ULL,
+    841392966470ULL, 2403979904200ULL, 6250347750920ULL, 14844575908435ULL,
+    32308782859535ULL, 64617565719070ULL, 119032357903550ULL, 202355008436035ULL,
+    317986441828055ULL, 462525733568080ULL, 623404249591760ULL, 779255311989700ULL,
+    903936161908052ULL, 973469712824056ULL, 973469712824056ULL, 903936161908052ULL,
+    779255311989700ULL, 623404249591760ULL, 462525733568080ULL, 317986441828055ULL,
+    202355008436035ULL, 119032357903550ULL, 64617565719070ULL, 32308782859535ULL,
+    14844575908435ULL, 6250347750920ULL, 2403979904200ULL, 841392966470ULL,
+    266783135710ULL, 76223753060ULL, 19499099620ULL, 4431613550ULL,
+    886322710ULL, 154143080ULL, 22957480ULL, 2869685ULL,
+    292825ULL, 23426ULL, 1378ULL, 53ULL,
+    1ULL, 1ULL, 54ULL, 1431ULL,
+    24804ULL, 316251ULL, 3162510ULL, 25827165ULL,
+    177100560ULL, 1040465790ULL, 5317936260ULL, 23930713170ULL,
+    95722852680ULL, 343006888770ULL, 1108176102180ULL, 3245372870670ULL,
+    8654327655120ULL, 21094923659355ULL, 47153358767970ULL, 96926348578605ULL,
+    183649923622620ULL, 321387366339585ULL, 520341450264090ULL, 780512175396135ULL,
+    1085929983159840ULL, 1402659561581460ULL, 1683191473897752ULL, 1877405874732108ULL,
+    1946939425648112ULL, 1877405874732108ULL, 1683191473897752ULL, 1402659561581460ULL,
+    1085929983159840ULL, 780512175396135ULL, 520341450264090ULL, 321387366339585ULL,
+    183649923622620ULL, 96926348578605ULL, 47153358767970ULL, 21094923659355ULL,
+    8654327655120ULL, 3245372870670ULL, 1108176102180ULL, 343006888770ULL,
+    95722852680ULL, 23930713170ULL, 5317936260ULL, 1040465790ULL,
+    177100560ULL, 25827165ULL, 3162510ULL, 316251ULL,
+    24804ULL, 1431ULL, 54ULL, 1ULL,
+    1ULL, 55ULL, 1485ULL, 26235ULL,
+    341055ULL, 3478761ULL, 28989675ULL, 202927725ULL,
+    1217566350ULL, 6358402050ULL, 29248649430ULL, 119653565850ULL,
+    438729741450ULL, 1451182990950ULL, 4353548972850ULL, 11899700525790ULL,
+    29749251314475ULL, 68248282427325ULL, 144079707346575ULL, 280576272201225ULL,
+    505037289962205ULL, 841728816603675ULL, 1300853625660225ULL, 1866442158555975ULL,
+    2488589544741300ULL, 3085851035479212ULL, 3560597348629860ULL, 3824345300380220ULL,
+    3824345300380220ULL, 3560597348629860ULL, 3085851035479212ULL, 2488589544741300ULL,
+    1866442158555975ULL, 1300853625660225ULL, 841728816603675ULL, 505037289962205ULL,
+    280576272201225ULL, 144079707346575ULL, 68248282427325ULL, 29749251314475ULL,
+    11899700525790ULL, 4353548972850ULL, 1451182990950ULL, 438729741450ULL,
+    119653565850ULL, 29248649430ULL, 6358402050ULL, 1217566350ULL,
+    202927725ULL, 28989675ULL, 3478761ULL, 341055ULL,
+    26235ULL, 1485ULL, 55ULL, 1ULL,
+    1ULL, 56ULL, 1540ULL, 27720ULL,
+    367290ULL, 3819816ULL, 32468436ULL, 231917400ULL,
+    1420494075ULL, 7575968400ULL, 35607051480ULL, 148902215280ULL,
+    558383307300ULL, 1889912732400ULL, 5804731963800ULL, 16253249498640ULL,
+    41648951840265ULL, 97997533741800ULL, 212327989773900ULL, 424655979547800ULL,
+    785613562163430ULL, 1346766106565880ULL, 2142582442263900ULL, 3167295784216200ULL,
+    4355031703297275ULL, 5574440580220512ULL, 6646448384109072ULL, 7384942649010080ULL,
+    7648690600760440ULL, 7384942649010080ULL, 6646448384109072ULL, 5574440580220512ULL,
+    4355031703297275ULL, 3167295784216200ULL, 2142582442263900ULL, 1346766106565880ULL,
+    785613562163430ULL, 424655979547800ULL, 212327989773900ULL, 97997533741800ULL,
+    41648951840265ULL, 16253249498640ULL, 5804731963800ULL, 1889912732400ULL,
+    558383307300ULL, 148902215280ULL, 35607051480ULL, 7575968400ULL,
+    1420494075ULL, 231917400ULL, 32468436ULL, 3819816ULL,
+    367290ULL, 27720ULL, 1540ULL, 56ULL,
+    1ULL, 1ULL, 57ULL, 1596ULL,
+    29260ULL, 395010ULL, 4187106ULL, 36288252ULL,
+    264385836ULL, 1652411475ULL, 8996462475ULL, 43183019880ULL,
+    184509266760ULL, 707285522580ULL, 2448296039700ULL, 7694644696200ULL,
+    22057981462440ULL, 57902201338905ULL, 139646485582065ULL, 310325523515700ULL,
+    636983969321700ULL, 1210269541711230ULL, 2132379668729310ULL, 3489348548829780ULL,
+    5309878226480100ULL, 7522327487513475ULL, 9929472283517787ULL, 12220888964329584ULL,
+    14031391033119152ULL, 15033633249770520ULL, 15033633249770520ULL, 14031391033119152ULL,
+    12220888964329584ULL, 9929472283517787ULL, 7522327487513475ULL, 5309878226480100ULL,
+    3489348548829780ULL, 2132379668729310ULL, 1210269541711230ULL, 636983969321700ULL,
+    310325523515700ULL, 139646485582065ULL, 57902201338905ULL, 22057981462440ULL,
+    7694644696200ULL, 2448296039700ULL, 707285522580ULL, 184509266760ULL,
+    43183019880ULL, 8996462475ULL, 1652411475ULL, 264385836ULL,
+    36288252ULL, 4187106ULL, 395010ULL, 29260ULL,
+    1596ULL, 57ULL, 1ULL, 1ULL,
+    58ULL, 1653ULL, 30856ULL, 424270ULL,
+    4582116ULL, 40475358ULL, 300674088ULL, 1916797311ULL,
+    10648873950ULL, 52179482355ULL, 227692286640ULL, 891794789340ULL,
+    3155581562280ULL, 10142940735900ULL, 29752626158640ULL, 79960182801345ULL,
+    197548686920970ULL, 449972009097765ULL, 947309492837400ULL, 1847253511032930ULL,
+    3342649210440540ULL, 5621728217559090ULL, 8799226775309880ULL, 12832205713993575ULL,
+    17451799771031262ULL, 22150361247847371ULL, 26252279997448736ULL, 29065024282889672ULL,
+    30067266499541040ULL, 29065024282889672ULL, 26252279997448736ULL, 22150361247847371ULL,
+    17451799771031262ULL, 12832205713993575ULL, 8799226775309880ULL, 5621728217559090ULL,
+    3342649210440540ULL, 1847253511032930ULL, 947309492837400ULL, 449972009097765ULL,
+    197548686920970ULL, 79960182801345ULL, 29752626158640ULL, 10142940735900ULL,
+    3155581562280ULL, 891794789340ULL, 227692286640ULL, 52179482355ULL,
+    10648873950ULL, 1916797311ULL, 300674088ULL, 40475358ULL,
+    4582116ULL, 424270ULL, 30856ULL, 1653ULL,
+    58ULL, 1ULL, 1ULL, 59ULL,
+    1711ULL, 32509ULL, 455126ULL, 5006386ULL,
+    45057474ULL, 341149446ULL, 2217471399ULL, 12565671261ULL,
+    62828356305ULL, 279871768995ULL, 1119487075980ULL, 4047376351620ULL,
+    13298522298180ULL, 39895566894540ULL, 109712808959985ULL, 277508869722315ULL,
+    647520696018735ULL, 1397281501935165ULL, 2794563003870330ULL, 5189902721473470ULL,
+    8964377427999630ULL, 14420954992868970ULL, 21631432489303455ULL, 30284005485024837ULL,
+    39602161018878633ULL, 48402641245296107ULL, 55317304280338408ULL, 59132290782430712ULL,
+    59132290782430712ULL, 55317304280338408ULL, 48402641245296107ULL, 39602161018878633ULL,
+    30284005485024837ULL, 21631432489303455ULL, 14420954992868970ULL, 8964377427999630ULL,
+    5189902721473470ULL, 2794563003870330ULL, 1397281501935165ULL, 647520696018735ULL,
+    277508869722315ULL, 109712808959985ULL, 39895566894540ULL, 13298522298180ULL,
+    4047376351620ULL, 1119487075980ULL, 279871768995ULL, 62828356305ULL,
+    12565671261ULL, 2217471399ULL, 341149446ULL, 45057474ULL,
+    5006386ULL, 455126ULL, 32509ULL, 1711ULL,
+    59ULL, 1ULL, 1ULL, 60ULL,
+    1770ULL, 34220ULL, 487635ULL, 5461512ULL,
+    50063860ULL, 386206920ULL, 2558620845ULL, 14783142660ULL,
+    75394027566ULL, 342700125300ULL, 1399358844975ULL, 5166863427600ULL,
+    17345898649800ULL, 53194089192720ULL, 149608375854525ULL, 387221678682300ULL,
+    925029565741050ULL, 2044802197953900ULL, 4191844505805495ULL, 7984465725343800ULL,
+    14154280149473100ULL, 23385332420868600ULL, 36052387482172425ULL, 51915437974328292ULL,
+    69886166503903470ULL, 88004802264174740ULL, 103719945525634515ULL, 114449595062769120ULL,
+    118264581564861424ULL, 114449595062769120ULL, 103719945525634515ULL, 88004802264174740ULL,
+    69886166503903470ULL, 51915437974328292ULL, 36052387482172425ULL, 23385332420868600ULL,
+    14154280149473100ULL, 7984465725343800ULL, 4191844505805495ULL, 2044802197953900ULL,
+    925029565741050ULL, 387221678682300ULL, 149608375854525ULL, 53194089192720ULL,
+    17345898649800ULL, 5166863427600ULL, 1399358844975ULL, 342700125300ULL,
+    75394027566ULL, 14783142660ULL, 2558620845ULL, 386206920ULL,
+    50063860ULL, 5461512ULL, 487635ULL, 34220ULL,
+    1770ULL, 60ULL, 1ULL, 1ULL,
+    61ULL, 1830ULL, 35990ULL, 521855ULL,
+    5949147ULL, 55525372ULL, 436270780ULL, 2944827765ULL,
+    17341763505ULL, 90177170226ULL, 418094152866ULL, 1742058970275ULL,
+    6566222272575ULL, 22512762077400ULL, 70539987842520ULL, 202802465047245ULL,
+    536830054536825ULL, 1312251244423350ULL, 2969831763694950ULL, 6236646703759395ULL,
+    12176310231149295ULL, 22138745874816900ULL, 37539612570341700ULL, 59437719903041025ULL,
+    87967825456500717ULL, 121801604478231762ULL, 157890968768078210ULL, 191724747789809255ULL,
+    218169540588403635ULL, 232714176627630544ULL, 232714176627630544ULL, 218169540588403635ULL,
+    191724747789809255ULL, 157890968768078210ULL, 121801604478231762ULL, 87967825456500717ULL,
+    59437719903041025ULL, 37539612570341700ULL, 22138745874816900ULL, 12176310231149295ULL,
+    6236646703759395ULL, 2969831763694950ULL, 1312251244423350ULL, 536830054536825ULL,
+    202802465047245ULL, 70539987842520ULL, 22512762077400ULL, 6566222272575ULL,
+    1742058970275ULL, 418094152866ULL, 90177170226ULL, 17341763505ULL,
+    2944827765ULL, 436270780ULL, 55525372ULL, 5949147ULL,
+    521855ULL, 35990ULL, 1830ULL, 61ULL,
+    1ULL, 1ULL, 62ULL, 1891ULL,
+    37820ULL, 557845ULL, 6471002ULL, 61474519ULL,
+    491796152ULL, 3381098545ULL, 20286591270ULL, 107518933731ULL,
+    508271323092ULL, 2160153123141ULL, 8308281242850ULL, 29078984349975ULL,
+    93052749919920ULL, 273342452889765ULL, 739632519584070ULL, 1849081298960175ULL,
+    4282083008118300ULL, 9206478467454345ULL, 18412956934908690ULL, 34315056105966195ULL,
+    59678358445158600ULL, 96977332473382725ULL, 147405545359541742ULL, 209769429934732479ULL,
+    279692573246309972ULL, 349615716557887465ULL, 409894288378212890ULL, 450883717216034179ULL,
+    465428353255261088ULL, 450883717216034179ULL, 409894288378212890ULL, 349615716557887465ULL,
+    279692573246309972ULL, 209769429934732479ULL, 147405545359541742ULL, 96977332473382725ULL,
+    59678358445158600ULL, 34315056105966195ULL, 18412956934908690ULL, 9206478467454345ULL,
+    4282083008118300ULL, 1849081298960175ULL, 739632519584070ULL, 273342452889765ULL,
+    93052749919920ULL, 29078984349975ULL, 8308281242850ULL, 2160153123141ULL,
+    508271323092ULL, 107518933731ULL, 20286591270ULL, 3381098545ULL,
+    491796152ULL, 61474519ULL, 6471002ULL, 557845ULL,
+    37820ULL, 1891ULL, 62ULL, 1ULL,
+    1ULL, 63ULL, 1953ULL, 39711ULL,
+    595665ULL, 7028847ULL, 67945521ULL, 553270671ULL,
+    3872894697ULL, 23667689815ULL, 127805525001ULL, 615790256823ULL,
+    2668424446233ULL, 10468434365991ULL, 37387265592825ULL, 122131734269895ULL,
+    366395202809685ULL, 1012974972473835ULL, 2588713818544245ULL, 6131164307078475ULL,
+    13488561475572645ULL, 27619435402363035ULL, 52728013040874885ULL, 93993414551124795ULL,
+    156655690918541325ULL, 244382877832924467ULL, 357174975294274221ULL, 489462003181042451ULL,
+    629308289804197437ULL, 759510004936100355ULL, 860778005594247069ULL, 916312070471295267ULL,
+    916312070471295267ULL, 860778005594247069ULL, 759510004936100355ULL, 629308289804197437ULL,
+    489462003181042451ULL, 357174975294274221ULL, 244382877832924467ULL, 156655690918541325ULL,
+    93993414551124795ULL, 52728013040874885ULL, 27619435402363035ULL, 13488561475572645ULL,
+    6131164307078475ULL, 2588713818544245ULL, 1012974972473835ULL, 366395202809685ULL,
+    122131734269895ULL, 37387265592825ULL, 10468434365991ULL, 2668424446233ULL,
+    615790256823ULL, 127805525001ULL, 23667689815ULL, 3872894697ULL,
+    553270671ULL, 67945521ULL, 7028847ULL, 595665ULL,
+    39711ULL, 1953ULL, 63ULL, 1ULL,
+    1ULL, 64ULL, 2016ULL, 41664ULL,
+    635376ULL, 7624512ULL, 74974368ULL, 621216192ULL,
+    4426165368ULL, 27540584512ULL, 151473214816ULL, 743595781824ULL,
+    3284214703056ULL, 13136858812224ULL, 47855699958816ULL, 159518999862720ULL,
+    488526937079580ULL, 1379370175283520ULL, 3601688791018080ULL, 8719878125622720ULL,
+    19619725782651120ULL, 41107996877935680ULL, 80347448443237920ULL, 146721427591999680ULL,
+    250649105469666120ULL, 401038568751465792ULL, 601557853127198688ULL, 846636978475316672ULL,
+    1118770292985239888ULL, 1388818294740297792ULL, 1620288010530347424ULL, 1777090076065542336ULL,
+    1832624140942590534ULL, 1777090076065542336ULL, 1620288010530347424ULL, 1388818294740297792ULL,
+    1118770292985239888ULL, 846636978475316672ULL, 601557853127198688ULL, 401038568751465792ULL,
+    250649105469666120ULL, 146721427591999680ULL, 80347448443237920ULL, 41107996877935680ULL,
+    19619725782651120ULL, 8719878125622720ULL, 3601688791018080ULL, 1379370175283520ULL,
+    488526937079580ULL, 159518999862720ULL, 47855699958816ULL, 13136858812224ULL,
+    3284214703056ULL, 743595781824ULL, 151473214816ULL, 27540584512ULL,
+    4426165368ULL, 621216192ULL, 74974368ULL, 7624512ULL,
+    635376ULL, 41664ULL, 2016ULL, 64ULL,
+    1ULL, 1ULL, 65ULL, 2080ULL,
+    43680ULL, 677040ULL, 8259888ULL, 82598880ULL,
+    696190560ULL, 5047381560ULL, 31966749880ULL, 179013799328ULL,
+    895068996640ULL, 4027810484880ULL, 16421073515280ULL, 60992558771040ULL,
+    207374699821536ULL, 648045936942300ULL, 1867897112363100ULL, 4981058966301600ULL,
+    12321566916640800ULL, 28339603908273840ULL, 60727722660586800ULL, 121455445321173600ULL,
+    227068876035237600ULL, 397370533061665800ULL, 651687674221131912ULL, 1002596421878664480ULL,
+    1448194831602515360ULL, 1965407271460556560ULL, 2507588587725537680ULL, 3009106305270645216ULL,
+    3397378086595889760ULL, 3609714217008132870ULL, 3609714217008132870ULL, 3397378086595889760ULL,
+    3009106305270645216ULL, 2507588587725537680ULL, 1965407271460556560ULL, 1448194831602515360ULL,
+    1002596421878664480ULL, 651687674221131912ULL, 397370533061665800ULL, 227068876035237600ULL,
+    121455445321173600ULL, 60727722660586800ULL, 28339603908273840ULL, 12321566916640800ULL,
+    4981058966301600ULL, 1867897112363100ULL, 648045936942300ULL, 207374699821536ULL,
+    60992558771040ULL, 16421073515280ULL, 4027810484880ULL, 895068996640ULL,
+    179013799328ULL, 31966749880ULL, 5047381560ULL, 696190560ULL,
+    82598880ULL, 8259888ULL, 677040ULL, 43680ULL,
+    2080ULL, 65ULL, 1ULL, 1ULL,
+    66ULL, 2145ULL, 45760ULL, 720720ULL,
+    8936928ULL, 90858768ULL, 778789440ULL, 5743572120ULL,
+    37014131440ULL, 210980549208ULL, 1074082795968ULL, 4922879481520ULL,
+    20448884000160ULL, 77413632286320ULL, 268367258592576ULL, 855420636763836ULL,
+    2515943049305400ULL, 6848956078664700ULL, 17302625882942400ULL, 40661170824914640ULL,
+    89067326568860640ULL, 182183167981760400ULL, 348524321356411200ULL, 624439409096903400ULL,
+    1049058207282797712ULL, 1654284096099796392ULL, 2450791253481179840ULL, 3413602103063071920ULL,
+    4472995859186094240ULL, 5516694892996182896ULL, 6406484391866534976ULL, 7007092303604022630ULL,
+    7219428434016265740ULL, 7007092303604022630ULL, 6406484391866534976ULL, 5516694892996182896ULL,
+    4472995859186094240ULL, 3413602103063071920ULL, 2450791253481179840ULL, 1654284096099796392ULL,
+    1049058207282797712ULL, 624439409096903400ULL, 348524321356411200ULL, 182183167981760400ULL,
+    89067326568860640ULL, 40661170824914640ULL, 17302625882942400ULL, 6848956078664700ULL,
+    2515943049305400ULL, 855420636763836ULL, 268367258592576ULL, 77413632286320ULL,
+    20448884000160ULL, 4922879481520ULL, 1074082795968ULL, 210980549208ULL,
+    37014131440ULL, 5743572120ULL, 778789440ULL, 90858768ULL,
+    8936928ULL, 720720ULL, 45760ULL, 2145ULL,
+    66ULL, 1ULL, 1ULL, 67ULL,
+    2211ULL, 47905ULL, 766480ULL, 9657648ULL,
+    99795696ULL, 869648208ULL, 6522361560ULL, 42757703560ULL,
+    247994680648ULL, 1285063345176ULL, 5996962277488ULL, 25371763481680ULL,
+    97862516286480ULL, 345780890878896ULL, 1123787895356412ULL, 3371363686069236ULL,
+    9364899127970100ULL, 24151581961607100ULL, 57963796707857040ULL, 129728497393775280ULL,
+    271250494550621040ULL, 530707489338171600ULL, 972963730453314600ULL, 1673497616379701112ULL,
+    2703342303382594104ULL, 4105075349580976232ULL, 5864393356544251760ULL, 7886597962249166160ULL,
+    9989690752182277136ULL, 11923179284862717872ULL, 13413576695470557606ULL, 14226520737620288370ULL,
+    14226520737620288370ULL, 13413576695470557606ULL, 11923179284862717872ULL, 9989690752182277136ULL,
+    7886597962249166160ULL, 5864393356544251760ULL, 4105075349580976232ULL, 2703342303382594104ULL,
+    1673497616379701112ULL, 972963730453314600ULL, 530707489338171600ULL, 271250494550621040ULL,
+    129728497393775280ULL, 57963796707857040ULL, 24151581961607100ULL, 9364899127970100ULL,
+    3371363686069236ULL, 1123787895356412ULL, 345780890878896ULL, 97862516286480ULL,
+    25371763481680ULL, 5996962277488ULL, 1285063345176ULL, 247994680648ULL,
+    42757703560ULL, 6522361560ULL, 869648208ULL, 99795696ULL,
+    9657648ULL, 766480ULL, 47905ULL, 2211ULL,
+    67ULL, 1ULL
+};
+
+#endif
@@ -92,6 +92,7 @@
 
 
 #include "mconf.h"
+#include "factorial.h"
 
 static double P[] = {
     1.60119522476751861407E-4,
@@ -166,6 +167,10 @@ double Gamma(double x)
     if (!cephes_isfinite(x)) {
 	return x;
     }
+    if (x >= 1.0 && x <= FACTORIAL_MAX + 1 && x == floor(x)) {
+	/* Gamma(n) = (n - 1)! */
+	return (factorial_table[(int)x - 1]);
+    }
     q = fabs(x);
 
     if (q > 33.0) {
@@ -288,6 +293,9 @@ double lgam_sgn(double x, int *sign)
     if (!cephes_isfinite(x))
 	return x;
 
+    if (x >= 1.0 && x <= FACTORIAL_MAX + 1 && x == floor(x))
+	return (lnfactorial_table[(int)x - 1]);
+
     if (x < -34.0) {
 	q = -x;
 	w = lgam_sgn(q, sign);
@@ -362,3 +370,80 @@ double lgam_sgn(double x, int *sign)
 	q += polevl(p, A, 4) / x;
     return (q);
 }
+
+
+/*
+ * Single precision version of lgam for the float32 ufunc loops.
+ *
+ * The argument is reduced to [1, 2), where log Gamma(1 + w) = w (w - 1)
+ * BF(w) keeps its relative accuracy at both zeros, and Stirling's
+ * formula takes over from 8 on. The results are within a few units in
+ * the last place. Negative arguments go to the double precision version.
+ */
+static const float BF[] = {
+    9.3493309360132509E-4f,
+    -6.1991512947256214E-3f,
+    1.9242068491940161E-2f,
+    -3.8316890782970191E-2f,
+    5.7687810537335851E-2f,
+    -7.4574804379204745E-2f,
+    9.1698277186767308E-2f,
+    -1.1508261009726623E-1f,
+    1.5543030950145918E-1f,
+    -2.4525127145025810E-1f,
+    5.7721566450190340E-1f
+};
+
+/* Beyond this, log Gamma overflows in single precision */
+#define MAXLGMF 4.0850031e36f
+
+float lgamf(float x)
+{
+    float p, u, w, z;
+
+    if (!cephes_isfinite(x) || x <= 0.0f) {
+	if (cephes_isnan(x) || x > 0.0f)
+	    return x;
+	return (float)lgam(x);
+    }
+
+    if (x < 8.0f) {
+	/* Gamma(x) = Gamma(x + 1) / x, no rounding of x + 1 */
+	if (x < 1.0f) {
+	    if (x < 5.9604645e-8f)
+		return -logf(x);
+	    return x * (x - 1.0f) * polevlf(x, BF, 10) - logf(x);
+	}
+	/* Gamma(x) = (x - 1) ... (x - k) Gamma(x - k) */
+	z = 1.0f;
+	u = x;
+	while (u >= 2.0f) {
+	    u -= 1.0f;
+	    z *= u;
+	}
+	w = u - 1.0f;
+	p = w * (w - 1.0f) * polevlf(w, BF, 10);
+	if (x < 2.0f)
+	    return (w == 0.0f ? 0.0f : p);	/* +0 at x = 1 */
+	if (x < 3.0f)
+	    return (log1pf(w) + p);
+	return (logf(z) + p);
+    }
+
+    if (x > MAXLGMF) {
+	return (NPY_INFINITY);
+    }
+
+    w = logf(x);
+    if (x > 1.0e30f)
+	return (x * (w - 1.0f) - 0.5f * w + (float)LS2PI);
+
+    u = (x - 0.5f) * w - x + (float)LS2PI;
+    if (x > 1.0e7f)
+	return (u);
+
+    z = 1.0f / x;
+    p = z * z;
+    return (u + ((7.9365079365079365E-4f * p - 2.7777777777777778E-3f) * p
+		 + 8.3333333333333333E-2f) * z);
+}
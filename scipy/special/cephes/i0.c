@@ -180,3 +180,20 @@ double x;
     return (chbevl(32.0 / x - 2.0, B, 25) / sqrt(x));
 
 }
+
+
+/*
+ * Single precision version of i0e for the float32 ufunc loops, which
+ * leaves out the terms of the series below single precision.
+ */
+float i0ef(float x)
+{
+    double y;
+
+    y = fabs(x);
+    if (y <= 8.0) {
+	return (chbevl(y / 2.0 - 2.0, A + 11, 19));
+    }
+
+    return (chbevl(32.0 / y - 2.0, B + 18, 7) / sqrt(y));
+}
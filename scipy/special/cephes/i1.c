@@ -184,3 +184,25 @@ double x;
 	z = -z;
     return (z);
 }
+
+
+/*
+ * Single precision version of i1e for the float32 ufunc loops, which
+ * leaves out the terms of the series below single precision.
+ */
+float i1ef(float x)
+{
+    double y, z;
+
+    z = fabs(x);
+    if (z <= 8.0) {
+	y = (z / 2.0) - 2.0;
+	z = chbevl(y, A + 11, 18) * z;
+    }
+    else {
+	z = chbevl(32.0 / z - 2.0, B + 18, 7) / sqrt(z);
+    }
+    if (x < 0.0)
+	z = -z;
+    return (z);
+}
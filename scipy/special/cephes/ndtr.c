@@ -132,6 +132,7 @@
 
 #include <float.h>		/* DBL_EPSILON */
 #include "mconf.h"
+#include "_array_loops.h"
 
 extern double MAXLOG;
 
@@ -343,3 +344,394 @@ double log_ndtr(double a)
     }
     return log_LHS + log(right_hand_side);
 }
+
+
+/*
+ * Single precision versions of erf, erfc and ndtr for the float32 ufunc
+ * loops. The polynomials below are fitted to single precision and are
+ * shorter than the rational functions above; the results are within a
+ * few units in the last place.
+ */
+
+/* erf(x) = x T(x^2), 0 <= x <= 1 */
+static const float TF[] = {
+    7.8758750377216913E-5f,
+    -8.0168642791144424E-4f,
+    5.1890874224379189E-3f,
+    -2.6854212010037592E-2f,
+    1.1283594715143437E-1f,
+    -3.7612626666718320E-1f,
+    1.1283791658483503E0f
+};
+
+/* erfc(x) = exp(-x^2) 1/x P(1/x - PF_C), 1/sqrt(2) <= x < 2 */
+static const float PF[] = {
+    2.9920845544634865E-4f,
+    4.3154324936250201E-3f,
+    -1.1822460852108579E-2f,
+    1.8791173052345023E-2f,
+    -2.2044630636442320E-2f,
+    1.1613848041451454E-2f,
+    3.4264449974450328E-2f,
+    -1.5736834109671117E-1f,
+    4.3426973648151230E-1f
+};
+
+#define PF_C 0.95710678f
+
+/* erfc(x) = exp(-x^2) 1/x R(1/x^2), 2 <= x < ERFCF_MAX */
+static const float RF[] = {
+    -9.2455462977343419E0f,
+    1.1826983608752661E1f,
+    -7.0654467936484612E0f,
+    2.8388741324136899E0f,
+    -1.0068037718315852E0f,
+    4.2139147555110100E-1f,
+    -2.8206549067919998E-1f,
+    5.6418941472118951E-1f
+};
+
+/* Beyond this, erfc underflows in single precision */
+#define ERFCF_MAX 10.5f
+
+/*
+ * exp(-z) for z given in double precision. Rounding z = x^2 to single
+ * precision first would lose most of the accuracy for large x.
+ */
+static float expnf(double z)
+{
+    float zf = (float)z;
+
+    return expf(-zf) * (1.0f - (float)(z - zf));
+}
+
+/* erfc(x) for 1/sqrt(2) <= x < ERFCF_MAX, with e = exp(-x^2) */
+static float erfcf_tail(float x, float e)
+{
+    float q = 1.0f / x;
+
+    if (x < 2.0f)
+	return e * q * polevlf(q - PF_C, PF, 8);
+    return e * q * polevlf(q * q, RF, 7);
+}
+
+float ndtrf(float a)
+{
+    float x, y, z;
+
+    if (cephes_isnan(a)) {
+	mtherr("ndtr", DOMAIN);
+	return (NPY_NAN);
+    }
+
+    x = a * (float)NPY_SQRT1_2;
+    z = fabsf(x);
+
+    if (z < (float)NPY_SQRT1_2)
+	return (0.5f + 0.5f * erff(x));
+
+    if (z < ERFCF_MAX)
+	y = 0.5f * erfcf_tail(z, expnf(0.5 * (double)a * a));
+    else if (x < 0)
+	y = 0.5f * erfcf(z);
+    else
+	y = 0.0f;
+
+    if (x > 0)
+	y = 1.0f - y;
+
+    return (y);
+}
+
+float erfcf(float a)
+{
+    float x, y;
+
+    if (cephes_isnan(a)) {
+	mtherr("erfc", DOMAIN);
+	return (NPY_NAN);
+    }
+
+    x = fabsf(a);
+
+    if (x < (float)NPY_SQRT1_2)
+	return (1.0f - erff(a));
+
+    if (x >= ERFCF_MAX) {
+      under:
+	mtherr("erfc", UNDERFLOW);
+	if (a < 0)
+	    return (2.0f);
+	else
+	    return (0.0f);
+    }
+
+    y = erfcf_tail(x, expnf((double)x * x));
+
+    if (a < 0)
+	y = 2.0f - y;
+
+    if (y == 0.0f)
+	goto under;
+
+    return (y);
+}
+
+float erff(float x)
+{
+    float z;
+
+    if (cephes_isnan(x)) {
+	mtherr("erf", DOMAIN);
+	return (NPY_NAN);
+    }
+
+    if (x < 0.0f) {
+	return -erff(-x);
+    }
+
+    /* erf(x) rounds to 1 from here on */
+    if (x >= 4.0f)
+	return (1.0f);
+
+    if (x > 1.0f)
+	return (1.0f - erfcf(x));
+    z = x * x;
+
+    return (x * polevlf(z, TF, 6));
+}
+
+
+/*
+ * Array versions of ndtr, erf and log_ndtr for the ufunc loops, see
+ * _array_loops.h.
+ *
+ * Each range of the approximations is evaluated over the whole block
+ * and the results are chosen by selects. The lanes that need erfc's
+ * rational functions and exp() are gathered first, so that the others
+ * do not pay for them. Lanes that may report an error (nan, or arguments
+ * far enough out for erfc to underflow) are evaluated again by the
+ * scalar functions, and the other lanes do the same operations as the
+ * scalar functions, so that the results and the floating point
+ * exceptions are those of the scalar ufunc loop.
+ */
+
+/* Beyond this, erfc may underflow */
+#define ERFC_ARRAY_MAX 26.0
+
+/* erfc(x) for 1 <= x < ERFC_ARRAY_MAX */
+static ARRAY_LOOP_OPT void erfc_block(const double *x, double *y, int n)
+{
+    double e[ARRAY_LOOP_BLOCK];
+    int idx[ARRAY_LOOP_BLOCK];
+    int i, k, m;
+
+    for (i = 0; i < n; i++) {
+	e[i] = exp(-x[i] * x[i]);
+    }
+    for (i = 0; i < n; i++) {
+	y[i] = (e[i] * polevl(x[i], P, 8)) / p1evl(x[i], Q, 8);
+    }
+
+    /* R/S for the few lanes from 8 on */
+    m = 0;
+    for (i = 0; i < n; i++) {
+	idx[m] = i;
+	m += x[i] >= 8.0;
+    }
+    for (i = 0; i < m; i++) {
+	k = idx[i];
+	y[k] = (e[k] * polevl(x[k], R, 5)) / p1evl(x[k], S, 6);
+    }
+}
+
+/* ndtr, setting patch[i] for the lanes left to the scalar function */
+static ARRAY_LOOP_OPT void ndtr_block(const double *a, double *y, char *patch,
+                                      int n)
+{
+    double x[ARRAY_LOOP_BLOCK], z[ARRAY_LOOP_BLOCK], v[ARRAY_LOOP_BLOCK];
+    double lo[ARRAY_LOOP_BLOCK], hi[ARRAY_LOOP_BLOCK];
+    double zc[ARRAY_LOOP_BLOCK], ec[ARRAY_LOOP_BLOCK];
+    int idx[ARRAY_LOOP_BLOCK];
+    double ai, xi, zi, w, s;
+    int i, m;
+
+    /* no comparisons with nan, which would raise the invalid flag */
+    for (i = 0; i < n; i++) {
+	ai = a[i];
+	x[i] = cephes_isnan(ai) ? 0.0 : ai;
+    }
+    for (i = 0; i < n; i++) {
+	x[i] = x[i] * NPY_SQRT1_2;
+	z[i] = fabs(x[i]);
+    }
+
+    /* 0.5 + 0.5 erf(x) below 1/sqrt(2), and 0.5 (1 - erf(|x|)) up to 1 */
+    for (i = 0; i < n; i++) {
+	xi = x[i];
+	zi = z[i];
+	v[i] = zi < 1.0 ? xi : 0.0;
+    }
+    for (i = 0; i < n; i++) {
+	w = v[i] * v[i];
+	s = v[i] * polevl(w, T, 4) / p1evl(w, U, 5);
+	lo[i] = 0.5 + 0.5 * s;
+	hi[i] = 0.5 * (1.0 - fabs(s));
+    }
+    for (i = 0; i < n; i++) {
+	zi = z[i];
+	s = lo[i];
+	w = hi[i];
+	y[i] = zi < NPY_SQRT1_2 ? s : w;
+    }
+
+    /* 0.5 erfc(|x|) from 1 on */
+    m = 0;
+    for (i = 0; i < n; i++) {
+	idx[m] = i;
+	zc[m] = z[i];
+	m += z[i] >= 1.0 && z[i] < ERFC_ARRAY_MAX;
+    }
+    erfc_block(zc, ec, m);
+    for (i = 0; i < m; i++) {
+	y[idx[i]] = 0.5 * ec[i];
+    }
+
+    /* 1 - ndtr(-a) for positive a */
+    for (i = 0; i < n; i++) {
+	lo[i] = 1.0 - y[i];
+    }
+    for (i = 0; i < n; i++) {
+	xi = x[i];
+	zi = z[i];
+	s = lo[i];
+	w = y[i];
+	y[i] = (zi >= NPY_SQRT1_2) & (xi > 0) ? s : w;
+    }
+
+    for (i = 0; i < n; i++) {
+	patch[i] = cephes_isnan(a[i]) || !(z[i] < ERFC_ARRAY_MAX);
+    }
+}
+
+static void ndtr_array(const double *a, double *y, int n)
+{
+    char patch[ARRAY_LOOP_BLOCK];
+    int i;
+
+    ndtr_block(a, y, patch, n);
+    for (i = 0; i < n; i++) {
+	if (patch[i]) {
+	    y[i] = ndtr(a[i]);
+	}
+    }
+}
+
+static ARRAY_LOOP_OPT void erf_array(const double *x, double *y, int n)
+{
+    double v[ARRAY_LOOP_BLOCK], z[ARRAY_LOOP_BLOCK];
+    double zc[ARRAY_LOOP_BLOCK], ec[ARRAY_LOOP_BLOCK];
+    int idx[ARRAY_LOOP_BLOCK];
+    double xi, zi, w;
+    int i, k, m;
+
+    /* no comparisons with nan, which would raise the invalid flag */
+    for (i = 0; i < n; i++) {
+	xi = x[i];
+	v[i] = cephes_isnan(xi) ? 0.0 : xi;
+    }
+    for (i = 0; i < n; i++) {
+	z[i] = fabs(v[i]);
+    }
+
+    /* x T(x^2) / U(x^2) up to 1 */
+    for (i = 0; i < n; i++) {
+	xi = v[i];
+	zi = z[i];
+	v[i] = zi <= 1.0 ? xi : 0.0;
+    }
+    for (i = 0; i < n; i++) {
+	w = v[i] * v[i];
+	y[i] = v[i] * polevl(w, T, 4) / p1evl(w, U, 5);
+    }
+
+    /* 1 - erfc(|x|) above, with the sign of x */
+    m = 0;
+    for (i = 0; i < n; i++) {
+	idx[m] = i;
+	zc[m] = z[i];
+	m += z[i] > 1.0 && z[i] < ERFC_ARRAY_MAX;
+    }
+    erfc_block(zc, ec, m);
+    for (i = 0; i < m; i++) {
+	k = idx[i];
+	y[k] = x[k] < 0.0 ? -(1.0 - ec[i]) : 1.0 - ec[i];
+    }
+
+    for (i = 0; i < n; i++) {
+	if (cephes_isnan(x[i]) || !(z[i] < ERFC_ARRAY_MAX)) {
+	    y[i] = erf(x[i]);
+	}
+    }
+}
+
+static ARRAY_LOOP_OPT void log_ndtr_array(const double *a, double *y, int n)
+{
+    double b[ARRAY_LOOP_BLOCK], t[ARRAY_LOOP_BLOCK], u[ARRAY_LOOP_BLOCK];
+    char patch[ARRAY_LOOP_BLOCK];
+    double ai, ti, ui;
+    int i;
+
+    /* -ndtr(-a) above 6, log(ndtr(a)) down to -20 */
+    for (i = 0; i < n; i++) {
+	b[i] = -a[i];
+    }
+    for (i = 0; i < n; i++) {
+	ai = a[i];
+	ti = b[i];
+	b[i] = ai > 6 ? ti : (ai > -20 ? ai : 0.0);
+    }
+    ndtr_block(b, t, patch, n);
+    for (i = 0; i < n; i++) {
+	ai = a[i];
+	ti = t[i];
+	u[i] = ai > 6 ? 1.0 : ti;
+    }
+    for (i = 0; i < n; i++) {
+	u[i] = log(u[i]);
+	b[i] = -t[i];
+    }
+    for (i = 0; i < n; i++) {
+	ai = a[i];
+	ti = b[i];
+	ui = u[i];
+	y[i] = ai > 6 ? ti : ui;
+    }
+
+    /* the asymptotic series below -20 */
+    for (i = 0; i < n; i++) {
+	if (patch[i] || !(a[i] > -20)) {
+	    y[i] = log_ndtr(a[i]);
+	}
+    }
+}
+
+void ndtr_loop(char **args, npy_intp *dims, npy_intp *steps)
+{
+    array_loop_d(args, dims, steps, ndtr_array);
+}
+
+void erf_loop(char **args, npy_intp *dims, npy_intp *steps)
+{
+    array_loop_d(args, dims, steps, erf_array);
+}
+
+void log_ndtr_loop(char **args, npy_intp *dims, npy_intp *steps)
+{
+    array_loop_d(args, dims, steps, log_ndtr_array);
+}
+
+void log_ndtr_loop_f(char **args, npy_intp *dims, npy_intp *steps)
+{
+    array_loop_fd(args, dims, steps, log_ndtr_array);
+}
@@ -51,6 +51,7 @@
  */
 
 #include "mconf.h"
+#include "_array_loops.h"
 
 /* sqrt(2pi) */
 static double s2pi = 2.50662827463100050242E0;
@@ -173,3 +174,101 @@ double y0;
 	x = -x;
     return (x);
 }
+
+
+/*
+ * Array version of ndtri for the ufunc loops, see _array_loops.h.
+ *
+ * The central range is evaluated over the whole block; the tails, which
+ * need log() and sqrt(), are gathered and evaluated on their own, and so
+ * are the few lanes beyond exp(-32). The lanes
+ * out of (0, 1) are left to the scalar function for its error reports.
+ */
+static ARRAY_LOOP_OPT void ndtri_array(const double *y0, double *x, int n)
+{
+    double y[ARRAY_LOOP_BLOCK], yc[ARRAY_LOOP_BLOCK], t[ARRAY_LOOP_BLOCK];
+    double l[ARRAY_LOOP_BLOCK], r[ARRAY_LOOP_BLOCK];
+    int idx[ARRAY_LOOP_BLOCK], far[ARRAY_LOOP_BLOCK];
+    double v, v2, yi, z;
+    int i, j, k, m;
+
+    /* y = 1 - y0 above 1 - exp(-2), with the sign of the result flipped */
+    for (i = 0; i < n; i++) {
+	v = y0[i];
+	y[i] = (v > 0.0) & (v < 1.0) ? v : 0.5;
+    }
+    for (i = 0; i < n; i++) {
+	t[i] = 1.0 - y[i];
+    }
+    for (i = 0; i < n; i++) {
+	yi = y[i];
+	y[i] = yi > (1.0 - 0.13533528323661269189) ? t[i] : yi;
+    }
+    for (i = 0; i < n; i++) {
+	t[i] = y[i] - 0.5;
+    }
+    for (i = 0; i < n; i++) {
+	yi = y[i];
+	r[i] = yi > 0.13533528323661269189 ? t[i] : 0.0;
+    }
+    for (i = 0; i < n; i++) {
+	v = r[i];
+	v2 = v * v;
+	v = v + v * (v2 * polevl(v2, P0, 4) / p1evl(v2, Q0, 8));
+	x[i] = v * s2pi;
+    }
+
+    /* x = sqrt(-2 log(y)) - log(x) / x - R(1 / x) in the tails */
+    m = 0;
+    for (i = 0; i < n; i++) {
+	idx[m] = i;
+	yc[m] = y[i];
+	m += y[i] <= 0.13533528323661269189 && y0[i] > 0.0 && y0[i] < 1.0;
+    }
+    for (i = 0; i < m; i++) {
+	l[i] = log(yc[i]);
+    }
+    for (i = 0; i < m; i++) {
+	t[i] = sqrt(-2.0 * l[i]);
+    }
+    for (i = 0; i < m; i++) {
+	l[i] = log(t[i]);
+    }
+    for (i = 0; i < m; i++) {
+	z = 1.0 / t[i];
+	r[i] = z * polevl(z, P1, 8) / p1evl(z, Q1, 8);
+    }
+    /* P2/Q2 for the few lanes from 8 on */
+    j = 0;
+    for (i = 0; i < m; i++) {
+	far[j] = i;
+	j += !(t[i] < 8.0);
+    }
+    for (i = 0; i < j; i++) {
+	z = 1.0 / t[far[i]];
+	r[far[i]] = z * polevl(z, P2, 8) / p1evl(z, Q2, 8);
+    }
+    for (i = 0; i < m; i++) {
+	t[i] = (t[i] - l[i] / t[i]) - r[i];
+    }
+    for (i = 0; i < m; i++) {
+	k = idx[i];
+	x[k] = y0[k] > (1.0 - 0.13533528323661269189) ? t[i] : -t[i];
+    }
+
+    for (i = 0; i < n; i++) {
+	if (!(y0[i] > 0.0 && y0[i] < 1.0)) {
+	    x[i] = ndtri(y0[i]);
+	}
+    }
+}
+
+void ndtri_loop(char **args, npy_intp *dims, npy_intp *steps)
+{
+    array_loop_d(args, dims, steps, ndtri_array);
+}
+
+void ndtri_loop_f(char **args, npy_intp *dims, npy_intp *steps)
+{
+    array_loop_fd(args, dims, steps, ndtri_array);
+}
@@ -81,6 +81,25 @@ static NPY_INLINE double polevl(double x, const double coef[], int N)
     return (ans);
 }
 
+/* Single precision version of polevl */
+
+static NPY_INLINE float polevlf(float x, const float coef[], int N)
+{
+    float ans;
+    int i;
+    const float *p;
+
+    p = coef;
+    ans = *p++;
+    i = N;
+
+    do
+	ans = ans * x + *p++;
+    while (--i);
+
+    return (ans);
+}
+
 /*                                                     p1evl() */
 /*                                          N
  * Evaluate polynomial when coefficient of x  is 1.0.
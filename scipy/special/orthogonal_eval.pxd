@@ -42,6 +42,12 @@ cdef extern from "specfun_wrappers.h":
 cdef extern from "c_misc/misc.h":
     double gammasgn(double x) nogil
 
+cdef extern from "cephes/factorial.h":
+    int FACTORIAL_MAX
+    int BINOM_TABLE_MAX
+    const double *factorial_table
+    const unsigned long long *binom_table
+
 # Fused type wrappers
 
 cdef inline number_t hyp2f1(double a, double b, double c, number_t z) nogil:
@@ -76,6 +82,10 @@ cdef inline double binom(double n, double k) nogil:
             return nan
 
     kx = floor(k)
+    if k == kx and n == floor(n) and 0 <= k <= n <= BINOM_TABLE_MAX:
+        # Small integers: exact, from the table
+        return binom_table[<int>n*(<int>n + 1)//2 + <int>k]
+
     if k == kx and (fabs(n) > 1e-8 or n == 0):
         # Integer case: use multiplication formula for less rounding error
         # for cases where the result is an integer.
@@ -99,6 +109,10 @@ cdef inline double binom(double n, double k) nogil:
                     den = 1.0
             return num/den
 
+        if nx == n and 0 <= kx <= n <= FACTORIAL_MAX:
+            return (factorial_table[<int>n] / factorial_table[<int>kx]
+                    / factorial_table[<int>(n - kx)])
+
     # general case:
     if n >= 1e10*k and k > 0:
         # avoid under/overflows in intermediate results
@@ -248,6 +262,11 @@ cdef inline number_t eval_chebyt(double n, number_t x) nogil:
     cdef double a, b, c, d
     cdef number_t g
 
+    if number_t is double:
+        if n == floor(n) and fabs(n) <= 10000:
+            # Integer order: use the recurrence
+            return eval_chebyt_l(<long>n, x)
+
     d = 1.0
     a = -n
     b = n
@@ -361,6 +380,11 @@ cdef inline number_t eval_legendre(double n, number_t x) nogil:
     cdef double a, b, c, d
     cdef number_t g
 
+    if number_t is double:
+        if n == floor(n) and fabs(n) <= 10000:
+            # Integer order: use the recurrence
+            return eval_legendre_l(<long>n, x)
+
     d = 1
     a = -n
     b = n+1
@@ -36,6 +36,15 @@ static volatile sf_action_t sf_error_actions[] = {
 
 extern int wrap_PyUFunc_getfperr(void);
 
+#ifdef _MSC_VER
+#define SF_THREAD_LOCAL __declspec(thread)
+#else
+#define SF_THREAD_LOCAL __thread
+#endif
+
+/* The log of the calling thread, if its errors are being collected */
+static SF_THREAD_LOCAL sf_error_log *sf_error_current_log = NULL;
+
 
 void sf_error_set_action(sf_error_t code, sf_action_t action)
 {
@@ -49,6 +58,84 @@ sf_action_t sf_error_get_action(sf_error_t code)
 }
 
 
+static int sf_error_log_has(sf_error_log *log, sf_error_t code)
+{
+    int k;
+
+    for (k = 0; k < log->n; ++k) {
+        if (log->codes[k] == code) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+static void sf_error_log_add(sf_error_log *log, const char *func_name,
+                             sf_error_t code, const char *info)
+{
+    if (sf_error_log_has(log, code)) {
+        return;
+    }
+    log->codes[log->n] = code;
+    log->func_names[log->n] = func_name;
+    PyOS_snprintf(log->infos[log->n], 1024, "%s", info);
+    ++log->n;
+}
+
+
+void sf_error_log_attach(sf_error_log *log)
+{
+    sf_error_current_log = log;
+}
+
+
+void sf_error_log_merge(sf_error_log *log, sf_error_log *other)
+{
+    int k;
+
+    for (k = 0; k < other->n; ++k) {
+        sf_error_log_add(log, other->func_names[k], other->codes[k],
+                         other->infos[k]);
+    }
+}
+
+
+void sf_error_log_report(sf_error_log *log)
+{
+    int k;
+
+    for (k = 0; k < log->n; ++k) {
+        if (log->infos[k][0] != '\0') {
+            sf_error(log->func_names[k], log->codes[k], "%s", log->infos[k]);
+        }
+        else {
+            sf_error(log->func_names[k], log->codes[k], NULL);
+        }
+    }
+}
+
+
+int sf_error_log_begin(sf_error_log *log)
+{
+    if (sf_error_current_log != NULL) {
+        return 0;
+    }
+    log->n = 0;
+    sf_error_current_log = log;
+    return 1;
+}
+
+
+void sf_error_log_end(sf_error_log *log, int begun)
+{
+    if (begun) {
+        sf_error_current_log = NULL;
+        sf_error_log_report(log);
+    }
+}
+
+
 void sf_error(const char *func_name, sf_error_t code, const char *fmt, ...)
 {
     PyGILState_STATE save;
@@ -70,10 +157,23 @@ void sf_error(const char *func_name, sf_error_t code, const char *fmt, ...)
         func_name = "?";
     }
 
+    info[0] = '\0';
     if (fmt != NULL && fmt[0] != '\0') {
+        if (sf_error_current_log != NULL &&
+                sf_error_log_has(sf_error_current_log, code)) {
+            return;
+        }
         va_start(ap, fmt);
         PyOS_vsnprintf(info, 1024, fmt, ap);
         va_end(ap);
+    }
+
+    if (sf_error_current_log != NULL) {
+        sf_error_log_add(sf_error_current_log, func_name, code, info);
+        return;
+    }
+
+    if (info[0] != '\0') {
         PyOS_snprintf(msg, 2048, "scipy.special/%s: (%s) %s",
                       func_name, sf_error_messages[(int)code], info);
     }
@@ -31,6 +31,28 @@ void sf_error_check_fpe(const char *func_name);
 void sf_error_set_action(sf_error_t code, sf_action_t action);
 sf_action_t sf_error_get_action(sf_error_t code);
 
+/*
+ * The ufunc loops collect their errors in a log local to the thread,
+ * between sf_error_log_begin and sf_error_log_end, and report them at
+ * the end. Recording an error then needs neither the GIL nor any
+ * shared state. When a loop runs on several threads (see
+ * sf_threads.c), each has a log of its own, and the calling thread
+ * merges and reports them once all are done. A log keeps the first
+ * error of each code.
+ */
+typedef struct {
+    int n;
+    sf_error_t codes[SF_ERROR__LAST];
+    const char *func_names[SF_ERROR__LAST];
+    char infos[SF_ERROR__LAST][1024];
+} sf_error_log;
+
+void sf_error_log_attach(sf_error_log *log);
+void sf_error_log_merge(sf_error_log *log, sf_error_log *other);
+void sf_error_log_report(sf_error_log *log);
+int sf_error_log_begin(sf_error_log *log);
+void sf_error_log_end(sf_error_log *log, int begun);
+
 #ifdef __cplusplus
 }
 #endif
@@ -24,6 +24,11 @@ cdef extern from "sf_error.h":
     void set_action "sf_error_set_action" (sf_error_t code, sf_action_t action) nogil
     sf_action_t get_action "sf_error_get_action" (sf_error_t code) nogil
 
+    ctypedef struct sf_error_log:
+        int n
+    int log_begin "sf_error_log_begin" (sf_error_log *log) nogil
+    void log_end "sf_error_log_end" (sf_error_log *log, int begun) nogil
+
 
 cdef inline int _sf_error_test_function(int code) nogil:
     """Function that can raise every sf_error category for testing
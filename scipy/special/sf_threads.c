@@ -0,0 +1,163 @@
+/*
+ * Running ufunc inner loops on several threads.
+ *
+ * sf_threads_run_loop splits the outer loop of a ufunc into contiguous
+ * chunks, one per thread, and runs the inner loop on each. The errors
+ * of the threads are collected in sf_error logs, merged and reported by
+ * the calling thread at the end, since only it can hand an exception
+ * back to the ufunc machinery.
+ *
+ * The number of threads is a global setting, like the error actions of
+ * sf_error.c; it is 1 by default.
+ */
+#include <stdlib.h>
+
+#include "sf_error.h"
+#include "sf_threads.h"
+
+#ifdef _WIN32
+
+#include <windows.h>
+#include <process.h>
+
+typedef HANDLE sf_thread_handle;
+#define SF_THREAD_RETURN unsigned __stdcall
+
+#else
+
+#include <pthread.h>
+
+typedef pthread_t sf_thread_handle;
+#define SF_THREAD_RETURN void *
+
+#endif
+
+/* Outer loop elements per thread, at least */
+#define SF_THREADS_MIN_CHUNK 512
+#define SF_THREADS_MAX_ARGS 32
+
+static volatile int sf_threads_workers = 1;
+
+typedef struct {
+    sf_loop_t *loop;
+    char *args[SF_THREADS_MAX_ARGS];
+    npy_intp n;
+    npy_intp *steps;
+    void *data;
+    sf_error_log log;
+    sf_thread_handle handle;
+    int started;
+} sf_loop_task;
+
+
+void sf_threads_set_workers(int workers)
+{
+    sf_threads_workers = workers < 1 ? 1 : workers;
+}
+
+
+int sf_threads_get_workers(void)
+{
+    return sf_threads_workers;
+}
+
+
+static void sf_loop_task_run(sf_loop_task *task)
+{
+    npy_intp dims[1];
+
+    dims[0] = task->n;
+    sf_error_log_attach(&task->log);
+    task->loop(task->args, dims, task->steps, task->data);
+    sf_error_log_attach(NULL);
+}
+
+
+static SF_THREAD_RETURN sf_loop_task_main(void *arg)
+{
+    sf_loop_task_run((sf_loop_task *)arg);
+    return 0;
+}
+
+
+static int sf_loop_task_start(sf_loop_task *task)
+{
+#ifdef _WIN32
+    task->handle = (HANDLE)_beginthreadex(NULL, 0, sf_loop_task_main, task,
+                                          0, NULL);
+    return task->handle != 0;
+#else
+    return pthread_create(&task->handle, NULL, sf_loop_task_main,
+                          task) == 0;
+#endif
+}
+
+
+static void sf_loop_task_join(sf_loop_task *task)
+{
+#ifdef _WIN32
+    WaitForSingleObject(task->handle, INFINITE);
+    CloseHandle(task->handle);
+#else
+    pthread_join(task->handle, NULL);
+#endif
+}
+
+
+void sf_threads_run_loop(sf_loop_t *loop, int nargs, char **args,
+                         npy_intp *dims, npy_intp *steps, void *data)
+{
+    npy_intp n = dims[0], one = 1, start, end;
+    sf_loop_task *tasks = NULL;
+    int nthreads = sf_threads_workers, j, k;
+
+    if (nthreads > n / SF_THREADS_MIN_CHUNK) {
+        nthreads = (int)(n / SF_THREADS_MIN_CHUNK);
+    }
+    if (nthreads > 1 && nargs <= SF_THREADS_MAX_ARGS) {
+        tasks = calloc(nthreads, sizeof(sf_loop_task));
+    }
+    if (tasks == NULL) {
+        loop(args, dims, steps, data);
+        return;
+    }
+
+    /*
+     * Evaluate the first element on the calling thread before starting
+     * the others, so that one-time initializations in the kernels (such
+     * as those of d1mach) are done before they can race.
+     */
+    sf_error_log_attach(&tasks[0].log);
+    loop(args, &one, steps, data);
+    sf_error_log_attach(NULL);
+
+    for (k = 0; k < nthreads; ++k) {
+        start = 1 + (n - 1) * k / nthreads;
+        end = 1 + (n - 1) * (k + 1) / nthreads;
+        tasks[k].loop = loop;
+        for (j = 0; j < nargs; ++j) {
+            tasks[k].args[j] = args[j] + start * steps[j];
+        }
+        tasks[k].n = end - start;
+        tasks[k].steps = steps;
+        tasks[k].data = data;
+    }
+    for (k = 1; k < nthreads; ++k) {
+        tasks[k].started = sf_loop_task_start(tasks + k);
+    }
+    sf_loop_task_run(tasks);
+    for (k = 1; k < nthreads; ++k) {
+        if (tasks[k].started) {
+            sf_loop_task_join(tasks + k);
+        }
+        else {
+            sf_loop_task_run(tasks + k);
+        }
+    }
+
+    for (k = 1; k < nthreads; ++k) {
+        sf_error_log_merge(&tasks[0].log, &tasks[k].log);
+    }
+    sf_error_log_report(&tasks[0].log);
+    free(tasks);
+}
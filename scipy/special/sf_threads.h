@@ -0,0 +1,22 @@
+#ifndef SF_THREADS_H_
+#define SF_THREADS_H_
+
+#include "numpy/npy_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void sf_loop_t(char **args, npy_intp *dims, npy_intp *steps,
+                       void *data);
+
+void sf_threads_set_workers(int workers);
+int sf_threads_get_workers(void);
+void sf_threads_run_loop(sf_loop_t *loop, int nargs, char **args,
+                         npy_intp *dims, npy_intp *steps, void *data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SF_THREADS_H_ */
@@ -0,0 +1,13 @@
+# -*-cython-*-
+
+cimport numpy as np
+
+ctypedef void (*loop_func_t)(char **args, np.npy_intp *dims,
+                             np.npy_intp *steps, void *data) nogil
+
+cdef extern from "sf_threads.h":
+    void set_workers "sf_threads_set_workers" (int workers) nogil
+    int get_workers "sf_threads_get_workers" () nogil
+    void run_loop "sf_threads_run_loop" (loop_func_t loop, int nargs, char **args,
+                                         np.npy_intp *dims, np.npy_intp *steps,
+                                         void *data) nogil
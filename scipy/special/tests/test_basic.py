@@ -111,6 +111,17 @@ class TestCephes(object):
                           nk,
                           atol=0, rtol=0)
 
+    def test_binom_table(self):
+        # Small integer arguments are looked up, larger ones use the
+        # factorials
+        for n in range(171):
+            k = np.arange(n + 1)
+            exact = [float(special.comb(n, kk, exact=True)) for kk in k]
+            if n <= 67:
+                assert_equal(cephes.binom(n, k), exact)
+            else:
+                assert_allclose(cephes.binom(n, k), exact, rtol=1e-13)
+
     def test_binom_nooverflow_8346(self):
         # Test (binom(n, k) doesn't overflow prematurely */
         dataset = [
@@ -1353,6 +1364,12 @@ class TestCombinatorics(object):
         ii = np.iinfo(int).max + 1
         assert_equal(special.comb(ii, ii-1, exact=True), ii)
 
+        for N in range(68):
+            assert_equal([special.comb(N, k, exact=True) for k in range(N+1)],
+                         [math.factorial(N) // (math.factorial(k) *
+                                                math.factorial(N - k))
+                          for k in range(N+1)])
+
         expected = 100891344545564193334812497256
         assert_equal(special.comb(100, 50, exact=True), expected)
 
@@ -1729,6 +1746,80 @@ class TestErf(object):
         expected = [np.nan + np.nan * 1.j, 0.-0.j, 0.+0.j]
         assert_allclose(special.wofz(vals), expected, rtol=1e-15)
 
+    @pytest.mark.parametrize('func, scalar, dtype', [
+        ('wofz', 'wofz', complex),
+        ('erfcx', 'erfcx', float),
+        ('dawsn', 'dawsn', float)])
+    def test_loop_kernels(self, func, scalar, dtype):
+        # The double loops evaluate whole arrays bucketed by region; they
+        # must agree with the element-wise scalar functions everywhere.
+        from scipy.special import cython_special
+        np.random.seed(1234)
+        special_vals = [0., -0., 1e-3, -1e-3, 0.01, 5., 6.5, 7.5, 9., 30.,
+                        45.5, 55., 4e3, 1e8, np.inf, -np.inf, np.nan]
+        x = np.r_[special_vals, np.negative(special_vals),
+                  np.random.randn(300)*10, np.random.randn(300)*1e3]
+        if dtype is complex:
+            re, im = np.meshgrid(x[::3], x[1::3])
+            x = (re + 1j*im).ravel()
+        f = getattr(special, func)
+        g = getattr(cython_special, scalar)
+        expected = np.array([g(v) for v in x], dtype=dtype)
+        with np.errstate(all='ignore'):
+            assert_allclose(f(x), expected, rtol=1e-14, atol=0)
+            assert_allclose(f(x[::3]), expected[::3], rtol=1e-14, atol=0)
+            y = x.copy()
+            f(y, out=y)
+            assert_allclose(y, expected, rtol=1e-14, atol=0)
+
+    @pytest.mark.parametrize('func, dtype', [
+        (func, dtype)
+        for func in ['ndtr', 'ndtri', 'erf', 'log_ndtr', 'expit', 'logit']
+        for dtype in [np.float64, np.float32]])
+    def test_array_kernels(self, func, dtype):
+        # The loops evaluate blocks of the array at once and patch the
+        # lanes needing the scalar code; the results must be identical
+        # to evaluating the elements one by one.
+        np.random.seed(1234)
+        special_vals = [0., -0., 1e-300, 1e-20, 1e-3, 0.1, 0.13533528323661,
+                        0.5, 0.7071067811865476, 0.9, 1., 2., 5., 6., 8.,
+                        13., 20., 26., 27., 38., 40., 1e10, np.inf, np.nan]
+        x = np.r_[special_vals, np.negative(special_vals),
+                  np.random.rand(600), np.random.randn(600)*5,
+                  np.random.randn(300)*50].astype(dtype)
+        f = getattr(special, func)
+        with np.errstate(all='ignore'):
+            expected = np.array([f(v) for v in x], dtype=dtype)
+            assert_equal(f(x), expected)
+            assert_equal(f(x[::3]), expected[::3])
+            y = x.copy()
+            f(y, out=y)
+            assert_equal(y, expected)
+
+    @pytest.mark.parametrize('func, a, b', [
+        ('erf', -6, 6),
+        ('erfc', -6, 9),
+        ('ndtr', -12, 8),
+        ('gammaln', 0, 50),
+        ('gammaln', 50, 1e30),
+        ('i0e', -100, 100),
+        ('i1e', -100, 100),
+        ('wrightomega', -80, 100)])
+    def test_float32_kernels(self, func, a, b):
+        # The float32 loops have their own kernels; compare with the
+        # double ones rounded to single precision.
+        np.random.seed(1234)
+        x = np.r_[np.linspace(a, b, 10001),
+                  np.random.uniform(a, b, 10000)].astype(np.float32)
+        x = x[(x > 0) | (func != 'gammaln')]
+        f = getattr(special, func)
+        res = f(x)
+        assert_equal(res.dtype, np.float32)
+        expected = f(x.astype(np.float64))
+        if func == 'wrightomega':
+            expected = expected.real
+        assert_allclose(res, expected.astype(np.float32), rtol=1e-6, atol=0)
+
 
 class TestEuler(object):
     def test_euler(self):
@@ -1914,6 +2005,14 @@ class TestGamma(object):
         lngam = log(special.gamma(3))
         assert_almost_equal(gamln,lngam,8)
 
+    def test_integers(self):
+        x = np.arange(1, 172)
+        assert_equal(special.gamma(x),
+                     [float(math.factorial(k - 1)) for k in x])
+        assert_allclose(special.gammaln(x),
+                        [math.lgamma(k) for k in x], rtol=1e-14)
+        assert_equal(special.gammaln([1, 2]), [0, 0])
+
     def test_gammainc(self):
         gama = special.gammainc(.5,.5)
         assert_almost_equal(gama,.7,1)
@@ -2799,6 +2898,24 @@ class TestBessel(object):
         x = special.ivp(1,2)
         assert_almost_equal(x,y,10)
 
+    @pytest.mark.parametrize('seq, func', [
+        (special.jv_seq, special.jv),
+        (special.iv_seq, special.iv),
+        (special.kv_seq, special.kv)])
+    @pytest.mark.parametrize('v', [-7.3, -5, -0.5, 0, 0.25, 3, 40.5])
+    def test_seq(self, seq, func, v):
+        n = 30
+        orders = v + np.arange(n)
+        x = np.array([0, 1e-3, 0.1, 1, 5, 30, 100, -3, -0.5, np.nan])
+        z = np.array([[5+2j, -2-7j, 1e-3+1e-3j], [50j, 100+1j, 0]])
+        with np.errstate(all='ignore'):
+            for arg in [x, z, 2.5]:
+                res = seq(v, n, arg)
+                assert_equal(res.shape, np.shape(arg) + (n,))
+                assert_allclose(res, func(orders, np.asarray(arg)[..., None]),
+                                rtol=1e-11, atol=1e-300)
+        assert_equal(seq(v, 0, x).shape, (x.size, 0))
+
 
 class TestLaguerre(object):
     def test_laguerre(self):
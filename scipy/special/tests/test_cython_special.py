@@ -82,8 +82,8 @@ PARAMS = [
     (special.ellipkinc, cython_special.ellipkinc, ('dd',), None),
     (special.ellipkm1, cython_special.ellipkm1, ('d',), None),
     (special.entr, cython_special.entr, ('d',), None),
-    (special.erf, cython_special.erf, ('d', 'D'), None),
-    (special.erfc, cython_special.erfc, ('d', 'D'), None),
+    (special.erf, cython_special.erf, ('f', 'd', 'D'), None),
+    (special.erfc, cython_special.erfc, ('f', 'd', 'D'), None),
     (special.erfcx, cython_special.erfcx, ('d', 'D'), None),
     (special.erfi, cython_special.erfi, ('d', 'D'), None),
     (special.eval_chebyc, cython_special.eval_chebyc, ('dd', 'dD', 'ld'), None),
@@ -128,7 +128,7 @@ PARAMS = [
     (special.gammaincc, cython_special.gammaincc, ('dd',), None),
     (special.gammainccinv, cython_special.gammainccinv, ('dd',), None),
     (special.gammaincinv, cython_special.gammaincinv, ('dd',), None),
-    (special.gammaln, cython_special.gammaln, ('d',), None),
+    (special.gammaln, cython_special.gammaln, ('f', 'd'), None),
     (special.gammasgn, cython_special.gammasgn, ('d',), None),
     (special.gdtr, cython_special.gdtr, ('ddd',), None),
     (special.gdtrc, cython_special.gdtrc, ('ddd',), None),
@@ -145,9 +145,9 @@ PARAMS = [
     (special.hyp2f1, cython_special.hyp2f1, ('dddd', 'dddD'), None),
     (special.hyperu, cython_special.hyperu, ('ddd',), None),
     (special.i0, cython_special.i0, ('d',), None),
-    (special.i0e, cython_special.i0e, ('d',), None),
+    (special.i0e, cython_special.i0e, ('f', 'd'), None),
     (special.i1, cython_special.i1, ('d',), None),
-    (special.i1e, cython_special.i1e, ('d',), None),
+    (special.i1e, cython_special.i1e, ('f', 'd'), None),
     (special.inv_boxcox, cython_special.inv_boxcox, ('dd',), None),
     (special.inv_boxcox1p, cython_special.inv_boxcox1p, ('dd',), None),
     (special.it2i0k0, cython_special._it2i0k0_pywrap, ('d',), None),
@@ -209,7 +209,7 @@ PARAMS = [
     (special.nctdtridf, cython_special.nctdtridf, ('ddd',), None),
     (special.nctdtrinc, cython_special.nctdtrinc, ('ddd',), None),
     (special.nctdtrit, cython_special.nctdtrit, ('ddd',), None),
-    (special.ndtr, cython_special.ndtr, ('d', 'D'), None),
+    (special.ndtr, cython_special.ndtr, ('f', 'd', 'D'), None),
     (special.ndtri, cython_special.ndtri, ('d',), None),
     (special.nrdtrimn, cython_special.nrdtrimn, ('ddd',), None),
     (special.nrdtrisd, cython_special.nrdtrisd, ('ddd',), None),
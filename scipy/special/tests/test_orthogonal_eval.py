@@ -1,12 +1,21 @@
 from __future__ import division, print_function, absolute_import
 
 import numpy as np
-from numpy.testing import assert_, assert_allclose
+from numpy.testing import assert_, assert_allclose, assert_array_equal
 import scipy.special.orthogonal as orth
 
 from scipy.special._testutils import FuncData
 
 
+def test_integral_float_degree():
+    # Integral float degrees take the integer recurrences
+    n = np.arange(0, 200, 3)
+    x = np.linspace(-1, 1, 7)[:,None]
+    for func in [orth.eval_chebyt, orth.eval_legendre]:
+        assert_array_equal(func(n.astype(float), x, sig='dd->d'),
+                           func(n, x, sig='ld->d'))
+
+
 def test_eval_chebyt():
     n = np.arange(0, 10000, 7)
     x = 2*np.random.rand() - 1
@@ -2,6 +2,7 @@ from __future__ import division, print_function, absolute_import
 
 import warnings
 
+import numpy as np
 from numpy.testing import assert_, assert_equal
 from scipy._lib._numpy_compat import suppress_warnings
 import pytest
@@ -113,3 +114,60 @@ def test_errstate_all_but_one():
         with assert_raises(sc.SpecialFunctionError):
             sc.spence(-1.0)
     assert_equal(olderr, sc.geterr())
+
+
+def test_set_workers():
+    assert_equal(sc.get_workers(), 1)
+    with sc.set_workers(4):
+        assert_equal(sc.get_workers(), 4)
+        with sc.set_workers(-1):
+            assert_(sc.get_workers() >= 1)
+        assert_equal(sc.get_workers(), 4)
+    assert_equal(sc.get_workers(), 1)
+
+    with assert_raises(ValueError):
+        with sc.set_workers(0):
+            pass
+
+
+def test_set_workers_results():
+    x = np.linspace(0, 100, 20001)
+    funcs = [
+        lambda: sc.jv(2.5, x),
+        lambda: sc.jv(2.5, x + 1j),
+        lambda: sc.hyp2f1(0.5, 1.5, 2.5, x / 101),
+        lambda: sc.kolmogorov(x / 50),
+        lambda: sc.struve(1.5, x),
+    ]
+    for f in funcs:
+        expected = f()
+        with sc.set_workers(4):
+            assert_equal(f(), expected)
+
+
+def test_set_workers_errstate():
+    p = np.linspace(0, 1, 20001)
+    p[-1] = 2
+    with sc.set_workers(4):
+        with sc.errstate(domain='raise'):
+            with assert_raises(sc.SpecialFunctionError):
+                sc.kolmogi(p)
+        with sc.errstate(domain='warn'):
+            with warnings.catch_warnings(record=True) as w:
+                warnings.simplefilter('always')
+                sc.kolmogi(p)
+            assert_equal(len(w), 1)
+
+
+def test_errstate_warn_once_per_loop():
+    # The loops collect the errors of all elements and report each
+    # kind once at the end
+    x = np.full(1000, -1.0)
+    with sc.errstate(domain='warn'):
+        with warnings.catch_warnings(record=True) as w:
+            warnings.simplefilter('always')
+            sc.spence(x)
+        assert_equal(len(w), 1)
+    with sc.errstate(domain='raise'):
+        with assert_raises(sc.SpecialFunctionError):
+            sc.spence(x)
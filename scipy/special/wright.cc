@@ -364,3 +364,71 @@ wright::wrightomega(complex<double> z)
   wrightomega_ext(z,&w,NULL);
   return w;
 }
+
+
+/**********************************************************************/
+/* wrightomegaf evaluates the wright omega function for real single   */
+/* precision arguments. It starts from the same approximations as the */
+/* real line of wrightomega_ext, and takes one FSC iteration, or two  */
+/* when the condition estimate asks for it at single precision.       */
+/**********************************************************************/
+
+float
+wright::wrightomegaf(float xf)
+{
+  double x = xf, w, wp1, e, r;
+
+  if (sc_isnan(x))
+    {
+      return xf;
+    }
+  else if (sc_isinf(x))
+    {
+      return (x > 0.0) ? xf : 0.0f;
+    }
+  /* exp(x) is accurate to single precision below -20 */
+  else if (x < -20.0)
+    {
+      w = exp(x);
+      if (w < FLT_MIN)
+	{
+	  sf_error("wrightomega", SF_ERROR_UNDERFLOW, "underflow in exponential series");
+	}
+      return w;
+    }
+  /* and x itself above 1e10 */
+  else if (x > 1.0e10)
+    {
+      return xf;
+    }
+
+  /* Initial guesses for (-inf, -2), [-2, 1) and [1, inf) */
+  if (x < -2.0)
+    {
+      w = exp(x);
+    }
+  else if (x < 1.0)
+    {
+      w = exp(2.0*(x-1.0)/3.0);
+    }
+  else
+    {
+      w = log(x);
+      w = x - w + w/x;
+    }
+
+  r = x-w-log(w);
+  wp1 = w+1.0;
+  e = r/wp1*(2.0*wp1*(wp1+2.0/3.0*r)-r)/(2.0*wp1*(wp1+2.0/3.0*r)-2.0*r);
+  w = w*(1.0+e);
+
+  if (fabs((2.0*w*w-8.0*w-1.0)*pow(fabs(r),4.0)) >= 0.01*FLT_EPSILON*72.0*pow(fabs(wp1),6.0))
+    {
+      r = x-w-log(w);
+      wp1 = w+1.0;
+      e = r/wp1*(2.0*wp1*(wp1+2.0/3.0*r)-r)/(2.0*wp1*(wp1+2.0/3.0*r)-2.0*r);
+      w = w*(1.0+e);
+    }
+
+  return w;
+}
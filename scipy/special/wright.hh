@@ -8,6 +8,7 @@ namespace wright {
 int wrightomega_ext(std::complex<double> z, std::complex<double> *w,
 		    std::complex<double> *cond);
 std::complex<double> wrightomega(std::complex<double> z);
+float wrightomegaf(float x);
 
 };
   
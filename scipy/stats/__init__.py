@@ -227,6 +227,7 @@ Correlation functions
    spearmanr
    pointbiserialr
    kendalltau
+   kendalltau_matrix
    weightedtau
    linregress
    siegelslopes
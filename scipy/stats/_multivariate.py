@@ -16,6 +16,8 @@ from scipy.linalg.lapack import get_lapack_funcs
 
 from ._discrete_distns import binom
 from . import mvn
+from .stats import _check_workers
+from ._stats import _mvn_batch
 
 __all__ = ['multivariate_normal',
            'matrix_normal',
@@ -275,9 +277,9 @@ class multivariate_normal_gen(multi_rv_generic):
         Probability density function.
     ``logpdf(x, mean=None, cov=1, allow_singular=False)``
         Log of the probability density function.
-    ``cdf(x, mean=None, cov=1, allow_singular=False, maxpts=1000000*dim, abseps=1e-5, releps=1e-5)``
+    ``cdf(x, mean=None, cov=1, allow_singular=False, maxpts=1000000*dim, abseps=1e-5, releps=1e-5, workers=None)``
         Cumulative distribution function.
-    ``logcdf(x, mean=None, cov=1, allow_singular=False, maxpts=1000000*dim, abseps=1e-5, releps=1e-5)``
+    ``logcdf(x, mean=None, cov=1, allow_singular=False, maxpts=1000000*dim, abseps=1e-5, releps=1e-5, workers=None)``
         Log of the cumulative distribution function.
     ``rvs(mean=None, cov=1, size=1, random_state=None)``
         Draw random samples from a multivariate normal distribution.
@@ -522,7 +524,7 @@ class multivariate_normal_gen(multi_rv_generic):
         out = np.exp(self._logpdf(x, mean, psd.U, psd.log_pdet, psd.rank))
         return _squeeze_output(out)
 
-    def _cdf(self, x, mean, cov, maxpts, abseps, releps):
+    def _cdf(self, x, mean, cov, maxpts, abseps, releps, workers=1):
         """
         Parameters
         ----------
@@ -538,6 +540,8 @@ class multivariate_normal_gen(multi_rv_generic):
             Absolute error tolerance
         releps: float
             Relative error tolerance
+        workers: integer
+            Number of threads integrating the points
 
         Notes
         -----
@@ -547,15 +551,38 @@ class multivariate_normal_gen(multi_rv_generic):
         .. versionadded:: 1.0.0
 
         """
-        lower = np.full(mean.shape, -np.inf)
-        # mvnun expects 1-d arguments, so process points sequentially
-        func1d = lambda x_slice: mvn.mvnun(lower, x_slice, mean, cov,
-                                           maxpts, abseps, releps)[0]
-        out = np.apply_along_axis(func1d, -1, x)
-        return _squeeze_output(out)
+        std = np.sqrt(np.diag(cov))
+        corr = None
+        if np.all(std > 0):
+            corr = cov / np.outer(std, std)
+            try:
+                np.linalg.cholesky(corr)
+            except LinAlgError:
+                corr = None
+
+        if corr is None:
+            # The batched integration needs a positive definite covariance
+            lower = np.full(mean.shape, -np.inf)
+            # mvnun expects 1-d arguments, so process points sequentially
+            func1d = lambda x_slice: mvn.mvnun(lower, x_slice, mean, cov,
+                                               maxpts, abseps, releps)[0]
+            out = np.apply_along_axis(func1d, -1, x)
+            return _squeeze_output(out)
+
+        # Integrate all the points at once over the standardized limits,
+        # the points shared out over the threads
+        upper = ((x - mean) / std).reshape(-1, len(mean))
+        upper = np.ascontiguousarray(upper, dtype=np.float64)
+        lower = np.full_like(upper, -np.inf)
+        out = np.empty(len(upper))
+        error = np.empty(len(upper))
+        inform = np.empty(len(upper), dtype=np.intc)
+        _mvn_batch(np.ascontiguousarray(corr), lower, upper, int(maxpts),
+                   abseps, releps, out, error, inform, workers)
+        return _squeeze_output(out.reshape(x.shape[:-1]))
 
     def logcdf(self, x, mean=None, cov=1, allow_singular=False, maxpts=None,
-               abseps=1e-5, releps=1e-5):
+               abseps=1e-5, releps=1e-5, workers=None):
         """
         Log of the multivariate normal cumulative distribution function.
 
@@ -571,6 +598,11 @@ class multivariate_normal_gen(multi_rv_generic):
             Absolute error tolerance (default 1e-5)
         releps: float, optional
             Relative error tolerance (default 1e-5)
+        workers: int, optional
+            Number of threads integrating the points of `x`. If negative,
+            the value wraps around from ``os.cpu_count()``. Default is 1.
+
+            .. versionadded:: 1.4.0
 
         Returns
         -------
@@ -590,11 +622,12 @@ class multivariate_normal_gen(multi_rv_generic):
         _PSD(cov, allow_singular=allow_singular)
         if not maxpts:
             maxpts = 1000000 * dim
-        out = np.log(self._cdf(x, mean, cov, maxpts, abseps, releps))
+        out = np.log(self._cdf(x, mean, cov, maxpts, abseps, releps,
+                               _check_workers(workers)))
         return out
 
     def cdf(self, x, mean=None, cov=1, allow_singular=False, maxpts=None,
-            abseps=1e-5, releps=1e-5):
+            abseps=1e-5, releps=1e-5, workers=None):
         """
         Multivariate normal cumulative distribution function.
 
@@ -610,6 +643,11 @@ class multivariate_normal_gen(multi_rv_generic):
             Absolute error tolerance (default 1e-5)
         releps: float, optional
             Relative error tolerance (default 1e-5)
+        workers: int, optional
+            Number of threads integrating the points of `x`. If negative,
+            the value wraps around from ``os.cpu_count()``. Default is 1.
+
+            .. versionadded:: 1.4.0
 
         Returns
         -------
@@ -629,7 +667,8 @@ class multivariate_normal_gen(multi_rv_generic):
         _PSD(cov, allow_singular=allow_singular)
         if not maxpts:
             maxpts = 1000000 * dim
-        out = self._cdf(x, mean, cov, maxpts, abseps, releps)
+        out = self._cdf(x, mean, cov, maxpts, abseps, releps,
+                        _check_workers(workers))
         return out
 
     def rvs(self, mean=None, cov=1, size=1, random_state=None):
@@ -749,13 +788,13 @@ class multivariate_normal_frozen(multi_rv_frozen):
     def pdf(self, x):
         return np.exp(self.logpdf(x))
 
-    def logcdf(self, x):
-        return np.log(self.cdf(x))
+    def logcdf(self, x, workers=None):
+        return np.log(self.cdf(x, workers))
 
-    def cdf(self, x):
+    def cdf(self, x, workers=None):
         x = self._dist._process_quantiles(x, self.dim)
         out = self._dist._cdf(x, self.mean, self.cov, self.maxpts, self.abseps,
-                              self.releps)
+                              self.releps, _check_workers(workers))
         return _squeeze_output(out)
 
     def rvs(self, size=1, random_state=None):
@@ -2,6 +2,8 @@ from __future__ import absolute_import
 
 from cpython cimport bool
 from libc cimport math
+from libc.stdlib cimport malloc, calloc, free
+from libc.string cimport memset
 cimport cython
 cimport numpy as np
 from numpy.math cimport PI
@@ -10,6 +12,25 @@ from numpy cimport ndarray, int64_t, float64_t, intp_t
 import numpy as np
 import scipy.stats, scipy.special
 
+cdef extern from "zeros_threads.h":
+    ctypedef struct zeros_mutex:
+        pass
+    void zeros_mutex_init(zeros_mutex *m) nogil
+    void zeros_mutex_destroy(zeros_mutex *m) nogil
+    void zeros_mutex_lock(zeros_mutex *m) nogil
+    void zeros_mutex_unlock(zeros_mutex *m) nogil
+    void zeros_run_threads(int nthreads, void (*func)(void *) nogil,
+                           void *arg) nogil
+
+cdef extern from "numpy/npy_math.h":
+    double nan "NPY_NAN"
+
+cdef extern from "mvn_batch.h":
+    int mvn_batch(Py_ssize_t npts, Py_ssize_t d, const double *corr,
+                  const double *lower, const double *upper, long maxpts,
+                  double abseps, double releps, double *value, double *error,
+                  int *inform, int nthreads) nogil
+
 
 cdef double von_mises_cdf_series(double k, double x, unsigned int p):
     cdef double s, c, sn, cn, R, V
@@ -106,6 +127,474 @@ def _kendall_dis(intp_t[:] x, intp_t[:] y):
     return dis
 
 
+cdef struct kendall_work:
+    # The shared state of the threads: for each of the nvars variables, its
+    # dense ranks 1, 2, ..., sup - 1 and a permutation sorting them, both of
+    # shape (nvars, n), and its number of tied pairs
+    const intp_t *ranks
+    const intp_t *order
+    const intp_t *sup
+    const int64_t *xtie
+    intp_t nvars, n, max_sup
+    double *out
+    # the next variable to claim, and whether a thread ran out of memory
+    intp_t next
+    bint nomem
+    zeros_mutex lock
+
+
+cdef intp_t claim_variable(kendall_work *w) nogil:
+    # Returns the next variable whose row of tau is not computed, or -1
+    cdef intp_t i
+    zeros_mutex_lock(&w.lock)
+    i = w.next
+    w.next += 1
+    if w.nomem or i >= w.nvars - 1:
+        i = -1
+    zeros_mutex_unlock(&w.lock)
+    return i
+
+
+@cython.wraparound(False)
+@cython.boundscheck(False)
+cdef void kendall_pair(const intp_t *x, const intp_t *y, intp_t n, intp_t sup,
+                       intp_t *arr, intp_t *cnt, int64_t *dis_out,
+                       int64_t *ntie_out) nogil:
+    """
+    The discordant pairs and the joint ties of x, sorted, and y, as in
+    _kendall_dis. The order of y within ties of x does not matter, so the
+    one sort of x serves all the y it is paired with. cnt must be zero, and
+    is left so.
+    """
+    cdef intp_t i = 0, k = 0, idx
+    cdef int64_t dis = 0, ntie = 0
+    memset(arr, 0, (sup + ((sup - 1) >> 14)) * sizeof(intp_t))
+
+    while i < n:
+        while k < n and x[i] == x[k]:
+            dis += i
+            idx = y[k]
+            while idx != 0:
+                dis -= arr[idx + (idx >> 14)]
+                idx = idx & (idx - 1)
+            ntie += cnt[y[k]]
+            cnt[y[k]] += 1
+            k += 1
+
+        while i < k:
+            idx = y[i]
+            cnt[idx] = 0
+            while idx < sup:
+                arr[idx + (idx >> 14)] += 1
+                idx += idx & -idx
+            i += 1
+
+    dis_out[0] = dis
+    ntie_out[0] = ntie
+
+
+@cython.wraparound(False)
+@cython.boundscheck(False)
+@cython.cdivision(True)
+cdef void kendall_thread(void *arg) nogil:
+    """
+    Computes the rows of tau of the variables it claims, against all the
+    variables after them.
+    """
+    cdef kendall_work *w = <kendall_work *>arg
+    cdef intp_t n = w.n, i, j, k
+    cdef int64_t dis, ntie, tot = (<int64_t>n * (n - 1)) // 2
+    cdef double tau
+    cdef const intp_t *perm
+    cdef intp_t *x = <intp_t *>malloc(n * sizeof(intp_t))
+    cdef intp_t *y = <intp_t *>malloc(n * sizeof(intp_t))
+    cdef intp_t *cnt = <intp_t *>calloc(w.max_sup, sizeof(intp_t))
+    cdef intp_t *arr = <intp_t *>malloc(
+        (w.max_sup + ((w.max_sup - 1) >> 14)) * sizeof(intp_t))
+
+    if x == NULL or y == NULL or cnt == NULL or arr == NULL:
+        zeros_mutex_lock(&w.lock)
+        w.nomem = True
+        zeros_mutex_unlock(&w.lock)
+    else:
+        i = claim_variable(w)
+        while i >= 0:
+            perm = w.order + i * n
+            for k in range(n):
+                x[k] = w.ranks[i * n + perm[k]]
+            for j in range(i + 1, w.nvars):
+                if w.xtie[i] == tot or w.xtie[j] == tot:
+                    tau = nan
+                else:
+                    for k in range(n):
+                        y[k] = w.ranks[j * n + perm[k]]
+                    kendall_pair(x, y, n, w.sup[j], arr, cnt, &dis, &ntie)
+                    tau = ((tot - w.xtie[i] - w.xtie[j] + ntie - 2 * dis)
+                           / math.sqrt(tot - w.xtie[i])
+                           / math.sqrt(tot - w.xtie[j]))
+                    tau = min(1., max(-1., tau))
+                w.out[i * w.nvars + j] = w.out[j * w.nvars + i] = tau
+            i = claim_variable(w)
+
+    free(x)
+    free(y)
+    free(cnt)
+    free(arr)
+
+
+def _kendall_matrix(const intp_t[:, ::1] ranks, const intp_t[:, ::1] order,
+                    const intp_t[::1] sup, const int64_t[::1] xtie,
+                    double[:, ::1] out, int nthreads=1):
+    """
+    Kendall's tau-b of all the pairs of rows of ranks, into out.
+
+    Parameters
+    ----------
+    ranks : ndarray, shape (nvars, n)
+        The dense ranks 1, 2, ..., sup[i] - 1 of each variable.
+    order : ndarray, shape (nvars, n)
+        Permutations sorting each row of ranks.
+    sup : ndarray, shape (nvars,)
+        One more than the largest rank of each variable.
+    xtie : ndarray, shape (nvars,)
+        The number of tied pairs of each variable.
+    out : ndarray, shape (nvars, nvars)
+        The tau of each pair; the diagonal is not written.
+    nthreads : int, optional
+        Number of threads computing rows of out.
+
+    """
+    cdef kendall_work w
+    cdef intp_t i
+
+    if (order.shape[0] != ranks.shape[0] or order.shape[1] != ranks.shape[1]
+            or sup.shape[0] != ranks.shape[0]
+            or xtie.shape[0] != ranks.shape[0]
+            or out.shape[0] != ranks.shape[0]
+            or out.shape[1] != ranks.shape[0]):
+        raise ValueError("ranks, order, sup, xtie and out have incompatible "
+                         "shapes")
+    if ranks.shape[0] < 2 or ranks.shape[1] == 0:
+        return
+
+    w.ranks = &ranks[0, 0]
+    w.order = &order[0, 0]
+    w.sup = &sup[0]
+    w.xtie = &xtie[0]
+    w.nvars = ranks.shape[0]
+    w.n = ranks.shape[1]
+    w.max_sup = 1
+    for i in range(w.nvars):
+        w.max_sup = max(w.max_sup, sup[i])
+    w.out = &out[0, 0]
+    w.next = 0
+    w.nomem = False
+
+    nthreads = max(1, min(nthreads, w.nvars - 1))
+    zeros_mutex_init(&w.lock)
+    with nogil:
+        zeros_run_threads(nthreads, kendall_thread, &w)
+    zeros_mutex_destroy(&w.lock)
+    if w.nomem:
+        raise MemoryError()
+
+
+# Number of points in a block of work of a thread of the kde evaluation
+DEF KDE_BLOCK_SIZE = 256
+# Largest dimension of the grids of the kde evaluation
+DEF KDE_MAX_DIM = 3
+
+
+cdef struct kde_work:
+    # The shared state of the threads. The data and the points, whitened,
+    # are of shape (n, d) and (npts, d).
+    const double *data
+    const double *weights
+    const double *points
+    intp_t d, npts
+    # the data near each point, in CSR form
+    const intp_t *indptr
+    const intp_t *indices
+    # a grid of values, of the given shape, starting at lo with spacing h
+    const double *grid
+    intp_t shape[KDE_MAX_DIM]
+    double lo[KDE_MAX_DIM]
+    double h[KDE_MAX_DIM]
+    double *out
+    # blocks of points, and the next one to claim
+    intp_t nblocks, next
+    zeros_mutex lock
+
+
+cdef intp_t claim_kde_block(kde_work *w) nogil:
+    # Returns the index of the next unprocessed block of points, or -1
+    cdef intp_t b
+    zeros_mutex_lock(&w.lock)
+    b = w.next
+    w.next += 1
+    if b >= w.nblocks:
+        b = -1
+    zeros_mutex_unlock(&w.lock)
+    return b
+
+
+cdef void run_kde_blocks(kde_work *w, void (*func)(void *) nogil,
+                         int nthreads) nogil:
+    w.nblocks = (w.npts + KDE_BLOCK_SIZE - 1) // KDE_BLOCK_SIZE
+    w.next = 0
+    nthreads = max(1, min(nthreads, w.nblocks))
+    zeros_mutex_init(&w.lock)
+    zeros_run_threads(nthreads, func, w)
+    zeros_mutex_destroy(&w.lock)
+
+
+@cython.cdivision(True)
+cdef inline intp_t grid_cell(const kde_work *w, const double *x, intp_t k,
+                             double *frac) nogil:
+    # The cell of the grid along axis k holding x[k], and the position of
+    # x[k] in it, clamped to the grid
+    cdef double t = (x[k] - w.lo[k]) / w.h[k]
+    cdef intp_t i = <intp_t>math.floor(t)
+    if i < 0:
+        i = 0
+    elif i > w.shape[k] - 2:
+        i = w.shape[k] - 2
+    frac[0] = min(1., max(0., t - i))
+    return i
+
+
+cdef void kde_csr_thread(void *arg) nogil:
+    """
+    Sums the Gaussians of the data near each point of the blocks it claims.
+    """
+    cdef kde_work *w = <kde_work *>arg
+    cdef intp_t b, p, q, i, k
+    cdef const double *x
+    cdef const double *y
+    cdef double s, r2
+
+    b = claim_kde_block(w)
+    while b >= 0:
+        for p in range(b * KDE_BLOCK_SIZE,
+                       min(w.npts, (b + 1) * KDE_BLOCK_SIZE)):
+            x = w.points + p * w.d
+            s = 0
+            for q in range(w.indptr[p], w.indptr[p + 1]):
+                i = w.indices[q]
+                y = w.data + i * w.d
+                r2 = 0
+                for k in range(w.d):
+                    r2 += (x[k] - y[k]) * (x[k] - y[k])
+                s += w.weights[i] * math.exp(-0.5 * r2)
+            w.out[p] = s
+        b = claim_kde_block(w)
+
+
+cdef void kde_interp_thread(void *arg) nogil:
+    """
+    Interpolates the grid multilinearly at the points of the blocks it
+    claims.
+    """
+    cdef kde_work *w = <kde_work *>arg
+    cdef intp_t b, p, k, corner, idx
+    cdef intp_t cell[KDE_MAX_DIM]
+    cdef double frac[KDE_MAX_DIM]
+    cdef double s, weight
+
+    b = claim_kde_block(w)
+    while b >= 0:
+        for p in range(b * KDE_BLOCK_SIZE,
+                       min(w.npts, (b + 1) * KDE_BLOCK_SIZE)):
+            for k in range(w.d):
+                cell[k] = grid_cell(w, w.points + p * w.d, k, &frac[k])
+            s = 0
+            for corner in range(1 << w.d):
+                idx = 0
+                weight = 1
+                for k in range(w.d):
+                    if (corner >> k) & 1:
+                        idx = idx * w.shape[k] + cell[k] + 1
+                        weight *= frac[k]
+                    else:
+                        idx = idx * w.shape[k] + cell[k]
+                        weight *= 1 - frac[k]
+                s += weight * w.grid[idx]
+            w.out[p] = s
+        b = claim_kde_block(w)
+
+
+cdef int kde_setup(kde_work *w, const double[:, ::1] data,
+                   const double[:, ::1] points, double[::1] out) except -1:
+    if data.shape[1] != points.shape[1]:
+        raise ValueError("data and points have incompatible shapes")
+    if out.shape[0] != points.shape[0]:
+        raise ValueError("points and out have incompatible shapes")
+    w.data = &data[0, 0] if data.shape[0] > 0 else NULL
+    w.points = &points[0, 0] if points.shape[0] > 0 else NULL
+    w.d = data.shape[1]
+    w.npts = points.shape[0]
+    w.out = &out[0] if out.shape[0] > 0 else NULL
+    return 0
+
+
+cdef int kde_grid_setup(kde_work *w, const intp_t[::1] shape,
+                        const double[::1] lo, const double[::1] h) except -1:
+    cdef intp_t k
+    if not 1 <= w.d <= KDE_MAX_DIM:
+        raise ValueError("grids are of 1 to %d dimensions" % KDE_MAX_DIM)
+    if shape.shape[0] != w.d or lo.shape[0] != w.d or h.shape[0] != w.d:
+        raise ValueError("shape, lo and h must be of the dimension of the "
+                         "data")
+    for k in range(w.d):
+        if shape[k] < 2 or not h[k] > 0:
+            raise ValueError("grids need 2 or more nodes per axis and a "
+                             "positive spacing")
+        w.shape[k] = shape[k]
+        w.lo[k] = lo[k]
+        w.h[k] = h[k]
+    return 0
+
+
+def _kde_sum_csr(const double[:, ::1] data, const double[::1] weights,
+                 const double[:, ::1] points, const intp_t[::1] indptr,
+                 const intp_t[::1] indices, double[::1] out,
+                 int nthreads=1):
+    """
+    Sums ``weights[i] * exp(-|points[p] - data[i]|**2 / 2)`` over the data i
+    in ``indices[indptr[p]:indptr[p+1]]``, into out[p].
+
+    The indices are those of ``cKDTree.query_ball_point(points, r,
+    output_type='csr')`` on a tree of data, for a kernel truncated at r.
+    The points are processed in blocks on nthreads threads.
+
+    """
+    cdef kde_work w
+    kde_setup(&w, data, points, out)
+    if weights.shape[0] != data.shape[0]:
+        raise ValueError("data and weights have incompatible shapes")
+    if indptr.shape[0] != points.shape[0] + 1:
+        raise ValueError("points and indptr have incompatible shapes")
+    if points.shape[0] == 0:
+        return
+    if (indptr[points.shape[0]] > indices.shape[0]
+            or indices.shape[0] > 0 and (np.min(indices) < 0
+                                         or np.max(indices) >= data.shape[0])):
+        raise ValueError("indices out of range")
+    w.weights = &weights[0] if weights.shape[0] > 0 else NULL
+    w.indptr = &indptr[0]
+    w.indices = &indices[0] if indices.shape[0] > 0 else NULL
+    with nogil:
+        run_kde_blocks(&w, kde_csr_thread, nthreads)
+
+
+@cython.wraparound(False)
+@cython.boundscheck(False)
+@cython.cdivision(True)
+def _kde_bin(const double[:, ::1] data, const double[::1] weights,
+             const intp_t[::1] shape, const double[::1] lo,
+             const double[::1] h, double[::1] grid):
+    """
+    Adds the weights of the data to the nodes of the grid, by linear
+    binning: each datum is spread over the corners of its cell in
+    proportion to its closeness to them. The grid, flattened in C order, is
+    of the given shape, with nodes at ``lo + h * index``.
+    """
+    cdef kde_work w
+    cdef intp_t i, k, corner, idx, size = 1
+    cdef intp_t cell[KDE_MAX_DIM]
+    cdef double frac[KDE_MAX_DIM]
+    cdef double weight
+
+    w.d = data.shape[1]
+    kde_grid_setup(&w, shape, lo, h)
+    if weights.shape[0] != data.shape[0]:
+        raise ValueError("data and weights have incompatible shapes")
+    for k in range(w.d):
+        size *= shape[k]
+    if grid.shape[0] != size:
+        raise ValueError("grid is not of the given shape")
+
+    with nogil:
+        for i in range(data.shape[0]):
+            for k in range(w.d):
+                cell[k] = grid_cell(&w, &data[i, 0], k, &frac[k])
+            for corner in range(1 << w.d):
+                idx = 0
+                weight = weights[i]
+                for k in range(w.d):
+                    if (corner >> k) & 1:
+                        idx = idx * w.shape[k] + cell[k] + 1
+                        weight *= frac[k]
+                    else:
+                        idx = idx * w.shape[k] + cell[k]
+                        weight *= 1 - frac[k]
+                grid[idx] += weight
+
+
+def _kde_interp(const double[::1] grid, const intp_t[::1] shape,
+                const double[::1] lo, const double[::1] h,
+                const double[:, ::1] points, double[::1] out,
+                int nthreads=1):
+    """
+    Interpolates the grid of `_kde_bin` multilinearly at the points, into
+    out. Points outside of the grid take the value at its boundary. The
+    points are processed in blocks on nthreads threads.
+    """
+    cdef kde_work w
+    cdef intp_t k, size = 1
+    kde_setup(&w, points, points, out)
+    kde_grid_setup(&w, shape, lo, h)
+    for k in range(w.d):
+        size *= shape[k]
+    if grid.shape[0] != size:
+        raise ValueError("grid is not of the given shape")
+    if points.shape[0] == 0:
+        return
+    w.grid = &grid[0]
+    with nogil:
+        run_kde_blocks(&w, kde_interp_thread, nthreads)
+
+
+def _mvn_batch(const double[:, ::1] corr, const double[:, ::1] lower,
+               const double[:, ::1] upper, long maxpts, double abseps,
+               double releps, double[::1] value, double[::1] error,
+               int[::1] inform, int nthreads=1):
+    """
+    Probabilities ``P(lower[p] < X < upper[p])`` of ``X ~ N(0, corr)`` for
+    each row p of lower and upper, into value[p], with the estimated errors
+    in error[p] and inform[p] 1 where the tolerances were not met within
+    maxpts evaluations of the integrand.
+
+    The methods are those of ``mvn.mvndst``, see mvn_batch.h; the points
+    are processed on nthreads threads.
+
+    """
+    cdef intp_t d = corr.shape[0], npts = lower.shape[0]
+    cdef int ret
+
+    if corr.shape[1] != d or lower.shape[1] != d:
+        raise ValueError("corr and lower have incompatible shapes")
+    if upper.shape[0] != npts or upper.shape[1] != d:
+        raise ValueError("lower and upper have incompatible shapes")
+    if (value.shape[0] != npts or error.shape[0] != npts
+            or inform.shape[0] != npts):
+        raise ValueError("lower and value, error or inform have "
+                         "incompatible shapes")
+    if npts == 0:
+        return
+    if d == 0:
+        value[:] = 1
+        error[:] = 0
+        inform[:] = 0
+        return
+    with nogil:
+        ret = mvn_batch(npts, d, &corr[0, 0], &lower[0, 0], &upper[0, 0],
+                        maxpts, abseps, releps, &value[0], &error[0],
+                        &inform[0], nthreads)
+    if ret < 0:
+        raise MemoryError()
+
+
 # The weighted tau will be computed directly between these types.
 # Arrays of other types will be turned into a rank array using _toint64().
 
@@ -0,0 +1,658 @@
+/*
+ * Multivariate normal probabilities over many sets of integration limits.
+ *
+ * mvn_batch computes P(lower[p] < X < upper[p]) for X ~ N(0, corr) and each
+ * point p, using the methods of Genz's MVNDST (mvndst.f):
+ *
+ * - variables with two infinite limits are dropped, one or two variables
+ *   are computed directly (Phi, and the bivariate normal of Drezner and
+ *   Wesolowsky as revised by Genz);
+ * - otherwise the variables are reordered by increasing conditional
+ *   probability while the Cholesky factor is computed, and the integral,
+ *   of one fewer dimension, is estimated by randomly shifted Richtmyer
+ *   lattice rules of increasing size, with the antithetic baker's
+ *   transform, until the error estimate meets max(abseps, releps * value)
+ *   or maxpts integrand evaluations are spent.
+ *
+ * Unlike mvndst.f this holds no state outside the arguments, so the points
+ * are shared out over nthreads threads. The shifts of a point are drawn
+ * from a generator seeded by the index of the point, so the results do not
+ * depend on the number of threads.
+ */
+#ifndef MVN_BATCH_H
+#define MVN_BATCH_H
+
+#include <math.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "zeros_threads.h"
+
+/* Number of shifts of each lattice rule */
+#define MVN_MIN_SAMPLES 8
+/* Sizes of the lattice rules, those of the Korobov rules of mvndst.f */
+#define MVN_NRULES 28
+static const long mvn_rule_sizes[MVN_NRULES] = {
+    31, 47, 73, 113, 173, 263, 397, 593, 907, 1361, 2053, 3079, 4621, 6947,
+    10427, 15641, 23473, 35221, 52837, 79259, 118891, 178349, 267523, 401287,
+    601942, 902933, 1354471, 2031713
+};
+
+typedef struct {
+    const double *corr;
+    const double *lower;
+    const double *upper;
+    ptrdiff_t npts;
+    ptrdiff_t d;
+    long maxpts;
+    double abseps;
+    double releps;
+    double *value;
+    double *error;
+    int *inform;
+    /* Generators of the lattice rules, frac(sqrt(prime)) */
+    double *gen;
+    ptrdiff_t next;
+    zeros_mutex lock;
+    int nomem;
+} mvn_batch_work;
+
+/* Scratch space of a thread */
+typedef struct {
+    double *c;
+    double *a;
+    double *b;
+    double *y;
+    double *x;
+    double *shift;
+    /* Indices of the variables kept */
+    ptrdiff_t *idx;
+} mvn_scratch;
+
+
+static double
+mvn_phi(double z)
+{
+    return 0.5 * erfc(-z * 0.70710678118654752440);
+}
+
+
+/*
+ * Normal deviate of lower tail area p, algorithm AS241 as in PHINVS of
+ * mvndst.f.
+ */
+static double
+mvn_phinv(double p)
+{
+    double q = (2 * p - 1) / 2, r, z;
+    if (fabs(q) <= 0.425) {
+        r = 0.180625 - q * q;
+        return q * (((((((2.5090809287301226727e+3 * r
+                          + 3.3430575583588128105e+4) * r
+                         + 6.7265770927008700853e+4) * r
+                        + 4.5921953931549871457e+4) * r
+                       + 1.3731693765509461125e+4) * r
+                      + 1.9715909503065514427e+3) * r
+                     + 1.3314166789178437745e+2) * r
+                    + 3.3871328727963666080e0)
+                 / (((((((5.2264952788528545610e+3 * r
+                          + 2.8729085735721942674e+4) * r
+                         + 3.9307895800092710610e+4) * r
+                        + 2.1213794301586595867e+4) * r
+                       + 5.3941960214247511077e+3) * r
+                      + 6.8718700749205790830e+2) * r
+                     + 4.2313330701600911252e+1) * r + 1);
+    }
+    r = p < 1 - p ? p : 1 - p;
+    if (r > 0) {
+        r = sqrt(-log(r));
+        if (r <= 5) {
+            r -= 1.6;
+            z = (((((((7.74545014278341407640e-4 * r
+                      + 2.27238449892691845833e-2) * r
+                     + 2.41780725177450611770e-1) * r
+                    + 1.27045825245236838258e0) * r
+                   + 3.64784832476320460504e0) * r
+                  + 5.76949722146069140550e0) * r
+                 + 4.63033784615654529590e0) * r
+                + 1.42343711074968357734e0)
+                / (((((((1.05075007164441684324e-9 * r
+                         + 5.47593808499534494600e-4) * r
+                        + 1.51986665636164571966e-2) * r
+                       + 1.48103976427480074590e-1) * r
+                      + 6.89767334985100004550e-1) * r
+                     + 1.67638483018380384940e0) * r
+                    + 2.05319162663775882187e0) * r + 1);
+        }
+        else {
+            r -= 5;
+            z = (((((((2.01033439929228813265e-7 * r
+                      + 2.71155556874348757815e-5) * r
+                     + 1.24266094738807843860e-3) * r
+                    + 2.65321895265761230930e-2) * r
+                   + 2.96560571828504891230e-1) * r
+                  + 1.78482653991729133580e0) * r
+                 + 5.46378491116411436990e0) * r
+                + 6.65790464350110377720e0)
+                / (((((((2.04426310338993978564e-15 * r
+                         + 1.42151175831644588870e-7) * r
+                        + 1.84631831751005468180e-5) * r
+                       + 7.86869131145613259100e-4) * r
+                      + 1.48753612908506148525e-2) * r
+                     + 1.36929880922735805310e-1) * r
+                    + 5.99832206555887937690e-1) * r + 1);
+        }
+    }
+    else {
+        z = 9;
+    }
+    return q < 0 ? -z : z;
+}
+
+
+/*
+ * P(X > h, Y > k) for a standard bivariate normal of correlation r, BVU of
+ * mvndst.f.
+ */
+static double
+mvn_bvu(double h, double k, double r)
+{
+    static const double w[3][10] = {
+        {0.1713244923791705, 0.3607615730481384, 0.4679139345726904},
+        {0.4717533638651177e-1, 0.1069393259953183, 0.1600783285433464,
+         0.2031674267230659, 0.2334925365383547, 0.2491470458134029},
+        {0.1761400713915212e-1, 0.4060142980038694e-1, 0.6267204833410906e-1,
+         0.8327674157670475e-1, 0.1019301198172404, 0.1181945319615184,
+         0.1316886384491766, 0.1420961093183821, 0.1491729864726037,
+         0.1527533871307259}
+    };
+    static const double x[3][10] = {
+        {-0.9324695142031522, -0.6612093864662647, -0.2386191860831970},
+        {-0.9815606342467191, -0.9041172563704750, -0.7699026741943050,
+         -0.5873179542866171, -0.3678314989981802, -0.1252334085114692},
+        {-0.9931285991850949, -0.9639719272779138, -0.9122344282513259,
+         -0.8391169718222188, -0.7463319064601508, -0.6360536807265150,
+         -0.5108670019508271, -0.3737060887154196, -0.2277858511416451,
+         -0.7652652113349733e-1}
+    };
+    const double twopi = 6.283185307179586;
+    double hk, hs, asr, sn, bvn = 0, as, a, b, bs, c, d, xs, rs;
+    int i, ng, lg;
+
+    if (fabs(r) < 0.3) {
+        ng = 0;
+        lg = 3;
+    }
+    else if (fabs(r) < 0.75) {
+        ng = 1;
+        lg = 6;
+    }
+    else {
+        ng = 2;
+        lg = 10;
+    }
+    hk = h * k;
+    if (fabs(r) < 0.925) {
+        hs = (h * h + k * k) / 2;
+        asr = asin(r);
+        for (i = 0; i < lg; i++) {
+            sn = sin(asr * (x[ng][i] + 1) / 2);
+            bvn += w[ng][i] * exp((sn * hk - hs) / (1 - sn * sn));
+            sn = sin(asr * (-x[ng][i] + 1) / 2);
+            bvn += w[ng][i] * exp((sn * hk - hs) / (1 - sn * sn));
+        }
+        return bvn * asr / (2 * twopi) + mvn_phi(-h) * mvn_phi(-k);
+    }
+    if (r < 0) {
+        k = -k;
+        hk = -hk;
+    }
+    if (fabs(r) < 1) {
+        as = (1 - r) * (1 + r);
+        a = sqrt(as);
+        bs = (h - k) * (h - k);
+        c = (4 - hk) / 8;
+        d = (12 - hk) / 16;
+        bvn = a * exp(-(bs / as + hk) / 2)
+              * (1 - c * (bs - as) * (1 - d * bs / 5) / 3 + c * d * as * as / 5);
+        if (hk > -160) {
+            b = sqrt(bs);
+            bvn -= exp(-hk / 2) * sqrt(twopi) * mvn_phi(-b / a) * b
+                   * (1 - c * bs * (1 - d * bs / 5) / 3);
+        }
+        a /= 2;
+        for (i = 0; i < lg; i++) {
+            xs = (a * (x[ng][i] + 1)) * (a * (x[ng][i] + 1));
+            rs = sqrt(1 - xs);
+            bvn += a * w[ng][i] * (exp(-bs / (2 * xs) - hk / (1 + rs)) / rs
+                                   - exp(-(bs / xs + hk) / 2)
+                                     * (1 + c * xs * (1 + d * xs)));
+            xs = as * (-x[ng][i] + 1) * (-x[ng][i] + 1) / 4;
+            rs = sqrt(1 - xs);
+            bvn += a * w[ng][i] * exp(-(bs / xs + hk) / 2)
+                   * (exp(-hk * (1 - rs) / (2 * (1 + rs))) / rs
+                      - (1 + c * xs * (1 + d * xs)));
+        }
+        bvn = -bvn / twopi;
+    }
+    if (r > 0) {
+        return bvn + mvn_phi(-(h > k ? h : k));
+    }
+    d = mvn_phi(-h) - mvn_phi(-k);
+    return -bvn + (d > 0 ? d : 0);
+}
+
+
+/* P(a < X < b) for a standard bivariate normal of correlation r */
+static double
+mvn_bvn(const double *a, const double *b, double r)
+{
+    double p;
+    int lo0 = !isinf(a[0]), lo1 = !isinf(a[1]);
+    int up0 = !isinf(b[0]), up1 = !isinf(b[1]);
+
+    if (lo0 && up0 && lo1 && up1) {
+        p = mvn_bvu(a[0], a[1], r) - mvn_bvu(b[0], a[1], r)
+            - mvn_bvu(a[0], b[1], r) + mvn_bvu(b[0], b[1], r);
+    }
+    else if (lo0 && up0 && lo1) {
+        p = mvn_bvu(a[0], a[1], r) - mvn_bvu(b[0], a[1], r);
+    }
+    else if (lo0 && up0) {
+        p = mvn_bvu(-b[0], -b[1], r) - mvn_bvu(-a[0], -b[1], r);
+    }
+    else if (lo1 && up1 && lo0) {
+        p = mvn_bvu(a[0], a[1], r) - mvn_bvu(a[0], b[1], r);
+    }
+    else if (lo1 && up1) {
+        p = mvn_bvu(-b[0], -b[1], r) - mvn_bvu(-b[0], -a[1], r);
+    }
+    else if (lo0 && lo1) {
+        p = mvn_bvu(a[0], a[1], r);
+    }
+    else if (lo0) {
+        p = mvn_bvu(a[0], -b[1], -r);
+    }
+    else if (lo1) {
+        p = mvn_bvu(-b[0], a[1], -r);
+    }
+    else {
+        p = mvn_bvu(-b[0], -b[1], r);
+    }
+    return p < 0 ? 0 : (p > 1 ? 1 : p);
+}
+
+
+/* splitmix64, for the shifts of the lattice rules */
+static double
+mvn_uniform(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    return (z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+/*
+ * Reorders the m variables of the correlation matrix c (lower triangle,
+ * row-major) and of the limits a, b by increasing conditional probability,
+ * and overwrites c with the Cholesky factor of the reordered matrix; the
+ * "chlrdr" of Genz's MATLAB codes.
+ */
+static void
+mvn_reorder(ptrdiff_t m, double *c, double *a, double *b, double *y)
+{
+    const double eps = 1e-10, sqtwopi = 2.506628274631000502;
+    ptrdiff_t i, j, k, im;
+    double ckk, dem, am = 0, bm = 0, s, cii, ai, bi, de, t;
+
+    for (k = 0; k < m; k++) {
+        im = k;
+        ckk = 0;
+        dem = 1;
+        for (i = k; i < m; i++) {
+            if (c[i * m + i] > eps) {
+                cii = sqrt(c[i * m + i]);
+                s = 0;
+                for (j = 0; j < k; j++) {
+                    s += c[i * m + j] * y[j];
+                }
+                ai = (a[i] - s) / cii;
+                bi = (b[i] - s) / cii;
+                de = mvn_phi(bi) - mvn_phi(ai);
+                if (de <= dem) {
+                    ckk = cii;
+                    dem = de;
+                    am = ai;
+                    bm = bi;
+                    im = i;
+                }
+            }
+        }
+        if (im > k) {
+            t = a[im]; a[im] = a[k]; a[k] = t;
+            t = b[im]; b[im] = b[k]; b[k] = t;
+            c[im * m + im] = c[k * m + k];
+            for (j = 0; j < k; j++) {
+                t = c[im * m + j]; c[im * m + j] = c[k * m + j];
+                c[k * m + j] = t;
+            }
+            for (i = im + 1; i < m; i++) {
+                t = c[i * m + im]; c[i * m + im] = c[i * m + k];
+                c[i * m + k] = t;
+            }
+            for (i = k + 1; i < im; i++) {
+                t = c[i * m + k]; c[i * m + k] = c[im * m + i];
+                c[im * m + i] = t;
+            }
+        }
+        if (ckk > eps * (k + 1)) {
+            c[k * m + k] = ckk;
+            for (i = k + 1; i < m; i++) {
+                c[i * m + k] /= ckk;
+                for (j = k + 1; j <= i; j++) {
+                    c[i * m + j] -= c[i * m + k] * c[j * m + k];
+                }
+            }
+            if (fabs(dem) > eps) {
+                y[k] = (exp(-am * am / 2) - exp(-bm * bm / 2))
+                       / (sqtwopi * dem);
+            }
+            else if (am < -10) {
+                y[k] = bm;
+            }
+            else if (bm > 10) {
+                y[k] = am;
+            }
+            else {
+                y[k] = (am + bm) / 2;
+            }
+        }
+        else {
+            for (i = k; i < m; i++) {
+                c[i * m + k] = 0;
+            }
+            y[k] = 0;
+        }
+    }
+}
+
+
+/*
+ * The integrand at x in [0, 1]^(m-1): the product of the conditional
+ * probabilities of the variables given the deviates of the previous ones.
+ */
+static double
+mvn_integrand(ptrdiff_t m, const double *c, const double *a, const double *b,
+              double *y, const double *x)
+{
+    ptrdiff_t i, j;
+    double lo = mvn_phi(a[0] / c[0]), dc = mvn_phi(b[0] / c[0]) - lo;
+    double p = dc, s, ct;
+
+    for (i = 1; i < m && p > 0; i++) {
+        y[i - 1] = mvn_phinv(lo + x[i - 1] * dc);
+        s = 0;
+        for (j = 0; j < i; j++) {
+            s += c[i * m + j] * y[j];
+        }
+        ct = c[i * m + i];
+        if (ct > 0) {
+            lo = mvn_phi((a[i] - s) / ct);
+            dc = mvn_phi((b[i] - s) / ct) - lo;
+        }
+        else {
+            lo = 0;
+            dc = a[i] - s <= 0 && b[i] - s >= 0;
+        }
+        p *= dc;
+    }
+    return p;
+}
+
+
+/*
+ * Mean of the integrand over a rule of n points and its antithetic points,
+ * shifted by a random vector.
+ */
+static double
+mvn_lattice_sum(ptrdiff_t m, const double *c, const double *a,
+                const double *b, const double *gen, long n, uint64_t *state,
+                mvn_scratch *s)
+{
+    ptrdiff_t j;
+    long k;
+    double sum = 0, t;
+
+    for (j = 0; j < m - 1; j++) {
+        s->shift[j] = mvn_uniform(state);
+    }
+    for (k = 1; k <= n; k++) {
+        for (j = 0; j < m - 1; j++) {
+            t = k * gen[j] + s->shift[j];
+            s->x[j] = fabs(2 * (t - floor(t)) - 1);
+        }
+        sum += (mvn_integrand(m, c, a, b, s->y, s->x) - sum) / (2 * k - 1);
+        for (j = 0; j < m - 1; j++) {
+            s->x[j] = 1 - s->x[j];
+        }
+        sum += (mvn_integrand(m, c, a, b, s->y, s->x) - sum) / (2 * k);
+    }
+    return sum;
+}
+
+
+/*
+ * Integrates the reordered problem of m >= 3 variables, the loop of DKBVRC
+ * of mvndst.f: the rules grow until the error estimate is small enough,
+ * and the estimates of successive rules are combined weighted by their
+ * variances.
+ */
+static void
+mvn_integrate(const mvn_batch_work *w, ptrdiff_t m, uint64_t *state,
+              mvn_scratch *s, double *value, double *error, int *inform)
+{
+    int np = (m - 1 < 10 ? (int)m - 1 : 10) - 1;
+    long samples = MVN_MIN_SAMPLES, intvls = 0, i;
+    double finest = 0, varest = 0, finval, varsqr, difint, varprd, abserr;
+
+    *inform = 1;
+    for (;;) {
+        finval = 0;
+        varsqr = 0;
+        for (i = 1; i <= samples; i++) {
+            difint = (mvn_lattice_sum(m, s->c, s->a, s->b, w->gen,
+                                      mvn_rule_sizes[np], state, s)
+                      - finval) / i;
+            finval += difint;
+            varsqr = (i - 2) * varsqr / i + difint * difint;
+        }
+        intvls += 2 * samples * mvn_rule_sizes[np];
+        varprd = varest * varsqr;
+        finest += (finval - finest) / (1 + varprd);
+        if (varsqr > 0) {
+            varest = (1 + varprd) / varsqr;
+        }
+        abserr = 3.5 * sqrt(varsqr / (1 + varprd));
+        if (abserr <= w->abseps || abserr <= fabs(finest) * w->releps) {
+            *inform = 0;
+            break;
+        }
+        if (np < MVN_NRULES - 1) {
+            np++;
+        }
+        else {
+            i = (w->maxpts - intvls) / (2 * mvn_rule_sizes[np]);
+            samples = 3 * samples / 2 < i ? 3 * samples / 2 : i;
+            if (samples < MVN_MIN_SAMPLES) {
+                samples = MVN_MIN_SAMPLES;
+            }
+        }
+        if (intvls + 2 * samples * mvn_rule_sizes[np] > w->maxpts) {
+            break;
+        }
+    }
+    *value = finest;
+    *error = abserr;
+}
+
+
+static void
+mvn_point(const mvn_batch_work *w, ptrdiff_t p, mvn_scratch *s)
+{
+    const double *lower = w->lower + p * w->d, *upper = w->upper + p * w->d;
+    ptrdiff_t i, j, m = 0;
+    uint64_t state = 0x5eed0000ULL + (uint64_t)p * 0x2545f4914f6cdd1dULL;
+    double *value = w->value + p, *error = w->error + p;
+    int *inform = w->inform + p;
+
+    *error = 0;
+    *inform = 0;
+    for (i = 0; i < w->d; i++) {
+        if (isnan(lower[i]) || isnan(upper[i])) {
+            *value = NAN;
+            return;
+        }
+        if (lower[i] >= upper[i]) {
+            *value = 0;
+            return;
+        }
+        if (isinf(lower[i]) && isinf(upper[i])) {
+            continue;
+        }
+        s->idx[m] = i;
+        s->a[m] = lower[i];
+        s->b[m] = upper[i];
+        m++;
+    }
+    if (m == 0) {
+        *value = 1;
+        return;
+    }
+    if (m == 1) {
+        *value = mvn_phi(s->b[0]) - mvn_phi(s->a[0]);
+        return;
+    }
+    if (m == 2) {
+        *value = mvn_bvn(s->a, s->b, w->corr[s->idx[1] * w->d + s->idx[0]]);
+        return;
+    }
+    for (i = 0; i < m; i++) {
+        for (j = 0; j <= i; j++) {
+            s->c[i * m + j] = w->corr[s->idx[i] * w->d + s->idx[j]];
+        }
+    }
+    mvn_reorder(m, s->c, s->a, s->b, s->y);
+    mvn_integrate(w, m, &state, s, value, error, inform);
+}
+
+
+static ptrdiff_t
+mvn_claim_point(mvn_batch_work *w)
+{
+    ptrdiff_t p;
+    zeros_mutex_lock(&w->lock);
+    p = w->next < w->npts ? w->next++ : -1;
+    zeros_mutex_unlock(&w->lock);
+    return p;
+}
+
+
+static void
+mvn_batch_thread(void *arg)
+{
+    mvn_batch_work *w = (mvn_batch_work *)arg;
+    mvn_scratch s;
+    double *buf;
+    ptrdiff_t p, d = w->d;
+
+    buf = malloc((d * d + 5 * d) * sizeof(double));
+    s.idx = malloc(d * sizeof(ptrdiff_t));
+    if (buf == NULL || s.idx == NULL) {
+        free(buf);
+        free(s.idx);
+        zeros_mutex_lock(&w->lock);
+        w->nomem = 1;
+        zeros_mutex_unlock(&w->lock);
+        return;
+    }
+    s.c = buf;
+    s.a = s.c + d * d;
+    s.b = s.a + d;
+    s.y = s.b + d;
+    s.x = s.y + d;
+    s.shift = s.x + d;
+    p = mvn_claim_point(w);
+    while (p >= 0) {
+        mvn_point(w, p, &s);
+        p = mvn_claim_point(w);
+    }
+    free(buf);
+    free(s.idx);
+}
+
+
+/*
+ * P(lower[p] < X < upper[p]) for X ~ N(0, corr) and each of the npts rows
+ * p of lower and upper, d x d corr and npts x d lower and upper in C order,
+ * into value[p], with an error estimate in error[p] and inform[p] 1 if the
+ * estimate did not meet the tolerances within maxpts evaluations of the
+ * integrand, else 0. The points are processed on nthreads threads.
+ *
+ * Returns 0, or -1 if out of memory.
+ */
+static int
+mvn_batch(ptrdiff_t npts, ptrdiff_t d, const double *corr,
+          const double *lower, const double *upper, long maxpts,
+          double abseps, double releps, double *value, double *error,
+          int *inform, int nthreads)
+{
+    mvn_batch_work w;
+    ptrdiff_t j;
+    long prime = 1, q;
+
+    if (npts <= 0) {
+        return 0;
+    }
+    w.gen = malloc((d > 0 ? d : 1) * sizeof(double));
+    if (w.gen == NULL) {
+        return -1;
+    }
+    for (j = 0; j < d; j++) {
+        for (prime++;; prime++) {
+            for (q = 2; q * q <= prime && prime % q; q++) {
+            }
+            if (q * q > prime) {
+                break;
+            }
+        }
+        w.gen[j] = sqrt((double)prime);
+        w.gen[j] -= floor(w.gen[j]);
+    }
+    w.corr = corr;
+    w.lower = lower;
+    w.upper = upper;
+    w.npts = npts;
+    w.d = d;
+    w.maxpts = maxpts;
+    w.abseps = abseps;
+    w.releps = releps;
+    w.value = value;
+    w.error = error;
+    w.inform = inform;
+    w.next = 0;
+    w.nomem = 0;
+    if (nthreads > npts) {
+        nthreads = (int)npts;
+    }
+    zeros_mutex_init(&w.lock);
+    zeros_run_threads(nthreads < 1 ? 1 : nthreads, mvn_batch_thread, &w);
+    zeros_mutex_destroy(&w.lock);
+    free(w.gen);
+    return w.nomem ? -1 : 0;
+}
+
+#endif
@@ -21,8 +21,11 @@ def configuration(parent_package='',top_path=None):
     )
 
     # add _stats module
+    zeros_dir = join('..', 'optimize', 'Zeros')
     config.add_extension('_stats',
         sources=['_stats.c'],
+        include_dirs=[zeros_dir],
+        depends=['mvn_batch.h', join(zeros_dir, 'zeros_threads.h')],
     )
 
     # add mvn module
@@ -164,7 +164,9 @@ from __future__ import division, print_function, absolute_import
 
 import warnings
 import sys
+import os
 import math
+import operator
 if sys.version_info.major >= 3 and sys.version_info.minor >= 5:
     from math import gcd
 else:
@@ -183,7 +185,8 @@ from . import distributions
 from . import mstats_basic
 from ._stats_mstats_common import (_find_repeats, linregress, theilslopes,
                                    siegelslopes)
-from ._stats import _kendall_dis, _toint64, _weightedrankedtau
+from ._stats import (_kendall_dis, _kendall_matrix, _toint64,
+                     _weightedrankedtau)
 from ._rvs_sampling import rvs_ratio_uniforms
 from ._hypotests import epps_singleton_2samp
 
@@ -198,7 +201,7 @@ __all__ = ['find_repeats', 'gmean', 'hmean', 'mode', 'tmean', 'tvar',
            'sigmaclip', 'trimboth', 'trim1', 'trim_mean', 'f_oneway',
            'PearsonRConstantInputWarning', 'PearsonRNearConstantInputWarning',
            'pearsonr', 'fisher_exact', 'spearmanr', 'pointbiserialr',
-           'kendalltau', 'weightedtau',
+           'kendalltau', 'kendalltau_matrix', 'weightedtau',
            'linregress', 'siegelslopes', 'theilslopes', 'ttest_1samp',
            'ttest_ind', 'ttest_ind_from_stats', 'ttest_rel', 'kstest',
            'chisquare', 'power_divergence', 'ks_2samp', 'mannwhitneyu',
@@ -208,6 +211,28 @@ __all__ = ['find_repeats', 'gmean', 'hmean', 'mode', 'tmean', 'tvar',
            'brunnermunzel', 'epps_singleton_2samp']
 
 
+def _check_workers(workers):
+    """Normalize a ``workers`` argument to a positive thread count.
+
+    ``None`` means a single thread, and negative values wrap around from
+    ``os.cpu_count()``, so that ``-1`` means all CPUs.
+    """
+    if workers is None:
+        return 1
+
+    workers = operator.index(workers)
+    if workers < 0:
+        cpu_count = os.cpu_count() or 1
+        if workers >= -cpu_count:
+            workers += 1 + cpu_count
+        else:
+            raise ValueError("workers value out of range; got {}, must not be"
+                             " less than {}".format(workers, -cpu_count))
+    elif workers == 0:
+        raise ValueError("workers must not be zero")
+    return workers
+
+
 def _chk_asarray(a, axis):
     if axis is None:
         a = np.ravel(a)
@@ -4048,6 +4073,144 @@ def kendalltau(x, y, initial_lexsort=None, nan_policy='propagate', method='auto'
     return KendalltauResult(tau, pvalue)
 
 
+def kendalltau_matrix(a, axis=0, nan_policy='propagate', workers=None):
+    """
+    Calculate Kendall's tau between all the pairs of variables of a 2-D array.
+
+    The tau-b of each pair of variables is that of `kendalltau`, but the
+    ranks of each variable are computed once for all the pairs it is in,
+    and the pairs are spread over `workers` threads.
+
+    Parameters
+    ----------
+    a : array_like
+        2-D array of rankings, with the variables in columns, or in rows if
+        `axis` is 1.
+    axis : {0, 1}, optional
+        The axis along which the observations of each variable run. Default
+        is 0.
+    nan_policy : {'propagate', 'raise', 'omit'}, optional
+        Defines how to handle when input contains nan. 'propagate' returns
+        nan for the pairs with a variable that contains nan, 'raise' throws
+        an error, 'omit' computes each pair with `kendalltau`, ignoring the
+        observations in which either variable is nan. Default is
+        'propagate'.
+    workers : int, optional
+        Number of threads computing pairs of variables. If negative, the
+        value wraps around from ``os.cpu_count()``. Default is 1.
+
+    Returns
+    -------
+    correlation : ndarray, shape (nvars, nvars)
+        The tau statistic of each pair of variables.
+    pvalue : ndarray, shape (nvars, nvars)
+        The two-sided p-value of each pair, for a hypothesis test whose null
+        hypothesis is an absence of association, tau = 0. These are the
+        asymptotic p-values of `kendalltau`, also for small samples.
+
+    See also
+    --------
+    kendalltau : Kendall's tau of two variables.
+    spearmanr : Spearman rank-order correlation coefficients.
+
+    Notes
+    -----
+    The discordant pairs of each pair of variables are counted as in
+    `kendalltau`, in :math:`O(n \log n)` time for :math:`n` observations,
+    with the observations already sorted on the first variable of the pair.
+
+    .. versionadded:: 1.4.0
+
+    Examples
+    --------
+    >>> from scipy import stats
+    >>> x = [[12, 1, 3], [2, 4, 1], [1, 7, 2], [12, 1, 5], [2, 0, 4]]
+    >>> tau, p_value = stats.kendalltau_matrix(x)
+    >>> tau.round(3)
+    array([[ 1.   , -0.471,  0.447],
+           [-0.471,  1.   , -0.527],
+           [ 0.447, -0.527,  1.   ]])
+
+    The first two columns are those of the example of `kendalltau`:
+
+    >>> stats.kendalltau([12, 2, 1, 12, 2], [1, 4, 7, 1, 0])[0]
+    -0.47140452079103173
+
+    """
+    a = np.asarray(a)
+    if a.ndim != 2:
+        raise ValueError("`kendalltau_matrix` needs a 2-D array")
+    if axis not in (0, 1, -1, -2):
+        raise ValueError("axis must be 0 or 1")
+    if axis in (1, -1):
+        a = a.T
+    nthreads = _check_workers(workers)
+
+    size, n_vars = a.shape
+    if size == 0:
+        nan = np.full((n_vars, n_vars), np.nan)
+        return KendalltauResult(nan, nan.copy())
+
+    contains_nan, nan_policy = _contains_nan(a, nan_policy)
+    if contains_nan and nan_policy == 'omit':
+        tau = np.empty((n_vars, n_vars))
+        pvalue = np.empty((n_vars, n_vars))
+        for i in range(n_vars):
+            for j in range(i, n_vars):
+                r = kendalltau(a[:, i], a[:, j], nan_policy='omit',
+                               method='asymptotic')
+                tau[i, j] = tau[j, i] = r[0]
+                pvalue[i, j] = pvalue[j, i] = r[1]
+        return KendalltauResult(tau, pvalue)
+
+    # Sort each variable once, and convert it to dense ranks
+    cols = np.arange(n_vars)
+    order = np.argsort(a, axis=0, kind='mergesort')
+    sorted_a = a[order, cols]
+    dense = np.empty(a.shape, dtype=np.intp)
+    dense[0] = 1
+    dense[1:] = sorted_a[1:] != sorted_a[:-1]
+    np.cumsum(dense, axis=0, out=dense)
+    ranks = np.empty_like(dense)
+    ranks[order, cols] = dense
+    sup = dense[-1] + 1
+
+    # Ties of each variable, and their contributions to the variance
+    xtie = np.empty(n_vars, dtype=np.int64)
+    x0 = np.empty(n_vars)
+    x1 = np.empty(n_vars)
+    for k in range(n_vars):
+        cnt = np.bincount(ranks[:, k]).astype('int64', copy=False)
+        cnt = cnt[cnt > 1]
+        xtie[k] = (cnt * (cnt - 1) // 2).sum()
+        x0[k] = (cnt * (cnt - 1.) * (cnt - 2)).sum()
+        x1[k] = (cnt * (cnt - 1.) * (2*cnt + 5)).sum()
+
+    tot = (size * (size - 1)) // 2
+    tau = np.empty((n_vars, n_vars))
+    _kendall_matrix(np.ascontiguousarray(ranks.T),
+                    np.ascontiguousarray(order.T), sup, xtie, tau, nthreads)
+    np.fill_diagonal(tau, np.where(xtie == tot, np.nan, 1.))
+    if contains_nan:
+        has_nan = np.isnan(a).any(axis=0)
+        tau[has_nan, :] = np.nan
+        tau[:, has_nan] = np.nan
+
+    # Asymptotic p-values, as in kendalltau
+    with np.errstate(divide='ignore', invalid='ignore'):
+        s = np.sqrt(tot - xtie)
+        con_minus_dis = np.abs(tau) * s[:, None] * s[None, :]
+        var = (size * (size - 1) * (2.*size + 5) - x1[:, None] -
+               x1[None, :]) / 18.
+        var += (2. * xtie[:, None] * xtie[None, :]) / (size * (size - 1))
+        var += x0[:, None] * x0[None, :] / (9. * size * (size - 1) *
+                                            (size - 2))
+        con_minus_dis /= np.sqrt(2 * var)
+        pvalue = special.erfc(con_minus_dis, out=con_minus_dis)
+
+    return KendalltauResult(tau, pvalue)
+
+
 WeightedTauResult = namedtuple('WeightedTauResult', ('correlation', 'pvalue'))
 
 
@@ -390,3 +390,53 @@ def test_weights_integer():
     assert_allclose(pdf_i.evaluate(xn),
                     pdf_f.evaluate(xn), atol=1e-14, rtol=1e-14)
 
+
+
+@pytest.mark.parametrize('d', [1, 2, 3])
+@pytest.mark.parametrize('workers', [None, 3])
+def test_kde_evaluate_tree(d, workers):
+    np.random.seed(1234)
+    gkde = stats.gaussian_kde(np.random.randn(d, 500),
+                              weights=np.random.rand(500))
+    x = 2 * np.random.randn(d, 300)
+    direct = gkde.evaluate(x)
+
+    # the error is bounded by rtol times the peak of one kernel
+    bound = 1e-6 / np.sqrt(np.linalg.det(2 * np.pi * gkde.covariance))
+    tree = gkde.evaluate(x, method='tree', rtol=1e-6, workers=workers)
+    assert_(np.all(np.abs(tree - direct) <= bound))
+    tree = gkde.evaluate(x, method='tree', rtol=1e-300, workers=workers)
+    assert_allclose(tree, direct, rtol=1e-12, atol=1e-300)
+
+
+@pytest.mark.parametrize('d', [1, 2, 3])
+@pytest.mark.parametrize('workers', [None, 3])
+def test_kde_evaluate_fft(d, workers):
+    np.random.seed(1234)
+    gkde = stats.gaussian_kde(np.random.randn(d, 500),
+                              weights=np.random.rand(500))
+    x = np.random.randn(d, 300)
+    direct = gkde.evaluate(x)
+    fft = gkde.evaluate(x, method='fft', workers=workers)
+    assert_allclose(fft, direct, atol=1e-2 * direct.max())
+
+    # a finer grid is closer
+    fine = gkde.evaluate(x, method='fft', grid_size=2 * (4096, 512, 128)[d-1],
+                         workers=workers)
+    assert_(np.abs(fine - direct).max() < np.abs(fft - direct).max())
+
+    # a datum on a node gives the kernel, sampled
+    gkde = stats.gaussian_kde([0., 1., 3.])
+    x = np.linspace(0, 3, 7)
+    assert_allclose(gkde.evaluate(x, method='fft', grid_size=3001),
+                    gkde.evaluate(x), rtol=1e-6)
+
+
+def test_kde_evaluate_method_errors():
+    gkde = stats.gaussian_kde(np.random.randn(4, 50))
+    x = np.random.randn(4, 5)
+    assert_raises(ValueError, gkde.evaluate, x, method='fft')
+    assert_raises(ValueError, gkde.evaluate, x, method='wrong')
+    assert_raises(ValueError, gkde.evaluate, x, method='tree', workers=0)
+    gkde = stats.gaussian_kde(np.random.randn(50))
+    assert_raises(ValueError, gkde.evaluate, [0.], method='fft', grid_size=1)
@@ -390,6 +390,44 @@ class TestMultivariateNormal(object):
         cdf2 = multivariate_normal.cdf(r2, mean2, cov2)
         assert_allclose(cdf2, r_cdf2, atol=1e-5)
 
+    def test_cdf_workers(self):
+        # The points are integrated independently of the threads
+        np.random.seed(1234)
+        x = np.random.randn(8, 4)
+        mean = np.zeros(4)
+        cov = np.full((4, 4), 0.5) + 0.5 * np.eye(4)
+        desired = multivariate_normal.cdf(x, mean, cov)
+        for workers in [2, -1]:
+            actual = multivariate_normal.cdf(x, mean, cov, workers=workers)
+            assert_equal(actual, desired)
+            actual = multivariate_normal(mean, cov).cdf(x, workers=workers)
+            assert_equal(actual, desired)
+        assert_raises(ValueError, multivariate_normal.cdf, x, mean, cov,
+                      workers=0)
+
+    def test_cdf_orthant(self):
+        # The orthant probabilities of equicorrelated normals with
+        # correlation 1/2 are 1/(d+1)
+        for d in [3, 5, 8]:
+            cov = np.full((d, d), 0.5) + 0.5 * np.eye(d)
+            cdf = multivariate_normal.cdf(np.zeros(d), np.zeros(d), cov)
+            assert_allclose(cdf, 1 / (d + 1), atol=1e-5)
+
+        # and with the variances scaled, and a variable at infinity
+        d = 4
+        std = np.arange(1, d + 1)
+        cov = (np.full((d, d), 0.5) + 0.5 * np.eye(d)) * np.outer(std, std)
+        x = np.array([[0, 0, 0, 0], [0, 0, np.inf, 0]])
+        cdf = multivariate_normal.cdf(x, np.zeros(d), cov)
+        assert_allclose(cdf, [1 / 5, 1 / 4], atol=1e-5)
+
+    def test_cdf_singular(self):
+        # Singular covariances are integrated by mvnun
+        cov = np.array([[1, 1], [1, 1]])
+        cdf = multivariate_normal.cdf([0, 1], [0, 0], cov,
+                                      allow_singular=True)
+        assert_allclose(cdf, 0.5, atol=1e-5)
+
     def test_multivariate_normal_rvs_zero_covariance(self):
         mean = np.zeros(2)
         covariance = np.zeros((2, 2))
@@ -1042,6 +1042,43 @@ def test_kendalltau_nan_2nd_arg():
     assert_allclose(r1.correlation, r2.correlation, atol=1e-15)
 
 
+@pytest.mark.parametrize('workers', [None, 3])
+def test_kendalltau_matrix(workers):
+    np.random.seed(1234)
+    # variables with and without ties, and a constant one
+    a = np.column_stack([np.random.randn(50), np.random.randint(5, size=50),
+                         np.random.randint(3, size=50), np.arange(50),
+                         np.ones(50), np.random.randint(20, size=50)])
+    tau, pvalue = stats.kendalltau_matrix(a, workers=workers)
+    for i in range(a.shape[1]):
+        for j in range(a.shape[1]):
+            expected = stats.kendalltau(a[:, i], a[:, j],
+                                        method='asymptotic')
+            assert_allclose(tau[i, j], expected[0], rtol=1e-13, atol=1e-15)
+            assert_allclose(pvalue[i, j], expected[1], rtol=1e-10, atol=1e-15)
+
+    tau1, pvalue1 = stats.kendalltau_matrix(a.T, axis=1, workers=workers)
+    assert_equal(tau1, tau)
+    assert_equal(pvalue1, pvalue)
+
+
+def test_kendalltau_matrix_nan():
+    x = np.array([[1., 2., 3., 4., 5.],
+                  [2., 1., np.nan, 4., 3.],
+                  [5., 4., 3., 1., 2.]]).T
+    tau, pvalue = stats.kendalltau_matrix(x)
+    assert_(np.isnan(tau[1]).all() and np.isnan(tau[:, 1]).all())
+    assert_allclose(tau[0, 2], stats.kendalltau(x[:, 0], x[:, 2])[0])
+
+    tau, pvalue = stats.kendalltau_matrix(x, nan_policy='omit')
+    assert_allclose(tau[0, 1],
+                    stats.kendalltau(x[:, 0], x[:, 1], nan_policy='omit')[0])
+
+    assert_raises(ValueError, stats.kendalltau_matrix, x, nan_policy='raise')
+    assert_raises(ValueError, stats.kendalltau_matrix, x[:, 0])
+    assert_raises(ValueError, stats.kendalltau_matrix, x, workers=0)
+
+
 def test_weightedtau():
     x = [12, 2, 1, 12, 2]
     y = [1, 4, 7, 1, 0]